@@ -0,0 +1,372 @@
+#ifndef ADJOINT_H
+#define ADJOINT_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/domain.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/memory_report.h"
+#include "../include/quadrature.h"
+#include "../include/specfem_mpi.h"
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace specfem {
+namespace adjoint {
+
+namespace action {
+enum type {
+  advance,   ///< Step the forward fields until get_capo
+  takeshot,  ///< Store the forward fields in checkpoint get_check
+  restore,   ///< Load the forward fields from checkpoint get_check
+  firsturn,  ///< First forward step from get_capo followed by an adjoint step
+  youturn,   ///< Forward step from get_capo followed by an adjoint step
+  terminate  ///< Every adjoint step was computed
+};
+} // namespace action
+
+/**
+ * @brief Binomial checkpointing schedule of the adjoint time loop
+ *
+ * Implements the revolve algorithm of Griewank and Walther (ACM TOMS 26,
+ * 2000). Adjoint steps nsteps - 1, ..., 0 are computed in reverse order, every
+ * one of them needing the forward fields at the same step. With s
+ * checkpoints the forward fields are recomputed from the closest checkpoint
+ * such that the number of forward steps is minimal, i.e. r nsteps -
+ * binomial(s + r, r - 1) steps before the turns where r is the smallest
+ * integer with binomial(s + r, s) >= nsteps.
+ *
+ * Positions are timesteps of the forward time loop: position i holds the
+ * fields before the timestep i is computed.
+ */
+class revolve {
+
+public:
+  /**
+   * @brief Construct a new schedule
+   *
+   * @param nsteps Number of timesteps of the simulation
+   * @param ncheckpoints Number of forward states stored at the same time
+   */
+  revolve(const int nsteps, const int ncheckpoints);
+  /**
+   * @brief Get the next action of the schedule
+   *
+   * @return specfem::adjoint::action::type Action to be executed before
+   * calling next again
+   */
+  specfem::adjoint::action::type next();
+  /**
+   * @brief Get the position of the forward fields after the action
+   *
+   * @return int Timestep reached by advance and restore, or the timestep of
+   * the forward step of a turn
+   */
+  int get_capo() const { return this->capo; }
+  /**
+   * @brief Get the checkpoint read or written by the action
+   *
+   * @return int Index of the checkpoint
+   */
+  int get_check() const { return this->check; }
+  /**
+   * @brief Number of forward timesteps computed by the schedule
+   *
+   * @param nsteps Number of timesteps of the simulation
+   * @param ncheckpoints Number of forward states stored at the same time
+   * @return std::int64_t Forward timesteps, including the nsteps steps of the
+   * turns
+   */
+  static std::int64_t forward_steps(const int nsteps, const int ncheckpoints);
+
+private:
+  int ncheckpoints;        ///< Number of checkpoints
+  int capo = 0;            ///< Current position of the forward fields
+  int fine;                ///< End of the steps left to reverse
+  int check = -1;          ///< Last written checkpoint
+  bool turned = false;     ///< true once the first turn is computed
+  std::vector<int> stored; ///< Position stored in every checkpoint
+};
+
+/**
+ * @brief Fixed-rate lossy storage of forward fields on the device
+ *
+ * Fields are flattened and split in blocks of block_size consecutive
+ * values. Every block stores its largest magnitude as scale, values are
+ * rounded to the closest of the 2^(bits - 1) - 1 signed multiples of
+ * scale / (2^(bits - 1) - 1) and packed into 32 bit words, hence the error of
+ * every value is at most half of that step. A slot stores one field.
+ */
+class quantizer {
+
+public:
+  constexpr static int block_size = 64; ///< Number of values sharing a scale
+
+  /**
+   * @brief Default constructor. There are no slots
+   *
+   */
+  quantizer() : bits(0), nvalues(0){};
+  /**
+   * @brief Allocate the compressed slots
+   *
+   * @param nslots Number of fields stored at the same time
+   * @param nglob Number of global points of the fields
+   * @param ncomponents Number of components of the fields
+   * @param bits Number of bits of every value, one of 2, 4, 8 or 16
+   */
+  quantizer(const int nslots, const int nglob, const int ncomponents,
+            const int bits);
+  /**
+   * @brief Compress a field into a slot
+   *
+   * @param islot Index of the slot
+   * @param field Field to compress (nglob, ncomponents)
+   * @param exec_space Execution space instance used to launch the kernel
+   * @return type_real Largest error of the stored values relative to the
+   * largest magnitude of the field. Fences exec_space
+   */
+  type_real
+  compress(const int islot,
+           const specfem::kokkos::DeviceFieldView2d<type_real> field,
+           const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Decompress a slot into a field
+   *
+   * @param islot Index of the slot
+   * @param field Field overwritten by the stored values (nglob, ncomponents)
+   * @param exec_space Execution space instance used to launch the kernel
+   */
+  void
+  decompress(const int islot,
+             const specfem::kokkos::DeviceFieldView2d<type_real> field,
+             const specfem::kokkos::DevExecSpace &exec_space) const;
+  /**
+   * @brief Bytes stored for every slot
+   *
+   * @param nvalues Number of values of a field
+   * @param bits Number of bits of every value
+   * @return std::size_t Bytes of the packed values and the scales
+   */
+  static std::size_t slot_size(const std::size_t nvalues, const int bits);
+  /**
+   * @brief Get the number of bits of every value
+   *
+   */
+  int get_bits() const { return this->bits; }
+  /**
+   * @brief Memory used by the compressed slots
+   *
+   * @return specfem::memory::usage Bytes allocated on the device and the host
+   */
+  specfem::memory::usage memory_usage() const;
+
+private:
+  int bits;    ///< Number of bits of every value
+  int nvalues; ///< Number of values of a field
+  specfem::kokkos::DeviceView2d<std::uint32_t> words; ///< Packed values of
+                                                      ///< every slot
+  specfem::kokkos::DeviceView2d<type_real> scales; ///< Scale of every block
+                                                   ///< of every slot
+};
+
+/**
+ * @brief Tractions of the absorbing points recorded at every timestep
+ *
+ * Elastic fields without attenuation are reconstructed backward in time from
+ * their last state, with the tractions of the absorbing points replayed in
+ * reverse order. Tractions of chunk_size timesteps are gathered in a device
+ * buffer, which is copied to pinned host memory and written to a file by a
+ * background task once full. Chunks are read back in reverse order, the
+ * previous chunk being read while the tractions of the current one are
+ * replayed. Storage scales with the number of absorbing points, not with the
+ * number of points of the domain.
+ */
+class boundary_storage {
+
+public:
+  /**
+   * @brief Construct the storage of the absorbing tractions
+   *
+   * @param npoints Number of absorbing points
+   * @param nvalues Number of traction values of every point
+   * @param nsteps Number of timesteps of the simulation
+   * @param chunk_size Number of timesteps of every chunk
+   * @param filename File storing the chunks. Removed on destruction
+   */
+  boundary_storage(const int npoints, const int nvalues, const int nsteps,
+                   const int chunk_size, const std::string &filename);
+  /**
+   * @brief Wait for the background task and remove the file
+   *
+   */
+  ~boundary_storage();
+  /**
+   * @brief Get the tractions recorded by a timestep of the forward time
+   * loop
+   *
+   * Timesteps are recorded in increasing order. Full chunks are written in
+   * the background
+   *
+   * @param istep Index of the timestep
+   * @param exec_space Execution space instance recording the tractions
+   * @return specfem::kokkos::DeviceView2d<type_real> Tractions (npoints,
+   * nvalues) written by the timestep
+   */
+  specfem::kokkos::DeviceView2d<type_real>
+  record(const int istep, const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Write the last chunk once every timestep is recorded
+   *
+   * @param exec_space Execution space instance recording the tractions
+   */
+  void flush(const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Get the tractions recorded by a timestep
+   *
+   * Timesteps are replayed in decreasing order once the storage is flushed
+   *
+   * @param istep Index of the timestep
+   * @param exec_space Execution space instance replaying the tractions
+   * @return specfem::kokkos::DeviceView2d<type_real> Tractions (npoints,
+   * nvalues) recorded by the timestep
+   */
+  specfem::kokkos::DeviceView2d<type_real>
+  replay(const int istep, const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Bytes written to the file
+   *
+   */
+  std::size_t get_file_size() const;
+  /**
+   * @brief Memory used by the buffers of the chunks
+   *
+   * @return specfem::memory::usage Bytes allocated on the device and the host
+   */
+  specfem::memory::usage memory_usage() const;
+
+private:
+  int npoints;          ///< Number of absorbing points
+  int nvalues;          ///< Number of traction values of every point
+  int nsteps;           ///< Number of timesteps of the simulation
+  int chunk_size;       ///< Number of timesteps of every chunk
+  std::string filename; ///< File storing the chunks
+  specfem::kokkos::DeviceView3d<type_real> buffer[2]; ///< Chunks being
+                                                      ///< recorded or
+                                                      ///< replayed
+  specfem::kokkos::HostPinnedView3d<type_real> staging[2]; ///< Chunks copied
+                                                           ///< to or read
+                                                           ///< from the file
+  std::vector<specfem::kokkos::DevExecSpace> copy_spaces; ///< Instances used
+                                                          ///< to copy chunks
+                                                          ///< to the host
+  int loaded = -1;     ///< Chunk stored in its device buffer for replay
+  int prefetched = -1; ///< Chunk read by the background task
+  std::future<void> pending; ///< Background task writing or reading a chunk
+
+  /**
+   * @brief Copy a recorded chunk to the host and write it in the background
+   *
+   * @param ichunk Index of the chunk
+   * @param exec_space Execution space instance recording the tractions
+   */
+  void write_chunk(const int ichunk,
+                   const specfem::kokkos::DevExecSpace &exec_space);
+};
+
+/**
+ * @brief Sensitivity kernels of an elastic domain
+ *
+ * Kernels are accumulated at every quadrature point during the adjoint time
+ * loop (Tromp et al., GJI 160, 2005):
+ *
+ * - \f$ K_\rho = -\int \rho \, s^\dagger \cdot \partial_t^2 s \, dt \f$
+ * - \f$ K_\kappa = -\int \kappa \, (\nabla \cdot s^\dagger) (\nabla \cdot s)
+ * \, dt \f$
+ * - \f$ K_\mu = -\int 2 \mu \, D^\dagger : D \, dt \f$
+ *
+ * with \f$ \kappa = \lambda + 2 \mu / 3 \f$ and D the deviatoric strain of
+ * the plane strain fields. SH fields have no volumetric strain, hence the
+ * bulk modulus kernel is 0. Forward fields s are read at the time of the
+ * adjoint sources, i.e. the forward and adjoint fields read by accumulate are
+ * at the same simulation time.
+ */
+class kernels {
+
+public:
+  /**
+   * @brief Default constructor. There are no kernels
+   *
+   */
+  kernels(){};
+  /**
+   * @brief Allocate the kernels of every element initialized to 0
+   *
+   * @param compute Pointer to the struct storing the global numbering and
+   * coordinates
+   * @param partial_derivatives Pointer to the partial derivatives
+   * @param properties Pointer to the material properties
+   * @param quadx Quadrature object in x dimension
+   * @param quadz Quadrature object in z dimension
+   * @param wave Wave type simulated by the domains
+   */
+  kernels(const specfem::compute::compute *compute,
+          const specfem::compute::partial_derivatives *partial_derivatives,
+          const specfem::compute::properties *properties,
+          const specfem::quadrature::quadrature *quadx,
+          const specfem::quadrature::quadrature *quadz,
+          const specfem::wave::type wave);
+  /**
+   * @brief Add the contribution of a timestep to the kernels
+   *
+   * @param forward Domain storing the forward fields
+   * @param adjoint Domain storing the adjoint fields
+   * @param dt Time interval between timesteps
+   * @param exec_space Execution space instance used to launch the kernel
+   */
+  void accumulate(const specfem::Domain::Domain *forward,
+                  const specfem::Domain::Domain *adjoint, const type_real dt,
+                  const specfem::kokkos::DevExecSpace &exec_space) const;
+  /**
+   * @brief Write the kernels of this process
+   *
+   * Every process writes <output_folder>/proc<rank>_kernels.dat, one line
+   * per quadrature point storing x, z, rho, kappa and mu kernels. Points
+   * shared by elements are written once for every element
+   *
+   * @param output_folder Folder storing the kernel files
+   * @param mpi Pointer to the MPI object
+   */
+  void write(const std::string &output_folder,
+             const specfem::MPI::MPI *mpi) const;
+  /**
+   * @brief Memory used by the views of the kernels
+   *
+   * @return specfem::memory::usage Bytes allocated on the device and the host
+   */
+  specfem::memory::usage memory_usage() const;
+
+private:
+  const specfem::compute::compute *compute; ///< Global numbering
+  const specfem::compute::partial_derivatives
+      *partial_derivatives;                    ///< Partial derivatives
+  const specfem::compute::properties *properties; ///< Material properties
+  const specfem::quadrature::quadrature *quadx;   ///< Quadrature along x
+  const specfem::quadrature::quadrature *quadz;   ///< Quadrature along z
+  specfem::wave::type wave; ///< Wave type simulated by the domains
+  specfem::kokkos::DeviceElementView3d<type_real> rho; ///< Density kernel
+                                                       ///< (nspec, ngllz,
+                                                       ///< ngllx)
+  specfem::kokkos::DeviceElementView3d<type_real> kappa; ///< Bulk modulus
+                                                         ///< kernel
+  specfem::kokkos::DeviceElementView3d<type_real> mu; ///< Shear modulus
+                                                      ///< kernel
+};
+
+} // namespace adjoint
+} // namespace specfem
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "../include/kokkos_abstractions.h"
+#include <Kokkos_Core.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace specfem {
+namespace memory {
+
+/**
+ * @brief Bump allocator for the temporaries of setup routines
+ *
+ * Views are carved out of large host chunks instead of being allocated one by
+ * one. Chunks never move, hence views stay valid until the arena is released
+ * past them. Memory isn't initialized, views need to be written before they
+ * are read. Released chunks are kept and reused by later allocations
+ *
+ */
+class arena {
+public:
+  /**
+   * @brief Position of the next allocation, see mark and release
+   *
+   */
+  struct position {
+    std::size_t chunk = 0;  ///< Index of the chunk
+    std::size_t offset = 0; ///< Offset in bytes within the chunk
+  };
+
+  /**
+   * @brief Construct a new arena
+   *
+   * @param chunk_bytes Size of the chunks. Larger allocations get a chunk of
+   * their own
+   */
+  arena(const std::size_t chunk_bytes = 1 << 20);
+  ~arena();
+  arena(const arena &) = delete;
+  arena &operator=(const arena &) = delete;
+
+  /**
+   * @brief Allocate an unmanaged host view
+   *
+   * @tparam ViewType Host view type, e.g. specfem::kokkos::HostView1d<T>
+   * @param extents Extents of the view
+   * @return ViewType View of uninitialized memory owned by the arena
+   */
+  template <typename ViewType, typename... Extents>
+  ViewType allocate(const Extents... extents) {
+    static_assert(
+        Kokkos::SpaceAccessibility<Kokkos::HostSpace,
+                                   typename ViewType::memory_space>::accessible,
+        "arena views need to be host accessible");
+    using value_type = typename ViewType::value_type;
+    const std::size_t count = (static_cast<std::size_t>(extents) * ... * 1);
+    auto *data = static_cast<value_type *>(
+        this->allocate_bytes(count * sizeof(value_type)));
+    return ViewType(data, extents...);
+  }
+
+  /**
+   * @brief Position of the next allocation
+   *
+   * @return position Position to pass to release
+   */
+  position mark() const { return { this->ichunk, this->offset }; }
+
+  /**
+   * @brief Release every view allocated after a mark
+   *
+   * @param mark Position returned by mark
+   */
+  void release(const position &mark);
+
+  /**
+   * @brief Release every view of the arena
+   *
+   */
+  void release() { this->release(position()); }
+
+  /**
+   * @brief Bytes held by the chunks of the arena
+   *
+   * @return std::size_t Bytes of every chunk, used or not
+   */
+  std::size_t capacity() const;
+
+private:
+  /// Allocations are aligned to cache lines
+  static constexpr std::size_t alignment = 64;
+
+  struct chunk {
+    void *data;
+    std::size_t bytes;
+  };
+
+  void *allocate_bytes(const std::size_t bytes);
+
+  std::size_t chunk_bytes;   ///< Size of new chunks
+  std::vector<chunk> chunks; ///< Chunks in allocation order
+  std::size_t ichunk = 0;    ///< Chunk of the next allocation
+  std::size_t offset = 0;    ///< Offset of the next allocation in ichunk
+};
+
+} // namespace memory
+} // namespace specfem
+
+#endif
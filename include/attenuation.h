@@ -0,0 +1,116 @@
+#ifndef ATTENUATION_H
+#define ATTENUATION_H
+
+#include "../include/config.h"
+#include <Kokkos_Core.hpp>
+#include <string>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Viscoelastic attenuation using coarse grained memory variables
+ *
+ * A constant Q in a frequency band around the reference frequency is
+ * approximated by n_sls standard linear solids (SLS). Each quadrature point
+ * carries the memory variables of a single SLS, assigned in a staggered
+ * pattern such that every SLS is represented once in every group of n_sls
+ * neighboring points. The anelastic coefficients are scaled by n_sls to
+ * compensate, hence memory variables use as much memory as a single SLS
+ * while the Q model is matched at wavelengths longer than the pattern
+ *
+ */
+namespace attenuation {
+
+/**
+ * @brief Ratio between the reference frequency and the lower end of the
+ * band in which Q is constant. The band spans two decades
+ *
+ */
+constexpr type_real band_ratio = 10.0;
+
+/**
+ * @brief Standard linear solids approximating a constant Q
+ *
+ * The stress of a point using SLS l is M_U * strain - zeta, where M_U is the
+ * unrelaxed modulus and the memory variable zeta follows
+ * d(zeta)/dt = omega_l * (M_U * Y_l / Q * strain - zeta). Anelastic
+ * coefficients Y_l are fitted such that the model has Q = 1, and scale with
+ * 1 / Q for Q >> 1
+ *
+ */
+struct model {
+  int n_sls = 0;                      ///< Number of standard linear solids
+  type_real f0 = 0.0;                 ///< Reference frequency at which
+                                      ///< moduli are given
+  std::vector<type_real> omega;       ///< Relaxation angular frequency of
+                                      ///< every SLS
+  std::vector<type_real> coefficient; ///< Anelastic coefficient of every
+                                      ///< SLS for Q = 1, without coarse
+                                      ///< graining
+
+  /**
+   * @brief Default constructor, attenuation isn't simulated
+   *
+   */
+  model() = default;
+  /**
+   * @brief Fit the anelastic coefficients of n_sls SLS
+   *
+   * Relaxation frequencies are spaced logarithmically in [f0 / band_ratio,
+   * f0 * band_ratio]. Coefficients are the least squares fit of Q^-1 = 1 at
+   * 2 * n_sls - 1 frequencies of the band
+   *
+   * @param n_sls Number of standard linear solids
+   * @param f0 Reference frequency at which moduli are given
+   */
+  model(const int n_sls, const type_real f0);
+
+  /**
+   * @brief Q^-1 of the model
+   *
+   * @param frequency Frequency at which Q is evaluated
+   * @param q Quality factor targeted by the model
+   * @return type_real Q^-1 at frequency
+   */
+  type_real inverse_q(const type_real frequency, const type_real q) const;
+
+  /**
+   * @brief Dispersion at the reference frequency
+   *
+   * The real part of the modulus at f0 is M_U * (1 - dispersion / Q), hence
+   * moduli given at f0 are converted to unrelaxed moduli by dividing by
+   * 1 - dispersion / Q
+   *
+   * @return type_real Dispersion for Q = 1
+   */
+  type_real dispersion() const;
+
+  /**
+   * @brief Log the standard linear solids
+   *
+   * @return std::string Message describing the relaxation frequencies and
+   * coefficients
+   */
+  std::string print() const;
+};
+
+/**
+ * @brief Standard linear solid of a quadrature point
+ *
+ * Consecutive points along x use consecutive SLS, rows are shifted by half
+ * the number of SLS such that points sharing an edge use different SLS
+ *
+ * @param iz Index of the quadrature point along z
+ * @param ix Index of the quadrature point along x
+ * @param n_sls Number of standard linear solids
+ * @return int Index of the SLS
+ */
+KOKKOS_INLINE_FUNCTION int sls_index(const int iz, const int ix,
+                                     const int n_sls) {
+  return (ix + iz * ((n_sls + 1) / 2)) % n_sls;
+}
+
+} // namespace attenuation
+} // namespace specfem
+
+#endif
@@ -0,0 +1,224 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include "../include/kokkos_abstractions.h"
+#include <Kokkos_Core.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace specfem {
+namespace autotune {
+
+/**
+ * @brief Launch configuration of a team kernel
+ *
+ */
+struct config {
+  int team_size = 0;     ///< Team size. 0 uses the default team size of the
+                         ///< kernel
+  int scratch_level = 0; ///< Level of scratch memory used by the kernel
+};
+
+/**
+ * @brief Name of the device used to execute kernels
+ *
+ * Used to key tuned configurations such that a cache file can be shared
+ * between GPU generations
+ *
+ * @return std::string Device name without whitespaces
+ */
+std::string device_name();
+
+/**
+ * @brief Configurations tuned during previous runs
+ *
+ * Configurations are stored in a text file with one `key team_size
+ * scratch_level` entry per line
+ *
+ */
+class cache {
+public:
+  /**
+   * @brief Default constructor. Tuned configurations are not stored on disk
+   *
+   */
+  cache(){};
+  /**
+   * @brief Construct a cache and read configurations stored in filename
+   *
+   * @param filename Cache file. Created when the first configuration is
+   * tuned if it doesn't exist
+   */
+  cache(const std::string &filename);
+  /**
+   * @brief Find the configuration tuned for key
+   *
+   * @param key Kernel key
+   * @param configuration Tuned configuration if key is found
+   * @return bool true if key is found
+   */
+  bool find(const std::string &key,
+            specfem::autotune::config &configuration) const;
+  /**
+   * @brief Store a tuned configuration and update the cache file
+   *
+   * @param key Kernel key
+   * @param configuration Tuned configuration
+   */
+  void insert(const std::string &key,
+              const specfem::autotune::config &configuration);
+
+private:
+  std::string filename; ///< Cache file
+  std::map<std::string, specfem::autotune::config>
+      configurations; ///< Tuned configurations
+};
+
+/**
+ * @brief Tune the launch configuration of a team kernel
+ *
+ * Successive launches of the kernel use successive candidate configurations.
+ * Every candidate is timed over nlaunch launches, after which the fastest
+ * candidate is used by every remaining launch and stored in the cache. A
+ * launch is still computed exactly once, hence tuning happens during the
+ * first steps of a run.
+ *
+ */
+class kernel {
+public:
+  /**
+   * @brief Default constructor. The kernel isn't tuned and always uses its
+   * default configuration
+   *
+   */
+  kernel(){};
+  /**
+   * @brief Construct a kernel tuner
+   *
+   * @param name Kernel name
+   * @param ngll Number of GLL points
+   * @param nelem Number of elements (or sources and receivers) the kernel is
+   * launched on
+   * @param tuning_cache Cache used to read and store tuned configurations
+   */
+  kernel(const std::string &name, const int ngll, const int nelem,
+         specfem::autotune::cache *tuning_cache);
+  /**
+   * @brief Get the configuration used by the next launch
+   *
+   * @param scratch_size Scratch memory per team used by the kernel
+   * @param timed false if the launch can't be timed, e.g. it is recorded
+   * inside a graph. Untimed launches while tuning use the default
+   * configuration
+   * @return specfem::autotune::config Launch configuration
+   */
+  specfem::autotune::config get_config(const int scratch_size,
+                                       const bool timed = true);
+  /**
+   * @brief Check if candidate configurations are still being timed
+   *
+   */
+  bool tuning() const {
+    return (this->icandidate < static_cast<int>(this->candidates.size()));
+  }
+  /**
+   * @brief Record the time of a launch using the current candidate
+   *
+   * @param time Time of the launch per league member
+   */
+  void record(const double time);
+  /**
+   * @brief Skip the current candidate. Used when the team size is too large
+   * for this kernel
+   *
+   */
+  void reject();
+
+private:
+  constexpr static int nlaunch = 3; ///< Launches timed per candidate
+  std::string key;                  ///< Key used to find the kernel in cache
+  specfem::autotune::cache *tuning_cache = nullptr; ///< Tuned configurations
+  bool initialized = false; ///< true once candidates are generated
+  std::vector<specfem::autotune::config> candidates; ///< Candidate
+                                                     ///< configurations
+  std::vector<double> timings; ///< Fastest launch of every candidate
+  int icandidate = 0;          ///< Candidate being timed
+  int ilaunch = 0;             ///< Launches timed for the current candidate
+  specfem::autotune::config best; ///< Configuration used after tuning
+  /**
+   * @brief Select the fastest candidate and store it in the cache
+   *
+   */
+  void finalize();
+};
+
+/**
+ * @brief Launch a team kernel with a tuned configuration
+ *
+ * The launch is timed if the tuner is still tuning and the kernel isn't
+ * recorded inside a graph
+ *
+ * @tparam Functor Kernel functor
+ * @param label Kernel label
+ * @param tuner Kernel tuner
+ * @param configuration Configuration returned by tuner.get_config. The
+ * functor has to use configuration.scratch_level
+ * @param exec_space Execution space instance used to launch the kernel
+ * @param league_size League size
+ * @param team_size Default team size of the kernel. 0 lets Kokkos choose
+ * @param scratch_size Scratch memory per team used by the kernel
+ * @param functor Kernel functor
+ * @param node Graph node used to record the kernel. The kernel is launched
+ * immediately if node is a nullptr
+ */
+template <typename Functor>
+void parallel_for(const std::string &label, specfem::autotune::kernel &tuner,
+                  const specfem::autotune::config &configuration,
+                  const specfem::kokkos::DevExecSpace &exec_space,
+                  const int league_size, const int team_size,
+                  const int scratch_size, const Functor &functor,
+                  specfem::kokkos::DeviceGraphNode *node) {
+
+  const auto create_policy = [&](const int nteam) {
+    auto policy =
+        (nteam > 0)
+            ? specfem::kokkos::DeviceTeam(exec_space, league_size, nteam, 1)
+            : specfem::kokkos::DeviceTeam(exec_space, league_size,
+                                          Kokkos::AUTO, 1);
+    if (scratch_size > 0)
+      policy.set_scratch_size(configuration.scratch_level,
+                              Kokkos::PerTeam(scratch_size));
+    return policy;
+  };
+
+  const int nteam =
+      (configuration.team_size > 0) ? configuration.team_size : team_size;
+  auto policy = create_policy(nteam);
+
+  bool timed = tuner.tuning() && (node == nullptr) && (league_size > 0);
+  if (timed &&
+      nteam > policy.team_size_max(functor, Kokkos::ParallelForTag())) {
+    tuner.reject();
+    policy = create_policy(team_size);
+    timed = false;
+  }
+
+  if (!timed) {
+    specfem::kokkos::parallel_for(label, policy, functor, node);
+    return;
+  }
+
+  exec_space.fence();
+  Kokkos::Timer timer;
+  specfem::kokkos::parallel_for(label, policy, functor, nullptr);
+  exec_space.fence();
+  tuner.record(timer.seconds() / league_size);
+
+  return;
+}
+
+} // namespace autotune
+} // namespace specfem
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef BINDING_H
+#define BINDING_H
+
+#include "../include/specfem_mpi.h"
+#include <string>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Binding of MPI processes to the devices and cores of their node
+ *
+ * Processes sharing a node are mapped round robin to the devices visible on
+ * the node. Cores are grouped by NUMA domain and split into contiguous blocks,
+ * one per process, such that host threads of a process stay within a NUMA
+ * domain whenever the number of processes per node is a multiple of the number
+ * of NUMA domains.
+ *
+ */
+namespace binding {
+
+/**
+ * @brief Resources assigned to a process
+ *
+ */
+struct mapping {
+  std::string hostname;  ///< Name of the node
+  int node_rank = 0;     ///< Rank of the process on its node
+  int device_id = -1;    ///< Device used by Kokkos. -1 on host backends
+  int ndevices = 0;      ///< Number of devices visible on the node
+  std::vector<int> cpus; ///< Cores the process is bound to. Empty if the
+                         ///< affinity set by the launcher is kept
+  int nthreads = 0;      ///< Number of host threads
+  std::vector<int> thread_domains; ///< NUMA domains the host threads run on
+  bool threads_bound = false; ///< true if every host thread is bound to the
+                              ///< cores of a single NUMA domain
+};
+
+/**
+ * @brief Compute the resources assigned to this process
+ *
+ * The device is not selected if it is set on the command line or using
+ * KOKKOS_DEVICE_ID. Cores are not assigned if the launcher already bound the
+ * process to a subset of the cores of the node.
+ *
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @param mpi Pointer to MPI object
+ * @return specfem::binding::mapping Resources of this process
+ */
+specfem::binding::mapping compute_mapping(const int argc, char **argv,
+                                          const specfem::MPI::MPI *mpi);
+
+/**
+ * @brief Bind this process to its cores and initialize Kokkos on its device
+ *
+ * Kokkos arguments are removed from argv as Kokkos::initialize does. The
+ * number of host threads is set to the number of assigned cores unless it is
+ * set on the command line or using OMP_NUM_THREADS. Host threads are bound to
+ * cores unless OMP_PROC_BIND or OMP_PLACES are set, such that pages first
+ * touched by a thread stay on its NUMA domain, see specfem::first_touch. The
+ * NUMA domains of the host threads are checked once Kokkos is initialized.
+ *
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @param mpi Pointer to MPI object
+ * @return specfem::binding::mapping Resources of this process
+ */
+specfem::binding::mapping initialize(int &argc, char **argv,
+                                     const specfem::MPI::MPI *mpi);
+
+/**
+ * @brief Resources of every process, gathered on the main process
+ *
+ * Processes whose host threads aren't bound to a single NUMA domain are
+ * flagged, memory placed by the first touch of a thread isn't local to the
+ * thread once it migrates
+ *
+ * @param map Resources of this process
+ * @param mpi Pointer to MPI object
+ * @return std::string One line per process on the main process
+ */
+std::string print(const specfem::binding::mapping &map,
+                  const specfem::MPI::MPI *mpi);
+
+} // namespace binding
+} // namespace specfem
+
+#endif
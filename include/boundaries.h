@@ -153,7 +153,7 @@ struct absorbing_boundary {
    * @param nspec Number of spectral elements
    * @param mpi Pointer to MPI object
    */
-  absorbing_boundary(std::ifstream &stream, int num_abs_boundary_faces,
+  absorbing_boundary(std::istream &stream, int num_abs_boundary_faces,
                      const int nspec, const specfem::MPI::MPI *mpi);
 };
 
@@ -269,10 +269,28 @@ struct forcing_boundary {
    * @param nspec Number of spectral elements
    * @param mpi Pointer to MPI object
    */
-  forcing_boundary(std::ifstream &stream, const int nelement_acforcing,
+  forcing_boundary(std::istream &stream, const int nelement_acforcing,
                    const int nspec, const specfem::MPI::MPI *mpi);
 };
 
+/**
+ * @brief Compute the index of every boundary entry within its side
+ *
+ * @param code Side of every entry (nelements, 4) stored as (bottom, right,
+ * top, left)
+ * @param ib_bottom Index of bottom entries
+ * @param ib_top Index of top entries
+ * @param ib_left Index of left entries
+ * @param ib_right Index of right entries
+ * @param nelements Number of entries
+ */
+void calculate_ib(const specfem::kokkos::HostView2d<bool> code,
+                  specfem::kokkos::HostView1d<int> ib_bottom,
+                  specfem::kokkos::HostView1d<int> ib_top,
+                  specfem::kokkos::HostView1d<int> ib_left,
+                  specfem::kokkos::HostView1d<int> ib_right,
+                  const int nelements);
+
 } // namespace boundaries
 } // namespace specfem
 
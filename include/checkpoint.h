@@ -0,0 +1,135 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/domain.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/specfem_mpi.h"
+#include "../include/timescheme.h"
+#include "../include/writer.h"
+#include <future>
+#include <string>
+
+namespace specfem {
+/**
+ * @brief Checkpoints of the time loop
+ *
+ * A checkpoint stores the fields, the position of the time loop, the
+ * seismogram samples which haven't been written yet and the recorded samples
+ * filtered by the anti-alias filter of decimated seismograms. Every process
+ * writes its own file, checkpoint_<rank>.bin, under a temporary name which is
+ * renamed once the file is complete, hence a file always holds a complete
+ * checkpoint.
+ *
+ */
+namespace checkpoint {
+
+/**
+ * @brief Checkpoint writer and reader
+ *
+ * Checkpoints are written every nstep_between_checkpoints timesteps and when
+ * the process receives SIGTERM, after which the time loop stops. Fields are
+ * copied on the device and to pinned host memory on a separate execution
+ * space instance, and the file is written by a background task.
+ *
+ */
+class checkpoint {
+public:
+  /**
+   * @brief Construct a new checkpoint object and install the SIGTERM handler
+   *
+   * @param directory Directory storing checkpoint files
+   * @param nstep_between_checkpoints Number of timesteps between
+   * checkpoints. 0 only writes a checkpoint when SIGTERM is received
+   * @param domain Pointer to domain storing the fields
+   * @param compute_receivers Pointer to specfem::compute::receivers struct
+   * storing seismograms
+   * @param writer Pointer to the seismogram writer. Can be null
+   * @param mpi Pointer to MPI object
+   */
+  checkpoint(const std::string &directory, const int nstep_between_checkpoints,
+             specfem::Domain::Domain *domain,
+             specfem::compute::receivers *compute_receivers,
+             specfem::writer::writer *writer, const specfem::MPI::MPI *mpi);
+  /**
+   * @brief Wait for the background task writing the checkpoint
+   *
+   */
+  ~checkpoint();
+  /**
+   * @brief Check if a checkpoint is written at the end of timestep istep
+   *
+   * Has to be called once for every timestep by every process. SIGTERM is
+   * checked every 10 timesteps, processes agree on the timestep of the
+   * checkpoint using a collective.
+   *
+   * @param istep Index of the timestep
+   * @return bool true if a checkpoint is written
+   */
+  bool checkpoint_step(const int istep);
+  /**
+   * @brief Write a checkpoint in the background
+   *
+   * Fields need to be corrected, and the predictor phase of the next timestep
+   * must not be applied yet.
+   *
+   * @param state Position of the time loop
+   * @param exec_space Execution space instance updating the fields
+   */
+  void write(const specfem::TimeScheme::state &state,
+             const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Check if the time loop has to stop after the last checkpoint
+   *
+   * @return bool true if the checkpoint was written because SIGTERM was
+   * received
+   */
+  bool interrupted() const { return this->stop; }
+  /**
+   * @brief Load the fields and seismograms of the checkpoint of this process
+   *
+   * @return specfem::TimeScheme::state Position of the time loop in the
+   * checkpoint
+   */
+  specfem::TimeScheme::state read();
+  /**
+   * @brief Wait for the background task writing the checkpoint
+   *
+   */
+  void wait();
+
+private:
+  std::string filename;            ///< Checkpoint file of this process
+  int nstep_between_checkpoints;   ///< Number of timesteps between
+                                   ///< checkpoints
+  specfem::Domain::Domain *domain; ///< Pointer to domain storing the fields
+  specfem::compute::receivers *compute_receivers; ///< Pointer to seismograms
+  specfem::writer::writer *writer; ///< Pointer to the seismogram writer
+  const specfem::MPI::MPI *mpi;    ///< Pointer to MPI object
+  bool stop = false;               ///< Checkpoint written because of SIGTERM
+  specfem::kokkos::DeviceView3d<type_real> fields; ///< Copy of field,
+                                                   ///< field_dot and
+                                                   ///< field_dot_dot
+  specfem::kokkos::HostPinnedView3d<type_real> h_fields; ///< Fields copied
+                                                         ///< to host
+  specfem::kokkos::DeviceView4d<type_real> seismogram; ///< Copy of the
+                                                       ///< seismogram buffer
+  specfem::kokkos::HostPinnedView4d<type_real> h_seismogram; ///< Seismograms
+                                                             ///< copied to
+                                                             ///< host
+  specfem::kokkos::DeviceView4d<type_real> history; ///< Copy of the recorded
+                                                    ///< samples of decimated
+                                                    ///< seismograms
+  specfem::kokkos::HostPinnedView4d<type_real> h_history; ///< Recorded
+                                                          ///< samples copied
+                                                          ///< to host
+  specfem::kokkos::DevExecSpace copy_space; ///< Instance used to copy
+                                            ///< checkpoints to host
+  std::future<void> pending; ///< Background task writing the checkpoint
+};
+
+} // namespace checkpoint
+} // namespace specfem
+
+#endif
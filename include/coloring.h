@@ -0,0 +1,36 @@
+#ifndef COLORING_H
+#define COLORING_H
+
+#include "../include/kokkos_abstractions.h"
+#include <tuple>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Routines used to color spectral elements for atomic-free assembly
+ *
+ */
+namespace coloring {
+
+/**
+ * @brief Color a list of spectral elements such that no two entries of the
+ * same color share a global quadrature point
+ *
+ * Greedy first-fit coloring is used. Entries of the list can repeat (e.g.
+ * multiple sources inside the same element), repeated entries are always
+ * assigned different colors.
+ *
+ * @param h_ibool Global number for every quadrature point
+ * @param ispec_list List of spectral elements to color
+ * @return std::tuple<std::vector<int>, std::vector<int>> Permutation of
+ * indices into ispec_list sorted by color and offsets of every color into the
+ * permutation. Color icolor spans [offsets[icolor], offsets[icolor + 1])
+ */
+std::tuple<std::vector<int>, std::vector<int> >
+color_elements(const specfem::kokkos::HostElementMirror3d<int> h_ibool,
+               const std::vector<int> &ispec_list);
+
+} // namespace coloring
+} // namespace specfem
+
+#endif
@@ -3,56 +3,108 @@
 
 #include "../include/kokkos_abstractions.h"
 #include "../include/material.h"
+#include "../include/memory_report.h"
 #include "../include/quadrature.h"
 #include "../include/receiver.h"
 #include "../include/source.h"
 #include <Kokkos_Core.hpp>
+#include <tuple>
 #include <vector>
 
 namespace specfem {
 namespace compute {
 
+/**
+ * @brief Columns of the geometry records of affine elements
+ *
+ */
+namespace element_geometry {
+enum column {
+  xix,      ///< \f$\partial \xi / \partial x\f$
+  xiz,      ///< \f$\partial \xi / \partial z\f$
+  gammax,   ///< \f$\partial \gamma / \partial x\f$
+  gammaz,   ///< \f$\partial \gamma / \partial z\f$
+  jacobian, ///< Jacobian
+  ncolumns  ///< Number of columns
+};
+} // namespace element_geometry
+
+/**
+ * @brief Device accessor of a partial derivative which is constant inside
+ * affine elements
+ *
+ * Affine elements read the record of the element, other elements read the
+ * value of the quadrature point. Kernels read geometry(ispec, iz, ix) in
+ * both cases
+ *
+ */
+struct geometry_accessor {
+  specfem::kokkos::DeviceElementView3d<type_real> point; ///< Value at every
+                                                         ///< quadrature point
+  specfem::kokkos::DeviceView2d<type_real> record; ///< Geometry record of
+                                                   ///< every element
+                                                   ///< (ispec, column)
+  specfem::kokkos::DeviceView1d<int> affine; ///< 1 if the element is affine
+  specfem::compute::element_geometry::column column; ///< Column of the
+                                                     ///< derivative in
+                                                     ///< record
+  bool records; ///< If false affine elements haven't been detected
+
+  KOKKOS_INLINE_FUNCTION
+  type_real operator()(const int ispec, const int iz, const int ix) const {
+    return (this->records && this->affine(ispec))
+               ? this->record(ispec, this->column)
+               : this->point(ispec, iz, ix);
+  }
+};
+
 /**
  * @brief Partial derivates matrices required to compute integrals
  *
- * The matrices are stored in (ispec, iz, ix) format
+ * The matrices are stored in (ispec, iz, ix) format. Partial derivatives of
+ * affine elements, straight sided 4-node parallelograms, are constant and
+ * are also stored once for every element
  *
  */
 struct partial_derivatives {
-  specfem::kokkos::DeviceView3d<type_real> xix; ///< inverted partial derivates
-                                                ///< \f$\partial \xi / \partial
-                                                ///< x\f$ stored on the device
-  specfem::kokkos::HostMirror3d<type_real> h_xix; ///< inverted partial
-                                                  ///< derivates \f$\partial \xi
-                                                  ///< / \partial x\f$ stored on
-                                                  ///< the host
-  specfem::kokkos::DeviceView3d<type_real> xiz; ///< inverted partial derivates
-                                                ///< \f$\partial \xi / \partial
-                                                ///< z\f$ stored on the device
-  specfem::kokkos::HostMirror3d<type_real> h_xiz; ///< inverted partial
-                                                  ///< derivates \f$\partial \xi
-                                                  ///< / \partial z\f$ stored on
-                                                  ///< the host
-  specfem::kokkos::DeviceView3d<type_real> gammax;   ///< inverted partial
-                                                     ///< derivates \f$\partial
-                                                     ///< \gamma / \partial x\f$
-                                                     ///< stored on device
-  specfem::kokkos::HostMirror3d<type_real> h_gammax; ///< inverted partial
-                                                     ///< derivates \f$\partial
-                                                     ///< \gamma / \partial x\f$
-                                                     ///< stored on host
-  specfem::kokkos::DeviceView3d<type_real> gammaz;   ///< inverted partial
-                                                     ///< derivates \f$\partial
-                                                     ///< \gamma / \partial z\f$
-                                                     ///< stored on device
-  specfem::kokkos::HostMirror3d<type_real> h_gammaz; ///< inverted partial
-                                                     ///< derivates \f$\partial
-                                                     ///< \gamma / \partial z\f$
-                                                     ///< stored on host
-  specfem::kokkos::DeviceView3d<type_real> jacobian; ///< Jacobian values stored
-                                                     ///< on device
-  specfem::kokkos::HostMirror3d<type_real> h_jacobian; ///< Jacobian values
-                                                       ///< stored on host
+  specfem::kokkos::DeviceElementView3d<type_real>
+      xix; ///< inverted partial derivates \f$\partial \xi / \partial x\f$
+           ///< stored on the device
+  specfem::kokkos::HostElementMirror3d<type_real>
+      h_xix; ///< inverted partial derivates \f$\partial \xi / \partial
+             ///< x\f$ stored on the host
+  specfem::kokkos::DeviceElementView3d<type_real>
+      xiz; ///< inverted partial derivates \f$\partial \xi / \partial z\f$
+           ///< stored on the device
+  specfem::kokkos::HostElementMirror3d<type_real>
+      h_xiz; ///< inverted partial derivates \f$\partial \xi / \partial
+             ///< z\f$ stored on the host
+  specfem::kokkos::DeviceElementView3d<type_real>
+      gammax; ///< inverted partial derivates \f$\partial \gamma / \partial
+              ///< x\f$ stored on device
+  specfem::kokkos::HostElementMirror3d<type_real>
+      h_gammax; ///< inverted partial derivates \f$\partial \gamma /
+                ///< \partial x\f$ stored on host
+  specfem::kokkos::DeviceElementView3d<type_real>
+      gammaz; ///< inverted partial derivates \f$\partial \gamma / \partial
+              ///< z\f$ stored on device
+  specfem::kokkos::HostElementMirror3d<type_real>
+      h_gammaz; ///< inverted partial derivates \f$\partial \gamma /
+                ///< \partial z\f$ stored on host
+  specfem::kokkos::DeviceElementView3d<type_real>
+      jacobian; ///< Jacobian values stored on device
+  specfem::kokkos::HostElementMirror3d<type_real>
+      h_jacobian; ///< Jacobian values stored on host
+  specfem::kokkos::DeviceView1d<int> affine;   ///< 1 if the element is
+                                               ///< affine stored on device
+  specfem::kokkos::HostMirror1d<int> h_affine; ///< 1 if the element is
+                                               ///< affine stored on host
+  specfem::kokkos::DeviceView2d<type_real>
+      affine_record; ///< Partial derivatives of affine elements (ispec,
+                     ///< column) stored on device
+  specfem::kokkos::HostMirror2d<type_real>
+      h_affine_record; ///< Partial derivatives of affine elements stored on
+                       ///< host
   /**
    * @brief Default constructor
    *
@@ -69,6 +121,10 @@ struct partial_derivatives {
   /**
    * @brief Constructor to allocate and assign views
    *
+   * Partial derivatives are computed on the device from the control nodes and
+   * copied to the host views. Affine elements are detected with
+   * assign_affine_elements
+   *
    * @param coorg (x,z) for every spectral element control node
    * @param knods Global control element number for every control node
    * @param quadx Quadrature object in x dimension
@@ -84,10 +140,154 @@ struct partial_derivatives {
    *
    */
   void sync_views();
+  /**
+   * @brief Free the host views once the device views are assigned
+   *
+   * Host views are only read during setup. sync_views can't be called
+   * afterwards
+   *
+   */
+  void release_host_mirrors();
+  /**
+   * @brief Copy the device views to host views released by
+   * release_host_mirrors
+   *
+   * Needed to set up a domain again once the host views are released
+   *
+   */
+  void restore_host_mirrors();
+  /**
+   * @brief Get the memory allocated by the views of this struct
+   *
+   */
+  specfem::memory::usage memory_usage() const;
+  /**
+   * @brief Detect affine elements and store their partial derivatives once
+   *
+   * 4-node elements whose control nodes form a parallelogram are affine.
+   * Values at every quadrature point of affine elements are replaced by the
+   * record of the element, hence every kernel reads the same geometry
+   *
+   * @param coorg (x,z) for every spectral element control node
+   * @param knods Global control element number for every control node
+   * @return int Number of affine elements
+   */
+  int assign_affine_elements(const specfem::kokkos::HostView2d<type_real> coorg,
+                             const specfem::kokkos::HostView2d<int> knods);
+  /**
+   * @brief Compute the partial derivatives of the elements on the axis of
+   * axisymmetric simulations at their Gauss-Lobatto-Jacobi points
+   *
+   * Elements on the axis use the GLJ quadrature along xi, the axis being
+   * their xi = -1 edge. Needs to be called before assign_affine_elements
+   *
+   * @param coorg (x,z) for every spectral element control node
+   * @param knods Global control element number for every control node
+   * @param is_on_the_axis True for every element on the axis (nspec)
+   * @param quadglj GLJ quadrature in x dimension
+   * @param quadz Quadrature object in z dimension
+   * @return int Number of elements on the axis
+   */
+  int assign_axial_elements(
+      const specfem::kokkos::HostView2d<type_real> coorg,
+      const specfem::kokkos::HostView2d<int> knods,
+      const specfem::kokkos::HostView1d<bool> is_on_the_axis,
+      const specfem::quadrature::quadrature &quadglj,
+      const specfem::quadrature::quadrature &quadz);
+  /**
+   * @brief Get the device accessor of \f$\partial \xi / \partial x\f$
+   *
+   */
+  specfem::compute::geometry_accessor get_xix() const {
+    return this->accessor(this->xix, specfem::compute::element_geometry::xix);
+  }
+  /**
+   * @brief Get the device accessor of \f$\partial \xi / \partial z\f$
+   *
+   */
+  specfem::compute::geometry_accessor get_xiz() const {
+    return this->accessor(this->xiz, specfem::compute::element_geometry::xiz);
+  }
+  /**
+   * @brief Get the device accessor of \f$\partial \gamma / \partial x\f$
+   *
+   */
+  specfem::compute::geometry_accessor get_gammax() const {
+    return this->accessor(this->gammax,
+                          specfem::compute::element_geometry::gammax);
+  }
+  /**
+   * @brief Get the device accessor of \f$\partial \gamma / \partial z\f$
+   *
+   */
+  specfem::compute::geometry_accessor get_gammaz() const {
+    return this->accessor(this->gammaz,
+                          specfem::compute::element_geometry::gammaz);
+  }
+  /**
+   * @brief Get the device accessor of the jacobian
+   *
+   */
+  specfem::compute::geometry_accessor get_jacobian() const {
+    return this->accessor(this->jacobian,
+                          specfem::compute::element_geometry::jacobian);
+  }
+
+private:
+  specfem::compute::geometry_accessor
+  accessor(const specfem::kokkos::DeviceElementView3d<type_real> point,
+           const specfem::compute::element_geometry::column column) const {
+    return { point, this->affine_record, this->affine, column,
+             this->affine.is_allocated() };
+  }
+};
+/**
+ * @brief Columns of the material table of compressed material properties
+ *
+ */
+namespace material_table {
+enum column {
+  rho,           ///< Density
+  mu,            ///< Shear modulus
+  lambdaplus2mu, ///< \f$ \lambda + 2 \mu \f$
+  ncolumns       ///< Number of columns
 };
+} // namespace material_table
+
+/**
+ * @brief Device accessor of a material property stored either at every
+ * quadrature point or once for every material
+ *
+ * Kernels read the property of a quadrature point with
+ * property(ispec, iz, ix) in both cases
+ *
+ */
+struct property_accessor {
+  specfem::kokkos::DeviceElementView3d<type_real>
+      point; ///< Property at every quadrature point. Not allocated if
+             ///< compressed
+  specfem::kokkos::DeviceView2d<type_real> table; ///< Material table
+                                                  ///< (imaterial, column)
+  specfem::kokkos::DeviceView1d<int> kmato; ///< Material of every element
+  specfem::compute::material_table::column column; ///< Column of the
+                                                   ///< property in table
+  bool compressed; ///< If true the property is read from table
+
+  KOKKOS_INLINE_FUNCTION
+  type_real operator()(const int ispec, const int iz, const int ix) const {
+    return this->compressed ? this->table(this->kmato(ispec), this->column)
+                            : this->point(ispec, iz, ix);
+  }
+};
+
 /**
  * @brief Material properties stored at every quadrature point
  *
+ * Models which are constant inside every material can be compressed to a
+ * table storing one record per material, in which case the device only
+ * stores the material of every element. The table holds a few values for
+ * every material and stays in cache during the stiffness kernels
+ *
  */
 struct properties {
   /**
@@ -96,24 +296,24 @@ struct properties {
    * h_ prefixes denote views stored on host
    */
   ///@{
-  specfem::kokkos::DeviceView3d<type_real> rho;
-  specfem::kokkos::HostMirror3d<type_real> h_rho;
+  specfem::kokkos::DeviceElementView3d<type_real> rho;
+  specfem::kokkos::HostElementMirror3d<type_real> h_rho;
 
-  specfem::kokkos::DeviceView3d<type_real> mu;
-  specfem::kokkos::HostMirror3d<type_real> h_mu;
+  specfem::kokkos::DeviceElementView3d<type_real> mu;
+  specfem::kokkos::HostElementMirror3d<type_real> h_mu;
 
-  specfem::kokkos::HostView3d<type_real> kappa;
+  specfem::kokkos::HostElementView3d<type_real> kappa;
 
-  specfem::kokkos::HostView3d<type_real> qmu;
+  specfem::kokkos::HostElementView3d<type_real> qmu;
 
-  specfem::kokkos::HostView3d<type_real> qkappa;
+  specfem::kokkos::HostElementView3d<type_real> qkappa;
 
-  specfem::kokkos::HostView3d<type_real> rho_vp;
+  specfem::kokkos::HostElementView3d<type_real> rho_vp;
 
-  specfem::kokkos::HostView3d<type_real> rho_vs;
+  specfem::kokkos::HostElementView3d<type_real> rho_vs;
 
-  specfem::kokkos::DeviceView3d<type_real> lambdaplus2mu;
-  specfem::kokkos::HostMirror3d<type_real> h_lambdaplus2mu;
+  specfem::kokkos::DeviceElementView3d<type_real> lambdaplus2mu;
+  specfem::kokkos::HostElementMirror3d<type_real> h_lambdaplus2mu;
   ///@}
   // element type is defined in config.h
   specfem::kokkos::DeviceView1d<specfem::elements::type>
@@ -122,6 +322,16 @@ struct properties {
   specfem::kokkos::HostMirror1d<specfem::elements::type>
       h_ispec_type; ///< type of element
                     ///< stored on host
+  specfem::kokkos::DeviceView1d<int> kmato;   ///< Material of every element
+                                              ///< stored on device. Only
+                                              ///< allocated if compressed
+  specfem::kokkos::HostMirror1d<int> h_kmato; ///< Material of every element
+                                              ///< stored on host
+  specfem::kokkos::DeviceView2d<type_real>
+      material_table; ///< Properties of every material (imaterial, column)
+                      ///< stored on device. Only allocated if compressed
+  specfem::kokkos::HostMirror2d<type_real>
+      h_material_table; ///< Properties of every material stored on host
 
   /**
    * @brief Default constructor
@@ -154,6 +364,66 @@ struct properties {
    *
    */
   void sync_views();
+  /**
+   * @brief Free the host views once the device views are assigned
+   *
+   * Host views, including the host only properties used to estimate the
+   * stable time step, are only read during setup. sync_views can't be called
+   * afterwards
+   *
+   */
+  void release_host_mirrors();
+  /**
+   * @brief Get the memory allocated by the views of this struct
+   *
+   */
+  specfem::memory::usage memory_usage() const;
+  /**
+   * @brief Store the properties once for every material if they are
+   * constant inside every material
+   *
+   * The device views storing properties at every quadrature point are
+   * freed. Host views are kept until release_host_mirrors is called
+   *
+   * @param kmato Material of every spectral element
+   * @return bool true if the properties are compressed
+   */
+  bool compress(const specfem::kokkos::HostView1d<int> kmato);
+  /**
+   * @brief Check if the properties are stored once for every material
+   *
+   */
+  bool compressed() const { return this->material_table.is_allocated(); }
+  /**
+   * @brief Get the device accessor of the density
+   *
+   */
+  specfem::compute::property_accessor get_rho() const {
+    return this->accessor(this->rho, specfem::compute::material_table::rho);
+  }
+  /**
+   * @brief Get the device accessor of the shear modulus
+   *
+   */
+  specfem::compute::property_accessor get_mu() const {
+    return this->accessor(this->mu, specfem::compute::material_table::mu);
+  }
+  /**
+   * @brief Get the device accessor of \f$ \lambda + 2 \mu \f$
+   *
+   */
+  specfem::compute::property_accessor get_lambdaplus2mu() const {
+    return this->accessor(this->lambdaplus2mu,
+                          specfem::compute::material_table::lambdaplus2mu);
+  }
+
+private:
+  specfem::compute::property_accessor
+  accessor(const specfem::kokkos::DeviceElementView3d<type_real> point,
+           const specfem::compute::material_table::column column) const {
+    return { point, this->material_table, this->kmato, column,
+             this->compressed() };
+  }
 };
 
 /**
@@ -167,13 +437,45 @@ struct sources {
   specfem::kokkos::DeviceView4d<type_real> source_array; ///< Array to store
                                                          ///< lagrange
                                                          ///< interpolants for
-                                                         ///< sources stored on
+                                                         ///< sources which
+                                                         ///< aren't separable
+                                                         ///< (idense, iz, ix,
+                                                         ///< icomp) stored on
                                                          ///< device
   specfem::kokkos::HostMirror4d<type_real> h_source_array; ///< Array to store
                                                            ///< lagrange
                                                            ///< interpolants for
-                                                           ///< sources stored
-                                                           ///< on host
+                                                           ///< sources which
+                                                           ///< aren't separable
+                                                           ///< stored on host
+  specfem::kokkos::DeviceView1d<int> dense_index; ///< Index of the source in
+                                                  ///< source_array. -1 if the
+                                                  ///< source is separable
+                                                  ///< stored on device
+  specfem::kokkos::HostMirror1d<int> h_dense_index; ///< Index of the source in
+                                                    ///< source_array stored on
+                                                    ///< host
+  specfem::kokkos::DeviceView2d<type_real> hxis; ///< Lagrange interpolants
+                                                 ///< along x of separable
+                                                 ///< sources (isource, ix)
+                                                 ///< stored on device
+  specfem::kokkos::HostMirror2d<type_real> h_hxis; ///< Lagrange interpolants
+                                                   ///< along x stored on host
+  specfem::kokkos::DeviceView2d<type_real> hgammas; ///< Lagrange interpolants
+                                                    ///< along z of separable
+                                                    ///< sources (isource, iz)
+                                                    ///< stored on device
+  specfem::kokkos::HostMirror2d<type_real> h_hgammas; ///< Lagrange
+                                                      ///< interpolants along z
+                                                      ///< stored on host
+  specfem::kokkos::DeviceView2d<type_real> components; ///< Weight of every
+                                                       ///< component of
+                                                       ///< separable sources
+                                                       ///< (isource, icomp)
+                                                       ///< stored on device
+  specfem::kokkos::HostMirror2d<type_real> h_components; ///< Weight of every
+                                                         ///< component stored
+                                                         ///< on host
   specfem::kokkos::DeviceView1d<specfem::forcing_function::stf_storage>
       stf_array; ///< Pointer to source time function for every source stored on
                  ///< device
@@ -186,6 +488,21 @@ struct sources {
   specfem::kokkos::HostMirror1d<int> h_ispec_array; ///< Spectral element number
                                                     ///< where the source lies
                                                     ///< stored on host
+  specfem::kokkos::DeviceView1d<int> shot_array;   ///< Shot of every source
+                                                   ///< stored on device
+  specfem::kokkos::HostMirror1d<int> h_shot_array; ///< Shot of every source
+                                                   ///< stored on host
+  specfem::kokkos::DeviceView2d<type_real> stf_table; ///< Source time function
+                                                      ///< of every source
+                                                      ///< sampled on a uniform
+                                                      ///< time grid (isample,
+                                                      ///< isource) stored on
+                                                      ///< device
+  type_real stf_table_t0 = 0.0; ///< Time of the first sample in the table
+  type_real stf_table_dt = 0.0; ///< Time between two samples in the table
+  int stf_table_nsamples = 0;   ///< Total number of samples. 0 if the source
+                                ///< time functions aren't tabulated
+  int stf_table_start = 0; ///< Sample stored in the first row of stf_table
   /**
    * @brief Default constructor
    *
@@ -198,35 +515,158 @@ struct sources {
    * @param quadx Quarature object in x dimension
    * @param quadz Quadrature object in z dimension
    * @param mpi Pointer to the MPI object
+   * @param wave Wave type simulated by the domain
+   * @param shots Shot of every source when several shots are simulated
+   * together. Every source belongs to shot 0 if empty
+   * @param is_on_the_axis Elements on the axis of axisymmetric simulations
+   * (nspec), empty otherwise. Sources of axial elements are interpolated at
+   * the GLJ points, and every source is divided by 2 pi since the
+   * axisymmetric weak form is integrated over the meridional plane only
    */
   sources(const std::vector<specfem::sources::source *> &sources,
           const specfem::quadrature::quadrature &quadx,
           const specfem::quadrature::quadrature &quadz, const type_real xmax,
           const type_real xmin, const type_real zmax, const type_real zmin,
-          specfem::MPI::MPI *mpi);
+          specfem::MPI::MPI *mpi,
+          const specfem::wave::type wave = specfem::wave::p_sv,
+          const std::vector<int> &shots = {},
+          const specfem::kokkos::HostView1d<bool> is_on_the_axis = {});
   /**
    * @brief Helper routine to sync views within this struct
    *
    */
   void sync_views();
+  /**
+   * @brief Free the host mirrors once the device views are assigned
+   *
+   * Host mirrors are only read while the domain is set up. sync_views can't
+   * be called afterwards
+   *
+   */
+  void release_host_mirrors();
+  /**
+   * @brief Get the memory allocated by the views of this struct
+   *
+   */
+  specfem::memory::usage memory_usage() const;
+  /**
+   * @brief Sample the source time function of every source on a uniform time
+   * grid
+   *
+   * The table is streamed in chunks of rows when nsamples * nsources exceeds
+   * max_table_size. Only the first chunk is computed here
+   *
+   * @param t0 Time of the first sample
+   * @param dt Time between two samples
+   * @param nsamples Total number of samples
+   * @param max_table_size Maximum number of values stored on the device
+   */
+  void tabulate_stf(const type_real t0, const type_real dt, const int nsamples,
+                    const int max_table_size = 1 << 24);
+  /**
+   * @brief Check if the source time functions are tabulated
+   *
+   */
+  bool stf_tabulated() const { return (this->stf_table_nsamples > 0); }
+  /**
+   * @brief Check if the whole source time function table is stored on the
+   * device
+   *
+   */
+  bool stf_table_resident() const {
+    return (this->stf_table.extent(0) == this->stf_table_nsamples);
+  }
+  /**
+   * @brief Stream the chunk of the table used to interpolate the source time
+   * functions at time t to the device
+   *
+   * Does nothing if the chunk is already stored on the device
+   *
+   * @param t Simulation time
+   */
+  void update_stf_table(const type_real t);
+
+private:
+  /**
+   * @brief Compute the rows of the chunk starting at sample istart
+   *
+   * @param istart First sample stored in the chunk
+   */
+  void compute_stf_table(const int istart);
 };
 
+/**
+ * @brief Find the samples used to linearly interpolate a tabulated source time
+ * function at time t
+ *
+ * Times outside the table are clamped to the first or the last sample
+ *
+ * @param t Simulation time
+ * @param t0 Time of the first sample in the table
+ * @param dt Time between two samples in the table
+ * @param nsamples Total number of samples in the table
+ * @param weight Interpolation weight of sample isample + 1
+ * @return int isample such that t lies in [isample, isample + 1]
+ */
+KOKKOS_INLINE_FUNCTION
+int stf_table_sample(const type_real t, const type_real t0, const type_real dt,
+                     const int nsamples, type_real &weight) {
+  const type_real s = (t - t0) / dt;
+  if (s <= 0.0) {
+    weight = 0.0;
+    return 0;
+  }
+  if (s >= static_cast<type_real>(nsamples - 1)) {
+    weight = 1.0;
+    return nsamples - 2;
+  }
+  const int isample = static_cast<int>(s);
+  weight = s - static_cast<type_real>(isample);
+  return isample;
+}
+
+/**
+ * @brief Get the decimated seismogram sample computed from a recorded sample
+ *
+ * The anti-alias filter is centered, hence decimated sample isample is
+ * computed once recorded sample isample * decimation + delay is available
+ *
+ * @param isig_step Index of the recorded sample
+ * @param decimation Number of recorded samples between decimated samples
+ * @param delay Half width of the anti-alias filter in recorded samples
+ * @return int Index of the decimated sample, -1 if no sample is computed
+ */
+KOKKOS_INLINE_FUNCTION
+int decimated_sample(const int isig_step, const int decimation,
+                     const int delay) {
+  if (isig_step < delay || (isig_step - delay) % decimation != 0)
+    return -1;
+  return (isig_step - delay) / decimation;
+}
+
 /**
  * @brief This struct is used to store receiver arrays required to interpolate
  * fields during seismogram calculations
  *
  */
 struct receivers {
-  specfem::kokkos::DeviceView4d<type_real> receiver_array; ///< Array to store
-                                                           ///< lagrange
-                                                           ///< interpolants for
-                                                           ///< receivers on the
-                                                           ///< device
-  specfem::kokkos::HostMirror4d<type_real> h_receiver_array; ///< Array to store
-                                                             ///< lagrange
-                                                             ///< interpolants
-                                                             ///< for sources
-                                                             ///< stored on host
+  specfem::kokkos::DeviceView2d<type_real> hxir; ///< Lagrange interpolants
+                                                 ///< along x of every
+                                                 ///< receiver (irec, ix)
+                                                 ///< stored on device. The
+                                                 ///< weight of a quadrature
+                                                 ///< point is hxir(irec, ix)
+                                                 ///< * hgammar(irec, iz)
+  specfem::kokkos::HostMirror2d<type_real> h_hxir; ///< Lagrange interpolants
+                                                   ///< along x stored on host
+  specfem::kokkos::DeviceView2d<type_real> hgammar; ///< Lagrange
+                                                    ///< interpolants along z
+                                                    ///< of every receiver
+                                                    ///< (irec, iz) stored on
+                                                    ///< device
+  specfem::kokkos::HostMirror2d<type_real> h_hgammar; ///< Lagrange
+                                                      ///< interpolants along
+                                                      ///< z stored on host
   specfem::kokkos::DeviceView1d<int> ispec_array;   ///< Spectral element number
                                                     ///< where the source lies
                                                     ///< stored on device
@@ -249,24 +689,33 @@ struct receivers {
                                                        ///< to rotate receiver
                                                        ///< components stored on
                                                        ///< host
-  specfem::kokkos::DeviceView5d<type_real> field;      ///< Container to store
-                                                  ///< spectral element field
-                                                  ///< used in computing
-                                                  ///< seismograms stored on the
-                                                  ///< device
-  specfem::kokkos::DeviceView4d<type_real> seismogram; ///< Container to store
-                                                       ///< computed seismograms
-                                                       ///< stored on the device
-  specfem::kokkos::HostMirror4d<type_real> h_seismogram; ///< Container to store
-                                                         ///< computed
-                                                         ///< seismograms stored
-                                                         ///< on the device
+  specfem::kokkos::DeviceReceiverView4d<type_real>
+      seismogram; ///< Ring buffer storing computed seismograms on the device.
+                  ///< Sample n is stored in slot n % extent(0)
+  specfem::kokkos::HostReceiverMirror4d<type_real>
+      h_seismogram; ///< Container to store computed seismograms on the host.
+                    ///< Allocated by sync_seismograms
   specfem::kokkos::DeviceView1d<specfem::seismogram::type>
       seismogram_types; ///< Types of seismograms to be calculated stored on the
                         ///< device
   specfem::kokkos::HostMirror1d<specfem::seismogram::type>
       h_seismogram_types; ///< Types of seismograms to be calculated stored on
                           ///< the host
+  int max_sig_step = 0;   ///< Total number of seismogram samples written
+  int decimation = 1;     ///< Number of recorded samples between written
+                          ///< samples
+  specfem::kokkos::DeviceView1d<type_real> filter; ///< Coefficients of the
+                                                   ///< anti-alias filter
+                                                   ///< applied before
+                                                   ///< decimation stored on
+                                                   ///< device
+  specfem::kokkos::HostMirror1d<type_real> h_filter; ///< Coefficients of the
+                                                     ///< anti-alias filter
+                                                     ///< stored on host
+  specfem::kokkos::DeviceReceiverView4d<type_real>
+      history; ///< Ring buffer of the last recorded samples filtered by the
+               ///< anti-alias filter (islot, isigtype, irec, icomp). Not
+               ///< allocated without decimation
 
   /**
    * @brief Default constructor
@@ -276,18 +725,61 @@ struct receivers {
   /**
    * @brief Constructor to allocate and assign views
    *
-   * @param receivers Pointer to receivers objects read from sources file
+   * @param receivers Stations read from stations file
    * @param stypes Types of seismograms to be written
    * @param quadx Quarature object in x dimension
    * @param quadz Quadrature object in z dimension
+   * @param nsig_steps Total number of recorded seismogram samples
    * @param mpi Pointer to the MPI object
+   * @param buffer_size Number of samples stored on the device. Samples are
+   * stored in a ring buffer if it's smaller than max_sig_step. 0 stores every
+   * sample
+   * @param decimation Number of recorded samples between written samples.
+   * Recorded samples are low-pass filtered before they are decimated
+   * @param is_on_the_axis Elements on the axis of axisymmetric simulations
+   * (nspec), empty otherwise. Receivers of axial elements are interpolated
+   * at the GLJ points
    */
-  receivers(const std::vector<specfem::receivers::receiver *> &receivers,
+  receivers(const specfem::receivers::receiver_set &receivers,
             const std::vector<specfem::seismogram::type> &stypes,
             const specfem::quadrature::quadrature &quadx,
             const specfem::quadrature::quadrature &quadz, const type_real xmax,
             const type_real xmin, const type_real zmax, const type_real zmin,
-            const int max_sig_step, specfem::MPI::MPI *mpi);
+            const int nsig_steps, specfem::MPI::MPI *mpi,
+            const int buffer_size = 0, const int decimation = 1,
+            const specfem::kokkos::HostView1d<bool> is_on_the_axis = {});
+  /**
+   * @brief Get the half width of the anti-alias filter
+   *
+   * @return int Number of recorded samples between a written sample and the
+   * last recorded sample it depends on
+   */
+  int filter_delay() const {
+    return this->filter.is_allocated() ? (this->filter.extent(0) - 1) / 2 : 0;
+  }
+  /**
+   * @brief Get the fields read by the seismogram types
+   *
+   * @return int Bit 1 << type set for every recorded
+   * specfem::seismogram::type
+   */
+  int seismogram_fields() const {
+    int fields = 0;
+    for (int isigtype = 0; isigtype < this->h_seismogram_types.extent(0);
+         isigtype++)
+      fields |= 1 << this->h_seismogram_types(isigtype);
+    return fields;
+  }
+  /**
+   * @brief Get the written sample computed from a recorded sample
+   *
+   * @param isig_step Index of the recorded sample
+   * @return int Index of the written sample, -1 if no sample is written
+   */
+  int written_sample(const int isig_step) const {
+    return specfem::compute::decimated_sample(isig_step, this->decimation,
+                                              this->filter_delay());
+  }
   /**
    * @brief Sync views within this struct from host to device
    *
@@ -299,8 +791,23 @@ struct receivers {
   /**
    * @brief Sync calculated seismogram from device to the host
    *
+   * The host mirror of the seismograms is allocated by the first call
+   *
    */
   void sync_seismograms();
+  /**
+   * @brief Free the host mirrors once the device views are assigned
+   *
+   * Seismogram types stay on the host for the writers. sync_views can't be
+   * called afterwards
+   *
+   */
+  void release_host_mirrors();
+  /**
+   * @brief Get the memory allocated by the views of this struct
+   *
+   */
+  specfem::memory::usage memory_usage() const;
 };
 
 struct coordinates {
@@ -322,15 +829,83 @@ struct coordinates {
   ///@}
 };
 
+/**
+ * @brief Device accessor of the global numbering
+ *
+ * Compressed numbering stores explicit global numbers only for the edge and
+ * corner points of every element. Interior points of an element are numbered
+ * consecutively from interior_base(ispec) in (iz, ix) order. Kernels read
+ * ibool(ispec, iz, ix) in both cases
+ *
+ */
+struct connectivity_accessor {
+  specfem::kokkos::DeviceElementView3d<int> ibool; ///< Global number for
+                                                   ///< every quadrature point
+  specfem::kokkos::DeviceView2d<int> boundary; ///< Global number of edge and
+                                               ///< corner points (ispec,
+                                               ///< boundary_index)
+  specfem::kokkos::DeviceView1d<int> interior_base; ///< Global number of the
+                                                    ///< first interior point
+                                                    ///< of every element
+  int ngllz; ///< Number of quadrature points in z dimension
+  int ngllx; ///< Number of quadrature points in x dimension
+  bool compressed; ///< If true the compressed numbering is read
+
+  /**
+   * @brief Index of an edge or corner point in boundary
+   *
+   * Points of the first row, the first and last points of interior rows and
+   * points of the last row are stored in that order
+   *
+   */
+  KOKKOS_INLINE_FUNCTION
+  static int boundary_index(const int iz, const int ix, const int ngllz,
+                            const int ngllx) {
+    if (iz == 0)
+      return ix;
+    if (iz == ngllz - 1)
+      return ngllx + 2 * (ngllz - 2) + ix;
+    return ngllx + 2 * (iz - 1) + ((ix == 0) ? 0 : 1);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  int operator()(const int ispec, const int iz, const int ix) const {
+    if (!this->compressed)
+      return this->ibool(ispec, iz, ix);
+
+    if (iz == 0 || iz == this->ngllz - 1 || ix == 0 || ix == this->ngllx - 1)
+      return this->boundary(
+          ispec, boundary_index(iz, ix, this->ngllz, this->ngllx));
+
+    return this->interior_base(ispec) + (iz - 1) * (this->ngllx - 2) +
+           (ix - 1);
+  }
+};
+
 struct compute {
-  specfem::kokkos::DeviceView3d<int> ibool;   ///< Global number for every
-                                              ///< quadrature point stored on
-                                              ///< device
-  specfem::kokkos::HostMirror3d<int> h_ibool; ///< Global number for every
-                                              ///< quadrature point stored on
-                                              ///< host
+  specfem::kokkos::DeviceElementView3d<int>
+      ibool; ///< Global number for every quadrature point stored on device
+  specfem::kokkos::HostElementMirror3d<int>
+      h_ibool; ///< Global number for every quadrature point stored on host
   specfem::compute::coordinates coordinates;  ///< Cartesian coordinates and
                                               ///< related meta-data
+  specfem::kokkos::DeviceView2d<int> boundary; ///< Global number of edge
+                                               ///< and corner points of
+                                               ///< every element. Only
+                                               ///< allocated by
+                                               ///< compress_connectivity
+  specfem::kokkos::DeviceView1d<int> interior_base; ///< Global number of the
+                                                    ///< first interior point
+                                                    ///< of every element
+  specfem::kokkos::DeviceView2d<int>
+      structured_tiles; ///< Global number of the first point, row stride and
+                        ///< parity of every element in its structured tile
+                        ///< (nspec, 3). The stride is 0 for elements outside
+                        ///< structured blocks. Only allocated by
+                        ///< assign_structured_blocks
+  specfem::kokkos::HostMirror2d<int>
+      h_structured_tiles; ///< Structured tiles of every element stored on
+                          ///< host
   /**
    * @brief Default constructor
    *
@@ -361,6 +936,86 @@ struct compute {
    *
    */
   void sync_views();
+  /**
+   * @brief Get the memory allocated by the views of this struct
+   *
+   * The global numbering stays on the host for the writers
+   *
+   */
+  specfem::memory::usage memory_usage() const;
+  /**
+   * @brief Renumber global points such that interior points of every element
+   * are consecutive and store the compressed numbering
+   *
+   * Elements are visited in order. Edge and corner points are numbered at
+   * their first appearance, followed by the interior points of the element.
+   * ibool, h_ibool and coordinates are renumbered, hence this needs to be
+   * called before global numbers are used by other structs
+   *
+   * @return bool false, leaving the numbering unchanged, if an interior point
+   * is shared by several elements or if elements have no interior points
+   */
+  bool compress_connectivity();
+  /**
+   * @brief Check if the compressed numbering is stored
+   *
+   */
+  bool compressed() const { return this->interior_base.is_allocated(); }
+  /**
+   * @brief Detect logically structured blocks of elements and renumber their
+   * global points as dense tiles
+   *
+   * Blocks are rectangles of elements found by walking the right and top
+   * neighbors of every element, given by shared corner control nodes. Points
+   * of a block are numbered row after row across the whole block, hence the
+   * global number of point (iz, ix) of an element of a block is origin + iz
+   * * stride + ix. Blocks don't share points, a block touching the tile of a
+   * previous block is rejected. Remaining points keep their relative order
+   * after the tiles. ibool, h_ibool and coordinates are renumbered, hence
+   * this needs to be called before global numbers are used by other structs
+   *
+   * @param knods Global control element number for every control node
+   * @return std::tuple<int, int> Number of blocks and number of elements in
+   * blocks
+   */
+  std::tuple<int, int>
+  assign_structured_blocks(const specfem::kokkos::HostView2d<int> knods);
+  /**
+   * @brief Move the points of the elements on the axis of axisymmetric
+   * simulations to their Gauss-Lobatto-Jacobi points
+   *
+   * Only points inside the edges along xi move. They are shared with other
+   * elements on the axis only, hence the global numbering is unchanged
+   *
+   * @param coorg (x,z) for every spectral element control node
+   * @param knods Global control element number for every control node
+   * @param is_on_the_axis True for every element on the axis (nspec)
+   * @param quadglj GLJ quadrature in x dimension
+   * @param quadz Quadrature object in z dimension
+   */
+  void
+  assign_axial_elements(const specfem::kokkos::HostView2d<type_real> coorg,
+                        const specfem::kokkos::HostView2d<int> knods,
+                        const specfem::kokkos::HostView1d<bool> is_on_the_axis,
+                        const specfem::quadrature::quadrature &quadglj,
+                        const specfem::quadrature::quadrature &quadz);
+  /**
+   * @brief Check if structured tiles are stored
+   *
+   */
+  bool structured() const { return this->structured_tiles.is_allocated(); }
+  /**
+   * @brief Get the device accessor of the global numbering
+   *
+   */
+  specfem::compute::connectivity_accessor get_ibool() const {
+    return { this->ibool,
+             this->boundary,
+             this->interior_base,
+             static_cast<int>(this->ibool.extent(1)),
+             static_cast<int>(this->ibool.extent(2)),
+             this->compressed() };
+  }
 };
 
 } // namespace compute
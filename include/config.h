@@ -1,7 +1,49 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
-using type_real = float;
+namespace specfem {
+/**
+ * @brief Floating point precision policy
+ *
+ * @tparam Storage Datatype used to store fields, geometry and material
+ * properties
+ * @tparam Accumulate Datatype used to accumulate stiffness contractions and
+ * time scheme updates
+ */
+template <typename Storage, typename Accumulate> struct precision_policy {
+  using storage_type = Storage;       ///< Storage datatype
+  using accumulate_type = Accumulate; ///< Accumulation datatype
+};
+
+namespace precision {
+using single = precision_policy<float, float>;   ///< Pure single precision
+using full = precision_policy<double, double>;   ///< Pure double precision
+using mixed = precision_policy<float, double>;   ///< float storage, double
+                                                 ///< accumulation
+} // namespace precision
+
+/**
+ * @brief Precision policy selected at configure time using -DPRECISION=
+ *
+ * Every struct stores type_real, hence a build runs a single policy. Runs
+ * can request a policy with simulation-setup.precision, which is checked
+ * against precision_name
+ *
+ */
+#if defined(SPECFEM_PRECISION_DOUBLE)
+using precision_type = precision::full;
+constexpr const char *precision_name = "double"; ///< Value of -DPRECISION
+#elif defined(SPECFEM_PRECISION_MIXED)
+using precision_type = precision::mixed;
+constexpr const char *precision_name = "mixed"; ///< Value of -DPRECISION
+#else
+using precision_type = precision::single;
+constexpr const char *precision_name = "float"; ///< Value of -DPRECISION
+#endif
+} // namespace specfem
+
+using type_real = specfem::precision_type::storage_type;
+using type_accum = specfem::precision_type::accumulate_type;
 const static int ndim{ 2 };
 const static int fint{ 4 }, fdouble{ 8 }, fbool{ 4 }, fchar{ 512 };
 const static bool use_best_location{ true };
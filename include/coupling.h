@@ -0,0 +1,122 @@
+#ifndef COUPLING_H
+#define COUPLING_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/domain.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/memory_report.h"
+#include "../include/quadrature.h"
+#include "../include/surfaces.h"
+
+namespace specfem {
+/**
+ * @brief Coupling between domains simulating different media
+ *
+ */
+namespace coupling {
+
+/**
+ * @brief Coupling of an acoustic and an elastic domain along fluid-solid
+ * edges
+ *
+ * The normal displacement of the solid is continuous across the edges, and
+ * the solid is loaded by the pressure of the fluid. Every quadrature point of
+ * an edge stores the normal pointing out of the fluid scaled by the
+ * integration weight of the edge, hence
+ *
+ * - the fluid kernel adds (weighted normal . displacement) of the solid to
+ *   the second derivative of the potential before its mass matrix division,
+ * - the solid kernel adds -(weighted normal) * (second derivative of the
+ *   potential), i.e. the pressure times the weighted normal, to the
+ *   acceleration of the solid before its mass matrix division.
+ *
+ * The fluid kernel reads the predicted displacement of the solid and the
+ * solid kernel reads the corrected second derivative of the potential,
+ * which orders the updates of the two domains within a timestep.
+ */
+class fluid_solid {
+
+public:
+  /**
+   * @brief Construct the quadrature points of the fluid-solid edges
+   *
+   * The edge of every pair of elements is the side of the acoustic element
+   * whose corners are control nodes of the elastic element. Normals are
+   * computed from the derivatives of the coordinates along the edge
+   *
+   * @param edges Acoustic and elastic element of every edge
+   * @param knods Control nodes of every spectral element
+   * @param compute Pointer to the struct storing the global numbering and
+   * coordinates
+   * @param quadx Quadrature object in x dimension
+   * @param quadz Quadrature object in z dimension
+   * @param fluid Pointer to the acoustic domain
+   * @param solid Pointer to the elastic domain
+   * @param nshots Number of shots stored in the fields of both domains
+   */
+  fluid_solid(const specfem::surfaces::fluid_solid_edges &edges,
+              const specfem::kokkos::HostView2d<int> knods,
+              const specfem::compute::compute *compute,
+              const specfem::quadrature::quadrature *quadx,
+              const specfem::quadrature::quadrature *quadz,
+              specfem::Domain::Acoustic *fluid, specfem::Domain::Elastic *solid,
+              const int nshots);
+  /**
+   * @brief Add the normal displacement of the solid to the second
+   * derivative of the potential of the fluid
+   *
+   * @param exec_space Execution space instance used to launch the kernel
+   */
+  void compute_fluid_coupling(const specfem::kokkos::DevExecSpace &exec_space =
+                                  specfem::kokkos::DevExecSpace()) const;
+  /**
+   * @brief Add the pressure of the fluid to the acceleration of the solid
+   *
+   * @param exec_space Execution space instance used to launch the kernel
+   */
+  void compute_solid_coupling(const specfem::kokkos::DevExecSpace &exec_space =
+                                  specfem::kokkos::DevExecSpace()) const;
+  /**
+   * @brief Number of quadrature points on the fluid-solid edges
+   *
+   * @return int Number of edge points, points shared by two edges are
+   * counted once for every edge
+   */
+  int get_npoints() const { return this->npoints; }
+  /**
+   * @brief Get the weighted normals of the edge points on the host
+   *
+   * @return specfem::kokkos::HostMirror2d<type_real> (point, component) normal
+   * pointing out of the fluid scaled by the integration weight
+   */
+  specfem::kokkos::HostMirror2d<type_real> get_host_normal() const {
+    return this->h_normal;
+  }
+  /**
+   * @brief Memory used by the views of the edge points
+   *
+   * @return specfem::memory::usage Bytes allocated on the device and the host
+   */
+  specfem::memory::usage memory_usage() const;
+
+private:
+  int npoints; ///< Number of edge points
+  int nshots;  ///< Number of shots stored in the fields
+  const specfem::Domain::Acoustic *fluid; ///< Acoustic domain
+  const specfem::Domain::Elastic *solid;  ///< Elastic domain
+  specfem::kokkos::DeviceView1d<int> fluid_index; ///< Acoustic number of
+                                                  ///< every edge point
+  specfem::kokkos::DeviceView1d<int> solid_index; ///< Global number of every
+                                                  ///< edge point
+  specfem::kokkos::DeviceView2d<type_real> normal; ///< Weighted normal of
+                                                   ///< every edge point
+  specfem::kokkos::HostMirror2d<type_real> h_normal; ///< Weighted normal of
+                                                     ///< every edge point on
+                                                     ///< the host
+};
+
+} // namespace coupling
+} // namespace specfem
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef COURANT_H
+#define COURANT_H
+
+#include "../include/kokkos_abstractions.h"
+#include <string>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Routines used to estimate the maximum stable time step of the
+ * explicit Newmark time scheme
+ *
+ */
+namespace courant {
+
+/**
+ * @brief Maximum Courant number for which the Newmark time scheme is stable
+ * on spectral elements, measured using the minimum distance between adjacent
+ * GLL points
+ *
+ */
+constexpr type_real courant_number_max = 0.5;
+
+/**
+ * @brief Maximum stable time step of the mesh and the elements limiting it
+ *
+ */
+struct stable_timestep {
+  type_real dt;                        ///< Maximum stable time step
+  std::vector<int> limiting_elements;  ///< Elements with the smallest stable
+                                       ///< time step sorted in ascending order
+                                       ///< of time step
+  std::vector<type_real> element_dt;   ///< Stable time step of every limiting
+                                       ///< element
+  std::vector<type_real> element_vmax; ///< Maximum wave speed inside every
+                                       ///< limiting element
+  std::vector<type_real> element_dmin; ///< Minimum distance between adjacent
+                                       ///< GLL points of every limiting
+                                       ///< element
+  std::vector<type_real> spectral_element_dt; ///< Stable time step of every
+                                              ///< spectral element (nspec)
+
+  /**
+   * @brief Log stable time step information
+   *
+   * @return std::string Message describing the stable time step and the
+   * elements limiting it
+   */
+  std::string print() const;
+};
+
+/**
+ * @brief Compute the maximum stable time step of the Newmark time scheme
+ *
+ * The stable time step of an element is courant_number_max times the minimum
+ * distance between adjacent GLL points divided by the maximum wave speed
+ * inside the element
+ *
+ * @param coord (x, z) for every distinct quadrature point
+ * @param ibool Global number for every quadrature point
+ * @param rho Density at every quadrature point
+ * @param rho_vp \f$ \rho v_p \f$ at every quadrature point
+ * @param rho_vs \f$ \rho v_s \f$ at every quadrature point
+ * @param nreport Number of limiting elements to report
+ * @return stable_timestep Maximum stable time step of the mesh
+ */
+stable_timestep compute_stable_timestep(
+    const specfem::kokkos::HostView2d<type_real> coord,
+    const specfem::kokkos::HostElementMirror3d<int> ibool,
+    const specfem::kokkos::HostElementMirror3d<type_real> rho,
+    const specfem::kokkos::HostElementView3d<type_real> rho_vp,
+    const specfem::kokkos::HostElementView3d<type_real> rho_vs,
+    const int nreport = 5);
+
+/**
+ * @brief Bin spectral elements into local time stepping levels
+ *
+ * Elements of level p are stepped with dt / 2^p. The level of an element is
+ * the smallest p such that dt / 2^p is lower than or equal to the stable time
+ * step of the element
+ *
+ * @param element_dt Stable time step of every spectral element
+ * @param dt Time step of the coarsest level
+ * @param max_levels Maximum number of levels
+ * @return std::vector<int> Level of every spectral element
+ */
+std::vector<int>
+compute_element_levels(const std::vector<type_real> &element_dt,
+                       const type_real dt, const int max_levels);
+
+} // namespace courant
+} // namespace specfem
+
+#endif
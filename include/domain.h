@@ -1,14 +1,190 @@
 #ifndef DOMAIN_H
 #define DOMAIN_H
 
+#include "../include/attenuation.h"
+#include "../include/autotune.h"
+#include "../include/boundaries.h"
 #include "../include/compute.h"
 #include "../include/config.h"
+#include "../include/enums.h"
+#include "../include/first_touch.h"
+#include "../include/injection.h"
+#include "../include/memory_report.h"
+#include "../include/mpi_interfaces.h"
+#include "../include/pml.h"
 #include "../include/quadrature.h"
+#include "../include/stacey.h"
+#include "../include/timers.h"
 #include <Kokkos_Core.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace specfem {
 namespace Domain {
 
+/**
+ * @brief Runtime options used to select the implementation of domain kernels
+ *
+ */
+struct options {
+  specfem::assembly::type assembly =
+      specfem::assembly::atomic; ///< Strategy used to assemble element
+                                 ///< contributions into global arrays
+  bool packed_element_data = false; ///< If true store geometry and material
+                                    ///< properties in a single element
+                                    ///< contiguous block ordered as elements
+                                    ///< of the domain
+  bool quantized_element_data = false; ///< If true packed element data is
+                                       ///< stored as 16 bit integers scaled
+                                       ///< for every element and field.
+                                       ///< Implies packed_element_data
+
+  specfem::wave::type wave = specfem::wave::p_sv; ///< Wave type simulated by
+                                                  ///< the domain. SH domains
+                                                  ///< store a single field
+                                                  ///< component
+  bool autotune = false; ///< If true tune team sizes and scratch levels of
+                         ///< team kernels during the first steps of the run
+  std::string autotune_cache = ""; ///< File used to store tuned
+                                   ///< configurations between runs. Not
+                                   ///< stored if empty
+  bool compressed_connectivity = false; ///< If true global points are
+                                        ///< renumbered such that kernels
+                                        ///< read explicit global numbers
+                                        ///< only for edge and corner points
+  bool structured_blocks = false; ///< If true rectangular blocks of inner
+                                  ///< elements are computed by a kernel
+                                  ///< indexing their global points without
+                                  ///< the global numbering
+  bool active_elements = false; ///< If true stiffness kernels are only
+                                ///< launched on elements with a displaced
+                                ///< quadrature point
+  bool host_offload = false; ///< If true a fraction of the inner elements is
+                             ///< computed on the host execution space while
+                             ///< device kernels run. Ignored on host backends
+  type_real host_fraction = -1.0; ///< Fraction of the elements computed on
+                                  ///< the host with host_offload. Calibrated
+                                  ///< at startup if negative
+  int nshots = 1; ///< Number of independent shots simulated together on the
+                  ///< mesh. Stiffness kernels load geometry and material
+                  ///< properties once for every shot
+  bool reference_kernels = false; ///< If true stiffness kernels are the
+                                  ///< runtime sized reference kernels
+                                  ///< instead of kernels specialized for
+                                  ///< the number of GLL points
+  bool host_lanes = true; ///< If true specialized stiffness kernels on host
+                          ///< backends process elements interleaved into
+                          ///< SIMD lanes instead of one element per team
+  bool batched_contractions = false; ///< If true specialized stiffness
+                                     ///< kernels compute the contractions
+                                     ///< of every team as batched products
+                                     ///< of zero padded tiles
+  bool assembled_operator = false; ///< If true the stiffness interaction is
+                                   ///< assembled into a sparse matrix at
+                                   ///< setup and applied as a sparse
+                                   ///< matrix-vector product
+};
+
+/**
+ * @brief Check if domain kernels are executed on a host backend
+ *
+ * @return constexpr bool true if device memory space is accessible from host
+ */
+constexpr bool host_backend() {
+  return Kokkos::SpaceAccessibility<Kokkos::HostSpace,
+                                    specfem::kokkos::DevMemSpace>::accessible;
+}
+
+/**
+ * @brief Number of spectral elements interleaved into SIMD lanes by the host
+ * stiffness kernel
+ *
+ * Lanes of a 512 bit vector register
+ *
+ * @tparam T Datatype stored in lanes
+ * @return constexpr int Number of lanes
+ */
+template <typename T> constexpr int simd_lanes() { return 64 / sizeof(T); }
+
+/**
+ * @brief Number of spectral elements processed by a single team of the NGLL
+ * specialized stiffness kernel
+ *
+ * On device backends elements are batched such that a team has about 128
+ * threads, one per quadrature point. On host backends a team is executed by a
+ * single thread, hence one element per team is used.
+ *
+ * @tparam NGLL Number of GLL points in x and z dimensions
+ * @return constexpr int Number of elements per team
+ */
+template <int NGLL> constexpr int elements_per_team() {
+  if (specfem::Domain::host_backend())
+    return 1;
+
+  constexpr int nelem = 128 / (NGLL * NGLL);
+  return (nelem > 1) ? nelem : 1;
+}
+
+/**
+ * @brief States of spectral elements when stiffness kernels are only launched
+ * on active elements
+ *
+ */
+namespace active {
+enum state {
+  inactive = 0, ///< Every quadrature point of the element is at rest
+  active = 1,   ///< Element is computed by stiffness kernels
+  settled = 2   ///< Element and all its neighbors are active
+};
+} // namespace active
+
+/**
+ * @brief Fields stored inside packed element data block
+ *
+ */
+namespace packed {
+enum field {
+  xix,           ///< \f$ \partial \xi / \partial x \f$
+  xiz,           ///< \f$ \partial \xi / \partial z \f$
+  gammax,        ///< \f$ \partial \gamma / \partial x \f$
+  gammaz,        ///< \f$ \partial \gamma / \partial z \f$
+  jacobian,      ///< Jacobian
+  mu,            ///< \f$ \mu \f$
+  lambdaplus2mu, ///< \f$ \lambda + 2 \mu \f$
+  nfields        ///< Number of packed fields
+};
+
+/**
+ * @brief Device accessor of packed element data
+ *
+ * Quantized element data stores value / scale(ielement, ifield) rounded to
+ * 16 bit integers. Values are widened to type_real when they are read.
+ * Kernels read data(ielement, ifield, iz, ix) in both cases
+ *
+ */
+struct element_data_accessor {
+  specfem::kokkos::DeviceView4d<type_real> values; ///< Full precision packed
+                                                   ///< element data
+  specfem::kokkos::DeviceView4d<std::int16_t> quantized; ///< Quantized
+                                                         ///< packed element
+                                                         ///< data
+  specfem::kokkos::DeviceView2d<type_real> scale; ///< Scale of quantized
+                                                  ///< data (ielement, ifield)
+  bool quantize; ///< If true quantized data is read
+
+  KOKKOS_INLINE_FUNCTION
+  type_real operator()(const int ielement, const int ifield, const int iz,
+                       const int ix) const {
+    return this->quantize ? this->scale(ielement, ifield) *
+                                static_cast<type_real>(
+                                    this->quantized(ielement, ifield, iz, ix))
+                          : this->values(ielement, ifield, iz, ix);
+  }
+};
+} // namespace packed
+
 /**
  * @brief  Base Domain class
  *
@@ -19,86 +195,202 @@ public:
   /**
    * @brief Get a view of the field stored on the device
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * @return specfem::kokkos::DeviceFieldView2d<type_real>
    */
-  virtual specfem::kokkos::DeviceView2d<type_real> get_field() const {
+  virtual specfem::kokkos::DeviceFieldView2d<type_real> get_field() const {
     return this->field;
   }
   /**
    * @brief Get a view of the field stored on the host
    *
-   * @return specfem::kokkos::HostMirror2d<type_real>
+   * @return specfem::kokkos::HostFieldMirror2d<type_real>
    */
-  virtual specfem::kokkos::HostMirror2d<type_real> get_host_field() const {
+  virtual specfem::kokkos::HostFieldMirror2d<type_real> get_host_field() const {
     return this->h_field;
   }
   /**
    * @brief Get a view of the derivative of field stored on the device
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * @return specfem::kokkos::DeviceFieldView2d<type_real>
    */
-  virtual specfem::kokkos::DeviceView2d<type_real> get_field_dot() const {
+  virtual specfem::kokkos::DeviceFieldView2d<type_real> get_field_dot() const {
     return this->field_dot;
   }
   /**
    * @brief Get a view of the derivative of field stored on the host
    *
-   * @return specfem::kokkos::HostMirror2d<type_real>
+   * @return specfem::kokkos::HostFieldMirror2d<type_real>
    */
-  virtual specfem::kokkos::HostMirror2d<type_real> get_host_field_dot() const {
+  virtual specfem::kokkos::HostFieldMirror2d<type_real>
+  get_host_field_dot() const {
     return this->h_field_dot;
   }
   /**
    * @brief Get a view of the second derivative of field stored on the Device
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * @return specfem::kokkos::DeviceFieldView2d<type_real>
    */
-  virtual specfem::kokkos::DeviceView2d<type_real> get_field_dot_dot() const {
+  virtual specfem::kokkos::DeviceFieldView2d<type_real>
+  get_field_dot_dot() const {
     return this->field_dot_dot;
   }
   /**
    * @brief Get a view of the second derivative of field stored on the host
    *
-   * @return specfem::kokkos::HostMirror2d<type_real>
+   * @return specfem::kokkos::HostFieldMirror2d<type_real>
    */
-  virtual specfem::kokkos::HostMirror2d<type_real>
+  virtual specfem::kokkos::HostFieldMirror2d<type_real>
   get_host_field_dot_dot() const {
     return this->h_field_dot_dot;
   }
   /**
    * @brief Get a view of rmass_inverse stored on the device
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * @return specfem::kokkos::DeviceView1d<type_real>
    */
-  virtual specfem::kokkos::DeviceView2d<type_real> get_rmass_inverse() const {
+  virtual specfem::kokkos::DeviceView1d<type_real> get_rmass_inverse() const {
     return this->rmass_inverse;
   }
   /**
    * @brief Get a view of rmass_inverse stored on the host
    *
-   * @return specfem::kokkos::HostMirror2d<type_real>
+   * @return specfem::kokkos::HostMirror1d<type_real>
    */
-  virtual specfem::kokkos::HostMirror2d<type_real>
+  virtual specfem::kokkos::HostMirror1d<type_real>
   get_host_rmass_inverse() const {
     return this->h_rmass_inverse;
   }
+  /**
+   * @brief Get the memory allocated by the views of the domain
+   *
+   */
+  virtual specfem::memory::usage memory_usage() const { return {}; }
+  /**
+   * @brief Get the elements of every launch of the stiffness kernels, in
+   * launch order
+   *
+   * Element arrays are placed on host backends using these launches, see
+   * specfem::first_touch
+   *
+   */
+  virtual specfem::first_touch::launches get_element_launches() const {
+    return {};
+  }
+  /**
+   * @brief Get the analytic cost of one call of the kernels the domain
+   * launches in a time loop phase
+   *
+   * Costs model the reference algorithm of the kernels from the number of
+   * quadrature points and the views they touch. Attenuation, absorbing
+   * boundaries and the reuse of views in caches are not modelled
+   *
+   * @param phase Time loop phase: stiffness, sources or seismograms
+   * @return specfem::timers::cost Bytes and flops of the kernels. Zero for
+   * phases without domain kernels
+   */
+  virtual specfem::timers::cost
+  get_cost(const specfem::timers::phase phase) const {
+    return {};
+  }
   /**
    * @brief Compute interaction of stiffness matrix on second derivative of
    * field
    *
+   * Kernels are launched asynchronously on exec_space
+   *
+   * @param exec_space Execution space instance used to launch kernels
    */
-  virtual void compute_stiffness_interaction(){};
+  virtual void compute_stiffness_interaction(
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()){};
   /**
    * @brief Divide the second derivative of field by the mass matrix
    *
+   * Kernels are launched asynchronously on exec_space
+   *
+   * @param exec_space Execution space instance used to launch kernels
    */
-  virtual void divide_mass_matrix(){};
+  virtual void
+  divide_mass_matrix(const specfem::kokkos::DevExecSpace &exec_space =
+                         specfem::kokkos::DevExecSpace()){};
   /**
    * @brief Compute interaction of sources on second derivative of field
    *
+   * Kernels are launched asynchronously on exec_space
+   *
    * @param timeval
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void compute_source_interaction(
+      const type_real timeval,
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()){};
+  /**
+   * @brief Check if source interactions can be computed concurrently with
+   * stiffness interactions
+   *
+   * @return bool true if both are assembled into the second derivative of
+   * field using atomic operations
+   */
+  virtual bool concurrent_source_interaction() const { return false; }
+  /**
+   * @brief Assemble second derivative of field across MPI interfaces
+   *
+   * Has to be called once stiffness and source interactions are computed and
+   * before the second derivative of field is divided by the mass matrix
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void
+  assemble_interfaces(const specfem::kokkos::DevExecSpace &exec_space =
+                          specfem::kokkos::DevExecSpace()){};
+  /**
+   * @brief Check if the assembly across MPI interfaces can be overlapped with
+   * the stiffness interaction of inner elements
+   *
+   * @return bool true if outer elements, which contain MPI interface points,
+   * can be computed separately from inner elements
+   */
+  virtual bool overlap_interfaces() const { return false; }
+  /**
+   * @brief Compute interaction of stiffness matrix on second derivative of
+   * field for outer elements
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void compute_outer_stiffness_interaction(
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()){};
+  /**
+   * @brief Compute interaction of stiffness matrix on second derivative of
+   * field for inner elements
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void compute_inner_stiffness_interaction(
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()){};
+  /**
+   * @brief Start the assembly of second derivative of field across MPI
+   * interfaces
+   *
+   * Contributions of outer elements and sources have to be computed. Returns
+   * once values are packed and messages are posted
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void
+  start_interface_assembly(const specfem::kokkos::DevExecSpace &exec_space =
+                               specfem::kokkos::DevExecSpace()){};
+  /**
+   * @brief Wait for the messages posted by start_interface_assembly and add
+   * the received values
+   *
+   * @param exec_space Execution space instance used to launch kernels
    */
-  virtual void compute_source_interaction(const type_real timeval){};
+  virtual void
+  finish_interface_assembly(const specfem::kokkos::DevExecSpace &exec_space =
+                                specfem::kokkos::DevExecSpace()){};
 
   /**
    * @brief Sync field views between host and device
@@ -127,28 +419,186 @@ public:
   /**
    * @brief Compute seismograms at for all receivers at isig_step
    *
-   * @param seismogram_types DeviceView of types of seismograms to be calculated
+   * Kernels are launched asynchronously on exec_space
+   *
    * @param isig_step timestep for seismogram calculation
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void
+  compute_seismogram(const int isig_step,
+                     const specfem::kokkos::DevExecSpace &exec_space =
+                         specfem::kokkos::DevExecSpace()){};
+  /**
+   * @brief Record interaction of stiffness matrix on second derivative of
+   * field inside a graph
+   *
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  virtual void
+  compute_stiffness_interaction(specfem::kokkos::DeviceGraphNode &node) {
+    throw std::runtime_error(
+        "Domain wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Record interaction of sources on second derivative of field inside
+   * a graph
+   *
+   * @param timeval View containing the simulation time. The value is read
+   * every time the graph is submitted
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  virtual void compute_source_interaction(
+      const specfem::kokkos::DeviceView1d<type_real> timeval,
+      specfem::kokkos::DeviceGraphNode &node) {
+    throw std::runtime_error(
+        "Domain wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Record computation of seismograms for all receivers inside a graph
+   *
+   * @param isig_step View containing the seismogram step. The value is read
+   * every time the graph is submitted
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  virtual void
+  compute_seismogram(const specfem::kokkos::DeviceView1d<int> isig_step,
+                     specfem::kokkos::DeviceGraphNode &node) {
+    throw std::runtime_error(
+        "Domain wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Order elements of the domain by local time stepping level
+   *
+   * @param element_levels Level of every spectral element (nspec)
+   */
+  virtual void set_element_levels(const std::vector<int> &element_levels) {
+    throw std::runtime_error(
+        "Domain wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Simulate attenuation using coarse grained memory variables
+   *
+   * @param model Standard linear solids approximating a constant Q
+   * @param dt Time step of the time scheme
    */
-  virtual void compute_seismogram(const int isig_step){};
+  virtual void set_attenuation(const specfem::attenuation::model &model,
+                               const type_real dt) {
+    throw std::runtime_error(
+        "Domain wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Damp waves leaving the domain through absorbing edges using
+   * Stacey boundary conditions
+   *
+   * @param abs_boundary Absorbing edges read from the database
+   */
+  virtual void set_absorbing_boundary(
+      const specfem::boundaries::absorbing_boundary &abs_boundary) {
+    throw std::runtime_error(
+        "Domain wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Get the number of absorbing quadrature points of the domain
+   *
+   */
+  virtual int get_absorbing_npoints() const { return 0; }
+  /**
+   * @brief Absorb waves in convolutional PML layers made of the elements
+   * flagged in region_CPML
+   *
+   * @param region_CPML PML flag of every element (nspec)
+   * @param layer Extent of the PML layers
+   * @param f0 Frequency setting the frequency shift of the damping profiles
+   * @param reflection Theoretical reflection coefficient of the layers
+   * @param dt Time step of the time scheme
+   */
+  virtual void set_pml(const specfem::kokkos::HostView1d<int> region_CPML,
+                       const specfem::boundaries::pml_layer &layer,
+                       const type_real f0, const type_real reflection,
+                       const type_real dt) {
+    throw std::runtime_error(
+        "Domain wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Get the number of PML elements of the domain
+   *
+   */
+  virtual int get_pml_nelements() const { return 0; }
+  /**
+   * @brief Replace the sources and receivers of the domain
+   *
+   * @param sources Pointer to sources struct, located within the mesh
+   * @param receivers Pointer to receivers struct, located within the mesh
+   */
+  virtual void set_sources(specfem::compute::sources *sources,
+                           specfem::compute::receivers *receivers) {
+    throw std::runtime_error(
+        "Domain wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Set the fields of the domain at rest, e.g. before simulating new
+   * sources
+   *
+   */
+  virtual void reset_fields() {
+    throw std::runtime_error(
+        "Domain wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Compute interaction of stiffness matrix on second derivative of
+   * field for elements with a local time stepping level >= ilevel
+   *
+   * Kernels are launched asynchronously on exec_space
+   *
+   * @param ilevel Coarsest level of elements to compute
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void compute_level_stiffness_interaction(
+      const int ilevel, const specfem::kokkos::DevExecSpace &exec_space =
+                            specfem::kokkos::DevExecSpace()) {
+    throw std::runtime_error(
+        "Domain wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Compute interaction of sources on the second derivative of field
+   * of the global points of a local time stepping level
+   *
+   * Kernels are launched asynchronously on exec_space
+   *
+   * @param timeval Simulation time at the start of the step of the level
+   * @param point_level Level of every global point
+   * @param ilevel Level of the points to update
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void compute_level_source_interaction(
+      const type_real timeval,
+      const specfem::kokkos::DeviceView1d<int> point_level, const int ilevel,
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()) {
+    throw std::runtime_error(
+        "Domain wasn't initialized properly. Base class being called");
+  };
 
 private:
-  specfem::kokkos::DeviceView2d<type_real> field;   ///< View of field on Device
-  specfem::kokkos::HostMirror2d<type_real> h_field; ///< View of field on host
-  specfem::kokkos::DeviceView2d<type_real> field_dot; ///< View of derivative of
-                                                      ///< field on Device
-  specfem::kokkos::HostMirror2d<type_real> h_field_dot; ///< View of derivative
-                                                        ///< of field on host
-  specfem::kokkos::DeviceView2d<type_real> field_dot_dot;   ///< View of second
-                                                            ///< derivative of
-                                                            ///< field on Device
-  specfem::kokkos::HostMirror2d<type_real> h_field_dot_dot; ///< View of second
-                                                            ///< derivative of
-                                                            ///< field on host
-  specfem::kokkos::DeviceView2d<type_real> rmass_inverse;   ///< View of inverse
+  specfem::kokkos::DeviceFieldView2d<type_real> field; ///< View of field on
+                                                       ///< Device
+  specfem::kokkos::HostFieldMirror2d<type_real> h_field; ///< View of field on
+                                                         ///< host
+  specfem::kokkos::DeviceFieldView2d<type_real>
+      field_dot; ///< View of derivative of field on Device
+  specfem::kokkos::HostFieldMirror2d<type_real>
+      h_field_dot; ///< View of derivative of field on host
+  specfem::kokkos::DeviceFieldView2d<type_real>
+      field_dot_dot; ///< View of second derivative of field on Device
+  specfem::kokkos::HostFieldMirror2d<type_real>
+      h_field_dot_dot; ///< View of second derivative of field on host
+  specfem::kokkos::DeviceView1d<type_real> rmass_inverse;   ///< View of inverse
                                                           ///< of mass matrix on
                                                           ///< device
-  specfem::kokkos::HostMirror2d<type_real> h_rmass_inverse; ///< View of inverse
+  specfem::kokkos::HostMirror1d<type_real> h_rmass_inverse; ///< View of inverse
                                                             ///< of mass matrix
                                                             ///< on host
 };
@@ -163,74 +613,96 @@ private:
  * (iglob) stored as a 2D View field(iglob, idim)
  *  - field_dot_dot -> Acceleration along the 2 dimensions (idim) for every
  * global point (iglob) stored as a 2D View field(iglob, idim)
+ *
+ * When several shots are simulated together the components of shot ishot
+ * are stored in columns ishot * ncomponents + idim, where ncomponents is the
+ * number of components of a single shot. Sources add to the columns of their
+ * shot, and receivers are stored once per shot, every shot having the same
+ * number of receivers on a process.
  */
-class Elastic : public Domain {
+class Elastic final : public Domain {
 public:
   /**
    * @brief Get a view of displacement stored on the device
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * @return specfem::kokkos::DeviceFieldView2d<type_real>
    */
-  specfem::kokkos::DeviceView2d<type_real> get_field() const override {
+  specfem::kokkos::DeviceFieldView2d<type_real> get_field() const override {
     return this->field;
   }
   /**
-   * @brief Get a view of displacement stored on the hsot
+   * @brief Get a view of displacement stored on the host
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * The host mirror is allocated by the first call
+   *
+   * @return specfem::kokkos::HostFieldMirror2d<type_real>
    */
-  specfem::kokkos::HostMirror2d<type_real> get_host_field() const override {
-    return this->h_field;
+  specfem::kokkos::HostFieldMirror2d<type_real>
+  get_host_field() const override {
+    return specfem::kokkos::lazy_mirror(this->h_field, this->field);
   }
   /**
    * @brief Get a view of velocity stored on device
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * @return specfem::kokkos::DeviceFieldView2d<type_real>
    */
-  specfem::kokkos::DeviceView2d<type_real> get_field_dot() const override {
+  specfem::kokkos::DeviceFieldView2d<type_real> get_field_dot() const override {
     return this->field_dot;
   }
   /**
    * @brief Get a view of velocity stored on host
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * The host mirror is allocated by the first call
+   *
+   * @return specfem::kokkos::HostFieldMirror2d<type_real>
    */
-  specfem::kokkos::HostMirror2d<type_real> get_host_field_dot() const override {
-    return this->h_field_dot;
+  specfem::kokkos::HostFieldMirror2d<type_real>
+  get_host_field_dot() const override {
+    return specfem::kokkos::lazy_mirror(this->h_field_dot, this->field_dot);
   }
   /**
    * @brief Get a view of acceleration stored on device
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * @return specfem::kokkos::DeviceFieldView2d<type_real>
    */
-  specfem::kokkos::DeviceView2d<type_real> get_field_dot_dot() const override {
+  specfem::kokkos::DeviceFieldView2d<type_real>
+  get_field_dot_dot() const override {
     return this->field_dot_dot;
   }
   /**
    * @brief Get a view of acceleration stored on host
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * The host mirror is allocated by the first call
+   *
+   * @return specfem::kokkos::HostFieldMirror2d<type_real>
    */
-  specfem::kokkos::HostMirror2d<type_real>
+  specfem::kokkos::HostFieldMirror2d<type_real>
   get_host_field_dot_dot() const override {
-    return this->h_field_dot_dot;
+    return specfem::kokkos::lazy_mirror(this->h_field_dot_dot,
+                                        this->field_dot_dot);
   }
   /**
    * @brief Get a view of inverse of mass matrix stored on device
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * The mass matrix is identical for every component of the field, hence it
+   * is stored once for every global point
+   *
+   * @return specfem::kokkos::DeviceView1d<type_real>
    */
-  specfem::kokkos::DeviceView2d<type_real> get_rmass_inverse() const override {
+  specfem::kokkos::DeviceView1d<type_real> get_rmass_inverse() const override {
     return this->rmass_inverse;
   }
   /**
    * @brief Get a view of inverse of mass matrix stored on host
    *
-   * @return specfem::kokkos::DeviceView2d<type_real>
+   * The host mirror is allocated by the first call
+   *
+   * @return specfem::kokkos::HostMirror1d<type_real>
    */
-  specfem::kokkos::HostMirror2d<type_real>
+  specfem::kokkos::HostMirror1d<type_real>
   get_host_rmass_inverse() const override {
-    return this->h_rmass_inverse;
+    return specfem::kokkos::lazy_mirror(this->h_rmass_inverse,
+                                        this->rmass_inverse);
   }
 
   /**
@@ -258,6 +730,9 @@ public:
    * @param sources Pointer to specfem::compute::sources struct
    * @param quadx Pointer to quadrature object in x-dimension
    * @param quadx Pointer to quadrature object in z-dimension
+   * @param options Runtime options used to select domain kernels
+   * @param halo Pointer to halo used to assemble fields across MPI
+   * interfaces. Fields aren't exchanged if nullptr
    */
   Elastic(const int ndim, const int nglob, specfem::compute::compute *compute,
           specfem::compute::properties *material_properties,
@@ -265,23 +740,116 @@ public:
           specfem::compute::sources *sources,
           specfem::compute::receivers *receivers,
           specfem::quadrature::quadrature *quadx,
-          specfem::quadrature::quadrature *quadz);
+          specfem::quadrature::quadrature *quadz,
+          const specfem::Domain::options &options = {},
+          specfem::interfaces::halo *halo = nullptr);
+  /**
+   * @brief Construct a domain sharing the mesh of another domain
+   *
+   * Views of the element lists, the packed element data, the mass matrix,
+   * the attenuation coefficients and the absorbing points are shared with
+   * domain. Fields, memory variables, active elements and host buffers are
+   * allocated for this domain, hence both domains can be stepped
+   * concurrently on different execution space instances. Domains with PML
+   * layers or MPI interfaces can't be shared
+   *
+   * @param domain Domain whose mesh is shared
+   * @param sources Pointer to sources struct of this domain
+   * @param receivers Pointer to receivers struct of this domain
+   */
+  Elastic(const specfem::Domain::Elastic &domain,
+          specfem::compute::sources *sources,
+          specfem::compute::receivers *receivers);
   /**
    * @brief Compute interaction of stiffness matrix on acceleration
    *
+   * @param exec_space Execution space instance used to launch kernels
    */
-  void compute_stiffness_interaction() override;
+  void compute_stiffness_interaction(
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()) override;
   /**
    * @brief Divide the acceleration by the mass matrix
    *
+   * @param exec_space Execution space instance used to launch kernels
    */
-  void divide_mass_matrix() override;
+  void divide_mass_matrix(const specfem::kokkos::DevExecSpace &exec_space =
+                              specfem::kokkos::DevExecSpace()) override;
   /**
    * @brief Compute interaction of sources on acceleration
    *
+   * Sources inside the same element and shot are accumulated by one team in
+   * scratch memory and added to the acceleration once.
+   *
    * @param timeval
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void compute_source_interaction(
+      const type_real timeval,
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Check if source interactions can be computed concurrently with
+   * stiffness interactions
+   *
+   * @return bool true if atomic assembly is used
+   */
+  bool concurrent_source_interaction() const override {
+    return (this->assembly == specfem::assembly::atomic);
+  }
+  /**
+   * @brief Assemble acceleration across MPI interfaces
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void assemble_interfaces(const specfem::kokkos::DevExecSpace &exec_space =
+                               specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Check if the assembly across MPI interfaces can be overlapped with
+   * the stiffness interaction of inner elements
+   *
+   * Active elements are computed in activation order and aren't split
+   *
+   * @return bool true if the domain has MPI interfaces
+   */
+  bool overlap_interfaces() const override {
+    return (this->halo != nullptr && this->halo->get_nneighbors() > 0 &&
+            !this->active_elements);
+  }
+  /**
+   * @brief Compute interaction of stiffness matrix on acceleration for outer
+   * elements
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void compute_outer_stiffness_interaction(
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Compute interaction of stiffness matrix on acceleration for inner
+   * elements
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void compute_inner_stiffness_interaction(
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Pack acceleration at MPI interface points and post messages
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void start_interface_assembly(
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Wait for messages and add received accelerations
+   *
+   * @param exec_space Execution space instance used to launch kernels
    */
-  void compute_source_interaction(const type_real timeval) override;
+  void finish_interface_assembly(
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()) override;
   /**
    * @brief Sync displacements views between host and device
    *
@@ -313,62 +881,1316 @@ public:
    */
   KOKKOS_IMPL_HOST_FUNCTION
   void assign_views();
+  /**
+   * @brief Copy the fields and the mass matrix to views first touched by the
+   * threads computing their points on host backends
+   *
+   * Host mirrors are allocated again on first use
+   *
+   */
+  void place_fields();
+  /**
+   * @brief Pack geometry and material properties of every element in this
+   * domain into a single element contiguous view
+   *
+   * Elements are stored in the same order as ispec_domain, hence this needs
+   * to be called after ispec_domain is assigned. Quantized element data is
+   * scaled by the largest magnitude of every field inside every element and
+   * the full precision block is freed
+   */
+  KOKKOS_IMPL_HOST_FUNCTION
+  void assign_element_data();
+  /**
+   * @brief Get the device accessor of packed element data
+   *
+   */
+  specfem::Domain::packed::element_data_accessor get_packed_data() const {
+    return { this->element_data, this->quantized_element_data_values,
+             this->element_data_scale, this->quantized_element_data };
+  }
   /**
    * @brief Compute seismograms at for all receivers at isig_step
    *
-   * @param seismogram_types DeviceView of types of seismograms to be calculated
    * @param isig_step timestep for seismogram calculation
+   * @param exec_space Execution space instance used to launch kernels
    */
-  void compute_seismogram(const int isig_step) override;
-
-private:
-  specfem::kokkos::DeviceView2d<type_real> field;   ///< View of field on Device
-  specfem::kokkos::HostMirror2d<type_real> h_field; ///< View of field on host
-  specfem::kokkos::DeviceView2d<type_real> field_dot; ///< View of derivative of
-                                                      ///< field on Device
-  specfem::kokkos::HostMirror2d<type_real> h_field_dot; ///< View of derivative
-                                                        ///< of field on host
-  specfem::kokkos::DeviceView2d<type_real> field_dot_dot;   ///< View of second
-                                                            ///< derivative of
-                                                            ///< field on Device
-  specfem::kokkos::HostMirror2d<type_real> h_field_dot_dot; ///< View of second
-                                                            ///< derivative of
-                                                            ///< field on host
-  specfem::kokkos::DeviceView2d<type_real> rmass_inverse;   ///< View of inverse
-                                                          ///< of mass matrix on
-                                                          ///< device
-  specfem::kokkos::HostMirror2d<type_real> h_rmass_inverse; ///< View of inverse
-                                                            ///< of mass matrix
-                                                            ///< on host
-  specfem::compute::compute *compute; ///< Pointer to compute struct used to
-                                      ///< store spectral element numbering
-                                      ///< mapping (ibool)
-  specfem::compute::properties *material_properties; ///< Pointer to struct used
-                                                     ///< to store material
-                                                     ///< properties
-  specfem::compute::partial_derivatives *partial_derivatives; ///< Pointer to
-                                                              ///< struct used
-                                                              ///< to store
-                                                              ///< partial
-                                                              ///< derivates
-  specfem::compute::sources *sources;     ///< Pointer to struct used to store
-                                          ///< sources
-  specfem::compute::receivers *receivers; ///< Pointer to struct used to store
-                                          ///< receivers
-  quadrature::quadrature *quadx;          ///< Pointer to quadrature object in
-                                          ///< x-dimension
-  quadrature::quadrature *quadz;          ///< Pointer to quadrature object in
-                                          ///< z-dimension
-  int nelem_domain; ///< Total number of elements in this domain
-  specfem::kokkos::DeviceView1d<int> ispec_domain; ///< Array containing global
-                                                   ///< indices(ispec) of all
-                                                   ///< elements in this domain
-                                                   ///< on the device
-  specfem::kokkos::HostMirror1d<int> h_ispec_domain; ///< Array containing
-                                                     ///< global indices(ispec)
-                                                     ///< of all elements in
-                                                     ///< this domain on the
-                                                     ///< host
+  void compute_seismogram(const int isig_step,
+                          const specfem::kokkos::DevExecSpace &exec_space =
+                              specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Record interaction of stiffness matrix on acceleration inside a
+   * graph
+   *
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  void compute_stiffness_interaction(
+      specfem::kokkos::DeviceGraphNode &node) override;
+  /**
+   * @brief Record interaction of sources on acceleration inside a graph
+   *
+   * @param timeval View containing the simulation time
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  void compute_source_interaction(
+      const specfem::kokkos::DeviceView1d<type_real> timeval,
+      specfem::kokkos::DeviceGraphNode &node) override;
+  /**
+   * @brief Record computation of seismograms for all receivers inside a graph
+   *
+   * @param isig_step View containing the seismogram step
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  void compute_seismogram(const specfem::kokkos::DeviceView1d<int> isig_step,
+                          specfem::kokkos::DeviceGraphNode &node) override;
+  /**
+   * @brief Order elements of the domain by local time stepping level
+   *
+   * Elements are stably sorted in ascending order of level, which keeps the
+   * element reordering within every level. Only implemented for atomic
+   * assembly
+   *
+   * @param element_levels Level of every spectral element (nspec)
+   */
+  void set_element_levels(const std::vector<int> &element_levels) override;
+  /**
+   * @brief Simulate attenuation using coarse grained memory variables
+   *
+   * Every quadrature point stores the memory variables of the standard
+   * linear solid given by specfem::attenuation::sls_index, for every shot.
+   * Moduli of the material properties are given at the reference frequency
+   * of the model and are converted to unrelaxed moduli by the stiffness
+   * kernel. Memory variables are updated once per call of the stiffness
+   * kernel, hence the time scheme needs to compute the stiffness interaction
+   * once per time step. Stiffness interaction is computed by the runtime
+   * sized kernel. Not supported with host offload or local time stepping
+   *
+   * @param model Standard linear solids approximating a constant Q
+   * @param dt Time step of the time scheme
+   */
+  void set_attenuation(const specfem::attenuation::model &model,
+                       const type_real dt) override;
+  /**
+   * @brief Damp waves leaving the domain through absorbing edges using
+   * Stacey boundary conditions
+   *
+   * Absorbing edges of elastic elements are damped after every stiffness
+   * interaction, using the velocity of the time scheme. Not supported with
+   * local time stepping
+   *
+   * @param abs_boundary Absorbing edges read from the database
+   */
+  void set_absorbing_boundary(
+      const specfem::boundaries::absorbing_boundary &abs_boundary) override;
+  /**
+   * @brief Get the number of absorbing quadrature points of the domain
+   *
+   */
+  int get_absorbing_npoints() const override {
+    return this->stacey.get_npoints();
+  }
+  /**
+   * @brief Select how absorbing points update the acceleration
+   *
+   * Fields stepped backward in time replay the tractions recorded by the
+   * forward time loop, see specfem::boundaries::stacey::set_mode
+   *
+   * @param mode Damp the velocity, record the tractions while damping or
+   * replay recorded tractions
+   * @param traction Traction of every absorbing point (npoints, ncomponents
+   * * nshots)
+   */
+  void set_absorbing_mode(
+      const specfem::absorbing::type mode,
+      const specfem::kokkos::DeviceView2d<type_real> traction = {}) {
+    this->stacey.set_mode(mode, traction);
+  }
+  /**
+   * @brief Get the absorbing points of the domain
+   *
+   */
+  const specfem::boundaries::stacey &get_stacey() const {
+    return this->stacey;
+  }
+  /**
+   * @brief Record or inject the wavefield of a hybrid simulation after every
+   * stiffness interaction
+   *
+   * Injected wavefields are applied after the absorbing points are damped.
+   * The injection advances by one timestep per stiffness interaction, hence
+   * single stage time schemes without local time stepping are supported
+   *
+   * @param injection Pointer to the injection, owned by the caller
+   */
+  void set_injection(specfem::boundaries::injection *injection);
+  /**
+   * @brief Absorb waves in convolutional PML layers made of the elements
+   * flagged in region_CPML
+   *
+   * Elastic PML elements are copied into compact arrays holding their memory
+   * variables. Their PML terms are added after every stiffness interaction,
+   * using the field and velocity of the time scheme. Not supported with
+   * local time stepping
+   *
+   * @param region_CPML PML flag of every element (nspec)
+   * @param layer Extent of the PML layers
+   * @param f0 Frequency setting the frequency shift of the damping profiles
+   * @param reflection Theoretical reflection coefficient of the layers
+   * @param dt Time step of the time scheme
+   */
+  void set_pml(const specfem::kokkos::HostView1d<int> region_CPML,
+               const specfem::boundaries::pml_layer &layer, const type_real f0,
+               const type_real reflection, const type_real dt) override;
+  /**
+   * @brief Get the number of PML elements of the domain
+   *
+   */
+  int get_pml_nelements() const override {
+    return this->pml.get_nelements();
+  }
+  /**
+   * @brief Simulate the meridional half plane x >= 0 of an axisymmetric
+   * medium, the symmetry axis being x = 0
+   *
+   * Elements on the axis have their edge xi = -1 on the axis and use the
+   * Gauss-Lobatto-Jacobi (0, 1) quadrature along xi, hence their partial
+   * derivatives and coordinates need to be computed at the GLJ points, see
+   * specfem::compute::partial_derivatives::assign_axial_elements. Mass and
+   * stiffness are weighted by the radius and the stiffness interaction adds
+   * the hoop stress (Nissen-Meyer et al. 2007). The radial acceleration of
+   * axis points is zeroed after the source interaction.
+   *
+   * Only implemented for P-SV waves. Not supported with host offload, the
+   * assembled stiffness operator, structured blocks, attenuation, absorbing
+   * boundaries, PML layers or local time stepping, hence this needs to be
+   * called before those are set
+   *
+   * @param is_on_the_axis Elements on the axis (nspec)
+   */
+  void set_axisymmetric(const specfem::kokkos::HostView1d<bool> is_on_the_axis);
+  /**
+   * @brief Check if the domain simulates an axisymmetric medium
+   *
+   */
+  bool is_axisymmetric() const { return this->axial.extent(0) > 0; }
+  /**
+   * @brief Replace the sources and receivers of the domain
+   *
+   * Sources are grouped by element and shot, and source groups are colored
+   * with colored assembly. The mesh, the fields and the mass matrix are
+   * kept, hence reset_fields needs to be called before the new sources are
+   * simulated
+   *
+   * @param sources Pointer to sources struct, located within the mesh
+   * @param receivers Pointer to receivers struct, located within the mesh
+   */
+  void set_sources(specfem::compute::sources *sources,
+                   specfem::compute::receivers *receivers) override;
+  /**
+   * @brief Set the fields of the domain at rest
+   *
+   * Fields and memory variables of attenuation are zeroed and, with active
+   * elements, the source elements are the only active elements. Auxiliary
+   * fields of PML layers aren't reset
+   *
+   */
+  void reset_fields() override;
+  /**
+   * @brief Compute interaction of stiffness matrix on acceleration for
+   * elements with a local time stepping level >= ilevel
+   *
+   * @param ilevel Coarsest level of elements to compute
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void compute_level_stiffness_interaction(
+      const int ilevel, const specfem::kokkos::DevExecSpace &exec_space =
+                            specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Compute interaction of sources on acceleration of the global
+   * points of a local time stepping level
+   *
+   * @param timeval Simulation time at the start of the step of the level
+   * @param point_level Level of every global point
+   * @param ilevel Level of the points to update
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void compute_level_source_interaction(
+      const type_real timeval,
+      const specfem::kokkos::DeviceView1d<int> point_level, const int ilevel,
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Get the number of elements computed on the host execution space
+   *
+   */
+  int get_nelem_host() const { return this->nelem_host; }
+  /**
+   * @brief Get the number of stored entries of the assembled stiffness matrix
+   *
+   * @return int Number of entries. 0 if the stiffness interaction isn't
+   * assembled
+   */
+  int get_matrix_nnz() const { return this->matrix_columns.extent(0); }
+  /**
+   * @brief Get the memory allocated by the views of the domain
+   *
+   * Does not include the compute structs the domain points to
+   *
+   */
+  specfem::memory::usage memory_usage() const override;
+  /**
+   * @brief Get the elements of every launch of the stiffness kernels, in
+   * launch order
+   *
+   * Colors are followed by the parities of structured blocks. Active
+   * elements are launched in the order of ispec_domain
+   *
+   */
+  specfem::first_touch::launches get_element_launches() const override;
+  /**
+   * @brief Get the analytic cost of one call of the kernels the domain
+   * launches in a time loop phase
+   *
+   * @param phase Time loop phase
+   * @return specfem::timers::cost Bytes and flops of the kernels
+   */
+  specfem::timers::cost
+  get_cost(const specfem::timers::phase phase) const override;
+
+private:
+  specfem::kokkos::DeviceFieldView2d<type_real> field; ///< View of field on
+                                                       ///< Device
+  mutable specfem::kokkos::HostFieldMirror2d<type_real>
+      h_field; ///< View of field on host. Allocated on first use
+  specfem::kokkos::DeviceFieldView2d<type_real>
+      field_dot; ///< View of derivative of field on Device
+  mutable specfem::kokkos::HostFieldMirror2d<type_real>
+      h_field_dot; ///< View of derivative of field on host. Allocated on
+                   ///< first use
+  specfem::kokkos::DeviceFieldView2d<type_real>
+      field_dot_dot; ///< View of second derivative of field on Device
+  mutable specfem::kokkos::HostFieldMirror2d<type_real>
+      h_field_dot_dot; ///< View of second derivative of field on host.
+                       ///< Allocated on first use
+  specfem::kokkos::DeviceView1d<type_real> rmass_inverse; ///< View of inverse
+                                                          ///< of mass matrix on
+                                                          ///< device
+  mutable specfem::kokkos::HostMirror1d<type_real>
+      h_rmass_inverse; ///< View of inverse of mass matrix on host. Allocated
+                       ///< on first use
+  specfem::compute::compute *compute; ///< Pointer to compute struct used to
+                                      ///< store spectral element numbering
+                                      ///< mapping (ibool)
+  specfem::compute::properties *material_properties; ///< Pointer to struct used
+                                                     ///< to store material
+                                                     ///< properties
+  specfem::compute::partial_derivatives *partial_derivatives; ///< Pointer to
+                                                              ///< struct used
+                                                              ///< to store
+                                                              ///< partial
+                                                              ///< derivates
+  specfem::compute::sources *sources;     ///< Pointer to struct used to store
+                                          ///< sources
+  specfem::compute::receivers *receivers; ///< Pointer to struct used to store
+                                          ///< receivers
+  quadrature::quadrature *quadx;          ///< Pointer to quadrature object in
+                                          ///< x-dimension
+  quadrature::quadrature *quadz;          ///< Pointer to quadrature object in
+                                          ///< z-dimension
+  specfem::interfaces::halo *halo; ///< Pointer to halo used to assemble
+                                   ///< fields across MPI interfaces
+  int nelem_domain; ///< Total number of elements in this domain
+  int nelem_outer;  ///< Number of elements containing MPI interface points.
+                    ///< Outer elements are first in ispec_domain
+  int ncolors_outer; ///< Number of colors of outer elements. Outer elements
+                     ///< span the first ncolors_outer colors
+  specfem::kokkos::DeviceView1d<int> ispec_domain; ///< Array containing global
+                                                   ///< indices(ispec) of all
+                                                   ///< elements in this domain
+                                                   ///< on the device
+  specfem::kokkos::HostMirror1d<int> h_ispec_domain; ///< Array containing
+                                                     ///< global indices(ispec)
+                                                     ///< of all elements in
+                                                     ///< this domain on the
+                                                     ///< host
+  int nelem_structured; ///< Number of elements computed by the structured
+                        ///< kernel. They aren't part of ispec_domain
+  specfem::kokkos::DeviceView1d<int>
+      structured_ispec; ///< Elements of structured blocks ordered by parity
+  specfem::kokkos::HostMirror1d<int>
+      h_structured_ispec; ///< Elements of structured blocks stored on host
+  std::vector<int> h_structured_offsets; ///< Elements of parity i in
+                                         ///< structured_ispec span
+                                         ///< [h_structured_offsets[i],
+                                         ///< h_structured_offsets[i + 1])
+  int ngll_specialization; ///< Number of GLL points used to select the
+                           ///< compile-time specialized stiffness kernel. 0
+                           ///< if the runtime sized kernel is used
+  bool batched_contractions; ///< If true specialized stiffness kernels use
+                             ///< batched tile products
+  bool host_lanes; ///< If true specialized stiffness kernels on host backends
+                   ///< interleave elements into SIMD lanes
+  specfem::assembly::type assembly; ///< Assembly strategy
+  bool packed_element_data; ///< If true stiffness kernels read geometry and
+                            ///< material properties from element_data
+  bool quantized_element_data; ///< If true element_data is quantized to 16
+                               ///< bit integers
+  specfem::wave::type wave; ///< Wave type simulated by this domain
+  int nshots; ///< Number of shots stored in the fields
+  bool active_elements; ///< If true stiffness kernels are only launched on
+                        ///< active elements
+  bool autotune;        ///< If true kernel configurations are tuned
+  specfem::kokkos::DeviceView1d<int> neighbor_offsets; ///< Offsets of the
+                                                       ///< neighbors of
+                                                       ///< every element
+                                                       ///< (ispec) in
+                                                       ///< neighbors
+  specfem::kokkos::DeviceView1d<int> neighbors; ///< Elements of this domain
+                                                ///< sharing a global point
+                                                ///< with an element
+  specfem::kokkos::DeviceView1d<int> element_state; ///< State of every
+                                                    ///< element (ispec). See
+                                                    ///< active::state
+  specfem::kokkos::DeviceView1d<int> active_ispec; ///< Global indices (ispec)
+                                                   ///< of active elements.
+                                                   ///< Only [0, nactive) is
+                                                   ///< used
+  specfem::kokkos::DeviceView1d<int> nactive; ///< Number of active elements
+                                              ///< stored on the device
+  specfem::kokkos::HostMirror1d<int> h_nactive; ///< Number of active elements
+                                                ///< stored on the host
+  int nelem_host; ///< Number of inner elements computed on the host
+                  ///< execution space. Host elements are last in
+                  ///< ispec_domain
+  specfem::kokkos::HostView3d<int> host_ibool; ///< Index in host_points of
+                                               ///< every quadrature point of
+                                               ///< host elements (nelem_host,
+                                               ///< ngllz, ngllx)
+  specfem::kokkos::HostView4d<type_real>
+      host_element_data; ///< Packed geometry and material properties of host
+                         ///< elements (nelem_host, nfields, ngllz, ngllx)
+  specfem::kokkos::DeviceView1d<int> host_points; ///< Global indices of the
+                                                  ///< points of host elements
+  specfem::kokkos::DeviceView2d<type_real> host_field; ///< Field at
+                                                       ///< host_points
+  specfem::kokkos::HostMirror2d<type_real> h_host_field; ///< Host copy of
+                                                         ///< host_field
+  specfem::kokkos::DeviceView2d<type_real>
+      host_field_dot_dot; ///< Stiffness interaction of host elements at
+                          ///< host_points
+  specfem::kokkos::HostMirror2d<type_real>
+      h_host_field_dot_dot; ///< Host copy of host_field_dot_dot
+  specfem::kokkos::DeviceView1d<int>
+      matrix_offsets; ///< Entries of row i of the assembled stiffness matrix
+                      ///< span [matrix_offsets(i), matrix_offsets(i + 1)).
+                      ///< Row iglob * ncomponents + icomponent updates
+                      ///< component icomponent of point iglob
+  specfem::kokkos::DeviceView1d<int> matrix_columns; ///< Column of every
+                                                     ///< entry, numbered as
+                                                     ///< rows
+  specfem::kokkos::DeviceView1d<type_real> matrix_values; ///< Value of every
+                                                          ///< entry
+  specfem::kokkos::DeviceView4d<type_real> element_data; ///< Packed geometry
+                                                         ///< and material
+                                                         ///< properties
+                                                         ///< (nelem_domain,
+                                                         ///< nfields, ngllz,
+                                                         ///< ngllx)
+  specfem::kokkos::DeviceView4d<std::int16_t>
+      quantized_element_data_values; ///< Quantized packed geometry and
+                                     ///< material properties (nelem_domain,
+                                     ///< nfields, ngllz, ngllx)
+  specfem::kokkos::DeviceView2d<type_real>
+      element_data_scale; ///< Scale of quantized element data
+                          ///< (nelem_domain, nfields)
+  std::vector<int> h_color_offsets; ///< Elements of color icolor in
+                                    ///< ispec_domain span [h_color_offsets[i],
+                                    ///< h_color_offsets[i + 1])
+  specfem::kokkos::DeviceView1d<int> source_order; ///< Order in which sources
+                                                   ///< are applied on the
+                                                   ///< device
+  specfem::kokkos::HostMirror1d<int> h_source_order; ///< Order in which
+                                                     ///< sources are applied
+                                                     ///< on the host
+  specfem::kokkos::DeviceView1d<int>
+      source_group_offsets; ///< Sources of group igroup, inside the same
+                            ///< element and shot, span
+                            ///< [source_group_offsets(igroup),
+                            ///< source_group_offsets(igroup + 1)) in
+                            ///< source_order
+  specfem::kokkos::HostMirror1d<int>
+      h_source_group_offsets; ///< Host mirror of source_group_offsets
+  std::vector<int> h_source_color_offsets; ///< Source groups of color icolor
+                                           ///< span
+                                           ///< [h_source_color_offsets[i],
+                                           ///< h_source_color_offsets[i + 1])
+  specfem::kokkos::DeviceView1d<int> receiver_index; ///< Receivers inside
+                                                     ///< elastic elements
+  specfem::kokkos::HostMirror1d<int> h_receiver_index; ///< Host mirror of
+                                                       ///< receiver_index
+  std::vector<int> h_level_offsets; ///< Elements of local time stepping
+                                    ///< level ilevel in ispec_domain span
+                                    ///< [h_level_offsets[i],
+                                    ///< h_level_offsets[i + 1])
+  int n_sls; ///< Number of standard linear solids. Attenuation isn't
+             ///< simulated if 0
+  type_real attenuation_dispersion; ///< Dispersion of the attenuation model
+                                    ///< at its reference frequency for Q = 1
+  specfem::kokkos::DeviceView2d<type_real> sls; ///< Decay of memory
+                                                ///< variables over a time
+                                                ///< step and coarse grained
+                                                ///< anelastic coefficient of
+                                                ///< every SLS (n_sls, 2)
+  specfem::kokkos::DeviceElementView3d<type_real>
+      inverse_qkappa; ///< Q_kappa^-1 of every quadrature point
+  specfem::kokkos::DeviceElementView3d<type_real>
+      inverse_qmu; ///< Q_mu^-1 of every quadrature point
+  specfem::kokkos::DeviceView4d<type_real>
+      memory_variables; ///< Memory variables of every quadrature point
+                        ///< (nspec, ngllz, ngllx, nvariables * nshots).
+                        ///< Bulk, deviatoric and shear stress for P-SV
+                        ///< waves, stress along x and z for SH waves
+  specfem::kokkos::DeviceView1d<int> axial; ///< 1 for elements on the axis of
+                                            ///< axisymmetric simulations
+                                            ///< (nspec). Not allocated if
+                                            ///< the medium isn't
+                                            ///< axisymmetric
+  specfem::kokkos::DeviceElementView3d<type_real>
+      radius; ///< Distance of every quadrature point to the axis, 0 on the
+              ///< axis
+  specfem::kokkos::DeviceElementView3d<type_real>
+      radius_factor; ///< Radius weighting the integrands of every quadrature
+                     ///< point. r / (1 + xi) inside elements on the axis,
+                     ///< dx / dxi on the axis
+  specfem::kokkos::DeviceView1d<int> axis_points; ///< Global numbers of the
+                                                  ///< points on the axis
+  specfem::kokkos::DeviceView1d<type_real> wxglj; ///< GLJ weights of elements
+                                                  ///< on the axis
+  specfem::kokkos::DeviceView2d<type_real>
+      hprimeBar_xx; ///< Derivatives of the GLJ interpolants
+  specfem::kokkos::DeviceView2d<type_real>
+      hprimeBarwglj_xx; ///< Transposed GLJ derivatives weighted by the GLJ
+                        ///< weights
+  specfem::boundaries::stacey stacey; ///< Absorbing points of the domain
+  specfem::boundaries::injection *injection =
+      nullptr;                  ///< Recorded or injected wavefield of hybrid
+                                ///< simulations, null if unused
+  specfem::boundaries::pml pml; ///< PML elements of the domain
+  specfem::autotune::cache tuning_cache;      ///< Configurations tuned by
+                                              ///< previous runs
+  specfem::autotune::kernel stiffness_tuner;  ///< Tuner of the stiffness
+                                              ///< team kernel
+  specfem::autotune::kernel source_tuner;     ///< Tuner of the source kernel
+  specfem::autotune::kernel seismogram_tuner; ///< Tuner of the seismogram
+                                              ///< kernel
+  /**
+   * @brief Compute interaction of stiffness matrix on acceleration using
+   * runtime sized scratch views
+   *
+   * This kernel is used when ngllx != ngllz, when no specialization exists
+   * for the chosen number of GLL points or when attenuation is simulated
+   *
+   * @param istart Index of first element in ispec_domain to compute
+   * @param iend Index one past the last element in ispec_domain to compute
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void compute_stiffness_interaction_generic(
+      const int istart, const int iend,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Compute interaction of stiffness matrix on acceleration of an
+   * axisymmetric medium
+   *
+   * Elements on the axis use the GLJ quadrature along xi. Integrands are
+   * weighted by radius_factor and the hoop stress sigma_phiphi is added to
+   * the radial component. u_x / r is replaced by du_x / dx on the axis
+   *
+   * @param istart Index of first element in ispec_domain to compute
+   * @param iend Index one past the last element in ispec_domain to compute
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void compute_stiffness_interaction_axisymmetric(
+      const int istart, const int iend,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Zero the radial acceleration of the points on the axis
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void apply_axis_constraint(const specfem::kokkos::DevExecSpace &exec_space,
+                             specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Compute interaction of stiffness matrix on acceleration for the
+   * elements of structured blocks
+   *
+   * Global numbers of the points of an element are computed from the origin
+   * and row stride of its tile, without reading ibool. Elements of the same
+   * parity along x and z don't share points, hence every parity is launched
+   * separately and assembled without atomics. Points shared with other
+   * elements are assembled by the kernels launched before on the same
+   * execution space instance
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void compute_structured_stiffness_interaction(
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Compute interaction of stiffness matrix on acceleration using
+   * compile-time sized scratch views
+   *
+   * Loop trip counts are known at compile time which allows the compiler to
+   * unroll the contractions and keep partial sums in registers
+   *
+   * @tparam NGLL Number of GLL points in x and z dimensions
+   * @tparam WAVE Wave type simulated by the domain
+   * @param istart Index of first element in ispec_domain to compute
+   * @param iend Index one past the last element in ispec_domain to compute
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  template <int NGLL, specfem::wave::type WAVE>
+  void compute_stiffness_interaction_ngll(
+      const int istart, const int iend,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Compute interaction of stiffness matrix on acceleration as batched
+   * products of element tiles
+   *
+   * Fields, derivatives and stress integrands of every element of a team are
+   * stored as NPAD x NPAD tiles, NPAD being NGLL rounded up to a multiple of
+   * 4 and padded entries being zero. Derivatives along xi and gamma are the
+   * products of every tile with hprime, and the weighted contractions the
+   * products of the stress integrands with hprimewgll. Products have fixed
+   * trip counts and one thread per entry of the batch
+   *
+   * @tparam NGLL Number of GLL points in x and z dimensions
+   * @tparam WAVE Wave type simulated by the domain
+   * @param istart Index of first element in ispec_domain to compute
+   * @param iend Index one past the last element in ispec_domain to compute
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  template <int NGLL, specfem::wave::type WAVE>
+  void compute_stiffness_interaction_gemm(
+      const int istart, const int iend,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Compute interaction of stiffness matrix on acceleration for host
+   * backends by vectorizing across elements
+   *
+   * Elements are processed in batches of simd_lanes<type_real>() elements.
+   * Remainder elements are computed using a single lane.
+   *
+   * @tparam NGLL Number of GLL points in x and z dimensions
+   * @tparam WAVE Wave type simulated by the domain
+   * @param istart Index of first element in ispec_domain to compute
+   * @param iend Index one past the last element in ispec_domain to compute
+   * @param node Graph node used to record the kernels. Kernels are launched
+   * immediately if node is a nullptr
+   */
+  template <int NGLL, specfem::wave::type WAVE>
+  void
+  compute_stiffness_interaction_simd(const int istart, const int iend,
+                                     specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Compute interaction of stiffness matrix on acceleration for batches
+   * of NLANES elements stored in element-interleaved lanes
+   *
+   * @tparam NGLL Number of GLL points in x and z dimensions
+   * @tparam NLANES Number of elements per batch
+   * @tparam WAVE Wave type simulated by the domain
+   * @param istart Index of first element in ispec_domain to compute
+   * @param iend Index one past the last element in ispec_domain to compute.
+   * (iend - istart) should be a multiple of NLANES
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  template <int NGLL, int NLANES, specfem::wave::type WAVE>
+  void
+  compute_stiffness_interaction_lanes(const int istart, const int iend,
+                                      specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Select the NGLL specialized stiffness kernel for the current
+   * backend and wave type
+   *
+   * @tparam NGLL Number of GLL points in x and z dimensions
+   * @param istart Index of first element in ispec_domain to compute
+   * @param iend Index one past the last element in ispec_domain to compute
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernels. Kernels are launched
+   * immediately if node is a nullptr
+   */
+  template <int NGLL>
+  void compute_stiffness_interaction_specialized(
+      const int istart, const int iend,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Launch or record the stiffness kernel selected for this domain on
+   * a range of elements
+   *
+   * @param istart Index of first element in ispec_domain to compute
+   * @param iend Index one past the last element in ispec_domain to compute
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernels. Kernels are launched
+   * immediately if node is a nullptr
+   */
+  void compute_stiffness_interaction_range(
+      const int istart, const int iend,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Compute the last nelem_host inner elements of ispec_domain on the
+   * host execution space
+   *
+   * Host elements get their own copy of geometry and material properties.
+   * Their points are numbered compactly such that only the field at these
+   * points is exchanged with the device at every step
+   *
+   * @param nelem_host Number of host elements
+   */
+  KOKKOS_IMPL_HOST_FUNCTION
+  void assign_host_elements(const int nelem_host);
+  /**
+   * @brief Estimate the fraction of elements computed on the host such that
+   * host and device kernels take the same time
+   *
+   * The device kernel is timed on every element and the host kernel on a
+   * sample of inner elements
+   *
+   * @return type_real Fraction of elements computed on the host
+   */
+  KOKKOS_IMPL_HOST_FUNCTION
+  type_real calibrate_host_fraction();
+  /**
+   * @brief Copy the field at the points of host elements to the host
+   *
+   * Returns once the copy is complete
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void
+  start_host_stiffness_interaction(const specfem::kokkos::DevExecSpace
+                                       &exec_space);
+  /**
+   * @brief Compute the stiffness interaction of host elements and add it to
+   * the acceleration
+   *
+   * The host kernel runs while kernels previously launched on exec_space
+   * execute. Contributions are added asynchronously on exec_space
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void
+  finish_host_stiffness_interaction(const specfem::kokkos::DevExecSpace
+                                        &exec_space);
+  /**
+   * @brief Compute the stiffness interaction of host elements into
+   * h_host_field_dot_dot on the host execution space
+   *
+   */
+  void compute_host_stiffness_interaction();
+  /**
+   * @brief Assemble the stiffness interaction of every element of the domain
+   * into a compressed sparse row matrix
+   *
+   * Element matrices are the responses of the element operator of the
+   * stiffness kernels to every unit element field, computed on the host from
+   * the host mirrors of geometry and material properties. Rows store the
+   * global points sharing an element with the point of the row
+   */
+  KOKKOS_IMPL_HOST_FUNCTION
+  void assemble_stiffness_matrix();
+  /**
+   * @brief Add the product of the assembled stiffness matrix and the field of
+   * every shot to the acceleration
+   *
+   * Every row is computed by a single thread, hence the acceleration is
+   * updated without atomics
+   *
+   * @param exec_space Execution space instance used to launch the kernel
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void compute_assembled_stiffness_interaction(
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Build the element adjacency and activate the elements containing
+   * sources
+   *
+   */
+  KOKKOS_IMPL_HOST_FUNCTION
+  void assign_active_elements();
+  /**
+   * @brief Activate the elements containing sources and the outer elements,
+   * every other element being inactive
+   *
+   */
+  void reset_active_elements();
+  /**
+   * @brief Activate the elements neighboring an active element which have a
+   * displaced quadrature point
+   *
+   * A point is only displaced after its acceleration was non zero, and only
+   * points of active or source elements get a non zero acceleration. Hence
+   * every element with a displaced point is active after this call
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void
+  update_active_elements(const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Launch or record stiffness kernels for every color of elements
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernels. Kernels are launched
+   * immediately if node is a nullptr
+   */
+  void
+  launch_stiffness_interaction(const specfem::kokkos::DevExecSpace &exec_space,
+                               specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Launch or record source kernels for every color of sources
+   *
+   * @param timeval Simulation time used by kernels launched immediately
+   * @param device_timeval View containing the simulation time used by
+   * recorded kernels
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernels. Kernels are launched
+   * immediately if node is a nullptr
+   * @param point_level Level of every global point. Every point is updated
+   * if the view is empty
+   * @param ilevel Level of the points to update
+   */
+  void launch_source_interaction(
+      const type_real timeval,
+      const specfem::kokkos::DeviceView1d<type_real> device_timeval,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node,
+      const specfem::kokkos::DeviceView1d<int> point_level =
+          specfem::kokkos::DeviceView1d<int>(),
+      const int ilevel = 0);
+  /**
+   * @brief Launch or record seismogram kernel
+   *
+   * @param isig_step Seismogram step used by kernels launched immediately
+   * @param device_isig_step View containing the seismogram step used by
+   * recorded kernels
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void
+  launch_seismogram(const int isig_step,
+                    const specfem::kokkos::DeviceView1d<int> device_isig_step,
+                    const specfem::kokkos::DevExecSpace &exec_space,
+                    specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Launch or record seismogram kernel reading a fixed set of fields
+   *
+   * @tparam FIELDS Fields read by the kernel, bit 1 << type set for every
+   * recorded specfem::seismogram::type
+   * @param isig_step Seismogram step used by kernels launched immediately
+   * @param device_isig_step View containing the seismogram step used by
+   * recorded kernels
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  template <int FIELDS>
+  void launch_seismogram_fields(
+      const int isig_step,
+      const specfem::kokkos::DeviceView1d<int> device_isig_step,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
+};
+
+/**
+ * @brief Acoustic domain class
+ *
+ * Acoustic domains implementation details:
+ *  - field -> Potential of every acoustic point (iglob) stored as a 2D View
+ * field(iglob, ishot), a single component being stored for every shot
+ *  - field_dot -> Derivative of potential stored as field
+ *  - field_dot_dot -> Second derivative of potential stored as field
+ *
+ * Points of acoustic elements are numbered compactly, in the order elements
+ * are visited, such that the fields only store the points of the domain.
+ * Pressure is the opposite of the second derivative of potential. Force
+ * sources are pressure sources, and seismograms record the displacement,
+ * velocity and acceleration given by the gradient of the corresponding field
+ * divided by the density. Graph execution and multi-stage time schemes are
+ * supported. MPI interfaces, local time stepping, attenuation, packed element
+ * data, active elements and host offload aren't implemented for acoustic
+ * domains
+ */
+class Acoustic final : public Domain {
+public:
+  /**
+   * @brief Get a view of potential stored on the device
+   *
+   * @return specfem::kokkos::DeviceFieldView2d<type_real>
+   */
+  specfem::kokkos::DeviceFieldView2d<type_real> get_field() const override {
+    return this->field;
+  }
+  /**
+   * @brief Get a view of potential stored on the host
+   *
+   * The host mirror is allocated by the first call
+   *
+   * @return specfem::kokkos::HostFieldMirror2d<type_real>
+   */
+  specfem::kokkos::HostFieldMirror2d<type_real>
+  get_host_field() const override {
+    return specfem::kokkos::lazy_mirror(this->h_field, this->field);
+  }
+  /**
+   * @brief Get a view of derivative of potential stored on device
+   *
+   * @return specfem::kokkos::DeviceFieldView2d<type_real>
+   */
+  specfem::kokkos::DeviceFieldView2d<type_real> get_field_dot() const override {
+    return this->field_dot;
+  }
+  /**
+   * @brief Get a view of derivative of potential stored on host
+   *
+   * The host mirror is allocated by the first call
+   *
+   * @return specfem::kokkos::HostFieldMirror2d<type_real>
+   */
+  specfem::kokkos::HostFieldMirror2d<type_real>
+  get_host_field_dot() const override {
+    return specfem::kokkos::lazy_mirror(this->h_field_dot, this->field_dot);
+  }
+  /**
+   * @brief Get a view of second derivative of potential stored on device
+   *
+   * @return specfem::kokkos::DeviceFieldView2d<type_real>
+   */
+  specfem::kokkos::DeviceFieldView2d<type_real>
+  get_field_dot_dot() const override {
+    return this->field_dot_dot;
+  }
+  /**
+   * @brief Get a view of second derivative of potential stored on host
+   *
+   * The host mirror is allocated by the first call
+   *
+   * @return specfem::kokkos::HostFieldMirror2d<type_real>
+   */
+  specfem::kokkos::HostFieldMirror2d<type_real>
+  get_host_field_dot_dot() const override {
+    return specfem::kokkos::lazy_mirror(this->h_field_dot_dot,
+                                        this->field_dot_dot);
+  }
+  /**
+   * @brief Get a view of inverse of mass matrix stored on device
+   *
+   * @return specfem::kokkos::DeviceView1d<type_real>
+   */
+  specfem::kokkos::DeviceView1d<type_real> get_rmass_inverse() const override {
+    return this->rmass_inverse;
+  }
+  /**
+   * @brief Get a view of inverse of mass matrix stored on host
+   *
+   * The host mirror is allocated by the first call
+   *
+   * @return specfem::kokkos::HostMirror1d<type_real>
+   */
+  specfem::kokkos::HostMirror1d<type_real>
+  get_host_rmass_inverse() const override {
+    return specfem::kokkos::lazy_mirror(this->h_rmass_inverse,
+                                        this->rmass_inverse);
+  }
+  /**
+   * @brief Get the global number of every point of the domain stored on the
+   * host
+   *
+   * @return specfem::kokkos::HostMirror1d<int> Global number (iglob) of
+   * every acoustic point
+   */
+  specfem::kokkos::HostMirror1d<int> get_host_global_index() const {
+    return this->h_global_index;
+  }
+
+  /**
+   * @brief Construct a new Acoustic domain object
+   *
+   * @param ndim Number of dimensions
+   * @param compute Pointer to specfem::compute::compute struct
+   * @param material_properties Pointer to specfem::compute::properties
+   * struct
+   * @param partial_derivatives Pointer to
+   * specfem::compute::partial_derivatives struct
+   * @param sources Pointer to specfem::compute::sources struct
+   * @param receivers Pointer to specfem::compute::receivers struct
+   * @param quadx Pointer to quadrature object in x-dimension
+   * @param quadz Pointer to quadrature object in z-dimension
+   * @param options Runtime options used to select domain kernels
+   * @param halo Pointer to halo of the mesh. Acoustic domains can't have MPI
+   * interfaces
+   */
+  Acoustic(const int ndim, specfem::compute::compute *compute,
+           specfem::compute::properties *material_properties,
+           specfem::compute::partial_derivatives *partial_derivatives,
+           specfem::compute::sources *sources,
+           specfem::compute::receivers *receivers,
+           specfem::quadrature::quadrature *quadx,
+           specfem::quadrature::quadrature *quadz,
+           const specfem::Domain::options &options = {},
+           specfem::interfaces::halo *halo = nullptr);
+  /**
+   * @brief Compute interaction of stiffness matrix on second derivative of
+   * potential
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void compute_stiffness_interaction(
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Divide the second derivative of potential by the mass matrix
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void divide_mass_matrix(const specfem::kokkos::DevExecSpace &exec_space =
+                              specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Compute interaction of pressure sources on second derivative of
+   * potential
+   *
+   * @param timeval
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void compute_source_interaction(
+      const type_real timeval,
+      const specfem::kokkos::DevExecSpace &exec_space =
+          specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Check if source interactions can be computed concurrently with
+   * stiffness interactions
+   *
+   * Sources are always assembled using atomic operations
+   *
+   * @return bool true if atomic assembly is used
+   */
+  bool concurrent_source_interaction() const override {
+    return (this->assembly == specfem::assembly::atomic);
+  }
+  /**
+   * @brief Sync potential views between host and device
+   *
+   * @param kind defines sync direction i.e. DeviceToHost or HostToDevice
+   */
+  void sync_field(specfem::sync::kind kind) override;
+  /**
+   * @brief Sync derivative of potential views between host and device
+   *
+   * @param kind defines sync direction i.e. DeviceToHost or HostToDevice
+   */
+  void sync_field_dot(specfem::sync::kind kind) override;
+  /**
+   * @brief Sync second derivative of potential views between host and device
+   *
+   * @param kind defines sync direction i.e. DeviceToHost or HostToDevice
+   */
+  void sync_field_dot_dot(specfem::sync::kind kind) override;
+  /**
+   * @brief Sync inverse of mass matrix views between host and device
+   *
+   * @param kind defines sync direction i.e. DeviceToHost or HostToDevice
+   */
+  void sync_rmass_inverse(specfem::sync::kind kind) override;
+  /**
+   * @brief Compute seismograms at for all receivers at isig_step
+   *
+   * @param isig_step timestep for seismogram calculation
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void compute_seismogram(const int isig_step,
+                          const specfem::kokkos::DevExecSpace &exec_space =
+                              specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Record interaction of stiffness matrix on second derivative of
+   * potential inside a graph
+   *
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  void compute_stiffness_interaction(
+      specfem::kokkos::DeviceGraphNode &node) override;
+  /**
+   * @brief Record interaction of pressure sources on second derivative of
+   * potential inside a graph
+   *
+   * @param timeval View containing the simulation time
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  void compute_source_interaction(
+      const specfem::kokkos::DeviceView1d<type_real> timeval,
+      specfem::kokkos::DeviceGraphNode &node) override;
+  /**
+   * @brief Record computation of seismograms for all receivers inside a graph
+   *
+   * @param isig_step View containing the seismogram step
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  void compute_seismogram(const specfem::kokkos::DeviceView1d<int> isig_step,
+                          specfem::kokkos::DeviceGraphNode &node) override;
+  /**
+   * @brief Local time stepping isn't implemented for acoustic domains
+   *
+   */
+  void set_element_levels(const std::vector<int> &element_levels) override {
+    throw std::runtime_error(
+        "Local time stepping is not implemented for acoustic domains");
+  }
+  /**
+   * @brief Attenuation isn't implemented for acoustic domains
+   *
+   */
+  void set_attenuation(const specfem::attenuation::model &model,
+                       const type_real dt) override {
+    throw std::runtime_error(
+        "Attenuation is not implemented for acoustic domains");
+  }
+  /**
+   * @brief Damp waves leaving the domain through absorbing edges using
+   * Stacey boundary conditions
+   *
+   * Absorbing edges of acoustic elements are damped after every stiffness
+   * interaction
+   *
+   * @param abs_boundary Absorbing edges read from the database
+   */
+  void set_absorbing_boundary(
+      const specfem::boundaries::absorbing_boundary &abs_boundary) override;
+  /**
+   * @brief Get the number of absorbing quadrature points of the domain
+   *
+   */
+  int get_absorbing_npoints() const override {
+    return this->stacey.get_npoints();
+  }
+  /**
+   * @brief PML layers aren't implemented for acoustic domains
+   *
+   * Throws if an acoustic element is flagged in region_CPML
+   *
+   * @param region_CPML PML flag of every element (nspec)
+   * @param layer Extent of the PML layers
+   * @param f0 Frequency setting the frequency shift of the damping profiles
+   * @param reflection Theoretical reflection coefficient of the layers
+   * @param dt Time step of the time scheme
+   */
+  void set_pml(const specfem::kokkos::HostView1d<int> region_CPML,
+               const specfem::boundaries::pml_layer &layer, const type_real f0,
+               const type_real reflection, const type_real dt) override;
+  /**
+   * @brief Get the memory allocated by the views of the domain
+   *
+   * Does not include the compute structs the domain points to
+   *
+   */
+  specfem::memory::usage memory_usage() const override;
+  /**
+   * @brief Get the elements of every launch of the stiffness kernels, in
+   * launch order
+   *
+   */
+  specfem::first_touch::launches get_element_launches() const override;
+  /**
+   * @brief Get the analytic cost of one call of the kernels the domain
+   * launches in a time loop phase
+   *
+   * @param phase Time loop phase
+   * @return specfem::timers::cost Bytes and flops of the kernels
+   */
+  specfem::timers::cost
+  get_cost(const specfem::timers::phase phase) const override;
+
+private:
+  specfem::kokkos::DeviceFieldView2d<type_real> field; ///< View of potential
+                                                       ///< on device
+  mutable specfem::kokkos::HostFieldMirror2d<type_real>
+      h_field; ///< View of potential on host. Allocated on first use
+  specfem::kokkos::DeviceFieldView2d<type_real>
+      field_dot; ///< View of derivative of potential on device
+  mutable specfem::kokkos::HostFieldMirror2d<type_real>
+      h_field_dot; ///< View of derivative of potential on host. Allocated on
+                   ///< first use
+  specfem::kokkos::DeviceFieldView2d<type_real>
+      field_dot_dot; ///< View of second derivative of potential on device
+  mutable specfem::kokkos::HostFieldMirror2d<type_real>
+      h_field_dot_dot; ///< View of second derivative of potential on host.
+                       ///< Allocated on first use
+  specfem::kokkos::DeviceView1d<type_real> rmass_inverse; ///< View of inverse
+                                                          ///< of mass matrix on
+                                                          ///< device
+  mutable specfem::kokkos::HostMirror1d<type_real>
+      h_rmass_inverse; ///< View of inverse of mass matrix on host. Allocated
+                       ///< on first use
+  specfem::compute::compute *compute; ///< Pointer to compute struct used to
+                                      ///< store spectral element numbering
+                                      ///< mapping (ibool)
+  specfem::compute::properties *material_properties; ///< Pointer to struct used
+                                                     ///< to store material
+                                                     ///< properties
+  specfem::compute::partial_derivatives *partial_derivatives; ///< Pointer to
+                                                              ///< struct used
+                                                              ///< to store
+                                                              ///< partial
+                                                              ///< derivates
+  specfem::compute::sources *sources;     ///< Pointer to struct used to store
+                                          ///< sources
+  specfem::compute::receivers *receivers; ///< Pointer to struct used to store
+                                          ///< receivers
+  quadrature::quadrature *quadx;          ///< Pointer to quadrature object in
+                                          ///< x-dimension
+  quadrature::quadrature *quadz;          ///< Pointer to quadrature object in
+                                          ///< z-dimension
+  int nelem_domain; ///< Total number of elements in this domain
+  specfem::kokkos::DeviceView1d<int> ispec_domain; ///< Global indices (ispec)
+                                                   ///< of the elements of this
+                                                   ///< domain on the device
+  specfem::kokkos::HostMirror1d<int> h_ispec_domain; ///< Global indices
+                                                     ///< (ispec) of the
+                                                     ///< elements of this
+                                                     ///< domain on the host
+  specfem::kokkos::DeviceView1d<int> element_index; ///< Index in ispec_domain
+                                                    ///< of every spectral
+                                                    ///< element (ispec). -1
+                                                    ///< for elements of other
+                                                    ///< domains
+  specfem::kokkos::DeviceView1d<int> source_index; ///< Sources inside
+                                                   ///< acoustic elements
+  specfem::kokkos::DeviceView1d<int> receiver_index; ///< Receivers inside
+                                                     ///< acoustic elements
+  specfem::kokkos::DeviceElementView3d<int> ibool; ///< Acoustic number of
+                                                   ///< every quadrature point
+                                                   ///< of the elements of
+                                                   ///< this domain (ielement,
+                                                   ///< iz, ix)
+  specfem::kokkos::DeviceView1d<int> global_index; ///< Global number (iglob)
+                                                   ///< of every acoustic point
+                                                   ///< on the device
+  specfem::kokkos::HostMirror1d<int> h_global_index; ///< Global number of
+                                                     ///< every acoustic point
+                                                     ///< on the host
+  specfem::assembly::type assembly; ///< Assembly strategy
+  int nshots; ///< Number of shots stored in the fields
+  std::vector<int> h_color_offsets; ///< Elements of color icolor in
+                                    ///< ispec_domain span [h_color_offsets[i],
+                                    ///< h_color_offsets[i + 1])
+  specfem::boundaries::stacey stacey; ///< Absorbing points of the domain
+  /**
+   * @brief Compute the mass matrix of the domain and invert it
+   *
+   */
+  KOKKOS_IMPL_HOST_FUNCTION
+  void assign_views();
+  /**
+   * @brief Copy the potentials and the mass matrix to views first touched by
+   * the threads computing their points on host backends
+   *
+   * @param ibool Acoustic number of every quadrature point of the elements of
+   * the domain stored on host
+   */
+  void place_fields(const specfem::kokkos::HostElementMirror3d<int> ibool);
+  /**
+   * @brief Launch or record the stiffness kernel on a range of elements
+   *
+   * @param istart Index of first element in ispec_domain to compute
+   * @param iend Index one past the last element in ispec_domain to compute
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void compute_stiffness_interaction_range(
+      const int istart, const int iend,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Launch or record stiffness kernels for every color of elements
+   *
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernels. Kernels are launched
+   * immediately if node is a nullptr
+   */
+  void
+  launch_stiffness_interaction(const specfem::kokkos::DevExecSpace &exec_space,
+                               specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Launch or record source kernel
+   *
+   * @param timeval Simulation time used by kernels launched immediately
+   * @param device_timeval View containing the simulation time used by
+   * recorded kernels
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void launch_source_interaction(
+      const type_real timeval,
+      const specfem::kokkos::DeviceView1d<type_real> device_timeval,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Launch or record seismogram kernel
+   *
+   * @param isig_step Seismogram step used by kernels launched immediately
+   * @param device_isig_step View containing the seismogram step used by
+   * recorded kernels
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void
+  launch_seismogram(const int isig_step,
+                    const specfem::kokkos::DeviceView1d<int> device_isig_step,
+                    const specfem::kokkos::DevExecSpace &exec_space,
+                    specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Launch or record seismogram kernel reading a fixed set of fields
+   *
+   * @tparam FIELDS Fields read by the kernel, bit 1 << type set for every
+   * recorded specfem::seismogram::type
+   * @param isig_step Seismogram step used by kernels launched immediately
+   * @param device_isig_step View containing the seismogram step used by
+   * recorded kernels
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  template <int FIELDS>
+  void launch_seismogram_fields(
+      const int isig_step,
+      const specfem::kokkos::DeviceView1d<int> device_isig_step,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node);
 };
 } // namespace Domain
 } // namespace specfem
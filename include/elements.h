@@ -23,7 +23,7 @@ struct tangential_elements {
   specfem::kokkos::HostView1d<type_real> x, y;
   tangential_elements(){};
   tangential_elements(const int nnodes_tangential_curve);
-  tangential_elements(std::ifstream &stream, const int nnodes_tangential_curve);
+  tangential_elements(std::istream &stream, const int nnodes_tangential_curve);
 };
 
 /**
@@ -36,7 +36,7 @@ struct axial_elements {
   specfem::kokkos::HostView1d<bool> is_on_the_axis;
   axial_elements(){};
   axial_elements(const int nspec);
-  axial_elements(std::ifstream &stream, const int nelem_on_the_axis,
+  axial_elements(std::istream &stream, const int nelem_on_the_axis,
                  const int nspec, const specfem::MPI::MPI *mpi);
 };
 
@@ -0,0 +1,169 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "../include/config.h"
+#include "../include/material.h"
+#include "../include/specfem_mpi.h"
+#include "../include/utils.h"
+#include <string>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Parameter sweeps simulated inside a single MPI job
+ *
+ */
+namespace ensemble {
+
+/**
+ * @brief Material property overridden by an ensemble member
+ *
+ */
+struct material_value {
+  int kmato;            ///< Material index, starting at 1 as in the database
+  std::string property; ///< rho, vp, vs, Qkappa or Qmu
+  type_real value;      ///< Value of the property
+
+  bool operator==(const material_value &other) const {
+    return kmato == other.kmato && property == other.property &&
+           value == other.value;
+  }
+};
+
+/**
+ * @brief Simulation of an ensemble
+ *
+ * Sweeping the source frequency or the source position is sweeping sources
+ * files
+ *
+ */
+struct member {
+  std::vector<std::string> sources_files; ///< Sources file of every shot.
+                                          ///< Sources of the parameter file
+                                          ///< if empty
+  std::vector<material_value> materials;  ///< Material properties
+                                          ///< overriding the materials of
+                                          ///< the mesh
+};
+
+/**
+ * @brief Sweep specification
+ *
+ * Members are listed explicitly under `members`, and the cartesian product
+ * of the axes under `sweep` is appended to them:
+ *
+ * @code{.yaml}
+ * ensemble:
+ *   output-folder: OUTPUT_FILES/ensemble
+ *   groups: 2
+ *   members:
+ *     - sources: [ sources_a.yaml ]
+ *       materials:
+ *         - kmato: 1
+ *           vs: 1700.0
+ *   sweep:
+ *     sources: [ [ sources_a.yaml ], [ sources_b.yaml ] ]
+ *     materials:
+ *       - kmato: 1
+ *         property: vp
+ *         values: [ 2800.0, 3000.0 ]
+ * @endcode
+ *
+ */
+class sweep {
+
+public:
+  /**
+   * @brief Construct a sweep from its members
+   *
+   * @param members Members of the ensemble
+   * @param output_folder Folder of the index file and of the seismograms of
+   * every member
+   * @param ngroups Number of groups of processes simulating members. One
+   * group for every process if 0
+   */
+  sweep(const std::vector<specfem::ensemble::member> &members,
+        const std::string &output_folder, const int ngroups = 0)
+      : members(members), output_folder(output_folder), ngroups(ngroups){};
+  /**
+   * @brief Read a sweep specification written in yaml format
+   *
+   * @param sweep_file Name of the yml file
+   */
+  sweep(const std::string &sweep_file);
+  /**
+   * @brief Get the number of members
+   *
+   */
+  int get_nmembers() const { return this->members.size(); }
+  /**
+   * @brief Get a member of the ensemble
+   *
+   * @param imember Index of the member
+   */
+  const specfem::ensemble::member &get_member(const int imember) const {
+    return this->members.at(imember);
+  }
+  /**
+   * @brief Get the folder of the index file
+   *
+   */
+  std::string get_output_folder() const { return this->output_folder; }
+  /**
+   * @brief Get the folder storing the seismograms of a member
+   *
+   * @param imember Index of the member
+   */
+  std::string get_member_folder(const int imember) const;
+  /**
+   * @brief Get the number of groups of processes simulating members
+   *
+   * Every group simulates at least one member
+   *
+   * @param nprocs Number of processes of the job
+   */
+  int get_ngroups(const int nprocs) const;
+
+private:
+  std::vector<specfem::ensemble::member> members; ///< Members of the ensemble
+  std::string output_folder; ///< Folder of the index and seismograms
+  int ngroups;               ///< Number of groups of processes, one group for
+                             ///< every process if 0
+};
+
+/**
+ * @brief Elastic materials of a member
+ *
+ * @param materials Properties of every material of the parameter file
+ * @param values Material properties overridden by the member
+ * @return std::vector<specfem::material *> Materials of the member, owned by
+ * the caller
+ */
+std::vector<specfem::material *> assign_materials(
+    const std::vector<specfem::utilities::return_holder> &materials,
+    const std::vector<specfem::ensemble::material_value> &values);
+
+/**
+ * @brief Simulate the members of a sweep
+ *
+ * Collective. Processes are split into groups of consecutive ranks and
+ * members are assigned to groups round-robin. Every group sets the mesh of
+ * the parameter file up once, and the materials once for every set of
+ * material values. Seismograms of every member are written into its own
+ * folder, listed by an index file in the output folder of the sweep.
+ *
+ * Meshes are partitioned among the processes of a group, hence databases
+ * partitioned for another number of processes can't be read by groups.
+ * Members are simulated by specfem::simulation::simulation
+ *
+ * @param parameter_file Path of the parameter file
+ * @param sweep Sweep specification
+ * @param mpi Pointer to MPI object containing every process of the job
+ */
+void run(const std::string &parameter_file,
+         const specfem::ensemble::sweep &sweep, specfem::MPI::MPI *mpi);
+
+} // namespace ensemble
+} // namespace specfem
+
+#endif
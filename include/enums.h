@@ -28,11 +28,52 @@ enum type {
 namespace format {
 enum type {
   seismic_unix, ///< Seismic unix output format
-  ascii         ///< ASCII output format
+  ascii,        ///< ASCII output format
+  hdf5          ///< HDF5 output format
 };
 }
 } // namespace seismogram
 
+namespace assembly {
+enum type {
+  atomic, ///< Assemble element contributions using atomic operations
+  colored ///< Assemble element contributions one element color at a time
+          ///< without atomic operations
+};
+} // namespace assembly
+
+namespace reordering {
+enum type {
+  none,         ///< Keep element order of the mesher
+  morton,       ///< Order elements along a Morton (Z-order) curve of element
+                ///< centroids
+  cuthill_mckee ///< Reverse Cuthill-McKee ordering of the element adjacency
+                ///< graph
+};
+} // namespace reordering
+
+namespace absorbing {
+enum type {
+  damp,   ///< Damp the velocity of the absorbing points
+  record, ///< Damp the velocity and store the traction of every point
+  replay  ///< Apply stored tractions instead of damping the velocity
+};
+} // namespace absorbing
+
+namespace injection {
+enum type {
+  record, ///< Record the velocity and stress of the points of a contour
+  inject  ///< Inject recorded velocities and stresses on absorbing points
+};
+} // namespace injection
+
+namespace misfit {
+enum type {
+  l2,               ///< Half the squared L2 norm of the residuals
+  cross_correlation ///< Half the squared cross-correlation traveltime shift
+};
+} // namespace misfit
+
 } // namespace specfem
 
 #endif
@@ -0,0 +1,114 @@
+#ifndef FIRST_TOUCH_H
+#define FIRST_TOUCH_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief NUMA aware placement of the arrays read by the stiffness kernels on
+ * host backends
+ *
+ * Pages of host memory are placed on the NUMA domain of the thread writing
+ * them first. Element and point arrays are computed during setup by kernels
+ * whose loops don't follow the elements of the domains, or by a single
+ * thread on the host, hence their pages end up on a single NUMA domain.
+ * Arrays are copied to views allocated without initialization using the
+ * element-to-thread distribution of the stiffness kernels: every launch
+ * splits its elements into contiguous blocks, one per thread, and the copy
+ * splits the same elements the same way. Placement is only effective if host
+ * threads are bound, see specfem::binding. Views are kept on device backends.
+ *
+ */
+namespace first_touch {
+
+/**
+ * @brief Indices of every kernel launch, in launch order
+ *
+ * Element launches store spectral elements (ispec), point launches store
+ * global points (iglob)
+ *
+ */
+using launches = std::vector<std::vector<int> >;
+
+/**
+ * @brief Compute the points of every launch of a stiffness kernel
+ *
+ * A point is assigned to the first element referencing it. Points of a
+ * launch are ordered by the position of their element in the launch
+ *
+ * @param elements Elements of every launch, indices of the first dimension of
+ * ibool
+ * @param ibool Global number for every quadrature point
+ * @param nglob Number of global points
+ * @return specfem::first_touch::launches Points of every launch
+ */
+specfem::first_touch::launches
+point_launches(const specfem::first_touch::launches &elements,
+               const specfem::kokkos::HostElementMirror3d<int> ibool,
+               const int nglob);
+
+/**
+ * @brief Place an element array
+ *
+ * Elements which aren't in any launch are placed after the last launch.
+ * Views which aren't allocated are kept
+ *
+ * @param view Element array (ispec, iz, ix), replaced by the placed copy
+ * @param elements Elements of every launch
+ */
+void place(specfem::kokkos::DeviceElementView3d<type_real> &view,
+           const specfem::first_touch::launches &elements);
+
+/**
+ * @brief Place a point array
+ *
+ * Points which aren't in any launch are placed after the last launch
+ *
+ * @param view Point array (iglob, icomponent), replaced by the placed copy
+ * @param points Points of every launch
+ */
+void place(specfem::kokkos::DeviceFieldView2d<type_real> &view,
+           const specfem::first_touch::launches &points);
+
+/**
+ * @brief Place a point array
+ *
+ * Points which aren't in any launch are placed after the last launch
+ *
+ * @param view Point array (iglob), replaced by the placed copy
+ * @param points Points of every launch
+ */
+void place(specfem::kokkos::DeviceView1d<type_real> &view,
+           const specfem::first_touch::launches &points);
+
+/**
+ * @brief Place the partial derivatives at every quadrature point
+ *
+ * Host mirrors are assigned again. Records of affine elements are small and
+ * aren't placed
+ *
+ * @param partial_derivatives Partial derivatives
+ * @param elements Elements of every launch
+ */
+void place(specfem::compute::partial_derivatives &partial_derivatives,
+           const specfem::first_touch::launches &elements);
+
+/**
+ * @brief Place the material properties at every quadrature point
+ *
+ * Host mirrors are assigned again. Host only properties are released after
+ * setup and aren't placed
+ *
+ * @param properties Material properties
+ * @param elements Elements of every launch
+ */
+void place(specfem::compute::properties &properties,
+           const specfem::first_touch::launches &elements);
+
+} // namespace first_touch
+} // namespace specfem
+
+#endif
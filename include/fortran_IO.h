@@ -2,24 +2,29 @@
 #define FORTRAN_IO_H
 
 #include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include <cstddef>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace specfem {
 namespace fortran_IO {
 
-void fortran_IO(std::ifstream &stream, int &buffer_length);
-void fortran_read_value(bool *value, std::ifstream &stream, int &buffer_length);
-void fortran_read_value(std::string *value, std::ifstream &stream,
+void fortran_IO(std::istream &stream, int &buffer_length);
+void fortran_read_value(bool *value, std::istream &stream, int &buffer_length);
+void fortran_read_value(std::string *value, std::istream &stream,
                         int &buffer_length);
-void fortran_read_value(type_real *value, std::ifstream &stream,
+void fortran_read_value(type_real *value, std::istream &stream,
                         int &buffer_length);
-void fortran_read_value(int *value, std::ifstream &stream, int &buffer_length);
+void fortran_read_value(int *value, std::istream &stream, int &buffer_length);
 template <typename T>
 void specfem::fortran_IO::fortran_read_value(std::vector<T> *value,
-                                             std::ifstream &stream,
+                                             std::istream &stream,
                                              int &buffer_length) {
   int nsize = value->size();
   std::vector<T> &rvalue = *value;
@@ -32,7 +37,7 @@ void specfem::fortran_IO::fortran_read_value(std::vector<T> *value,
 }
 
 template <typename T, typename... Args>
-void fortran_IO(std::ifstream &stream, int &buffer_length, T *value,
+void fortran_IO(std::istream &stream, int &buffer_length, T *value,
                 Args... values) {
 
   specfem::fortran_IO::fortran_read_value(value, stream, buffer_length);
@@ -45,14 +50,16 @@ void fortran_IO(std::ifstream &stream, int &buffer_length, T *value,
  *
  * @tparam Args Argument can be of the type bool, int, type_real, string,
  * vector<T = bool, int, type_real, string>
- * @param stream An open file stream.
+ * @param stream An open file stream or a buffer holding the file.
  * @param values Comma separated list of variable addresses to be read.
  */
 template <typename... Args>
-void fortran_read_line(std::ifstream &stream, Args... values) {
+void fortran_read_line(std::istream &stream, Args... values) {
   int buffer_length;
 
-  if (!stream.is_open()) {
+  // Streams that failed before reaching the end, e.g. files that couldn't be
+  // opened
+  if (stream.fail() && !stream.eof()) {
     throw std::runtime_error("Could not find fortran file to read");
   }
 
@@ -62,6 +69,231 @@ void fortran_read_line(std::ifstream &stream, Args... values) {
   stream.read(reinterpret_cast<char *>(&buffer_length), fint);
   return;
 }
+namespace impl {
+/**
+ * @brief Size in bytes of a value of type T in a record. Reals are stored in
+ * double precision
+ *
+ */
+template <typename T> constexpr int nbytes() {
+  static_assert(std::is_same<T, int>::value ||
+                    std::is_same<T, type_real>::value,
+                "Records hold int or type_real values");
+  return std::is_same<T, int>::value ? fint : fdouble;
+}
+
+/**
+ * @brief Decode a value of type T from a record
+ *
+ */
+template <typename T> T decode(const char *record) {
+  if constexpr (std::is_same<T, int>::value) {
+    int value;
+    std::memcpy(&value, record, fint);
+    return value;
+  } else {
+    double value;
+    std::memcpy(&value, record, fdouble);
+    return static_cast<T>(value);
+  }
+}
+
+template <typename T, typename... Properties>
+int record_bytes(const Kokkos::View<T *, Properties...> &) {
+  return nbytes<T>();
+}
+
+template <typename T, typename... Properties>
+int record_bytes(const Kokkos::View<T **, Properties...> &column) {
+  return column.extent(1) * nbytes<T>();
+}
+
+template <typename T, typename... Properties>
+void decode_column(const char *&record, const int irecord,
+                   const Kokkos::View<T *, Properties...> &column) {
+  column(irecord) = decode<T>(record);
+  record += nbytes<T>();
+}
+
+template <typename T, typename... Properties>
+void decode_column(const char *&record, const int irecord,
+                   const Kokkos::View<T **, Properties...> &column) {
+  const int ncolumns = column.extent(1);
+  for (int i = 0; i < ncolumns; i++) {
+    column(irecord, i) = decode<T>(record);
+    record += nbytes<T>();
+  }
+}
+} // namespace impl
+
+/**
+ * @brief Reader of Fortran unformatted sequential records stored in memory
+ *
+ * Records are decoded in place from a memory-mapped file or from a buffer
+ * holding the file, e.g. a database read by
+ * IO::fortran_database::read_database_file. Record markers are validated
+ * for every record and values are copied without intermediate allocations.
+ *
+ */
+class record_reader {
+public:
+  /**
+   * @brief Memory-map a file
+   *
+   * @param filename Name of the Fortran unformatted file
+   */
+  record_reader(const std::string &filename);
+  /**
+   * @brief Read records from a buffer. The buffer is not copied and must
+   * outlive the reader
+   *
+   * @param data Pointer to the first record marker
+   * @param size Size of the buffer in bytes
+   */
+  record_reader(const char *data, const std::size_t size)
+      : data(data), size(size){};
+  // The mapping is owned by a single reader
+  record_reader(const record_reader &) = delete;
+  record_reader &operator=(const record_reader &) = delete;
+  /**
+   * @brief Unmap the file
+   *
+   */
+  ~record_reader();
+  /**
+   * @brief Get the offset of the next record in bytes
+   *
+   */
+  std::size_t tell() const { return this->position; }
+  /**
+   * @brief Check if every record was read
+   *
+   */
+  bool eof() const { return this->position >= this->size; }
+  /**
+   * @brief Get the length in bytes of the next record
+   *
+   */
+  int record_length() const;
+  /**
+   * @brief Read a record, see specfem::fortran_IO::fortran_read_line
+   *
+   * @tparam Args Argument can be of the type bool, int, type_real, string,
+   * vector<T = bool, int, type_real, string>
+   * @param values Comma separated list of variable addresses to be read.
+   */
+  template <typename... Args> void read_line(Args... values) {
+    int remaining;
+    const char *record = this->begin_record(remaining);
+    const int length = remaining;
+    (this->read_value(values, record, remaining), ...);
+    if (remaining != 0)
+      throw std::runtime_error("Error reading fortran file");
+    this->end_record(length);
+  }
+  /**
+   * @brief Read consecutive records of identical layout into columns
+   *
+   * Record irecord holds, in order, one value per column. Columns of type
+   * Kokkos::View<T *> store a single value of the record at column(irecord).
+   * Columns of type Kokkos::View<T **> store column.extent(1) consecutive
+   * values at column(irecord, :). T is int or type_real.
+   *
+   * @code
+   * // Records of the form (ipoin, x, z)
+   * specfem::kokkos::HostView1d<int> ipoin("ipoin", npgeo);
+   * specfem::kokkos::HostView2d<type_real> coordinates("xz", npgeo, 2);
+   * reader.read_records(npgeo, ipoin, coordinates);
+   * @endcode
+   *
+   * @param nrecords Number of records to read
+   * @param columns Host views storing the values of every record
+   */
+  template <typename... Columns>
+  void read_records(const int nrecords, const Columns &...columns) {
+    if (((static_cast<int>(columns.extent(0)) < nrecords) || ...))
+      throw std::runtime_error("Columns are smaller than the records");
+
+    const int length = (impl::record_bytes(columns) + ...);
+    for (int irecord = 0; irecord < nrecords; irecord++) {
+      int remaining;
+      const char *record = this->begin_record(remaining);
+      if (remaining != length)
+        throw std::runtime_error("Error reading fortran file");
+      (impl::decode_column(record, irecord, columns), ...);
+      this->end_record(length);
+    }
+  }
+
+private:
+  /**
+   * @brief Validate the leading marker of the next record and the size of
+   * the record
+   *
+   * @param length Length of the record in bytes
+   * @return const char* Pointer to the first value of the record
+   */
+  const char *begin_record(int &length);
+  /**
+   * @brief Validate the trailing marker of the record and move to the next
+   * record
+   *
+   * @param length Length of the record in bytes
+   */
+  void end_record(const int length);
+
+  void read_value(bool *value, const char *&record, int &remaining) const;
+  void read_value(int *value, const char *&record, int &remaining) const;
+  void read_value(type_real *value, const char *&record, int &remaining) const;
+  void read_value(std::string *value, const char *&record,
+                  int &remaining) const;
+  template <typename T>
+  void read_value(std::vector<T> *value, const char *&record,
+                  int &remaining) const {
+    std::vector<T> &rvalue = *value;
+    for (int i = 0; i < rvalue.size(); i++) {
+      if constexpr (std::is_same<T, bool>::value) {
+        bool element;
+        this->read_value(&element, record, remaining);
+        rvalue[i] = element;
+      } else {
+        this->read_value(&rvalue[i], record, remaining);
+      }
+    }
+  }
+
+  const char *data = nullptr; ///< First byte of the records
+  std::size_t size = 0;       ///< Size of the records in bytes
+  std::size_t position = 0;   ///< Offset of the next record
+  void *mapping = nullptr;    ///< Memory-mapped file, if mapped
+};
+
+/**
+ * @brief Read consecutive records of identical layout from a stream
+ *
+ * Every record is read with a single stream read and decoded by
+ * specfem::fortran_IO::record_reader::read_records
+ *
+ * @param stream An open file stream or a buffer holding the file.
+ * @param nrecords Number of records to read
+ * @param columns Host views storing the values of every record
+ */
+template <typename... Columns>
+void fortran_read_records(std::istream &stream, const int nrecords,
+                          const Columns &...columns) {
+  if (stream.fail() && !stream.eof()) {
+    throw std::runtime_error("Could not find fortran file to read");
+  }
+
+  const std::size_t length = (impl::record_bytes(columns) + ...);
+  std::vector<char> block(nrecords * (length + 2 * fint));
+  stream.read(block.data(), block.size());
+  if (stream.gcount() != static_cast<std::streamsize>(block.size()))
+    throw std::runtime_error("Error reading fortran file");
+
+  specfem::fortran_IO::record_reader reader(block.data(), block.size());
+  reader.read_records(nrecords, columns...);
+}
 } // namespace fortran_IO
 } // namespace specfem
 
@@ -0,0 +1,150 @@
+#ifndef GLL_TABLES_H
+#define GLL_TABLES_H
+
+namespace specfem {
+namespace quadrature {
+
+/**
+ * @brief Gauss-Lobatto-Legendre quadrature of NGLL points known at compile
+ * time
+ *
+ * Same quantities as specfem::quadrature::quadrature with alpha = beta = 0:
+ *
+ * @code
+ * hprime(i, j) = derivative of the Lagrange polynomial j at point i
+ * hprimewgll(i, j) = hprime(j, i) * w(j)
+ * @endcode
+ *
+ * @tparam T Floating point type of the values
+ * @tparam NGLL Number of quadrature points
+ */
+template <typename T, int NGLL> struct gll_table {
+  static_assert(NGLL >= 2 && NGLL <= 10,
+                "Compile-time GLL tables exist for 2 to 10 points");
+
+  T xi[NGLL];               ///< Quadrature points
+  T w[NGLL];                ///< Quadrature weights
+  T hprime[NGLL][NGLL];     ///< Derivatives of the Lagrange polynomials
+  T hprimewgll[NGLL][NGLL]; ///< Transposed derivatives weighted by the
+                            ///< quadrature weights
+};
+
+namespace impl {
+
+constexpr long double pi = 3.141592653589793238462643383279502884L;
+
+// Cosine of x in [0, pi] from its Taylor series
+constexpr long double cos(const long double x) {
+  long double term = 1.0L;
+  long double sum = 1.0L;
+  for (int k = 1; k < 40; k++) {
+    term *= -x * x / ((2 * k - 1) * (2 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr long double abs(const long double x) { return (x < 0.0L) ? -x : x; }
+
+// Legendre polynomials of degree n and n - 1 at x
+constexpr void legendre(const int n, const long double x, long double &pn,
+                        long double &pnm1) {
+  long double p0 = 1.0L;
+  long double p1 = x;
+  for (int k = 2; k <= n; k++) {
+    const long double p2 = ((2 * k - 1) * x * p1 - (k - 1) * p0) / k;
+    p0 = p1;
+    p1 = p2;
+  }
+  pn = p1;
+  pnm1 = p0;
+}
+
+} // namespace impl
+
+/**
+ * @brief Compute the GLL quadrature of NGLL points at compile time
+ *
+ * Points are the roots of (1 - x^2) P'_n(x), n = NGLL - 1, found by Newton
+ * iterations from the Chebyshev-Gauss-Lobatto points in long double
+ * precision. Weights are 2 / (n (n + 1) P_n(x)^2)
+ *
+ * @tparam T Floating point type of the values
+ * @tparam NGLL Number of quadrature points
+ * @return constexpr gll_table<T, NGLL> Points, weights and derivatives
+ */
+template <typename T, int NGLL>
+constexpr gll_table<T, NGLL> compute_gll_table() {
+  constexpr int n = NGLL - 1;
+  long double xi[NGLL] = {};
+  long double pn[NGLL] = {};
+
+  for (int i = 0; i < NGLL; i++) {
+    long double x = -impl::cos(impl::pi * i / n);
+    for (int iter = 0; iter < 100; iter++) {
+      long double p = 0.0L;
+      long double pnm1 = 0.0L;
+      impl::legendre(n, x, p, pnm1);
+      const long double dx = (x * p - pnm1) / ((n + 1) * p);
+      x -= dx;
+      if (impl::abs(dx) < 1e-30L)
+        break;
+    }
+    xi[i] = x;
+  }
+
+  // End points are exact and the middle point of odd orders is 0
+  xi[0] = -1.0L;
+  xi[n] = 1.0L;
+  if (NGLL % 2 != 0)
+    xi[n / 2] = 0.0L;
+
+  gll_table<T, NGLL> table{};
+  for (int i = 0; i < NGLL; i++) {
+    long double pnm1 = 0.0L;
+    impl::legendre(n, xi[i], pn[i], pnm1);
+    table.xi[i] = static_cast<T>(xi[i]);
+    table.w[i] = static_cast<T>(2.0L / (n * (n + 1) * pn[i] * pn[i]));
+  }
+
+  long double hprime[NGLL][NGLL] = {};
+  for (int i = 0; i < NGLL; i++) {
+    for (int j = 0; j < NGLL; j++) {
+      if (i == 0 && j == 0) {
+        hprime[i][j] = -0.25L * n * (n + 1);
+      } else if (i == n && j == n) {
+        hprime[i][j] = 0.25L * n * (n + 1);
+      } else if (i != j) {
+        hprime[i][j] = pn[i] / (pn[j] * (xi[i] - xi[j]));
+      }
+    }
+  }
+
+  for (int i = 0; i < NGLL; i++) {
+    for (int j = 0; j < NGLL; j++) {
+      table.hprime[i][j] = static_cast<T>(hprime[i][j]);
+      table.hprimewgll[i][j] = static_cast<T>(
+          hprime[j][i] * 2.0L / (n * (n + 1) * pn[j] * pn[j]));
+    }
+  }
+
+  return table;
+}
+
+/**
+ * @brief GLL quadrature of NGLL points evaluated at compile time
+ *
+ * Kernels copy the table into their closure, hence device kernels read it
+ * from kernel parameter memory and loops with compile-time indices fold the
+ * values into constants
+ *
+ * @tparam T Floating point type of the values
+ * @tparam NGLL Number of quadrature points
+ */
+template <typename T, int NGLL>
+inline constexpr gll_table<T, NGLL> gll_tables = compute_gll_table<T, NGLL>();
+
+} // namespace quadrature
+} // namespace specfem
+
+#endif
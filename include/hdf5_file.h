@@ -0,0 +1,117 @@
+#ifndef HDF5_FILE_H
+#define HDF5_FILE_H
+
+#include "../include/specfem_mpi.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace specfem {
+namespace writer {
+/**
+ * @brief Self-describing HDF5 output shared by every process
+ *
+ * Every process opens the same file. When SPECFEM is compiled with MPI and
+ * the HDF5 library supports parallel I/O, datasets are created and written
+ * collectively using MPI-IO, hence every method has to be called by every
+ * process in the same order.
+ *
+ */
+namespace hdf5 {
+
+/**
+ * @brief Check if SPECFEM was compiled with HDF5
+ *
+ * @return bool true if HDF5 files can be written
+ */
+bool available();
+
+/**
+ * @brief HDF5 file opened for writing
+ *
+ */
+class file {
+public:
+  /**
+   * @brief Create a file, truncating an existing file, or open an existing
+   * file
+   *
+   * @param filename Path of the file
+   * @param mpi Pointer to MPI object. nullptr if the file is written by a
+   * single process
+   * @param truncate If false the existing file is opened to update its
+   * datasets
+   */
+  file(const std::string &filename, const specfem::MPI::MPI *mpi = nullptr,
+       const bool truncate = true);
+  file(const file &) = delete;
+  file &operator=(const file &) = delete;
+  /**
+   * @brief Close the file
+   *
+   */
+  ~file();
+  /**
+   * @brief Create a chunked dataset
+   *
+   * @tparam T Type of values stored in the dataset (float, double or int)
+   * @param name Name of the dataset
+   * @param dims Dimensions of the dataset
+   * @param chunk Dimensions of a chunk. Chunks are clipped to the dimensions
+   * of the dataset
+   * @param compression Deflate level between 0 (no compression) and 9.
+   * Compressed chunks are shuffled before they are deflated
+   */
+  template <typename T>
+  void create_dataset(const std::string &name,
+                      const std::vector<std::size_t> &dims,
+                      const std::vector<std::size_t> &chunk,
+                      const int compression = 0);
+  /**
+   * @brief Write blocks of a dataset
+   *
+   * @tparam T Type of values (float, double or int)
+   * @param name Name of the dataset
+   * @param offsets Offset of every block written by this process, may be
+   * empty
+   * @param block Dimensions of a block
+   * @param data Values of the blocks, one block after the other in row major
+   * order
+   */
+  template <typename T>
+  void write(const std::string &name,
+             const std::vector<std::vector<std::size_t> > &offsets,
+             const std::vector<std::size_t> &block, const T *data);
+  /**
+   * @brief Create and write a dataset of strings
+   *
+   * Values are written by the main process
+   *
+   * @param name Name of the dataset
+   * @param values Values of the dataset
+   */
+  void write_strings(const std::string &name,
+                     const std::vector<std::string> &values);
+  /**
+   * @brief Attach an attribute to the root group
+   *
+   * @tparam T Type of the attribute (float, double or int)
+   * @param name Name of the attribute
+   * @param value Value of the attribute
+   */
+  template <typename T>
+  void write_attribute(const std::string &name, const T value);
+
+private:
+  const specfem::MPI::MPI *mpi; ///< Pointer to MPI object
+  std::int64_t id = -1;         ///< HDF5 identifier of the file
+  std::int64_t transfer = -1;   ///< HDF5 dataset transfer property list
+  std::string filename;         ///< Path of the file
+};
+
+} // namespace hdf5
+} // namespace writer
+} // namespace specfem
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef INJECTION_H
+#define INJECTION_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/memory_report.h"
+#include "../include/quadrature.h"
+#include "../include/stacey.h"
+#include <string>
+
+namespace specfem {
+namespace boundaries {
+
+/**
+ * @brief Wavefield injection of hybrid simulations
+ *
+ * A regional simulation records the velocity and the stress of the points of
+ * a closed rectangular contour at every timestep. Local simulations of a
+ * truncated mesh, whose absorbing edges follow the contour, inject the
+ * recorded wavefield through their Stacey absorbing points:
+ *
+ * - P-SV waves: acceleration += weight * sigma . n + Z v_inc
+ * - SH waves: acceleration += weight * sigma_y . n + rho_vs * v_inc
+ *
+ * where Z is the weighted impedance of the absorbing point, hence the
+ * absorbing points apply t_inc - Z (v - v_inc) and only absorb the part of
+ * the wavefield scattered by the local model. Values of a point are
+ *
+ * - P-SV waves: vx, vz, sigma_xx, sigma_zz, sigma_xz
+ * - SH waves: vy, sigma_xy, sigma_zy
+ *
+ * Every process of the regional simulation writes the values of its points
+ * to proc<rank>_injection.bin, chunk_size timesteps at a time. The file
+ * stores the size of a value, the number of points, of values and of
+ * timesteps as 32 bit integers, the start time and the time step as doubles,
+ * the coordinates of the points and then the values of every timestep.
+ * Points of the local simulation are matched to recorded points by their
+ * coordinates, hence both meshes share the quadrature points of the
+ * contour.
+ */
+class injection {
+
+public:
+  /**
+   * @brief Default constructor. There are no injection points
+   *
+   */
+  injection() : npoints(0), nvalues(0), nsteps(0), chunk_size(1){};
+  /**
+   * @brief Record the wavefield on a rectangular contour
+   *
+   * Points of the contour are the quadrature points lying on the rectangle
+   * of elastic elements whose centers are inside it. The stress of a point is
+   * computed inside its first element, in element order. Host views of the
+   * global numbering and the element types are read
+   *
+   * @param xmin Left side of the contour
+   * @param xmax Right side of the contour
+   * @param zmin Bottom side of the contour
+   * @param zmax Top side of the contour
+   * @param compute Pointer to the struct storing the global numbering and
+   * coordinates
+   * @param partial_derivatives Pointer to the partial derivatives
+   * @param properties Pointer to the material properties
+   * @param quadx Quadrature object in x dimension
+   * @param quadz Quadrature object in z dimension
+   * @param wave Wave type simulated by the elastic domain
+   * @param nsteps Number of timesteps of the simulation
+   * @param chunk_size Number of timesteps written to disk at once
+   * @param t0 Time of the first timestep
+   * @param dt Time step
+   * @param filename File storing the recorded values. Overwritten
+   */
+  injection(const type_real xmin, const type_real xmax, const type_real zmin,
+            const type_real zmax, const specfem::compute::compute *compute,
+            const specfem::compute::partial_derivatives *partial_derivatives,
+            const specfem::compute::properties *properties,
+            const specfem::quadrature::quadrature *quadx,
+            const specfem::quadrature::quadrature *quadz,
+            const specfem::wave::type wave, const int nsteps,
+            const int chunk_size, const type_real t0, const type_real dt,
+            const std::string filename);
+  /**
+   * @brief Inject a recorded wavefield through the absorbing points of the
+   * domain
+   *
+   * Every proc<rank>_injection.bin file of folder is read, hence the
+   * regional simulation can be partitioned differently. Timesteps are
+   * matched by time, steps outside the recorded time window inject nothing
+   *
+   * @param folder Folder storing the files of the regional simulation
+   * @param stacey Absorbing points of the elastic domain
+   * @param compute Pointer to the struct storing the global numbering and
+   * coordinates
+   * @param wave Wave type simulated by the elastic domain
+   * @param nsteps Number of timesteps of the simulation
+   * @param chunk_size Number of timesteps copied to the device at once
+   * @param t0 Time of the first timestep
+   * @param dt Time step, equal to the time step of the regional simulation
+   */
+  injection(const std::string folder,
+            const specfem::boundaries::stacey &stacey,
+            const specfem::compute::compute *compute,
+            const specfem::wave::type wave, const int nsteps,
+            const int chunk_size, const type_real t0, const type_real dt);
+  /**
+   * @brief Record or inject the wavefield of the next timestep
+   *
+   * Called once per stiffness interaction, hence once per timestep, after the
+   * absorbing points are damped
+   *
+   * @param field Displacement of the elastic domain
+   * @param velocity First derivative of the field of the domain
+   * @param acceleration Second derivative of the field of the domain
+   * @param exec_space Execution space instance used to launch the kernel.
+   * Fenced when a chunk is copied between the host and the device
+   */
+  void compute_interaction(
+      const specfem::kokkos::DeviceFieldView2d<type_real> field,
+      const specfem::kokkos::DeviceFieldView2d<type_real> velocity,
+      const specfem::kokkos::DeviceFieldView2d<type_real> acceleration,
+      const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Write the values of the last, partial chunk of a recording
+   *
+   */
+  void flush();
+  /**
+   * @brief Get the mode of the injection
+   *
+   */
+  specfem::injection::type get_mode() const { return this->mode; }
+  /**
+   * @brief Number of recorded or injected points
+   *
+   * @return int Number of points. Absorbing points shared by two edges are
+   * counted once for every edge
+   */
+  int get_npoints() const { return this->npoints; }
+  /**
+   * @brief Memory used by the views of the injection points
+   *
+   * @return specfem::memory::usage Bytes allocated on the device and the host
+   */
+  specfem::memory::usage memory_usage() const;
+
+private:
+  specfem::injection::type mode = specfem::injection::record; ///< Record or
+                                                              ///< inject
+  int npoints;       ///< Number of points
+  int nvalues;       ///< Number of values of every point
+  int nsteps;        ///< Number of timesteps of the simulation
+  int chunk_size;    ///< Number of timesteps of a chunk
+  int istep = 0;     ///< Timestep of the next call to compute_interaction
+  int nwritten = 0;  ///< Number of recorded timesteps written to disk
+  int offset = 0;    ///< Recorded timestep of the first timestep
+  int nrecorded = 0; ///< Number of recorded timesteps read from disk
+  std::string filename; ///< File storing the recorded values
+  specfem::kokkos::DeviceView3d<type_real, Kokkos::LayoutRight>
+      values; ///< Values of the timesteps of the current chunk (chunk_size,
+              ///< npoints, nvalues)
+  specfem::kokkos::HostMirror3d<type_real, Kokkos::LayoutRight>
+      h_values; ///< Host copy of the current chunk
+  specfem::kokkos::HostView3d<type_real, Kokkos::LayoutRight>
+      recorded; ///< Recorded values of the injected points (nrecorded,
+                ///< npoints, nvalues)
+  /**
+   * @name Recorded points
+   *
+   */
+  ///@{
+  specfem::kokkos::DeviceView2d<int> element; ///< Element and quadrature
+                                              ///< point (ispec, iz, ix) of
+                                              ///< every point
+  specfem::compute::connectivity_accessor ibool; ///< Global numbering
+  specfem::compute::geometry_accessor xix;       ///< Partial derivatives
+  specfem::compute::geometry_accessor xiz;       ///< Partial derivatives
+  specfem::compute::geometry_accessor gammax;    ///< Partial derivatives
+  specfem::compute::geometry_accessor gammaz;    ///< Partial derivatives
+  specfem::compute::property_accessor mu;        ///< Shear modulus
+  specfem::compute::property_accessor lambdaplus2mu; ///< Lambda + 2 mu
+  specfem::kokkos::DeviceView2d<type_real> hprime_xx; ///< Derivatives of the
+                                                      ///< polynomials in x
+  specfem::kokkos::DeviceView2d<type_real> hprime_zz; ///< Derivatives of the
+                                                      ///< polynomials in z
+  ///@}
+  /**
+   * @name Injected points
+   *
+   */
+  ///@{
+  specfem::kokkos::DeviceView1d<int> index; ///< Index in the fields of every
+                                            ///< absorbing point
+  specfem::kokkos::DeviceView2d<type_real> normal; ///< Unit outward normal of
+                                                   ///< every absorbing point
+  specfem::kokkos::DeviceView2d<type_real> impedance; ///< Weighted impedances
+                                                      ///< of every absorbing
+                                                      ///< point
+  specfem::kokkos::DeviceView1d<type_real> weight; ///< Integration weight of
+                                                   ///< every absorbing point
+  ///@}
+  /**
+   * @brief Copy the recorded values of the chunk starting at istep to the
+   * device
+   *
+   */
+  void load_chunk(const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Append the recorded values of the first nchunk timesteps of the
+   * current chunk to the file
+   *
+   */
+  void write_chunk(const int nchunk);
+};
+
+} // namespace boundaries
+} // namespace specfem
+
+#endif
@@ -2,6 +2,8 @@
 #define JACOBIAN_H
 
 #include "../include/kokkos_abstractions.h"
+#include <Kokkos_Core.hpp>
+#include <tuple>
 /**
  * Jacobian namespace contains overloaded functions for serial (without Kokkos)
  * and Kokkos implementations (using team policy)
@@ -232,6 +234,51 @@ compute_inverted_derivatives(
     const specfem::kokkos::HostView2d<type_real> s_coorg, const int ngnod,
     const type_real xi, const type_real gamma);
 
+/**
+ * @brief Compute inverted partial derivatives and the jacobian at \f$ (\xi,
+ * \gamma) \f$ on the device
+ *
+ * The sums over control nodes run serially within the calling thread, hence
+ * the function can be called from any level of a device team policy.
+ *
+ * @tparam ViewType View type of dershape2D, e.g. a subview of a device view
+ * @param s_coorg scratch view of coorg subviewed at required element
+ * @param ngnod Total number of control nodes per element
+ * @param dershape2D derivative of shape function matrix calculated at (xi,
+ * gamma)
+ * @param xix \f$ \partial \xi/ \partial x \f$
+ * @param gammax \f$ \partial \gamma/ \partial x \f$
+ * @param xiz \f$ \partial \xi/ \partial z \f$
+ * @param gammaz \f$ \partial \gamma/ \partial z \f$
+ * @param jacobian Jacobian of the transformation
+ */
+template <typename ViewType>
+KOKKOS_INLINE_FUNCTION void compute_inverted_derivatives(
+    const specfem::kokkos::DeviceScratchView2d<type_real> s_coorg,
+    const int ngnod, const ViewType &dershape2D, type_real &xix,
+    type_real &gammax, type_real &xiz, type_real &gammaz,
+    type_real &jacobian) {
+
+  type_real xxi = 0.0;
+  type_real zxi = 0.0;
+  type_real xgamma = 0.0;
+  type_real zgamma = 0.0;
+
+  for (int in = 0; in < ngnod; in++) {
+    xxi += dershape2D(0, in) * s_coorg(0, in);
+    zxi += dershape2D(0, in) * s_coorg(1, in);
+    xgamma += dershape2D(1, in) * s_coorg(0, in);
+    zgamma += dershape2D(1, in) * s_coorg(1, in);
+  }
+
+  jacobian = xxi * zgamma - xgamma * zxi;
+
+  xix = zgamma / jacobian;
+  gammax = -zxi / jacobian;
+  xiz = -xgamma / jacobian;
+  gammaz = xxi / jacobian;
+}
+
 } // namespace jacobian
 
 #endif
@@ -3,7 +3,11 @@
 
 #include "../include/config.h"
 #include <Kokkos_Core.hpp>
+#include <Kokkos_Graph.hpp>
 #include <Kokkos_ScatterView.hpp>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 
 namespace specfem {
 
@@ -27,6 +31,17 @@ using DevExecSpace = Kokkos::DefaultExecutionSpace;
 ///@{
 using HostMemSpace = Kokkos::HostSpace;
 using DevMemSpace = Kokkos::DefaultExecutionSpace::memory_space;
+/**
+ * @note Page locked host memory on GPU backends, i.e. device to host copies
+ * don't need an intermediate buffer. Host memory on other backends
+ */
+#if defined(KOKKOS_ENABLE_CUDA)
+using HostPinnedMemSpace = Kokkos::CudaHostPinnedSpace;
+#elif defined(KOKKOS_ENABLE_HIP)
+using HostPinnedMemSpace = Kokkos::Experimental::HIPHostPinnedSpace;
+#else
+using HostPinnedMemSpace = HostMemSpace;
+#endif
 ///@}
 
 /** @name View Layout
@@ -37,6 +52,52 @@ using DevMemSpace = Kokkos::DefaultExecutionSpace::memory_space;
  */
 ///@{
 using LayoutWrapper = Kokkos::LayoutRight;
+
+/**
+ * @brief Layouts of the view families of the solver
+ *
+ * Kernels access views through operator(), hence they don't depend on the
+ * layout of a family. Specialize for an execution space to change its
+ * defaults
+ *
+ * @tparam ExecSpace Execution space accessing the views
+ */
+template <typename ExecSpace> struct layout_policy {
+  using field = Kokkos::LayoutRight;    ///< Global fields (iglob, icomp)
+  using element = Kokkos::LayoutRight;  ///< Element arrays (ispec, iz, ix)
+  using receiver = Kokkos::LayoutRight; ///< Seismograms (isig_step, isig,
+                                        ///< irec, idim)
+};
+
+/**
+ * @brief Layout of a family, selected at configure time using
+ * -D<FAMILY>_LAYOUT=left or right. The default of the device execution space
+ * is used otherwise
+ *
+ */
+#if defined(SPECFEM_FIELD_LAYOUT_LEFT)
+using FieldLayout = Kokkos::LayoutLeft;
+#elif defined(SPECFEM_FIELD_LAYOUT_RIGHT)
+using FieldLayout = Kokkos::LayoutRight;
+#else
+using FieldLayout = layout_policy<DevExecSpace>::field;
+#endif
+
+#if defined(SPECFEM_ELEMENT_LAYOUT_LEFT)
+using ElementLayout = Kokkos::LayoutLeft;
+#elif defined(SPECFEM_ELEMENT_LAYOUT_RIGHT)
+using ElementLayout = Kokkos::LayoutRight;
+#else
+using ElementLayout = layout_policy<DevExecSpace>::element;
+#endif
+
+#if defined(SPECFEM_RECEIVER_LAYOUT_LEFT)
+using ReceiverLayout = Kokkos::LayoutLeft;
+#elif defined(SPECFEM_RECEIVER_LAYOUT_RIGHT)
+using ReceiverLayout = Kokkos::LayoutRight;
+#else
+using ReceiverLayout = layout_policy<DevExecSpace>::receiver;
+#endif
 ///@}
 
 /** @name Scratch Memory Spaces
@@ -110,6 +171,18 @@ using HostView3d = Kokkos::View<T ***, L, HostMemSpace>;
  */
 template <typename T, typename L = LayoutWrapper>
 using HostView4d = Kokkos::View<T ****, L, HostMemSpace>;
+/**
+ * @tparam T view datatype
+ * @tparam L view layout - default layout is LayoutRight
+ */
+template <typename T, typename L = LayoutWrapper>
+using HostPinnedView3d = Kokkos::View<T ***, L, HostPinnedMemSpace>;
+/**
+ * @tparam T view datatype
+ * @tparam L view layout - default layout is LayoutRight
+ */
+template <typename T, typename L = LayoutWrapper>
+using HostPinnedView4d = Kokkos::View<T ****, L, HostPinnedMemSpace>;
 ///@}
 
 /** @name Host Scatter Views
@@ -208,6 +281,42 @@ using HostMirror4d = typename DeviceView4d<T, L>::HostMirror;
  */
 template <typename T, typename L = LayoutWrapper>
 using HostMirror5d = typename DeviceView5d<T, L>::HostMirror;
+
+/**
+ * @brief Get the host mirror of a device view, allocating it on first use
+ *
+ * Host mirrors of views which the host only reads on demand are allocated
+ * lazily, hence GPU builds don't keep a host copy of arrays the host never
+ * touches. On host backends the mirror is the device view itself
+ *
+ * @param mirror Host mirror, allocated if it isn't yet
+ * @param view Device view mirrored on the host
+ * @return MirrorType& Allocated host mirror
+ */
+template <typename MirrorType, typename ViewType>
+MirrorType &lazy_mirror(MirrorType &mirror, const ViewType &view) {
+  if (mirror.data() == nullptr)
+    mirror = Kokkos::create_mirror_view(view);
+  return mirror;
+}
+///@}
+
+/** @name View families
+ *
+ * Views of a family share a layout, see layout_policy
+ */
+///@{
+template <typename T> using DeviceFieldView2d = DeviceView2d<T, FieldLayout>;
+template <typename T> using HostFieldMirror2d = HostMirror2d<T, FieldLayout>;
+template <typename T>
+using DeviceElementView3d = DeviceView3d<T, ElementLayout>;
+template <typename T>
+using HostElementMirror3d = HostMirror3d<T, ElementLayout>;
+template <typename T> using HostElementView3d = HostView3d<T, ElementLayout>;
+template <typename T>
+using DeviceReceiverView4d = DeviceView4d<T, ReceiverLayout>;
+template <typename T>
+using HostReceiverMirror4d = HostMirror4d<T, ReceiverLayout>;
 ///@}
 
 // Scratch Views
@@ -265,6 +374,42 @@ template <typename T, typename L = LayoutWrapper>
 using DeviceScratchView3d =
     Kokkos::View<T ***, L, DevScratchSpace,
                  Kokkos::MemoryTraits<Kokkos::Unmanaged> >;
+/**
+ * @brief Scratch view with extents known at compile time
+ *
+ * @tparam T view datatype
+ * @tparam N extent of first dimension
+ * @tparam M extent of second dimension
+ * @tparam L view layout - default layout is LayoutRight
+ */
+template <typename T, int N, int M, typename L = LayoutWrapper>
+using StaticDeviceScratchView2d =
+    Kokkos::View<T[N][M], L, DevScratchSpace,
+                 Kokkos::MemoryTraits<Kokkos::Unmanaged> >;
+/**
+ * @brief Scratch view with extent known at compile time
+ *
+ * @tparam T view datatype
+ * @tparam N extent of the view
+ * @tparam L view layout - default layout is LayoutRight
+ */
+template <typename T, int N, typename L = LayoutWrapper>
+using StaticDeviceScratchView1d =
+    Kokkos::View<T[N], L, DevScratchSpace,
+                 Kokkos::MemoryTraits<Kokkos::Unmanaged> >;
+/**
+ * @brief Scratch view with extents known at compile time
+ *
+ * @tparam T view datatype
+ * @tparam N extent of first dimension
+ * @tparam M extent of second dimension
+ * @tparam K extent of third dimension
+ * @tparam L view layout - default layout is LayoutRight
+ */
+template <typename T, int N, int M, int K, typename L = LayoutWrapper>
+using StaticDeviceScratchView3d =
+    Kokkos::View<T[N][M][K], L, DevScratchSpace,
+                 Kokkos::MemoryTraits<Kokkos::Unmanaged> >;
 ///@}
 
 // Loop Strategies
@@ -324,6 +469,46 @@ using HostTeam = Kokkos::TeamPolicy<HostExecSpace>;
 using DeviceTeam = Kokkos::TeamPolicy<DevExecSpace>;
 ///@}
 
+/** @name Graphs
+ */
+///@{
+using DeviceGraph = Kokkos::Experimental::Graph<DevExecSpace>;
+using DeviceGraphNode = Kokkos::Experimental::GraphNodeRef<DevExecSpace>;
+///@}
+
+/**
+ * @brief Launch a kernel or record it inside a graph
+ *
+ * If node is a nullptr the kernel is launched immediately. Otherwise the
+ * kernel is recorded as a successor of node and node is updated to refer to
+ * the recorded kernel. Only device kernels can be recorded.
+ *
+ * @tparam Policy Execution policy type
+ * @tparam Functor Kernel functor type
+ * @param label Kernel label
+ * @param policy Execution policy
+ * @param functor Kernel functor
+ * @param node Pointer to the graph node the kernel is recorded after
+ */
+template <typename Policy, typename Functor>
+void parallel_for(const std::string &label, const Policy &policy,
+                  const Functor &functor, DeviceGraphNode *node) {
+  if (node == nullptr) {
+    Kokkos::parallel_for(label, policy, functor);
+    return;
+  }
+
+  if constexpr (std::is_same_v<typename Policy::execution_space,
+                               DevExecSpace>) {
+    *node = node->then_parallel_for(label, policy, functor);
+  } else {
+    throw std::runtime_error("Kernel " + label +
+                             " cannot be recorded inside a device graph");
+  }
+
+  return;
+}
+
 } // namespace kokkos
 } // namespace specfem
 
@@ -38,13 +38,11 @@ specfem::kokkos::HostView2d<type_real> compute_lagrange_derivatives_GLL(
  * @brief Compute the derivatives of Jacobi functions at GLJ points
  * @note Please refer Nisser-Meyer et.al. 2007 equation (A27)
  *
- * @warning This function hasn't been tested yet. Could be potential source of
- * error.
- *
  * @param xiglj GLJ points
  * @param nglj Order used to approximate functions
  * @return specfem::kokkos::HostView2d<type_real> Derivates of Jacobi
- * polynomials at GLJ points
+ * polynomials at GLJ points, hprimeBar(i, j) is the derivative of the
+ * polynomial j at the point i
  */
 specfem::kokkos::HostView2d<type_real> compute_jacobi_derivatives_GLJ(
     const specfem::kokkos::HostView1d<type_real> xiglj, const int nglj);
@@ -78,9 +76,6 @@ void compute_lagrange_derivatives_GLL(
  * @brief Compute the derivatives of Jacobi functions at GLJ points
  * @note Please refer Nisser-Meyer et.al. 2007 equation (A27)
  *
- * @warning This function hasn't been tested yet. Could be potential source of
- * error.
- *
  * @param hprimeBar_ii Derivates of Jacobi polynomials at GLJ points
  * @param xiglj GLJ points
  * @param nglj Order used to approximate functions
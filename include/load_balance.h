@@ -0,0 +1,108 @@
+#ifndef LOAD_BALANCE_H
+#define LOAD_BALANCE_H
+
+#include "../include/config.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/specfem_mpi.h"
+#include "../include/timers.h"
+#include <string>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Load balance of the processes of a run
+ *
+ */
+namespace load_balance {
+
+/**
+ * @brief Work assigned to a process
+ *
+ */
+struct rank_load {
+  int nelastic = 0;     ///< Number of elastic elements
+  int nacoustic = 0;    ///< Number of acoustic elements
+  int nporoelastic = 0; ///< Number of poroelastic elements
+  int npml = 0;         ///< Number of PML elements
+  int nabsorbing = 0;   ///< Number of quadrature points on absorbing
+                        ///< boundaries
+  int nsources = 0;     ///< Number of sources located on the process
+  int nreceivers = 0;   ///< Number of receivers located on the process
+  int nneighbors = 0;   ///< Number of neighboring processes
+  int nhalo = 0;        ///< Number of values sent to neighbors by every
+                        ///< assembly
+
+  /**
+   * @brief Construct a process without work
+   *
+   */
+  rank_load(){};
+  /**
+   * @brief Count the elements of every type of a process
+   *
+   * Domains compute the elements of their type, hence element counts are
+   * the sizes of the element lists of the domains
+   *
+   * @param h_ispec_type Type of every spectral element
+   */
+  rank_load(const specfem::kokkos::HostMirror1d<specfem::elements::type>
+                h_ispec_type);
+};
+
+/**
+ * @brief Time a process spent computing during the time loop
+ *
+ * Interface exchanges include the time spent waiting for slower neighbors
+ * and outputs depend on the process writing them, hence they are excluded
+ *
+ * @param timers Timers of the run
+ * @return double Time in seconds
+ */
+double compute_seconds(const specfem::timers::timers &timers);
+
+/**
+ * @brief Load imbalance report
+ *
+ * Collective: gathers the work and compute time of every process. Prints
+ * the largest compute time relative to the mean, the fraction of the time
+ * loop lost waiting for the slowest process and the work of the slowest
+ * processes.
+ *
+ * @param load Work assigned to this process
+ * @param timers Timers of the run
+ * @param mpi Pointer to MPI object
+ * @param nworst Number of slowest processes printed
+ * @return std::string Report
+ */
+std::string print(const specfem::load_balance::rank_load &load,
+                  const specfem::timers::timers &timers,
+                  const specfem::MPI::MPI *mpi, const int nworst = 4);
+
+/**
+ * @brief Write the measured cost of every element of the serial mesh
+ *
+ * Collective: processes append their elements in turn. The weight of every
+ * element used to partition this run is scaled by the compute time of its
+ * process relative to its weight, normalized such that the total weight
+ * doesn't change. Partitioning the next run with these weights moves work
+ * away from slow processes. The file is read by
+ * specfem::partitioner::read_element_weights
+ *
+ * @param filename Path of the element weights file
+ * @param serial_ispec Index in the serial mesh of every element of this
+ * process
+ * @param element_weights Weight of every element of this process
+ * @param seconds Compute time of this process
+ * @param mpi Pointer to MPI object
+ */
+void write_element_weights(const std::string &filename,
+                           const std::vector<int> &serial_ispec,
+                           const std::vector<type_real> &element_weights,
+                           const double seconds,
+                           const specfem::MPI::MPI *mpi);
+
+} // namespace load_balance
+} // namespace specfem
+
+#endif
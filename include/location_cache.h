@@ -0,0 +1,135 @@
+#ifndef LOCATION_CACHE_H
+#define LOCATION_CACHE_H
+
+#include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/specfem_mpi.h"
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Binary cache of the locations of sources and stations
+ *
+ * Locating a batch of points searches the candidate elements of every
+ * process, runs Newton iterations and selects the owner of every point with
+ * collectives. The resulting (xi, gamma, ispec, islice) of every point are
+ * stored in a versioned binary file per batch and process. Runs locating the
+ * same points in the same mesh, e.g. runs of an inversion with a fixed
+ * station geometry, read the file instead. The cache is separate from the
+ * setup cache since stations and sources change more often than meshes.
+ *
+ */
+namespace location_cache {
+
+/**
+ * @brief Location of a point: (xi, gamma, ispec, islice). ispec is local to
+ * rank islice
+ *
+ */
+using location = std::tuple<type_real, type_real, int, int>;
+
+/**
+ * @brief Compute the key identifying the inputs of cached locations
+ *
+ * The key hashes the control nodes, the elements, the global numbering and
+ * the coordinates of the quadrature points of the mesh of this process, the
+ * quadrature points, the number of processes and the coordinates of the
+ * located points. Locations are only reused if every process finds its key,
+ * hence a change of the partitioning invalidates the cache of every process.
+ *
+ * @param coord (x, z) for every global quadrature point
+ * @param ibool Global number for every quadrature point
+ * @param xigll Quadrature points in x-dimension
+ * @param zigll Quadrature points in z-dimension
+ * @param x x coordinate of every point
+ * @param z z coordinate of every point
+ * @param coorg Value of every spectral element control nodes
+ * @param knods Global control element number for every control node
+ * @param mpi Pointer to specfem MPI object
+ * @return std::uint64_t Key of the cached locations
+ */
+std::uint64_t key(const specfem::kokkos::HostView2d<type_real> coord,
+                  const specfem::kokkos::HostElementMirror3d<int> ibool,
+                  const specfem::kokkos::HostMirror1d<type_real> xigll,
+                  const specfem::kokkos::HostMirror1d<type_real> zigll,
+                  const std::vector<type_real> &x,
+                  const std::vector<type_real> &z,
+                  const specfem::kokkos::HostView2d<type_real> coorg,
+                  const specfem::kokkos::HostView2d<int> knods,
+                  const specfem::MPI::MPI *mpi);
+
+/**
+ * @brief Get the cache file of a batch of points of this process
+ *
+ * @param directory Directory storing cache files
+ * @param name Name of the batch, e.g. stations
+ * @param mpi Pointer to MPI object
+ * @return std::string Cache file of this process
+ */
+std::string filename(const std::string &directory, const std::string &name,
+                     const specfem::MPI::MPI *mpi);
+
+/**
+ * @brief Load cached locations
+ *
+ * @param filename Cache file of this process
+ * @param key Key of the locations, see specfem::location_cache::key
+ * @param locations Location of every point
+ * @return bool false if the file doesn't exist, was written by another
+ * version or for another key. Locations are not modified in this case
+ */
+bool load(const std::string &filename, const std::uint64_t key,
+          std::vector<location> &locations);
+
+/**
+ * @brief Store locations in a cache file
+ *
+ * The file is written under a temporary name and renamed, hence concurrent
+ * runs never load a partially written file.
+ *
+ * @param filename Cache file of this process
+ * @param key Key of the locations, see specfem::location_cache::key
+ * @param locations Location of every point
+ */
+void save(const std::string &filename, const std::uint64_t key,
+          const std::vector<location> &locations);
+
+/**
+ * @brief Locate a batch of points, reading the locations from the cache if
+ * every process finds them
+ *
+ * Points are located with specfem::utilities::locate and stored in the cache
+ * otherwise. Collective over every process.
+ *
+ * @param filename Cache file of this process. Points are always located if
+ * empty
+ * @param coord (x, z) for every global quadrature point
+ * @param ibool Global number for every quadrature point
+ * @param xigll Quadrature points in x-dimension
+ * @param zigll Quadrature points in z-dimension
+ * @param x x coordinate of every point
+ * @param z z coordinate of every point
+ * @param coorg Value of every spectral element control nodes
+ * @param knods Global control element number for every control node
+ * @param mpi Pointer to specfem MPI object
+ * @return std::tuple<std::vector<location>, bool> Location of every point,
+ * and true if the locations were read from the cache
+ */
+std::tuple<std::vector<location>, bool>
+locate(const std::string &filename,
+       const specfem::kokkos::HostView2d<type_real> coord,
+       const specfem::kokkos::HostElementMirror3d<int> ibool,
+       const specfem::kokkos::HostMirror1d<type_real> xigll,
+       const specfem::kokkos::HostMirror1d<type_real> zigll,
+       const std::vector<type_real> &x, const std::vector<type_real> &z,
+       const specfem::kokkos::HostView2d<type_real> coorg,
+       const specfem::kokkos::HostView2d<int> knods,
+       const specfem::MPI::MPI *mpi);
+
+} // namespace location_cache
+} // namespace specfem
+
+#endif
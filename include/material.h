@@ -118,6 +118,13 @@ public:
   friend std::ostream &operator<<(std::ostream &out,
                                   const acoustic_material &h);
   specfem::elements::type get_ispec_type() { return ispec_type; };
+  /**
+   * @brief Get private acoustic material properties
+   *
+   * @return utilities::return_holder holder used to return acoustic material
+   * properties
+   */
+  utilities::return_holder get_properties() override;
   std::string print() const override;
 
 private:
@@ -56,8 +56,26 @@ struct material_ind {
    * @param numat Total number of different materials
    * @param mpi Pointer to a MPI object
    */
-  material_ind(std::ifstream &stream, const int ngnod, const int nspec,
+  material_ind(std::istream &stream, const int ngnod, const int nspec,
                const int numat, const specfem::MPI::MPI *mpi);
+  /**
+   * @brief Constructor used to assign allocated views from fortran database
+   * file
+   *
+   * @param stream Stream object for fortran binary file buffered to material
+   * definition section
+   * @param ngnod Number of control nodes per spectral element
+   * @param nspec Number of spectral elements
+   * @param numat Total number of different materials
+   * @param storage Allocated views (region_CPML, kmato, knods)
+   * @param store If false values are read and discarded, e.g. when storage
+   * is shared with another process writing it
+   * @param mpi Pointer to a MPI object
+   */
+  material_ind(std::istream &stream, const int ngnod, const int nspec,
+               const int numat,
+               const specfem::materials::material_ind &storage,
+               const bool store, const specfem::MPI::MPI *mpi);
 };
 } // namespace materials
 } // namespace specfem
@@ -0,0 +1,162 @@
+#ifndef MEMORY_REPORT_H
+#define MEMORY_REPORT_H
+
+#include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/specfem_mpi.h"
+#include <Kokkos_Core.hpp>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Accounting of the memory allocated by the views of the solver
+ *
+ */
+namespace memory {
+
+/**
+ * @brief Bytes allocated by the views of a struct
+ *
+ * Views are counted in host memory if the host can access their memory
+ * space, hence every view is host memory on host backends
+ *
+ */
+struct usage {
+  std::size_t device = 0; ///< Bytes allocated in device memory
+  std::size_t host = 0;   ///< Bytes allocated in host memory
+
+  /**
+   * @brief Add the allocation of a view
+   *
+   * @param view View to account for. Unallocated views are ignored
+   */
+  template <typename ViewType> void add(const ViewType &view) {
+    const std::size_t bytes =
+        view.span() * sizeof(typename ViewType::value_type);
+    if (Kokkos::SpaceAccessibility<
+            Kokkos::HostSpace, typename ViewType::memory_space>::accessible) {
+      this->host += bytes;
+    } else {
+      this->device += bytes;
+    }
+  }
+  /**
+   * @brief Add the allocation of a device view and of its host mirror
+   *
+   * The mirror is only counted if it doesn't share the allocation of the
+   * view
+   *
+   * @param view Device view
+   * @param mirror Host mirror of view
+   */
+  template <typename ViewType, typename MirrorType>
+  void add(const ViewType &view, const MirrorType &mirror) {
+    this->add(view);
+    if (mirror.data() != nullptr && mirror.data() != view.data())
+      this->add(mirror);
+  }
+
+  usage &operator+=(const usage &other) {
+    this->device += other.device;
+    this->host += other.host;
+    return *this;
+  }
+};
+
+/**
+ * @brief Log the memory resident after setup
+ *
+ * Collective: usages are reduced over every process, the report shows the
+ * largest usage of any process
+ *
+ * @param usages Name and usage of every struct
+ * @param mpi Pointer to MPI object
+ * @return std::string Report of the device and host memory of every struct.
+ * Only complete on the root process
+ */
+std::string print(const std::vector<std::pair<std::string, usage> > &usages,
+                  const specfem::MPI::MPI *mpi);
+
+/**
+ * @brief Track every labeled allocation of Kokkos views
+ *
+ * Kokkos tools callbacks tally the bytes allocated by every subsystem and
+ * memory space. The subsystem is the label of the view without its last
+ * component, e.g. specfem::compute::partial_derivatives for
+ * specfem::compute::partial_derivatives::xix. Needs to be called after
+ * Kokkos is initialized and replaces the allocation callbacks of a loaded
+ * tools library. Allocations made before the call aren't tracked
+ *
+ */
+void track_allocations();
+
+/**
+ * @brief Log the tracked allocations
+ *
+ * Collective: peak usage is reduced over every process
+ *
+ * @param mpi Pointer to MPI object
+ * @return std::string Report of the bytes currently allocated by every
+ * subsystem in every memory space on the root process, and of the peak usage
+ * of every memory space on the largest process. Only complete on the root
+ * process
+ */
+std::string print_tracked(const specfem::MPI::MPI *mpi);
+
+/**
+ * @brief Get the bytes allocated since allocations are tracked
+ *
+ * Deallocations aren't subtracted, hence the difference of two calls is the
+ * bytes allocated between them
+ *
+ * @return usage Bytes allocated in the host space and in every other memory
+ * space
+ */
+usage tracked_allocated();
+
+/**
+ * @brief Get the bytes currently allocated by tracked views
+ *
+ * @return usage Bytes allocated in the host space and in every other memory
+ * space
+ */
+usage tracked_current();
+
+/**
+ * @brief Sizes determining the memory of a simulation
+ *
+ */
+struct problem_size {
+  int nspec = 0;             ///< Number of spectral elements of the process
+  int ngllz = 0;             ///< Number of quadrature points in z dimension
+  int ngllx = 0;             ///< Number of quadrature points in x dimension
+  int ncomponents = 0;       ///< Number of field components times the
+                             ///< number of shots
+  int nsources = 0;          ///< Number of sources
+  int nreceivers = 0;        ///< Number of recorded receivers
+  int nseismogram_types = 0; ///< Number of recorded seismogram types
+  int nseismogram_steps = 0; ///< Number of seismogram samples stored on the
+                             ///< device
+};
+
+/**
+ * @brief Predict the memory resident after setup without allocating views
+ *
+ * The number of global points is estimated for a mesh of about square shape.
+ * Sources and receivers are assumed to be located on this process, hence
+ * the prediction is an upper bound for distributed runs
+ *
+ * @param size Sizes of the simulation
+ * @return std::vector<std::pair<std::string, usage> > Predicted usage of
+ * every struct in the order of the report of print
+ */
+std::vector<std::pair<std::string, usage> >
+estimate(const problem_size &size);
+
+} // namespace memory
+} // namespace specfem
+
+#endif
@@ -10,9 +10,12 @@
 #include "../include/mpi_interfaces.h"
 #include "../include/quadrature.h"
 #include "../include/read_mesh_database.h"
+#include "../include/reordering.h"
 #include "../include/specfem_mpi.h"
 #include "../include/surfaces.h"
 #include <Kokkos_Core.hpp>
+#include <memory>
+#include <vector>
 
 namespace specfem {
 
@@ -52,6 +55,10 @@ struct mesh {
       acfree_surface; ///< Struct used to store data required to implement
                       ///< acoustic free surface
 
+  specfem::surfaces::fluid_solid_edges
+      fluid_solid_edges; ///< Struct used to store the edges coupling acoustic
+                         ///< and elastic elements
+
   specfem::boundaries::forcing_boundary
       acforcing_boundary; ///< Struct used to store data required to implement
                           ///< acoustic forcing boundary
@@ -60,6 +67,26 @@ struct mesh {
                                                            ///< tangential nodes
 
   specfem::elements::axial_elements axial_nodes; ///< Defines axial nodes
+  bool axisym = false; ///< If true the mesh is the meridional half plane
+                       ///< x >= 0 of an axisymmetric model, the axis being
+                       ///< x = 0
+
+  int n_sls = 0; ///< Number of standard linear solids used to simulate
+                 ///< attenuation
+  type_real attenuation_f0_reference = 0.0; ///< Reference frequency at which
+                                            ///< the moduli of the materials
+                                            ///< are given
+  bool read_velocities_at_f0 = false; ///< If true velocities of the model
+                                      ///< are given at
+                                      ///< attenuation_f0_reference
+
+  std::vector<int> serial_ispec; ///< Index in the serial mesh of every
+                                 ///< spectral element. Empty if the mesh
+                                 ///< wasn't partitioned at startup
+
+  std::vector<std::shared_ptr<specfem::MPI::shared_window> >
+      node_storage; ///< Node shared windows storing coorg and material_ind
+                    ///< when the mesh is read with node_shared
 
   /**
    * @brief Default mesh constructor
@@ -72,9 +99,39 @@ struct mesh {
    *
    * @param filename Fortran binary database filename
    * @param mpi pointer to MPI object to manage communication
+   * @param node_shared If true coorg and material_ind are stored once per
+   * node in shared memory and are written by the first process of the node.
+   * Used when every process reads the same serial database. Every process of
+   * the node has to construct its mesh with node_shared
    */
   mesh(const std::string filename, std::vector<specfem::material *> &materials,
-       const specfem::MPI::MPI *mpi);
+       const specfem::MPI::MPI *mpi, const bool node_shared = false);
+
+  /**
+   * @brief Restrict a serial mesh to the elements of a partition
+   *
+   * Control nodes used by the partition are renumbered, entries of
+   * boundaries, surfaces and axial elements outside the partition are removed
+   * and MPI interfaces with the other partitions are generated. Node shared
+   * storage is released, hence every process of a node has to partition its
+   * mesh. The serial index of every kept element is stored in serial_ispec.
+   * Should be called before reorder_elements.
+   *
+   * @param element_partition Partition of every spectral element
+   * @param rank Partition kept by this rank
+   */
+  void partition(const std::vector<int> &element_partition, const int rank);
+
+  /**
+   * @brief Reorder spectral elements to improve cache locality
+   *
+   * Per element arrays and element indices stored in boundaries, surfaces and
+   * interfaces are permuted consistently. Should be called before compute
+   * structs are generated such that global numbering follows the new order.
+   *
+   * @param ordering Reordering type
+   */
+  void reorder_elements(const specfem::reordering::type ordering);
 
   /**
    * @brief User output
@@ -0,0 +1,91 @@
+#ifndef MESHER_H
+#define MESHER_H
+
+#include "../include/config.h"
+#include "../include/material.h"
+#include "../include/mesh.h"
+#include "../include/specfem_mpi.h"
+#include <array>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Internal mesher generating meshes of layered rectangular models in
+ * memory
+ *
+ */
+namespace mesher {
+
+/**
+ * @brief Layer of a layered model
+ *
+ */
+struct layer {
+  int nz = 1; ///< Number of elements across the layer
+  std::vector<std::array<type_real, 2> > top; ///< (x, z) points of the top
+                                              ///< interface, in increasing x.
+                                              ///< A single point defines a
+                                              ///< flat interface
+  type_real rho = 0.0;       ///< Density
+  type_real vp = 0.0;        ///< P-wave velocity
+  type_real vs = 0.0;        ///< S-wave velocity. Acoustic layer if 0
+  type_real Qkappa = 9999.0; ///< Bulk quality factor
+  type_real Qmu = 9999.0;    ///< Shear quality factor
+};
+
+/**
+ * @brief Rectangular model made of layers stacked from the bottom to the top
+ *
+ */
+struct layered_model {
+  type_real xmin = 0.0; ///< Left side of the model
+  type_real xmax = 0.0; ///< Right side of the model
+  type_real zmin = 0.0; ///< Bottom side of the model
+  int nx = 1;           ///< Number of elements along x
+  int ngnod = 4;        ///< Number of control nodes per element (4 or 9)
+  std::vector<specfem::mesher::layer> layers; ///< Layers from the bottom to
+                                              ///< the top
+  std::array<bool, 4> absorbing = {}; ///< Absorbing bottom, right, top and
+                                      ///< left sides
+  bool axisymmetric = false; ///< If true the model is the meridional half
+                             ///< plane of an axisymmetric model whose axis is
+                             ///< the left side, hence xmin is 0
+};
+
+/**
+ * @brief Height of an interface at x
+ *
+ * Interfaces are linearly interpolated between their points and constant
+ * beyond their first and last points
+ *
+ * @param top (x, z) points of the interface
+ * @param x Position along x
+ * @return type_real Height of the interface
+ */
+type_real interface_height(const std::vector<std::array<type_real, 2> > &top,
+                           const type_real x);
+
+/**
+ * @brief Generate the serial mesh of a layered model
+ *
+ * Every layer is meshed with nx x nz elements whose control nodes are evenly
+ * spaced along x and between the bottom and top interfaces of the layer along
+ * z. Elements are numbered row by row from the bottom left corner, and every
+ * layer defines a material. Absorbing edges, fluid-solid edges between
+ * acoustic and elastic layers, elements on the axis of axisymmetric models
+ * and materials are generated as if they were read from a database. The mesh is serial and is partitioned with
+ * specfem::mesh::partition.
+ *
+ * @param model Layered model
+ * @param materials Material of every layer
+ * @param mpi Pointer to MPI object
+ * @return specfem::mesh Serial mesh
+ */
+specfem::mesh generate(const specfem::mesher::layered_model &model,
+                       std::vector<specfem::material *> &materials,
+                       const specfem::MPI::MPI *mpi);
+
+} // namespace mesher
+} // namespace specfem
+
+#endif
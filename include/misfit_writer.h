@@ -0,0 +1,130 @@
+#ifndef MISFIT_WRITER_H
+#define MISFIT_WRITER_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/receiver.h"
+#include "../include/specfem_mpi.h"
+#include "../include/writer.h"
+#include <string>
+#include <vector>
+
+namespace specfem {
+namespace writer {
+/**
+ * @brief Misfit writer class measuring the misfit of the seismograms against
+ * observed traces during the time loop
+ *
+ * Observed traces of the receivers of this process are read from the files
+ * the seismogram writer would write, <network><station>BXX.sem<ext> and
+ * <network><station>BXZ.sem<ext> for P-SV waves or <network><station>BXX.sem
+ * <ext> for SH waves, ext being the extension of the first seismogram type.
+ * Files store time value lines sampled on the time axis of the seismograms.
+ * Components without an observed trace are skipped. Traces are stored on the
+ * device and every seismogram sample is compared with them once it is
+ * computed, hence synthetic seismograms are never written.
+ *
+ * - l2 : \f$ \chi = \frac{1}{2} \int (s - d)^2 dt \f$, the adjoint source
+ * being the residual \f$ s - d \f$
+ * - cross_correlation : \f$ \chi = \frac{1}{2} \Delta T^2 \f$ where
+ * \f$ \Delta T \f$ is the shift of the synthetic trace relative to the
+ * observed trace maximizing their cross-correlation, refined by a parabola
+ * through the correlations of the neighboring lags. The adjoint source is
+ * \f$ -\Delta T \dot{s} / \int \dot{s}^2 dt \f$ (Tromp et al. 2005)
+ *
+ * Every process writes the adjoint sources of its components as time value
+ * lines to <network><station>BXX.adj and <network><station>BXZ.adj, the
+ * residual files read by adjoint simulations, and the misfit of every
+ * component to misfit_<rank>.txt. The main process writes the total misfit
+ * to misfit.txt.
+ */
+class misfit : public writer {
+
+public:
+  /**
+   * @brief Construct a new misfit writer object
+   *
+   * @param receivers Stations of the simulation
+   * @param compute_receivers Pointer to specfem::compute::receivers struct
+   * storing seismograms
+   * @param measurement Misfit measured on every component
+   * @param observed_folder Folder storing the observed traces
+   * @param output_folder Path to output folder where misfits and adjoint
+   * sources will be stored
+   * @param wave Wave type of the seismograms
+   * @param sample_dt Time interval between seismogram samples
+   * @param t0 Starting time of simulation
+   * @param max_shift Largest cross-correlation shift in seconds
+   * @param mpi Pointer to MPI object
+   */
+  misfit(const specfem::receivers::receiver_set &receivers,
+         const specfem::compute::receivers *compute_receivers,
+         const specfem::misfit::type measurement,
+         const std::string observed_folder, const std::string output_folder,
+         const specfem::wave::type wave, const type_real sample_dt,
+         const type_real t0, const type_real max_shift,
+         const specfem::MPI::MPI *mpi);
+  /**
+   * @brief Compare the seismogram sample computed from recorded sample
+   * isig_step with the observed traces
+   *
+   * @param isig_step Index of the recorded sample
+   * @param exec_space Execution space instance computing the sample
+   */
+  void sample(const int isig_step,
+              const specfem::kokkos::DevExecSpace &exec_space) override;
+  /**
+   * @brief Write the misfits and the adjoint sources
+   *
+   * Cross-correlation shifts and adjoint sources are computed on the device
+   * first
+   */
+  void write() override;
+
+private:
+  const specfem::compute::receivers *compute_receivers; ///< Pointer to
+                                                        ///< seismograms
+  specfem::misfit::type measurement; ///< Misfit measured on every component
+  std::string output_folder;         ///< Path to output folder
+  type_real sample_dt; ///< Time interval between seismogram samples
+  type_real t0;        ///< Starting time of simulation
+  int nsamples;        ///< Number of samples of every trace
+  int max_lag;         ///< Largest cross-correlation shift in samples
+  const specfem::MPI::MPI *mpi; ///< Pointer to MPI object
+  std::vector<std::string> names; ///< Network and station names of the
+                                  ///< receivers of this process
+  std::vector<std::string> components; ///< Names of the components
+  specfem::kokkos::DeviceView2d<int> available; ///< 1 if the component of a
+                                                ///< receiver has an observed
+                                                ///< trace (receiver,
+                                                ///< component)
+  specfem::kokkos::DeviceView3d<type_real> observed; ///< Observed traces
+                                                     ///< (sample, receiver,
+                                                     ///< component)
+  specfem::kokkos::DeviceView3d<type_real>
+      traces; ///< Residuals of l2 misfits, synthetic traces replaced by the
+              ///< adjoint sources of cross-correlation misfits (sample,
+              ///< receiver, component)
+  specfem::kokkos::DeviceView3d<type_real>
+      correlation; ///< Cross-correlation of the synthetic and observed traces
+                   ///< (lag + max_lag, receiver, component)
+  specfem::kokkos::DeviceView2d<type_real> values; ///< Misfit of every
+                                                   ///< component (receiver,
+                                                   ///< component)
+  specfem::kokkos::DeviceView2d<type_real> shifts; ///< Cross-correlation
+                                                   ///< traveltime shifts
+                                                   ///< (receiver, component)
+
+  /**
+   * @brief Compute the traveltime shifts, misfits and adjoint sources of
+   * cross-correlation misfits
+   *
+   */
+  void compute_shifts();
+};
+} // namespace writer
+} // namespace specfem
+
+#endif
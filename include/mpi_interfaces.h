@@ -1,9 +1,11 @@
 #ifndef MPI_INTERFACES_H
 #define MPI_INTERFACES_H
 
+#include "../include/config.h"
+#include "../include/enums.h"
 #include "../include/kokkos_abstractions.h"
 #include "../include/specfem_mpi.h"
-// #include "../include/mpi_interfaces.tpp"
+#include <vector>
 
 namespace specfem {
 namespace interfaces {
@@ -15,22 +17,157 @@ struct interface {
   specfem::kokkos::HostView3d<int> my_interfaces;
   interface(){};
   interface(const int ninterfaces, const int max_interface_size);
-  interface(std::ifstream &stream, const specfem::MPI::MPI *mpi);
+  interface(std::istream &stream, const specfem::MPI::MPI *mpi);
 };
-} // namespace interfaces
 
-// namespace compute{
-// namespace mpi_interfaces{
+/**
+ * @brief Assembly of global arrays across MPI interfaces
+ *
+ * Global points shared with every neighboring rank are computed once and
+ * sorted by coordinates, such that both ranks sharing an interface pack the
+ * same points in the same order. Values are packed into persistent device
+ * buffers and exchanged using persistent non-blocking requests. MPI reads
+ * the device buffers directly on host backends and when MPI is GPU-aware,
+ * otherwise buffers are staged through host mirrors.
+ *
+ * Without MPI every rank has no neighbors and assembly is a no-op.
+ */
+class halo {
+public:
+  /**
+   * @brief Default constructor. Halo without neighbors
+   *
+   */
+  halo(){};
+  /**
+   * @brief Compute the interface points of every neighbor and initialize
+   * persistent requests
+   *
+   * @param interface MPI interfaces read from the database
+   * @param h_ibool Global number of every quadrature point (nspec, ngllz,
+   * ngllx)
+   * @param coord (x, z) coordinates of every global point (ndim, nglob)
+   * @param knods Control nodes of every spectral element (ngnod, nspec)
+   * @param h_ispec_type Type of every spectral element. Only points of
+   * elastic elements are assembled
+   * @param ncomponents Number of components of assembled arrays
+   * @param mpi Pointer to MPI object
+   */
+  halo(const specfem::interfaces::interface &interface,
+       const specfem::kokkos::HostElementMirror3d<int> h_ibool,
+       const specfem::kokkos::HostView2d<type_real> coord,
+       const specfem::kokkos::HostView2d<int> knods,
+       const specfem::kokkos::HostMirror1d<specfem::elements::type>
+           h_ispec_type,
+       const int ncomponents, const specfem::MPI::MPI *mpi);
+  // Persistent requests refer to the buffers of this halo
+  halo(const halo &) = delete;
+  halo &operator=(const halo &) = delete;
+  /**
+   * @brief Free persistent requests
+   *
+   */
+  ~halo();
+  /**
+   * @brief Get the number of neighboring ranks sharing points
+   *
+   */
+  int get_nneighbors() const { return this->neighbors.size(); }
+  /**
+   * @brief Get the number of components of assembled arrays
+   *
+   */
+  int get_ncomponents() const { return this->ncomponents; }
+  /**
+   * @brief Get global indices of interface points stored on host
+   *
+   * @return specfem::kokkos::HostMirror1d<int>
+   */
+  specfem::kokkos::HostMirror1d<int> get_host_points() const {
+    return this->h_points;
+  }
+  /**
+   * @brief Check if MPI reads and writes device buffers directly
+   *
+   */
+  bool device_buffers() const { return this->direct; }
+  /**
+   * @brief Get the time spent waiting for exchanges to complete since the
+   * halo was constructed or since the last call to reset_wait_time
+   *
+   * @return double Wait time in seconds
+   */
+  double get_wait_time() const { return this->wait_time; }
+  /**
+   * @brief Reset the wait time, e.g. after assembling the mass matrix
+   *
+   */
+  void reset_wait_time() { this->wait_time = 0.0; }
+  /**
+   * @brief Pack the values of interface points and start the exchange
+   *
+   * Packing is launched on exec_space, which is fenced before the exchange
+   * starts
+   *
+   * @param field Array assembled on this rank (nglob, ncomponents)
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void start(const specfem::kokkos::DeviceFieldView2d<type_real> field,
+             const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Wait for the exchange and add received values to interface points
+   *
+   * Unpacking is launched asynchronously on exec_space
+   *
+   * @param field Array assembled on this rank (nglob, ncomponents)
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void finish(const specfem::kokkos::DeviceFieldView2d<type_real> field,
+              const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Assemble field across MPI interfaces
+   *
+   * @param field Array assembled on this rank (nglob, ncomponents)
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void assemble(const specfem::kokkos::DeviceFieldView2d<type_real> field,
+                const specfem::kokkos::DevExecSpace &exec_space =
+                    specfem::kokkos::DevExecSpace());
+  /**
+   * @brief Assemble an array with one value per global point, e.g. the mass
+   * matrix, across MPI interfaces
+   *
+   * @param values Array assembled on this rank (nglob)
+   */
+  void assemble(const specfem::kokkos::DeviceView1d<type_real> values);
 
-// struct mpi_interfaces {
-//   specfem::compute::mpi_interfaces::mpi_interface_type<elastic>
-//   elastic_interface{}; mpi_interfaces(){}; mpi_interfaces(const int
-//   max_interface_size, const int ninterfaces,
-//                  const int ngllx);
-//   mpi_interfaces()
-// }
-// }
-// }
+private:
+  int ncomponents = 0;        ///< Number of components of assembled arrays
+  std::vector<int> neighbors; ///< Ranks sharing interface points
+  std::vector<int> offsets;   ///< Points shared with neighbors[i] span
+                              ///< [offsets[i], offsets[i + 1]) in points
+  specfem::kokkos::DeviceView1d<int> points; ///< Global indices of interface
+                                             ///< points on the device
+  specfem::kokkos::HostMirror1d<int> h_points; ///< Global indices of
+                                               ///< interface points on the
+                                               ///< host
+  specfem::kokkos::DeviceView2d<type_real> send_buffer; ///< Packed values
+                                                        ///< sent to neighbors
+  specfem::kokkos::HostMirror2d<type_real> h_send_buffer; ///< Host staging
+                                                          ///< of send_buffer
+  specfem::kokkos::DeviceView2d<type_real> recv_buffer; ///< Values received
+                                                        ///< from neighbors
+  specfem::kokkos::HostMirror2d<type_real> h_recv_buffer; ///< Host staging
+                                                          ///< of recv_buffer
+  bool direct = false; ///< If true MPI uses send_buffer and recv_buffer
+  double wait_time = 0.0; ///< Time spent in finish waiting for exchanges
+#ifdef MPI_PARALLEL
+  std::vector<MPI_Request> requests; ///< Persistent receive requests followed
+                                     ///< by persistent send requests
+#endif
+};
+
+} // namespace interfaces
 } // namespace specfem
 
 #endif
@@ -1,14 +1,27 @@
 #ifndef PARAMETER_PARSER_H
 #define PARAMETER_PARSER_H
 
+#include "../include/checkpoint.h"
 #include "../include/config.h"
+#include "../include/domain.h"
+#include "../include/enums.h"
+#include "../include/mesher.h"
+#include "../include/misfit_writer.h"
+#include "../include/partitioner.h"
 #include "../include/quadrature.h"
 #include "../include/receiver.h"
+#include "../include/source.h"
+#include "../include/spectrum_writer.h"
 #include "../include/timescheme.h"
+#include "../include/wavefield_writer.h"
 #include "../include/writer.h"
 #include "yaml-cpp/yaml.h"
+#include <array>
 #include <ctime>
+#include <limits>
+#include <string>
 #include <tuple>
+#include <vector>
 
 namespace specfem {
 /**
@@ -150,6 +163,31 @@ public:
     throw std::runtime_error("Solver not instantiated properly");
     return 0.0;
   };
+  /**
+   * @brief Check if the time increment is derived from the stable time step
+   *
+   * @return bool true if the time increment is set to auto
+   */
+  virtual bool is_auto_dt() const { return false; }
+  /**
+   * @brief Update the time increment using the maximum stable time step
+   *
+   * @param stable_dt Maximum stable time step of the mesh
+   */
+  virtual void update_dt(const type_real stable_dt){};
+  /**
+   * @brief Get the maximum number of local time stepping levels
+   *
+   * @return int Maximum number of levels. 1 if local time stepping is
+   * disabled
+   */
+  virtual int get_lts_levels() const { return 1; }
+  /**
+   * @brief Get the number of time steps
+   *
+   * @return int Number of time steps
+   */
+  virtual int get_nstep() const { return 0; }
 };
 
 /**
@@ -201,12 +239,48 @@ public:
   type_real get_dt() const override { return this->dt; }
 
   type_real get_t0() const override { return this->t0; }
+  /**
+   * @brief Check if the time increment is derived from the stable time step
+   *
+   * @return bool true if the time increment is set to auto
+   */
+  bool is_auto_dt() const override { return this->auto_dt; }
+  /**
+   * @brief Set the time increment to dt_safety_factor times the maximum
+   * stable time step. Does nothing if the time increment is set explicitly
+   *
+   * @param stable_dt Maximum stable time step of the mesh
+   */
+  void update_dt(const type_real stable_dt) override {
+    if (this->auto_dt)
+      this->dt = this->dt_safety_factor * stable_dt;
+  }
+  /**
+   * @brief Get the maximum number of local time stepping levels
+   *
+   * @return int Maximum number of levels. 1 if local time stepping is
+   * disabled
+   */
+  int get_lts_levels() const override { return this->lts_levels; }
+  /**
+   * @brief Get the number of time steps
+   *
+   * @return int Number of time steps
+   */
+  int get_nstep() const override { return this->nstep; }
 
 private:
-  int nstep;              ///< number of time steps
-  type_real dt;           ///< delta time for the timescheme
-  type_real t0;           ///< simulation start time
-  std::string timescheme; ///< Time scheme e.g. Newmark, Runge-Kutta, LDDRK
+  int nstep;                        ///< number of time steps
+  type_real dt;                     ///< delta time for the timescheme
+  type_real t0;                     ///< simulation start time
+  std::string timescheme;           ///< Time scheme e.g. Newmark,
+                                    ///< Runge-Kutta, LDDRK
+  bool auto_dt = false;             ///< If true dt is derived from the
+                                    ///< maximum stable time step
+  type_real dt_safety_factor = 0.9; ///< Fraction of maximum stable time step
+                                    ///< used when dt is auto
+  int lts_levels = 1;               ///< Maximum number of local time
+                                    ///< stepping levels
 };
 
 /**
@@ -226,14 +300,28 @@ public:
    * @param seismogram_type Type of seismogram
    * @param output_folder Path to folder location where seismogram will be
    * stored
+   * @param buffer_size Number of samples stored on the device before they are
+   * appended to output files. 0 stores every sample until the end of the run
+   * @param compression Deflate level of HDF5 output, 0 disables compression
+   * @param writer_ranks Number of processes writing ASCII and Seismic Unix
+   * seismograms
+   * @param decimation Number of recorded samples between written samples
+   * @param reciprocal If true forces are applied at the stations and the
+   * seismograms of the sources are synthesized from the responses at the
+   * sources
    */
   seismogram(const std::string stations_file, const type_real angle,
              const int nstep_between_samples,
              const std::string seismogram_format,
-             const std::string output_folder)
+             const std::string output_folder, const int buffer_size = 0,
+             const int compression = 0, const int writer_ranks = 1,
+             const int decimation = 1, const bool reciprocal = false)
       : stations_file(stations_file), angle(angle),
         nstep_between_samples(nstep_between_samples),
-        seismogram_format(seismogram_format), output_folder(output_folder){};
+        seismogram_format(seismogram_format), output_folder(output_folder),
+        buffer_size(buffer_size), compression(compression),
+        writer_ranks(writer_ranks), decimation(decimation),
+        reciprocal(reciprocal){};
   /**
    * @brief Construct a new seismogram object
    *
@@ -266,22 +354,83 @@ public:
   std::vector<specfem::seismogram::type> get_seismogram_types() const {
     return stypes;
   }
+  /**
+   * @brief Get the number of samples stored on the device before they are
+   * appended to output files
+   *
+   * @return int Number of samples, 0 if every sample is stored
+   */
+  int get_buffer_size() const { return this->buffer_size; }
+  /**
+   * @brief Get the number of recorded samples between written samples
+   *
+   * @return int Decimation factor, 1 if every recorded sample is written
+   */
+  int get_decimation() const { return this->decimation; }
+  /**
+   * @brief Check if the simulation is reciprocal
+   *
+   * @return bool true if forces are applied at the stations
+   */
+  bool get_reciprocal() const { return this->reciprocal; }
+  /**
+   * @brief Get the folder storing the seismograms
+   *
+   */
+  std::string get_output_folder() const { return this->output_folder; }
+  /**
+   * @brief Update the folder storing the seismograms of the next writers
+   *
+   * @param output_folder Path to folder
+   */
+  void update_output_folder(const std::string &output_folder) {
+    this->output_folder = output_folder;
+  }
 
   /**
    * @brief Instantiate a seismogram writer object
    *
-   * @param receivers Vector of pointers to receiver objects used to instantiate
-   * the writer
+   * @param receivers Stations used to instantiate the writer
    * @param compute_receivers Pointer to specfem::compute::receivers struct used
    * to instantiate the writer
    * @param dt Time interval between timesteps
    * @param t0 Starting time of simulation
+   * @param mpi Pointer to MPI object. nullptr if this process stores every
+   * receiver
    * @return specfem::writer::writer* Pointer to an instantiated writer object
    */
   specfem::writer::writer *instantiate_seismogram_writer(
-      std::vector<specfem::receivers::receiver *> &receivers,
+      const specfem::receivers::receiver_set &receivers,
       specfem::compute::receivers *compute_receivers, const type_real dt,
-      const type_real t0) const;
+      const type_real t0, const specfem::MPI::MPI *mpi = nullptr) const;
+  /**
+   * @brief Instantiate the seismogram writer of a reciprocal simulation
+   *
+   * @param domain Pointer to domain storing the fields of the station forces
+   * @param compute Pointer to specfem::compute::compute struct storing the
+   * global numbering
+   * @param sources Sources of the source files, located within the mesh
+   * @param receivers Stations of the simulation
+   * @param quadx Quadrature object in x-dimension
+   * @param quadz Quadrature object in z-dimension
+   * @param wave Wave type simulated by the domain
+   * @param nsig_steps Number of recorded samples
+   * @param dt Time interval between timesteps
+   * @param t0 Starting time of simulation
+   * @param source_t0 Starting time of the seismograms of the sources
+   * @param mpi Pointer to MPI object
+   * @return specfem::writer::writer* Pointer to an instantiated writer object
+   */
+  specfem::writer::writer *instantiate_reciprocal_writer(
+      specfem::Domain::Domain *domain,
+      const specfem::compute::compute *compute,
+      const std::vector<specfem::sources::source *> &sources,
+      const specfem::receivers::receiver_set &receivers,
+      const specfem::quadrature::quadrature &quadx,
+      const specfem::quadrature::quadrature &quadz,
+      const specfem::wave::type wave, const int nsig_steps,
+      const type_real dt, const type_real t0, const type_real source_t0,
+      specfem::MPI::MPI *mpi) const;
 
 private:
   std::string stations_file; ///< path to stations file
@@ -292,6 +441,13 @@ private:
                                                  ///< written
   std::string seismogram_format;                 ///< format of output file
   std::string output_folder;                     ///< Path to output folder
+  int buffer_size; ///< Number of samples stored on the device before they are
+                   ///< appended to output files
+  int compression;  ///< Deflate level of HDF5 output
+  int writer_ranks; ///< Number of processes writing ASCII and Seismic Unix
+                    ///< seismograms
+  int decimation;   ///< Number of recorded samples between written samples
+  bool reciprocal;  ///< Forces are applied at the stations
 };
 
 /**
@@ -311,166 +467,1353 @@ public:
    * @param nruns Number of simulation runs
    */
   run_setup(int nproc, int nruns) : nproc(nproc), nruns(nruns){};
+  /**
+   * @brief Construct a new run setup object
+   *
+   * @param nproc Number of processors used in the simulation
+   * @param nruns Number of simulation runs
+   * @param domain_options Runtime options used to select domain kernels
+   * @param element_ordering Reordering applied to spectral elements before
+   * global numbering
+   * @param graph_execution If true timesteps are executed by replaying
+   * recorded graphs
+   * @param partition_mesh If true a serial database is partitioned across MPI
+   * ranks at startup
+   * @param partition_weights Relative cost of element types used to balance
+   * partitions
+   */
+  run_setup(int nproc, int nruns,
+            const specfem::Domain::options &domain_options,
+            const specfem::reordering::type element_ordering =
+                specfem::reordering::none,
+            const bool graph_execution = false,
+            const bool partition_mesh = false,
+            const specfem::partitioner::weights &partition_weights =
+                specfem::partitioner::weights())
+      : nproc(nproc), nruns(nruns), domain_options(domain_options),
+        element_ordering(element_ordering), graph_execution(graph_execution),
+        partition_mesh(partition_mesh),
+        partition_weights(partition_weights){};
   /**
    * @brief Construct a new run setup object
    *
    * @param Node YAML node describing the run configuration
    */
   run_setup(const YAML::Node &Node);
+  /**
+   * @brief Get the runtime options used to select domain kernels
+   *
+   * @return specfem::Domain::options Domain options
+   */
+  specfem::Domain::options get_domain_options() const {
+    return this->domain_options;
+  }
+  /**
+   * @brief Get the reordering applied to spectral elements
+   *
+   * @return specfem::reordering::type Element reordering type
+   */
+  specfem::reordering::type get_element_ordering() const {
+    return this->element_ordering;
+  }
+  /**
+   * @brief Check if timesteps are executed by replaying recorded graphs
+   *
+   * @return bool true if graph execution is enabled
+   */
+  bool get_graph_execution() const { return this->graph_execution; }
+  /**
+   * @brief Check if viscoelastic attenuation is simulated
+   *
+   * @return bool true if attenuation is enabled
+   */
+  bool get_attenuation() const { return this->attenuation; }
+  /**
+   * @brief Check if Stacey absorbing boundaries are applied
+   *
+   * @return bool true if absorbing boundaries are enabled
+   */
+  bool get_absorbing_boundaries() const { return this->absorbing_boundaries; }
+  /**
+   * @brief Check if PML layers absorb waves in region_CPML elements
+   *
+   * @return bool true if PML layers are enabled
+   */
+  bool get_pml() const { return this->pml; }
+  /**
+   * @brief Get the frequency setting the frequency shift of PML profiles
+   *
+   * @return type_real Frequency in Hz
+   */
+  type_real get_pml_frequency() const { return this->pml_frequency; }
+  /**
+   * @brief Get the theoretical reflection coefficient of PML layers
+   *
+   * @return type_real Reflection coefficient
+   */
+  type_real get_pml_reflection() const { return this->pml_reflection; }
+  /**
+   * @brief Check if a serial database is partitioned at startup
+   *
+   * @return bool true if partitioning is enabled
+   */
+  bool get_partition_mesh() const { return this->partition_mesh; }
+  /**
+   * @brief Get the relative cost of element types used to balance partitions
+   *
+   * @return specfem::partitioner::weights Element weights
+   */
+  specfem::partitioner::weights get_partition_weights() const {
+    return this->partition_weights;
+  }
+  /**
+   * @brief Get the path of the element weights file used to balance
+   * partitions
+   *
+   * @return std::string Path of the file. Empty if partitions are balanced
+   * using the weights of element types
+   */
+  std::string get_partition_weights_file() const {
+    return this->partition_weights_file;
+  }
+  /**
+   * @brief Check if the phases of the run are timed
+   *
+   * @return bool true if timers are enabled
+   */
+  bool get_timers() const { return this->timers; }
+  /**
+   * @brief Check if timed phases fence their execution space
+   *
+   * @return bool true if timers are accurate
+   */
+  bool get_accurate_timers() const { return this->accurate_timers; }
+  /**
+   * @brief Get the peak bandwidth of the machine
+   *
+   * @return double Peak bandwidth in GB/s. 0 if unknown
+   */
+  double get_peak_bandwidth() const { return this->peak_bandwidth; }
+  /**
+   * @brief Get the peak flop rate of the machine
+   *
+   * @return double Peak flop rate in GFLOP/s. 0 if unknown
+   */
+  double get_peak_flops() const { return this->peak_flops; }
+  /**
+   * @brief Get the path of the JSON startup report
+   *
+   * @return std::string Path of the report. Empty if the report isn't
+   * written
+   */
+  std::string get_startup_report() const { return this->startup_report; }
+  /**
+   * @brief Get the time between two progress lines of the time loop
+   *
+   * @return double Interval in seconds. Progress isn't reported if less
+   * than 0
+   */
+  double get_progress_interval() const { return this->progress_interval; }
+  /**
+   * @brief Get the path of the progress status file
+   *
+   * @return std::string Path of the status file. Empty if the file isn't
+   * written
+   */
+  std::string get_status_file() const { return this->status_file; }
+  /**
+   * @brief Get the number of steps between two stability checks
+   *
+   * @return int Number of steps. Fields aren't checked if 0
+   */
+  int get_stability_interval() const { return this->stability_interval; }
+  /**
+   * @brief Get the largest absolute value of stable fields
+   *
+   * @return type_real Stability threshold
+   */
+  type_real get_stability_threshold() const {
+    return this->stability_threshold;
+  }
+  /**
+   * @brief Get the path of the Chrome trace JSON file
+   *
+   * @return std::string Path of the trace. Empty if the run isn't traced
+   */
+  std::string get_trace_file() const { return this->trace_file; }
+  /**
+   * @brief Get the first traced step
+   *
+   * @return int First traced step
+   */
+  int get_trace_first_step() const { return this->trace_first_step; }
+  /**
+   * @brief Get the last traced step
+   *
+   * @return int Last traced step
+   */
+  int get_trace_last_step() const { return this->trace_last_step; }
+  /**
+   * @brief Get the path of the element weights file written after the time
+   * loop
+   *
+   * @return std::string Path of the file. Empty if weights aren't written
+   */
+  std::string get_element_weights_file() const {
+    return this->element_weights_file;
+  }
 
 private:
   int nproc; ///< number of processors used in the simulation
   int nruns; ///< Number of simulation runs
+  specfem::Domain::options domain_options; ///< Options used to select domain
+                                           ///< kernels
+  specfem::reordering::type element_ordering =
+      specfem::reordering::none; ///< Reordering applied to spectral elements
+                                 ///< before global numbering
+  bool graph_execution = false;  ///< If true timesteps are executed by
+                                 ///< replaying recorded graphs
+  bool partition_mesh = false;   ///< If true a serial database is partitioned
+                                 ///< at startup
+  bool attenuation = false;      ///< If true viscoelastic attenuation is
+                                 ///< simulated
+  bool absorbing_boundaries = false; ///< If true absorbing edges of the
+                                     ///< database are damped using Stacey
+                                     ///< boundary conditions
+  bool pml = false;                  ///< If true region_CPML elements are
+                                     ///< convolutional PML layers
+  type_real pml_frequency = 0.0;     ///< Frequency of the PML frequency
+                                     ///< shift
+  type_real pml_reflection = 0.001;  ///< Theoretical reflection coefficient
+                                     ///< of PML layers
+  specfem::partitioner::weights partition_weights; ///< Relative cost of
+                                                   ///< element types
+  std::string partition_weights_file; ///< Path of the element weights file
+                                      ///< used to balance partitions
+  bool timers = true;           ///< If true the phases of the run are timed
+  bool accurate_timers = false; ///< If true timed phases fence their
+                                ///< execution space
+  double peak_bandwidth = 0.0;  ///< Peak bandwidth of the machine in GB/s
+  double peak_flops = 0.0;      ///< Peak flop rate of the machine in GFLOP/s
+  std::string startup_report;   ///< Path of the JSON startup report
+  double progress_interval = 10.0; ///< Time between two progress lines in
+                                   ///< seconds
+  std::string status_file;         ///< Path of the progress status file
+  int stability_interval = 0;      ///< Number of steps between two stability
+                                   ///< checks
+  type_real stability_threshold = 1e25; ///< Largest absolute value of
+                                        ///< stable fields
+  std::string trace_file;               ///< Path of the Chrome trace
+  int trace_first_step = 0;             ///< First traced step
+  int trace_last_step =
+      std::numeric_limits<int>::max(); ///< Last traced step
+  std::string element_weights_file;    ///< Path of the element weights file
+                                       ///< written after the time loop
 };
 
 /**
- * @brief database_configuration defines the file location of databases
+ * @brief Wavefield class is used to instantiate the wavefield snapshot writer
  *
  */
-class database_configuration {
+class wavefield {
 
 public:
   /**
-   * @brief Construct a new database configuration object
+   * @brief Construct a new wavefield object
    *
-   * @param fortran_database location of fortran database
-   * @param source_database location of source file
+   * @param nstep_between_snapshots Number of timesteps between snapshots
+   * @param stride Stride between written GLL points, 0 writes element corners
+   * @param output_folder Path to folder location where snapshots will be
+   * stored
    */
-  database_configuration(std::string fortran_database,
-                         std::string source_database)
-      : fortran_database(fortran_database), source_database(source_database){};
+  wavefield(const int nstep_between_snapshots, const int stride,
+            const std::string output_folder)
+      : nstep_between_snapshots(nstep_between_snapshots), stride(stride),
+        output_folder(output_folder){};
   /**
-   * @brief Construct a new run setup object
+   * @brief Construct a new wavefield object
    *
-   * @param Node YAML node describing the run configuration
+   * @param Node YAML node describing the wavefield writer
    */
-  database_configuration(const YAML::Node &Node);
-
-  std::tuple<std::string, std::string> get_databases() const {
-    return std::make_tuple(this->fortran_database, this->source_database);
-  }
+  wavefield(const YAML::Node &Node);
+  /**
+   * @brief Instantiate a wavefield writer object
+   *
+   * @param domain Pointer to domain storing the fields
+   * @param compute Pointer to specfem::compute::compute struct storing the
+   * global numbering and coordinates
+   * @param quadx Quadrature object in x dimension
+   * @param quadz Quadrature object in z dimension
+   * @param coorg (x, z) for every spectral element control node, used to
+   * locate the pixels of images
+   * @param knods Global control element number for every control node
+   * @param mpi Pointer to MPI object
+   * @return specfem::writer::wavefield* Pointer to an instantiated writer
+   * object
+   */
+  specfem::writer::wavefield *instantiate_wavefield_writer(
+      specfem::Domain::Domain *domain,
+      const specfem::compute::compute *compute,
+      const specfem::quadrature::quadrature &quadx,
+      const specfem::quadrature::quadrature &quadz,
+      const specfem::kokkos::HostView2d<type_real> coorg,
+      const specfem::kokkos::HostView2d<int> knods,
+      const specfem::MPI::MPI *mpi) const;
 
 private:
-  std::string fortran_database; ///< location of fortran binary database
-  std::string source_database;  ///< location of sources file
+  int nstep_between_snapshots; ///< Number of timesteps between snapshots
+  int stride;                  ///< Stride between written GLL points. 0
+                               ///< writes element corners
+  std::vector<specfem::seismogram::type> fields = {
+    specfem::seismogram::displacement
+  };                         ///< Fields written in every snapshot
+  std::string output_folder; ///< Path to output folder
+  specfem::writer::image_grid grid; ///< Pixels of images. Snapshots gather
+                                    ///< GLL points if grid.nx is 0
 };
 
 /**
- * Setup class is used to read the YAML file parameter file.
+ * @brief Checkpoint class is used to instantiate the checkpoint writer
  *
- * Setup class is also used to instantiate the simulation i.e. instantiate
- * quadrature objects, instantiate solver objects.
+ */
+class checkpoint {
+
+public:
+  /**
+   * @brief Construct a new checkpoint object
+   *
+   * @param directory Directory storing checkpoint files
+   * @param nstep_between_checkpoints Number of timesteps between checkpoints.
+   * 0 only writes a checkpoint when SIGTERM is received
+   */
+  checkpoint(const std::string directory, const int nstep_between_checkpoints)
+      : directory(directory),
+        nstep_between_checkpoints(nstep_between_checkpoints){};
+  /**
+   * @brief Construct a new checkpoint object
+   *
+   * @param Node YAML node describing the checkpoints
+   */
+  checkpoint(const YAML::Node &Node);
+  /**
+   * @brief Instantiate a checkpoint object
+   *
+   * @param domain Pointer to domain storing the fields
+   * @param compute_receivers Pointer to specfem::compute::receivers struct
+   * storing seismograms
+   * @param writer Pointer to the seismogram writer
+   * @param mpi Pointer to MPI object
+   * @return specfem::checkpoint::checkpoint* Pointer to an instantiated
+   * checkpoint object
+   */
+  specfem::checkpoint::checkpoint *
+  instantiate_checkpoint(specfem::Domain::Domain *domain,
+                         specfem::compute::receivers *compute_receivers,
+                         specfem::writer::writer *writer,
+                         const specfem::MPI::MPI *mpi) const;
+
+private:
+  std::string directory;         ///< Directory storing checkpoint files
+  int nstep_between_checkpoints; ///< Number of timesteps between checkpoints
+};
+
+/**
+ * @brief Spectrum class is used to instantiate the spectrum writer
  *
  */
-class setup {
+class spectrum {
 
 public:
   /**
-   * @brief Construct a new setup object
+   * @brief Construct a new spectrum object
    *
-   * @param parameter_file Path to a configuration YAML file
+   * @param frequencies Frequencies of the spectra in Hz
+   * @param nstep_between_samples Number of timesteps between samples of the
+   * fields
+   * @param stride Stride between transformed GLL points, 0 transforms element
+   * corners
+   * @param output_folder Path to folder location where spectra will be stored
    */
-  setup(std::string parameter_file);
+  spectrum(const std::vector<type_real> &frequencies,
+           const int nstep_between_samples, const int stride,
+           const std::string output_folder)
+      : frequencies(frequencies), nstep_between_samples(nstep_between_samples),
+        stride(stride), output_folder(output_folder){};
   /**
-   * @brief Instantiate quadrature objects in x and z dimensions
+   * @brief Construct a new spectrum object
    *
-   * @return std::tuple<specfem::quadrature::quadrature,
-   * specfem::quadrature::quadrature> Quadrature objects in x and z dimensions
+   * @param Node YAML node describing the spectrum writer
    */
-  std::tuple<specfem::quadrature::quadrature, specfem::quadrature::quadrature>
-  instantiate_quadrature() {
-    return this->quadrature->instantiate();
-  }
+  spectrum(const YAML::Node &Node);
   /**
-   * @brief Instantiate the Timescheme
+   * @brief Instantiate a spectrum writer object
    *
-   * @return specfem::TimeScheme::TimeScheme* Pointer to the TimeScheme object
-   * used in the solver algorithm
+   * @param domain Pointer to domain storing the fields
+   * @param compute Pointer to specfem::compute::compute struct storing the
+   * global numbering and coordinates
+   * @param receivers Stations read from the stations file
+   * @param compute_receivers Pointer to specfem::compute::receivers struct
+   * storing seismograms
+   * @param dt Time interval between timesteps
+   * @param t0 Starting time of simulation
+   * @param sample_dt Time interval between seismogram samples
+   * @param mpi Pointer to MPI object
+   * @return specfem::writer::spectrum* Pointer to an instantiated writer
+   * object
    */
-  specfem::TimeScheme::TimeScheme *instantiate_solver() {
-    auto it = this->solver->instantiate(
-        this->seismogram->get_nstep_between_samples());
+  specfem::writer::spectrum *instantiate_spectrum_writer(
+      specfem::Domain::Domain *domain,
+      const specfem::compute::compute *compute,
+      const specfem::receivers::receiver_set &receivers,
+      const specfem::compute::receivers *compute_receivers,
+      const type_real dt, const type_real t0, const type_real sample_dt,
+      const specfem::MPI::MPI *mpi) const;
 
-    // User output
-    std::cout << *it << "\n";
+private:
+  std::vector<type_real> frequencies; ///< Frequencies of the spectra in Hz
+  int nstep_between_samples;          ///< Number of timesteps between samples
+  int stride; ///< Stride between transformed GLL points. 0 transforms
+              ///< element corners
+  std::vector<specfem::seismogram::type> fields = {
+    specfem::seismogram::displacement
+  };                         ///< Transformed fields
+  bool receivers = true;     ///< Transform seismograms
+  std::string output_folder; ///< Path to output folder
+};
 
-    return it;
-  }
+/**
+ * @brief Adjoint class defines the residuals and checkpoints of adjoint
+ * simulations computing sensitivity kernels
+ *
+ */
+class adjoint {
+
+public:
   /**
-   * @brief Update simulation start time.
+   * @brief Construct a new adjoint object
    *
-   * If user has not defined start time then we need to update the simulation
-   * start time based on source frequencies and time shift
+   * @param residuals_folder Folder storing the residual files of the stations
+   * @param checkpoint_memory Device memory in GB storing forward checkpoints
+   * @param output_folder Path to folder location where kernels will be stored
+   * @param compression_bits Bits of every value of the compressed
+   * checkpoints. Checkpoints aren't compressed if 0
+   * @param reconstruction Reconstruct the forward fields backward in time
+   * from the absorbing tractions instead of recomputing them from checkpoints
+   * @param boundary_chunk Number of timesteps of absorbing tractions written
+   * to disk at once
+   */
+  adjoint(const std::string residuals_folder, const type_real checkpoint_memory,
+          const std::string output_folder, const int compression_bits = 0,
+          const bool reconstruction = false, const int boundary_chunk = 100)
+      : residuals_folder(residuals_folder),
+        checkpoint_memory(checkpoint_memory), output_folder(output_folder),
+        compression_bits(compression_bits), reconstruction(reconstruction),
+        boundary_chunk(boundary_chunk){};
+  /**
+   * @brief Construct a new adjoint object
    *
-   * @note This might be specific to only time-marching solvers
+   * @param Node YAML node describing the adjoint simulation
+   */
+  adjoint(const YAML::Node &Node);
+  /**
+   * @brief Get the folder storing the residual files
    *
-   * @param t0 Simulation start time
    */
-  void update_t0(type_real t0) { this->solver->update_t0(t0); }
+  std::string get_residuals_folder() const { return this->residuals_folder; }
   /**
-   * @brief Log the header and description of the simulation
+   * @brief Get the device memory storing forward checkpoints
+   *
+   * @return type_real Memory in GB
    */
-  std::string
-  print_header(std::chrono::time_point<std::chrono::high_resolution_clock> now);
-
+  type_real get_checkpoint_memory() const { return this->checkpoint_memory; }
   /**
-   * @brief Get delta time value
+   * @brief Get the folder storing the kernel files
    *
-   * @return type_real
    */
-  type_real get_dt() const { return solver->get_dt(); }
-
+  std::string get_output_folder() const { return this->output_folder; }
   /**
-   * @brief Get the path to mesh database and source yaml file
+   * @brief Get the bits of every value of the compressed checkpoints
    *
-   * @return std::tuple<std::string, std::string> std::tuple specifying the path
-   * to mesh database and source yaml file
+   * @return int 0 if checkpoints aren't compressed
    */
-  std::tuple<std::string, std::string> get_databases() const {
-    return databases->get_databases();
-  }
-
+  int get_compression_bits() const { return this->compression_bits; }
   /**
-   * @brief Get the path to stations file
+   * @brief Check if the forward fields are reconstructed from the absorbing
+   * tractions
    *
-   * @return std::string path to stations file
+   * @return bool false if forward fields are recomputed from checkpoints
    */
-  std::string get_stations_file() const {
-    return seismogram->get_stations_file();
-  }
-
+  bool get_reconstruction() const { return this->reconstruction; }
   /**
-   * @brief Get the angle of receivers
+   * @brief Get the number of timesteps of absorbing tractions written to disk
+   * at once
    *
-   * @return type_real angle of the receiver
    */
-  type_real get_receiver_angle() const { return seismogram->get_angle(); }
+  int get_boundary_chunk() const { return this->boundary_chunk; }
+
+private:
+  std::string residuals_folder; ///< Folder storing the residual files
+  type_real checkpoint_memory;  ///< Device memory in GB storing forward
+                                ///< checkpoints
+  std::string output_folder;    ///< Path to output folder
+  int compression_bits;         ///< Bits of every compressed value
+  bool reconstruction;          ///< Reconstruct the forward fields from the
+                                ///< absorbing tractions
+  int boundary_chunk; ///< Timesteps of absorbing tractions per chunk
+};
+
+/**
+ * @brief Injection class defines the recorded or injected wavefield of
+ * hybrid simulations
+ *
+ */
+class injection {
 
+public:
   /**
-   * @brief Get the types of siesmograms to be calculated
+   * @brief Construct a new injection object
    *
-   * @return std::vector<specfem::seismogram::type> Types of seismograms to be
-   * calculated
+   * @param mode Record the wavefield on the contour or inject it through the
+   * absorbing boundaries
+   * @param folder Folder storing the recorded wavefield
+   * @param contour Sides of the recorded contour (xmin, xmax, zmin, zmax)
+   * @param chunk Number of timesteps copied between the host and the device
+   * at once
    */
-  std::vector<specfem::seismogram::type> get_seismogram_types() const {
-    return this->seismogram->get_seismogram_types();
-  }
-
+  injection(const specfem::injection::type mode, const std::string folder,
+            const std::array<type_real, 4> contour, const int chunk = 100)
+      : mode(mode), folder(folder), contour(contour), chunk(chunk){};
   /**
-   * @brief Instantiate a seismogram writer object
+   * @brief Construct a new injection object
    *
-   * @param receivers Vector of pointers to receiver objects used to instantiate
-   * the writer
-   * @param compute_receivers Pointer to specfem::compute::receivers struct used
-   * to instantiate the writer
-   * @return specfem::writer::writer* Pointer to an instantiated writer object
+   * @param Node YAML node describing the injection
    */
-  specfem::writer::writer *instantiate_seismogram_writer(
-      std::vector<specfem::receivers::receiver *> &receivers,
-      specfem::compute::receivers *compute_receivers) const {
-    return this->seismogram->instantiate_seismogram_writer(
-        receivers, compute_receivers, this->solver->get_dt(),
-        this->solver->get_t0());
+  injection(const YAML::Node &Node);
+  /**
+   * @brief Get the mode of the injection
+   *
+   */
+  specfem::injection::type get_mode() const { return this->mode; }
+  /**
+   * @brief Get the folder storing the recorded wavefield
+   *
+   */
+  std::string get_folder() const { return this->folder; }
+  /**
+   * @brief Get the sides of the recorded contour
+   *
+   * @return std::array<type_real, 4> xmin, xmax, zmin and zmax
+   */
+  std::array<type_real, 4> get_contour() const { return this->contour; }
+  /**
+   * @brief Get the number of timesteps copied between the host and the device
+   * at once
+   *
+   */
+  int get_chunk() const { return this->chunk; }
+
+private:
+  specfem::injection::type mode; ///< Record or inject
+  std::string folder;            ///< Folder storing the recorded wavefield
+  std::array<type_real, 4> contour; ///< Sides of the recorded contour
+  int chunk; ///< Timesteps per chunk
+};
+
+/**
+ * @brief Misfit class is used to instantiate the misfit writer measuring the
+ * seismograms against observed traces instead of writing them
+ *
+ */
+class misfit {
+
+public:
+  /**
+   * @brief Construct a new misfit object
+   *
+   * @param measurement Misfit measured on every component
+   * @param observed_folder Folder storing the observed traces
+   * @param output_folder Path to folder location where misfits and adjoint
+   * sources will be stored
+   * @param max_shift Largest cross-correlation shift in seconds
+   */
+  misfit(const specfem::misfit::type measurement,
+         const std::string observed_folder, const std::string output_folder,
+         const type_real max_shift = 0.0)
+      : measurement(measurement), observed_folder(observed_folder),
+        output_folder(output_folder), max_shift(max_shift){};
+  /**
+   * @brief Construct a new misfit object
+   *
+   * @param Node YAML node describing the misfit writer
+   */
+  misfit(const YAML::Node &Node);
+  /**
+   * @brief Instantiate a misfit writer object
+   *
+   * @param receivers Stations of the simulation
+   * @param compute_receivers Pointer to specfem::compute::receivers struct
+   * storing seismograms
+   * @param wave Wave type of the seismograms
+   * @param sample_dt Time interval between seismogram samples
+   * @param t0 Starting time of simulation
+   * @param mpi Pointer to MPI object
+   * @return specfem::writer::writer* Pointer to an instantiated writer object
+   */
+  specfem::writer::writer *
+  instantiate_misfit_writer(const specfem::receivers::receiver_set &receivers,
+                            specfem::compute::receivers *compute_receivers,
+                            const specfem::wave::type wave,
+                            const type_real sample_dt, const type_real t0,
+                            const specfem::MPI::MPI *mpi) const;
+
+private:
+  specfem::misfit::type measurement; ///< Misfit measured on every component
+  std::string observed_folder;       ///< Folder storing the observed traces
+  std::string output_folder;         ///< Path to output folder
+  type_real max_shift; ///< Largest cross-correlation shift in seconds
+};
+
+/**
+ * @brief database_configuration defines the file location of databases
+ *
+ */
+class database_configuration {
+
+public:
+  /**
+   * @brief Construct a new database configuration object
+   *
+   * @param fortran_database location of fortran database
+   * @param source_database location of source file
+   * @param setup_cache Directory storing setup cache files. The cache is
+   * disabled if empty
+   */
+  database_configuration(std::string fortran_database,
+                         std::string source_database,
+                         std::string setup_cache = "")
+      : fortran_database(fortran_database),
+        source_databases({ source_database }), setup_cache(setup_cache){};
+  /**
+   * @brief Construct a new database configuration object for shots
+   * simulated together
+   *
+   * @param fortran_database location of fortran database
+   * @param source_databases location of the source file of every shot
+   * @param setup_cache Directory storing setup cache files. The cache is
+   * disabled if empty
+   */
+  database_configuration(std::string fortran_database,
+                         std::vector<std::string> source_databases,
+                         std::string setup_cache = "")
+      : fortran_database(fortran_database),
+        source_databases(source_databases), setup_cache(setup_cache){};
+  /**
+   * @brief Construct a new run setup object
+   *
+   * @param Node YAML node describing the run configuration
+   */
+  database_configuration(const YAML::Node &Node);
+
+  /**
+   * @brief Get the path to mesh database and the source file of the first
+   * shot
+   *
+   */
+  std::tuple<std::string, std::string> get_databases() const {
+    return std::make_tuple(this->fortran_database,
+                           this->source_databases.front());
+  }
+  /**
+   * @brief Get the source file of every shot
+   *
+   * @return std::vector<std::string> One source file per shot
+   */
+  std::vector<std::string> get_source_files() const {
+    return this->source_databases;
+  }
+  /**
+   * @brief Get the directory storing setup cache files
+   *
+   * @return std::string Directory, empty if the cache is disabled
+   */
+  std::string get_setup_cache() const { return this->setup_cache; }
+  /**
+   * @brief Get the directory storing source and station location cache
+   * files
+   *
+   * @return std::string Directory, empty if the cache is disabled
+   */
+  std::string get_location_cache() const { return this->location_cache; }
+  /**
+   * @brief Get the external velocity model and the number of grid rows read
+   * at once
+   *
+   * @return std::tuple<std::string, int> Model file, empty if material
+   * properties are taken from the database, and tile rows
+   */
+  std::tuple<std::string, int> get_velocity_model() const {
+    return std::make_tuple(this->velocity_model,
+                           this->velocity_model_tile_rows);
+  }
+  /**
+   * @brief Check if the mesh is generated by the internal mesher instead of
+   * being read from a database
+   *
+   */
+  bool get_internal_mesh() const { return this->internal_mesh; }
+  /**
+   * @brief Get the layered model meshed by the internal mesher
+   *
+   * @return specfem::mesher::layered_model Layered model
+   */
+  specfem::mesher::layered_model get_layered_model() const {
+    return this->layered_model;
+  }
+
+private:
+  std::string fortran_database; ///< location of fortran binary database
+  std::vector<std::string> source_databases; ///< location of the sources
+                                             ///< file of every shot
+  std::string setup_cache;      ///< Directory storing setup cache files
+  std::string location_cache;   ///< Directory storing location cache files
+  std::string velocity_model;   ///< External velocity model file
+  int velocity_model_tile_rows = 256; ///< Grid rows of the velocity model
+                                      ///< read at once
+  bool internal_mesh = false; ///< Mesh generated by the internal mesher
+  specfem::mesher::layered_model layered_model; ///< Model meshed by the
+                                                ///< internal mesher
+};
+
+/**
+ * Setup class is used to read the YAML file parameter file.
+ *
+ * Setup class is also used to instantiate the simulation i.e. instantiate
+ * quadrature objects, instantiate solver objects.
+ *
+ */
+class setup {
+
+public:
+  /**
+   * @brief Construct a new setup object
+   *
+   * @param parameter_file Path to a configuration YAML file
+   */
+  setup(std::string parameter_file);
+  /**
+   * @brief Instantiate quadrature objects in x and z dimensions
+   *
+   * @return std::tuple<specfem::quadrature::quadrature,
+   * specfem::quadrature::quadrature> Quadrature objects in x and z dimensions
+   */
+  std::tuple<specfem::quadrature::quadrature, specfem::quadrature::quadrature>
+  instantiate_quadrature() {
+    return this->quadrature->instantiate();
+  }
+  /**
+   * @brief Instantiate the Timescheme
+   *
+   * @return specfem::TimeScheme::TimeScheme* Pointer to the TimeScheme object
+   * used in the solver algorithm
+   */
+  specfem::TimeScheme::TimeScheme *instantiate_solver() {
+    auto it = this->solver->instantiate(
+        this->seismogram->get_nstep_between_samples());
+
+    // User output
+    std::cout << *it << "\n";
+
+    return it;
+  }
+  /**
+   * @brief Update simulation start time.
+   *
+   * If user has not defined start time then we need to update the simulation
+   * start time based on source frequencies and time shift
+   *
+   * @note This might be specific to only time-marching solvers
+   *
+   * @param t0 Simulation start time
+   */
+  void update_t0(type_real t0) { this->solver->update_t0(t0); }
+  /**
+   * @brief Log the header and description of the simulation
+   */
+  std::string
+  print_header(std::chrono::time_point<std::chrono::high_resolution_clock> now);
+
+  /**
+   * @brief Get delta time value
+   *
+   * @return type_real
+   */
+  type_real get_dt() const { return solver->get_dt(); }
+
+  /**
+   * @brief Check if the time increment is derived from the stable time step
+   *
+   * @return bool true if the time increment is set to auto
+   */
+  bool is_auto_dt() const { return solver->is_auto_dt(); }
+
+  /**
+   * @brief Update the time increment using the maximum stable time step
+   *
+   * @note Needs to be called before the sources are read and the solver is
+   * instantiated
+   *
+   * @param stable_dt Maximum stable time step of the mesh
+   */
+  void update_dt(const type_real stable_dt) { solver->update_dt(stable_dt); }
+
+  /**
+   * @brief Get the maximum number of local time stepping levels
+   *
+   * @return int Maximum number of levels. 1 if local time stepping is
+   * disabled
+   */
+  int get_lts_levels() const { return solver->get_lts_levels(); }
+
+  /**
+   * @brief Get the number of recorded seismogram samples without
+   * instantiating the solver
+   *
+   * @return int Number of recorded seismogram samples
+   */
+  int get_max_seismogram_step() const {
+    return solver->get_nstep() / seismogram->get_nstep_between_samples();
+  }
+
+  /**
+   * @brief Get the path to mesh database and source yaml file
+   *
+   * @return std::tuple<std::string, std::string> std::tuple specifying the path
+   * to mesh database and source yaml file
+   */
+  std::tuple<std::string, std::string> get_databases() const {
+    return databases->get_databases();
+  }
+  /**
+   * @brief Get the source file of every shot simulated together
+   *
+   * @return std::vector<std::string> One source file per shot
+   */
+  std::vector<std::string> get_source_files() const {
+    return databases->get_source_files();
+  }
+  /**
+   * @brief Get the directory storing setup cache files
+   *
+   * @return std::string Directory, empty if the cache is disabled
+   */
+  std::string get_setup_cache() const {
+    return databases->get_setup_cache();
+  }
+  /**
+   * @brief Get the directory storing source and station location cache
+   * files
+   *
+   * @return std::string Directory, empty if the cache is disabled
+   */
+  std::string get_location_cache() const {
+    return databases->get_location_cache();
+  }
+  /**
+   * @brief Get the external velocity model and the number of grid rows read
+   * at once
+   *
+   * @return std::tuple<std::string, int> Model file, empty if material
+   * properties are taken from the database, and tile rows
+   */
+  std::tuple<std::string, int> get_velocity_model() const {
+    return databases->get_velocity_model();
+  }
+  /**
+   * @brief Check if the mesh is generated by the internal mesher
+   *
+   */
+  bool get_internal_mesh() const { return databases->get_internal_mesh(); }
+  /**
+   * @brief Get the layered model meshed by the internal mesher
+   *
+   * @return specfem::mesher::layered_model Layered model
+   */
+  specfem::mesher::layered_model get_layered_model() const {
+    return databases->get_layered_model();
+  }
+
+  /**
+   * @brief Get the path to stations file
+   *
+   * @return std::string path to stations file
+   */
+  std::string get_stations_file() const {
+    return seismogram->get_stations_file();
+  }
+
+  /**
+   * @brief Get the angle of receivers
+   *
+   * @return type_real angle of the receiver
+   */
+  type_real get_receiver_angle() const { return seismogram->get_angle(); }
+
+  /**
+   * @brief Get the runtime options used to select domain kernels
+   *
+   * @return specfem::Domain::options Domain options
+   */
+  specfem::Domain::options get_domain_options() const {
+    specfem::Domain::options options = run_setup->get_domain_options();
+    options.wave = this->wave;
+    options.nshots = databases->get_source_files().size();
+    return options;
+  }
+
+  /**
+   * @brief Get the wave type simulated
+   *
+   * @return specfem::wave::type Wave type
+   */
+  specfem::wave::type get_wave_type() const { return this->wave; }
+
+  /**
+   * @brief Get the reordering applied to spectral elements
+   *
+   * @return specfem::reordering::type Element reordering type
+   */
+  specfem::reordering::type get_element_ordering() const {
+    return run_setup->get_element_ordering();
+  }
+
+  /**
+   * @brief Check if timesteps are executed by replaying recorded graphs
+   *
+   * @return bool true if graph execution is enabled
+   */
+  bool get_graph_execution() const {
+    return run_setup->get_graph_execution();
+  }
+
+  /**
+   * @brief Check if viscoelastic attenuation is simulated
+   *
+   * @return bool true if attenuation is enabled
+   */
+  bool get_attenuation() const { return run_setup->get_attenuation(); }
+
+  /**
+   * @brief Check if Stacey absorbing boundaries are applied
+   *
+   * @return bool true if absorbing boundaries are enabled
+   */
+  bool get_absorbing_boundaries() const {
+    return run_setup->get_absorbing_boundaries();
+  }
+
+  /**
+   * @brief Check if PML layers absorb waves in region_CPML elements
+   *
+   * @return bool true if PML layers are enabled
+   */
+  bool get_pml() const { return run_setup->get_pml(); }
+
+  /**
+   * @brief Get the frequency setting the frequency shift of PML profiles
+   *
+   * @return type_real Frequency in Hz
+   */
+  type_real get_pml_frequency() const {
+    return run_setup->get_pml_frequency();
+  }
+
+  /**
+   * @brief Get the theoretical reflection coefficient of PML layers
+   *
+   * @return type_real Reflection coefficient
+   */
+  type_real get_pml_reflection() const {
+    return run_setup->get_pml_reflection();
+  }
+
+  /**
+   * @brief Check if a serial database is partitioned at startup
+   *
+   * @return bool true if partitioning is enabled
+   */
+  bool get_partition_mesh() const { return run_setup->get_partition_mesh(); }
+
+  /**
+   * @brief Get the relative cost of element types used to balance partitions
+   *
+   * @return specfem::partitioner::weights Element weights
+   */
+  specfem::partitioner::weights get_partition_weights() const {
+    return run_setup->get_partition_weights();
+  }
+
+  /**
+   * @brief Get the path of the element weights file used to balance
+   * partitions
+   *
+   * @return std::string Path of the file. Empty if partitions are balanced
+   * using the weights of element types
+   */
+  std::string get_partition_weights_file() const {
+    return run_setup->get_partition_weights_file();
+  }
+
+  /**
+   * @brief Check if the phases of the run are timed
+   *
+   * @return bool true if timers are enabled
+   */
+  bool get_timers() const { return run_setup->get_timers(); }
+
+  /**
+   * @brief Check if timed phases fence their execution space
+   *
+   * @return bool true if timers are accurate
+   */
+  bool get_accurate_timers() const { return run_setup->get_accurate_timers(); }
+
+  /**
+   * @brief Get the peak bandwidth of the machine
+   *
+   * @return double Peak bandwidth in GB/s. 0 if unknown
+   */
+  double get_peak_bandwidth() const { return run_setup->get_peak_bandwidth(); }
+
+  /**
+   * @brief Get the peak flop rate of the machine
+   *
+   * @return double Peak flop rate in GFLOP/s. 0 if unknown
+   */
+  double get_peak_flops() const { return run_setup->get_peak_flops(); }
+
+  /**
+   * @brief Get the path of the JSON startup report
+   *
+   * @return std::string Path of the report. Empty if the report isn't
+   * written
+   */
+  std::string get_startup_report() const {
+    return run_setup->get_startup_report();
+  }
+
+  /**
+   * @brief Get the time between two progress lines of the time loop
+   *
+   * @return double Interval in seconds. Progress isn't reported if less
+   * than 0
+   */
+  double get_progress_interval() const {
+    return run_setup->get_progress_interval();
+  }
+
+  /**
+   * @brief Get the path of the progress status file
+   *
+   * @return std::string Path of the status file. Empty if the file isn't
+   * written
+   */
+  std::string get_status_file() const { return run_setup->get_status_file(); }
+
+  /**
+   * @brief Get the number of steps between two stability checks
+   *
+   * @return int Number of steps. Fields aren't checked if 0
+   */
+  int get_stability_interval() const {
+    return run_setup->get_stability_interval();
+  }
+
+  /**
+   * @brief Get the largest absolute value of stable fields
+   *
+   * @return type_real Stability threshold
+   */
+  type_real get_stability_threshold() const {
+    return run_setup->get_stability_threshold();
+  }
+
+  /**
+   * @brief Get the path of the Chrome trace JSON file
+   *
+   * @return std::string Path of the trace. Empty if the run isn't traced
+   */
+  std::string get_trace_file() const { return run_setup->get_trace_file(); }
+
+  /**
+   * @brief Get the first traced step
+   *
+   * @return int First traced step
+   */
+  int get_trace_first_step() const {
+    return run_setup->get_trace_first_step();
+  }
+
+  /**
+   * @brief Get the last traced step
+   *
+   * @return int Last traced step
+   */
+  int get_trace_last_step() const { return run_setup->get_trace_last_step(); }
+
+  /**
+   * @brief Get the path of the element weights file written after the time
+   * loop
+   *
+   * @return std::string Path of the file. Empty if weights aren't written
+   */
+  std::string get_element_weights_file() const {
+    return run_setup->get_element_weights_file();
+  }
+
+  /**
+   * @brief Get the types of siesmograms to be calculated
+   *
+   * @return std::vector<specfem::seismogram::type> Types of seismograms to be
+   * calculated
+   */
+  std::vector<specfem::seismogram::type> get_seismogram_types() const {
+    return this->seismogram->get_seismogram_types();
+  }
+
+  /**
+   * @brief Get the number of seismogram samples stored on the device before
+   * they are appended to output files
+   *
+   * @return int Number of samples, 0 if every sample is stored
+   */
+  int get_seismogram_buffer_size() const {
+    return this->seismogram->get_buffer_size();
+  }
+
+  /**
+   * @brief Get the number of recorded seismogram samples between written
+   * samples
+   *
+   * @return int Decimation factor, 1 if every recorded sample is written
+   */
+  int get_seismogram_decimation() const {
+    return this->seismogram->get_decimation();
+  }
+
+  /**
+   * @brief Check if the simulation is reciprocal
+   *
+   * @return bool true if forces are applied at the stations
+   */
+  bool get_reciprocal() const { return this->seismogram->get_reciprocal(); }
+
+  /**
+   * @brief Get the folder storing the seismograms
+   *
+   */
+  std::string get_seismogram_folder() const {
+    return this->seismogram->get_output_folder();
+  }
+
+  /**
+   * @brief Update the folder storing the seismograms of the next writers
+   *
+   * @param output_folder Path to folder
+   */
+  void update_seismogram_folder(const std::string &output_folder) {
+    this->seismogram->update_output_folder(output_folder);
+  }
+
+  /**
+   * @brief Instantiate a seismogram writer object
+   *
+   * @param receivers Stations used to instantiate the writer
+   * @param compute_receivers Pointer to specfem::compute::receivers struct used
+   * to instantiate the writer
+   * @param mpi Pointer to MPI object. nullptr if this process stores every
+   * receiver. Required by misfit writers
+   * @return specfem::writer::writer* Pointer to an instantiated writer object,
+   * a misfit writer if the parameter file defines a misfit section
+   */
+  specfem::writer::writer *instantiate_seismogram_writer(
+      const specfem::receivers::receiver_set &receivers,
+      specfem::compute::receivers *compute_receivers,
+      const specfem::MPI::MPI *mpi = nullptr) const {
+    if (this->misfit) {
+      const type_real sample_dt =
+          this->solver->get_dt() *
+          this->seismogram->get_nstep_between_samples() *
+          this->seismogram->get_decimation();
+      return this->misfit->instantiate_misfit_writer(
+          receivers, compute_receivers, this->wave, sample_dt,
+          this->solver->get_t0(), mpi);
+    }
+    return this->seismogram->instantiate_seismogram_writer(
+        receivers, compute_receivers, this->solver->get_dt(),
+        this->solver->get_t0(), mpi);
+  }
+
+  /**
+   * @brief Instantiate the seismogram writer of a reciprocal simulation
+   *
+   * @param domain Pointer to domain storing the fields of the station forces
+   * @param compute Pointer to specfem::compute::compute struct storing the
+   * global numbering
+   * @param sources Sources of the source files, located within the mesh
+   * @param receivers Stations of the simulation
+   * @param quadx Quadrature object in x-dimension
+   * @param quadz Quadrature object in z-dimension
+   * @param nsig_steps Number of recorded samples
+   * @param source_t0 Starting time of the seismograms of the sources
+   * @param mpi Pointer to MPI object
+   * @return specfem::writer::writer* Pointer to an instantiated writer object
+   */
+  specfem::writer::writer *instantiate_reciprocal_writer(
+      specfem::Domain::Domain *domain,
+      const specfem::compute::compute *compute,
+      const std::vector<specfem::sources::source *> &sources,
+      const specfem::receivers::receiver_set &receivers,
+      const specfem::quadrature::quadrature &quadx,
+      const specfem::quadrature::quadrature &quadz, const int nsig_steps,
+      const type_real source_t0, specfem::MPI::MPI *mpi) const {
+    return this->seismogram->instantiate_reciprocal_writer(
+        domain, compute, sources, receivers, quadx, quadz, this->wave,
+        nsig_steps, this->solver->get_dt(), this->solver->get_t0(), source_t0,
+        mpi);
+  }
+
+  /**
+   * @brief Check if the parameter file requests wavefield snapshots
+   *
+   * @return bool true if snapshots are written
+   */
+  bool get_wavefield_snapshots() const { return this->wavefield != nullptr; }
+
+  /**
+   * @brief Check if the parameter file requests spectra of seismograms
+   *
+   * @return bool true if spectra are written
+   */
+  bool get_spectra() const { return this->spectrum != nullptr; }
+
+  /**
+   * @brief Instantiate a wavefield snapshot writer object
+   *
+   * @param domain Pointer to domain storing the fields
+   * @param compute Pointer to specfem::compute::compute struct storing the
+   * global numbering and coordinates
+   * @param quadx Quadrature object in x dimension
+   * @param quadz Quadrature object in z dimension
+   * @param coorg (x, z) for every spectral element control node
+   * @param knods Global control element number for every control node
+   * @param mpi Pointer to MPI object
+   * @return specfem::writer::wavefield* Pointer to an instantiated writer
+   * object, nullptr if the parameter file doesn't request snapshots
+   */
+  specfem::writer::wavefield *instantiate_wavefield_writer(
+      specfem::Domain::Domain *domain,
+      const specfem::compute::compute *compute,
+      const specfem::quadrature::quadrature &quadx,
+      const specfem::quadrature::quadrature &quadz,
+      const specfem::kokkos::HostView2d<type_real> coorg,
+      const specfem::kokkos::HostView2d<int> knods,
+      const specfem::MPI::MPI *mpi) const {
+    if (!this->wavefield)
+      return nullptr;
+    return this->wavefield->instantiate_wavefield_writer(
+        domain, compute, quadx, quadz, coorg, knods, mpi);
+  }
+
+  /**
+   * @brief Instantiate a spectrum writer object
+   *
+   * @param domain Pointer to domain storing the fields
+   * @param compute Pointer to specfem::compute::compute struct storing the
+   * global numbering and coordinates
+   * @param receivers Stations read from the stations file
+   * @param compute_receivers Pointer to specfem::compute::receivers struct
+   * storing seismograms
+   * @param mpi Pointer to MPI object
+   * @return specfem::writer::spectrum* Pointer to an instantiated writer
+   * object, nullptr if the parameter file doesn't request spectra
+   */
+  specfem::writer::spectrum *instantiate_spectrum_writer(
+      specfem::Domain::Domain *domain,
+      const specfem::compute::compute *compute,
+      const specfem::receivers::receiver_set &receivers,
+      const specfem::compute::receivers *compute_receivers,
+      const specfem::MPI::MPI *mpi) const {
+    if (!this->spectrum)
+      return nullptr;
+    const type_real sample_dt = this->solver->get_dt() *
+                                this->seismogram->get_nstep_between_samples() *
+                                this->seismogram->get_decimation();
+    return this->spectrum->instantiate_spectrum_writer(
+        domain, compute, receivers, compute_receivers, this->solver->get_dt(),
+        this->solver->get_t0(), sample_dt, mpi);
+  }
+
+  /**
+   * @brief Instantiate a checkpoint object
+   *
+   * @param domain Pointer to domain storing the fields
+   * @param compute_receivers Pointer to specfem::compute::receivers struct
+   * storing seismograms
+   * @param writer Pointer to the seismogram writer
+   * @param mpi Pointer to MPI object
+   * @return specfem::checkpoint::checkpoint* Pointer to an instantiated
+   * checkpoint object, nullptr if the parameter file doesn't define
+   * checkpoints
+   */
+  specfem::checkpoint::checkpoint *
+  instantiate_checkpoint(specfem::Domain::Domain *domain,
+                         specfem::compute::receivers *compute_receivers,
+                         specfem::writer::writer *writer,
+                         const specfem::MPI::MPI *mpi) const {
+    if (!this->checkpoint)
+      return nullptr;
+    return this->checkpoint->instantiate_checkpoint(domain, compute_receivers,
+                                                    writer, mpi);
+  }
+
+  /**
+   * @brief Check if the simulation computes sensitivity kernels
+   *
+   * @return bool true if the parameter file defines an adjoint section
+   */
+  bool get_adjoint() const { return this->adjoint != nullptr; }
+
+  /**
+   * @brief Get the configuration of the adjoint simulation
+   *
+   * @return const specfem::runtime_configuration::adjoint* Pointer to the
+   * adjoint configuration, nullptr if kernels aren't computed
+   */
+  const specfem::runtime_configuration::adjoint *
+  get_adjoint_configuration() const {
+    return this->adjoint;
+  }
+
+  /**
+   * @brief Get the configuration of the wavefield injection
+   *
+   * @return const specfem::runtime_configuration::injection* Pointer to the
+   * injection configuration, nullptr if the simulation isn't hybrid
+   */
+  const specfem::runtime_configuration::injection *
+  get_injection_configuration() const {
+    return this->injection;
+  }
+
+  /**
+   * @brief Get the configuration of the misfit writer
+   *
+   * @return const specfem::runtime_configuration::misfit* Pointer to the
+   * misfit configuration, nullptr if seismograms are written
+   */
+  const specfem::runtime_configuration::misfit *
+  get_misfit_configuration() const {
+    return this->misfit;
   }
 
 private:
@@ -482,8 +1825,24 @@ private:
                                                           ///< quadrature object
   specfem::runtime_configuration::seismogram *seismogram; ///< Pointer to
                                                           ///< seismogram object
+  specfem::runtime_configuration::wavefield *wavefield =
+      nullptr; ///< Pointer to wavefield object, null if snapshots aren't
+               ///< written
+  specfem::runtime_configuration::checkpoint *checkpoint =
+      nullptr; ///< Pointer to checkpoint object, null if checkpoints aren't
+               ///< written
+  specfem::runtime_configuration::spectrum *spectrum =
+      nullptr; ///< Pointer to spectrum object, null if spectra aren't written
+  specfem::runtime_configuration::adjoint *adjoint =
+      nullptr; ///< Pointer to adjoint object, null if kernels aren't computed
+  specfem::runtime_configuration::injection *injection =
+      nullptr; ///< Pointer to injection object, null if the simulation isn't
+               ///< hybrid
+  specfem::runtime_configuration::misfit *misfit =
+      nullptr; ///< Pointer to misfit object, null if seismograms are written
   specfem::runtime_configuration::database_configuration
       *databases; ///< Get database filenames
+  specfem::wave::type wave = specfem::wave::p_sv; ///< Wave type simulated
 };
 
 } // namespace runtime_configuration
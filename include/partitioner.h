@@ -0,0 +1,91 @@
+#ifndef PARTITIONER_H
+#define PARTITIONER_H
+
+#include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/material.h"
+#include "../include/mesh.h"
+#include <string>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Routines used to partition a serial mesh across MPI ranks
+ *
+ */
+namespace partitioner {
+
+/**
+ * @brief Relative cost of spectral elements used to balance partitions
+ *
+ */
+struct weights {
+  type_real elastic = 1.0;     ///< Cost of an elastic element
+  type_real acoustic = 0.5;    ///< Cost of an acoustic element
+  type_real poroelastic = 2.0; ///< Cost of a poroelastic element
+  type_real absorbing = 0.25;  ///< Additional cost of an element on an
+                               ///< absorbing boundary
+  type_real pml = 1.0;         ///< Additional cost of a PML element
+};
+
+/**
+ * @brief Compute the cost of every spectral element of a mesh
+ *
+ * @param mesh Mesh read from database
+ * @param materials Materials read from database
+ * @param weights Relative cost of element types
+ * @return std::vector<type_real> Cost of every spectral element (nspec)
+ */
+std::vector<type_real>
+element_weights(const specfem::mesh &mesh,
+                const std::vector<specfem::material *> &materials,
+                const specfem::partitioner::weights &weights);
+
+/**
+ * @brief Read the cost of every spectral element of a serial mesh
+ *
+ * Every line of the file is the index of an element in the serial mesh
+ * followed by its cost, e.g. as written by
+ * specfem::load_balance::write_element_weights
+ *
+ * @param filename Path of the element weights file
+ * @param nspec Number of spectral elements of the serial mesh
+ * @return std::vector<type_real> Cost of every spectral element (nspec)
+ */
+std::vector<type_real> read_element_weights(const std::string &filename,
+                                            const int nspec);
+
+/**
+ * @brief Partition spectral elements into parts of equal cost
+ *
+ * Elements are ordered along a Morton curve of their centroids, which is cut
+ * into nparts contiguous segments of equal cumulative cost. Every part has at
+ * least one element.
+ *
+ * @param coorg (x,z) for every spectral element control node
+ * @param knods Global control element number for every control node
+ * @param element_weights Cost of every spectral element
+ * @param nparts Number of parts
+ * @return std::vector<int> Part of every spectral element (nspec)
+ */
+std::vector<int>
+partition_elements(const specfem::kokkos::HostView2d<type_real> coorg,
+                   const specfem::kokkos::HostView2d<int> knods,
+                   const std::vector<type_real> &element_weights,
+                   const int nparts);
+
+/**
+ * @brief User output
+ *
+ * @param element_weights Cost of every spectral element
+ * @param element_partition Part of every spectral element
+ * @param nparts Number of parts
+ * @return std::string Cost of the most expensive part relative to the mean
+ */
+std::string print(const std::vector<type_real> &element_weights,
+                  const std::vector<int> &element_partition, const int nparts);
+
+} // namespace partitioner
+} // namespace specfem
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef PML_H
+#define PML_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/memory_report.h"
+#include "../include/quadrature.h"
+#include "../include/specfem_mpi.h"
+
+namespace specfem {
+namespace boundaries {
+
+/**
+ * @brief Extent of the PML layers surrounding the mesh
+ *
+ * The interior of the mesh is the bounding box of the elements that aren't
+ * flagged in region_CPML, the exterior is the bounding box of the whole mesh.
+ * Both boxes are reduced across MPI ranks, hence every rank sees the same
+ * layers.
+ */
+struct pml_layer {
+  type_real interior[4]; ///< xmin, xmax, zmin and zmax of interior elements
+  type_real exterior[4]; ///< xmin, xmax, zmin and zmax of the mesh
+
+  /**
+   * @brief Default constructor. There are no layers
+   *
+   */
+  pml_layer() : interior{ 0, 0, 0, 0 }, exterior{ 0, 0, 0, 0 } {};
+  /**
+   * @brief Compute the extent of the layers
+   *
+   * @param region_CPML PML flag of every element (nspec)
+   * @param compute Pointer to the struct storing the global numbering and
+   * coordinates
+   * @param mpi Pointer to the MPI object
+   */
+  pml_layer(const specfem::kokkos::HostView1d<int> region_CPML,
+            const specfem::compute::compute *compute,
+            const specfem::MPI::MPI *mpi);
+  /**
+   * @brief Distance of a point into the layer along one dimension
+   *
+   * @param idim Dimension, 0 for x and 1 for z
+   * @param coord Coordinate of the point along idim
+   * @param thickness Thickness of the layer containing the point, 0 if the
+   * point is inside the interior box
+   * @return type_real Distance from the interior box
+   */
+  type_real distance(const int idim, const type_real coord,
+                     type_real &thickness) const;
+};
+
+/**
+ * @brief Convolutional PML of the elastic elements flagged in region_CPML
+ *
+ * PML elements are copied into compact arrays storing their global
+ * numbering, geometry, material, damping profiles and memory variables,
+ * hence the memory used scales with the thickness of the layers rather than
+ * with the number of elements. The stiffness interaction of the domain is
+ * kept unchanged, and a correction kernel launched over the PML elements
+ * after it adds:
+ *
+ * - the weak form of the stress computed from the difference between the
+ * stretched gradients (s_z / s_x) d/dx, (s_x / s_z) d/dz and the regular
+ * gradients
+ * - the terms rho * (s_x * s_z - 1) * acceleration expressed with the
+ * velocity, moved to the right hand side before the division by the mass
+ * matrix
+ *
+ * with s = 1 + d / (alpha + i omega). Convolutions are computed by recursive
+ * filters of the memory variables, 9 per field component and shot.
+ */
+class pml {
+
+public:
+  /**
+   * @brief Default constructor. There are no PML elements
+   *
+   */
+  pml() : nelements(0), ncomponents(1), nshots(1){};
+  /**
+   * @brief Construct the compact arrays of the PML elements of a domain
+   *
+   * Host views of the geometry and the material properties are read, hence
+   * this needs to be called before they are released.
+   *
+   * @param region_CPML PML flag of every element (nspec)
+   * @param layer Extent of the PML layers
+   * @param compute Pointer to the struct storing the global numbering and
+   * coordinates
+   * @param partial_derivatives Pointer to the partial derivatives
+   * @param properties Pointer to the material properties
+   * @param quadx Quadrature object in x dimension
+   * @param quadz Quadrature object in z dimension
+   * @param wave Wave type simulated by the domain
+   * @param nshots Number of shots stored in the fields
+   * @param f0 Frequency setting the frequency shift alpha = pi * f0 of the
+   * damping profiles at the inner edge of the layers
+   * @param reflection Theoretical reflection coefficient of the layers
+   * @param dt Time step of the time scheme
+   */
+  pml(const specfem::kokkos::HostView1d<int> region_CPML,
+      const specfem::boundaries::pml_layer &layer,
+      const specfem::compute::compute *compute,
+      const specfem::compute::partial_derivatives *partial_derivatives,
+      const specfem::compute::properties *properties,
+      const specfem::quadrature::quadrature *quadx,
+      const specfem::quadrature::quadrature *quadz,
+      const specfem::wave::type wave, const int nshots, const type_real f0,
+      const type_real reflection, const type_real dt);
+  /**
+   * @brief Update the memory variables and add the PML terms to the second
+   * derivative of the field
+   *
+   * @param field Field of the domain
+   * @param field_dot First derivative of the field of the domain
+   * @param field_dot_dot Second derivative of the field of the domain
+   * @param exec_space Execution space instance used to launch the kernel
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void compute_interaction(
+      const specfem::kokkos::DeviceFieldView2d<type_real> field,
+      const specfem::kokkos::DeviceFieldView2d<type_real> field_dot,
+      const specfem::kokkos::DeviceFieldView2d<type_real> field_dot_dot,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node) const;
+  /**
+   * @brief Number of PML elements
+   *
+   * @return int Number of elements stored in the compact arrays
+   */
+  int get_nelements() const { return this->nelements; }
+  /**
+   * @brief Number of memory variables of every quadrature point and shot
+   *
+   * @return int 9 times the number of field components
+   */
+  int get_nvariables() const { return 9 * this->ncomponents; }
+  /**
+   * @brief Memory used by the views of the PML elements
+   *
+   * @return specfem::memory::usage Bytes allocated on the device and the host
+   */
+  specfem::memory::usage memory_usage() const;
+
+private:
+  int nelements;   ///< Number of PML elements
+  int ncomponents; ///< Number of field components of every shot
+  int nshots;      ///< Number of shots stored in the fields
+  specfem::kokkos::DeviceView3d<int> ibool; ///< Global number of every
+                                            ///< point of the PML elements
+  specfem::kokkos::DeviceView4d<type_real>
+      coefficients; ///< Partial derivatives, Jacobian, mu, lambda + 2 mu and
+                    ///< weighted mass of every point
+  specfem::kokkos::DeviceView4d<type_real>
+      profile; ///< Damping d, frequency shift alpha and filter coefficients
+               ///< of every point
+  specfem::kokkos::DeviceView4d<type_real>
+      memory_variables; ///< Memory variables of every point (nelements,
+                        ///< ngllz, ngllx, 9 * ncomponents * nshots)
+  specfem::kokkos::DeviceView1d<type_real> wxgll; ///< Weights along x
+  specfem::kokkos::DeviceView1d<type_real> wzgll; ///< Weights along z
+  specfem::kokkos::DeviceView2d<type_real> hprime_xx; ///< Derivatives of the
+                                                      ///< polynomials along x
+  specfem::kokkos::DeviceView2d<type_real> hprime_zz; ///< Derivatives of the
+                                                      ///< polynomials along z
+  specfem::kokkos::DeviceView2d<type_real> hprimewgll_xx; ///< Weighted
+                                                          ///< derivatives
+                                                          ///< along x
+  specfem::kokkos::DeviceView2d<type_real> hprimewgll_zz; ///< Weighted
+                                                          ///< derivatives
+                                                          ///< along z
+};
+
+} // namespace boundaries
+} // namespace specfem
+
+#endif
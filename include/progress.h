@@ -0,0 +1,110 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include "../include/specfem_mpi.h"
+#include <chrono>
+#include <string>
+
+namespace specfem {
+/**
+ * @brief Progress of the time loop
+ *
+ */
+namespace progress {
+
+/**
+ * @brief Progress reporter of the time loop driven by the main process
+ *
+ * Other processes return immediately from every call, hence reporting
+ * progress never synchronizes processes. The main process reads the clock at
+ * every step and prints a line every interval seconds with the number of
+ * executed steps, the steps and elements per second, the estimated time of
+ * arrival and the memory allocated by its views. Kernels are launched
+ * asynchronously, hence rates measure the host side of the time loop, which
+ * is bounded by the fences inside it.
+ *
+ * The same values are written to a status file, which is replaced
+ * atomically so workflow managers can poll it
+ *
+ */
+class reporter {
+
+public:
+  /**
+   * @brief Construct a disabled reporter object
+   *
+   */
+  reporter() : active(false){};
+  /**
+   * @brief Construct a new reporter object
+   *
+   * @param mpi Pointer to MPI object
+   * @param interval Time between two progress lines in seconds. If 0 every
+   * update is reported, if less than 0 nothing is reported
+   * @param nelements Number of elements of the mesh summed over processes,
+   * used to report elements per second
+   * @param status_file Path of the status file. Not written if empty
+   */
+  reporter(const specfem::MPI::MPI *mpi, const double interval,
+           const double nelements, const std::string &status_file = "");
+  /**
+   * @brief Report the progress of a time loop
+   *
+   * Rates and estimated time of arrival are measured from the first update of
+   * a time loop. A loop starts when the name of the steps changes or when
+   * fewer steps were executed than at the previous update
+   *
+   * @param nexecuted Number of executed steps
+   * @param nstep Total number of steps of the loop
+   * @param name Name of the steps, e.g. adjoint steps
+   */
+  void update(const int nexecuted, const int nstep,
+              const std::string &name = "steps");
+  /**
+   * @brief Report the end of the time loops
+   *
+   * Prints the last progress line and marks the status file as finished
+   *
+   */
+  void finish();
+  /**
+   * @brief Get the last progress line
+   *
+   * @return std::string Last printed line. Empty on processes other than
+   * the main process
+   */
+  std::string get_message() const { return this->message; }
+
+private:
+  /**
+   * @brief Print the progress and write the status file
+   *
+   * @param state State written to the status file
+   */
+  void report(const std::string &state);
+
+  bool active;              ///< If false the process doesn't report progress
+  double interval = 0.0;    ///< Time between two progress lines in seconds
+  double nelements = 0.0;   ///< Number of elements of the mesh
+  std::string status_file;  ///< Path of the status file
+  std::string name;         ///< Name of the steps of the running loop
+  int nexecuted = -1;       ///< Executed steps at the last update
+  int nstep = 0;            ///< Number of steps of the running loop
+  int nfirst = 0;           ///< Executed steps at the start of the loop
+  std::string message;      ///< Last progress line
+  std::chrono::steady_clock::time_point begin; ///< Start of the loop
+  std::chrono::steady_clock::time_point last;  ///< Time of the last report
+};
+
+/**
+ * @brief Disabled reporter used by solvers without a reporter
+ *
+ * @return specfem::progress::reporter* Pointer to a reporter printing
+ * nothing
+ */
+specfem::progress::reporter *disabled();
+
+} // namespace progress
+} // namespace specfem
+
+#endif
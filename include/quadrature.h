@@ -59,6 +59,15 @@ public:
    *
    */
   specfem::kokkos::DeviceView2d<type_real> get_hprime() const;
+  /**
+   * Get derivatives of quadrature polynomials weighted by quadrature weights
+   * on device
+   *
+   * @code
+   * hprimewgll(i, j) = hprime(j, i) * w(j)
+   * @endcode
+   */
+  specfem::kokkos::DeviceView2d<type_real> get_hprimewgll() const;
   /**
    * Get quadrature points on host
    *
@@ -74,11 +83,39 @@ public:
    *
    */
   specfem::kokkos::HostMirror2d<type_real> get_hhprime() const;
+  /**
+   * Get derivatives of quadrature polynomials weighted by quadrature weights
+   * on host
+   *
+   */
+  specfem::kokkos::HostMirror2d<type_real> get_hhprimewgll() const;
   /**
    * @brief get number of quadrture points
    *
    */
   int get_N() const;
+  /**
+   * @brief Check if the quadrature is the GLL quadrature of a compile-time
+   * table
+   *
+   * Points, weights and derivatives are then copied from
+   * specfem::quadrature::gll_tables<type_real, N>, and kernels specialized
+   * for N may read the table instead of the views of this object
+   *
+   * @return true if alpha = beta = 0 and N <= 10
+   */
+  bool has_gll_table() const;
+  /**
+   * @brief Check if the quadrature is the Gauss-Lobatto-Jacobi quadrature of
+   * the elements on the axis of axisymmetric simulations
+   *
+   * Weights then integrate f(xi) (1 + xi), and derivatives are the
+   * derivatives of the GLJ interpolants (Nissen-Meyer et al. 2007, equation
+   * A27)
+   *
+   * @return true if alpha = 0 and beta = 1
+   */
+  bool is_glj() const;
 
 private:
   type_real alpha; ///< alpha value of the quadrature
@@ -99,6 +136,18 @@ private:
                                                    ///< stored on device
   specfem::kokkos::HostView2d<type_real> h_hprime; ///< Polynomial derivatives
                                                    ///< store on host
+  specfem::kokkos::DeviceView2d<type_real> hprimewgll; ///< Transposed
+                                                       ///< polynomial
+                                                       ///< derivatives
+                                                       ///< weighted by
+                                                       ///< quadrature weights
+                                                       ///< stored on device
+  specfem::kokkos::HostView2d<type_real> h_hprimewgll; ///< Transposed
+                                                       ///< polynomial
+                                                       ///< derivatives
+                                                       ///< weighted by
+                                                       ///< quadrature weights
+                                                       ///< stored on host
 
   /**
    * Set View allocations for all derivative matrices
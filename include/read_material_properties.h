@@ -20,7 +20,7 @@ namespace IO {
  * from the database file
  */
 std::vector<specfem::material *>
-read_material_properties(std::ifstream &stream, const int numat,
+read_material_properties(std::istream &stream, const int numat,
                          const specfem::MPI::MPI *mpi);
 } // namespace IO
 
@@ -13,6 +13,7 @@
 #include "../include/surfaces.h"
 #include <fstream>
 #include <iostream>
+#include <string>
 #include <tuple>
 
 namespace IO {
@@ -22,19 +23,35 @@ namespace IO {
  */
 namespace fortran_database {
 
+/**
+ * @brief Read the content of a database file with one reader per node
+ *
+ * The first process of every node gathers the filenames of the processes of
+ * the node, reads every distinct file with a single bulk read and scatters
+ * the contents. If every process of the node reads the same file, e.g. a
+ * serial database partitioned at startup, the content is broadcast instead.
+ * Record parsers then read from memory instead of the filesystem.
+ *
+ * @param filename Database filename of this process
+ * @param mpi Pointer to MPI object
+ * @return std::string Content of the database file
+ */
+std::string read_database_file(const std::string &filename,
+                               const specfem::MPI::MPI *mpi);
+
 /**
  * @brief Read fortran bindary database header.
  *
- * This section populates nspec, npgeo, nproc in the mesh struct
+ * This section populates nspec, npgeo, nproc and axisym in the mesh struct
  *
  * @param stream Stream object for fortran binary file buffered to header
  * section
  * @param mpi Pointer to MPI object
- * @return std::tuple<int, int, int> nspec, npgeo, nproc values read from
- * database file
+ * @return std::tuple<int, int, int, bool> nspec, npgeo, nproc and AXISYM
+ * values read from database file
  */
-std::tuple<int, int, int>
-read_mesh_database_header(std::ifstream &stream, const specfem::MPI::MPI *mpi);
+std::tuple<int, int, int, bool>
+read_mesh_database_header(std::istream &stream, const specfem::MPI::MPI *mpi);
 /**
  * @brief Read coorg elements from fortran binary database file
  *
@@ -46,22 +63,55 @@ read_mesh_database_header(std::ifstream &stream, const specfem::MPI::MPI *mpi);
  * fortran binary database file
  */
 specfem::kokkos::HostView2d<type_real>
-read_coorg_elements(std::ifstream &stream, const int npgeo,
+read_coorg_elements(std::istream &stream, const int npgeo,
                     const specfem::MPI::MPI *mpi);
-
 /**
- * @warning These two routines need to be implemented
+ * @brief Read coorg elements from fortran binary database file into an
+ * allocated view
+ *
+ * @param stream Stream object for fortran binary file buffered to header
+ * section
+ * @param npgeo Total number of control nodes in simulation box
+ * @param coorg View (ndim, npgeo) storing coorg values
+ * @param store If false values are read and discarded, e.g. when coorg is
+ * shared with another process writing it
+ * @param mpi Pointer to MPI object
  */
+void read_coorg_elements(std::istream &stream, const int npgeo,
+                         const specfem::kokkos::HostView2d<type_real> coorg,
+                         const bool store, const specfem::MPI::MPI *mpi);
 
+/**
+ * @brief Read attenuation parameters from mesh database
+ *
+ * @param stream Stream object for fortran binary file buffered to attenuation
+ * section
+ * @param mpi Pointer to MPI object
+ * @return std::tuple<int, type_real, bool> Number of standard linear solids,
+ * reference frequency and if velocities are given at the reference frequency
+ */
 std::tuple<int, type_real, bool>
-read_mesh_database_attenuation(std::ifstream &stream,
+read_mesh_database_attenuation(std::istream &stream,
                                const specfem::MPI::MPI *mpi);
 
-void read_mesh_database_coupled(std::ifstream &stream,
-                                const int num_fluid_solid_edges,
-                                const int num_fluid_poro_edges,
-                                const int num_solid_poro_edges,
-                                const specfem::MPI::MPI *mpi);
+/**
+ * @brief Read coupled edges from mesh database
+ *
+ * Edges coupling poroelastic elements are skipped
+ *
+ * @param stream Stream object for fortran binary file buffered to coupled
+ * edges section
+ * @param num_fluid_solid_edges Number of fluid-solid edges
+ * @param num_fluid_poro_edges Number of fluid-poroelastic edges
+ * @param num_solid_poro_edges Number of solid-poroelastic edges
+ * @param mpi Pointer to MPI object
+ * @return specfem::surfaces::fluid_solid_edges Acoustic and elastic elements
+ * of every fluid-solid edge
+ */
+specfem::surfaces::fluid_solid_edges read_mesh_database_coupled(
+    std::istream &stream, const int num_fluid_solid_edges,
+    const int num_fluid_poro_edges, const int num_solid_poro_edges,
+    const specfem::MPI::MPI *mpi);
 } // namespace fortran_database
 } // namespace IO
 
@@ -2,8 +2,10 @@
 #define READ_SOURCES_H
 
 #include "../include/config.h"
+#include "../include/enums.h"
 #include "../include/receiver.h"
 #include "../include/source.h"
+#include <string>
 #include <vector>
 
 namespace specfem {
@@ -22,8 +24,80 @@ std::tuple<std::vector<specfem::sources::source *>, type_real>
 read_sources(const std::string sources_file, const type_real dt,
              const specfem::MPI::MPI *mpi);
 
-std::vector<specfem::receivers::receiver *>
-read_receivers(const std::string stations_file, const type_real angle);
+/**
+ * @brief Read the sources files of shots simulated together
+ *
+ * Every file defines the sources of one shot. Time shifts are relative to the
+ * earliest source of every shot, hence every shot shares the time axis of the
+ * simulation
+ *
+ * @param sources_files Name of the yml file of every shot
+ * @param dt Time interval between timesteps
+ * @param mpi Pointer to specfem MPI object
+ * @return std::tuple<std::vector<specfem::sources::source *>,
+ * std::vector<int>, type_real> Sources of every shot one shot after the
+ * other, shot of every source and start time of the simulation
+ */
+std::tuple<std::vector<specfem::sources::source *>, std::vector<int>,
+           type_real>
+read_sources(const std::vector<std::string> &sources_files, const type_real dt,
+             const specfem::MPI::MPI *mpi);
+
+/**
+ * @brief Create the point forces of a reciprocal simulation
+ *
+ * An impulsive force is applied at every station along x and z for P-SV
+ * waves, or out of plane for SH waves, every force being a shot. Forces use
+ * the Dirac source time function scaled to a unit integral
+ *
+ * @param receivers Stations of the simulation
+ * @param wave Wave type simulated by the domain
+ * @param dt Time interval between timesteps
+ * @return std::tuple<std::vector<specfem::sources::source *>,
+ * std::vector<int>, type_real> Forces of every station one station after the
+ * other, shot of every force and start time of the simulation
+ */
+std::tuple<std::vector<specfem::sources::source *>, std::vector<int>,
+           type_real>
+reciprocal_sources(const specfem::receivers::receiver_set &receivers,
+                   const specfem::wave::type wave, const type_real dt);
+
+/**
+ * @brief Create the adjoint sources of an adjoint simulation
+ *
+ * Residuals of every station are read from
+ * <residuals_folder>/<network><station>BXX.adj and BXZ.adj for P-SV waves, or
+ * BXX.adj for SH waves. Files store uniformly sampled "time value" lines on
+ * the time axis of the seismograms and define tabulated forces along the
+ * directions in which the seismogram components were recorded. Components
+ * without a residual file are skipped
+ *
+ * @param receivers Stations of the simulation
+ * @param wave Wave type simulated by the domain
+ * @param residuals_folder Folder storing the residual files
+ * @param dt Time interval between timesteps
+ * @return std::vector<specfem::sources::source *> Tabulated forces of every
+ * residual file
+ */
+std::vector<specfem::sources::source *>
+adjoint_sources(const specfem::receivers::receiver_set &receivers,
+                const specfem::wave::type wave,
+                const std::string &residuals_folder, const type_real dt);
+
+/**
+ * @brief Read stations file
+ *
+ * Stations files are either text files, every station being defined by 6
+ * whitespace delimited values, or binary files storing the coordinates and
+ * names of the stations as columns
+ *
+ * @param stations_file Name of the stations file
+ * @param angle Angle of the stations
+ * @return specfem::receivers::receiver_set Stations in the order of the file.
+ * Empty if the file doesn't exist
+ */
+specfem::receivers::receiver_set read_receivers(const std::string stations_file,
+                                                const type_real angle);
 } // namespace specfem
 
 #endif
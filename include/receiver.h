@@ -1,6 +1,7 @@
 #ifndef RECEIVER_H
 #define RECEIVER_H
 
+#include "../include/arena.h"
 #include "../include/config.h"
 #include "../include/constants.h"
 #include "../include/enums.h"
@@ -8,69 +9,114 @@
 #include "../include/quadrature.h"
 #include "../include/specfem_mpi.h"
 #include <cmath>
+#include <string>
+#include <vector>
 
 namespace specfem {
 namespace receivers {
 
 /**
- * @brief Receiver Class
+ * @brief Set of stations stored as arrays
+ *
+ * Every array stores one value per station, in the order of the stations
+ * file. Locations are assigned by locate, which locates every station in a
+ * single batch.
  *
  */
-class receiver {
-
-public:
+struct receiver_set {
+  /**
+   * @brief Construct an empty set of stations
+   *
+   * @param angle Angle of the stations
+   */
+  receiver_set(const type_real angle = 0.0) : angle(angle){};
+  /**
+   * @brief Get the number of stations
+   *
+   * @return int Number of stations
+   */
+  int size() const { return this->x.size(); }
   /**
-   * @brief Construct a new receiver object
+   * @brief Append a station to the set
    *
    * @param network_name Name of network where this station lies in
    * @param station_name Name of station
    * @param x X coordinate of the station
    * @param z Z coordinate of the station
-   * @param angle Angle of the station
    */
-  receiver(const std::string network_name, const std::string station_name,
-           const type_real x, const type_real z, const type_real angle)
-      : network_name(network_name), station_name(station_name), x(x), z(z),
-        angle(angle){};
+  void add(const std::string &network_name, const std::string &station_name,
+           const type_real x, const type_real z);
   /**
-   * @brief Locate station within the mesh
+   * @brief Locate every station within the mesh
    *
-   * Given the global cartesian coordinates of a station, locate the spectral
-   * element and xi, gamma value of the station
+   * Stations are located together using specfem::utilities::locate, hence the
+   * number of collectives doesn't depend on the number of stations
    *
+   * @param coord (x, z) for every global quadrature point
    * @param h_ibool Global number for every quadrature point
-   * @param coord (x, z) for every distinct control node
    * @param xigll Quadrature points in x-dimension
    * @param zigll Quadrature points in z-dimension
-   * @param nproc Number of processors in the simulation
    * @param coorg Value of every spectral element control nodes
    * @param knods Global control element number for every control node
-   * @param npgeo Total number of distinct control nodes
-   * @param ispec_type material type for every spectral element
    * @param mpi Pointer to specfem MPI object
+   * @param cache_file Location cache file of this process, see
+   * specfem::location_cache. Stations are always located if empty
+   * @return bool true if the locations were read from the cache
    */
-  void locate(
-      const specfem::kokkos::HostView2d<type_real> coord,
-      const specfem::kokkos::HostMirror3d<int> h_ibool,
-      const specfem::kokkos::HostMirror1d<type_real> xigll,
-      const specfem::kokkos::HostMirror1d<type_real> zigll, const int nproc,
-      const specfem::kokkos::HostView2d<type_real> coorg,
-      const specfem::kokkos::HostView2d<int> knods, const int npgeo,
-      const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
-      const specfem::MPI::MPI *mpi);
+  bool locate(const specfem::kokkos::HostView2d<type_real> coord,
+              const specfem::kokkos::HostElementMirror3d<int> h_ibool,
+              const specfem::kokkos::HostMirror1d<type_real> xigll,
+              const specfem::kokkos::HostMirror1d<type_real> zigll,
+              const specfem::kokkos::HostView2d<type_real> coorg,
+              const specfem::kokkos::HostView2d<int> knods,
+              const specfem::MPI::MPI *mpi,
+              const std::string &cache_file = "");
   /**
-   * @brief Compute the receiver array (lagrangians) for this station
+   * @brief Assign the location of a station found within the mesh
+   *
+   * @param irec Index of the station
+   * @param xi \f$ \xi \f$ value of the station inside the element
+   * @param gamma \f$ \gamma \f$ value of the station inside the element
+   * @param ispec Spectral element, local to islice, containing the station
+   * @param islice MPI slice (rank) where the station is located
+   */
+  void set_location(const int irec, const type_real xi, const type_real gamma,
+                    const int ispec, const int islice);
+  /**
+   * @brief Copy the located stations once for every shot simulated together
+   *
+   * Stations of shot ishot follow the stations of shot ishot - 1. Network
+   * names of shot ishot are prefixed by shot<ishot>_ such that every shot
+   * writes its own seismograms
+   *
+   * @param nshots Number of shots
+   * @return receiver_set Stations of every shot. A copy of this set if
+   * nshots is 1
+   */
+  receiver_set replicate(const int nshots) const;
+  /**
+   * @brief Compute the lagrange interpolants of a station along both
+   * dimensions
+   *
+   * The weight of the quadrature point (iz, ix) is hxir(ix) * hgammar(iz)
    *
+   * @param irec Index of the station
    * @param quadx Quadrature object in x-dimension
    * @param quadz Quadrature object in z-dimension
-   * @param receiver_array view to store the source array
+   * @param hxir view to store the interpolants along x
+   * @param hgammar view to store the interpolants along z
+   * @param arena Arena allocating the temporaries
    */
-  void
-  compute_receiver_array(const specfem::quadrature::quadrature &quadx,
-                         const specfem::quadrature::quadrature &quadz,
-                         specfem::kokkos::HostView3d<type_real> receiver_array);
+  void compute_lagrange_interpolants(
+      const int irec, const specfem::quadrature::quadrature &quadx,
+      const specfem::quadrature::quadrature &quadz,
+      specfem::kokkos::HostView1d<type_real> hxir,
+      specfem::kokkos::HostView1d<type_real> hgammar,
+      specfem::memory::arena &arena) const;
   /**
-   * @brief Check if the station is within the domain
+   * @brief Check if every station is within the domain
+   *
+   * Collective over every process
    *
    * @param xmin minimum x-coordinate on my processor
    * @param xmax maximum x-coordinate on my processor
@@ -80,67 +126,46 @@ public:
    */
   void check_locations(const type_real xmin, const type_real xmax,
                        const type_real zmin, const type_real zmax,
-                       const specfem::MPI::MPI *mpi);
-  /**
-   * @brief Get the MPI slice where this station lies
-   *
-   * @return int MPI slice where this station lies
-   */
-  int get_islice() { return this->islice; };
+                       const specfem::MPI::MPI *mpi) const;
   /**
-   * @brief Get the spectral element where this station lies
+   * @brief Get the sine of angle of the stations
    *
-   * @return int Spectral element where this station lies
+   * @return type_real Sine value of the angle of the stations
    */
-  int get_ispec() { return this->ispec; };
-  /**
-   * @brief Get the sine of angle of this station
-   *
-   * @return type_real Sine value of the angle of this station
-   */
-  type_real get_sine() {
+  type_real get_sine() const {
     return std::sin(Kokkos::Experimental::pi_v<type_real> / 180 * this->angle);
   }
   /**
-   * @brief Get the cosine of angle of this station
+   * @brief Get the cosine of angle of the stations
    *
-   * @return type_real Coine value of the angle of this station
+   * @return type_real Cosine value of the angle of the stations
    */
-  type_real get_cosine() {
+  type_real get_cosine() const {
     return std::cos(Kokkos::Experimental::pi_v<type_real> / 180 * this->angle);
   }
   /**
-   * @brief Get the name of network where this station lies
+   * @brief User output describing a station
    *
-   * @return std::string name of the network where the station lies
+   * @param irec Index of the station
    */
-  std::string get_network_name() { return this->network_name; }
-  /**
-   * @brief Get the name of this station
-   *
-   * @return std::string Name of this station
-   */
-  std::string get_station_name() { return this->station_name; }
+  std::string print(const int irec) const;
 
-  /**
-   * @brief User output
-   *
-   */
-  std::string print() const;
-
-private:
-  type_real xi;    ///< f$ \xi f$ value of source inside element
-  type_real gamma; ///< f$ \gamma f$ value of source inside element
-  type_real x;     ///< x coordinate of source
-  type_real z;     ///< z coordinate of source
-  int ispec;       ///< ispec element number where source is located
-  int islice;      ///< MPI slice (rank) where the source is located
-  specfem::elements::type el_type; ///< type of the element inside which this
-                                   ///< receiver lies
-  type_real angle;                 ///< Angle to rotate components at receivers
-  std::string network_name; ///< Name of the network where this station lies
-  std::string station_name; ///< Name of the station
+  type_real angle; ///< Angle to rotate components at receivers
+  std::vector<std::string> network_names; ///< Name of the network where
+                                          ///< every station lies
+  std::vector<std::string> station_names; ///< Name of every station
+  std::vector<type_real> x;               ///< x coordinate of every station
+  std::vector<type_real> z;               ///< z coordinate of every station
+  std::vector<type_real> xi;    ///< \f$ \xi \f$ value of every station inside
+                                ///< its element
+  std::vector<type_real> gamma; ///< \f$ \gamma \f$ value of every station
+                                ///< inside its element
+  std::vector<int> ispec;  ///< Element, local to islice, containing every
+                           ///< station
+  std::vector<int> islice; ///< MPI slice (rank) where every station is
+                           ///< located
 };
+
 } // namespace receivers
 
 } // namespace specfem
@@ -0,0 +1,107 @@
+#ifndef RECIPROCAL_WRITER_H
+#define RECIPROCAL_WRITER_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/domain.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/quadrature.h"
+#include "../include/receiver.h"
+#include "../include/source.h"
+#include "../include/specfem_mpi.h"
+#include "../include/writer.h"
+#include <string>
+#include <vector>
+
+namespace specfem {
+namespace writer {
+/**
+ * @brief Seismogram writer of reciprocal simulations
+ *
+ * Reciprocal simulations apply an impulsive point force at every station,
+ * one shot for every station and force component, and record the response
+ * at the location of every source. At every recorded sample the response is
+ * contracted with the source array of every source of this process,
+ * computed by compute_source_array (the moment tensor contracted with the
+ * strain Green's function for moment-tensor sources). The seismograms of
+ * every source at every station are synthesized at the end of the run by
+ * convolving the contracted responses with the source time functions.
+ *
+ * Every process writes the seismograms of its sources as ASCII files
+ * <network><station>.S<isource>.BX<X|Z>.sem<d|v|a>, isource being the index
+ * of the source in the source files.
+ */
+class reciprocal : public writer {
+
+public:
+  /**
+   * @brief Construct a new reciprocal writer object
+   *
+   * @param domain Pointer to domain storing the fields of the station forces
+   * @param compute Pointer to specfem::compute::compute struct storing the
+   * global numbering
+   * @param sources Sources of the source files, located within the mesh
+   * @param receivers Stations of the simulation, in the order of the shots
+   * @param stypes Types of seismograms written
+   * @param quadx Quadrature object in x-dimension
+   * @param quadz Quadrature object in z-dimension
+   * @param wave Wave type simulated by the domain
+   * @param nsig_steps Number of recorded samples
+   * @param sample_dt Time interval between recorded samples
+   * @param t0 Starting time of simulation
+   * @param source_t0 Starting time of the seismograms of the sources
+   * @param output_folder Path to output folder where seismograms will be
+   * stored
+   * @param mpi Pointer to MPI object
+   */
+  reciprocal(specfem::Domain::Domain *domain,
+             const specfem::compute::compute *compute,
+             const std::vector<specfem::sources::source *> &sources,
+             const specfem::receivers::receiver_set &receivers,
+             const std::vector<specfem::seismogram::type> &stypes,
+             const specfem::quadrature::quadrature &quadx,
+             const specfem::quadrature::quadrature &quadz,
+             const specfem::wave::type wave, const int nsig_steps,
+             const type_real sample_dt, const type_real t0,
+             const type_real source_t0, const std::string output_folder,
+             specfem::MPI::MPI *mpi);
+  /**
+   * @brief Contract the fields at recorded sample isig_step with the source
+   * arrays
+   *
+   * @param isig_step Index of the recorded sample
+   * @param exec_space Execution space instance updating the fields
+   */
+  void sample(const int isig_step,
+              const specfem::kokkos::DevExecSpace &exec_space) override;
+  /**
+   * @brief Synthesize and write the seismograms of every source
+   *
+   */
+  void write() override;
+
+private:
+  specfem::Domain::Domain *domain; ///< Pointer to domain storing the fields
+  specfem::kokkos::DeviceElementView3d<int> ibool; ///< Global number for every
+                                            ///< quadrature point
+  specfem::receivers::receiver_set receivers; ///< Stations of the simulation
+  std::vector<specfem::seismogram::type> stypes; ///< Written seismogram types
+  specfem::wave::type wave;  ///< Wave type simulated by the domain
+  type_real sample_dt;       ///< Time interval between recorded samples
+  type_real t0;              ///< Starting time of simulation
+  type_real source_t0;       ///< Starting time of the seismograms
+  std::string output_folder; ///< Path to output folder
+  std::vector<int> indices;  ///< Index of the sources of this process in
+                             ///< the source files
+  specfem::compute::sources sources; ///< Source arrays and source time
+                                     ///< functions of the sources of this
+                                     ///< process
+  specfem::kokkos::DeviceView4d<type_real>
+      responses; ///< Responses contracted with the source arrays (sample,
+                 ///< seismogram type, source, shot)
+};
+} // namespace writer
+} // namespace specfem
+
+#endif
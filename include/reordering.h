@@ -0,0 +1,62 @@
+#ifndef REORDERING_H
+#define REORDERING_H
+
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Routines used to reorder spectral elements for cache locality
+ *
+ * Global numbering is assigned in first-touch order of the elements. Hence
+ * reordering elements before numbering also reorders global quadrature points.
+ *
+ */
+namespace reordering {
+
+/**
+ * @brief Order spectral elements along a Morton (Z-order) curve of their
+ * centroids
+ *
+ * @param coorg (x,z) for every spectral element control node
+ * @param knods Global control element number for every control node
+ * @return std::vector<int> Permutation of elements. permutation[inew] is the
+ * original element index placed at position inew
+ */
+std::vector<int>
+morton_order(const specfem::kokkos::HostView2d<type_real> coorg,
+             const specfem::kokkos::HostView2d<int> knods);
+
+/**
+ * @brief Reverse Cuthill-McKee ordering of the element adjacency graph
+ *
+ * Two elements are adjacent if they share a control node
+ *
+ * @param knods Global control element number for every control node
+ * @param npgeo Total number of control nodes
+ * @return std::vector<int> Permutation of elements. permutation[inew] is the
+ * original element index placed at position inew
+ */
+std::vector<int>
+cuthill_mckee_order(const specfem::kokkos::HostView2d<int> knods,
+                    const int npgeo);
+
+/**
+ * @brief Compute element permutation for the chosen reordering
+ *
+ * @param coorg (x,z) for every spectral element control node
+ * @param knods Global control element number for every control node
+ * @param ordering Reordering type
+ * @return std::vector<int> Permutation of elements. permutation[inew] is the
+ * original element index placed at position inew
+ */
+std::vector<int>
+element_permutation(const specfem::kokkos::HostView2d<type_real> coorg,
+                    const specfem::kokkos::HostView2d<int> knods,
+                    const specfem::reordering::type ordering);
+
+} // namespace reordering
+} // namespace specfem
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef SETUP_CACHE_H
+#define SETUP_CACHE_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/material.h"
+#include "../include/quadrature.h"
+#include "../include/specfem_mpi.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Binary cache of the arrays computed from the mesh and the quadrature
+ *
+ * Global numbering, coordinates, partial derivatives and material properties
+ * of every process are stored in a versioned binary file. Runs sharing the
+ * mesh and the quadrature, e.g. runs of an inversion with different sources,
+ * map the file and copy the arrays instead of computing them.
+ *
+ */
+namespace setup_cache {
+
+/**
+ * @brief Compute the key identifying the inputs of the cached arrays
+ *
+ * The key hashes the control nodes, the elements and the materials of the
+ * partitioned and reordered mesh of this process, and the quadrature points
+ * and weights, hence it changes with the database, the partitioning, the
+ * element ordering and the quadrature settings.
+ *
+ * @param coorg (x_a, z_a) for every control node
+ * @param knods Global control element number for every control node
+ * @param kmato Material specification number of every spectral element
+ * @param materials Pointer to material objects read from database file
+ * @param quadx Quadrature object in x dimension
+ * @param quadz Quadrature object in z dimension
+ * @return std::uint64_t Key of the cached arrays
+ */
+std::uint64_t key(const specfem::kokkos::HostView2d<type_real> coorg,
+                  const specfem::kokkos::HostView2d<int> knods,
+                  const specfem::kokkos::HostView1d<int> kmato,
+                  const std::vector<specfem::material *> &materials,
+                  const specfem::quadrature::quadrature &quadx,
+                  const specfem::quadrature::quadrature &quadz);
+
+/**
+ * @brief Get the cache file of this process
+ *
+ * @param directory Directory storing cache files
+ * @param mpi Pointer to MPI object
+ * @return std::string Cache file of this process
+ */
+std::string filename(const std::string &directory,
+                     const specfem::MPI::MPI *mpi);
+
+/**
+ * @brief Load cached arrays
+ *
+ * @param filename Cache file of this process
+ * @param key Key of the arrays, see specfem::setup_cache::key
+ * @param compute Global numbering and coordinates
+ * @param partial_derivatives Partial derivatives and Jacobian
+ * @param properties Material properties
+ * @return bool false if the file doesn't exist, was written by another
+ * version or for another key. Arrays are not modified in this case
+ */
+bool load(const std::string &filename, const std::uint64_t key,
+          specfem::compute::compute &compute,
+          specfem::compute::partial_derivatives &partial_derivatives,
+          specfem::compute::properties &properties);
+
+/**
+ * @brief Store arrays in a cache file
+ *
+ * The file is written under a temporary name and renamed, hence concurrent
+ * runs never load a partially written file.
+ *
+ * @param filename Cache file of this process
+ * @param key Key of the arrays, see specfem::setup_cache::key
+ * @param compute Global numbering and coordinates
+ * @param partial_derivatives Partial derivatives and Jacobian
+ * @param properties Material properties
+ */
+void save(const std::string &filename, const std::uint64_t key,
+          const specfem::compute::compute &compute,
+          const specfem::compute::partial_derivatives &partial_derivatives,
+          const specfem::compute::properties &properties);
+
+} // namespace setup_cache
+} // namespace specfem
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef SHAPE_FUNCTIONS_H
 #define SHAPE_FUNCTIONS_H
 
+#include "../include/config.h"
 #include "../include/kokkos_abstractions.h"
 #include <Kokkos_Core.hpp>
 
@@ -59,6 +60,97 @@ void define_shape_functions(specfem::kokkos::HostView1d<type_real> shape2D,
 void define_shape_functions_derivatives(
     specfem::kokkos::HostView2d<type_real> dershape2D, const double xi,
     const double gamma, const int ngod);
+/**
+ * @brief Maximum number of control nodes per element
+ *
+ */
+constexpr int max_ngnod = 9;
+
+/**
+ * @brief Compute shape functions and their derivatives at a particular point
+ * (xi, gamma)
+ *
+ * Values are stored in arrays of the calling thread, hence the function can
+ * be called within parallel regions.
+ *
+ * @param xi \f$ \xi \f$ value of the point
+ * @param gamma \f$ \gamma \f$ value of the point
+ * @param ngnod Total number of control nodes per element, 4 or 9
+ * @param shape2D Shape functions (updated by this function)
+ * @param dershape2D Derivatives of shape functions (\f$ \partial N/\partial
+ * \xi \f$, \f$ \partial N/\partial \gamma \f$) (updated by this function)
+ */
+KOKKOS_INLINE_FUNCTION void
+define_shape_functions(const type_real xi, const type_real gamma,
+                       const int ngnod, type_real shape2D[max_ngnod],
+                       type_real dershape2D[ndim][max_ngnod]) {
+
+  const type_real sp = xi + 1.0;
+  const type_real sm = xi - 1.0;
+  const type_real tp = gamma + 1.0;
+  const type_real tm = gamma - 1.0;
+
+  if (ngnod == 4) {
+    shape2D[0] = 0.25 * sm * tm;
+    shape2D[1] = -0.25 * sp * tm;
+    shape2D[2] = 0.25 * sp * tp;
+    shape2D[3] = -0.25 * sm * tp;
+
+    dershape2D[0][0] = 0.25 * tm;
+    dershape2D[0][1] = -0.25 * tm;
+    dershape2D[0][2] = 0.25 * tp;
+    dershape2D[0][3] = -0.25 * tp;
+
+    dershape2D[1][0] = 0.25 * sm;
+    dershape2D[1][1] = -0.25 * sp;
+    dershape2D[1][2] = 0.25 * sp;
+    dershape2D[1][3] = -0.25 * sm;
+  } else {
+    const type_real s2 = xi * 2.0;
+    const type_real t2 = gamma * 2.0;
+    const type_real ss = xi * xi;
+    const type_real tt = gamma * gamma;
+    const type_real st = xi * gamma;
+
+    //----  corner nodes
+    shape2D[0] = 0.25 * sm * st * tm;
+    shape2D[1] = 0.25 * sp * st * tm;
+    shape2D[2] = 0.25 * sp * st * tp;
+    shape2D[3] = 0.25 * sm * st * tp;
+
+    dershape2D[0][0] = 0.25 * tm * gamma * (s2 - 1.0);
+    dershape2D[0][1] = 0.25 * tm * gamma * (s2 + 1.0);
+    dershape2D[0][2] = 0.25 * tp * gamma * (s2 + 1.0);
+    dershape2D[0][3] = 0.25 * tp * gamma * (s2 - 1.0);
+
+    dershape2D[1][0] = 0.25 * sm * xi * (t2 - 1.0);
+    dershape2D[1][1] = 0.25 * sp * xi * (t2 - 1.0);
+    dershape2D[1][2] = 0.25 * sp * xi * (t2 + 1.0);
+    dershape2D[1][3] = 0.25 * sm * xi * (t2 + 1.0);
+
+    //----  midside nodes
+    shape2D[4] = 0.5 * tm * gamma * (1.0 - ss);
+    shape2D[5] = 0.5 * sp * xi * (1.0 - tt);
+    shape2D[6] = 0.5 * tp * gamma * (1.0 - ss);
+    shape2D[7] = 0.5 * sm * xi * (1.0 - tt);
+
+    dershape2D[0][4] = -1.0 * st * tm;
+    dershape2D[0][5] = 0.5 * (1.0 - tt) * (s2 + 1.0);
+    dershape2D[0][6] = -1.0 * st * tp;
+    dershape2D[0][7] = 0.5 * (1.0 - tt) * (s2 - 1.0);
+
+    dershape2D[1][4] = 0.5 * (1.0 - ss) * (t2 - 1.0);
+    dershape2D[1][5] = -1.0 * st * sp;
+    dershape2D[1][6] = 0.5 * (1.0 - ss) * (t2 + 1.0);
+    dershape2D[1][7] = -1.0 * st * sm;
+
+    //----  center node
+    shape2D[8] = (1.0 - ss) * (1.0 - tt);
+
+    dershape2D[0][8] = -1.0 * s2 * (1.0 - tt);
+    dershape2D[1][8] = -1.0 * t2 * (1.0 - ss);
+  }
+}
 } // namespace shape_functions
 
 #endif // SHAPE_FUNCTIONS_H
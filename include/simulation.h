@@ -0,0 +1,244 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/domain.h"
+#include "../include/material.h"
+#include "../include/mesh.h"
+#include "../include/mpi_interfaces.h"
+#include "../include/parameter_parser.h"
+#include "../include/quadrature.h"
+#include "../include/receiver.h"
+#include "../include/source.h"
+#include "../include/specfem_mpi.h"
+#include "../include/timescheme.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Simulations kept resident between runs
+ *
+ */
+namespace simulation {
+
+/**
+ * @brief Elastic simulation re-running new sources on a resident mesh
+ *
+ * The mesh, the global numbering, the partial derivatives, the material
+ * properties, the interfaces and the mass matrix are set up once by the
+ * constructor. Every run zeroes the fields, resets the time scheme and
+ * steps the sources set last, hence workflows simulating many sources on the
+ * same mesh only pay for the time loop of every source.
+ *
+ * Only elastic meshes stepped by a single level time scheme are simulated.
+ * Seismograms are kept in memory and written on request, writers of
+ * snapshots, spectra and checkpoints defined by the parameter file aren't
+ * instantiated
+ *
+ */
+class simulation {
+
+public:
+  /**
+   * @brief Set up the simulation defined by a parameter file
+   *
+   * The sources and stations of the parameter file are the sources and
+   * receivers of the first run
+   *
+   * @param parameter_file Path of the parameter file
+   * @param mpi Pointer to MPI object
+   */
+  simulation(const std::string &parameter_file, specfem::MPI::MPI *mpi);
+  /**
+   * @brief Delete the materials and the sources of the simulation
+   *
+   */
+  ~simulation();
+  simulation(const simulation &) = delete;
+  simulation &operator=(const simulation &) = delete;
+  /**
+   * @brief Replace the sources of the next runs
+   *
+   * Sources are located on the resident mesh and their source time
+   * functions are tabulated from the new start time. The simulation owns the
+   * sources, previous sources are deleted
+   *
+   * @param sources Sources of every shot one shot after the other
+   * @param shots Shot of every source. Every source belongs to shot 0 if
+   * empty
+   * @param t0 Start time of the simulation, usually returned by
+   * specfem::read_sources
+   */
+  void set_sources(const std::vector<specfem::sources::source *> &sources,
+                   const std::vector<int> &shots, const type_real t0);
+  /**
+   * @brief Replace the sources of the next runs by the sources of yaml files
+   *
+   * @param sources_files Name of the yml file of every shot. The number of
+   * shots can't change
+   */
+  void set_sources(const std::vector<std::string> &sources_files);
+  /**
+   * @brief Replace the receivers of the next runs
+   *
+   * Every shot records the stations
+   *
+   * @param stations Stations, located on the resident mesh by this call
+   */
+  void set_receivers(const specfem::receivers::receiver_set &stations);
+  /**
+   * @brief Replace the materials of the next runs
+   *
+   * Material properties, the mass matrix and the domain are set up again.
+   * The mesh, the global numbering and the partial derivatives are kept. The
+   * simulation owns the materials, previous materials are deleted
+   *
+   * @param materials Elastic material of every material index of the mesh
+   */
+  void set_materials(const std::vector<specfem::material *> &materials);
+  /**
+   * @brief Get the materials of the next runs
+   *
+   * @return const std::vector<specfem::material *>& Material of every
+   * material index of the mesh
+   */
+  const std::vector<specfem::material *> &get_materials() const {
+    return this->materials;
+  }
+  /**
+   * @brief Simulate the current sources from a medium at rest
+   *
+   */
+  void run();
+  /**
+   * @brief Get the seismograms recorded by the last run
+   *
+   * Seismograms are computed on the device, call sync_seismograms to read
+   * them on the host
+   *
+   * @return specfem::compute::receivers& Receivers of this process
+   */
+  specfem::compute::receivers &get_receivers() {
+    return this->compute_receivers;
+  }
+  /**
+   * @brief Write the seismograms of the last run in the format and the
+   * folder of the parameter file
+   *
+   */
+  void write_seismograms();
+  /**
+   * @brief Write the seismograms of the last run in the format of the
+   * parameter file
+   *
+   * @param output_folder Folder storing the seismograms
+   */
+  void write_seismograms(const std::string &output_folder);
+  /**
+   * @brief Get the elastic domain of the simulation
+   *
+   * @return specfem::Domain::Elastic* Pointer to the domain
+   */
+  specfem::Domain::Elastic *get_domain() const { return this->domain.get(); }
+  /**
+   * @brief Get the number of runs executed
+   *
+   */
+  int get_nruns() const { return this->nruns; }
+  /**
+   * @brief Simulate several sets of sources concurrently from a medium at
+   * rest
+   *
+   * Every set is stepped by its own domain and time scheme, sharing the
+   * resident mesh, geometry and materials read-only. Time loops are launched
+   * by their own host thread on their own execution space instance, hence
+   * small meshes fill the device without duplicating the mesh. Host backends
+   * step the sets one after the other
+   *
+   * @param sources_files Name of the yml file of every shot of every set.
+   * Every set has the number of shots of the parameter file
+   */
+  void run_concurrent(
+      const std::vector<std::vector<std::string> > &sources_files);
+  /**
+   * @brief Get the seismograms recorded by a set of sources of the last
+   * concurrent run
+   *
+   * @param iset Index of the set of sources
+   * @return specfem::compute::receivers& Receivers of this process
+   */
+  specfem::compute::receivers &get_receivers(const int iset) {
+    return this->concurrent.at(iset)->compute_receivers;
+  }
+  /**
+   * @brief Get the number of sets of sources of the last concurrent run
+   *
+   */
+  int get_nconcurrent() const { return this->concurrent.size(); }
+
+private:
+  /**
+   * @brief Locate the stations and build the receivers struct
+   *
+   */
+  void assign_receivers();
+  /**
+   * @brief Compute the material properties of every element
+   *
+   */
+  void assign_materials();
+  /**
+   * @brief Set up the domain and assemble its mass matrix
+   *
+   */
+  void assign_domain();
+
+  /**
+   * @brief Set of sources stepped concurrently with other sets
+   *
+   */
+  struct concurrent_run {
+    std::vector<specfem::sources::source *> sources; ///< Sources of the set
+    specfem::compute::sources compute_sources;       ///< Sources struct
+    specfem::compute::receivers compute_receivers;   ///< Receivers struct
+    std::unique_ptr<specfem::TimeScheme::TimeScheme> it; ///< Time scheme
+    std::unique_ptr<specfem::Domain::Elastic> domain; ///< Domain sharing the
+                                                      ///< resident mesh
+    ~concurrent_run();
+  };
+
+  specfem::MPI::MPI *mpi; ///< Pointer to MPI object
+  std::unique_ptr<specfem::runtime_configuration::setup>
+      setup;                                  ///< Parsed parameter file
+  specfem::quadrature::quadrature gllx;       ///< Quadrature along x
+  specfem::quadrature::quadrature gllz;       ///< Quadrature along z
+  std::vector<specfem::material *> materials; ///< Materials of the mesh
+  specfem::mesh mesh;                         ///< Mesh of this process
+  specfem::compute::compute compute;          ///< Global numbering
+  specfem::compute::partial_derivatives
+      partial_derivatives; ///< Partial derivatives of every element
+  specfem::compute::properties
+      material_properties; ///< Material properties of every element
+  std::unique_ptr<specfem::interfaces::halo>
+      halo;   ///< Interface points shared with neighboring processes
+  int nshots; ///< Number of shots simulated together
+  std::vector<specfem::sources::source *> sources; ///< Sources of the runs
+  type_real t0; ///< Start time of the runs, before sign inversion
+  specfem::receivers::receiver_set stations; ///< Located stations
+  specfem::receivers::receiver_set recorded; ///< Stations of every shot
+  specfem::compute::sources compute_sources; ///< Sources struct
+  specfem::compute::receivers compute_receivers;       ///< Receivers struct
+  std::unique_ptr<specfem::TimeScheme::TimeScheme> it; ///< Time scheme
+  std::unique_ptr<specfem::Domain::Elastic> domain;    ///< Elastic domain
+  int nruns = 0;                                       ///< Executed runs
+  std::vector<std::unique_ptr<concurrent_run> >
+      concurrent; ///< Sets of sources of the last concurrent run
+};
+
+} // namespace simulation
+} // namespace specfem
+
+#endif
@@ -1,8 +1,17 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
+#include "../include/adjoint.h"
+#include "../include/checkpoint.h"
+#include "../include/coupling.h"
 #include "../include/domain.h"
+#include "../include/progress.h"
+#include "../include/spectrum_writer.h"
+#include "../include/timers.h"
 #include "../include/timescheme.h"
+#include "../include/wavefield_writer.h"
+#include "../include/writer.h"
+#include <vector>
 
 namespace specfem {
 namespace solver {
@@ -19,20 +28,244 @@ public:
    *
    */
   virtual void run(){};
+  /**
+   * @brief Set the timers of the phases of the time loop
+   *
+   * @param timers Pointer to the timers. Phases aren't timed if not set
+   */
+  void set_timers(specfem::timers::timers *timers) { this->timers = timers; }
+  /**
+   * @brief Set the progress reporter of the time loop
+   *
+   * @param progress Pointer to the reporter. Progress isn't reported if not
+   * set
+   */
+  void set_progress(specfem::progress::reporter *progress) {
+    this->progress = progress;
+  }
+  /**
+   * @brief Set the execution space instance partitioned by the time loop
+   *
+   * Time loops of independent simulations launched on different instances
+   * run concurrently
+   *
+   * @param exec_space Execution space instance. Defaults to the default
+   * instance
+   */
+  void set_execution_space(const specfem::kokkos::DevExecSpace &exec_space) {
+    this->exec_space = exec_space;
+  }
+
+protected:
+  specfem::kokkos::DevExecSpace exec_space; ///< Execution space instance
+                                            ///< of the time loop
+  specfem::timers::timers *timers =
+      specfem::timers::disabled(); ///< Timers of the phases of the time loop
+  specfem::progress::reporter *progress =
+      specfem::progress::disabled(); ///< Progress reporter of the time loop
 };
 
+/**
+ * @brief Time-marching solver
+ *
+ * Domain and timescheme methods are called through pointers to DomainType
+ * and TimeSchemeType. With the base classes every call is resolved at
+ * runtime. With final implementations calls are resolved at compile time and
+ * can be inlined into the time loop.
+ *
+ * @tparam DomainType Domain class, specfem::Domain::Domain or a class derived
+ * from it
+ * @tparam TimeSchemeType TimeScheme class, specfem::TimeScheme::TimeScheme or
+ * a class derived from it
+ */
+template <typename DomainType = specfem::Domain::Domain,
+          typename TimeSchemeType = specfem::TimeScheme::TimeScheme>
 class time_marching : public solver {
 
 public:
   /**
    * @brief Construct a new time marching solver object
    *
-   * @param domain Pointer to specfem::Domain::Domain class
-   * @param it Pointer to spectem::TimeScheme::TimeScheme class
+   * @param domain Pointer to DomainType class
+   * @param it Pointer to TimeSchemeType class
+   * @param graph_execution If true record the kernels of a timestep inside a
+   * graph once and replay the graph at every timestep
+   * @param writer Pointer to the seismogram writer notified of every
+   * computed sample, e.g. to flush seismograms during the time loop
+   * @param wavefield Pointer to the wavefield writer taking snapshots of the
+   * fields during the time loop
+   * @param checkpoint Pointer to the checkpoint writer. The time loop stops
+   * after the checkpoint written when SIGTERM is received
+   * @param spectrum Pointer to the spectrum writer accumulating Fourier
+   * transforms of the fields and seismograms during the time loop
+   */
+  time_marching(DomainType *domain, TimeSchemeType *it,
+                const bool graph_execution = false,
+                specfem::writer::writer *writer = nullptr,
+                specfem::writer::wavefield *wavefield = nullptr,
+                specfem::checkpoint::checkpoint *checkpoint = nullptr,
+                specfem::writer::spectrum *spectrum = nullptr)
+      : domain(domain), it(it), graph_execution(graph_execution),
+        writer(writer), wavefield(wavefield), checkpoint(checkpoint),
+        spectrum(spectrum){};
+  /**
+   * @brief Run time-marching solver algorithm
+   *
+   */
+  void run() override;
+
+private:
+  DomainType *domain; ///< Pointer to domain class
+  TimeSchemeType *it; ///< Pointer to timescheme class
+  bool graph_execution; ///< If true timesteps are executed by replaying
+                        ///< recorded graphs
+  specfem::writer::writer *writer; ///< Seismogram writer notified of computed
+                                   ///< samples. Can be null
+  specfem::writer::wavefield *wavefield; ///< Wavefield snapshot writer. Can
+                                         ///< be null
+  specfem::checkpoint::checkpoint *checkpoint; ///< Checkpoint writer. Can be
+                                               ///< null
+  specfem::writer::spectrum *spectrum; ///< Spectrum writer. Can be null
+
+  /**
+   * @brief Check if a snapshot of the fields is taken at the end of istep
+   *
+   * Snapshots need the corrected fields, hence the predictor phase of the
+   * next timestep isn't fused with snapshot timesteps
+   *
+   * @param istep Index of the timestep
+   * @return bool true if a snapshot is taken
+   */
+  bool snapshot_step(const int istep) const {
+    return this->wavefield && this->wavefield->snapshot_step(istep);
+  }
+
+  /**
+   * @brief Check if the fields are transformed at the end of istep
+   *
+   * Fourier transforms need the corrected fields, hence the predictor phase
+   * of the next timestep isn't fused with transformed timesteps
+   *
+   * @param istep Index of the timestep
+   * @return bool true if the fields are transformed
+   */
+  bool transform_step(const int istep) const {
+    return this->spectrum && this->spectrum->transform_step(istep);
+  }
+
+  /**
+   * @brief Check if a checkpoint is written at the end of istep
+   *
+   * Checkpoints are written once the time is incremented and before the
+   * predictor phase of the next timestep, hence the predictor phase isn't
+   * fused with checkpoint timesteps. Has to be called once for every timestep
+   *
+   * @param istep Index of the timestep
+   * @return bool true if a checkpoint is written
+   */
+  bool checkpoint_step(const int istep) {
+    return this->checkpoint &&
+           (istep + 1 < this->it->get_max_timestep()) &&
+           this->checkpoint->checkpoint_step(istep);
+  }
+
+  /**
+   * @brief Write the checkpoint of the current position of the time loop
+   *
+   * @param exec_space Execution space instance updating the fields
+   * @return bool true if the time loop has to stop
+   */
+  bool write_checkpoint(const specfem::kokkos::DevExecSpace &exec_space) {
+    this->timers->start(specfem::timers::output, exec_space);
+    this->checkpoint->write(this->it->get_state(), exec_space);
+    this->timers->stop(specfem::timers::output, exec_space);
+    return this->checkpoint->interrupted();
+  }
+
+  /**
+   * @brief Compute the seismogram sample of the current timestep
+   *
+   * @param exec_space Execution space instance computing the sample
+   */
+  void compute_seismogram(const specfem::kokkos::DevExecSpace &exec_space);
+
+  /**
+   * @brief Compute the complete second derivative of field at timeval
+   *
+   * Stiffness interactions are launched on main_space and source interactions
+   * on source_space. With MPI interfaces, the exchange of outer elements is
+   * overlapped with the stiffness interaction of inner elements. Kernels
+   * launched on main_space afterwards read the assembled values
+   *
+   * @param timeval Time at which source interactions are computed
+   * @param main_space Execution space instance ordering field updates
+   * @param source_space Execution space instance used to launch source
+   * kernels
+   */
+  void compute_acceleration(const type_real timeval,
+                            const specfem::kokkos::DevExecSpace &main_space,
+                            const specfem::kokkos::DevExecSpace &source_space);
+
+  /**
+   * @brief Run time-marching solver algorithm by replaying graphs
+   *
+   * Two graphs are recorded. The first one applies a regular timestep fused
+   * with the predictor phase of the next timestep. The second one also
+   * computes seismograms and is replayed when seismograms are sampled. The
+   * last timestep is launched eagerly since it doesn't apply the predictor
+   * phase.
+   */
+  void run_graph();
+
+  /**
+   * @brief Run time-marching solver algorithm for multi-stage timeschemes
+   *
+   * Every stage computes the stiffness and source interactions at the stage
+   * time followed by the stage update of the timescheme
+   */
+  void run_stages();
+
+  /**
+   * @brief Run time-marching solver algorithm with local time stepping
+   *
+   * Every timestep is divided into substeps of the finest level. Every
+   * substep computes the stiffness interaction of the elements required by
+   * the levels ending a step at the end of the substep
+   */
+  void run_lts();
+};
+
+/**
+ * @brief Time-marching solver for meshes of fluid and solid elements
+ *
+ * The acoustic and the elastic domain are updated on their own execution
+ * space instances, hence their stiffness and source kernels run
+ * concurrently. Instances are only fenced at the coupling points of a
+ * timestep: the fluid coupling reads the predicted displacement of the solid
+ * and the solid coupling reads the corrected second derivative of the
+ * potential. Only implemented for single stage timeschemes without local
+ * time stepping or graph execution.
+ */
+class coupled_time_marching : public solver {
+
+public:
+  /**
+   * @brief Construct a new coupled time marching solver object
+   *
+   * @param fluid Pointer to the acoustic domain
+   * @param solid Pointer to the elastic domain
+   * @param coupling Pointer to the fluid-solid coupling of the domains
+   * @param it Pointer to the timescheme updating both domains
+   * @param writer Pointer to the seismogram writer notified of every
+   * computed sample
    */
-  time_marching(specfem::Domain::Domain *domain,
-                specfem::TimeScheme::TimeScheme *it)
-      : domain(domain), it(it){};
+  coupled_time_marching(specfem::Domain::Acoustic *fluid,
+                        specfem::Domain::Elastic *solid,
+                        const specfem::coupling::fluid_solid *coupling,
+                        specfem::TimeScheme::TimeScheme *it,
+                        specfem::writer::writer *writer = nullptr)
+      : fluid(fluid), solid(solid), coupling(coupling), it(it),
+        writer(writer){};
   /**
    * @brief Run time-marching solver algorithm
    *
@@ -40,11 +273,174 @@ public:
   void run() override;
 
 private:
-  specfem::Domain::Domain *domain; ///< Pointer to spefem::Domain::Domain class
-  specfem::TimeScheme::TimeScheme *it; ///< Pointer to
-                                       ///< spectem::TimeScheme::TimeScheme
-                                       ///< class
+  specfem::Domain::Acoustic *fluid; ///< Acoustic domain
+  specfem::Domain::Elastic *solid;  ///< Elastic domain
+  const specfem::coupling::fluid_solid *coupling; ///< Coupling of the domains
+  specfem::TimeScheme::TimeScheme *it; ///< Pointer to timescheme class
+  specfem::writer::writer *writer; ///< Seismogram writer notified of computed
+                                   ///< samples. Can be null
 };
+
+/**
+ * @brief Adjoint time-marching solver computing sensitivity kernels
+ *
+ * The forward domain is stepped from the start of the simulation and the
+ * adjoint domain, whose sources are the residuals at the stations, from the
+ * end of the simulation back to its start. Adjoint steps need the forward
+ * fields at the same time, which are recomputed from checkpoints of the
+ * forward fields stored on the device following the revolve schedule. Both
+ * domains share the Newmark timescheme coefficients. Checkpoints are
+ * optionally stored by a lossy fixed-rate quantizer, the largest error of the
+ * restored fields being reported at the end of the run. Alternatively the
+ * forward fields are stepped backward in time alongside the adjoint fields,
+ * from the last forward state and the absorbing tractions recorded by the
+ * forward time loop, hence without checkpoints. Only implemented for
+ * single shot elastic domains without local time stepping or graph
+ * execution.
+ */
+class adjoint_time_marching : public solver {
+
+public:
+  /**
+   * @brief Construct a new adjoint time marching solver object
+   *
+   * @param forward Pointer to the elastic domain of the forward fields
+   * @param adjoint Pointer to the elastic domain of the adjoint fields
+   * @param it Pointer to the timescheme of the forward domain. The adjoint
+   * domain is updated by a copy of it
+   * @param kernels Pointer to the kernels accumulated at every adjoint step
+   * @param ncheckpoints Number of forward states stored on the device
+   * @param dt Time interval between timesteps
+   * @param compression_bits Bits of every value of the compressed checkpoints.
+   * Checkpoints aren't compressed if 0
+   */
+  adjoint_time_marching(specfem::Domain::Elastic *forward,
+                        specfem::Domain::Elastic *adjoint,
+                        specfem::TimeScheme::Newmark *it,
+                        const specfem::adjoint::kernels *kernels,
+                        const int ncheckpoints, const type_real dt,
+                        const int compression_bits = 0);
+  /**
+   * @brief Construct a new adjoint time marching solver object reconstructing
+   * the forward fields backward in time
+   *
+   * Damping of the forward fields needs to be reversible, i.e. there is no
+   * attenuation and there are no PML layers
+   *
+   * @param forward Pointer to the elastic domain of the forward fields
+   * @param adjoint Pointer to the elastic domain of the adjoint fields
+   * @param it Pointer to the timescheme of the forward domain. The adjoint
+   * domain is updated by a copy of it
+   * @param kernels Pointer to the kernels accumulated at every adjoint step
+   * @param boundaries Pointer to the storage of the absorbing tractions of
+   * the forward domain
+   * @param dt Time interval between timesteps
+   */
+  adjoint_time_marching(specfem::Domain::Elastic *forward,
+                        specfem::Domain::Elastic *adjoint,
+                        specfem::TimeScheme::Newmark *it,
+                        const specfem::adjoint::kernels *kernels,
+                        specfem::adjoint::boundary_storage *boundaries,
+                        const type_real dt);
+  /**
+   * @brief Run adjoint time-marching solver algorithm
+   *
+   */
+  void run() override;
+
+private:
+  specfem::Domain::Elastic *forward; ///< Domain of the forward fields
+  specfem::Domain::Elastic *adjoint; ///< Domain of the adjoint fields
+  specfem::TimeScheme::Newmark *it;  ///< Timescheme of the forward domain
+  specfem::TimeScheme::Newmark adjoint_it; ///< Timescheme of the adjoint
+                                           ///< domain
+  const specfem::adjoint::kernels *kernels; ///< Accumulated kernels
+  type_real dt;                             ///< Time interval between
+                                            ///< timesteps
+  specfem::kokkos::DeviceView4d<type_real> checkpoints; ///< field, field_dot
+                                                        ///< and field_dot_dot
+                                                        ///< of every
+                                                        ///< checkpoint
+  specfem::adjoint::quantizer compressed; ///< Compressed checkpoints, slot
+                                          ///< 3 * icheckpoint + ifield
+  type_real errors[3] = { 0.0, 0.0, 0.0 }; ///< Largest relative error of the
+                                           ///< compressed field, field_dot
+                                           ///< and field_dot_dot
+  std::vector<specfem::TimeScheme::state> states; ///< Position of the time
+                                                  ///< loop of every
+                                                  ///< checkpoint
+  specfem::adjoint::boundary_storage *boundaries =
+      nullptr; ///< Absorbing tractions replayed by the reconstruction. Forward
+               ///< fields are recomputed from checkpoints if null
+
+  /**
+   * @brief Run the forward time loop, then step the forward fields backward
+   * in time alongside the adjoint fields
+   *
+   */
+  void reconstruct();
+
+  /**
+   * @brief Compute a complete timestep of a domain
+   *
+   * The predictor phase isn't fused with the corrector phase, hence the
+   * corrected fields are available once the step is computed
+   *
+   * @param domain Pointer to the domain to update
+   * @param it Pointer to the timescheme of the domain
+   * @param timeval Time at which source interactions are computed
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void step(specfem::Domain::Elastic *domain,
+            specfem::TimeScheme::Newmark *it, const type_real timeval,
+            const specfem::kokkos::DevExecSpace &exec_space);
+
+  /**
+   * @brief Copy the forward fields and position to a checkpoint
+   *
+   * @param icheckpoint Index of the checkpoint
+   * @param exec_space Execution space instance used to copy the fields
+   */
+  void store(const int icheckpoint,
+             const specfem::kokkos::DevExecSpace &exec_space);
+
+  /**
+   * @brief Copy the forward fields and position from a checkpoint
+   *
+   * @param icheckpoint Index of the checkpoint
+   * @param exec_space Execution space instance used to copy the fields
+   */
+  void load(const int icheckpoint,
+            const specfem::kokkos::DevExecSpace &exec_space);
+};
+
+/**
+ * @brief Instantiate a time-marching solver
+ *
+ * Solvers are statically dispatched on the dynamic types of the domain and
+ * timescheme when an instantiation exists for them. Other combinations use
+ * runtime dispatch.
+ *
+ * @param domain Pointer to specfem::Domain::Domain class
+ * @param it Pointer to spectem::TimeScheme::TimeScheme class
+ * @param graph_execution If true record the kernels of a timestep inside a
+ * graph once and replay the graph at every timestep
+ * @param writer Pointer to the seismogram writer notified of every computed
+ * sample
+ * @param wavefield Pointer to the wavefield writer taking snapshots of the
+ * fields
+ * @param checkpoint Pointer to the checkpoint writer
+ * @param spectrum Pointer to the spectrum writer accumulating Fourier
+ * transforms
+ * @return specfem::solver::solver* Pointer to the time-marching solver
+ */
+specfem::solver::solver *instantiate_time_marching(
+    specfem::Domain::Domain *domain, specfem::TimeScheme::TimeScheme *it,
+    const bool graph_execution = false,
+    specfem::writer::writer *writer = nullptr,
+    specfem::writer::wavefield *wavefield = nullptr,
+    specfem::checkpoint::checkpoint *checkpoint = nullptr,
+    specfem::writer::spectrum *spectrum = nullptr);
 } // namespace solver
 } // namespace specfem
 
@@ -1,6 +1,7 @@
 #ifndef SOURCES_H
 #define SOURCES_H
 
+#include "../include/arena.h"
 #include "../include/config.h"
 #include "../include/enums.h"
 #include "../include/kokkos_abstractions.h"
@@ -10,6 +11,8 @@
 #include "../include/utils.h"
 #include "yaml-cpp/yaml.h"
 #include <Kokkos_Core.hpp>
+#include <string>
+#include <vector>
 
 namespace specfem {
 namespace sources {
@@ -45,13 +48,31 @@ public:
    */
   virtual void locate(
       const specfem::kokkos::HostView2d<type_real> coord,
-      const specfem::kokkos::HostMirror3d<int> h_ibool,
+      const specfem::kokkos::HostElementMirror3d<int> h_ibool,
       const specfem::kokkos::HostMirror1d<type_real> xigll,
       const specfem::kokkos::HostMirror1d<type_real> zigll, const int nproc,
       const specfem::kokkos::HostView2d<type_real> coorg,
       const specfem::kokkos::HostView2d<int> knods, const int npgeo,
       const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
       const specfem::MPI::MPI *mpi){};
+  /**
+   * @brief Assign the location of the source found within the mesh
+   *
+   * @param xi \f$ \xi \f$ value of the source inside the element
+   * @param gamma \f$ \gamma \f$ value of the source inside the element
+   * @param ispec Spectral element, local to islice, containing the source
+   * @param islice MPI slice (rank) where the source is located
+   * @param coorg Value of every spectral element control nodes
+   * @param knods Global control element number for every control node
+   * @param ispec_type material type for every spectral element
+   * @param mpi Pointer to specfem MPI object
+   */
+  virtual void set_location(
+      const type_real xi, const type_real gamma, const int ispec,
+      const int islice, const specfem::kokkos::HostView2d<type_real> coorg,
+      const specfem::kokkos::HostView2d<int> knods,
+      const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
+      const specfem::MPI::MPI *mpi){};
   /**
    * @brief Precompute and store lagrangian values used to compute integrals for
    * sources
@@ -59,11 +80,45 @@ public:
    * @param quadx Quadrature object in x-dimension
    * @param quadz Quadrature object in z-dimension
    * @param source_array view to store the source array
+   * @param wave Wave type simulated by the domain
+   * @param arena Arena allocating the temporaries
    */
   virtual void
   compute_source_array(const specfem::quadrature::quadrature &quadx,
                        const specfem::quadrature::quadrature &quadz,
-                       specfem::kokkos::HostView3d<type_real> source_array){};
+                       specfem::kokkos::HostView3d<type_real> source_array,
+                       const specfem::wave::type wave,
+                       specfem::memory::arena &arena){};
+  /**
+   * @brief Check if the source array is the tensor product of lagrange
+   * interpolants along x and z, scaled for every component
+   *
+   * @return bool true if the source is stored using
+   * compute_lagrange_interpolants instead of compute_source_array
+   */
+  virtual bool separable() const { return false; }
+  /**
+   * @brief Precompute the lagrange interpolants and component weights of a
+   * separable source
+   *
+   * The source array at the quadrature point (iz, ix) for component icomp is
+   * components(icomp) * hxis(ix) * hgammas(iz)
+   *
+   * @param quadx Quadrature object in x-dimension
+   * @param quadz Quadrature object in z-dimension
+   * @param hxis view to store the interpolants along x
+   * @param hgammas view to store the interpolants along z
+   * @param components view to store the weight of every component
+   * @param wave Wave type simulated by the domain
+   * @param arena Arena allocating the temporaries
+   */
+  virtual void compute_lagrange_interpolants(
+      const specfem::quadrature::quadrature &quadx,
+      const specfem::quadrature::quadrature &quadz,
+      specfem::kokkos::HostView1d<type_real> hxis,
+      specfem::kokkos::HostView1d<type_real> hgammas,
+      specfem::kokkos::HostView1d<type_real> components,
+      const specfem::wave::type wave, specfem::memory::arena &arena){};
   /**
    * @brief Check if the source is within the domain
    *
@@ -190,13 +245,31 @@ public:
    */
   void locate(
       const specfem::kokkos::HostView2d<type_real> coord,
-      const specfem::kokkos::HostMirror3d<int> h_ibool,
+      const specfem::kokkos::HostElementMirror3d<int> h_ibool,
       const specfem::kokkos::HostMirror1d<type_real> xigll,
       const specfem::kokkos::HostMirror1d<type_real> zigll, const int nproc,
       const specfem::kokkos::HostView2d<type_real> coorg,
       const specfem::kokkos::HostView2d<int> knods, const int npgeo,
       const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
       const specfem::MPI::MPI *mpi) override;
+  /**
+   * @brief Assign the location of the source found within the mesh
+   *
+   * @param xi \f$ \xi \f$ value of the source inside the element
+   * @param gamma \f$ \gamma \f$ value of the source inside the element
+   * @param ispec Spectral element, local to islice, containing the source
+   * @param islice MPI slice (rank) where the source is located
+   * @param coorg Value of every spectral element control nodes
+   * @param knods Global control element number for every control node
+   * @param ispec_type material type for every spectral element
+   * @param mpi Pointer to specfem MPI object
+   */
+  void set_location(
+      const type_real xi, const type_real gamma, const int ispec,
+      const int islice, const specfem::kokkos::HostView2d<type_real> coorg,
+      const specfem::kokkos::HostView2d<int> knods,
+      const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
+      const specfem::MPI::MPI *mpi) override;
   /**
    * @brief Precompute and store lagrangian values used to compute integrals for
    * sources
@@ -204,11 +277,39 @@ public:
    * @param quadx Quadrature object in x-dimension
    * @param quadz Quadrature object in z-dimension
    * @param source_array view to store the source array
+   * @param wave Wave type simulated by the domain
+   * @param arena Arena allocating the temporaries
    */
-  void compute_source_array(
+  void compute_source_array(const specfem::quadrature::quadrature &quadx,
+                            const specfem::quadrature::quadrature &quadz,
+                            specfem::kokkos::HostView3d<type_real> source_array,
+                            const specfem::wave::type wave,
+                            specfem::memory::arena &arena) override;
+  /**
+   * @brief Force sources are separable
+   *
+   * @return bool true
+   */
+  bool separable() const override { return true; }
+  /**
+   * @brief Precompute the lagrange interpolants and component weights of the
+   * source
+   *
+   * @param quadx Quadrature object in x-dimension
+   * @param quadz Quadrature object in z-dimension
+   * @param hxis view to store the interpolants along x
+   * @param hgammas view to store the interpolants along z
+   * @param components view to store the weight of every component
+   * @param wave Wave type simulated by the domain
+   * @param arena Arena allocating the temporaries
+   */
+  void compute_lagrange_interpolants(
       const specfem::quadrature::quadrature &quadx,
       const specfem::quadrature::quadrature &quadz,
-      specfem::kokkos::HostView3d<type_real> source_array) override;
+      specfem::kokkos::HostView1d<type_real> hxis,
+      specfem::kokkos::HostView1d<type_real> hgammas,
+      specfem::kokkos::HostView1d<type_real> components,
+      const specfem::wave::type wave, specfem::memory::arena &arena) override;
   /**
    * @brief Check if the source is within the domain
    *
@@ -356,13 +457,31 @@ public:
    */
   void locate(
       const specfem::kokkos::HostView2d<type_real> coord,
-      const specfem::kokkos::HostMirror3d<int> h_ibool,
+      const specfem::kokkos::HostElementMirror3d<int> h_ibool,
       const specfem::kokkos::HostMirror1d<type_real> xigll,
       const specfem::kokkos::HostMirror1d<type_real> zigll, const int nproc,
       const specfem::kokkos::HostView2d<type_real> coorg,
       const specfem::kokkos::HostView2d<int> knods, const int npgeo,
       const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
       const specfem::MPI::MPI *mpi) override;
+  /**
+   * @brief Assign the location of the source found within the mesh
+   *
+   * @param xi \f$ \xi \f$ value of the source inside the element
+   * @param gamma \f$ \gamma \f$ value of the source inside the element
+   * @param ispec Spectral element, local to islice, containing the source
+   * @param islice MPI slice (rank) where the source is located
+   * @param coorg Value of every spectral element control nodes
+   * @param knods Global control element number for every control node
+   * @param ispec_type material type for every spectral element
+   * @param mpi Pointer to specfem MPI object
+   */
+  void set_location(
+      const type_real xi, const type_real gamma, const int ispec,
+      const int islice, const specfem::kokkos::HostView2d<type_real> coorg,
+      const specfem::kokkos::HostView2d<int> knods,
+      const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
+      const specfem::MPI::MPI *mpi) override;
   /**
    * @brief Precompute and store lagrangian values used to compute integrals for
    * sources
@@ -370,11 +489,14 @@ public:
    * @param quadx Quadrature object in x-dimension
    * @param quadz Quadrature object in z-dimension
    * @param source_array view to store the source array
+   * @param wave Wave type simulated by the domain
+   * @param arena Arena allocating the temporaries
    */
-  void compute_source_array(
-      const specfem::quadrature::quadrature &quadx,
-      const specfem::quadrature::quadrature &quadz,
-      specfem::kokkos::HostView3d<type_real> source_array) override;
+  void compute_source_array(const specfem::quadrature::quadrature &quadx,
+                            const specfem::quadrature::quadrature &quadz,
+                            specfem::kokkos::HostView3d<type_real> source_array,
+                            const specfem::wave::type wave,
+                            specfem::memory::arena &arena) override;
   /**
    * @brief Get the processor on which this source lies
    *
@@ -484,6 +606,36 @@ private:
 std::ostream &operator<<(std::ostream &out,
                          const specfem::sources::source &source);
 
+/**
+ * @brief Locate a batch of sources within the mesh
+ *
+ * Sources are located together using specfem::utilities::locate, hence the
+ * number of collectives doesn't depend on the number of sources
+ *
+ * @param sources Sources to locate
+ * @param coord (x, z) for every global quadrature point
+ * @param h_ibool Global number for every quadrature point
+ * @param xigll Quadrature points in x-dimension
+ * @param zigll Quadrature points in z-dimension
+ * @param coorg Value of every spectral element control nodes
+ * @param knods Global control element number for every control node
+ * @param ispec_type material type for every spectral element
+ * @param mpi Pointer to specfem MPI object
+ * @param cache_file Location cache file of this process, see
+ * specfem::location_cache. Sources are always located if empty
+ * @return bool true if the locations were read from the cache
+ */
+bool locate(
+    const std::vector<specfem::sources::source *> &sources,
+    const specfem::kokkos::HostView2d<type_real> coord,
+    const specfem::kokkos::HostElementMirror3d<int> h_ibool,
+    const specfem::kokkos::HostMirror1d<type_real> xigll,
+    const specfem::kokkos::HostMirror1d<type_real> zigll,
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
+    const specfem::MPI::MPI *mpi, const std::string &cache_file = "");
+
 } // namespace sources
 
 } // namespace specfem
@@ -93,6 +93,60 @@ private:
   bool use_trick_for_better_pressure;
 };
 
+/**
+ * @brief Source time function tabulated by the user
+ *
+ * Samples are stored on the device on a uniform time grid and linearly
+ * interpolated. The function is 0 outside the sampled interval
+ *
+ */
+class Tabulated : public stf {
+
+public:
+  /**
+   * @brief Construct a tabulated source time function object
+   *
+   * @param values Pointer to the samples stored on the device
+   * @param nsamples Number of samples
+   * @param tstart Time of the first sample
+   * @param dt Time between two samples
+   * @param factor factor to scale source time function
+   */
+  KOKKOS_FUNCTION Tabulated(type_real *values, int nsamples, type_real tstart,
+                            type_real dt, type_real factor);
+
+  /**
+   * @brief compute the value of stf at time t
+   *
+   * @param t
+   * @return value of source time function at time t
+   */
+  KOKKOS_FUNCTION type_real compute(type_real t) override;
+  /**
+   * @brief update the time shift value
+   *
+   * @param tshift new tshift value
+   */
+  KOKKOS_FUNCTION void update_tshift(type_real tshift) override {
+    this->tshift = tshift;
+  }
+  /**
+   * @brief Get the t0 value
+   *
+   * @return t0 value
+   */
+  KOKKOS_FUNCTION type_real get_t0() const override { return this->t0; }
+
+private:
+  type_real *values; ///< samples stored on the device
+  int nsamples;      ///< number of samples
+  type_real tstart;  ///< time of the first sample
+  type_real dt;      ///< time between two samples
+  type_real tshift;  ///< value of tshift
+  type_real t0;      ///< t0 value
+  type_real factor;  ///< scaling factor
+};
+
 std::ostream &operator<<(std::ostream &out,
                          const specfem::forcing_function::stf &stf);
 
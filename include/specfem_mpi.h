@@ -1,7 +1,12 @@
 #ifndef SPECFEM_MPI_H
 #define SPECFEM_MPI_H
 
+#include <Kokkos_Core.hpp>
+#include <cstddef>
+#include <functional>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #ifdef MPI_PARALLEL
@@ -27,6 +32,43 @@ enum reduce_type { sum = MPI_SUM, min = MPI_MIN, max = MPI_MAX };
 enum reduce_type { sum, min, max };
 #endif
 
+/**
+ * @brief Handle of a non-blocking collective
+ *
+ * The result of the collective is available in the view passed to the
+ * collective once wait returns. The destructor waits for pending collectives.
+ */
+class request {
+public:
+  /**
+   * @brief Construct a completed request
+   *
+   */
+  request(){};
+  // Host staging buffers are owned by a single request
+  request(const request &) = delete;
+  request &operator=(const request &) = delete;
+  request(request &&other);
+  request &operator=(request &&other);
+  /**
+   * @brief Wait for the collective to complete
+   *
+   */
+  ~request() { this->wait(); }
+  /**
+   * @brief Wait for the collective and copy staged results to the view
+   *
+   */
+  void wait();
+
+private:
+  friend class MPI;
+  std::function<void()> complete; ///< Copy staged results back to the view
+#ifdef MPI_PARALLEL
+  MPI_Request handle = MPI_REQUEST_NULL; ///< MPI request
+#endif
+};
+
 /**
  * @brief MPI class instance to manage MPI communication
  *
@@ -44,6 +86,16 @@ public:
    * @brief Initialize a MPI object
    */
   MPI(int *argc, char ***argv);
+  /**
+   * @brief Split the processes of parent into groups of processes
+   *
+   * Processes of the same color belong to the same group and keep the order
+   * of their ranks in parent. parent outlives the group
+   *
+   * @param parent MPI object containing every process of the groups
+   * @param color Group of this process
+   */
+  MPI(const specfem::MPI::MPI &parent, const int color);
   /**
    * @brief Sync all process. MPI_Barrier
    *
@@ -75,6 +127,33 @@ public:
    * @return int rank of the main proc
    */
   int get_main() const { return 0; }
+  /**
+   * @brief Get the number of processes sharing memory with this process
+   *
+   * @return int Number of processes on this node
+   */
+  int get_node_size() const { return this->node_size; }
+  /**
+   * @brief Get the rank of this process among processes sharing memory
+   *
+   * @return int Rank of this process on this node
+   */
+  int get_node_rank() const { return this->node_rank; }
+#ifdef MPI_PARALLEL
+  /**
+   * @brief Get the communicator containing every process
+   *
+   * @return MPI_Comm MPI communicator
+   */
+  MPI_Comm get_comm() const { return this->comm; }
+  /**
+   * @brief Get the communicator containing processes sharing memory with this
+   * process
+   *
+   * @return MPI_Comm MPI communicator
+   */
+  MPI_Comm get_node_comm() const { return this->node_comm; }
+#endif
   /**
    * @brief MPI_Abort
    *
@@ -144,6 +223,33 @@ public:
    * @return int Reduced value. Should only be reduced on the root=0 process.
    */
   double all_reduce(double lvalue, specfem::MPI::reduce_type reduce_type) const;
+  /**
+   * @brief Element-wise MPI all reduce implementation
+   *
+   * @param lvalues local values to reduce
+   * @param reduce_type specfem reducer type
+   * @return std::vector<int> Reduced values on every process
+   */
+  std::vector<int> all_reduce(const std::vector<int> &lvalues,
+                              specfem::MPI::reduce_type reduce_type) const;
+  /**
+   * @brief Element-wise MPI all reduce implementation
+   *
+   * @param lvalues local values to reduce
+   * @param reduce_type specfem reducer type
+   * @return std::vector<float> Reduced values on every process
+   */
+  std::vector<float> all_reduce(const std::vector<float> &lvalues,
+                                specfem::MPI::reduce_type reduce_type) const;
+  /**
+   * @brief Element-wise MPI all reduce implementation
+   *
+   * @param lvalues local values to reduce
+   * @param reduce_type specfem reducer type
+   * @return std::vector<double> Reduced values on every process
+   */
+  std::vector<double> all_reduce(const std::vector<double> &lvalues,
+                                 specfem::MPI::reduce_type reduce_type) const;
 
   /**
    * @brief Gathers elements from all procs in communicator in a vector on main
@@ -227,11 +333,370 @@ public:
    */
   void bcast(double &val, int root) const;
 
+  /**
+   * @name Collectives over Kokkos views
+   *
+   * Views must be contiguous. Views in memory spaces not accessible from the
+   * host, e.g. CUDA device memory, are staged through host mirrors. A single
+   * collective operates on every value of the view, hence a batch of values
+   * costs the latency of one collective instead of one per value.
+   *
+   */
+  ///@{
+  /**
+   * @brief Element-wise in-place MPI reduce
+   *
+   * @param values Local values to reduce. Contains the reduced values on the
+   * main process
+   * @param reduce_type specfem reducer type
+   */
+  template <typename T, typename... Properties>
+  void reduce(const Kokkos::View<T, Properties...> &values,
+              specfem::MPI::reduce_type reduce_type) const;
+  /**
+   * @brief Element-wise in-place MPI all reduce
+   *
+   * @param values Local values to reduce. Contains the reduced values on
+   * every process
+   * @param reduce_type specfem reducer type
+   */
+  template <typename T, typename... Properties>
+  void all_reduce(const Kokkos::View<T, Properties...> &values,
+                  specfem::MPI::reduce_type reduce_type) const;
+  /**
+   * @brief Start an element-wise in-place non-blocking MPI all reduce
+   *
+   * values must not be accessed until the request completes
+   *
+   * @param values Local values to reduce. Contains the reduced values on
+   * every process once the request completes
+   * @param reduce_type specfem reducer type
+   * @return specfem::MPI::request Handle of the collective
+   */
+  template <typename T, typename... Properties>
+  specfem::MPI::request
+  iall_reduce(const Kokkos::View<T, Properties...> &values,
+              specfem::MPI::reduce_type reduce_type) const;
+  /**
+   * @brief Broadcast values from root proc to the rest
+   *
+   * @param values Values to broadcast
+   * @param root Rank of the process broadcasting values
+   */
+  template <typename T, typename... Properties>
+  void bcast(const Kokkos::View<T, Properties...> &values,
+             const int root = 0) const;
+  /**
+   * @brief Start a non-blocking broadcast of values from root proc to the
+   * rest
+   *
+   * @param values Values to broadcast. values must not be accessed until the
+   * request completes
+   * @param root Rank of the process broadcasting values
+   * @return specfem::MPI::request Handle of the collective
+   */
+  template <typename T, typename... Properties>
+  specfem::MPI::request ibcast(const Kokkos::View<T, Properties...> &values,
+                               const int root = 0) const;
+  /**
+   * @brief Gather a variable number of values from every process on every
+   * process
+   *
+   * @param lvalues Values of this process
+   * @param offsets Values of rank r span [offsets[r], offsets[r + 1]) in the
+   * gathered values. Resized to the number of processes + 1
+   * @return Gathered values of every process, in the memory space of lvalues
+   */
+  template <typename T, typename... Properties>
+  Kokkos::View<typename Kokkos::View<T *, Properties...>::non_const_value_type
+                   *,
+               typename Kokkos::View<T *, Properties...>::memory_space>
+  all_gatherv(const Kokkos::View<T *, Properties...> &lvalues,
+              std::vector<int> &offsets) const;
+  /**
+   * @brief Send a variable number of values from every process to every
+   * process
+   *
+   * @param svalues Values sent by this process
+   * @param send_offsets Values sent to rank r span [send_offsets[r],
+   * send_offsets[r + 1]) in svalues. Size is the number of processes + 1
+   * @param recv_offsets Values received from rank r span [recv_offsets[r],
+   * recv_offsets[r + 1]) in the received values. Resized to the number of
+   * processes + 1
+   * @return Values received from every process, in the memory space of
+   * svalues
+   */
+  template <typename T, typename... Properties>
+  Kokkos::View<typename Kokkos::View<T *, Properties...>::non_const_value_type
+                   *,
+               typename Kokkos::View<T *, Properties...>::memory_space>
+  all_to_allv(const Kokkos::View<T *, Properties...> &svalues,
+              const std::vector<int> &send_offsets,
+              std::vector<int> &recv_offsets) const;
+  ///@}
+
 private:
   int world_size; ///< total number of MPI processes
   int my_rank;    ///< rank of my process
+  int node_size;  ///< number of MPI processes on my node
+  int node_rank;  ///< rank of my process on my node
+  bool owner = true; ///< If true MPI is finalized by this object
+#ifdef MPI_PARALLEL
+  MPI_Comm comm;      ///< MPI communicator
+  MPI_Comm node_comm; ///< MPI communicator of processes on my node
+#endif
+};
+
+namespace impl {
+#ifdef MPI_PARALLEL
+/**
+ * @brief MPI datatype of T
+ *
+ */
+template <typename T> MPI_Datatype datatype() {
+  if (std::is_same<T, int>::value)
+    return MPI_INT;
+  if (std::is_same<T, float>::value)
+    return MPI_FLOAT;
+  if (std::is_same<T, double>::value)
+    return MPI_DOUBLE;
+  if (std::is_same<T, char>::value)
+    return MPI_CHAR;
+  if (std::is_same<T, bool>::value)
+    return MPI_CXX_BOOL;
+  throw std::runtime_error("Unsupported type in MPI collective");
+}
+#endif
+
+/**
+ * @brief Host accessible copy of a contiguous view. Returns the view itself
+ * if it is host accessible
+ *
+ */
+template <typename ViewType> auto stage(const ViewType &view) {
+  if (!view.span_is_contiguous())
+    throw std::runtime_error("MPI collectives require contiguous views");
+  return Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), view);
+}
+
+/**
+ * @brief Copy staged values back to the view
+ *
+ */
+template <typename ViewType, typename HostViewType>
+void unstage(const ViewType &view, const HostViewType &h_view) {
+  if (h_view.data() != view.data())
+    Kokkos::deep_copy(view, h_view);
+}
+} // namespace impl
+
+template <typename T, typename... Properties>
+void specfem::MPI::MPI::reduce(const Kokkos::View<T, Properties...> &values,
+                               specfem::MPI::reduce_type reducer) const {
+#ifdef MPI_PARALLEL
+  using value_type =
+      typename Kokkos::View<T, Properties...>::non_const_value_type;
+  const auto h_values = impl::stage(values);
+  const void *send = this->main_proc() ? MPI_IN_PLACE : h_values.data();
+  MPI_Reduce(send, h_values.data(), h_values.span(),
+             impl::datatype<value_type>(), reducer, this->get_main(),
+             this->comm);
+  impl::unstage(values, h_values);
+#endif
+}
+
+template <typename T, typename... Properties>
+void specfem::MPI::MPI::all_reduce(
+    const Kokkos::View<T, Properties...> &values,
+    specfem::MPI::reduce_type reducer) const {
+#ifdef MPI_PARALLEL
+  using value_type =
+      typename Kokkos::View<T, Properties...>::non_const_value_type;
+  const auto h_values = impl::stage(values);
+  MPI_Allreduce(MPI_IN_PLACE, h_values.data(), h_values.span(),
+                impl::datatype<value_type>(), reducer, this->comm);
+  impl::unstage(values, h_values);
+#endif
+}
+
+template <typename T, typename... Properties>
+specfem::MPI::request specfem::MPI::MPI::iall_reduce(
+    const Kokkos::View<T, Properties...> &values,
+    specfem::MPI::reduce_type reducer) const {
+  specfem::MPI::request request;
+#ifdef MPI_PARALLEL
+  using value_type =
+      typename Kokkos::View<T, Properties...>::non_const_value_type;
+  const auto h_values = impl::stage(values);
+  MPI_Iallreduce(MPI_IN_PLACE, h_values.data(), h_values.span(),
+                 impl::datatype<value_type>(), reducer, this->comm,
+                 &request.handle);
+  request.complete = [values, h_values]() { impl::unstage(values, h_values); };
+#endif
+  return request;
+}
+
+template <typename T, typename... Properties>
+void specfem::MPI::MPI::bcast(const Kokkos::View<T, Properties...> &values,
+                              const int root) const {
+#ifdef MPI_PARALLEL
+  using value_type =
+      typename Kokkos::View<T, Properties...>::non_const_value_type;
+  const auto h_values = impl::stage(values);
+  MPI_Bcast(h_values.data(), h_values.span(), impl::datatype<value_type>(),
+            root, this->comm);
+  impl::unstage(values, h_values);
+#endif
+}
+
+template <typename T, typename... Properties>
+specfem::MPI::request
+specfem::MPI::MPI::ibcast(const Kokkos::View<T, Properties...> &values,
+                          const int root) const {
+  specfem::MPI::request request;
+#ifdef MPI_PARALLEL
+  using value_type =
+      typename Kokkos::View<T, Properties...>::non_const_value_type;
+  const auto h_values = impl::stage(values);
+  MPI_Ibcast(h_values.data(), h_values.span(), impl::datatype<value_type>(),
+             root, this->comm, &request.handle);
+  request.complete = [values, h_values]() { impl::unstage(values, h_values); };
+#endif
+  return request;
+}
+
+template <typename T, typename... Properties>
+Kokkos::View<typename Kokkos::View<T *, Properties...>::non_const_value_type *,
+             typename Kokkos::View<T *, Properties...>::memory_space>
+specfem::MPI::MPI::all_gatherv(const Kokkos::View<T *, Properties...> &lvalues,
+                               std::vector<int> &offsets) const {
+  using value_type =
+      typename Kokkos::View<T *, Properties...>::non_const_value_type;
+  using memory_space = typename Kokkos::View<T *, Properties...>::memory_space;
+
+  const int nlocal = lvalues.extent(0);
+  offsets.assign(this->world_size + 1, 0);
+#ifdef MPI_PARALLEL
+  std::vector<int> counts(this->world_size);
+  MPI_Allgather(&nlocal, 1, MPI_INT, counts.data(), 1, MPI_INT, this->comm);
+  for (int rank = 0; rank < this->world_size; rank++)
+    offsets[rank + 1] = offsets[rank] + counts[rank];
+
+  Kokkos::View<value_type *, memory_space> gvalues("specfem::MPI::all_gatherv",
+                                                   offsets.back());
+  const auto h_lvalues = impl::stage(lvalues);
+  const auto h_gvalues = Kokkos::create_mirror_view(gvalues);
+  MPI_Allgatherv(h_lvalues.data(), nlocal, impl::datatype<value_type>(),
+                 h_gvalues.data(), counts.data(), offsets.data(),
+                 impl::datatype<value_type>(), this->comm);
+  impl::unstage(gvalues, h_gvalues);
+#else
+  offsets[1] = nlocal;
+  Kokkos::View<value_type *, memory_space> gvalues("specfem::MPI::all_gatherv",
+                                                   nlocal);
+  Kokkos::deep_copy(gvalues, lvalues);
+#endif
+  return gvalues;
+}
+
+template <typename T, typename... Properties>
+Kokkos::View<typename Kokkos::View<T *, Properties...>::non_const_value_type *,
+             typename Kokkos::View<T *, Properties...>::memory_space>
+specfem::MPI::MPI::all_to_allv(const Kokkos::View<T *, Properties...> &svalues,
+                               const std::vector<int> &send_offsets,
+                               std::vector<int> &recv_offsets) const {
+  using value_type =
+      typename Kokkos::View<T *, Properties...>::non_const_value_type;
+  using memory_space = typename Kokkos::View<T *, Properties...>::memory_space;
+
+  if (static_cast<int>(send_offsets.size()) != this->world_size + 1 ||
+      send_offsets.back() > static_cast<int>(svalues.extent(0)))
+    throw std::runtime_error("Send offsets don't match the values to send");
+
+  recv_offsets.assign(this->world_size + 1, 0);
 #ifdef MPI_PARALLEL
-  MPI_Comm comm; ///< MPI communicator
+  std::vector<int> send_counts(this->world_size);
+  std::vector<int> recv_counts(this->world_size);
+  for (int rank = 0; rank < this->world_size; rank++)
+    send_counts[rank] = send_offsets[rank + 1] - send_offsets[rank];
+  MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT,
+               this->comm);
+  for (int rank = 0; rank < this->world_size; rank++)
+    recv_offsets[rank + 1] = recv_offsets[rank] + recv_counts[rank];
+
+  Kokkos::View<value_type *, memory_space> rvalues("specfem::MPI::all_to_allv",
+                                                   recv_offsets.back());
+  const auto h_svalues = impl::stage(svalues);
+  const auto h_rvalues = Kokkos::create_mirror_view(rvalues);
+  MPI_Alltoallv(h_svalues.data(), send_counts.data(), send_offsets.data(),
+                impl::datatype<value_type>(), h_rvalues.data(),
+                recv_counts.data(), recv_offsets.data(),
+                impl::datatype<value_type>(), this->comm);
+  impl::unstage(rvalues, h_rvalues);
+#else
+  recv_offsets[1] = send_offsets[1] - send_offsets[0];
+  Kokkos::View<value_type *, memory_space> rvalues("specfem::MPI::all_to_allv",
+                                                   recv_offsets[1]);
+  Kokkos::deep_copy(
+      rvalues, Kokkos::subview(svalues, Kokkos::make_pair(send_offsets[0],
+                                                          send_offsets[1])));
+#endif
+  return rvalues;
+}
+
+/**
+ * @brief Memory shared by every process of a node
+ *
+ * The memory is allocated once per node in an MPI-3 shared memory window and
+ * is written by the first process of the node. Other processes of the node
+ * map the same memory, hence read-only arrays stored in the window are not
+ * duplicated across processes. Without MPI the memory is private.
+ *
+ */
+class shared_window {
+public:
+  /**
+   * @brief Allocate memory shared by every process of a node. Collective over
+   * the processes of the node
+   *
+   * @param bytes Size of the memory in bytes
+   * @param mpi Pointer to MPI object
+   */
+  shared_window(const std::size_t bytes, const specfem::MPI::MPI *mpi);
+  // Views into the window don't own its memory
+  shared_window(const shared_window &) = delete;
+  shared_window &operator=(const shared_window &) = delete;
+  /**
+   * @brief Free the window. Collective over the processes of the node
+   *
+   */
+  ~shared_window();
+  /**
+   * @brief Get the base address of the shared memory
+   *
+   */
+  void *data() const { return this->base; }
+  /**
+   * @brief Check if this process writes the shared memory
+   *
+   * @return bool true on the first process of the node
+   */
+  bool owner() const { return this->is_owner; }
+  /**
+   * @brief Make the writes of the owner visible to every process of the node.
+   * Collective over the processes of the node
+   *
+   */
+  void sync() const;
+
+private:
+  void *base = nullptr; ///< Base address of the shared memory
+  bool is_owner = true; ///< If true this process writes the shared memory
+#ifdef MPI_PARALLEL
+  MPI_Win window;     ///< Shared memory window
+  MPI_Comm node_comm; ///< Communicator of processes sharing the window
+#else
+  std::vector<char> storage; ///< Private memory used without MPI
 #endif
 };
 } // namespace MPI
@@ -0,0 +1,149 @@
+#ifndef SPECTRUM_WRITER_H
+#define SPECTRUM_WRITER_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/domain.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/receiver.h"
+#include "../include/specfem_mpi.h"
+#include "../include/writer.h"
+#include <Kokkos_Complex.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace specfem {
+namespace writer {
+/**
+ * @brief Spectrum writer class accumulating discrete Fourier transforms of
+ * the fields and seismograms during the time loop
+ *
+ * At every sampled timestep the requested fields of a subset of the global
+ * points are multiplied by \f$ e^{-i \omega t} \Delta t \f$ and added to
+ * device resident spectra, for every requested frequency. Seismogram samples
+ * of the receivers of this process are accumulated the same way once they
+ * are computed. Only the spectra are written at the end of the run.
+ *
+ * Every process writes its own files:
+ *  - spectrum_points_<rank>.bin : number of points (int32) followed by the
+ * (x, z) coordinates of every point
+ *  - spectrum_<rank>.bin : number of fields, frequencies, points and
+ * components (int32) followed by the spectra, ordered as (field, frequency,
+ * point, component)
+ *  - spectrum_receivers_<rank>.bin : number of seismogram types, frequencies
+ * and receivers (int32), the index of every receiver in the stations file
+ * (int32), followed by the spectra ordered as (seismogram type, frequency,
+ * receiver, component)
+ *
+ * Spectra are stored as (real, imaginary) pairs of type_real in native byte
+ * order, frequencies in the order of the parameter file.
+ */
+class spectrum : public writer {
+
+public:
+  /**
+   * @brief Construct a new spectrum writer object
+   *
+   * @param domain Pointer to domain storing the fields
+   * @param compute Pointer to specfem::compute::compute struct storing the
+   * global numbering and coordinates
+   * @param receivers Stations read from the stations file
+   * @param compute_receivers Pointer to specfem::compute::receivers struct
+   * storing seismograms. Receiver spectra aren't computed if it's a nullptr
+   * @param fields Fields transformed at every sampled timestep
+   * @param frequencies Frequencies of the spectra in Hz
+   * @param nstep_between_samples Number of timesteps between samples of the
+   * fields
+   * @param stride Stride between transformed GLL points along both dimensions
+   * of every element. Element edges are always transformed
+   * @param dt Time interval between timesteps
+   * @param t0 Starting time of simulation
+   * @param sample_dt Time interval between seismogram samples
+   * @param output_folder Path to output folder where spectra will be stored
+   * @param mpi Pointer to MPI object
+   */
+  spectrum(specfem::Domain::Domain *domain,
+           const specfem::compute::compute *compute,
+           const specfem::receivers::receiver_set &receivers,
+           const specfem::compute::receivers *compute_receivers,
+           const std::vector<specfem::seismogram::type> &fields,
+           const std::vector<type_real> &frequencies,
+           const int nstep_between_samples, const int stride,
+           const type_real dt, const type_real t0, const type_real sample_dt,
+           const std::string output_folder, const specfem::MPI::MPI *mpi);
+  /**
+   * @brief Check if the fields are transformed at the end of timestep istep
+   *
+   * @param istep Index of the timestep
+   * @return bool true if the fields at the end of istep are accumulated
+   */
+  bool transform_step(const int istep) const {
+    return istep % this->nstep_between_samples == 0;
+  }
+  /**
+   * @brief Accumulate the fields at the end of timestep istep
+   *
+   * Fields need to be corrected, and must not be updated by kernels launched
+   * before the call on other execution space instances.
+   *
+   * @param istep Index of the timestep
+   * @param exec_space Execution space instance updating the fields
+   */
+  void transform(const int istep,
+                 const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Accumulate the seismogram sample computed from recorded sample
+   * isig_step
+   *
+   * @param isig_step Index of the recorded sample
+   * @param exec_space Execution space instance computing the sample
+   */
+  void sample(const int isig_step,
+              const specfem::kokkos::DevExecSpace &exec_space) override;
+  /**
+   * @brief Write the spectra
+   *
+   */
+  void write() override;
+
+private:
+  specfem::Domain::Domain *domain; ///< Pointer to domain storing the fields
+  const specfem::compute::receivers *compute_receivers; ///< Pointer to
+                                                        ///< seismograms
+  std::vector<specfem::seismogram::type> fields; ///< Transformed fields
+  int nstep_between_samples; ///< Number of timesteps between samples
+  type_real dt;              ///< Time interval between timesteps
+  type_real t0;              ///< Starting time of simulation
+  type_real sample_dt;       ///< Time interval between seismogram samples
+  std::string output_folder; ///< Path to output folder
+  int rank;                  ///< Rank of this process used in filenames
+  std::vector<std::int32_t> stations; ///< Index of the receivers of this
+                                      ///< process in the stations file
+  specfem::kokkos::DeviceView1d<int> points; ///< Global number of
+                                             ///< transformed points
+  specfem::kokkos::DeviceView1d<double> omega; ///< Angular frequencies
+  specfem::kokkos::DeviceView1d<Kokkos::complex<type_real> >
+      phase; ///< \f$ e^{-i \omega t} \Delta t \f$ of the current sample
+  specfem::kokkos::DeviceView4d<Kokkos::complex<type_real> >
+      field_spectra; ///< Spectra of the fields (field, frequency, point,
+                     ///< component)
+  specfem::kokkos::DeviceView4d<Kokkos::complex<type_real> >
+      receiver_spectra; ///< Spectra of the seismograms (seismogram type,
+                        ///< frequency, receiver, component)
+
+  /**
+   * @brief Compute the phases of a sample at time t
+   *
+   * @param t Time of the sample
+   * @param weight Length of the time interval represented by the sample
+   * @param exec_space Execution space instance used to launch the kernel
+   */
+  void compute_phase(const double t, const type_real weight,
+                     const specfem::kokkos::DevExecSpace &exec_space);
+};
+} // namespace writer
+} // namespace specfem
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef STACEY_H
+#define STACEY_H
+
+#include "../include/boundaries.h"
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/memory_report.h"
+#include "../include/quadrature.h"
+
+namespace specfem {
+namespace boundaries {
+
+/**
+ * @brief Stacey absorbing boundary conditions of a domain
+ *
+ * Absorbing edges of the elements of one medium are flattened into a list of
+ * quadrature points at setup. Every point stores the index of its field
+ * values, the unit normal pointing out of the element and the impedances of
+ * the material weighted by the integration weight and the Jacobian of the
+ * edge. Velocities are damped by a single kernel launched after the
+ * stiffness interaction:
+ *
+ * - P-SV waves: acceleration -= rho_vp * (v . n) n + rho_vs * (v - (v . n) n)
+ * - SH waves: acceleration -= rho_vs * v
+ * - acoustic potential: second derivative -= first derivative / rho_vp
+ *
+ * before the division by the mass matrix.
+ *
+ * Damping is irreversible, hence fields stepped backward in time replay the
+ * tractions recorded by the forward time loop instead.
+ */
+class stacey {
+
+public:
+  /**
+   * @brief Default constructor. There are no absorbing points
+   *
+   */
+  stacey() : npoints(0), ncomponents(1), nshots(1){};
+  /**
+   * @brief Construct the list of absorbing points of a domain
+   *
+   * Host views of the material properties are read, hence this needs to be
+   * called before they are released. Points of every edge span
+   * [ibegin_edge, iend_edge] along the edge
+   *
+   * @param abs_boundary Absorbing edges read from the database
+   * @param compute Pointer to the struct storing the global numbering and
+   * coordinates
+   * @param properties Pointer to the material properties
+   * @param quadx Quadrature object in x dimension
+   * @param quadz Quadrature object in z dimension
+   * @param medium Type of the elements of the domain. Edges of other
+   * elements are skipped
+   * @param wave Wave type simulated by an elastic domain
+   * @param nshots Number of shots stored in the fields
+   * @param global_index Global number (iglob) of every point of the domain
+   * numbering. Points are numbered with the global numbering if empty
+   */
+  stacey(const specfem::boundaries::absorbing_boundary &abs_boundary,
+         const specfem::compute::compute *compute,
+         const specfem::compute::properties *properties,
+         const specfem::quadrature::quadrature *quadx,
+         const specfem::quadrature::quadrature *quadz,
+         const specfem::elements::type medium,
+         const specfem::wave::type wave, const int nshots,
+         const specfem::kokkos::HostMirror1d<int> global_index = {});
+  /**
+   * @brief Damp the velocity of the absorbing points
+   *
+   * @param velocity First derivative of the field of the domain
+   * @param acceleration Second derivative of the field of the domain
+   * @param exec_space Execution space instance used to launch the kernel
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void compute_interaction(
+      const specfem::kokkos::DeviceFieldView2d<type_real> velocity,
+      const specfem::kokkos::DeviceFieldView2d<type_real> acceleration,
+      const specfem::kokkos::DevExecSpace &exec_space,
+      specfem::kokkos::DeviceGraphNode *node) const;
+  /**
+   * @brief Select how compute_interaction updates the acceleration
+   *
+   * @param mode Damp the velocity, record the tractions while damping or
+   * replay recorded tractions
+   * @param traction Traction of every absorbing point (npoints, ncomponents
+   * * nshots) written by record and read by replay. Unused by damp
+   */
+  void set_mode(const specfem::absorbing::type mode,
+                const specfem::kokkos::DeviceView2d<type_real> traction = {}) {
+    this->mode = mode;
+    this->traction = traction;
+  }
+  /**
+   * @brief Number of absorbing quadrature points
+   *
+   * @return int Number of points, points shared by two edges are counted
+   * once for every edge
+   */
+  int get_npoints() const { return this->npoints; }
+  /**
+   * @brief Get the index in the fields of every absorbing point
+   *
+   */
+  specfem::kokkos::DeviceView1d<int> get_index() const { return this->index; }
+  /**
+   * @brief Get the unit outward normal of every absorbing point (npoints, 2)
+   *
+   */
+  specfem::kokkos::DeviceView2d<type_real> get_normal() const {
+    return this->normal;
+  }
+  /**
+   * @brief Get the weighted impedances of every absorbing point (npoints, 2)
+   *
+   */
+  specfem::kokkos::DeviceView2d<type_real> get_impedance() const {
+    return this->impedance;
+  }
+  /**
+   * @brief Get the integration weight times the Jacobian of the edge of
+   * every absorbing point
+   *
+   */
+  specfem::kokkos::DeviceView1d<type_real> get_weight() const {
+    return this->weight;
+  }
+  /**
+   * @brief Memory used by the views of the absorbing points
+   *
+   * @return specfem::memory::usage Bytes allocated on the device and the host
+   */
+  specfem::memory::usage memory_usage() const;
+
+private:
+  int npoints;     ///< Number of absorbing points
+  int ncomponents; ///< Number of field components of every shot
+  int nshots;      ///< Number of shots stored in the fields
+  specfem::absorbing::type mode = specfem::absorbing::damp; ///< Update of
+                                                            ///< the
+                                                            ///< acceleration
+  specfem::kokkos::DeviceView2d<type_real> traction; ///< Recorded or replayed
+                                                     ///< tractions
+  specfem::kokkos::DeviceView1d<int> index; ///< Index in the fields of every
+                                            ///< absorbing point
+  specfem::kokkos::DeviceView2d<type_real> normal; ///< Unit outward normal of
+                                                   ///< every absorbing point
+  specfem::kokkos::DeviceView2d<type_real>
+      impedance; ///< Weighted impedances of every absorbing point
+                 ///< (npoints, 2). rho_vp and rho_vs for P-SV waves, rho_vs
+                 ///< for SH waves and 1 / rho_vp for acoustic potentials
+  specfem::kokkos::DeviceView1d<type_real> weight; ///< Integration weight
+                                                   ///< times the Jacobian of
+                                                   ///< the edge of every
+                                                   ///< absorbing point
+};
+
+} // namespace boundaries
+} // namespace specfem
+
+#endif
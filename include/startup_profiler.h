@@ -0,0 +1,152 @@
+#ifndef STARTUP_PROFILER_H
+#define STARTUP_PROFILER_H
+
+#include "../include/memory_report.h"
+#include "../include/specfem_mpi.h"
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Breakdown of the setup of a run into stages
+ *
+ */
+namespace startup {
+
+/**
+ * @brief Time, input bytes and allocations of the setup stages of a run
+ *
+ * Stages run one after the other. The bytes allocated by a stage are the
+ * bytes of the Kokkos views allocated while it runs, read from the tracked
+ * allocations (see specfem::memory::track_allocations). The bytes read by a
+ * stage are the sizes of the input files it reads
+ *
+ */
+class profiler {
+
+public:
+  /**
+   * @brief Construct a new profiler object
+   *
+   * @param enabled If false starting and stopping stages does nothing
+   */
+  profiler(const bool enabled = true) : enabled(enabled){};
+  /**
+   * @brief Start a stage
+   *
+   * @param name Name of the stage. Stages with the same name are accumulated
+   */
+  void start(const std::string &name);
+  /**
+   * @brief Stop the running stage
+   *
+   */
+  void stop();
+  /**
+   * @brief Add the size of an input file to the bytes read by the running
+   * stage
+   *
+   * @param filename Path of the file. Missing files are ignored
+   */
+  void add_read(const std::string &filename);
+  /**
+   * @brief Describe the size of the problem set up in the JSON dump
+   *
+   * @param name Name of the size, e.g. nspec
+   * @param value Value of the size
+   */
+  void add_size(const std::string &name, const double value);
+  /**
+   * @brief Check if the profiler records stages
+   *
+   * @return bool true if the profiler is enabled
+   */
+  bool is_enabled() const { return this->enabled; }
+  /**
+   * @brief Get the number of recorded stages
+   *
+   * @return int Number of stages
+   */
+  int get_nstages() const { return this->stages.size(); }
+  /**
+   * @brief Get the accumulated time of a stage
+   *
+   * @param istage Index of the stage, in the order stages first started
+   * @return double Time in seconds
+   */
+  double get_seconds(const int istage) const {
+    return this->stages[istage].seconds;
+  }
+  /**
+   * @brief Get the bytes read by a stage
+   *
+   * @param istage Index of the stage
+   * @return double Bytes read
+   */
+  double get_bytes_read(const int istage) const {
+    return this->stages[istage].bytes_read;
+  }
+  /**
+   * @brief Get the bytes allocated by a stage
+   *
+   * @param istage Index of the stage
+   * @return specfem::memory::usage Bytes allocated in device and host memory
+   */
+  specfem::memory::usage get_allocated(const int istage) const {
+    return this->stages[istage].allocated;
+  }
+  /**
+   * @brief Startup report
+   *
+   * Collective: prints the largest time, the total bytes read and the
+   * largest allocations of every stage across processes
+   *
+   * @param mpi Pointer to MPI object
+   * @return std::string Report of every stage. Only complete on the root
+   * process, empty if the profiler is disabled
+   */
+  std::string print(const specfem::MPI::MPI *mpi) const;
+  /**
+   * @brief Write the startup report as a JSON file
+   *
+   * Collective: the file is written by the root process. Stages report the
+   * mean and largest time, the total bytes read and the largest allocations
+   * across processes
+   *
+   * @param filename Path of the JSON file
+   * @param mpi Pointer to MPI object
+   */
+  void write(const std::string &filename, const specfem::MPI::MPI *mpi) const;
+
+private:
+  struct stage {
+    std::string name;                 ///< Name of the stage
+    double seconds = 0.0;             ///< Accumulated time
+    double bytes_read = 0.0;          ///< Bytes of the input files read
+    specfem::memory::usage allocated; ///< Bytes of the views allocated
+  };
+
+  /**
+   * @brief Reduce the stages across processes
+   *
+   * @return std::vector<double> Mean time, largest time, total bytes read and
+   * largest device and host allocations of every stage
+   */
+  std::vector<double> reduce(const specfem::MPI::MPI *mpi) const;
+
+  bool enabled = true;       ///< If false stages aren't recorded
+  std::vector<stage> stages; ///< Recorded stages
+  int running = -1;          ///< Index of the running stage, -1 if none
+  std::chrono::steady_clock::time_point begin; ///< Start of the running
+                                               ///< stage
+  specfem::memory::usage allocated; ///< Tracked allocations at the start of
+                                    ///< the running stage
+  std::vector<std::pair<std::string, double> > sizes; ///< Problem sizes
+};
+
+} // namespace startup
+} // namespace specfem
+
+#endif
@@ -20,10 +20,34 @@ struct acoustic_free_surface {
 
   acoustic_free_surface(){};
   acoustic_free_surface(const int nelem_acoustic_surface);
-  acoustic_free_surface(std::ifstream &stream, const int nelem_acoustic_surface,
+  acoustic_free_surface(std::istream &stream, const int nelem_acoustic_surface,
                         const specfem::MPI::MPI *mpi);
 };
 
+/**
+ * @brief Edges shared by an acoustic and an elastic spectral element
+ *
+ */
+struct fluid_solid_edges {
+  specfem::kokkos::HostView1d<int> ispec_acoustic; ///< Acoustic element of
+                                                   ///< every edge (0-based)
+  specfem::kokkos::HostView1d<int> ispec_elastic;  ///< Elastic element of
+                                                   ///< every edge (0-based)
+
+  fluid_solid_edges(){};
+  /**
+   * @brief Allocate the elements of nedges edges
+   *
+   * @param nedges Number of fluid-solid edges
+   */
+  fluid_solid_edges(const int nedges);
+  /**
+   * @brief Number of fluid-solid edges
+   *
+   */
+  int nedges() const { return this->ispec_acoustic.extent(0); }
+};
+
 } // namespace surfaces
 } // namespace specfem
 
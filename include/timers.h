@@ -0,0 +1,231 @@
+#ifndef TIMERS_H
+#define TIMERS_H
+
+#include "../include/kokkos_abstractions.h"
+#include "../include/specfem_mpi.h"
+#include "../include/trace.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Wall clock timers of the setup and time loop phases of a run
+ *
+ */
+namespace timers {
+
+/**
+ * @brief Phases of the time loop registered by every timers object
+ *
+ */
+enum phase {
+  predictor,   ///< Predictor phase of the timescheme
+  stiffness,   ///< Stiffness interaction
+  sources,     ///< Source interaction
+  interfaces,  ///< Assembly of the points shared with other processes,
+               ///< including the time spent waiting for messages
+  corrector,   ///< Mass matrix division and corrector phase
+  seismograms, ///< Seismograms
+  output       ///< Wavefield snapshots, spectra and checkpoints
+};
+
+/**
+ * @brief Analytic cost of the kernels of a phase
+ *
+ * Bytes count every view read or written once by the kernels, flops count
+ * the additions and multiplications of their reference algorithm
+ *
+ */
+struct cost {
+  double bytes = 0.0; ///< Bytes moved to or from memory
+  double flops = 0.0; ///< Floating point operations
+};
+
+/**
+ * @brief Accumulated wall clock time of named phases
+ *
+ * Kernels are launched asynchronously, hence by default a phase measures the
+ * time spent by the host launching its kernels and waiting for the fences
+ * inside it. In accurate mode the execution space of a phase is fenced when
+ * the phase starts and stops, which measures the time of its kernels at the
+ * cost of serializing the phases. Disabled timers don't read the clock.
+ *
+ * Phases accumulating the analytic cost of their kernels also report their
+ * achieved bandwidth and flop rate, relative to the peak of the machine if
+ * it is set. Running phases are Kokkos profiling regions, hence Kokkos Tools
+ * connectors, e.g. to read hardware counters, see every phase. Stopped
+ * phases are also recorded as events of the trace of the timers.
+ *
+ */
+class timers {
+
+public:
+  /**
+   * @brief Construct a new timers object
+   *
+   * @param enabled If false starting and stopping phases does nothing
+   * @param accurate If true fence the execution space of a phase when it
+   * starts and stops
+   */
+  timers(const bool enabled = true, const bool accurate = false);
+  /**
+   * @brief Register a phase
+   *
+   * @param name Name of the phase
+   * @return int Index of the phase. Phases with the same name share an index
+   */
+  int add(const std::string &name);
+  /**
+   * @brief Start a phase of host work, fencing every execution space in
+   * accurate mode
+   *
+   * @param iphase Index of the phase
+   */
+  void start(const int iphase);
+  /**
+   * @brief Start a phase
+   *
+   * @param iphase Index of the phase
+   * @param exec_space Execution space fenced in accurate mode
+   */
+  void start(const int iphase,
+             const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Stop a phase of host work, fencing every execution space in
+   * accurate mode
+   *
+   * @param iphase Index of the phase
+   */
+  void stop(const int iphase);
+  /**
+   * @brief Stop a phase and add its duration to the phase
+   *
+   * @param iphase Index of the phase
+   * @param exec_space Execution space fenced in accurate mode
+   */
+  void stop(const int iphase, const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Add the analytic cost of kernels run by a phase
+   *
+   * @param iphase Index of the phase
+   * @param cost Cost of the kernels
+   */
+  void add_cost(const int iphase, const specfem::timers::cost &cost) {
+    if (!this->enabled)
+      return;
+    this->phases[iphase].work.bytes += cost.bytes;
+    this->phases[iphase].work.flops += cost.flops;
+  }
+  /**
+   * @brief Set the peak of the machine achieved rates are compared to
+   *
+   * @param bandwidth Peak bandwidth in GB/s, not compared if 0
+   * @param flops Peak flop rate in GFLOP/s, not compared if 0
+   */
+  void set_peak(const double bandwidth, const double flops) {
+    this->peak_bandwidth = bandwidth;
+    this->peak_flops = flops;
+  }
+  /**
+   * @brief Set the trace recording the timed phases
+   *
+   * @param trace Pointer to the trace. Phases aren't traced if not set
+   */
+  void set_trace(specfem::trace::recorder *trace) { this->trace = trace; }
+  /**
+   * @brief Set the step executed by the time loop, used to select traced
+   * phases
+   *
+   * @param istep Step, -1 outside of the time loop
+   */
+  void set_step(const int istep) { this->trace->set_step(istep); }
+  /**
+   * @brief Check if the timers read the clock
+   *
+   * @return bool true if the timers are enabled
+   */
+  bool is_enabled() const { return this->enabled; }
+  /**
+   * @brief Get the number of registered phases
+   *
+   * @return int Number of phases
+   */
+  int get_nphases() const { return this->phases.size(); }
+  /**
+   * @brief Get the name of a phase
+   *
+   * @param iphase Index of the phase
+   * @return std::string Name of the phase
+   */
+  std::string get_name(const int iphase) const {
+    return this->phases[iphase].name;
+  }
+  /**
+   * @brief Get the accumulated time of a phase
+   *
+   * @param iphase Index of the phase
+   * @return double Time in seconds
+   */
+  double get_seconds(const int iphase) const {
+    return this->phases[iphase].seconds;
+  }
+  /**
+   * @brief Get the number of times a phase was stopped
+   *
+   * @param iphase Index of the phase
+   * @return int Number of calls
+   */
+  int get_calls(const int iphase) const { return this->phases[iphase].calls; }
+  /**
+   * @brief Get the analytic cost accumulated by a phase
+   *
+   * @param iphase Index of the phase
+   * @return specfem::timers::cost Accumulated cost
+   */
+  specfem::timers::cost get_cost(const int iphase) const {
+    return this->phases[iphase].work;
+  }
+  /**
+   * @brief Performance summary of the phases
+   *
+   * Prints the mean, smallest and largest time of every phase across
+   * processes, and the mean achieved bandwidth and flop rate of phases with
+   * an analytic cost. Phases which were never stopped on any process are
+   * skipped. Every process needs to call this function with the same phases.
+   *
+   * @param mpi Pointer to MPI object
+   * @return std::string Summary table
+   */
+  std::string print(const specfem::MPI::MPI *mpi) const;
+
+private:
+  struct entry {
+    std::string name;           ///< Name of the phase
+    double seconds = 0.0;       ///< Accumulated time
+    int calls = 0;              ///< Number of times the phase was stopped
+    specfem::timers::cost work; ///< Accumulated cost of the kernels
+    std::chrono::steady_clock::time_point begin; ///< Start of the running
+                                                 ///< phase
+  };
+
+  bool enabled = true;         ///< If false phases aren't timed
+  bool accurate = false;       ///< If true execution spaces are fenced
+  std::vector<entry> phases;   ///< Registered phases
+  double peak_bandwidth = 0.0; ///< Peak bandwidth of the machine in GB/s
+  double peak_flops = 0.0;     ///< Peak flop rate of the machine in GFLOP/s
+  specfem::trace::recorder *trace =
+      specfem::trace::disabled(); ///< Trace recording the timed phases
+};
+
+/**
+ * @brief Disabled timers used by solvers without timers
+ *
+ * @return specfem::timers::timers* Pointer to disabled timers
+ */
+specfem::timers::timers *disabled();
+
+} // namespace timers
+} // namespace specfem
+
+#endif
@@ -4,9 +4,21 @@
 #include "../include/config.h"
 #include "../include/domain.h"
 #include <ostream>
+#include <stdexcept>
+#include <vector>
 
 namespace specfem {
 namespace TimeScheme {
+/**
+ * @brief Position of the time loop between two timesteps
+ *
+ */
+struct state {
+  int istep = 0;             ///< Next timestep to compute
+  int isig_step = 0;         ///< Next seismogram step
+  double current_time = 0.0; ///< Simulation time at the start of istep
+};
+
 /**
  * @brief Base time scheme class.
  *
@@ -39,10 +51,17 @@ public:
    */
   virtual int get_timestep() const { return 0; }
   /**
-   * @brief reset current time to t0 and timestep to 0
+   * @brief reset current time to t0, timestep and seismogram step to 0
    *
    */
   virtual void reset_time(){};
+  /**
+   * @brief Update the simulation start time, e.g. for new sources. The
+   * current time is updated by reset_time
+   *
+   * @param t0 Simulation start time
+   */
+  virtual void update_t0(const type_real t0){};
   /**
    * @brief Get the max timestep (nstep) of the simuation
    *
@@ -53,17 +72,212 @@ public:
    * @brief Apply predictor phase of the timescheme
    *
    * @param domain_class Pointer to domain class to apply predictor phase
+   * @param exec_space Execution space instance used to launch kernels
    */
   virtual void
-  apply_predictor_phase(const specfem::Domain::Domain *domain_class){};
+  apply_predictor_phase(const specfem::Domain::Domain *domain_class,
+                        const specfem::kokkos::DevExecSpace &exec_space =
+                            specfem::kokkos::DevExecSpace()){};
   /**
    * @brief Apply corrector phase of the timescheme
    *
    * @param domain_class Pointer to domain class to apply corrector phase
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void
+  apply_corrector_phase(const specfem::Domain::Domain *domain_class,
+                        const specfem::kokkos::DevExecSpace &exec_space =
+                            specfem::kokkos::DevExecSpace()){};
+  /**
+   * @brief Divide the acceleration by the mass matrix and apply corrector
+   * phase of the timescheme in a single pass over global arrays. Optionally
+   * also apply the predictor phase of the next timestep in the same pass
+   *
+   * @param domain_class Pointer to domain class to update
+   * @param apply_predictor if true apply predictor phase of the next
+   * timestep. Acceleration at the current step is not available after the
+   * update
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void
+  apply_fused_corrector_phase(const specfem::Domain::Domain *domain_class,
+                              const bool apply_predictor,
+                              const specfem::kokkos::DevExecSpace &exec_space =
+                                  specfem::kokkos::DevExecSpace()) {
+    throw std::runtime_error(
+        "Time scheme wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Record predictor phase of the timescheme inside a graph
+   *
+   * @param domain_class Pointer to domain class to apply predictor phase
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  virtual void
+  apply_predictor_phase(const specfem::Domain::Domain *domain_class,
+                        specfem::kokkos::DeviceGraphNode &node) {
+    throw std::runtime_error(
+        "Time scheme wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Record fused mass matrix division and corrector phase of the
+   * timescheme inside a graph
+   *
+   * @param domain_class Pointer to domain class to update
+   * @param apply_predictor if true apply predictor phase of the next
+   * timestep
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  virtual void
+  apply_fused_corrector_phase(const specfem::Domain::Domain *domain_class,
+                              const bool apply_predictor,
+                              specfem::kokkos::DeviceGraphNode &node) {
+    throw std::runtime_error(
+        "Time scheme wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Get the analytic cost of one call of the kernels of a time loop
+   * phase
+   *
+   * @param phase Time loop phase: predictor or corrector (fused mass matrix
+   * division and corrector)
+   * @param domain_class Pointer to domain class updated by the kernels
+   * @param apply_predictor if true the fused corrector phase also applies the
+   * predictor phase of the next timestep
+   * @return specfem::timers::cost Bytes and flops of the kernels. Zero for
+   * phases without a cost model
+   */
+  virtual specfem::timers::cost
+  get_cost(const specfem::timers::phase phase,
+           const specfem::Domain::Domain *domain_class,
+           const bool apply_predictor = false) const {
+    return {};
+  }
+
+  /**
+   * @brief Get the number of stages of the timescheme
+   *
+   * Single stage timeschemes use the predictor/corrector protocol. Multi-stage
+   * timeschemes compute the acceleration at every stage and update the fields
+   * using apply_stage_update
+   *
+   * @return int Number of stages per timestep
+   */
+  virtual int get_nstages() const { return 1; }
+  /**
+   * @brief Get the simulation time at which sources are evaluated for a stage
+   *
+   * @param istage Stage index
+   * @return type_real Simulation time of stage istage
+   */
+  virtual type_real get_stage_time(const int istage) const {
+    return this->get_time();
+  }
+  /**
+   * @brief Divide the acceleration by the mass matrix and update the fields
+   * for a stage of a multi-stage timescheme
+   *
+   * @param domain_class Pointer to domain class to update
+   * @param istage Stage index
+   * @param exec_space Execution space instance used to launch kernels
    */
   virtual void
-  apply_corrector_phase(const specfem::Domain::Domain *domain_class){};
+  apply_stage_update(const specfem::Domain::Domain *domain_class,
+                     const int istage,
+                     const specfem::kokkos::DevExecSpace &exec_space =
+                         specfem::kokkos::DevExecSpace()) {
+    throw std::runtime_error(
+        "Time scheme wasn't initialized properly. Base class being called");
+  };
 
+  /**
+   * @brief Get the number of local time stepping levels
+   *
+   * Level ilevel is stepped with dt / 2^ilevel. Timeschemes with a single
+   * level step every global point with dt
+   *
+   * @return int Number of levels
+   */
+  virtual int get_nlevels() const { return 1; }
+  /**
+   * @brief Assign local time stepping levels to spectral elements and order
+   * the elements of the domain by level
+   *
+   * @param domain_class Pointer to domain class to step
+   * @param ibool Global number for every quadrature point
+   * @param element_levels Level of every spectral element
+   */
+  virtual void
+  set_element_levels(specfem::Domain::Domain *domain_class,
+                     const specfem::kokkos::HostElementMirror3d<int> ibool,
+                     const std::vector<int> &element_levels) {
+    throw std::runtime_error(
+        "Local time stepping is not implemented for this time scheme");
+  };
+  /**
+   * @brief Get the coarsest level whose step ends at the end of a substep
+   *
+   * A timestep is divided into 2^(nlevels - 1) substeps of the finest level
+   *
+   * @param isubstep Substep index
+   * @return int Coarsest level updated by isubstep
+   */
+  virtual int get_substep_level(const int isubstep) const { return 0; }
+  /**
+   * @brief Get the simulation time at which sources are evaluated for the
+   * points of a level ending a step at a substep
+   *
+   * @param isubstep Substep index
+   * @param ilevel Level ending a step at isubstep
+   * @return type_real Simulation time at the start of the step of ilevel
+   */
+  virtual type_real get_level_time(const int isubstep,
+                                   const int ilevel) const {
+    return this->get_time();
+  }
+  /**
+   * @brief Get the level of every global point
+   *
+   * @return specfem::kokkos::DeviceView1d<int> Level of every global point,
+   * empty for timeschemes with a single level
+   */
+  virtual specfem::kokkos::DeviceView1d<int> get_point_level() const {
+    return specfem::kokkos::DeviceView1d<int>();
+  }
+  /**
+   * @brief Apply predictor phase to levels starting a step at a substep and
+   * reset the acceleration of levels ending a step at the substep
+   *
+   * @param domain_class Pointer to domain class to apply predictor phase
+   * @param isubstep Substep index
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void
+  apply_level_predictor_phase(const specfem::Domain::Domain *domain_class,
+                              const int isubstep,
+                              const specfem::kokkos::DevExecSpace &exec_space =
+                                  specfem::kokkos::DevExecSpace()) {
+    throw std::runtime_error(
+        "Time scheme wasn't initialized properly. Base class being called");
+  };
+  /**
+   * @brief Divide the acceleration by the mass matrix and apply corrector
+   * phase to levels ending a step at a substep
+   *
+   * @param domain_class Pointer to domain class to apply corrector phase
+   * @param isubstep Substep index
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  virtual void
+  apply_level_corrector_phase(const specfem::Domain::Domain *domain_class,
+                              const int isubstep,
+                              const specfem::kokkos::DevExecSpace &exec_space =
+                                  specfem::kokkos::DevExecSpace()) {
+    throw std::runtime_error(
+        "Time scheme wasn't initialized properly. Base class being called");
+  };
   friend std::ostream &operator<<(std::ostream &out, TimeScheme &ts);
   /**
    * @brief Log timescheme information to console
@@ -91,6 +305,18 @@ public:
    *
    */
   virtual void increment_seismogram_step(){};
+  /**
+   * @brief Get the position of the time loop, e.g. to write a checkpoint
+   *
+   * @return specfem::TimeScheme::state Position of the time loop
+   */
+  virtual specfem::TimeScheme::state get_state() const { return {}; }
+  /**
+   * @brief Resume the time loop at a position returned by get_state
+   *
+   * @param state Position of the time loop
+   */
+  virtual void set_state(const specfem::TimeScheme::state &state){};
 };
 
 /**
@@ -115,50 +341,113 @@ public:
    * @return false if current step >= number of steps
    * @return true if current step < number of steps
    */
-  bool status() const override { return (this->istep < this->nstep); }
+  bool status() const final { return (this->istep < this->nstep); }
   /**
    * @brief increment by one timestep, also updates the simulation time by dt
    *
    */
-  void increment_time() override;
+  void increment_time() final;
   /**
    * @brief Get the current simulation time
    *
    * @return type_real current time
    */
-  type_real get_time() const override { return this->current_time; }
+  type_real get_time() const final { return this->current_time; }
   /**
    * @brief Get the current timestep
    *
    * @return int current timestep
    */
-  int get_timestep() const override { return this->istep; }
+  int get_timestep() const final { return this->istep; }
   /**
-   * @brief reset current time to t0 and timestep to 0
+   * @brief reset current time to t0, timestep and seismogram step to 0
    *
    */
-  void reset_time() override;
+  void reset_time() final;
+  /**
+   * @brief Update the simulation start time
+   *
+   * @param t0 Simulation start time
+   */
+  void update_t0(const type_real t0) final { this->t0 = t0; }
   // void update_fields(specfem::Domain::Domain *domain_class){};
   /**
    * @brief Get the max timestep (nstep) of the simuation
    *
    * @return int max timestep
    */
-  int get_max_timestep() override { return this->nstep; }
+  int get_max_timestep() final { return this->nstep; }
   /**
    * @brief Apply predictor phase of the timescheme
    *
    * @param domain_class Pointer to domain class to apply predictor phase
+   * @param exec_space Execution space instance used to launch kernels
    */
-  void
-  apply_predictor_phase(const specfem::Domain::Domain *domain_class) override;
+  void apply_predictor_phase(const specfem::Domain::Domain *domain_class,
+                             const specfem::kokkos::DevExecSpace &exec_space =
+                                 specfem::kokkos::DevExecSpace()) final;
   /**
    * @brief Apply corrector phase of the timescheme
    *
    * @param domain_class Pointer to domain class to apply corrector phase
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void apply_corrector_phase(const specfem::Domain::Domain *domain_class,
+                             const specfem::kokkos::DevExecSpace &exec_space =
+                                 specfem::kokkos::DevExecSpace()) final;
+  /**
+   * @brief Divide the acceleration by the mass matrix and apply corrector
+   * phase of the timescheme in a single pass over global arrays. Optionally
+   * also apply the predictor phase of the next timestep in the same pass
+   *
+   * @param domain_class Pointer to domain class to update
+   * @param apply_predictor if true apply predictor phase of the next
+   * timestep. Acceleration at the current step is not available after the
+   * update
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void
+  apply_fused_corrector_phase(const specfem::Domain::Domain *domain_class,
+                              const bool apply_predictor,
+                              const specfem::kokkos::DevExecSpace &exec_space =
+                                  specfem::kokkos::DevExecSpace()) final;
+  /**
+   * @brief Record predictor phase of the timescheme inside a graph
+   *
+   * @param domain_class Pointer to domain class to apply predictor phase
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
+   */
+  void apply_predictor_phase(const specfem::Domain::Domain *domain_class,
+                             specfem::kokkos::DeviceGraphNode &node) final;
+  /**
+   * @brief Record fused mass matrix division and corrector phase of the
+   * timescheme inside a graph
+   *
+   * @param domain_class Pointer to domain class to update
+   * @param apply_predictor if true apply predictor phase of the next
+   * timestep
+   * @param node Graph node after which kernels are recorded. Updated to refer
+   * to the last recorded kernel
    */
   void
-  apply_corrector_phase(const specfem::Domain::Domain *domain_class) override;
+  apply_fused_corrector_phase(const specfem::Domain::Domain *domain_class,
+                              const bool apply_predictor,
+                              specfem::kokkos::DeviceGraphNode &node) final;
+  /**
+   * @brief Get the analytic cost of one call of the kernels of a time loop
+   * phase
+   *
+   * @param phase Time loop phase
+   * @param domain_class Pointer to domain class updated by the kernels
+   * @param apply_predictor if true the fused corrector phase also applies the
+   * predictor phase of the next timestep
+   * @return specfem::timers::cost Bytes and flops of the kernels
+   */
+  specfem::timers::cost
+  get_cost(const specfem::timers::phase phase,
+           const specfem::Domain::Domain *domain_class,
+           const bool apply_predictor = false) const final;
   /**
    * @brief
    *
@@ -168,6 +457,246 @@ public:
    * @brief Compute if seismogram needs to be calculated at this timestep
    *
    */
+  bool compute_seismogram() const final {
+    return (this->istep % nstep_between_samples == 0);
+  };
+  /**
+   * @brief Get the current seismogram step
+   *
+   * @return int value of the current seismogram step
+   */
+  int get_seismogram_step() const final { return isig_step; }
+  /**
+   * @brief Get the max seismogram step
+   *
+   * @return int maximum value of seismogram step
+   */
+  int get_max_seismogram_step() const final {
+    return nstep / nstep_between_samples;
+  }
+  /**
+   * @brief Increment seismogram step
+   *
+   */
+  void increment_seismogram_step() final { isig_step++; }
+  /**
+   * @brief Get the position of the time loop
+   *
+   * @return specfem::TimeScheme::state Position of the time loop
+   */
+  specfem::TimeScheme::state get_state() const final {
+    return { this->istep, this->isig_step,
+             static_cast<double>(this->current_time) };
+  }
+  /**
+   * @brief Resume the time loop at a position returned by get_state
+   *
+   * @param state Position of the time loop
+   */
+  void set_state(const specfem::TimeScheme::state &state) final {
+    this->istep = state.istep;
+    this->isig_step = state.isig_step;
+    this->current_time = state.current_time;
+  }
+
+  /**
+   * @brief Check the stability of the fields every interval steps
+   *
+   * On check steps the fused corrector phase also reduces the largest
+   * absolute value of the displacement and velocity, and throws if it is
+   * not finite or larger than threshold. The reduction reads values already
+   * loaded by the corrector, but blocks the host until the kernel completes.
+   * Fused corrector phases recorded inside a graph aren't checked
+   *
+   * @param interval Number of steps between two checks. Fields aren't
+   * checked if 0
+   * @param threshold Largest absolute value of a stable field
+   */
+  void set_stability_check(const int interval, const type_real threshold) {
+    this->check_interval = interval;
+    this->check_threshold = threshold;
+  }
+
+  /**
+   * @brief
+   *
+   */
+  void print(std::ostream &out) const override;
+
+protected:
+  type_accum current_time;      ///< Current simulation time in seconds
+  int istep = 0;                ///< Current simulation step
+  type_accum deltat;            ///< time increment (\f$ \delta t \f$)
+  type_accum deltatover2;       ///< \f$ \delta t / 2 \f$
+  type_accum deltatsquareover2; ///< \f$ \delta t^2 / 2 \f$
+  int nstep;                    ///< Maximum value of timestep
+  type_accum t0;                ///< Simultion start time in seconds
+  int nstep_between_samples;    ///< Number of time steps between seismogram
+                                ///< outputs
+  int isig_step = 0;            ///< current seismogram step
+  int check_interval = 0;       ///< Number of steps between two stability
+                                ///< checks, 0 if fields aren't checked
+  type_real check_threshold = 0.0; ///< Largest absolute value of a stable
+                                   ///< field
+  /**
+   * @brief Launch or record predictor phase kernel
+   *
+   * @param domain_class Pointer to domain class to apply predictor phase
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void launch_predictor_phase(const specfem::Domain::Domain *domain_class,
+                              const specfem::kokkos::DevExecSpace &exec_space,
+                              specfem::kokkos::DeviceGraphNode *node);
+  /**
+   * @brief Launch or record fused corrector phase kernel
+   *
+   * @param domain_class Pointer to domain class to update
+   * @param apply_predictor if true apply predictor phase of the next
+   * timestep
+   * @param exec_space Execution space instance used to launch kernels
+   * @param node Graph node used to record the kernel. The kernel is launched
+   * immediately if node is a nullptr
+   */
+  void
+  launch_fused_corrector_phase(const specfem::Domain::Domain *domain_class,
+                               const bool apply_predictor,
+                               const specfem::kokkos::DevExecSpace &exec_space,
+                               specfem::kokkos::DeviceGraphNode *node);
+};
+
+/**
+ * @brief Low-dissipation and low-dispersion Runge-Kutta timescheme
+ *
+ * Six stage, fourth order, 2N-storage scheme of Berland et al. (2006). Every
+ * stage updates the fields using two registers which store the increments of
+ * displacement and velocity.
+ *
+ */
+class LDDRK final : public TimeScheme {
+
+public:
+  /**
+   * @brief Number of stages per timestep
+   *
+   */
+  constexpr static int nstages = 6;
+  /**
+   * @brief 2N-storage coefficients \f$ \alpha \f$ of the six stage, fourth
+   * order low-dissipation and low-dispersion Runge-Kutta scheme (Berland et
+   * al. 2006)
+   *
+   */
+  constexpr static type_accum alpha[nstages] = {
+    0.0,
+    -0.737101392796,
+    -1.634740794341,
+    -0.744739003780,
+    -1.469897351522,
+    -2.813971388035
+  };
+  /**
+   * @brief 2N-storage coefficients \f$ \beta \f$ of the scheme
+   *
+   */
+  constexpr static type_accum beta[nstages] = {
+    0.032918605146, 0.823256998200, 0.381530948900,
+    0.200092213184, 1.718581042715, 0.27
+  };
+  /**
+   * @brief Construct a new LDDRK timescheme object
+   *
+   * @param nstep maximum number of timesteps in the simulation
+   * @param t0 Simulation start time
+   * @param dt delta for the LDDRK timescheme
+   * @param nstep_between_samples Number of time steps between seismogram
+   * outputs
+   */
+  LDDRK(const int nstep, const type_real t0, const type_real dt,
+        const int nstep_between_samples);
+  /**
+   * @brief Return the status of simulation
+   *
+   * @return false if current step >= number of steps
+   * @return true if current step < number of steps
+   */
+  bool status() const override { return (this->istep < this->nstep); }
+  /**
+   * @brief increment by one timestep, also updates the simulation time by dt
+   *
+   */
+  void increment_time() override;
+  /**
+   * @brief Get the current simulation time
+   *
+   * @return type_real current time
+   */
+  type_real get_time() const override { return this->current_time; }
+  /**
+   * @brief Get the current timestep
+   *
+   * @return int current timestep
+   */
+  int get_timestep() const override { return this->istep; }
+  /**
+   * @brief reset current time to t0, timestep and seismogram step to 0
+   *
+   */
+  void reset_time() override;
+  /**
+   * @brief Update the simulation start time
+   *
+   * @param t0 Simulation start time
+   */
+  void update_t0(const type_real t0) override { this->t0 = t0; }
+  /**
+   * @brief Get the max timestep (nstep) of the simuation
+   *
+   * @return int max timestep
+   */
+  int get_max_timestep() override { return this->nstep; }
+  /**
+   * @brief Reset the acceleration before the first stage of a timestep
+   *
+   * @param domain_class Pointer to domain class to apply predictor phase
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void apply_predictor_phase(const specfem::Domain::Domain *domain_class,
+                             const specfem::kokkos::DevExecSpace &exec_space =
+                                 specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Get the number of stages of the timescheme
+   *
+   * @return int Number of stages per timestep
+   */
+  int get_nstages() const override { return nstages; }
+  /**
+   * @brief Get the simulation time at which sources are evaluated for a stage
+   *
+   * @param istage Stage index
+   * @return type_real Simulation time of stage istage
+   */
+  type_real get_stage_time(const int istage) const override;
+  /**
+   * @brief Divide the acceleration by the mass matrix and update the stage
+   * registers and fields for a stage
+   *
+   * The acceleration is reset for the next stage, except after the last stage
+   * where it is kept for seismograms
+   *
+   * @param domain_class Pointer to domain class to update
+   * @param istage Stage index
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void apply_stage_update(const specfem::Domain::Domain *domain_class,
+                          const int istage,
+                          const specfem::kokkos::DevExecSpace &exec_space =
+                              specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Compute if seismogram needs to be calculated at this timestep
+   *
+   */
   bool compute_seismogram() const override {
     return (this->istep % nstep_between_samples == 0);
   };
@@ -182,7 +711,7 @@ public:
    *
    * @return int maximum value of seismogram step
    */
-  virtual int get_max_seismogram_step() const override {
+  int get_max_seismogram_step() const override {
     return nstep / nstep_between_samples;
   }
   /**
@@ -190,24 +719,189 @@ public:
    *
    */
   void increment_seismogram_step() override { isig_step++; }
+  /**
+   * @brief Get the position of the time loop
+   *
+   * @return specfem::TimeScheme::state Position of the time loop
+   */
+  specfem::TimeScheme::state get_state() const override {
+    return { this->istep, this->isig_step,
+             static_cast<double>(this->current_time) };
+  }
+  /**
+   * @brief Resume the time loop at a position returned by get_state
+   *
+   * @param state Position of the time loop
+   */
+  void set_state(const specfem::TimeScheme::state &state) override {
+    this->istep = state.istep;
+    this->isig_step = state.isig_step;
+    this->current_time = state.current_time;
+  }
+  /**
+   * @brief Log timescheme information to console
+   *
+   */
+  void print(std::ostream &out) const override;
+
+private:
+  type_accum current_time;   ///< Current simulation time in seconds
+  int istep = 0;             ///< Current simulation step
+  type_accum deltat;         ///< time increment (\f$ \delta t \f$)
+  int nstep;                 ///< Maximum value of timestep
+  type_accum t0;             ///< Simultion start time in seconds
+  int nstep_between_samples; ///< Number of time steps between seismogram
+                             ///< outputs
+  int isig_step = 0;         ///< current seismogram step
+  specfem::kokkos::DeviceFieldView2d<type_real>
+      field_register; ///< Displacement increment register
+  specfem::kokkos::DeviceFieldView2d<type_real>
+      field_dot_register; ///< Velocity increment register
+};
 
+/**
+ * @brief Newmark timescheme with local time stepping
+ *
+ * Spectral elements are binned into levels, elements of level ilevel are
+ * stable with dt / 2^ilevel. A global point belongs to the finest level of the
+ * elements containing it and is stepped by the Newmark scheme using the time
+ * step of its level. A timestep is divided into 2^(nlevels - 1) substeps of
+ * the finest level. At the end of every substep the acceleration of the
+ * levels ending a step is computed using only the elements containing points
+ * of those levels. Displacements of coarser points of these elements are
+ * linearly interpolated in time between the start and the end of their step.
+ *
+ */
+class LTSNewmark final : public Newmark {
+public:
   /**
-   * @brief
+   * @brief Construct a new Newmark timescheme object with local time stepping
+   *
+   * @param nstep maximum number of timesteps in the simulation
+   * @param t0 Simulation start time
+   * @param dt delta of the coarsest level
+   * @param nstep_between_samples Number of time steps between seismogram
+   * outputs
+   */
+  LTSNewmark(const int nstep, const type_real t0, const type_real dt,
+             const int nstep_between_samples)
+      : Newmark(nstep, t0, dt, nstep_between_samples){};
+  /**
+   * @brief Get the number of local time stepping levels
+   *
+   * @return int Number of levels
+   */
+  int get_nlevels() const override { return this->nlevels; }
+  /**
+   * @brief Assign local time stepping levels to spectral elements and order
+   * the elements of the domain by level
+   *
+   * Levels of elements are raised to the finest level of the points they
+   * contain, such that the elements required to compute the acceleration of
+   * a level are contiguous in the domain
+   *
+   * @param domain_class Pointer to domain class to step
+   * @param ibool Global number for every quadrature point
+   * @param element_levels Level of every spectral element
+   */
+  void set_element_levels(specfem::Domain::Domain *domain_class,
+                          const specfem::kokkos::HostElementMirror3d<int> ibool,
+                          const std::vector<int> &element_levels) override;
+  /**
+   * @brief Get the coarsest level whose step ends at the end of a substep
+   *
+   * @param isubstep Substep index
+   * @return int Coarsest level updated by isubstep
+   */
+  int get_substep_level(const int isubstep) const override;
+  /**
+   * @brief Get the simulation time at which sources are evaluated for the
+   * points of a level ending a step at a substep
+   *
+   * Sources are evaluated at the start of the step of the level, consistent
+   * with the Newmark timescheme
+   *
+   * @param isubstep Substep index
+   * @param ilevel Level ending a step at isubstep
+   * @return type_real Simulation time at the start of the step of ilevel
+   */
+  type_real get_level_time(const int isubstep,
+                           const int ilevel) const override;
+  /**
+   * @brief Get the level of every global point
+   *
+   * @return specfem::kokkos::DeviceView1d<int> Level of every global point
+   */
+  specfem::kokkos::DeviceView1d<int> get_point_level() const override {
+    return this->point_level;
+  }
+  /**
+   * @brief Apply predictor phase to levels starting a step at a substep,
+   * reset the acceleration of levels ending a step at the substep and
+   * interpolate interface displacements of coarser levels
+   *
+   * @param domain_class Pointer to domain class to apply predictor phase
+   * @param isubstep Substep index
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void
+  apply_level_predictor_phase(const specfem::Domain::Domain *domain_class,
+                              const int isubstep,
+                              const specfem::kokkos::DevExecSpace &exec_space =
+                                  specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Restore interface displacements of coarser levels, divide the
+   * acceleration by the mass matrix and apply corrector phase to levels ending
+   * a step at a substep
+   *
+   * @param domain_class Pointer to domain class to apply corrector phase
+   * @param isubstep Substep index
+   * @param exec_space Execution space instance used to launch kernels
+   */
+  void
+  apply_level_corrector_phase(const specfem::Domain::Domain *domain_class,
+                              const int isubstep,
+                              const specfem::kokkos::DevExecSpace &exec_space =
+                                  specfem::kokkos::DevExecSpace()) override;
+  /**
+   * @brief Log timescheme information to console
    *
    */
   void print(std::ostream &out) const override;
 
 private:
-  type_real current_time;      ///< Current simulation time in seconds
-  int istep = 0;               ///< Current simulation step
-  type_real deltat;            ///< time increment (\f$ \delta t \f$)
-  type_real deltatover2;       ///< \f$ \delta t / 2 \f$
-  type_real deltatsquareover2; ///< \f$ \delta t^2 / 2 \f$
-  int nstep;                   ///< Maximum value of timestep
-  type_real t0;                ///< Simultion start time in seconds
-  int nstep_between_samples;   ///< Number of time steps between seismogram
-                               ///< outputs
-  int isig_step = 0;           ///< current seismogram step
+  int nlevels = 1; ///< Number of local time stepping levels
+  specfem::kokkos::DeviceView1d<int> point_level; ///< Level of every global
+                                                  ///< point
+  specfem::kokkos::DeviceView1d<int> level_points; ///< Global points sorted
+                                                   ///< in ascending order of
+                                                   ///< level
+  std::vector<int> h_point_offsets; ///< Points of level ilevel in
+                                    ///< level_points span
+                                    ///< [h_point_offsets[i],
+                                    ///< h_point_offsets[i + 1])
+  specfem::kokkos::DeviceView1d<int> interface_points; ///< Points of coarser
+                                                       ///< levels contained
+                                                       ///< in elements updated
+                                                       ///< by every level
+  std::vector<int> h_interface_offsets; ///< Interface points of level ilevel
+                                        ///< in interface_points span
+                                        ///< [h_interface_offsets[i],
+                                        ///< h_interface_offsets[i + 1])
+  specfem::kokkos::DeviceFieldView2d<type_real>
+      field_start; ///< Displacement at the start of the current step of
+                   ///< every point
+  specfem::kokkos::DeviceFieldView2d<type_real>
+      field_end; ///< Displacement at the end of the current step of every
+                 ///< point
+  /**
+   * @brief Get the coarsest level whose step starts at the start of a
+   * substep
+   *
+   * @param isubstep Substep index
+   * @return int Coarsest level starting a step at isubstep
+   */
+  int get_start_level(const int isubstep) const;
 };
 
 std::ostream &operator<<(std::ostream &out,
@@ -0,0 +1,151 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "../include/specfem_mpi.h"
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace specfem {
+/**
+ * @brief Timeline trace of the phases and kernels of a run
+ *
+ */
+namespace trace {
+
+/**
+ * @brief Tracks of a trace, shown as threads of a process
+ *
+ */
+enum track {
+  phases = 0, ///< Timed phases, including interface exchanges and outputs
+  kernels = 1 ///< Kokkos kernel launches
+};
+
+/**
+ * @brief Recorder of begin and end events of every process
+ *
+ * Events are recorded between the first and last traced steps. Events
+ * outside of the time loop, e.g. setup phases, are only recorded if every
+ * step is traced. Timestamps are relative to the construction of the
+ * recorder, which synchronizes processes so their timelines are aligned.
+ *
+ * Kernel events are recorded using Kokkos tools callbacks. Kernels are
+ * launched asynchronously, hence kernel events measure the time the host
+ * spends launching kernels unless kernels are blocking, e.g. with
+ * CUDA_LAUNCH_BLOCKING=1
+ *
+ */
+class recorder {
+
+public:
+  /**
+   * @brief Construct a disabled recorder object
+   *
+   */
+  recorder() : enabled(false){};
+  /**
+   * @brief Construct a new recorder object
+   *
+   * Collective: synchronizes processes
+   *
+   * @param mpi Pointer to MPI object
+   * @param first_step First traced step
+   * @param last_step Last traced step
+   */
+  recorder(const specfem::MPI::MPI *mpi, const int first_step = 0,
+           const int last_step = std::numeric_limits<int>::max());
+  /**
+   * @brief Destroy the recorder object, kernels launched afterwards aren't
+   * recorded
+   *
+   */
+  ~recorder();
+  /**
+   * @brief Set the step executed by the time loop
+   *
+   * @param istep Step, -1 outside of the time loop
+   */
+  void set_step(const int istep) { this->istep = istep; }
+  /**
+   * @brief Check if events are recorded
+   *
+   * @return bool true if the recorder is enabled and the current step is
+   * traced
+   */
+  bool is_recording() const {
+    if (!this->enabled)
+      return false;
+    if (this->istep < 0)
+      return this->first_step <= 0 &&
+             this->last_step == std::numeric_limits<int>::max();
+    return this->istep >= this->first_step && this->istep <= this->last_step;
+  }
+  /**
+   * @brief Record an event
+   *
+   * @param name Name of the event
+   * @param track Track of the event
+   * @param begin Start of the event
+   * @param end End of the event
+   */
+  void record(const std::string &name, const specfem::trace::track track,
+              const std::chrono::steady_clock::time_point &begin,
+              const std::chrono::steady_clock::time_point &end);
+  /**
+   * @brief Record the kernels launched by Kokkos
+   *
+   * Replaces the kernel callbacks of a loaded tools library. Only one
+   * recorder records kernels at a time
+   *
+   */
+  void record_kernels();
+  /**
+   * @brief Get the number of recorded events
+   *
+   * @return int Number of events
+   */
+  int get_nevents() const { return this->events.size(); }
+  /**
+   * @brief Write the trace as a Chrome trace JSON file
+   *
+   * Collective: processes append their events in turn. Every process is a
+   * process of the trace, which can be loaded in Perfetto or
+   * chrome://tracing
+   *
+   * @param filename Path of the JSON file
+   * @param mpi Pointer to MPI object
+   */
+  void write(const std::string &filename, const specfem::MPI::MPI *mpi) const;
+
+private:
+  struct event {
+    std::string name;             ///< Name of the event
+    specfem::trace::track track;  ///< Track of the event
+    double begin;                 ///< Start in microseconds
+    double duration;              ///< Duration in microseconds
+    int istep;                    ///< Step of the event, -1 outside of the
+                                  ///< time loop
+  };
+
+  bool enabled = true;           ///< If false events aren't recorded
+  int first_step = 0;            ///< First traced step
+  int last_step = std::numeric_limits<int>::max(); ///< Last traced step
+  int istep = -1;                ///< Step executed by the time loop
+  std::chrono::steady_clock::time_point origin; ///< Origin of timestamps
+  std::vector<event> events;     ///< Recorded events
+};
+
+/**
+ * @brief Disabled recorder used by timers without a trace
+ *
+ * @return specfem::trace::recorder* Pointer to a recorder recording nothing
+ */
+specfem::trace::recorder *disabled();
+
+} // namespace trace
+} // namespace specfem
+
+#endif
@@ -6,6 +6,7 @@
 #include "../include/quadrature.h"
 #include "../include/specfem_mpi.h"
 #include <tuple>
+#include <vector>
 
 namespace specfem {
 namespace utilities {
@@ -47,9 +48,63 @@ struct return_holder {
 //   type_real tshift;
 // };
 
+/**
+ * @brief Closest quadrature point search over the global points of a rank
+ *
+ * Global points are binned in a uniform grid of buckets. Queries search rings
+ * of buckets around a point, and return the same quadrature point as a scan
+ * over every quadrature point in element order: ties are broken by the first
+ * quadrature point in element order. Meshes with zero width or height use a
+ * single row or column of buckets.
+ *
+ */
+class spatial_index {
+public:
+  /**
+   * @brief Construct the buckets and the corner adjacency of elements
+   *
+   * @param coord (x, z) for every global quadrature point
+   * @param ibool Global number for every quadrature point
+   */
+  spatial_index(const specfem::kokkos::HostView2d<type_real> coord,
+                const specfem::kokkos::HostElementMirror3d<int> ibool);
+
+  /**
+   * @brief Find the closest quadrature point to (x, z)
+   *
+   * @param x x coordinate of the point
+   * @param z z coordinate of the point
+   * @return std::tuple<int, int, int> (ix, iz, ispec) of the closest
+   * quadrature point
+   */
+  std::tuple<int, int, int> rough_location(const type_real x,
+                                           const type_real z) const;
+
+  /**
+   * @brief Get the elements to search for the best location of a point
+   *
+   * @param ispec Element of the closest quadrature point
+   * @return std::vector<int> ispec followed by the elements sharing one of
+   * its corners in increasing order
+   */
+  std::vector<int> best_candidates(const int ispec) const;
+
+private:
+  int bucket_x(const type_real x) const;
+  int bucket_z(const type_real z) const;
+
+  specfem::kokkos::HostView2d<type_real> coord;
+  int ngllz, ngllx;
+  std::vector<int> first; ///< First quadrature point of every global point
+  type_real xmin, zmin, hx, hz;
+  int nx = 1, nz = 1;
+  std::vector<int> offsets, points;
+  std::vector<int> neighbor_offsets, neighbors;
+};
+
 std::tuple<type_real, type_real, int, int>
 locate(const specfem::kokkos::HostView2d<type_real> coord,
-       const specfem::kokkos::HostMirror3d<int> ibool,
+       const specfem::kokkos::HostElementMirror3d<int> ibool,
        const specfem::kokkos::HostMirror1d<type_real> xigll,
        const specfem::kokkos::HostMirror1d<type_real> zigll, const int nproc,
        const type_real x_source, const type_real z_source,
@@ -57,11 +112,73 @@ locate(const specfem::kokkos::HostView2d<type_real> coord,
        const specfem::kokkos::HostView2d<int> knods, const int npgeo,
        const specfem::MPI::MPI *mpi);
 
+/**
+ * @brief Locate a batch of points within a distributed mesh
+ *
+ * Every rank searches the points inside the bounding box of its elements.
+ * Owners are then selected, and the location found by the owner of every
+ * point is shipped to every rank, using a fixed number of element-wise
+ * reductions independent of the number of points.
+ *
+ * @param coord (x, z) for every global quadrature point
+ * @param ibool Global number for every quadrature point
+ * @param xigll Quadrature points in x-dimension
+ * @param zigll Quadrature points in z-dimension
+ * @param x_sources x coordinate of every point
+ * @param z_sources z coordinate of every point
+ * @param coorg Value of every spectral element control nodes
+ * @param knods Global control element number for every control node
+ * @param mpi Pointer to specfem MPI object
+ * @return std::vector<std::tuple<type_real, type_real, int, int> > (xi,
+ * gamma, ispec, islice) of every point. ispec is local to rank islice
+ */
+std::vector<std::tuple<type_real, type_real, int, int> >
+locate(const specfem::kokkos::HostView2d<type_real> coord,
+       const specfem::kokkos::HostElementMirror3d<int> ibool,
+       const specfem::kokkos::HostMirror1d<type_real> xigll,
+       const specfem::kokkos::HostMirror1d<type_real> zigll,
+       const std::vector<type_real> &x_sources,
+       const std::vector<type_real> &z_sources,
+       const specfem::kokkos::HostView2d<type_real> coorg,
+       const specfem::kokkos::HostView2d<int> knods,
+       const specfem::MPI::MPI *mpi);
+
+/**
+ * @brief Find the best location of a batch of points inside given elements
+ *
+ * Every point is located independently inside its element using Newton
+ * iterations on the mapping of the element, in parallel on the host
+ * execution space. Iterations stop once the update of \f$ (\xi, \gamma)
+ * \f$ is below tolerance, or after max_iterations.
+ *
+ * @param x x coordinate of every point
+ * @param z z coordinate of every point
+ * @param ispec Element searched for every point
+ * @param coorg Value of every spectral element control nodes
+ * @param knods Global control element number for every control node
+ * @param xi \f$ \xi \f$ of every point. Initial guess, updated by this
+ * function
+ * @param gamma \f$ \gamma \f$ of every point. Initial guess, updated by
+ * this function
+ * @param residual Distance between every point and its best location
+ * (updated by this function)
+ * @param max_iterations Maximum number of Newton iterations
+ */
+void best_locations(const specfem::kokkos::HostView1d<type_real> x,
+                    const specfem::kokkos::HostView1d<type_real> z,
+                    const specfem::kokkos::HostView1d<int> ispec,
+                    const specfem::kokkos::HostView2d<type_real> coorg,
+                    const specfem::kokkos::HostView2d<int> knods,
+                    specfem::kokkos::HostView1d<type_real> xi,
+                    specfem::kokkos::HostView1d<type_real> gamma,
+                    specfem::kokkos::HostView1d<type_real> residual,
+                    const int max_iterations = 5);
+
 void check_locations(const type_real x, const type_real z, const type_real xmin,
                      const type_real xmax, const type_real zmin,
                      const type_real zmax, const specfem::MPI::MPI *mpi);
 
-int compute_nglob(const specfem::kokkos::HostMirror3d<int> ibool);
+int compute_nglob(const specfem::kokkos::HostElementMirror3d<int> ibool);
 } // namespace utilities
 } // namespace specfem
 
@@ -0,0 +1,69 @@
+#ifndef VELOCITY_MODEL_H
+#define VELOCITY_MODEL_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include <cstdint>
+#include <string>
+
+namespace specfem {
+/**
+ * @brief External velocity models sampled on a regular grid
+ *
+ * A model file starts with a header followed by the rows of the grid in
+ * ascending order of z. Every row stores nx values of vp, then nx values of
+ * vs, then nx values of rho as 32 bit floats. Rows are read in tiles, hence
+ * the memory used to interpolate a model is bounded by the tile size instead
+ * of the model size.
+ *
+ */
+namespace velocity_model {
+
+/**
+ * @brief Header of a model file
+ *
+ */
+struct header {
+  char magic[8];   ///< Equal to SPECFEMV
+  std::int32_t nx; ///< Number of grid points along x
+  std::int32_t nz; ///< Number of grid points along z
+  double x0;       ///< x coordinate of the first column
+  double z0;       ///< z coordinate of the first row
+  double dx;       ///< Spacing of the columns
+  double dz;       ///< Spacing of the rows
+};
+
+/**
+ * @brief Number of fields stored in every row (vp, vs and rho)
+ *
+ */
+constexpr int nfields = 3;
+
+/**
+ * @brief Interpolate a model file onto the quadrature points of elastic
+ * elements
+ *
+ * Quadrature points are grouped by the tile of rows containing them. Every
+ * tile is read once and its points are bilinearly interpolated in parallel
+ * into the host views of properties. Points outside the grid take the value
+ * of the closest grid point. rho, mu, lambdaplus2mu, kappa, rho_vp and
+ * rho_vs are overwritten, Q values are kept. Device views are updated using
+ * properties.sync_views, hence properties shouldn't be compressed.
+ *
+ * @param filename Model file
+ * @param tile_rows Number of grid rows read at once
+ * @param coord (x, z) for every distinct quadrature point
+ * @param ibool Global number for every quadrature point
+ * @param properties Material properties to overwrite
+ * @return int Number of quadrature points assigned
+ */
+int interpolate(const std::string &filename, const int tile_rows,
+                const specfem::kokkos::HostView2d<type_real> coord,
+                const specfem::kokkos::HostElementMirror3d<int> ibool,
+                specfem::compute::properties &properties);
+
+} // namespace velocity_model
+} // namespace specfem
+
+#endif
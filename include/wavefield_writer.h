@@ -0,0 +1,225 @@
+#ifndef WAVEFIELD_WRITER_H
+#define WAVEFIELD_WRITER_H
+
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/domain.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/quadrature.h"
+#include "../include/specfem_mpi.h"
+#include "../include/writer.h"
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace specfem {
+namespace writer {
+/**
+ * @brief Select the global points written by wavefield outputs
+ *
+ * Points (iz, ix) of every element are selected when iz and ix are multiples
+ * of stride or on the edges of the element
+ *
+ * @param ibool Global number of every quadrature point
+ * @param nglob Number of global points
+ * @param stride Stride between selected points along both dimensions
+ * @return std::vector<int> Global number of the selected points, in the order
+ * of their first occurrence
+ */
+std::vector<int>
+select_points(const specfem::kokkos::HostElementMirror3d<int> ibool,
+              const int nglob, const int stride);
+
+/**
+ * @brief Write the contents of a host view to a binary file
+ *
+ * @tparam ViewType Type of the host view
+ * @param filename Path of the file
+ * @param values Values written after the header
+ * @param header Integers written at the beginning of the file
+ */
+template <typename ViewType>
+void write_binary(const std::string &filename, const ViewType values,
+                  const std::vector<std::int32_t> &header = {}) {
+  std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+  stream.write(reinterpret_cast<const char *>(header.data()),
+               header.size() * sizeof(std::int32_t));
+  stream.write(reinterpret_cast<const char *>(values.data()),
+               values.span() * sizeof(typename ViewType::value_type));
+  if (!stream) {
+    std::ostringstream message;
+    message << "Could not write file " << filename;
+    throw std::runtime_error(message.str());
+  }
+}
+
+/**
+ * @brief Regular grid of pixels onto which wavefield images are interpolated
+ *
+ * Pixels are numbered row by row from the bottom left corner. Pixel (iz, ix)
+ * is centered at (xmin + (ix + 0.5) * dx, zmin + (iz + 0.5) * dz)
+ */
+struct image_grid {
+  int nx = 0;           ///< Number of pixels along x. Images aren't written
+                        ///< if 0
+  int nz = 0;           ///< Number of pixels along z
+  type_real xmin = 0.0; ///< Left side of the grid
+  type_real xmax = 0.0; ///< Right side of the grid
+  type_real zmin = 0.0; ///< Bottom side of the grid
+  type_real zmax = 0.0; ///< Top side of the grid
+  bool bounded = false; ///< If false the grid spans the bounding box of the
+                        ///< mesh
+};
+
+/**
+ * @brief Wavefield writer class to write snapshots of the fields during the
+ * time loop
+ *
+ * A snapshot gathers the requested fields at a subset of the global points
+ * into a device buffer on the execution space instance updating the fields.
+ * The buffer is copied to pinned host memory on a separate execution space
+ * instance and written to file by a background task, hence the time loop only
+ * waits for the gather kernel. Buffers are double buffered such that a
+ * snapshot can be copied while the previous one is written.
+ *
+ * Every process writes its own files:
+ *  - wavefield_points_<rank>.bin : number of points (int32) followed by the
+ * (x, z) coordinates of every point
+ *  - wavefield_<step>_<rank>.bin : values of the points for every requested
+ * field, ordered as (field, point, component)
+ *
+ * Snapshots can instead be interpolated onto a regular grid of pixels. Every
+ * pixel is located once in the mesh, storing its element and the Lagrange
+ * interpolants of its location along both dimensions, and every snapshot
+ * interpolates every pixel with a single kernel. Every process writes
+ * image_<step>_<rank>.bin : number of pixels along x and z (int32) followed
+ * by the values of every pixel for every requested field, ordered as (field,
+ * iz, ix, component). Pixels located on other processes or outside the mesh
+ * are 0, hence the images of every process add up to the full image.
+ *
+ * Values are stored as type_real in native byte order.
+ */
+class wavefield : public writer {
+
+public:
+  /**
+   * @brief Construct a new wavefield writer object
+   *
+   * @param domain Pointer to domain storing the fields
+   * @param compute Pointer to specfem::compute::compute struct storing the
+   * global numbering and coordinates
+   * @param fields Fields written in every snapshot, displacement (field),
+   * velocity (field_dot) or acceleration (field_dot_dot)
+   * @param nstep_between_snapshots Number of timesteps between snapshots
+   * @param stride Stride between written GLL points along both dimensions
+   * of every element. Element edges are always written, hence 1 writes every
+   * point and ngll - 1 writes element corners
+   * @param output_folder Path to output folder where snapshots will be stored
+   * @param mpi Pointer to MPI object
+   */
+  wavefield(specfem::Domain::Domain *domain,
+            const specfem::compute::compute *compute,
+            const std::vector<specfem::seismogram::type> &fields,
+            const int nstep_between_snapshots, const int stride,
+            const std::string output_folder, const specfem::MPI::MPI *mpi);
+  /**
+   * @brief Construct a wavefield writer interpolating snapshots onto a
+   * regular grid
+   *
+   * @param domain Pointer to domain storing the fields
+   * @param compute Pointer to specfem::compute::compute struct storing the
+   * global numbering and coordinates
+   * @param quadx Quadrature object in x dimension
+   * @param quadz Quadrature object in z dimension
+   * @param coorg (x, z) for every spectral element control node
+   * @param knods Global control element number for every control node
+   * @param fields Fields written in every snapshot
+   * @param nstep_between_snapshots Number of timesteps between snapshots
+   * @param grid Regular grid of pixels
+   * @param output_folder Path to output folder where images will be stored
+   * @param mpi Pointer to MPI object
+   */
+  wavefield(specfem::Domain::Domain *domain,
+            const specfem::compute::compute *compute,
+            const specfem::quadrature::quadrature &quadx,
+            const specfem::quadrature::quadrature &quadz,
+            const specfem::kokkos::HostView2d<type_real> coorg,
+            const specfem::kokkos::HostView2d<int> knods,
+            const std::vector<specfem::seismogram::type> &fields,
+            const int nstep_between_snapshots,
+            const specfem::writer::image_grid &grid,
+            const std::string output_folder, const specfem::MPI::MPI *mpi);
+  /**
+   * @brief Wait for the background task writing snapshots
+   *
+   */
+  ~wavefield();
+  /**
+   * @brief Check if a snapshot is taken at the end of timestep istep
+   *
+   * @param istep Index of the timestep
+   * @return bool true if the fields at the end of istep are written
+   */
+  bool snapshot_step(const int istep) const {
+    return (istep + 1) % this->nstep_between_snapshots == 0;
+  }
+  /**
+   * @brief Take a snapshot of the fields at the end of timestep istep
+   *
+   * Fields need to be corrected, and must not be updated by kernels launched
+   * before the call on other execution space instances.
+   *
+   * @param istep Index of the timestep
+   * @param exec_space Execution space instance updating the fields
+   */
+  void snapshot(const int istep,
+                const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Complete every background write
+   *
+   */
+  void write() override;
+
+private:
+  specfem::Domain::Domain *domain; ///< Pointer to domain storing the fields
+  std::vector<specfem::seismogram::type> fields; ///< Fields written in every
+                                                 ///< snapshot
+  int nstep_between_snapshots; ///< Number of timesteps between snapshots
+  std::string output_folder;   ///< Path to output folder
+  int rank;                    ///< Rank of this process used in filenames
+  specfem::kokkos::DeviceView1d<int> points; ///< Global number of written
+                                             ///< points
+  specfem::writer::image_grid grid; ///< Pixels of images. Snapshots gather
+                                    ///< points if grid.nx is 0
+  specfem::compute::connectivity_accessor ibool; ///< Global numbering read by
+                                                 ///< the image kernel
+  specfem::kokkos::DeviceView1d<int> pixels; ///< Index (iz * nx + ix) of the
+                                             ///< pixels located on this
+                                             ///< process
+  specfem::kokkos::DeviceView1d<int> pixel_ispec; ///< Element of every pixel
+  specfem::kokkos::DeviceView2d<type_real> hxi;    ///< Lagrange interpolants
+                                                   ///< of every pixel along x
+  specfem::kokkos::DeviceView2d<type_real> hgamma; ///< Lagrange interpolants
+                                                   ///< of every pixel along z
+  specfem::kokkos::DeviceView1d<int> field_types; ///< Field of every image
+                                                  ///< slot: displacement (0),
+                                                  ///< velocity (1) or
+                                                  ///< acceleration (2)
+  specfem::kokkos::DeviceView3d<type_real> buffer[2]; ///< Gathered snapshots
+  specfem::kokkos::HostPinnedView3d<type_real> staging[2]; ///< Snapshots
+                                                           ///< copied to host
+  std::vector<specfem::kokkos::DevExecSpace> copy_spaces; ///< Instances used
+                                                          ///< to copy
+                                                          ///< snapshots
+  int isnapshot = 0;         ///< Number of snapshots taken
+  std::future<void> pending; ///< Background task writing the last snapshot
+};
+} // namespace writer
+} // namespace specfem
+
+#endif
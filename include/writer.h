@@ -4,7 +4,13 @@
 #include "../include/compute.h"
 #include "../include/config.h"
 #include "../include/enums.h"
+#include "../include/hdf5_file.h"
+#include "../include/kokkos_abstractions.h"
 #include "../include/receiver.h"
+#include "../include/specfem_mpi.h"
+#include <future>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace specfem {
@@ -15,16 +21,58 @@ namespace writer {
  */
 class writer {
 public:
+  virtual ~writer() = default;
   /**
    * @brief Method to execute the write operation
    *
    */
   virtual void write(){};
+  /**
+   * @brief Method called by the solver once a seismogram sample is computed
+   *
+   * @param isig_step Index of the sample
+   * @param exec_space Execution space instance computing the sample
+   */
+  virtual void sample(const int isig_step,
+                      const specfem::kokkos::DevExecSpace &exec_space){};
+  /**
+   * @brief Wait for background writes to complete
+   *
+   */
+  virtual void wait(){};
+  /**
+   * @brief Get the number of samples written to the output files
+   *
+   * @return int Number of samples written during the time loop
+   */
+  virtual int get_nflushed() const { return 0; }
+  /**
+   * @brief Resume writing a run whose first nflushed samples are already
+   * written, e.g. when restarting from a checkpoint
+   *
+   * @param nflushed Number of samples written by the previous run
+   */
+  virtual void resume(const int nflushed){};
 };
 
 /**
  * @brief Seismogram writer class to write seismogram to a file
  *
+ * When the device stores fewer samples than the run computes, the samples
+ * are flushed every time the buffer is full: the buffer is copied to one of
+ * two staging buffers in pinned host memory and appended to the output files
+ * by a background task while the time loop continues.
+ *
+ * HDF5 output stores every seismogram type of every receiver in a single file
+ * written collectively by every process. Flushes are then written by the
+ * calling thread since collective writes can't overlap with the MPI
+ * communications of the time loop.
+ *
+ * With other formats and an MPI object, samples are gathered on a subset of
+ * writer processes, every writer storing a contiguous block of receivers in
+ * the order of the stations file. Seismic Unix writers store their traces
+ * in the same files.
+ *
  */
 class seismogram : public writer {
 
@@ -32,7 +80,7 @@ public:
   /**
    * @brief Construct a new seismogram writer object
    *
-   * @param receivers Vector of pointers to specfem::receivers::receiver objects
+   * @param receivers Stations of the simulation. Stored by reference
    * @param compute_receivers Pointer to specfem::compute::receivers object
    * @param type Format of the output file
    * @param output_folder path to output folder where results will be stored
@@ -40,22 +88,120 @@ public:
    * @param t0 Solver start time
    * @param nstep_between_samples number of timesteps between seismogram
    * sampling (seismogram sampling frequency)
+   * @param mpi Pointer to MPI object used to locate the receivers of this
+   * process. nullptr if this process stores every receiver
+   * @param compression Deflate level of HDF5 datasets, 0 disables compression
+   * @param nwriters Number of processes writing ASCII and Seismic Unix
+   * seismograms. Clipped to the number of processes
    */
-  seismogram(std ::vector<specfem::receivers::receiver *> &receivers,
+  seismogram(const specfem::receivers::receiver_set &receivers,
              specfem::compute::receivers *compute_receivers,
              const specfem::seismogram::format::type type,
              const std::string output_folder, const type_real dt,
-             const type_real t0, const int nstep_between_samples)
-      : receivers(receivers), compute_receivers(compute_receivers), type(type),
-        output_folder(output_folder), dt(dt), t0(t0),
-        nstep_between_samples(nstep_between_samples){};
+             const type_real t0, const int nstep_between_samples,
+             const specfem::MPI::MPI *mpi = nullptr,
+             const int compression = 0, const int nwriters = 1);
+  /**
+   * @brief Wait for the background task writing samples
+   *
+   */
+  ~seismogram();
   /**
    * @brief Write seismograms
    *
+   * Samples which haven't been flushed are written and every background
+   * write is completed
+   *
    */
   void write() override;
+  /**
+   * @brief Flush the samples stored on the device if the sample written
+   * after recorded sample isig_step fills the buffer
+   *
+   * @param isig_step Index of the recorded sample
+   * @param exec_space Execution space instance computing the sample
+   */
+  void sample(const int isig_step,
+              const specfem::kokkos::DevExecSpace &exec_space) override;
+  /**
+   * @brief Wait for the background task writing samples
+   *
+   */
+  void wait() override;
+  /**
+   * @brief Get the number of samples flushed to the output files
+   *
+   * @return int Number of flushed samples
+   */
+  int get_nflushed() const override { return this->nflushed; }
+  /**
+   * @brief Append samples to the files written by a previous run
+   *
+   * Seismic Unix and HDF5 files are updated in place. ASCII files can't be
+   * resumed once samples have been flushed
+   *
+   * @param nflushed Number of samples flushed by the previous run
+   */
+  void resume(const int nflushed) override;
 
 private:
+  /**
+   * @brief Copy the device buffer to a staging buffer and append its first
+   * nsamples samples to the output files in the background
+   *
+   * @param nsamples Number of samples stored in the device buffer
+   * @param exec_space Execution space instance computing the samples
+   */
+  void flush(const int nsamples,
+             const specfem::kokkos::DevExecSpace &exec_space);
+  /**
+   * @brief Append samples to the output files
+   *
+   * @tparam ViewType Host view type of the buffer
+   * @param buffer Buffer storing the samples
+   * @param first Index of the first sample in the seismogram
+   * @param nsamples Number of samples
+   */
+  template <typename ViewType>
+  void write_samples(const ViewType buffer, const int first,
+                     const int nsamples);
+  /**
+   * @brief Write samples to the HDF5 file, creating the file when the first
+   * samples are written
+   *
+   * @tparam ViewType Host view type of the buffer
+   * @param buffer Buffer storing the samples
+   * @param first Index of the first sample in the seismogram
+   * @param nsamples Number of samples
+   */
+  template <typename ViewType>
+  void write_hdf5(const ViewType buffer, const int first, const int nsamples);
+  /**
+   * @brief Send the samples of the receivers of this process to the writer
+   * processes. Collective over every process
+   *
+   * @tparam ViewType Host view type of the buffer
+   * @param buffer Buffer storing the samples of the receivers of this process
+   * @param nsamples Number of samples
+   * @return specfem::kokkos::HostView4d<type_real> Samples of the receivers
+   * written by this process
+   */
+  template <typename ViewType>
+  specfem::kokkos::HostView4d<type_real> gather(const ViewType buffer,
+                                                const int nsamples) const;
+  /**
+   * @brief Create the files shared by writer processes before the first
+   * samples are written. Collective over every process
+   *
+   */
+  void create_files() const;
+
+  specfem::kokkos::HostPinnedView4d<type_real, specfem::kokkos::ReceiverLayout>
+      staging[2]; ///< Staging buffers used alternatively
+  int nflushed = 0;          ///< Number of samples already flushed
+  int iflush = 0;            ///< Number of flushes
+  std::future<void> pending; ///< Background task writing the last flush
+
   specfem::seismogram::format::type type; ///< Output format of the seismogram
                                           ///< file
   std::string output_folder; ///< Path to output folder where results will be
@@ -67,14 +213,28 @@ private:
                           ///< containes the view used
                           ///< to store calculated
                           ///< seismograms
-  std::vector<specfem::receivers::receiver *>
-      receivers; ///< Vector of pointers to specfem::receivers::receiver
-                 ///< objects. These are used to get station and network name
-                 ///< where saving the seismogram
-  type_real dt;  ///< Time interval between subsequent timesteps
-  type_real t0;  ///< Solver start time
+  const specfem::receivers::receiver_set
+      *receivers; ///< Pointer to the stations, used to get station and
+                  ///< network name where saving the seismogram
+  type_real dt;   ///< Time interval between subsequent timesteps
+  type_real t0;   ///< Solver start time
   int nstep_between_samples; ///< number of timesteps between seismogram
                              ///< sampling (seismogram sampling frequency)
+  const specfem::MPI::MPI *mpi; ///< Pointer to MPI object
+  int compression;              ///< Deflate level of HDF5 datasets
+  std::unique_ptr<specfem::writer::hdf5::file> file; ///< HDF5 file, open
+                                                     ///< until every sample
+                                                     ///< is written
+  bool gathered; ///< If true samples are gathered on writer processes
+  std::vector<int> written; ///< Index of every receiver written by this
+                            ///< process
+  int first_written = 0; ///< Index of the first written receiver in the
+                         ///< set of stations
+  std::vector<int> send_offsets; ///< Receivers of this process sent to rank r
+                                 ///< span [send_offsets[r],
+                                 ///< send_offsets[r + 1])
+  std::vector<int> recv_order; ///< Index in written of every received
+                               ///< receiver, in the order of reception
 };
 } // namespace writer
 } // namespace specfem
@@ -0,0 +1,1036 @@
+#include "../include/coloring.h"
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/domain.h"
+#include "../include/enums.h"
+#include "../include/first_touch.h"
+#include "../include/globals.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/quadrature.h"
+#include "../include/utils.h"
+#include <Kokkos_Core.hpp>
+#include <Kokkos_ScatterView.hpp>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+// Interpolated displacement, velocity and acceleration of an acoustic
+// receiver, indexed by (specfem::seismogram::type, component)
+struct acoustic_receiver_sample {
+  type_real value[3][2];
+
+  KOKKOS_INLINE_FUNCTION acoustic_receiver_sample() {
+    for (int itype = 0; itype < 3; itype++)
+      for (int icomp = 0; icomp < 2; icomp++)
+        value[itype][icomp] = 0.0;
+  }
+
+  KOKKOS_INLINE_FUNCTION acoustic_receiver_sample &
+  operator+=(const acoustic_receiver_sample &rhs) {
+    for (int itype = 0; itype < 3; itype++)
+      for (int icomp = 0; icomp < 2; icomp++)
+        value[itype][icomp] += rhs.value[itype][icomp];
+    return *this;
+  }
+};
+
+namespace Kokkos {
+template <> struct reduction_identity<acoustic_receiver_sample> {
+  KOKKOS_INLINE_FUNCTION static acoustic_receiver_sample sum() {
+    return acoustic_receiver_sample();
+  }
+};
+} // namespace Kokkos
+
+specfem::Domain::Acoustic::Acoustic(
+    const int ndim, specfem::compute::compute *compute,
+    specfem::compute::properties *material_properties,
+    specfem::compute::partial_derivatives *partial_derivatives,
+    specfem::compute::sources *sources, specfem::compute::receivers *receivers,
+    specfem::quadrature::quadrature *quadx,
+    specfem::quadrature::quadrature *quadz,
+    const specfem::Domain::options &options, specfem::interfaces::halo *halo)
+    : compute(compute), material_properties(material_properties),
+      partial_derivatives(partial_derivatives), sources(sources),
+      receivers(receivers), quadx(quadx), quadz(quadz),
+      assembly(options.assembly), nshots(options.nshots) {
+
+  const auto h_ibool = compute->h_ibool;
+  const int nspec = h_ibool.extent(0);
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  const int nglob_mesh = specfem::utilities::compute_nglob(h_ibool);
+
+  if (this->nshots < 1) {
+    throw std::runtime_error("Number of shots must be positive");
+  }
+
+  // SH waves don't propagate inside fluids
+  if (options.wave != specfem::wave::p_sv) {
+    throw std::runtime_error("Acoustic domains only simulate P-SV waves");
+  }
+
+  // Interface points are numbered globally
+  if (halo != nullptr && halo->get_nneighbors() > 0) {
+    throw std::runtime_error(
+        "MPI interfaces are not implemented for acoustic domains");
+  }
+
+  if (options.packed_element_data || options.quantized_element_data ||
+      options.active_elements ||
+      (options.host_offload && !specfem::Domain::host_backend())) {
+    throw std::runtime_error("Packed element data, active elements and host "
+                             "offload are only implemented for elastic "
+                             "domains");
+  }
+
+  const int nsources_local = sources->h_shot_array.extent(0);
+  for (int isource = 0; isource < nsources_local; isource++) {
+    if (sources->h_shot_array(isource) < 0 ||
+        sources->h_shot_array(isource) >= this->nshots) {
+      throw std::runtime_error("Source belongs to a shot out of range");
+    }
+  }
+
+  // Receivers are stored shot after shot
+  if (receivers->ispec_array.extent(0) % this->nshots != 0) {
+    throw std::runtime_error(
+        "Every shot needs the same receivers on a process");
+  }
+
+  std::vector<int> elements;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    if (material_properties->h_ispec_type(ispec) ==
+        specfem::elements::acoustic) {
+      elements.push_back(ispec);
+    }
+  }
+  this->nelem_domain = elements.size();
+
+  // Points are numbered compactly in the order elements are visited, which
+  // keeps the locality of the element ordering of the mesh
+  std::vector<int> acoustic_number(nglob_mesh, -1);
+  std::vector<int> global_numbers;
+  for (const int ispec : elements) {
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int iglob = h_ibool(ispec, iz, ix);
+        if (acoustic_number[iglob] < 0) {
+          acoustic_number[iglob] = global_numbers.size();
+          global_numbers.push_back(iglob);
+        }
+      }
+    }
+  }
+  const int nglob = global_numbers.size();
+
+  // Elements of the same color do not share any point and are assembled
+  // without atomics
+  if (this->assembly == specfem::assembly::colored) {
+    auto [permutation, offsets] =
+        specfem::coloring::color_elements(h_ibool, elements);
+    const std::vector<int> unordered = elements;
+    for (int index = 0; index < this->nelem_domain; index++)
+      elements[index] = unordered[permutation[index]];
+    this->h_color_offsets = offsets;
+  } else {
+    this->h_color_offsets = { 0, this->nelem_domain };
+  }
+
+  this->ispec_domain = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Acoustic::ispec_domain", this->nelem_domain);
+  this->h_ispec_domain = Kokkos::create_mirror_view(ispec_domain);
+  this->element_index = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Acoustic::element_index", nspec);
+  this->ibool = specfem::kokkos::DeviceElementView3d<int>(
+      "specfem::Domain::Acoustic::ibool", this->nelem_domain, ngllz, ngllx);
+  this->global_index = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Acoustic::global_index", nglob);
+  this->h_global_index = Kokkos::create_mirror_view(global_index);
+
+  const auto h_element_index = Kokkos::create_mirror_view(element_index);
+  const auto h_acoustic_ibool = Kokkos::create_mirror_view(ibool);
+  for (int ispec = 0; ispec < nspec; ispec++)
+    h_element_index(ispec) = -1;
+  for (int ielement = 0; ielement < this->nelem_domain; ielement++) {
+    const int ispec = elements[ielement];
+    this->h_ispec_domain(ielement) = ispec;
+    h_element_index(ispec) = ielement;
+    for (int iz = 0; iz < ngllz; iz++)
+      for (int ix = 0; ix < ngllx; ix++)
+        h_acoustic_ibool(ielement, iz, ix) =
+            acoustic_number[h_ibool(ispec, iz, ix)];
+  }
+  for (int iglob = 0; iglob < nglob; iglob++)
+    this->h_global_index(iglob) = global_numbers[iglob];
+
+  // Kernels launch only over the sources and receivers of acoustic elements
+  std::vector<int> domain_sources;
+  for (int isource = 0; isource < sources->h_ispec_array.extent(0);
+       isource++) {
+    if (h_element_index(sources->h_ispec_array(isource)) >= 0)
+      domain_sources.push_back(isource);
+  }
+  std::vector<int> domain_receivers;
+  for (int irec = 0; irec < receivers->h_ispec_array.extent(0); irec++) {
+    if (h_element_index(receivers->h_ispec_array(irec)) >= 0)
+      domain_receivers.push_back(irec);
+  }
+  this->source_index = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Acoustic::source_index", domain_sources.size());
+  this->receiver_index = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Acoustic::receiver_index", domain_receivers.size());
+  const auto h_source_index = Kokkos::create_mirror_view(source_index);
+  const auto h_receiver_index = Kokkos::create_mirror_view(receiver_index);
+  for (int index = 0; index < domain_sources.size(); index++)
+    h_source_index(index) = domain_sources[index];
+  for (int index = 0; index < domain_receivers.size(); index++)
+    h_receiver_index(index) = domain_receivers[index];
+
+  Kokkos::deep_copy(ispec_domain, h_ispec_domain);
+  Kokkos::deep_copy(element_index, h_element_index);
+  Kokkos::deep_copy(source_index, h_source_index);
+  Kokkos::deep_copy(receiver_index, h_receiver_index);
+  Kokkos::deep_copy(ibool, h_acoustic_ibool);
+  Kokkos::deep_copy(global_index, h_global_index);
+
+  // Views are zero initialized
+  this->field = specfem::kokkos::DeviceFieldView2d<type_real>(
+      "specfem::Domain::Acoustic::field", nglob, this->nshots);
+  this->field_dot = specfem::kokkos::DeviceFieldView2d<type_real>(
+      "specfem::Domain::Acoustic::field_dot", nglob, this->nshots);
+  this->field_dot_dot = specfem::kokkos::DeviceFieldView2d<type_real>(
+      "specfem::Domain::Acoustic::field_dot_dot", nglob, this->nshots);
+  this->rmass_inverse = specfem::kokkos::DeviceView1d<type_real>(
+      "specfem::Domain::Acoustic::rmass_inverse", nglob);
+
+  this->assign_views();
+
+  // Points are first touched by the threads computing them in the stiffness
+  // kernels
+  this->place_fields(h_acoustic_ibool);
+
+  return;
+}
+
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::Domain::Acoustic::assign_views() {
+
+  const int ngllz = this->ibool.extent(1);
+  const int ngllx = this->ibool.extent(2);
+  const int nelem_domain = this->nelem_domain;
+  const int nglob = this->rmass_inverse.extent(0);
+  const auto ibool = this->ibool;
+  const auto ispec_domain = this->ispec_domain;
+  const auto rmass_inverse = this->rmass_inverse;
+
+  // The mass matrix of the potential is weighted by the inverse of the bulk
+  // modulus, which is lambdaplus2mu inside fluids
+  specfem::kokkos::DeviceScatterView1d<type_real> results(rmass_inverse);
+  const auto wxgll = quadx->get_w();
+  const auto wzgll = quadz->get_w();
+  const auto kappa = this->material_properties->get_lambdaplus2mu();
+  const auto jacobian = this->partial_derivatives->get_jacobian();
+  Kokkos::parallel_for(
+      "specfem::Domain::Acoustic::compute_mass_matrix",
+      specfem::kokkos::DeviceMDrange<3>({ 0, 0, 0 },
+                                        { nelem_domain, ngllz, ngllx }),
+      KOKKOS_LAMBDA(const int ielement, const int iz, const int ix) {
+        const int ispec = ispec_domain(ielement);
+        auto access = results.access();
+        access(ibool(ielement, iz, ix)) += wxgll(ix) * wzgll(iz) *
+                                           jacobian(ispec, iz, ix) /
+                                           kappa(ispec, iz, ix);
+      });
+
+  Kokkos::Experimental::contribute(rmass_inverse, results);
+
+  Kokkos::parallel_for(
+      "specfem::Domain::Acoustic::invert_mass_matrix",
+      specfem::kokkos::DeviceRange(0, nglob), KOKKOS_LAMBDA(const int iglob) {
+        if (rmass_inverse(iglob) > 0.0) {
+          rmass_inverse(iglob) = 1.0 / rmass_inverse(iglob);
+        } else {
+          rmass_inverse(iglob) = 1.0;
+        }
+      });
+
+  return;
+}
+
+void specfem::Domain::Acoustic::sync_field(specfem::sync::kind kind) {
+
+  const auto mirror = specfem::kokkos::lazy_mirror(this->h_field, this->field);
+
+  if (kind == specfem::sync::DeviceToHost) {
+    Kokkos::deep_copy(mirror, field);
+  } else if (kind == specfem::sync::HostToDevice) {
+    Kokkos::deep_copy(field, mirror);
+  } else {
+    throw std::runtime_error("Could not recognize the kind argument");
+  }
+
+  return;
+}
+
+void specfem::Domain::Acoustic::sync_field_dot(specfem::sync::kind kind) {
+
+  const auto mirror =
+      specfem::kokkos::lazy_mirror(this->h_field_dot, this->field_dot);
+
+  if (kind == specfem::sync::DeviceToHost) {
+    Kokkos::deep_copy(mirror, field_dot);
+  } else if (kind == specfem::sync::HostToDevice) {
+    Kokkos::deep_copy(field_dot, mirror);
+  } else {
+    throw std::runtime_error("Could not recognize the kind argument");
+  }
+
+  return;
+}
+
+void specfem::Domain::Acoustic::sync_field_dot_dot(specfem::sync::kind kind) {
+
+  const auto mirror =
+      specfem::kokkos::lazy_mirror(this->h_field_dot_dot, this->field_dot_dot);
+
+  if (kind == specfem::sync::DeviceToHost) {
+    Kokkos::deep_copy(mirror, field_dot_dot);
+  } else if (kind == specfem::sync::HostToDevice) {
+    Kokkos::deep_copy(field_dot_dot, mirror);
+  } else {
+    throw std::runtime_error("Could not recognize the kind argument");
+  }
+
+  return;
+}
+
+void specfem::Domain::Acoustic::sync_rmass_inverse(specfem::sync::kind kind) {
+
+  const auto mirror =
+      specfem::kokkos::lazy_mirror(this->h_rmass_inverse, this->rmass_inverse);
+
+  if (kind == specfem::sync::DeviceToHost) {
+    Kokkos::deep_copy(mirror, rmass_inverse);
+  } else if (kind == specfem::sync::HostToDevice) {
+    Kokkos::deep_copy(rmass_inverse, mirror);
+  } else {
+    throw std::runtime_error("Could not recognize the kind argument");
+  }
+
+  return;
+}
+
+specfem::first_touch::launches
+specfem::Domain::Acoustic::get_element_launches() const {
+
+  specfem::first_touch::launches launches;
+  const int ncolors = this->h_color_offsets.size() - 1;
+  for (int icolor = 0; icolor < ncolors; icolor++) {
+    std::vector<int> elements;
+    for (int index = this->h_color_offsets[icolor];
+         index < this->h_color_offsets[icolor + 1]; index++)
+      elements.push_back(this->h_ispec_domain(index));
+    launches.push_back(elements);
+  }
+
+  return launches;
+}
+
+void specfem::Domain::Acoustic::place_fields(
+    const specfem::kokkos::HostElementMirror3d<int> ibool) {
+
+  if (!specfem::Domain::host_backend())
+    return;
+
+  // The acoustic numbering is indexed by the position of the elements in
+  // ispec_domain
+  specfem::first_touch::launches elements;
+  const int ncolors = this->h_color_offsets.size() - 1;
+  for (int icolor = 0; icolor < ncolors; icolor++) {
+    std::vector<int> positions(this->h_color_offsets[icolor + 1] -
+                               this->h_color_offsets[icolor]);
+    std::iota(positions.begin(), positions.end(),
+              this->h_color_offsets[icolor]);
+    elements.push_back(positions);
+  }
+
+  const auto points = specfem::first_touch::point_launches(
+      elements, ibool, this->field.extent(0));
+  specfem::first_touch::place(this->field, points);
+  specfem::first_touch::place(this->field_dot, points);
+  specfem::first_touch::place(this->field_dot_dot, points);
+  specfem::first_touch::place(this->rmass_inverse, points);
+
+  this->h_field = {};
+  this->h_field_dot = {};
+  this->h_field_dot_dot = {};
+  this->h_rmass_inverse = {};
+
+  return;
+}
+
+specfem::memory::usage specfem::Domain::Acoustic::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->field, this->h_field);
+  usage.add(this->field_dot, this->h_field_dot);
+  usage.add(this->field_dot_dot, this->h_field_dot_dot);
+  usage.add(this->rmass_inverse, this->h_rmass_inverse);
+  usage.add(this->ispec_domain, this->h_ispec_domain);
+  usage.add(this->element_index);
+  usage.add(this->source_index);
+  usage.add(this->receiver_index);
+  usage.add(this->ibool);
+  usage.add(this->global_index, this->h_global_index);
+  usage += this->stacey.memory_usage();
+
+  return usage;
+}
+
+specfem::timers::cost
+specfem::Domain::Acoustic::get_cost(const specfem::timers::phase phase) const {
+  const double ngll = this->quadx->get_N();
+  const double ngll2 = ngll * ngll;
+  const double nshots = this->nshots;
+  constexpr double real = sizeof(type_real);
+  constexpr double index = sizeof(int);
+
+  specfem::timers::cost cost;
+  switch (phase) {
+  case specfem::timers::stiffness: {
+    // Every quadrature point reads its global index, geometry and density
+    // once, reads the potential and updates its second derivative of every
+    // shot
+    const double npoints = this->nelem_domain * ngll2;
+    cost.bytes = npoints * (index + (6 + 3 * nshots) * real);
+    cost.flops = npoints * nshots * (8 * ngll + 22);
+    break;
+  }
+  case specfem::timers::sources: {
+    const double npoints = this->source_index.extent(0) * ngll2;
+    cost.bytes = npoints * (index + 3 * real);
+    cost.flops = npoints * 3;
+    break;
+  }
+  case specfem::timers::seismograms: {
+    // Every receiver computes the gradient of one potential per seismogram
+    // type at every point of its element
+    const double npoints = this->receiver_index.extent(0) * ngll2;
+    const double ntypes = this->receivers->seismogram_types.extent(0);
+    cost.bytes = npoints * (index + (5 + ntypes) * real);
+    cost.flops = npoints * ntypes * (4 * ngll + 14);
+    break;
+  }
+  default:
+    break;
+  }
+
+  return cost;
+}
+
+void specfem::Domain::Acoustic::compute_stiffness_interaction(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  this->launch_stiffness_interaction(exec_space, nullptr);
+  this->stacey.compute_interaction(this->field_dot, this->field_dot_dot,
+                                   exec_space, nullptr);
+
+  return;
+}
+
+void specfem::Domain::Acoustic::compute_stiffness_interaction(
+    specfem::kokkos::DeviceGraphNode &node) {
+
+  this->launch_stiffness_interaction(specfem::kokkos::DevExecSpace(), &node);
+  this->stacey.compute_interaction(this->field_dot, this->field_dot_dot,
+                                   specfem::kokkos::DevExecSpace(), &node);
+
+  return;
+}
+
+void specfem::Domain::Acoustic::set_absorbing_boundary(
+    const specfem::boundaries::absorbing_boundary &abs_boundary) {
+
+  // Absorbing points are numbered with the acoustic numbering
+  this->stacey = specfem::boundaries::stacey(
+      abs_boundary, this->compute, this->material_properties, this->quadx,
+      this->quadz, specfem::elements::acoustic, specfem::wave::p_sv,
+      this->nshots, this->h_global_index);
+
+  return;
+}
+
+void specfem::Domain::Acoustic::set_pml(
+    const specfem::kokkos::HostView1d<int> region_CPML,
+    const specfem::boundaries::pml_layer &layer, const type_real f0,
+    const type_real reflection, const type_real dt) {
+
+  const auto ispec_type = this->material_properties->h_ispec_type;
+  for (int ispec = 0; ispec < region_CPML.extent(0); ispec++) {
+    if (region_CPML(ispec) != 0 &&
+        ispec_type(ispec) == specfem::elements::acoustic) {
+      throw std::runtime_error(
+          "PML layers are not implemented for acoustic elements");
+    }
+  }
+
+  return;
+}
+
+void specfem::Domain::Acoustic::launch_stiffness_interaction(
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  // Kernels are launched on the same execution space instance. Hence there is
+  // no need to fence between colors
+  const int ncolors = this->h_color_offsets.size() - 1;
+  for (int icolor = 0; icolor < ncolors; icolor++) {
+    const int istart = this->h_color_offsets[icolor];
+    const int iend = this->h_color_offsets[icolor + 1];
+    this->compute_stiffness_interaction_range(istart, iend, exec_space, node);
+  }
+
+  return;
+}
+
+void specfem::Domain::Acoustic::compute_stiffness_interaction_range(
+    const int istart, const int iend,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  if (istart >= iend)
+    return;
+
+  const int ngllx = this->quadx->get_N();
+  const int ngllz = this->quadz->get_N();
+  const int ngllxz = ngllx * ngllz;
+  const auto ibool = this->ibool;
+  const auto ispec_domain = this->ispec_domain;
+  const auto xix = this->partial_derivatives->get_xix();
+  const auto xiz = this->partial_derivatives->get_xiz();
+  const auto gammax = this->partial_derivatives->get_gammax();
+  const auto gammaz = this->partial_derivatives->get_gammaz();
+  const auto jacobian = this->partial_derivatives->get_jacobian();
+  const auto rho = this->material_properties->get_rho();
+  const auto wxgll = this->quadx->get_w();
+  const auto wzgll = this->quadz->get_w();
+  const auto hprime_xx = this->quadx->get_hprime();
+  const auto hprime_zz = this->quadz->get_hprime();
+  const auto hprimewgll_xx = this->quadx->get_hprimewgll();
+  const auto hprimewgll_zz = this->quadz->get_hprimewgll();
+  const auto field = this->field;
+  const auto field_dot_dot = this->field_dot_dot;
+  const bool use_atomics = (this->assembly == specfem::assembly::atomic);
+  const int nshots = this->nshots;
+
+  int scratch_size =
+      2 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllx, ngllx);
+  scratch_size +=
+      2 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllz, ngllz);
+  scratch_size +=
+      3 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllz, ngllx);
+
+  specfem::kokkos::DeviceTeam policy(exec_space, iend - istart, Kokkos::AUTO,
+                                     1);
+  policy.set_scratch_size(0, Kokkos::PerTeam(scratch_size));
+
+  specfem::kokkos::parallel_for(
+      "specfem::Domain::Acoustic::compute_forces", policy,
+      KOKKOS_LAMBDA(
+          const specfem::kokkos::DeviceTeam::member_type &team_member) {
+        const int ielement = istart + team_member.league_rank();
+        const int ispec = ispec_domain(ielement);
+
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprime_xx(
+            team_member.team_scratch(0), ngllx, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprime_zz(
+            team_member.team_scratch(0), ngllz, ngllz);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprimewgll_xx(
+            team_member.team_scratch(0), ngllx, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprimewgll_zz(
+            team_member.team_scratch(0), ngllz, ngllz);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_field(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempx1(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempx3(
+            team_member.team_scratch(0), ngllz, ngllx);
+
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team_member, ngllx * ngllx),
+            [=](const int ij) {
+              const int i = ij % ngllx;
+              const int j = ij / ngllx;
+              s_hprime_xx(j, i) = hprime_xx(j, i);
+              s_hprimewgll_xx(j, i) = hprimewgll_xx(j, i);
+            });
+
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team_member, ngllz * ngllz),
+            [=](const int ij) {
+              const int i = ij % ngllz;
+              const int j = ij / ngllz;
+              s_hprime_zz(j, i) = hprime_zz(j, i);
+              s_hprimewgll_zz(j, i) = hprimewgll_zz(j, i);
+            });
+
+        // Shots are computed one after the other. The barrier following the
+        // potential load also guarantees the contractions of the previous
+        // shot are done with the integrands
+        for (int ishot = 0; ishot < nshots; ishot++) {
+          Kokkos::parallel_for(Kokkos::TeamThreadRange(team_member, ngllxz),
+                               [=](const int xz) {
+                                 const int ix = xz % ngllx;
+                                 const int iz = xz / ngllx;
+                                 s_field(iz, ix) =
+                                     field(ibool(ielement, iz, ix), ishot);
+                               });
+
+          team_member.team_barrier();
+
+          // Gradient of potential divided by density, and its integrands
+          // along xi (tempx1) and gamma (tempx3)
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+                const int ix = xz % ngllx;
+                const int iz = xz / ngllx;
+
+                type_accum dchidxi = 0;
+                type_accum dchidgamma = 0;
+
+                for (int l = 0; l < ngllx; l++)
+                  dchidxi += s_hprime_xx(ix, l) * s_field(iz, l);
+
+                for (int l = 0; l < ngllz; l++)
+                  dchidgamma += s_hprime_zz(iz, l) * s_field(l, ix);
+
+                const type_real xixl = xix(ispec, iz, ix);
+                const type_real xizl = xiz(ispec, iz, ix);
+                const type_real gammaxl = gammax(ispec, iz, ix);
+                const type_real gammazl = gammaz(ispec, iz, ix);
+                const type_real jacobianl = jacobian(ispec, iz, ix);
+                const type_real rho_inversel = 1.0 / rho(ispec, iz, ix);
+
+                const type_accum dchidxl =
+                    rho_inversel * (xixl * dchidxi + gammaxl * dchidgamma);
+                const type_accum dchidzl =
+                    rho_inversel * (xizl * dchidxi + gammazl * dchidgamma);
+
+                s_tempx1(iz, ix) =
+                    jacobianl * (dchidxl * xixl + dchidzl * xizl);
+                s_tempx3(iz, ix) =
+                    jacobianl * (dchidxl * gammaxl + dchidzl * gammazl);
+              });
+
+          team_member.team_barrier();
+
+          // Weighted contractions and assembly into the second derivative
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+                const int ix = xz % ngllx;
+                const int iz = xz / ngllx;
+
+                type_accum tempx1 = 0;
+                type_accum tempx3 = 0;
+
+                for (int l = 0; l < ngllx; l++)
+                  tempx1 += s_hprimewgll_xx(ix, l) * s_tempx1(iz, l);
+
+                for (int l = 0; l < ngllz; l++)
+                  tempx3 += s_hprimewgll_zz(iz, l) * s_tempx3(l, ix);
+
+                const int iglob = ibool(ielement, iz, ix);
+                const type_real sum_terms =
+                    -1.0 * (wzgll(iz) * tempx1) -
+                    (wxgll(ix) * tempx3);
+                if (use_atomics) {
+                  Kokkos::atomic_add(&field_dot_dot(iglob, ishot), sum_terms);
+                } else {
+                  field_dot_dot(iglob, ishot) += sum_terms;
+                }
+              });
+        }
+      },
+      node);
+
+  return;
+}
+
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::Domain::Acoustic::divide_mass_matrix(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const auto rmass_inverse = this->rmass_inverse;
+  const auto field_dot_dot = this->field_dot_dot;
+  const int nglob = rmass_inverse.extent(0);
+  const int nshots = this->nshots;
+
+  Kokkos::parallel_for(
+      "specfem::Domain::Acoustic::divide_mass_matrix",
+      specfem::kokkos::DeviceRange(exec_space, 0, nglob),
+      KOKKOS_LAMBDA(const int iglob) {
+        const type_real rmass_inversel = rmass_inverse(iglob);
+        for (int ishot = 0; ishot < nshots; ishot++) {
+          field_dot_dot(iglob, ishot) =
+              field_dot_dot(iglob, ishot) * rmass_inversel;
+        }
+      });
+
+  return;
+}
+
+void specfem::Domain::Acoustic::compute_source_interaction(
+    const type_real timeval, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  this->launch_source_interaction(
+      timeval, specfem::kokkos::DeviceView1d<type_real>(), exec_space, nullptr);
+
+  return;
+}
+
+void specfem::Domain::Acoustic::compute_source_interaction(
+    const specfem::kokkos::DeviceView1d<type_real> timeval,
+    specfem::kokkos::DeviceGraphNode &node) {
+
+  this->launch_source_interaction(0.0, timeval, specfem::kokkos::DevExecSpace(),
+                                  &node);
+
+  return;
+}
+
+void specfem::Domain::Acoustic::launch_source_interaction(
+    const type_real timeval,
+    const specfem::kokkos::DeviceView1d<type_real> device_timeval,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  const int nsources = this->source_index.extent(0);
+  if (nsources == 0)
+    return;
+
+  const int ngllx = this->sources->hxis.extent(1);
+  const int ngllz = this->sources->hgammas.extent(1);
+  const int ngllxz = ngllx * ngllz;
+  const auto ispec_array = this->sources->ispec_array;
+  const auto stf_array = this->sources->stf_array;
+  const auto source_array = this->sources->source_array;
+  const auto dense_index = this->sources->dense_index;
+  const auto hxis = this->sources->hxis;
+  const auto hgammas = this->sources->hgammas;
+  const auto components = this->sources->components;
+  const auto shot_array = this->sources->shot_array;
+  const auto element_index = this->element_index;
+  const auto source_index = this->source_index;
+  const auto ibool = this->ibool;
+  const auto field_dot_dot = this->field_dot_dot;
+  // Recorded kernels are replayed, hence time is read on the device
+  const bool use_device_time = (node != nullptr);
+
+  // Tabulated source time functions are gathered from the table instead of
+  // being evaluated every step
+  const bool use_stf_table = this->sources->stf_tabulated();
+  if (use_stf_table) {
+    if (use_device_time && !this->sources->stf_table_resident()) {
+      throw std::runtime_error(
+          "Graph execution requires the source time function table to fit "
+          "on the device");
+    }
+    if (!use_device_time)
+      this->sources->update_stf_table(timeval);
+  }
+  const auto stf_table = this->sources->stf_table;
+  const type_real stf_table_t0 = this->sources->stf_table_t0;
+  const type_real stf_table_dt = this->sources->stf_table_dt;
+  const int stf_table_nsamples = this->sources->stf_table_nsamples;
+  const int stf_table_start = this->sources->stf_table_start;
+
+  // One team per source of an acoustic element. Sources sharing points are
+  // assembled using atomics
+  specfem::kokkos::DeviceTeam policy(exec_space, nsources, Kokkos::AUTO, 1);
+
+  specfem::kokkos::parallel_for(
+      "specfem::Domain::Acoustic::compute_source_interaction", policy,
+      KOKKOS_LAMBDA(
+          const specfem::kokkos::DeviceTeam::member_type &team_member) {
+        const int isource = source_index(team_member.league_rank());
+        const int ielement = element_index(ispec_array(isource));
+
+        const int ishot = shot_array(isource);
+        const int idense = dense_index(isource);
+        const type_real t = use_device_time ? device_timeval(0) : timeval;
+
+        type_real stf = 0.0;
+        Kokkos::single(
+            Kokkos::PerTeam(team_member),
+            [=](type_real &l_stf) {
+              if (use_stf_table) {
+                type_real weight;
+                const int isample =
+                    specfem::compute::stf_table_sample(
+                        t, stf_table_t0, stf_table_dt, stf_table_nsamples,
+                        weight) -
+                    stf_table_start;
+                l_stf = (1.0 - weight) * stf_table(isample, isource) +
+                        weight * stf_table(isample + 1, isource);
+              } else {
+                l_stf = stf_array(isource).T->compute(t);
+              }
+            },
+            stf);
+
+        // Pressure is the opposite of the second derivative of potential
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+              const int ix = xz % ngllx;
+              const int iz = xz / ngllx;
+              const type_real weight =
+                  (idense < 0) ? components(isource, 0) * hxis(isource, ix) *
+                                     hgammas(isource, iz)
+                               : source_array(idense, iz, ix, 0);
+              Kokkos::atomic_add(
+                  &field_dot_dot(ibool(ielement, iz, ix), ishot),
+                  -1.0 * weight * stf);
+            });
+      },
+      node);
+
+  return;
+}
+
+void specfem::Domain::Acoustic::compute_seismogram(
+    const int isig_step, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  this->launch_seismogram(isig_step, specfem::kokkos::DeviceView1d<int>(),
+                          exec_space, nullptr);
+}
+
+void specfem::Domain::Acoustic::compute_seismogram(
+    const specfem::kokkos::DeviceView1d<int> isig_step,
+    specfem::kokkos::DeviceGraphNode &node) {
+
+  this->launch_seismogram(0, isig_step, specfem::kokkos::DevExecSpace(), &node);
+}
+
+void specfem::Domain::Acoustic::launch_seismogram(
+    const int isig_step,
+    const specfem::kokkos::DeviceView1d<int> device_isig_step,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  if (this->receiver_index.extent(0) == 0)
+    return;
+
+  // The kernel is specialized on the fields read by the requested seismogram
+  // types
+  switch (this->receivers->seismogram_fields()) {
+  case 1:
+    this->launch_seismogram_fields<1>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  case 2:
+    this->launch_seismogram_fields<2>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  case 3:
+    this->launch_seismogram_fields<3>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  case 4:
+    this->launch_seismogram_fields<4>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  case 5:
+    this->launch_seismogram_fields<5>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  case 6:
+    this->launch_seismogram_fields<6>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  case 7:
+    this->launch_seismogram_fields<7>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  default:
+    break;
+  }
+
+  return;
+}
+
+template <int FIELDS>
+void specfem::Domain::Acoustic::launch_seismogram_fields(
+    const int isig_step,
+    const specfem::kokkos::DeviceView1d<int> device_isig_step,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  const int nreceivers = this->receivers->ispec_array.extent(0);
+  const int nreceivers_domain = this->receiver_index.extent(0);
+  const auto receiver_index = this->receiver_index;
+  const auto seismogram_types = this->receivers->seismogram_types;
+  const int nsigtype = seismogram_types.extent(0);
+  const auto ispec_array = this->receivers->ispec_array;
+  const auto hxir = this->receivers->hxir;
+  const auto hgammar = this->receivers->hgammar;
+  const auto cos_recs = this->receivers->cos_recs;
+  const auto sin_recs = this->receivers->sin_recs;
+  const auto element_index = this->element_index;
+  const auto ibool = this->ibool;
+  const int ngllz = ibool.extent(1);
+  const int ngllx = ibool.extent(2);
+  const int ngllxz = ngllx * ngllz;
+  const auto xix = this->partial_derivatives->get_xix();
+  const auto xiz = this->partial_derivatives->get_xiz();
+  const auto gammax = this->partial_derivatives->get_gammax();
+  const auto gammaz = this->partial_derivatives->get_gammaz();
+  const auto rho = this->material_properties->get_rho();
+  const auto hprime_xx = this->quadx->get_hprime();
+  const auto hprime_zz = this->quadz->get_hprime();
+  const auto seismogram = this->receivers->seismogram;
+  // Seismograms are stored in a ring buffer of nslots samples
+  const int nslots = seismogram.extent(0);
+  // Decimated seismograms filter the last ntaps recorded samples
+  const int decimation = this->receivers->decimation;
+  const int delay = this->receivers->filter_delay();
+  const auto filter = this->receivers->filter;
+  const auto history = this->receivers->history;
+  const int ntaps = 2 * delay + 1;
+  // Receivers are stored shot after shot
+  const int nreceivers_shot = nreceivers / this->nshots;
+  const auto field = this->field;
+  const auto field_dot = this->field_dot;
+  const auto field_dot_dot = this->field_dot_dot;
+  // Recorded kernels are replayed, hence seismogram step is read on the device
+  const bool use_device_step = (node != nullptr);
+
+  // Only the fields of requested seismograms are read
+  constexpr bool read_displacement =
+      FIELDS & (1 << specfem::seismogram::displacement);
+  constexpr bool read_velocity = FIELDS & (1 << specfem::seismogram::velocity);
+  constexpr bool read_acceleration =
+      FIELDS & (1 << specfem::seismogram::acceleration);
+
+  const int scratch_size =
+      3 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllz, ngllx);
+
+  specfem::kokkos::DeviceTeam policy(exec_space, nreceivers_domain,
+                                     Kokkos::AUTO, 1);
+  policy.set_scratch_size(0, Kokkos::PerTeam(scratch_size));
+
+  // Displacement, velocity and acceleration are the gradients of the
+  // potential and its derivatives divided by density. Gradients are computed
+  // at the quadrature points of the element and interpolated at the receiver
+  specfem::kokkos::parallel_for(
+      "specfem::Domain::Acoustic::compute_seismogram", policy,
+      KOKKOS_LAMBDA(
+          const specfem::kokkos::DeviceTeam::member_type &team_member) {
+        const int irec = receiver_index(team_member.league_rank());
+        const int ispec = ispec_array(irec);
+        const int ielement = element_index(ispec);
+        const int ishot = irec / nreceivers_shot;
+
+        specfem::kokkos::DeviceScratchView2d<type_real> s_field(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_field_dot(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_field_dot_dot(
+            team_member.team_scratch(0), ngllz, ngllx);
+
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+              const int ix = xz % ngllx;
+              const int iz = xz / ngllx;
+              const int iglob = ibool(ielement, iz, ix);
+              if (read_displacement)
+                s_field(iz, ix) = field(iglob, ishot);
+              if (read_velocity)
+                s_field_dot(iz, ix) = field_dot(iglob, ishot);
+              if (read_acceleration)
+                s_field_dot_dot(iz, ix) = field_dot_dot(iglob, ishot);
+            });
+
+        team_member.team_barrier();
+
+        acoustic_receiver_sample sample;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamThreadRange(team_member, ngllxz),
+            [=](const int xz, acoustic_receiver_sample &l_sample) {
+              const int ix = xz % ngllx;
+              const int iz = xz / ngllx;
+              const type_real xixl = xix(ispec, iz, ix);
+              const type_real xizl = xiz(ispec, iz, ix);
+              const type_real gammaxl = gammax(ispec, iz, ix);
+              const type_real gammazl = gammaz(ispec, iz, ix);
+              const type_real weight =
+                  hxir(irec, ix) * hgammar(irec, iz) / rho(ispec, iz, ix);
+
+              const auto add_gradient = [&](const auto &s_values,
+                                            const int itype) {
+                type_real dxi = 0.0;
+                type_real dgamma = 0.0;
+                for (int l = 0; l < ngllx; l++)
+                  dxi += hprime_xx(ix, l) * s_values(iz, l);
+                for (int l = 0; l < ngllz; l++)
+                  dgamma += hprime_zz(iz, l) * s_values(l, ix);
+                l_sample.value[itype][0] +=
+                    weight * (xixl * dxi + gammaxl * dgamma);
+                l_sample.value[itype][1] +=
+                    weight * (xizl * dxi + gammazl * dgamma);
+              };
+
+              if (read_displacement)
+                add_gradient(s_field, specfem::seismogram::displacement);
+              if (read_velocity)
+                add_gradient(s_field_dot, specfem::seismogram::velocity);
+              if (read_acceleration)
+                add_gradient(s_field_dot_dot,
+                             specfem::seismogram::acceleration);
+            },
+            sample);
+
+        const type_real cos_irec = cos_recs(irec);
+        const type_real sin_irec = sin_recs(irec);
+        const int isig = use_device_step ? device_isig_step(0) : isig_step;
+
+        const int isample =
+            specfem::compute::decimated_sample(isig, decimation, delay);
+
+        Kokkos::single(Kokkos::PerTeam(team_member), [=] {
+          for (int isigtype = 0; isigtype < nsigtype; isigtype++) {
+            const type_real vx = sample.value[seismogram_types(isigtype)][0];
+            const type_real vz = sample.value[seismogram_types(isigtype)][1];
+            type_real value[2];
+            value[0] = cos_irec * vx + sin_irec * vz;
+            value[1] = sin_irec * vx + cos_irec * vz;
+
+            if (decimation > 1) {
+              for (int icomp = 0; icomp < 2; icomp++)
+                history(isig % ntaps, isigtype, irec, icomp) = value[icomp];
+
+              // Samples before the first recorded sample are zero
+              if (isample >= 0) {
+                for (int icomp = 0; icomp < 2; icomp++) {
+                  type_real filtered = 0.0;
+                  for (int k = 0; k < ntaps && k <= isig; k++)
+                    filtered += filter(k) *
+                                history((isig - k) % ntaps, isigtype, irec,
+                                        icomp);
+                  value[icomp] = filtered;
+                }
+              }
+            }
+
+            if (isample >= 0) {
+              seismogram(isample % nslots, isigtype, irec, 0) = value[0];
+              seismogram(isample % nslots, isigtype, irec, 1) = value[1];
+            }
+          }
+        });
+      },
+      node);
+}
@@ -0,0 +1,633 @@
+#include "../include/adjoint.h"
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/domain.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/memory_report.h"
+#include "../include/quadrature.h"
+#include "../include/specfem_mpi.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+specfem::adjoint::revolve::revolve(const int nsteps, const int ncheckpoints)
+    : ncheckpoints(ncheckpoints), fine(nsteps), stored(ncheckpoints, 0) {
+  if (nsteps < 1) {
+    throw std::runtime_error(
+        "Adjoint simulations need at least one timestep");
+  }
+  if (ncheckpoints < 1) {
+    throw std::runtime_error(
+        "Adjoint simulations need at least one checkpoint");
+  }
+}
+
+specfem::adjoint::action::type specfem::adjoint::revolve::next() {
+
+  // Every step after capo is reversed, go back to the last checkpoint
+  if (this->fine == this->capo) {
+    if (this->check == -1 || this->capo == this->stored[0]) {
+      this->check--;
+      return specfem::adjoint::action::terminate;
+    }
+    this->capo = this->stored[this->check];
+    return specfem::adjoint::action::restore;
+  }
+
+  // The forward step from capo is followed by the adjoint step. A checkpoint
+  // storing capo isn't read anymore
+  if (this->fine - this->capo == 1) {
+    this->fine--;
+    if (this->check >= 0 && this->stored[this->check] == this->capo)
+      this->check--;
+    if (!this->turned) {
+      this->turned = true;
+      return specfem::adjoint::action::firsturn;
+    }
+    return specfem::adjoint::action::youturn;
+  }
+
+  if (this->check == -1) {
+    this->stored[0] = 0;
+    this->check = 0;
+    return specfem::adjoint::action::takeshot;
+  }
+
+  if (this->stored[this->check] != this->capo) {
+    this->check++;
+    if (this->check >= this->ncheckpoints) {
+      throw std::runtime_error(
+          "Revolve schedule needs more checkpoints than available");
+    }
+    this->stored[this->check] = this->capo;
+    return specfem::adjoint::action::takeshot;
+  }
+
+  // Advance to the optimal position of the next checkpoint. range is the
+  // smallest binomial(ds + reps, ds) covering the steps left, the other
+  // binomials are its neighbors along reps and ds
+  const int oldcapo = this->capo;
+  const std::int64_t ds = this->ncheckpoints - this->check;
+  const std::int64_t steps = this->fine - this->capo;
+  std::int64_t reps = 0;
+  std::int64_t range = 1;
+  while (range < steps) {
+    reps++;
+    range = range * (reps + ds) / reps;
+  }
+
+  const std::int64_t bino1 = range * reps / (ds + reps);
+  const std::int64_t bino2 = (ds > 1) ? bino1 * ds / (ds + reps - 1) : 1;
+  const std::int64_t bino3 =
+      (ds == 1) ? 0 : ((ds > 2) ? bino2 * (ds - 1) / (ds + reps - 2) : 1);
+  const std::int64_t bino4 = bino2 * (reps - 1) / ds;
+  const std::int64_t bino5 =
+      (ds < 3) ? 0 : ((ds > 3) ? bino3 * (ds - 2) / reps : 1);
+
+  if (steps <= bino1 + bino3) {
+    this->capo += bino4;
+  } else if (steps >= range - bino5) {
+    this->capo += bino1;
+  } else {
+    this->capo = this->fine - bino2 - bino3;
+  }
+
+  if (this->capo == oldcapo)
+    this->capo = oldcapo + 1;
+
+  return specfem::adjoint::action::advance;
+}
+
+std::int64_t specfem::adjoint::revolve::forward_steps(const int nsteps,
+                                                      const int ncheckpoints) {
+
+  // binomial(s + r, s) steps can be reversed with s checkpoints and r
+  // recomputations of every step
+  const std::int64_t s = ncheckpoints;
+  std::int64_t r = 0;
+  std::int64_t binomial = 1;
+  while (binomial < nsteps) {
+    r++;
+    binomial = binomial * (s + r) / r;
+  }
+
+  // binomial(s + r, r - 1) = binomial(s + r, s) r / (s + 1)
+  const std::int64_t saved = (r > 0) ? binomial * r / (s + 1) : 0;
+
+  return r * nsteps - saved + nsteps;
+}
+
+specfem::adjoint::quantizer::quantizer(const int nslots, const int nglob,
+                                       const int ncomponents, const int bits)
+    : bits(bits), nvalues(nglob * ncomponents) {
+
+  // Values don't straddle words
+  if (bits != 2 && bits != 4 && bits != 8 && bits != 16) {
+    std::ostringstream message;
+    message << "Compressed fields store 2, 4, 8 or 16 bits per value, not "
+            << bits;
+    throw std::runtime_error(message.str());
+  }
+
+  const int nblocks = (this->nvalues + block_size - 1) / block_size;
+  this->words = specfem::kokkos::DeviceView2d<std::uint32_t>(
+      "specfem::adjoint::quantizer::words", nslots,
+      nblocks * block_size * bits / 32);
+  this->scales = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::adjoint::quantizer::scales", nslots, nblocks);
+}
+
+type_real specfem::adjoint::quantizer::compress(
+    const int islot, const specfem::kokkos::DeviceFieldView2d<type_real> field,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const int bits = this->bits;
+  const int nvalues = this->nvalues;
+  const int ncomponents = field.extent(1);
+  const int nblocks = this->scales.extent(1);
+  const int values_per_word = 32 / bits;
+  const int words_per_block = block_size / values_per_word;
+  const type_real levels = (1 << (bits - 1)) - 1;
+  const auto words = this->words;
+  const auto scales = this->scales;
+
+  type_real error = 0.0;
+  type_real amplitude = 0.0;
+  Kokkos::parallel_reduce(
+      "specfem::adjoint::quantizer::compress",
+      Kokkos::RangePolicy<specfem::kokkos::DevExecSpace>(exec_space, 0,
+                                                         nblocks),
+      KOKKOS_LAMBDA(const int iblock, type_real &l_error,
+                    type_real &l_amplitude) {
+        const int first = iblock * block_size;
+        const int last =
+            (first + block_size < nvalues) ? first + block_size : nvalues;
+
+        type_real scale = 0.0;
+        for (int ivalue = first; ivalue < last; ivalue++) {
+          const type_real value =
+              Kokkos::fabs(field(ivalue / ncomponents, ivalue % ncomponents));
+          scale = (value > scale) ? value : scale;
+        }
+        scales(islot, iblock) = scale;
+        l_amplitude = (scale > l_amplitude) ? scale : l_amplitude;
+
+        for (int iword = 0; iword < words_per_block; iword++) {
+          std::uint32_t word = 0;
+          for (int j = 0; j < values_per_word; j++) {
+            const int ivalue = first + iword * values_per_word + j;
+            if (ivalue >= last)
+              break;
+            const type_real value =
+                field(ivalue / ncomponents, ivalue % ncomponents);
+            const int q =
+                (scale > 0.0)
+                    ? static_cast<int>(Kokkos::round(value / scale * levels))
+                    : 0;
+            const type_real lerror =
+                (scale > 0.0) ? Kokkos::fabs(value - q * scale / levels) : 0.0;
+            l_error = (lerror > l_error) ? lerror : l_error;
+            word |= static_cast<std::uint32_t>(q + levels) << (j * bits);
+          }
+          words(islot, iblock * words_per_block + iword) = word;
+        }
+      },
+      Kokkos::Max<type_real>(error), Kokkos::Max<type_real>(amplitude));
+
+  return (amplitude > 0.0) ? error / amplitude : 0.0;
+}
+
+void specfem::adjoint::quantizer::decompress(
+    const int islot, const specfem::kokkos::DeviceFieldView2d<type_real> field,
+    const specfem::kokkos::DevExecSpace &exec_space) const {
+
+  const int bits = this->bits;
+  const int ncomponents = field.extent(1);
+  const int values_per_word = 32 / bits;
+  const int words_per_block = block_size / values_per_word;
+  const int levels = (1 << (bits - 1)) - 1;
+  const std::uint32_t mask = (1u << bits) - 1;
+  const auto words = this->words;
+  const auto scales = this->scales;
+
+  Kokkos::parallel_for(
+      "specfem::adjoint::quantizer::decompress",
+      Kokkos::RangePolicy<specfem::kokkos::DevExecSpace>(exec_space, 0,
+                                                         this->nvalues),
+      KOKKOS_LAMBDA(const int ivalue) {
+        const int iblock = ivalue / block_size;
+        const int iword = iblock * words_per_block +
+                          (ivalue % block_size) / values_per_word;
+        const int j = ivalue % values_per_word;
+        const int q =
+            static_cast<int>((words(islot, iword) >> (j * bits)) & mask) -
+            levels;
+        field(ivalue / ncomponents, ivalue % ncomponents) =
+            q * scales(islot, iblock) / levels;
+      });
+
+  return;
+}
+
+std::size_t
+specfem::adjoint::quantizer::slot_size(const std::size_t nvalues,
+                                       const int bits) {
+  const std::size_t nblocks = (nvalues + block_size - 1) / block_size;
+  return nblocks * (block_size * bits / 8 + sizeof(type_real));
+}
+
+specfem::memory::usage specfem::adjoint::quantizer::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->words);
+  usage.add(this->scales);
+
+  return usage;
+}
+
+namespace {
+
+// Chunks are stored one after the other, every chunk storing chunk_size
+// timesteps even if the last one is partially recorded
+void write_chunk_file(
+    const std::string &filename, const std::size_t offset,
+    const specfem::kokkos::HostPinnedView3d<type_real> chunk) {
+  std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+  file.seekp(offset);
+  file.write(reinterpret_cast<const char *>(chunk.data()),
+             chunk.span() * sizeof(type_real));
+  if (!file) {
+    std::ostringstream message;
+    message << "Could not write absorbing tractions to " << filename;
+    throw std::runtime_error(message.str());
+  }
+}
+
+void read_chunk_file(const std::string &filename, const std::size_t offset,
+                     const specfem::kokkos::HostPinnedView3d<type_real> chunk) {
+  std::ifstream file(filename, std::ios::binary);
+  file.seekg(offset);
+  file.read(reinterpret_cast<char *>(chunk.data()),
+            chunk.span() * sizeof(type_real));
+  if (!file) {
+    std::ostringstream message;
+    message << "Could not read absorbing tractions from " << filename;
+    throw std::runtime_error(message.str());
+  }
+}
+
+} // namespace
+
+specfem::adjoint::boundary_storage::boundary_storage(
+    const int npoints, const int nvalues, const int nsteps,
+    const int chunk_size, const std::string &filename)
+    : npoints(npoints), nvalues(nvalues), nsteps(nsteps),
+      chunk_size(std::min(chunk_size, nsteps)), filename(filename) {
+
+  if (chunk_size < 1) {
+    throw std::runtime_error(
+        "Chunks of absorbing tractions need at least one timestep");
+  }
+
+  if (npoints == 0)
+    return;
+
+  this->copy_spaces = Kokkos::Experimental::partition_space(
+      specfem::kokkos::DevExecSpace(), 1, 1);
+  for (int islot = 0; islot < 2; islot++) {
+    this->buffer[islot] = specfem::kokkos::DeviceView3d<type_real>(
+        "specfem::adjoint::boundary_storage::buffer", this->chunk_size,
+        npoints, nvalues);
+    this->staging[islot] = specfem::kokkos::HostPinnedView3d<type_real>(
+        "specfem::adjoint::boundary_storage::staging", this->chunk_size,
+        npoints, nvalues);
+  }
+
+  const auto folder = std::filesystem::path(filename).parent_path();
+  if (!folder.empty())
+    std::filesystem::create_directories(folder);
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    std::ostringstream message;
+    message << "Could not create " << filename;
+    throw std::runtime_error(message.str());
+  }
+}
+
+specfem::adjoint::boundary_storage::~boundary_storage() {
+  if (this->pending.valid())
+    this->pending.wait();
+  if (this->npoints > 0)
+    std::remove(this->filename.c_str());
+}
+
+specfem::kokkos::DeviceView2d<type_real>
+specfem::adjoint::boundary_storage::record(
+    const int istep, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  if (this->npoints == 0)
+    return {};
+
+  const int ichunk = istep / this->chunk_size;
+  const int irow = istep % this->chunk_size;
+  if (irow == 0 && ichunk > 0)
+    this->write_chunk(ichunk - 1, exec_space);
+
+  return Kokkos::subview(this->buffer[ichunk % 2], irow, Kokkos::ALL,
+                         Kokkos::ALL);
+}
+
+void specfem::adjoint::boundary_storage::flush(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  if (this->npoints == 0)
+    return;
+
+  // The last chunk is replayed first, hence it stays in its device buffer
+  const int ichunk = (this->nsteps - 1) / this->chunk_size;
+  this->loaded = ichunk;
+  if (this->pending.valid())
+    this->pending.get();
+  if (ichunk == 0)
+    return;
+
+  this->prefetched = ichunk - 1;
+  const auto staging = this->staging[(ichunk - 1) % 2];
+  const std::size_t offset =
+      static_cast<std::size_t>(ichunk - 1) * staging.span() * sizeof(type_real);
+  this->pending =
+      std::async(std::launch::async, [staging, offset,
+                                      filename = this->filename]() {
+        read_chunk_file(filename, offset, staging);
+      });
+}
+
+specfem::kokkos::DeviceView2d<type_real>
+specfem::adjoint::boundary_storage::replay(
+    const int istep, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  if (this->npoints == 0)
+    return {};
+
+  const int ichunk = istep / this->chunk_size;
+  const int islot = ichunk % 2;
+  if (ichunk != this->loaded) {
+    // Rethrows errors of the background read
+    if (this->pending.valid())
+      this->pending.get();
+    const std::size_t bytes = this->staging[islot].span() * sizeof(type_real);
+    if (this->prefetched != ichunk) {
+      read_chunk_file(this->filename, ichunk * bytes, this->staging[islot]);
+    }
+    // The staging buffer is overwritten by the read of chunk ichunk - 2
+    Kokkos::deep_copy(exec_space, this->buffer[islot], this->staging[islot]);
+    exec_space.fence();
+    this->loaded = ichunk;
+
+    if (ichunk > 0) {
+      this->prefetched = ichunk - 1;
+      const auto staging = this->staging[(ichunk - 1) % 2];
+      const std::size_t offset = (ichunk - 1) * bytes;
+      this->pending =
+          std::async(std::launch::async, [staging, offset,
+                                          filename = this->filename]() {
+            read_chunk_file(filename, offset, staging);
+          });
+    }
+  }
+
+  return Kokkos::subview(this->buffer[islot], istep % this->chunk_size,
+                         Kokkos::ALL, Kokkos::ALL);
+}
+
+void specfem::adjoint::boundary_storage::write_chunk(
+    const int ichunk, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  // The copy instance reads the recorded tractions. Later timesteps record
+  // into the other buffer
+  const int islot = ichunk % 2;
+  exec_space.fence();
+  const auto &copy_space = this->copy_spaces[0];
+  const auto staging = this->staging[islot];
+  Kokkos::deep_copy(copy_space, staging, this->buffer[islot]);
+
+  // Chunks are written in order. Rethrows errors of the previous write
+  if (this->pending.valid())
+    this->pending.get();
+
+  const std::size_t offset =
+      static_cast<std::size_t>(ichunk) * staging.span() * sizeof(type_real);
+  this->pending =
+      std::async(std::launch::async, [copy_space, staging, offset,
+                                      filename = this->filename]() {
+        copy_space.fence();
+        write_chunk_file(filename, offset, staging);
+      });
+}
+
+std::size_t specfem::adjoint::boundary_storage::get_file_size() const {
+  if (this->npoints == 0)
+    return 0;
+  // The last chunk is never written
+  const std::size_t nchunks = (this->nsteps - 1) / this->chunk_size;
+  return nchunks * this->staging[0].span() * sizeof(type_real);
+}
+
+specfem::memory::usage
+specfem::adjoint::boundary_storage::memory_usage() const {
+  specfem::memory::usage usage;
+  for (int islot = 0; islot < 2; islot++) {
+    usage.add(this->buffer[islot]);
+    usage.add(this->staging[islot]);
+  }
+
+  return usage;
+}
+
+specfem::adjoint::kernels::kernels(
+    const specfem::compute::compute *compute,
+    const specfem::compute::partial_derivatives *partial_derivatives,
+    const specfem::compute::properties *properties,
+    const specfem::quadrature::quadrature *quadx,
+    const specfem::quadrature::quadrature *quadz,
+    const specfem::wave::type wave)
+    : compute(compute), partial_derivatives(partial_derivatives),
+      properties(properties), quadx(quadx), quadz(quadz), wave(wave) {
+
+  const int nspec = compute->h_ibool.extent(0);
+  const int ngllz = quadz->get_N();
+  const int ngllx = quadx->get_N();
+
+  this->rho = specfem::kokkos::DeviceElementView3d<type_real>(
+      "specfem::adjoint::kernels::rho", nspec, ngllz, ngllx);
+  this->kappa = specfem::kokkos::DeviceElementView3d<type_real>(
+      "specfem::adjoint::kernels::kappa", nspec, ngllz, ngllx);
+  this->mu = specfem::kokkos::DeviceElementView3d<type_real>(
+      "specfem::adjoint::kernels::mu", nspec, ngllz, ngllx);
+}
+
+void specfem::adjoint::kernels::accumulate(
+    const specfem::Domain::Domain *forward,
+    const specfem::Domain::Domain *adjoint, const type_real dt,
+    const specfem::kokkos::DevExecSpace &exec_space) const {
+
+  const int nspec = this->rho.extent(0);
+  const int ngllz = this->quadz->get_N();
+  const int ngllx = this->quadx->get_N();
+  const int ngllxz = ngllx * ngllz;
+  const auto ibool = this->compute->get_ibool();
+  const auto xix = this->partial_derivatives->get_xix();
+  const auto xiz = this->partial_derivatives->get_xiz();
+  const auto gammax = this->partial_derivatives->get_gammax();
+  const auto gammaz = this->partial_derivatives->get_gammaz();
+  const auto density = this->properties->get_rho();
+  const auto modulus = this->properties->get_mu();
+  const auto lambdaplus2mu = this->properties->get_lambdaplus2mu();
+  const auto hprime_xx = this->quadx->get_hprime();
+  const auto hprime_zz = this->quadz->get_hprime();
+  const auto field = forward->get_field();
+  const auto field_dot_dot = forward->get_field_dot_dot();
+  const auto adjoint_field = adjoint->get_field();
+  const auto rho_kernel = this->rho;
+  const auto kappa_kernel = this->kappa;
+  const auto mu_kernel = this->mu;
+  const bool p_sv = (this->wave == specfem::wave::p_sv);
+  const int ncomponents = p_sv ? 2 : 1;
+
+  // Every point belongs to a single element, kernels are updated without
+  // atomics
+  Kokkos::parallel_for(
+      "specfem::adjoint::kernels::accumulate",
+      Kokkos::RangePolicy<specfem::kokkos::DevExecSpace>(exec_space, 0,
+                                                         nspec * ngllxz),
+      KOKKOS_LAMBDA(const int ipoint) {
+        const int ispec = ipoint / ngllxz;
+        const int iz = (ipoint % ngllxz) / ngllx;
+        const int ix = ipoint % ngllx;
+
+        // Derivatives along xi and gamma of the forward (0) and adjoint (1)
+        // displacement components
+        type_real dxi[2][2] = { { 0.0, 0.0 }, { 0.0, 0.0 } };
+        type_real dgamma[2][2] = { { 0.0, 0.0 }, { 0.0, 0.0 } };
+        for (int icomp = 0; icomp < ncomponents; icomp++) {
+          for (int l = 0; l < ngllx; l++) {
+            const int iglob = ibool(ispec, iz, l);
+            dxi[0][icomp] += hprime_xx(ix, l) * field(iglob, icomp);
+            dxi[1][icomp] += hprime_xx(ix, l) * adjoint_field(iglob, icomp);
+          }
+          for (int l = 0; l < ngllz; l++) {
+            const int iglob = ibool(ispec, l, ix);
+            dgamma[0][icomp] += hprime_zz(iz, l) * field(iglob, icomp);
+            dgamma[1][icomp] +=
+                hprime_zz(iz, l) * adjoint_field(iglob, icomp);
+          }
+        }
+
+        const type_real xixl = xix(ispec, iz, ix);
+        const type_real xizl = xiz(ispec, iz, ix);
+        const type_real gammaxl = gammax(ispec, iz, ix);
+        const type_real gammazl = gammaz(ispec, iz, ix);
+
+        // Gradients of both fields, (du_0 / dx, du_0 / dz, du_1 / dx,
+        // du_1 / dz) where u_0 is x (P-SV) or y (SH)
+        type_real gradient[2][4];
+        for (int ifield = 0; ifield < 2; ifield++) {
+          for (int icomp = 0; icomp < ncomponents; icomp++) {
+            gradient[ifield][2 * icomp] =
+                xixl * dxi[ifield][icomp] + gammaxl * dgamma[ifield][icomp];
+            gradient[ifield][2 * icomp + 1] =
+                xizl * dxi[ifield][icomp] + gammazl * dgamma[ifield][icomp];
+          }
+        }
+
+        const int iglob = ibool(ispec, iz, ix);
+        const type_real rhol = density(ispec, iz, ix);
+        const type_real mul = modulus(ispec, iz, ix);
+
+        type_real acceleration = 0.0;
+        for (int icomp = 0; icomp < ncomponents; icomp++)
+          acceleration +=
+              adjoint_field(iglob, icomp) * field_dot_dot(iglob, icomp);
+        rho_kernel(ispec, iz, ix) -= rhol * acceleration * dt;
+
+        if (p_sv) {
+          const type_real kappal =
+              lambdaplus2mu(ispec, iz, ix) - 4.0 * mul / 3.0;
+          const type_real div = gradient[0][0] + gradient[0][3];
+          const type_real adjoint_div = gradient[1][0] + gradient[1][3];
+          const type_real shear = (gradient[0][1] + gradient[0][2]) *
+                                  (gradient[1][1] + gradient[1][2]) / 2.0;
+          const type_real deviatoric =
+              gradient[0][0] * gradient[1][0] +
+              gradient[0][3] * gradient[1][3] + shear -
+              div * adjoint_div / 3.0;
+          kappa_kernel(ispec, iz, ix) -= kappal * div * adjoint_div * dt;
+          mu_kernel(ispec, iz, ix) -= 2.0 * mul * deviatoric * dt;
+        } else {
+          mu_kernel(ispec, iz, ix) -=
+              mul *
+              (gradient[0][0] * gradient[1][0] +
+               gradient[0][1] * gradient[1][1]) *
+              dt;
+        }
+      });
+
+  return;
+}
+
+void specfem::adjoint::kernels::write(const std::string &output_folder,
+                                      const specfem::MPI::MPI *mpi) const {
+
+  const auto h_rho =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), this->rho);
+  const auto h_kappa =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), this->kappa);
+  const auto h_mu =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), this->mu);
+  const auto h_ibool = this->compute->h_ibool;
+  const auto coord = this->compute->coordinates.coord;
+
+  std::filesystem::create_directories(output_folder);
+  std::ostringstream filename;
+  filename << output_folder << "/proc" << mpi->get_rank() << "_kernels.dat";
+  std::ofstream stream(filename.str());
+
+  const int nspec = h_rho.extent(0);
+  const int ngllz = h_rho.extent(1);
+  const int ngllx = h_rho.extent(2);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int iglob = h_ibool(ispec, iz, ix);
+        stream << std::scientific << coord(0, iglob) << " " << coord(1, iglob)
+               << " " << h_rho(ispec, iz, ix) << " " << h_kappa(ispec, iz, ix)
+               << " " << h_mu(ispec, iz, ix) << "\n";
+      }
+    }
+  }
+
+  if (!stream) {
+    std::ostringstream message;
+    message << "Could not write kernel file " << filename.str();
+    throw std::runtime_error(message.str());
+  }
+
+  return;
+}
+
+specfem::memory::usage specfem::adjoint::kernels::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->rho);
+  usage.add(this->kappa);
+  usage.add(this->mu);
+
+  return usage;
+}
@@ -0,0 +1,49 @@
+#include "../include/arena.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cstddef>
+
+specfem::memory::arena::arena(const std::size_t chunk_bytes)
+    : chunk_bytes(chunk_bytes) {}
+
+specfem::memory::arena::~arena() {
+  for (auto &chunk : this->chunks)
+    Kokkos::kokkos_free<Kokkos::HostSpace>(chunk.data);
+}
+
+void *specfem::memory::arena::allocate_bytes(const std::size_t bytes) {
+  const std::size_t size = (bytes + alignment - 1) / alignment * alignment;
+
+  // Use the first chunk from the current position with enough space left
+  for (; this->ichunk < this->chunks.size(); this->ichunk++) {
+    auto &chunk = this->chunks[this->ichunk];
+    if (this->offset + size <= chunk.bytes) {
+      void *data = static_cast<char *>(chunk.data) + this->offset;
+      this->offset += size;
+      return data;
+    }
+    this->offset = 0;
+  }
+
+  // Kokkos host allocations are aligned to cache lines
+  const std::size_t chunk_size = std::max(this->chunk_bytes, size);
+  void *data = Kokkos::kokkos_malloc<Kokkos::HostSpace>(
+      "specfem::memory::arena::chunk", chunk_size);
+  this->chunks.push_back({ data, chunk_size });
+  this->ichunk = this->chunks.size() - 1;
+  this->offset = size;
+
+  return data;
+}
+
+void specfem::memory::arena::release(const position &mark) {
+  this->ichunk = mark.chunk;
+  this->offset = mark.offset;
+}
+
+std::size_t specfem::memory::arena::capacity() const {
+  std::size_t bytes = 0;
+  for (const auto &chunk : this->chunks)
+    bytes += chunk.bytes;
+  return bytes;
+}
@@ -0,0 +1,123 @@
+#include "../include/attenuation.h"
+#include "../include/config.h"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Contribution of a SLS with unit coefficient to Q^-1
+static double response(const double omega_sls, const double omega) {
+  return omega_sls * omega / (omega_sls * omega_sls + omega * omega);
+}
+
+// Frequency of index i of n frequencies spaced logarithmically in the band
+static double band_frequency(const double f0, const int i, const int n) {
+  if (n == 1)
+    return f0;
+  const double exponent = 2.0 * static_cast<double>(i) / (n - 1) - 1.0;
+  return f0 * std::pow(static_cast<double>(specfem::attenuation::band_ratio),
+                       exponent);
+}
+
+specfem::attenuation::model::model(const int n_sls, const type_real f0)
+    : n_sls(n_sls), f0(f0), omega(n_sls), coefficient(n_sls) {
+
+  if (n_sls < 1) {
+    std::ostringstream message;
+    message << "Attenuation needs at least 1 standard linear solid, got "
+            << n_sls;
+    throw std::runtime_error(message.str());
+  }
+
+  if (!(f0 > 0.0)) {
+    std::ostringstream message;
+    message << "Attenuation reference frequency must be positive, got " << f0;
+    throw std::runtime_error(message.str());
+  }
+
+  const double two_pi = 2.0 * M_PI;
+  std::vector<double> omega_sls(n_sls);
+  for (int l = 0; l < n_sls; l++)
+    omega_sls[l] = two_pi * band_frequency(f0, l, n_sls);
+
+  // Normal equations of the least squares fit of Q^-1 = 1
+  const int nfit = 2 * n_sls - 1;
+  std::vector<std::vector<double> > a(n_sls, std::vector<double>(n_sls + 1));
+  for (int k = 0; k < nfit; k++) {
+    const double omega_fit = two_pi * band_frequency(f0, k, nfit);
+    for (int l = 0; l < n_sls; l++) {
+      const double rl = response(omega_sls[l], omega_fit);
+      for (int m = 0; m < n_sls; m++)
+        a[l][m] += rl * response(omega_sls[m], omega_fit);
+      a[l][n_sls] += rl;
+    }
+  }
+
+  // Gaussian elimination with partial pivoting
+  for (int l = 0; l < n_sls; l++) {
+    int pivot = l;
+    for (int m = l + 1; m < n_sls; m++) {
+      if (std::abs(a[m][l]) > std::abs(a[pivot][l]))
+        pivot = m;
+    }
+    std::swap(a[l], a[pivot]);
+    for (int m = l + 1; m < n_sls; m++) {
+      const double factor = a[m][l] / a[l][l];
+      for (int n = l; n <= n_sls; n++)
+        a[m][n] -= factor * a[l][n];
+    }
+  }
+
+  std::vector<double> y(n_sls);
+  for (int l = n_sls - 1; l >= 0; l--) {
+    double sum = a[l][n_sls];
+    for (int m = l + 1; m < n_sls; m++)
+      sum -= a[l][m] * y[m];
+    y[l] = sum / a[l][l];
+  }
+
+  for (int l = 0; l < n_sls; l++) {
+    this->omega[l] = omega_sls[l];
+    this->coefficient[l] = y[l];
+  }
+}
+
+type_real specfem::attenuation::model::inverse_q(const type_real frequency,
+                                                 const type_real q) const {
+  const double omega = 2.0 * M_PI * frequency;
+  double sum = 0.0;
+  for (int l = 0; l < this->n_sls; l++)
+    sum += this->coefficient[l] * response(this->omega[l], omega);
+  return sum / q;
+}
+
+type_real specfem::attenuation::model::dispersion() const {
+  const double omega = 2.0 * M_PI * this->f0;
+  double sum = 0.0;
+  for (int l = 0; l < this->n_sls; l++) {
+    const double omega_sls = this->omega[l];
+    sum += this->coefficient[l] * omega_sls * omega_sls /
+           (omega_sls * omega_sls + omega * omega);
+  }
+  return sum;
+}
+
+std::string specfem::attenuation::model::print() const {
+  std::ostringstream message;
+  message << "Attenuation:\n"
+          << "------------------------------\n"
+          << "- Reference frequency : " << this->f0 << " Hz\n"
+          << "- Constant Q band : " << this->f0 / band_ratio << " - "
+          << this->f0 * band_ratio << " Hz\n"
+          << "- Standard linear solids (coarse grained) : " << this->n_sls
+          << "\n";
+  for (int l = 0; l < this->n_sls; l++) {
+    message << "    - SLS " << l << " : relaxation frequency = "
+            << this->omega[l] / (2.0 * M_PI)
+            << " Hz, coefficient = " << this->coefficient[l] << "\n";
+  }
+
+  return message.str();
+}
@@ -0,0 +1,208 @@
+#include "../include/autotune.h"
+#include "../include/kokkos_abstractions.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(KOKKOS_ENABLE_CUDA)
+#include <cuda_runtime.h>
+#elif defined(KOKKOS_ENABLE_HIP)
+#include <hip/hip_runtime.h>
+#endif
+
+std::string specfem::autotune::device_name() {
+
+  std::string name;
+#if defined(KOKKOS_ENABLE_CUDA)
+  cudaDeviceProp properties;
+  cudaGetDeviceProperties(&properties, Kokkos::Cuda().cuda_device());
+  name = properties.name;
+#elif defined(KOKKOS_ENABLE_HIP)
+  hipDeviceProp_t properties;
+  hipGetDeviceProperties(&properties, Kokkos::Experimental::HIP().hip_device());
+  name = properties.name;
+#else
+  // Host backends are keyed by the number of threads
+  std::ostringstream host;
+  host << specfem::kokkos::DevExecSpace::name() << "-"
+       << specfem::kokkos::DevExecSpace().concurrency();
+  name = host.str();
+#endif
+
+  std::replace_if(
+      name.begin(), name.end(),
+      [](const unsigned char c) { return std::isspace(c); }, '_');
+
+  return name;
+}
+
+specfem::autotune::cache::cache(const std::string &filename)
+    : filename(filename) {
+
+  std::ifstream stream(filename);
+  if (!stream.is_open())
+    return;
+
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::istringstream tokens(line);
+    std::string key;
+    specfem::autotune::config configuration;
+    if (tokens >> key >> configuration.team_size >>
+        configuration.scratch_level) {
+      this->configurations[key] = configuration;
+    }
+  }
+
+  return;
+}
+
+bool specfem::autotune::cache::find(
+    const std::string &key, specfem::autotune::config &configuration) const {
+
+  const auto entry = this->configurations.find(key);
+  if (entry == this->configurations.end())
+    return false;
+
+  configuration = entry->second;
+  return true;
+}
+
+void specfem::autotune::cache::insert(
+    const std::string &key, const specfem::autotune::config &configuration) {
+
+  this->configurations[key] = configuration;
+
+  if (this->filename.empty())
+    return;
+
+  std::ofstream stream(this->filename);
+  if (!stream.is_open()) {
+    std::ostringstream message;
+    message << "Could not write autotuning cache file " << this->filename;
+    throw std::runtime_error(message.str());
+  }
+
+  for (const auto &[entry_key, entry] : this->configurations) {
+    stream << entry_key << " " << entry.team_size << " "
+           << entry.scratch_level << "\n";
+  }
+
+  return;
+}
+
+specfem::autotune::kernel::kernel(const std::string &name, const int ngll,
+                                  const int nelem,
+                                  specfem::autotune::cache *tuning_cache)
+    : tuning_cache(tuning_cache) {
+
+  std::ostringstream key;
+  key << specfem::autotune::device_name() << "/" << name << "/ngll" << ngll
+      << "/nelem" << nelem;
+  this->key = key.str();
+
+  return;
+}
+
+specfem::autotune::config
+specfem::autotune::kernel::get_config(const int scratch_size,
+                                      const bool timed) {
+
+  if (!this->initialized) {
+    this->initialized = true;
+
+    // Untuned kernels and kernels found in the cache are never timed
+    if (this->tuning_cache == nullptr ||
+        this->tuning_cache->find(this->key, this->best))
+      return this->best;
+
+    // Device kernels try power of two team sizes. Teams on host backends are
+    // executed by a single thread, hence only the scratch level is tuned
+    std::vector<int> team_sizes = { 0 };
+    if (!Kokkos::SpaceAccessibility<Kokkos::HostSpace,
+                                    specfem::kokkos::DevMemSpace>::accessible) {
+      team_sizes.insert(team_sizes.end(), { 32, 64, 128, 256, 512, 1024 });
+    }
+
+    for (int scratch_level = 0; scratch_level < 2; scratch_level++) {
+      // Scratch level doesn't change kernels without scratch memory
+      if (scratch_level > 0 && scratch_size == 0)
+        continue;
+      if (scratch_size > specfem::kokkos::DeviceTeam::scratch_size_max(
+                             scratch_level))
+        continue;
+      for (const int team_size : team_sizes) {
+        specfem::autotune::config configuration;
+        configuration.team_size = team_size;
+        configuration.scratch_level = scratch_level;
+        this->candidates.push_back(configuration);
+      }
+    }
+
+    this->timings = std::vector<double>(this->candidates.size(),
+                                        std::numeric_limits<double>::max());
+
+    if (this->candidates.empty())
+      this->finalize();
+  }
+
+  if (this->tuning() && timed)
+    return this->candidates[this->icandidate];
+
+  if (this->tuning())
+    return specfem::autotune::config();
+
+  return this->best;
+}
+
+void specfem::autotune::kernel::record(const double time) {
+
+  if (!this->tuning())
+    return;
+
+  this->timings[this->icandidate] =
+      std::min(this->timings[this->icandidate], time);
+
+  this->ilaunch++;
+  if (this->ilaunch == nlaunch) {
+    this->ilaunch = 0;
+    this->icandidate++;
+    if (!this->tuning())
+      this->finalize();
+  }
+
+  return;
+}
+
+void specfem::autotune::kernel::reject() {
+
+  if (!this->tuning())
+    return;
+
+  this->ilaunch = 0;
+  this->icandidate++;
+  if (!this->tuning())
+    this->finalize();
+
+  return;
+}
+
+void specfem::autotune::kernel::finalize() {
+
+  if (!this->candidates.empty()) {
+    const auto fastest =
+        std::min_element(this->timings.begin(), this->timings.end());
+    if (*fastest < std::numeric_limits<double>::max())
+      this->best = this->candidates[fastest - this->timings.begin()];
+  }
+
+  this->tuning_cache->insert(this->key, this->best);
+
+  return;
+}
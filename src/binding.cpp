@@ -0,0 +1,358 @@
+#include "../include/binding.h"
+#include "../include/specfem_mpi.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#if defined(KOKKOS_ENABLE_CUDA)
+#include <cuda_runtime.h>
+#elif defined(KOKKOS_ENABLE_HIP)
+#include <hip/hip_runtime.h>
+#endif
+
+namespace {
+
+// Check if an argument starting with one of prefixes or one of the
+// environment variables is set
+bool is_set(const int argc, char **argv,
+            const std::vector<std::string> &prefixes,
+            const std::vector<std::string> &variables) {
+  for (int iarg = 1; iarg < argc; iarg++) {
+    for (const auto &prefix : prefixes) {
+      if (std::strncmp(argv[iarg], prefix.c_str(), prefix.size()) == 0)
+        return true;
+    }
+  }
+
+  for (const auto &variable : variables) {
+    if (std::getenv(variable.c_str()) != nullptr)
+      return true;
+  }
+
+  return false;
+}
+
+// Number of devices visible to this process before Kokkos is initialized
+int device_count() {
+  int ndevices = 0;
+#if defined(KOKKOS_ENABLE_CUDA)
+  if (cudaGetDeviceCount(&ndevices) != cudaSuccess)
+    ndevices = 0;
+#elif defined(KOKKOS_ENABLE_HIP)
+  if (hipGetDeviceCount(&ndevices) != hipSuccess)
+    ndevices = 0;
+#endif
+  return ndevices;
+}
+
+// Device used by Kokkos once it is initialized
+int current_device() {
+#if defined(KOKKOS_ENABLE_CUDA)
+  return Kokkos::Cuda().cuda_device();
+#elif defined(KOKKOS_ENABLE_HIP)
+  return Kokkos::Experimental::HIP().hip_device();
+#else
+  return -1;
+#endif
+}
+
+// Parse a Linux cpu list, e.g. 0-3,8-11
+std::vector<int> parse_cpulist(const std::string &list) {
+  std::vector<int> cpus;
+  std::istringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    const auto dash = range.find('-');
+    const int first = std::atoi(range.substr(0, dash).c_str());
+    const int last = (dash == std::string::npos)
+                         ? first
+                         : std::atoi(range.substr(dash + 1).c_str());
+    for (int cpu = first; cpu <= last; cpu++)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+// Format a list of cpus as ranges, e.g. 0-3,8-11
+std::string format_cpulist(const std::vector<int> &cpus) {
+  std::ostringstream list;
+  for (int i = 0; i < cpus.size();) {
+    int j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+      j++;
+    if (i > 0)
+      list << ",";
+    list << cpus[i];
+    if (j > i)
+      list << "-" << cpus[j];
+    i = j + 1;
+  }
+  return list.str();
+}
+
+// NUMA domain of every cpu. Cpus are in domain 0 if the topology is unknown
+std::vector<int> numa_domains(const int ncpus) {
+  std::vector<int> domains(ncpus, 0);
+  constexpr int max_domains = 1024;
+  for (int idomain = 0; idomain < max_domains; idomain++) {
+    std::ifstream stream("/sys/devices/system/node/node" +
+                         std::to_string(idomain) + "/cpulist");
+    if (!stream.is_open())
+      continue;
+    std::string list;
+    std::getline(stream, list);
+    for (const int cpu : parse_cpulist(list)) {
+      if (cpu < ncpus)
+        domains[cpu] = idomain;
+    }
+  }
+  return domains;
+}
+
+// Cores assigned to this process. Empty if the affinity is kept
+std::vector<int> assign_cpus(const specfem::MPI::MPI *mpi) {
+#if defined(__linux__)
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  if (sched_getaffinity(0, sizeof(mask), &mask) != 0)
+    return {};
+
+  const int ncpus_online = sysconf(_SC_NPROCESSORS_ONLN);
+  std::vector<int> allowed;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &mask))
+      allowed.push_back(cpu);
+  }
+
+  // The launcher bound this process, or there is nothing to split
+  if (static_cast<int>(allowed.size()) < ncpus_online ||
+      mpi->get_node_size() == 1)
+    return {};
+
+  const auto domains = numa_domains(CPU_SETSIZE);
+  std::stable_sort(allowed.begin(), allowed.end(),
+                   [&domains](const int a, const int b) {
+                     return domains[a] < domains[b];
+                   });
+
+  // Oversubscribed nodes share cores between processes
+  const int nallowed = allowed.size();
+  const int node_size = mpi->get_node_size();
+  const int node_rank = mpi->get_node_rank();
+  if (nallowed < node_size)
+    return { allowed[node_rank % nallowed] };
+
+  const int ncpus = nallowed / node_size;
+  std::vector<int> cpus(allowed.begin() + node_rank * ncpus,
+                        allowed.begin() + (node_rank + 1) * ncpus);
+  std::sort(cpus.begin(), cpus.end());
+  return cpus;
+#else
+  return {};
+#endif
+}
+
+// NUMA domains the host threads run on, and true if every thread is bound to
+// the cores of a single NUMA domain. Every thread of the pool runs one
+// iteration of a static range policy with an iteration per thread
+std::tuple<std::vector<int>, bool> thread_domains(const int nthreads) {
+#if defined(__linux__)
+  const auto domains = numa_domains(CPU_SETSIZE);
+  std::vector<int> current(nthreads, -1);
+  std::vector<int> bound(nthreads, 1);
+
+  Kokkos::parallel_for(
+      "specfem::binding::thread_domains",
+      Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(0, nthreads),
+      [&](const int ithread) {
+        const int cpu = sched_getcpu();
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+          current[ithread] = domains[cpu];
+
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (sched_getaffinity(0, sizeof(mask), &mask) != 0) {
+          bound[ithread] = 0;
+          return;
+        }
+        int domain = -1;
+        for (int icpu = 0; icpu < CPU_SETSIZE; icpu++) {
+          if (!CPU_ISSET(icpu, &mask))
+            continue;
+          if (domain < 0)
+            domain = domains[icpu];
+          else if (domains[icpu] != domain)
+            bound[ithread] = 0;
+        }
+      });
+  Kokkos::fence();
+
+  std::vector<int> used;
+  for (const int domain : current) {
+    if (domain >= 0)
+      used.push_back(domain);
+  }
+  std::sort(used.begin(), used.end());
+  used.erase(std::unique(used.begin(), used.end()), used.end());
+
+  return { used, std::all_of(bound.begin(), bound.end(),
+                             [](const int value) { return value == 1; }) };
+#else
+  return { {}, false };
+#endif
+}
+
+} // namespace
+
+specfem::binding::mapping
+specfem::binding::compute_mapping(const int argc, char **argv,
+                                  const specfem::MPI::MPI *mpi) {
+
+  specfem::binding::mapping map;
+  map.node_rank = mpi->get_node_rank();
+
+#if defined(__linux__)
+  char hostname[256] = { 0 };
+  if (gethostname(hostname, sizeof(hostname) - 1) == 0)
+    map.hostname = hostname;
+#endif
+
+  map.ndevices = device_count();
+  const bool device_set =
+      is_set(argc, argv,
+             { "--kokkos-device-id", "--device-id", "--kokkos-num-devices",
+               "--num-devices" },
+             { "KOKKOS_DEVICE_ID", "KOKKOS_NUM_DEVICES" });
+  if (map.ndevices > 0 && !device_set)
+    map.device_id = map.node_rank % map.ndevices;
+
+  map.cpus = assign_cpus(mpi);
+
+  return map;
+}
+
+specfem::binding::mapping
+specfem::binding::initialize(int &argc, char **argv,
+                             const specfem::MPI::MPI *mpi) {
+
+  auto map = specfem::binding::compute_mapping(argc, argv, mpi);
+
+  // Host threads inherit the affinity of the process. Threads are bound to
+  // consecutive cores, hence contiguous blocks of elements computed by
+  // consecutive threads share a NUMA domain
+#if defined(__linux__)
+  if (!map.cpus.empty()) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (const int cpu : map.cpus)
+      CPU_SET(cpu, &mask);
+    if (sched_setaffinity(0, sizeof(mask), &mask) != 0)
+      map.cpus.clear();
+  }
+  setenv("OMP_PROC_BIND", "close", 0);
+  setenv("OMP_PLACES", "cores", 0);
+#endif
+
+  std::vector<std::string> extra_arguments;
+  if (map.device_id >= 0)
+    extra_arguments.push_back("--kokkos-device-id=" +
+                              std::to_string(map.device_id));
+
+  const bool threads_set =
+      is_set(argc, argv, { "--kokkos-num-threads", "--kokkos-threads" },
+             { "OMP_NUM_THREADS", "KOKKOS_NUM_THREADS" });
+  if (!map.cpus.empty() && !threads_set)
+    extra_arguments.push_back("--kokkos-num-threads=" +
+                              std::to_string(map.cpus.size()));
+
+  // Kokkos removes the arguments it recognizes, including extra arguments
+  std::vector<char *> arguments(argv, argv + argc);
+  for (auto &argument : extra_arguments)
+    arguments.push_back(&argument[0]);
+  int narguments = arguments.size();
+  arguments.push_back(nullptr);
+
+  Kokkos::initialize(narguments, arguments.data());
+
+  const std::vector<char *> original(argv, argv + argc);
+  int iarg = 0;
+  for (int i = 0; i < narguments; i++) {
+    if (std::find(original.begin(), original.end(), arguments[i]) !=
+        original.end())
+      argv[iarg++] = arguments[i];
+  }
+  argc = iarg;
+  argv[argc] = nullptr;
+
+  if (map.ndevices > 0)
+    map.device_id = current_device();
+
+  map.nthreads = Kokkos::DefaultHostExecutionSpace().concurrency();
+  std::tie(map.thread_domains, map.threads_bound) =
+      thread_domains(map.nthreads);
+
+  return map;
+}
+
+std::string specfem::binding::print(const specfem::binding::mapping &map,
+                                    const specfem::MPI::MPI *mpi) {
+
+  std::ostringstream line;
+  line << "Rank " << mpi->get_rank() << " : node " << map.hostname
+       << ", local rank " << map.node_rank << ", ";
+  if (map.device_id >= 0) {
+    line << "device " << map.device_id << " of " << map.ndevices;
+  } else {
+    line << "host";
+  }
+  line << ", cores "
+       << (map.cpus.empty() ? std::string("set by launcher")
+                            : format_cpulist(map.cpus));
+  line << ", " << map.nthreads << " host threads";
+  if (!map.thread_domains.empty())
+    line << " on NUMA domains " << format_cpulist(map.thread_domains);
+  if (!map.threads_bound && map.nthreads > 1)
+    line << " (threads not bound to a NUMA domain, set OMP_PROC_BIND and "
+            "OMP_PLACES)";
+  if (map.ndevices > 0 && mpi->get_node_size() > map.ndevices)
+    line << " (devices shared by " << mpi->get_node_size()
+         << " local ranks)";
+  line << "\n";
+
+  std::string lines = line.str();
+#ifdef MPI_PARALLEL
+  int length = lines.size();
+  std::vector<int> lengths(mpi->get_size());
+  MPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT,
+             mpi->get_main(), mpi->get_comm());
+
+  std::vector<int> offsets(mpi->get_size() + 1, 0);
+  for (int rank = 0; rank < mpi->get_size(); rank++)
+    offsets[rank + 1] = offsets[rank] + lengths[rank];
+
+  std::vector<char> buffer(offsets.back());
+  MPI_Gatherv(lines.data(), length, MPI_CHAR, buffer.data(), lengths.data(),
+              offsets.data(), MPI_CHAR, mpi->get_main(), mpi->get_comm());
+  if (mpi->main_proc())
+    lines.assign(buffer.begin(), buffer.end());
+#endif
+
+  std::ostringstream message;
+  message << "Process binding:\n"
+          << "-------------------------------\n"
+          << lines;
+
+  return message.str();
+}
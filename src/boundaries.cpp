@@ -53,12 +53,12 @@ void find_corners(const specfem::kokkos::HostView1d<int> numabs,
     assert(ncorner_all <= 4);
 }
 
-void calculate_ib(const specfem::kokkos::HostView2d<bool> code,
-                  specfem::kokkos::HostView1d<int> ib_bottom,
-                  specfem::kokkos::HostView1d<int> ib_top,
-                  specfem::kokkos::HostView1d<int> ib_left,
-                  specfem::kokkos::HostView1d<int> ib_right,
-                  const int nelements) {
+void specfem::boundaries::calculate_ib(
+    const specfem::kokkos::HostView2d<bool> code,
+    specfem::kokkos::HostView1d<int> ib_bottom,
+    specfem::kokkos::HostView1d<int> ib_top,
+    specfem::kokkos::HostView1d<int> ib_left,
+    specfem::kokkos::HostView1d<int> ib_right, const int nelements) {
 
   int nspec_left = 0, nspec_right = 0, nspec_top = 0, nspec_bottom = 0;
   for (int inum = 0; inum < nelements; inum++) {
@@ -189,22 +189,22 @@ specfem::boundaries::absorbing_boundary::absorbing_boundary(
       }
     }
   } else {
-    this->numabs(1) = 0;
-    this->abs_boundary_type(1) = 0;
-    this->ibegin_edge1(1) = 0;
-    this->ibegin_edge2(1) = 0;
-    this->ibegin_edge3(1) = 0;
-    this->ibegin_edge4(1) = 0;
-    this->iend_edge1(1) = 0;
-    this->iend_edge2(1) = 0;
-    this->iend_edge3(1) = 0;
-    this->iend_edge4(1) = 0;
-    this->ib_bottom(1) = 0;
-    this->ib_left(1) = 0;
-    this->ib_top(1) = 0;
-    this->ib_right(1) = 0;
-    this->codeabs(1, 1) = false;
-    this->codeabscorner(1, 1) = false;
+    this->numabs(0) = 0;
+    this->abs_boundary_type(0) = 0;
+    this->ibegin_edge1(0) = 0;
+    this->ibegin_edge2(0) = 0;
+    this->ibegin_edge3(0) = 0;
+    this->ibegin_edge4(0) = 0;
+    this->iend_edge1(0) = 0;
+    this->iend_edge2(0) = 0;
+    this->iend_edge3(0) = 0;
+    this->iend_edge4(0) = 0;
+    this->ib_bottom(0) = 0;
+    this->ib_left(0) = 0;
+    this->ib_top(0) = 0;
+    this->ib_right(0) = 0;
+    this->codeabs(0, 0) = false;
+    this->codeabscorner(0, 0) = false;
   }
   return;
 }
@@ -296,27 +296,27 @@ specfem::boundaries::forcing_boundary::forcing_boundary(
       }
     }
   } else {
-    this->numacforcing(1) = 0;
-    this->typeacforcing(1) = 0;
-    this->ibegin_edge1(1) = 0;
-    this->ibegin_edge2(1) = 0;
-    this->ibegin_edge3(1) = 0;
-    this->ibegin_edge4(1) = 0;
-    this->iend_edge1(1) = 0;
-    this->iend_edge2(1) = 0;
-    this->iend_edge3(1) = 0;
-    this->iend_edge4(1) = 0;
-    this->ib_bottom(1) = 0;
-    this->ib_left(1) = 0;
-    this->ib_top(1) = 0;
-    this->ib_right(1) = 0;
-    this->codeacforcing(1, 1) = false;
+    this->numacforcing(0) = 0;
+    this->typeacforcing(0) = 0;
+    this->ibegin_edge1(0) = 0;
+    this->ibegin_edge2(0) = 0;
+    this->ibegin_edge3(0) = 0;
+    this->ibegin_edge4(0) = 0;
+    this->iend_edge1(0) = 0;
+    this->iend_edge2(0) = 0;
+    this->iend_edge3(0) = 0;
+    this->iend_edge4(0) = 0;
+    this->ib_bottom(0) = 0;
+    this->ib_left(0) = 0;
+    this->ib_top(0) = 0;
+    this->ib_right(0) = 0;
+    this->codeacforcing(0, 0) = false;
   }
   return;
 }
 
 specfem::boundaries::absorbing_boundary::absorbing_boundary(
-    std::ifstream &stream, int num_abs_boundary_faces, const int nspec,
+    std::istream &stream, int num_abs_boundary_faces, const int nspec,
     const specfem::MPI::MPI *mpi) {
 
   // I have to do this because std::vector<bool> is a fake container type that
@@ -369,15 +369,16 @@ specfem::boundaries::absorbing_boundary::absorbing_boundary(
                  num_abs_boundary_faces, mpi);
 
     // populate ib_bottom, ib_top, ib_left, ib_right arrays
-    calculate_ib(this->codeabs, this->ib_bottom, this->ib_top, this->ib_left,
-                 this->ib_right, num_abs_boundary_faces);
+    specfem::boundaries::calculate_ib(this->codeabs, this->ib_bottom,
+                                      this->ib_top, this->ib_left,
+                                      this->ib_right, num_abs_boundary_faces);
   }
 
   return;
 }
 
 specfem::boundaries::forcing_boundary::forcing_boundary(
-    std::ifstream &stream, const int nelement_acforcing, const int nspec,
+    std::istream &stream, const int nelement_acforcing, const int nspec,
     const specfem::MPI::MPI *mpi) {
   bool codeacread1 = true, codeacread2 = true, codeacread3 = true,
        codeacread4 = true;
@@ -421,8 +422,9 @@ specfem::boundaries::forcing_boundary::forcing_boundary(
   }
 
   // populate ib_bottom, ib_top, ib_left, ib_right arrays
-  calculate_ib(this->codeacforcing, this->ib_bottom, this->ib_top,
-               this->ib_left, this->ib_right, nelement_acforcing);
+  specfem::boundaries::calculate_ib(this->codeacforcing, this->ib_bottom,
+                                    this->ib_top, this->ib_left,
+                                    this->ib_right, nelement_acforcing);
 
   return;
 }
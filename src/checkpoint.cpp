@@ -0,0 +1,289 @@
+#include "../include/checkpoint.h"
+#include "../include/compute.h"
+#include "../include/domain.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/specfem_mpi.h"
+#include "../include/timescheme.h"
+#include "../include/writer.h"
+#include <Kokkos_Core.hpp>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Increment when the layout of checkpoint files changes
+constexpr std::uint32_t version = 2;
+constexpr char magic[8] = { 'S', 'P', 'E', 'C', 'F', 'E', 'M', 'R' };
+
+// Number of timesteps between checks of SIGTERM
+constexpr int signal_interval = 10;
+
+volatile std::sig_atomic_t terminate_received = 0;
+
+extern "C" void handle_terminate(int) { terminate_received = 1; }
+
+struct header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t real_size; ///< Size of type_real in bytes
+  std::int32_t nglob, ncomponents;
+  std::int32_t seismogram_extents[4];
+  std::int32_t history_extents[4]; ///< Recorded samples of decimated
+                                   ///< seismograms
+  std::int32_t istep, isig_step, nflushed;
+  double current_time;
+};
+
+template <typename ViewType> std::size_t bytes(const ViewType &view) {
+  return view.span() * sizeof(typename ViewType::value_type);
+}
+
+} // namespace
+
+specfem::checkpoint::checkpoint::checkpoint(
+    const std::string &directory, const int nstep_between_checkpoints,
+    specfem::Domain::Domain *domain,
+    specfem::compute::receivers *compute_receivers,
+    specfem::writer::writer *writer, const specfem::MPI::MPI *mpi)
+    : nstep_between_checkpoints(nstep_between_checkpoints), domain(domain),
+      compute_receivers(compute_receivers), writer(writer), mpi(mpi),
+      copy_space(Kokkos::Experimental::partition_space(
+          specfem::kokkos::DevExecSpace(), 1)[0]) {
+
+  if (nstep_between_checkpoints < 0) {
+    throw std::runtime_error(
+        "Number of timesteps between checkpoints must be positive");
+  }
+
+  std::ostringstream filename;
+  filename << directory << "/checkpoint_" << mpi->get_rank() << ".bin";
+  this->filename = filename.str();
+
+  std::signal(SIGTERM, handle_terminate);
+}
+
+specfem::checkpoint::checkpoint::~checkpoint() {
+  if (this->pending.valid())
+    this->pending.wait();
+}
+
+bool specfem::checkpoint::checkpoint::checkpoint_step(const int istep) {
+
+  // Every process stops at the same timestep
+  if (istep % signal_interval == 0 &&
+      this->mpi->all_reduce(static_cast<int>(terminate_received),
+                            specfem::MPI::max) > 0) {
+    this->stop = true;
+    return true;
+  }
+
+  return this->nstep_between_checkpoints > 0 &&
+         (istep + 1) % this->nstep_between_checkpoints == 0;
+}
+
+void specfem::checkpoint::checkpoint::write(
+    const specfem::TimeScheme::state &state,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  // Rethrows errors of the previous checkpoint
+  this->wait();
+
+  const auto field = this->domain->get_field();
+  const int nglob = field.extent(0);
+  const int ncomponents = field.extent(1);
+  const auto d_seismogram = this->compute_receivers->seismogram;
+  const auto d_history = this->compute_receivers->history;
+
+  if (!this->fields.is_allocated()) {
+    this->fields = specfem::kokkos::DeviceView3d<type_real>(
+        "specfem::checkpoint::fields", 3, nglob, ncomponents);
+    this->h_fields = specfem::kokkos::HostPinnedView3d<type_real>(
+        "specfem::checkpoint::h_fields", 3, nglob, ncomponents);
+    this->seismogram = specfem::kokkos::DeviceView4d<type_real>(
+        "specfem::checkpoint::seismogram", d_seismogram.extent(0),
+        d_seismogram.extent(1), d_seismogram.extent(2),
+        d_seismogram.extent(3));
+    this->h_seismogram = specfem::kokkos::HostPinnedView4d<type_real>(
+        "specfem::checkpoint::h_seismogram", d_seismogram.extent(0),
+        d_seismogram.extent(1), d_seismogram.extent(2),
+        d_seismogram.extent(3));
+    this->history = specfem::kokkos::DeviceView4d<type_real>(
+        "specfem::checkpoint::history", d_history.extent(0),
+        d_history.extent(1), d_history.extent(2), d_history.extent(3));
+    this->h_history = specfem::kokkos::HostPinnedView4d<type_real>(
+        "specfem::checkpoint::h_history", d_history.extent(0),
+        d_history.extent(1), d_history.extent(2), d_history.extent(3));
+  }
+
+  // Device copies are read by the copy instance while the time loop updates
+  // the fields
+  Kokkos::deep_copy(
+      exec_space, Kokkos::subview(this->fields, 0, Kokkos::ALL, Kokkos::ALL),
+      field);
+  Kokkos::deep_copy(
+      exec_space, Kokkos::subview(this->fields, 1, Kokkos::ALL, Kokkos::ALL),
+      this->domain->get_field_dot());
+  Kokkos::deep_copy(
+      exec_space, Kokkos::subview(this->fields, 2, Kokkos::ALL, Kokkos::ALL),
+      this->domain->get_field_dot_dot());
+  Kokkos::deep_copy(exec_space, this->seismogram, d_seismogram);
+  Kokkos::deep_copy(exec_space, this->history, d_history);
+  exec_space.fence();
+
+  Kokkos::deep_copy(this->copy_space, this->h_fields, this->fields);
+  Kokkos::deep_copy(this->copy_space, this->h_seismogram, this->seismogram);
+  Kokkos::deep_copy(this->copy_space, this->h_history, this->history);
+
+  // Samples flushed before the checkpoint are complete on disk
+  int nflushed = 0;
+  if (this->writer) {
+    this->writer->wait();
+    nflushed = this->writer->get_nflushed();
+  }
+
+  header head;
+  std::memcpy(head.magic, magic, sizeof(magic));
+  head.version = version;
+  head.real_size = sizeof(type_real);
+  head.nglob = nglob;
+  head.ncomponents = ncomponents;
+  for (int i = 0; i < 4; i++) {
+    head.seismogram_extents[i] = d_seismogram.extent(i);
+    head.history_extents[i] = d_history.extent(i);
+  }
+  head.istep = state.istep;
+  head.isig_step = state.isig_step;
+  head.nflushed = nflushed;
+  head.current_time = state.current_time;
+
+  const auto directory = std::filesystem::path(this->filename).parent_path();
+  if (!directory.empty())
+    std::filesystem::create_directories(directory);
+
+  this->pending = std::async(
+      std::launch::async,
+      [copy_space = this->copy_space, h_fields = this->h_fields,
+       h_seismogram = this->h_seismogram, h_history = this->h_history,
+       filename = this->filename, head]() {
+        copy_space.fence();
+
+        const std::string temporary = filename + ".tmp";
+        std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+        stream.write(reinterpret_cast<const char *>(&head), sizeof(header));
+        stream.write(reinterpret_cast<const char *>(h_fields.data()),
+                     bytes(h_fields));
+        stream.write(reinterpret_cast<const char *>(h_seismogram.data()),
+                     bytes(h_seismogram));
+        stream.write(reinterpret_cast<const char *>(h_history.data()),
+                     bytes(h_history));
+        stream.close();
+
+        if (!stream ||
+            std::rename(temporary.c_str(), filename.c_str()) != 0) {
+          std::remove(temporary.c_str());
+          std::ostringstream message;
+          message << "Could not write checkpoint file " << filename;
+          throw std::runtime_error(message.str());
+        }
+      });
+}
+
+void specfem::checkpoint::checkpoint::wait() {
+  if (this->pending.valid())
+    this->pending.get();
+}
+
+specfem::TimeScheme::state specfem::checkpoint::checkpoint::read() {
+
+  this->wait();
+
+  const auto field = this->domain->get_field();
+  const auto d_seismogram = this->compute_receivers->seismogram;
+  const auto d_history = this->compute_receivers->history;
+
+  std::ifstream stream(this->filename, std::ios::binary);
+  header head;
+  if (!stream.is_open() ||
+      !stream.read(reinterpret_cast<char *>(&head), sizeof(header))) {
+    std::ostringstream message;
+    message << "Could not read checkpoint file " << this->filename;
+    throw std::runtime_error(message.str());
+  }
+
+  bool matches = std::memcmp(head.magic, magic, sizeof(magic)) == 0 &&
+                 head.version == version &&
+                 head.real_size == sizeof(type_real) &&
+                 head.nglob == static_cast<int>(field.extent(0)) &&
+                 head.ncomponents == static_cast<int>(field.extent(1));
+  for (int i = 0; i < 4; i++)
+    matches = matches &&
+              (head.seismogram_extents[i] ==
+               static_cast<int>(d_seismogram.extent(i))) &&
+              (head.history_extents[i] ==
+               static_cast<int>(d_history.extent(i)));
+  if (!matches) {
+    std::ostringstream message;
+    message << "Checkpoint file " << this->filename
+            << " was written by another version or for another simulation";
+    throw std::runtime_error(message.str());
+  }
+
+  specfem::kokkos::HostView3d<type_real> h_fields(
+      "specfem::checkpoint::h_fields", 3, head.nglob, head.ncomponents);
+  specfem::kokkos::HostView4d<type_real> h_seismogram(
+      "specfem::checkpoint::h_seismogram", head.seismogram_extents[0],
+      head.seismogram_extents[1], head.seismogram_extents[2],
+      head.seismogram_extents[3]);
+  specfem::kokkos::HostView4d<type_real> h_history(
+      "specfem::checkpoint::h_history", head.history_extents[0],
+      head.history_extents[1], head.history_extents[2],
+      head.history_extents[3]);
+  stream.read(reinterpret_cast<char *>(h_fields.data()), bytes(h_fields));
+  stream.read(reinterpret_cast<char *>(h_seismogram.data()),
+              bytes(h_seismogram));
+  stream.read(reinterpret_cast<char *>(h_history.data()), bytes(h_history));
+  if (!stream) {
+    std::ostringstream message;
+    message << "Checkpoint file " << this->filename << " is truncated";
+    throw std::runtime_error(message.str());
+  }
+
+  // Processes may have been killed while writing a later checkpoint
+  const int first_step = this->mpi->all_reduce(head.istep, specfem::MPI::min);
+  const int last_step = this->mpi->all_reduce(head.istep, specfem::MPI::max);
+  if (first_step != last_step) {
+    std::ostringstream message;
+    message << "Checkpoints of processes were written at different timesteps ("
+            << first_step << " to " << last_step << ")";
+    throw std::runtime_error(message.str());
+  }
+
+  const auto views = { field, this->domain->get_field_dot(),
+                       this->domain->get_field_dot_dot() };
+  int ifield = 0;
+  for (const auto &view : views) {
+    auto mirror = Kokkos::create_mirror_view(view);
+    Kokkos::deep_copy(
+        mirror, Kokkos::subview(h_fields, ifield++, Kokkos::ALL, Kokkos::ALL));
+    Kokkos::deep_copy(view, mirror);
+  }
+  auto mirror = Kokkos::create_mirror_view(d_seismogram);
+  Kokkos::deep_copy(mirror, h_seismogram);
+  Kokkos::deep_copy(d_seismogram, mirror);
+  auto history_mirror = Kokkos::create_mirror_view(d_history);
+  Kokkos::deep_copy(history_mirror, h_history);
+  Kokkos::deep_copy(d_history, history_mirror);
+
+  if (this->writer)
+    this->writer->resume(head.nflushed);
+
+  return { head.istep, head.isig_step, head.current_time };
+}
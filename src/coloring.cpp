@@ -0,0 +1,74 @@
+#include "../include/coloring.h"
+#include "../include/kokkos_abstractions.h"
+#include <tuple>
+#include <vector>
+
+std::tuple<std::vector<int>, std::vector<int> >
+specfem::coloring::color_elements(
+    const specfem::kokkos::HostElementMirror3d<int> h_ibool,
+    const std::vector<int> &ispec_list) {
+
+  const int nspec = h_ibool.extent(0);
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  const int nelements = ispec_list.size();
+
+  int nglob = 0;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        nglob = std::max(nglob, h_ibool(ispec, iz, ix) + 1);
+      }
+    }
+  }
+
+  // color_nodes[icolor][iglob] is true if iglob is already touched by an
+  // element of color icolor
+  std::vector<std::vector<bool> > color_nodes;
+  std::vector<int> colors(nelements);
+
+  for (int i = 0; i < nelements; i++) {
+    const int ispec = ispec_list[i];
+    int icolor = 0;
+    for (; icolor < color_nodes.size(); icolor++) {
+      bool conflict = false;
+      for (int iz = 0; iz < ngllz && !conflict; iz++) {
+        for (int ix = 0; ix < ngllx && !conflict; ix++) {
+          conflict = color_nodes[icolor][h_ibool(ispec, iz, ix)];
+        }
+      }
+      if (!conflict)
+        break;
+    }
+
+    if (icolor == color_nodes.size())
+      color_nodes.push_back(std::vector<bool>(nglob, false));
+
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        color_nodes[icolor][h_ibool(ispec, iz, ix)] = true;
+      }
+    }
+
+    colors[i] = icolor;
+  }
+
+  // Sort entries by color (counting sort keeps the original order within a
+  // color)
+  const int ncolors = color_nodes.size();
+  std::vector<int> offsets(ncolors + 1, 0);
+  for (int i = 0; i < nelements; i++)
+    offsets[colors[i] + 1]++;
+
+  for (int icolor = 0; icolor < ncolors; icolor++)
+    offsets[icolor + 1] += offsets[icolor];
+
+  std::vector<int> permutation(nelements);
+  std::vector<int> counter(offsets.begin(), offsets.end() - 1);
+  for (int i = 0; i < nelements; i++) {
+    permutation[counter[colors[i]]] = i;
+    counter[colors[i]]++;
+  }
+
+  return std::make_tuple(permutation, offsets);
+}
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <boost/program_options.hpp>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Compare the ASCII seismograms of a test run against a reference run on the
+// same mesh, e.g. a run with quantized element data against a full precision
+// run. Every seismogram file of the reference folder needs to exist in the
+// test folder
+
+boost::program_options::options_description define_args() {
+  namespace po = boost::program_options;
+
+  po::options_description desc{ "======================================\n"
+                                "--------Compare seismograms-----------\n"
+                                "======================================" };
+
+  desc.add_options()("help,h", "Print this help message")(
+      "reference,r", po::value<std::string>(),
+      "Folder storing the reference seismograms")(
+      "test,t", po::value<std::string>(),
+      "Folder storing the seismograms to compare");
+
+  return desc;
+}
+
+// Amplitudes of an ASCII seismogram file. Every line stores a time and an
+// amplitude
+static std::vector<double> read_amplitudes(const std::filesystem::path &path) {
+  std::ifstream file(path);
+  if (!file) {
+    std::ostringstream message;
+    message << "Could not open seismogram file " << path.string();
+    throw std::runtime_error(message.str());
+  }
+
+  std::vector<double> amplitudes;
+  double time, amplitude;
+  while (file >> time >> amplitude)
+    amplitudes.push_back(amplitude);
+
+  return amplitudes;
+}
+
+int main(int argc, char **argv) {
+
+  const auto desc = define_args();
+  boost::program_options::variables_map vm;
+  boost::program_options::store(
+      boost::program_options::parse_command_line(argc, argv, desc), vm);
+
+  if (vm.count("help") || !vm.count("reference") || !vm.count("test")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+
+  const std::filesystem::path reference = vm["reference"].as<std::string>();
+  const std::filesystem::path test = vm["test"].as<std::string>();
+
+  std::vector<std::filesystem::path> files;
+  for (const auto &entry : std::filesystem::directory_iterator(reference)) {
+    if (entry.is_regular_file() &&
+        entry.path().extension().string().rfind(".sem", 0) == 0)
+      files.push_back(entry.path().filename());
+  }
+  std::sort(files.begin(), files.end());
+
+  if (files.empty()) {
+    std::cerr << "No seismogram files found in " << reference.string()
+              << std::endl;
+    return 1;
+  }
+
+  // Errors are relative to the largest amplitude of the reference trace
+  double max_error = 0.0;
+  std::string max_file;
+  std::cout << std::scientific << std::setprecision(3);
+  for (const auto &filename : files) {
+    const auto expected = read_amplitudes(reference / filename);
+    const auto computed = read_amplitudes(test / filename);
+    if (expected.size() != computed.size()) {
+      std::cerr << filename.string() << " : " << expected.size()
+                << " reference samples, " << computed.size()
+                << " test samples" << std::endl;
+      return 1;
+    }
+
+    double norm = 0.0, difference = 0.0, amax = 0.0, dmax = 0.0;
+    for (std::size_t i = 0; i < expected.size(); i++) {
+      norm += expected[i] * expected[i];
+      difference += (expected[i] - computed[i]) * (expected[i] - computed[i]);
+      amax = std::max(amax, std::abs(expected[i]));
+      dmax = std::max(dmax, std::abs(expected[i] - computed[i]));
+    }
+
+    const double l2_error =
+        (norm > 0.0) ? std::sqrt(difference / norm) : std::sqrt(difference);
+    const double linf_error = (amax > 0.0) ? dmax / amax : dmax;
+    std::cout << filename.string() << " : relative L2 error = " << l2_error
+              << ", relative max error = " << linf_error << "\n";
+
+    if (l2_error > max_error || max_file.empty()) {
+      max_error = l2_error;
+      max_file = filename.string();
+    }
+  }
+
+  std::cout << "Largest relative L2 error : " << max_error << " ("
+            << max_file << ")" << std::endl;
+
+  return 0;
+}
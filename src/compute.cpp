@@ -4,7 +4,15 @@
 #include "../include/quadrature.h"
 #include "../include/shape_functions.h"
 #include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 struct qp {
@@ -12,39 +20,255 @@ struct qp {
   int iloc = 0, iglob = 0;
 };
 
-type_real get_tolerance(std::vector<qp> cart_cord, const int nspec,
+type_real get_tolerance(const std::vector<qp> &cart_cord, const int nspec,
                         const int ngllxz) {
 
   assert(cart_cord.size() == ngllxz * nspec);
 
+  const qp *points = cart_cord.data();
   type_real xtypdist = std::numeric_limits<type_real>::max();
-  for (int ispec = 0; ispec < nspec; ispec++) {
-    type_real xmax = std::numeric_limits<type_real>::min();
-    type_real xmin = std::numeric_limits<type_real>::max();
-    type_real ymax = std::numeric_limits<type_real>::min();
-    type_real ymin = std::numeric_limits<type_real>::max();
-    for (int xz = 0; xz < ngllxz; xz++) {
-      int iloc = ispec * (ngllxz) + xz;
-      xmax = std::max(xmax, cart_cord[iloc].x);
-      xmin = std::min(xmin, cart_cord[iloc].x);
-      ymax = std::max(ymax, cart_cord[iloc].y);
-      ymin = std::min(ymin, cart_cord[iloc].y);
-    }
+  Kokkos::parallel_reduce(
+      "specfem::compute::compute::get_tolerance",
+      specfem::kokkos::HostRange(0, nspec),
+      [=](const int ispec, type_real &l_xtypdist) {
+        type_real xmax = std::numeric_limits<type_real>::lowest();
+        type_real xmin = std::numeric_limits<type_real>::max();
+        type_real ymax = std::numeric_limits<type_real>::lowest();
+        type_real ymin = std::numeric_limits<type_real>::max();
+        for (int xz = 0; xz < ngllxz; xz++) {
+          int iloc = ispec * (ngllxz) + xz;
+          xmax = std::max(xmax, points[iloc].x);
+          xmin = std::min(xmin, points[iloc].x);
+          ymax = std::max(ymax, points[iloc].y);
+          ymin = std::min(ymin, points[iloc].y);
+        }
 
-    xtypdist = std::min(xtypdist, xmax - xmin);
-    xtypdist = std::min(xtypdist, ymax - ymin);
-  }
+        l_xtypdist = std::min(l_xtypdist, xmax - xmin);
+        l_xtypdist = std::min(l_xtypdist, ymax - ymin);
+      },
+      Kokkos::Min<type_real>(xtypdist));
 
   return 1e-6 * xtypdist;
 }
 
+/**
+ * Number points shared by elements using the corners of the elements.
+ *
+ * Corners and edges of neighbouring elements match if they share control
+ * nodes, hence the numbering doesn't depend on a floating point comparison of
+ * coordinates. Every point is represented by its copy in the element with the
+ * smallest index, i.e. its first appearance when looping over (ispec, iz, ix),
+ * and representatives are numbered with a prefix sum, which gives the same
+ * numbering as the sort below for conforming meshes.
+ *
+ * Returns false, leaving h_ibool unchanged, if the quadrature differs in x and
+ * z or if points sharing a number are not within the tolerance.
+ */
+bool assign_numbering_topological(
+    specfem::kokkos::HostElementMirror3d<int> h_ibool,
+    const std::vector<qp> &cart_cord,
+    const specfem::kokkos::HostView2d<int> knods, const int npgeo,
+    const int ngllx, const int ngllz,
+    specfem::kokkos::HostView2d<type_real> &coord, type_real &xmin,
+    type_real &xmax, type_real &zmin, type_real &zmax) {
+
+  const int nspec = knods.extent(1);
+  const int ngllxz = ngllx * ngllz;
+  const int N = ngllx;
+  const int npoints = nspec * ngllxz;
+
+  if (ngllx != ngllz || knods.extent(0) < 4 || nspec == 0)
+    return false;
+
+  // Elements sharing every corner node
+  specfem::kokkos::HostView1d<int> offsets(
+      "specfem::compute::compute::node_offsets", npgeo + 1);
+  specfem::kokkos::HostView1d<int> elements(
+      "specfem::compute::compute::node_elements", 4 * nspec);
+
+  Kokkos::parallel_for(
+      "specfem::compute::compute::count_node_elements",
+      specfem::kokkos::HostRange(0, nspec), [=](const int ispec) {
+        for (int icorner = 0; icorner < 4; icorner++)
+          Kokkos::atomic_add(&offsets(knods(icorner, ispec) + 1), 1);
+      });
+
+  Kokkos::parallel_scan(
+      "specfem::compute::compute::node_offsets",
+      specfem::kokkos::HostRange(1, npgeo + 1),
+      [=](const int inode, int &update, const bool final) {
+        update += offsets(inode);
+        if (final)
+          offsets(inode) = update;
+      });
+
+  specfem::kokkos::HostView1d<int> fill(
+      "specfem::compute::compute::node_fill", npgeo);
+  Kokkos::parallel_for(
+      "specfem::compute::compute::fill_node_elements",
+      specfem::kokkos::HostRange(0, nspec), [=](const int ispec) {
+        for (int icorner = 0; icorner < 4; icorner++) {
+          const int inode = knods(icorner, ispec);
+          elements(offsets(inode) + Kokkos::atomic_fetch_add(&fill(inode), 1)) =
+              ispec;
+        }
+      });
+
+  // Local index of the copy of every point in the element with the smallest
+  // index sharing it
+  specfem::kokkos::HostView1d<int> representative(
+      "specfem::compute::compute::representative", npoints);
+
+  Kokkos::parallel_for(
+      "specfem::compute::compute::representative",
+      specfem::kokkos::HostRange(0, npoints), [=](const int iloc) {
+        // Corners are numbered counter clockwise starting at (xi, gamma) =
+        // (-1, -1). Edges run from their first corner to their second
+        // corner
+        constexpr int corners[4][2] = {
+          { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 }
+        };
+        constexpr int edges[4][2] = {
+          { 0, 1 }, { 1, 2 }, { 3, 2 }, { 0, 3 }
+        };
+
+        const int ispec = iloc / ngllxz;
+        const int iz = (iloc % ngllxz) / ngllx;
+        const int ix = iloc % ngllx;
+        const bool zedge = (iz == 0 || iz == N - 1);
+        const bool xedge = (ix == 0 || ix == N - 1);
+
+        int jrepresentative = iloc;
+        if (zedge && xedge) {
+          const int icorner =
+              (iz == 0) ? ((ix == 0) ? 0 : 1) : ((ix == 0) ? 3 : 2);
+          const int inode = knods(icorner, ispec);
+          int jbest = ispec;
+          for (int i = offsets(inode); i < offsets(inode + 1); i++) {
+            const int jspec = elements(i);
+            if (jspec >= jbest)
+              continue;
+            for (int jcorner = 0; jcorner < 4; jcorner++) {
+              if (knods(jcorner, jspec) == inode) {
+                jbest = jspec;
+                jrepresentative = jspec * ngllxz +
+                                  corners[jcorner][0] * (N - 1) * ngllx +
+                                  corners[jcorner][1] * (N - 1);
+                break;
+              }
+            }
+          }
+        } else if (zedge || xedge) {
+          const int iedge =
+              (iz == 0) ? 0 : ((ix == N - 1) ? 1 : ((iz == N - 1) ? 2 : 3));
+          const int t = (iedge == 0 || iedge == 2) ? ix : iz;
+          const int first = knods(edges[iedge][0], ispec);
+          const int second = knods(edges[iedge][1], ispec);
+          int jbest = ispec;
+          for (int i = offsets(first); i < offsets(first + 1); i++) {
+            const int jspec = elements(i);
+            if (jspec >= jbest)
+              continue;
+            for (int jedge = 0; jedge < 4; jedge++) {
+              const int jfirst = knods(edges[jedge][0], jspec);
+              const int jsecond = knods(edges[jedge][1], jspec);
+              int jt = -1;
+              if (jfirst == first && jsecond == second) {
+                jt = t;
+              } else if (jfirst == second && jsecond == first) {
+                jt = N - 1 - t;
+              }
+              if (jt < 0)
+                continue;
+              const int jz = (jedge == 0) ? 0 : ((jedge == 2) ? N - 1 : jt);
+              const int jx = (jedge == 3) ? 0 : ((jedge == 1) ? N - 1 : jt);
+              jbest = jspec;
+              jrepresentative = jspec * ngllxz + jz * ngllx + jx;
+              break;
+            }
+          }
+        }
+
+        representative(iloc) = jrepresentative;
+      });
+
+  // Points sharing a number have to be at the same location
+  const qp *points = cart_cord.data();
+  const type_real xtol = get_tolerance(cart_cord, nspec, ngllxz);
+  int nmismatch = 0;
+  Kokkos::parallel_reduce(
+      "specfem::compute::compute::check_numbering",
+      specfem::kokkos::HostRange(0, npoints),
+      [=](const int iloc, int &l_nmismatch) {
+        const qp &point = points[iloc];
+        const qp &copy = points[representative(iloc)];
+        if ((std::abs(point.x - copy.x) > xtol) ||
+            (std::abs(point.y - copy.y) > xtol))
+          l_nmismatch++;
+      },
+      nmismatch);
+
+  if (nmismatch > 0)
+    return false;
+
+  specfem::kokkos::HostView1d<int> inum("specfem::compute::compute::inum",
+                                        npoints);
+  int nglob = 0;
+  Kokkos::parallel_scan(
+      "specfem::compute::compute::number_points",
+      specfem::kokkos::HostRange(0, npoints),
+      [=](const int iloc, int &update, const bool final) {
+        if (representative(iloc) == iloc) {
+          if (final)
+            inum(iloc) = update;
+          update++;
+        }
+      },
+      nglob);
+
+  coord = specfem::kokkos::HostView2d<type_real>("specfem::mesh::coord", ndim,
+                                                 nglob);
+
+  Kokkos::parallel_for(
+      "specfem::compute::compute::assign_numbering",
+      specfem::kokkos::HostRange(0, npoints), [=](const int iloc) {
+        const int ispec = iloc / ngllxz;
+        const int iz = (iloc % ngllxz) / ngllx;
+        const int ix = iloc % ngllx;
+        const int iglob = inum(representative(iloc));
+        h_ibool(ispec, iz, ix) = iglob;
+        if (representative(iloc) == iloc) {
+          coord(0, iglob) = points[iloc].x;
+          coord(1, iglob) = points[iloc].y;
+        }
+      });
+
+  Kokkos::parallel_reduce(
+      "specfem::compute::compute::bounding_box",
+      specfem::kokkos::HostRange(0, nglob),
+      [=](const int iglob, type_real &l_xmin, type_real &l_xmax,
+          type_real &l_zmin, type_real &l_zmax) {
+        l_xmin = std::min(l_xmin, coord(0, iglob));
+        l_xmax = std::max(l_xmax, coord(0, iglob));
+        l_zmin = std::min(l_zmin, coord(1, iglob));
+        l_zmax = std::max(l_zmax, coord(1, iglob));
+      },
+      Kokkos::Min<type_real>(xmin), Kokkos::Max<type_real>(xmax),
+      Kokkos::Min<type_real>(zmin), Kokkos::Max<type_real>(zmax));
+
+  return true;
+}
+
 std::tuple<specfem::kokkos::HostView2d<type_real>, type_real, type_real,
            type_real, type_real>
-assign_numbering(specfem::kokkos::HostMirror3d<int> h_ibool,
+assign_numbering(specfem::kokkos::HostElementMirror3d<int> h_ibool,
                  std::vector<qp> &cart_cord, const int nspec, const int ngllx,
                  const int ngllz) {
 
   int ngllxz = ngllx * ngllz;
+  // Tolerance is computed per element, i.e. before sorting
+  type_real xtol = get_tolerance(cart_cord, nspec, ngllxz);
+
   // Sort cartesian coordinates in ascending order i.e.
   // cart_cord = [{0,0}, {0, 25}, {0, 50}, ..., {50, 0}, {50, 25}, {50, 50}]
   std::sort(cart_cord.begin(), cart_cord.end(),
@@ -60,8 +284,6 @@ assign_numbering(specfem::kokkos::HostMirror3d<int> h_ibool,
   int ig = 0;
   cart_cord[0].iglob = ig;
 
-  type_real xtol = get_tolerance(cart_cord, nspec, ngllxz);
-
   for (int iloc = 1; iloc < cart_cord.size(); iloc++) {
     // check if the previous point is same as current
     if ((std::abs(cart_cord[iloc].x - cart_cord[iloc - 1].x) > xtol) ||
@@ -88,9 +310,9 @@ assign_numbering(specfem::kokkos::HostMirror3d<int> h_ibool,
   int iloc = 0;
   int inum = 0;
   type_real xmin = std::numeric_limits<type_real>::max();
-  type_real xmax = std::numeric_limits<type_real>::min();
+  type_real xmax = std::numeric_limits<type_real>::lowest();
   type_real zmin = std::numeric_limits<type_real>::max();
-  type_real zmax = std::numeric_limits<type_real>::min();
+  type_real zmax = std::numeric_limits<type_real>::lowest();
   for (int ispec = 0; ispec < nspec; ispec++) {
     for (int iz = 0; iz < ngllz; iz++) {
       for (int ix = 0; ix < ngllx; ix++) {
@@ -106,7 +328,7 @@ assign_numbering(specfem::kokkos::HostMirror3d<int> h_ibool,
           if (xmax < coord(0, inum))
             xmax = coord(0, inum);
           if (zmax < coord(1, inum))
-            zmax = coord(0, inum);
+            zmax = coord(1, inum);
           inum++;
         } else {
           h_ibool(ispec, iz, ix) = iglob_counted[copy_cart_cord[iloc].iglob];
@@ -125,7 +347,7 @@ assign_numbering(specfem::kokkos::HostMirror3d<int> h_ibool,
 
 specfem::compute::compute::compute(const int nspec, const int ngllz,
                                    const int ngllx)
-    : ibool(specfem::kokkos::DeviceView3d<int>(
+    : ibool(specfem::kokkos::DeviceElementView3d<int>(
           "specfem::compute::compute::ibool", nspec, ngllz, ngllx)) {
   h_ibool = Kokkos::create_mirror_view(ibool);
   return;
@@ -216,10 +438,16 @@ specfem::compute::compute::compute(
             });
       });
 
-  std::tie(this->coordinates.coord, this->coordinates.xmin,
-           this->coordinates.xmax, this->coordinates.zmin,
-           this->coordinates.zmax) =
-      assign_numbering(this->h_ibool, cart_cord, nspec, ngllx, ngllz);
+  if (!assign_numbering_topological(
+          this->h_ibool, cart_cord, knods, coorg.extent(1), ngllx, ngllz,
+          this->coordinates.coord, this->coordinates.xmin,
+          this->coordinates.xmax, this->coordinates.zmin,
+          this->coordinates.zmax)) {
+    std::tie(this->coordinates.coord, this->coordinates.xmin,
+             this->coordinates.xmax, this->coordinates.zmin,
+             this->coordinates.zmax) =
+        assign_numbering(this->h_ibool, cart_cord, nspec, ngllx, ngllz);
+  }
 
   this->sync_views();
 }
@@ -229,3 +457,326 @@ void specfem::compute::compute::sync_views() {
 
   return;
 }
+
+specfem::memory::usage specfem::compute::compute::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->ibool, this->h_ibool);
+  usage.add(this->boundary);
+  usage.add(this->interior_base);
+  usage.add(this->structured_tiles, this->h_structured_tiles);
+  usage.add(this->coordinates.coord);
+
+  return usage;
+}
+
+bool specfem::compute::compute::compress_connectivity() {
+
+  const int nspec = this->h_ibool.extent(0);
+  const int ngllz = this->h_ibool.extent(1);
+  const int ngllx = this->h_ibool.extent(2);
+  const int nglob = this->coordinates.coord.extent(1);
+
+  if (ngllz < 3 || ngllx < 3 || nspec == 0)
+    return false;
+
+  const auto is_boundary = [=](const int iz, const int ix) {
+    return iz == 0 || iz == ngllz - 1 || ix == 0 || ix == ngllx - 1;
+  };
+
+  // Interior points need to belong to a single element
+  std::vector<int> copies(nglob, 0);
+  for (int ispec = 0; ispec < nspec; ispec++)
+    for (int iz = 0; iz < ngllz; iz++)
+      for (int ix = 0; ix < ngllx; ix++)
+        copies[this->h_ibool(ispec, iz, ix)]++;
+
+  for (int ispec = 0; ispec < nspec; ispec++)
+    for (int iz = 1; iz < ngllz - 1; iz++)
+      for (int ix = 1; ix < ngllx - 1; ix++)
+        if (copies[this->h_ibool(ispec, iz, ix)] > 1)
+          return false;
+
+  std::vector<int> renumber(nglob, -1);
+  int inum = 0;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int iz = 0; iz < ngllz; iz++)
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int iglob = this->h_ibool(ispec, iz, ix);
+        if (is_boundary(iz, ix) && renumber[iglob] < 0)
+          renumber[iglob] = inum++;
+      }
+    for (int iz = 1; iz < ngllz - 1; iz++)
+      for (int ix = 1; ix < ngllx - 1; ix++)
+        renumber[this->h_ibool(ispec, iz, ix)] = inum++;
+  }
+
+  specfem::kokkos::HostView2d<type_real> coord("specfem::mesh::coord", ndim,
+                                               nglob);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    coord(0, renumber[iglob]) = this->coordinates.coord(0, iglob);
+    coord(1, renumber[iglob]) = this->coordinates.coord(1, iglob);
+  }
+  this->coordinates.coord = coord;
+
+  const int nboundary = 2 * ngllx + 2 * (ngllz - 2);
+  this->boundary = specfem::kokkos::DeviceView2d<int>(
+      "specfem::compute::compute::boundary", nspec, nboundary);
+  this->interior_base = specfem::kokkos::DeviceView1d<int>(
+      "specfem::compute::compute::interior_base", nspec);
+  const auto h_boundary = Kokkos::create_mirror_view(this->boundary);
+  const auto h_interior_base = Kokkos::create_mirror_view(this->interior_base);
+
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int iz = 0; iz < ngllz; iz++)
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int iglob = renumber[this->h_ibool(ispec, iz, ix)];
+        this->h_ibool(ispec, iz, ix) = iglob;
+        if (is_boundary(iz, ix))
+          h_boundary(ispec,
+                     specfem::compute::connectivity_accessor::boundary_index(
+                         iz, ix, ngllz, ngllx)) = iglob;
+      }
+    h_interior_base(ispec) = this->h_ibool(ispec, 1, 1);
+  }
+
+  this->sync_views();
+  Kokkos::deep_copy(this->boundary, h_boundary);
+  Kokkos::deep_copy(this->interior_base, h_interior_base);
+
+  return true;
+}
+
+void specfem::compute::compute::assign_axial_elements(
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::kokkos::HostView1d<bool> is_on_the_axis,
+    const specfem::quadrature::quadrature &quadglj,
+    const specfem::quadrature::quadrature &quadz) {
+
+  const int nspec = this->h_ibool.extent(0);
+  const int ngllz = this->h_ibool.extent(1);
+  const int ngllx = this->h_ibool.extent(2);
+  const int ngnod = knods.extent(0);
+
+  if (static_cast<int>(is_on_the_axis.extent(0)) != nspec ||
+      quadglj.get_N() != ngllx || quadz.get_N() != ngllz) {
+    throw std::runtime_error(
+        "Axial elements don't match the global numbering");
+  }
+
+  const auto xi = quadglj.get_hxi();
+  const auto gamma = quadz.get_hxi();
+  specfem::kokkos::HostView2d<type_real> s_coorg(
+      "specfem::compute::compute::s_coorg", ndim, ngnod);
+  auto &coord = this->coordinates.coord;
+
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    if (!is_on_the_axis(ispec))
+      continue;
+    for (int in = 0; in < ngnod; in++) {
+      s_coorg(0, in) = coorg(0, knods(in, ispec));
+      s_coorg(1, in) = coorg(1, knods(in, ispec));
+    }
+    // Corners and the edges at xi = -1 and xi = 1 are GLL points as well
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 1; ix < ngllx - 1; ix++) {
+        const int iglob = this->h_ibool(ispec, iz, ix);
+        const auto [x, z] =
+            jacobian::compute_locations(s_coorg, ngnod, xi(ix), gamma(iz));
+        coord(0, iglob) = x;
+        coord(1, iglob) = z;
+      }
+    }
+  }
+
+  return;
+}
+
+std::tuple<int, int> specfem::compute::compute::assign_structured_blocks(
+    const specfem::kokkos::HostView2d<int> knods) {
+
+  const int nspec = this->h_ibool.extent(0);
+  const int ngllz = this->h_ibool.extent(1);
+  const int ngllx = this->h_ibool.extent(2);
+  const int nglob = this->coordinates.coord.extent(1);
+
+  if (this->compressed()) {
+    throw std::runtime_error(
+        "Structured blocks are not supported with compressed connectivity");
+  }
+
+  if (static_cast<int>(knods.extent(1)) != nspec) {
+    std::ostringstream message;
+    message << "Control nodes are given for " << knods.extent(1)
+            << " elements, global numbering for " << nspec << " elements";
+    throw std::runtime_error(message.str());
+  }
+
+  // Corner control nodes are ordered bottom left, bottom right, top right and
+  // top left. The right neighbor of an element has the right edge of the
+  // element as its left edge, the top neighbor has its top edge as its
+  // bottom edge
+  std::map<std::pair<int, int>, int> left_edges;
+  std::map<std::pair<int, int>, int> bottom_edges;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    left_edges[{ knods(0, ispec), knods(3, ispec) }] = ispec;
+    bottom_edges[{ knods(0, ispec), knods(1, ispec) }] = ispec;
+  }
+
+  std::vector<int> left(nspec, -1);
+  std::vector<int> right(nspec, -1);
+  std::vector<int> bottom(nspec, -1);
+  std::vector<int> top(nspec, -1);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    const auto ileft = left_edges.find({ knods(1, ispec), knods(2, ispec) });
+    if (ileft != left_edges.end() && ileft->second != ispec) {
+      right[ispec] = ileft->second;
+      left[ileft->second] = ispec;
+    }
+    const auto ibottom =
+        bottom_edges.find({ knods(3, ispec), knods(2, ispec) });
+    if (ibottom != bottom_edges.end() && ibottom->second != ispec) {
+      top[ispec] = ibottom->second;
+      bottom[ibottom->second] = ispec;
+    }
+  }
+
+  std::vector<int> renumber(nglob, -1);
+  std::vector<int> origin(nspec, 0);
+  std::vector<int> stride(nspec, 0);
+  std::vector<int> parity(nspec, -1);
+  std::vector<bool> visited(nspec, false);
+  std::vector<int> stamp(nspec, -1);
+  int inum = 0;
+  int nblocks = 0;
+  int nstructured = 0;
+
+  for (int seed = 0; seed < nspec; seed++) {
+    if (visited[seed])
+      continue;
+
+    // Walk to the bottom left corner of the unvisited elements around the
+    // seed. Periodic meshes would walk forever without a bound
+    int corner = seed;
+    for (int iter = 0; iter < nspec; iter++) {
+      if (left[corner] >= 0 && !visited[left[corner]])
+        corner = left[corner];
+      else if (bottom[corner] >= 0 && !visited[bottom[corner]])
+        corner = bottom[corner];
+      else
+        break;
+    }
+
+    // The first row extends to the right of the corner, every following row
+    // is made of the top neighbors of the previous row
+    const auto available = [&](const int ispec) {
+      return ispec >= 0 && !visited[ispec] && stamp[ispec] != corner;
+    };
+    std::vector<std::vector<int> > rows(1, std::vector<int>{ corner });
+    stamp[corner] = corner;
+    while (available(right[rows[0].back()])) {
+      rows[0].push_back(right[rows[0].back()]);
+      stamp[rows[0].back()] = corner;
+    }
+    const int nex = rows[0].size();
+    while (true) {
+      std::vector<int> row;
+      for (const int ispec : rows.back()) {
+        const int itop = top[ispec];
+        if (!available(itop) || (!row.empty() && right[row.back()] != itop))
+          break;
+        row.push_back(itop);
+      }
+      if (static_cast<int>(row.size()) != nex)
+        break;
+      for (const int ispec : row)
+        stamp[ispec] = corner;
+      rows.push_back(row);
+    }
+    const int nez = rows.size();
+
+    // Every point of the tile needs a single global number that isn't part
+    // of a previous tile, and every global number a single position in the
+    // tile
+    const int ncols = nex * (ngllx - 1) + 1;
+    const int nrows = nez * (ngllz - 1) + 1;
+    bool valid = (nex > 1 && nez > 1);
+    std::vector<int> tile;
+    if (valid)
+      tile.assign(ncols * nrows, -1);
+    std::map<int, int> position;
+    for (int ez = 0; ez < nez && valid; ez++) {
+      for (int ex = 0; ex < nex && valid; ex++) {
+        const int ispec = rows[ez][ex];
+        for (int iz = 0; iz < ngllz && valid; iz++) {
+          for (int ix = 0; ix < ngllx && valid; ix++) {
+            const int iglob = this->h_ibool(ispec, iz, ix);
+            const int ipos =
+                (ez * (ngllz - 1) + iz) * ncols + ex * (ngllx - 1) + ix;
+            const auto [entry, inserted] = position.insert({ iglob, ipos });
+            valid = (renumber[iglob] < 0) && (entry->second == ipos) &&
+                    (tile[ipos] < 0 || tile[ipos] == iglob);
+            tile[ipos] = iglob;
+          }
+        }
+      }
+    }
+
+    // Rejected rectangles are left to the general kernels
+    for (const auto &row : rows)
+      for (const int ispec : row)
+        visited[ispec] = true;
+    visited[seed] = true;
+
+    if (!valid)
+      continue;
+
+    for (int ipos = 0; ipos < ncols * nrows; ipos++)
+      renumber[tile[ipos]] = inum + ipos;
+    for (int ez = 0; ez < nez; ez++) {
+      for (int ex = 0; ex < nex; ex++) {
+        const int ispec = rows[ez][ex];
+        origin[ispec] = inum + ez * (ngllz - 1) * ncols + ex * (ngllx - 1);
+        stride[ispec] = ncols;
+        parity[ispec] = 2 * (ez % 2) + (ex % 2);
+      }
+    }
+    inum += ncols * nrows;
+    nblocks++;
+    nstructured += nex * nez;
+  }
+
+  if (nblocks == 0)
+    return { 0, 0 };
+
+  for (int iglob = 0; iglob < nglob; iglob++)
+    if (renumber[iglob] < 0)
+      renumber[iglob] = inum++;
+
+  specfem::kokkos::HostView2d<type_real> coord("specfem::mesh::coord", ndim,
+                                               nglob);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    coord(0, renumber[iglob]) = this->coordinates.coord(0, iglob);
+    coord(1, renumber[iglob]) = this->coordinates.coord(1, iglob);
+  }
+  this->coordinates.coord = coord;
+
+  for (int ispec = 0; ispec < nspec; ispec++)
+    for (int iz = 0; iz < ngllz; iz++)
+      for (int ix = 0; ix < ngllx; ix++)
+        this->h_ibool(ispec, iz, ix) = renumber[this->h_ibool(ispec, iz, ix)];
+
+  this->structured_tiles = specfem::kokkos::DeviceView2d<int>(
+      "specfem::compute::compute::structured_tiles", nspec, 3);
+  this->h_structured_tiles = Kokkos::create_mirror_view(this->structured_tiles);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    this->h_structured_tiles(ispec, 0) = origin[ispec];
+    this->h_structured_tiles(ispec, 1) = stride[ispec];
+    this->h_structured_tiles(ispec, 2) = parity[ispec];
+  }
+
+  this->sync_views();
+  Kokkos::deep_copy(this->structured_tiles, this->h_structured_tiles);
+
+  return { nblocks, nstructured };
+}
@@ -3,19 +3,24 @@
 #include "../include/kokkos_abstractions.h"
 #include "../include/shape_functions.h"
 #include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
 
 specfem::compute::partial_derivatives::partial_derivatives(const int nspec,
                                                            const int ngllz,
                                                            const int ngllx)
-    : xix(specfem::kokkos::DeviceView3d<type_real>(
+    : xix(specfem::kokkos::DeviceElementView3d<type_real>(
           "specfem::mesh::compute::xix", nspec, ngllz, ngllx)),
-      xiz(specfem::kokkos::DeviceView3d<type_real>(
+      xiz(specfem::kokkos::DeviceElementView3d<type_real>(
           "specfem::mesh::compute::xiz", nspec, ngllz, ngllx)),
-      gammax(specfem::kokkos::DeviceView3d<type_real>(
+      gammax(specfem::kokkos::DeviceElementView3d<type_real>(
           "specfem::mesh::compute::gammax", nspec, ngllz, ngllx)),
-      gammaz(specfem::kokkos::DeviceView3d<type_real>(
+      gammaz(specfem::kokkos::DeviceElementView3d<type_real>(
           "specfem::mesh::compute::gammaz", nspec, ngllz, ngllx)),
-      jacobian(specfem::kokkos::DeviceView3d<type_real>(
+      jacobian(specfem::kokkos::DeviceElementView3d<type_real>(
           "specfem::mesh::compute::jacobian", nspec, ngllz, ngllx)) {
 
   h_xix = Kokkos::create_mirror_view(xix);
@@ -31,7 +36,8 @@ specfem::compute::partial_derivatives::partial_derivatives(
     const specfem::quadrature::quadrature &quadx,
     const specfem::quadrature::quadrature &quadz) {
 
-  // Needs an axisymmetric update
+  // Elements on the axis of axisymmetric simulations are updated by
+  // assign_axial_elements
 
   int ngnod = knods.extent(0);
   int nspec = knods.extent(1);
@@ -46,15 +52,13 @@ specfem::compute::partial_derivatives::partial_derivatives(
   specfem::kokkos::HostMirror1d<type_real> xi = quadx.get_hxi();
   specfem::kokkos::HostMirror1d<type_real> gamma = quadz.get_hxi();
 
-  // Allocate views for shape functions
-  specfem::kokkos::HostView3d<type_real> shape2D(
-      "specfem::mesh::assign_numbering::shape2D", ngllz, ngllx, ngnod);
-  specfem::kokkos::HostView4d<type_real> dershape2D(
-      "specfem::mesh::assign_numbering::dershape2D", ngllz, ngllx, ndim, ngnod);
-  int scratch_size =
-      specfem::kokkos::HostScratchView2d<type_real>::shmem_size(ndim, ngnod);
+  // Shape function derivatives are tabulated once on the host and copied to
+  // the device with the control nodes
+  specfem::kokkos::DeviceView4d<type_real> dershape2D(
+      "specfem::compute::partial_derivatives::dershape2D", ngllz, ngllx, ndim,
+      ngnod);
+  auto h_dershape2D = Kokkos::create_mirror_view(dershape2D);
 
-  // Allocate shape functions
   Kokkos::parallel_for(
       "shape_functions",
       specfem::kokkos::HostMDrange<2>({ 0, 0 }, { ngllz, ngllx }),
@@ -64,34 +68,46 @@ specfem::compute::partial_derivatives::partial_derivatives(
 
         // Always use subviews inside parallel regions
         // ** Do not allocate views inside parallel regions **
-        auto sv_shape2D = Kokkos::subview(shape2D, iz, ix, Kokkos::ALL);
         auto sv_dershape2D =
-            Kokkos::subview(dershape2D, iz, ix, Kokkos::ALL, Kokkos::ALL);
+            Kokkos::subview(h_dershape2D, iz, ix, Kokkos::ALL, Kokkos::ALL);
 
-        shape_functions::define_shape_functions(sv_shape2D, ixxi, izgamma,
-                                                ngnod);
         shape_functions::define_shape_functions_derivatives(sv_dershape2D, ixxi,
                                                             izgamma, ngnod);
       });
 
   Kokkos::fence();
 
+  Kokkos::deep_copy(dershape2D, h_dershape2D);
+  const auto d_coorg = Kokkos::create_mirror_view_and_copy(
+      specfem::kokkos::DevMemSpace(), coorg);
+  const auto d_knods = Kokkos::create_mirror_view_and_copy(
+      specfem::kokkos::DevMemSpace(), knods);
+
+  const auto d_xix = this->xix;
+  const auto d_xiz = this->xiz;
+  const auto d_gammax = this->gammax;
+  const auto d_gammaz = this->gammaz;
+  const auto d_jacobian = this->jacobian;
+
+  int scratch_size =
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ndim, ngnod);
+
   Kokkos::parallel_for(
-      specfem::kokkos::HostTeam(nspec, Kokkos::AUTO, ngnod)
+      "specfem::compute::partial_derivatives::compute",
+      specfem::kokkos::DeviceTeam(nspec, Kokkos::AUTO)
           .set_scratch_size(0, Kokkos::PerTeam(scratch_size)),
-      [=](const specfem::kokkos::HostTeam::member_type &teamMember) {
+      KOKKOS_LAMBDA(
+          const specfem::kokkos::DeviceTeam::member_type &teamMember) {
         const int ispec = teamMember.league_rank();
 
         //----- Load coorgx, coorgz in level 0 cache to be utilized later
-        specfem::kokkos::HostScratchView2d<type_real> s_coorg(
+        specfem::kokkos::DeviceScratchView2d<type_real> s_coorg(
             teamMember.team_scratch(0), ndim, ngnod);
 
-        // This loop is not vectorizable because access to coorg via
-        // knods(ispec, in) is not vectorizable
         Kokkos::parallel_for(Kokkos::TeamThreadRange(teamMember, ngnod),
                              [&](const int in) {
-                               s_coorg(0, in) = coorg(0, knods(in, ispec));
-                               s_coorg(1, in) = coorg(1, knods(in, ispec));
+                               s_coorg(0, in) = d_coorg(0, d_knods(in, ispec));
+                               s_coorg(1, in) = d_coorg(1, d_knods(in, ispec));
                              });
 
         teamMember.team_barrier();
@@ -99,42 +115,223 @@ specfem::compute::partial_derivatives::partial_derivatives(
 
         Kokkos::parallel_for(
             Kokkos::TeamThreadRange(teamMember, ngllxz), [&](const int xz) {
-              const int ix = xz % ngllz;
-              const int iz = xz / ngllz;
-
-              // Get x and y coordinates for (ix, iz) point
-              auto sv_shape2D = Kokkos::subview(shape2D, iz, ix, Kokkos::ALL);
-              auto [xcor, ycor] = jacobian::compute_locations(
-                  teamMember, s_coorg, ngnod, sv_shape2D);
+              const int ix = xz % ngllx;
+              const int iz = xz / ngllx;
 
-              // compute partial derivatives
-              auto sv_dershape2D =
+              const auto sv_dershape2D =
                   Kokkos::subview(dershape2D, iz, ix, Kokkos::ALL, Kokkos::ALL);
 
-              type_real jacobianl = jacobian::compute_jacobian(
-                  teamMember, s_coorg, ngnod, sv_dershape2D);
+              type_real xixl, gammaxl, xizl, gammazl, jacobianl;
+              jacobian::compute_inverted_derivatives(s_coorg, ngnod,
+                                                     sv_dershape2D, xixl,
+                                                     gammaxl, xizl, gammazl,
+                                                     jacobianl);
 
-              auto [xixl, gammaxl, xizl, gammazl] =
-                  jacobian::compute_inverted_derivatives(teamMember, s_coorg,
-                                                         ngnod, sv_dershape2D);
-
-              this->h_xix(ispec, iz, ix) = xixl;
-              this->h_gammax(ispec, iz, ix) = gammaxl;
-              this->h_xiz(ispec, iz, ix) = xizl;
-              this->h_gammaz(ispec, iz, ix) = gammazl;
-              this->h_jacobian(ispec, iz, ix) = jacobianl;
+              d_xix(ispec, iz, ix) = xixl;
+              d_gammax(ispec, iz, ix) = gammaxl;
+              d_xiz(ispec, iz, ix) = xizl;
+              d_gammaz(ispec, iz, ix) = gammazl;
+              d_jacobian(ispec, iz, ix) = jacobianl;
             });
       });
 
-  this->sync_views();
+  Kokkos::fence();
+
+  // Host copies are kept for host side consumers, e.g. the packed element
+  // block and the setup cache
+  Kokkos::deep_copy(h_xix, d_xix);
+  Kokkos::deep_copy(h_xiz, d_xiz);
+  Kokkos::deep_copy(h_gammax, d_gammax);
+  Kokkos::deep_copy(h_gammaz, d_gammaz);
+  Kokkos::deep_copy(h_jacobian, d_jacobian);
 
   return;
 }
 
+// 4-node elements are affine if their control nodes form a parallelogram.
+// Control nodes are ordered counter-clockwise, hence opposite edges are equal
+// if x0 + x2 = x1 + x3
+static bool
+is_affine(const specfem::kokkos::HostView2d<type_real> coorg,
+          const specfem::kokkos::HostView2d<int> knods, const int ispec) {
+  if (knods.extent(0) != 4)
+    return false;
+
+  const type_real tolerance = 100 * std::numeric_limits<type_real>::epsilon();
+  for (int idim = 0; idim < ndim; idim++) {
+    type_real corner[4];
+    for (int in = 0; in < 4; in++)
+      corner[in] = coorg(idim, knods(in, ispec));
+
+    const type_real scale = std::max(std::abs(corner[2] - corner[0]),
+                                     std::abs(corner[3] - corner[1]));
+    if (std::abs(corner[0] + corner[2] - corner[1] - corner[3]) >
+        tolerance * scale)
+      return false;
+  }
+
+  return true;
+}
+
+int specfem::compute::partial_derivatives::assign_affine_elements(
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods) {
+
+  const int nspec = this->h_xix.extent(0);
+  const int ngllz = this->h_xix.extent(1);
+  const int ngllx = this->h_xix.extent(2);
+
+  if (static_cast<int>(knods.extent(1)) != nspec) {
+    std::ostringstream message;
+    message << "Control nodes are given for " << knods.extent(1)
+            << " elements, partial derivatives for " << nspec << " elements";
+    throw std::runtime_error(message.str());
+  }
+
+  this->affine = specfem::kokkos::DeviceView1d<int>(
+      "specfem::compute::partial_derivatives::affine", nspec);
+  this->affine_record = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::compute::partial_derivatives::affine_record", nspec,
+      specfem::compute::element_geometry::ncolumns);
+  this->h_affine = Kokkos::create_mirror_view(this->affine);
+  this->h_affine_record = Kokkos::create_mirror_view(this->affine_record);
+
+  const specfem::kokkos::HostElementMirror3d<type_real> values[] = {
+    this->h_xix, this->h_xiz, this->h_gammax, this->h_gammaz, this->h_jacobian
+  };
+
+  // Values of affine elements are equal at every quadrature point up to
+  // round-off. Every point takes the value of the first point so that every
+  // kernel, fast path or not, reads the same geometry
+  int naffine = 0;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    this->h_affine(ispec) = is_affine(coorg, knods, ispec);
+    for (int icol = 0; icol < specfem::compute::element_geometry::ncolumns;
+         icol++) {
+      const auto &value = values[icol];
+      this->h_affine_record(ispec, icol) = value(ispec, 0, 0);
+      if (!this->h_affine(ispec))
+        continue;
+      for (int iz = 0; iz < ngllz; iz++)
+        for (int ix = 0; ix < ngllx; ix++)
+          value(ispec, iz, ix) = this->h_affine_record(ispec, icol);
+    }
+    naffine += this->h_affine(ispec);
+  }
+
+  this->sync_views();
+
+  return naffine;
+}
+
+int specfem::compute::partial_derivatives::assign_axial_elements(
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::kokkos::HostView1d<bool> is_on_the_axis,
+    const specfem::quadrature::quadrature &quadglj,
+    const specfem::quadrature::quadrature &quadz) {
+
+  const int nspec = this->h_xix.extent(0);
+  const int ngllz = this->h_xix.extent(1);
+  const int ngllx = this->h_xix.extent(2);
+  const int ngnod = knods.extent(0);
+
+  if (static_cast<int>(is_on_the_axis.extent(0)) != nspec ||
+      quadglj.get_N() != ngllx || quadz.get_N() != ngllz) {
+    std::ostringstream message;
+    message << "Axial elements are given for " << is_on_the_axis.extent(0)
+            << " elements of " << quadglj.get_N() << " x " << quadz.get_N()
+            << " points, partial derivatives for " << nspec
+            << " elements of " << ngllx << " x " << ngllz << " points";
+    throw std::runtime_error(message.str());
+  }
+
+  const auto xi = quadglj.get_hxi();
+  const auto gamma = quadz.get_hxi();
+  specfem::kokkos::HostView2d<type_real> s_coorg(
+      "specfem::compute::partial_derivatives::s_coorg", ndim, ngnod);
+
+  int naxial = 0;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    if (!is_on_the_axis(ispec))
+      continue;
+    naxial++;
+    for (int in = 0; in < ngnod; in++) {
+      s_coorg(0, in) = coorg(0, knods(in, ispec));
+      s_coorg(1, in) = coorg(1, knods(in, ispec));
+    }
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const auto [xxi, zxi, xgamma, zgamma] =
+            jacobian::compute_partial_derivatives(s_coorg, ngnod, xi(ix),
+                                                  gamma(iz));
+        const type_real jacobianl =
+            jacobian::compute_jacobian(xxi, zxi, xgamma, zgamma);
+        this->h_xix(ispec, iz, ix) = zgamma / jacobianl;
+        this->h_gammax(ispec, iz, ix) = -zxi / jacobianl;
+        this->h_xiz(ispec, iz, ix) = -xgamma / jacobianl;
+        this->h_gammaz(ispec, iz, ix) = xxi / jacobianl;
+        this->h_jacobian(ispec, iz, ix) = jacobianl;
+      }
+    }
+  }
+
+  this->sync_views();
+
+  return naxial;
+}
+
 void specfem::compute::partial_derivatives::sync_views() {
   Kokkos::deep_copy(xix, h_xix);
   Kokkos::deep_copy(xiz, h_xiz);
   Kokkos::deep_copy(gammax, h_gammax);
   Kokkos::deep_copy(gammaz, h_gammaz);
   Kokkos::deep_copy(jacobian, h_jacobian);
+  if (this->affine.is_allocated()) {
+    Kokkos::deep_copy(affine, h_affine);
+    Kokkos::deep_copy(affine_record, h_affine_record);
+  }
+}
+
+void specfem::compute::partial_derivatives::release_host_mirrors() {
+  this->h_xix = {};
+  this->h_xiz = {};
+  this->h_gammax = {};
+  this->h_gammaz = {};
+  this->h_jacobian = {};
+  this->h_affine = {};
+  this->h_affine_record = {};
+}
+
+void specfem::compute::partial_derivatives::restore_host_mirrors() {
+  this->h_xix = Kokkos::create_mirror_view(this->xix);
+  this->h_xiz = Kokkos::create_mirror_view(this->xiz);
+  this->h_gammax = Kokkos::create_mirror_view(this->gammax);
+  this->h_gammaz = Kokkos::create_mirror_view(this->gammaz);
+  this->h_jacobian = Kokkos::create_mirror_view(this->jacobian);
+  Kokkos::deep_copy(this->h_xix, this->xix);
+  Kokkos::deep_copy(this->h_xiz, this->xiz);
+  Kokkos::deep_copy(this->h_gammax, this->gammax);
+  Kokkos::deep_copy(this->h_gammaz, this->gammaz);
+  Kokkos::deep_copy(this->h_jacobian, this->jacobian);
+  if (this->affine.is_allocated()) {
+    this->h_affine = Kokkos::create_mirror_view(this->affine);
+    this->h_affine_record = Kokkos::create_mirror_view(this->affine_record);
+    Kokkos::deep_copy(this->h_affine, this->affine);
+    Kokkos::deep_copy(this->h_affine_record, this->affine_record);
+  }
+}
+
+specfem::memory::usage
+specfem::compute::partial_derivatives::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->xix, this->h_xix);
+  usage.add(this->xiz, this->h_xiz);
+  usage.add(this->gammax, this->h_gammax);
+  usage.add(this->gammaz, this->h_gammaz);
+  usage.add(this->jacobian, this->h_jacobian);
+  usage.add(this->affine, this->h_affine);
+  usage.add(this->affine_record, this->h_affine_record);
+
+  return usage;
 }
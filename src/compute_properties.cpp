@@ -4,24 +4,28 @@
 #include "../include/kokkos_abstractions.h"
 #include "../include/shape_functions.h"
 #include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
 specfem::compute::properties::properties(const int nspec, const int ngllz,
                                          const int ngllx)
-    : rho(specfem::kokkos::DeviceView3d<type_real>(
+    : rho(specfem::kokkos::DeviceElementView3d<type_real>(
           "specfem::compute::properties::rho", nspec, ngllz, ngllx)),
-      mu(specfem::kokkos::DeviceView3d<type_real>(
+      mu(specfem::kokkos::DeviceElementView3d<type_real>(
           "specfem::compute::properties::mu", nspec, ngllz, ngllx)),
-      kappa(specfem::kokkos::HostView3d<type_real>(
+      kappa(specfem::kokkos::HostElementView3d<type_real>(
           "specfem::compute::properties::kappa", nspec, ngllz, ngllx)),
-      qmu(specfem::kokkos::HostView3d<type_real>(
+      qmu(specfem::kokkos::HostElementView3d<type_real>(
           "specfem::compute::properties::qmu", nspec, ngllz, ngllx)),
-      qkappa(specfem::kokkos::HostView3d<type_real>(
+      qkappa(specfem::kokkos::HostElementView3d<type_real>(
           "specfem::compute::properties::qkappa", nspec, ngllz, ngllx)),
-      rho_vp(specfem::kokkos::HostView3d<type_real>(
+      rho_vp(specfem::kokkos::HostElementView3d<type_real>(
           "specfem::compute::properties::rho_vp", nspec, ngllz, ngllx)),
-      rho_vs(specfem::kokkos::HostView3d<type_real>(
+      rho_vs(specfem::kokkos::HostElementView3d<type_real>(
           "specfem::compute::properties::rho_vs", nspec, ngllz, ngllx)),
-      lambdaplus2mu(specfem::kokkos::DeviceView3d<type_real>(
+      lambdaplus2mu(specfem::kokkos::DeviceElementView3d<type_real>(
           "specfem::compute::properties::lambdaplus2mu", nspec, ngllz, ngllx)),
       ispec_type(specfem::kokkos::DeviceView1d<specfem::elements::type>(
           "specfem::compute::properties::ispec_type", nspec)) {
@@ -46,12 +50,17 @@ specfem::compute::properties::properties(
 
   *this = specfem::compute::properties(nspec, ngllz, ngllx);
 
+  // Properties are constant inside every material
+  std::vector<utilities::return_holder> holders;
+  for (const auto &material : materials)
+    holders.push_back(material->get_properties());
+
   Kokkos::parallel_for(
       "specfem::compute::properties::properties",
       specfem::kokkos::HostMDrange<3>({ 0, 0, 0 }, { nspec, ngllz, ngllx }),
-      [=](const int ispec, const int iz, const int ix) {
+      [=, &holders](const int ispec, const int iz, const int ix) {
         const int imat = kmato(ispec);
-        utilities::return_holder holder = materials[imat]->get_properties();
+        const utilities::return_holder &holder = holders[imat];
         auto [rho, mu, kappa, qmu, qkappa, lambdaplus2mu] =
             std::make_tuple(holder.rho, holder.mu, holder.kappa, holder.qmu,
                             holder.qkappa, holder.lambdaplus2mu);
@@ -81,10 +90,123 @@ specfem::compute::properties::properties(
 }
 
 void specfem::compute::properties::sync_views() {
-  Kokkos::deep_copy(rho, h_rho);
-  Kokkos::deep_copy(mu, h_mu);
-  Kokkos::deep_copy(lambdaplus2mu, h_lambdaplus2mu);
+  if (this->compressed()) {
+    Kokkos::deep_copy(kmato, h_kmato);
+    Kokkos::deep_copy(material_table, h_material_table);
+  } else {
+    Kokkos::deep_copy(rho, h_rho);
+    Kokkos::deep_copy(mu, h_mu);
+    Kokkos::deep_copy(lambdaplus2mu, h_lambdaplus2mu);
+  }
   Kokkos::deep_copy(ispec_type, h_ispec_type);
 
   return;
 }
+
+bool specfem::compute::properties::compress(
+    const specfem::kokkos::HostView1d<int> kmato) {
+
+  const int nspec = this->h_rho.extent(0);
+  const int ngllz = this->h_rho.extent(1);
+  const int ngllx = this->h_rho.extent(2);
+
+  if (static_cast<int>(kmato.extent(0)) != nspec) {
+    std::ostringstream message;
+    message << "Material numbers of " << kmato.extent(0)
+            << " elements given to compress the properties of " << nspec
+            << " elements";
+    throw std::runtime_error(message.str());
+  }
+
+  if (nspec == 0 || this->compressed())
+    return this->compressed();
+
+  int nmaterials = 0;
+  for (int ispec = 0; ispec < nspec; ispec++)
+    nmaterials = std::max(nmaterials, kmato(ispec) + 1);
+
+  const specfem::kokkos::HostElementMirror3d<type_real>
+      values[specfem::compute::material_table::ncolumns] = {
+        this->h_rho, this->h_mu, this->h_lambdaplus2mu
+      };
+
+  // Properties of every material are taken from its first quadrature point
+  specfem::kokkos::HostView2d<type_real> table(
+      "specfem::compute::properties::table", nmaterials,
+      specfem::compute::material_table::ncolumns);
+  std::vector<bool> assigned(nmaterials, false);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    const int imat = kmato(ispec);
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        for (int icol = 0; icol < specfem::compute::material_table::ncolumns;
+             icol++) {
+          const type_real value = values[icol](ispec, iz, ix);
+          if (!assigned[imat]) {
+            table(imat, icol) = value;
+          } else if (table(imat, icol) != value) {
+            // The model varies inside the material
+            return false;
+          }
+        }
+        assigned[imat] = true;
+      }
+    }
+  }
+
+  this->kmato = specfem::kokkos::DeviceView1d<int>(
+      "specfem::compute::properties::kmato", nspec);
+  this->h_kmato = Kokkos::create_mirror_view(this->kmato);
+  this->material_table = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::compute::properties::material_table", nmaterials,
+      specfem::compute::material_table::ncolumns);
+  this->h_material_table = Kokkos::create_mirror_view(this->material_table);
+
+  for (int ispec = 0; ispec < nspec; ispec++)
+    this->h_kmato(ispec) = kmato(ispec);
+  Kokkos::deep_copy(this->h_material_table, table);
+
+  Kokkos::deep_copy(this->kmato, this->h_kmato);
+  Kokkos::deep_copy(this->material_table, this->h_material_table);
+
+  // Host views stay valid for the remaining setup. On host backends they
+  // share the allocation of the device views
+  this->rho = {};
+  this->mu = {};
+  this->lambdaplus2mu = {};
+
+  return true;
+}
+
+void specfem::compute::properties::release_host_mirrors() {
+  this->h_rho = {};
+  this->h_mu = {};
+  this->h_lambdaplus2mu = {};
+  this->h_ispec_type = {};
+  this->h_kmato = {};
+  this->h_material_table = {};
+  this->kappa = {};
+  this->qmu = {};
+  this->qkappa = {};
+  this->rho_vp = {};
+  this->rho_vs = {};
+
+  return;
+}
+
+specfem::memory::usage specfem::compute::properties::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->rho, this->h_rho);
+  usage.add(this->mu, this->h_mu);
+  usage.add(this->lambdaplus2mu, this->h_lambdaplus2mu);
+  usage.add(this->ispec_type, this->h_ispec_type);
+  usage.add(this->kmato, this->h_kmato);
+  usage.add(this->material_table, this->h_material_table);
+  usage.add(this->kappa);
+  usage.add(this->qmu);
+  usage.add(this->qkappa);
+  usage.add(this->rho_vp);
+  usage.add(this->rho_vs);
+
+  return usage;
+}
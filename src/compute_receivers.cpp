@@ -1,34 +1,101 @@
 #include "../include/compute.h"
+#include "../include/arena.h"
+#include "../include/constants.h"
 #include "../include/globals.h"
 #include "../include/kokkos_abstractions.h"
 #include "../include/quadrature.h"
 #include "../include/receiver.h"
 #include "../include/specfem_mpi.h"
 #include <Kokkos_Core.hpp>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
 #include <vector>
 
+// Blackman windowed sinc low-pass filter of 16 * decimation + 1 taps. The
+// cutoff at a third of the decimated sampling rate leaves the transition band
+// below the decimated Nyquist frequency
+static std::vector<type_real> anti_alias_filter(const int decimation) {
+  const int delay = 8 * decimation;
+  const int ntaps = 2 * delay + 1;
+  const double cutoff = 1.0 / (3.0 * decimation);
+
+  std::vector<double> taps(ntaps);
+  double sum = 0.0;
+  for (int k = 0; k < ntaps; k++) {
+    const double x = pi * 2.0 * cutoff * (k - delay);
+    const double sinc = (k == delay) ? 1.0 : std::sin(x) / x;
+    const double window = 0.42 - 0.5 * std::cos(2.0 * pi * k / (ntaps - 1)) +
+                          0.08 * std::cos(4.0 * pi * k / (ntaps - 1));
+    taps[k] = sinc * window;
+    sum += taps[k];
+  }
+
+  // Unit gain at zero frequency
+  std::vector<type_real> filter(ntaps);
+  for (int k = 0; k < ntaps; k++)
+    filter[k] = taps[k] / sum;
+
+  return filter;
+}
+
 specfem::compute::receivers::receivers(
-    const std::vector<specfem::receivers::receiver *> &receivers,
+    const specfem::receivers::receiver_set &receivers,
     const std::vector<specfem::seismogram::type> &stypes,
     const specfem::quadrature::quadrature &quadx,
     const specfem::quadrature::quadrature &quadz, const type_real xmax,
     const type_real xmin, const type_real zmax, const type_real zmin,
-    const int max_sig_step, specfem::MPI::MPI *mpi) {
+    const int nsig_steps, specfem::MPI::MPI *mpi, const int buffer_size,
+    const int decimation,
+    const specfem::kokkos::HostView1d<bool> is_on_the_axis)
+    : decimation(decimation) {
+
+  if (decimation < 1) {
+    throw std::runtime_error("Seismogram decimation must be positive");
+  }
+
+  // Written samples are filtered from recorded samples up to delay samples
+  // later, hence the last delay recorded samples are not written
+  int delay = 0;
+  if (decimation > 1) {
+    const auto taps = anti_alias_filter(decimation);
+    delay = (taps.size() - 1) / 2;
+    if (nsig_steps <= delay) {
+      std::ostringstream message;
+      message << "Seismograms decimated by " << decimation << " need more "
+              << "than " << delay << " recorded samples";
+      throw std::runtime_error(message.str());
+    }
 
-  // Get  sources which lie in processor
-  std::vector<specfem::receivers::receiver *> my_receivers;
-  for (auto &receiver : receivers) {
-    if (receiver->get_islice() == mpi->get_rank()) {
-      my_receivers.push_back(receiver);
+    this->filter = specfem::kokkos::DeviceView1d<type_real>(
+        "specfem::compute::receivers::filter", taps.size());
+    this->h_filter = Kokkos::create_mirror_view(this->filter);
+    for (int k = 0; k < taps.size(); k++)
+      this->h_filter(k) = taps[k];
+  }
+  this->max_sig_step = (nsig_steps - delay - 1) / decimation + 1;
+
+  // Get receivers which lie in processor
+  std::vector<int> my_receivers;
+  for (int irec = 0; irec < receivers.size(); irec++) {
+    if (receivers.islice[irec] == mpi->get_rank()) {
+      my_receivers.push_back(irec);
     }
   }
 
-  // allocate source array view
-  this->receiver_array = specfem::kokkos::DeviceView4d<type_real>(
-      "specfem::compute::receiver::receiver_array", my_receivers.size(),
-      quadz.get_N(), quadx.get_N(), ndim);
+  receivers.check_locations(xmin, xmax, zmin, zmax, mpi);
+
+  // allocate lagrange interpolants
+  this->hxir = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::compute::receivers::hxir", my_receivers.size(), quadx.get_N());
 
-  this->h_receiver_array = Kokkos::create_mirror_view(this->receiver_array);
+  this->h_hxir = Kokkos::create_mirror_view(this->hxir);
+
+  this->hgammar = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::compute::receivers::hgammar", my_receivers.size(),
+      quadz.get_N());
+
+  this->h_hgammar = Kokkos::create_mirror_view(this->hgammar);
 
   this->ispec_array = specfem::kokkos::DeviceView1d<int>(
       "specfem::compute::receivers::ispec_array", my_receivers.size());
@@ -45,28 +112,38 @@ specfem::compute::receivers::receivers(
 
   this->h_sin_recs = Kokkos::create_mirror_view(sin_recs);
 
-  this->field = specfem::kokkos::DeviceView5d<type_real>(
-      "specfem::compute::receivers::field", stypes.size(), my_receivers.size(),
-      2, quadz.get_N(), quadx.get_N());
-
-  this->seismogram = specfem::kokkos::DeviceView4d<type_real>(
-      "specfem::compute::receivers::seismogram", max_sig_step, stypes.size(),
+  const int nslots = (buffer_size > 0 && buffer_size < this->max_sig_step)
+                         ? buffer_size
+                         : this->max_sig_step;
+  this->seismogram = specfem::kokkos::DeviceReceiverView4d<type_real>(
+      "specfem::compute::receivers::seismogram", nslots, stypes.size(),
       my_receivers.size(), 2);
 
-  this->h_seismogram = Kokkos::create_mirror_view(this->seismogram);
+  if (decimation > 1) {
+    this->history = specfem::kokkos::DeviceReceiverView4d<type_real>(
+        "specfem::compute::receivers::history", this->filter.extent(0),
+        stypes.size(), my_receivers.size(), 2);
+  }
 
-  // store source array for sources in my islice
+  // store lagrange interpolants for receivers in my islice. Elements on the
+  // axis of axisymmetric simulations are interpolated at the GLJ points
+  const bool axisymmetric = is_on_the_axis.extent(0) > 0;
+  const specfem::quadrature::quadrature quadglj =
+      axisymmetric ? specfem::quadrature::quadrature(0.0, 1.0, quadx.get_N())
+                   : specfem::quadrature::quadrature();
+  specfem::memory::arena arena;
   for (int irec = 0; irec < my_receivers.size(); irec++) {
 
-    my_receivers[irec]->check_locations(xmax, xmin, zmax, zmin, mpi);
-
-    auto sv_receiver_array = Kokkos::subview(
-        this->h_receiver_array, irec, Kokkos::ALL, Kokkos::ALL, Kokkos::ALL);
-    my_receivers[irec]->compute_receiver_array(quadx, quadz, sv_receiver_array);
+    const bool axial =
+        axisymmetric && is_on_the_axis(receivers.ispec[my_receivers[irec]]);
+    receivers.compute_lagrange_interpolants(
+        my_receivers[irec], axial ? quadglj : quadx, quadz,
+        Kokkos::subview(this->h_hxir, irec, Kokkos::ALL),
+        Kokkos::subview(this->h_hgammar, irec, Kokkos::ALL), arena);
 
-    this->h_ispec_array(irec) = my_receivers[irec]->get_ispec();
-    this->h_cos_recs(irec) = my_receivers[irec]->get_cosine();
-    this->h_sin_recs(irec) = my_receivers[irec]->get_sine();
+    this->h_ispec_array(irec) = receivers.ispec[my_receivers[irec]];
+    this->h_cos_recs(irec) = receivers.get_cosine();
+    this->h_sin_recs(irec) = receivers.get_sine();
   }
 
   this->seismogram_types =
@@ -85,17 +162,47 @@ specfem::compute::receivers::receivers(
 };
 
 void specfem::compute::receivers::sync_views() {
-  Kokkos::deep_copy(receiver_array, h_receiver_array);
+  Kokkos::deep_copy(hxir, h_hxir);
+  Kokkos::deep_copy(hgammar, h_hgammar);
   Kokkos::deep_copy(ispec_array, h_ispec_array);
   Kokkos::deep_copy(cos_recs, h_cos_recs);
   Kokkos::deep_copy(sin_recs, h_sin_recs);
   Kokkos::deep_copy(seismogram_types, h_seismogram_types);
+  if (filter.is_allocated())
+    Kokkos::deep_copy(filter, h_filter);
 
   return;
 }
 
 void specfem::compute::receivers::sync_seismograms() {
-  Kokkos::deep_copy(h_seismogram, seismogram);
+  Kokkos::deep_copy(specfem::kokkos::lazy_mirror(h_seismogram, seismogram),
+                    seismogram);
 
   return;
 }
+
+void specfem::compute::receivers::release_host_mirrors() {
+  this->h_hxir = {};
+  this->h_hgammar = {};
+  this->h_ispec_array = {};
+  this->h_cos_recs = {};
+  this->h_sin_recs = {};
+  this->h_filter = {};
+
+  return;
+}
+
+specfem::memory::usage specfem::compute::receivers::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->hxir, this->h_hxir);
+  usage.add(this->hgammar, this->h_hgammar);
+  usage.add(this->ispec_array, this->h_ispec_array);
+  usage.add(this->cos_recs, this->h_cos_recs);
+  usage.add(this->sin_recs, this->h_sin_recs);
+  usage.add(this->seismogram, this->h_seismogram);
+  usage.add(this->seismogram_types, this->h_seismogram_types);
+  usage.add(this->filter, this->h_filter);
+  usage.add(this->history);
+
+  return usage;
+}
@@ -1,9 +1,13 @@
 #include "../include/compute.h"
+#include "../include/arena.h"
+#include "../include/constants.h"
 #include "../include/kokkos_abstractions.h"
 #include "../include/quadrature.h"
 #include "../include/source.h"
 #include "../include/specfem_mpi.h"
 #include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <stdexcept>
 #include <vector>
 
 specfem::compute::sources::sources(
@@ -11,45 +15,123 @@ specfem::compute::sources::sources(
     const specfem::quadrature::quadrature &quadx,
     const specfem::quadrature::quadrature &quadz, const type_real xmax,
     const type_real xmin, const type_real zmax, const type_real zmin,
-    specfem::MPI::MPI *mpi) {
+    specfem::MPI::MPI *mpi, const specfem::wave::type wave,
+    const std::vector<int> &shots,
+    const specfem::kokkos::HostView1d<bool> is_on_the_axis) {
+
+  if (!shots.empty() && shots.size() != sources.size()) {
+    throw std::runtime_error("Every source needs a shot");
+  }
 
   // Get  sources which lie in processor
   std::vector<specfem::sources::source *> my_sources;
-  for (auto &source : sources) {
-    if (source->get_islice() == mpi->get_rank()) {
-      my_sources.push_back(source);
+  std::vector<int> my_shots;
+  for (int isource = 0; isource < sources.size(); isource++) {
+    if (sources[isource]->get_islice() == mpi->get_rank()) {
+      my_sources.push_back(sources[isource]);
+      my_shots.push_back(shots.empty() ? 0 : shots[isource]);
     }
   }
 
-  // allocate source array view
+  const int nsources = my_sources.size();
+  const int ngllx = quadx.get_N();
+  const int ngllz = quadz.get_N();
+
+  // Separable sources only store their 1D interpolants
+  this->dense_index = specfem::kokkos::DeviceView1d<int>(
+      "specfem::compute::sources::dense_index", nsources);
+
+  this->h_dense_index = Kokkos::create_mirror_view(this->dense_index);
+
+  int ndense = 0;
+  for (int isource = 0; isource < nsources; isource++) {
+    this->h_dense_index(isource) =
+        my_sources[isource]->separable() ? -1 : ndense++;
+  }
+
   this->source_array = specfem::kokkos::DeviceView4d<type_real>(
-      "specfem::compute::sources::source_array", my_sources.size(),
-      quadz.get_N(), quadx.get_N(), ndim);
+      "specfem::compute::sources::source_array", ndense, ngllz, ngllx, ndim);
 
   this->h_source_array = Kokkos::create_mirror_view(this->source_array);
 
+  this->hxis = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::compute::sources::hxis", nsources, ngllx);
+
+  this->h_hxis = Kokkos::create_mirror_view(this->hxis);
+
+  this->hgammas = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::compute::sources::hgammas", nsources, ngllz);
+
+  this->h_hgammas = Kokkos::create_mirror_view(this->hgammas);
+
+  this->components = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::compute::sources::components", nsources, ndim);
+
+  this->h_components = Kokkos::create_mirror_view(this->components);
+
   this->stf_array =
       specfem::kokkos::DeviceView1d<specfem::forcing_function::stf_storage>(
-          "specfem::compute::sources::stf_array", my_sources.size());
+          "specfem::compute::sources::stf_array", nsources);
 
   this->h_stf_array = Kokkos::create_mirror_view(this->stf_array);
 
   this->ispec_array = specfem::kokkos::DeviceView1d<int>(
-      "specfem::compute::sources::ispec_array", my_sources.size());
+      "specfem::compute::sources::ispec_array", nsources);
 
   this->h_ispec_array = Kokkos::create_mirror_view(ispec_array);
 
+  this->shot_array = specfem::kokkos::DeviceView1d<int>(
+      "specfem::compute::sources::shot_array", nsources);
+
+  this->h_shot_array = Kokkos::create_mirror_view(shot_array);
+
+  // Elements on the axis are interpolated at the GLJ points along xi
+  const bool axisymmetric = is_on_the_axis.extent(0) > 0;
+  const specfem::quadrature::quadrature quadglj =
+      axisymmetric ? specfem::quadrature::quadrature(0.0, 1.0, ngllx)
+                   : specfem::quadrature::quadrature();
+
+  // The temporaries of every source reuse the chunks of a single arena
+  specfem::memory::arena arena;
+
   // store source array for sources in my islice
-  for (int isource = 0; isource < my_sources.size(); isource++) {
+  for (int isource = 0; isource < nsources; isource++) {
 
     my_sources[isource]->check_locations(xmax, xmin, zmax, zmin, mpi);
 
-    auto sv_source_array = Kokkos::subview(
-        this->h_source_array, isource, Kokkos::ALL, Kokkos::ALL, Kokkos::ALL);
-    my_sources[isource]->compute_source_array(quadx, quadz, sv_source_array);
+    const auto &quadxi =
+        (axisymmetric && is_on_the_axis(my_sources[isource]->get_ispec()))
+            ? quadglj
+            : quadx;
+    const int idense = this->h_dense_index(isource);
+    if (idense < 0) {
+      auto sv_components =
+          Kokkos::subview(this->h_components, isource, Kokkos::ALL);
+      my_sources[isource]->compute_lagrange_interpolants(
+          quadxi, quadz, Kokkos::subview(this->h_hxis, isource, Kokkos::ALL),
+          Kokkos::subview(this->h_hgammas, isource, Kokkos::ALL),
+          sv_components, wave, arena);
+      if (axisymmetric) {
+        for (int icomp = 0; icomp < ndim; icomp++)
+          sv_components(icomp) /= 2.0 * pi;
+      }
+    } else {
+      auto sv_source_array =
+          Kokkos::subview(this->h_source_array, idense, Kokkos::ALL,
+                          Kokkos::ALL, Kokkos::ALL);
+      my_sources[isource]->compute_source_array(quadxi, quadz, sv_source_array,
+                                                wave, arena);
+      if (axisymmetric) {
+        for (int iz = 0; iz < ngllz; iz++)
+          for (int ix = 0; ix < ngllx; ix++)
+            for (int icomp = 0; icomp < ndim; icomp++)
+              sv_source_array(iz, ix, icomp) /= 2.0 * pi;
+      }
+    }
 
     this->h_stf_array(isource).T = my_sources[isource]->get_stf();
     this->h_ispec_array(isource) = my_sources[isource]->get_ispec();
+    this->h_shot_array(isource) = my_shots[isource];
   }
 
   this->sync_views();
@@ -59,8 +141,126 @@ specfem::compute::sources::sources(
 
 void specfem::compute::sources::sync_views() {
   Kokkos::deep_copy(source_array, h_source_array);
+  Kokkos::deep_copy(dense_index, h_dense_index);
+  Kokkos::deep_copy(hxis, h_hxis);
+  Kokkos::deep_copy(hgammas, h_hgammas);
+  Kokkos::deep_copy(components, h_components);
   Kokkos::deep_copy(stf_array, h_stf_array);
   Kokkos::deep_copy(ispec_array, h_ispec_array);
+  Kokkos::deep_copy(shot_array, h_shot_array);
+
+  return;
+}
+
+void specfem::compute::sources::release_host_mirrors() {
+  this->h_source_array = {};
+  this->h_dense_index = {};
+  this->h_hxis = {};
+  this->h_hgammas = {};
+  this->h_components = {};
+  this->h_stf_array = {};
+  this->h_ispec_array = {};
+  this->h_shot_array = {};
+
+  return;
+}
+
+specfem::memory::usage specfem::compute::sources::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->source_array, this->h_source_array);
+  usage.add(this->dense_index, this->h_dense_index);
+  usage.add(this->hxis, this->h_hxis);
+  usage.add(this->hgammas, this->h_hgammas);
+  usage.add(this->components, this->h_components);
+  usage.add(this->stf_array, this->h_stf_array);
+  usage.add(this->ispec_array, this->h_ispec_array);
+  usage.add(this->shot_array, this->h_shot_array);
+  usage.add(this->stf_table);
+
+  return usage;
+}
+
+void specfem::compute::sources::tabulate_stf(const type_real t0,
+                                             const type_real dt,
+                                             const int nsamples,
+                                             const int max_table_size) {
+
+  if (nsamples < 2) {
+    throw std::runtime_error(
+        "Source time function table needs at least 2 samples");
+  }
+
+  if (dt <= 0.0) {
+    throw std::runtime_error(
+        "Source time function table needs a positive sampling interval");
+  }
+
+  const int nsources = this->stf_array.extent(0);
+
+  // Every chunk needs 2 rows to interpolate between samples
+  const int nchunk =
+      std::min(nsamples, std::max(2, max_table_size / std::max(1, nsources)));
+
+  this->stf_table = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::compute::sources::stf_table", nchunk, nsources);
+
+  this->stf_table_t0 = t0;
+  this->stf_table_dt = dt;
+  this->stf_table_nsamples = nsamples;
+
+  this->compute_stf_table(0);
+
+  return;
+}
+
+void specfem::compute::sources::update_stf_table(const type_real t) {
+
+  if (!this->stf_tabulated() || this->stf_table_resident())
+    return;
+
+  type_real weight;
+  const int isample = specfem::compute::stf_table_sample(
+      t, this->stf_table_t0, this->stf_table_dt, this->stf_table_nsamples,
+      weight);
+
+  const int nchunk = this->stf_table.extent(0);
+
+  if (isample >= this->stf_table_start &&
+      isample + 1 < this->stf_table_start + nchunk)
+    return;
+
+  // Kernels launched earlier might still be reading the current chunk
+  Kokkos::fence();
+
+  this->compute_stf_table(
+      std::min(isample, this->stf_table_nsamples - nchunk));
+
+  return;
+}
+
+void specfem::compute::sources::compute_stf_table(const int istart) {
+
+  const int nchunk = this->stf_table.extent(0);
+  const int nsources = this->stf_table.extent(1);
+  const type_real t0 = this->stf_table_t0;
+  const type_real dt = this->stf_table_dt;
+  const auto stf_array = this->stf_array;
+  const auto stf_table = this->stf_table;
+
+  this->stf_table_start = istart;
+
+  if (nsources == 0)
+    return;
+
+  Kokkos::parallel_for(
+      "specfem::compute::sources::compute_stf_table",
+      specfem::kokkos::DeviceMDrange<2>({ 0, 0 }, { nchunk, nsources }),
+      KOKKOS_LAMBDA(const int irow, const int isource) {
+        const type_real t = t0 + static_cast<type_real>(istart + irow) * dt;
+        stf_table(irow, isource) = stf_array(isource).T->compute(t);
+      });
+
+  Kokkos::fence();
 
   return;
 }
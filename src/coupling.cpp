@@ -0,0 +1,216 @@
+#include "../include/coupling.h"
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/domain.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/quadrature.h"
+#include "../include/surfaces.h"
+#include <Kokkos_Core.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+// Side of the acoustic element shared with the elastic element. Sides are
+// numbered bottom, right, top and left, side k joining corners k and k + 1
+static int shared_side(const specfem::kokkos::HostView2d<int> knods,
+                       const int ispec_acoustic, const int ispec_elastic) {
+  const auto is_corner = [&](const int ipgeo) {
+    for (int ia = 0; ia < 4; ia++) {
+      if (knods(ia, ispec_elastic) == ipgeo)
+        return true;
+    }
+    return false;
+  };
+
+  for (int iside = 0; iside < 4; iside++) {
+    if (is_corner(knods(iside, ispec_acoustic)) &&
+        is_corner(knods((iside + 1) % 4, ispec_acoustic)))
+      return iside;
+  }
+
+  std::ostringstream message;
+  message << "Acoustic element " << ispec_acoustic
+          << " doesn't share an edge with elastic element " << ispec_elastic;
+  throw std::runtime_error(message.str());
+}
+
+specfem::coupling::fluid_solid::fluid_solid(
+    const specfem::surfaces::fluid_solid_edges &edges,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::compute::compute *compute,
+    const specfem::quadrature::quadrature *quadx,
+    const specfem::quadrature::quadrature *quadz,
+    specfem::Domain::Acoustic *fluid, specfem::Domain::Elastic *solid,
+    const int nshots)
+    : nshots(nshots), fluid(fluid), solid(solid) {
+
+  const auto h_ibool = compute->h_ibool;
+  const auto coord = compute->coordinates.coord;
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  const int nglob = coord.extent(1);
+  const int nedges = edges.nedges();
+  const auto wxgll = quadx->get_hw();
+  const auto wzgll = quadz->get_hw();
+  const auto hprime_xx = quadx->get_hhprime();
+  const auto hprime_zz = quadz->get_hhprime();
+
+  // Acoustic number of every global point, -1 outside the fluid
+  std::vector<int> acoustic_number(nglob, -1);
+  const auto global_index = fluid->get_host_global_index();
+  for (int iacoustic = 0; iacoustic < global_index.extent(0); iacoustic++)
+    acoustic_number[global_index(iacoustic)] = iacoustic;
+
+  std::vector<int> fluid_points;
+  std::vector<int> solid_points;
+  std::vector<type_real> normals;
+
+  for (int iedge = 0; iedge < nedges; iedge++) {
+    const int ispec = edges.ispec_acoustic(iedge);
+    const int iside =
+        shared_side(knods, ispec, edges.ispec_elastic(iedge));
+
+    // Points of bottom and top sides run along xi, points of right and left
+    // sides along gamma
+    const bool along_xi = (iside % 2 == 0);
+    const int ngll = along_xi ? ngllx : ngllz;
+    const auto point = [&](const int i, int &iz, int &ix) {
+      iz = (iside == 0) ? 0 : (iside == 2) ? ngllz - 1 : i;
+      ix = (iside == 3) ? 0 : (iside == 1) ? ngllx - 1 : i;
+    };
+
+    for (int i = 0; i < ngll; i++) {
+      // Tangent along the side, oriented with xi or gamma
+      type_real dx = 0.0;
+      type_real dz = 0.0;
+      for (int l = 0; l < ngll; l++) {
+        int iz, ix;
+        point(l, iz, ix);
+        const int iglob = h_ibool(ispec, iz, ix);
+        const type_real hprime = along_xi ? hprime_xx(i, l) : hprime_zz(i, l);
+        dx += hprime * coord(0, iglob);
+        dz += hprime * coord(1, iglob);
+      }
+
+      // The reference element lies to the left of the tangent on bottom and
+      // right sides, hence the outward normal is the tangent rotated
+      // clockwise. Normals of top and left sides are rotated counterclockwise
+      const type_real sign = (iside < 2) ? 1.0 : -1.0;
+      const type_real weight = along_xi ? wxgll(i) : wzgll(i);
+
+      int iz, ix;
+      point(i, iz, ix);
+      const int iglob = h_ibool(ispec, iz, ix);
+      if (acoustic_number[iglob] < 0) {
+        std::ostringstream message;
+        message << "Fluid-solid edge " << iedge
+                << " isn't part of the acoustic domain";
+        throw std::runtime_error(message.str());
+      }
+      fluid_points.push_back(acoustic_number[iglob]);
+      solid_points.push_back(iglob);
+      normals.push_back(sign * weight * dz);
+      normals.push_back(-1.0 * sign * weight * dx);
+    }
+  }
+
+  this->npoints = fluid_points.size();
+  this->fluid_index = specfem::kokkos::DeviceView1d<int>(
+      "specfem::coupling::fluid_solid::fluid_index", this->npoints);
+  this->solid_index = specfem::kokkos::DeviceView1d<int>(
+      "specfem::coupling::fluid_solid::solid_index", this->npoints);
+  this->normal = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::coupling::fluid_solid::normal", this->npoints, 2);
+  this->h_normal = Kokkos::create_mirror_view(normal);
+
+  const auto h_fluid_index = Kokkos::create_mirror_view(fluid_index);
+  const auto h_solid_index = Kokkos::create_mirror_view(solid_index);
+  for (int ipoint = 0; ipoint < this->npoints; ipoint++) {
+    h_fluid_index(ipoint) = fluid_points[ipoint];
+    h_solid_index(ipoint) = solid_points[ipoint];
+    this->h_normal(ipoint, 0) = normals[2 * ipoint];
+    this->h_normal(ipoint, 1) = normals[2 * ipoint + 1];
+  }
+
+  Kokkos::deep_copy(fluid_index, h_fluid_index);
+  Kokkos::deep_copy(solid_index, h_solid_index);
+  Kokkos::deep_copy(normal, h_normal);
+
+  return;
+}
+
+void specfem::coupling::fluid_solid::compute_fluid_coupling(
+    const specfem::kokkos::DevExecSpace &exec_space) const {
+
+  if (this->npoints == 0)
+    return;
+
+  const auto fluid_index = this->fluid_index;
+  const auto solid_index = this->solid_index;
+  const auto normal = this->normal;
+  const auto displacement = this->solid->get_field();
+  const auto potential_dot_dot = this->fluid->get_field_dot_dot();
+  const int nshots = this->nshots;
+
+  // Corners of the edges are shared by two edges
+  Kokkos::parallel_for(
+      "specfem::coupling::fluid_solid::compute_fluid_coupling",
+      specfem::kokkos::DeviceRange(exec_space, 0, this->npoints),
+      KOKKOS_LAMBDA(const int ipoint) {
+        const int iacoustic = fluid_index(ipoint);
+        const int iglob = solid_index(ipoint);
+        const type_real nx = normal(ipoint, 0);
+        const type_real nz = normal(ipoint, 1);
+        for (int ishot = 0; ishot < nshots; ishot++) {
+          const type_real displacement_n =
+              nx * displacement(iglob, 2 * ishot) +
+              nz * displacement(iglob, 2 * ishot + 1);
+          Kokkos::atomic_add(&potential_dot_dot(iacoustic, ishot),
+                             displacement_n);
+        }
+      });
+
+  return;
+}
+
+void specfem::coupling::fluid_solid::compute_solid_coupling(
+    const specfem::kokkos::DevExecSpace &exec_space) const {
+
+  if (this->npoints == 0)
+    return;
+
+  const auto fluid_index = this->fluid_index;
+  const auto solid_index = this->solid_index;
+  const auto normal = this->normal;
+  const auto acceleration = this->solid->get_field_dot_dot();
+  const auto potential_dot_dot = this->fluid->get_field_dot_dot();
+  const int nshots = this->nshots;
+
+  Kokkos::parallel_for(
+      "specfem::coupling::fluid_solid::compute_solid_coupling",
+      specfem::kokkos::DeviceRange(exec_space, 0, this->npoints),
+      KOKKOS_LAMBDA(const int ipoint) {
+        const int iacoustic = fluid_index(ipoint);
+        const int iglob = solid_index(ipoint);
+        const type_real nx = normal(ipoint, 0);
+        const type_real nz = normal(ipoint, 1);
+        for (int ishot = 0; ishot < nshots; ishot++) {
+          // Pressure is the opposite of the second derivative of potential
+          const type_real pressure = -1.0 * potential_dot_dot(iacoustic, ishot);
+          Kokkos::atomic_add(&acceleration(iglob, 2 * ishot), pressure * nx);
+          Kokkos::atomic_add(&acceleration(iglob, 2 * ishot + 1),
+                             pressure * nz);
+        }
+      });
+
+  return;
+}
+
+specfem::memory::usage specfem::coupling::fluid_solid::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->fluid_index);
+  usage.add(this->solid_index);
+  usage.add(this->normal, this->h_normal);
+
+  return usage;
+}
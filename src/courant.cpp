@@ -0,0 +1,141 @@
+#include "../include/courant.h"
+#include "../include/kokkos_abstractions.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+specfem::courant::stable_timestep specfem::courant::compute_stable_timestep(
+    const specfem::kokkos::HostView2d<type_real> coord,
+    const specfem::kokkos::HostElementMirror3d<int> ibool,
+    const specfem::kokkos::HostElementMirror3d<type_real> rho,
+    const specfem::kokkos::HostElementView3d<type_real> rho_vp,
+    const specfem::kokkos::HostElementView3d<type_real> rho_vs,
+    const int nreport) {
+
+  const int nspec = ibool.extent(0);
+  const int ngllz = ibool.extent(1);
+  const int ngllx = ibool.extent(2);
+
+  std::vector<type_real> dt(nspec), vmax(nspec), dmin(nspec);
+
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    type_real vmax_elem = 0.0;
+    type_real dmin_elem = std::numeric_limits<type_real>::max();
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const type_real rhol = rho(ispec, iz, ix);
+        if (rhol > 0.0) {
+          const type_real vp = rho_vp(ispec, iz, ix) / rhol;
+          const type_real vs = rho_vs(ispec, iz, ix) / rhol;
+          vmax_elem = std::max(vmax_elem, std::max(vp, vs));
+        }
+
+        const int iglob = ibool(ispec, iz, ix);
+        // distance to the next GLL point along xi and gamma
+        if (ix + 1 < ngllx) {
+          const int jglob = ibool(ispec, iz, ix + 1);
+          const type_real dx = coord(0, jglob) - coord(0, iglob);
+          const type_real dz = coord(1, jglob) - coord(1, iglob);
+          dmin_elem = std::min(dmin_elem, std::sqrt(dx * dx + dz * dz));
+        }
+        if (iz + 1 < ngllz) {
+          const int jglob = ibool(ispec, iz + 1, ix);
+          const type_real dx = coord(0, jglob) - coord(0, iglob);
+          const type_real dz = coord(1, jglob) - coord(1, iglob);
+          dmin_elem = std::min(dmin_elem, std::sqrt(dx * dx + dz * dz));
+        }
+      }
+    }
+
+    vmax[ispec] = vmax_elem;
+    dmin[ispec] = dmin_elem;
+    dt[ispec] = (vmax_elem > 0.0)
+                    ? specfem::courant::courant_number_max * dmin_elem /
+                          vmax_elem
+                    : std::numeric_limits<type_real>::max();
+  }
+
+  std::vector<int> order(nspec);
+  std::iota(order.begin(), order.end(), 0);
+  const int nlimiting = std::min(nreport, nspec);
+  std::partial_sort(
+      order.begin(), order.begin() + nlimiting, order.end(),
+      [&dt](const int a, const int b) { return dt[a] < dt[b]; });
+
+  if (nspec == 0 || dt[order[0]] == std::numeric_limits<type_real>::max()) {
+    throw std::runtime_error(
+        "Could not estimate stable time step. No element has a positive wave "
+        "speed");
+  }
+
+  specfem::courant::stable_timestep timestep;
+  timestep.dt = dt[order[0]];
+  timestep.spectral_element_dt = dt;
+  for (int i = 0; i < nlimiting; i++) {
+    const int ispec = order[i];
+    timestep.limiting_elements.push_back(ispec);
+    timestep.element_dt.push_back(dt[ispec]);
+    timestep.element_vmax.push_back(vmax[ispec]);
+    timestep.element_dmin.push_back(dmin[ispec]);
+  }
+
+  return timestep;
+}
+
+std::vector<int> specfem::courant::compute_element_levels(
+    const std::vector<type_real> &element_dt, const type_real dt,
+    const int max_levels) {
+
+  if (max_levels < 1) {
+    throw std::runtime_error("Number of time stepping levels must be >= 1");
+  }
+
+  const int nspec = element_dt.size();
+  std::vector<int> levels(nspec);
+
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    int level = 0;
+    type_real dt_level = dt;
+    while (dt_level > element_dt[ispec] && level < max_levels - 1) {
+      dt_level /= 2.0;
+      level++;
+    }
+
+    if (dt_level > element_dt[ispec]) {
+      std::ostringstream message;
+      message << "dt = " << dt << " requires more than " << max_levels
+              << " time stepping levels to be stable in element " << ispec
+              << " with stable time step " << element_dt[ispec];
+      throw std::runtime_error(message.str());
+    }
+
+    levels[ispec] = level;
+  }
+
+  return levels;
+}
+
+std::string specfem::courant::stable_timestep::print() const {
+  std::ostringstream message;
+
+  message << "Stable time step:\n"
+          << "------------------------------\n"
+          << "- Courant number = " << specfem::courant::courant_number_max
+          << "\n"
+          << "- Maximum stable dt = " << this->dt << "\n"
+          << "- Limiting elements:\n";
+
+  for (int i = 0; i < this->limiting_elements.size(); i++) {
+    message << "    ispec = " << this->limiting_elements[i]
+            << ", dt = " << this->element_dt[i]
+            << ", max velocity = " << this->element_vmax[i]
+            << ", min GLL distance = " << this->element_dmin[i] << "\n";
+  }
+
+  return message.str();
+}
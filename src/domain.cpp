@@ -1,27 +1,142 @@
 #include "../include/domain.h"
+#include "../include/attenuation.h"
+#include "../include/coloring.h"
 #include "../include/compute.h"
 #include "../include/config.h"
 #include "../include/enums.h"
+#include "../include/first_touch.h"
 #include "../include/globals.h"
+#include "../include/gll_tables.h"
 #include "../include/kokkos_abstractions.h"
 #include "../include/quadrature.h"
 #include <Kokkos_Core.hpp>
 #include <Kokkos_ScatterView.hpp>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+// Vectorize loops over element lanes of the host stiffness kernel
+#if defined(KOKKOS_ENABLE_OPENMP)
+#define SPECFEM_SIMD_LOOP _Pragma("omp simd")
+#else
+#define SPECFEM_SIMD_LOOP
+#endif
+
+// Number of source time functions of a group of sources held in scratch
+// memory at once by the source kernel
+static constexpr int source_chunk = 64;
+
+// Number of field components stored for a wave type. SH waves only have the
+// out of plane displacement
+static int field_components(const int ndim, const specfem::wave::type wave) {
+  return (wave == specfem::wave::sh) ? 1 : ndim;
+}
+
+// Interpolated displacement, velocity and acceleration of a receiver,
+// indexed by (specfem::seismogram::type, component)
+struct receiver_sample {
+  type_real value[3][2];
+
+  KOKKOS_INLINE_FUNCTION receiver_sample() {
+    for (int itype = 0; itype < 3; itype++)
+      for (int icomp = 0; icomp < 2; icomp++)
+        value[itype][icomp] = 0.0;
+  }
+
+  KOKKOS_INLINE_FUNCTION receiver_sample &
+  operator+=(const receiver_sample &rhs) {
+    for (int itype = 0; itype < 3; itype++)
+      for (int icomp = 0; icomp < 2; icomp++)
+        value[itype][icomp] += rhs.value[itype][icomp];
+    return *this;
+  }
+};
+
+namespace Kokkos {
+template <> struct reduction_identity<receiver_sample> {
+  KOKKOS_INLINE_FUNCTION static receiver_sample sum() {
+    return receiver_sample();
+  }
+};
+} // namespace Kokkos
+
+// Batched products of the first nbatch NPAD x NPAD tiles computed by a team:
+// xi(b) = a(b) * right and gamma(b) = left * b(b). Trip counts are fixed and
+// zero padded entries of the operands stay zero in the products
+template <int NPAD, typename TileView, typename OperatorView>
+static KOKKOS_INLINE_FUNCTION void
+team_tile_products(const specfem::kokkos::DeviceTeam::member_type &team_member,
+                   const int nbatch, const TileView &a,
+                   const OperatorView &right, const TileView &b,
+                   const OperatorView &left, const TileView &xi,
+                   const TileView &gamma) {
+  constexpr int NPAD2 = NPAD * NPAD;
+  Kokkos::parallel_for(
+      Kokkos::TeamThreadRange(team_member, nbatch * NPAD2),
+      [=](const int index) {
+        const int ibatch = index / NPAD2;
+        const int i = (index % NPAD2) / NPAD;
+        const int j = index % NPAD;
+
+        type_accum sum_xi = 0;
+        type_accum sum_gamma = 0;
+        for (int k = 0; k < NPAD; k++) {
+          sum_xi += a(ibatch, i, k) * right(k, j);
+          sum_gamma += left(i, k) * b(ibatch, k, j);
+        }
+        xi(ibatch, i, j) = sum_xi;
+        gamma(ibatch, i, j) = sum_gamma;
+      });
+}
+
+// Flag elements (ispec) containing a point shared with a neighboring rank
+static std::vector<bool>
+interface_elements(const specfem::kokkos::HostElementMirror3d<int> h_ibool,
+                   const int nglob, const specfem::interfaces::halo *halo) {
+  const int nspec = h_ibool.extent(0);
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  std::vector<bool> elements(nspec, false);
+
+  if (halo == nullptr)
+    return elements;
+
+  const auto h_points = halo->get_host_points();
+  const int npoints = h_points.extent(0);
+  std::vector<bool> interface_point(nglob, false);
+  for (int ipoint = 0; ipoint < npoints; ipoint++)
+    interface_point[h_points(ipoint)] = true;
+
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        if (interface_point[h_ibool(ispec, iz, ix)])
+          elements[ispec] = true;
+      }
+    }
+  }
+
+  return elements;
+}
 
 specfem::Domain::Elastic::Elastic(const int ndim, const int nglob)
-    : field(specfem::kokkos::DeviceView2d<type_real>(
+    : field(specfem::kokkos::DeviceFieldView2d<type_real>(
           "specfem::Domain::Elastic::field", nglob, ndim)),
-      field_dot(specfem::kokkos::DeviceView2d<type_real>(
+      field_dot(specfem::kokkos::DeviceFieldView2d<type_real>(
           "specfem::Domain::Elastic::field_dot", nglob, ndim)),
-      field_dot_dot(specfem::kokkos::DeviceView2d<type_real>(
+      field_dot_dot(specfem::kokkos::DeviceFieldView2d<type_real>(
           "specfem::Domain::Elastic::field_dot_dot", nglob, ndim)),
-      rmass_inverse(specfem::kokkos::DeviceView2d<type_real>(
-          "specfem::Domain::Elastic::rmass_inverse", nglob, ndim)) {
-
-  this->h_field = Kokkos::create_mirror_view(this->field);
-  this->h_field_dot = Kokkos::create_mirror_view(this->field_dot);
-  this->h_field_dot_dot = Kokkos::create_mirror_view(this->field_dot_dot);
-  this->h_rmass_inverse = Kokkos::create_mirror_view(this->rmass_inverse);
+      rmass_inverse(specfem::kokkos::DeviceView1d<type_real>(
+          "specfem::Domain::Elastic::rmass_inverse", nglob)),
+      halo(nullptr), nelem_outer(0), ncolors_outer(0), nelem_structured(0),
+      ngll_specialization(0), batched_contractions(false), host_lanes(true),
+      assembly(specfem::assembly::atomic), packed_element_data(false),
+      quantized_element_data(false), wave(specfem::wave::p_sv), nshots(1),
+      active_elements(false), nelem_host(0), n_sls(0),
+      attenuation_dispersion(0.0) {
 
   return;
 }
@@ -32,67 +147,415 @@ specfem::Domain::Elastic::Elastic(
     specfem::compute::partial_derivatives *partial_derivatives,
     specfem::compute::sources *sources, specfem::compute::receivers *receivers,
     specfem::quadrature::quadrature *quadx,
-    specfem::quadrature::quadrature *quadz)
-    : field(specfem::kokkos::DeviceView2d<type_real>(
-          "specfem::Domain::Elastic::field", nglob, ndim)),
-      field_dot(specfem::kokkos::DeviceView2d<type_real>(
-          "specfem::Domain::Elastic::field_dot", nglob, ndim)),
-      field_dot_dot(specfem::kokkos::DeviceView2d<type_real>(
-          "specfem::Domain::Elastic::field_dot_dot", nglob, ndim)),
-      rmass_inverse(specfem::kokkos::DeviceView2d<type_real>(
-          "specfem::Domain::Elastic::rmass_inverse", nglob, ndim)),
+    specfem::quadrature::quadrature *quadz,
+    const specfem::Domain::options &options, specfem::interfaces::halo *halo)
+    : field(specfem::kokkos::DeviceFieldView2d<type_real>(
+          "specfem::Domain::Elastic::field", nglob,
+          field_components(ndim, options.wave) * options.nshots)),
+      field_dot(specfem::kokkos::DeviceFieldView2d<type_real>(
+          "specfem::Domain::Elastic::field_dot", nglob,
+          field_components(ndim, options.wave) * options.nshots)),
+      field_dot_dot(specfem::kokkos::DeviceFieldView2d<type_real>(
+          "specfem::Domain::Elastic::field_dot_dot", nglob,
+          field_components(ndim, options.wave) * options.nshots)),
+      rmass_inverse(specfem::kokkos::DeviceView1d<type_real>(
+          "specfem::Domain::Elastic::rmass_inverse", nglob)),
       compute(compute), material_properties(material_properties),
       partial_derivatives(partial_derivatives), sources(sources),
-      receivers(receivers), quadx(quadx), quadz(quadz) {
-
-  this->h_field = Kokkos::create_mirror_view(this->field);
-  this->h_field_dot = Kokkos::create_mirror_view(this->field_dot);
-  this->h_field_dot_dot = Kokkos::create_mirror_view(this->field_dot_dot);
-  this->h_rmass_inverse = Kokkos::create_mirror_view(this->rmass_inverse);
+      receivers(receivers), quadx(quadx), quadz(quadz), halo(halo),
+      nelem_structured(0),
+      batched_contractions(options.batched_contractions),
+      host_lanes(options.host_lanes), assembly(options.assembly),
+      packed_element_data(options.packed_element_data ||
+                          options.quantized_element_data),
+      quantized_element_data(options.quantized_element_data),
+      wave(options.wave),
+      nshots(options.nshots), active_elements(options.active_elements),
+      autotune(options.autotune), nelem_host(0), n_sls(0),
+      attenuation_dispersion(0.0) {
 
   const auto ibool = compute->ibool;
   const int nspec = ibool.extent(0);
   const int ngllz = ibool.extent(1);
   const int ngllx = ibool.extent(2);
 
+  if (this->nshots < 1) {
+    throw std::runtime_error("Number of shots must be positive");
+  }
+
+  if (halo != nullptr && halo->get_nneighbors() > 0 &&
+      halo->get_ncomponents() != static_cast<int>(this->field.extent(1))) {
+    throw std::runtime_error(
+        "Halo doesn't match the number of field components");
+  }
+
   this->assign_views();
 
-  this->nelem_domain = 0;
+  std::vector<int> elements;
   for (int ispec = 0; ispec < nspec; ispec++) {
     if (material_properties->h_ispec_type(ispec) ==
         specfem::elements::elastic) {
-      this->nelem_domain++;
+      elements.push_back(ispec);
     }
   }
 
+  // Outer elements, which contain MPI interface points, are ordered first
+  // such that they can be exchanged while inner elements are computed
+  const std::vector<bool> outer =
+      interface_elements(compute->h_ibool, this->field.extent(0), halo);
+  const auto inner = std::stable_partition(
+      elements.begin(), elements.end(),
+      [&outer](const int ispec) { return outer[ispec]; });
+  this->nelem_outer = inner - elements.begin();
+
+  // Inner elements of structured blocks are computed by the structured
+  // kernel. Outer elements stay in ispec_domain such that MPI interface
+  // points are computed before they are exchanged
+  std::vector<int> structured;
+  if (compute->structured()) {
+    const auto tiles = compute->h_structured_tiles;
+    const auto general =
+        std::stable_partition(inner, elements.end(), [&tiles](const int ispec) {
+          return tiles(ispec, 1) == 0;
+        });
+    structured.assign(general, elements.end());
+    elements.erase(general, elements.end());
+    std::stable_sort(structured.begin(), structured.end(),
+                     [&tiles](const int a, const int b) {
+                       return tiles(a, 2) < tiles(b, 2);
+                     });
+  }
+
+  this->nelem_domain = elements.size();
   this->ispec_domain = specfem::kokkos::DeviceView1d<int>(
       "specfem::Domain::Elastic::ispec_domain", this->nelem_domain);
   this->h_ispec_domain = Kokkos::create_mirror_view(ispec_domain);
 
-  int index = 0;
-  for (int ispec = 0; ispec < nspec; ispec++) {
-    if (material_properties->h_ispec_type(ispec) ==
-        specfem::elements::elastic) {
-      this->h_ispec_domain(index) = ispec;
-      index++;
+  this->nelem_structured = structured.size();
+  this->structured_ispec = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::structured_ispec", this->nelem_structured);
+  this->h_structured_ispec = Kokkos::create_mirror_view(structured_ispec);
+  this->h_structured_offsets = std::vector<int>(5, this->nelem_structured);
+  for (int index = this->nelem_structured - 1; index >= 0; index--) {
+    const int ispec = structured[index];
+    this->h_structured_ispec(index) = ispec;
+    for (int iparity = 0; iparity <= compute->h_structured_tiles(ispec, 2);
+         iparity++)
+      this->h_structured_offsets[iparity] = index;
+  }
+  Kokkos::deep_copy(structured_ispec, h_structured_ispec);
+
+  if (this->assembly == specfem::assembly::colored) {
+    // Group elements by color, elements of the same color do not share any
+    // global quadrature point and can be assembled without atomics. Outer
+    // and inner elements are colored separately
+    this->h_color_offsets = { 0 };
+    for (const auto [istart, iend] :
+         { std::make_tuple(0, this->nelem_outer),
+           std::make_tuple(this->nelem_outer, this->nelem_domain) }) {
+      const std::vector<int> group(elements.begin() + istart,
+                                   elements.begin() + iend);
+      auto [permutation, offsets] =
+          specfem::coloring::color_elements(compute->h_ibool, group);
+      for (int index = 0; index < iend - istart; index++) {
+        this->h_ispec_domain(istart + index) = group[permutation[index]];
+      }
+      for (int icolor = 1; icolor < offsets.size(); icolor++) {
+        this->h_color_offsets.push_back(istart + offsets[icolor]);
+      }
+      if (istart == 0)
+        this->ncolors_outer = offsets.size() - 1;
     }
+    this->h_level_offsets = { 0, this->nelem_domain };
+  } else {
+    // A group of outer elements followed by a group of inner elements
+    for (int index = 0; index < this->nelem_domain; index++) {
+      this->h_ispec_domain(index) = elements[index];
+    }
+    this->h_color_offsets = { 0, this->nelem_outer, this->nelem_domain };
+    this->ncolors_outer = 1;
+    this->h_level_offsets = { 0, this->nelem_domain };
   }
 
   Kokkos::deep_copy(ispec_domain, h_ispec_domain);
 
+  // Tuned configurations are keyed by the number of elements, source groups
+  // or receivers a kernel is launched on
+  if (this->autotune)
+    this->tuning_cache = specfem::autotune::cache(options.autotune_cache);
+
+  this->set_sources(sources, receivers);
+
+  if (this->packed_element_data) {
+    this->assign_element_data();
+  }
+
+  // Select the stiffness kernel once. Specialized kernels exist only for
+  // square elements with 3 to 8 GLL points, and read the compile-time GLL
+  // tables
+  if (!options.reference_kernels && ngllx == ngllz && ngllx >= 3 &&
+      ngllx <= 8 && quadx->has_gll_table() && quadz->has_gll_table()) {
+    this->ngll_specialization = ngllx;
+  } else {
+    this->ngll_specialization = 0;
+  }
+
+  if (this->active_elements) {
+    if (this->assembly != specfem::assembly::atomic ||
+        this->packed_element_data) {
+      throw std::runtime_error("Active elements are only implemented for "
+                               "atomic assembly without packed element data");
+    }
+    // Elements of structured blocks are computed at every step and aren't
+    // neighbours of the elements of the domain
+    if (this->nelem_structured > 0) {
+      throw std::runtime_error(
+          "Active elements are not supported with structured blocks");
+    }
+    this->assign_active_elements();
+  }
+
+  // The assembled matrix replaces the stiffness kernels of every element,
+  // structured blocks included
+  if (options.assembled_operator) {
+    if (this->active_elements ||
+        (options.host_offload && !specfem::Domain::host_backend())) {
+      throw std::runtime_error("The assembled stiffness operator is not "
+                               "supported with active elements or host "
+                               "offload");
+    }
+    this->assemble_stiffness_matrix();
+  }
+
+  // Host elements are taken from inner elements, hence the host never
+  // computes MPI interface points. Host and device share the cores on host
+  // backends
+  if (options.host_offload && !specfem::Domain::host_backend()) {
+    if (this->assembly != specfem::assembly::atomic || this->active_elements ||
+        this->nshots > 1) {
+      throw std::runtime_error("Host offload is only implemented for atomic "
+                               "assembly of a single shot without active "
+                               "elements");
+    }
+    const type_real host_fraction = (options.host_fraction < 0.0)
+                                        ? this->calibrate_host_fraction()
+                                        : options.host_fraction;
+    const int nelem_host = std::min(
+        this->nelem_domain - this->nelem_outer,
+        static_cast<int>(std::lround(host_fraction * this->nelem_domain)));
+    this->assign_host_elements(std::max(nelem_host, 0));
+  }
+
+  if (this->autotune) {
+    this->stiffness_tuner = specfem::autotune::kernel(
+        "compute_forces", ngllx, this->nelem_domain, &this->tuning_cache);
+  }
+
+  // Points are first touched by the threads computing them in the stiffness
+  // kernels
+  this->place_fields();
+
   return;
 };
 
-KOKKOS_IMPL_HOST_FUNCTION
-void specfem::Domain::Elastic::assign_views() {
+specfem::Domain::Elastic::Elastic(const specfem::Domain::Elastic &domain,
+                                  specfem::compute::sources *sources,
+                                  specfem::compute::receivers *receivers)
+    : Elastic(domain) {
+
+  // Auxiliary fields of PML layers are stored by the layers
+  if (this->pml.get_nelements() > 0) {
+    throw std::runtime_error("Domains with PML layers can't be shared");
+  }
+  // Halos own the communication buffers of a single domain
+  if (this->halo && this->halo->get_nneighbors() > 0) {
+    throw std::runtime_error(
+        "Domains exchanging fields across MPI interfaces can't be shared");
+  }
+
+  const int nglob = domain.field.extent(0);
+  const int ncomponents = domain.field.extent(1);
+  this->field = specfem::kokkos::DeviceFieldView2d<type_real>(
+      "specfem::Domain::Elastic::field", nglob, ncomponents);
+  this->field_dot = specfem::kokkos::DeviceFieldView2d<type_real>(
+      "specfem::Domain::Elastic::field_dot", nglob, ncomponents);
+  this->field_dot_dot = specfem::kokkos::DeviceFieldView2d<type_real>(
+      "specfem::Domain::Elastic::field_dot_dot", nglob, ncomponents);
+  this->h_field = {};
+  this->h_field_dot = {};
+  this->h_field_dot_dot = {};
+
+  if (this->n_sls > 0) {
+    const auto &memory_variables = domain.memory_variables;
+    this->memory_variables = specfem::kokkos::DeviceView4d<type_real>(
+        "specfem::Domain::Elastic::memory_variables",
+        memory_variables.extent(0), memory_variables.extent(1),
+        memory_variables.extent(2), memory_variables.extent(3));
+  }
+
+  if (this->active_elements) {
+    this->element_state = specfem::kokkos::DeviceView1d<int>(
+        "specfem::Domain::Elastic::element_state",
+        domain.element_state.extent(0));
+    this->active_ispec = specfem::kokkos::DeviceView1d<int>(
+        "specfem::Domain::Elastic::active_ispec", this->nelem_domain);
+    this->nactive = specfem::kokkos::DeviceView1d<int>(
+        "specfem::Domain::Elastic::nactive", 1);
+    this->h_nactive = Kokkos::create_mirror_view(this->nactive);
+  }
+
+  if (this->nelem_host > 0) {
+    const int npoints = domain.host_field.extent(0);
+    this->host_field = specfem::kokkos::DeviceView2d<type_real>(
+        "specfem::Domain::Elastic::host_field", npoints, ncomponents);
+    this->h_host_field = Kokkos::create_mirror_view(this->host_field);
+    this->host_field_dot_dot = specfem::kokkos::DeviceView2d<type_real>(
+        "specfem::Domain::Elastic::host_field_dot_dot", npoints, ncomponents);
+    this->h_host_field_dot_dot =
+        Kokkos::create_mirror_view(this->host_field_dot_dot);
+  }
+
+  // Tuners of the copied domain point to its cache
+  if (this->autotune) {
+    this->stiffness_tuner = specfem::autotune::kernel(
+        "compute_forces", this->compute->ibool.extent(2), this->nelem_domain,
+        &this->tuning_cache);
+  }
+
+  this->set_sources(sources, receivers);
+  this->reset_fields();
+
+  return;
+}
+
+void specfem::Domain::Elastic::set_sources(
+    specfem::compute::sources *sources,
+    specfem::compute::receivers *receivers) {
+
+  const int nsources_local = sources->h_shot_array.extent(0);
+  for (int isource = 0; isource < nsources_local; isource++) {
+    if (sources->h_shot_array(isource) < 0 ||
+        sources->h_shot_array(isource) >= this->nshots) {
+      throw std::runtime_error("Source belongs to a shot out of range");
+    }
+  }
+
+  // Receivers are stored shot after shot
+  if (receivers->ispec_array.extent(0) % this->nshots != 0) {
+    throw std::runtime_error(
+        "Every shot needs the same receivers on a process");
+  }
+
+  this->sources = sources;
+  this->receivers = receivers;
+
+  // The domain applies the sources and records the receivers of its elements
+  // only, hence its kernels launch neither over acoustic sources nor
+  // acoustic receivers
+  const auto h_ispec_type = this->material_properties->h_ispec_type;
+  std::vector<int> sorted_sources;
+  for (int isource = 0; isource < sources->h_ispec_array.extent(0);
+       isource++) {
+    if (h_ispec_type(sources->h_ispec_array(isource)) ==
+        specfem::elements::elastic)
+      sorted_sources.push_back(isource);
+  }
+  std::vector<int> domain_receivers;
+  for (int irec = 0; irec < receivers->h_ispec_array.extent(0); irec++) {
+    if (h_ispec_type(receivers->h_ispec_array(irec)) ==
+        specfem::elements::elastic)
+      domain_receivers.push_back(irec);
+  }
+
+  this->receiver_index = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::receiver_index", domain_receivers.size());
+  this->h_receiver_index = Kokkos::create_mirror_view(receiver_index);
+  for (int index = 0; index < domain_receivers.size(); index++)
+    this->h_receiver_index(index) = domain_receivers[index];
+  Kokkos::deep_copy(receiver_index, h_receiver_index);
+
+  // Sources are grouped by element and shot. The contributions of every
+  // source of a group are accumulated in scratch memory and added to the
+  // field once
+  const int nsources = sorted_sources.size();
+  std::stable_sort(sorted_sources.begin(), sorted_sources.end(),
+                   [&sources](const int lhs, const int rhs) {
+                     return std::make_tuple(sources->h_ispec_array(lhs),
+                                            sources->h_shot_array(lhs)) <
+                            std::make_tuple(sources->h_ispec_array(rhs),
+                                            sources->h_shot_array(rhs));
+                   });
+  std::vector<int> group_offsets;
+  for (int index = 0; index < nsources; index++) {
+    const int isource = sorted_sources[index];
+    const int iprevious = sorted_sources[std::max(index - 1, 0)];
+    if (index == 0 ||
+        sources->h_ispec_array(isource) !=
+            sources->h_ispec_array(iprevious) ||
+        sources->h_shot_array(isource) != sources->h_shot_array(iprevious))
+      group_offsets.push_back(index);
+  }
+  group_offsets.push_back(nsources);
+  const int ngroups = group_offsets.size() - 1;
+
+  this->source_order = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::source_order", nsources);
+  this->h_source_order = Kokkos::create_mirror_view(source_order);
+  this->source_group_offsets = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::source_group_offsets", ngroups + 1);
+  this->h_source_group_offsets =
+      Kokkos::create_mirror_view(source_group_offsets);
+
+  // Groups are applied in the order of group_permutation
+  std::vector<int> group_permutation(ngroups);
+  std::iota(group_permutation.begin(), group_permutation.end(), 0);
+
+  if (this->assembly == specfem::assembly::colored) {
+    // Groups of the same element and different shots are assigned different
+    // colors
+    std::vector<int> source_elements;
+    for (int igroup = 0; igroup < ngroups; igroup++) {
+      source_elements.push_back(
+          sources->h_ispec_array(sorted_sources[group_offsets[igroup]]));
+    }
+    auto [source_permutation, source_offsets] =
+        specfem::coloring::color_elements(compute->h_ibool, source_elements);
+    group_permutation = source_permutation;
+    this->h_source_color_offsets = source_offsets;
+  } else {
+    this->h_source_color_offsets = { 0, ngroups };
+  }
+
+  int iordered = 0;
+  this->h_source_group_offsets(0) = 0;
+  for (int igroup = 0; igroup < ngroups; igroup++) {
+    const int jgroup = group_permutation[igroup];
+    for (int jndex = group_offsets[jgroup]; jndex < group_offsets[jgroup + 1];
+         jndex++) {
+      this->h_source_order(iordered++) = sorted_sources[jndex];
+    }
+    this->h_source_group_offsets(igroup + 1) = iordered;
+  }
+
+  Kokkos::deep_copy(source_order, h_source_order);
+  Kokkos::deep_copy(source_group_offsets, h_source_group_offsets);
+
+  if (this->autotune) {
+    const int ngllx = this->compute->ibool.extent(2);
+    this->source_tuner = specfem::autotune::kernel(
+        "compute_source_interaction", ngllx, ngroups, &this->tuning_cache);
+    this->seismogram_tuner = specfem::autotune::kernel(
+        "compute_seismogram", ngllx, domain_receivers.size(),
+        &this->tuning_cache);
+  }
+
+  return;
+}
+
+void specfem::Domain::Elastic::reset_fields() {
 
-  const auto ibool = compute->ibool;
-  const int nspec = ibool.extent(0);
-  const int ngllz = ibool.extent(1);
-  const int ngllx = ibool.extent(2);
   const int nglob = field.extent(0);
   const int ndim = field.extent(1);
-  // Initialize views
   Kokkos::parallel_for(
       "specfem::Domain::Elastic::initiaze_views",
       specfem::kokkos::DeviceMDrange<2>({ 0, 0 }, { nglob, ndim }),
@@ -100,16 +563,48 @@ void specfem::Domain::Elastic::assign_views() {
         this->field(iglob, idim) = 0;
         this->field_dot(iglob, idim) = 0;
         this->field_dot_dot(iglob, idim) = 0;
-        this->rmass_inverse(iglob, idim) = 0;
       });
 
+  if (this->n_sls > 0)
+    Kokkos::deep_copy(this->memory_variables, 0.0);
+
+  // Active elements are valid only for a medium at rest
+  if (this->active_elements && this->element_state.extent(0) > 0)
+    this->reset_active_elements();
+
+  return;
+}
+
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::Domain::Elastic::assign_views() {
+
+  const auto ibool = compute->ibool;
+  const int nspec = ibool.extent(0);
+  const int ngllz = ibool.extent(1);
+  const int ngllx = ibool.extent(2);
+  const int nglob = field.extent(0);
+  const int ndim = field.extent(1);
+  // Initialize views
+  this->reset_fields();
+
+  Kokkos::parallel_for(
+      "specfem::Domain::Elastic::initiaze_rmass_inverse",
+      specfem::kokkos::DeviceRange(0, nglob),
+      KOKKOS_CLASS_LAMBDA(const int iglob) { this->rmass_inverse(iglob) = 0; });
+
   // Compute the mass matrix
-  specfem::kokkos::DeviceScatterView2d<type_real> results(rmass_inverse);
+  specfem::kokkos::DeviceScatterView1d<type_real> results(rmass_inverse);
   auto wxgll = quadx->get_w();
   auto wzgll = quadz->get_w();
-  auto rho = this->material_properties->rho;
+  auto rho = this->material_properties->get_rho();
   auto ispec_type = this->material_properties->ispec_type;
-  auto jacobian = this->partial_derivatives->jacobian;
+  auto jacobian = this->partial_derivatives->get_jacobian();
+  // Axisymmetric masses are weighted by the radius, elements on the axis use
+  // the GLJ weights along xi
+  const bool axisymmetric = this->is_axisymmetric();
+  const auto axial = this->axial;
+  const auto wxglj = this->wxglj;
+  const auto radius_factor = this->radius_factor;
   Kokkos::parallel_for(
       "specfem::Domain::Elastic::compute_mass_matrix",
       specfem::kokkos::DeviceMDrange<3>({ 0, 0, 0 }, { nspec, ngllz, ngllx }),
@@ -118,38 +613,139 @@ void specfem::Domain::Elastic::assign_views() {
         type_real rhol = rho(ispec, iz, ix);
         auto access = results.access();
         if (ispec_type(ispec) == specfem::elements::elastic) {
-          access(iglob, 0) +=
-              wxgll(ix) * wzgll(iz) * rhol * jacobian(ispec, iz, ix);
-          access(iglob, 1) +=
-              wxgll(ix) * wzgll(iz) * rhol * jacobian(ispec, iz, ix);
+          if (axisymmetric) {
+            const type_real wx = axial(ispec) ? wxglj(ix) : wxgll(ix);
+            access(iglob) += wx * wzgll(iz) * rhol * jacobian(ispec, iz, ix) *
+                             radius_factor(ispec, iz, ix);
+          } else {
+            access(iglob) +=
+                wxgll(ix) * wzgll(iz) * rhol * jacobian(ispec, iz, ix);
+          }
         }
       });
 
   Kokkos::Experimental::contribute(rmass_inverse, results);
 
+  // Points on MPI interfaces include the mass of elements on neighboring
+  // ranks
+  if (this->halo != nullptr)
+    this->halo->assemble(rmass_inverse);
+
   // invert the mass matrix
   Kokkos::parallel_for(
       "specfem::Domain::Elastic::Invert_mass_matrix",
       specfem::kokkos::DeviceRange(0, nglob),
       KOKKOS_CLASS_LAMBDA(const int iglob) {
-        if (rmass_inverse(iglob, 0) > 0.0) {
-          rmass_inverse(iglob, 0) = 1.0 / rmass_inverse(iglob, 0);
-          rmass_inverse(iglob, 1) = 1.0 / rmass_inverse(iglob, 1);
+        if (rmass_inverse(iglob) > 0.0) {
+          rmass_inverse(iglob) = 1.0 / rmass_inverse(iglob);
         } else {
-          rmass_inverse(iglob, 0) = 1.0;
-          rmass_inverse(iglob, 1) = 1.0;
+          rmass_inverse(iglob) = 1.0;
         }
       });
 
   return;
 }
 
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::Domain::Elastic::assign_element_data() {
+
+  const int ngllz = this->compute->ibool.extent(1);
+  const int ngllx = this->compute->ibool.extent(2);
+  const int nelem_domain = this->nelem_domain;
+  const auto ispec_domain = this->ispec_domain;
+  const auto xix = this->partial_derivatives->get_xix();
+  const auto xiz = this->partial_derivatives->get_xiz();
+  const auto gammax = this->partial_derivatives->get_gammax();
+  const auto gammaz = this->partial_derivatives->get_gammaz();
+  const auto jacobian = this->partial_derivatives->get_jacobian();
+  const auto mu = this->material_properties->get_mu();
+  const auto lambdaplus2mu = this->material_properties->get_lambdaplus2mu();
+
+  this->element_data = specfem::kokkos::DeviceView4d<type_real>(
+      "specfem::Domain::Elastic::element_data", nelem_domain,
+      specfem::Domain::packed::nfields, ngllz, ngllx);
+
+  const auto element_data = this->element_data;
+
+  Kokkos::parallel_for(
+      "specfem::Domain::Elastic::assign_element_data",
+      specfem::kokkos::DeviceMDrange<3>({ 0, 0, 0 },
+                                        { nelem_domain, ngllz, ngllx }),
+      KOKKOS_LAMBDA(const int ielement, const int iz, const int ix) {
+        const int ispec = ispec_domain(ielement);
+        element_data(ielement, specfem::Domain::packed::xix, iz, ix) =
+            xix(ispec, iz, ix);
+        element_data(ielement, specfem::Domain::packed::xiz, iz, ix) =
+            xiz(ispec, iz, ix);
+        element_data(ielement, specfem::Domain::packed::gammax, iz, ix) =
+            gammax(ispec, iz, ix);
+        element_data(ielement, specfem::Domain::packed::gammaz, iz, ix) =
+            gammaz(ispec, iz, ix);
+        element_data(ielement, specfem::Domain::packed::jacobian, iz, ix) =
+            jacobian(ispec, iz, ix);
+        element_data(ielement, specfem::Domain::packed::mu, iz, ix) =
+            mu(ispec, iz, ix);
+        element_data(ielement, specfem::Domain::packed::lambdaplus2mu, iz,
+                     ix) = lambdaplus2mu(ispec, iz, ix);
+      });
+
+  Kokkos::fence();
+
+  if (!this->quantized_element_data)
+    return;
+
+  // Every field of every element is scaled by its largest magnitude, hence
+  // the relative error of the largest value is 1 / 65534
+  constexpr type_real qmax = 32767.0;
+  const int nfields = specfem::Domain::packed::nfields;
+  this->element_data_scale = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::Domain::Elastic::element_data_scale", nelem_domain, nfields);
+  this->quantized_element_data_values =
+      specfem::kokkos::DeviceView4d<std::int16_t>(
+          "specfem::Domain::Elastic::quantized_element_data", nelem_domain,
+          nfields, ngllz, ngllx);
+
+  const auto scale = this->element_data_scale;
+  const auto quantized = this->quantized_element_data_values;
+
+  Kokkos::parallel_for(
+      "specfem::Domain::Elastic::quantize_element_data",
+      specfem::kokkos::DeviceMDrange<2>({ 0, 0 }, { nelem_domain, nfields }),
+      KOKKOS_LAMBDA(const int ielement, const int ifield) {
+        type_real amax = 0.0;
+        for (int iz = 0; iz < ngllz; iz++)
+          for (int ix = 0; ix < ngllx; ix++)
+            amax = (Kokkos::fabs(element_data(ielement, ifield, iz, ix)) > amax)
+                       ? Kokkos::fabs(element_data(ielement, ifield, iz, ix))
+                       : amax;
+
+        const type_real lscale = amax / qmax;
+        scale(ielement, ifield) = lscale;
+        for (int iz = 0; iz < ngllz; iz++)
+          for (int ix = 0; ix < ngllx; ix++)
+            quantized(ielement, ifield, iz, ix) =
+                (lscale > 0.0)
+                    ? static_cast<std::int16_t>(Kokkos::round(
+                          element_data(ielement, ifield, iz, ix) / lscale))
+                    : 0;
+      });
+
+  Kokkos::fence();
+
+  // Kernels only read the quantized block
+  this->element_data = {};
+
+  return;
+}
+
 void specfem::Domain::Elastic::sync_field(specfem::sync::kind kind) {
 
+  const auto mirror = specfem::kokkos::lazy_mirror(this->h_field, this->field);
+
   if (kind == specfem::sync::DeviceToHost) {
-    Kokkos::deep_copy(h_field, field);
+    Kokkos::deep_copy(mirror, field);
   } else if (kind == specfem::sync::HostToDevice) {
-    Kokkos::deep_copy(field, h_field);
+    Kokkos::deep_copy(field, mirror);
   } else {
     throw std::runtime_error("Could not recognize the kind argument");
   }
@@ -159,10 +755,13 @@ void specfem::Domain::Elastic::sync_field(specfem::sync::kind kind) {
 
 void specfem::Domain::Elastic::sync_field_dot(specfem::sync::kind kind) {
 
+  const auto mirror =
+      specfem::kokkos::lazy_mirror(this->h_field_dot, this->field_dot);
+
   if (kind == specfem::sync::DeviceToHost) {
-    Kokkos::deep_copy(h_field_dot, field_dot);
+    Kokkos::deep_copy(mirror, field_dot);
   } else if (kind == specfem::sync::HostToDevice) {
-    Kokkos::deep_copy(field_dot, h_field_dot);
+    Kokkos::deep_copy(field_dot, mirror);
   } else {
     throw std::runtime_error("Could not recognize the kind argument");
   }
@@ -172,10 +771,13 @@ void specfem::Domain::Elastic::sync_field_dot(specfem::sync::kind kind) {
 
 void specfem::Domain::Elastic::sync_field_dot_dot(specfem::sync::kind kind) {
 
+  const auto mirror =
+      specfem::kokkos::lazy_mirror(this->h_field_dot_dot, this->field_dot_dot);
+
   if (kind == specfem::sync::DeviceToHost) {
-    Kokkos::deep_copy(h_field_dot_dot, field_dot_dot);
+    Kokkos::deep_copy(mirror, field_dot_dot);
   } else if (kind == specfem::sync::HostToDevice) {
-    Kokkos::deep_copy(field_dot_dot, h_field_dot_dot);
+    Kokkos::deep_copy(field_dot_dot, mirror);
   } else {
     throw std::runtime_error("Could not recognize the kind argument");
   }
@@ -185,10 +787,13 @@ void specfem::Domain::Elastic::sync_field_dot_dot(specfem::sync::kind kind) {
 
 void specfem::Domain::Elastic::sync_rmass_inverse(specfem::sync::kind kind) {
 
+  const auto mirror =
+      specfem::kokkos::lazy_mirror(this->h_rmass_inverse, this->rmass_inverse);
+
   if (kind == specfem::sync::DeviceToHost) {
-    Kokkos::deep_copy(h_rmass_inverse, rmass_inverse);
+    Kokkos::deep_copy(mirror, rmass_inverse);
   } else if (kind == specfem::sync::HostToDevice) {
-    Kokkos::deep_copy(rmass_inverse, h_rmass_inverse);
+    Kokkos::deep_copy(rmass_inverse, mirror);
   } else {
     throw std::runtime_error("Could not recognize the kind argument");
   }
@@ -196,584 +801,3633 @@ void specfem::Domain::Elastic::sync_rmass_inverse(specfem::sync::kind kind) {
   return;
 }
 
-void specfem::Domain::Elastic::compute_stiffness_interaction() {
+specfem::first_touch::launches
+specfem::Domain::Elastic::get_element_launches() const {
 
-  const int ngllx = this->quadx->get_N();
-  const int ngllz = this->quadz->get_N();
-  const int ngllxz = ngllx * ngllz;
-  const auto ibool = this->compute->ibool;
-  const auto ispec_domain = this->ispec_domain;
-  const auto xix = this->partial_derivatives->xix;
-  const auto xiz = this->partial_derivatives->xiz;
-  const auto gammax = this->partial_derivatives->gammax;
-  const auto gammaz = this->partial_derivatives->gammaz;
-  const auto jacobian = this->partial_derivatives->jacobian;
-  const auto mu = this->material_properties->mu;
-  const auto lambdaplus2mu = this->material_properties->lambdaplus2mu;
-  const auto wxgll = this->quadx->get_w();
-  const auto wzgll = this->quadz->get_w();
-  const auto hprime_xx = this->quadx->get_hprime();
-  const auto hprime_zz = this->quadz->get_hprime();
+  specfem::first_touch::launches launches;
+  const int ncolors = this->h_color_offsets.size() - 1;
+  for (int icolor = 0; icolor < ncolors; icolor++) {
+    std::vector<int> elements;
+    for (int index = this->h_color_offsets[icolor];
+         index < this->h_color_offsets[icolor + 1]; index++)
+      elements.push_back(this->h_ispec_domain(index));
+    launches.push_back(elements);
+  }
 
-  int scratch_size =
-      specfem::kokkos::DeviceScratchView1d<type_real>::shmem_size(ngllx);
-  scratch_size +=
-      specfem::kokkos::DeviceScratchView1d<type_real>::shmem_size(ngllz);
-  scratch_size +=
-      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllx, ngllx);
-  scratch_size +=
-      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllz, ngllz);
-  scratch_size +=
-      2 *
-      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllx, ngllz);
-  scratch_size +=
-      3 *
-      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllx, ngllz);
-  scratch_size +=
-      4 *
-      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllx, ngllz);
+  // Structured blocks launch one kernel per parity
+  const int nparities = (this->nelem_structured > 0) ? 4 : 0;
+  for (int iparity = 0; iparity < nparities; iparity++) {
+    std::vector<int> elements;
+    for (int index = this->h_structured_offsets[iparity];
+         index < this->h_structured_offsets[iparity + 1]; index++)
+      elements.push_back(this->h_structured_ispec(index));
+    launches.push_back(elements);
+  }
 
-  Kokkos::parallel_for(
-      "specfem::Domain::Elastic::compute_forces",
-      specfem::kokkos::DeviceTeam(this->nelem_domain, Kokkos::AUTO, 1)
-          .set_scratch_size(0, Kokkos::PerTeam(scratch_size)),
-      KOKKOS_CLASS_LAMBDA(
-          const specfem::kokkos::DeviceTeam::member_type &team_member) {
-        // std::cout << team_member.league_rank() << std::endl;
-        const int ispec = ispec_domain(team_member.league_rank());
-
-        // Getting subviews for better readability
-        // This has a small perfomance hit (It should be negligible)
-        const auto sv_ibool =
-            Kokkos::subview(ibool, ispec, Kokkos::ALL, Kokkos::ALL);
-        const auto sv_xix =
-            Kokkos::subview(xix, ispec, Kokkos::ALL, Kokkos::ALL);
-        const auto sv_xiz =
-            Kokkos::subview(xiz, ispec, Kokkos::ALL, Kokkos::ALL);
-        const auto sv_gammax =
-            Kokkos::subview(gammax, ispec, Kokkos::ALL, Kokkos::ALL);
-        const auto sv_gammaz =
-            Kokkos::subview(gammaz, ispec, Kokkos::ALL, Kokkos::ALL);
-        const auto sv_jacobian =
-            Kokkos::subview(jacobian, ispec, Kokkos::ALL, Kokkos::ALL);
-        const auto sv_mu = Kokkos::subview(mu, ispec, Kokkos::ALL, Kokkos::ALL);
-        const auto sv_lambdaplus2mu =
-            Kokkos::subview(lambdaplus2mu, ispec, Kokkos::ALL, Kokkos::ALL);
+  return launches;
+}
 
-        // Assign scratch views
-        // Optional performance related scratch views
-        specfem::kokkos::DeviceScratchView1d<type_real> s_wxgll(
-            team_member.team_scratch(0), ngllx);
-        specfem::kokkos::DeviceScratchView1d<type_real> s_wzgll(
-            team_member.team_scratch(0), ngllz);
-        specfem::kokkos::DeviceScratchView2d<type_real> s_hprime_xx(
-            team_member.team_scratch(0), ngllx, ngllx);
-        specfem::kokkos::DeviceScratchView2d<type_real> s_hprime_zz(
-            team_member.team_scratch(0), ngllz, ngllz);
-        specfem::kokkos::DeviceScratchView2d<type_real> s_tempx(
-            team_member.team_scratch(0), ngllz, ngllx);
-        specfem::kokkos::DeviceScratchView2d<type_real> s_tempz(
-            team_member.team_scratch(0), ngllz, ngllx);
+void specfem::Domain::Elastic::place_fields() {
 
-        // Nacessary scratch views
-        specfem::kokkos::DeviceScratchView2d<type_real> s_sigma_xx(
-            team_member.team_scratch(0), ngllz, ngllx);
-        specfem::kokkos::DeviceScratchView2d<type_real> s_sigma_xz(
-            team_member.team_scratch(0), ngllz, ngllx);
-        specfem::kokkos::DeviceScratchView2d<type_real> s_sigma_zz(
-            team_member.team_scratch(0), ngllz, ngllx);
-        specfem::kokkos::DeviceScratchView2d<type_real> s_tempx1(
-            team_member.team_scratch(0), ngllz, ngllx);
-        specfem::kokkos::DeviceScratchView2d<type_real> s_tempz1(
-            team_member.team_scratch(0), ngllz, ngllx);
-        specfem::kokkos::DeviceScratchView2d<type_real> s_tempx3(
-            team_member.team_scratch(0), ngllz, ngllx);
-        specfem::kokkos::DeviceScratchView2d<type_real> s_tempz3(
-            team_member.team_scratch(0), ngllz, ngllx);
+  if (!specfem::Domain::host_backend())
+    return;
 
-        // -------------Load into scratch memory----------------------------
-        if (team_member.team_rank() == 0) {
+  const auto points = specfem::first_touch::point_launches(
+      this->get_element_launches(), this->compute->h_ibool,
+      this->field.extent(0));
+  specfem::first_touch::place(this->field, points);
+  specfem::first_touch::place(this->field_dot, points);
+  specfem::first_touch::place(this->field_dot_dot, points);
+  specfem::first_touch::place(this->rmass_inverse, points);
 
-          for (int ix = 0; ix < ngllx; ix++) {
-            s_wxgll(ix) = wxgll(ix);
-          }
+  this->h_field = {};
+  this->h_field_dot = {};
+  this->h_field_dot_dot = {};
+  this->h_rmass_inverse = {};
 
-          for (int iz = 0; iz < ngllz; iz++) {
-            s_wzgll(iz) = wzgll(iz);
-          }
-        }
+  return;
+}
 
-        Kokkos::parallel_for(Kokkos::TeamThreadRange(team_member, ngllxz),
-                             [=](const int xz) {
-                               const int ix = xz % ngllz;
-                               const int iz = xz / ngllz;
-                               int iglob = sv_ibool(iz, ix);
-                               s_tempx(iz, ix) = this->field(iglob, 0);
-                               s_tempz(iz, ix) = this->field(iglob, 1);
-                             });
+specfem::memory::usage specfem::Domain::Elastic::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->field, this->h_field);
+  usage.add(this->field_dot, this->h_field_dot);
+  usage.add(this->field_dot_dot, this->h_field_dot_dot);
+  usage.add(this->rmass_inverse, this->h_rmass_inverse);
+  usage.add(this->ispec_domain, this->h_ispec_domain);
+  usage.add(this->structured_ispec, this->h_structured_ispec);
+  usage.add(this->neighbor_offsets);
+  usage.add(this->neighbors);
+  usage.add(this->element_state);
+  usage.add(this->active_ispec);
+  usage.add(this->nactive, this->h_nactive);
+  usage.add(this->host_ibool);
+  usage.add(this->host_element_data);
+  usage.add(this->host_points);
+  usage.add(this->host_field, this->h_host_field);
+  usage.add(this->host_field_dot_dot, this->h_host_field_dot_dot);
+  usage.add(this->matrix_offsets);
+  usage.add(this->matrix_columns);
+  usage.add(this->matrix_values);
+  usage.add(this->element_data);
+  usage.add(this->quantized_element_data_values);
+  usage.add(this->element_data_scale);
+  usage.add(this->source_order, this->h_source_order);
+  usage.add(this->source_group_offsets, this->h_source_group_offsets);
+  usage.add(this->receiver_index, this->h_receiver_index);
+  usage.add(this->sls);
+  usage.add(this->inverse_qkappa);
+  usage.add(this->inverse_qmu);
+  usage.add(this->memory_variables);
+  usage += this->stacey.memory_usage();
+  usage += this->pml.memory_usage();
 
-        Kokkos::parallel_for(
-            Kokkos::TeamThreadRange(team_member, ngllx * ngllx),
-            [=](const int ij) {
-              const int i = ij % ngllx;
-              const int j = ij / ngllx;
-              s_hprime_xx(j, i) = hprime_xx(j, i);
-            });
+  return usage;
+}
 
-        Kokkos::parallel_for(
-            Kokkos::TeamThreadRange(team_member, ngllz * ngllz),
-            [=](const int ij) {
-              const int i = ij % ngllz;
-              const int j = ij / ngllz;
-              s_hprime_zz(j, i) = hprime_zz(j, i);
-            });
-        //----------------------------------------------------------------
+specfem::timers::cost
+specfem::Domain::Elastic::get_cost(const specfem::timers::phase phase) const {
+  const double ngll = this->quadx->get_N();
+  const double ngll2 = ngll * ngll;
+  const bool p_sv = (this->wave == specfem::wave::p_sv);
+  const double ncomponents = p_sv ? 2 : 1;
+  // Components of every shot
+  const double nvalues = this->field.extent(1);
+  constexpr double real = sizeof(type_real);
+  constexpr double index = sizeof(int);
 
-        team_member.team_barrier();
+  specfem::timers::cost cost;
+  switch (phase) {
+  case specfem::timers::stiffness: {
+    // Every row of the assembled matrix reads its entries and the field of
+    // their columns, and updates the acceleration of every shot
+    if (this->get_matrix_nnz() > 0) {
+      const double nrows = this->matrix_offsets.extent(0) - 1;
+      const double nnz = this->get_matrix_nnz();
+      cost.bytes = nnz * (index + real + this->nshots * real) +
+                   nrows * (index + 2 * this->nshots * real);
+      cost.flops = 2 * nnz * this->nshots;
+      break;
+    }
+    // Every quadrature point reads its global index, geometry and material
+    // properties once, reads the field and updates the acceleration of every
+    // shot. Flops count the gradients, stresses and weighted contractions
+    const double npoints =
+        (this->nelem_domain + this->nelem_structured) * ngll2;
+    const double ndata = p_sv ? 7 : 6;
+    const double flops = p_sv ? 16 * ngll + 48 : 8 * ngll + 21;
+    cost.bytes = npoints * (index + (ndata + 3 * nvalues) * real);
+    cost.flops = npoints * this->nshots * flops;
+    break;
+  }
+  case specfem::timers::sources: {
+    // Every source updates the acceleration at every point of its element
+    const double npoints = this->source_order.extent(0) * ngll2;
+    cost.bytes = npoints * (index + 3 * ncomponents * real);
+    cost.flops = npoints * (1 + 2 * ncomponents);
+    break;
+  }
+  case specfem::timers::seismograms: {
+    // Every receiver interpolates one field per seismogram type
+    const double npoints = this->receiver_index.extent(0) * ngll2;
+    const double ntypes = this->receivers->seismogram_types.extent(0);
+    cost.bytes = npoints * (index + ntypes * ncomponents * real);
+    cost.flops = npoints * (1 + 2 * ntypes * ncomponents);
+    break;
+  }
+  default:
+    break;
+  }
 
-        Kokkos::parallel_for(
-            Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
-              const int ix = xz % ngllz;
-              const int iz = xz / ngllz;
-
-              type_real sum_hprime_x1 = 0;
-              type_real sum_hprime_x3 = 0;
-              type_real sum_hprime_z1 = 0;
-              type_real sum_hprime_z3 = 0;
-
-              for (int l = 0; l < ngllx; l++) {
-                sum_hprime_x1 += s_hprime_xx(ix, l) * s_tempx(iz, l);
-                sum_hprime_x3 += s_hprime_xx(ix, l) * s_tempz(iz, l);
-              }
+  return cost;
+}
 
-              for (int l = 0; l < ngllz; l++) {
-                sum_hprime_z1 += s_hprime_zz(iz, l) * s_tempx(l, ix);
-                sum_hprime_z3 += s_hprime_zz(iz, l) * s_tempz(l, ix);
-              }
+void specfem::Domain::Elastic::assign_active_elements() {
 
-              const type_real xixl = sv_xix(iz, ix);
-              const type_real xizl = sv_xiz(iz, ix);
-              const type_real gammaxl = sv_gammax(iz, ix);
-              const type_real gammazl = sv_gammaz(iz, ix);
-              const type_real jacobianl = sv_jacobian(iz, ix);
+  const auto h_ibool = this->compute->h_ibool;
+  const int nspec = h_ibool.extent(0);
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  const int nglob = this->field.extent(0);
 
-              const type_real duxdxl =
-                  xixl * sum_hprime_x1 + gammaxl * sum_hprime_x3;
-              const type_real duxdzl =
-                  xizl * sum_hprime_x1 + gammazl * sum_hprime_x3;
+  // Elements of this domain containing every global point
+  std::vector<std::vector<int> > point_elements(nglob);
+  for (int index = 0; index < this->nelem_domain; index++) {
+    const int ispec = this->h_ispec_domain(index);
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        std::vector<int> &elements = point_elements[h_ibool(ispec, iz, ix)];
+        if (elements.empty() || elements.back() != ispec)
+          elements.push_back(ispec);
+      }
+    }
+  }
+
+  std::vector<std::vector<int> > element_neighbors(nspec);
+  for (int index = 0; index < this->nelem_domain; index++) {
+    const int ispec = this->h_ispec_domain(index);
+    std::vector<int> &element = element_neighbors[ispec];
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        for (const int jspec : point_elements[h_ibool(ispec, iz, ix)]) {
+          if (jspec != ispec)
+            element.push_back(jspec);
+        }
+      }
+    }
+    std::sort(element.begin(), element.end());
+    element.erase(std::unique(element.begin(), element.end()), element.end());
+  }
+
+  this->neighbor_offsets = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::neighbor_offsets", nspec + 1);
+  auto h_neighbor_offsets = Kokkos::create_mirror_view(this->neighbor_offsets);
+  h_neighbor_offsets(0) = 0;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    h_neighbor_offsets(ispec + 1) =
+        h_neighbor_offsets(ispec) + element_neighbors[ispec].size();
+  }
+
+  this->neighbors = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::neighbors", h_neighbor_offsets(nspec));
+  auto h_neighbors = Kokkos::create_mirror_view(this->neighbors);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    std::copy(element_neighbors[ispec].begin(), element_neighbors[ispec].end(),
+              h_neighbors.data() + h_neighbor_offsets(ispec));
+  }
+
+  Kokkos::deep_copy(this->neighbor_offsets, h_neighbor_offsets);
+  Kokkos::deep_copy(this->neighbors, h_neighbors);
+
+  this->element_state = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::element_state", nspec);
+  this->active_ispec = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::active_ispec", this->nelem_domain);
+  this->nactive = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::nactive", 1);
+  this->h_nactive = Kokkos::create_mirror_view(this->nactive);
+
+  this->reset_active_elements();
+
+  return;
+}
+
+void specfem::Domain::Elastic::reset_active_elements() {
+
+  const int nspec = this->compute->h_ibool.extent(0);
+
+  // Sources are the only non zero accelerations of a medium at rest, hence
+  // the source elements are the initial active elements
+  auto h_element_state = Kokkos::create_mirror_view(this->element_state);
+  auto h_active_ispec = Kokkos::create_mirror_view(this->active_ispec);
+
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    h_element_state(ispec) = specfem::Domain::active::inactive;
+  }
+
+  this->h_nactive(0) = 0;
+  const int nsources = this->sources->h_ispec_array.extent(0);
+  for (int isource = 0; isource < nsources; isource++) {
+    const int ispec = this->sources->h_ispec_array(isource);
+    if (this->material_properties->h_ispec_type(ispec) ==
+            specfem::elements::elastic &&
+        h_element_state(ispec) == specfem::Domain::active::inactive) {
+      h_element_state(ispec) = specfem::Domain::active::active;
+      h_active_ispec(this->h_nactive(0)) = ispec;
+      this->h_nactive(0)++;
+    }
+  }
+
+  // Waves reach outer elements through the assembly across MPI interfaces,
+  // which the update of active elements doesn't see. These elements are
+  // always active. Outer elements are first in ispec_domain
+  for (int index = 0; index < this->nelem_outer; index++) {
+    const int ispec = this->h_ispec_domain(index);
+    if (h_element_state(ispec) == specfem::Domain::active::inactive) {
+      h_element_state(ispec) = specfem::Domain::active::active;
+      h_active_ispec(this->h_nactive(0)) = ispec;
+      this->h_nactive(0)++;
+    }
+  }
+
+  Kokkos::deep_copy(this->element_state, h_element_state);
+  Kokkos::deep_copy(this->active_ispec, h_active_ispec);
+  Kokkos::deep_copy(this->nactive, this->h_nactive);
+
+  return;
+}
+
+void specfem::Domain::Elastic::update_active_elements(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const int nactive_elements = this->h_nactive(0);
+  const int ngllz = this->compute->ibool.extent(1);
+  const int ngllx = this->compute->ibool.extent(2);
+  const int ncomponents = this->field.extent(1);
+  const auto ibool = this->compute->ibool;
+  const auto field = this->field;
+  const auto neighbor_offsets = this->neighbor_offsets;
+  const auto neighbors = this->neighbors;
+  const auto element_state = this->element_state;
+  const auto active_ispec = this->active_ispec;
+  const auto nactive = this->nactive;
+
+  Kokkos::parallel_for(
+      "specfem::Domain::Elastic::update_active_elements",
+      specfem::kokkos::DeviceRange(exec_space, 0, nactive_elements),
+      KOKKOS_LAMBDA(const int iactive) {
+        const int ispec = active_ispec(iactive);
+        if (element_state(ispec) == specfem::Domain::active::settled)
+          return;
+
+        bool settled = true;
+        for (int ineighbor = neighbor_offsets(ispec);
+             ineighbor < neighbor_offsets(ispec + 1); ineighbor++) {
+          const int jspec = neighbors(ineighbor);
+          if (element_state(jspec) != specfem::Domain::active::inactive)
+            continue;
+
+          bool displaced = false;
+          for (int iz = 0; iz < ngllz; iz++) {
+            for (int ix = 0; ix < ngllx; ix++) {
+              const int iglob = ibool(jspec, iz, ix);
+              for (int icomp = 0; icomp < ncomponents; icomp++) {
+                displaced = displaced || (field(iglob, icomp) != 0.0);
+              }
+            }
+          }
+
+          if (!displaced) {
+            settled = false;
+            continue;
+          }
+
+          // Neighbors shared by several active elements are appended once
+          if (Kokkos::atomic_compare_exchange(
+                  &element_state(jspec), int(specfem::Domain::active::inactive),
+                  int(specfem::Domain::active::active)) ==
+              specfem::Domain::active::inactive) {
+            active_ispec(Kokkos::atomic_fetch_add(&nactive(0), 1)) = jspec;
+          }
+        }
+
+        if (settled)
+          element_state(ispec) = specfem::Domain::active::settled;
+      });
+
+  // The number of active elements sets the league size of stiffness kernels
+  Kokkos::deep_copy(exec_space, this->h_nactive, nactive);
+  exec_space.fence();
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_stiffness_interaction(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  if (this->active_elements) {
+    this->update_active_elements(exec_space);
+    this->compute_stiffness_interaction_range(0, this->h_nactive(0),
+                                              exec_space, nullptr);
+    this->compute_structured_stiffness_interaction(exec_space, nullptr);
+    this->pml.compute_interaction(this->field, this->field_dot,
+                                  this->field_dot_dot, exec_space, nullptr);
+    this->stacey.compute_interaction(this->field_dot, this->field_dot_dot,
+                                     exec_space, nullptr);
+    return;
+  }
+
+  if (this->nelem_host > 0)
+    this->start_host_stiffness_interaction(exec_space);
+
+  this->launch_stiffness_interaction(exec_space, nullptr);
+
+  if (this->nelem_host > 0)
+    this->finish_host_stiffness_interaction(exec_space);
+
+  this->pml.compute_interaction(this->field, this->field_dot,
+                                this->field_dot_dot, exec_space, nullptr);
+  this->stacey.compute_interaction(this->field_dot, this->field_dot_dot,
+                                   exec_space, nullptr);
+  if (this->injection)
+    this->injection->compute_interaction(this->field, this->field_dot,
+                                         this->field_dot_dot, exec_space);
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_outer_stiffness_interaction(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  // Rows of the assembled matrix aren't split between outer and inner
+  // points, hence every row is computed before interface points are packed
+  if (this->get_matrix_nnz() > 0) {
+    this->compute_assembled_stiffness_interaction(exec_space, nullptr);
+  } else {
+    for (int icolor = 0; icolor < this->ncolors_outer; icolor++) {
+      this->compute_stiffness_interaction_range(
+          this->h_color_offsets[icolor], this->h_color_offsets[icolor + 1],
+          exec_space, nullptr);
+    }
+  }
+
+  // PML elements and absorbing points can lie on MPI interfaces, hence they
+  // are computed before interface points are packed
+  this->pml.compute_interaction(this->field, this->field_dot,
+                                this->field_dot_dot, exec_space, nullptr);
+  this->stacey.compute_interaction(this->field_dot, this->field_dot_dot,
+                                   exec_space, nullptr);
+  if (this->injection)
+    this->injection->compute_interaction(this->field, this->field_dot,
+                                         this->field_dot_dot, exec_space);
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_inner_stiffness_interaction(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  // Every row of the assembled matrix is computed with the outer elements
+  if (this->get_matrix_nnz() > 0)
+    return;
+
+  if (this->nelem_host > 0)
+    this->start_host_stiffness_interaction(exec_space);
+
+  const int ncolors = this->h_color_offsets.size() - 1;
+  for (int icolor = this->ncolors_outer; icolor < ncolors; icolor++) {
+    this->compute_stiffness_interaction_range(
+        this->h_color_offsets[icolor], this->h_color_offsets[icolor + 1],
+        exec_space, nullptr);
+  }
+  this->compute_structured_stiffness_interaction(exec_space, nullptr);
+
+  if (this->nelem_host > 0)
+    this->finish_host_stiffness_interaction(exec_space);
+
+  return;
+}
+
+void specfem::Domain::Elastic::start_interface_assembly(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  if (this->halo != nullptr)
+    this->halo->start(this->field_dot_dot, exec_space);
+
+  return;
+}
+
+void specfem::Domain::Elastic::finish_interface_assembly(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  if (this->halo != nullptr)
+    this->halo->finish(this->field_dot_dot, exec_space);
+
+  return;
+}
+
+void specfem::Domain::Elastic::assemble_interfaces(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  if (this->halo != nullptr)
+    this->halo->assemble(this->field_dot_dot, exec_space);
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_stiffness_interaction(
+    specfem::kokkos::DeviceGraphNode &node) {
+
+  if (this->active_elements) {
+    throw std::runtime_error(
+        "Active elements are not supported with graph execution");
+  }
+
+  // The host kernel can't be recorded inside a graph
+  if (this->nelem_host > 0) {
+    throw std::runtime_error("Host offload is not supported with graph "
+                             "execution");
+  }
+
+  // MPI communication can't be recorded inside a graph
+  if (this->halo != nullptr && this->halo->get_nneighbors() > 0) {
+    throw std::runtime_error(
+        "Graph execution is not supported with MPI interfaces");
+  }
+
+  // Chunks of the injected wavefield are copied between timesteps
+  if (this->injection) {
+    throw std::runtime_error(
+        "Wavefield injection is not supported with graph execution");
+  }
+
+  this->launch_stiffness_interaction(specfem::kokkos::DevExecSpace(), &node);
+  this->pml.compute_interaction(this->field, this->field_dot,
+                                this->field_dot_dot,
+                                specfem::kokkos::DevExecSpace(), &node);
+  this->stacey.compute_interaction(this->field_dot, this->field_dot_dot,
+                                   specfem::kokkos::DevExecSpace(), &node);
+
+  return;
+}
+
+void specfem::Domain::Elastic::launch_stiffness_interaction(
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  if (this->get_matrix_nnz() > 0) {
+    this->compute_assembled_stiffness_interaction(exec_space, node);
+    return;
+  }
+
+  // Kernels are launched on the same execution space instance. Hence there is
+  // no need to fence between colors
+  const int ncolors = this->h_color_offsets.size() - 1;
+  for (int icolor = 0; icolor < ncolors; icolor++) {
+    const int istart = this->h_color_offsets[icolor];
+    const int iend = this->h_color_offsets[icolor + 1];
+    this->compute_stiffness_interaction_range(istart, iend, exec_space, node);
+  }
+
+  this->compute_structured_stiffness_interaction(exec_space, node);
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_stiffness_interaction_range(
+    const int istart, const int iend,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  if (istart >= iend)
+    return;
+
+  if (this->is_axisymmetric()) {
+    this->compute_stiffness_interaction_axisymmetric(istart, iend, exec_space,
+                                                     node);
+    return;
+  }
+
+  switch (this->ngll_specialization) {
+  case 3:
+    this->compute_stiffness_interaction_specialized<3>(istart, iend,
+                                                       exec_space, node);
+    break;
+  case 4:
+    this->compute_stiffness_interaction_specialized<4>(istart, iend,
+                                                       exec_space, node);
+    break;
+  case 5:
+    this->compute_stiffness_interaction_specialized<5>(istart, iend,
+                                                       exec_space, node);
+    break;
+  case 6:
+    this->compute_stiffness_interaction_specialized<6>(istart, iend,
+                                                       exec_space, node);
+    break;
+  case 7:
+    this->compute_stiffness_interaction_specialized<7>(istart, iend,
+                                                       exec_space, node);
+    break;
+  case 8:
+    this->compute_stiffness_interaction_specialized<8>(istart, iend,
+                                                       exec_space, node);
+    break;
+  default:
+    this->compute_stiffness_interaction_generic(istart, iend, exec_space,
+                                                node);
+    break;
+  }
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_structured_stiffness_interaction(
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  if (this->nelem_structured == 0)
+    return;
+
+  const int ngllx = this->quadx->get_N();
+  const int ngllz = this->quadz->get_N();
+  const int ngllxz = ngllx * ngllz;
+  const auto tiles = this->compute->structured_tiles;
+  const auto structured_ispec = this->structured_ispec;
+  const auto xix = this->partial_derivatives->get_xix();
+  const auto xiz = this->partial_derivatives->get_xiz();
+  const auto gammax = this->partial_derivatives->get_gammax();
+  const auto gammaz = this->partial_derivatives->get_gammaz();
+  const auto jacobian = this->partial_derivatives->get_jacobian();
+  const auto mu = this->material_properties->get_mu();
+  const auto lambdaplus2mu = this->material_properties->get_lambdaplus2mu();
+  const auto wxgll = this->quadx->get_w();
+  const auto wzgll = this->quadz->get_w();
+  const auto hprime_xx = this->quadx->get_hprime();
+  const auto hprime_zz = this->quadz->get_hprime();
+  const auto hprimewgll_xx = this->quadx->get_hprimewgll();
+  const auto hprimewgll_zz = this->quadz->get_hprimewgll();
+  const auto field = this->field;
+  const auto field_dot_dot = this->field_dot_dot;
+  // Only the out of plane component is stored for SH waves
+  const bool p_sv = (this->wave == specfem::wave::p_sv);
+  const int nshots = this->nshots;
+  const int ncomponents = p_sv ? 2 : 1;
+
+  int scratch_size =
+      2 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllx, ngllx);
+  scratch_size +=
+      2 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllz, ngllz);
+  scratch_size +=
+      6 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllz, ngllx);
+
+  // Elements of a parity are 2 elements apart along x or z in their block,
+  // and blocks don't share points
+  for (int iparity = 0; iparity < 4; iparity++) {
+    const int istart = this->h_structured_offsets[iparity];
+    const int iend = this->h_structured_offsets[iparity + 1];
+    if (istart >= iend)
+      continue;
+
+    specfem::kokkos::DeviceTeam policy(exec_space, iend - istart,
+                                       Kokkos::AUTO, 1);
+    policy.set_scratch_size(0, Kokkos::PerTeam(scratch_size));
+
+    specfem::kokkos::parallel_for(
+        "specfem::Domain::Elastic::compute_structured_forces", policy,
+        KOKKOS_LAMBDA(
+            const specfem::kokkos::DeviceTeam::member_type &team_member) {
+          const int ispec =
+              structured_ispec(istart + team_member.league_rank());
+          // Points of the element are rows of its tile
+          const int origin = tiles(ispec, 0);
+          const int stride = tiles(ispec, 1);
+
+          specfem::kokkos::DeviceScratchView2d<type_real> s_hprime_xx(
+              team_member.team_scratch(0), ngllx, ngllx);
+          specfem::kokkos::DeviceScratchView2d<type_real> s_hprime_zz(
+              team_member.team_scratch(0), ngllz, ngllz);
+          specfem::kokkos::DeviceScratchView2d<type_real> s_hprimewgll_xx(
+              team_member.team_scratch(0), ngllx, ngllx);
+          specfem::kokkos::DeviceScratchView2d<type_real> s_hprimewgll_zz(
+              team_member.team_scratch(0), ngllz, ngllz);
+          specfem::kokkos::DeviceScratchView2d<type_real> s_fieldx(
+              team_member.team_scratch(0), ngllz, ngllx);
+          specfem::kokkos::DeviceScratchView2d<type_real> s_fieldz(
+              team_member.team_scratch(0), ngllz, ngllx);
+          specfem::kokkos::DeviceScratchView2d<type_real> s_tempx1(
+              team_member.team_scratch(0), ngllz, ngllx);
+          specfem::kokkos::DeviceScratchView2d<type_real> s_tempz1(
+              team_member.team_scratch(0), ngllz, ngllx);
+          specfem::kokkos::DeviceScratchView2d<type_real> s_tempx3(
+              team_member.team_scratch(0), ngllz, ngllx);
+          specfem::kokkos::DeviceScratchView2d<type_real> s_tempz3(
+              team_member.team_scratch(0), ngllz, ngllx);
+
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllx * ngllx),
+              [=](const int ij) {
+                const int i = ij % ngllx;
+                const int j = ij / ngllx;
+                s_hprime_xx(j, i) = hprime_xx(j, i);
+                s_hprimewgll_xx(j, i) = hprimewgll_xx(j, i);
+              });
+
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllz * ngllz),
+              [=](const int ij) {
+                const int i = ij % ngllz;
+                const int j = ij / ngllz;
+                s_hprime_zz(j, i) = hprime_zz(j, i);
+                s_hprimewgll_zz(j, i) = hprimewgll_zz(j, i);
+              });
+
+          // The barrier following the field load also guarantees the
+          // contractions of the previous shot are done with the integrands
+          for (int ishot = 0; ishot < nshots; ishot++) {
+            const int icomponent = ishot * ncomponents;
+
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange(team_member, ngllxz),
+                [=](const int xz) {
+                  const int ix = xz % ngllx;
+                  const int iz = xz / ngllx;
+                  const int iglob = origin + iz * stride + ix;
+                  s_fieldx(iz, ix) = field(iglob, icomponent);
+                  if (p_sv)
+                    s_fieldz(iz, ix) = field(iglob, icomponent + 1);
+                });
+
+            team_member.team_barrier();
+
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange(team_member, ngllxz),
+                [=](const int xz) {
+                  const int ix = xz % ngllx;
+                  const int iz = xz / ngllx;
+
+                  type_accum sum_hprime_x1 = 0;
+                  type_accum sum_hprime_x3 = 0;
+                  type_accum sum_hprime_z1 = 0;
+                  type_accum sum_hprime_z3 = 0;
+
+                  for (int l = 0; l < ngllx; l++) {
+                    sum_hprime_x1 += s_hprime_xx(ix, l) * s_fieldx(iz, l);
+                    if (p_sv)
+                      sum_hprime_x3 += s_hprime_xx(ix, l) * s_fieldz(iz, l);
+                  }
+
+                  for (int l = 0; l < ngllz; l++) {
+                    sum_hprime_z1 += s_hprime_zz(iz, l) * s_fieldx(l, ix);
+                    if (p_sv)
+                      sum_hprime_z3 += s_hprime_zz(iz, l) * s_fieldz(l, ix);
+                  }
+
+                  const type_real xixl = xix(ispec, iz, ix);
+                  const type_real xizl = xiz(ispec, iz, ix);
+                  const type_real gammaxl = gammax(ispec, iz, ix);
+                  const type_real gammazl = gammaz(ispec, iz, ix);
+                  const type_real jacobianl = jacobian(ispec, iz, ix);
+                  const type_real mul = mu(ispec, iz, ix);
+
+                  type_accum sigma_xx = 0;
+                  type_accum sigma_zz = 0;
+                  type_accum sigma_xz = 0;
+
+                  if (p_sv) {
+                    const type_accum duxdxl =
+                        xixl * sum_hprime_x1 + gammaxl * sum_hprime_x3;
+                    const type_accum duxdzl =
+                        xizl * sum_hprime_x1 + gammazl * sum_hprime_x3;
+
+                    const type_accum duzdxl =
+                        xixl * sum_hprime_z1 + gammaxl * sum_hprime_z3;
+                    const type_accum duzdzl =
+                        xizl * sum_hprime_z1 + gammazl * sum_hprime_z3;
+
+                    const type_real lambdaplus2mul =
+                        lambdaplus2mu(ispec, iz, ix);
+                    const type_accum lambdal = lambdaplus2mul - 2.0 * mul;
+
+                    sigma_xx = lambdaplus2mul * duxdxl + lambdal * duzdzl;
+                    sigma_zz = lambdaplus2mul * duzdzl + lambdal * duxdxl;
+                    sigma_xz = mul * (duzdxl + duxdzl);
+                  } else {
+                    // SH-case: sum_hprime_x1 and sum_hprime_z1 are
+                    // derivatives of the out of plane displacement along xi
+                    // and gamma
+                    sigma_xx = mul * (xixl * sum_hprime_x1 +
+                                      gammaxl * sum_hprime_z1); // sigma_xy
+                    sigma_xz = mul * (xizl * sum_hprime_x1 +
+                                      gammazl * sum_hprime_z1); // sigma_zy
+                  }
+
+                  s_tempx1(iz, ix) =
+                      jacobianl * (sigma_xx * xixl + sigma_xz * xizl);
+                  s_tempz1(iz, ix) =
+                      jacobianl * (sigma_xz * xixl + sigma_zz * xizl);
+                  s_tempx3(iz, ix) =
+                      jacobianl * (sigma_xx * gammaxl + sigma_xz * gammazl);
+                  s_tempz3(iz, ix) =
+                      jacobianl * (sigma_xz * gammaxl + sigma_zz * gammazl);
+                });
+
+            team_member.team_barrier();
+
+            // Every point of the element belongs to a single element of the
+            // parity, hence it is written without atomics
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange(team_member, ngllxz),
+                [=](const int xz) {
+                  const int ix = xz % ngllx;
+                  const int iz = xz / ngllx;
+
+                  type_accum tempx1 = 0;
+                  type_accum tempz1 = 0;
+                  type_accum tempx3 = 0;
+                  type_accum tempz3 = 0;
+
+                  for (int l = 0; l < ngllx; l++) {
+                    tempx1 += s_hprimewgll_xx(ix, l) * s_tempx1(iz, l);
+                    tempz1 += s_hprimewgll_xx(ix, l) * s_tempz1(iz, l);
+                  }
+
+                  for (int l = 0; l < ngllz; l++) {
+                    tempx3 += s_hprimewgll_zz(iz, l) * s_tempx3(l, ix);
+                    tempz3 += s_hprimewgll_zz(iz, l) * s_tempz3(l, ix);
+                  }
+
+                  const int iglob = origin + iz * stride + ix;
+                  const type_real sum_terms1 =
+                      -1.0 * (wzgll(iz) * tempx1) - (wxgll(ix) * tempx3);
+                  const type_real sum_terms3 =
+                      -1.0 * (wzgll(iz) * tempz1) - (wxgll(ix) * tempz3);
+                  Kokkos::single(Kokkos::PerThread(team_member), [=] {
+                    field_dot_dot(iglob, icomponent) += sum_terms1;
+                    if (p_sv)
+                      field_dot_dot(iglob, icomponent + 1) += sum_terms3;
+                  });
+                });
+          }
+        },
+        node);
+  }
+
+  return;
+}
+
+void specfem::Domain::Elastic::set_element_levels(
+    const std::vector<int> &element_levels) {
+
+  if (this->assembly != specfem::assembly::atomic) {
+    throw std::runtime_error(
+        "Local time stepping is only implemented for atomic assembly");
+  }
+
+  if (this->active_elements) {
+    throw std::runtime_error(
+        "Local time stepping is not supported with active elements");
+  }
+
+  if (this->nelem_host > 0) {
+    throw std::runtime_error(
+        "Local time stepping is not supported with host offload");
+  }
+
+  if (this->is_axisymmetric()) {
+    throw std::runtime_error(
+        "Local time stepping is not supported with axisymmetric simulations");
+  }
+
+  if (this->get_matrix_nnz() > 0) {
+    throw std::runtime_error("Local time stepping is not supported with the "
+                             "assembled stiffness operator");
+  }
+
+  // Memory variables are updated with the global time step
+  if (this->n_sls > 0) {
+    throw std::runtime_error(
+        "Local time stepping is not supported with attenuation");
+  }
+
+  // Elements of structured blocks are computed at every step
+  if (this->nelem_structured > 0) {
+    throw std::runtime_error(
+        "Local time stepping is not supported with structured blocks");
+  }
+
+  // Absorbing points are damped with the velocity of the global time step
+  if (this->stacey.get_npoints() > 0) {
+    throw std::runtime_error("Local time stepping is not supported with "
+                             "absorbing boundaries");
+  }
+
+  // Memory variables of PML elements are updated with the global time step
+  if (this->pml.get_nelements() > 0) {
+    throw std::runtime_error(
+        "Local time stepping is not supported with PML layers");
+  }
+
+  // Neighboring ranks would assemble points ending a step on different
+  // substeps
+  if (this->halo != nullptr && this->halo->get_nneighbors() > 0) {
+    throw std::runtime_error(
+        "Local time stepping is not supported with MPI interfaces");
+  }
+
+  std::vector<int> elements(this->nelem_domain);
+  for (int index = 0; index < this->nelem_domain; index++) {
+    elements[index] = this->h_ispec_domain(index);
+  }
+
+  std::stable_sort(elements.begin(), elements.end(),
+                   [&element_levels](const int a, const int b) {
+                     return element_levels[a] < element_levels[b];
+                   });
+
+  int nlevels = 1;
+  for (const int ispec : elements) {
+    nlevels = std::max(nlevels, element_levels[ispec] + 1);
+  }
+
+  this->h_level_offsets = std::vector<int>(nlevels + 1, this->nelem_domain);
+  for (int index = this->nelem_domain - 1; index >= 0; index--) {
+    const int ispec = elements[index];
+    this->h_ispec_domain(index) = ispec;
+    for (int ilevel = 0; ilevel <= element_levels[ispec]; ilevel++) {
+      this->h_level_offsets[ilevel] = index;
+    }
+  }
+
+  // A single color containing every element. Local time stepping isn't
+  // supported with MPI interfaces, hence there are no outer elements
+  this->h_color_offsets = { 0, this->nelem_domain };
+  this->ncolors_outer = 0;
+
+  Kokkos::deep_copy(ispec_domain, h_ispec_domain);
+
+  if (this->packed_element_data) {
+    this->assign_element_data();
+  }
+
+  return;
+}
+
+void specfem::Domain::Elastic::set_attenuation(
+    const specfem::attenuation::model &model, const type_real dt) {
+
+  if (this->nelem_host > 0) {
+    throw std::runtime_error("Attenuation is not supported with host offload");
+  }
+
+  if (this->is_axisymmetric()) {
+    throw std::runtime_error(
+        "Attenuation is not supported with axisymmetric simulations");
+  }
+
+  // Memory variables aren't part of the assembled matrix
+  if (this->get_matrix_nnz() > 0) {
+    throw std::runtime_error("Attenuation is not supported with the assembled "
+                             "stiffness operator");
+  }
+
+  if (this->h_level_offsets.size() > 2) {
+    throw std::runtime_error(
+        "Attenuation is not supported with local time stepping");
+  }
+
+  // Memory variables are only computed by the runtime sized kernel
+  if (this->nelem_structured > 0) {
+    throw std::runtime_error(
+        "Attenuation is not supported with structured blocks");
+  }
+
+  const auto qkappa = this->material_properties->qkappa;
+  const auto qmu = this->material_properties->qmu;
+  const int nspec = qkappa.extent(0);
+  const int ngllz = qkappa.extent(1);
+  const int ngllx = qkappa.extent(2);
+
+  // Unrelaxed moduli are M / (1 - dispersion / Q), which needs Q to be
+  // larger than the dispersion of the model
+  const type_real dispersion = model.dispersion();
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    if (this->material_properties->h_ispec_type(ispec) !=
+        specfem::elements::elastic)
+      continue;
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const type_real q = std::min(qkappa(ispec, iz, ix), qmu(ispec, iz, ix));
+        if (q <= 2.0 * dispersion) {
+          std::ostringstream message;
+          message << "Quality factor " << q << " of element " << ispec
+                  << " is too small for an attenuation model with "
+                  << model.n_sls << " standard linear solids. Q needs to be "
+                  << "larger than " << 2.0 * dispersion;
+          throw std::runtime_error(message.str());
+        }
+      }
+    }
+  }
+
+  this->n_sls = model.n_sls;
+  this->attenuation_dispersion = dispersion;
+
+  // Every SLS is represented at one point out of n_sls, hence coefficients
+  // are scaled by n_sls
+  this->sls = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::Domain::Elastic::sls", model.n_sls, 2);
+  auto h_sls = Kokkos::create_mirror_view(this->sls);
+  for (int l = 0; l < model.n_sls; l++) {
+    h_sls(l, 0) = std::exp(-model.omega[l] * dt);
+    h_sls(l, 1) = model.n_sls * model.coefficient[l];
+  }
+  Kokkos::deep_copy(this->sls, h_sls);
+
+  this->inverse_qkappa = specfem::kokkos::DeviceElementView3d<type_real>(
+      "specfem::Domain::Elastic::inverse_qkappa", nspec, ngllz, ngllx);
+  this->inverse_qmu = specfem::kokkos::DeviceElementView3d<type_real>(
+      "specfem::Domain::Elastic::inverse_qmu", nspec, ngllz, ngllx);
+  auto h_inverse_qkappa = Kokkos::create_mirror_view(this->inverse_qkappa);
+  auto h_inverse_qmu = Kokkos::create_mirror_view(this->inverse_qmu);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        h_inverse_qkappa(ispec, iz, ix) = 1.0 / qkappa(ispec, iz, ix);
+        h_inverse_qmu(ispec, iz, ix) = 1.0 / qmu(ispec, iz, ix);
+      }
+    }
+  }
+  Kokkos::deep_copy(this->inverse_qkappa, h_inverse_qkappa);
+  Kokkos::deep_copy(this->inverse_qmu, h_inverse_qmu);
+
+  const int nvariables = (this->wave == specfem::wave::p_sv) ? 3 : 2;
+  this->memory_variables = specfem::kokkos::DeviceView4d<type_real>(
+      "specfem::Domain::Elastic::memory_variables", nspec, ngllz, ngllx,
+      nvariables * this->nshots);
+
+  // Memory variables are only computed by the runtime sized kernel
+  this->ngll_specialization = 0;
+
+  return;
+}
+
+void specfem::Domain::Elastic::set_absorbing_boundary(
+    const specfem::boundaries::absorbing_boundary &abs_boundary) {
+
+  if (this->h_level_offsets.size() > 2) {
+    throw std::runtime_error("Absorbing boundaries are not supported with "
+                             "local time stepping");
+  }
+
+  // Tractions of absorbing points aren't weighted by the radius
+  if (this->is_axisymmetric()) {
+    throw std::runtime_error("Absorbing boundaries are not supported with "
+                             "axisymmetric simulations");
+  }
+
+  this->stacey = specfem::boundaries::stacey(
+      abs_boundary, this->compute, this->material_properties, this->quadx,
+      this->quadz, specfem::elements::elastic, this->wave, this->nshots);
+
+  return;
+}
+
+void specfem::Domain::Elastic::set_injection(
+    specfem::boundaries::injection *injection) {
+
+  if (this->h_level_offsets.size() > 2) {
+    throw std::runtime_error("Wavefield injection is not supported with "
+                             "local time stepping");
+  }
+
+  // Recorded stresses ignore memory variables and hoop stresses
+  if (this->n_sls > 0 || this->is_axisymmetric()) {
+    throw std::runtime_error("Wavefield injection is not supported with "
+                             "attenuation and axisymmetric simulations");
+  }
+
+  if (this->nshots > 1) {
+    throw std::runtime_error(
+        "Wavefield injection is only implemented for a single shot");
+  }
+
+  // Elements are activated by the displacement of their neighbors, hence
+  // elements receiving injected forces from a quiet field stay inactive
+  if (this->active_elements) {
+    throw std::runtime_error(
+        "Wavefield injection is not supported with active elements");
+  }
+
+  this->injection = injection;
+
+  return;
+}
+
+void specfem::Domain::Elastic::set_pml(
+    const specfem::kokkos::HostView1d<int> region_CPML,
+    const specfem::boundaries::pml_layer &layer, const type_real f0,
+    const type_real reflection, const type_real dt) {
+
+  if (this->h_level_offsets.size() > 2) {
+    throw std::runtime_error(
+        "PML layers are not supported with local time stepping");
+  }
+
+  if (this->is_axisymmetric()) {
+    throw std::runtime_error(
+        "PML layers are not supported with axisymmetric simulations");
+  }
+
+  this->pml = specfem::boundaries::pml(
+      region_CPML, layer, this->compute, this->partial_derivatives,
+      this->material_properties, this->quadx, this->quadz, this->wave,
+      this->nshots, f0, reflection, dt);
+
+  return;
+}
+
+void specfem::Domain::Elastic::set_axisymmetric(
+    const specfem::kokkos::HostView1d<bool> is_on_the_axis) {
+
+  if (this->wave != specfem::wave::p_sv) {
+    throw std::runtime_error(
+        "Axisymmetric simulations are only implemented for P-SV waves");
+  }
+
+  if (this->nelem_host > 0 || this->get_matrix_nnz() > 0 ||
+      this->nelem_structured > 0) {
+    throw std::runtime_error(
+        "Axisymmetric simulations are not supported with host offload, the "
+        "assembled stiffness operator or structured blocks");
+  }
+
+  if (this->n_sls > 0 || this->stacey.get_npoints() > 0 ||
+      this->pml.get_nelements() > 0 || this->h_level_offsets.size() > 2) {
+    throw std::runtime_error(
+        "Axisymmetric simulations are not supported with attenuation, "
+        "absorbing boundaries, PML layers or local time stepping");
+  }
+
+  const auto h_ibool = this->compute->h_ibool;
+  const int nspec = h_ibool.extent(0);
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  const int nglob = this->field.extent(0);
+  const auto coord = this->compute->coordinates.coord;
+
+  if (static_cast<int>(is_on_the_axis.extent(0)) != nspec) {
+    std::ostringstream message;
+    message << "Axial elements are given for " << is_on_the_axis.extent(0)
+            << " elements, the mesh has " << nspec << " elements";
+    throw std::runtime_error(message.str());
+  }
+
+  const specfem::quadrature::quadrature quadglj(0.0, 1.0, ngllx);
+  this->wxglj = quadglj.get_w();
+  this->hprimeBar_xx = quadglj.get_hprime();
+  this->hprimeBarwglj_xx = quadglj.get_hprimewgll();
+  const auto xiglj = quadglj.get_hxi();
+
+  // dx / dxi = gammaz * jacobian on the axis. Partial derivatives are read
+  // from the device as host mirrors may be released. Values of affine
+  // elements are stored at every quadrature point as well
+  const auto gammaz = Kokkos::create_mirror_view_and_copy(
+      specfem::kokkos::HostMemSpace(), this->partial_derivatives->gammaz);
+  const auto jacobian = Kokkos::create_mirror_view_and_copy(
+      specfem::kokkos::HostMemSpace(), this->partial_derivatives->jacobian);
+
+  this->axial = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::axial", nspec);
+  this->radius = specfem::kokkos::DeviceElementView3d<type_real>(
+      "specfem::Domain::Elastic::radius", nspec, ngllz, ngllx);
+  this->radius_factor = specfem::kokkos::DeviceElementView3d<type_real>(
+      "specfem::Domain::Elastic::radius_factor", nspec, ngllz, ngllx);
+  const auto h_axial = Kokkos::create_mirror_view(this->axial);
+  const auto h_radius = Kokkos::create_mirror_view(this->radius);
+  const auto h_radius_factor = Kokkos::create_mirror_view(this->radius_factor);
+
+  // Points closer to the axis than the tolerance are on the axis
+  const type_real tolerance =
+      1e-6 * (this->compute->coordinates.xmax - this->compute->coordinates.xmin);
+  std::vector<bool> on_the_axis(nglob, false);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    h_axial(ispec) = is_on_the_axis(ispec);
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int iglob = h_ibool(ispec, iz, ix);
+        const type_real x = coord(0, iglob);
+        if (x < -tolerance) {
+          std::ostringstream message;
+          message << "Axisymmetric meshes need x >= 0, point " << iglob
+                  << " is at x = " << x;
+          throw std::runtime_error(message.str());
+        }
+        const type_real r = (x > tolerance) ? x : 0.0;
+        if (h_axial(ispec) && (ix == 0) != (r == 0.0)) {
+          std::ostringstream message;
+          message << "Element " << ispec
+                  << " on the axis needs its edge xi = -1, and only this "
+                     "edge, on the axis";
+          throw std::runtime_error(message.str());
+        }
+        h_radius(ispec, iz, ix) = r;
+        if (!h_axial(ispec)) {
+          h_radius_factor(ispec, iz, ix) = r;
+        } else if (ix == 0) {
+          h_radius_factor(ispec, iz, ix) =
+              gammaz(ispec, iz, ix) * jacobian(ispec, iz, ix);
+        } else {
+          h_radius_factor(ispec, iz, ix) = r / (1.0 + xiglj(ix));
+        }
+        if (r == 0.0)
+          on_the_axis[iglob] = true;
+      }
+    }
+  }
+
+  const int npoints = std::count(on_the_axis.begin(), on_the_axis.end(), true);
+  this->axis_points = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::axis_points", npoints);
+  const auto h_axis_points = Kokkos::create_mirror_view(this->axis_points);
+  for (int iglob = 0, ipoint = 0; iglob < nglob; iglob++) {
+    if (on_the_axis[iglob])
+      h_axis_points(ipoint++) = iglob;
+  }
+
+  Kokkos::deep_copy(this->axial, h_axial);
+  Kokkos::deep_copy(this->radius, h_radius);
+  Kokkos::deep_copy(this->radius_factor, h_radius_factor);
+  Kokkos::deep_copy(this->axis_points, h_axis_points);
+
+  // The mass matrix is weighted by the radius
+  this->assign_views();
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_level_stiffness_interaction(
+    const int ilevel, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const int nlevels = this->h_level_offsets.size() - 1;
+  if (ilevel < 0 || ilevel >= nlevels) {
+    throw std::runtime_error("Local time stepping level out of range");
+  }
+
+  // Elements are sorted by level, hence elements with level >= ilevel are
+  // contiguous
+  this->compute_stiffness_interaction_range(
+      this->h_level_offsets[ilevel], this->nelem_domain, exec_space, nullptr);
+
+  return;
+}
+
+template <int NGLL, specfem::wave::type WAVE>
+void specfem::Domain::Elastic::compute_stiffness_interaction_ngll(
+    const int istart, const int iend,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  constexpr int NGLL2 = NGLL * NGLL;
+  constexpr int NELEM = specfem::Domain::elements_per_team<NGLL>();
+  constexpr int NPOINTS = NELEM * NGLL2;
+  const int nelements = iend - istart;
+  const int nleague = (nelements + NELEM - 1) / NELEM;
+  const bool use_atomics = (this->assembly == specfem::assembly::atomic);
+  const bool use_packed = this->packed_element_data;
+  const auto element_data = this->get_packed_data();
+  const auto ibool = this->compute->get_ibool();
+  // Active elements are computed in the order they were activated
+  const auto ispec_domain =
+      this->active_elements ? this->active_ispec : this->ispec_domain;
+  const auto xix = this->partial_derivatives->get_xix();
+  const auto xiz = this->partial_derivatives->get_xiz();
+  const auto gammax = this->partial_derivatives->get_gammax();
+  const auto gammaz = this->partial_derivatives->get_gammaz();
+  const auto jacobian = this->partial_derivatives->get_jacobian();
+  const auto mu = this->material_properties->get_mu();
+  const auto lambdaplus2mu = this->material_properties->get_lambdaplus2mu();
+  // Quadrature is the same in x and z and is read from the kernel closure
+  constexpr auto gll = specfem::quadrature::gll_tables<type_real, NGLL>;
+  const auto field = this->field;
+  const auto field_dot_dot = this->field_dot_dot;
+  const int nshots = this->nshots;
+  // Element data of batched shots is loaded once into scratch memory
+  const bool batched = (nshots > 1);
+
+  using StaticScratchView3d =
+      specfem::kokkos::StaticDeviceScratchView3d<type_real, NELEM, NGLL, NGLL>;
+
+  // Only the out of plane component is stored for SH waves
+  constexpr bool p_sv = (WAVE == specfem::wave::p_sv);
+  constexpr int NCOMPONENTS = p_sv ? 2 : 1;
+
+  // Scratch plan:
+  //  - field of every element for the current shot (read when computing
+  //    gradients)
+  //  - stress integrands along xi and gamma (read when computing the
+  //    weighted contractions)
+  //  - geometry and material properties of every element when shots are
+  //    batched
+  const int scratch_size =
+      3 * NCOMPONENTS * StaticScratchView3d::shmem_size() +
+      (batched ? specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(
+                     specfem::Domain::packed::nfields, NPOINTS)
+               : 0);
+
+  // Single element teams let Kokkos choose the team size. Batched teams use
+  // one thread per quadrature point of every element in the batch by default
+  const int team_size = (NELEM == 1) ? 0 : NPOINTS;
+  const auto configuration =
+      this->stiffness_tuner.get_config(scratch_size, node == nullptr);
+  const int scratch_level = configuration.scratch_level;
+
+  specfem::autotune::parallel_for(
+      "specfem::Domain::Elastic::compute_forces", this->stiffness_tuner,
+      configuration, exec_space, nleague, team_size, scratch_size,
+      KOKKOS_LAMBDA(
+          const specfem::kokkos::DeviceTeam::member_type &team_member) {
+        const int ifirst = istart + team_member.league_rank() * NELEM;
+        // Number of elements processed by this team
+        const int nelem_team =
+            (iend - ifirst) < NELEM ? (iend - ifirst) : NELEM;
+        const int npoints = nelem_team * NGLL2;
+
+        // Read geometry and material properties either from packed element
+        // data or from partial derivatives and properties structs
+        const auto get_element_data =
+            [=](const int ielement, const specfem::Domain::packed::field ifield,
+                const int iz, const int ix) -> type_real {
+          if (use_packed)
+            return element_data(ielement, ifield, iz, ix);
+
+          const int ispec = ispec_domain(ielement);
+          switch (ifield) {
+          case specfem::Domain::packed::xix:
+            return xix(ispec, iz, ix);
+          case specfem::Domain::packed::xiz:
+            return xiz(ispec, iz, ix);
+          case specfem::Domain::packed::gammax:
+            return gammax(ispec, iz, ix);
+          case specfem::Domain::packed::gammaz:
+            return gammaz(ispec, iz, ix);
+          case specfem::Domain::packed::jacobian:
+            return jacobian(ispec, iz, ix);
+          case specfem::Domain::packed::mu:
+            return mu(ispec, iz, ix);
+          default:
+            return lambdaplus2mu(ispec, iz, ix);
+          }
+        };
+
+        const auto &scratch = team_member.team_scratch(scratch_level);
+        StaticScratchView3d s_fieldx(scratch);
+        StaticScratchView3d s_tempx1(scratch);
+        StaticScratchView3d s_tempx3(scratch);
+        // z components are not allocated for SH waves
+        StaticScratchView3d s_fieldz =
+            p_sv ? StaticScratchView3d(scratch) : s_fieldx;
+        StaticScratchView3d s_tempz1 =
+            p_sv ? StaticScratchView3d(scratch) : s_tempx1;
+        StaticScratchView3d s_tempz3 =
+            p_sv ? StaticScratchView3d(scratch) : s_tempx3;
+        // Element data is not allocated for a single shot
+        const specfem::kokkos::DeviceScratchView2d<type_real> s_element =
+            batched ? specfem::kokkos::DeviceScratchView2d<type_real>(
+                          scratch, specfem::Domain::packed::nfields, NPOINTS)
+                    : specfem::kokkos::DeviceScratchView2d<type_real>();
+
+        // Batched shots read element data from scratch memory
+        const auto get_point_data =
+            [=](const int ixz, const specfem::Domain::packed::field ifield,
+                const int iz, const int ix) -> type_real {
+          if (batched)
+            return s_element(ifield, ixz);
+          return get_element_data(ifirst + ixz / NGLL2, ifield, iz, ix);
+        };
+
+        // -------------Load into scratch memory----------------------------
+        if (batched) {
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, npoints),
+              [=](const int ixz) {
+                const int ie = ixz / NGLL2;
+                const int ix = ixz % NGLL;
+                const int iz = (ixz % NGLL2) / NGLL;
+                for (int ifield = 0;
+                     ifield < specfem::Domain::packed::nfields; ifield++) {
+                  s_element(ifield, ixz) = get_element_data(
+                      ifirst + ie,
+                      static_cast<specfem::Domain::packed::field>(ifield),
+                      iz, ix);
+                }
+              });
+        }
+
+        // Shots are computed one after the other. The barrier following the
+        // field load also guarantees the contractions of the previous shot
+        // are done with the stress integrands
+        for (int ishot = 0; ishot < nshots; ishot++) {
+          const int icomponent = ishot * NCOMPONENTS;
+
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, npoints),
+              [=](const int ixz) {
+                const int ie = ixz / NGLL2;
+                const int ix = ixz % NGLL;
+                const int iz = (ixz % NGLL2) / NGLL;
+                const int iglob = ibool(ispec_domain(ifirst + ie), iz, ix);
+                s_fieldx(ie, iz, ix) = field(iglob, icomponent);
+                if constexpr (p_sv)
+                  s_fieldz(ie, iz, ix) = field(iglob, icomponent + 1);
+              });
+          //----------------------------------------------------------------
+
+          team_member.team_barrier();
+
+          // Compute stress and the stress integrands along xi (tempx1) and
+          // gamma (tempx3). Stress is kept in registers
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, npoints),
+              [=](const int ixz) {
+                const int ie = ixz / NGLL2;
+                const int ix = ixz % NGLL;
+                const int iz = (ixz % NGLL2) / NGLL;
+
+                const type_real xixl = get_point_data(
+                    ixz, specfem::Domain::packed::xix, iz, ix);
+                const type_real xizl = get_point_data(
+                    ixz, specfem::Domain::packed::xiz, iz, ix);
+                const type_real gammaxl = get_point_data(
+                    ixz, specfem::Domain::packed::gammax, iz, ix);
+                const type_real gammazl = get_point_data(
+                    ixz, specfem::Domain::packed::gammaz, iz, ix);
+                const type_real jacobianl = get_point_data(
+                    ixz, specfem::Domain::packed::jacobian, iz, ix);
+                const type_real mul = get_point_data(
+                    ixz, specfem::Domain::packed::mu, iz, ix);
+
+                if constexpr (p_sv) {
+                  type_accum sum_hprime_x1 = 0;
+                  type_accum sum_hprime_x3 = 0;
+                  type_accum sum_hprime_z1 = 0;
+                  type_accum sum_hprime_z3 = 0;
+
+                  for (int l = 0; l < NGLL; l++) {
+                    sum_hprime_x1 += gll.hprime[ix][l] * s_fieldx(ie, iz, l);
+                    sum_hprime_x3 += gll.hprime[ix][l] * s_fieldz(ie, iz, l);
+                    sum_hprime_z1 += gll.hprime[iz][l] * s_fieldx(ie, l, ix);
+                    sum_hprime_z3 += gll.hprime[iz][l] * s_fieldz(ie, l, ix);
+                  }
+
+                  const type_accum duxdxl =
+                      xixl * sum_hprime_x1 + gammaxl * sum_hprime_x3;
+                  const type_accum duxdzl =
+                      xizl * sum_hprime_x1 + gammazl * sum_hprime_x3;
+
+                  const type_accum duzdxl =
+                      xixl * sum_hprime_z1 + gammaxl * sum_hprime_z3;
+                  const type_accum duzdzl =
+                      xizl * sum_hprime_z1 + gammazl * sum_hprime_z3;
+
+                  const type_accum duzdxl_plus_duxdzl = duzdxl + duxdzl;
+
+                  const type_real lambdaplus2mul = get_point_data(
+                      ixz, specfem::Domain::packed::lambdaplus2mu, iz, ix);
+                  const type_accum lambdal = lambdaplus2mul - 2.0 * mul;
+
+                  const type_accum sigma_xx =
+                      lambdaplus2mul * duxdxl + lambdal * duzdzl;
+                  const type_accum sigma_zz =
+                      lambdaplus2mul * duzdzl + lambdal * duxdxl;
+                  const type_accum sigma_xz = mul * duzdxl_plus_duxdzl;
+
+                  s_tempx1(ie, iz, ix) =
+                      jacobianl * (sigma_xx * xixl + sigma_xz * xizl);
+                  s_tempz1(ie, iz, ix) =
+                      jacobianl * (sigma_xz * xixl + sigma_zz * xizl);
+                  s_tempx3(ie, iz, ix) =
+                      jacobianl * (sigma_xx * gammaxl + sigma_xz * gammazl);
+                  s_tempz3(ie, iz, ix) =
+                      jacobianl * (sigma_xz * gammaxl + sigma_zz * gammazl);
+                } else {
+                  // Derivatives of the out of plane displacement along xi and
+                  // gamma
+                  type_accum duydxil = 0;
+                  type_accum duydgammal = 0;
+
+                  for (int l = 0; l < NGLL; l++) {
+                    duydxil += gll.hprime[ix][l] * s_fieldx(ie, iz, l);
+                    duydgammal += gll.hprime[iz][l] * s_fieldx(ie, l, ix);
+                  }
+
+                  const type_accum duydxl =
+                      xixl * duydxil + gammaxl * duydgammal;
+                  const type_accum duydzl =
+                      xizl * duydxil + gammazl * duydgammal;
+
+                  const type_accum sigma_xy = mul * duydxl;
+                  const type_accum sigma_zy = mul * duydzl;
+
+                  s_tempx1(ie, iz, ix) =
+                      jacobianl * (sigma_xy * xixl + sigma_zy * xizl);
+                  s_tempx3(ie, iz, ix) =
+                      jacobianl * (sigma_xy * gammaxl + sigma_zy * gammazl);
+                }
+              });
+
+          team_member.team_barrier();
+
+          // Weighted contractions and assembly into acceleration array
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, npoints),
+              [=](const int ixz) {
+                const int ie = ixz / NGLL2;
+                const int ix = ixz % NGLL;
+                const int iz = (ixz % NGLL2) / NGLL;
+
+                type_accum tempx1 = 0;
+                type_accum tempx3 = 0;
+
+                for (int l = 0; l < NGLL; l++) {
+                  tempx1 += gll.hprimewgll[ix][l] * s_tempx1(ie, iz, l);
+                  tempx3 += gll.hprimewgll[iz][l] * s_tempx3(ie, l, ix);
+                }
+
+                const int iglob = ibool(ispec_domain(ifirst + ie), iz, ix);
+                const type_real sum_terms1 =
+                    -1.0 * (gll.w[iz] * tempx1) - (gll.w[ix] * tempx3);
+                if (use_atomics) {
+                  Kokkos::atomic_add(&field_dot_dot(iglob, icomponent),
+                                     sum_terms1);
+                } else {
+                  field_dot_dot(iglob, icomponent) += sum_terms1;
+                }
+
+                if constexpr (p_sv) {
+                  type_accum tempz1 = 0;
+                  type_accum tempz3 = 0;
+
+                  for (int l = 0; l < NGLL; l++) {
+                    tempz1 += gll.hprimewgll[ix][l] * s_tempz1(ie, iz, l);
+                    tempz3 += gll.hprimewgll[iz][l] * s_tempz3(ie, l, ix);
+                  }
+
+                  const type_real sum_terms3 =
+                      -1.0 * (gll.w[iz] * tempz1) - (gll.w[ix] * tempz3);
+                  if (use_atomics) {
+                    Kokkos::atomic_add(&field_dot_dot(iglob, icomponent + 1),
+                                       sum_terms3);
+                  } else {
+                    field_dot_dot(iglob, icomponent + 1) += sum_terms3;
+                  }
+                }
+              });
+        }
+      },
+      node);
+
+  return;
+}
+
+template <int NGLL, specfem::wave::type WAVE>
+void specfem::Domain::Elastic::compute_stiffness_interaction_gemm(
+    const int istart, const int iend,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  constexpr int NGLL2 = NGLL * NGLL;
+  // Tiles are padded to a multiple of 4 entries such that products have the
+  // same trip count for every NGLL of a padded size
+  constexpr int NPAD = ((NGLL + 3) / 4) * 4;
+  constexpr int NPAD2 = NPAD * NPAD;
+  constexpr int NELEM = specfem::Domain::elements_per_team<NGLL>();
+  // Only the out of plane component is stored for SH waves
+  constexpr bool p_sv = (WAVE == specfem::wave::p_sv);
+  constexpr int NCOMPONENTS = p_sv ? 2 : 1;
+  // Tile of component icomp of element ie is tile ie * NCOMPONENTS + icomp
+  constexpr int NTILES = NELEM * NCOMPONENTS;
+  const int nelements = iend - istart;
+  const int nleague = (nelements + NELEM - 1) / NELEM;
+  const bool use_atomics = (this->assembly == specfem::assembly::atomic);
+  const bool use_packed = this->packed_element_data;
+  const auto element_data = this->get_packed_data();
+  const auto ibool = this->compute->get_ibool();
+  // Active elements are computed in the order they were activated
+  const auto ispec_domain =
+      this->active_elements ? this->active_ispec : this->ispec_domain;
+  const auto xix = this->partial_derivatives->get_xix();
+  const auto xiz = this->partial_derivatives->get_xiz();
+  const auto gammax = this->partial_derivatives->get_gammax();
+  const auto gammaz = this->partial_derivatives->get_gammaz();
+  const auto jacobian = this->partial_derivatives->get_jacobian();
+  const auto mu = this->material_properties->get_mu();
+  const auto lambdaplus2mu = this->material_properties->get_lambdaplus2mu();
+  constexpr auto gll = specfem::quadrature::gll_tables<type_real, NGLL>;
+  const auto field = this->field;
+  const auto field_dot_dot = this->field_dot_dot;
+  const int nshots = this->nshots;
+
+  using StaticOperatorView =
+      specfem::kokkos::StaticDeviceScratchView2d<type_real, NPAD, NPAD>;
+  using StaticTileView =
+      specfem::kokkos::StaticDeviceScratchView3d<type_real, NTILES, NPAD,
+                                                 NPAD>;
+
+  // Scratch plan:
+  //  - padded operators shared by every element of the team. hprime_xx and
+  //    hprimewgll_xx are stored transposed
+  //  - field tiles, overwritten by the weighted contractions along xi
+  //  - derivative tiles along xi and gamma, overwritten by the stress
+  //    integrands
+  //  - weighted contractions along gamma
+  const int scratch_size =
+      4 * StaticOperatorView::shmem_size() + 4 * StaticTileView::shmem_size();
+
+  // One thread per entry of every padded tile of an element by default
+  const int team_size = (NELEM == 1) ? 0 : NELEM * NPAD2;
+  const auto configuration =
+      this->stiffness_tuner.get_config(scratch_size, node == nullptr);
+  const int scratch_level = configuration.scratch_level;
+
+  specfem::autotune::parallel_for(
+      "specfem::Domain::Elastic::compute_forces", this->stiffness_tuner,
+      configuration, exec_space, nleague, team_size, scratch_size,
+      KOKKOS_LAMBDA(
+          const specfem::kokkos::DeviceTeam::member_type &team_member) {
+        const int ifirst = istart + team_member.league_rank() * NELEM;
+        // Number of elements processed by this team
+        const int nelem_team =
+            (iend - ifirst) < NELEM ? (iend - ifirst) : NELEM;
+        const int npoints = nelem_team * NGLL2;
+        const int ntiles = nelem_team * NCOMPONENTS;
+
+        // Read geometry and material properties either from packed element
+        // data or from partial derivatives and properties structs
+        const auto get_element_data =
+            [=](const int ielement, const specfem::Domain::packed::field ifield,
+                const int iz, const int ix) -> type_real {
+          if (use_packed)
+            return element_data(ielement, ifield, iz, ix);
+
+          const int ispec = ispec_domain(ielement);
+          switch (ifield) {
+          case specfem::Domain::packed::xix:
+            return xix(ispec, iz, ix);
+          case specfem::Domain::packed::xiz:
+            return xiz(ispec, iz, ix);
+          case specfem::Domain::packed::gammax:
+            return gammax(ispec, iz, ix);
+          case specfem::Domain::packed::gammaz:
+            return gammaz(ispec, iz, ix);
+          case specfem::Domain::packed::jacobian:
+            return jacobian(ispec, iz, ix);
+          case specfem::Domain::packed::mu:
+            return mu(ispec, iz, ix);
+          default:
+            return lambdaplus2mu(ispec, iz, ix);
+          }
+        };
+
+        const auto &scratch = team_member.team_scratch(scratch_level);
+        StaticOperatorView s_hprime_xt(scratch);
+        StaticOperatorView s_hprime_zz(scratch);
+        StaticOperatorView s_hprimewgll_xt(scratch);
+        StaticOperatorView s_hprimewgll_zz(scratch);
+        StaticTileView s_field(scratch);
+        StaticTileView s_dxi(scratch);
+        StaticTileView s_dgamma(scratch);
+        StaticTileView s_contraction(scratch);
+
+        // -------------Load into scratch memory----------------------------
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team_member, NPAD2), [=](const int ij) {
+              const int i = ij / NPAD;
+              const int j = ij % NPAD;
+              const bool inside = (i < NGLL && j < NGLL);
+              s_hprime_xt(i, j) = inside ? gll.hprime[j][i] : 0.0;
+              s_hprime_zz(i, j) = inside ? gll.hprime[i][j] : 0.0;
+              s_hprimewgll_xt(i, j) = inside ? gll.hprimewgll[j][i] : 0.0;
+              s_hprimewgll_zz(i, j) = inside ? gll.hprimewgll[i][j] : 0.0;
+            });
+
+        for (int ishot = 0; ishot < nshots; ishot++) {
+          const int icomponent = ishot * NCOMPONENTS;
+
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ntiles * NPAD2),
+              [=](const int index) {
+                const int itile = index / NPAD2;
+                const int iz = (index % NPAD2) / NPAD;
+                const int ix = index % NPAD;
+                const int ie = itile / NCOMPONENTS;
+                const int icomp = itile % NCOMPONENTS;
+                if (iz < NGLL && ix < NGLL) {
+                  const int iglob = ibool(ispec_domain(ifirst + ie), iz, ix);
+                  s_field(itile, iz, ix) = field(iglob, icomponent + icomp);
+                } else {
+                  s_field(itile, iz, ix) = 0.0;
+                }
+              });
+          //----------------------------------------------------------------
+
+          team_member.team_barrier();
+
+          // Derivatives along xi (field * hprime_xx^T) and gamma
+          // (hprime_zz * field)
+          team_tile_products<NPAD>(team_member, ntiles, s_field, s_hprime_xt,
+                                   s_field, s_hprime_zz, s_dxi, s_dgamma);
+
+          team_member.team_barrier();
+
+          // Stress integrands along xi and gamma replace the derivatives at
+          // every quadrature point
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, npoints),
+              [=](const int ixz) {
+                const int ie = ixz / NGLL2;
+                const int ix = ixz % NGLL;
+                const int iz = (ixz % NGLL2) / NGLL;
+                const int itile = ie * NCOMPONENTS;
+                const int ielement = ifirst + ie;
+
+                const type_real xixl = get_element_data(
+                    ielement, specfem::Domain::packed::xix, iz, ix);
+                const type_real xizl = get_element_data(
+                    ielement, specfem::Domain::packed::xiz, iz, ix);
+                const type_real gammaxl = get_element_data(
+                    ielement, specfem::Domain::packed::gammax, iz, ix);
+                const type_real gammazl = get_element_data(
+                    ielement, specfem::Domain::packed::gammaz, iz, ix);
+                const type_real jacobianl = get_element_data(
+                    ielement, specfem::Domain::packed::jacobian, iz, ix);
+                const type_real mul = get_element_data(
+                    ielement, specfem::Domain::packed::mu, iz, ix);
+
+                if constexpr (p_sv) {
+                  const type_accum sum_hprime_x1 = s_dxi(itile, iz, ix);
+                  const type_accum sum_hprime_x3 = s_dxi(itile + 1, iz, ix);
+                  const type_accum sum_hprime_z1 = s_dgamma(itile, iz, ix);
+                  const type_accum sum_hprime_z3 = s_dgamma(itile + 1, iz, ix);
+
+                  const type_accum duxdxl =
+                      xixl * sum_hprime_x1 + gammaxl * sum_hprime_x3;
+                  const type_accum duxdzl =
+                      xizl * sum_hprime_x1 + gammazl * sum_hprime_x3;
+
+                  const type_accum duzdxl =
+                      xixl * sum_hprime_z1 + gammaxl * sum_hprime_z3;
+                  const type_accum duzdzl =
+                      xizl * sum_hprime_z1 + gammazl * sum_hprime_z3;
+
+                  const type_accum duzdxl_plus_duxdzl = duzdxl + duxdzl;
+
+                  const type_real lambdaplus2mul = get_element_data(
+                      ielement, specfem::Domain::packed::lambdaplus2mu, iz,
+                      ix);
+                  const type_accum lambdal = lambdaplus2mul - 2.0 * mul;
+
+                  const type_accum sigma_xx =
+                      lambdaplus2mul * duxdxl + lambdal * duzdzl;
+                  const type_accum sigma_zz =
+                      lambdaplus2mul * duzdzl + lambdal * duxdxl;
+                  const type_accum sigma_xz = mul * duzdxl_plus_duxdzl;
+
+                  s_dxi(itile, iz, ix) =
+                      jacobianl * (sigma_xx * xixl + sigma_xz * xizl);
+                  s_dxi(itile + 1, iz, ix) =
+                      jacobianl * (sigma_xz * xixl + sigma_zz * xizl);
+                  s_dgamma(itile, iz, ix) =
+                      jacobianl * (sigma_xx * gammaxl + sigma_xz * gammazl);
+                  s_dgamma(itile + 1, iz, ix) =
+                      jacobianl * (sigma_xz * gammaxl + sigma_zz * gammazl);
+                } else {
+                  const type_accum duydxil = s_dxi(itile, iz, ix);
+                  const type_accum duydgammal = s_dgamma(itile, iz, ix);
+
+                  const type_accum duydxl =
+                      xixl * duydxil + gammaxl * duydgammal;
+                  const type_accum duydzl =
+                      xizl * duydxil + gammazl * duydgammal;
+
+                  const type_accum sigma_xy = mul * duydxl;
+                  const type_accum sigma_zy = mul * duydzl;
+
+                  s_dxi(itile, iz, ix) =
+                      jacobianl * (sigma_xy * xixl + sigma_zy * xizl);
+                  s_dgamma(itile, iz, ix) =
+                      jacobianl * (sigma_xy * gammaxl + sigma_zy * gammazl);
+                }
+              });
+
+          team_member.team_barrier();
+
+          // Weighted contractions along xi (tempx1 * hprimewgll_xx^T) and
+          // gamma (hprimewgll_zz * tempx3)
+          team_tile_products<NPAD>(team_member, ntiles, s_dxi,
+                                   s_hprimewgll_xt, s_dgamma, s_hprimewgll_zz,
+                                   s_field, s_contraction);
+
+          team_member.team_barrier();
+
+          // Assembly into acceleration array
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ntiles * NGLL2),
+              [=](const int index) {
+                const int itile = index / NGLL2;
+                const int ix = index % NGLL;
+                const int iz = (index % NGLL2) / NGLL;
+                const int ie = itile / NCOMPONENTS;
+                const int icomp = itile % NCOMPONENTS;
+
+                const int iglob = ibool(ispec_domain(ifirst + ie), iz, ix);
+                const type_real sum_terms =
+                    -1.0 * (gll.w[iz] * s_field(itile, iz, ix)) -
+                    (gll.w[ix] * s_contraction(itile, iz, ix));
+                if (use_atomics) {
+                  Kokkos::atomic_add(
+                      &field_dot_dot(iglob, icomponent + icomp), sum_terms);
+                } else {
+                  field_dot_dot(iglob, icomponent + icomp) += sum_terms;
+                }
+              });
+
+          // Field tiles of the next shot overwrite the contractions
+          team_member.team_barrier();
+        }
+      },
+      node);
+
+  return;
+}
+
+template <int NGLL>
+void specfem::Domain::Elastic::compute_stiffness_interaction_specialized(
+    const int istart, const int iend,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+  constexpr auto p_sv = specfem::wave::p_sv;
+  constexpr auto sh = specfem::wave::sh;
+
+  // Batched tile products are used on every backend when requested
+  if (this->batched_contractions) {
+    if (this->wave == sh) {
+      this->compute_stiffness_interaction_gemm<NGLL, sh>(istart, iend,
+                                                         exec_space, node);
+    } else {
+      this->compute_stiffness_interaction_gemm<NGLL, p_sv>(istart, iend,
+                                                           exec_space, node);
+    }
+  } else if (specfem::Domain::host_backend() && this->host_lanes &&
+             this->nshots == 1) {
+    // Lanes interleave elements of a single shot. Batched shots already reuse
+    // element data across shots, hence they use team kernels on every
+    // backend
+    if (this->wave == sh) {
+      this->compute_stiffness_interaction_simd<NGLL, sh>(istart, iend,
+                                                         node);
+    } else {
+      this->compute_stiffness_interaction_simd<NGLL, p_sv>(istart, iend,
+                                                           node);
+    }
+  } else {
+    if (this->wave == sh) {
+      this->compute_stiffness_interaction_ngll<NGLL, sh>(istart, iend,
+                                                         exec_space, node);
+    } else {
+      this->compute_stiffness_interaction_ngll<NGLL, p_sv>(istart, iend,
+                                                           exec_space, node);
+    }
+  }
+
+  return;
+}
+
+template <int NGLL, specfem::wave::type WAVE>
+void specfem::Domain::Elastic::compute_stiffness_interaction_simd(
+    const int istart, const int iend, specfem::kokkos::DeviceGraphNode *node) {
+
+  constexpr int NLANES = specfem::Domain::simd_lanes<type_real>();
+  const int nelements = iend - istart;
+  const int ivector_end = istart + (nelements / NLANES) * NLANES;
+
+  // Full batches are vectorized across elements
+  this->compute_stiffness_interaction_lanes<NGLL, NLANES, WAVE>(
+      istart, ivector_end, node);
+  // Scalar fallback for remainder elements
+  this->compute_stiffness_interaction_lanes<NGLL, 1, WAVE>(ivector_end, iend,
+                                                           node);
+
+  return;
+}
+
+template <int NGLL, int NLANES, specfem::wave::type WAVE>
+void specfem::Domain::Elastic::compute_stiffness_interaction_lanes(
+    const int istart, const int iend, specfem::kokkos::DeviceGraphNode *node) {
+
+  const int nbatches = (iend - istart) / NLANES;
+  if (nbatches == 0)
+    return;
+
+  // Only the out of plane component is stored for SH waves
+  constexpr bool p_sv = (WAVE == specfem::wave::p_sv);
+  const bool use_atomics = (this->assembly == specfem::assembly::atomic);
+  const bool use_packed = this->packed_element_data;
+  const auto element_data = this->get_packed_data();
+  const auto ibool = this->compute->get_ibool();
+  // Active elements are computed in the order they were activated
+  const auto ispec_domain =
+      this->active_elements ? this->active_ispec : this->ispec_domain;
+  const auto xix = this->partial_derivatives->get_xix();
+  const auto xiz = this->partial_derivatives->get_xiz();
+  const auto gammax = this->partial_derivatives->get_gammax();
+  const auto gammaz = this->partial_derivatives->get_gammaz();
+  const auto jacobian = this->partial_derivatives->get_jacobian();
+  const auto mu = this->material_properties->get_mu();
+  const auto lambdaplus2mu = this->material_properties->get_lambdaplus2mu();
+  // Loops over quadrature points have compile-time trip counts, hence the
+  // values of the table are folded into the unrolled contractions
+  constexpr auto gll = specfem::quadrature::gll_tables<type_real, NGLL>;
+  const auto field = this->field;
+  const auto field_dot_dot = this->field_dot_dot;
+
+  // This kernel is only selected when device memory is accessible from host
+  specfem::kokkos::parallel_for(
+      "specfem::Domain::Elastic::compute_forces_simd",
+      Kokkos::RangePolicy<specfem::kokkos::HostExecSpace>(0, nbatches),
+      [=](const int ibatch) {
+        const int ifirst = istart + ibatch * NLANES;
+
+        // Element-interleaved lanes: the last index is the element in batch
+        int l_ispec[NLANES];
+        int l_iglob[NGLL][NGLL][NLANES];
+        type_real l_fieldx[NGLL][NGLL][NLANES];
+        type_real l_fieldz[NGLL][NGLL][NLANES];
+        type_real l_tempx1[NGLL][NGLL][NLANES];
+        type_real l_tempz1[NGLL][NGLL][NLANES];
+        type_real l_tempx3[NGLL][NGLL][NLANES];
+        type_real l_tempz3[NGLL][NGLL][NLANES];
+
+        for (int lane = 0; lane < NLANES; lane++)
+          l_ispec[lane] = ispec_domain(ifirst + lane);
+
+        // -------------Gather fields into lanes---------------------------
+        for (int iz = 0; iz < NGLL; iz++) {
+          for (int ix = 0; ix < NGLL; ix++) {
+            for (int lane = 0; lane < NLANES; lane++) {
+              const int iglob = ibool(l_ispec[lane], iz, ix);
+              l_iglob[iz][ix][lane] = iglob;
+              l_fieldx[iz][ix][lane] = field(iglob, 0);
+              if constexpr (p_sv)
+                l_fieldz[iz][ix][lane] = field(iglob, 1);
+            }
+          }
+        }
+        //----------------------------------------------------------------
+
+        // Compute stress and the stress integrands along xi (tempx1) and
+        // gamma (tempx3)
+        for (int iz = 0; iz < NGLL; iz++) {
+          for (int ix = 0; ix < NGLL; ix++) {
+            type_real xixl[NLANES], xizl[NLANES], gammaxl[NLANES],
+                gammazl[NLANES], jacobianl[NLANES], mul[NLANES],
+                lambdaplus2mul[NLANES];
+
+            // Gather geometry and material properties into lanes
+            if (use_packed) {
+              for (int lane = 0; lane < NLANES; lane++) {
+                const int ielement = ifirst + lane;
+                xixl[lane] = element_data(
+                    ielement, specfem::Domain::packed::xix, iz, ix);
+                xizl[lane] = element_data(
+                    ielement, specfem::Domain::packed::xiz, iz, ix);
+                gammaxl[lane] = element_data(
+                    ielement, specfem::Domain::packed::gammax, iz, ix);
+                gammazl[lane] = element_data(
+                    ielement, specfem::Domain::packed::gammaz, iz, ix);
+                jacobianl[lane] = element_data(
+                    ielement, specfem::Domain::packed::jacobian, iz, ix);
+                mul[lane] =
+                    element_data(ielement, specfem::Domain::packed::mu, iz, ix);
+                if constexpr (p_sv)
+                  lambdaplus2mul[lane] = element_data(
+                      ielement, specfem::Domain::packed::lambdaplus2mu, iz, ix);
+              }
+            } else {
+              for (int lane = 0; lane < NLANES; lane++) {
+                const int ispec = l_ispec[lane];
+                xixl[lane] = xix(ispec, iz, ix);
+                xizl[lane] = xiz(ispec, iz, ix);
+                gammaxl[lane] = gammax(ispec, iz, ix);
+                gammazl[lane] = gammaz(ispec, iz, ix);
+                jacobianl[lane] = jacobian(ispec, iz, ix);
+                mul[lane] = mu(ispec, iz, ix);
+                if constexpr (p_sv)
+                  lambdaplus2mul[lane] = lambdaplus2mu(ispec, iz, ix);
+              }
+            }
+
+            if constexpr (p_sv) {
+              SPECFEM_SIMD_LOOP
+              for (int lane = 0; lane < NLANES; lane++) {
+                type_accum sum_hprime_x1 = 0;
+                type_accum sum_hprime_x3 = 0;
+                type_accum sum_hprime_z1 = 0;
+                type_accum sum_hprime_z3 = 0;
+
+                for (int l = 0; l < NGLL; l++) {
+                  sum_hprime_x1 += gll.hprime[ix][l] * l_fieldx[iz][l][lane];
+                  sum_hprime_x3 += gll.hprime[ix][l] * l_fieldz[iz][l][lane];
+                  sum_hprime_z1 += gll.hprime[iz][l] * l_fieldx[l][ix][lane];
+                  sum_hprime_z3 += gll.hprime[iz][l] * l_fieldz[l][ix][lane];
+                }
+
+                const type_accum duxdxl =
+                    xixl[lane] * sum_hprime_x1 + gammaxl[lane] * sum_hprime_x3;
+                const type_accum duxdzl =
+                    xizl[lane] * sum_hprime_x1 + gammazl[lane] * sum_hprime_x3;
+
+                const type_accum duzdxl =
+                    xixl[lane] * sum_hprime_z1 + gammaxl[lane] * sum_hprime_z3;
+                const type_accum duzdzl =
+                    xizl[lane] * sum_hprime_z1 + gammazl[lane] * sum_hprime_z3;
+
+                const type_accum duzdxl_plus_duxdzl = duzdxl + duxdzl;
+
+                const type_accum lambdal =
+                    lambdaplus2mul[lane] - 2.0 * mul[lane];
+
+                const type_accum sigma_xx =
+                    lambdaplus2mul[lane] * duxdxl + lambdal * duzdzl;
+                const type_accum sigma_zz =
+                    lambdaplus2mul[lane] * duzdzl + lambdal * duxdxl;
+                const type_accum sigma_xz = mul[lane] * duzdxl_plus_duxdzl;
+
+                l_tempx1[iz][ix][lane] =
+                    jacobianl[lane] *
+                    (sigma_xx * xixl[lane] + sigma_xz * xizl[lane]);
+                l_tempz1[iz][ix][lane] =
+                    jacobianl[lane] *
+                    (sigma_xz * xixl[lane] + sigma_zz * xizl[lane]);
+                l_tempx3[iz][ix][lane] =
+                    jacobianl[lane] *
+                    (sigma_xx * gammaxl[lane] + sigma_xz * gammazl[lane]);
+                l_tempz3[iz][ix][lane] =
+                    jacobianl[lane] *
+                    (sigma_xz * gammaxl[lane] + sigma_zz * gammazl[lane]);
+              }
+            } else {
+              SPECFEM_SIMD_LOOP
+              for (int lane = 0; lane < NLANES; lane++) {
+                // Derivatives of the out of plane displacement along xi and
+                // gamma
+                type_accum duydxil = 0;
+                type_accum duydgammal = 0;
+
+                for (int l = 0; l < NGLL; l++) {
+                  duydxil += gll.hprime[ix][l] * l_fieldx[iz][l][lane];
+                  duydgammal += gll.hprime[iz][l] * l_fieldx[l][ix][lane];
+                }
+
+                const type_accum duydxl =
+                    xixl[lane] * duydxil + gammaxl[lane] * duydgammal;
+                const type_accum duydzl =
+                    xizl[lane] * duydxil + gammazl[lane] * duydgammal;
+
+                const type_accum sigma_xy = mul[lane] * duydxl;
+                const type_accum sigma_zy = mul[lane] * duydzl;
+
+                l_tempx1[iz][ix][lane] =
+                    jacobianl[lane] *
+                    (sigma_xy * xixl[lane] + sigma_zy * xizl[lane]);
+                l_tempx3[iz][ix][lane] =
+                    jacobianl[lane] *
+                    (sigma_xy * gammaxl[lane] + sigma_zy * gammazl[lane]);
+              }
+            }
+          }
+        }
+
+        // Weighted contractions and assembly into acceleration array
+        for (int iz = 0; iz < NGLL; iz++) {
+          for (int ix = 0; ix < NGLL; ix++) {
+            type_real sum_terms1[NLANES], sum_terms3[NLANES];
+
+            SPECFEM_SIMD_LOOP
+            for (int lane = 0; lane < NLANES; lane++) {
+              type_accum tempx1 = 0;
+              type_accum tempx3 = 0;
+
+              for (int l = 0; l < NGLL; l++) {
+                tempx1 += gll.hprimewgll[ix][l] * l_tempx1[iz][l][lane];
+                tempx3 += gll.hprimewgll[iz][l] * l_tempx3[l][ix][lane];
+              }
+
+              sum_terms1[lane] =
+                  -1.0 * (gll.w[iz] * tempx1) - (gll.w[ix] * tempx3);
+            }
+
+            if constexpr (p_sv) {
+              SPECFEM_SIMD_LOOP
+              for (int lane = 0; lane < NLANES; lane++) {
+                type_accum tempz1 = 0;
+                type_accum tempz3 = 0;
+
+                for (int l = 0; l < NGLL; l++) {
+                  tempz1 += gll.hprimewgll[ix][l] * l_tempz1[iz][l][lane];
+                  tempz3 += gll.hprimewgll[iz][l] * l_tempz3[l][ix][lane];
+                }
+
+                sum_terms3[lane] =
+                    -1.0 * (gll.w[iz] * tempz1) - (gll.w[ix] * tempz3);
+              }
+            }
+
+            // Lanes are scattered one at a time since elements within a batch
+            // can share global nodes
+            for (int lane = 0; lane < NLANES; lane++) {
+              const int iglob = l_iglob[iz][ix][lane];
+              if (use_atomics) {
+                Kokkos::atomic_add(&field_dot_dot(iglob, 0), sum_terms1[lane]);
+                if constexpr (p_sv)
+                  Kokkos::atomic_add(&field_dot_dot(iglob, 1),
+                                     sum_terms3[lane]);
+              } else {
+                field_dot_dot(iglob, 0) += sum_terms1[lane];
+                if constexpr (p_sv)
+                  field_dot_dot(iglob, 1) += sum_terms3[lane];
+              }
+            }
+          }
+        }
+      },
+      node);
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_stiffness_interaction_generic(
+    const int istart, const int iend,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  const int ngllx = this->quadx->get_N();
+  const int ngllz = this->quadz->get_N();
+  const int ngllxz = ngllx * ngllz;
+  const auto ibool = this->compute->get_ibool();
+  // Active elements are computed in the order they were activated
+  const auto ispec_domain =
+      this->active_elements ? this->active_ispec : this->ispec_domain;
+  const auto xix = this->partial_derivatives->get_xix();
+  const auto xiz = this->partial_derivatives->get_xiz();
+  const auto gammax = this->partial_derivatives->get_gammax();
+  const auto gammaz = this->partial_derivatives->get_gammaz();
+  const auto jacobian = this->partial_derivatives->get_jacobian();
+  const auto mu = this->material_properties->get_mu();
+  const auto lambdaplus2mu = this->material_properties->get_lambdaplus2mu();
+  const auto wxgll = this->quadx->get_w();
+  const auto wzgll = this->quadz->get_w();
+  const auto hprime_xx = this->quadx->get_hprime();
+  const auto hprime_zz = this->quadz->get_hprime();
+  const auto hprimewgll_xx = this->quadx->get_hprimewgll();
+  const auto hprimewgll_zz = this->quadz->get_hprimewgll();
+  const auto field = this->field;
+  const auto field_dot_dot = this->field_dot_dot;
+  const bool use_atomics = (this->assembly == specfem::assembly::atomic);
+  // Only the out of plane component is stored for SH waves
+  const bool p_sv = (this->wave == specfem::wave::p_sv);
+  const int nshots = this->nshots;
+  const int ncomponents = p_sv ? 2 : 1;
+  // Coarse grained memory variables, see set_attenuation
+  const int n_sls = this->n_sls;
+  const bool attenuated = (n_sls > 0);
+  const type_real dispersion = this->attenuation_dispersion;
+  const auto sls = this->sls;
+  const auto inverse_qkappa = this->inverse_qkappa;
+  const auto inverse_qmu = this->inverse_qmu;
+  const auto memory_variables = this->memory_variables;
+  const int nvariables = p_sv ? 3 : 2;
+
+  int scratch_size =
+      specfem::kokkos::DeviceScratchView1d<type_real>::shmem_size(ngllx);
+  scratch_size +=
+      specfem::kokkos::DeviceScratchView1d<type_real>::shmem_size(ngllz);
+  scratch_size +=
+      2 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllx, ngllx);
+  scratch_size +=
+      2 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllz, ngllz);
+  scratch_size +=
+      6 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllz, ngllx);
+
+  const auto configuration =
+      this->stiffness_tuner.get_config(scratch_size, node == nullptr);
+  const int scratch_level = configuration.scratch_level;
+
+  specfem::autotune::parallel_for(
+      "specfem::Domain::Elastic::compute_forces", this->stiffness_tuner,
+      configuration, exec_space, iend - istart, 0, scratch_size,
+      KOKKOS_LAMBDA(
+          const specfem::kokkos::DeviceTeam::member_type &team_member) {
+        const int ispec = ispec_domain(istart + team_member.league_rank());
+
+        // Assign scratch views
+        specfem::kokkos::DeviceScratchView1d<type_real> s_wxgll(
+            team_member.team_scratch(scratch_level), ngllx);
+        specfem::kokkos::DeviceScratchView1d<type_real> s_wzgll(
+            team_member.team_scratch(scratch_level), ngllz);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprime_xx(
+            team_member.team_scratch(scratch_level), ngllx, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprime_zz(
+            team_member.team_scratch(scratch_level), ngllz, ngllz);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprimewgll_xx(
+            team_member.team_scratch(scratch_level), ngllx, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprimewgll_zz(
+            team_member.team_scratch(scratch_level), ngllz, ngllz);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_fieldx(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_fieldz(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempx1(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempz1(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempx3(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempz3(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+
+        // -------------Load into scratch memory----------------------------
+        Kokkos::parallel_for(Kokkos::TeamThreadRange(team_member, ngllx),
+                             [=](const int ix) { s_wxgll(ix) = wxgll(ix); });
+
+        Kokkos::parallel_for(Kokkos::TeamThreadRange(team_member, ngllz),
+                             [=](const int iz) { s_wzgll(iz) = wzgll(iz); });
+
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team_member, ngllx * ngllx),
+            [=](const int ij) {
+              const int i = ij % ngllx;
+              const int j = ij / ngllx;
+              s_hprime_xx(j, i) = hprime_xx(j, i);
+              s_hprimewgll_xx(j, i) = hprimewgll_xx(j, i);
+            });
+
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team_member, ngllz * ngllz),
+            [=](const int ij) {
+              const int i = ij % ngllz;
+              const int j = ij / ngllz;
+              s_hprime_zz(j, i) = hprime_zz(j, i);
+              s_hprimewgll_zz(j, i) = hprimewgll_zz(j, i);
+            });
+        //----------------------------------------------------------------
+
+        // Shots are computed one after the other. The barrier following the
+        // field load also guarantees the contractions of the previous shot
+        // are done with the stress integrands
+        for (int ishot = 0; ishot < nshots; ishot++) {
+          const int icomponent = ishot * ncomponents;
+
+          Kokkos::parallel_for(Kokkos::TeamThreadRange(team_member, ngllxz),
+                               [=](const int xz) {
+                                 const int ix = xz % ngllx;
+                                 const int iz = xz / ngllx;
+                                 int iglob = ibool(ispec, iz, ix);
+                                 s_fieldx(iz, ix) = field(iglob, icomponent);
+                                 if (p_sv)
+                                   s_fieldz(iz, ix) =
+                                       field(iglob, icomponent + 1);
+                               });
+
+          team_member.team_barrier();
+
+          // Compute stress and the stress integrands along xi (tempx1) and
+          // gamma (tempx3). Stress is kept in registers
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+                const int ix = xz % ngllx;
+                const int iz = xz / ngllx;
+
+                type_accum sum_hprime_x1 = 0;
+                type_accum sum_hprime_x3 = 0;
+                type_accum sum_hprime_z1 = 0;
+                type_accum sum_hprime_z3 = 0;
+
+                for (int l = 0; l < ngllx; l++) {
+                  sum_hprime_x1 += s_hprime_xx(ix, l) * s_fieldx(iz, l);
+                  if (p_sv)
+                    sum_hprime_x3 += s_hprime_xx(ix, l) * s_fieldz(iz, l);
+                }
+
+                for (int l = 0; l < ngllz; l++) {
+                  sum_hprime_z1 += s_hprime_zz(iz, l) * s_fieldx(l, ix);
+                  if (p_sv)
+                    sum_hprime_z3 += s_hprime_zz(iz, l) * s_fieldz(l, ix);
+                }
+
+                const type_real xixl = xix(ispec, iz, ix);
+                const type_real xizl = xiz(ispec, iz, ix);
+                const type_real gammaxl = gammax(ispec, iz, ix);
+                const type_real gammazl = gammaz(ispec, iz, ix);
+                const type_real jacobianl = jacobian(ispec, iz, ix);
+                const type_real mul = mu(ispec, iz, ix);
+
+                type_accum sigma_xx = 0;
+                type_accum sigma_zz = 0;
+                type_accum sigma_xz = 0;
+
+                if (p_sv) {
+                  const type_accum duxdxl =
+                      xixl * sum_hprime_x1 + gammaxl * sum_hprime_x3;
+                  const type_accum duxdzl =
+                      xizl * sum_hprime_x1 + gammazl * sum_hprime_x3;
+
+                  const type_accum duzdxl =
+                      xixl * sum_hprime_z1 + gammaxl * sum_hprime_z3;
+                  const type_accum duzdzl =
+                      xizl * sum_hprime_z1 + gammazl * sum_hprime_z3;
+
+                  const type_accum duzdxl_plus_duxdzl = duzdxl + duxdzl;
+
+                  const type_real lambdaplus2mul = lambdaplus2mu(ispec, iz, ix);
+                  const type_accum lambdal = lambdaplus2mul - 2.0 * mul;
+
+                  if (attenuated) {
+                    // Unrelaxed moduli and memory variables of the bulk,
+                    // deviatoric and shear stress
+                    const int isls =
+                        specfem::attenuation::sls_index(iz, ix, n_sls);
+                    const type_real decay = sls(isls, 0);
+                    const type_real relaxation = (1.0 - decay) * sls(isls, 1);
+                    const type_real inverse_qkappal =
+                        inverse_qkappa(ispec, iz, ix);
+                    const type_real inverse_qmul = inverse_qmu(ispec, iz, ix);
+                    const type_accum kappa_u =
+                        (lambdal + mul) / (1.0 - dispersion * inverse_qkappal);
+                    const type_accum mu_u =
+                        mul / (1.0 - dispersion * inverse_qmul);
+                    const type_accum theta = duxdxl + duzdzl;
+                    const type_accum deviator = duxdxl - duzdzl;
+                    const int ivariable = ishot * nvariables;
+
+                    type_real &bulk =
+                        memory_variables(ispec, iz, ix, ivariable);
+                    type_real &deviatoric =
+                        memory_variables(ispec, iz, ix, ivariable + 1);
+                    type_real &shear =
+                        memory_variables(ispec, iz, ix, ivariable + 2);
+                    bulk = decay * bulk +
+                           relaxation * inverse_qkappal * kappa_u * theta;
+                    deviatoric = decay * deviatoric +
+                                 relaxation * inverse_qmul * mu_u * deviator;
+                    shear = decay * shear + relaxation * inverse_qmul * mu_u *
+                                                duzdxl_plus_duxdzl;
+
+                    sigma_xx = kappa_u * theta + mu_u * deviator - bulk -
+                               deviatoric;
+                    sigma_zz = kappa_u * theta - mu_u * deviator - bulk +
+                               deviatoric;
+                    sigma_xz = mu_u * duzdxl_plus_duxdzl - shear;
+                  } else {
+                    sigma_xx = lambdaplus2mul * duxdxl + lambdal * duzdzl;
+                    sigma_zz = lambdaplus2mul * duzdzl + lambdal * duxdxl;
+                    sigma_xz = mul * duzdxl_plus_duxdzl;
+                  }
+                } else {
+                  // SH-case: sum_hprime_x1 and sum_hprime_z1 are derivatives of
+                  // the out of plane displacement along xi and gamma
+                  const type_accum duydxl =
+                      xixl * sum_hprime_x1 + gammaxl * sum_hprime_z1;
+                  const type_accum duydzl =
+                      xizl * sum_hprime_x1 + gammazl * sum_hprime_z1;
+                  if (attenuated) {
+                    const int isls =
+                        specfem::attenuation::sls_index(iz, ix, n_sls);
+                    const type_real decay = sls(isls, 0);
+                    const type_real inverse_qmul = inverse_qmu(ispec, iz, ix);
+                    const type_real relaxation =
+                        (1.0 - decay) * sls(isls, 1) * inverse_qmul;
+                    const type_accum mu_u =
+                        mul / (1.0 - dispersion * inverse_qmul);
+                    const int ivariable = ishot * nvariables;
+
+                    type_real &shear_x =
+                        memory_variables(ispec, iz, ix, ivariable);
+                    type_real &shear_z =
+                        memory_variables(ispec, iz, ix, ivariable + 1);
+                    shear_x = decay * shear_x + relaxation * mu_u * duydxl;
+                    shear_z = decay * shear_z + relaxation * mu_u * duydzl;
+
+                    sigma_xx = mu_u * duydxl - shear_x; // sigma_xy
+                    sigma_xz = mu_u * duydzl - shear_z; // sigma_zy
+                  } else {
+                    sigma_xx = mul * duydxl; // sigma_xy
+                    sigma_xz = mul * duydzl; // sigma_zy
+                  }
+                }
+
+                s_tempx1(iz, ix) =
+                    jacobianl * (sigma_xx * xixl + sigma_xz * xizl);
+                s_tempz1(iz, ix) =
+                    jacobianl * (sigma_xz * xixl + sigma_zz * xizl);
+                s_tempx3(iz, ix) =
+                    jacobianl * (sigma_xx * gammaxl + sigma_xz * gammazl);
+                s_tempz3(iz, ix) =
+                    jacobianl * (sigma_xz * gammaxl + sigma_zz * gammazl);
+              });
+
+          team_member.team_barrier();
+
+          // Weighted contractions and assembly into acceleration array
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+                const int ix = xz % ngllx;
+                const int iz = xz / ngllx;
+
+                type_accum tempx1 = 0;
+                type_accum tempz1 = 0;
+                type_accum tempx3 = 0;
+                type_accum tempz3 = 0;
+
+                for (int l = 0; l < ngllx; l++) {
+                  tempx1 += s_hprimewgll_xx(ix, l) * s_tempx1(iz, l);
+                  tempz1 += s_hprimewgll_xx(ix, l) * s_tempz1(iz, l);
+                }
+
+                for (int l = 0; l < ngllz; l++) {
+                  tempx3 += s_hprimewgll_zz(iz, l) * s_tempx3(l, ix);
+                  tempz3 += s_hprimewgll_zz(iz, l) * s_tempz3(l, ix);
+                }
+
+                const int iglob = ibool(ispec, iz, ix);
+                const type_real sum_terms1 =
+                    -1.0 * (s_wzgll(iz) * tempx1) - (s_wxgll(ix) * tempx3);
+                const type_real sum_terms3 =
+                    -1.0 * (s_wzgll(iz) * tempz1) - (s_wxgll(ix) * tempz3);
+                Kokkos::single(Kokkos::PerThread(team_member), [=] {
+                  if (use_atomics) {
+                    Kokkos::atomic_add(&field_dot_dot(iglob, icomponent),
+                                       sum_terms1);
+                    if (p_sv)
+                      Kokkos::atomic_add(&field_dot_dot(iglob, icomponent + 1),
+                                         sum_terms3);
+                  } else {
+                    field_dot_dot(iglob, icomponent) += sum_terms1;
+                    if (p_sv)
+                      field_dot_dot(iglob, icomponent + 1) += sum_terms3;
+                  }
+                });
+              });
+        }
+      },
+      node);
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_stiffness_interaction_axisymmetric(
+    const int istart, const int iend,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  const int ngllx = this->quadx->get_N();
+  const int ngllz = this->quadz->get_N();
+  const int ngllxz = ngllx * ngllz;
+  const auto ibool = this->compute->get_ibool();
+  // Active elements are computed in the order they were activated
+  const auto ispec_domain =
+      this->active_elements ? this->active_ispec : this->ispec_domain;
+  const auto xix = this->partial_derivatives->get_xix();
+  const auto xiz = this->partial_derivatives->get_xiz();
+  const auto gammax = this->partial_derivatives->get_gammax();
+  const auto gammaz = this->partial_derivatives->get_gammaz();
+  const auto jacobian = this->partial_derivatives->get_jacobian();
+  const auto mu = this->material_properties->get_mu();
+  const auto lambdaplus2mu = this->material_properties->get_lambdaplus2mu();
+  const auto wxgll = this->quadx->get_w();
+  const auto wzgll = this->quadz->get_w();
+  const auto hprime_xx = this->quadx->get_hprime();
+  const auto hprime_zz = this->quadz->get_hprime();
+  const auto hprimewgll_xx = this->quadx->get_hprimewgll();
+  const auto hprimewgll_zz = this->quadz->get_hprimewgll();
+  const auto wxglj = this->wxglj;
+  const auto hprimeBar_xx = this->hprimeBar_xx;
+  const auto hprimeBarwglj_xx = this->hprimeBarwglj_xx;
+  const auto axial = this->axial;
+  const auto radius = this->radius;
+  const auto radius_factor = this->radius_factor;
+  const auto field = this->field;
+  const auto field_dot_dot = this->field_dot_dot;
+  const bool use_atomics = (this->assembly == specfem::assembly::atomic);
+  const int nshots = this->nshots;
+
+  int scratch_size =
+      specfem::kokkos::DeviceScratchView1d<type_real>::shmem_size(ngllx);
+  scratch_size +=
+      specfem::kokkos::DeviceScratchView1d<type_real>::shmem_size(ngllz);
+  scratch_size +=
+      2 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllx, ngllx);
+  scratch_size +=
+      2 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllz, ngllz);
+  scratch_size +=
+      7 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllz, ngllx);
+
+  const auto configuration =
+      this->stiffness_tuner.get_config(scratch_size, node == nullptr);
+  const int scratch_level = configuration.scratch_level;
+
+  specfem::autotune::parallel_for(
+      "specfem::Domain::Elastic::compute_forces_axisymmetric",
+      this->stiffness_tuner, configuration, exec_space, iend - istart, 0,
+      scratch_size,
+      KOKKOS_LAMBDA(
+          const specfem::kokkos::DeviceTeam::member_type &team_member) {
+        const int ispec = ispec_domain(istart + team_member.league_rank());
+        const bool on_the_axis = axial(ispec);
+
+        specfem::kokkos::DeviceScratchView1d<type_real> s_wxgll(
+            team_member.team_scratch(scratch_level), ngllx);
+        specfem::kokkos::DeviceScratchView1d<type_real> s_wzgll(
+            team_member.team_scratch(scratch_level), ngllz);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprime_xx(
+            team_member.team_scratch(scratch_level), ngllx, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprime_zz(
+            team_member.team_scratch(scratch_level), ngllz, ngllz);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprimewgll_xx(
+            team_member.team_scratch(scratch_level), ngllx, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hprimewgll_zz(
+            team_member.team_scratch(scratch_level), ngllz, ngllz);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_fieldx(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_fieldz(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempx1(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempz1(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempx3(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempz3(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_hoop(
+            team_member.team_scratch(scratch_level), ngllz, ngllx);
+
+        // Elements on the axis use the GLJ quadrature along xi
+        Kokkos::parallel_for(Kokkos::TeamThreadRange(team_member, ngllx),
+                             [=](const int ix) {
+                               s_wxgll(ix) =
+                                   on_the_axis ? wxglj(ix) : wxgll(ix);
+                             });
+
+        Kokkos::parallel_for(Kokkos::TeamThreadRange(team_member, ngllz),
+                             [=](const int iz) { s_wzgll(iz) = wzgll(iz); });
+
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team_member, ngllx * ngllx),
+            [=](const int ij) {
+              const int i = ij % ngllx;
+              const int j = ij / ngllx;
+              s_hprime_xx(j, i) =
+                  on_the_axis ? hprimeBar_xx(j, i) : hprime_xx(j, i);
+              s_hprimewgll_xx(j, i) =
+                  on_the_axis ? hprimeBarwglj_xx(j, i) : hprimewgll_xx(j, i);
+            });
+
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team_member, ngllz * ngllz),
+            [=](const int ij) {
+              const int i = ij % ngllz;
+              const int j = ij / ngllz;
+              s_hprime_zz(j, i) = hprime_zz(j, i);
+              s_hprimewgll_zz(j, i) = hprimewgll_zz(j, i);
+            });
+
+        for (int ishot = 0; ishot < nshots; ishot++) {
+          const int icomponent = 2 * ishot;
+
+          Kokkos::parallel_for(Kokkos::TeamThreadRange(team_member, ngllxz),
+                               [=](const int xz) {
+                                 const int ix = xz % ngllx;
+                                 const int iz = xz / ngllx;
+                                 int iglob = ibool(ispec, iz, ix);
+                                 s_fieldx(iz, ix) = field(iglob, icomponent);
+                                 s_fieldz(iz, ix) =
+                                     field(iglob, icomponent + 1);
+                               });
+
+          team_member.team_barrier();
+
+          // Stress integrands weighted by the radius. s_hoop holds the hoop
+          // stress weighted by radius_factor / r, or by
+          // radius_factor * dxi / dx on the axis
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+                const int ix = xz % ngllx;
+                const int iz = xz / ngllx;
+
+                type_accum duxdxi = 0;
+                type_accum duzdxi = 0;
+                type_accum duxdgamma = 0;
+                type_accum duzdgamma = 0;
+
+                for (int l = 0; l < ngllx; l++) {
+                  duxdxi += s_hprime_xx(ix, l) * s_fieldx(iz, l);
+                  duzdxi += s_hprime_xx(ix, l) * s_fieldz(iz, l);
+                }
+
+                for (int l = 0; l < ngllz; l++) {
+                  duxdgamma += s_hprime_zz(iz, l) * s_fieldx(l, ix);
+                  duzdgamma += s_hprime_zz(iz, l) * s_fieldz(l, ix);
+                }
+
+                const type_real xixl = xix(ispec, iz, ix);
+                const type_real xizl = xiz(ispec, iz, ix);
+                const type_real gammaxl = gammax(ispec, iz, ix);
+                const type_real gammazl = gammaz(ispec, iz, ix);
+                const type_real jacobianl = jacobian(ispec, iz, ix);
+                const type_real mul = mu(ispec, iz, ix);
+                const type_real lambdaplus2mul = lambdaplus2mu(ispec, iz, ix);
+                const type_accum lambdal = lambdaplus2mul - 2.0 * mul;
+                const type_real rl = radius(ispec, iz, ix);
+                const type_real factorl = radius_factor(ispec, iz, ix);
+
+                const type_accum duxdxl = xixl * duxdxi + gammaxl * duxdgamma;
+                const type_accum duxdzl = xizl * duxdxi + gammazl * duxdgamma;
+                const type_accum duzdxl = xixl * duzdxi + gammaxl * duzdgamma;
+                const type_accum duzdzl = xizl * duzdxi + gammazl * duzdgamma;
+
+                // u_x / r tends to du_x / dx on the axis
+                const type_accum dphidphil =
+                    (rl > 0.0) ? s_fieldx(iz, ix) / rl : duxdxl;
+
+                const type_accum sigma_xx =
+                    lambdaplus2mul * duxdxl + lambdal * (duzdzl + dphidphil);
+                const type_accum sigma_zz =
+                    lambdaplus2mul * duzdzl + lambdal * (duxdxl + dphidphil);
+                const type_accum sigma_xz = mul * (duzdxl + duxdzl);
+                const type_accum sigma_phiphi =
+                    lambdaplus2mul * dphidphil + lambdal * (duxdxl + duzdzl);
+
+                const type_real weight = jacobianl * factorl;
+                s_tempx1(iz, ix) = weight * (sigma_xx * xixl + sigma_xz * xizl);
+                s_tempz1(iz, ix) = weight * (sigma_xz * xixl + sigma_zz * xizl);
+                s_tempx3(iz, ix) =
+                    weight * (sigma_xx * gammaxl + sigma_xz * gammazl);
+                s_tempz3(iz, ix) =
+                    weight * (sigma_xz * gammaxl + sigma_zz * gammazl);
+                s_hoop(iz, ix) = (rl > 0.0) ? weight * sigma_phiphi / rl
+                                            : weight * sigma_phiphi * xixl;
+              });
+
+          team_member.team_barrier();
+
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+                const int ix = xz % ngllx;
+                const int iz = xz / ngllx;
+
+                type_accum tempx1 = 0;
+                type_accum tempz1 = 0;
+                type_accum tempx3 = 0;
+                type_accum tempz3 = 0;
+
+                for (int l = 0; l < ngllx; l++) {
+                  tempx1 += s_hprimewgll_xx(ix, l) * s_tempx1(iz, l);
+                  tempz1 += s_hprimewgll_xx(ix, l) * s_tempz1(iz, l);
+                }
+
+                for (int l = 0; l < ngllz; l++) {
+                  tempx3 += s_hprimewgll_zz(iz, l) * s_tempx3(l, ix);
+                  tempz3 += s_hprimewgll_zz(iz, l) * s_tempz3(l, ix);
+                }
+
+                // Hoop stress tested by u_x / r. On the axis u_x / r is
+                // du_x / dx, which couples the axis point of the row to
+                // every point of the row
+                type_accum hoop = 0;
+                if (radius(ispec, iz, ix) > 0.0)
+                  hoop += s_wxgll(ix) * s_wzgll(iz) * s_hoop(iz, ix);
+                if (on_the_axis)
+                  hoop += s_wxgll(0) * s_wzgll(iz) * s_hoop(iz, 0) *
+                          s_hprime_xx(0, ix);
+
+                const int iglob = ibool(ispec, iz, ix);
+                const type_real sum_terms1 = -1.0 * (s_wzgll(iz) * tempx1) -
+                                             (s_wxgll(ix) * tempx3) - hoop;
+                const type_real sum_terms3 =
+                    -1.0 * (s_wzgll(iz) * tempz1) - (s_wxgll(ix) * tempz3);
+                Kokkos::single(Kokkos::PerThread(team_member), [=] {
+                  if (use_atomics) {
+                    Kokkos::atomic_add(&field_dot_dot(iglob, icomponent),
+                                       sum_terms1);
+                    Kokkos::atomic_add(&field_dot_dot(iglob, icomponent + 1),
+                                       sum_terms3);
+                  } else {
+                    field_dot_dot(iglob, icomponent) += sum_terms1;
+                    field_dot_dot(iglob, icomponent + 1) += sum_terms3;
+                  }
+                });
+              });
+        }
+      },
+      node);
+
+  return;
+}
 
-              const type_real duzdxl =
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::Domain::Elastic::assign_host_elements(const int nelem_host) {
+
+  const auto h_ibool = this->compute->h_ibool;
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  const int nglob = this->field.extent(0);
+  const int ncomponents = this->field.extent(1);
+  const int istart = this->nelem_domain - nelem_host;
+
+  // Device kernels compute the elements before the host elements
+  this->nelem_host = nelem_host;
+  this->h_color_offsets = { 0, this->nelem_outer, istart };
+
+  // Points of host elements in the order they are first seen
+  std::vector<int> local(nglob, -1);
+  std::vector<int> points;
+  this->host_ibool = specfem::kokkos::HostView3d<int>(
+      "specfem::Domain::Elastic::host_ibool", nelem_host, ngllz, ngllx);
+  this->host_element_data = specfem::kokkos::HostView4d<type_real>(
+      "specfem::Domain::Elastic::host_element_data", nelem_host,
+      specfem::Domain::packed::nfields, ngllz, ngllx);
+
+  const auto pd = this->partial_derivatives;
+  const auto properties = this->material_properties;
+  for (int ielement = 0; ielement < nelem_host; ielement++) {
+    const int ispec = this->h_ispec_domain(istart + ielement);
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int iglob = h_ibool(ispec, iz, ix);
+        if (local[iglob] < 0) {
+          local[iglob] = points.size();
+          points.push_back(iglob);
+        }
+        this->host_ibool(ielement, iz, ix) = local[iglob];
+
+        const auto data = Kokkos::subview(this->host_element_data, ielement,
+                                          Kokkos::ALL, iz, ix);
+        data(specfem::Domain::packed::xix) = pd->h_xix(ispec, iz, ix);
+        data(specfem::Domain::packed::xiz) = pd->h_xiz(ispec, iz, ix);
+        data(specfem::Domain::packed::gammax) = pd->h_gammax(ispec, iz, ix);
+        data(specfem::Domain::packed::gammaz) = pd->h_gammaz(ispec, iz, ix);
+        data(specfem::Domain::packed::jacobian) =
+            pd->h_jacobian(ispec, iz, ix);
+        data(specfem::Domain::packed::mu) = properties->h_mu(ispec, iz, ix);
+        data(specfem::Domain::packed::lambdaplus2mu) =
+            properties->h_lambdaplus2mu(ispec, iz, ix);
+      }
+    }
+  }
+
+  const int npoints = points.size();
+  this->host_points = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::host_points", npoints);
+  auto h_host_points = Kokkos::create_mirror_view(this->host_points);
+  for (int ipoint = 0; ipoint < npoints; ipoint++)
+    h_host_points(ipoint) = points[ipoint];
+  Kokkos::deep_copy(this->host_points, h_host_points);
+
+  this->host_field = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::Domain::Elastic::host_field", npoints, ncomponents);
+  this->h_host_field = Kokkos::create_mirror_view(this->host_field);
+  this->host_field_dot_dot = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::Domain::Elastic::host_field_dot_dot", npoints, ncomponents);
+  this->h_host_field_dot_dot =
+      Kokkos::create_mirror_view(this->host_field_dot_dot);
+
+  return;
+}
+
+KOKKOS_IMPL_HOST_FUNCTION
+type_real specfem::Domain::Elastic::calibrate_host_fraction() {
+
+  constexpr int nlaunch = 3;
+  const int nelem_inner = this->nelem_domain - this->nelem_outer;
+  if (nelem_inner == 0)
+    return 0.0;
+
+  // Fields are at rest, hence timed launches don't change the acceleration
+  const specfem::kokkos::DevExecSpace exec_space;
+  this->launch_stiffness_interaction(exec_space, nullptr);
+  exec_space.fence();
+  Kokkos::Timer timer;
+  for (int ilaunch = 0; ilaunch < nlaunch; ilaunch++)
+    this->launch_stiffness_interaction(exec_space, nullptr);
+  exec_space.fence();
+  const double device_time =
+      timer.seconds() / (nlaunch * static_cast<double>(this->nelem_domain));
+
+  const int nsample =
+      std::min(nelem_inner, std::max(64, this->nelem_domain / 10));
+  this->assign_host_elements(nsample);
+  this->compute_host_stiffness_interaction();
+  timer.reset();
+  for (int ilaunch = 0; ilaunch < nlaunch; ilaunch++)
+    this->compute_host_stiffness_interaction();
+  const double host_time =
+      timer.seconds() / (nlaunch * static_cast<double>(nsample));
+  this->assign_host_elements(0);
+
+  // Host and device finish together when
+  // nelem_host * host_time = (nelem_domain - nelem_host) * device_time
+  return device_time / (device_time + host_time);
+}
+
+void specfem::Domain::Elastic::start_host_stiffness_interaction(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const int npoints = this->host_points.extent(0);
+  const int ncomponents = this->field.extent(1);
+  const auto host_points = this->host_points;
+  const auto host_field = this->host_field;
+  const auto field = this->field;
+
+  Kokkos::parallel_for(
+      "specfem::Domain::Elastic::pack_host_field",
+      specfem::kokkos::DeviceMDrange<2>(exec_space, { 0, 0 },
+                                        { npoints, ncomponents }),
+      KOKKOS_LAMBDA(const int ipoint, const int icomp) {
+        host_field(ipoint, icomp) = field(host_points(ipoint), icomp);
+      });
+
+  Kokkos::deep_copy(exec_space, this->h_host_field, host_field);
+  exec_space.fence();
+
+  return;
+}
+
+void specfem::Domain::Elastic::finish_host_stiffness_interaction(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  this->compute_host_stiffness_interaction();
+
+  const int npoints = this->host_points.extent(0);
+  const int ncomponents = this->field.extent(1);
+  const auto host_points = this->host_points;
+  const auto host_field_dot_dot = this->host_field_dot_dot;
+  const auto field_dot_dot = this->field_dot_dot;
+
+  Kokkos::deep_copy(exec_space, host_field_dot_dot,
+                    this->h_host_field_dot_dot);
+
+  // Sources may be assembled concurrently on another execution space
+  Kokkos::parallel_for(
+      "specfem::Domain::Elastic::add_host_field_dot_dot",
+      specfem::kokkos::DeviceMDrange<2>(exec_space, { 0, 0 },
+                                        { npoints, ncomponents }),
+      KOKKOS_LAMBDA(const int ipoint, const int icomp) {
+        Kokkos::atomic_add(&field_dot_dot(host_points(ipoint), icomp),
+                           host_field_dot_dot(ipoint, icomp));
+      });
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_host_stiffness_interaction() {
+
+  const int ngllx = this->quadx->get_N();
+  const int ngllz = this->quadz->get_N();
+  const int nelem_host = this->nelem_host;
+  const auto host_ibool = this->host_ibool;
+  const auto host_element_data = this->host_element_data;
+  const auto wxgll = this->quadx->get_hw();
+  const auto wzgll = this->quadz->get_hw();
+  const auto hprime_xx = this->quadx->get_hhprime();
+  const auto hprime_zz = this->quadz->get_hhprime();
+  const auto hprimewgll_xx = this->quadx->get_hhprimewgll();
+  const auto hprimewgll_zz = this->quadz->get_hhprimewgll();
+  const auto field = this->h_host_field;
+  const auto field_dot_dot = this->h_host_field_dot_dot;
+  const bool p_sv = (this->wave == specfem::wave::p_sv);
+
+  const specfem::kokkos::HostExecSpace host_space;
+  Kokkos::deep_copy(host_space, field_dot_dot, 0.0);
+
+  const int scratch_size =
+      6 *
+      specfem::kokkos::HostScratchView2d<type_real>::shmem_size(ngllz, ngllx);
+
+  // Teams of a single thread compute one element each
+  Kokkos::parallel_for(
+      "specfem::Domain::Elastic::compute_host_forces",
+      specfem::kokkos::HostTeam(host_space, nelem_host, 1)
+          .set_scratch_size(0, Kokkos::PerTeam(scratch_size)),
+      [=](const specfem::kokkos::HostTeam::member_type &team_member) {
+        const int ielement = team_member.league_rank();
+        const auto data = Kokkos::subview(host_element_data, ielement,
+                                          Kokkos::ALL, Kokkos::ALL,
+                                          Kokkos::ALL);
+
+        specfem::kokkos::HostScratchView2d<type_real> s_fieldx(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::HostScratchView2d<type_real> s_fieldz(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::HostScratchView2d<type_real> s_tempx1(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::HostScratchView2d<type_real> s_tempz1(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::HostScratchView2d<type_real> s_tempx3(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::HostScratchView2d<type_real> s_tempz3(
+            team_member.team_scratch(0), ngllz, ngllx);
+
+        for (int iz = 0; iz < ngllz; iz++) {
+          for (int ix = 0; ix < ngllx; ix++) {
+            const int ipoint = host_ibool(ielement, iz, ix);
+            s_fieldx(iz, ix) = field(ipoint, 0);
+            s_fieldz(iz, ix) = p_sv ? field(ipoint, 1) : 0.0;
+          }
+        }
+
+        // Same stress computation as the device kernels
+        for (int iz = 0; iz < ngllz; iz++) {
+          for (int ix = 0; ix < ngllx; ix++) {
+            type_accum sum_hprime_x1 = 0;
+            type_accum sum_hprime_x3 = 0;
+            type_accum sum_hprime_z1 = 0;
+            type_accum sum_hprime_z3 = 0;
+
+            for (int l = 0; l < ngllx; l++) {
+              sum_hprime_x1 += hprime_xx(ix, l) * s_fieldx(iz, l);
+              sum_hprime_x3 += hprime_xx(ix, l) * s_fieldz(iz, l);
+            }
+
+            for (int l = 0; l < ngllz; l++) {
+              sum_hprime_z1 += hprime_zz(iz, l) * s_fieldx(l, ix);
+              sum_hprime_z3 += hprime_zz(iz, l) * s_fieldz(l, ix);
+            }
+
+            const type_real xixl = data(specfem::Domain::packed::xix, iz, ix);
+            const type_real xizl = data(specfem::Domain::packed::xiz, iz, ix);
+            const type_real gammaxl =
+                data(specfem::Domain::packed::gammax, iz, ix);
+            const type_real gammazl =
+                data(specfem::Domain::packed::gammaz, iz, ix);
+            const type_real jacobianl =
+                data(specfem::Domain::packed::jacobian, iz, ix);
+            const type_real mul = data(specfem::Domain::packed::mu, iz, ix);
+
+            type_accum sigma_xx = 0;
+            type_accum sigma_zz = 0;
+            type_accum sigma_xz = 0;
+
+            if (p_sv) {
+              const type_accum duxdxl =
+                  xixl * sum_hprime_x1 + gammaxl * sum_hprime_x3;
+              const type_accum duxdzl =
+                  xizl * sum_hprime_x1 + gammazl * sum_hprime_x3;
+
+              const type_accum duzdxl =
                   xixl * sum_hprime_z1 + gammaxl * sum_hprime_z3;
-              const type_real duzdzl =
+              const type_accum duzdzl =
                   xizl * sum_hprime_z1 + gammazl * sum_hprime_z3;
 
-              const type_real duzdxl_plus_duxdzl = duzdxl + duxdzl;
-
-              const type_real mul = sv_mu(iz, ix);
-              const type_real lambdaplus2mul = sv_lambdaplus2mu(iz, ix);
-              const type_real lambdal = lambdaplus2mul - 2.0 * mul;
-
-              if (specfem::globals::simulation_wave == specfem::wave::p_sv) {
-                // P_SV case
-                s_sigma_xx(iz, ix) = lambdaplus2mul * duxdxl + lambdal * duzdzl;
-                s_sigma_zz(iz, ix) = lambdaplus2mul * duzdzl + lambdal * duxdxl;
-                s_sigma_xz(iz, ix) = mul * duzdxl_plus_duxdzl;
-              } else if (specfem::globals::simulation_wave ==
-                         specfem::wave::sh) {
-                // SH-case
-                s_sigma_xx(iz, ix) =
-                    mul * duxdxl; // would be sigma_xy in CPU-version
-                s_sigma_xz(iz, ix) = mul * duxdzl; // sigma_zy
-              }
-            });
+              const type_real lambdaplus2mul =
+                  data(specfem::Domain::packed::lambdaplus2mu, iz, ix);
+              const type_accum lambdal = lambdaplus2mul - 2.0 * mul;
 
-        team_member.team_barrier();
+              sigma_xx = lambdaplus2mul * duxdxl + lambdal * duzdzl;
+              sigma_zz = lambdaplus2mul * duzdzl + lambdal * duxdxl;
+              sigma_xz = mul * (duzdxl + duxdzl);
+            } else {
+              const type_accum duydxl =
+                  xixl * sum_hprime_x1 + gammaxl * sum_hprime_z1;
+              const type_accum duydzl =
+                  xizl * sum_hprime_x1 + gammazl * sum_hprime_z1;
+              sigma_xx = mul * duydxl; // sigma_xy
+              sigma_xz = mul * duydzl; // sigma_zy
+            }
 
-        Kokkos::parallel_for(
-            Kokkos::TeamThreadRange(team_member, ngllxz), [&](const int xz) {
-              const int ix = xz % ngllz;
-              const int iz = xz / ngllz;
-              const type_real xixl = sv_xix(iz, ix);
-              const type_real xizl = sv_xiz(iz, ix);
-              const type_real jacobianl = sv_jacobian(iz, ix);
-              s_tempx(iz, ix) = jacobianl * (s_sigma_xx(iz, ix) * xixl +
-                                             s_sigma_xz(iz, ix) * xizl);
-              s_tempz(iz, ix) = jacobianl * (s_sigma_xz(iz, ix) * xixl +
-                                             s_sigma_zz(iz, ix) * xizl);
-            });
+            s_tempx1(iz, ix) = jacobianl * (sigma_xx * xixl + sigma_xz * xizl);
+            s_tempz1(iz, ix) = jacobianl * (sigma_xz * xixl + sigma_zz * xizl);
+            s_tempx3(iz, ix) =
+                jacobianl * (sigma_xx * gammaxl + sigma_xz * gammazl);
+            s_tempz3(iz, ix) =
+                jacobianl * (sigma_xz * gammaxl + sigma_zz * gammazl);
+          }
+        }
 
-        team_member.team_barrier();
+        // Points shared by host elements are updated by several teams
+        for (int iz = 0; iz < ngllz; iz++) {
+          for (int ix = 0; ix < ngllx; ix++) {
+            type_accum tempx1 = 0;
+            type_accum tempz1 = 0;
+            type_accum tempx3 = 0;
+            type_accum tempz3 = 0;
 
-        Kokkos::parallel_for(
-            Kokkos::TeamThreadRange(team_member, ngllxz), [&](const int xz) {
-              const int ix = xz % ngllz;
-              const int iz = xz / ngllz;
-
-              s_tempx1(iz, ix) = 0;
-              s_tempz1(iz, ix) = 0;
-              for (int l = 0; l < ngllx; l++) {
-                s_tempx1(iz, ix) +=
-                    s_wxgll(l) * s_hprime_xx(l, ix) * s_tempx(iz, l);
-                s_tempz1(iz, ix) +=
-                    s_wxgll(l) * s_hprime_xx(l, ix) * s_tempz(iz, l);
-              }
-            });
+            for (int l = 0; l < ngllx; l++) {
+              tempx1 += hprimewgll_xx(ix, l) * s_tempx1(iz, l);
+              tempz1 += hprimewgll_xx(ix, l) * s_tempz1(iz, l);
+            }
 
-        team_member.team_barrier();
+            for (int l = 0; l < ngllz; l++) {
+              tempx3 += hprimewgll_zz(iz, l) * s_tempx3(l, ix);
+              tempz3 += hprimewgll_zz(iz, l) * s_tempz3(l, ix);
+            }
 
-        Kokkos::parallel_for(
-            Kokkos::TeamThreadRange(team_member, ngllxz), [&](const int xz) {
-              const int ix = xz % ngllz;
-              const int iz = xz / ngllz;
-              const type_real gammaxl = sv_gammax(iz, ix);
-              const type_real gammazl = sv_gammaz(iz, ix);
-              const type_real jacobianl = sv_jacobian(iz, ix);
-              s_tempx(iz, ix) = jacobianl * (s_sigma_xx(iz, ix) * gammaxl +
-                                             s_sigma_xz(iz, ix) * gammazl);
-              s_tempz(iz, ix) = jacobianl * (s_sigma_xz(iz, ix) * gammaxl +
-                                             s_sigma_zz(iz, ix) * gammazl);
-            });
+            const int ipoint = host_ibool(ielement, iz, ix);
+            const type_real sum_terms1 =
+                -1.0 * (wzgll(iz) * tempx1) - (wxgll(ix) * tempx3);
+            const type_real sum_terms3 =
+                -1.0 * (wzgll(iz) * tempz1) - (wxgll(ix) * tempz3);
+            Kokkos::atomic_add(&field_dot_dot(ipoint, 0), sum_terms1);
+            if (p_sv)
+              Kokkos::atomic_add(&field_dot_dot(ipoint, 1), sum_terms3);
+          }
+        }
+      });
 
-        team_member.team_barrier();
+  // Device kernels keep running
+  host_space.fence();
 
-        Kokkos::parallel_for(
-            Kokkos::TeamThreadRange(team_member, ngllxz), [&](const int xz) {
-              const int ix = xz % ngllz;
-              const int iz = xz / ngllz;
-
-              s_tempx3(iz, ix) = 0;
-              s_tempz3(iz, ix) = 0;
-              for (int l = 0; l < ngllz; l++) {
-                s_tempx3(iz, ix) +=
-                    s_wzgll(l) * s_hprime_zz(l, iz) * s_tempx(l, ix);
-                s_tempz3(iz, ix) +=
-                    s_wzgll(l) * s_hprime_zz(l, iz) * s_tempz(l, ix);
-              }
-            });
+  return;
+}
 
-        team_member.team_barrier();
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::Domain::Elastic::assemble_stiffness_matrix() {
 
-        // assembles acceleration array
-        Kokkos::parallel_for(
-            Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
-              const int ix = xz % ngllz;
-              const int iz = xz / ngllz;
-              const int iglob = sv_ibool(iz, ix);
-              const type_real sum_terms1 =
-                  -1.0 * (s_wzgll(iz) * s_tempx1(iz, ix)) -
-                  (s_wxgll(ix) * s_tempx3(iz, ix));
-              const type_real sum_terms3 =
-                  -1.0 * (s_wzgll(iz) * s_tempz1(iz, ix)) -
-                  (s_wxgll(ix) * s_tempz3(iz, ix));
-              Kokkos::single(Kokkos::PerThread(team_member), [=] {
-                Kokkos::atomic_add(&this->field_dot_dot(iglob, 0), sum_terms1);
-                Kokkos::atomic_add(&this->field_dot_dot(iglob, 1), sum_terms3);
-              });
-            });
-      });
+  const auto h_ibool = this->compute->h_ibool;
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  const int ngllxz = ngllx * ngllz;
+  const int nglob = this->field.extent(0);
+  const bool p_sv = (this->wave == specfem::wave::p_sv);
+  const int ncomponents = p_sv ? 2 : 1;
+  const int nrows = nglob * ncomponents;
+  const auto wxgll = this->quadx->get_hw();
+  const auto wzgll = this->quadz->get_hw();
+  const auto hprime_xx = this->quadx->get_hhprime();
+  const auto hprime_zz = this->quadz->get_hhprime();
+  const auto hprimewgll_xx = this->quadx->get_hhprimewgll();
+  const auto hprimewgll_zz = this->quadz->get_hhprimewgll();
+  const auto pd = this->partial_derivatives;
+  const auto properties = this->material_properties;
 
-  Kokkos::fence();
+  // Elements of structured blocks are assembled as well
+  std::vector<int> elements(this->h_ispec_domain.data(),
+                            this->h_ispec_domain.data() + this->nelem_domain);
+  for (int ielement = 0; ielement < this->nelem_structured; ielement++)
+    elements.push_back(this->h_structured_ispec(ielement));
+
+  // Global points coupled to every global point through an element
+  std::vector<std::vector<int> > coupled(nglob);
+  for (const int ispec : elements) {
+    for (int ixz = 0; ixz < ngllxz; ixz++) {
+      auto &points = coupled[h_ibool(ispec, ixz / ngllx, ixz % ngllx)];
+      for (int jxz = 0; jxz < ngllxz; jxz++)
+        points.push_back(h_ibool(ispec, jxz / ngllx, jxz % ngllx));
+    }
+  }
+
+  this->matrix_offsets = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::matrix_offsets", nrows + 1);
+  auto h_offsets = Kokkos::create_mirror_view(this->matrix_offsets);
+  std::vector<int> columns;
+  h_offsets(0) = 0;
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    auto &points = coupled[iglob];
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    for (int icomp = 0; icomp < ncomponents; icomp++) {
+      const int irow = iglob * ncomponents + icomp;
+      for (const int jglob : points)
+        for (int jcomp = 0; jcomp < ncomponents; jcomp++)
+          columns.push_back(jglob * ncomponents + jcomp);
+      h_offsets(irow + 1) = columns.size();
+    }
+  }
+  std::vector<double> values(columns.size(), 0.0);
+
+  // Element field and the intermediate arrays of the element operator,
+  // indexed by component * ngllxz + iz * ngllx + ix
+  std::vector<type_real> u(ncomponents * ngllxz);
+  std::vector<type_real> temp1(ncomponents * ngllxz);
+  std::vector<type_real> temp3(ncomponents * ngllxz);
+
+  for (const int ispec : elements) {
+    for (int jdof = 0; jdof < ncomponents * ngllxz; jdof++) {
+      std::fill(u.begin(), u.end(), 0.0);
+      u[jdof] = 1.0;
+      const type_real *fieldx = u.data();
+      const type_real *fieldz = u.data() + (p_sv ? ngllxz : 0);
+
+      // Same stress computation as the stiffness kernels
+      for (int iz = 0; iz < ngllz; iz++) {
+        for (int ix = 0; ix < ngllx; ix++) {
+          type_accum sum_hprime_x1 = 0;
+          type_accum sum_hprime_x3 = 0;
+          type_accum sum_hprime_z1 = 0;
+          type_accum sum_hprime_z3 = 0;
+
+          for (int l = 0; l < ngllx; l++) {
+            sum_hprime_x1 += hprime_xx(ix, l) * fieldx[iz * ngllx + l];
+            sum_hprime_x3 += hprime_xx(ix, l) * fieldz[iz * ngllx + l];
+          }
+
+          for (int l = 0; l < ngllz; l++) {
+            sum_hprime_z1 += hprime_zz(iz, l) * fieldx[l * ngllx + ix];
+            sum_hprime_z3 += hprime_zz(iz, l) * fieldz[l * ngllx + ix];
+          }
+
+          const type_real xixl = pd->h_xix(ispec, iz, ix);
+          const type_real xizl = pd->h_xiz(ispec, iz, ix);
+          const type_real gammaxl = pd->h_gammax(ispec, iz, ix);
+          const type_real gammazl = pd->h_gammaz(ispec, iz, ix);
+          const type_real jacobianl = pd->h_jacobian(ispec, iz, ix);
+          const type_real mul = properties->h_mu(ispec, iz, ix);
+          const int ixz = iz * ngllx + ix;
+
+          if (p_sv) {
+            const type_accum duxdxl =
+                xixl * sum_hprime_x1 + gammaxl * sum_hprime_x3;
+            const type_accum duxdzl =
+                xizl * sum_hprime_x1 + gammazl * sum_hprime_x3;
+
+            const type_accum duzdxl =
+                xixl * sum_hprime_z1 + gammaxl * sum_hprime_z3;
+            const type_accum duzdzl =
+                xizl * sum_hprime_z1 + gammazl * sum_hprime_z3;
+
+            const type_real lambdaplus2mul =
+                properties->h_lambdaplus2mu(ispec, iz, ix);
+            const type_accum lambdal = lambdaplus2mul - 2.0 * mul;
+
+            const type_accum sigma_xx =
+                lambdaplus2mul * duxdxl + lambdal * duzdzl;
+            const type_accum sigma_zz =
+                lambdaplus2mul * duzdzl + lambdal * duxdxl;
+            const type_accum sigma_xz = mul * (duzdxl + duxdzl);
+
+            temp1[ixz] = jacobianl * (sigma_xx * xixl + sigma_xz * xizl);
+            temp1[ngllxz + ixz] =
+                jacobianl * (sigma_xz * xixl + sigma_zz * xizl);
+            temp3[ixz] = jacobianl * (sigma_xx * gammaxl + sigma_xz * gammazl);
+            temp3[ngllxz + ixz] =
+                jacobianl * (sigma_xz * gammaxl + sigma_zz * gammazl);
+          } else {
+            const type_accum duydxl =
+                xixl * sum_hprime_x1 + gammaxl * sum_hprime_z1;
+            const type_accum duydzl =
+                xizl * sum_hprime_x1 + gammazl * sum_hprime_z1;
+            const type_accum sigma_xy = mul * duydxl;
+            const type_accum sigma_zy = mul * duydzl;
+
+            temp1[ixz] = jacobianl * (sigma_xy * xixl + sigma_zy * xizl);
+            temp3[ixz] = jacobianl * (sigma_xy * gammaxl + sigma_zy * gammazl);
+          }
+        }
+      }
+
+      // Response of every component of every point is an entry of the
+      // column of the unit field
+      const int jglob = h_ibool(ispec, (jdof % ngllxz) / ngllx, jdof % ngllx);
+      const int icolumn = jglob * ncomponents + jdof / ngllxz;
+      for (int icomp = 0; icomp < ncomponents; icomp++) {
+        for (int iz = 0; iz < ngllz; iz++) {
+          for (int ix = 0; ix < ngllx; ix++) {
+            const int offset = icomp * ngllxz;
+            type_accum tempx1 = 0;
+            type_accum tempx3 = 0;
+
+            for (int l = 0; l < ngllx; l++)
+              tempx1 += hprimewgll_xx(ix, l) * temp1[offset + iz * ngllx + l];
+
+            for (int l = 0; l < ngllz; l++)
+              tempx3 += hprimewgll_zz(iz, l) * temp3[offset + l * ngllx + ix];
+
+            const type_real sum_terms =
+                -1.0 * (wzgll(iz) * tempx1) - (wxgll(ix) * tempx3);
+            if (sum_terms == 0.0)
+              continue;
+
+            const int irow = h_ibool(ispec, iz, ix) * ncomponents + icomp;
+            const auto first = columns.begin() + h_offsets(irow);
+            const auto last = columns.begin() + h_offsets(irow + 1);
+            values[std::lower_bound(first, last, icolumn) - columns.begin()] +=
+                sum_terms;
+          }
+        }
+      }
+    }
+  }
+
+  const int nnz = columns.size();
+  this->matrix_columns = specfem::kokkos::DeviceView1d<int>(
+      "specfem::Domain::Elastic::matrix_columns", nnz);
+  this->matrix_values = specfem::kokkos::DeviceView1d<type_real>(
+      "specfem::Domain::Elastic::matrix_values", nnz);
+  auto h_columns = Kokkos::create_mirror_view(this->matrix_columns);
+  auto h_values = Kokkos::create_mirror_view(this->matrix_values);
+  for (int inz = 0; inz < nnz; inz++) {
+    h_columns(inz) = columns[inz];
+    h_values(inz) = values[inz];
+  }
+  Kokkos::deep_copy(this->matrix_offsets, h_offsets);
+  Kokkos::deep_copy(this->matrix_columns, h_columns);
+  Kokkos::deep_copy(this->matrix_values, h_values);
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_assembled_stiffness_interaction(
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  const auto offsets = this->matrix_offsets;
+  const auto columns = this->matrix_columns;
+  const auto values = this->matrix_values;
+  const auto field = this->field;
+  const auto field_dot_dot = this->field_dot_dot;
+  const int ncomponents = (this->wave == specfem::wave::p_sv) ? 2 : 1;
+  const int nshots = this->nshots;
+  const int nrows = offsets.extent(0) - 1;
+
+  specfem::kokkos::parallel_for(
+      "specfem::Domain::Elastic::compute_assembled_forces",
+      specfem::kokkos::DeviceRange(exec_space, 0, nrows),
+      KOKKOS_LAMBDA(const int irow) {
+        const int iglob = irow / ncomponents;
+        const int icomp = irow % ncomponents;
+        for (int ishot = 0; ishot < nshots; ishot++) {
+          const int icomponent = ishot * ncomponents;
+          type_accum sum = 0;
+          for (int inz = offsets(irow); inz < offsets(irow + 1); inz++) {
+            const int icolumn = columns(inz);
+            sum += values(inz) * field(icolumn / ncomponents,
+                                       icomponent + icolumn % ncomponents);
+          }
+          field_dot_dot(iglob, icomponent + icomp) += sum;
+        }
+      },
+      node);
 
   return;
 }
 
 KOKKOS_IMPL_HOST_FUNCTION
-void specfem::Domain::Elastic::divide_mass_matrix() {
+void specfem::Domain::Elastic::divide_mass_matrix(
+    const specfem::kokkos::DevExecSpace &exec_space) {
 
-  const int nglob = this->rmass_inverse.extent(0);
+  const auto rmass_inverse = this->rmass_inverse;
+  const auto field_dot_dot = this->field_dot_dot;
+  const int nglob = rmass_inverse.extent(0);
+  const int ncomponents = field_dot_dot.extent(1);
 
   Kokkos::parallel_for(
       "specfem::Domain::Elastic::divide_mass_matrix",
-      specfem::kokkos::DeviceRange(0, nglob),
-      KOKKOS_CLASS_LAMBDA(const int iglob) {
-        this->field_dot_dot(iglob, 0) =
-            this->field_dot_dot(iglob, 0) * this->rmass_inverse(iglob, 0);
-        this->field_dot_dot(iglob, 1) =
-            this->field_dot_dot(iglob, 1) * this->rmass_inverse(iglob, 1);
+      specfem::kokkos::DeviceRange(exec_space, 0, nglob),
+      KOKKOS_LAMBDA(const int iglob) {
+        const type_real rmass_inversel = rmass_inverse(iglob);
+        for (int icomp = 0; icomp < ncomponents; icomp++) {
+          field_dot_dot(iglob, icomp) =
+              field_dot_dot(iglob, icomp) * rmass_inversel;
+        }
       });
 
-  Kokkos::fence();
+  return;
+}
+
+void specfem::Domain::Elastic::compute_source_interaction(
+    const type_real timeval, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  this->launch_source_interaction(
+      timeval, specfem::kokkos::DeviceView1d<type_real>(), exec_space, nullptr);
+
+  // Sources are the last contribution to the acceleration before time
+  // schemes divide it by the mass matrix
+  if (this->is_axisymmetric())
+    this->apply_axis_constraint(exec_space, nullptr);
+
+  return;
+}
+
+void specfem::Domain::Elastic::compute_level_source_interaction(
+    const type_real timeval,
+    const specfem::kokkos::DeviceView1d<int> point_level, const int ilevel,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  // Local time stepping isn't supported with axisymmetric simulations, hence
+  // the axis constraint isn't applied
+  this->launch_source_interaction(
+      timeval, specfem::kokkos::DeviceView1d<type_real>(), exec_space, nullptr,
+      point_level, ilevel);
 
   return;
 }
 
 void specfem::Domain::Elastic::compute_source_interaction(
-    const type_real timeval) {
+    const specfem::kokkos::DeviceView1d<type_real> timeval,
+    specfem::kokkos::DeviceGraphNode &node) {
+
+  this->launch_source_interaction(0.0, timeval, specfem::kokkos::DevExecSpace(),
+                                  &node);
+
+  if (this->is_axisymmetric())
+    this->apply_axis_constraint(specfem::kokkos::DevExecSpace(), &node);
+
+  return;
+}
+
+void specfem::Domain::Elastic::apply_axis_constraint(
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  const auto axis_points = this->axis_points;
+  const auto field_dot_dot = this->field_dot_dot;
+  const int nshots = this->nshots;
+
+  // Radial displacement vanishes on the axis
+  specfem::kokkos::parallel_for(
+      "specfem::Domain::Elastic::apply_axis_constraint",
+      specfem::kokkos::DeviceRange(exec_space, 0, axis_points.extent(0)),
+      KOKKOS_LAMBDA(const int ipoint) {
+        const int iglob = axis_points(ipoint);
+        for (int ishot = 0; ishot < nshots; ishot++)
+          field_dot_dot(iglob, 2 * ishot) = 0.0;
+      },
+      node);
+
+  return;
+}
 
-  const int nsources = this->sources->source_array.extent(0);
-  const int ngllz = this->sources->source_array.extent(1);
-  const int ngllx = this->sources->source_array.extent(2);
+void specfem::Domain::Elastic::launch_source_interaction(
+    const type_real timeval,
+    const specfem::kokkos::DeviceView1d<type_real> device_timeval,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node,
+    const specfem::kokkos::DeviceView1d<int> point_level, const int ilevel) {
+
+  const int ngllx = this->sources->hxis.extent(1);
+  const int ngllz = this->sources->hgammas.extent(1);
   const int ngllxz = ngllx * ngllz;
   const auto ispec_array = this->sources->ispec_array;
-  const auto ispec_type = this->material_properties->ispec_type;
   const auto stf_array = this->sources->stf_array;
   const auto source_array = this->sources->source_array;
+  const auto dense_index = this->sources->dense_index;
+  const auto hxis = this->sources->hxis;
+  const auto hgammas = this->sources->hgammas;
+  const auto components = this->sources->components;
+  const auto shot_array = this->sources->shot_array;
   const auto ibool = this->compute->ibool;
+  const auto source_order = this->source_order;
+  const auto source_group_offsets = this->source_group_offsets;
+  const bool use_atomics = (this->assembly == specfem::assembly::atomic);
+  const auto wave = this->wave;
+  const auto field_dot_dot = this->field_dot_dot;
+  // Recorded kernels are replayed, hence time is read on the device
+  const bool use_device_time = (node != nullptr);
+  // Sources only update the points of a local time stepping level
+  const bool use_levels = (point_level.extent(0) > 0);
 
-  Kokkos::parallel_for(
-      "specfem::Domain::Elastic::compute_source_interaction",
-      specfem::kokkos::DeviceTeam(nsources, Kokkos::AUTO, 1),
-      KOKKOS_CLASS_LAMBDA(
-          const specfem::kokkos::DeviceTeam::member_type &team_member) {
-        int isource = team_member.league_rank();
-        int ispec = ispec_array(isource);
-        auto sv_ibool = Kokkos::subview(ibool, ispec, Kokkos::ALL, Kokkos::ALL);
+  // Tabulated source time functions are gathered from the table instead of
+  // being evaluated every step
+  const bool use_stf_table = this->sources->stf_tabulated();
+  if (use_stf_table) {
+    if (use_device_time && !this->sources->stf_table_resident()) {
+      throw std::runtime_error(
+          "Graph execution requires the source time function table to fit "
+          "on the device");
+    }
+    if (!use_device_time)
+      this->sources->update_stf_table(timeval);
+  }
+  const auto stf_table = this->sources->stf_table;
+  const type_real stf_table_t0 = this->sources->stf_table_t0;
+  const type_real stf_table_dt = this->sources->stf_table_dt;
+  const int stf_table_nsamples = this->sources->stf_table_nsamples;
+  const int stf_table_start = this->sources->stf_table_start;
 
-        if (ispec_type(ispec) == specfem::elements::elastic) {
+  const int ncomponents = (wave == specfem::wave::p_sv) ? 2 : 1;
+  const int scratch_size =
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(
+          ngllxz, ncomponents) +
+      specfem::kokkos::DeviceScratchView1d<type_real>::shmem_size(
+          source_chunk);
 
-          type_real stf;
+  // One team per group of sources inside the same element and shot. Groups
+  // only contain sources of elastic elements
+  const int ncolors = this->h_source_color_offsets.size() - 1;
+  for (int icolor = 0; icolor < ncolors; icolor++) {
+    const int istart = this->h_source_color_offsets[icolor];
+    const int iend = this->h_source_color_offsets[icolor + 1];
+    const auto configuration =
+        this->source_tuner.get_config(scratch_size, node == nullptr);
+    const int scratch_level = configuration.scratch_level;
+    specfem::autotune::parallel_for(
+        "specfem::Domain::Elastic::compute_source_interaction",
+        this->source_tuner, configuration, exec_space, iend - istart, 0,
+        scratch_size,
+        KOKKOS_LAMBDA(
+            const specfem::kokkos::DeviceTeam::member_type &team_member) {
+          const int igroup = istart + team_member.league_rank();
+          const int ifirst = source_group_offsets(igroup);
+          const int ilast = source_group_offsets(igroup + 1);
+          const int ispec = ispec_array(source_order(ifirst));
+          auto sv_ibool =
+              Kokkos::subview(ibool, ispec, Kokkos::ALL, Kokkos::ALL);
 
-          Kokkos::parallel_reduce(
-              Kokkos::TeamThreadRange(team_member, 1),
-              [=](const int &, type_real &lsum) {
-                lsum = stf_array(isource).T->compute(timeval);
-              },
-              stf);
+          // Sources add to the components of their shot
+          const int icomponent =
+              ncomponents * shot_array(source_order(ifirst));
+          const type_real t = use_device_time ? device_timeval(0) : timeval;
 
-          team_member.team_barrier();
+          specfem::kokkos::DeviceScratchView2d<type_real> s_accel(
+              team_member.team_scratch(scratch_level), ngllxz, ncomponents);
+          specfem::kokkos::DeviceScratchView1d<type_real> s_stf(
+              team_member.team_scratch(scratch_level), source_chunk);
 
           Kokkos::parallel_for(
               Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
-                const int ix = xz % ngllz;
-                const int iz = xz / ngllz;
-                int iglob = sv_ibool(iz, ix);
-
-                if (specfem::globals::simulation_wave == specfem::wave::p_sv) {
-                  const type_real accelx =
-                      source_array(isource, iz, ix, 0) * stf;
-                  const type_real accelz =
-                      source_array(isource, iz, ix, 1) * stf;
+                for (int icomp = 0; icomp < ncomponents; icomp++)
+                  s_accel(xz, icomp) = 0.0;
+              });
+
+          for (int ichunk = ifirst; ichunk < ilast; ichunk += source_chunk) {
+            const int nchunk = (ilast - ichunk < source_chunk)
+                                   ? ilast - ichunk
+                                   : source_chunk;
+
+            team_member.team_barrier();
+
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange(team_member, nchunk),
+                [=](const int i) {
+                  const int isource = source_order(ichunk + i);
+                  if (use_stf_table) {
+                    type_real weight;
+                    const int isample =
+                        specfem::compute::stf_table_sample(
+                            t, stf_table_t0, stf_table_dt, stf_table_nsamples,
+                            weight) -
+                        stf_table_start;
+                    s_stf(i) = (1.0 - weight) * stf_table(isample, isource) +
+                               weight * stf_table(isample + 1, isource);
+                  } else {
+                    s_stf(i) = stf_array(isource).T->compute(t);
+                  }
+                });
+
+            team_member.team_barrier();
+
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange(team_member, ngllxz),
+                [=](const int xz) {
+                  const int ix = xz % ngllx;
+                  const int iz = xz / ngllx;
+                  type_real accel[2] = { 0.0, 0.0 };
+
+                  for (int i = 0; i < nchunk; i++) {
+                    const int isource = source_order(ichunk + i);
+                    // Separable sources are interpolated on the fly
+                    const int idense = dense_index(isource);
+                    const type_real hlagrange =
+                        hxis(isource, ix) * hgammas(isource, iz);
+                    for (int icomp = 0; icomp < ncomponents; icomp++) {
+                      const type_real weight =
+                          (idense < 0) ? components(isource, icomp) * hlagrange
+                                       : source_array(idense, iz, ix, icomp);
+                      accel[icomp] += weight * s_stf(i);
+                    }
+                  }
+
                   Kokkos::single(Kokkos::PerThread(team_member), [=] {
-                    Kokkos::atomic_add(&this->field_dot_dot(iglob, 0), accelx);
-                    Kokkos::atomic_add(&this->field_dot_dot(iglob, 1), accelz);
+                    for (int icomp = 0; icomp < ncomponents; icomp++)
+                      s_accel(xz, icomp) += accel[icomp];
                   });
-                } else if (specfem::globals::simulation_wave ==
-                           specfem::wave::sh) {
-                  const type_real accelx =
-                      source_array(isource, iz, ix, 0) * stf;
-                  Kokkos::atomic_add(&this->field_dot_dot(iglob, 0), accelx);
-                }
+                });
+          }
+
+          team_member.team_barrier();
+
+          // A single scatter of the contributions of the group
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+                const int iglob = sv_ibool(xz / ngllx, xz % ngllx);
+                if (use_levels && point_level(iglob) != ilevel)
+                  return;
+                Kokkos::single(Kokkos::PerThread(team_member), [=] {
+                  for (int icomp = 0; icomp < ncomponents; icomp++) {
+                    if (use_atomics) {
+                      Kokkos::atomic_add(
+                          &field_dot_dot(iglob, icomponent + icomp),
+                          s_accel(xz, icomp));
+                    } else {
+                      field_dot_dot(iglob, icomponent + icomp) +=
+                          s_accel(xz, icomp);
+                    }
+                  }
+                });
               });
-        }
-      });
+        },
+        node);
+  }
 
-  Kokkos::fence();
   return;
 }
 
-// Copy the values of relevant field at the spectral element where receiver lies
-// to a storage view (field)
-// KOKKOS_FUNCTION
-// void get_receiver_field_for_seismogram(
-//     const specfem::kokkos::DeviceTeam::member_type &team_member,
-//     specfem::kokkos::DeviceView3d<type_real> field,
-//     const specfem::kokkos::DeviceView2d<int> sv_ibool,
-//     specfem::kokkos::DeviceView2d<type_real> copy_field) {
-
-//   const int ngllx = sv_ibool.extent(0);
-//   const int ngllz = sv_ibool.extent(1);
-//   const int ngllxz = ngllx * ngllz;
-
-//   Kokkos::parallel_for(
-//       Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
-//         const int ix = xz % ngllz;
-//         const int iz = xz / ngllz;
-//         const int iglob = sv_ibool(iz, ix);
-
-//         if (specfem::globals::simulation_wave == specfem::wave::p_sv) {
-//           field(0, iz, ix) = copy_field(iglob, 0);
-//           field(1, iz, ix) = copy_field(iglob, 0);
-//         } else if (specfem::globals::simulation_wave == specfem::wave::sh) {
-//           field(0, iz, ix) = copy_field(iglob, 0);
-//         }
-//       });
-
-//   return;
-// }
-
-// Compute the seismogram using field view calculated using above function
-KOKKOS_FUNCTION
-void compute_receiver_seismogram(
-    const specfem::kokkos::DeviceTeam::member_type &team_member,
-    specfem::kokkos::DeviceView1d<type_real> sv_seismogram,
-    const specfem::kokkos::DeviceView3d<type_real> field,
-    const specfem::seismogram::type type,
-    const specfem::kokkos::DeviceView3d<type_real> sv_receiver_array,
-    const type_real cos_irec, const type_real sin_irec) {
-
-  const int ngllx = sv_receiver_array.extent(0);
-  const int ngllz = sv_receiver_array.extent(1);
-  const int ngllxz = ngllx * ngllz;
-  switch (type) {
-  case specfem::seismogram::displacement:
-  case specfem::seismogram::velocity:
-  case specfem::seismogram::acceleration:
-
-    type_real vx = 0.0;
-    type_real vz = 0.0;
-
-    if (specfem::globals::simulation_wave == specfem::wave::p_sv) {
-      Kokkos::parallel_reduce(
-          Kokkos::TeamThreadRange(team_member, ngllxz),
-          [=](const int xz, type_real &l_vx) {
-            const int ix = xz % ngllz;
-            const int iz = xz / ngllz;
-            const type_real hlagrange = sv_receiver_array(iz, ix, 0);
-            const type_real field_v = field(0, iz, ix);
-
-            l_vx += field_v * hlagrange;
-          },
-          vx);
-      Kokkos::parallel_reduce(
-          Kokkos::TeamThreadRange(team_member, ngllxz),
-          [=](const int xz, type_real &l_vz) {
-            const int ix = xz % ngllz;
-            const int iz = xz / ngllz;
-            const type_real hlagrange = sv_receiver_array(iz, ix, 0);
-            const type_real field_v = field(1, iz, ix);
-
-            l_vz += field_v * hlagrange;
-          },
-          vz);
-    } else if (specfem::globals::simulation_wave == specfem::wave::sh) {
-      Kokkos::parallel_reduce(
-          Kokkos::TeamThreadRange(team_member, ngllxz),
-          [=](const int xz, type_real &l_vx) {
-            const int ix = xz % ngllz;
-            const int iz = xz / ngllz;
-            const type_real hlagrange = sv_receiver_array(iz, ix, 0);
-            const type_real field_v = field(0, iz, ix);
-
-            l_vx += field_v * hlagrange;
-          },
-          vx);
-    }
+void specfem::Domain::Elastic::compute_seismogram(
+    const int isig_step, const specfem::kokkos::DevExecSpace &exec_space) {
 
-    Kokkos::single(Kokkos::PerTeam(team_member), [=] {
-      if (specfem::globals::simulation_wave == specfem::wave::p_sv) {
-        sv_seismogram(0) = cos_irec * vx + sin_irec * vz;
-        sv_seismogram(1) = sin_irec * vx + cos_irec * vz;
-      } else if ((specfem::globals::simulation_wave == specfem::wave::sh)) {
-        sv_seismogram(0) = cos_irec * vx + sin_irec * vz;
-        sv_seismogram(1) = 0;
-      }
-    });
+  this->launch_seismogram(isig_step, specfem::kokkos::DeviceView1d<int>(),
+                          exec_space, nullptr);
+}
+
+void specfem::Domain::Elastic::compute_seismogram(
+    const specfem::kokkos::DeviceView1d<int> isig_step,
+    specfem::kokkos::DeviceGraphNode &node) {
+
+  this->launch_seismogram(0, isig_step, specfem::kokkos::DevExecSpace(), &node);
+}
 
+void specfem::Domain::Elastic::launch_seismogram(
+    const int isig_step,
+    const specfem::kokkos::DeviceView1d<int> device_isig_step,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  if (this->receiver_index.extent(0) == 0)
+    return;
+
+  // The kernel is specialized on the fields read by the requested seismogram
+  // types
+  switch (this->receivers->seismogram_fields()) {
+  case 1:
+    this->launch_seismogram_fields<1>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  case 2:
+    this->launch_seismogram_fields<2>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  case 3:
+    this->launch_seismogram_fields<3>(isig_step, device_isig_step, exec_space,
+                                      node);
     break;
-  } // switch(type)
+  case 4:
+    this->launch_seismogram_fields<4>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  case 5:
+    this->launch_seismogram_fields<5>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  case 6:
+    this->launch_seismogram_fields<6>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  case 7:
+    this->launch_seismogram_fields<7>(isig_step, device_isig_step, exec_space,
+                                      node);
+    break;
+  default:
+    break;
+  }
 
   return;
 }
 
-void specfem::Domain::Elastic::compute_seismogram(const int isig_step) {
+template <int FIELDS>
+void specfem::Domain::Elastic::launch_seismogram_fields(
+    const int isig_step,
+    const specfem::kokkos::DeviceView1d<int> device_isig_step,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
 
   const auto seismogram_types = this->receivers->seismogram_types;
   const int nsigtype = seismogram_types.extent(0);
-  const int nreceivers = this->receivers->receiver_array.extent(0);
+  const int nreceivers = this->receivers->ispec_array.extent(0);
+  const int nreceivers_domain = this->receiver_index.extent(0);
+  const auto receiver_index = this->receiver_index;
   const auto ispec_array = this->receivers->ispec_array;
-  const auto ispec_type = this->material_properties->ispec_type;
-  const auto receiver_array = this->receivers->receiver_array;
-  const auto ibool = this->compute->ibool;
+  const auto hxir = this->receivers->hxir;
+  const auto hgammar = this->receivers->hgammar;
+  const auto ibool = this->compute->get_ibool();
   const auto cos_recs = this->receivers->cos_recs;
   const auto sin_recs = this->receivers->sin_recs;
-  auto field = this->receivers->field;
-  const int ngllx = ibool.extent(1);
-  const int ngllz = ibool.extent(2);
+  const int ngllz = ibool.ngllz;
+  const int ngllx = ibool.ngllx;
   const int ngllxz = ngllx * ngllz;
-  auto seismogram = Kokkos::subview(this->receivers->seismogram, isig_step,
-                                    Kokkos::ALL, Kokkos::ALL, Kokkos::ALL);
-  specfem::kokkos::DeviceView2d<type_real> copy_field;
+  const auto seismogram = this->receivers->seismogram;
+  // Seismograms are stored in a ring buffer of nslots samples
+  const int nslots = seismogram.extent(0);
+  // Decimated seismograms filter the last ntaps recorded samples
+  const int decimation = this->receivers->decimation;
+  const int delay = this->receivers->filter_delay();
+  const auto filter = this->receivers->filter;
+  const auto history = this->receivers->history;
+  const int ntaps = 2 * delay + 1;
+  const auto wave = this->wave;
+  const int ncomponents = (wave == specfem::wave::p_sv) ? 2 : 1;
+  // Receivers are stored shot after shot
+  const int nreceivers_shot = nreceivers / this->nshots;
+  const auto field = this->field;
+  const auto field_dot = this->field_dot;
+  const auto field_dot_dot = this->field_dot_dot;
+  // Recorded kernels are replayed, hence seismogram step is read on the device
+  const bool use_device_step = (node != nullptr);
 
-  Kokkos::parallel_for(
-      "specfem::Domain::Elastic::compute_seismogram",
-      specfem::kokkos::DeviceTeam(nsigtype * nreceivers, Kokkos::AUTO, 1),
-      KOKKOS_CLASS_LAMBDA(
+  // Only the fields of requested seismograms are read
+  constexpr bool read_displacement =
+      FIELDS & (1 << specfem::seismogram::displacement);
+  constexpr bool read_velocity = FIELDS & (1 << specfem::seismogram::velocity);
+  constexpr bool read_acceleration =
+      FIELDS & (1 << specfem::seismogram::acceleration);
+
+  // Every seismogram type of a receiver is interpolated from a single gather
+  // of the element nodes. One team per receiver of an elastic element
+  const auto configuration =
+      this->seismogram_tuner.get_config(0, node == nullptr);
+  specfem::autotune::parallel_for(
+      "specfem::Domain::Elastic::compute_seismogram", this->seismogram_tuner,
+      configuration, exec_space, nreceivers_domain, 0, 0,
+      KOKKOS_LAMBDA(
           const specfem::kokkos::DeviceTeam::member_type &team_member) {
-        const int isigtype = team_member.league_rank() / nreceivers;
-        const int irec = team_member.league_rank() % nreceivers;
+        const int irec = receiver_index(team_member.league_rank());
         const int ispec = ispec_array(irec);
-        if (ispec_type(ispec) == specfem::elements::elastic) {
+        const int icomponent = (irec / nreceivers_shot) * ncomponents;
 
-          const specfem::seismogram::type type = seismogram_types(isigtype);
-          const auto sv_ibool =
-              Kokkos::subview(ibool, ispec, Kokkos::ALL, Kokkos::ALL);
-          auto sv_field = Kokkos::subview(field, isigtype, irec, Kokkos::ALL,
-                                          Kokkos::ALL, Kokkos::ALL);
-          // Get seismogram field
-          // ----------------------------------------------------------------
-          switch (type) {
-          // Get the displacement field
-          case specfem::seismogram::displacement:
-            Kokkos::parallel_for(
-                Kokkos::TeamThreadRange(team_member, ngllxz),
-                [=](const int xz) {
-                  const int ix = xz % ngllz;
-                  const int iz = xz / ngllz;
-                  const int iglob = sv_ibool(iz, ix);
-
-                  if (specfem::globals::simulation_wave ==
-                      specfem::wave::p_sv) {
-                    sv_field(0, iz, ix) = this->field(iglob, 0);
-                    sv_field(1, iz, ix) = this->field(iglob, 1);
-                  } else if (specfem::globals::simulation_wave ==
-                             specfem::wave::sh) {
-                    sv_field(0, iz, ix) = this->field(iglob, 0);
-                  }
-                });
-            break;
-          // Get the velocity field
-          case specfem::seismogram::velocity:
-            Kokkos::parallel_for(
-                Kokkos::TeamThreadRange(team_member, ngllxz),
-                [=](const int xz) {
-                  const int ix = xz % ngllz;
-                  const int iz = xz / ngllz;
-                  const int iglob = sv_ibool(iz, ix);
-
-                  if (specfem::globals::simulation_wave ==
-                      specfem::wave::p_sv) {
-                    sv_field(0, iz, ix) = this->field_dot(iglob, 0);
-                    sv_field(1, iz, ix) = this->field_dot(iglob, 1);
-                  } else if (specfem::globals::simulation_wave ==
-                             specfem::wave::sh) {
-                    sv_field(0, iz, ix) = this->field_dot(iglob, 0);
-                  }
-                });
-            break;
-          // Get the acceleration field
-          case specfem::seismogram::acceleration:
-            Kokkos::parallel_for(
-                Kokkos::TeamThreadRange(team_member, ngllxz),
-                [=](const int xz) {
-                  const int ix = xz % ngllz;
-                  const int iz = xz / ngllz;
-                  const int iglob = sv_ibool(iz, ix);
-
-                  if (specfem::globals::simulation_wave ==
-                      specfem::wave::p_sv) {
-                    sv_field(0, iz, ix) = this->field_dot_dot(iglob, 0);
-                    sv_field(1, iz, ix) = this->field_dot_dot(iglob, 1);
-                  } else if (specfem::globals::simulation_wave ==
-                             specfem::wave::sh) {
-                    sv_field(0, iz, ix) = this->field_dot_dot(iglob, 0);
-                  }
-                });
-            break;
-          }
-          //-------------------------------------------------------------------
-
-          // compute seismograms
-          const auto sv_receiver_array = Kokkos::subview(
-              receiver_array, irec, Kokkos::ALL, Kokkos::ALL, Kokkos::ALL);
-          const type_real cos_irec = cos_recs(irec);
-          const type_real sin_irec = sin_recs(irec);
-          auto sv_seismogram =
-              Kokkos::subview(seismogram, isigtype, irec, Kokkos::ALL);
-          compute_receiver_seismogram(team_member, sv_seismogram, sv_field,
-                                      type, sv_receiver_array, cos_irec,
-                                      sin_irec);
-        }
-      });
+        receiver_sample sample;
+        Kokkos::parallel_reduce(
+            Kokkos::TeamThreadRange(team_member, ngllxz),
+            [=](const int xz, receiver_sample &l_sample) {
+              const int ix = xz % ngllx;
+              const int iz = xz / ngllx;
+              const int iglob = ibool(ispec, iz, ix);
+              const type_real hlagrange = hxir(irec, ix) * hgammar(irec, iz);
 
-  Kokkos::fence();
+              for (int icomp = 0; icomp < ncomponents; icomp++) {
+                if (read_displacement)
+                  l_sample.value[specfem::seismogram::displacement][icomp] +=
+                      field(iglob, icomponent + icomp) * hlagrange;
+                if (read_velocity)
+                  l_sample.value[specfem::seismogram::velocity][icomp] +=
+                      field_dot(iglob, icomponent + icomp) * hlagrange;
+                if (read_acceleration)
+                  l_sample.value[specfem::seismogram::acceleration][icomp] +=
+                      field_dot_dot(iglob, icomponent + icomp) * hlagrange;
+              }
+            },
+            sample);
+
+        const type_real cos_irec = cos_recs(irec);
+        const type_real sin_irec = sin_recs(irec);
+        const int isig = use_device_step ? device_isig_step(0) : isig_step;
+
+        const int isample =
+            specfem::compute::decimated_sample(isig, decimation, delay);
+
+        Kokkos::single(Kokkos::PerTeam(team_member), [=] {
+          for (int isigtype = 0; isigtype < nsigtype; isigtype++) {
+            const type_real vx = sample.value[seismogram_types(isigtype)][0];
+            const type_real vz = sample.value[seismogram_types(isigtype)][1];
+            type_real value[2];
+            if (wave == specfem::wave::p_sv) {
+              value[0] = cos_irec * vx + sin_irec * vz;
+              value[1] = sin_irec * vx + cos_irec * vz;
+            } else {
+              value[0] = cos_irec * vx + sin_irec * vz;
+              value[1] = 0;
+            }
+
+            if (decimation > 1) {
+              for (int icomp = 0; icomp < 2; icomp++)
+                history(isig % ntaps, isigtype, irec, icomp) = value[icomp];
+
+              // Samples before the first recorded sample are zero
+              if (isample >= 0) {
+                for (int icomp = 0; icomp < 2; icomp++) {
+                  type_real filtered = 0.0;
+                  for (int k = 0; k < ntaps && k <= isig; k++)
+                    filtered += filter(k) *
+                                history((isig - k) % ntaps, isigtype, irec,
+                                        icomp);
+                  value[icomp] = filtered;
+                }
+              }
+            }
+
+            if (isample >= 0) {
+              seismogram(isample % nslots, isigtype, irec, 0) = value[0];
+              seismogram(isample % nslots, isigtype, irec, 1) = value[1];
+            }
+          }
+        });
+      },
+      node);
 }
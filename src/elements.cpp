@@ -33,14 +33,14 @@ specfem::elements::axial_elements::axial_elements(const int nspec) {
       "specfem::mesh::axial_element::is_on_the_axis", nspec);
 
   for (int inum = 0; inum < nspec; inum++) {
-    this->is_on_the_axis(nspec) = false;
+    this->is_on_the_axis(inum) = false;
   }
 
   return;
 }
 
 specfem::elements::tangential_elements::tangential_elements(
-    std::ifstream &stream, const int nnodes_tangential_curve) {
+    std::istream &stream, const int nnodes_tangential_curve) {
   type_real xread, yread;
 
   *this = specfem::elements::tangential_elements(nnodes_tangential_curve);
@@ -63,7 +63,7 @@ specfem::elements::tangential_elements::tangential_elements(
 }
 
 specfem::elements::axial_elements::axial_elements(
-    std::ifstream &stream, const int nelem_on_the_axis, const int nspec,
+    std::istream &stream, const int nelem_on_the_axis, const int nspec,
     const specfem::MPI::MPI *mpi) {
   int ispec;
 
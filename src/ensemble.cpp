@@ -0,0 +1,300 @@
+#include "../include/ensemble.h"
+#include "../include/material.h"
+#include "../include/parameter_parser.h"
+#include "../include/simulation.h"
+#include "../include/specfem_mpi.h"
+#include "../include/utils.h"
+#include "yaml-cpp/yaml.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::vector<std::string> properties = { "rho", "vp", "vs", "Qkappa",
+                                              "Qmu" };
+
+void check_property(const std::string &property) {
+  if (std::find(properties.begin(), properties.end(), property) ==
+      properties.end()) {
+    std::ostringstream message;
+    message << "Unknown material property " << property
+            << ". Use rho, vp, vs, Qkappa or Qmu";
+    throw std::runtime_error(message.str());
+  }
+}
+
+// Material values of a member, every key other than kmato is a property
+std::vector<specfem::ensemble::material_value>
+read_materials(const YAML::Node &Node) {
+  std::vector<specfem::ensemble::material_value> values;
+  for (const auto &material : Node) {
+    const int kmato = material["kmato"].as<int>();
+    for (const auto &entry : material) {
+      const auto property = entry.first.as<std::string>();
+      if (property == "kmato")
+        continue;
+      check_property(property);
+      values.push_back({ kmato, property, entry.second.as<type_real>() });
+    }
+  }
+  return values;
+}
+
+// Cartesian product of the axes of a sweep
+std::vector<specfem::ensemble::member> expand(const YAML::Node &Node) {
+  std::vector<specfem::ensemble::member> members(1);
+
+  if (const YAML::Node sources = Node["sources"]) {
+    std::vector<specfem::ensemble::member> expanded;
+    for (const auto &member : members) {
+      for (const auto &sources_files : sources) {
+        expanded.push_back(member);
+        expanded.back().sources_files =
+            sources_files.as<std::vector<std::string> >();
+      }
+    }
+    members = expanded;
+  }
+
+  if (const YAML::Node materials = Node["materials"]) {
+    for (const auto &axis : materials) {
+      const int kmato = axis["kmato"].as<int>();
+      const auto property = axis["property"].as<std::string>();
+      check_property(property);
+      std::vector<specfem::ensemble::member> expanded;
+      for (const auto &member : members) {
+        for (const auto &value : axis["values"]) {
+          expanded.push_back(member);
+          expanded.back().materials.push_back(
+              { kmato, property, value.as<type_real>() });
+        }
+      }
+      members = expanded;
+    }
+  }
+
+  return members;
+}
+
+void write_index(const specfem::ensemble::sweep &sweep, const int ngroups) {
+  const auto folder = sweep.get_output_folder();
+  std::filesystem::create_directories(folder);
+  const auto filename = folder + "/ensemble.yaml";
+  std::ofstream stream(filename);
+  if (!stream.is_open()) {
+    std::ostringstream message;
+    message << "Could not write ensemble index file " << filename;
+    throw std::runtime_error(message.str());
+  }
+
+  stream << "ensemble:\n"
+         << "  number-of-members: " << sweep.get_nmembers() << "\n"
+         << "  number-of-groups: " << ngroups << "\n"
+         << "  members:\n";
+  for (int imember = 0; imember < sweep.get_nmembers(); imember++) {
+    const auto &member = sweep.get_member(imember);
+    stream << "    - index: " << imember << "\n"
+           << "      group: " << imember % ngroups << "\n"
+           << "      folder: \"" << sweep.get_member_folder(imember) << "\"\n";
+    if (!member.sources_files.empty()) {
+      stream << "      sources:\n";
+      for (const auto &sources_file : member.sources_files)
+        stream << "        - \"" << sources_file << "\"\n";
+    }
+    if (!member.materials.empty()) {
+      stream << "      materials:\n";
+      for (const auto &value : member.materials)
+        stream << "        - { kmato: " << value.kmato << ", "
+               << value.property << ": " << value.value << " }\n";
+    }
+  }
+
+  return;
+}
+
+} // namespace
+
+specfem::ensemble::sweep::sweep(const std::string &sweep_file) {
+  const YAML::Node yaml = YAML::LoadFile(sweep_file);
+  const YAML::Node Node = yaml["ensemble"];
+  if (!Node) {
+    std::ostringstream message;
+    message << "Sweep specification " << sweep_file
+            << " doesn't define an ensemble";
+    throw std::runtime_error(message.str());
+  }
+
+  this->output_folder = Node["output-folder"]
+                            ? Node["output-folder"].as<std::string>()
+                            : std::string("OUTPUT_FILES/ensemble");
+  this->ngroups = Node["groups"] ? Node["groups"].as<int>() : 0;
+
+  if (const YAML::Node members = Node["members"]) {
+    for (const auto &member : members) {
+      specfem::ensemble::member listed;
+      if (member["sources"])
+        listed.sources_files =
+            member["sources"].as<std::vector<std::string> >();
+      if (member["materials"])
+        listed.materials = read_materials(member["materials"]);
+      this->members.push_back(listed);
+    }
+  }
+  if (const YAML::Node axes = Node["sweep"]) {
+    const auto expanded = expand(axes);
+    this->members.insert(this->members.end(), expanded.begin(),
+                         expanded.end());
+  }
+
+  if (this->members.empty()) {
+    std::ostringstream message;
+    message << "Sweep specification " << sweep_file << " has no member";
+    throw std::runtime_error(message.str());
+  }
+}
+
+std::string
+specfem::ensemble::sweep::get_member_folder(const int imember) const {
+  std::ostringstream folder;
+  folder << this->output_folder << "/member" << std::setw(4)
+         << std::setfill('0') << imember;
+  return folder.str();
+}
+
+int specfem::ensemble::sweep::get_ngroups(const int nprocs) const {
+  const int ngroups = (this->ngroups > 0) ? this->ngroups : nprocs;
+  if (ngroups > nprocs) {
+    std::ostringstream message;
+    message << "Ensemble of " << ngroups << " groups needs at least "
+            << ngroups << " processes";
+    throw std::runtime_error(message.str());
+  }
+  return std::max(std::min(ngroups, this->get_nmembers()), 1);
+}
+
+std::vector<specfem::material *> specfem::ensemble::assign_materials(
+    const std::vector<specfem::utilities::return_holder> &materials,
+    const std::vector<specfem::ensemble::material_value> &values) {
+
+  const int nmaterials = materials.size();
+  for (const auto &value : values) {
+    if (value.kmato < 1 || value.kmato > nmaterials) {
+      std::ostringstream message;
+      message << "Material " << value.kmato << " isn't a material of the mesh";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  std::vector<specfem::material *> assigned;
+  for (int imaterial = 0; imaterial < nmaterials; imaterial++) {
+    const auto &properties = materials[imaterial];
+    type_real rho = properties.rho;
+    type_real vp = std::sqrt(properties.lambdaplus2mu / properties.rho);
+    type_real vs = std::sqrt(properties.mu / properties.rho);
+    type_real qkappa = properties.qkappa;
+    type_real qmu = properties.qmu;
+    for (const auto &value : values) {
+      if (value.kmato != imaterial + 1)
+        continue;
+      if (value.property == "rho")
+        rho = value.value;
+      else if (value.property == "vp")
+        vp = value.value;
+      else if (value.property == "vs")
+        vs = value.value;
+      else if (value.property == "Qkappa")
+        qkappa = value.value;
+      else if (value.property == "Qmu")
+        qmu = value.value;
+    }
+
+    // Values are laid out as in the database
+    specfem::utilities::input_holder holder;
+    holder.val0 = rho;
+    holder.val1 = vp;
+    holder.val2 = vs;
+    holder.val3 = 0.0;
+    holder.val5 = qkappa;
+    holder.val6 = qmu;
+    auto material = new specfem::elastic_material();
+    material->assign(holder);
+    assigned.push_back(material);
+  }
+
+  return assigned;
+}
+
+void specfem::ensemble::run(const std::string &parameter_file,
+                            const specfem::ensemble::sweep &sweep,
+                            specfem::MPI::MPI *mpi) {
+
+  const int nmembers = sweep.get_nmembers();
+  const int ngroups = sweep.get_ngroups(mpi->get_size());
+  const int igroup = mpi->get_rank() * ngroups / mpi->get_size();
+  specfem::MPI::MPI group(*mpi, igroup);
+
+  if (mpi->main_proc())
+    write_index(sweep, ngroups);
+
+  // Members of a group sharing their material values are simulated one
+  // after the other, hence materials are only set up again when they change
+  std::vector<int> members;
+  for (int imember = igroup; imember < nmembers; imember += ngroups)
+    members.push_back(imember);
+  std::vector<int> ordered;
+  std::vector<bool> assigned(members.size(), false);
+  for (int index = 0; index < members.size(); index++) {
+    if (assigned[index])
+      continue;
+    for (int jndex = index; jndex < members.size(); jndex++) {
+      if (!assigned[jndex] &&
+          sweep.get_member(members[jndex]).materials ==
+              sweep.get_member(members[index]).materials) {
+        ordered.push_back(members[jndex]);
+        assigned[jndex] = true;
+      }
+    }
+  }
+
+  const auto default_sources =
+      specfem::runtime_configuration::setup(parameter_file).get_source_files();
+
+  specfem::simulation::simulation simulation(parameter_file, &group);
+  std::vector<specfem::utilities::return_holder> materials;
+  for (auto &material : simulation.get_materials())
+    materials.push_back(material->get_properties());
+
+  std::vector<specfem::ensemble::material_value> current;
+  for (const int imember : ordered) {
+    const auto &member = sweep.get_member(imember);
+    std::ostringstream message;
+    message << "Ensemble member " << imember << " of " << nmembers
+            << " on group " << igroup;
+    group.cout(message.str());
+
+    if (!(member.materials == current)) {
+      simulation.set_materials(assign_materials(materials, member.materials));
+      current = member.materials;
+    }
+    simulation.set_sources(member.sources_files.empty()
+                               ? default_sources
+                               : member.sources_files);
+    simulation.run();
+
+    const auto folder = sweep.get_member_folder(imember);
+    if (group.main_proc())
+      std::filesystem::create_directories(folder);
+    group.sync_all();
+    simulation.write_seismograms(folder);
+  }
+
+  mpi->sync_all();
+  return;
+}
@@ -0,0 +1,182 @@
+#include "../include/first_touch.h"
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include <Kokkos_Core.hpp>
+#include <vector>
+
+namespace {
+
+// Indices of every launch followed by the indices which aren't in any launch.
+// Every index in [0, n) is listed once
+specfem::first_touch::launches
+complete(const specfem::first_touch::launches &launches, const int n) {
+  std::vector<bool> listed(n, false);
+  specfem::first_touch::launches completed;
+  for (const auto &launch : launches) {
+    std::vector<int> indices;
+    for (const int index : launch) {
+      if (!listed[index]) {
+        listed[index] = true;
+        indices.push_back(index);
+      }
+    }
+    completed.push_back(indices);
+  }
+
+  std::vector<int> remaining;
+  for (int index = 0; index < n; index++) {
+    if (!listed[index])
+      remaining.push_back(index);
+  }
+  completed.push_back(remaining);
+
+  return completed;
+}
+
+// Copy view to a view allocated without initialization, launch after launch.
+// Range policies split every launch into contiguous blocks, one per thread,
+// as the stiffness kernels do
+template <typename ViewType>
+void place_view(ViewType &view,
+                const specfem::first_touch::launches &launches) {
+  // Device memory isn't placed by host threads
+  constexpr bool host_backend =
+      Kokkos::SpaceAccessibility<Kokkos::HostSpace,
+                                 specfem::kokkos::DevMemSpace>::accessible;
+  if (!host_backend || !view.is_allocated())
+    return;
+
+  const ViewType placed(
+      Kokkos::view_alloc(Kokkos::WithoutInitializing, view.label()),
+      view.layout());
+  const ViewType source = view;
+
+  for (const auto &launch : complete(launches, view.extent(0))) {
+    const int n = launch.size();
+    if (n == 0)
+      continue;
+
+    specfem::kokkos::DeviceView1d<int> indices(
+        "specfem::first_touch::indices", n);
+    auto h_indices = Kokkos::create_mirror_view(indices);
+    for (int i = 0; i < n; i++)
+      h_indices(i) = launch[i];
+    Kokkos::deep_copy(indices, h_indices);
+
+    Kokkos::parallel_for(
+        "specfem::first_touch::place", specfem::kokkos::DeviceRange(0, n),
+        KOKKOS_LAMBDA(const int i) {
+          const int index = indices(i);
+          if constexpr (ViewType::rank == 1) {
+            placed(index) = source(index);
+          } else if constexpr (ViewType::rank == 2) {
+            for (int j = 0; j < source.extent(1); j++)
+              placed(index, j) = source(index, j);
+          } else {
+            for (int j = 0; j < source.extent(1); j++) {
+              for (int k = 0; k < source.extent(2); k++)
+                placed(index, j, k) = source(index, j, k);
+            }
+          }
+        });
+  }
+
+  Kokkos::fence();
+  view = placed;
+
+  return;
+}
+
+// Assign a host mirror of a placed view again unless it was released. Host
+// mirrors are the device views on host backends
+template <typename MirrorType, typename ViewType>
+void remirror(MirrorType &mirror, const ViewType &view) {
+  if (mirror.data() != nullptr && view.is_allocated())
+    mirror = Kokkos::create_mirror_view(view);
+}
+
+} // namespace
+
+specfem::first_touch::launches specfem::first_touch::point_launches(
+    const specfem::first_touch::launches &elements,
+    const specfem::kokkos::HostElementMirror3d<int> ibool, const int nglob) {
+
+  const int ngllz = ibool.extent(1);
+  const int ngllx = ibool.extent(2);
+  std::vector<bool> assigned(nglob, false);
+
+  specfem::first_touch::launches points;
+  for (const auto &launch : elements) {
+    std::vector<int> launch_points;
+    for (const int ielement : launch) {
+      for (int iz = 0; iz < ngllz; iz++) {
+        for (int ix = 0; ix < ngllx; ix++) {
+          const int iglob = ibool(ielement, iz, ix);
+          if (!assigned[iglob]) {
+            assigned[iglob] = true;
+            launch_points.push_back(iglob);
+          }
+        }
+      }
+    }
+    points.push_back(launch_points);
+  }
+
+  return points;
+}
+
+void specfem::first_touch::place(
+    specfem::kokkos::DeviceElementView3d<type_real> &view,
+    const specfem::first_touch::launches &elements) {
+  place_view(view, elements);
+}
+
+void specfem::first_touch::place(
+    specfem::kokkos::DeviceFieldView2d<type_real> &view,
+    const specfem::first_touch::launches &points) {
+  place_view(view, points);
+}
+
+void specfem::first_touch::place(
+    specfem::kokkos::DeviceView1d<type_real> &view,
+    const specfem::first_touch::launches &points) {
+  place_view(view, points);
+}
+
+void specfem::first_touch::place(
+    specfem::compute::partial_derivatives &partial_derivatives,
+    const specfem::first_touch::launches &elements) {
+
+  for (auto *view :
+       { &partial_derivatives.xix, &partial_derivatives.xiz,
+         &partial_derivatives.gammax, &partial_derivatives.gammaz,
+         &partial_derivatives.jacobian }) {
+    place_view(*view, elements);
+  }
+
+  remirror(partial_derivatives.h_xix, partial_derivatives.xix);
+  remirror(partial_derivatives.h_xiz, partial_derivatives.xiz);
+  remirror(partial_derivatives.h_gammax, partial_derivatives.gammax);
+  remirror(partial_derivatives.h_gammaz, partial_derivatives.gammaz);
+  remirror(partial_derivatives.h_jacobian, partial_derivatives.jacobian);
+
+  return;
+}
+
+void specfem::first_touch::place(
+    specfem::compute::properties &properties,
+    const specfem::first_touch::launches &elements) {
+
+  // Compressed properties are read from the material table
+  for (auto *view :
+       { &properties.rho, &properties.mu, &properties.lambdaplus2mu }) {
+    place_view(*view, elements);
+  }
+
+  remirror(properties.h_rho, properties.rho);
+  remirror(properties.h_mu, properties.mu);
+  remirror(properties.h_lambdaplus2mu, properties.lambdaplus2mu);
+
+  return;
+}
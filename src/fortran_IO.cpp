@@ -1,10 +1,18 @@
 #include "../include/fortran_IO.h"
 #include <boost/algorithm/string.hpp>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <string>
 
-void specfem::fortran_IO::fortran_IO(std::ifstream &stream,
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+void specfem::fortran_IO::fortran_IO(std::istream &stream,
                                      int &buffer_length) {
   if (buffer_length != 0)
     throw std::runtime_error("Error reading fortran file");
@@ -12,55 +20,46 @@ void specfem::fortran_IO::fortran_IO(std::ifstream &stream,
   return;
 }
 
-void specfem::fortran_IO::fortran_read_value(bool *value, std::ifstream &stream,
+void specfem::fortran_IO::fortran_read_value(bool *value, std::istream &stream,
                                              int &buffer_length) {
 
   buffer_length -= fbool;
-  char *ivalue = new char[fbool];
   if (buffer_length < 0) {
     throw std::runtime_error("Error reading fortran file");
   }
+  char ivalue[fbool];
   stream.read(ivalue, fbool);
-
   *value = *reinterpret_cast<bool *>(ivalue);
-
-  delete[] ivalue;
   return;
 }
 
-void specfem::fortran_IO::fortran_read_value(int *value, std::ifstream &stream,
+void specfem::fortran_IO::fortran_read_value(int *value, std::istream &stream,
                                              int &buffer_length) {
 
   buffer_length -= fint;
-  char *ivalue = new char[fint];
   if (buffer_length < 0) {
     throw std::runtime_error("Error reading fortran file");
   }
-  stream.read(ivalue, fint);
-  *value = *reinterpret_cast<int *>(ivalue);
-  delete[] ivalue;
+  stream.read(reinterpret_cast<char *>(value), fint);
   return;
 }
 
 void specfem::fortran_IO::fortran_read_value(type_real *value,
-                                             std::ifstream &stream,
+                                             std::istream &stream,
                                              int &buffer_length) {
 
-  double *temp;
   buffer_length -= fdouble;
-  char *ivalue = new char[fdouble];
   if (buffer_length < 0) {
     throw std::runtime_error("Error reading fortran file");
   }
-  stream.read(ivalue, fdouble);
-  temp = reinterpret_cast<double *>(ivalue);
-  *value = static_cast<type_real>(*temp);
-  delete[] ivalue;
+  double temp;
+  stream.read(reinterpret_cast<char *>(&temp), fdouble);
+  *value = static_cast<type_real>(temp);
   return;
 }
 
 void specfem::fortran_IO::fortran_read_value(std::string *value,
-                                             std::ifstream &stream,
+                                             std::istream &stream,
                                              int &buffer_length) {
   // reading a string has few errors. There seem to unknown characters at the
   // end of the string
@@ -75,3 +74,110 @@ void specfem::fortran_IO::fortran_read_value(std::string *value,
   boost::algorithm::trim(*value);
   return;
 }
+
+specfem::fortran_IO::record_reader::record_reader(const std::string &filename) {
+#if defined(__unix__) || defined(__APPLE__)
+  const int file = open(filename.c_str(), O_RDONLY);
+  if (file < 0)
+    throw std::runtime_error("Could not find fortran file to read");
+
+  struct stat status;
+  if (fstat(file, &status) != 0) {
+    close(file);
+    throw std::runtime_error("Could not find fortran file to read");
+  }
+
+  this->size = status.st_size;
+  if (this->size > 0) {
+    void *address = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (address == MAP_FAILED) {
+      close(file);
+      throw std::runtime_error("Could not map fortran file");
+    }
+    // Records are read once from the first to the last
+    madvise(address, this->size, MADV_SEQUENTIAL);
+    this->mapping = address;
+    this->data = static_cast<const char *>(address);
+  }
+  // The mapping stays valid once the file is closed
+  close(file);
+#else
+  throw std::runtime_error("Memory-mapped files are not supported");
+#endif
+}
+
+specfem::fortran_IO::record_reader::~record_reader() {
+#if defined(__unix__) || defined(__APPLE__)
+  if (this->mapping)
+    munmap(this->mapping, this->size);
+#endif
+}
+
+int specfem::fortran_IO::record_reader::record_length() const {
+  if (this->position + fint > this->size)
+    throw std::runtime_error("Error reading fortran file");
+
+  int length;
+  std::memcpy(&length, this->data + this->position, fint);
+  return length;
+}
+
+const char *specfem::fortran_IO::record_reader::begin_record(int &length) {
+  length = this->record_length();
+  if (length < 0 || this->position + length + 2 * fint > this->size)
+    throw std::runtime_error("Error reading fortran file");
+
+  return this->data + this->position + fint;
+}
+
+void specfem::fortran_IO::record_reader::end_record(const int length) {
+  int trailing;
+  std::memcpy(&trailing, this->data + this->position + fint + length, fint);
+  if (trailing != length)
+    throw std::runtime_error("Error reading fortran file");
+
+  this->position += length + 2 * fint;
+}
+
+void specfem::fortran_IO::record_reader::read_value(bool *value,
+                                                    const char *&record,
+                                                    int &remaining) const {
+  remaining -= fbool;
+  if (remaining < 0)
+    throw std::runtime_error("Error reading fortran file");
+  *value = *reinterpret_cast<const bool *>(record);
+  record += fbool;
+}
+
+void specfem::fortran_IO::record_reader::read_value(int *value,
+                                                    const char *&record,
+                                                    int &remaining) const {
+  remaining -= fint;
+  if (remaining < 0)
+    throw std::runtime_error("Error reading fortran file");
+  *value = impl::decode<int>(record);
+  record += fint;
+}
+
+void specfem::fortran_IO::record_reader::read_value(type_real *value,
+                                                    const char *&record,
+                                                    int &remaining) const {
+  remaining -= fdouble;
+  if (remaining < 0)
+    throw std::runtime_error("Error reading fortran file");
+  *value = impl::decode<type_real>(record);
+  record += fdouble;
+}
+
+void specfem::fortran_IO::record_reader::read_value(std::string *value,
+                                                    const char *&record,
+                                                    int &remaining) const {
+  remaining -= fchar;
+  if (remaining < 0)
+    throw std::runtime_error("Error reading fortran file");
+  // Strings are padded with blanks, and sometimes terminated early
+  const char *end = static_cast<const char *>(std::memchr(record, '\0', fchar));
+  value->assign(record, end ? end : record + fchar);
+  boost::algorithm::trim(*value);
+  record += fchar;
+}
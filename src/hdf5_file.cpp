@@ -0,0 +1,300 @@
+#include "../include/hdf5_file.h"
+#include "../include/specfem_mpi.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef SPECFEM_ENABLE_HDF5
+#include <hdf5.h>
+
+static_assert(std::is_same<hid_t, std::int64_t>::value,
+              "HDF5 identifiers are expected to be 64 bit integers");
+
+#if defined(MPI_PARALLEL) && defined(H5_HAVE_PARALLEL)
+#define SPECFEM_PARALLEL_HDF5
+#endif
+
+namespace {
+
+template <typename T> hid_t datatype();
+template <> hid_t datatype<float>() { return H5T_NATIVE_FLOAT; }
+template <> hid_t datatype<double>() { return H5T_NATIVE_DOUBLE; }
+template <> hid_t datatype<int>() { return H5T_NATIVE_INT; }
+
+void check(const herr_t status, const std::string &operation,
+           const std::string &filename) {
+  if (status < 0) {
+    std::ostringstream message;
+    message << "HDF5 error while trying to " << operation << " in "
+            << filename;
+    throw std::runtime_error(message.str());
+  }
+}
+
+hid_t check_id(const hid_t id, const std::string &operation,
+               const std::string &filename) {
+  check(id < 0 ? -1 : 0, operation, filename);
+  return id;
+}
+
+} // namespace
+
+bool specfem::writer::hdf5::available() { return true; }
+
+specfem::writer::hdf5::file::file(const std::string &filename,
+                                  const specfem::MPI::MPI *mpi,
+                                  const bool truncate)
+    : mpi(mpi), filename(filename) {
+
+  const hid_t access = H5Pcreate(H5P_FILE_ACCESS);
+  this->transfer = H5Pcreate(H5P_DATASET_XFER);
+
+#ifdef SPECFEM_PARALLEL_HDF5
+  if (mpi) {
+    check(H5Pset_fapl_mpio(access, mpi->get_comm(), MPI_INFO_NULL),
+          "set the MPI-IO driver", filename);
+    check(H5Pset_dxpl_mpio(this->transfer, H5FD_MPIO_COLLECTIVE),
+          "set collective transfers", filename);
+  }
+#else
+  if (mpi && mpi->get_size() > 1) {
+    H5Pclose(access);
+    H5Pclose(this->transfer);
+    std::ostringstream message;
+    message << "Writing " << filename << " from " << mpi->get_size()
+            << " processes requires a parallel HDF5 library";
+    throw std::runtime_error(message.str());
+  }
+#endif
+
+  this->id = truncate ? H5Fcreate(filename.c_str(), H5F_ACC_TRUNC,
+                                  H5P_DEFAULT, access)
+                       : H5Fopen(filename.c_str(), H5F_ACC_RDWR, access);
+  H5Pclose(access);
+  if (this->id < 0) {
+    H5Pclose(this->transfer);
+    std::ostringstream message;
+    message << "Could not " << (truncate ? "create" : "open")
+            << " HDF5 file " << filename;
+    throw std::runtime_error(message.str());
+  }
+}
+
+specfem::writer::hdf5::file::~file() {
+  if (this->transfer >= 0)
+    H5Pclose(this->transfer);
+  if (this->id >= 0)
+    H5Fclose(this->id);
+}
+
+template <typename T>
+void specfem::writer::hdf5::file::create_dataset(
+    const std::string &name, const std::vector<std::size_t> &dims,
+    const std::vector<std::size_t> &chunk, const int compression) {
+
+  if (chunk.size() != dims.size())
+    throw std::runtime_error("Chunks and datasets have different ranks");
+
+  if (compression < 0 || compression > 9)
+    throw std::runtime_error("Deflate level must be between 0 and 9");
+
+  if (compression > 0 && !H5Zfilter_avail(H5Z_FILTER_DEFLATE))
+    throw std::runtime_error("HDF5 library doesn't support compression");
+
+  std::vector<hsize_t> h_dims(dims.begin(), dims.end());
+  std::vector<hsize_t> h_chunk(chunk.size());
+  for (int idim = 0; idim < chunk.size(); idim++)
+    h_chunk[idim] =
+        std::max<hsize_t>(1, std::min<hsize_t>(chunk[idim], dims[idim]));
+
+  const hid_t space = check_id(
+      H5Screate_simple(h_dims.size(), h_dims.data(), nullptr),
+      "create the dataspace of " + name, this->filename);
+  const hid_t properties = H5Pcreate(H5P_DATASET_CREATE);
+
+  // Empty datasets can't be chunked
+  const bool empty = std::find(dims.begin(), dims.end(), 0) != dims.end();
+  if (!empty)
+    check(H5Pset_chunk(properties, h_chunk.size(), h_chunk.data()),
+          "set the chunks of " + name, this->filename);
+  if (compression > 0 && !empty) {
+    check(H5Pset_shuffle(properties), "shuffle " + name, this->filename);
+    check(H5Pset_deflate(properties, compression), "compress " + name,
+          this->filename);
+  }
+
+  const hid_t dataset =
+      H5Dcreate2(this->id, name.c_str(), datatype<T>(), space, H5P_DEFAULT,
+                 properties, H5P_DEFAULT);
+  H5Pclose(properties);
+  H5Sclose(space);
+  check_id(dataset, "create dataset " + name, this->filename);
+  H5Dclose(dataset);
+}
+
+template <typename T>
+void specfem::writer::hdf5::file::write(
+    const std::string &name,
+    const std::vector<std::vector<std::size_t> > &offsets,
+    const std::vector<std::size_t> &block, const T *data) {
+
+  const hid_t dataset =
+      check_id(H5Dopen2(this->id, name.c_str(), H5P_DEFAULT),
+               "open dataset " + name, this->filename);
+  const hid_t filespace = H5Dget_space(dataset);
+
+  // Blocks are selected one by one
+  std::vector<hsize_t> h_block(block.begin(), block.end());
+  hsize_t block_size = 1;
+  for (const auto extent : block)
+    block_size *= extent;
+
+  H5Sselect_none(filespace);
+  for (const auto &offset : offsets) {
+    std::vector<hsize_t> h_offset(offset.begin(), offset.end());
+    check(H5Sselect_hyperslab(filespace, H5S_SELECT_OR, h_offset.data(),
+                              nullptr, h_block.data(), nullptr),
+          "select a block of " + name, this->filename);
+  }
+
+  // Processes without blocks take part in collective writes with empty
+  // selections
+  const hsize_t nvalues = std::max<hsize_t>(1, offsets.size() * block_size);
+  const hid_t memspace = H5Screate_simple(1, &nvalues, nullptr);
+  if (offsets.empty() || block_size == 0)
+    H5Sselect_none(memspace);
+
+  const herr_t status = H5Dwrite(dataset, datatype<T>(), memspace, filespace,
+                                 this->transfer, data);
+
+  H5Sclose(memspace);
+  H5Sclose(filespace);
+  H5Dclose(dataset);
+  check(status, "write dataset " + name, this->filename);
+}
+
+void specfem::writer::hdf5::file::write_strings(
+    const std::string &name, const std::vector<std::string> &values) {
+
+  std::size_t length = 1;
+  for (const auto &value : values)
+    length = std::max(length, value.size());
+
+  // Fixed length strings, padded with null characters
+  std::vector<char> buffer(values.size() * length, '\0');
+  for (int i = 0; i < values.size(); i++)
+    std::copy(values[i].begin(), values[i].end(),
+              buffer.begin() + i * length);
+
+  const hid_t type = H5Tcopy(H5T_C_S1);
+  H5Tset_size(type, length);
+  H5Tset_strpad(type, H5T_STR_NULLPAD);
+
+  const hsize_t dims = values.size();
+  const hid_t space = H5Screate_simple(1, &dims, nullptr);
+  const hid_t dataset = H5Dcreate2(this->id, name.c_str(), type, space,
+                                   H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (dataset < 0) {
+    H5Sclose(space);
+    H5Tclose(type);
+    check(-1, "create dataset " + name, this->filename);
+  }
+
+  const bool main_proc = (this->mpi == nullptr) || this->mpi->main_proc();
+  if (!main_proc)
+    H5Sselect_none(space);
+
+  const herr_t status =
+      H5Dwrite(dataset, type, space, space, this->transfer, buffer.data());
+
+  H5Dclose(dataset);
+  H5Sclose(space);
+  H5Tclose(type);
+  check(status, "write dataset " + name, this->filename);
+}
+
+template <typename T>
+void specfem::writer::hdf5::file::write_attribute(const std::string &name,
+                                                  const T value) {
+
+  const hid_t space = H5Screate(H5S_SCALAR);
+  const hid_t attribute =
+      H5Acreate2(this->id, name.c_str(), datatype<T>(), space, H5P_DEFAULT,
+                 H5P_DEFAULT);
+  H5Sclose(space);
+  check_id(attribute, "create attribute " + name, this->filename);
+
+  const herr_t status = H5Awrite(attribute, datatype<T>(), &value);
+  H5Aclose(attribute);
+  check(status, "write attribute " + name, this->filename);
+}
+
+#else
+
+namespace {
+void unavailable() {
+  throw std::runtime_error("SPECFEM was compiled without HDF5. Reconfigure "
+                           "with -DHDF5_OUTPUT=ON to write HDF5 files");
+}
+} // namespace
+
+bool specfem::writer::hdf5::available() { return false; }
+
+specfem::writer::hdf5::file::file(const std::string &filename,
+                                  const specfem::MPI::MPI *mpi,
+                                  const bool truncate)
+    : mpi(mpi), filename(filename) {
+  unavailable();
+}
+
+specfem::writer::hdf5::file::~file() {}
+
+template <typename T>
+void specfem::writer::hdf5::file::create_dataset(
+    const std::string &name, const std::vector<std::size_t> &dims,
+    const std::vector<std::size_t> &chunk, const int compression) {
+  unavailable();
+}
+
+template <typename T>
+void specfem::writer::hdf5::file::write(
+    const std::string &name,
+    const std::vector<std::vector<std::size_t> > &offsets,
+    const std::vector<std::size_t> &block, const T *data) {
+  unavailable();
+}
+
+void specfem::writer::hdf5::file::write_strings(
+    const std::string &name, const std::vector<std::string> &values) {
+  unavailable();
+}
+
+template <typename T>
+void specfem::writer::hdf5::file::write_attribute(const std::string &name,
+                                                  const T value) {
+  unavailable();
+}
+
+#endif
+
+// Explicit instantiation
+#define INSTANTIATE(T)                                                         \
+  template void specfem::writer::hdf5::file::create_dataset<T>(                \
+      const std::string &, const std::vector<std::size_t> &,                   \
+      const std::vector<std::size_t> &, const int);                            \
+  template void specfem::writer::hdf5::file::write<T>(                         \
+      const std::string &, const std::vector<std::vector<std::size_t> > &,     \
+      const std::vector<std::size_t> &, const T *);                            \
+  template void specfem::writer::hdf5::file::write_attribute<T>(               \
+      const std::string &, const T);
+
+INSTANTIATE(float)
+INSTANTIATE(double)
+INSTANTIATE(int)
+
+#undef INSTANTIATE
@@ -0,0 +1,510 @@
+#include "../include/injection.h"
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/quadrature.h"
+#include "../include/stacey.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+int number_of_values(const specfem::wave::type wave) {
+  return (wave == specfem::wave::p_sv) ? 5 : 3;
+}
+
+} // namespace
+
+specfem::boundaries::injection::injection(
+    const type_real xmin, const type_real xmax, const type_real zmin,
+    const type_real zmax, const specfem::compute::compute *compute,
+    const specfem::compute::partial_derivatives *partial_derivatives,
+    const specfem::compute::properties *properties,
+    const specfem::quadrature::quadrature *quadx,
+    const specfem::quadrature::quadrature *quadz,
+    const specfem::wave::type wave, const int nsteps, const int chunk_size,
+    const type_real t0, const type_real dt, const std::string filename)
+    : mode(specfem::injection::record), nvalues(number_of_values(wave)),
+      nsteps(nsteps), chunk_size(chunk_size), filename(filename) {
+
+  if (xmin >= xmax || zmin >= zmax) {
+    throw std::runtime_error("Injection contour needs xmin < xmax and "
+                             "zmin < zmax");
+  }
+
+  const auto h_ibool = compute->h_ibool;
+  const auto coord = compute->coordinates.coord;
+  const auto ispec_type = properties->h_ispec_type;
+  const int nspec = h_ibool.extent(0);
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  const int nglob = coord.extent(1);
+  const type_real tol = 1e-5 * std::max(xmax - xmin, zmax - zmin);
+
+  const auto on_contour = [&](const type_real x, const type_real z) {
+    const bool inside_x = (x > xmin - tol) && (x < xmax + tol);
+    const bool inside_z = (z > zmin - tol) && (z < zmax + tol);
+    return (inside_z &&
+            (std::abs(x - xmin) < tol || std::abs(x - xmax) < tol)) ||
+           (inside_x &&
+            (std::abs(z - zmin) < tol || std::abs(z - zmax) < tol));
+  };
+
+  // Points are recorded once, inside the first element containing them
+  std::vector<bool> recorded_point(nglob, false);
+  std::vector<int> elements;
+  std::vector<type_real> coordinates;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    if (ispec_type(ispec) != specfem::elements::elastic)
+      continue;
+
+    const int corners[4] = { h_ibool(ispec, 0, 0),
+                             h_ibool(ispec, 0, ngllx - 1),
+                             h_ibool(ispec, ngllz - 1, 0),
+                             h_ibool(ispec, ngllz - 1, ngllx - 1) };
+    type_real xc = 0.0;
+    type_real zc = 0.0;
+    for (int icorner = 0; icorner < 4; icorner++) {
+      xc += 0.25 * coord(0, corners[icorner]);
+      zc += 0.25 * coord(1, corners[icorner]);
+    }
+    if (xc <= xmin || xc >= xmax || zc <= zmin || zc >= zmax)
+      continue;
+
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int iglob = h_ibool(ispec, iz, ix);
+        if (recorded_point[iglob] ||
+            !on_contour(coord(0, iglob), coord(1, iglob)))
+          continue;
+        recorded_point[iglob] = true;
+        elements.push_back(ispec);
+        elements.push_back(iz);
+        elements.push_back(ix);
+        coordinates.push_back(coord(0, iglob));
+        coordinates.push_back(coord(1, iglob));
+      }
+    }
+  }
+
+  this->npoints = coordinates.size() / 2;
+
+  this->element = specfem::kokkos::DeviceView2d<int>(
+      "specfem::boundaries::injection::element", this->npoints, 3);
+  const auto h_element = Kokkos::create_mirror_view(this->element);
+  for (int ipoint = 0; ipoint < this->npoints; ipoint++)
+    for (int i = 0; i < 3; i++)
+      h_element(ipoint, i) = elements[3 * ipoint + i];
+  Kokkos::deep_copy(this->element, h_element);
+
+  this->values = specfem::kokkos::DeviceView3d<type_real, Kokkos::LayoutRight>(
+      "specfem::boundaries::injection::values", chunk_size, this->npoints,
+      this->nvalues);
+  this->h_values = Kokkos::create_mirror_view(this->values);
+
+  this->ibool = compute->get_ibool();
+  this->xix = partial_derivatives->get_xix();
+  this->xiz = partial_derivatives->get_xiz();
+  this->gammax = partial_derivatives->get_gammax();
+  this->gammaz = partial_derivatives->get_gammaz();
+  this->mu = properties->get_mu();
+  this->lambdaplus2mu = properties->get_lambdaplus2mu();
+  this->hprime_xx = quadx->get_hprime();
+  this->hprime_zz = quadz->get_hprime();
+
+  const std::filesystem::path path(filename);
+  if (path.has_parent_path())
+    std::filesystem::create_directories(path.parent_path());
+
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    std::ostringstream message;
+    message << "Could not open injection file " << filename;
+    throw std::runtime_error(message.str());
+  }
+  const std::int32_t header[4] = { sizeof(type_real), this->npoints,
+                                   this->nvalues, nsteps };
+  const double times[2] = { t0, dt };
+  file.write(reinterpret_cast<const char *>(header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(times), sizeof(times));
+  file.write(reinterpret_cast<const char *>(coordinates.data()),
+             coordinates.size() * sizeof(type_real));
+
+  return;
+}
+
+specfem::boundaries::injection::injection(
+    const std::string folder, const specfem::boundaries::stacey &stacey,
+    const specfem::compute::compute *compute, const specfem::wave::type wave,
+    const int nsteps, const int chunk_size, const type_real t0,
+    const type_real dt)
+    : mode(specfem::injection::inject), npoints(stacey.get_npoints()),
+      nvalues(number_of_values(wave)), nsteps(nsteps),
+      chunk_size(chunk_size) {
+
+  const auto coord = compute->coordinates.coord;
+  const auto &coordinates = compute->coordinates;
+  const type_real tol = 1e-5 * std::max(coordinates.xmax - coordinates.xmin,
+                                        coordinates.zmax - coordinates.zmin);
+
+  this->index = stacey.get_index();
+  this->normal = stacey.get_normal();
+  this->impedance = stacey.get_impedance();
+  this->weight = stacey.get_weight();
+  const auto h_index = Kokkos::create_mirror_view_and_copy(
+      specfem::kokkos::HostMemSpace(), this->index);
+
+  std::vector<std::filesystem::path> files;
+  if (std::filesystem::is_directory(folder)) {
+    for (const auto &entry : std::filesystem::directory_iterator(folder)) {
+      const std::string name = entry.path().filename().string();
+      if (name.rfind("proc", 0) == 0 && name.size() > 14 &&
+          name.compare(name.size() - 14, 14, "_injection.bin") == 0)
+        files.push_back(entry.path());
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  if (files.empty()) {
+    std::ostringstream message;
+    message << "No proc<rank>_injection.bin file found in " << folder;
+    throw std::runtime_error(message.str());
+  }
+
+  std::vector<bool> matched(this->npoints, false);
+  double recorded_t0 = 0.0;
+  for (int ifile = 0; ifile < files.size(); ifile++) {
+    std::ifstream file(files[ifile], std::ios::binary);
+    std::int32_t header[4];
+    double times[2];
+    file.read(reinterpret_cast<char *>(header), sizeof(header));
+    file.read(reinterpret_cast<char *>(times), sizeof(times));
+    if (!file || header[0] != sizeof(type_real)) {
+      std::ostringstream message;
+      message << "Injection file " << files[ifile].string()
+              << " wasn't written by a build with the same precision";
+      throw std::runtime_error(message.str());
+    }
+    if (header[2] != this->nvalues) {
+      std::ostringstream message;
+      message << "Injection file " << files[ifile].string()
+              << " was recorded for another wave type";
+      throw std::runtime_error(message.str());
+    }
+
+    const int nfile_points = header[1];
+    const int nfile_steps = header[3];
+    if (ifile == 0) {
+      if (std::abs(times[1] - dt) > 1e-6 * std::abs(dt)) {
+        std::ostringstream message;
+        message << "Time step " << dt
+                << " differs from the time step of the recorded wavefield "
+                << times[1];
+        throw std::runtime_error(message.str());
+      }
+
+      // Timestep istep of this simulation injects the recorded step
+      // istep + offset
+      const double shift = (t0 - times[0]) / dt;
+      this->offset = static_cast<int>(std::round(shift));
+      if (std::abs(shift - this->offset) > 1e-3) {
+        std::ostringstream message;
+        message << "Start time " << t0
+                << " isn't a timestep of the recorded wavefield starting at "
+                << times[0];
+        throw std::runtime_error(message.str());
+      }
+      recorded_t0 = times[0];
+      this->nrecorded = nfile_steps;
+      this->recorded =
+          specfem::kokkos::HostView3d<type_real, Kokkos::LayoutRight>(
+              "specfem::boundaries::injection::recorded", this->nrecorded,
+              this->npoints, this->nvalues);
+    } else if (nfile_steps != this->nrecorded || times[0] != recorded_t0) {
+      std::ostringstream message;
+      message << "Injection file " << files[ifile].string()
+              << " wasn't recorded by the same simulation as "
+              << files[0].string();
+      throw std::runtime_error(message.str());
+    }
+
+    std::vector<type_real> file_coordinates(2 * nfile_points);
+    file.read(reinterpret_cast<char *>(file_coordinates.data()),
+              file_coordinates.size() * sizeof(type_real));
+
+    // Absorbing points shared by two edges read the same recorded point
+    std::vector<std::pair<int, int> > sources;
+    for (int ipoint = 0; ipoint < this->npoints; ipoint++) {
+      if (matched[ipoint])
+        continue;
+      const int iglob = h_index(ipoint);
+      for (int jpoint = 0; jpoint < nfile_points; jpoint++) {
+        if (std::abs(file_coordinates[2 * jpoint] - coord(0, iglob)) < tol &&
+            std::abs(file_coordinates[2 * jpoint + 1] - coord(1, iglob)) <
+                tol) {
+          matched[ipoint] = true;
+          sources.push_back({ ipoint, jpoint });
+          break;
+        }
+      }
+    }
+
+    if (sources.empty())
+      continue;
+
+    std::vector<type_real> step(nfile_points * this->nvalues);
+    for (int jstep = 0; jstep < this->nrecorded; jstep++) {
+      file.read(reinterpret_cast<char *>(step.data()),
+                step.size() * sizeof(type_real));
+      if (!file) {
+        std::ostringstream message;
+        message << "Injection file " << files[ifile].string() << " stores "
+                << jstep << " of " << this->nrecorded << " timesteps";
+        throw std::runtime_error(message.str());
+      }
+      for (const auto &source : sources)
+        for (int ivalue = 0; ivalue < this->nvalues; ivalue++)
+          this->recorded(jstep, source.first, ivalue) =
+              step[source.second * this->nvalues + ivalue];
+    }
+  }
+
+  for (int ipoint = 0; ipoint < this->npoints; ipoint++) {
+    if (!matched[ipoint]) {
+      const int iglob = h_index(ipoint);
+      std::ostringstream message;
+      message << "Absorbing point (" << coord(0, iglob) << ", "
+              << coord(1, iglob)
+              << ") isn't a point of the recorded injection contour";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  this->values = specfem::kokkos::DeviceView3d<type_real, Kokkos::LayoutRight>(
+      "specfem::boundaries::injection::values", chunk_size, this->npoints,
+      this->nvalues);
+  this->h_values = Kokkos::create_mirror_view(this->values);
+
+  return;
+}
+
+void specfem::boundaries::injection::load_chunk(
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  // The previous chunk may still be read by the device
+  exec_space.fence();
+
+  for (int ichunk = 0; ichunk < this->chunk_size; ichunk++) {
+    const int jstep = this->istep + ichunk + this->offset;
+    const bool inside = (jstep >= 0 && jstep < this->nrecorded);
+    for (int ipoint = 0; ipoint < this->npoints; ipoint++)
+      for (int ivalue = 0; ivalue < this->nvalues; ivalue++)
+        this->h_values(ichunk, ipoint, ivalue) =
+            inside ? this->recorded(jstep, ipoint, ivalue) : 0.0;
+  }
+
+  Kokkos::deep_copy(exec_space, this->values, this->h_values);
+
+  return;
+}
+
+void specfem::boundaries::injection::write_chunk(const int nchunk) {
+
+  if (nchunk == 0)
+    return;
+
+  std::ofstream file(this->filename, std::ios::binary | std::ios::app);
+  if (!file) {
+    std::ostringstream message;
+    message << "Could not open injection file " << this->filename;
+    throw std::runtime_error(message.str());
+  }
+  file.write(reinterpret_cast<const char *>(this->h_values.data()),
+             static_cast<std::size_t>(nchunk) * this->npoints *
+                 this->nvalues * sizeof(type_real));
+  this->nwritten += nchunk;
+
+  return;
+}
+
+void specfem::boundaries::injection::compute_interaction(
+    const specfem::kokkos::DeviceFieldView2d<type_real> field,
+    const specfem::kokkos::DeviceFieldView2d<type_real> velocity,
+    const specfem::kokkos::DeviceFieldView2d<type_real> acceleration,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  if (this->istep >= this->nsteps)
+    return;
+
+  const int ichunk = this->istep % this->chunk_size;
+  const int npoints = this->npoints;
+  const auto values = this->values;
+  const bool p_sv = (this->nvalues == 5);
+
+  if (this->mode == specfem::injection::inject) {
+    if (ichunk == 0)
+      this->load_chunk(exec_space);
+    this->istep++;
+
+    if (npoints == 0)
+      return;
+
+    const auto index = this->index;
+    const auto normal = this->normal;
+    const auto impedance = this->impedance;
+    const auto weight = this->weight;
+
+    // Traction of the recorded stress plus the damping of the recorded
+    // velocity, the absorbing points damp the velocity of the local field
+    specfem::kokkos::parallel_for(
+        "specfem::boundaries::injection::inject_interaction",
+        specfem::kokkos::DeviceRange(exec_space, 0, npoints),
+        KOKKOS_LAMBDA(const int ipoint) {
+          const int iglob = index(ipoint);
+          const type_real nx = normal(ipoint, 0);
+          const type_real nz = normal(ipoint, 1);
+          const type_real w = weight(ipoint);
+          const type_real impedance0 = impedance(ipoint, 0);
+
+          if (!p_sv) {
+            const type_real t = w * (values(ichunk, ipoint, 1) * nx +
+                                     values(ichunk, ipoint, 2) * nz) +
+                                impedance0 * values(ichunk, ipoint, 0);
+            Kokkos::atomic_add(&acceleration(iglob, 0), t);
+            return;
+          }
+
+          const type_real impedance1 = impedance(ipoint, 1);
+          const type_real vx = values(ichunk, ipoint, 0);
+          const type_real vz = values(ichunk, ipoint, 1);
+          const type_real sigma_xx = values(ichunk, ipoint, 2);
+          const type_real sigma_zz = values(ichunk, ipoint, 3);
+          const type_real sigma_xz = values(ichunk, ipoint, 4);
+          const type_real vn = nx * vx + nz * vz;
+          const type_real tx = w * (sigma_xx * nx + sigma_xz * nz) +
+                               impedance0 * vn * nx +
+                               impedance1 * (vx - vn * nx);
+          const type_real tz = w * (sigma_xz * nx + sigma_zz * nz) +
+                               impedance0 * vn * nz +
+                               impedance1 * (vz - vn * nz);
+          Kokkos::atomic_add(&acceleration(iglob, 0), tx);
+          Kokkos::atomic_add(&acceleration(iglob, 1), tz);
+        },
+        nullptr);
+    return;
+  }
+
+  const auto element = this->element;
+  const auto ibool = this->ibool;
+  const auto xix = this->xix;
+  const auto xiz = this->xiz;
+  const auto gammax = this->gammax;
+  const auto gammaz = this->gammaz;
+  const auto mu = this->mu;
+  const auto lambdaplus2mu = this->lambdaplus2mu;
+  const auto hprime_xx = this->hprime_xx;
+  const auto hprime_zz = this->hprime_zz;
+  const int ngllx = hprime_xx.extent(0);
+  const int ngllz = hprime_zz.extent(0);
+  const int ncomponents = p_sv ? 2 : 1;
+
+  if (npoints > 0) {
+    specfem::kokkos::parallel_for(
+        "specfem::boundaries::injection::record_interaction",
+        specfem::kokkos::DeviceRange(exec_space, 0, npoints),
+        KOKKOS_LAMBDA(const int ipoint) {
+          const int ispec = element(ipoint, 0);
+          const int iz = element(ipoint, 1);
+          const int ix = element(ipoint, 2);
+
+          // Derivatives of every component along xi and gamma
+          type_real dxi[2] = { 0.0, 0.0 };
+          type_real dgamma[2] = { 0.0, 0.0 };
+          for (int l = 0; l < ngllx; l++) {
+            const int iglob = ibool(ispec, iz, l);
+            for (int icomp = 0; icomp < ncomponents; icomp++)
+              dxi[icomp] += hprime_xx(ix, l) * field(iglob, icomp);
+          }
+          for (int l = 0; l < ngllz; l++) {
+            const int iglob = ibool(ispec, l, ix);
+            for (int icomp = 0; icomp < ncomponents; icomp++)
+              dgamma[icomp] += hprime_zz(iz, l) * field(iglob, icomp);
+          }
+
+          const type_real xixl = xix(ispec, iz, ix);
+          const type_real xizl = xiz(ispec, iz, ix);
+          const type_real gammaxl = gammax(ispec, iz, ix);
+          const type_real gammazl = gammaz(ispec, iz, ix);
+          const type_real mul = mu(ispec, iz, ix);
+          const int iglob = ibool(ispec, iz, ix);
+
+          if (!p_sv) {
+            values(ichunk, ipoint, 0) = velocity(iglob, 0);
+            values(ichunk, ipoint, 1) =
+                mul * (dxi[0] * xixl + dgamma[0] * gammaxl);
+            values(ichunk, ipoint, 2) =
+                mul * (dxi[0] * xizl + dgamma[0] * gammazl);
+            return;
+          }
+
+          const type_real lambdaplus2mul = lambdaplus2mu(ispec, iz, ix);
+          const type_real lambdal = lambdaplus2mul - 2.0 * mul;
+          const type_real duxdx = dxi[0] * xixl + dgamma[0] * gammaxl;
+          const type_real duxdz = dxi[0] * xizl + dgamma[0] * gammazl;
+          const type_real duzdx = dxi[1] * xixl + dgamma[1] * gammaxl;
+          const type_real duzdz = dxi[1] * xizl + dgamma[1] * gammazl;
+
+          values(ichunk, ipoint, 0) = velocity(iglob, 0);
+          values(ichunk, ipoint, 1) = velocity(iglob, 1);
+          values(ichunk, ipoint, 2) = lambdaplus2mul * duxdx + lambdal * duzdz;
+          values(ichunk, ipoint, 3) = lambdaplus2mul * duzdz + lambdal * duxdx;
+          values(ichunk, ipoint, 4) = mul * (duxdz + duzdx);
+        },
+        nullptr);
+  }
+
+  this->istep++;
+
+  // Full chunks are written while the time loop runs
+  if (ichunk == this->chunk_size - 1) {
+    Kokkos::deep_copy(exec_space, this->h_values, this->values);
+    exec_space.fence();
+    this->write_chunk(this->chunk_size);
+  }
+
+  return;
+}
+
+void specfem::boundaries::injection::flush() {
+
+  if (this->mode != specfem::injection::record)
+    return;
+
+  const int nchunk = this->istep - this->nwritten;
+  if (nchunk == 0)
+    return;
+
+  Kokkos::deep_copy(this->h_values, this->values);
+  this->write_chunk(nchunk);
+
+  return;
+}
+
+specfem::memory::usage
+specfem::boundaries::injection::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->values, this->h_values);
+  usage.add(this->recorded);
+  usage.add(this->element);
+
+  return usage;
+}
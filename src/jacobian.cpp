@@ -15,8 +15,10 @@ std::tuple<type_real, type_real> jacobian::compute_locations(
   type_real xcor = 0.0;
   type_real ycor = 0.0;
 
-  specfem::kokkos::HostView1d<type_real> shape2D =
-      shape_functions::define_shape_functions(xi, gamma, ngnod);
+  type_real shape2D[shape_functions::max_ngnod];
+  type_real dershape2D[ndim][shape_functions::max_ngnod];
+  shape_functions::define_shape_functions(xi, gamma, ngnod, shape2D,
+                                          dershape2D);
 
   // FIXME:: Multi reduction is not yet implemented in kokkos
   // This is hacky way of doing this using double vector loops
@@ -24,13 +26,13 @@ std::tuple<type_real, type_real> jacobian::compute_locations(
   Kokkos::parallel_reduce(
       Kokkos::ThreadVectorRange(teamMember, ngnod),
       [&](const int &in, type_real &update_xcor) {
-        update_xcor += shape2D(in) * s_coorg(0, in);
+        update_xcor += shape2D[in] * s_coorg(0, in);
       },
       xcor);
   Kokkos::parallel_reduce(
       Kokkos::ThreadVectorRange(teamMember, ngnod),
       [&](const int &in, type_real &update_ycor) {
-        update_ycor += shape2D(in) * s_coorg(1, in);
+        update_ycor += shape2D[in] * s_coorg(1, in);
       },
       ycor);
 
@@ -48,12 +50,14 @@ jacobian::compute_locations(const specfem::kokkos::HostView2d<type_real> coorg,
   type_real xcor = 0.0;
   type_real ycor = 0.0;
 
-  specfem::kokkos::HostView1d<type_real> shape2D =
-      shape_functions::define_shape_functions(xi, gamma, ngnod);
+  type_real shape2D[shape_functions::max_ngnod];
+  type_real dershape2D[ndim][shape_functions::max_ngnod];
+  shape_functions::define_shape_functions(xi, gamma, ngnod, shape2D,
+                                          dershape2D);
 
   for (int in = 0; in < ngnod; in++) {
-    xcor += shape2D(in) * coorg(0, in);
-    ycor += shape2D(in) * coorg(1, in);
+    xcor += shape2D[in] * coorg(0, in);
+    ycor += shape2D[in] * coorg(1, in);
   }
 
   return std::make_tuple(xcor, ycor);
@@ -124,8 +128,10 @@ jacobian::compute_partial_derivatives(
   type_real xgamma = 0.0;
   type_real zgamma = 0.0;
 
-  specfem::kokkos::HostView2d<type_real> dershape2D =
-      shape_functions::define_shape_functions_derivatives(xi, gamma, ngnod);
+  type_real shape2D[shape_functions::max_ngnod];
+  type_real dershape2D[ndim][shape_functions::max_ngnod];
+  shape_functions::define_shape_functions(xi, gamma, ngnod, shape2D,
+                                          dershape2D);
 
   // FIXME:: Multi reduction is not yet implemented in kokkos
   // This is hacky way of doing this using double vector loops
@@ -134,25 +140,25 @@ jacobian::compute_partial_derivatives(
   Kokkos::parallel_reduce(
       Kokkos::ThreadVectorRange(teamMember, ngnod),
       [&](const int &in, type_real &update_xxi) {
-        update_xxi += dershape2D(0, in) * s_coorg(0, in);
+        update_xxi += dershape2D[0][in] * s_coorg(0, in);
       },
       xxi);
   Kokkos::parallel_reduce(
       Kokkos::ThreadVectorRange(teamMember, ngnod),
       [&](const int &in, type_real &update_zxi) {
-        update_zxi += dershape2D(0, in) * s_coorg(1, in);
+        update_zxi += dershape2D[0][in] * s_coorg(1, in);
       },
       zxi);
   Kokkos::parallel_reduce(
       Kokkos::ThreadVectorRange(teamMember, ngnod),
       [&](const int &in, type_real &update_xgamma) {
-        update_xgamma += dershape2D(1, in) * s_coorg(0, in);
+        update_xgamma += dershape2D[1][in] * s_coorg(0, in);
       },
       xgamma);
   Kokkos::parallel_reduce(
       Kokkos::ThreadVectorRange(teamMember, ngnod),
       [&](const int &in, type_real &update_zgamma) {
-        update_zgamma += dershape2D(1, in) * s_coorg(1, in);
+        update_zgamma += dershape2D[1][in] * s_coorg(1, in);
       },
       zgamma);
 
@@ -220,14 +226,16 @@ jacobian::compute_partial_derivatives(
   type_real xgamma = 0.0;
   type_real zgamma = 0.0;
 
-  specfem::kokkos::HostView2d<type_real> dershape2D =
-      shape_functions::define_shape_functions_derivatives(xi, gamma, ngnod);
+  type_real shape2D[shape_functions::max_ngnod];
+  type_real dershape2D[ndim][shape_functions::max_ngnod];
+  shape_functions::define_shape_functions(xi, gamma, ngnod, shape2D,
+                                          dershape2D);
 
   for (int in = 0; in < ngnod; in++) {
-    xxi += dershape2D(0, in) * s_coorg(0, in);
-    zxi += dershape2D(0, in) * s_coorg(1, in);
-    xgamma += dershape2D(1, in) * s_coorg(0, in);
-    zgamma += dershape2D(1, in) * s_coorg(1, in);
+    xxi += dershape2D[0][in] * s_coorg(0, in);
+    zxi += dershape2D[0][in] * s_coorg(1, in);
+    xgamma += dershape2D[1][in] * s_coorg(0, in);
+    zgamma += dershape2D[1][in] * s_coorg(1, in);
   }
 
   return std::make_tuple(xxi, zxi, xgamma, zgamma);
@@ -80,8 +80,6 @@ HostView2d Lagrange::compute_jacobi_derivatives_GLJ(const HostView1d xiglj,
   int degpoly = nglj - 1;
   for (int i = 0; i < nglj; i++) {
     for (int j = 0; j < nglj; j++) {
-      std::cout << gll_library::pnglj(xiglj(i), degpoly) << " " << xiglj(i)
-                << std::endl;
       if (j == 0 && i == 0) {
         hprimeBar_ii(i, j) = -1.0 * static_cast<type_real>(degpoly) *
                              (static_cast<type_real>(degpoly) + 2.0) / 6.0;
@@ -106,7 +104,7 @@ HostView2d Lagrange::compute_jacobi_derivatives_GLJ(const HostView1d xiglj,
         hprimeBar_ii(i, j) = -1.0 / (2.0 * (1.0 + xiglj(j)));
       } else if (0 < j && j < degpoly && i == degpoly) {
         hprimeBar_ii(i, j) =
-            1.0 / (gll_library::pnglj(xiglj(i), degpoly) * (1.0 - xiglj(j)));
+            1.0 / (gll_library::pnglj(xiglj(j), degpoly) * (1.0 - xiglj(j)));
       } else if (j == degpoly && i == 0) {
         hprimeBar_ii(i, j) = std::pow(-1, degpoly + 1) *
                              (static_cast<type_real>(degpoly) + 1.0) / 4.0;
@@ -203,8 +201,6 @@ void Lagrange::compute_jacobi_derivatives_GLJ(HostMirror2d hprimeBar_ii,
   int degpoly = nglj - 1;
   for (int i = 0; i < nglj; i++) {
     for (int j = 0; j < nglj; j++) {
-      std::cout << gll_library::pnglj(xiglj(i), degpoly) << " " << xiglj(i)
-                << std::endl;
       if (j == 0 && i == 0) {
         hprimeBar_ii(i, j) = -1.0 * static_cast<type_real>(degpoly) *
                              (static_cast<type_real>(degpoly) + 2.0) / 6.0;
@@ -229,7 +225,7 @@ void Lagrange::compute_jacobi_derivatives_GLJ(HostMirror2d hprimeBar_ii,
         hprimeBar_ii(i, j) = -1.0 / (2.0 * (1.0 + xiglj(j)));
       } else if (0 < j && j < degpoly && i == degpoly) {
         hprimeBar_ii(i, j) =
-            1.0 / (gll_library::pnglj(xiglj(i), degpoly) * (1.0 - xiglj(j)));
+            1.0 / (gll_library::pnglj(xiglj(j), degpoly) * (1.0 - xiglj(j)));
       } else if (j == degpoly && i == 0) {
         hprimeBar_ii(i, j) = std::pow(-1, degpoly + 1) *
                              (static_cast<type_real>(degpoly) + 1.0) / 4.0;
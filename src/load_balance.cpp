@@ -0,0 +1,180 @@
+#include "../include/load_balance.h"
+#include "../include/config.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/specfem_mpi.h"
+#include "../include/timers.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Fields of every process gathered by print
+enum column {
+  seconds,
+  nelastic,
+  nacoustic,
+  nporoelastic,
+  npml,
+  nabsorbing,
+  nsources,
+  nreceivers,
+  nneighbors,
+  nhalo,
+  ncolumns
+};
+
+// Gather values of every process on every process, (nproc, nvalues)
+static std::vector<double> all_gather(const std::vector<double> &values,
+                                      const specfem::MPI::MPI *mpi) {
+  const int nvalues = values.size();
+  std::vector<double> gathered(mpi->get_size() * nvalues, 0.0);
+  std::copy(values.begin(), values.end(),
+            gathered.begin() + mpi->get_rank() * nvalues);
+  return mpi->all_reduce(gathered, specfem::MPI::sum);
+}
+
+specfem::load_balance::rank_load::rank_load(
+    const specfem::kokkos::HostMirror1d<specfem::elements::type>
+        h_ispec_type) {
+  for (int ispec = 0; ispec < h_ispec_type.extent(0); ispec++) {
+    switch (h_ispec_type(ispec)) {
+    case specfem::elements::elastic:
+      this->nelastic++;
+      break;
+    case specfem::elements::acoustic:
+      this->nacoustic++;
+      break;
+    case specfem::elements::poroelastic:
+      this->nporoelastic++;
+      break;
+    }
+  }
+}
+
+double
+specfem::load_balance::compute_seconds(const specfem::timers::timers &timers) {
+  double seconds = 0.0;
+  for (const auto iphase :
+       { specfem::timers::predictor, specfem::timers::stiffness,
+         specfem::timers::sources, specfem::timers::corrector,
+         specfem::timers::seismograms })
+    seconds += timers.get_seconds(iphase);
+  return seconds;
+}
+
+std::string
+specfem::load_balance::print(const specfem::load_balance::rank_load &load,
+                             const specfem::timers::timers &timers,
+                             const specfem::MPI::MPI *mpi, const int nworst) {
+
+  std::vector<double> values(ncolumns);
+  values[seconds] = specfem::load_balance::compute_seconds(timers);
+  values[nelastic] = load.nelastic;
+  values[nacoustic] = load.nacoustic;
+  values[nporoelastic] = load.nporoelastic;
+  values[npml] = load.npml;
+  values[nabsorbing] = load.nabsorbing;
+  values[nsources] = load.nsources;
+  values[nreceivers] = load.nreceivers;
+  values[nneighbors] = load.nneighbors;
+  values[nhalo] = load.nhalo;
+  const auto gathered = all_gather(values, mpi);
+
+  const int nproc = mpi->get_size();
+  const auto value = [&gathered](const int irank, const column icolumn) {
+    return gathered[irank * ncolumns + icolumn];
+  };
+  const auto count = [&value](const int irank, const column icolumn) {
+    return static_cast<int>(value(irank, icolumn));
+  };
+
+  double total = 0.0;
+  for (int irank = 0; irank < nproc; irank++)
+    total += value(irank, seconds);
+  const double mean = total / nproc;
+
+  // Slowest processes first
+  std::vector<int> ranks(nproc);
+  std::iota(ranks.begin(), ranks.end(), 0);
+  std::stable_sort(ranks.begin(), ranks.end(),
+                   [&value](const int irank, const int jrank) {
+                     return value(irank, seconds) > value(jrank, seconds);
+                   });
+  const double largest = value(ranks[0], seconds);
+
+  std::ostringstream message;
+  message << "Load balance (" << nproc << " processes):\n"
+          << "------------------------------\n"
+          << std::fixed << std::setprecision(3);
+  if (largest <= 0.0) {
+    message << "Compute time wasn't measured\n";
+    return message.str();
+  }
+
+  message << "Compute time : mean = " << mean << " s, max = " << largest
+          << " s, imbalance (max / mean) = " << largest / mean << "\n"
+          << "Time loop lost waiting for the slowest process : "
+          << std::setprecision(1) << 100.0 * (1.0 - mean / largest) << " %\n"
+          << "Slowest processes :\n";
+  for (int i = 0; i < std::min(nworst, nproc); i++) {
+    const int irank = ranks[i];
+    message << std::setprecision(3) << "- Rank " << irank << " : "
+            << value(irank, seconds) << " s ("
+            << value(irank, seconds) / mean << " x mean), elements = "
+            << count(irank, nelastic) << " elastic, "
+            << count(irank, nacoustic) << " acoustic, "
+            << count(irank, nporoelastic) << " poroelastic, "
+            << count(irank, npml) << " PML, absorbing points = "
+            << count(irank, nabsorbing)
+            << ", sources = " << count(irank, nsources)
+            << ", receivers = " << count(irank, nreceivers)
+            << ", neighbors = " << count(irank, nneighbors)
+            << ", halo values = " << count(irank, nhalo) << "\n";
+  }
+
+  return message.str();
+}
+
+void specfem::load_balance::write_element_weights(
+    const std::string &filename, const std::vector<int> &serial_ispec,
+    const std::vector<type_real> &element_weights, const double seconds,
+    const specfem::MPI::MPI *mpi) {
+
+  const int nspec = element_weights.size();
+  const int unpartitioned = mpi->all_reduce(
+      static_cast<int>(serial_ispec.size() != nspec), specfem::MPI::max);
+  if (unpartitioned)
+    throw std::runtime_error("Element weights can only be written for meshes "
+                             "partitioned at startup");
+
+  // Weight units of this run are kept such that element weights of several
+  // runs are comparable
+  const double weight = std::accumulate(element_weights.begin(),
+                                        element_weights.end(), 0.0);
+  const double total_weight = mpi->all_reduce(weight, specfem::MPI::sum);
+  const double total_seconds = mpi->all_reduce(seconds, specfem::MPI::sum);
+  const double scale = (weight > 0.0 && total_seconds > 0.0)
+                           ? (seconds / weight) / (total_seconds / total_weight)
+                           : 1.0;
+
+  // Processes append their elements in turn
+  for (int irank = 0; irank < mpi->get_size(); irank++) {
+    if (irank == mpi->get_rank()) {
+      std::ofstream file(filename, (irank == 0) ? std::ios::trunc
+                                                : std::ios::app);
+      if (!file.is_open())
+        throw std::runtime_error("Could not open element weights " +
+                                 filename);
+      file << std::setprecision(6);
+      for (int ispec = 0; ispec < nspec; ispec++)
+        file << serial_ispec[ispec] << " " << scale * element_weights[ispec]
+             << "\n";
+    }
+    mpi->sync_all();
+  }
+}
@@ -0,0 +1,195 @@
+#include "../include/location_cache.h"
+#include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/specfem_mpi.h"
+#include "../include/utils.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// Increment when the layout of cache files changes
+constexpr std::uint32_t version = 1;
+constexpr char magic[8] = { 'S', 'P', 'E', 'C', 'F', 'E', 'M', 'L' };
+
+struct header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t real_size; ///< Size of type_real in bytes
+  std::uint64_t key;
+  std::uint64_t npoints;
+};
+
+// Location of a point as stored in the file
+struct record {
+  type_real xi, gamma;
+  std::int32_t ispec, islice;
+};
+
+// FNV-1a hash of bytes
+std::uint64_t hash(std::uint64_t value, const void *data,
+                   const std::size_t bytes) {
+  const unsigned char *begin = static_cast<const unsigned char *>(data);
+  for (std::size_t i = 0; i < bytes; i++) {
+    value ^= begin[i];
+    value *= 1099511628211ULL;
+  }
+  return value;
+}
+
+template <typename ViewType>
+std::uint64_t hash(const std::uint64_t value, const ViewType &view) {
+  const std::size_t extents[3] = { view.extent(0), view.extent(1),
+                                   view.extent(2) };
+  return hash(hash(value, extents, sizeof(extents)), view.data(),
+              view.span() * sizeof(typename ViewType::value_type));
+}
+
+} // namespace
+
+std::uint64_t specfem::location_cache::key(
+    const specfem::kokkos::HostView2d<type_real> coord,
+    const specfem::kokkos::HostElementMirror3d<int> ibool,
+    const specfem::kokkos::HostMirror1d<type_real> xigll,
+    const specfem::kokkos::HostMirror1d<type_real> zigll,
+    const std::vector<type_real> &x, const std::vector<type_real> &z,
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::MPI::MPI *mpi) {
+
+  std::uint64_t value = 14695981039346656037ULL;
+
+  const int nproc = mpi->get_size();
+  value = hash(value, &nproc, sizeof(nproc));
+  value = hash(value, coorg);
+  value = hash(value, knods);
+  value = hash(value, ibool);
+  value = hash(value, coord);
+  value = hash(value, xigll);
+  value = hash(value, zigll);
+
+  const std::size_t npoints = x.size();
+  value = hash(value, &npoints, sizeof(npoints));
+  value = hash(value, x.data(), x.size() * sizeof(type_real));
+  value = hash(value, z.data(), z.size() * sizeof(type_real));
+
+  return value;
+}
+
+std::string specfem::location_cache::filename(const std::string &directory,
+                                              const std::string &name,
+                                              const specfem::MPI::MPI *mpi) {
+  std::ostringstream filename;
+  filename << directory << "/" << name << "_locations_" << mpi->get_rank()
+           << ".bin";
+  return filename.str();
+}
+
+bool specfem::location_cache::load(
+    const std::string &filename, const std::uint64_t key,
+    std::vector<specfem::location_cache::location> &locations) {
+
+  std::ifstream stream(filename, std::ios::binary);
+  if (!stream.is_open())
+    return false;
+
+  header head;
+  if (!stream.read(reinterpret_cast<char *>(&head), sizeof(header)) ||
+      std::memcmp(head.magic, magic, sizeof(magic)) != 0 ||
+      head.version != version || head.real_size != sizeof(type_real) ||
+      head.key != key)
+    return false;
+
+  std::vector<record> records(head.npoints);
+  if (!stream.read(reinterpret_cast<char *>(records.data()),
+                   records.size() * sizeof(record)) ||
+      stream.peek() != std::ifstream::traits_type::eof())
+    return false;
+
+  locations.clear();
+  for (const auto &point : records)
+    locations.emplace_back(point.xi, point.gamma, point.ispec, point.islice);
+
+  return true;
+}
+
+void specfem::location_cache::save(
+    const std::string &filename, const std::uint64_t key,
+    const std::vector<specfem::location_cache::location> &locations) {
+
+  const auto directory = std::filesystem::path(filename).parent_path();
+  if (!directory.empty())
+    std::filesystem::create_directories(directory);
+
+  header head;
+  std::memcpy(head.magic, magic, sizeof(magic));
+  head.version = version;
+  head.real_size = sizeof(type_real);
+  head.key = key;
+  head.npoints = locations.size();
+
+  std::vector<record> records;
+  for (const auto &[xi, gamma, ispec, islice] : locations)
+    records.push_back({ xi, gamma, ispec, islice });
+
+  const std::string temporary = filename + ".tmp";
+  std::ofstream stream(temporary, std::ios::binary);
+  if (!stream.is_open()) {
+    std::ostringstream message;
+    message << "Could not write location cache file " << filename;
+    throw std::runtime_error(message.str());
+  }
+
+  stream.write(reinterpret_cast<const char *>(&head), sizeof(header));
+  stream.write(reinterpret_cast<const char *>(records.data()),
+               records.size() * sizeof(record));
+
+  stream.close();
+  if (!stream || std::rename(temporary.c_str(), filename.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    std::ostringstream message;
+    message << "Could not write location cache file " << filename;
+    throw std::runtime_error(message.str());
+  }
+}
+
+std::tuple<std::vector<specfem::location_cache::location>, bool>
+specfem::location_cache::locate(
+    const std::string &filename,
+    const specfem::kokkos::HostView2d<type_real> coord,
+    const specfem::kokkos::HostElementMirror3d<int> ibool,
+    const specfem::kokkos::HostMirror1d<type_real> xigll,
+    const specfem::kokkos::HostMirror1d<type_real> zigll,
+    const std::vector<type_real> &x, const std::vector<type_real> &z,
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::MPI::MPI *mpi) {
+
+  if (filename.empty()) {
+    return { specfem::utilities::locate(coord, ibool, xigll, zigll, x, z,
+                                        coorg, knods, mpi),
+             false };
+  }
+
+  // Owners are resolved across processes, hence a single miss relocates
+  // every point
+  const std::uint64_t cache_key =
+      key(coord, ibool, xigll, zigll, x, z, coorg, knods, mpi);
+  std::vector<location> locations;
+  const bool loaded = load(filename, cache_key, locations);
+  if (mpi->all_reduce(static_cast<int>(loaded), specfem::MPI::min) == 1)
+    return { locations, true };
+
+  locations = specfem::utilities::locate(coord, ibool, xigll, zigll, x, z,
+                                         coorg, knods, mpi);
+  save(filename, cache_key, locations);
+  return { locations, false };
+}
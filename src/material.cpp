@@ -124,6 +124,18 @@ void specfem::acoustic_material::assign(utilities::input_holder &holder) {
     std::runtime_error("Poisson's ratio out of range");
 }
 
+specfem::utilities::return_holder specfem::acoustic_material::get_properties() {
+  utilities::return_holder holder;
+  holder.rho = this->density;
+  holder.mu = this->mu;
+  holder.kappa = this->kappa;
+  holder.qmu = this->Qmu;
+  holder.qkappa = this->Qkappa;
+  holder.lambdaplus2mu = this->lambdaplus2mu;
+
+  return holder;
+}
+
 specfem::utilities::return_holder specfem::elastic_material::get_properties() {
   utilities::return_holder holder;
   holder.rho = this->density;
@@ -18,38 +18,59 @@ specfem::materials::material_ind::material_ind(const int nspec,
   return;
 }
 
-specfem::materials::material_ind::material_ind(std::ifstream &stream,
+specfem::materials::material_ind::material_ind(std::istream &stream,
                                                const int ngnod, const int nspec,
                                                const int numat,
                                                const specfem::MPI::MPI *mpi) {
-  std::vector<int> knods_read(ngnod, -1);
-  int n, kmato_read, pml_read;
-
   // Allocate views
-  *this = specfem::materials::material_ind(nspec, ngnod);
+  *this = specfem::materials::material_ind(
+      stream, ngnod, nspec, numat,
+      specfem::materials::material_ind(nspec, ngnod), true, mpi);
+}
+
+specfem::materials::material_ind::material_ind(
+    std::istream &stream, const int ngnod, const int nspec, const int numat,
+    const specfem::materials::material_ind &storage, const bool store,
+    const specfem::MPI::MPI *mpi)
+    : region_CPML(storage.region_CPML), kmato(storage.kmato),
+      knods(storage.knods) {
+  // format: #element_id  #material_id #node_id1 #node_id2 #... #pml
+  specfem::kokkos::HostView1d<int> n_read("specfem::mesh::n", nspec);
+  specfem::kokkos::HostView1d<int> kmato_read("specfem::mesh::kmato", nspec);
+  specfem::kokkos::HostView2d<int> knods_read("specfem::mesh::knods", nspec,
+                                              ngnod);
+  specfem::kokkos::HostView1d<int> pml_read("specfem::mesh::pml", nspec);
+  specfem::fortran_IO::fortran_read_records(stream, nspec, n_read, kmato_read,
+                                            knods_read, pml_read);
 
   // Read an assign material values, coordinate numbering, PML association
   for (int ispec = 0; ispec < nspec; ispec++) {
-    // format: #element_id  #material_id #node_id1 #node_id2 #...
-    specfem::fortran_IO::fortran_read_line(stream, &n, &kmato_read, &knods_read,
-                                           &pml_read);
+    const int n = n_read(ispec);
 
     // material association
     if (n < 1 || n > nspec) {
       throw std::runtime_error("Error reading mato properties");
     }
-    this->kmato(n - 1) = kmato_read - 1;
-    this->region_CPML(n - 1) = pml_read;
 
-    // element control node indices (ipgeo)
     for (int i = 0; i < ngnod; i++) {
-      if (knods_read[i] == 0)
+      if (knods_read(ispec, i) == 0)
         throw std::runtime_error("Error reading knods (node_id) values");
-
-      this->knods(i, n - 1) = knods_read[i] - 1;
     }
+
+    if (!store)
+      continue;
+
+    this->kmato(n - 1) = kmato_read(ispec) - 1;
+    this->region_CPML(n - 1) = pml_read(ispec);
+
+    // element control node indices (ipgeo)
+    for (int i = 0; i < ngnod; i++)
+      this->knods(i, n - 1) = knods_read(ispec, i) - 1;
   }
 
+  if (!store)
+    return;
+
   for (int ispec = 0; ispec < nspec; ispec++) {
     int imat = this->kmato(ispec);
     if (imat < 0 || imat >= numat) {
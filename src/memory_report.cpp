@@ -0,0 +1,239 @@
+#include "../include/memory_report.h"
+#include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/specfem_mpi.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Size of an allocation in megabytes
+static double megabytes(const std::size_t bytes) {
+  return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+std::string specfem::memory::print(
+    const std::vector<std::pair<std::string, specfem::memory::usage> > &usages,
+    const specfem::MPI::MPI *mpi) {
+
+  specfem::memory::usage total;
+  std::vector<double> local;
+  for (const auto &[name, usage] : usages) {
+    local.push_back(megabytes(usage.device));
+    local.push_back(megabytes(usage.host));
+    total += usage;
+  }
+  local.push_back(megabytes(total.device));
+  local.push_back(megabytes(total.host));
+
+  const auto largest = mpi->all_reduce(local, specfem::MPI::max);
+
+  std::ostringstream message;
+  message << "Resident memory (largest process, MB):\n"
+          << "------------------------------\n"
+          << std::fixed << std::setprecision(1);
+  for (int i = 0; i <= usages.size(); i++) {
+    const std::string name = (i < usages.size()) ? usages[i].first : "Total";
+    message << "- " << name << " : device = " << largest[2 * i]
+            << ", host = " << largest[2 * i + 1] << "\n";
+  }
+
+  return message.str();
+}
+
+// Bytes allocated by every (subsystem, memory space), current and peak
+// bytes of every memory space, and bytes allocated since tracking started
+struct tracked_allocations {
+  std::mutex mutex;
+  std::map<std::pair<std::string, std::string>, std::int64_t> subsystems;
+  std::map<std::string, std::int64_t> current;
+  std::map<std::string, std::int64_t> peak;
+  std::map<std::string, std::int64_t> allocated;
+};
+
+static tracked_allocations &tracked() {
+  static tracked_allocations instance;
+  return instance;
+}
+
+// Label of a view without its last component
+static std::string subsystem(const char *label) {
+  const std::string name(label);
+  const auto last = name.rfind("::");
+  if (last == std::string::npos)
+    return name.empty() ? "unlabeled" : name;
+  return name.substr(0, last);
+}
+
+static void record(const Kokkos::Tools::SpaceHandle handle,
+                   const char *label, const std::int64_t bytes) {
+  auto &state = tracked();
+  const std::lock_guard<std::mutex> lock(state.mutex);
+  const std::string space(handle.name);
+  state.subsystems[{ subsystem(label), space }] += bytes;
+  auto &current = state.current[space];
+  current += bytes;
+  state.peak[space] = std::max(state.peak[space], current);
+  if (bytes > 0)
+    state.allocated[space] += bytes;
+}
+
+// Kokkos tools callbacks
+static void allocate(const Kokkos::Tools::SpaceHandle handle,
+                     const char *label, const void *,
+                     const std::uint64_t size) {
+  record(handle, label, static_cast<std::int64_t>(size));
+}
+
+static void deallocate(const Kokkos::Tools::SpaceHandle handle,
+                       const char *label, const void *,
+                       const std::uint64_t size) {
+  record(handle, label, -static_cast<std::int64_t>(size));
+}
+
+void specfem::memory::track_allocations() {
+  Kokkos::Tools::Experimental::set_allocate_data_callback(allocate);
+  Kokkos::Tools::Experimental::set_deallocate_data_callback(deallocate);
+}
+
+specfem::memory::usage specfem::memory::tracked_allocated() {
+  auto &state = tracked();
+  const std::lock_guard<std::mutex> lock(state.mutex);
+  specfem::memory::usage usage;
+  for (const auto &[space, bytes] : state.allocated) {
+    if (space == Kokkos::HostSpace::name())
+      usage.host += bytes;
+    else
+      usage.device += bytes;
+  }
+  return usage;
+}
+
+specfem::memory::usage specfem::memory::tracked_current() {
+  auto &state = tracked();
+  const std::lock_guard<std::mutex> lock(state.mutex);
+  specfem::memory::usage usage;
+  for (const auto &[space, bytes] : state.current) {
+    if (bytes <= 0)
+      continue;
+    if (space == Kokkos::HostSpace::name())
+      usage.host += bytes;
+    else
+      usage.device += bytes;
+  }
+  return usage;
+}
+
+std::string specfem::memory::print_tracked(const specfem::MPI::MPI *mpi) {
+
+  auto &state = tracked();
+  std::map<std::pair<std::string, std::string>, std::int64_t> subsystems;
+  std::map<std::string, std::int64_t> peak;
+  {
+    const std::lock_guard<std::mutex> lock(state.mutex);
+    subsystems = state.subsystems;
+    peak = state.peak;
+  }
+
+  // Every process uses the same memory spaces, which are the device and host
+  // spaces on device backends
+  std::vector<std::string> spaces = { specfem::kokkos::DevMemSpace::name() };
+  if (spaces[0] != Kokkos::HostSpace::name())
+    spaces.push_back(Kokkos::HostSpace::name());
+
+  std::vector<double> local;
+  for (const auto &space : spaces)
+    local.push_back(megabytes(std::max<std::int64_t>(peak[space], 0)));
+  const auto largest = mpi->all_reduce(local, specfem::MPI::max);
+
+  std::ostringstream message;
+  message << "Allocated memory (process 0, MB):\n"
+          << "------------------------------\n"
+          << std::fixed << std::setprecision(1);
+  for (const auto &[key, bytes] : subsystems) {
+    if (bytes > 0)
+      message << "- " << key.first << " : " << key.second << " = "
+              << megabytes(bytes) << "\n";
+  }
+  message << "Peak memory (largest process, MB):\n"
+          << "------------------------------\n";
+  for (int ispace = 0; ispace < spaces.size(); ispace++)
+    message << "- " << spaces[ispace] << " : " << largest[ispace] << "\n";
+
+  return message.str();
+}
+
+std::vector<std::pair<std::string, specfem::memory::usage> >
+specfem::memory::estimate(const specfem::memory::problem_size &size) {
+
+  constexpr bool host_backend =
+      Kokkos::SpaceAccessibility<Kokkos::HostSpace,
+                                 specfem::kokkos::DevMemSpace>::accessible;
+
+  // Device views are host memory on host backends, where host mirrors share
+  // the allocation of device views
+  const auto device = [](specfem::memory::usage &usage,
+                         const std::size_t bytes) {
+    if (host_backend)
+      usage.host += bytes;
+    else
+      usage.device += bytes;
+  };
+  const auto mirror = [](specfem::memory::usage &usage,
+                         const std::size_t bytes) {
+    if (!host_backend)
+      usage.host += bytes;
+  };
+
+  const std::size_t real = sizeof(type_real);
+  const std::size_t nspec = size.nspec;
+  const std::size_t ngll = size.ngllz * size.ngllx;
+  const std::size_t npoints = nspec * ngll;
+  const std::size_t side = std::ceil(std::sqrt(static_cast<double>(nspec)));
+  const std::size_t nglob = nspec * (size.ngllz - 1) * (size.ngllx - 1) +
+                            side * (size.ngllz + size.ngllx - 2) + 1;
+  const std::size_t ninterpolants = size.ngllz + size.ngllx;
+
+  specfem::memory::usage numbering, derivatives, properties, sources,
+      receivers, domain;
+
+  // ibool, the host numbering stays resident for the writers
+  device(numbering, npoints * sizeof(int));
+  mirror(numbering, npoints * sizeof(int));
+  numbering.host += ndim * nglob * real;
+
+  // xix, xiz, gammax, gammaz, jacobian and the records of affine elements
+  device(derivatives, 5 * npoints * real + nspec * (sizeof(int) + 5 * real));
+
+  // rho, mu, lambdaplus2mu and the element types
+  device(properties, 3 * npoints * real + nspec * sizeof(int));
+
+  // Source arrays, interpolants and source time functions
+  device(sources, size.nsources * (ndim * ngll + ninterpolants + ndim) * real);
+
+  // Seismogram buffer and its host copy, interpolants and rotations
+  const std::size_t nseismogram = static_cast<std::size_t>(
+                                      size.nseismogram_steps) *
+                                  size.nseismogram_types * size.nreceivers *
+                                  ndim * real;
+  device(receivers, nseismogram + size.nreceivers * (ninterpolants + 2) * real);
+  mirror(receivers, nseismogram);
+
+  // field, field_dot, field_dot_dot, rmass_inverse and the domain elements
+  device(domain, 3 * nglob * size.ncomponents * real + nglob * real +
+                     nspec * sizeof(int));
+
+  return { { "Global numbering", numbering },
+           { "Partial derivatives", derivatives },
+           { "Material properties", properties },
+           { "Sources", sources },
+           { "Receivers", receivers },
+           { "Domain", domain } };
+}
@@ -9,36 +9,53 @@
 #include "../include/mpi_interfaces.h"
 #include "../include/read_material_properties.h"
 #include "../include/read_mesh_database.h"
+#include "../include/reordering.h"
 #include "../include/specfem_mpi.h"
 #include <Kokkos_Core.hpp>
 #include <algorithm>
+#include <array>
 #include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
 #include <vector>
 
 specfem::mesh::mesh(const std::string filename,
                     std::vector<specfem::material *> &materials,
-                    const specfem::MPI::MPI *mpi) {
+                    const specfem::MPI::MPI *mpi, const bool node_shared) {
 
-  std::ifstream stream;
-  stream.open(filename);
-
-  if (!stream.is_open()) {
-    throw std::runtime_error("Could not open database file");
-  }
+  // The database is read with a single bulk read and parsed from memory
+  std::istringstream stream(
+      IO::fortran_database::read_database_file(filename, mpi));
 
   try {
-    auto [nspec, npgeo, nproc] =
+    auto [nspec, npgeo, nproc, axisym] =
         IO::fortran_database::read_mesh_database_header(stream, mpi);
     this->nspec = nspec;
     this->npgeo = npgeo;
     this->nproc = nproc;
+    this->axisym = axisym;
   } catch (std::runtime_error &e) {
     throw;
   }
 
   try {
-    this->coorg =
-        IO::fortran_database::read_coorg_elements(stream, this->npgeo, mpi);
+    if (node_shared) {
+      auto window = std::make_shared<specfem::MPI::shared_window>(
+          sizeof(type_real) * ndim * this->npgeo, mpi);
+      this->coorg = specfem::kokkos::HostView2d<type_real>(
+          static_cast<type_real *>(window->data()), ndim, this->npgeo);
+      IO::fortran_database::read_coorg_elements(stream, this->npgeo,
+                                                this->coorg, window->owner(),
+                                                mpi);
+      window->sync();
+      this->node_storage.push_back(window);
+    } else {
+      this->coorg =
+          IO::fortran_database::read_coorg_elements(stream, this->npgeo, mpi);
+    }
   } catch (std::runtime_error &e) {
     throw;
   }
@@ -49,11 +66,15 @@ specfem::mesh::mesh(const std::string filename,
     throw;
   }
 
-  int nspec_all = mpi->reduce(this->parameters.nspec, specfem::MPI::sum);
-  int nelem_acforcing_all =
-      mpi->reduce(this->parameters.nelem_acforcing, specfem::MPI::sum);
-  int nelem_acoustic_surface_all =
-      mpi->reduce(this->parameters.nelem_acoustic_surface, specfem::MPI::sum);
+  // Element counts are reduced with a single collective
+  specfem::kokkos::HostView1d<int> nelem_all("specfem::mesh::nelem_all", 3);
+  nelem_all(0) = this->parameters.nspec;
+  nelem_all(1) = this->parameters.nelem_acforcing;
+  nelem_all(2) = this->parameters.nelem_acoustic_surface;
+  mpi->reduce(nelem_all, specfem::MPI::sum);
+  const int nspec_all = nelem_all(0);
+  const int nelem_acforcing_all = nelem_all(1);
+  const int nelem_acoustic_surface_all = nelem_all(2);
 
   // std::ostringstream message;
   // message << "Number of spectral elements . . . . . . . . . .(nspec) = "
@@ -77,7 +98,8 @@ specfem::mesh::mesh(const std::string filename,
   // mpi->cout(message.str());
 
   try {
-    auto [n_sls, attenuation_f0_reference, read_velocities_at_f0] =
+    std::tie(this->n_sls, this->attenuation_f0_reference,
+             this->read_velocities_at_f0) =
         IO::fortran_database::read_mesh_database_attenuation(stream, mpi);
   } catch (std::runtime_error &e) {
     throw;
@@ -91,9 +113,33 @@ specfem::mesh::mesh(const std::string filename,
   }
 
   try {
-    this->material_ind = specfem::materials::material_ind(
-        stream, this->parameters.ngnod, this->nspec, this->parameters.numat,
-        mpi);
+    if (node_shared) {
+      // region_CPML, kmato and knods are stored contiguously
+      const int ngnod = this->parameters.ngnod;
+      auto window = std::make_shared<specfem::MPI::shared_window>(
+          sizeof(int) * (2 + ngnod) * this->nspec, mpi);
+      int *data = static_cast<int *>(window->data());
+      specfem::materials::material_ind storage;
+      storage.region_CPML =
+          specfem::kokkos::HostView1d<int>(data, this->nspec);
+      storage.kmato =
+          specfem::kokkos::HostView1d<int>(data + this->nspec, this->nspec);
+      storage.knods = specfem::kokkos::HostView2d<int>(
+          data + 2 * this->nspec, ngnod, this->nspec);
+      if (window->owner()) {
+        for (int ispec = 0; ispec < this->nspec; ispec++)
+          storage.kmato(ispec) = -1;
+      }
+      this->material_ind = specfem::materials::material_ind(
+          stream, ngnod, this->nspec, this->parameters.numat, storage,
+          window->owner(), mpi);
+      window->sync();
+      this->node_storage.push_back(window);
+    } else {
+      this->material_ind = specfem::materials::material_ind(
+          stream, this->parameters.ngnod, this->nspec, this->parameters.numat,
+          mpi);
+    }
   } catch (std::runtime_error &e) {
     throw;
   }
@@ -126,7 +172,7 @@ specfem::mesh::mesh(const std::string filename,
   }
 
   try {
-    IO::fortran_database::read_mesh_database_coupled(
+    this->fluid_solid_edges = IO::fortran_database::read_mesh_database_coupled(
         stream, this->parameters.num_fluid_solid_edges,
         this->parameters.num_fluid_poro_edges,
         this->parameters.num_solid_poro_edges, mpi);
@@ -154,7 +200,325 @@ specfem::mesh::mesh(const std::string filename,
                              "anything written after axial elements?");
   }
 
-  stream.close();
+  return;
+}
+
+void specfem::mesh::partition(const std::vector<int> &element_partition,
+                              const int rank) {
+
+  if (this->nproc > 1 || this->interface.ninterfaces > 0)
+    throw std::runtime_error("Only serial databases can be partitioned");
+
+  const int ngnod = this->material_ind.knods.extent(0);
+  const auto knods = this->material_ind.knods;
+  const int nparts =
+      *std::max_element(element_partition.begin(), element_partition.end()) +
+      1;
+
+  // local[ispec] is the index of element ispec in this partition, -1 if
+  // ispec belongs to another partition
+  std::vector<int> local(this->nspec, -1);
+  std::vector<int> elements;
+  for (int ispec = 0; ispec < this->nspec; ispec++) {
+    if (element_partition[ispec] == rank) {
+      local[ispec] = elements.size();
+      elements.push_back(ispec);
+    }
+  }
+  const int nspec_local = elements.size();
+
+  if (nspec_local == 0) {
+    std::ostringstream message;
+    message << "Partition " << rank << " doesn't contain any element";
+    throw std::runtime_error(message.str());
+  }
+
+  // Control nodes used by this partition keep their relative order
+  std::vector<int> node(this->npgeo, -1);
+  for (const int ispec : elements) {
+    for (int in = 0; in < ngnod; in++)
+      node[knods(in, ispec)] = 0;
+  }
+  int npgeo_local = 0;
+  for (int ipgeo = 0; ipgeo < this->npgeo; ipgeo++) {
+    if (node[ipgeo] == 0)
+      node[ipgeo] = npgeo_local++;
+  }
+
+  // Elements sharing every corner control node
+  std::vector<std::vector<int> > node_elements(this->npgeo);
+  for (int ispec = 0; ispec < this->nspec; ispec++) {
+    for (int in = 0; in < 4; in++)
+      node_elements[knods(in, ispec)].push_back(ispec);
+  }
+
+  // Interface entries (element, type, node 1, node 2) shared with every
+  // other partition. Element and node ids are 1-based as in databases
+  std::map<int, std::vector<std::array<int, 4> > > entries;
+  for (const int ispec : elements) {
+    // Corners already covered by an edge shared with a partition
+    std::set<std::pair<int, int> > covered;
+    for (int iedge = 0; iedge < 4; iedge++) {
+      const int n1 = knods(iedge, ispec);
+      const int n2 = knods((iedge + 1) % 4, ispec);
+      std::set<int> neighbors;
+      for (const int jspec : node_elements[n1]) {
+        const auto &n2_elements = node_elements[n2];
+        if (element_partition[jspec] != rank &&
+            std::find(n2_elements.begin(), n2_elements.end(), jspec) !=
+                n2_elements.end())
+          neighbors.insert(element_partition[jspec]);
+      }
+      for (const int ipart : neighbors) {
+        entries[ipart].push_back(
+            { local[ispec] + 1, 2, node[n1] + 1, node[n2] + 1 });
+        covered.insert({ ipart, n1 });
+        covered.insert({ ipart, n2 });
+      }
+    }
+
+    for (int in = 0; in < 4; in++) {
+      const int n = knods(in, ispec);
+      for (const int jspec : node_elements[n]) {
+        const int ipart = element_partition[jspec];
+        if (ipart != rank && covered.insert({ ipart, n }).second)
+          entries[ipart].push_back({ local[ispec] + 1, 1, node[n] + 1, -1 });
+      }
+    }
+  }
+
+  int max_interface_size = 0;
+  for (const auto &[ipart, part_entries] : entries)
+    max_interface_size =
+        std::max(max_interface_size, static_cast<int>(part_entries.size()));
+
+  specfem::interfaces::interface interface(entries.size(),
+                                           max_interface_size);
+  int iinterface = 0;
+  for (const auto &[ipart, part_entries] : entries) {
+    interface.my_neighbors(iinterface) = ipart;
+    interface.my_nelmnts_neighbors(iinterface) = part_entries.size();
+    for (int ie = 0; ie < part_entries.size(); ie++) {
+      for (int k = 0; k < 4; k++)
+        interface.my_interfaces(iinterface, ie, k) = part_entries[ie][k];
+    }
+    iinterface++;
+  }
+
+  // Control nodes and per element arrays
+  specfem::kokkos::HostView2d<type_real> coorg("specfem::mesh::coorg", ndim,
+                                               npgeo_local);
+  for (int ipgeo = 0; ipgeo < this->npgeo; ipgeo++) {
+    if (node[ipgeo] >= 0) {
+      coorg(0, node[ipgeo]) = this->coorg(0, ipgeo);
+      coorg(1, node[ipgeo]) = this->coorg(1, ipgeo);
+    }
+  }
+
+  specfem::materials::material_ind material_ind(nspec_local, ngnod);
+  specfem::kokkos::HostView1d<bool> is_on_the_axis(
+      "specfem::mesh::axial_element::is_on_the_axis", nspec_local);
+  int nelem_on_the_axis = 0;
+  for (int ilocal = 0; ilocal < nspec_local; ilocal++) {
+    const int ispec = elements[ilocal];
+    material_ind.kmato(ilocal) = this->material_ind.kmato(ispec);
+    material_ind.region_CPML(ilocal) = this->material_ind.region_CPML(ispec);
+    for (int in = 0; in < ngnod; in++)
+      material_ind.knods(in, ilocal) = node[knods(in, ispec)];
+    is_on_the_axis(ilocal) = this->axial_nodes.is_on_the_axis(ispec);
+    if (is_on_the_axis(ilocal))
+      nelem_on_the_axis++;
+  }
+
+  // Absorbing boundary entries. Element indices stored as 0-based values
+  std::vector<int> kept;
+  for (int inum = 0; inum < this->parameters.nelemabs; inum++) {
+    if (local[this->abs_boundary.numabs(inum)] >= 0)
+      kept.push_back(inum);
+  }
+  const int nelemabs = kept.size();
+  specfem::boundaries::absorbing_boundary abs_boundary(nelemabs);
+  for (int inum = 0; inum < nelemabs; inum++) {
+    const int iold = kept[inum];
+    const auto &old = this->abs_boundary;
+    abs_boundary.numabs(inum) = local[old.numabs(iold)];
+    abs_boundary.abs_boundary_type(inum) = old.abs_boundary_type(iold);
+    abs_boundary.ibegin_edge1(inum) = old.ibegin_edge1(iold);
+    abs_boundary.ibegin_edge2(inum) = old.ibegin_edge2(iold);
+    abs_boundary.ibegin_edge3(inum) = old.ibegin_edge3(iold);
+    abs_boundary.ibegin_edge4(inum) = old.ibegin_edge4(iold);
+    abs_boundary.iend_edge1(inum) = old.iend_edge1(iold);
+    abs_boundary.iend_edge2(inum) = old.iend_edge2(iold);
+    abs_boundary.iend_edge3(inum) = old.iend_edge3(iold);
+    abs_boundary.iend_edge4(inum) = old.iend_edge4(iold);
+    for (int i = 0; i < 4; i++) {
+      abs_boundary.codeabs(inum, i) = old.codeabs(iold, i);
+      abs_boundary.codeabscorner(inum, i) = old.codeabscorner(iold, i);
+    }
+  }
+  specfem::boundaries::calculate_ib(
+      abs_boundary.codeabs, abs_boundary.ib_bottom, abs_boundary.ib_top,
+      abs_boundary.ib_left, abs_boundary.ib_right, nelemabs);
+
+  // Acoustic forcing entries. Element indices stored as 0-based values
+  kept.clear();
+  for (int inum = 0; inum < this->parameters.nelem_acforcing; inum++) {
+    if (local[this->acforcing_boundary.numacforcing(inum)] >= 0)
+      kept.push_back(inum);
+  }
+  const int nelem_acforcing = kept.size();
+  specfem::boundaries::forcing_boundary acforcing_boundary(nelem_acforcing);
+  for (int inum = 0; inum < nelem_acforcing; inum++) {
+    const int iold = kept[inum];
+    const auto &old = this->acforcing_boundary;
+    acforcing_boundary.numacforcing(inum) = local[old.numacforcing(iold)];
+    acforcing_boundary.typeacforcing(inum) = old.typeacforcing(iold);
+    acforcing_boundary.ibegin_edge1(inum) = old.ibegin_edge1(iold);
+    acforcing_boundary.ibegin_edge2(inum) = old.ibegin_edge2(iold);
+    acforcing_boundary.ibegin_edge3(inum) = old.ibegin_edge3(iold);
+    acforcing_boundary.ibegin_edge4(inum) = old.ibegin_edge4(iold);
+    acforcing_boundary.iend_edge1(inum) = old.iend_edge1(iold);
+    acforcing_boundary.iend_edge2(inum) = old.iend_edge2(iold);
+    acforcing_boundary.iend_edge3(inum) = old.iend_edge3(iold);
+    acforcing_boundary.iend_edge4(inum) = old.iend_edge4(iold);
+    for (int i = 0; i < 4; i++)
+      acforcing_boundary.codeacforcing(inum, i) = old.codeacforcing(iold, i);
+  }
+  specfem::boundaries::calculate_ib(
+      acforcing_boundary.codeacforcing, acforcing_boundary.ib_bottom,
+      acforcing_boundary.ib_top, acforcing_boundary.ib_left,
+      acforcing_boundary.ib_right, nelem_acforcing);
+
+  // Acoustic free surface entries. Element and node indices stored as
+  // 1-based values read from database
+  kept.clear();
+  for (int inum = 0; inum < this->parameters.nelem_acoustic_surface; inum++) {
+    if (local[this->acfree_surface.numacfree_surface(inum) - 1] >= 0)
+      kept.push_back(inum);
+  }
+  const int nelem_acoustic_surface = kept.size();
+  specfem::surfaces::acoustic_free_surface acfree_surface(
+      nelem_acoustic_surface);
+  for (int inum = 0; inum < nelem_acoustic_surface; inum++) {
+    const int iold = kept[inum];
+    const auto &old = this->acfree_surface;
+    acfree_surface.numacfree_surface(inum) =
+        local[old.numacfree_surface(iold) - 1] + 1;
+    acfree_surface.typeacfree_surface(inum) = old.typeacfree_surface(iold);
+    acfree_surface.e1(inum) = node[old.e1(iold) - 1] + 1;
+    acfree_surface.e2(inum) = node[old.e2(iold) - 1] + 1;
+    acfree_surface.ixmin(inum) = old.ixmin(iold);
+    acfree_surface.ixmax(inum) = old.ixmax(iold);
+    acfree_surface.izmin(inum) = old.izmin(iold);
+    acfree_surface.izmax(inum) = old.izmax(iold);
+  }
+
+  // Fluid-solid edges with both elements in the partition. Edges split
+  // between partitions would need coupling through MPI interfaces
+  kept.clear();
+  for (int inum = 0; inum < this->fluid_solid_edges.nedges(); inum++) {
+    if (local[this->fluid_solid_edges.ispec_acoustic(inum)] >= 0 &&
+        local[this->fluid_solid_edges.ispec_elastic(inum)] >= 0)
+      kept.push_back(inum);
+  }
+  const int num_fluid_solid_edges = kept.size();
+  specfem::surfaces::fluid_solid_edges fluid_solid_edges(
+      num_fluid_solid_edges);
+  for (int inum = 0; inum < num_fluid_solid_edges; inum++) {
+    const int iold = kept[inum];
+    fluid_solid_edges.ispec_acoustic(inum) =
+        local[this->fluid_solid_edges.ispec_acoustic(iold)];
+    fluid_solid_edges.ispec_elastic(inum) =
+        local[this->fluid_solid_edges.ispec_elastic(iold)];
+  }
+
+  this->nspec = nspec_local;
+  this->serial_ispec = elements;
+  this->npgeo = npgeo_local;
+  this->nproc = nparts;
+  this->coorg = coorg;
+  this->material_ind = material_ind;
+  this->axial_nodes.is_on_the_axis = is_on_the_axis;
+  this->interface = interface;
+  this->abs_boundary = abs_boundary;
+  this->acforcing_boundary = acforcing_boundary;
+  this->acfree_surface = acfree_surface;
+  this->fluid_solid_edges = fluid_solid_edges;
+  this->parameters.nspec = nspec_local;
+  this->parameters.nelemabs = nelemabs;
+  this->parameters.nelem_acforcing = nelem_acforcing;
+  this->parameters.nelem_acoustic_surface = nelem_acoustic_surface;
+  this->parameters.num_fluid_solid_edges = num_fluid_solid_edges;
+  this->parameters.nelem_on_the_axis = nelem_on_the_axis;
+
+  // Serial arrays aren't referenced anymore
+  this->node_storage.clear();
+
+  return;
+}
+
+void specfem::mesh::reorder_elements(const specfem::reordering::type ordering) {
+
+  if (ordering == specfem::reordering::none)
+    return;
+
+  const std::vector<int> permutation = specfem::reordering::element_permutation(
+      this->coorg, this->material_ind.knods, ordering);
+
+  // inverse[iold] is the new index of element iold
+  std::vector<int> inverse(this->nspec);
+  for (int inew = 0; inew < this->nspec; inew++)
+    inverse[permutation[inew]] = inew;
+
+  // Per element arrays
+  const int ngnod = this->material_ind.knods.extent(0);
+  specfem::materials::material_ind material_ind(this->nspec, ngnod);
+  specfem::kokkos::HostView1d<bool> is_on_the_axis(
+      "specfem::mesh::axial_element::is_on_the_axis", this->nspec);
+  for (int inew = 0; inew < this->nspec; inew++) {
+    const int iold = permutation[inew];
+    material_ind.kmato(inew) = this->material_ind.kmato(iold);
+    material_ind.region_CPML(inew) = this->material_ind.region_CPML(iold);
+    for (int in = 0; in < ngnod; in++)
+      material_ind.knods(in, inew) = this->material_ind.knods(in, iold);
+    is_on_the_axis(inew) = this->axial_nodes.is_on_the_axis(iold);
+  }
+  this->material_ind = material_ind;
+  this->axial_nodes.is_on_the_axis = is_on_the_axis;
+
+  if (!this->serial_ispec.empty()) {
+    std::vector<int> serial_ispec(this->nspec);
+    for (int inew = 0; inew < this->nspec; inew++)
+      serial_ispec[inew] = this->serial_ispec[permutation[inew]];
+    this->serial_ispec = serial_ispec;
+  }
+
+  // Element indices stored as 0-based values
+  for (int inum = 0; inum < this->parameters.nelemabs; inum++)
+    this->abs_boundary.numabs(inum) = inverse[this->abs_boundary.numabs(inum)];
+
+  for (int inum = 0; inum < this->parameters.nelem_acforcing; inum++)
+    this->acforcing_boundary.numacforcing(inum) =
+        inverse[this->acforcing_boundary.numacforcing(inum)];
+
+  // Element indices stored as 1-based values read from database
+  for (int inum = 0; inum < this->parameters.nelem_acoustic_surface; inum++)
+    this->acfree_surface.numacfree_surface(inum) =
+        inverse[this->acfree_surface.numacfree_surface(inum) - 1] + 1;
+
+  for (int inum = 0; inum < this->fluid_solid_edges.nedges(); inum++) {
+    this->fluid_solid_edges.ispec_acoustic(inum) =
+        inverse[this->fluid_solid_edges.ispec_acoustic(inum)];
+    this->fluid_solid_edges.ispec_elastic(inum) =
+        inverse[this->fluid_solid_edges.ispec_elastic(inum)];
+  }
+
+  for (int i = 0; i < this->interface.ninterfaces; i++) {
+    for (int ie = 0; ie < this->interface.my_nelmnts_neighbors(i); ie++) {
+      this->interface.my_interfaces(i, ie, 0) =
+          inverse[this->interface.my_interfaces(i, ie, 0) - 1] + 1;
+    }
+  }
 
   return;
 }
@@ -1,7 +1,7 @@
 #include "../include/mesh_properties.h"
 #include "../include/fortran_IO.h"
 
-specfem::properties::properties(std::ifstream &stream,
+specfem::properties::properties(std::istream &stream,
                                 const specfem::MPI::MPI *mpi) {
   // ---------------------------------------------------------------------
   // reading mesh properties
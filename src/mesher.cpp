@@ -0,0 +1,273 @@
+#include "../include/mesher.h"
+#include "../include/boundaries.h"
+#include "../include/config.h"
+#include "../include/elements.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/material.h"
+#include "../include/material_indic.h"
+#include "../include/mesh.h"
+#include "../include/mesh_properties.h"
+#include "../include/mpi_interfaces.h"
+#include "../include/specfem_mpi.h"
+#include "../include/surfaces.h"
+#include "../include/utils.h"
+#include <array>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+type_real specfem::mesher::interface_height(
+    const std::vector<std::array<type_real, 2> > &top, const type_real x) {
+
+  if (x <= top.front()[0])
+    return top.front()[1];
+
+  for (int i = 1; i < top.size(); i++) {
+    if (x <= top[i][0]) {
+      const type_real w = (x - top[i - 1][0]) / (top[i][0] - top[i - 1][0]);
+      return (1.0 - w) * top[i - 1][1] + w * top[i][1];
+    }
+  }
+
+  return top.back()[1];
+}
+
+specfem::mesh
+specfem::mesher::generate(const specfem::mesher::layered_model &model,
+                          std::vector<specfem::material *> &materials,
+                          const specfem::MPI::MPI *mpi) {
+
+  const int nx = model.nx;
+  const int nlayers = model.layers.size();
+
+  if (model.ngnod != 4 && model.ngnod != 9)
+    throw std::runtime_error("Internal mesh elements need 4 or 9 nodes");
+  if (nx < 1 || !(model.xmax > model.xmin))
+    throw std::runtime_error("Internal mesh needs xmax > xmin and nx >= 1");
+  if (model.axisymmetric && model.xmin != 0.0)
+    throw std::runtime_error(
+        "Axisymmetric internal meshes need their axis at xmin = 0");
+  if (model.axisymmetric && model.absorbing[3])
+    throw std::runtime_error(
+        "The axis of axisymmetric internal meshes can't be absorbing");
+  if (nlayers == 0)
+    throw std::runtime_error("Internal mesh doesn't define any layer");
+
+  // First element row of every layer
+  std::vector<int> first_row(nlayers + 1, 0);
+  for (int ilayer = 0; ilayer < nlayers; ilayer++) {
+    const auto &layer = model.layers[ilayer];
+    if (layer.nz < 1 || layer.top.empty()) {
+      std::ostringstream message;
+      message << "Layer " << ilayer << " of the internal mesh needs nz >= 1 "
+              << "and a top interface";
+      throw std::runtime_error(message.str());
+    }
+    for (int i = 1; i < layer.top.size(); i++) {
+      if (!(layer.top[i][0] > layer.top[i - 1][0])) {
+        std::ostringstream message;
+        message << "Points of the top interface of layer " << ilayer
+                << " aren't sorted by increasing x";
+        throw std::runtime_error(message.str());
+      }
+    }
+    first_row[ilayer + 1] = first_row[ilayer] + layer.nz;
+  }
+  const int nz = first_row[nlayers];
+
+  // Midside and centre nodes of 9 node elements double the node grid
+  const int r = (model.ngnod == 9) ? 2 : 1;
+  const int nnodes_x = r * nx + 1;
+  const int nnodes_z = r * nz + 1;
+
+  specfem::mesh mesh;
+  mesh.nspec = nx * nz;
+  mesh.npgeo = nnodes_x * nnodes_z;
+  mesh.nproc = 1;
+
+  // Control nodes are numbered row by row from the bottom left corner
+  mesh.coorg = specfem::kokkos::HostView2d<type_real>("specfem::mesh::coorg",
+                                                      ndim, mesh.npgeo);
+  for (int ix = 0; ix < nnodes_x; ix++) {
+    const type_real x =
+        model.xmin + (model.xmax - model.xmin) * ix / (nnodes_x - 1);
+    type_real bottom = model.zmin;
+    for (int ilayer = 0; ilayer < nlayers; ilayer++) {
+      const type_real top =
+          specfem::mesher::interface_height(model.layers[ilayer].top, x);
+      if (!(top > bottom)) {
+        std::ostringstream message;
+        message << "Top interface of layer " << ilayer
+                << " isn't above its bottom interface at x = " << x;
+        throw std::runtime_error(message.str());
+      }
+      const int iz0 = r * first_row[ilayer];
+      const int nrows = r * model.layers[ilayer].nz;
+      for (int iz = 0; iz <= nrows; iz++) {
+        const int ipgeo = (iz0 + iz) * nnodes_x + ix;
+        mesh.coorg(0, ipgeo) = x;
+        mesh.coorg(1, ipgeo) = bottom + (top - bottom) * iz / nrows;
+      }
+      bottom = top;
+    }
+  }
+
+  // Corners are numbered counterclockwise from the bottom left corner,
+  // followed by the bottom, right, top and left midside nodes and the centre
+  // node
+  const int offsets[9][2] = { { 0, 0 }, { r, 0 }, { r, r }, { 0, r }, { 1, 0 },
+                              { r, 1 }, { 1, r }, { 0, 1 }, { 1, 1 } };
+
+  mesh.material_ind =
+      specfem::materials::material_ind(mesh.nspec, model.ngnod);
+  for (int ilayer = 0; ilayer < nlayers; ilayer++) {
+    for (int iz = first_row[ilayer]; iz < first_row[ilayer + 1]; iz++) {
+      for (int ix = 0; ix < nx; ix++) {
+        const int ispec = iz * nx + ix;
+        mesh.material_ind.kmato(ispec) = ilayer;
+        mesh.material_ind.region_CPML(ispec) = 0;
+        for (int in = 0; in < model.ngnod; in++)
+          mesh.material_ind.knods(in, ispec) =
+              (r * iz + offsets[in][1]) * nnodes_x + r * ix + offsets[in][0];
+      }
+    }
+  }
+
+  // Absorbing edges. Sides are numbered bottom, right, top and left
+  std::vector<std::array<int, 2> > edges;
+  for (int ix = 0; ix < nx; ix++) {
+    if (model.absorbing[0])
+      edges.push_back({ ix, 0 });
+    if (model.absorbing[2])
+      edges.push_back({ (nz - 1) * nx + ix, 2 });
+  }
+  for (int iz = 0; iz < nz; iz++) {
+    if (model.absorbing[1])
+      edges.push_back({ iz * nx + nx - 1, 1 });
+    if (model.absorbing[3])
+      edges.push_back({ iz * nx, 3 });
+  }
+
+  const int nelemabs = edges.size();
+  mesh.abs_boundary = specfem::boundaries::absorbing_boundary(nelemabs);
+  for (int inum = 0; inum < nelemabs; inum++) {
+    const int ispec = edges[inum][0];
+    const int iside = edges[inum][1];
+    auto &abs_boundary = mesh.abs_boundary;
+    abs_boundary.numabs(inum) = ispec;
+    abs_boundary.abs_boundary_type(inum) = iside + 1;
+    // Full edges are used when edge limits aren't set
+    abs_boundary.ibegin_edge1(inum) = 0;
+    abs_boundary.ibegin_edge2(inum) = 0;
+    abs_boundary.ibegin_edge3(inum) = 0;
+    abs_boundary.ibegin_edge4(inum) = 0;
+    abs_boundary.iend_edge1(inum) = 0;
+    abs_boundary.iend_edge2(inum) = 0;
+    abs_boundary.iend_edge3(inum) = 0;
+    abs_boundary.iend_edge4(inum) = 0;
+    for (int i = 0; i < 4; i++) {
+      abs_boundary.codeabs(inum, i) = (i == iside);
+      abs_boundary.codeabscorner(inum, i) = false;
+    }
+
+    // Bottom and top edges of corner elements flag the corner
+    const bool left = (ispec % nx == 0) && model.absorbing[3];
+    const bool right = (ispec % nx == nx - 1) && model.absorbing[1];
+    if (iside == 0 || iside == 2) {
+      const int offset = (iside == 0) ? 0 : 2;
+      abs_boundary.codeabscorner(inum, offset) = left;
+      abs_boundary.codeabscorner(inum, offset + 1) = right;
+    }
+  }
+  specfem::boundaries::calculate_ib(
+      mesh.abs_boundary.codeabs, mesh.abs_boundary.ib_bottom,
+      mesh.abs_boundary.ib_top, mesh.abs_boundary.ib_left,
+      mesh.abs_boundary.ib_right, nelemabs);
+
+  // Fluid-solid edges between the top row of a layer and the bottom row of
+  // the next layer
+  std::vector<std::array<int, 2> > coupled;
+  for (int ilayer = 0; ilayer < nlayers - 1; ilayer++) {
+    const bool acoustic_below = (model.layers[ilayer].vs == 0.0);
+    const bool acoustic_above = (model.layers[ilayer + 1].vs == 0.0);
+    if (acoustic_below == acoustic_above)
+      continue;
+    const int iz = first_row[ilayer + 1];
+    for (int ix = 0; ix < nx; ix++) {
+      const int below = (iz - 1) * nx + ix;
+      const int above = iz * nx + ix;
+      if (acoustic_below)
+        coupled.push_back({ below, above });
+      else
+        coupled.push_back({ above, below });
+    }
+  }
+  mesh.fluid_solid_edges = specfem::surfaces::fluid_solid_edges(coupled.size());
+  for (int inum = 0; inum < coupled.size(); inum++) {
+    mesh.fluid_solid_edges.ispec_acoustic(inum) = coupled[inum][0];
+    mesh.fluid_solid_edges.ispec_elastic(inum) = coupled[inum][1];
+  }
+
+  mesh.interface = specfem::interfaces::interface(0, 0);
+  mesh.acforcing_boundary = specfem::boundaries::forcing_boundary(0);
+  mesh.acfree_surface = specfem::surfaces::acoustic_free_surface(0);
+  mesh.tangential_nodes.force_normal_to_surface = false;
+  mesh.tangential_nodes.rec_normal_to_surface = false;
+  // Elements of the first column are on the axis of axisymmetric models
+  mesh.axisym = model.axisymmetric;
+  mesh.axial_nodes = specfem::elements::axial_elements(mesh.nspec);
+  int nelem_on_the_axis = 0;
+  if (model.axisymmetric) {
+    for (int ispec = 0; ispec < mesh.nspec; ispec += nx) {
+      mesh.axial_nodes.is_on_the_axis(ispec) = true;
+      nelem_on_the_axis++;
+    }
+  }
+
+  mesh.parameters.numat = nlayers;
+  mesh.parameters.ngnod = model.ngnod;
+  mesh.parameters.nspec = mesh.nspec;
+  mesh.parameters.pointsdisp = 6;
+  mesh.parameters.nelemabs = nelemabs;
+  mesh.parameters.nelem_acforcing = 0;
+  mesh.parameters.nelem_acoustic_surface = 0;
+  mesh.parameters.num_fluid_solid_edges = coupled.size();
+  mesh.parameters.num_fluid_poro_edges = 0;
+  mesh.parameters.num_solid_poro_edges = 0;
+  mesh.parameters.nnodes_tangential_curve = 0;
+  mesh.parameters.nelem_on_the_axis = nelem_on_the_axis;
+  mesh.parameters.plot_lowerleft_corner_only = false;
+
+  // Materials are created as if they were read from a database
+  std::ostringstream message;
+  message << "Material systems:\n"
+          << "------------------------------";
+  mpi->cout(message.str());
+
+  materials.resize(nlayers);
+  for (int ilayer = 0; ilayer < nlayers; ilayer++) {
+    const auto &layer = model.layers[ilayer];
+    specfem::utilities::input_holder holder{};
+    holder.n = ilayer + 1;
+    holder.indic = 1;
+    holder.val0 = layer.rho;
+    holder.val1 = layer.vp;
+    holder.val2 = layer.vs;
+    holder.val5 = layer.Qkappa;
+    holder.val6 = layer.Qmu;
+    if (layer.vs == 0.0) {
+      specfem::acoustic_material *acoustic_holder =
+          new specfem::acoustic_material();
+      acoustic_holder->assign(holder);
+      materials[ilayer] = acoustic_holder;
+    } else {
+      specfem::elastic_material *elastic_holder =
+          new specfem::elastic_material();
+      elastic_holder->assign(holder);
+      materials[ilayer] = elastic_holder;
+    }
+    mpi->cout(materials[ilayer]->print());
+  }
+
+  return mesh;
+}
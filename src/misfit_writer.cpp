@@ -0,0 +1,345 @@
+#include "../include/misfit_writer.h"
+#include "../include/compute.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/receiver.h"
+#include "../include/specfem_mpi.h"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Extension of the files of seismograms of type stype
+std::string extension(const specfem::seismogram::type stype) {
+  switch (stype) {
+  case specfem::seismogram::displacement:
+    return "d";
+  case specfem::seismogram::velocity:
+    return "v";
+  case specfem::seismogram::acceleration:
+    return "a";
+  default:
+    std::ostringstream message;
+    message << "seismogram type " << stype << " has not been implemented yet.";
+    throw std::runtime_error(message.str());
+  }
+}
+
+// Read the first nsamples values of the time value lines of filename into
+// column (irec, icomp) of observed. Times need to match the samples of the
+// seismograms
+void read_trace(const std::string &filename, const int irec, const int icomp,
+                const type_real sample_dt, const type_real t0,
+                const specfem::kokkos::HostMirror3d<type_real> observed) {
+
+  std::ifstream stream(filename);
+  const int nsamples = observed.extent(0);
+  double time, value;
+  int isample = 0;
+  while (isample < nsamples && stream >> time >> value) {
+    const double expected = t0 + static_cast<double>(isample) * sample_dt;
+    if (std::abs(time - expected) >
+        1e-2 * sample_dt + 1e-5 * std::abs(expected)) {
+      std::ostringstream message;
+      message << "Sample " << isample << " of observed trace " << filename
+              << " is recorded at " << time << " s instead of " << expected
+              << " s";
+      throw std::runtime_error(message.str());
+    }
+    observed(isample, irec, icomp) = value;
+    isample++;
+  }
+
+  if (isample < nsamples) {
+    std::ostringstream message;
+    message << "Observed trace " << filename << " stores " << isample
+            << " samples, the seismograms " << nsamples;
+    throw std::runtime_error(message.str());
+  }
+}
+
+} // namespace
+
+specfem::writer::misfit::misfit(
+    const specfem::receivers::receiver_set &receivers,
+    const specfem::compute::receivers *compute_receivers,
+    const specfem::misfit::type measurement,
+    const std::string observed_folder, const std::string output_folder,
+    const specfem::wave::type wave, const type_real sample_dt,
+    const type_real t0, const type_real max_shift,
+    const specfem::MPI::MPI *mpi)
+    : compute_receivers(compute_receivers), measurement(measurement),
+      output_folder(output_folder), sample_dt(sample_dt), t0(t0),
+      nsamples(compute_receivers->max_sig_step), max_lag(0), mpi(mpi) {
+
+  if (measurement == specfem::misfit::cross_correlation) {
+    this->max_lag = std::lround(max_shift / sample_dt);
+    if (this->max_lag < 1) {
+      std::ostringstream message;
+      message << "Cross-correlation shifts of " << max_shift
+              << " s are shorter than the sampling interval of the "
+              << "seismograms";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  // SH seismograms store a single component
+  this->components = { "BXX", "BXZ" };
+  if (wave == specfem::wave::sh)
+    this->components = { "BXX" };
+
+  // Receivers of this process are stored in the order of the stations
+  for (int irec = 0; irec < receivers.size(); irec++) {
+    if (receivers.islice[irec] == mpi->get_rank())
+      this->names.push_back(receivers.network_names[irec] +
+                            receivers.station_names[irec]);
+  }
+
+  const int nreceivers = this->names.size();
+  const int ncomponents = this->components.size();
+
+  this->available = specfem::kokkos::DeviceView2d<int>(
+      "specfem::writer::misfit::available", nreceivers, ncomponents);
+  this->observed = specfem::kokkos::DeviceView3d<type_real>(
+      "specfem::writer::misfit::observed", this->nsamples, nreceivers,
+      ncomponents);
+  this->traces = specfem::kokkos::DeviceView3d<type_real>(
+      "specfem::writer::misfit::traces", this->nsamples, nreceivers,
+      ncomponents);
+  this->correlation = specfem::kokkos::DeviceView3d<type_real>(
+      "specfem::writer::misfit::correlation",
+      (measurement == specfem::misfit::cross_correlation)
+          ? 2 * this->max_lag + 1
+          : 0,
+      nreceivers, ncomponents);
+  this->values = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::writer::misfit::values", nreceivers, ncomponents);
+  this->shifts = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::writer::misfit::shifts", nreceivers, ncomponents);
+
+  auto h_available = Kokkos::create_mirror_view(this->available);
+  auto h_observed = Kokkos::create_mirror_view(this->observed);
+
+  int ntraces = 0;
+  if (nreceivers > 0) {
+    const std::string ext =
+        extension(compute_receivers->h_seismogram_types(0));
+    for (int irec = 0; irec < nreceivers; irec++) {
+      for (int icomp = 0; icomp < ncomponents; icomp++) {
+        const std::string filename = observed_folder + "/" +
+                                     this->names[irec] +
+                                     this->components[icomp] + ".sem" + ext;
+        h_available(irec, icomp) = std::ifstream(filename).good();
+        if (!h_available(irec, icomp))
+          continue;
+        read_trace(filename, irec, icomp, sample_dt, t0, h_observed);
+        ntraces++;
+      }
+    }
+  }
+
+  if (mpi->all_reduce(ntraces, specfem::MPI::sum) == 0) {
+    std::ostringstream message;
+    message << "No observed trace found in " << observed_folder;
+    throw std::runtime_error(message.str());
+  }
+
+  Kokkos::deep_copy(this->available, h_available);
+  Kokkos::deep_copy(this->observed, h_observed);
+}
+
+void specfem::writer::misfit::sample(
+    const int isig_step, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  if (this->names.empty())
+    return;
+
+  // Decimated seismograms aren't written at every recorded sample
+  const int isample = this->compute_receivers->written_sample(isig_step);
+  if (isample < 0 || isample >= this->nsamples)
+    return;
+
+  const auto seismogram = this->compute_receivers->seismogram;
+  const auto available = this->available;
+  const auto observed = this->observed;
+  const auto traces = this->traces;
+  const auto correlation = this->correlation;
+  const auto values = this->values;
+  const int islot = isample % seismogram.extent(0);
+  const int nsamples = this->nsamples;
+  const int ncomponents = values.extent(1);
+  const int ntraces = values.extent(0) * ncomponents;
+  const int nlags = correlation.extent(0);
+  const int max_lag = this->max_lag;
+  const type_real sample_dt = this->sample_dt;
+  const bool l2 = (this->measurement == specfem::misfit::l2);
+
+  // The correlation of lag l adds s(t) d(t + l), the observed trace being
+  // stored for the whole run
+  Kokkos::parallel_for(
+      "specfem::writer::misfit::sample",
+      Kokkos::RangePolicy<specfem::kokkos::DevExecSpace>(exec_space, 0,
+                                                         ntraces),
+      KOKKOS_LAMBDA(const int itrace) {
+        const int irec = itrace / ncomponents;
+        const int icomp = itrace % ncomponents;
+        if (!available(irec, icomp))
+          return;
+
+        const type_real synthetic = seismogram(islot, 0, irec, icomp);
+        if (l2) {
+          const type_real residual =
+              synthetic - observed(isample, irec, icomp);
+          traces(isample, irec, icomp) = residual;
+          values(irec, icomp) += 0.5 * residual * residual * sample_dt;
+          return;
+        }
+
+        traces(isample, irec, icomp) = synthetic;
+        for (int ilag = 0; ilag < nlags; ilag++) {
+          const int jsample = isample + ilag - max_lag;
+          if (jsample >= 0 && jsample < nsamples)
+            correlation(ilag, irec, icomp) +=
+                synthetic * observed(jsample, irec, icomp);
+        }
+      });
+}
+
+void specfem::writer::misfit::compute_shifts() {
+
+  const auto available = this->available;
+  const auto traces = this->traces;
+  const auto correlation = this->correlation;
+  const auto values = this->values;
+  const auto shifts = this->shifts;
+  const int nsamples = this->nsamples;
+  const int ncomponents = values.extent(1);
+  const int ntraces = values.extent(0) * ncomponents;
+  const int nlags = correlation.extent(0);
+  const int max_lag = this->max_lag;
+  const type_real sample_dt = this->sample_dt;
+
+  Kokkos::parallel_for(
+      "specfem::writer::misfit::compute_shifts",
+      Kokkos::RangePolicy<specfem::kokkos::DevExecSpace>(0, ntraces),
+      KOKKOS_LAMBDA(const int itrace) {
+        const int irec = itrace / ncomponents;
+        const int icomp = itrace % ncomponents;
+        if (!available(irec, icomp) || nsamples < 2)
+          return;
+
+        int best = 0;
+        for (int ilag = 1; ilag < nlags; ilag++) {
+          if (correlation(ilag, irec, icomp) > correlation(best, irec, icomp))
+            best = ilag;
+        }
+
+        // Vertex of the parabola through the neighboring lags
+        type_real lag = best - max_lag;
+        if (best > 0 && best < nlags - 1) {
+          const type_real left = correlation(best - 1, irec, icomp);
+          const type_real center = correlation(best, irec, icomp);
+          const type_real right = correlation(best + 1, irec, icomp);
+          const type_real curvature = left - 2.0 * center + right;
+          if (curvature < 0.0)
+            lag += 0.5 * (left - right) / curvature;
+        }
+
+        // The observed trace matches the synthetic trace delayed by the lag
+        const type_real shift = -1.0 * lag * sample_dt;
+        shifts(irec, icomp) = shift;
+        values(irec, icomp) = 0.5 * shift * shift;
+
+        // Velocities are central differences, one sided at both ends
+        const auto velocity = [&](const int isample) {
+          const int previous = (isample > 0) ? isample - 1 : 0;
+          const int next = (isample < nsamples - 1) ? isample + 1 : isample;
+          return (traces(next, irec, icomp) - traces(previous, irec, icomp)) /
+                 ((next - previous) * sample_dt);
+        };
+
+        type_real norm = 0.0;
+        for (int isample = 0; isample < nsamples; isample++) {
+          const type_real value = velocity(isample);
+          norm += value * value * sample_dt;
+        }
+
+        // Synthetic values are replaced once the velocity of the next sample
+        // doesn't read them
+        type_real previous = traces(0, irec, icomp);
+        for (int isample = 0; isample < nsamples; isample++) {
+          const type_real current = traces(isample, irec, icomp);
+          const int next = (isample < nsamples - 1) ? isample + 1 : isample;
+          const type_real value =
+              (traces(next, irec, icomp) - previous) /
+              ((next - ((isample > 0) ? isample - 1 : 0)) * sample_dt);
+          traces(isample, irec, icomp) =
+              (norm > 0.0) ? -1.0 * shift * value / norm : 0.0;
+          previous = current;
+        }
+      });
+}
+
+void specfem::writer::misfit::write() {
+
+  if (this->measurement == specfem::misfit::cross_correlation &&
+      !this->names.empty())
+    this->compute_shifts();
+  Kokkos::fence();
+
+  const auto h_available = Kokkos::create_mirror_view_and_copy(
+      Kokkos::HostSpace(), this->available);
+  const auto h_traces =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), this->traces);
+  const auto h_values =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), this->values);
+  const auto h_shifts =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), this->shifts);
+
+  std::filesystem::create_directories(this->output_folder);
+  std::ofstream misfits(this->output_folder + "/misfit_" +
+                        std::to_string(this->mpi->get_rank()) + ".txt");
+
+  double total = 0.0;
+  for (int irec = 0; irec < this->names.size(); irec++) {
+    for (int icomp = 0; icomp < this->components.size(); icomp++) {
+      if (!h_available(irec, icomp))
+        continue;
+
+      const std::string name = this->names[irec] + this->components[icomp];
+      misfits << name << " " << std::scientific << h_values(irec, icomp);
+      if (this->measurement == specfem::misfit::cross_correlation)
+        misfits << " " << std::scientific << h_shifts(irec, icomp);
+      misfits << "\n";
+      total += h_values(irec, icomp);
+
+      std::ofstream adjoint(this->output_folder + "/" + name + ".adj");
+      for (int isample = 0; isample < this->nsamples; isample++) {
+        const type_real time_t = isample * this->sample_dt + this->t0;
+        adjoint << std::scientific << time_t << " " << std::scientific
+                << h_traces(isample, irec, icomp) << "\n";
+      }
+    }
+  }
+
+  if (!misfits) {
+    std::ostringstream message;
+    message << "Could not write misfits to " << this->output_folder;
+    throw std::runtime_error(message.str());
+  }
+
+  total = this->mpi->reduce(total, specfem::MPI::sum);
+  if (this->mpi->main_proc()) {
+    std::ofstream(this->output_folder + "/misfit.txt")
+        << std::scientific << total << "\n";
+  }
+
+  std::ostringstream message;
+  message << "Total misfit : " << std::scientific << total;
+  this->mpi->cout(message.str());
+}
@@ -2,7 +2,20 @@
 #include "../include/fortran_IO.h"
 #include "../include/kokkos_abstractions.h"
 #include "../include/specfem_mpi.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if defined(MPI_PARALLEL) && defined(OPEN_MPI) && OPEN_MPI
+#include <mpi-ext.h>
+#endif
 
 specfem::interfaces::interface::interface(const int ninterfaces,
                                           const int max_interface_size) {
@@ -39,9 +52,9 @@ specfem::interfaces::interface::interface(const int ninterfaces,
         "specfem::mesh::interfaces::my_interfaces", 1, 1, 1);
 
     // initialize values
-    this->my_neighbors(1) = -1;
-    this->my_nelmnts_neighbors(1) = 0;
-    this->my_interfaces(1, 1, 1) = -1;
+    this->my_neighbors(0) = -1;
+    this->my_nelmnts_neighbors(0) = 0;
+    this->my_interfaces(0, 0, 0) = -1;
   }
 #else
   if (ninterfaces > 0)
@@ -55,15 +68,15 @@ specfem::interfaces::interface::interface(const int ninterfaces,
       "specfem::mesh::interfaces::my_interfaces", 1, 1, 1);
 
   // initialize values
-  this->my_neighbors(1) = -1;
-  this->my_nelmnts_neighbors(1) = 0;
-  this->my_interfaces(1, 1, 1) = -1;
+  this->my_neighbors(0) = -1;
+  this->my_nelmnts_neighbors(0) = 0;
+  this->my_interfaces(0, 0, 0) = -1;
 #endif
 
   return;
 }
 
-specfem::interfaces::interface::interface(std::ifstream &stream,
+specfem::interfaces::interface::interface(std::istream &stream,
                                           const specfem::MPI::MPI *mpi) {
 
   // read number of interfaces
@@ -111,3 +124,351 @@ specfem::interfaces::interface::interface(std::ifstream &stream,
 
   return;
 }
+
+namespace {
+
+// Quadrature point (iz, ix) at control node inode of an element. Corner
+// control nodes are ordered counter clockwise starting at (xi, gamma) = (-1,
+// -1)
+std::tuple<int, int> corner_point(const int inode, const int ngllz,
+                                  const int ngllx) {
+  switch (inode) {
+  case 0:
+    return std::make_tuple(0, 0);
+  case 1:
+    return std::make_tuple(0, ngllx - 1);
+  case 2:
+    return std::make_tuple(ngllz - 1, ngllx - 1);
+  case 3:
+    return std::make_tuple(ngllz - 1, 0);
+  default:
+    throw std::runtime_error("Interface node is not a corner of the element");
+  }
+}
+
+// Find the corner of element ispec at control node node_id (0-based)
+int find_corner(const specfem::kokkos::HostView2d<int> knods, const int ispec,
+                const int node_id) {
+  for (int inode = 0; inode < 4; inode++) {
+    if (knods(inode, ispec) == node_id)
+      return inode;
+  }
+
+  std::ostringstream message;
+  message << "Interface node " << node_id + 1
+          << " is not a corner of element " << ispec + 1;
+  throw std::runtime_error(message.str());
+}
+
+// Check if MPI can read and write device memory
+bool gpu_aware_mpi() {
+  // Device memory is host memory on host backends
+  if (Kokkos::SpaceAccessibility<Kokkos::HostSpace,
+                                 specfem::kokkos::DevMemSpace>::accessible)
+    return true;
+
+#if defined(KOKKOS_ENABLE_CUDA) && defined(MPIX_CUDA_AWARE_SUPPORT) &&        \
+    MPIX_CUDA_AWARE_SUPPORT
+  if (MPIX_Query_cuda_support() == 1)
+    return true;
+#endif
+#if defined(KOKKOS_ENABLE_HIP) && defined(MPIX_ROCM_AWARE_SUPPORT) &&         \
+    MPIX_ROCM_AWARE_SUPPORT
+  if (MPIX_Query_rocm_support() == 1)
+    return true;
+#endif
+
+  // Cray MPICH doesn't provide a query, GPU support is enabled at runtime
+  const char *cray_gpu_support = std::getenv("MPICH_GPU_SUPPORT_ENABLED");
+  return (cray_gpu_support != nullptr &&
+          std::string(cray_gpu_support) == "1");
+}
+
+} // namespace
+
+specfem::interfaces::halo::halo(
+    const specfem::interfaces::interface &interface,
+    const specfem::kokkos::HostElementMirror3d<int> h_ibool,
+    const specfem::kokkos::HostView2d<type_real> coord,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::kokkos::HostMirror1d<specfem::elements::type> h_ispec_type,
+    const int ncomponents, const specfem::MPI::MPI *mpi)
+    : ncomponents(ncomponents) {
+
+#ifdef MPI_PARALLEL
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  const int nglob = coord.extent(1);
+
+  // Coordinates computed by neighboring ranks differ by round off errors
+  type_real xmin = 0, xmax = 0, zmin = 0, zmax = 0;
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    xmin = (iglob == 0) ? coord(0, iglob) : std::min(xmin, coord(0, iglob));
+    xmax = (iglob == 0) ? coord(0, iglob) : std::max(xmax, coord(0, iglob));
+    zmin = (iglob == 0) ? coord(1, iglob) : std::min(zmin, coord(1, iglob));
+    zmax = (iglob == 0) ? coord(1, iglob) : std::max(zmax, coord(1, iglob));
+  }
+  const type_real tolerance = 1e-5 * std::max(xmax - xmin, zmax - zmin);
+
+  std::vector<std::vector<int> > interface_points(interface.ninterfaces);
+  std::vector<bool> mask(nglob, false);
+
+  for (int iinterface = 0; iinterface < interface.ninterfaces; iinterface++) {
+    std::vector<int> &iglobs = interface_points[iinterface];
+    for (int ie = 0; ie < interface.my_nelmnts_neighbors(iinterface); ie++) {
+      // Element and control node ids are 1-based database values
+      const int ispec = interface.my_interfaces(iinterface, ie, 0) - 1;
+      const int itype = interface.my_interfaces(iinterface, ie, 1);
+
+      if (h_ispec_type(ispec) != specfem::elements::elastic)
+        continue;
+
+      const auto [izmin, ixmin] = corner_point(
+          find_corner(knods, ispec,
+                      interface.my_interfaces(iinterface, ie, 2) - 1),
+          ngllz, ngllx);
+      int izmax = izmin, ixmax = ixmin;
+
+      if (itype == 2) {
+        // The edge spans the GLL points between both corners
+        std::tie(izmax, ixmax) = corner_point(
+            find_corner(knods, ispec,
+                        interface.my_interfaces(iinterface, ie, 3) - 1),
+            ngllz, ngllx);
+        if (izmin != izmax && ixmin != ixmax)
+          throw std::runtime_error("Interface edge joins opposite corners");
+      } else if (itype != 1) {
+        throw std::runtime_error("Unknown MPI interface type");
+      }
+
+      for (int iz = std::min(izmin, izmax); iz <= std::max(izmin, izmax);
+           iz++) {
+        for (int ix = std::min(ixmin, ixmax); ix <= std::max(ixmin, ixmax);
+             ix++) {
+          const int iglob = h_ibool(ispec, iz, ix);
+          if (!mask[iglob]) {
+            mask[iglob] = true;
+            iglobs.push_back(iglob);
+          }
+        }
+      }
+    }
+
+    for (const int iglob : iglobs)
+      mask[iglob] = false;
+
+    // Both ranks sharing the interface order points by coordinates
+    std::sort(iglobs.begin(), iglobs.end(), [&](const int i1, const int i2) {
+      if (std::abs(coord(0, i1) - coord(0, i2)) > tolerance)
+        return coord(0, i1) < coord(0, i2);
+      return coord(1, i1) < coord(1, i2);
+    });
+  }
+
+  // Check that neighbors share the same number of points
+  const MPI_Comm comm = mpi->get_comm();
+  std::vector<int> npoints(interface.ninterfaces);
+  std::vector<int> neighbor_npoints(interface.ninterfaces);
+  std::vector<MPI_Request> count_requests(2 * interface.ninterfaces);
+  for (int iinterface = 0; iinterface < interface.ninterfaces; iinterface++) {
+    npoints[iinterface] = interface_points[iinterface].size();
+    MPI_Irecv(&neighbor_npoints[iinterface], 1, MPI_INT,
+              interface.my_neighbors(iinterface), 0, comm,
+              &count_requests[iinterface]);
+    MPI_Isend(&npoints[iinterface], 1, MPI_INT,
+              interface.my_neighbors(iinterface), 0, comm,
+              &count_requests[interface.ninterfaces + iinterface]);
+  }
+  MPI_Waitall(count_requests.size(), count_requests.data(),
+              MPI_STATUSES_IGNORE);
+
+  this->offsets = { 0 };
+  for (int iinterface = 0; iinterface < interface.ninterfaces; iinterface++) {
+    if (npoints[iinterface] != neighbor_npoints[iinterface]) {
+      std::ostringstream message;
+      message << "Rank " << mpi->get_rank() << " shares "
+              << npoints[iinterface] << " points with rank "
+              << interface.my_neighbors(iinterface) << " which shares "
+              << neighbor_npoints[iinterface] << " points";
+      throw std::runtime_error(message.str());
+    }
+    // Interfaces between non elastic elements aren't exchanged
+    if (npoints[iinterface] == 0)
+      continue;
+    this->neighbors.push_back(interface.my_neighbors(iinterface));
+    this->offsets.push_back(this->offsets.back() + npoints[iinterface]);
+  }
+
+  const int ntotal = this->offsets.back();
+  this->points = specfem::kokkos::DeviceView1d<int>(
+      "specfem::interfaces::halo::points", ntotal);
+  this->h_points = Kokkos::create_mirror_view(this->points);
+  int ipoint = 0;
+  for (int iinterface = 0; iinterface < interface.ninterfaces; iinterface++) {
+    for (const int iglob : interface_points[iinterface]) {
+      this->h_points(ipoint) = iglob;
+      ipoint++;
+    }
+  }
+  Kokkos::deep_copy(this->points, this->h_points);
+
+  this->send_buffer = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::interfaces::halo::send_buffer", ntotal, ncomponents);
+  this->recv_buffer = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::interfaces::halo::recv_buffer", ntotal, ncomponents);
+  this->h_send_buffer = Kokkos::create_mirror_view(this->send_buffer);
+  this->h_recv_buffer = Kokkos::create_mirror_view(this->recv_buffer);
+
+  this->direct = gpu_aware_mpi();
+  type_real *send = this->direct ? this->send_buffer.data()
+                                 : this->h_send_buffer.data();
+  type_real *recv = this->direct ? this->recv_buffer.data()
+                                 : this->h_recv_buffer.data();
+  const MPI_Datatype datatype =
+      std::is_same<type_real, float>::value ? MPI_FLOAT : MPI_DOUBLE;
+
+  // Buffers are LayoutRight, hence the points of a neighbor are contiguous
+  const int nneighbors = this->neighbors.size();
+  this->requests = std::vector<MPI_Request>(2 * nneighbors);
+  for (int ineighbor = 0; ineighbor < nneighbors; ineighbor++) {
+    const int offset = this->offsets[ineighbor] * ncomponents;
+    const int count =
+        (this->offsets[ineighbor + 1] - this->offsets[ineighbor]) *
+        ncomponents;
+    MPI_Recv_init(recv + offset, count, datatype, this->neighbors[ineighbor],
+                  0, comm, &this->requests[ineighbor]);
+    MPI_Send_init(send + offset, count, datatype, this->neighbors[ineighbor],
+                  0, comm, &this->requests[nneighbors + ineighbor]);
+  }
+#else
+  if (interface.ninterfaces > 0)
+    throw std::runtime_error("Found interfaces but SPECFEM compiled without "
+                             "MPI. Compile SPECFEM with MPI");
+#endif
+
+  return;
+}
+
+specfem::interfaces::halo::~halo() {
+#ifdef MPI_PARALLEL
+  for (auto &request : this->requests)
+    MPI_Request_free(&request);
+#endif
+
+  return;
+}
+
+void specfem::interfaces::halo::start(
+    const specfem::kokkos::DeviceFieldView2d<type_real> field,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+#ifdef MPI_PARALLEL
+  if (this->neighbors.empty())
+    return;
+
+  const int ntotal = this->offsets.back();
+  const int ncomponents = this->ncomponents;
+  const auto points = this->points;
+  const auto send_buffer = this->send_buffer;
+
+  Kokkos::parallel_for(
+      "specfem::interfaces::halo::pack",
+      specfem::kokkos::DeviceMDrange<2>(exec_space, { 0, 0 },
+                                        { ntotal, ncomponents }),
+      KOKKOS_LAMBDA(const int ipoint, const int icomp) {
+        send_buffer(ipoint, icomp) = field(points(ipoint), icomp);
+      });
+
+  if (!this->direct)
+    Kokkos::deep_copy(exec_space, this->h_send_buffer, send_buffer);
+
+  // MPI reads the buffers outside of Kokkos execution spaces
+  exec_space.fence();
+
+  MPI_Startall(this->requests.size(), this->requests.data());
+#endif
+
+  return;
+}
+
+void specfem::interfaces::halo::finish(
+    const specfem::kokkos::DeviceFieldView2d<type_real> field,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+#ifdef MPI_PARALLEL
+  if (this->neighbors.empty())
+    return;
+
+  Kokkos::Timer timer;
+  MPI_Waitall(this->requests.size(), this->requests.data(),
+              MPI_STATUSES_IGNORE);
+  this->wait_time += timer.seconds();
+
+  const int ntotal = this->offsets.back();
+  const int ncomponents = this->ncomponents;
+  const auto points = this->points;
+  const auto recv_buffer = this->recv_buffer;
+
+  if (!this->direct)
+    Kokkos::deep_copy(exec_space, recv_buffer, this->h_recv_buffer);
+
+  // Points shared with several neighbors are updated by several entries
+  Kokkos::parallel_for(
+      "specfem::interfaces::halo::unpack",
+      specfem::kokkos::DeviceMDrange<2>(exec_space, { 0, 0 },
+                                        { ntotal, ncomponents }),
+      KOKKOS_LAMBDA(const int ipoint, const int icomp) {
+        Kokkos::atomic_add(&field(points(ipoint), icomp),
+                           recv_buffer(ipoint, icomp));
+      });
+#endif
+
+  return;
+}
+
+void specfem::interfaces::halo::assemble(
+    const specfem::kokkos::DeviceFieldView2d<type_real> field,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  if (field.extent(1) != static_cast<size_t>(this->ncomponents) &&
+      !this->neighbors.empty())
+    throw std::runtime_error("Assembled field doesn't match the number of "
+                             "components of the halo");
+
+  this->start(field, exec_space);
+  this->finish(field, exec_space);
+
+  return;
+}
+
+void specfem::interfaces::halo::assemble(
+    const specfem::kokkos::DeviceView1d<type_real> values) {
+
+  if (this->neighbors.empty())
+    return;
+
+  // Persistent requests exchange ncomponents values per point, hence values
+  // are replicated for every component
+  const int nglob = values.extent(0);
+  const int ncomponents = this->ncomponents;
+  specfem::kokkos::DeviceFieldView2d<type_real> field(
+      "specfem::interfaces::halo::values", nglob, ncomponents);
+
+  Kokkos::parallel_for(
+      "specfem::interfaces::halo::replicate_values",
+      specfem::kokkos::DeviceMDrange<2>({ 0, 0 }, { nglob, ncomponents }),
+      KOKKOS_LAMBDA(const int iglob, const int icomp) {
+        field(iglob, icomp) = values(iglob);
+      });
+
+  this->assemble(field);
+
+  Kokkos::parallel_for(
+      "specfem::interfaces::halo::copy_values",
+      specfem::kokkos::DeviceRange(0, nglob),
+      KOKKOS_LAMBDA(const int iglob) { values(iglob) = field(iglob, 0); });
+
+  Kokkos::fence();
+
+  return;
+}
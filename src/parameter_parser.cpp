@@ -1,11 +1,17 @@
 #include "../include/parameter_parser.h"
 #include "../include/globals.h"
+#include "../include/hdf5_file.h"
+#include "../include/misfit_writer.h"
+#include "../include/reciprocal_writer.h"
 #include "../include/writer.h"
 #include "yaml-cpp/yaml.h"
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <chrono>
 #include <ctime>
 #include <ostream>
+#include <sstream>
+#include <stdexcept>
 #include <tuple>
 
 specfem::TimeScheme::TimeScheme *
@@ -24,9 +30,24 @@ specfem::runtime_configuration::time_marching::instantiate(
     const int nstep_between_samples) {
 
   specfem::TimeScheme::TimeScheme *it;
-  if (this->timescheme == "Newmark") {
+  if (this->lts_levels > 1) {
+    if (this->timescheme != "Newmark") {
+      throw std::runtime_error(
+          "Local time stepping is only implemented for the Newmark scheme");
+    }
+    it = new specfem::TimeScheme::LTSNewmark(this->nstep, this->t0, this->dt,
+                                             nstep_between_samples);
+  } else if (this->timescheme == "Newmark") {
     it = new specfem::TimeScheme::Newmark(this->nstep, this->t0, this->dt,
                                           nstep_between_samples);
+  } else if (this->timescheme == "LDDRK") {
+    it = new specfem::TimeScheme::LDDRK(this->nstep, this->t0, this->dt,
+                                        nstep_between_samples);
+  } else {
+    std::ostringstream message;
+    message << "Time scheme : " << this->timescheme
+            << " not recognized. Use Newmark or LDDRK.";
+    throw std::runtime_error(message.str());
   }
 
   return it;
@@ -63,11 +84,59 @@ specfem::runtime_configuration::seismogram::seismogram(
   const int nstep_between_samples =
       seismogram["nstep_between_samples"].as<int>();
 
+  int buffer_size = 0;
+  if (seismogram["buffer-size"]) {
+    buffer_size = seismogram["buffer-size"].as<int>();
+    if (buffer_size < 0) {
+      throw std::runtime_error("Seismogram buffer size must be positive");
+    }
+  }
+
+  int compression = 0;
+  if (seismogram["compression"]) {
+    compression = seismogram["compression"].as<int>();
+    if (compression < 0 || compression > 9) {
+      throw std::runtime_error(
+          "Seismogram compression must be between 0 and 9");
+    }
+  }
+
+  int writer_ranks = 1;
+  if (seismogram["writer-ranks"]) {
+    writer_ranks = seismogram["writer-ranks"].as<int>();
+    if (writer_ranks < 1) {
+      throw std::runtime_error(
+          "Number of seismogram writer ranks must be positive");
+    }
+  }
+
+  int decimation = 1;
+  if (seismogram["decimation"]) {
+    decimation = seismogram["decimation"].as<int>();
+    if (decimation < 1) {
+      throw std::runtime_error("Seismogram decimation must be positive");
+    }
+  }
+
+  // Reciprocal simulations write every recorded sample of the sources as
+  // ASCII files
+  bool reciprocal = false;
+  if (seismogram["reciprocal"]) {
+    reciprocal = seismogram["reciprocal"].as<bool>();
+    if (reciprocal &&
+        (decimation > 1 ||
+         seismogram["seismogram-format"].as<std::string>() != "ascii")) {
+      throw std::runtime_error("Reciprocal simulations write ASCII "
+                               "seismograms without decimation");
+    }
+  }
+
   *this = specfem::runtime_configuration::seismogram(
       seismogram["stations-file"].as<std::string>(),
       seismogram["angle"].as<type_real>(),
       seismogram["nstep_between_samples"].as<int>(),
-      seismogram["seismogram-format"].as<std::string>(), output_folder);
+      seismogram["seismogram-format"].as<std::string>(), output_folder,
+      buffer_size, compression, writer_ranks, decimation, reciprocal);
 
   // Allocate seismogram types
   assert(seismogram["seismogram-type"].IsSequence());
@@ -89,9 +158,9 @@ specfem::runtime_configuration::seismogram::seismogram(
 
 specfem::writer::writer *
 specfem::runtime_configuration::seismogram::instantiate_seismogram_writer(
-    std::vector<specfem::receivers::receiver *> &receivers,
+    const specfem::receivers::receiver_set &receivers,
     specfem::compute::receivers *compute_receivers, const type_real dt,
-    const type_real t0) const {
+    const type_real t0, const specfem::MPI::MPI *mpi) const {
 
   specfem::seismogram::format::type type;
   if (this->seismogram_format == "seismic_unix" ||
@@ -99,26 +168,631 @@ specfem::runtime_configuration::seismogram::instantiate_seismogram_writer(
     type = specfem::seismogram::format::seismic_unix;
   } else if (this->seismogram_format == "ascii") {
     type = specfem::seismogram::format::ascii;
+  } else if (this->seismogram_format == "hdf5") {
+    if (!specfem::writer::hdf5::available()) {
+      throw std::runtime_error("Seismogram format hdf5 requires SPECFEM to "
+                               "be compiled with -DHDF5_OUTPUT=ON");
+    }
+    type = specfem::seismogram::format::hdf5;
+  } else {
+    std::ostringstream message;
+    message << "Seismogram format " << this->seismogram_format
+            << " is not supported";
+    throw std::runtime_error(message.str());
   }
 
   specfem::writer::writer *writer = new specfem::writer::seismogram(
       receivers, compute_receivers, type, this->output_folder, dt, t0,
-      this->nstep_between_samples);
+      this->nstep_between_samples, mpi, this->compression,
+      this->writer_ranks);
 
   return writer;
 }
 
+specfem::writer::writer *
+specfem::runtime_configuration::seismogram::instantiate_reciprocal_writer(
+    specfem::Domain::Domain *domain, const specfem::compute::compute *compute,
+    const std::vector<specfem::sources::source *> &sources,
+    const specfem::receivers::receiver_set &receivers,
+    const specfem::quadrature::quadrature &quadx,
+    const specfem::quadrature::quadrature &quadz,
+    const specfem::wave::type wave, const int nsig_steps, const type_real dt,
+    const type_real t0, const type_real source_t0,
+    specfem::MPI::MPI *mpi) const {
+
+  return new specfem::writer::reciprocal(
+      domain, compute, sources, receivers, this->stypes, quadx, quadz, wave,
+      nsig_steps, dt * this->nstep_between_samples, t0, source_t0,
+      this->output_folder, mpi);
+}
+
+// Stride between GLL points of wavefield outputs, 0 selects element corners
+static int read_subsampling(const YAML::Node &Node) {
+  int stride = 1;
+  if (Node["subsampling"]) {
+    const std::string subsampling = Node["subsampling"].as<std::string>();
+    if (subsampling == "corners") {
+      stride = 0;
+    } else {
+      stride = Node["subsampling"].as<int>();
+      if (stride < 1) {
+        throw std::runtime_error(
+            "Wavefield subsampling must be positive or corners");
+      }
+    }
+  }
+  return stride;
+}
+
+// Fields listed in a wavefield-type sequence
+static std::vector<specfem::seismogram::type>
+read_wavefield_types(const YAML::Node &Node) {
+  std::vector<specfem::seismogram::type> fields;
+  for (YAML::Node field : Node) {
+    if (field.as<std::string>() == "displacement") {
+      fields.push_back(specfem::seismogram::displacement);
+    } else if (field.as<std::string>() == "velocity") {
+      fields.push_back(specfem::seismogram::velocity);
+    } else if (field.as<std::string>() == "acceleration") {
+      fields.push_back(specfem::seismogram::acceleration);
+    } else {
+      std::ostringstream message;
+      message << "Wavefield type " << field.as<std::string>()
+              << " is not supported";
+      throw std::runtime_error(message.str());
+    }
+  }
+  return fields;
+}
+
+specfem::runtime_configuration::wavefield::wavefield(const YAML::Node &Node) {
+
+  std::string output_folder = ".";
+  if (Node["output-folder"]) {
+    output_folder = Node["output-folder"].as<std::string>();
+  }
+
+  *this = specfem::runtime_configuration::wavefield(
+      Node["nstep_between_snapshots"].as<int>(), read_subsampling(Node),
+      output_folder);
+
+  if (Node["wavefield-type"]) {
+    this->fields = read_wavefield_types(Node["wavefield-type"]);
+  }
+
+  // Images are interpolated onto a regular grid instead of gathering points
+  if (Node["image"]) {
+    const YAML::Node &image = Node["image"];
+    this->grid.nx = image["nx"].as<int>();
+    this->grid.nz = image["nz"].as<int>();
+    if (this->grid.nx < 1 || this->grid.nz < 1) {
+      throw std::runtime_error("Wavefield images need at least one pixel "
+                               "along x and z");
+    }
+    const int nbounds = static_cast<bool>(image["xmin"]) +
+                        static_cast<bool>(image["xmax"]) +
+                        static_cast<bool>(image["zmin"]) +
+                        static_cast<bool>(image["zmax"]);
+    if (nbounds != 0 && nbounds != 4) {
+      throw std::runtime_error("Wavefield images need xmin, xmax, zmin and "
+                               "zmax, or none of them");
+    }
+    if (nbounds == 4) {
+      this->grid.bounded = true;
+      this->grid.xmin = image["xmin"].as<type_real>();
+      this->grid.xmax = image["xmax"].as<type_real>();
+      this->grid.zmin = image["zmin"].as<type_real>();
+      this->grid.zmax = image["zmax"].as<type_real>();
+    }
+  }
+
+  return;
+}
+
+specfem::writer::wavefield *
+specfem::runtime_configuration::wavefield::instantiate_wavefield_writer(
+    specfem::Domain::Domain *domain, const specfem::compute::compute *compute,
+    const specfem::quadrature::quadrature &quadx,
+    const specfem::quadrature::quadrature &quadz,
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::MPI::MPI *mpi) const {
+
+  if (this->grid.nx > 0)
+    return new specfem::writer::wavefield(
+        domain, compute, quadx, quadz, coorg, knods, this->fields,
+        this->nstep_between_snapshots, this->grid, this->output_folder, mpi);
+
+  // Corners are points whose indices are multiples of ngll - 1
+  const int stride =
+      (this->stride == 0) ? compute->h_ibool.extent(2) - 1 : this->stride;
+
+  return new specfem::writer::wavefield(domain, compute, this->fields,
+                                        this->nstep_between_snapshots, stride,
+                                        this->output_folder, mpi);
+}
+
+specfem::runtime_configuration::spectrum::spectrum(const YAML::Node &Node) {
+
+  std::string output_folder = ".";
+  if (Node["output-folder"]) {
+    output_folder = Node["output-folder"].as<std::string>();
+  }
+
+  int nstep_between_samples = 1;
+  if (Node["nstep_between_samples"]) {
+    nstep_between_samples = Node["nstep_between_samples"].as<int>();
+  }
+
+  *this = specfem::runtime_configuration::spectrum(
+      Node["frequencies"].as<std::vector<type_real> >(), nstep_between_samples,
+      read_subsampling(Node), output_folder);
+
+  if (Node["wavefield-type"]) {
+    this->fields = read_wavefield_types(Node["wavefield-type"]);
+  }
+
+  if (Node["receivers"]) {
+    this->receivers = Node["receivers"].as<bool>();
+  }
+
+  return;
+}
+
+specfem::writer::spectrum *
+specfem::runtime_configuration::spectrum::instantiate_spectrum_writer(
+    specfem::Domain::Domain *domain, const specfem::compute::compute *compute,
+    const specfem::receivers::receiver_set &receivers,
+    const specfem::compute::receivers *compute_receivers, const type_real dt,
+    const type_real t0, const type_real sample_dt,
+    const specfem::MPI::MPI *mpi) const {
+
+  // Corners are points whose indices are multiples of ngll - 1
+  const int stride =
+      (this->stride == 0) ? compute->h_ibool.extent(2) - 1 : this->stride;
+
+  return new specfem::writer::spectrum(
+      domain, compute, receivers, this->receivers ? compute_receivers : nullptr,
+      this->fields, this->frequencies, this->nstep_between_samples, stride, dt,
+      t0, sample_dt, this->output_folder, mpi);
+}
+
+specfem::runtime_configuration::checkpoint::checkpoint(const YAML::Node &Node) {
+
+  int nstep_between_checkpoints = 0;
+  if (Node["nstep_between_checkpoints"]) {
+    nstep_between_checkpoints = Node["nstep_between_checkpoints"].as<int>();
+    if (nstep_between_checkpoints < 0) {
+      throw std::runtime_error(
+          "Number of timesteps between checkpoints must be positive");
+    }
+  }
+
+  *this = specfem::runtime_configuration::checkpoint(
+      Node["directory"].as<std::string>(), nstep_between_checkpoints);
+}
+
+specfem::runtime_configuration::adjoint::adjoint(const YAML::Node &Node) {
+
+  std::string output_folder = ".";
+  if (Node["output-folder"]) {
+    output_folder = Node["output-folder"].as<std::string>();
+  }
+
+  type_real checkpoint_memory = 1.0;
+  if (Node["checkpoint-memory"]) {
+    checkpoint_memory = Node["checkpoint-memory"].as<type_real>();
+    if (checkpoint_memory <= 0.0) {
+      throw std::runtime_error(
+          "Memory storing adjoint checkpoints must be positive");
+    }
+  }
+
+  int compression_bits = 0;
+  if (Node["compression-bits"]) {
+    compression_bits = Node["compression-bits"].as<int>();
+    if (compression_bits != 0 && compression_bits != 2 &&
+        compression_bits != 4 && compression_bits != 8 &&
+        compression_bits != 16) {
+      throw std::runtime_error(
+          "Compressed adjoint checkpoints store 2, 4, 8 or 16 bits per value");
+    }
+  }
+
+  bool reconstruction = false;
+  if (Node["forward-wavefield"]) {
+    const std::string forward = Node["forward-wavefield"].as<std::string>();
+    if (forward == "boundaries") {
+      reconstruction = true;
+    } else if (forward != "checkpoints") {
+      std::ostringstream message;
+      message << "Forward wavefield : " << forward
+              << " not recognized. Use checkpoints or boundaries.";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  // Checkpoints aren't stored when the forward fields are reconstructed
+  if (reconstruction && compression_bits > 0) {
+    throw std::runtime_error("Compressed checkpoints can't be used with "
+                             "forward fields reconstructed from boundaries");
+  }
+
+  int boundary_chunk = 100;
+  if (Node["boundary-chunk"]) {
+    boundary_chunk = Node["boundary-chunk"].as<int>();
+    if (boundary_chunk < 1) {
+      throw std::runtime_error(
+          "Chunks of absorbing tractions need at least one timestep");
+    }
+  }
+
+  *this = specfem::runtime_configuration::adjoint(
+      Node["residuals"].as<std::string>(), checkpoint_memory, output_folder,
+      compression_bits, reconstruction, boundary_chunk);
+}
+
+specfem::runtime_configuration::injection::injection(const YAML::Node &Node) {
+
+  const std::string mode = Node["mode"].as<std::string>();
+  specfem::injection::type injection_mode;
+  if (mode == "record") {
+    injection_mode = specfem::injection::record;
+  } else if (mode == "inject") {
+    injection_mode = specfem::injection::inject;
+  } else {
+    std::ostringstream message;
+    message << "Injection mode : " << mode
+            << " not recognized. Use record or inject.";
+    throw std::runtime_error(message.str());
+  }
+
+  // Local simulations inject through their absorbing edges, only the
+  // recording needs the contour
+  std::array<type_real, 4> contour = { 0.0, 0.0, 0.0, 0.0 };
+  if (injection_mode == specfem::injection::record) {
+    const YAML::Node &n_contour = Node["contour"];
+    contour = { n_contour["xmin"].as<type_real>(),
+                n_contour["xmax"].as<type_real>(),
+                n_contour["zmin"].as<type_real>(),
+                n_contour["zmax"].as<type_real>() };
+    if (contour[0] >= contour[1] || contour[2] >= contour[3]) {
+      throw std::runtime_error(
+          "Injection contour needs xmin < xmax and zmin < zmax");
+    }
+  }
+
+  int chunk = 100;
+  if (Node["chunk"]) {
+    chunk = Node["chunk"].as<int>();
+    if (chunk < 1) {
+      throw std::runtime_error(
+          "Chunks of the injected wavefield need at least one timestep");
+    }
+  }
+
+  *this = specfem::runtime_configuration::injection(
+      injection_mode, Node["folder"].as<std::string>(), contour, chunk);
+}
+
+specfem::runtime_configuration::misfit::misfit(const YAML::Node &Node) {
+
+  std::string output_folder = ".";
+  if (Node["output-folder"]) {
+    output_folder = Node["output-folder"].as<std::string>();
+  }
+
+  specfem::misfit::type measurement = specfem::misfit::l2;
+  if (Node["measurement"]) {
+    const std::string name = Node["measurement"].as<std::string>();
+    if (name == "cross-correlation") {
+      measurement = specfem::misfit::cross_correlation;
+    } else if (name != "l2") {
+      std::ostringstream message;
+      message << "Misfit measurement : " << name
+              << " not recognized. Use l2 or cross-correlation.";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  // Correlations of every lag are accumulated at every sample, hence shifts
+  // are bounded
+  type_real max_shift = 0.0;
+  if (measurement == specfem::misfit::cross_correlation) {
+    max_shift = Node["max-shift"].as<type_real>();
+    if (max_shift <= 0.0) {
+      throw std::runtime_error(
+          "Largest cross-correlation shift must be positive");
+    }
+  }
+
+  *this = specfem::runtime_configuration::misfit(
+      measurement, Node["observed"].as<std::string>(), output_folder,
+      max_shift);
+}
+
+specfem::writer::writer *
+specfem::runtime_configuration::misfit::instantiate_misfit_writer(
+    const specfem::receivers::receiver_set &receivers,
+    specfem::compute::receivers *compute_receivers,
+    const specfem::wave::type wave, const type_real sample_dt,
+    const type_real t0, const specfem::MPI::MPI *mpi) const {
+
+  if (!mpi) {
+    throw std::runtime_error("Misfit writers need the MPI object locating "
+                             "the receivers of this process");
+  }
+
+  return new specfem::writer::misfit(
+      receivers, compute_receivers, this->measurement, this->observed_folder,
+      this->output_folder, wave, sample_dt, t0, this->max_shift, mpi);
+}
+
+specfem::checkpoint::checkpoint *
+specfem::runtime_configuration::checkpoint::instantiate_checkpoint(
+    specfem::Domain::Domain *domain,
+    specfem::compute::receivers *compute_receivers,
+    specfem::writer::writer *writer, const specfem::MPI::MPI *mpi) const {
+  return new specfem::checkpoint::checkpoint(this->directory,
+                                             this->nstep_between_checkpoints,
+                                             domain, compute_receivers, writer,
+                                             mpi);
+}
+
 specfem::runtime_configuration::time_marching::time_marching(
     const YAML::Node &timescheme) {
 
+  int lts_levels = 1;
+  if (timescheme["lts-levels"]) {
+    lts_levels = timescheme["lts-levels"].as<int>();
+  }
+
+  // Finest level is stepped 2^(lts-levels - 1) times per timestep
+  if (lts_levels < 1 || lts_levels > 16) {
+    std::ostringstream message;
+    message << "lts-levels : " << lts_levels
+            << " needs to be in the range [1, 16].";
+    throw std::runtime_error(message.str());
+  }
+
+  if (timescheme["dt"].as<std::string>() == "auto") {
+    type_real dt_safety_factor = 0.9;
+    if (timescheme["dt-safety-factor"]) {
+      dt_safety_factor = timescheme["dt-safety-factor"].as<type_real>();
+    }
+
+    if (dt_safety_factor <= 0.0 || dt_safety_factor > 1.0) {
+      std::ostringstream message;
+      message << "dt-safety-factor : " << dt_safety_factor
+              << " needs to be in the range (0, 1].";
+      throw std::runtime_error(message.str());
+    }
+
+    // dt is updated once the stable time step is computed
+    *this = specfem::runtime_configuration::time_marching(
+        timescheme["type"].as<std::string>(), 0.0,
+        timescheme["nstep"].as<int>());
+    this->auto_dt = true;
+    this->dt_safety_factor = dt_safety_factor;
+    this->lts_levels = lts_levels;
+    return;
+  }
+
   *this = specfem::runtime_configuration::time_marching(
       timescheme["type"].as<std::string>(), timescheme["dt"].as<type_real>(),
       timescheme["nstep"].as<int>());
+  this->lts_levels = lts_levels;
 }
 
 specfem::runtime_configuration::run_setup::run_setup(const YAML::Node &Node) {
+
+  specfem::Domain::options domain_options;
+  if (Node["assembly"]) {
+    const std::string assembly_type = Node["assembly"].as<std::string>();
+    if (assembly_type == "atomic") {
+      domain_options.assembly = specfem::assembly::atomic;
+    } else if (assembly_type == "colored") {
+      domain_options.assembly = specfem::assembly::colored;
+    } else {
+      std::ostringstream message;
+      message << "Assembly type : " << assembly_type
+              << " not recognized. Use atomic or colored.";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  if (Node["packed-element-data"]) {
+    domain_options.packed_element_data =
+        Node["packed-element-data"].as<bool>();
+  }
+
+  if (Node["quantized-element-data"]) {
+    domain_options.quantized_element_data =
+        Node["quantized-element-data"].as<bool>();
+  }
+
+  if (Node["compressed-connectivity"]) {
+    domain_options.compressed_connectivity =
+        Node["compressed-connectivity"].as<bool>();
+  }
+
+  if (Node["structured-blocks"]) {
+    domain_options.structured_blocks = Node["structured-blocks"].as<bool>();
+  }
+
+  if (Node["active-elements"]) {
+    domain_options.active_elements = Node["active-elements"].as<bool>();
+  }
+
+  if (Node["reference-kernels"]) {
+    domain_options.reference_kernels = Node["reference-kernels"].as<bool>();
+  }
+
+  if (Node["host-lanes"]) {
+    domain_options.host_lanes = Node["host-lanes"].as<bool>();
+  }
+
+  if (Node["batched-contractions"]) {
+    domain_options.batched_contractions =
+        Node["batched-contractions"].as<bool>();
+  }
+
+  if (Node["assembled-operator"]) {
+    domain_options.assembled_operator = Node["assembled-operator"].as<bool>();
+  }
+
+  if (Node["autotune"]) {
+    domain_options.autotune = Node["autotune"].as<bool>();
+  }
+
+  if (Node["autotune-cache"]) {
+    domain_options.autotune_cache = Node["autotune-cache"].as<std::string>();
+  }
+
+  if (Node["host-offload"]) {
+    domain_options.host_offload = Node["host-offload"].as<bool>();
+  }
+
+  if (Node["host-fraction"]) {
+    domain_options.host_fraction = Node["host-fraction"].as<type_real>();
+  }
+
+  specfem::reordering::type element_ordering = specfem::reordering::none;
+  if (Node["element-reordering"]) {
+    const std::string reordering = Node["element-reordering"].as<std::string>();
+    if (reordering == "none") {
+      element_ordering = specfem::reordering::none;
+    } else if (reordering == "morton") {
+      element_ordering = specfem::reordering::morton;
+    } else if (reordering == "cuthill-mckee") {
+      element_ordering = specfem::reordering::cuthill_mckee;
+    } else {
+      std::ostringstream message;
+      message << "Element reordering : " << reordering
+              << " not recognized. Use none, morton or cuthill-mckee.";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  bool graph_execution = false;
+  if (Node["graph-execution"]) {
+    graph_execution = Node["graph-execution"].as<bool>();
+  }
+
+  bool partition_mesh = false;
+  specfem::partitioner::weights partition_weights;
+  if (Node["partitioning"]) {
+    partition_mesh = true;
+    const YAML::Node &weights = Node["partitioning"]["weights"];
+    if (weights) {
+      if (weights["elastic"])
+        partition_weights.elastic = weights["elastic"].as<type_real>();
+      if (weights["acoustic"])
+        partition_weights.acoustic = weights["acoustic"].as<type_real>();
+      if (weights["poroelastic"])
+        partition_weights.poroelastic = weights["poroelastic"].as<type_real>();
+      if (weights["absorbing"])
+        partition_weights.absorbing = weights["absorbing"].as<type_real>();
+      if (weights["pml"])
+        partition_weights.pml = weights["pml"].as<type_real>();
+    }
+  }
+
   *this = specfem::runtime_configuration::run_setup(
-      Node["number-of-processors"].as<int>(), Node["number-of-runs"].as<int>());
+      Node["number-of-processors"].as<int>(), Node["number-of-runs"].as<int>(),
+      domain_options, element_ordering, graph_execution, partition_mesh,
+      partition_weights);
+
+  if (Node["attenuation"]) {
+    this->attenuation = Node["attenuation"].as<bool>();
+  }
+
+  if (Node["absorbing-boundaries"]) {
+    this->absorbing_boundaries = Node["absorbing-boundaries"].as<bool>();
+  }
+
+  if (Node["pml"]) {
+    this->pml = true;
+    const YAML::Node &pml_node = Node["pml"];
+    this->pml_frequency = pml_node["frequency"].as<type_real>();
+    if (pml_node["reflection"])
+      this->pml_reflection = pml_node["reflection"].as<type_real>();
+  }
+
+  if (Node["timers"]) {
+    const std::string timers = Node["timers"].as<std::string>();
+    if (timers == "enabled") {
+      this->timers = true;
+      this->accurate_timers = false;
+    } else if (timers == "accurate") {
+      this->timers = true;
+      this->accurate_timers = true;
+    } else if (timers == "disabled") {
+      this->timers = false;
+      this->accurate_timers = false;
+    } else {
+      std::ostringstream message;
+      message << "Timers : " << timers
+              << " not recognized. Use enabled, accurate or disabled.";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  if (Node["machine-peak"]) {
+    const YAML::Node &peak_node = Node["machine-peak"];
+    if (peak_node["bandwidth"])
+      this->peak_bandwidth = peak_node["bandwidth"].as<double>();
+    if (peak_node["flops"])
+      this->peak_flops = peak_node["flops"].as<double>();
+    if (this->peak_bandwidth < 0.0 || this->peak_flops < 0.0)
+      throw std::runtime_error("Machine peak needs to be positive");
+  }
+
+  if (Node["startup-report"]) {
+    this->startup_report = Node["startup-report"].as<std::string>();
+  }
+
+  if (Node["progress"]) {
+    const YAML::Node &progress_node = Node["progress"];
+    if (progress_node["interval"])
+      this->progress_interval = progress_node["interval"].as<double>();
+    if (progress_node["status-file"])
+      this->status_file = progress_node["status-file"].as<std::string>();
+  }
+
+  if (Node["stability-check"]) {
+    const YAML::Node &stability_node = Node["stability-check"];
+    this->stability_interval = stability_node["interval"].as<int>();
+    if (stability_node["threshold"])
+      this->stability_threshold = stability_node["threshold"].as<type_real>();
+    if (this->stability_interval < 0 || this->stability_threshold <= 0.0)
+      throw std::runtime_error("Stability check interval and threshold need "
+                               "to be positive");
+  }
+
+  if (Node["trace"]) {
+    const YAML::Node &trace_node = Node["trace"];
+    this->trace_file = trace_node["file"].as<std::string>();
+    if (trace_node["first-step"])
+      this->trace_first_step = trace_node["first-step"].as<int>();
+    if (trace_node["last-step"])
+      this->trace_last_step = trace_node["last-step"].as<int>();
+    if (this->trace_first_step < 0 ||
+        this->trace_first_step > this->trace_last_step)
+      throw std::runtime_error("Traced steps need to be a positive range");
+  }
+
+  if (Node["partitioning"] && Node["partitioning"]["element-weights"]) {
+    this->partition_weights_file =
+        Node["partitioning"]["element-weights"].as<std::string>();
+  }
+
+  if (Node["load-balance"]) {
+    const YAML::Node &load_balance_node = Node["load-balance"];
+    if (load_balance_node["element-weights"])
+      this->element_weights_file =
+          load_balance_node["element-weights"].as<std::string>();
+  }
 }
 
 specfem::runtime_configuration::quadrature::quadrature(const YAML::Node &Node) {
@@ -127,11 +801,110 @@ specfem::runtime_configuration::quadrature::quadrature(const YAML::Node &Node) {
       Node["ngllx"].as<int>(), Node["ngllz"].as<int>());
 }
 
+static specfem::mesher::layered_model
+read_layered_model(const YAML::Node &Node) {
+  specfem::mesher::layered_model model;
+  model.xmin = Node["xmin"].as<type_real>();
+  model.xmax = Node["xmax"].as<type_real>();
+  model.zmin = Node["zmin"].as<type_real>();
+  model.nx = Node["nx"].as<int>();
+  if (Node["ngnod"]) {
+    model.ngnod = Node["ngnod"].as<int>();
+  }
+  if (Node["axisymmetric"]) {
+    model.axisymmetric = Node["axisymmetric"].as<bool>();
+  }
+
+  if (Node["absorbing"]) {
+    const std::vector<std::string> sides = { "bottom", "right", "top",
+                                             "left" };
+    for (const auto &side : Node["absorbing"].as<std::vector<std::string> >()) {
+      const auto it = std::find(sides.begin(), sides.end(), side);
+      if (it == sides.end()) {
+        throw std::runtime_error("Unknown absorbing side " + side +
+                                 " of the internal mesh");
+      }
+      model.absorbing[it - sides.begin()] = true;
+    }
+  }
+
+  for (const auto &N : Node["layers"]) {
+    specfem::mesher::layer layer;
+    layer.nz = N["nz"].as<int>();
+    // The top interface is either flat or a list of (x, z) points
+    if (N["top"].IsSequence()) {
+      for (const auto &point : N["top"]) {
+        const auto xz = point.as<std::vector<type_real> >();
+        if (xz.size() != 2) {
+          throw std::runtime_error(
+              "Interface points of the internal mesh need x and z");
+        }
+        layer.top.push_back({ xz[0], xz[1] });
+      }
+    } else {
+      layer.top.push_back({ model.xmin, N["top"].as<type_real>() });
+    }
+    const YAML::Node &material = N["material"];
+    layer.rho = material["rho"].as<type_real>();
+    layer.vp = material["vp"].as<type_real>();
+    layer.vs = material["vs"].as<type_real>();
+    if (material["Qkappa"]) {
+      layer.Qkappa = material["Qkappa"].as<type_real>();
+    }
+    if (material["Qmu"]) {
+      layer.Qmu = material["Qmu"].as<type_real>();
+    }
+    model.layers.push_back(layer);
+  }
+
+  return model;
+}
+
 specfem::runtime_configuration::database_configuration::database_configuration(
     const YAML::Node &Node) {
+  std::string setup_cache;
+  if (Node["setup-cache"]) {
+    setup_cache = Node["setup-cache"].as<std::string>();
+  }
+
+  // A list of source files defines one shot per file
+  std::vector<std::string> source_files;
+  if (Node["source-file"].IsSequence()) {
+    source_files = Node["source-file"].as<std::vector<std::string> >();
+  } else {
+    source_files = { Node["source-file"].as<std::string>() };
+  }
+  if (source_files.empty()) {
+    throw std::runtime_error("databases.source-file defines no shot");
+  }
+
+  // The internal mesher replaces the mesh database
+  const bool internal_mesh = static_cast<bool>(Node["internal-mesh"]);
+  if (internal_mesh && Node["mesh-database"]) {
+    throw std::runtime_error("databases.internal-mesh and "
+                             "databases.mesh-database are exclusive");
+  }
+
   *this = specfem::runtime_configuration::database_configuration(
-      Node["mesh-database"].as<std::string>(),
-      Node["source-file"].as<std::string>());
+      internal_mesh ? "" : Node["mesh-database"].as<std::string>(),
+      source_files, setup_cache);
+
+  if (internal_mesh) {
+    this->internal_mesh = true;
+    this->layered_model = read_layered_model(Node["internal-mesh"]);
+  }
+
+  if (Node["location-cache"]) {
+    this->location_cache = Node["location-cache"].as<std::string>();
+  }
+
+  if (Node["velocity-model"]) {
+    const YAML::Node &model = Node["velocity-model"];
+    this->velocity_model = model["file"].as<std::string>();
+    if (model["tile-rows"]) {
+      this->velocity_model_tile_rows = model["tile-rows"].as<int>();
+    }
+  }
 }
 
 specfem::runtime_configuration::setup::setup(std::string parameter_file) {
@@ -146,9 +919,48 @@ specfem::runtime_configuration::setup::setup(std::string parameter_file) {
   const YAML::Node &n_run_setup = runtime_config["run-setup"];
   const YAML::Node &n_databases = runtime_config["databases"];
   const YAML::Node &n_seismogram = runtime_config["seismogram"];
+  const YAML::Node &n_wavefield = runtime_config["wavefield"];
+  const YAML::Node &n_checkpoint = runtime_config["checkpoint"];
+  const YAML::Node &n_spectrum = runtime_config["spectrum"];
+  const YAML::Node &n_adjoint = runtime_config["adjoint"];
+  const YAML::Node &n_injection = runtime_config["injection"];
+  const YAML::Node &n_misfit = runtime_config["misfit"];
 
   this->header = new specfem::runtime_configuration::header(n_header);
 
+  if (simulation_setup["wave"]) {
+    const std::string wave = simulation_setup["wave"].as<std::string>();
+    if (wave == "p-sv") {
+      this->wave = specfem::wave::p_sv;
+    } else if (wave == "sh") {
+      this->wave = specfem::wave::sh;
+    } else {
+      std::ostringstream message;
+      message << "Wave type : " << wave << " not recognized. Use p-sv or sh.";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  if (simulation_setup["precision"]) {
+    const std::string precision =
+        simulation_setup["precision"].as<std::string>();
+    if (precision != "float" && precision != "double" &&
+        precision != "mixed") {
+      std::ostringstream message;
+      message << "Precision : " << precision
+              << " not recognized. Use float, double or mixed.";
+      throw std::runtime_error(message.str());
+    }
+    // The policy is compiled into every struct, see specfem::precision_type
+    if (precision != specfem::precision_name) {
+      std::ostringstream message;
+      message << "Precision : " << precision << " requested but this build "
+              << "uses " << specfem::precision_name
+              << ". Run a build configured with -DPRECISION=" << precision;
+      throw std::runtime_error(message.str());
+    }
+  }
+
   try {
     const YAML::Node &n_time_marching = n_solver["time-marching"];
     const YAML::Node &n_timescheme = n_time_marching["time-scheme"];
@@ -185,6 +997,33 @@ specfem::runtime_configuration::setup::setup(std::string parameter_file) {
 
   this->seismogram =
       new specfem::runtime_configuration::seismogram(n_seismogram);
+
+  if (n_wavefield) {
+    this->wavefield =
+        new specfem::runtime_configuration::wavefield(n_wavefield);
+  }
+
+  if (n_checkpoint) {
+    this->checkpoint =
+        new specfem::runtime_configuration::checkpoint(n_checkpoint);
+  }
+
+  if (n_spectrum) {
+    this->spectrum = new specfem::runtime_configuration::spectrum(n_spectrum);
+  }
+
+  if (n_adjoint) {
+    this->adjoint = new specfem::runtime_configuration::adjoint(n_adjoint);
+  }
+
+  if (n_injection) {
+    this->injection =
+        new specfem::runtime_configuration::injection(n_injection);
+  }
+
+  if (n_misfit) {
+    this->misfit = new specfem::runtime_configuration::misfit(n_misfit);
+  }
 }
 
 std::string specfem::runtime_configuration::setup::print_header(
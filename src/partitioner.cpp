@@ -0,0 +1,159 @@
+#include "../include/partitioner.h"
+#include "../include/config.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/material.h"
+#include "../include/mesh.h"
+#include "../include/reordering.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+std::vector<type_real> specfem::partitioner::element_weights(
+    const specfem::mesh &mesh,
+    const std::vector<specfem::material *> &materials,
+    const specfem::partitioner::weights &weights) {
+
+  std::vector<type_real> element_weights(mesh.nspec, 0.0);
+
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    const int imat = mesh.material_ind.kmato(ispec);
+    switch (materials[imat]->get_ispec_type()) {
+    case specfem::elements::elastic:
+      element_weights[ispec] = weights.elastic;
+      break;
+    case specfem::elements::acoustic:
+      element_weights[ispec] = weights.acoustic;
+      break;
+    case specfem::elements::poroelastic:
+      element_weights[ispec] = weights.poroelastic;
+      break;
+    }
+
+    if (mesh.material_ind.region_CPML(ispec) != 0)
+      element_weights[ispec] += weights.pml;
+  }
+
+  // Elements with several absorbing edges are only counted once
+  std::vector<bool> absorbing(mesh.nspec, false);
+  for (int inum = 0; inum < mesh.parameters.nelemabs; inum++)
+    absorbing[mesh.abs_boundary.numabs(inum)] = true;
+
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    if (absorbing[ispec])
+      element_weights[ispec] += weights.absorbing;
+  }
+
+  return element_weights;
+}
+
+std::vector<type_real>
+specfem::partitioner::read_element_weights(const std::string &filename,
+                                           const int nspec) {
+
+  std::ifstream file(filename);
+  if (!file.is_open())
+    throw std::runtime_error("Could not open element weights " + filename);
+
+  std::vector<type_real> element_weights(nspec, -1.0);
+  int ispec;
+  type_real weight;
+  while (file >> ispec >> weight) {
+    if (ispec < 0 || ispec >= nspec || weight < 0.0) {
+      std::ostringstream message;
+      message << "Element weights " << filename << " : invalid weight "
+              << weight << " of element " << ispec << " of a mesh of "
+              << nspec << " elements";
+      throw std::runtime_error(message.str());
+    }
+    element_weights[ispec] = weight;
+  }
+  if (!file.eof())
+    throw std::runtime_error("Element weights " + filename +
+                             " : expected an element and a weight per line");
+
+  for (ispec = 0; ispec < nspec; ispec++) {
+    if (element_weights[ispec] < 0.0) {
+      std::ostringstream message;
+      message << "Element weights " << filename
+              << " : missing weight of element " << ispec;
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  return element_weights;
+}
+
+std::vector<int> specfem::partitioner::partition_elements(
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const std::vector<type_real> &element_weights, const int nparts) {
+
+  const int nspec = knods.extent(1);
+
+  if (nparts < 1 || nparts > nspec) {
+    std::ostringstream message;
+    message << "Can't partition " << nspec << " elements into " << nparts
+            << " parts";
+    throw std::runtime_error(message.str());
+  }
+
+  const std::vector<int> order =
+      specfem::reordering::morton_order(coorg, knods);
+
+  type_real total = 0.0;
+  for (int ispec = 0; ispec < nspec; ispec++)
+    total += element_weights[ispec];
+  const type_real target = total / nparts;
+
+  // An element is assigned to the next part once the part is full up to the
+  // middle of the element, or once the remaining elements are needed to fill
+  // the remaining parts
+  std::vector<int> element_partition(nspec);
+  type_real cumulative = 0.0;
+  int ipart = 0;
+  int nelements = 0;
+  for (int i = 0; i < nspec; i++) {
+    const int ispec = order[i];
+    const type_real weight = element_weights[ispec];
+    const bool full = (cumulative + 0.5 * weight > (ipart + 1) * target);
+    const bool needed = (nspec - i == nparts - 1 - ipart);
+    if (ipart < nparts - 1 && nelements > 0 && (full || needed)) {
+      ipart++;
+      nelements = 0;
+    }
+    element_partition[ispec] = ipart;
+    cumulative += weight;
+    nelements++;
+  }
+
+  return element_partition;
+}
+
+std::string
+specfem::partitioner::print(const std::vector<type_real> &element_weights,
+                            const std::vector<int> &element_partition,
+                            const int nparts) {
+
+  std::vector<type_real> costs(nparts, 0.0);
+  type_real total = 0.0;
+  for (int ispec = 0; ispec < element_partition.size(); ispec++) {
+    costs[element_partition[ispec]] += element_weights[ispec];
+    total += element_weights[ispec];
+  }
+
+  const type_real imbalance =
+      *std::max_element(costs.begin(), costs.end()) * nparts / total;
+
+  std::ostringstream message;
+  message << "Mesh partitioning:\n"
+          << "------------------------------\n"
+          << "Number of partitions : " << nparts << "\n"
+          << "Cost of the most expensive partition relative to the mean : "
+          << imbalance << "\n";
+
+  return message.str();
+}
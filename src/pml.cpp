@@ -0,0 +1,504 @@
+#include "../include/pml.h"
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/constants.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/quadrature.h"
+#include "../include/specfem_mpi.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+// Columns of the coefficients of every PML point
+struct coefficient {
+  enum { xix, xiz, gammax, gammaz, jacobian, mu, lambdaplus2mu, mass, ncols };
+};
+
+// Columns of the damping profile of every PML point. beta = alpha + d, and
+// the convolution of f with exp(-gamma t) is updated as psi = b psi + c f
+struct profile_column {
+  enum {
+    dx,
+    dz,
+    alphax,
+    alphaz,
+    b_alphax,
+    c_alphax,
+    b_alphaz,
+    c_alphaz,
+    b_betax,
+    c_betax,
+    b_betaz,
+    c_betaz,
+    ncols
+  };
+};
+
+// Coefficients of the recursive filter of a convolution with exp(-gamma t)
+static void filter_coefficients(const type_real gamma, const type_real dt,
+                                type_real &b, type_real &c) {
+  b = std::exp(-1.0 * gamma * dt);
+  c = (gamma * dt > 1e-6) ? (1.0 - b) / gamma : dt;
+}
+
+specfem::boundaries::pml_layer::pml_layer(
+    const specfem::kokkos::HostView1d<int> region_CPML,
+    const specfem::compute::compute *compute, const specfem::MPI::MPI *mpi) {
+
+  const auto h_ibool = compute->h_ibool;
+  const auto coord = compute->coordinates.coord;
+  const int nspec = h_ibool.extent(0);
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+
+  if (static_cast<int>(region_CPML.extent(0)) != nspec) {
+    throw std::runtime_error(
+        "PML flags are not given for every element of the mesh");
+  }
+
+  for (int idim = 0; idim < 2; idim++) {
+    this->interior[2 * idim] = std::numeric_limits<type_real>::max();
+    this->interior[2 * idim + 1] = std::numeric_limits<type_real>::lowest();
+    this->exterior[2 * idim] = std::numeric_limits<type_real>::max();
+    this->exterior[2 * idim + 1] = std::numeric_limits<type_real>::lowest();
+  }
+
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int iglob = h_ibool(ispec, iz, ix);
+        for (int idim = 0; idim < 2; idim++) {
+          const type_real value = coord(idim, iglob);
+          this->exterior[2 * idim] = std::min(this->exterior[2 * idim], value);
+          this->exterior[2 * idim + 1] =
+              std::max(this->exterior[2 * idim + 1], value);
+          if (region_CPML(ispec) != 0)
+            continue;
+          this->interior[2 * idim] = std::min(this->interior[2 * idim], value);
+          this->interior[2 * idim + 1] =
+              std::max(this->interior[2 * idim + 1], value);
+        }
+      }
+    }
+  }
+
+  for (int idim = 0; idim < 2; idim++) {
+    this->interior[2 * idim] =
+        mpi->all_reduce(this->interior[2 * idim], specfem::MPI::min);
+    this->interior[2 * idim + 1] =
+        mpi->all_reduce(this->interior[2 * idim + 1], specfem::MPI::max);
+    this->exterior[2 * idim] =
+        mpi->all_reduce(this->exterior[2 * idim], specfem::MPI::min);
+    this->exterior[2 * idim + 1] =
+        mpi->all_reduce(this->exterior[2 * idim + 1], specfem::MPI::max);
+  }
+
+  // A mesh made only of PML elements has no interior
+  if (this->interior[0] > this->interior[1] ||
+      this->interior[2] > this->interior[3]) {
+    throw std::runtime_error("Every element of the mesh is a PML element");
+  }
+
+  return;
+}
+
+type_real specfem::boundaries::pml_layer::distance(const int idim,
+                                                   const type_real coord,
+                                                   type_real &thickness) const {
+  const type_real lower = this->interior[2 * idim];
+  const type_real upper = this->interior[2 * idim + 1];
+  if (coord < lower) {
+    thickness = lower - this->exterior[2 * idim];
+    return lower - coord;
+  }
+  if (coord > upper) {
+    thickness = this->exterior[2 * idim + 1] - upper;
+    return coord - upper;
+  }
+  thickness = 0.0;
+  return 0.0;
+}
+
+specfem::boundaries::pml::pml(
+    const specfem::kokkos::HostView1d<int> region_CPML,
+    const specfem::boundaries::pml_layer &layer,
+    const specfem::compute::compute *compute,
+    const specfem::compute::partial_derivatives *partial_derivatives,
+    const specfem::compute::properties *properties,
+    const specfem::quadrature::quadrature *quadx,
+    const specfem::quadrature::quadrature *quadz,
+    const specfem::wave::type wave, const int nshots, const type_real f0,
+    const type_real reflection, const type_real dt)
+    : nshots(nshots) {
+
+  if (reflection <= 0.0 || reflection >= 1.0) {
+    throw std::runtime_error(
+        "PML reflection coefficient needs to be in (0, 1)");
+  }
+
+  this->ncomponents = (wave == specfem::wave::p_sv) ? 2 : 1;
+
+  const auto h_ibool = compute->h_ibool;
+  const auto coord = compute->coordinates.coord;
+  const int nspec = h_ibool.extent(0);
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  const auto wxgll = quadx->get_hw();
+  const auto wzgll = quadz->get_hw();
+  const auto ispec_type = properties->h_ispec_type;
+
+  if (static_cast<int>(region_CPML.extent(0)) != nspec) {
+    throw std::runtime_error(
+        "PML flags are not given for every element of the mesh");
+  }
+
+  std::vector<int> elements;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    if (region_CPML(ispec) != 0 &&
+        ispec_type(ispec) == specfem::elements::elastic)
+      elements.push_back(ispec);
+  }
+
+  this->nelements = elements.size();
+  if (this->nelements == 0)
+    return;
+
+  this->ibool = specfem::kokkos::DeviceView3d<int>(
+      "specfem::boundaries::pml::ibool", this->nelements, ngllz, ngllx);
+  this->coefficients = specfem::kokkos::DeviceView4d<type_real>(
+      "specfem::boundaries::pml::coefficients", this->nelements, ngllz, ngllx,
+      coefficient::ncols);
+  this->profile = specfem::kokkos::DeviceView4d<type_real>(
+      "specfem::boundaries::pml::profile", this->nelements, ngllz, ngllx,
+      profile_column::ncols);
+  this->memory_variables = specfem::kokkos::DeviceView4d<type_real>(
+      "specfem::boundaries::pml::memory_variables", this->nelements, ngllz,
+      ngllx, this->get_nvariables() * this->nshots);
+
+  const auto h_index = Kokkos::create_mirror_view(this->ibool);
+  const auto h_coefficients = Kokkos::create_mirror_view(this->coefficients);
+  const auto h_profile = Kokkos::create_mirror_view(this->profile);
+
+  for (int ielement = 0; ielement < this->nelements; ielement++) {
+    const int ispec = elements[ielement];
+    const int region = region_CPML(ispec);
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int iglob = h_ibool(ispec, iz, ix);
+        h_index(ielement, iz, ix) = iglob;
+
+        const type_real rho = properties->h_rho(ispec, iz, ix);
+        const type_real lambdaplus2mu =
+            properties->h_lambdaplus2mu(ispec, iz, ix);
+        const type_real jacobian =
+            partial_derivatives->h_jacobian(ispec, iz, ix);
+        const auto coefficients =
+            Kokkos::subview(h_coefficients, ielement, iz, ix, Kokkos::ALL);
+        coefficients(coefficient::xix) =
+            partial_derivatives->h_xix(ispec, iz, ix);
+        coefficients(coefficient::xiz) =
+            partial_derivatives->h_xiz(ispec, iz, ix);
+        coefficients(coefficient::gammax) =
+            partial_derivatives->h_gammax(ispec, iz, ix);
+        coefficients(coefficient::gammaz) =
+            partial_derivatives->h_gammaz(ispec, iz, ix);
+        coefficients(coefficient::jacobian) = jacobian;
+        coefficients(coefficient::mu) = properties->h_mu(ispec, iz, ix);
+        coefficients(coefficient::lambdaplus2mu) = lambdaplus2mu;
+        coefficients(coefficient::mass) =
+            wxgll(ix) * wzgll(iz) * jacobian * rho;
+
+        // Damping grows quadratically from 0 at the inner edge of the layer
+        // to d0 = -3 vp log(R) / (2 L) at the outer edge, while the
+        // frequency shift decreases linearly from pi f0 to 0
+        const type_real vp = std::sqrt(lambdaplus2mu / rho);
+        type_real damping[2];
+        type_real alpha[2];
+        for (int idim = 0; idim < 2; idim++) {
+          const bool stretched = (region == 3) || (region == idim + 1);
+          type_real thickness;
+          const type_real distance =
+              layer.distance(idim, coord(idim, iglob), thickness);
+          type_real ratio = 0.0;
+          damping[idim] = 0.0;
+          if (stretched && thickness > 0.0) {
+            ratio = std::min(distance / thickness, static_cast<type_real>(1.0));
+            damping[idim] = -3.0 * vp * std::log(reflection) /
+                            (2.0 * thickness) * ratio * ratio;
+          }
+          alpha[idim] = pi * f0 * (1.0 - ratio);
+        }
+
+        const auto profile =
+            Kokkos::subview(h_profile, ielement, iz, ix, Kokkos::ALL);
+        profile(profile_column::dx) = damping[0];
+        profile(profile_column::dz) = damping[1];
+        profile(profile_column::alphax) = alpha[0];
+        profile(profile_column::alphaz) = alpha[1];
+        filter_coefficients(alpha[0], dt, profile(profile_column::b_alphax),
+                            profile(profile_column::c_alphax));
+        filter_coefficients(alpha[1], dt, profile(profile_column::b_alphaz),
+                            profile(profile_column::c_alphaz));
+        filter_coefficients(alpha[0] + damping[0], dt,
+                            profile(profile_column::b_betax),
+                            profile(profile_column::c_betax));
+        filter_coefficients(alpha[1] + damping[1], dt,
+                            profile(profile_column::b_betaz),
+                            profile(profile_column::c_betaz));
+      }
+    }
+  }
+
+  Kokkos::deep_copy(this->ibool, h_index);
+  Kokkos::deep_copy(this->coefficients, h_coefficients);
+  Kokkos::deep_copy(this->profile, h_profile);
+
+  this->wxgll = quadx->get_w();
+  this->wzgll = quadz->get_w();
+  this->hprime_xx = quadx->get_hprime();
+  this->hprime_zz = quadz->get_hprime();
+  this->hprimewgll_xx = quadx->get_hprimewgll();
+  this->hprimewgll_zz = quadz->get_hprimewgll();
+
+  return;
+}
+
+void specfem::boundaries::pml::compute_interaction(
+    const specfem::kokkos::DeviceFieldView2d<type_real> field,
+    const specfem::kokkos::DeviceFieldView2d<type_real> field_dot,
+    const specfem::kokkos::DeviceFieldView2d<type_real> field_dot_dot,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) const {
+
+  if (this->nelements == 0)
+    return;
+
+  const int ngllz = this->ibool.extent(1);
+  const int ngllx = this->ibool.extent(2);
+  const int ngllxz = ngllx * ngllz;
+  const auto ibool = this->ibool;
+  const auto coefficients = this->coefficients;
+  const auto profile = this->profile;
+  const auto memory_variables = this->memory_variables;
+  const auto wxgll = this->wxgll;
+  const auto wzgll = this->wzgll;
+  const auto hprime_xx = this->hprime_xx;
+  const auto hprime_zz = this->hprime_zz;
+  const auto hprimewgll_xx = this->hprimewgll_xx;
+  const auto hprimewgll_zz = this->hprimewgll_zz;
+  const int ncomponents = this->ncomponents;
+  const bool p_sv = (ncomponents == 2);
+  const int nshots = this->nshots;
+  const int nvariables = this->get_nvariables();
+
+  const int scratch_size =
+      6 *
+      specfem::kokkos::DeviceScratchView2d<type_real>::shmem_size(ngllz, ngllx);
+
+  specfem::kokkos::DeviceTeam policy(exec_space, this->nelements,
+                                     Kokkos::AUTO, 1);
+  policy.set_scratch_size(0, Kokkos::PerTeam(scratch_size));
+
+  // PML elements are usually on the edges of the mesh and few, hence every
+  // point is assembled with atomics
+  specfem::kokkos::parallel_for(
+      "specfem::boundaries::pml::compute_interaction", policy,
+      KOKKOS_LAMBDA(
+          const specfem::kokkos::DeviceTeam::member_type &team_member) {
+        const int ielement = team_member.league_rank();
+
+        specfem::kokkos::DeviceScratchView2d<type_real> s_fieldx(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_fieldz(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempx1(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempz1(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempx3(
+            team_member.team_scratch(0), ngllz, ngllx);
+        specfem::kokkos::DeviceScratchView2d<type_real> s_tempz3(
+            team_member.team_scratch(0), ngllz, ngllx);
+
+        // The barrier following the field load also guarantees the
+        // contractions of the previous shot are done with the integrands
+        for (int ishot = 0; ishot < nshots; ishot++) {
+          const int icomponent = ishot * ncomponents;
+
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+                const int ix = xz % ngllx;
+                const int iz = xz / ngllx;
+                const int iglob = ibool(ielement, iz, ix);
+                s_fieldx(iz, ix) = field(iglob, icomponent);
+                if (p_sv)
+                  s_fieldz(iz, ix) = field(iglob, icomponent + 1);
+              });
+
+          team_member.team_barrier();
+
+          // Update the memory variables, compute the stress corrections and
+          // add the terms of the velocity
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+                const int ix = xz % ngllx;
+                const int iz = xz / ngllx;
+                const int iglob = ibool(ielement, iz, ix);
+
+                const auto c = Kokkos::subview(coefficients, ielement, iz, ix,
+                                               Kokkos::ALL);
+                const auto p =
+                    Kokkos::subview(profile, ielement, iz, ix, Kokkos::ALL);
+                const type_real xixl = c(coefficient::xix);
+                const type_real xizl = c(coefficient::xiz);
+                const type_real gammaxl = c(coefficient::gammax);
+                const type_real gammazl = c(coefficient::gammaz);
+                const type_real dx = p(profile_column::dx);
+                const type_real dz = p(profile_column::dz);
+                const type_real alphax = p(profile_column::alphax);
+                const type_real alphaz = p(profile_column::alphaz);
+
+                // Stretched minus regular gradient along x and z of every
+                // component
+                type_accum dgradx[2] = { 0, 0 };
+                type_accum dgradz[2] = { 0, 0 };
+
+                for (int icomp = 0; icomp < ncomponents; icomp++) {
+                  const auto s_field = (icomp == 0) ? s_fieldx : s_fieldz;
+                  type_accum dxi = 0;
+                  type_accum dgamma = 0;
+                  for (int l = 0; l < ngllx; l++)
+                    dxi += hprime_xx(ix, l) * s_field(iz, l);
+                  for (int l = 0; l < ngllz; l++)
+                    dgamma += hprime_zz(iz, l) * s_field(l, ix);
+                  const type_accum gradx = xixl * dxi + gammaxl * dgamma;
+                  const type_accum gradz = xizl * dxi + gammazl * dgamma;
+                  const type_real velocity =
+                      field_dot(iglob, icomponent + icomp);
+
+                  const auto m =
+                      Kokkos::subview(memory_variables, ielement, iz, ix,
+                                      Kokkos::make_pair(
+                                          ishot * nvariables + 9 * icomp,
+                                          ishot * nvariables + 9 * icomp + 9));
+
+                  // (s_z / s_x - 1) d/dx = dz F_alphaz - dx F_betax
+                  //                        - dx dz F_alphaz F_betax
+                  m(1) = p(profile_column::b_betax) * m(1) +
+                         p(profile_column::c_betax) * gradx;
+                  m(0) = p(profile_column::b_alphaz) * m(0) +
+                         p(profile_column::c_alphaz) * gradx;
+                  m(2) = p(profile_column::b_alphaz) * m(2) +
+                         p(profile_column::c_alphaz) * m(1);
+                  dgradx[icomp] = dz * m(0) - dx * m(1) - dx * dz * m(2);
+
+                  // (s_x / s_z - 1) d/dz = dx F_alphax - dz F_betaz
+                  //                        - dx dz F_alphax F_betaz
+                  m(4) = p(profile_column::b_betaz) * m(4) +
+                         p(profile_column::c_betaz) * gradz;
+                  m(3) = p(profile_column::b_alphax) * m(3) +
+                         p(profile_column::c_alphax) * gradz;
+                  m(5) = p(profile_column::b_alphax) * m(5) +
+                         p(profile_column::c_alphax) * m(4);
+                  dgradz[icomp] = dx * m(3) - dz * m(4) - dx * dz * m(5);
+
+                  // (s_x s_z - 1) acceleration = dx (v - alphax F_alphax v)
+                  //  + dz (v - alphaz F_alphaz v)
+                  //  + dx dz (F_alphax v - alphaz F_alphax F_alphaz v)
+                  m(7) = p(profile_column::b_alphaz) * m(7) +
+                         p(profile_column::c_alphaz) * velocity;
+                  m(6) = p(profile_column::b_alphax) * m(6) +
+                         p(profile_column::c_alphax) * velocity;
+                  m(8) = p(profile_column::b_alphax) * m(8) +
+                         p(profile_column::c_alphax) * m(7);
+                  const type_accum stretch =
+                      dx * (velocity - alphax * m(6)) +
+                      dz * (velocity - alphaz * m(7)) +
+                      dx * dz * (m(6) - alphaz * m(8));
+                  const type_real mass_term =
+                      -1.0 * c(coefficient::mass) * stretch;
+                  Kokkos::atomic_add(&field_dot_dot(iglob, icomponent + icomp),
+                                     mass_term);
+                }
+
+                // Rows of the stress contracted with the gradient of the
+                // test functions along x (t_x*) and z (t_z*)
+                const type_real mul = c(coefficient::mu);
+                const type_real jacobianl = c(coefficient::jacobian);
+                type_accum t_xx, t_xz, t_zx, t_zz;
+                if (p_sv) {
+                  const type_real lambdaplus2mul =
+                      c(coefficient::lambdaplus2mu);
+                  t_xx = lambdaplus2mul * dgradx[0];
+                  t_xz = mul * dgradx[1];
+                  t_zx = mul * dgradz[0];
+                  t_zz = lambdaplus2mul * dgradz[1];
+                } else {
+                  t_xx = mul * dgradx[0];
+                  t_zx = mul * dgradz[0];
+                  t_xz = 0;
+                  t_zz = 0;
+                }
+
+                s_tempx1(iz, ix) = jacobianl * (t_xx * xixl + t_zx * xizl);
+                s_tempz1(iz, ix) = jacobianl * (t_xz * xixl + t_zz * xizl);
+                s_tempx3(iz, ix) =
+                    jacobianl * (t_xx * gammaxl + t_zx * gammazl);
+                s_tempz3(iz, ix) =
+                    jacobianl * (t_xz * gammaxl + t_zz * gammazl);
+              });
+
+          team_member.team_barrier();
+
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team_member, ngllxz), [=](const int xz) {
+                const int ix = xz % ngllx;
+                const int iz = xz / ngllx;
+
+                type_accum tempx1 = 0;
+                type_accum tempz1 = 0;
+                type_accum tempx3 = 0;
+                type_accum tempz3 = 0;
+
+                for (int l = 0; l < ngllx; l++) {
+                  tempx1 += hprimewgll_xx(ix, l) * s_tempx1(iz, l);
+                  tempz1 += hprimewgll_xx(ix, l) * s_tempz1(iz, l);
+                }
+
+                for (int l = 0; l < ngllz; l++) {
+                  tempx3 += hprimewgll_zz(iz, l) * s_tempx3(l, ix);
+                  tempz3 += hprimewgll_zz(iz, l) * s_tempz3(l, ix);
+                }
+
+                const int iglob = ibool(ielement, iz, ix);
+                const type_real sum_terms1 =
+                    -1.0 * (wzgll(iz) * tempx1) - (wxgll(ix) * tempx3);
+                Kokkos::atomic_add(&field_dot_dot(iglob, icomponent),
+                                   sum_terms1);
+                if (p_sv) {
+                  const type_real sum_terms3 =
+                      -1.0 * (wzgll(iz) * tempz1) - (wxgll(ix) * tempz3);
+                  Kokkos::atomic_add(&field_dot_dot(iglob, icomponent + 1),
+                                     sum_terms3);
+                }
+              });
+        }
+      },
+      node);
+
+  return;
+}
+
+specfem::memory::usage specfem::boundaries::pml::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->ibool);
+  usage.add(this->coefficients);
+  usage.add(this->profile);
+  usage.add(this->memory_variables);
+
+  return usage;
+}
@@ -0,0 +1,113 @@
+#include "../include/progress.h"
+#include "../include/memory_report.h"
+#include "../include/specfem_mpi.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Duration formatted as hh:mm:ss
+static std::string clock_time(const double seconds) {
+  const long total = static_cast<long>(seconds + 0.5);
+  std::ostringstream message;
+  message << std::setfill('0') << std::setw(2) << total / 3600 << ":"
+          << std::setw(2) << (total / 60) % 60 << ":" << std::setw(2)
+          << total % 60;
+  return message.str();
+}
+
+specfem::progress::reporter::reporter(const specfem::MPI::MPI *mpi,
+                                      const double interval,
+                                      const double nelements,
+                                      const std::string &status_file)
+    : active(mpi->main_proc() && interval >= 0.0), interval(interval),
+      nelements(nelements), status_file(status_file) {}
+
+void specfem::progress::reporter::update(const int nexecuted,
+                                         const int nstep,
+                                         const std::string &name) {
+  if (!this->active)
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+  if (name != this->name || nexecuted < this->nexecuted) {
+    this->name = name;
+    this->nfirst = nexecuted;
+    this->begin = now;
+    this->last = now;
+  }
+  this->nexecuted = nexecuted;
+  this->nstep = nstep;
+
+  const std::chrono::duration<double> elapsed = now - this->last;
+  if (elapsed.count() < this->interval && nexecuted < nstep)
+    return;
+
+  this->last = now;
+  this->report("running");
+}
+
+void specfem::progress::reporter::finish() {
+  if (!this->active || this->nexecuted < 0)
+    return;
+  this->last = std::chrono::steady_clock::now();
+  this->report("finished");
+}
+
+void specfem::progress::reporter::report(const std::string &state) {
+
+  // Rates since the start of the running loop
+  const std::chrono::duration<double> elapsed = this->last - this->begin;
+  const int nsteps = this->nexecuted - this->nfirst;
+  const double steps_per_second =
+      (elapsed.count() > 0.0) ? nsteps / elapsed.count() : 0.0;
+  const double elements_per_second = steps_per_second * this->nelements;
+  const double eta =
+      (steps_per_second > 0.0)
+          ? (this->nstep - this->nexecuted) / steps_per_second
+          : 0.0;
+  const auto memory = specfem::memory::tracked_current();
+  const double memory_bytes = static_cast<double>(memory.device + memory.host);
+
+  std::ostringstream message;
+  message << "Progress : executed " << this->nexecuted << " " << this->name
+          << " of " << this->nstep << " " << this->name << ", "
+          << std::fixed << std::setprecision(1) << steps_per_second << " "
+          << this->name << "/s, " << std::scientific << std::setprecision(3)
+          << elements_per_second << " elements/s, ETA " << clock_time(eta)
+          << ", memory " << std::fixed << std::setprecision(1)
+          << memory_bytes / (1024.0 * 1024.0) << " MB";
+  this->message = message.str();
+  std::cout << this->message << std::endl;
+
+  if (this->status_file.empty())
+    return;
+
+  // Write a temporary file and rename it, pollers never read a partial file
+  const std::string temporary = this->status_file + ".tmp";
+  {
+    std::ofstream file(temporary);
+    if (!file.is_open())
+      throw std::runtime_error("Could not open status file " + temporary);
+    file << std::setprecision(9) << "{\"state\": \"" << state
+         << "\", \"name\": \"" << this->name
+         << "\", \"step\": " << this->nexecuted
+         << ", \"nstep\": " << this->nstep
+         << ", \"steps_per_second\": " << steps_per_second
+         << ", \"elements_per_second\": " << elements_per_second
+         << ", \"eta_seconds\": " << eta
+         << ", \"memory_bytes\": " << memory_bytes << "}\n";
+  }
+  if (std::rename(temporary.c_str(), this->status_file.c_str()) != 0)
+    throw std::runtime_error("Could not write status file " +
+                             this->status_file);
+}
+
+specfem::progress::reporter *specfem::progress::disabled() {
+  static specfem::progress::reporter instance;
+  return &instance;
+}
@@ -1,6 +1,7 @@
 #include "../include/quadrature.h"
 #include "../include/config.h"
 #include "../include/gll_library.h"
+#include "../include/gll_tables.h"
 #include "../include/kokkos_abstractions.h"
 #include "../include/lagrange_poly.h"
 #include <Kokkos_Core.hpp>
@@ -12,6 +13,22 @@ using DeviceView2d = specfem::kokkos::DeviceView2d<type_real>;
 using HostMirror1d = specfem::kokkos::HostMirror1d<type_real>;
 using HostMirror2d = specfem::kokkos::HostMirror2d<type_real>;
 
+// Copy the compile-time table of NGLL points into host views
+template <int NGLL>
+static void assign_gll_table(HostMirror1d h_xi, HostMirror1d h_w,
+                             HostMirror2d h_hprime,
+                             HostMirror2d h_hprimewgll) {
+  constexpr auto table = specfem::quadrature::gll_tables<type_real, NGLL>;
+  for (int i = 0; i < NGLL; i++) {
+    h_xi(i) = table.xi[i];
+    h_w(i) = table.w[i];
+    for (int j = 0; j < NGLL; j++) {
+      h_hprime(i, j) = table.hprime[i][j];
+      h_hprimewgll(i, j) = table.hprimewgll[i][j];
+    }
+  }
+}
+
 void specfem::quadrature::quadrature::set_allocations() {
   xi = specfem::kokkos::DeviceView1d<type_real>(
       "specfem::quadrature::quadrature::DeviceView1d::xi", N);
@@ -22,12 +39,16 @@ void specfem::quadrature::quadrature::set_allocations() {
   hprime = specfem::kokkos::DeviceView2d<type_real>(
       "specfem::quadrature::quadrature::DeviceView1d::hprime", N, N);
   h_hprime = Kokkos::create_mirror_view(hprime);
+  hprimewgll = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::quadrature::quadrature::DeviceView2d::hprimewgll", N, N);
+  h_hprimewgll = Kokkos::create_mirror_view(hprimewgll);
 }
 
 void specfem::quadrature::quadrature::sync_views() {
   Kokkos::deep_copy(xi, h_xi);
   Kokkos::deep_copy(w, h_w);
   Kokkos::deep_copy(hprime, h_hprime);
+  Kokkos::deep_copy(hprimewgll, h_hprimewgll);
 }
 
 specfem::quadrature::quadrature::quadrature() : alpha(0.0), beta(0.0), N(5) {
@@ -60,9 +81,50 @@ specfem::quadrature::quadrature::quadrature(const type_real alpha,
 }
 
 void specfem::quadrature::quadrature::set_derivation_matrices() {
+  if (this->has_gll_table()) {
+    switch (this->N) {
+    case 3:
+      assign_gll_table<3>(h_xi, h_w, h_hprime, h_hprimewgll);
+      break;
+    case 4:
+      assign_gll_table<4>(h_xi, h_w, h_hprime, h_hprimewgll);
+      break;
+    case 5:
+      assign_gll_table<5>(h_xi, h_w, h_hprime, h_hprimewgll);
+      break;
+    case 6:
+      assign_gll_table<6>(h_xi, h_w, h_hprime, h_hprimewgll);
+      break;
+    case 7:
+      assign_gll_table<7>(h_xi, h_w, h_hprime, h_hprimewgll);
+      break;
+    case 8:
+      assign_gll_table<8>(h_xi, h_w, h_hprime, h_hprimewgll);
+      break;
+    case 9:
+      assign_gll_table<9>(h_xi, h_w, h_hprime, h_hprimewgll);
+      break;
+    default:
+      assign_gll_table<10>(h_xi, h_w, h_hprime, h_hprimewgll);
+      break;
+    }
+    this->sync_views();
+    return;
+  }
+
   gll_library::zwgljd(this->h_xi, this->h_w, this->N, this->alpha, this->beta);
-  Lagrange::compute_lagrange_derivatives_GLL(this->h_hprime, this->h_xi,
+  if (this->is_glj()) {
+    Lagrange::compute_jacobi_derivatives_GLJ(this->h_hprime, this->h_xi,
                                              this->N);
+  } else {
+    Lagrange::compute_lagrange_derivatives_GLL(this->h_hprime, this->h_xi,
+                                               this->N);
+  }
+  for (int i = 0; i < this->N; i++) {
+    for (int j = 0; j < this->N; j++) {
+      this->h_hprimewgll(i, j) = this->h_hprime(j, i) * this->h_w(j);
+    }
+  }
   this->sync_views();
 }
 
@@ -76,6 +138,10 @@ DeviceView2d specfem::quadrature::quadrature::get_hprime() const {
   return this->hprime;
 }
 
+DeviceView2d specfem::quadrature::quadrature::get_hprimewgll() const {
+  return this->hprimewgll;
+}
+
 HostMirror1d specfem::quadrature::quadrature::get_hxi() const {
   return this->h_xi;
 }
@@ -88,4 +154,17 @@ HostMirror2d specfem::quadrature::quadrature::get_hhprime() const {
   return this->h_hprime;
 }
 
+HostMirror2d specfem::quadrature::quadrature::get_hhprimewgll() const {
+  return this->h_hprimewgll;
+}
+
 int specfem::quadrature::quadrature::get_N() const { return this->N; };
+
+bool specfem::quadrature::quadrature::has_gll_table() const {
+  // Quadratures have at least 3 points
+  return this->alpha == 0.0 && this->beta == 0.0 && this->N <= 10;
+}
+
+bool specfem::quadrature::quadrature::is_glj() const {
+  return this->alpha == 0.0 && this->beta == 1.0;
+}
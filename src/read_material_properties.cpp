@@ -6,7 +6,7 @@
 #include <vector>
 
 std::vector<specfem::material *>
-IO::read_material_properties(std::ifstream &stream, const int numat,
+IO::read_material_properties(std::istream &stream, const int numat,
                              const specfem::MPI::MPI *mpi) {
 
   specfem::utilities::input_holder read_values;
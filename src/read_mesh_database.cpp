@@ -9,10 +9,130 @@
 #include <Kokkos_Core.hpp>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
-std::tuple<int, int, int>
-IO::fortran_database::read_mesh_database_header(std::ifstream &stream,
+// Read a file with a single bulk read. Returns false if the file can't be
+// read
+static bool read_file(const std::string &filename, std::string &content) {
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+  if (!file.is_open())
+    return false;
+
+  const std::streamsize size = file.tellg();
+  file.seekg(0, std::ios::beg);
+  content.resize(size);
+  return static_cast<bool>(file.read(&content[0], size));
+}
+
+std::string
+IO::fortran_database::read_database_file(const std::string &filename,
+                                         const specfem::MPI::MPI *mpi) {
+
+  std::string content;
+
+#ifdef MPI_PARALLEL
+  const MPI_Comm node_comm = mpi->get_node_comm();
+  const int node_size = mpi->get_node_size();
+  const bool aggregator = (mpi->get_node_rank() == 0);
+
+  // Gather filenames on the aggregator of the node
+  const int length = filename.size();
+  std::vector<int> lengths(node_size), offsets(node_size + 1, 0);
+  MPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0, node_comm);
+  for (int irank = 0; irank < node_size; irank++)
+    offsets[irank + 1] = offsets[irank] + lengths[irank];
+
+  std::string filenames(aggregator ? offsets[node_size] : 0, '\0');
+  MPI_Gatherv(filename.data(), length, MPI_CHAR, &filenames[0],
+              lengths.data(), offsets.data(), MPI_CHAR, 0, node_comm);
+
+  // Every distinct file is read once. Files the aggregator can't read are
+  // reported as missing, files too large to be scattered are read directly
+  // by their process
+  constexpr int missing = -1, direct = -2;
+  std::vector<std::string> names(node_size);
+  std::map<std::string, std::string> files;
+  std::vector<int> sizes(node_size, 0);
+  int shared = 1;
+  if (aggregator) {
+    for (int irank = 0; irank < node_size; irank++) {
+      names[irank] = filenames.substr(offsets[irank], lengths[irank]);
+      if (files.find(names[irank]) == files.end()) {
+        std::string file_content;
+        if (!read_file(names[irank], file_content))
+          file_content.clear();
+        files[names[irank]] = file_content;
+      }
+    }
+    shared = (files.size() == 1);
+
+    std::size_t total = 0;
+    for (const auto &[name, file_content] : files)
+      total += file_content.size();
+    const std::size_t max_size = std::numeric_limits<int>::max();
+
+    for (int irank = 0; irank < node_size; irank++) {
+      const std::string &file_content = files[names[irank]];
+      if (file_content.empty()) {
+        sizes[irank] = missing;
+      } else if ((shared && file_content.size() > max_size) ||
+                 (!shared && total > max_size)) {
+        sizes[irank] = direct;
+      } else {
+        sizes[irank] = file_content.size();
+      }
+    }
+  }
+
+  int size;
+  MPI_Scatter(sizes.data(), 1, MPI_INT, &size, 1, MPI_INT, 0, node_comm);
+  MPI_Bcast(&shared, 1, MPI_INT, 0, node_comm);
+
+  if (shared && size > 0) {
+    // Every process of the node reads the same file
+    if (aggregator)
+      content = std::move(files.begin()->second);
+    content.resize(size);
+    MPI_Bcast(&content[0], size, MPI_CHAR, 0, node_comm);
+  } else if (!shared) {
+    std::string send_buffer;
+    std::vector<int> send_counts(node_size, 0), send_offsets(node_size, 0);
+    if (aggregator) {
+      for (int irank = 0; irank < node_size; irank++) {
+        send_offsets[irank] = send_buffer.size();
+        if (sizes[irank] > 0) {
+          send_counts[irank] = sizes[irank];
+          send_buffer += files[names[irank]];
+        }
+      }
+    }
+    content.resize(std::max(size, 0));
+    MPI_Scatterv(send_buffer.data(), send_counts.data(), send_offsets.data(),
+                 MPI_CHAR, &content[0], std::max(size, 0), MPI_CHAR, 0,
+                 node_comm);
+  }
+
+  if (size == direct && !read_file(filename, content))
+    size = missing;
+
+  if (size == missing)
+    throw std::runtime_error("Could not open database file");
+#else
+  if (!read_file(filename, content))
+    throw std::runtime_error("Could not open database file");
+#endif
+
+  return content;
+}
+
+std::tuple<int, int, int, bool>
+IO::fortran_database::read_mesh_database_header(std::istream &stream,
                                                 const specfem::MPI::MPI *mpi) {
   // This subroutine reads header values of the database which are skipped
   std::string dummy_s;
@@ -20,6 +140,7 @@ IO::fortran_database::read_mesh_database_header(std::ifstream &stream,
   type_real dummy_d, dummy_d1;
   bool dummy_b, dummy_b1, dummy_b2, dummy_b3;
   int nspec, npgeo, nproc;
+  bool axisym;
 
   specfem::fortran_IO::fortran_read_line(stream, &dummy_s); // title
   specfem::fortran_IO::fortran_read_line(
@@ -115,7 +236,7 @@ IO::fortran_database::read_mesh_database_header(std::ifstream &stream,
   specfem::fortran_IO::fortran_read_line(
       stream, &dummy_d,
       &dummy_d1); // Q0_poroelastic,freq0_poroelastic
-  specfem::fortran_IO::fortran_read_line(stream, &dummy_b); // AXISYM
+  specfem::fortran_IO::fortran_read_line(stream, &axisym); // AXISYM
   specfem::fortran_IO::fortran_read_line(stream, &dummy_b); // psv
   specfem::fortran_IO::fortran_read_line(stream,
                                          &dummy_d); // factor_subsample_image
@@ -161,38 +282,51 @@ IO::fortran_database::read_mesh_database_header(std::ifstream &stream,
 
   mpi->sync_all();
 
-  return std::make_tuple(nspec, npgeo, nproc);
+  return std::make_tuple(nspec, npgeo, nproc, axisym);
 }
 
 specfem::kokkos::HostView2d<type_real>
-IO::fortran_database::read_coorg_elements(std::ifstream &stream,
+IO::fortran_database::read_coorg_elements(std::istream &stream,
                                           const int npgeo,
                                           const specfem::MPI::MPI *mpi) {
 
-  int ipoin = 0;
-
-  type_real coorgi, coorgj;
-  int buffer_length;
   specfem::kokkos::HostView2d<type_real> coorg("specfem::mesh::coorg", ndim,
                                                npgeo);
 
+  IO::fortran_database::read_coorg_elements(stream, npgeo, coorg, true, mpi);
+
+  return coorg;
+}
+
+void IO::fortran_database::read_coorg_elements(
+    std::istream &stream, const int npgeo,
+    const specfem::kokkos::HostView2d<type_real> coorg, const bool store,
+    const specfem::MPI::MPI *mpi) {
+
+  // Records of the form (ipoin, x, z) are read in bulk
+  specfem::kokkos::HostView1d<int> ipoin("specfem::mesh::ipoin", npgeo);
+  specfem::kokkos::HostView2d<type_real> coordinates(
+      "specfem::mesh::coordinates", npgeo, ndim);
+  specfem::fortran_IO::fortran_read_records(stream, npgeo, ipoin, coordinates);
+
   for (int i = 0; i < npgeo; i++) {
-    specfem::fortran_IO::fortran_read_line(stream, &ipoin, &coorgi, &coorgj);
-    if (ipoin < 1 || ipoin > npgeo) {
+    if (ipoin(i) < 1 || ipoin(i) > npgeo) {
       throw std::runtime_error("Error reading coordinates");
     }
+    if (!store)
+      continue;
     // coorg stores the x,z for every control point
     // coorg([0, 2), i) = [x, z]
-    coorg(0, ipoin - 1) = coorgi;
-    coorg(1, ipoin - 1) = coorgj;
+    coorg(0, ipoin(i) - 1) = coordinates(i, 0);
+    coorg(1, ipoin(i) - 1) = coordinates(i, 1);
   }
 
-  return coorg;
+  return;
 }
 
 std::tuple<int, type_real, bool>
 IO::fortran_database::read_mesh_database_attenuation(
-    std::ifstream &stream, const specfem::MPI::MPI *mpi) {
+    std::istream &stream, const specfem::MPI::MPI *mpi) {
 
   int n_sls;
   type_real attenuation_f0_reference;
@@ -209,21 +343,27 @@ IO::fortran_database::read_mesh_database_attenuation(
                          read_velocities_at_f0);
 }
 
-void IO::fortran_database::read_mesh_database_coupled(
-    std::ifstream &stream, const int num_fluid_solid_edges,
+specfem::surfaces::fluid_solid_edges
+IO::fortran_database::read_mesh_database_coupled(
+    std::istream &stream, const int num_fluid_solid_edges,
     const int num_fluid_poro_edges, const int num_solid_poro_edges,
     const specfem::MPI::MPI *mpi) {
 
   int dummy_i, dummy_i1;
 
-  if (num_fluid_solid_edges > 0 || num_fluid_poro_edges > 0 ||
-      num_solid_poro_edges > 0) {
-    mpi->cout("\n Warning coupled surfaces haven't been implemented yet \n");
+  if (num_fluid_poro_edges > 0 || num_solid_poro_edges > 0) {
+    mpi->cout("\n Warning poroelastic coupled surfaces haven't been "
+              "implemented yet \n");
   }
 
-  if (num_fluid_solid_edges > 0) {
-    for (int inum = 0; inum < num_fluid_solid_edges; inum++)
-      specfem::fortran_IO::fortran_read_line(stream, &dummy_i, &dummy_i1);
+  // Element indices are 1-based in databases
+  specfem::surfaces::fluid_solid_edges fluid_solid(num_fluid_solid_edges);
+  for (int inum = 0; inum < num_fluid_solid_edges; inum++) {
+    int ispec_acoustic, ispec_elastic;
+    specfem::fortran_IO::fortran_read_line(stream, &ispec_acoustic,
+                                           &ispec_elastic);
+    fluid_solid.ispec_acoustic(inum) = ispec_acoustic - 1;
+    fluid_solid.ispec_elastic(inum) = ispec_elastic - 1;
   }
 
   if (num_fluid_poro_edges > 0) {
@@ -235,5 +375,5 @@ void IO::fortran_database::read_mesh_database_coupled(
     for (int inum = 0; inum < num_solid_poro_edges; inum++)
       specfem::fortran_IO::fortran_read_line(stream, &dummy_i, &dummy_i1);
   }
-  return;
+  return fluid_solid;
 }
@@ -1,12 +1,23 @@
 #include "../include/read_sources.h"
 #include "../include/config.h"
+#include "../include/constants.h"
+#include "../include/enums.h"
 #include "../include/receiver.h"
 #include "../include/source.h"
 #include "../include/utils.h"
 #include "yaml-cpp/yaml.h"
-#include <boost/tokenizer.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 // void operator>>(YAML::Node &Node,
@@ -81,37 +92,209 @@ specfem::read_sources(const std::string sources_file, const type_real dt,
   return std::make_tuple(sources, t0);
 }
 
-std::vector<specfem::receivers::receiver *>
+std::tuple<std::vector<specfem::sources::source *>, std::vector<int>,
+           type_real>
+specfem::read_sources(const std::vector<std::string> &sources_files,
+                      const type_real dt, const specfem::MPI::MPI *mpi) {
+  std::vector<specfem::sources::source *> sources;
+  std::vector<int> shots;
+  for (int ishot = 0; ishot < sources_files.size(); ishot++) {
+    auto [shot_sources, shot_t0] =
+        specfem::read_sources(sources_files[ishot], dt, mpi);
+    sources.insert(sources.end(), shot_sources.begin(), shot_sources.end());
+    shots.insert(shots.end(), shot_sources.size(), ishot);
+  }
+
+  // Shots start at the earliest source of every shot
+  type_real t0 = std::numeric_limits<type_real>::max();
+  for (auto &source : sources) {
+    t0 = std::min(t0, source->get_t0());
+  }
+
+  for (auto &source : sources) {
+    source->update_tshift(source->get_t0() - t0);
+  }
+
+  return std::make_tuple(sources, shots, t0);
+}
+
+std::tuple<std::vector<specfem::sources::source *>, std::vector<int>,
+           type_real>
+specfem::reciprocal_sources(const specfem::receivers::receiver_set &receivers,
+                            const specfem::wave::type wave,
+                            const type_real dt) {
+
+  // The Dirac source time function is a gaussian of dominant frequency
+  // 1 / (10 dt), factor * exp(-a t^2) / (2 a)
+  const type_real f0 = 1.0 / (10.0 * dt);
+  const type_real a = pi * pi * f0 * f0;
+  const type_real factor = 2.0 * a * std::sqrt(a / pi);
+
+  // Forces along x and z for P-SV waves
+  std::vector<type_real> angles = { pi / 2.0, pi };
+  if (wave == specfem::wave::sh)
+    angles = { 0.0 };
+
+  std::vector<specfem::sources::source *> sources;
+  std::vector<int> shots;
+  for (int irec = 0; irec < receivers.size(); irec++) {
+    for (const type_real angle : angles) {
+      YAML::Node Node;
+      Node["x"] = receivers.x[irec];
+      Node["z"] = receivers.z[irec];
+      Node["angle"] = angle;
+      Node["Dirac"]["tshift"] = 0.0;
+      Node["Dirac"]["factor"] = factor;
+      shots.push_back(sources.size());
+      sources.push_back(new specfem::sources::force(Node, dt));
+    }
+  }
+
+  type_real t0 = std::numeric_limits<type_real>::max();
+  for (auto &source : sources) {
+    t0 = std::min(t0, source->get_t0());
+  }
+
+  return std::make_tuple(sources, shots, t0);
+}
+
+std::vector<specfem::sources::source *>
+specfem::adjoint_sources(const specfem::receivers::receiver_set &receivers,
+                         const specfem::wave::type wave,
+                         const std::string &residuals_folder,
+                         const type_real dt) {
+
+  // Seismograms record cos * ux + sin * uz along BXX and sin * ux + cos * uz
+  // along BXZ, forces along (sin(angle), -cos(angle)) apply the residuals
+  // along the same directions. SH seismograms record cos * uy along BXX
+  const type_real theta = pi / 180.0 * receivers.angle;
+  std::vector<std::pair<std::string, type_real> > components = {
+    { "BXX", theta + pi / 2.0 }, { "BXZ", pi - theta }
+  };
+  type_real factor = 1.0;
+  if (wave == specfem::wave::sh) {
+    components = { { "BXX", 0.0 } };
+    factor = receivers.get_cosine();
+  }
+
+  std::vector<specfem::sources::source *> sources;
+  for (int irec = 0; irec < receivers.size(); irec++) {
+    for (const auto &[component, angle] : components) {
+      const std::string filename =
+          residuals_folder + "/" + receivers.network_names[irec] +
+          receivers.station_names[irec] + component + ".adj";
+      if (!std::ifstream(filename).good())
+        continue;
+      YAML::Node Node;
+      Node["x"] = receivers.x[irec];
+      Node["z"] = receivers.z[irec];
+      Node["angle"] = angle;
+      Node["Tabulated"]["file"] = filename;
+      Node["Tabulated"]["factor"] = factor;
+      sources.push_back(new specfem::sources::force(Node, dt));
+    }
+  }
+
+  if (sources.empty()) {
+    std::ostringstream message;
+    message << "No residual file found in " << residuals_folder;
+    throw std::runtime_error(message.str());
+  }
+
+  return sources;
+}
+
+namespace {
+
+// Binary stations files start with the magic string, followed by the version
+// of the layout
+constexpr char stations_magic[8] = { 'S', 'P', 'E', 'C', 'F', 'E', 'M', 'S' };
+constexpr std::uint32_t stations_version = 1;
+
+// Read the columns of a binary stations file, the magic string being already
+// read
+void read_binary_stations(std::ifstream &stations,
+                          const std::string &stations_file,
+                          specfem::receivers::receiver_set &receivers) {
+
+  std::uint32_t version;
+  std::uint64_t nstations;
+  stations.read(reinterpret_cast<char *>(&version), sizeof(version));
+  stations.read(reinterpret_cast<char *>(&nstations), sizeof(nstations));
+  if (!stations || version != stations_version) {
+    std::ostringstream message;
+    message << "Stations file " << stations_file
+            << " was written with an unsupported layout";
+    throw std::runtime_error(message.str());
+  }
+
+  std::vector<double> x(nstations), z(nstations);
+  stations.read(reinterpret_cast<char *>(x.data()), nstations * sizeof(double));
+  stations.read(reinterpret_cast<char *>(z.data()), nstations * sizeof(double));
+  if (!stations) {
+    std::ostringstream message;
+    message << "Stations file " << stations_file << " is truncated";
+    throw std::runtime_error(message.str());
+  }
+
+  // Network and station names, every name being terminated by '\0'
+  const std::string names{ std::istreambuf_iterator<char>(stations),
+                           std::istreambuf_iterator<char>() };
+
+  std::size_t position = 0;
+  const auto next_name = [&]() {
+    const std::size_t end = names.find('\0', position);
+    if (end == std::string::npos) {
+      std::ostringstream message;
+      message << "Stations file " << stations_file << " is truncated";
+      throw std::runtime_error(message.str());
+    }
+    std::string name = names.substr(position, end - position);
+    position = end + 1;
+    return name;
+  };
+
+  for (std::uint64_t irec = 0; irec < nstations; irec++) {
+    const std::string network_name = next_name();
+    const std::string station_name = next_name();
+    receivers.add(network_name, station_name, static_cast<type_real>(x[irec]),
+                  static_cast<type_real>(z[irec]));
+  }
+}
+
+} // namespace
+
+specfem::receivers::receiver_set
 specfem::read_receivers(const std::string stations_file,
                         const type_real angle) {
 
-  boost::char_separator<char> sep(" ");
-  std::vector<specfem::receivers::receiver *> receivers;
-  std::fstream stations;
-  stations.open(stations_file, std::ios::in);
-  if (stations.is_open()) {
-    std::string line;
-    // Read stations file line by line
-    while (std::getline(stations, line)) {
-      // split every line with " " delimiter
-      boost::tokenizer<boost::char_separator<char> > tokens(line, sep);
-      std::vector<std::string> current_station;
-      for (const auto &t : tokens) {
-        current_station.push_back(t);
-      }
-      // check if the read line meets the format
-      assert(current_station.size() == 6);
-      // get the x and z coordinates of the station;
-      const std::string network_name = current_station[0];
-      const std::string station_name = current_station[1];
-      const type_real x = static_cast<type_real>(std::stod(current_station[2]));
-      const type_real z = static_cast<type_real>(std::stod(current_station[3]));
-
-      receivers.push_back(new specfem::receivers::receiver(
-          network_name, station_name, x, z, angle));
-    }
+  specfem::receivers::receiver_set receivers(angle);
+  std::ifstream stations(stations_file, std::ios::binary);
+  if (!stations.is_open())
+    return receivers;
 
-    stations.close();
+  char magic[sizeof(stations_magic)] = {};
+  stations.read(magic, sizeof(magic));
+  if (stations &&
+      std::memcmp(magic, stations_magic, sizeof(stations_magic)) == 0) {
+    read_binary_stations(stations, stations_file, receivers);
+    return receivers;
+  }
+
+  // Text file, every station being defined by 6 whitespace delimited values
+  stations.clear();
+  stations.seekg(0);
+  std::string network_name, station_name;
+  double x, z, elevation, burial;
+  while (stations >> network_name) {
+    if (!(stations >> station_name >> x >> z >> elevation >> burial)) {
+      std::ostringstream message;
+      message << "Station " << receivers.size() + 1 << " of stations file "
+              << stations_file << " is not defined by 6 values";
+      throw std::runtime_error(message.str());
+    }
+    receivers.add(network_name, station_name, static_cast<type_real>(x),
+                  static_cast<type_real>(z));
   }
 
   return receivers;
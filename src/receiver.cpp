@@ -2,72 +2,146 @@
 #include "../include/config.h"
 #include "../include/kokkos_abstractions.h"
 #include "../include/lagrange_poly.h"
+#include "../include/location_cache.h"
 #include "../include/quadrature.h"
 #include "../include/specfem_mpi.h"
 #include "../include/utils.h"
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-void specfem::receivers::receiver::locate(
+void specfem::receivers::receiver_set::add(const std::string &network_name,
+                                           const std::string &station_name,
+                                           const type_real x,
+                                           const type_real z) {
+  this->network_names.push_back(network_name);
+  this->station_names.push_back(station_name);
+  this->x.push_back(x);
+  this->z.push_back(z);
+  this->xi.push_back(0.0);
+  this->gamma.push_back(0.0);
+  this->ispec.push_back(-1);
+  this->islice.push_back(-1);
+}
+
+bool specfem::receivers::receiver_set::locate(
     const specfem::kokkos::HostView2d<type_real> coord,
-    const specfem::kokkos::HostMirror3d<int> h_ibool,
+    const specfem::kokkos::HostElementMirror3d<int> h_ibool,
     const specfem::kokkos::HostMirror1d<type_real> xigll,
-    const specfem::kokkos::HostMirror1d<type_real> zigll, const int nproc,
+    const specfem::kokkos::HostMirror1d<type_real> zigll,
     const specfem::kokkos::HostView2d<type_real> coorg,
-    const specfem::kokkos::HostView2d<int> knods, const int npgeo,
-    const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
-    const specfem::MPI::MPI *mpi) {
-  std::tie(this->xi, this->gamma, this->ispec, this->islice) =
-      specfem::utilities::locate(coord, h_ibool, xigll, zigll, nproc, this->x,
-                                 this->z, coorg, knods, npgeo, mpi);
-  if (this->islice == mpi->get_rank()) {
-    this->el_type = ispec_type(ispec);
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::MPI::MPI *mpi, const std::string &cache_file) {
+
+  const auto [locations, cached] = specfem::location_cache::locate(
+      cache_file, coord, h_ibool, xigll, zigll, this->x, this->z, coorg,
+      knods, mpi);
+
+  for (int irec = 0; irec < this->size(); irec++) {
+    const auto [xi, gamma, ispec, islice] = locations[irec];
+    this->set_location(irec, xi, gamma, ispec, islice);
   }
+
+  return cached;
 }
 
-void specfem::receivers::receiver::check_locations(
-    const type_real xmin, const type_real xmax, const type_real zmin,
-    const type_real zmax, const specfem::MPI::MPI *mpi) {
-  specfem::utilities::check_locations(this->x, this->z, xmin, xmax, zmin, zmax,
-                                      mpi);
+void specfem::receivers::receiver_set::set_location(const int irec,
+                                                    const type_real xi,
+                                                    const type_real gamma,
+                                                    const int ispec,
+                                                    const int islice) {
+  this->xi[irec] = xi;
+  this->gamma[irec] = gamma;
+  this->ispec[irec] = ispec;
+  this->islice[irec] = islice;
 }
 
-void specfem::receivers::receiver::compute_receiver_array(
-    const specfem::quadrature::quadrature &quadx,
-    const specfem::quadrature::quadrature &quadz,
-    specfem::kokkos::HostView3d<type_real> receiver_array) {
-  type_real xi = this->xi;
-  type_real gamma = this->gamma;
+specfem::receivers::receiver_set
+specfem::receivers::receiver_set::replicate(const int nshots) const {
+
+  if (nshots == 1)
+    return *this;
+
+  specfem::receivers::receiver_set receivers(this->angle);
+  for (int ishot = 0; ishot < nshots; ishot++) {
+    const std::string prefix = "shot" + std::to_string(ishot) + "_";
+    for (int irec = 0; irec < this->size(); irec++) {
+      receivers.add(prefix + this->network_names[irec],
+                    this->station_names[irec], this->x[irec], this->z[irec]);
+      receivers.set_location(receivers.size() - 1, this->xi[irec],
+                             this->gamma[irec], this->ispec[irec],
+                             this->islice[irec]);
+    }
+  }
 
-  auto [hxir, hpxir] = Lagrange::compute_lagrange_interpolants(
-      xi, quadx.get_N(), quadx.get_hxi());
-  auto [hgammar, hpgammar] = Lagrange::compute_lagrange_interpolants(
-      gamma, quadz.get_N(), quadz.get_hxi());
+  return receivers;
+}
+
+void specfem::receivers::receiver_set::check_locations(
+    const type_real xmin, const type_real xmax, const type_real zmin,
+    const type_real zmax, const specfem::MPI::MPI *mpi) const {
 
-  int nquadx = quadx.get_N();
-  int nquadz = quadz.get_N();
+  specfem::kokkos::HostView1d<type_real> lower(
+      "specfem::receivers::receiver_set::check_locations::lower", 2);
+  specfem::kokkos::HostView1d<type_real> upper(
+      "specfem::receivers::receiver_set::check_locations::upper", 2);
+  lower(0) = xmin;
+  lower(1) = zmin;
+  upper(0) = xmax;
+  upper(1) = zmax;
+  mpi->reduce(lower, specfem::MPI::min);
+  mpi->reduce(upper, specfem::MPI::max);
 
-  type_real hlagrange;
+  if (!mpi->main_proc())
+    return;
 
-  for (int i = 0; i < nquadx; i++) {
-    for (int j = 0; j < nquadz; j++) {
-      hlagrange = hxir(i) * hgammar(j);
-      receiver_array(j, i, 0) = hlagrange;
-      receiver_array(j, i, 1) = hlagrange;
+  for (int irec = 0; irec < this->size(); irec++) {
+    if (this->x[irec] < lower(0) || this->x[irec] > upper(0) ||
+        this->z[irec] < lower(1) || this->z[irec] > upper(1)) {
+      std::ostringstream message;
+      message << "Station " << this->network_names[irec]
+              << this->station_names[irec] << " at position (x,z) = "
+              << this->x[irec] << " " << this->z[irec]
+              << " is located outside of mesh. Mesh dimensions are (xmin, "
+              << "xmax, zmin, zmax) = " << lower(0) << " " << upper(0) << " "
+              << lower(1) << " " << upper(1);
+      throw std::runtime_error(message.str());
     }
   }
 }
 
-std::string specfem::receivers::receiver::print() const {
+void specfem::receivers::receiver_set::compute_lagrange_interpolants(
+    const int irec, const specfem::quadrature::quadrature &quadx,
+    const specfem::quadrature::quadrature &quadz,
+    specfem::kokkos::HostView1d<type_real> hxir,
+    specfem::kokkos::HostView1d<type_real> hgammar,
+    specfem::memory::arena &arena) const {
+
+  // Interpolants are computed in place, only their derivatives are temporary
+  const auto mark = arena.mark();
+  using HostView1d = specfem::kokkos::HostView1d<type_real>;
+  auto hpxir = arena.allocate<HostView1d>(quadx.get_N());
+  auto hpgammar = arena.allocate<HostView1d>(quadz.get_N());
+  Lagrange::compute_lagrange_interpolants(hxir, hpxir, this->xi[irec],
+                                          quadx.get_N(), quadx.get_hxi());
+  Lagrange::compute_lagrange_interpolants(hgammar, hpgammar, this->gamma[irec],
+                                          quadz.get_N(), quadz.get_hxi());
+  arena.release(mark);
+}
+
+std::string specfem::receivers::receiver_set::print(const int irec) const {
   std::ostringstream message;
   message << " - Receiver:\n"
-          << "      Station Name = " << this->station_name << "\n"
-          << "      Network Name = " << this->network_name << "\n"
+          << "      Station Name = " << this->station_names[irec] << "\n"
+          << "      Network Name = " << this->network_names[irec] << "\n"
           << "      Receiver Location: \n"
-          << "        x = " << type_real(this->x) << "\n"
-          << "        z = " << type_real(this->z) << "\n"
-          << "        xi = " << this->xi << "\n"
-          << "        gamma = " << this->gamma << "\n"
-          << "        ispec = " << this->ispec << "\n"
-          << "        islice = " << this->islice << "\n";
+          << "        x = " << type_real(this->x[irec]) << "\n"
+          << "        z = " << type_real(this->z[irec]) << "\n"
+          << "        xi = " << this->xi[irec] << "\n"
+          << "        gamma = " << this->gamma[irec] << "\n"
+          << "        ispec = " << this->ispec[irec] << "\n"
+          << "        islice = " << this->islice[irec] << "\n";
 
   return message.str();
 }
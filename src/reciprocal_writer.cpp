@@ -0,0 +1,260 @@
+#include "../include/reciprocal_writer.h"
+#include "../include/compute.h"
+#include "../include/domain.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/quadrature.h"
+#include "../include/receiver.h"
+#include "../include/source.h"
+#include "../include/specfem_mpi.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Extension of files storing seismograms of type stype
+static std::string extension(const specfem::seismogram::type stype) {
+  switch (stype) {
+  case specfem::seismogram::displacement:
+    return "d";
+  case specfem::seismogram::velocity:
+    return "v";
+  case specfem::seismogram::acceleration:
+    return "a";
+  default:
+    std::ostringstream message;
+    message << "seismogram type " << stype << " has not been implemented yet.";
+    throw std::runtime_error(message.str());
+  }
+}
+
+specfem::writer::reciprocal::reciprocal(
+    specfem::Domain::Domain *domain, const specfem::compute::compute *compute,
+    const std::vector<specfem::sources::source *> &sources,
+    const specfem::receivers::receiver_set &receivers,
+    const std::vector<specfem::seismogram::type> &stypes,
+    const specfem::quadrature::quadrature &quadx,
+    const specfem::quadrature::quadrature &quadz,
+    const specfem::wave::type wave, const int nsig_steps,
+    const type_real sample_dt, const type_real t0, const type_real source_t0,
+    const std::string output_folder, specfem::MPI::MPI *mpi)
+    : domain(domain), ibool(compute->ibool), receivers(receivers),
+      stypes(stypes), wave(wave), sample_dt(sample_dt), t0(t0),
+      source_t0(source_t0), output_folder(output_folder) {
+
+  // One shot for every station and force component. SH waves have a single
+  // component
+  const int ncomponents = (wave == specfem::wave::sh) ? 1 : 2;
+  const int nshots = receivers.size() * ncomponents;
+  if (nshots == 0 ||
+      domain->get_field().extent(1) !=
+          static_cast<std::size_t>(nshots * ncomponents)) {
+    std::ostringstream message;
+    message << "Reciprocal simulations need one shot for every station and "
+            << "force component (" << nshots << " shots)";
+    throw std::runtime_error(message.str());
+  }
+
+  for (int isource = 0; isource < sources.size(); isource++) {
+    if (sources[isource]->get_islice() == mpi->get_rank())
+      this->indices.push_back(isource);
+  }
+
+  this->sources = specfem::compute::sources(
+      sources, quadx, quadz, compute->coordinates.xmax,
+      compute->coordinates.xmin, compute->coordinates.zmax,
+      compute->coordinates.zmin, mpi, wave);
+  this->sources.release_host_mirrors();
+
+  this->responses = specfem::kokkos::DeviceView4d<type_real>(
+      "specfem::writer::reciprocal::responses", nsig_steps, stypes.size(),
+      this->indices.size(), nshots);
+}
+
+void specfem::writer::reciprocal::sample(
+    const int isig_step, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const auto responses = this->responses;
+  const int nsig_steps = responses.extent(0);
+  const int nsources = responses.extent(2);
+  const int nshots = responses.extent(3);
+
+  if (nsources == 0 || isig_step >= nsig_steps)
+    return;
+
+  const auto ibool = this->ibool;
+  const auto ispec_array = this->sources.ispec_array;
+  const auto dense_index = this->sources.dense_index;
+  const auto source_array = this->sources.source_array;
+  const auto hxis = this->sources.hxis;
+  const auto hgammas = this->sources.hgammas;
+  const auto components = this->sources.components;
+  const int ngllz = ibool.extent(1);
+  const int ngllx = ibool.extent(2);
+  const int ncomponents = (this->wave == specfem::wave::sh) ? 1 : 2;
+
+  for (int isig = 0; isig < this->stypes.size(); isig++) {
+    specfem::kokkos::DeviceFieldView2d<type_real> field;
+    switch (this->stypes[isig]) {
+    case specfem::seismogram::displacement:
+      field = this->domain->get_field();
+      break;
+    case specfem::seismogram::velocity:
+      field = this->domain->get_field_dot();
+      break;
+    case specfem::seismogram::acceleration:
+      field = this->domain->get_field_dot_dot();
+      break;
+    default:
+      throw std::runtime_error("Seismogram type has not been implemented yet");
+    }
+
+    // Separable sources are interpolated on the fly
+    Kokkos::parallel_for(
+        "specfem::writer::reciprocal::sample",
+        Kokkos::RangePolicy<specfem::kokkos::DevExecSpace>(
+            exec_space, 0, nsources * nshots),
+        KOKKOS_LAMBDA(const int index) {
+          const int isource = index / nshots;
+          const int ishot = index % nshots;
+          const int ispec = ispec_array(isource);
+          const int idense = dense_index(isource);
+          type_real value = 0.0;
+          for (int iz = 0; iz < ngllz; iz++) {
+            for (int ix = 0; ix < ngllx; ix++) {
+              const int iglob = ibool(ispec, iz, ix);
+              const type_real hlagrange =
+                  hxis(isource, ix) * hgammas(isource, iz);
+              for (int icomp = 0; icomp < ncomponents; icomp++) {
+                const type_real weight =
+                    (idense < 0) ? components(isource, icomp) * hlagrange
+                                 : source_array(idense, iz, ix, icomp);
+                value += weight * field(iglob, ishot * ncomponents + icomp);
+              }
+            }
+          }
+          responses(isig_step, isig, isource, ishot) = value;
+        });
+  }
+}
+
+void specfem::writer::reciprocal::write() {
+
+  const auto responses = this->responses;
+  const int nsamples = responses.extent(0);
+  const int nsig_types = responses.extent(1);
+  const int nsources = responses.extent(2);
+  const int nshots = responses.extent(3);
+
+  if (nsources == 0 || nsig_types == 0)
+    return;
+
+  // The seismogram sample n of a source is
+  //   sum_k dt * response(k) * stf(source_t0 - t0 + (n - k) * dt)
+  // The source time functions are tabulated for n - k in
+  // [-(nsamples - 1), nsamples - 1]
+  const type_real dt = this->sample_dt;
+  const int ntable = 2 * nsamples - 1;
+  this->sources.tabulate_stf(this->source_t0 - this->t0 -
+                                 (nsamples - 1) * dt,
+                             dt, ntable, ntable * nsources);
+  const auto stf_table = this->sources.stf_table;
+
+  // Samples outside the support of the source time functions vanish
+  const auto h_stf_table =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), stf_table);
+  specfem::kokkos::DeviceView2d<int> support(
+      "specfem::writer::reciprocal::support", nsources, 2);
+  auto h_support = Kokkos::create_mirror_view(support);
+  for (int isource = 0; isource < nsources; isource++) {
+    int first = ntable;
+    int last = -1;
+    for (int isample = 0; isample < ntable; isample++) {
+      if (h_stf_table(isample, isource) != 0.0) {
+        first = std::min(first, isample);
+        last = isample;
+      }
+    }
+    h_support(isource, 0) = first;
+    h_support(isource, 1) = last;
+  }
+  Kokkos::deep_copy(support, h_support);
+
+  specfem::kokkos::DeviceView4d<type_real> seismograms(
+      "specfem::writer::reciprocal::seismograms", nsamples, nsig_types,
+      nsources, nshots);
+
+  Kokkos::parallel_for(
+      "specfem::writer::reciprocal::convolve",
+      specfem::kokkos::DeviceMDrange<3>({ 0, 0, 0 },
+                                        { nsamples, nsources, nshots }),
+      KOKKOS_LAMBDA(const int isample, const int isource, const int ishot) {
+        const int offset = isample + nsamples - 1;
+        const int kfirst =
+            (offset - support(isource, 1) > 0) ? offset - support(isource, 1)
+                                               : 0;
+        const int klast = (offset - support(isource, 0) < nsamples - 1)
+                              ? offset - support(isource, 0)
+                              : nsamples - 1;
+        for (int isig = 0; isig < nsig_types; isig++) {
+          type_real value = 0.0;
+          for (int k = kfirst; k <= klast; k++)
+            value += responses(k, isig, isource, ishot) *
+                     stf_table(offset - k, isource);
+          seismograms(isample, isig, isource, ishot) = dt * value;
+        }
+      });
+
+  const auto h_seismograms =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), seismograms);
+
+  // Forces along x and z are combined like the components of seismograms
+  const type_real cos_rec = this->receivers.get_cosine();
+  const type_real sin_rec = this->receivers.get_sine();
+  const bool p_sv = (this->wave == specfem::wave::p_sv);
+
+  std::filesystem::create_directories(this->output_folder);
+  for (int isource = 0; isource < nsources; isource++) {
+    for (int irec = 0; irec < this->receivers.size(); irec++) {
+      const std::string prefix =
+          this->output_folder + "/" + this->receivers.network_names[irec] +
+          this->receivers.station_names[irec] + ".S" +
+          std::to_string(this->indices[isource]) + ".";
+      for (int isig = 0; isig < nsig_types; isig++) {
+        const std::string ext = extension(this->stypes[isig]);
+        std::ofstream files[2] = { std::ofstream(prefix + "BXX.sem" + ext),
+                                   std::ofstream(prefix + "BXZ.sem" + ext) };
+        for (int isample = 0; isample < nsamples; isample++) {
+          const type_real time_t = isample * dt + this->source_t0;
+          type_real value[2];
+          if (p_sv) {
+            const type_real vx =
+                h_seismograms(isample, isig, isource, 2 * irec);
+            const type_real vz =
+                h_seismograms(isample, isig, isource, 2 * irec + 1);
+            value[0] = cos_rec * vx + sin_rec * vz;
+            value[1] = sin_rec * vx + cos_rec * vz;
+          } else {
+            value[0] = cos_rec * h_seismograms(isample, isig, isource, irec);
+            value[1] = 0;
+          }
+          for (int iorientation = 0; iorientation < 2; iorientation++)
+            files[iorientation] << std::scientific << time_t << " "
+                                << std::scientific << value[iorientation]
+                                << "\n";
+        }
+        for (int iorientation = 0; iorientation < 2; iorientation++) {
+          if (!files[iorientation]) {
+            std::ostringstream message;
+            message << "Could not write seismogram file " << prefix
+                    << ((iorientation == 0) ? "BXX" : "BXZ") << ".sem" << ext;
+            throw std::runtime_error(message.str());
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,169 @@
+#include "../include/reordering.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// Spread the lower 16 bits of x such that there is a zero bit between every
+// bit
+std::uint32_t spread_bits(std::uint32_t x) {
+  x &= 0x0000ffff;
+  x = (x | (x << 8)) & 0x00ff00ff;
+  x = (x | (x << 4)) & 0x0f0f0f0f;
+  x = (x | (x << 2)) & 0x33333333;
+  x = (x | (x << 1)) & 0x55555555;
+  return x;
+}
+} // namespace
+
+std::vector<int> specfem::reordering::morton_order(
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods) {
+
+  const int ngnod = knods.extent(0);
+  const int nspec = knods.extent(1);
+
+  std::vector<type_real> xc(nspec, 0.0), zc(nspec, 0.0);
+  type_real xmin = std::numeric_limits<type_real>::max();
+  type_real xmax = std::numeric_limits<type_real>::lowest();
+  type_real zmin = std::numeric_limits<type_real>::max();
+  type_real zmax = std::numeric_limits<type_real>::lowest();
+
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int in = 0; in < ngnod; in++) {
+      xc[ispec] += coorg(0, knods(in, ispec));
+      zc[ispec] += coorg(1, knods(in, ispec));
+    }
+    xc[ispec] /= ngnod;
+    zc[ispec] /= ngnod;
+    xmin = std::min(xmin, xc[ispec]);
+    xmax = std::max(xmax, xc[ispec]);
+    zmin = std::min(zmin, zc[ispec]);
+    zmax = std::max(zmax, zc[ispec]);
+  }
+
+  // Quantize centroids on a 2^16 x 2^16 grid
+  const type_real nbins = 65535.0;
+  const type_real xscale = (xmax > xmin) ? nbins / (xmax - xmin) : 0.0;
+  const type_real zscale = (zmax > zmin) ? nbins / (zmax - zmin) : 0.0;
+
+  std::vector<std::uint32_t> keys(nspec);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    const auto ix = static_cast<std::uint32_t>((xc[ispec] - xmin) * xscale);
+    const auto iz = static_cast<std::uint32_t>((zc[ispec] - zmin) * zscale);
+    keys[ispec] = spread_bits(ix) | (spread_bits(iz) << 1);
+  }
+
+  std::vector<int> permutation(nspec);
+  std::iota(permutation.begin(), permutation.end(), 0);
+  std::stable_sort(permutation.begin(), permutation.end(),
+                   [&](const int a, const int b) { return keys[a] < keys[b]; });
+
+  return permutation;
+}
+
+std::vector<int>
+specfem::reordering::cuthill_mckee_order(
+    const specfem::kokkos::HostView2d<int> knods, const int npgeo) {
+
+  const int ngnod = knods.extent(0);
+  const int nspec = knods.extent(1);
+
+  // Elements sharing every control node
+  std::vector<std::vector<int> > node_elements(npgeo);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int in = 0; in < ngnod; in++) {
+      node_elements[knods(in, ispec)].push_back(ispec);
+    }
+  }
+
+  // Element adjacency graph
+  std::vector<std::vector<int> > neighbors(nspec);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    auto &ineighbors = neighbors[ispec];
+    for (int in = 0; in < ngnod; in++) {
+      for (const int jspec : node_elements[knods(in, ispec)]) {
+        if (jspec != ispec)
+          ineighbors.push_back(jspec);
+      }
+    }
+    std::sort(ineighbors.begin(), ineighbors.end());
+    ineighbors.erase(std::unique(ineighbors.begin(), ineighbors.end()),
+                     ineighbors.end());
+  }
+
+  // Elements sorted by degree are used as starting points of every connected
+  // component
+  std::vector<int> by_degree(nspec);
+  std::iota(by_degree.begin(), by_degree.end(), 0);
+  std::stable_sort(by_degree.begin(), by_degree.end(),
+                   [&](const int a, const int b) {
+                     return neighbors[a].size() < neighbors[b].size();
+                   });
+
+  std::vector<int> permutation;
+  permutation.reserve(nspec);
+  std::vector<bool> visited(nspec, false);
+
+  for (const int istart : by_degree) {
+    if (visited[istart])
+      continue;
+
+    std::queue<int> queue;
+    queue.push(istart);
+    visited[istart] = true;
+
+    while (!queue.empty()) {
+      const int ispec = queue.front();
+      queue.pop();
+      permutation.push_back(ispec);
+
+      std::vector<int> next;
+      for (const int jspec : neighbors[ispec]) {
+        if (!visited[jspec]) {
+          visited[jspec] = true;
+          next.push_back(jspec);
+        }
+      }
+
+      std::stable_sort(next.begin(), next.end(), [&](const int a, const int b) {
+        return neighbors[a].size() < neighbors[b].size();
+      });
+
+      for (const int jspec : next)
+        queue.push(jspec);
+    }
+  }
+
+  std::reverse(permutation.begin(), permutation.end());
+
+  return permutation;
+}
+
+std::vector<int> specfem::reordering::element_permutation(
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::reordering::type ordering) {
+
+  const int nspec = knods.extent(1);
+
+  switch (ordering) {
+  case specfem::reordering::morton:
+    return specfem::reordering::morton_order(coorg, knods);
+  case specfem::reordering::cuthill_mckee:
+    return specfem::reordering::cuthill_mckee_order(knods, coorg.extent(1));
+  case specfem::reordering::none: {
+    std::vector<int> permutation(nspec);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    return permutation;
+  }
+  default:
+    throw std::runtime_error("Unknown element reordering type");
+  }
+}
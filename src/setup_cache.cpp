@@ -0,0 +1,315 @@
+#include "../include/setup_cache.h"
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/material.h"
+#include "../include/quadrature.h"
+#include "../include/specfem_mpi.h"
+#include "../include/utils.h"
+#include <Kokkos_Core.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Increment when the layout of cache files changes
+constexpr std::uint32_t version = 2;
+constexpr char magic[8] = { 'S', 'P', 'E', 'C', 'F', 'E', 'M', 'C' };
+
+struct header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t real_size; ///< Size of type_real in bytes
+  std::uint64_t key;
+  std::uint64_t element_layout; ///< Layout of element arrays, see layout_id
+  std::int32_t nspec, ngllz, ngllx, nglob;
+  double xmin, xmax, zmin, zmax;
+};
+
+// FNV-1a hash of bytes
+std::uint64_t hash(std::uint64_t value, const void *data,
+                   const std::size_t bytes) {
+  const unsigned char *begin = static_cast<const unsigned char *>(data);
+  for (std::size_t i = 0; i < bytes; i++) {
+    value ^= begin[i];
+    value *= 1099511628211ULL;
+  }
+  return value;
+}
+
+// Element arrays are read and written in memory order
+template <typename Layout> constexpr std::uint64_t layout_id() {
+  return std::is_same_v<Layout, Kokkos::LayoutLeft> ? 1 : 0;
+}
+
+template <typename ViewType>
+std::uint64_t hash(const std::uint64_t value, const ViewType &view) {
+  return hash(value, view.data(),
+              view.span() * sizeof(typename ViewType::value_type));
+}
+
+template <typename ViewType> std::size_t bytes(const ViewType &view) {
+  return view.span() * sizeof(typename ViewType::value_type);
+}
+
+template <typename ViewType>
+void write_view(std::ofstream &stream, const ViewType &view) {
+  stream.write(reinterpret_cast<const char *>(view.data()), bytes(view));
+}
+
+template <typename ViewType>
+void read_view(const char *&data, const ViewType &view) {
+  std::memcpy(view.data(), data, bytes(view));
+  data += bytes(view);
+}
+
+// Read-only mapping of a file. Empty if the file can't be mapped
+class mapped_file {
+public:
+  mapped_file(const std::string &filename) {
+#if defined(__unix__) || defined(__APPLE__)
+    const int file = open(filename.c_str(), O_RDONLY);
+    if (file < 0)
+      return;
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size > 0) {
+      void *mapping =
+          mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+      if (mapping != MAP_FAILED) {
+        this->address = mapping;
+        this->size = status.st_size;
+      }
+    }
+    close(file);
+#else
+    std::ifstream stream(filename, std::ios::binary | std::ios::ate);
+    if (!stream.is_open())
+      return;
+    this->storage.resize(stream.tellg());
+    stream.seekg(0, std::ios::beg);
+    if (!stream.read(this->storage.data(), this->storage.size()))
+      return;
+    this->address = this->storage.data();
+    this->size = this->storage.size();
+#endif
+  }
+  mapped_file(const mapped_file &) = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+  ~mapped_file() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (this->address)
+      munmap(this->address, this->size);
+#endif
+  }
+  const char *data() const { return static_cast<const char *>(this->address); }
+  std::size_t bytes() const { return this->size; }
+
+private:
+  void *address = nullptr;
+  std::size_t size = 0;
+#if !defined(__unix__) && !defined(__APPLE__)
+  std::vector<char> storage;
+#endif
+};
+
+} // namespace
+
+std::uint64_t specfem::setup_cache::key(
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::kokkos::HostView1d<int> kmato,
+    const std::vector<specfem::material *> &materials,
+    const specfem::quadrature::quadrature &quadx,
+    const specfem::quadrature::quadrature &quadz) {
+
+  std::uint64_t value = 14695981039346656037ULL;
+
+  const std::size_t extents[3] = { coorg.extent(1), knods.extent(0),
+                                   knods.extent(1) };
+  value = hash(value, extents, sizeof(extents));
+  value = hash(value, coorg);
+  value = hash(value, knods);
+  value = hash(value, kmato);
+
+  for (auto &material : materials) {
+    const utilities::return_holder holder = material->get_properties();
+    const type_real properties[6] = { holder.rho,   holder.mu,
+                                      holder.kappa, holder.qmu,
+                                      holder.qkappa, holder.lambdaplus2mu };
+    const int type = material->get_ispec_type();
+    value = hash(value, properties, sizeof(properties));
+    value = hash(value, &type, sizeof(type));
+  }
+
+  for (const auto *quad : { &quadx, &quadz }) {
+    const int N = quad->get_N();
+    value = hash(value, &N, sizeof(N));
+    value = hash(value, quad->get_hxi());
+    value = hash(value, quad->get_hw());
+  }
+
+  return value;
+}
+
+std::string specfem::setup_cache::filename(const std::string &directory,
+                                           const specfem::MPI::MPI *mpi) {
+  std::ostringstream filename;
+  filename << directory << "/setup_cache_" << mpi->get_rank() << ".bin";
+  return filename.str();
+}
+
+bool specfem::setup_cache::load(
+    const std::string &filename, const std::uint64_t key,
+    specfem::compute::compute &compute,
+    specfem::compute::partial_derivatives &partial_derivatives,
+    specfem::compute::properties &properties) {
+
+  const mapped_file file(filename);
+  if (file.bytes() < sizeof(header))
+    return false;
+
+  header head;
+  std::memcpy(&head, file.data(), sizeof(header));
+  if (std::memcmp(head.magic, magic, sizeof(magic)) != 0 ||
+      head.version != version || head.real_size != sizeof(type_real) ||
+      head.key != key ||
+      head.element_layout != layout_id<specfem::kokkos::ElementLayout>())
+    return false;
+
+  const std::size_t npoints =
+      static_cast<std::size_t>(head.nspec) * head.ngllz * head.ngllx;
+  const std::size_t expected =
+      sizeof(header) + npoints * sizeof(int) +
+      static_cast<std::size_t>(ndim) * head.nglob * sizeof(type_real) +
+      13 * npoints * sizeof(type_real) + head.nspec * sizeof(std::int32_t);
+  if (file.bytes() != expected)
+    return false;
+
+  specfem::compute::compute l_compute(head.nspec, head.ngllz, head.ngllx);
+  specfem::compute::partial_derivatives l_partial_derivatives(
+      head.nspec, head.ngllz, head.ngllx);
+  specfem::compute::properties l_properties(head.nspec, head.ngllz,
+                                            head.ngllx);
+  l_compute.coordinates.coord = specfem::kokkos::HostView2d<type_real>(
+      "specfem::compute::compute::coordinates", ndim, head.nglob);
+  l_compute.coordinates.xmin = head.xmin;
+  l_compute.coordinates.xmax = head.xmax;
+  l_compute.coordinates.zmin = head.zmin;
+  l_compute.coordinates.zmax = head.zmax;
+
+  const char *data = file.data() + sizeof(header);
+  read_view(data, l_compute.h_ibool);
+  read_view(data, l_compute.coordinates.coord);
+
+  read_view(data, l_partial_derivatives.h_xix);
+  read_view(data, l_partial_derivatives.h_xiz);
+  read_view(data, l_partial_derivatives.h_gammax);
+  read_view(data, l_partial_derivatives.h_gammaz);
+  read_view(data, l_partial_derivatives.h_jacobian);
+
+  read_view(data, l_properties.h_rho);
+  read_view(data, l_properties.h_mu);
+  read_view(data, l_properties.kappa);
+  read_view(data, l_properties.qmu);
+  read_view(data, l_properties.qkappa);
+  read_view(data, l_properties.rho_vp);
+  read_view(data, l_properties.rho_vs);
+  read_view(data, l_properties.h_lambdaplus2mu);
+  for (int ispec = 0; ispec < head.nspec; ispec++) {
+    std::int32_t type;
+    std::memcpy(&type, data, sizeof(type));
+    data += sizeof(type);
+    l_properties.h_ispec_type(ispec) =
+        static_cast<specfem::elements::type>(type);
+  }
+
+  l_compute.sync_views();
+  l_partial_derivatives.sync_views();
+  l_properties.sync_views();
+
+  compute = l_compute;
+  partial_derivatives = l_partial_derivatives;
+  properties = l_properties;
+
+  return true;
+}
+
+void specfem::setup_cache::save(
+    const std::string &filename, const std::uint64_t key,
+    const specfem::compute::compute &compute,
+    const specfem::compute::partial_derivatives &partial_derivatives,
+    const specfem::compute::properties &properties) {
+
+  const auto directory = std::filesystem::path(filename).parent_path();
+  if (!directory.empty())
+    std::filesystem::create_directories(directory);
+
+  header head;
+  std::memcpy(head.magic, magic, sizeof(magic));
+  head.version = version;
+  head.real_size = sizeof(type_real);
+  head.key = key;
+  head.element_layout = layout_id<specfem::kokkos::ElementLayout>();
+  head.nspec = compute.h_ibool.extent(0);
+  head.ngllz = compute.h_ibool.extent(1);
+  head.ngllx = compute.h_ibool.extent(2);
+  head.nglob = compute.coordinates.coord.extent(1);
+  head.xmin = compute.coordinates.xmin;
+  head.xmax = compute.coordinates.xmax;
+  head.zmin = compute.coordinates.zmin;
+  head.zmax = compute.coordinates.zmax;
+
+  const std::string temporary = filename + ".tmp";
+  std::ofstream stream(temporary, std::ios::binary);
+  if (!stream.is_open()) {
+    std::ostringstream message;
+    message << "Could not write setup cache file " << filename;
+    throw std::runtime_error(message.str());
+  }
+
+  stream.write(reinterpret_cast<const char *>(&head), sizeof(header));
+  write_view(stream, compute.h_ibool);
+  write_view(stream, compute.coordinates.coord);
+
+  write_view(stream, partial_derivatives.h_xix);
+  write_view(stream, partial_derivatives.h_xiz);
+  write_view(stream, partial_derivatives.h_gammax);
+  write_view(stream, partial_derivatives.h_gammaz);
+  write_view(stream, partial_derivatives.h_jacobian);
+
+  write_view(stream, properties.h_rho);
+  write_view(stream, properties.h_mu);
+  write_view(stream, properties.kappa);
+  write_view(stream, properties.qmu);
+  write_view(stream, properties.qkappa);
+  write_view(stream, properties.rho_vp);
+  write_view(stream, properties.rho_vs);
+  write_view(stream, properties.h_lambdaplus2mu);
+  for (int ispec = 0; ispec < head.nspec; ispec++) {
+    const std::int32_t type = properties.h_ispec_type(ispec);
+    stream.write(reinterpret_cast<const char *>(&type), sizeof(type));
+  }
+
+  stream.close();
+  if (!stream || std::rename(temporary.c_str(), filename.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    std::ostringstream message;
+    message << "Could not write setup cache file " << filename;
+    throw std::runtime_error(message.str());
+  }
+}
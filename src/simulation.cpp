@@ -0,0 +1,460 @@
+#include "../include/simulation.h"
+#include "../include/attenuation.h"
+#include "../include/compute.h"
+#include "../include/courant.h"
+#include "../include/domain.h"
+#include "../include/first_touch.h"
+#include "../include/mesher.h"
+#include "../include/parameter_parser.h"
+#include "../include/partitioner.h"
+#include "../include/read_sources.h"
+#include "../include/solver.h"
+#include "../include/source.h"
+#include "../include/specfem_mpi.h"
+#include "../include/timescheme.h"
+#include "../include/utils.h"
+#include "../include/velocity_model.h"
+#include "../include/writer.h"
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+specfem::simulation::simulation::simulation(const std::string &parameter_file,
+                                            specfem::MPI::MPI *mpi)
+    : mpi(mpi),
+      setup(new specfem::runtime_configuration::setup(parameter_file)) {
+
+  auto &setup = *this->setup;
+  const auto source_files = setup.get_source_files();
+  this->nshots = source_files.size();
+
+  // Auxiliary fields of PML layers aren't reset between runs. Other
+  // simulations need state which isn't resident
+  if (setup.get_reciprocal() || setup.get_adjoint_configuration() ||
+      setup.get_injection_configuration() ||
+      setup.get_misfit_configuration() || setup.get_lts_levels() > 1 ||
+      setup.get_pml()) {
+    throw std::runtime_error(
+        "Reciprocal, adjoint and hybrid simulations, misfits, local time "
+        "stepping and PML layers are not implemented for resident "
+        "simulations");
+  }
+
+  std::tie(this->gllx, this->gllz) = setup.instantiate_quadrature();
+
+  // Meshes are read and partitioned as by the specfem2d driver
+  const bool internal_mesh = setup.get_internal_mesh();
+  const bool partition_mesh =
+      (setup.get_partition_mesh() || internal_mesh) && mpi->get_size() > 1;
+  this->mesh = internal_mesh
+                   ? specfem::mesher::generate(setup.get_layered_model(),
+                                               this->materials, mpi)
+                   : specfem::mesh(std::get<0>(setup.get_databases()),
+                                   this->materials, mpi, partition_mesh);
+  if (partition_mesh) {
+    const auto element_weights =
+        setup.get_partition_weights_file().empty()
+            ? specfem::partitioner::element_weights(
+                  this->mesh, this->materials, setup.get_partition_weights())
+            : specfem::partitioner::read_element_weights(
+                  setup.get_partition_weights_file(), this->mesh.nspec);
+    const auto element_partition = specfem::partitioner::partition_elements(
+        this->mesh.coorg, this->mesh.material_ind.knods, element_weights,
+        mpi->get_size());
+    this->mesh.partition(element_partition, mpi->get_rank());
+  }
+  this->mesh.reorder_elements(setup.get_element_ordering());
+
+  if (this->mesh.axisym) {
+    throw std::runtime_error(
+        "Resident simulations are not implemented for axisymmetric meshes");
+  }
+
+  const auto coorg = this->mesh.coorg;
+  const auto knods = this->mesh.material_ind.knods;
+  this->compute = specfem::compute::compute(coorg, knods, gllx, gllz);
+  this->partial_derivatives =
+      specfem::compute::partial_derivatives(coorg, knods, gllx, gllz);
+  this->assign_materials();
+
+  int nelastic = 0;
+  for (int ispec = 0; ispec < this->mesh.nspec; ispec++) {
+    if (this->material_properties.h_ispec_type(ispec) ==
+        specfem::elements::elastic)
+      nelastic++;
+  }
+  if (mpi->all_reduce(static_cast<int>(nelastic < this->mesh.nspec),
+                      specfem::MPI::max)) {
+    throw std::runtime_error(
+        "Resident simulations are only implemented for elastic meshes");
+  }
+
+  this->partial_derivatives.assign_affine_elements(coorg, knods);
+
+  const auto domain_options = setup.get_domain_options();
+  if (domain_options.compressed_connectivity)
+    this->compute.compress_connectivity();
+  if (domain_options.structured_blocks)
+    this->compute.assign_structured_blocks(knods);
+
+  const auto stable_timestep = specfem::courant::compute_stable_timestep(
+      this->compute.coordinates.coord, this->compute.h_ibool,
+      this->material_properties.h_rho, this->material_properties.rho_vp,
+      this->material_properties.rho_vs);
+  setup.update_dt(mpi->all_reduce(stable_timestep.dt, specfem::MPI::min));
+
+  const int ncomponents =
+      ((setup.get_wave_type() == specfem::wave::sh) ? 1 : ndim) *
+      this->nshots;
+  this->halo = std::make_unique<specfem::interfaces::halo>(
+      this->mesh.interface, this->compute.h_ibool,
+      this->compute.coordinates.coord, knods,
+      this->material_properties.h_ispec_type, ncomponents, mpi);
+
+  // The start time of the time scheme is updated by every set of sources
+  this->it.reset(setup.instantiate_solver());
+  if (this->it->get_nstages() > 1 &&
+      (setup.get_attenuation() || setup.get_absorbing_boundaries())) {
+    throw std::runtime_error("Attenuation and absorbing boundaries are only "
+                             "implemented for time schemes with a single "
+                             "stage");
+  }
+  if (auto newmark =
+          dynamic_cast<specfem::TimeScheme::Newmark *>(this->it.get()))
+    newmark->set_stability_check(setup.get_stability_interval(),
+                                 setup.get_stability_threshold());
+
+  this->set_sources(source_files);
+  this->stations = specfem::read_receivers(setup.get_stations_file(),
+                                           setup.get_receiver_angle());
+  this->assign_receivers();
+
+  this->assign_domain();
+
+  // Element arrays are first touched by the threads computing the elements
+  // on host backends
+  const auto element_launches = this->domain->get_element_launches();
+  specfem::first_touch::place(this->partial_derivatives, element_launches);
+  specfem::first_touch::place(this->material_properties, element_launches);
+
+  // Host copies of the geometry aren't read once the domain is set up.
+  // Material types locate new sources and receivers
+  this->partial_derivatives.release_host_mirrors();
+
+  return;
+}
+
+specfem::simulation::simulation::~simulation() {
+  for (auto &material : this->materials)
+    delete material;
+  for (auto &source : this->sources)
+    delete source;
+}
+
+void specfem::simulation::simulation::assign_materials() {
+
+  this->material_properties = specfem::compute::properties(
+      this->mesh.material_ind.kmato, this->materials, this->mesh.nspec,
+      this->gllx.get_N(), this->gllz.get_N());
+
+  const auto [model_file, tile_rows] = this->setup->get_velocity_model();
+  if (!model_file.empty()) {
+    specfem::velocity_model::interpolate(
+        model_file, tile_rows, this->compute.coordinates.coord,
+        this->compute.h_ibool, this->material_properties);
+  }
+  this->material_properties.compress(this->mesh.material_ind.kmato);
+
+  return;
+}
+
+void specfem::simulation::simulation::assign_domain() {
+
+  // The domain assembles the mass matrix once for every run
+  this->domain = std::make_unique<specfem::Domain::Elastic>(
+      ndim, specfem::utilities::compute_nglob(this->compute.h_ibool),
+      &this->compute, &this->material_properties, &this->partial_derivatives,
+      &this->compute_sources, &this->compute_receivers, &this->gllx,
+      &this->gllz, this->setup->get_domain_options(), this->halo.get());
+
+  if (this->setup->get_attenuation()) {
+    const specfem::attenuation::model attenuation(
+        this->mesh.n_sls, this->mesh.attenuation_f0_reference);
+    this->domain->set_attenuation(attenuation, this->setup->get_dt());
+  }
+  if (this->setup->get_absorbing_boundaries())
+    this->domain->set_absorbing_boundary(this->mesh.abs_boundary);
+
+  return;
+}
+
+void specfem::simulation::simulation::set_materials(
+    const std::vector<specfem::material *> &materials) {
+
+  if (materials.size() != this->materials.size()) {
+    throw std::runtime_error(
+        "The number of materials of a resident simulation can't change");
+  }
+  for (auto &material : materials) {
+    if (material->get_ispec_type() != specfem::elements::elastic) {
+      throw std::runtime_error(
+          "Resident simulations are only implemented for elastic meshes");
+    }
+  }
+
+  for (auto &material : this->materials) {
+    if (std::find(materials.begin(), materials.end(), material) ==
+        materials.end())
+      delete material;
+  }
+  this->materials = materials;
+  this->assign_materials();
+
+  // The time step of the parameter file is kept, hence faster materials
+  // can't be stepped
+  const auto stable_timestep = specfem::courant::compute_stable_timestep(
+      this->compute.coordinates.coord, this->compute.h_ibool,
+      this->material_properties.h_rho, this->material_properties.rho_vp,
+      this->material_properties.rho_vs);
+  if (this->setup->get_dt() >
+      this->mpi->all_reduce(stable_timestep.dt, specfem::MPI::min)) {
+    throw std::runtime_error("The time step of the parameter file is "
+                             "unstable for the new materials");
+  }
+
+  // Domains of concurrent runs share the mass matrix of the replaced domain
+  this->concurrent.clear();
+  this->partial_derivatives.restore_host_mirrors();
+  this->assign_domain();
+  specfem::first_touch::place(this->material_properties,
+                              this->domain->get_element_launches());
+  this->partial_derivatives.release_host_mirrors();
+
+  return;
+}
+
+void specfem::simulation::simulation::set_sources(
+    const std::vector<specfem::sources::source *> &sources,
+    const std::vector<int> &shots, const type_real t0) {
+
+  specfem::sources::locate(
+      sources, this->compute.coordinates.coord, this->compute.h_ibool,
+      this->gllx.get_hxi(), this->gllz.get_hxi(), this->mesh.coorg,
+      this->mesh.material_ind.knods, this->material_properties.h_ispec_type,
+      this->mpi);
+
+  for (auto &source : this->sources) {
+    if (std::find(sources.begin(), sources.end(), source) == sources.end())
+      delete source;
+  }
+  this->sources = sources;
+  this->t0 = t0;
+
+  // Seismogram writers read the start time of the parameter file
+  this->setup->update_t0(-1.0 * t0);
+  this->it->update_t0(-1.0 * t0);
+  this->it->reset_time();
+
+  const auto &coordinates = this->compute.coordinates;
+  this->compute_sources = specfem::compute::sources(
+      sources, this->gllx, this->gllz, coordinates.xmax, coordinates.xmin,
+      coordinates.zmax, coordinates.zmin, this->mpi,
+      this->setup->get_wave_type(), shots);
+  this->compute_sources.tabulate_stf(this->it->get_time(),
+                                     this->setup->get_dt(),
+                                     this->it->get_max_timestep() + 2);
+
+  if (this->domain)
+    this->domain->set_sources(&this->compute_sources,
+                              &this->compute_receivers);
+
+  return;
+}
+
+void specfem::simulation::simulation::set_sources(
+    const std::vector<std::string> &sources_files) {
+  if (static_cast<int>(sources_files.size()) != this->nshots) {
+    throw std::runtime_error(
+        "The number of shots of a resident simulation can't change");
+  }
+  auto [sources, shots, t0] =
+      specfem::read_sources(sources_files, this->setup->get_dt(), this->mpi);
+  this->set_sources(sources, shots, t0);
+  return;
+}
+
+void specfem::simulation::simulation::set_receivers(
+    const specfem::receivers::receiver_set &stations) {
+  this->stations = stations;
+  this->assign_receivers();
+  this->domain->set_sources(&this->compute_sources, &this->compute_receivers);
+  return;
+}
+
+void specfem::simulation::simulation::assign_receivers() {
+
+  this->stations.locate(this->compute.coordinates.coord,
+                        this->compute.h_ibool, this->gllx.get_hxi(),
+                        this->gllz.get_hxi(), this->mesh.coorg,
+                        this->mesh.material_ind.knods, this->mpi);
+  this->recorded = this->stations.replicate(this->nshots);
+
+  // Seismograms of every step are kept in memory until they are written
+  const auto &coordinates = this->compute.coordinates;
+  this->compute_receivers = specfem::compute::receivers(
+      this->recorded, this->setup->get_seismogram_types(), this->gllx,
+      this->gllz, coordinates.xmax, coordinates.xmin, coordinates.zmax,
+      coordinates.zmin, this->it->get_max_seismogram_step(), this->mpi, 0,
+      this->setup->get_seismogram_decimation());
+
+  return;
+}
+
+void specfem::simulation::simulation::run() {
+
+  this->domain->reset_fields();
+  this->it->reset_time();
+
+  // Graphs capture the views of the sources and receivers, hence every run
+  // records its own time loop
+  specfem::solver::solver *solver = specfem::solver::instantiate_time_marching(
+      this->domain.get(), this->it.get(), this->setup->get_graph_execution());
+  solver->run();
+  delete solver;
+
+  this->nruns++;
+  return;
+}
+
+void specfem::simulation::simulation::write_seismograms(
+    const std::string &output_folder) {
+  const auto folder = this->setup->get_seismogram_folder();
+  this->setup->update_seismogram_folder(output_folder);
+  this->write_seismograms();
+  this->setup->update_seismogram_folder(folder);
+  return;
+}
+
+void specfem::simulation::simulation::write_seismograms() {
+  specfem::writer::writer *writer =
+      this->setup->instantiate_seismogram_writer(
+          this->recorded, &this->compute_receivers, this->mpi);
+  writer->write();
+  delete writer;
+  return;
+}
+
+specfem::simulation::simulation::concurrent_run::~concurrent_run() {
+  for (auto &source : this->sources)
+    delete source;
+}
+
+void specfem::simulation::simulation::run_concurrent(
+    const std::vector<std::vector<std::string> > &sources_files) {
+
+  const int nsets = sources_files.size();
+  const type_real dt = this->setup->get_dt();
+  const auto &coordinates = this->compute.coordinates;
+
+  // Domains of previous concurrent runs are kept, only their sources and
+  // receivers are replaced
+  this->concurrent.resize(nsets);
+  for (int iset = 0; iset < nsets; iset++) {
+    if (static_cast<int>(sources_files[iset].size()) != this->nshots) {
+      throw std::runtime_error(
+          "The number of shots of a resident simulation can't change");
+    }
+    if (!this->concurrent[iset])
+      this->concurrent[iset] = std::make_unique<concurrent_run>();
+    auto &run = *this->concurrent[iset];
+
+    auto [sources, shots, t0] =
+        specfem::read_sources(sources_files[iset], dt, this->mpi);
+    specfem::sources::locate(
+        sources, coordinates.coord, this->compute.h_ibool,
+        this->gllx.get_hxi(), this->gllz.get_hxi(), this->mesh.coorg,
+        this->mesh.material_ind.knods, this->material_properties.h_ispec_type,
+        this->mpi);
+    for (auto &source : run.sources)
+      delete source;
+    run.sources = sources;
+
+    if (!run.it) {
+      run.it.reset(this->setup->instantiate_solver());
+      if (auto newmark =
+              dynamic_cast<specfem::TimeScheme::Newmark *>(run.it.get()))
+        newmark->set_stability_check(this->setup->get_stability_interval(),
+                                     this->setup->get_stability_threshold());
+    }
+    run.it->update_t0(-1.0 * t0);
+    run.it->reset_time();
+
+    run.compute_sources = specfem::compute::sources(
+        sources, this->gllx, this->gllz, coordinates.xmax, coordinates.xmin,
+        coordinates.zmax, coordinates.zmin, this->mpi,
+        this->setup->get_wave_type(), shots);
+    run.compute_sources.tabulate_stf(run.it->get_time(), dt,
+                                     run.it->get_max_timestep() + 2);
+    run.compute_receivers = specfem::compute::receivers(
+        this->recorded, this->setup->get_seismogram_types(), this->gllx,
+        this->gllz, coordinates.xmax, coordinates.xmin, coordinates.zmax,
+        coordinates.zmin, run.it->get_max_seismogram_step(), this->mpi, 0,
+        this->setup->get_seismogram_decimation());
+
+    if (run.domain) {
+      run.domain->set_sources(&run.compute_sources, &run.compute_receivers);
+      run.domain->reset_fields();
+    } else {
+      run.domain = std::make_unique<specfem::Domain::Elastic>(
+          *this->domain, &run.compute_sources, &run.compute_receivers);
+    }
+  }
+
+  // Instances are split off the default instance one at a time, variadic
+  // weights being the interface of partition_space on every backend
+  std::vector<specfem::kokkos::DevExecSpace> spaces;
+  specfem::kokkos::DevExecSpace remaining;
+  for (int iset = 0; iset < nsets - 1; iset++) {
+    const auto instances =
+        Kokkos::Experimental::partition_space(remaining, 1, 1);
+    spaces.push_back(instances[0]);
+    remaining = instances[1];
+  }
+  spaces.push_back(remaining);
+
+  // Graphs capture the views of the sources and receivers, hence every run
+  // records its own time loop
+  std::vector<std::unique_ptr<specfem::solver::solver> > solvers;
+  for (int iset = 0; iset < nsets; iset++) {
+    auto &run = *this->concurrent[iset];
+    solvers.emplace_back(specfem::solver::instantiate_time_marching(
+        run.domain.get(), run.it.get(), this->setup->get_graph_execution()));
+    solvers.back()->set_execution_space(spaces[iset]);
+  }
+
+  // Host backends launch kernels on a single thread pool, hence concurrent
+  // time loops would contend on it
+  const bool concurrent_launch = !specfem::Domain::host_backend() &&
+                                 this->domain->get_nelem_host() == 0;
+  if (concurrent_launch) {
+    std::vector<std::future<void> > pending;
+    for (auto &solver : solvers) {
+      pending.push_back(std::async(std::launch::async,
+                                   [&solver]() { solver->run(); }));
+    }
+    // Exceptions of the time loops are rethrown once every loop returned
+    for (auto &loop : pending)
+      loop.wait();
+    for (auto &loop : pending)
+      loop.get();
+  } else {
+    for (auto &solver : solvers)
+      solver->run();
+  }
+
+  this->nruns += nsets;
+  return;
+}
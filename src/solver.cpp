@@ -1,50 +1,964 @@
 #include "../include/solver.h"
+#include "../include/adjoint.h"
+#include "../include/checkpoint.h"
+#include "../include/coupling.h"
 #include "../include/domain.h"
+#include "../include/spectrum_writer.h"
+#include "../include/timers.h"
 #include "../include/timescheme.h"
+#include "../include/wavefield_writer.h"
 #include "../include/writer.h"
 #include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
 
-void specfem::solver::time_marching::run() {
+template <typename DomainType, typename TimeSchemeType>
+void specfem::solver::time_marching<DomainType, TimeSchemeType>::run() {
+
+  if (this->it->get_nstages() > 1) {
+    if (this->graph_execution) {
+      throw std::runtime_error(
+          "Graph execution is only implemented for single stage timeschemes");
+    }
+    this->run_stages();
+    return;
+  }
+
+  if (this->it->get_nlevels() > 1) {
+    if (this->graph_execution) {
+      throw std::runtime_error(
+          "Graph execution is not implemented for local time stepping");
+    }
+    this->run_lts();
+    return;
+  }
+
+  if (this->graph_execution) {
+    this->run_graph();
+    return;
+  }
+
+  TimeSchemeType *it = this->it;
+  DomainType *domain = this->domain;
+  specfem::timers::timers *timers = this->timers;
+
+  const int nstep = it->get_max_timestep();
+
+  // Kernels updating the fields are ordered by the main execution space
+  // instance. Seismograms read the corrected fields which are overwritten by
+  // the predictor phase of the next step, hence they are also computed on the
+  // main instance. Source interactions are computed on their own instance
+  // concurrently with the stiffness interaction when both use atomic assembly
+  const bool overlap_sources = domain->concurrent_source_interaction();
+  const auto instances = Kokkos::Experimental::partition_space(
+      this->exec_space, 1, 1);
+  const specfem::kokkos::DevExecSpace &main_space = instances[0];
+  const specfem::kokkos::DevExecSpace &source_space =
+      overlap_sources ? instances[1] : instances[0];
+
+  // The predictor phase of a timestep is fused with the mass matrix division
+  // and corrector phase of the previous timestep. Only the first step, and
+  // steps following a seismogram computation, apply the predictor separately
+  if (it->status()) {
+    timers->start(specfem::timers::predictor, main_space);
+    it->apply_predictor_phase(domain, main_space);
+    timers->stop(specfem::timers::predictor, main_space);
+    timers->add_cost(specfem::timers::predictor,
+                     it->get_cost(specfem::timers::predictor, domain));
+  }
+
+  while (it->status()) {
+    int istep = it->get_timestep();
+    timers->set_step(istep);
+
+    type_real timeval = it->get_time();
+
+#if TIME
+    Kokkos::Profiling::pushRegion("Stiffness calculation");
+#endif
+    this->compute_acceleration(timeval, main_space, source_space);
+
+    // Seismograms, snapshots and checkpoints need the corrected fields at
+    // this timestep
+    const bool compute_seismogram = it->compute_seismogram();
+    const bool snapshot = this->snapshot_step(istep);
+    const bool transform = this->transform_step(istep);
+    const bool take_checkpoint = this->checkpoint_step(istep);
+    const bool apply_predictor = !compute_seismogram && !snapshot &&
+                                 !transform && !take_checkpoint &&
+                                 (istep + 1 < nstep);
+
+    timers->start(specfem::timers::corrector, main_space);
+    it->apply_fused_corrector_phase(domain, apply_predictor, main_space);
+    timers->stop(specfem::timers::corrector, main_space);
+    timers->add_cost(specfem::timers::corrector,
+                     it->get_cost(specfem::timers::corrector, domain,
+                                  apply_predictor));
+
+    if (compute_seismogram)
+      this->compute_seismogram(main_space);
+    if (snapshot || transform) {
+      timers->start(specfem::timers::output, main_space);
+      if (snapshot)
+        this->wavefield->snapshot(istep, main_space);
+      if (transform)
+        this->spectrum->transform(istep, main_space);
+      timers->stop(specfem::timers::output, main_space);
+    }
+#if TIME
+    Kokkos::Profiling::popRegion();
+#endif
+
+    this->progress->update(istep + 1, nstep);
+
+    it->increment_time();
+
+    if (take_checkpoint && this->write_checkpoint(main_space))
+      break;
+
+    if (!apply_predictor && it->status()) {
+      timers->start(specfem::timers::predictor, main_space);
+      it->apply_predictor_phase(domain, main_space);
+      timers->stop(specfem::timers::predictor, main_space);
+      timers->add_cost(specfem::timers::predictor,
+                       it->get_cost(specfem::timers::predictor, domain));
+    }
+  }
+
+  main_space.fence();
+
+  std::cout << std::endl;
+
+  return;
+}
+
+template <typename DomainType, typename TimeSchemeType>
+void specfem::solver::time_marching<DomainType, TimeSchemeType>::
+    compute_acceleration(const type_real timeval,
+                         const specfem::kokkos::DevExecSpace &main_space,
+                         const specfem::kokkos::DevExecSpace &source_space) {
+
+  DomainType *domain = this->domain;
+  specfem::timers::timers *timers = this->timers;
+  const bool overlap_sources = domain->concurrent_source_interaction();
+
+  // Sources are assembled into the acceleration reset by the previous phase
+  if (overlap_sources)
+    main_space.fence();
+
+  if (domain->overlap_interfaces()) {
+    timers->start(specfem::timers::stiffness, main_space);
+    domain->compute_outer_stiffness_interaction(main_space);
+    timers->stop(specfem::timers::stiffness, main_space);
+
+    timers->start(specfem::timers::sources, source_space);
+    domain->compute_source_interaction(timeval, source_space);
+    // Packed interface points need the contributions of sources
+    if (overlap_sources)
+      source_space.fence();
+    timers->stop(specfem::timers::sources, source_space);
+
+    // Messages are in flight while inner elements are computed
+    timers->start(specfem::timers::interfaces, main_space);
+    domain->start_interface_assembly(main_space);
+    timers->stop(specfem::timers::interfaces, main_space);
+
+    timers->start(specfem::timers::stiffness, main_space);
+    domain->compute_inner_stiffness_interaction(main_space);
+    timers->stop(specfem::timers::stiffness, main_space);
+
+    timers->start(specfem::timers::interfaces, main_space);
+    domain->finish_interface_assembly(main_space);
+    timers->stop(specfem::timers::interfaces, main_space);
+    timers->add_cost(specfem::timers::stiffness,
+                     domain->get_cost(specfem::timers::stiffness));
+    timers->add_cost(specfem::timers::sources,
+                     domain->get_cost(specfem::timers::sources));
+    return;
+  }
+
+  timers->start(specfem::timers::stiffness, main_space);
+  domain->compute_stiffness_interaction(main_space);
+  timers->stop(specfem::timers::stiffness, main_space);
+
+  timers->start(specfem::timers::sources, source_space);
+  domain->compute_source_interaction(timeval, source_space);
+  // Mass matrix division needs the complete acceleration
+  if (overlap_sources)
+    source_space.fence();
+  timers->stop(specfem::timers::sources, source_space);
+
+  timers->start(specfem::timers::interfaces, main_space);
+  domain->assemble_interfaces(main_space);
+  timers->stop(specfem::timers::interfaces, main_space);
+  timers->add_cost(specfem::timers::stiffness,
+                   domain->get_cost(specfem::timers::stiffness));
+  timers->add_cost(specfem::timers::sources,
+                   domain->get_cost(specfem::timers::sources));
+
+  return;
+}
+
+template <typename DomainType, typename TimeSchemeType>
+void specfem::solver::time_marching<DomainType, TimeSchemeType>::
+    compute_seismogram(const specfem::kokkos::DevExecSpace &exec_space) {
+
+  this->timers->start(specfem::timers::seismograms, exec_space);
+  const int isig_step = this->it->get_seismogram_step();
+  this->domain->compute_seismogram(isig_step, exec_space);
+  if (this->writer)
+    this->writer->sample(isig_step, exec_space);
+  if (this->spectrum)
+    this->spectrum->sample(isig_step, exec_space);
+  this->it->increment_seismogram_step();
+  this->timers->stop(specfem::timers::seismograms, exec_space);
+  this->timers->add_cost(
+      specfem::timers::seismograms,
+      this->domain->get_cost(specfem::timers::seismograms));
+
+  return;
+}
+
+template <typename DomainType, typename TimeSchemeType>
+void specfem::solver::time_marching<DomainType, TimeSchemeType>::run_graph() {
+
+  TimeSchemeType *it = this->it;
+  DomainType *domain = this->domain;
+
+  const int nstep = it->get_max_timestep();
+
+  // Values updated before every replay of the graphs
+  specfem::kokkos::DeviceView1d<type_real> timeval(
+      "specfem::solver::time_marching::timeval", 1);
+  specfem::kokkos::HostMirror1d<type_real> h_timeval =
+      Kokkos::create_mirror_view(timeval);
+  specfem::kokkos::DeviceView1d<int> isig_step(
+      "specfem::solver::time_marching::isig_step", 1);
+  specfem::kokkos::HostMirror1d<int> h_isig_step =
+      Kokkos::create_mirror_view(isig_step);
+
+  const specfem::kokkos::DevExecSpace exec_space = this->exec_space;
+
+  // Replays execute every phase of a timestep, hence they are timed as a
+  // single phase
+  specfem::timers::timers *timers = this->timers;
+  const int graph_phase = timers->add("Graph replay");
+
+  // Regular timestep fused with the predictor phase of the next timestep
+  specfem::kokkos::DeviceGraph step_graph =
+      Kokkos::Experimental::create_graph(exec_space, [&](const auto &root) {
+        specfem::kokkos::DeviceGraphNode node = root;
+        domain->compute_stiffness_interaction(node);
+        domain->compute_source_interaction(timeval, node);
+        it->apply_fused_corrector_phase(domain, true, node);
+      });
+
+  // Seismograms need the corrected fields, hence the predictor phase of the
+  // next timestep is applied after computing seismograms
+  specfem::kokkos::DeviceGraph seismogram_graph =
+      Kokkos::Experimental::create_graph(exec_space, [&](const auto &root) {
+        specfem::kokkos::DeviceGraphNode node = root;
+        domain->compute_stiffness_interaction(node);
+        domain->compute_source_interaction(timeval, node);
+        it->apply_fused_corrector_phase(domain, false, node);
+        domain->compute_seismogram(isig_step, node);
+        it->apply_predictor_phase(domain, node);
+      });
+
+  if (it->status()) {
+    timers->start(specfem::timers::predictor, exec_space);
+    it->apply_predictor_phase(domain, exec_space);
+    timers->stop(specfem::timers::predictor, exec_space);
+    timers->add_cost(specfem::timers::predictor,
+                     it->get_cost(specfem::timers::predictor, domain));
+  }
+
+  while (it->status()) {
+    int istep = it->get_timestep();
+    timers->set_step(istep);
+
+    type_real timeval_step = it->get_time();
+
+#if TIME
+    Kokkos::Profiling::pushRegion("Stiffness calculation");
+#endif
+    const bool compute_seismogram = it->compute_seismogram();
+    const bool snapshot = this->snapshot_step(istep);
+    const bool transform = this->transform_step(istep);
+    const bool take_checkpoint = this->checkpoint_step(istep);
+    const bool replay =
+        (istep + 1 < nstep) && !snapshot && !transform && !take_checkpoint;
+
+    if (replay) {
+      timers->start(graph_phase, exec_space);
+      h_timeval(0) = timeval_step;
+      Kokkos::deep_copy(exec_space, timeval, h_timeval);
+      if (compute_seismogram) {
+        h_isig_step(0) = it->get_seismogram_step();
+        Kokkos::deep_copy(exec_space, isig_step, h_isig_step);
+        seismogram_graph.submit();
+      } else {
+        step_graph.submit();
+      }
+      timers->stop(graph_phase, exec_space);
+      if (compute_seismogram) {
+        timers->start(specfem::timers::seismograms, exec_space);
+        if (this->writer)
+          this->writer->sample(it->get_seismogram_step(), exec_space);
+        if (this->spectrum)
+          this->spectrum->sample(it->get_seismogram_step(), exec_space);
+        it->increment_seismogram_step();
+        timers->stop(specfem::timers::seismograms, exec_space);
+      }
+    } else {
+      // The last timestep doesn't apply the predictor phase. Snapshot and
+      // checkpoint timesteps are launched eagerly to read the fields before
+      // it
+      timers->start(specfem::timers::stiffness, exec_space);
+      domain->compute_stiffness_interaction(exec_space);
+      timers->stop(specfem::timers::stiffness, exec_space);
+      timers->start(specfem::timers::sources, exec_space);
+      domain->compute_source_interaction(timeval_step, exec_space);
+      timers->stop(specfem::timers::sources, exec_space);
+      timers->add_cost(specfem::timers::stiffness,
+                       domain->get_cost(specfem::timers::stiffness));
+      timers->add_cost(specfem::timers::sources,
+                       domain->get_cost(specfem::timers::sources));
+      timers->start(specfem::timers::corrector, exec_space);
+      it->apply_fused_corrector_phase(domain, false, exec_space);
+      timers->stop(specfem::timers::corrector, exec_space);
+      timers->add_cost(specfem::timers::corrector,
+                       it->get_cost(specfem::timers::corrector, domain, false));
+      if (compute_seismogram)
+        this->compute_seismogram(exec_space);
+      if (snapshot || transform) {
+        timers->start(specfem::timers::output, exec_space);
+        if (snapshot)
+          this->wavefield->snapshot(istep, exec_space);
+        if (transform)
+          this->spectrum->transform(istep, exec_space);
+        timers->stop(specfem::timers::output, exec_space);
+      }
+    }
+#if TIME
+    Kokkos::Profiling::popRegion();
+#endif
+
+    this->progress->update(istep + 1, nstep);
+
+    it->increment_time();
+
+    if (take_checkpoint && this->write_checkpoint(exec_space))
+      break;
+
+    if (!replay && it->status()) {
+      timers->start(specfem::timers::predictor, exec_space);
+      it->apply_predictor_phase(domain, exec_space);
+      timers->stop(specfem::timers::predictor, exec_space);
+      timers->add_cost(specfem::timers::predictor,
+                       it->get_cost(specfem::timers::predictor, domain));
+    }
+  }
+
+  exec_space.fence();
+
+  std::cout << std::endl;
+
+  return;
+}
+
+template <typename DomainType, typename TimeSchemeType>
+void specfem::solver::time_marching<DomainType, TimeSchemeType>::run_stages() {
+
+  TimeSchemeType *it = this->it;
+  DomainType *domain = this->domain;
+
+  const int nstep = it->get_max_timestep();
+  const int nstages = it->get_nstages();
+  specfem::timers::timers *timers = this->timers;
+
+  // Same execution space instances as the single stage algorithm
+  const bool overlap_sources = domain->concurrent_source_interaction();
+  const auto instances = Kokkos::Experimental::partition_space(
+      this->exec_space, 1, 1);
+  const specfem::kokkos::DevExecSpace &main_space = instances[0];
+  const specfem::kokkos::DevExecSpace &source_space =
+      overlap_sources ? instances[1] : instances[0];
+
+  while (it->status()) {
+    int istep = it->get_timestep();
+    timers->set_step(istep);
+
+#if TIME
+    Kokkos::Profiling::pushRegion("Stiffness calculation");
+#endif
+    // Every stage computes the acceleration at the stage time and updates the
+    // fields. The acceleration is reset by the stage updates, hence only the
+    // first stage needs the predictor phase
+    timers->start(specfem::timers::predictor, main_space);
+    it->apply_predictor_phase(domain, main_space);
+    timers->stop(specfem::timers::predictor, main_space);
+    timers->add_cost(specfem::timers::predictor,
+                     it->get_cost(specfem::timers::predictor, domain));
+
+    for (int istage = 0; istage < nstages; istage++) {
+      this->compute_acceleration(it->get_stage_time(istage), main_space,
+                                 source_space);
+
+      timers->start(specfem::timers::corrector, main_space);
+      it->apply_stage_update(domain, istage, main_space);
+      timers->stop(specfem::timers::corrector, main_space);
+    }
+
+    if (it->compute_seismogram())
+      this->compute_seismogram(main_space);
+    const bool snapshot = this->snapshot_step(istep);
+    const bool transform = this->transform_step(istep);
+    if (snapshot || transform) {
+      timers->start(specfem::timers::output, main_space);
+      if (snapshot)
+        this->wavefield->snapshot(istep, main_space);
+      if (transform)
+        this->spectrum->transform(istep, main_space);
+      timers->stop(specfem::timers::output, main_space);
+    }
+#if TIME
+    Kokkos::Profiling::popRegion();
+#endif
+
+    this->progress->update(istep + 1, nstep);
+
+    it->increment_time();
+
+    if (this->checkpoint_step(istep) && this->write_checkpoint(main_space))
+      break;
+  }
+
+  main_space.fence();
+
+  std::cout << std::endl;
+
+  return;
+}
+
+template <typename DomainType, typename TimeSchemeType>
+void specfem::solver::time_marching<DomainType, TimeSchemeType>::run_lts() {
+
+  TimeSchemeType *it = this->it;
+  DomainType *domain = this->domain;
+
+  const int nstep = it->get_max_timestep();
+  const int nsubsteps = 1 << (it->get_nlevels() - 1);
+  specfem::timers::timers *timers = this->timers;
+
+  // Same execution space instances as the single level algorithm
+  const bool overlap_sources = domain->concurrent_source_interaction();
+  const auto instances = Kokkos::Experimental::partition_space(
+      this->exec_space, 1, 1);
+  const specfem::kokkos::DevExecSpace &main_space = instances[0];
+  const specfem::kokkos::DevExecSpace &source_space =
+      overlap_sources ? instances[1] : instances[0];
+  const auto point_level = it->get_point_level();
+
+  while (it->status()) {
+    int istep = it->get_timestep();
+    timers->set_step(istep);
+
+#if TIME
+    Kokkos::Profiling::pushRegion("Stiffness calculation");
+#endif
+    for (int isubstep = 0; isubstep < nsubsteps; isubstep++) {
+      timers->start(specfem::timers::predictor, main_space);
+      it->apply_level_predictor_phase(domain, isubstep, main_space);
+      timers->stop(specfem::timers::predictor, main_space);
+
+      // Sources are assembled into the acceleration reset by the predictor
+      if (overlap_sources)
+        main_space.fence();
+
+      // Only elements containing points of the levels ending a step are
+      // computed
+      const int end_level = it->get_substep_level(isubstep);
+      timers->start(specfem::timers::stiffness, main_space);
+      domain->compute_level_stiffness_interaction(end_level, main_space);
+      timers->stop(specfem::timers::stiffness, main_space);
+
+      // Sources are evaluated at the start of the step of the level of every
+      // point, as in the Newmark timescheme. Levels are launched in ascending
+      // order of time
+      timers->start(specfem::timers::sources, source_space);
+      for (int ilevel = end_level; ilevel < it->get_nlevels(); ilevel++)
+        domain->compute_level_source_interaction(
+            it->get_level_time(isubstep, ilevel), point_level, ilevel,
+            source_space);
+      // Mass matrix division needs the complete acceleration
+      if (overlap_sources)
+        source_space.fence();
+      timers->stop(specfem::timers::sources, source_space);
+
+      timers->start(specfem::timers::corrector, main_space);
+      it->apply_level_corrector_phase(domain, isubstep, main_space);
+      timers->stop(specfem::timers::corrector, main_space);
+    }
+
+    // Every level ends a step at the end of the timestep
+    if (it->compute_seismogram())
+      this->compute_seismogram(main_space);
+    const bool snapshot = this->snapshot_step(istep);
+    const bool transform = this->transform_step(istep);
+    if (snapshot || transform) {
+      timers->start(specfem::timers::output, main_space);
+      if (snapshot)
+        this->wavefield->snapshot(istep, main_space);
+      if (transform)
+        this->spectrum->transform(istep, main_space);
+      timers->stop(specfem::timers::output, main_space);
+    }
+#if TIME
+    Kokkos::Profiling::popRegion();
+#endif
+
+    this->progress->update(istep + 1, nstep);
+
+    it->increment_time();
+
+    if (this->checkpoint_step(istep) && this->write_checkpoint(main_space))
+      break;
+  }
+
+  main_space.fence();
+
+  std::cout << std::endl;
+
+  return;
+}
+
+void specfem::solver::coupled_time_marching::run() {
+
+  if (this->it->get_nstages() > 1 || this->it->get_nlevels() > 1) {
+    throw std::runtime_error("Coupled fluid-solid simulations are only "
+                             "implemented for single stage timeschemes "
+                             "without local time stepping");
+  }
 
   specfem::TimeScheme::TimeScheme *it = this->it;
-  specfem::Domain::Domain *domain = this->domain;
+  specfem::Domain::Acoustic *fluid = this->fluid;
+  specfem::Domain::Elastic *solid = this->solid;
+  specfem::timers::timers *timers = this->timers;
+  const int coupling_phase = timers->add("Fluid-solid coupling");
 
   const int nstep = it->get_max_timestep();
 
+  // Every domain is updated on its own instance. Kernels reading the other
+  // domain, the predictor of the fluid and seismograms are launched on the
+  // solid instance after the fluid instance is fenced
+  const auto instances = Kokkos::Experimental::partition_space(
+      this->exec_space, 1, 1);
+  const specfem::kokkos::DevExecSpace &fluid_space = instances[0];
+  const specfem::kokkos::DevExecSpace &solid_space = instances[1];
+
+  if (it->status()) {
+    timers->start(specfem::timers::predictor, solid_space);
+    it->apply_predictor_phase(fluid, solid_space);
+    it->apply_predictor_phase(solid, solid_space);
+    timers->stop(specfem::timers::predictor, solid_space);
+  }
+
   while (it->status()) {
     int istep = it->get_timestep();
+    timers->set_step(istep);
 
     type_real timeval = it->get_time();
 
 #if TIME
     Kokkos::Profiling::pushRegion("Stiffness calculation");
 #endif
-    it->apply_predictor_phase(domain);
+    // Coupling point: the fluid reads the predicted displacement of the
+    // solid and its own predicted potential
+    timers->start(coupling_phase, solid_space);
+    solid_space.fence();
+    timers->stop(coupling_phase, solid_space);
+
+    // Phases of both domains are timed on the instance launching them, hence
+    // the phases of the fluid overlap with the phases of the solid unless
+    // the timers are accurate
+    timers->start(specfem::timers::stiffness, fluid_space);
+    fluid->compute_stiffness_interaction(fluid_space);
+    timers->stop(specfem::timers::stiffness, fluid_space);
+    timers->start(specfem::timers::sources, fluid_space);
+    fluid->compute_source_interaction(timeval, fluid_space);
+    timers->stop(specfem::timers::sources, fluid_space);
+    timers->start(coupling_phase, fluid_space);
+    this->coupling->compute_fluid_coupling(fluid_space);
+    timers->stop(coupling_phase, fluid_space);
+    // The solid coupling reads the second derivative of the potential, hence
+    // the predictor phase of the fluid isn't fused
+    timers->start(specfem::timers::corrector, fluid_space);
+    it->apply_fused_corrector_phase(fluid, false, fluid_space);
+    timers->stop(specfem::timers::corrector, fluid_space);
+
+    timers->start(specfem::timers::stiffness, solid_space);
+    solid->compute_stiffness_interaction(solid_space);
+    timers->stop(specfem::timers::stiffness, solid_space);
+    timers->start(specfem::timers::sources, solid_space);
+    solid->compute_source_interaction(timeval, solid_space);
+    timers->stop(specfem::timers::sources, solid_space);
+
+    // Coupling point: the solid reads the corrected second derivative of the
+    // potential
+    timers->start(coupling_phase, solid_space);
+    fluid_space.fence();
+    this->coupling->compute_solid_coupling(solid_space);
+    timers->stop(coupling_phase, solid_space);
 
-    domain->compute_stiffness_interaction();
-    domain->compute_source_interaction(timeval);
-    domain->divide_mass_matrix();
+    const bool compute_seismogram = it->compute_seismogram();
+    const bool apply_predictor = !compute_seismogram && (istep + 1 < nstep);
 
-    it->apply_corrector_phase(domain);
+    timers->start(specfem::timers::corrector, solid_space);
+    it->apply_fused_corrector_phase(solid, apply_predictor, solid_space);
+    timers->stop(specfem::timers::corrector, solid_space);
 
-    if (it->compute_seismogram()) {
-      int isig_step = it->get_seismogram_step();
-      domain->compute_seismogram(isig_step);
+    // Receivers of either domain are only sampled by that domain
+    if (compute_seismogram) {
+      timers->start(specfem::timers::seismograms, solid_space);
+      const int isig_step = it->get_seismogram_step();
+      fluid->compute_seismogram(isig_step, solid_space);
+      solid->compute_seismogram(isig_step, solid_space);
+      if (this->writer)
+        this->writer->sample(isig_step, solid_space);
       it->increment_seismogram_step();
+      timers->stop(specfem::timers::seismograms, solid_space);
     }
 #if TIME
     Kokkos::Profiling::popRegion();
 #endif
 
-    if (istep % 10 == 0) {
-      std::cout << "Progress : executed " << istep << " steps of " << nstep
-                << " steps\n";
-    }
+    this->progress->update(istep + 1, nstep);
 
     it->increment_time();
+
+    if (it->status()) {
+      timers->start(specfem::timers::predictor, solid_space);
+      it->apply_predictor_phase(fluid, solid_space);
+      if (!apply_predictor)
+        it->apply_predictor_phase(solid, solid_space);
+      timers->stop(specfem::timers::predictor, solid_space);
+    }
+  }
+
+  solid_space.fence();
+
+  std::cout << std::endl;
+
+  return;
+}
+
+specfem::solver::adjoint_time_marching::adjoint_time_marching(
+    specfem::Domain::Elastic *forward, specfem::Domain::Elastic *adjoint,
+    specfem::TimeScheme::Newmark *it,
+    const specfem::adjoint::kernels *kernels, const int ncheckpoints,
+    const type_real dt, const int compression_bits)
+    : forward(forward), adjoint(adjoint), it(it), adjoint_it(*it),
+      kernels(kernels), dt(dt), states(ncheckpoints) {
+
+  const auto field = forward->get_field();
+  if (compression_bits > 0) {
+    this->compressed = specfem::adjoint::quantizer(
+        3 * ncheckpoints, field.extent(0), field.extent(1), compression_bits);
+  } else {
+    this->checkpoints = specfem::kokkos::DeviceView4d<type_real>(
+        "specfem::solver::adjoint_time_marching::checkpoints", ncheckpoints, 3,
+        field.extent(0), field.extent(1));
+  }
+  this->adjoint_it.reset_time();
+}
+
+specfem::solver::adjoint_time_marching::adjoint_time_marching(
+    specfem::Domain::Elastic *forward, specfem::Domain::Elastic *adjoint,
+    specfem::TimeScheme::Newmark *it,
+    const specfem::adjoint::kernels *kernels,
+    specfem::adjoint::boundary_storage *boundaries, const type_real dt)
+    : forward(forward), adjoint(adjoint), it(it), adjoint_it(*it),
+      kernels(kernels), dt(dt), boundaries(boundaries) {
+  this->adjoint_it.reset_time();
+}
+
+void specfem::solver::adjoint_time_marching::run() {
+
+  if (this->boundaries) {
+    this->reconstruct();
+    return;
+  }
+
+  specfem::TimeScheme::Newmark *it = this->it;
+  specfem::Domain::Elastic *forward = this->forward;
+  specfem::Domain::Elastic *adjoint = this->adjoint;
+
+  const int nstep = it->get_max_timestep();
+  const int ncheckpoints = this->states.size();
+  const specfem::kokkos::DevExecSpace exec_space = this->exec_space;
+
+  specfem::adjoint::revolve schedule(nstep, ncheckpoints);
+
+  specfem::timers::timers *timers = this->timers;
+  const int checkpoint_phase = timers->add("Forward checkpoints");
+  const int kernel_phase = timers->add("Kernels");
+
+  int nadjoint = 0;
+  for (auto action = schedule.next();
+       action != specfem::adjoint::action::terminate;
+       action = schedule.next()) {
+    switch (action) {
+    case specfem::adjoint::action::advance:
+      while (it->get_timestep() < schedule.get_capo())
+        this->step(forward, it, it->get_time(), exec_space);
+      break;
+    case specfem::adjoint::action::takeshot:
+      timers->start(checkpoint_phase, exec_space);
+      this->store(schedule.get_check(), exec_space);
+      timers->stop(checkpoint_phase, exec_space);
+      break;
+    case specfem::adjoint::action::restore:
+      timers->start(checkpoint_phase, exec_space);
+      this->load(schedule.get_check(), exec_space);
+      timers->stop(checkpoint_phase, exec_space);
+      break;
+    case specfem::adjoint::action::firsturn:
+    case specfem::adjoint::action::youturn: {
+      // Adjoint sources are evaluated at the time of the forward step, hence
+      // both fields are at the same simulation time once the steps are done
+      const type_real timeval = it->get_time();
+      this->step(forward, it, timeval, exec_space);
+      this->step(adjoint, &this->adjoint_it, timeval, exec_space);
+      timers->start(kernel_phase, exec_space);
+      this->kernels->accumulate(forward, adjoint, this->dt, exec_space);
+      timers->stop(kernel_phase, exec_space);
+
+      nadjoint++;
+      this->progress->update(nadjoint, nstep, "adjoint steps");
+      break;
+    }
+    default:
+      break;
+    }
+  }
+
+  exec_space.fence();
+
+  std::cout << std::endl;
+
+  if (this->compressed.get_bits() > 0) {
+    const int bits = this->compressed.get_bits();
+    std::cout << "Compressed checkpoints : " << bits << " bits per value, "
+              << 8.0 * sizeof(type_real) / bits << "x smaller\n";
+    std::cout << "Largest relative error : " << this->errors[0]
+              << " (displacement), " << this->errors[1] << " (velocity), "
+              << this->errors[2] << " (acceleration)\n";
+    std::cout << std::endl;
+  }
+
+  return;
+}
+
+void specfem::solver::adjoint_time_marching::reconstruct() {
+
+  specfem::TimeScheme::Newmark *it = this->it;
+  specfem::Domain::Elastic *forward = this->forward;
+  specfem::Domain::Elastic *adjoint = this->adjoint;
+  specfem::adjoint::boundary_storage *boundaries = this->boundaries;
+
+  const int nstep = it->get_max_timestep();
+  const specfem::kokkos::DevExecSpace exec_space = this->exec_space;
+
+  specfem::timers::timers *timers = this->timers;
+  const int kernel_phase = timers->add("Kernels");
+  const int boundary_phase = timers->add("Absorbing tractions");
+
+  while (it->status()) {
+    const int istep = it->get_timestep();
+    timers->start(boundary_phase, exec_space);
+    const auto tractions = boundaries->record(istep, exec_space);
+    timers->stop(boundary_phase, exec_space);
+    forward->set_absorbing_mode(specfem::absorbing::record, tractions);
+    this->step(forward, it, it->get_time(), exec_space);
+
+    this->progress->update(istep + 1, nstep, "forward steps");
+  }
+  timers->start(boundary_phase, exec_space);
+  boundaries->flush(exec_space);
+  timers->stop(boundary_phase, exec_space);
+
+  // Newmark steps with -dt revert the steps with dt. Forward step istep
+  // computed the acceleration of position istep + 1 from the source at time
+  // t(istep) and the tractions of istep, hence reverting position istep + 2
+  // replays them
+  specfem::TimeScheme::Newmark backward(nstep, it->get_time(), -1.0 * this->dt,
+                                        1);
+  for (int istep = nstep - 1; istep >= 0; istep--) {
+    // Forward fields are at position istep + 1, i.e. at the time of the
+    // adjoint step
+    const type_real timeval = backward.get_time() - this->dt;
+    this->step(adjoint, &this->adjoint_it, timeval, exec_space);
+    timers->start(kernel_phase, exec_space);
+    this->kernels->accumulate(forward, adjoint, this->dt, exec_space);
+    timers->stop(kernel_phase, exec_space);
+
+    if (istep > 0) {
+      timers->start(boundary_phase, exec_space);
+      const auto tractions = boundaries->replay(istep - 1, exec_space);
+      timers->stop(boundary_phase, exec_space);
+      forward->set_absorbing_mode(specfem::absorbing::replay, tractions);
+      this->step(forward, &backward, timeval - this->dt, exec_space);
+    }
+
+    this->progress->update(nstep - istep, nstep, "adjoint steps");
   }
+  forward->set_absorbing_mode(specfem::absorbing::damp);
+
+  exec_space.fence();
 
   std::cout << std::endl;
 
   return;
 }
+
+void specfem::solver::adjoint_time_marching::step(
+    specfem::Domain::Elastic *domain, specfem::TimeScheme::Newmark *it,
+    const type_real timeval, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  specfem::timers::timers *timers = this->timers;
+  timers->set_step(it->get_timestep());
+
+  timers->start(specfem::timers::predictor, exec_space);
+  it->apply_predictor_phase(domain, exec_space);
+  timers->stop(specfem::timers::predictor, exec_space);
+  timers->add_cost(specfem::timers::predictor,
+                   it->get_cost(specfem::timers::predictor, domain));
+  timers->start(specfem::timers::stiffness, exec_space);
+  domain->compute_stiffness_interaction(exec_space);
+  timers->stop(specfem::timers::stiffness, exec_space);
+  timers->start(specfem::timers::sources, exec_space);
+  domain->compute_source_interaction(timeval, exec_space);
+  timers->stop(specfem::timers::sources, exec_space);
+  timers->add_cost(specfem::timers::stiffness,
+                   domain->get_cost(specfem::timers::stiffness));
+  timers->add_cost(specfem::timers::sources,
+                   domain->get_cost(specfem::timers::sources));
+  timers->start(specfem::timers::interfaces, exec_space);
+  domain->assemble_interfaces(exec_space);
+  timers->stop(specfem::timers::interfaces, exec_space);
+  timers->start(specfem::timers::corrector, exec_space);
+  it->apply_fused_corrector_phase(domain, false, exec_space);
+  timers->stop(specfem::timers::corrector, exec_space);
+  timers->add_cost(specfem::timers::corrector,
+                   it->get_cost(specfem::timers::corrector, domain, false));
+  it->increment_time();
+
+  return;
+}
+
+void specfem::solver::adjoint_time_marching::store(
+    const int icheckpoint, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const specfem::kokkos::DeviceFieldView2d<type_real> fields[3] = {
+    this->forward->get_field(), this->forward->get_field_dot(),
+    this->forward->get_field_dot_dot()
+  };
+  for (int ifield = 0; ifield < 3; ifield++) {
+    if (this->compressed.get_bits() > 0) {
+      const type_real error = this->compressed.compress(
+          3 * icheckpoint + ifield, fields[ifield], exec_space);
+      this->errors[ifield] = std::max(this->errors[ifield], error);
+      continue;
+    }
+    Kokkos::deep_copy(exec_space,
+                      Kokkos::subview(this->checkpoints, icheckpoint, ifield,
+                                      Kokkos::ALL, Kokkos::ALL),
+                      fields[ifield]);
+  }
+  this->states[icheckpoint] = this->it->get_state();
+
+  return;
+}
+
+void specfem::solver::adjoint_time_marching::load(
+    const int icheckpoint, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const specfem::kokkos::DeviceFieldView2d<type_real> fields[3] = {
+    this->forward->get_field(), this->forward->get_field_dot(),
+    this->forward->get_field_dot_dot()
+  };
+  for (int ifield = 0; ifield < 3; ifield++) {
+    if (this->compressed.get_bits() > 0) {
+      this->compressed.decompress(3 * icheckpoint + ifield, fields[ifield],
+                                  exec_space);
+      continue;
+    }
+    Kokkos::deep_copy(exec_space, fields[ifield],
+                      Kokkos::subview(this->checkpoints, icheckpoint, ifield,
+                                      Kokkos::ALL, Kokkos::ALL));
+  }
+  this->it->set_state(this->states[icheckpoint]);
+
+  return;
+}
+
+// Statically dispatched solvers
+template class specfem::solver::time_marching<specfem::Domain::Elastic,
+                                              specfem::TimeScheme::Newmark>;
+template class specfem::solver::time_marching<specfem::Domain::Elastic,
+                                              specfem::TimeScheme::LDDRK>;
+template class specfem::solver::time_marching<
+    specfem::Domain::Elastic, specfem::TimeScheme::LTSNewmark>;
+template class specfem::solver::time_marching<specfem::Domain::Acoustic,
+                                              specfem::TimeScheme::Newmark>;
+template class specfem::solver::time_marching<specfem::Domain::Acoustic,
+                                              specfem::TimeScheme::LDDRK>;
+// Runtime dispatched solver
+template class specfem::solver::time_marching<>;
+
+specfem::solver::solver *specfem::solver::instantiate_time_marching(
+    specfem::Domain::Domain *domain, specfem::TimeScheme::TimeScheme *it,
+    const bool graph_execution, specfem::writer::writer *writer,
+    specfem::writer::wavefield *wavefield,
+    specfem::checkpoint::checkpoint *checkpoint,
+    specfem::writer::spectrum *spectrum) {
+
+  if (auto elastic = dynamic_cast<specfem::Domain::Elastic *>(domain)) {
+    // LTSNewmark is derived from Newmark, hence it needs to be checked first
+    if (auto lts = dynamic_cast<specfem::TimeScheme::LTSNewmark *>(it)) {
+      return new specfem::solver::time_marching(elastic, lts, graph_execution,
+                                                writer, wavefield, checkpoint,
+                                                spectrum);
+    }
+    if (auto newmark = dynamic_cast<specfem::TimeScheme::Newmark *>(it)) {
+      return new specfem::solver::time_marching(
+          elastic, newmark, graph_execution, writer, wavefield, checkpoint,
+          spectrum);
+    }
+    if (auto lddrk = dynamic_cast<specfem::TimeScheme::LDDRK *>(it)) {
+      return new specfem::solver::time_marching(
+          elastic, lddrk, graph_execution, writer, wavefield, checkpoint,
+          spectrum);
+    }
+  }
+
+  // Local time stepping isn't implemented for acoustic domains
+  if (auto acoustic = dynamic_cast<specfem::Domain::Acoustic *>(domain);
+      acoustic && !dynamic_cast<specfem::TimeScheme::LTSNewmark *>(it)) {
+    if (auto newmark = dynamic_cast<specfem::TimeScheme::Newmark *>(it)) {
+      return new specfem::solver::time_marching(
+          acoustic, newmark, graph_execution, writer, wavefield, checkpoint,
+          spectrum);
+    }
+    if (auto lddrk = dynamic_cast<specfem::TimeScheme::LDDRK *>(it)) {
+      return new specfem::solver::time_marching(
+          acoustic, lddrk, graph_execution, writer, wavefield, checkpoint,
+          spectrum);
+    }
+  }
+
+  return new specfem::solver::time_marching(
+      domain, it, graph_execution, writer, wavefield, checkpoint, spectrum);
+}
@@ -1,14 +1,20 @@
 #include "../include/source.h"
+#include "../include/arena.h"
 #include "../include/config.h"
 #include "../include/globals.h"
 #include "../include/jacobian.h"
 #include "../include/kokkos_abstractions.h"
 #include "../include/lagrange_poly.h"
+#include "../include/location_cache.h"
 #include "../include/source_time_function.h"
 #include "../include/specfem_mpi.h"
 #include "../include/utils.h"
 #include "yaml-cpp/yaml.h"
 #include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
 KOKKOS_IMPL_HOST_FUNCTION
 specfem::forcing_function::stf *assign_stf(std::string forcing_type,
@@ -63,6 +69,75 @@ assign_dirac(YAML::Node &Dirac, type_real dt,
   return forcing_function;
 }
 
+KOKKOS_IMPL_HOST_FUNCTION
+specfem::forcing_function::stf *assign_tabulated(YAML::Node &Tabulated) {
+
+  const std::string filename = Tabulated["file"].as<std::string>();
+  const type_real factor = Tabulated["factor"].as<type_real>();
+
+  // Read (time, value) pairs uniformly sampled in time
+  std::ifstream stream(filename);
+  if (!stream.is_open()) {
+    std::ostringstream message;
+    message << "Could not open source time function file " << filename;
+    throw std::runtime_error(message.str());
+  }
+
+  std::vector<type_real> times;
+  std::vector<type_real> h_values;
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::istringstream tokens(line);
+    type_real time, value;
+    if (tokens >> time >> value) {
+      times.push_back(time);
+      h_values.push_back(value);
+    }
+  }
+
+  const int nsamples = h_values.size();
+  if (nsamples < 2) {
+    std::ostringstream message;
+    message << "Source time function file " << filename
+            << " needs at least 2 samples";
+    throw std::runtime_error(message.str());
+  }
+
+  const type_real tstart = times[0];
+  const type_real dt = (times[nsamples - 1] - tstart) / (nsamples - 1);
+  for (int isample = 1; isample < nsamples; isample++) {
+    if (std::abs(times[isample] - times[isample - 1] - dt) > 1e-3 * dt) {
+      std::ostringstream message;
+      message << "Source time function file " << filename
+              << " has to be sampled uniformly in time";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  type_real *values = (type_real *)
+      Kokkos::kokkos_malloc<specfem::kokkos::DevMemSpace>(nsamples *
+                                                          sizeof(type_real));
+  Kokkos::deep_copy(
+      specfem::kokkos::DeviceView1d<type_real>(values, nsamples),
+      specfem::kokkos::HostView1d<type_real>(h_values.data(), nsamples));
+
+  specfem::forcing_function::stf *forcing_function;
+  forcing_function = (specfem::forcing_function::stf *)
+      Kokkos::kokkos_malloc<specfem::kokkos::DevMemSpace>(
+          sizeof(specfem::forcing_function::Tabulated));
+
+  Kokkos::parallel_for(
+      "specfem::sources::source::allocate_tabulated_stf",
+      specfem::kokkos::DeviceRange(0, 1), KOKKOS_LAMBDA(const int &) {
+        new (forcing_function) specfem::forcing_function::Tabulated(
+            values, nsamples, tstart, dt, factor);
+      });
+
+  Kokkos::fence();
+
+  return forcing_function;
+}
+
 void specfem::sources::source::check_locations(const type_real xmin,
                                                const type_real xmax,
                                                const type_real zmin,
@@ -74,17 +149,29 @@ void specfem::sources::source::check_locations(const type_real xmin,
 
 void specfem::sources::force::locate(
     const specfem::kokkos::HostView2d<type_real> coord,
-    const specfem::kokkos::HostMirror3d<int> h_ibool,
+    const specfem::kokkos::HostElementMirror3d<int> h_ibool,
     const specfem::kokkos::HostMirror1d<type_real> xigll,
     const specfem::kokkos::HostMirror1d<type_real> zigll, const int nproc,
     const specfem::kokkos::HostView2d<type_real> coorg,
     const specfem::kokkos::HostView2d<int> knods, const int npgeo,
     const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
     const specfem::MPI::MPI *mpi) {
-  std::tie(this->xi, this->gamma, this->ispec, this->islice) =
-      specfem::utilities::locate(coord, h_ibool, xigll, zigll, nproc,
-                                 this->get_x(), this->get_z(), coorg, knods,
-                                 npgeo, mpi);
+  auto [xi, gamma, ispec, islice] = specfem::utilities::locate(
+      coord, h_ibool, xigll, zigll, nproc, this->get_x(), this->get_z(), coorg,
+      knods, npgeo, mpi);
+  this->set_location(xi, gamma, ispec, islice, coorg, knods, ispec_type, mpi);
+}
+
+void specfem::sources::force::set_location(
+    const type_real xi, const type_real gamma, const int ispec,
+    const int islice, const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
+    const specfem::MPI::MPI *mpi) {
+  this->xi = xi;
+  this->gamma = gamma;
+  this->ispec = ispec;
+  this->islice = islice;
   if (this->islice == mpi->get_rank()) {
     this->el_type = ispec_type(ispec);
   }
@@ -92,26 +179,41 @@ void specfem::sources::force::locate(
 
 void specfem::sources::moment_tensor::locate(
     const specfem::kokkos::HostView2d<type_real> coord,
-    const specfem::kokkos::HostMirror3d<int> h_ibool,
+    const specfem::kokkos::HostElementMirror3d<int> h_ibool,
     const specfem::kokkos::HostMirror1d<type_real> xigll,
     const specfem::kokkos::HostMirror1d<type_real> zigll, const int nproc,
     const specfem::kokkos::HostView2d<type_real> coorg,
     const specfem::kokkos::HostView2d<int> knods, const int npgeo,
     const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
     const specfem::MPI::MPI *mpi) {
-  std::tie(this->xi, this->gamma, this->ispec, this->islice) =
-      specfem::utilities::locate(coord, h_ibool, xigll, zigll, nproc,
-                                 this->get_x(), this->get_z(), coorg, knods,
-                                 npgeo, mpi);
+  auto [xi, gamma, ispec, islice] = specfem::utilities::locate(
+      coord, h_ibool, xigll, zigll, nproc, this->get_x(), this->get_z(), coorg,
+      knods, npgeo, mpi);
+  this->set_location(xi, gamma, ispec, islice, coorg, knods, ispec_type, mpi);
+}
 
-  if (this->islice == mpi->get_rank()) {
-    if (ispec_type(ispec) != specfem::elements::elastic) {
-      throw std::runtime_error(
-          "Found a Moment-tensor source in acoustic/poroelastic element");
-    } else {
-      this->el_type = specfem::elements::elastic;
-    }
+void specfem::sources::moment_tensor::set_location(
+    const type_real xi, const type_real gamma, const int ispec,
+    const int islice, const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
+    const specfem::MPI::MPI *mpi) {
+  this->xi = xi;
+  this->gamma = gamma;
+  this->ispec = ispec;
+  this->islice = islice;
+
+  // ispec is only an element of this rank on the owner
+  if (this->islice != mpi->get_rank())
+    return;
+
+  if (ispec_type(ispec) != specfem::elements::elastic) {
+    throw std::runtime_error(
+        "Found a Moment-tensor source in acoustic/poroelastic element");
+  } else {
+    this->el_type = specfem::elements::elastic;
   }
+
   int ngnod = knods.extent(0);
   this->s_coorg = specfem::kokkos::HostView2d<type_real>(
       "specfem::sources::moment_tensor::s_coorg", ndim, ngnod);
@@ -125,51 +227,76 @@ void specfem::sources::moment_tensor::locate(
   return;
 }
 
-void specfem::sources::force::compute_source_array(
+void specfem::sources::force::compute_lagrange_interpolants(
     const specfem::quadrature::quadrature &quadx,
     const specfem::quadrature::quadrature &quadz,
-    specfem::kokkos::HostView3d<type_real> source_array) {
+    specfem::kokkos::HostView1d<type_real> hxis,
+    specfem::kokkos::HostView1d<type_real> hgammas,
+    specfem::kokkos::HostView1d<type_real> components,
+    const specfem::wave::type wave, specfem::memory::arena &arena) {
 
-  type_real xi = this->xi;
-  type_real gamma = this->gamma;
   type_real angle = this->angle;
   specfem::elements::type el_type = this->el_type;
 
-  auto [hxis, hpxis] = Lagrange::compute_lagrange_interpolants(
-      xi, quadx.get_N(), quadx.get_hxi());
-  auto [hgammas, hpgammas] = Lagrange::compute_lagrange_interpolants(
-      gamma, quadz.get_N(), quadz.get_hxi());
+  // Interpolants are computed in place, only their derivatives are temporary
+  const auto mark = arena.mark();
+  using HostView1d = specfem::kokkos::HostView1d<type_real>;
+  auto hpxis = arena.allocate<HostView1d>(quadx.get_N());
+  auto hpgammas = arena.allocate<HostView1d>(quadz.get_N());
+  Lagrange::compute_lagrange_interpolants(hxis, hpxis, this->xi, quadx.get_N(),
+                                          quadx.get_hxi());
+  Lagrange::compute_lagrange_interpolants(hgammas, hpgammas, this->gamma,
+                                          quadz.get_N(), quadz.get_hxi());
+  arena.release(mark);
+
+  if (el_type == specfem::elements::acoustic ||
+      (el_type == specfem::elements::elastic && wave == specfem::wave::sh)) {
+    components(0) = 1.0;
+    components(1) = 1.0;
+  } else if ((el_type == specfem::elements::elastic &&
+              wave == specfem::wave::p_sv) ||
+             el_type == specfem::elements::poroelastic) {
+    components(0) = sin(angle);
+    components(1) = -1.0 * cos(angle);
+  }
+};
+
+void specfem::sources::force::compute_source_array(
+    const specfem::quadrature::quadrature &quadx,
+    const specfem::quadrature::quadrature &quadz,
+    specfem::kokkos::HostView3d<type_real> source_array,
+    const specfem::wave::type wave, specfem::memory::arena &arena) {
 
   int nquadx = quadx.get_N();
   int nquadz = quadz.get_N();
 
-  type_real hlagrange;
+  const auto mark = arena.mark();
+  auto hxis = arena.allocate<specfem::kokkos::HostView1d<type_real> >(nquadx);
+  auto hgammas =
+      arena.allocate<specfem::kokkos::HostView1d<type_real> >(nquadz);
+  auto components =
+      arena.allocate<specfem::kokkos::HostView1d<type_real> >(ndim);
+  for (int icomp = 0; icomp < ndim; icomp++)
+    components(icomp) = 0.0;
+  this->compute_lagrange_interpolants(quadx, quadz, hxis, hgammas, components,
+                                      wave, arena);
 
   for (int i = 0; i < nquadx; i++) {
     for (int j = 0; j < nquadz; j++) {
-      hlagrange = hxis(i) * hgammas(j);
-
-      if (el_type == specfem::elements::acoustic ||
-          (el_type == specfem::elements::elastic &&
-           specfem::globals::simulation_wave == specfem::wave::sh)) {
-        source_array(j, i, 0) = hlagrange;
-        source_array(j, i, 1) = hlagrange;
-      } else if ((el_type == specfem::elements::elastic &&
-                  specfem::globals::simulation_wave == specfem::wave::p_sv) ||
-                 el_type == specfem::elements::poroelastic) {
-        type_real tempx = sin(angle) * hlagrange;
-        source_array(j, i, 0) = tempx;
-        type_real tempz = -1.0 * cos(angle) * hlagrange;
-        source_array(j, i, 1) = tempz;
-      }
+      const type_real hlagrange = hxis(i) * hgammas(j);
+      source_array(j, i, 0) = components(0) * hlagrange;
+      source_array(j, i, 1) = components(1) * hlagrange;
     }
   }
+
+  arena.release(mark);
 };
 
 void specfem::sources::moment_tensor::compute_source_array(
     const specfem::quadrature::quadrature &quadx,
     const specfem::quadrature::quadrature &quadz,
-    specfem::kokkos::HostView3d<type_real> source_array) {
+    specfem::kokkos::HostView3d<type_real> source_array,
+    const specfem::wave::type wave, specfem::memory::arena &arena) {
 
   type_real xi = this->xi;
   type_real gamma = this->gamma;
@@ -179,14 +306,20 @@ void specfem::sources::moment_tensor::compute_source_array(
   auto s_coorg = this->s_coorg;
   int ngnod = s_coorg.extent(1);
 
-  auto [hxis, hpxis] = Lagrange::compute_lagrange_interpolants(
-      xi, quadx.get_N(), quadx.get_hxi());
-  auto [hgammas, hpgammas] = Lagrange::compute_lagrange_interpolants(
-      gamma, quadz.get_N(), quadz.get_hxi());
-
   int nquadx = quadx.get_N();
   int nquadz = quadz.get_N();
 
+  const auto mark = arena.mark();
+  using HostView1d = specfem::kokkos::HostView1d<type_real>;
+  auto hxis = arena.allocate<HostView1d>(nquadx);
+  auto hpxis = arena.allocate<HostView1d>(nquadx);
+  auto hgammas = arena.allocate<HostView1d>(nquadz);
+  auto hpgammas = arena.allocate<HostView1d>(nquadz);
+  Lagrange::compute_lagrange_interpolants(hxis, hpxis, xi, nquadx,
+                                          quadx.get_hxi());
+  Lagrange::compute_lagrange_interpolants(hgammas, hpgammas, gamma, nquadz,
+                                          quadz.get_hxi());
+
   type_real hlagrange;
   type_real dxis_dx = 0;
   type_real dxis_dz = 0;
@@ -218,6 +351,7 @@ void specfem::sources::moment_tensor::compute_source_array(
       source_array(j, i, 1) += Mxz * dsrc_dx + Mzz * dsrc_dz;
     }
   }
+  arena.release(mark);
 };
 
 void specfem::sources::force::check_locations(const type_real xmin,
@@ -263,6 +397,8 @@ specfem::sources::force::force(YAML::Node &Node, const type_real dt)
   if (YAML::Node Dirac = Node["Dirac"]) {
     this->forcing_function =
         assign_dirac(Dirac, dt, use_trick_for_better_pressure);
+  } else if (YAML::Node Tabulated = Node["Tabulated"]) {
+    this->forcing_function = assign_tabulated(Tabulated);
   }
 };
 
@@ -292,6 +428,8 @@ specfem::sources::moment_tensor::moment_tensor(YAML::Node &Node,
   if (YAML::Node Dirac = Node["Dirac"]) {
     this->forcing_function =
         assign_dirac(Dirac, dt, use_trick_for_better_pressure);
+  } else if (YAML::Node Tabulated = Node["Tabulated"]) {
+    this->forcing_function = assign_tabulated(Tabulated);
   }
 };
 
@@ -430,3 +568,32 @@ specfem::sources::operator<<(std::ostream &out,
   source.print(out);
   return out;
 }
+
+bool specfem::sources::locate(
+    const std::vector<specfem::sources::source *> &sources,
+    const specfem::kokkos::HostView2d<type_real> coord,
+    const specfem::kokkos::HostElementMirror3d<int> h_ibool,
+    const specfem::kokkos::HostMirror1d<type_real> xigll,
+    const specfem::kokkos::HostMirror1d<type_real> zigll,
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::kokkos::HostMirror1d<specfem::elements::type> ispec_type,
+    const specfem::MPI::MPI *mpi, const std::string &cache_file) {
+
+  std::vector<type_real> x, z;
+  for (const auto &source : sources) {
+    x.push_back(source->get_x());
+    z.push_back(source->get_z());
+  }
+
+  const auto [locations, cached] = specfem::location_cache::locate(
+      cache_file, coord, h_ibool, xigll, zigll, x, z, coorg, knods, mpi);
+
+  for (int i = 0; i < sources.size(); i++) {
+    const auto [xi, gamma, ispec, islice] = locations[i];
+    sources[i]->set_location(xi, gamma, ispec, islice, coorg, knods,
+                             ispec_type, mpi);
+  }
+
+  return cached;
+}
@@ -51,6 +51,34 @@ type_real specfem::forcing_function::Dirac::compute(type_real t) {
   return val;
 }
 
+KOKKOS_FUNCTION
+specfem::forcing_function::Tabulated::Tabulated(type_real *values,
+                                                int nsamples, type_real tstart,
+                                                type_real dt, type_real factor)
+    : values(values), nsamples(nsamples), tstart(tstart), dt(dt), tshift(0.0),
+      factor(factor) {
+
+  // The simulation has to start at the first sample
+  this->t0 = -1.0 * this->tstart;
+}
+
+KOKKOS_FUNCTION
+type_real specfem::forcing_function::Tabulated::compute(type_real t) {
+
+  const type_real s = (t - this->tshift - this->tstart) / this->dt;
+
+  if (s < 0.0 || s > static_cast<type_real>(this->nsamples - 1))
+    return 0.0;
+
+  const int isample = (static_cast<int>(s) < this->nsamples - 1)
+                          ? static_cast<int>(s)
+                          : this->nsamples - 2;
+  const type_real weight = s - static_cast<type_real>(isample);
+
+  return this->factor * ((1.0 - weight) * this->values[isample] +
+                         weight * this->values[isample + 1]);
+}
+
 // void specfem::forcing_function::stf::print(std::ostream &out) const {
 
 //   out << "  Error allocating source time function. Base class being called";
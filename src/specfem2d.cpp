@@ -1,26 +1,53 @@
+#include "../include/adjoint.h"
+#include "../include/attenuation.h"
+#include "../include/binding.h"
+#include "../include/checkpoint.h"
 #include "../include/compute.h"
 #include "../include/config.h"
+#include "../include/coupling.h"
+#include "../include/courant.h"
 #include "../include/domain.h"
+#include "../include/ensemble.h"
+#include "../include/first_touch.h"
+#include "../include/injection.h"
 #include "../include/kokkos_abstractions.h"
+#include "../include/load_balance.h"
+#include "../include/location_cache.h"
 #include "../include/material.h"
+#include "../include/memory_report.h"
 #include "../include/mesh.h"
+#include "../include/mesher.h"
+#include "../include/mpi_interfaces.h"
 #include "../include/parameter_parser.h"
 #include "../include/params.h"
+#include "../include/partitioner.h"
+#include "../include/pml.h"
+#include "../include/progress.h"
 #include "../include/read_mesh_database.h"
 #include "../include/read_sources.h"
 #include "../include/receiver.h"
+#include "../include/setup_cache.h"
 #include "../include/solver.h"
 #include "../include/source.h"
 #include "../include/specfem_mpi.h"
+#include "../include/startup_profiler.h"
+#include "../include/timers.h"
 #include "../include/timescheme.h"
+#include "../include/trace.h"
 #include "../include/utils.h"
+#include "../include/velocity_model.h"
 #include "yaml-cpp/yaml.h"
 #include <Kokkos_Core.hpp>
+#include <algorithm>
 #include <boost/program_options.hpp>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <ctime>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <vector>
 // Specfem2d driver
 
@@ -53,7 +80,13 @@ boost::program_options::options_description define_args() {
 
   desc.add_options()("help,h", "Print this help message")(
       "parameters_file,p", po::value<std::string>(),
-      "Location to parameters file");
+      "Location to parameters file")(
+      "restart,r", "Resume the simulation from the latest checkpoint")(
+      "verbose,v", "Print the location of every receiver")(
+      "dry-run,d",
+      "Predict the memory of the simulation from the mesh without running it")(
+      "ensemble,e", po::value<std::string>(),
+      "Location of a sweep specification. Simulate its members in this job");
 
   return desc;
 }
@@ -78,60 +111,410 @@ int parse_args(int argc, char **argv,
   return 1;
 }
 
-void execute(const std::string parameter_file, specfem::MPI::MPI *mpi) {
+void execute(const std::string parameter_file, const bool restart,
+             const bool verbose, const bool dry_run, specfem::MPI::MPI *mpi) {
 
   // log start time
   auto start_time = std::chrono::high_resolution_clock::now();
 
+  // Every setup stage is timed for the startup report
+  specfem::startup::profiler startup;
+  startup.start("Parameter file");
+  startup.add_read(parameter_file);
   specfem::runtime_configuration::setup setup(parameter_file);
-  const auto [database_filename, source_filename] = setup.get_databases();
+  const auto database_filename = std::get<0>(setup.get_databases());
+  // Every source file defines a shot. Shots are simulated together
+  const auto source_files = setup.get_source_files();
+  int nshots = source_files.size();
   const auto stations_filename = setup.get_stations_file();
+  const bool reciprocal = setup.get_reciprocal();
+  const auto adjoint = setup.get_adjoint_configuration();
+  startup.stop();
 
   mpi->cout(setup.print_header(start_time));
 
+  // Setup and time loop phases are timed for the performance summary. Traced
+  // phases are recorded by the timers, and measured element weights are
+  // computed from the timed phases
+  const std::string trace_file = setup.get_trace_file();
+  const std::string element_weights_file = setup.get_element_weights_file();
+  specfem::timers::timers timers(setup.get_timers() || !trace_file.empty() ||
+                                     !element_weights_file.empty(),
+                                 setup.get_accurate_timers());
+  timers.set_peak(setup.get_peak_bandwidth(), setup.get_peak_flops());
+  specfem::trace::recorder trace =
+      trace_file.empty()
+          ? specfem::trace::recorder()
+          : specfem::trace::recorder(mpi, setup.get_trace_first_step(),
+                                     setup.get_trace_last_step());
+  if (!trace_file.empty()) {
+    trace.record_kernels();
+    timers.set_trace(&trace);
+  }
+
   // Set up GLL quadrature points
+  startup.start("Quadrature");
   auto [gllx, gllz] = setup.instantiate_quadrature();
+  startup.stop();
 
-  // Read mesh generated MESHFEM
+  // Read mesh generated MESHFEM. When partitioning, every rank reads the
+  // serial database and keeps its own partition. The serial arrays are
+  // stored once per node until the mesh is partitioned. Meshes generated by
+  // the internal mesher are serial, hence they are always partitioned
+  const bool internal_mesh = setup.get_internal_mesh();
+  const bool partition_mesh =
+      (setup.get_partition_mesh() || internal_mesh) && mpi->get_size() > 1;
+  const int mesh_phase = timers.add("Mesh");
+  timers.start(mesh_phase);
+  startup.start(internal_mesh ? "Internal mesher" : "Database");
+  if (!internal_mesh)
+    startup.add_read(database_filename);
   std::vector<specfem::material *> materials;
-  specfem::mesh mesh(database_filename, materials, mpi);
+  specfem::mesh mesh =
+      internal_mesh
+          ? specfem::mesher::generate(setup.get_layered_model(), materials,
+                                      mpi)
+          : specfem::mesh(database_filename, materials, mpi, partition_mesh);
+  startup.stop();
+  timers.stop(mesh_phase);
+
+  const int partition_phase = timers.add("Partitioning");
+  timers.start(partition_phase);
+  startup.start("Partitioning");
+  // Weights of the serial elements, measured by a previous run if they are
+  // read from a file
+  if (!element_weights_file.empty() && !partition_mesh)
+    throw std::runtime_error("Element weights can only be written for meshes "
+                             "partitioned at startup");
+  std::vector<type_real> element_weights;
+  if (partition_mesh) {
+    element_weights =
+        setup.get_partition_weights_file().empty()
+            ? specfem::partitioner::element_weights(
+                  mesh, materials, setup.get_partition_weights())
+            : specfem::partitioner::read_element_weights(
+                  setup.get_partition_weights_file(), mesh.nspec);
+    const auto element_partition = specfem::partitioner::partition_elements(
+        mesh.coorg, mesh.material_ind.knods, element_weights,
+        mpi->get_size());
+    mpi->cout(specfem::partitioner::print(element_weights, element_partition,
+                                          mpi->get_size()));
+    mesh.partition(element_partition, mpi->get_rank());
+  }
+
+  // Reorder elements before global numbering is assigned
+  mesh.reorder_elements(setup.get_element_ordering());
+  startup.stop();
+  timers.stop(partition_phase);
+
+  // Predict the memory resident after setup from the sizes of the simulation
+  if (dry_run) {
+    const int nreceivers = specfem::read_receivers(
+                               stations_filename, setup.get_receiver_angle())
+                               .size();
+    const int ncomponents_shot =
+        (setup.get_wave_type() == specfem::wave::sh) ? 1 : ndim;
+    auto [sources, shots, t0] =
+        specfem::read_sources(source_files, setup.get_dt(), mpi);
+    const int nforces = nreceivers * ncomponents_shot;
+    const int nseismogram_steps = setup.get_max_seismogram_step();
+    const int buffer_size = setup.get_seismogram_buffer_size();
+
+    specfem::memory::problem_size size;
+    size.nspec = mesh.nspec;
+    size.ngllz = gllz.get_N();
+    size.ngllx = gllx.get_N();
+    size.ncomponents = ncomponents_shot * (reciprocal ? nforces : nshots);
+    size.nsources = reciprocal ? nforces : sources.size();
+    size.nreceivers = reciprocal ? sources.size() : nreceivers * nshots;
+    size.nseismogram_types = setup.get_seismogram_types().size();
+    size.nseismogram_steps =
+        (buffer_size > 0 && buffer_size < nseismogram_steps)
+            ? buffer_size
+            : nseismogram_steps;
+
+    mpi->cout("Dry run : predicted memory");
+    mpi->cout(specfem::memory::print(specfem::memory::estimate(size), mpi));
+
+    for (auto &material : materials)
+      delete material;
+    for (auto &source : sources)
+      delete source;
+    return;
+  }
+
+  // Generate compute structs to be used by the solver. Structs are loaded
+  // from the setup cache if a previous run used the same mesh and quadrature
+  const int compute_phase = timers.add("Compute structs");
+  timers.start(compute_phase);
+  specfem::compute::compute compute;
+  specfem::compute::partial_derivatives partial_derivatives;
+  specfem::compute::properties material_properties;
+
+  const std::string setup_cache = setup.get_setup_cache();
+  std::uint64_t cache_key = 0;
+  bool cached = false;
+  if (!setup_cache.empty()) {
+    startup.start("Setup cache");
+    cache_key = specfem::setup_cache::key(
+        mesh.coorg, mesh.material_ind.knods, mesh.material_ind.kmato,
+        materials, gllx, gllz);
+    cached = specfem::setup_cache::load(
+        specfem::setup_cache::filename(setup_cache, mpi), cache_key, compute,
+        partial_derivatives, material_properties);
+    if (cached)
+      startup.add_read(specfem::setup_cache::filename(setup_cache, mpi));
+    startup.stop();
+  }
+
+  if (!cached) {
+    startup.start("Global numbering");
+    compute = specfem::compute::compute(mesh.coorg, mesh.material_ind.knods,
+                                        gllx, gllz);
+    startup.stop();
+    startup.start("Partial derivatives");
+    partial_derivatives = specfem::compute::partial_derivatives(
+        mesh.coorg, mesh.material_ind.knods, gllx, gllz);
+    startup.stop();
+    startup.start("Material properties");
+    material_properties = specfem::compute::properties(
+        mesh.material_ind.kmato, materials, mesh.nspec, gllx.get_N(),
+        gllz.get_N());
+    startup.stop();
+    if (!setup_cache.empty()) {
+      startup.start("Setup cache");
+      specfem::setup_cache::save(
+          specfem::setup_cache::filename(setup_cache, mpi), cache_key,
+          compute, partial_derivatives, material_properties);
+      startup.stop();
+    }
+  }
+
+  if (!setup_cache.empty()) {
+    std::ostringstream message;
+    message << "Setup cache : loaded by "
+            << mpi->reduce(static_cast<int>(cached), specfem::MPI::sum)
+            << " of " << mpi->get_size() << " processes\n";
+    mpi->cout(message.str());
+  }
+
+  // Elements on the axis of axisymmetric meshes use the GLJ quadrature along
+  // xi. Their points are moved after the setup cache, which stores the GLL
+  // points, and before models are interpolated onto them
+  const specfem::quadrature::quadrature quadglj(0.0, 1.0, gllx.get_N());
+  if (mesh.axisym) {
+    if (setup.get_wave_type() != specfem::wave::p_sv || reciprocal ||
+        adjoint) {
+      throw std::runtime_error(
+          "Axisymmetric simulations are only implemented for forward P-SV "
+          "simulations");
+    }
+    startup.start("Axial elements");
+    compute.assign_axial_elements(mesh.coorg, mesh.material_ind.knods,
+                                  mesh.axial_nodes.is_on_the_axis, quadglj,
+                                  gllz);
+    const int naxial = partial_derivatives.assign_axial_elements(
+        mesh.coorg, mesh.material_ind.knods, mesh.axial_nodes.is_on_the_axis,
+        quadglj, gllz);
+    startup.stop();
+    std::ostringstream message;
+    message << "Axisymmetric mesh : " << mpi->reduce(naxial, specfem::MPI::sum)
+            << " elements on the axis\n";
+    mpi->cout(message.str());
+  }
+
+  // External models are interpolated after the setup cache, which stores the
+  // properties of the database
+  const auto [model_file, tile_rows] = setup.get_velocity_model();
+  if (!model_file.empty()) {
+    startup.start("Velocity model");
+    startup.add_read(model_file);
+    const int npoints = specfem::velocity_model::interpolate(
+        model_file, tile_rows, compute.coordinates.coord, compute.h_ibool,
+        material_properties);
+    std::ostringstream message;
+    message << "Velocity model : " << model_file << " interpolated onto "
+            << mpi->reduce(npoints, specfem::MPI::sum)
+            << " quadrature points\n";
+    startup.stop();
+    mpi->cout(message.str());
+  }
+
+  // Models constant inside every material are stored once for every
+  // material on the device
+  startup.start("Compression");
+  const bool compressed =
+      material_properties.compress(mesh.material_ind.kmato);
+  {
+    std::ostringstream message;
+    message << "Material properties : stored once for every material by "
+            << mpi->reduce(static_cast<int>(compressed), specfem::MPI::sum)
+            << " of " << mpi->get_size() << " processes\n";
+    mpi->cout(message.str());
+  }
+
+  // Partial derivatives of affine elements are stored once for every
+  // element
+  const int naffine = partial_derivatives.assign_affine_elements(
+      mesh.coorg, mesh.material_ind.knods);
+  startup.stop();
+  {
+    std::ostringstream message;
+    message << "Affine elements : "
+            << mpi->reduce(naffine, specfem::MPI::sum) << " of "
+            << mpi->reduce(mesh.nspec, specfem::MPI::sum) << " elements\n";
+    mpi->cout(message.str());
+  }
+
+  // Interior points of every element are numbered consecutively, before
+  // global numbers are used to locate sources, receivers and interfaces
+  if (setup.get_domain_options().compressed_connectivity) {
+    startup.start("Compression");
+    const bool compressed = compute.compress_connectivity();
+    startup.stop();
+    std::ostringstream message;
+    message << "Global numbering : compressed by "
+            << mpi->reduce(static_cast<int>(compressed), specfem::MPI::sum)
+            << " of " << mpi->get_size() << " processes\n";
+    mpi->cout(message.str());
+  }
+
+  // Points of structured blocks are numbered as dense tiles, hence this
+  // also needs to happen before global numbers are used
+  if (setup.get_domain_options().structured_blocks) {
+    startup.start("Structured blocks");
+    const auto [nblocks, nstructured] =
+        compute.assign_structured_blocks(mesh.material_ind.knods);
+    startup.stop();
+    std::ostringstream message;
+    message << "Structured blocks : "
+            << mpi->reduce(nstructured, specfem::MPI::sum) << " elements in "
+            << mpi->reduce(nblocks, specfem::MPI::sum) << " blocks\n";
+    mpi->cout(message.str());
+  }
+
+  timers.stop(compute_phase);
+
+  // Print spectral element information
+  mpi->cout(mesh.print(materials));
+
+  // Estimate the maximum stable time step
+  startup.start("Stable time step");
+  const auto stable_timestep = specfem::courant::compute_stable_timestep(
+      compute.coordinates.coord, compute.h_ibool, material_properties.h_rho,
+      material_properties.rho_vp, material_properties.rho_vs);
+  const type_real stable_dt =
+      mpi->all_reduce(stable_timestep.dt, specfem::MPI::min);
+  startup.stop();
+  mpi->cout(stable_timestep.print());
+
+  // With local time stepping dt is the time step of the coarsest level
+  const int lts_levels = setup.get_lts_levels();
+  std::vector<int> element_levels;
+  if (lts_levels > 1) {
+    // The finest level is stepped with the stable time step of the mesh. The
+    // coarsest level is not larger than the stable time step of any element
+    const auto &element_dt = stable_timestep.spectral_element_dt;
+    const type_real max_element_dt = mpi->all_reduce(
+        *std::max_element(element_dt.begin(), element_dt.end()),
+        specfem::MPI::max);
+    setup.update_dt(
+        std::min(stable_dt * (1 << (lts_levels - 1)), max_element_dt));
+    element_levels = specfem::courant::compute_element_levels(
+        element_dt, setup.get_dt(), lts_levels);
+  } else {
+    setup.update_dt(stable_dt);
+    if (setup.get_dt() > stable_dt) {
+      std::ostringstream message;
+      message << "WARNING : dt = " << setup.get_dt()
+              << " is larger than the maximum stable time step " << stable_dt
+              << ". The simulation might be unstable.\n";
+      mpi->cout(message.str());
+    }
+  }
+
+  const int source_phase = timers.add("Sources and receivers");
+  timers.start(source_phase);
+  startup.start("Source and receiver locate");
+  for (const auto &source_file : source_files)
+    startup.add_read(source_file);
+  startup.add_read(stations_filename);
 
   // Read sources
   //    if start time is not explicitly specified then t0 is determined using
   //    source frequencies and time shift
-  auto [sources, t0] =
-      specfem::read_sources(source_filename, setup.get_dt(), mpi);
+  auto [sources, shots, t0] =
+      specfem::read_sources(source_files, setup.get_dt(), mpi);
   const auto angle = setup.get_receiver_angle();
   auto receivers = specfem::read_receivers(stations_filename, angle);
 
-  // Generate compute structs to be used by the solver
-  specfem::compute::compute compute(mesh.coorg, mesh.material_ind.knods, gllx,
-                                    gllz);
-  specfem::compute::partial_derivatives partial_derivatives(
-      mesh.coorg, mesh.material_ind.knods, gllx, gllz);
-  specfem::compute::properties material_properties(mesh.material_ind.kmato,
-                                                   materials, mesh.nspec,
-                                                   gllx.get_N(), gllz.get_N());
+  // Reciprocal simulations apply forces at the stations, every force being a
+  // shot, and record the responses at the sources
+  std::vector<specfem::sources::source *> forces;
+  std::vector<int> force_shots;
+  type_real force_t0 = 0.0;
+  if (reciprocal) {
+    std::tie(forces, force_shots, force_t0) = specfem::reciprocal_sources(
+        receivers, setup.get_wave_type(), setup.get_dt());
+    nshots = forces.size();
+  }
 
-  // Print spectral element information
-  mpi->cout(mesh.print(materials));
+  // Adjoint simulations apply the residuals at the stations to a second
+  // domain stepped backward in time
+  std::vector<specfem::sources::source *> adjoint_forces;
+  if (adjoint) {
+    if (reciprocal || nshots > 1) {
+      throw std::runtime_error("Adjoint simulations are only implemented for "
+                               "a single shot without reciprocity");
+    }
+    adjoint_forces = specfem::adjoint_sources(
+        receivers, setup.get_wave_type(), adjoint->get_residuals_folder(),
+        setup.get_dt());
+  }
 
-  // Locate the sources
-  for (auto &source : sources)
-    source->locate(compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
-                   gllz.get_hxi(), mesh.nproc, mesh.coorg,
-                   mesh.material_ind.knods, mesh.npgeo,
-                   material_properties.h_ispec_type, mpi);
+  // Locate the sources and receivers in batches, every batch having its own
+  // location cache file
+  const std::string location_cache = setup.get_location_cache();
+  const auto cache_file = [&](const std::string &name) -> std::string {
+    return location_cache.empty()
+               ? ""
+               : specfem::location_cache::filename(location_cache, name, mpi);
+  };
 
-  for (auto &receiver : receivers)
-    receiver->locate(compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
-                     gllz.get_hxi(), mesh.nproc, mesh.coorg,
-                     mesh.material_ind.knods, mesh.npgeo,
-                     material_properties.h_ispec_type, mpi);
+  int located_batches = 0;
+  for (const auto &[name, located] :
+       { std::make_tuple("sources", sources), std::make_tuple("forces", forces),
+         std::make_tuple("adjoint_sources", adjoint_forces) }) {
+    located_batches += specfem::sources::locate(
+        located, compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
+        gllz.get_hxi(), mesh.coorg, mesh.material_ind.knods,
+        material_properties.h_ispec_type, mpi, cache_file(name));
+  }
+
+  located_batches += receivers.locate(
+      compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
+      gllz.get_hxi(), mesh.coorg, mesh.material_ind.knods, mpi,
+      cache_file("stations"));
+  startup.stop();
+
+  if (!location_cache.empty()) {
+    std::ostringstream message;
+    message << "Location cache : " << located_batches
+            << " of 4 batches loaded\n";
+    mpi->cout(message.str());
+  }
 
   mpi->cout("Source Information:");
   mpi->cout("-------------------------------");
   if (mpi->main_proc()) {
+    if (reciprocal)
+      std::cout << "Reciprocal simulation : " << nshots
+                << " forces applied at the stations\n";
+    else if (nshots > 1)
+      std::cout << "Number of shots : " << nshots << "\n";
+    if (adjoint)
+      std::cout << "Adjoint simulation : " << adjoint_forces.size()
+                << " residuals applied at the stations\n";
     std::cout << "Number of sources : " << sources.size() << "\n\n";
   }
 
@@ -145,51 +528,631 @@ void execute(const std::string parameter_file, specfem::MPI::MPI *mpi) {
     std::cout << "Number of receivers : " << receivers.size() << "\n\n";
   }
 
-  for (auto &receiver : receivers) {
-    mpi->cout(receiver->print());
+  // Dense arrays define too many receivers to describe every receiver
+  if (verbose) {
+    for (int irec = 0; irec < receivers.size(); irec++) {
+      mpi->cout(receivers.print(irec));
+    }
   }
 
+  // Every shot records the stations. Responses of reciprocal simulations
+  // are recorded at the sources instead
+  const auto recorded = reciprocal ? specfem::receivers::receiver_set(angle)
+                                   : receivers.replicate(nshots);
+
   // Update solver intialization time
-  setup.update_t0(-1.0 * t0);
+  setup.update_t0(-1.0 * (reciprocal ? force_t0 : t0));
 
   // Instantiate the solver and timescheme
   auto it = setup.instantiate_solver();
 
   // Setup solver compute struct
+  startup.start("Source and receiver structs");
 
   const type_real xmax = compute.coordinates.xmax;
   const type_real xmin = compute.coordinates.xmin;
   const type_real zmax = compute.coordinates.zmax;
   const type_real zmin = compute.coordinates.zmin;
 
-  specfem::compute::sources compute_sources(sources, gllx, gllz, xmax, xmin,
-                                            zmax, zmin, mpi);
+  specfem::compute::sources compute_sources(
+      reciprocal ? forces : sources, gllx, gllz, xmax, xmin, zmax, zmin, mpi,
+      setup.get_wave_type(), reciprocal ? force_shots : shots,
+      mesh.axisym ? mesh.axial_nodes.is_on_the_axis
+                  : specfem::kokkos::HostView1d<bool>());
+
+  specfem::compute::sources compute_adjoint_sources;
+  if (adjoint) {
+    compute_adjoint_sources =
+        specfem::compute::sources(adjoint_forces, gllx, gllz, xmax, xmin, zmax,
+                                  zmin, mpi, setup.get_wave_type());
+  }
 
   specfem::compute::receivers compute_receivers(
-      receivers, setup.get_seismogram_types(), gllx, gllz, xmax, xmin, zmax,
-      zmin, it->get_max_seismogram_step(), mpi);
+      recorded, setup.get_seismogram_types(), gllx, gllz, xmax, xmin, zmax,
+      zmin, it->get_max_seismogram_step(), mpi,
+      setup.get_seismogram_buffer_size(), setup.get_seismogram_decimation(),
+      mesh.axisym ? mesh.axial_nodes.is_on_the_axis
+                  : specfem::kokkos::HostView1d<bool>());
+  startup.stop();
+  timers.stop(source_phase);
+
+  const int domain_phase = timers.add("Domains and writers");
+  timers.start(domain_phase);
+
+  // Interface points shared with neighboring ranks. SH domains store a
+  // single field component for every shot
+  const int ncomponents =
+      ((setup.get_wave_type() == specfem::wave::sh) ? 1 : ndim) * nshots;
+  startup.start("Interfaces");
+  specfem::interfaces::halo halo(
+      mesh.interface, compute.h_ibool, compute.coordinates.coord,
+      mesh.material_ind.knods, material_properties.h_ispec_type, ncomponents,
+      mpi);
+  startup.stop();
 
-  // Instantiate domain classes
+  // Instantiate domain classes. Domains assemble the mass matrix
+  startup.start("Domains");
   const int nglob = specfem::utilities::compute_nglob(compute.h_ibool);
-  specfem::Domain::Domain *domains = new specfem::Domain::Elastic(
-      ndim, nglob, &compute, &material_properties, &partial_derivatives,
-      &compute_sources, &compute_receivers, &gllx, &gllz);
+  auto domain_options = setup.get_domain_options();
+  domain_options.nshots = nshots;
+  // Purely acoustic meshes use the acoustic domain. Meshes with fluid and
+  // solid elements use both domains coupled along fluid-solid edges
+  int nacoustic = 0;
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    if (material_properties.h_ispec_type(ispec) == specfem::elements::acoustic)
+      nacoustic++;
+  }
+  const int nacoustic_total = mpi->all_reduce(nacoustic, specfem::MPI::sum);
+  const int nspec_total = mpi->all_reduce(mesh.nspec, specfem::MPI::sum);
+  const bool acoustic = nacoustic_total > 0 && nacoustic_total == nspec_total;
+  const bool coupled = nacoustic_total > 0 && nacoustic_total < nspec_total;
+
+  // Acoustic points are numbered compactly, writers reading the global
+  // numbering can't read acoustic fields
+  if ((acoustic || coupled) &&
+      (lts_levels > 1 || setup.get_attenuation() || reciprocal ||
+       setup.get_wavefield_snapshots() || setup.get_spectra())) {
+    throw std::runtime_error(
+        "Local time stepping, attenuation, reciprocal simulations, "
+        "wavefield and spectrum writers are not implemented for acoustic "
+        "meshes");
+  }
+
+  specfem::Domain::Domain *domains = nullptr;
+  specfem::Domain::Acoustic *fluid = nullptr;
+  specfem::coupling::fluid_solid *coupling = nullptr;
+  if (acoustic) {
+    domains = new specfem::Domain::Acoustic(
+        ndim, &compute, &material_properties, &partial_derivatives,
+        &compute_sources, &compute_receivers, &gllx, &gllz, domain_options,
+        &halo);
+    mpi->cout("Acoustic domain : scalar potential, one component per shot");
+  } else {
+    domains = new specfem::Domain::Elastic(
+        ndim, nglob, &compute, &material_properties, &partial_derivatives,
+        &compute_sources, &compute_receivers, &gllx, &gllz, domain_options,
+        &halo);
+  }
+
+  // Axisymmetric masses are assembled again, weighted by the radius
+  if (mesh.axisym) {
+    if (acoustic || coupled) {
+      throw std::runtime_error(
+          "Axisymmetric simulations are not implemented for acoustic meshes");
+    }
+    static_cast<specfem::Domain::Elastic *>(domains)->set_axisymmetric(
+        mesh.axial_nodes.is_on_the_axis);
+  }
 
+  // The adjoint domain shares the mesh and the timescheme coefficients of
+  // the forward domain. Only the Newmark timescheme stores a single state
+  // per field, hence forward states are checkpointed as the fields
+  specfem::Domain::Elastic *adjoint_domain = nullptr;
+  auto newmark = dynamic_cast<specfem::TimeScheme::Newmark *>(it);
+  if (newmark)
+    newmark->set_stability_check(setup.get_stability_interval(),
+                                 setup.get_stability_threshold());
+  if (adjoint) {
+    if (acoustic || coupled) {
+      throw std::runtime_error(
+          "Adjoint simulations are not implemented for acoustic meshes");
+    }
+    if (!newmark || it->get_nlevels() > 1) {
+      throw std::runtime_error(
+          "Adjoint simulations are only implemented for the Newmark "
+          "timescheme without local time stepping");
+    }
+    // Memory variables and snapshots would need to be checkpointed and
+    // reversed with the fields
+    if (setup.get_attenuation() || setup.get_pml() ||
+        setup.get_graph_execution() || setup.get_wavefield_snapshots() ||
+        setup.get_spectra() || restart) {
+      throw std::runtime_error(
+          "Attenuation, PML layers, graph execution, wavefield and spectrum "
+          "writers and restarts are not implemented for adjoint simulations");
+    }
+    adjoint_domain = new specfem::Domain::Elastic(
+        ndim, nglob, &compute, &material_properties, &partial_derivatives,
+        &compute_adjoint_sources, &compute_receivers, &gllx, &gllz,
+        domain_options, &halo);
+  }
+
+  if (coupled) {
+    if (setup.get_graph_execution()) {
+      throw std::runtime_error(
+          "Graph execution is not implemented for coupled fluid-solid meshes");
+    }
+    fluid = new specfem::Domain::Acoustic(
+        ndim, &compute, &material_properties, &partial_derivatives,
+        &compute_sources, &compute_receivers, &gllx, &gllz, domain_options,
+        &halo);
+    coupling = new specfem::coupling::fluid_solid(
+        mesh.fluid_solid_edges, mesh.material_ind.knods, &compute, &gllx,
+        &gllz, fluid, static_cast<specfem::Domain::Elastic *>(domains),
+        nshots);
+    std::ostringstream message;
+    message << "Fluid-solid coupling : "
+            << mpi->reduce(mesh.fluid_solid_edges.nedges(), specfem::MPI::sum)
+            << " edges, "
+            << mpi->reduce(coupling->get_npoints(), specfem::MPI::sum)
+            << " quadrature points\n";
+    mpi->cout(message.str());
+  }
+  startup.stop();
+
+  // Order elements of the domain by level
+  startup.start("Boundaries and attenuation");
+  if (lts_levels > 1) {
+    it->set_element_levels(domains, compute.h_ibool, element_levels);
+    std::ostringstream message;
+    it->print(message);
+    mpi->cout(message.str());
+  }
+
+  // Memory variables are updated by every stiffness interaction, hence once
+  // per time step
+  if (setup.get_attenuation()) {
+    if (it->get_nstages() > 1) {
+      throw std::runtime_error("Attenuation is only implemented for time "
+                               "schemes with a single stage");
+    }
+    const specfem::attenuation::model attenuation(
+        mesh.n_sls, mesh.attenuation_f0_reference);
+    domains->set_attenuation(attenuation, setup.get_dt());
+    mpi->cout(attenuation.print());
+  }
+
+  // Absorbing edges are damped after every stiffness interaction of the
+  // domain containing them
+  if (setup.get_absorbing_boundaries()) {
+    domains->set_absorbing_boundary(mesh.abs_boundary);
+    int npoints = domains->get_absorbing_npoints();
+    if (coupled) {
+      fluid->set_absorbing_boundary(mesh.abs_boundary);
+      npoints += fluid->get_absorbing_npoints();
+    }
+    // Adjoint fields are damped by the same boundaries
+    if (adjoint_domain)
+      adjoint_domain->set_absorbing_boundary(mesh.abs_boundary);
+    std::ostringstream message;
+    message << "Stacey absorbing boundaries : "
+            << mpi->reduce(mesh.parameters.nelemabs, specfem::MPI::sum)
+            << " edges, " << mpi->reduce(npoints, specfem::MPI::sum)
+            << " quadrature points\n";
+    mpi->cout(message.str());
+  }
+
+  // Memory variables of PML elements are updated by every stiffness
+  // interaction, hence once per time step
+  if (setup.get_pml()) {
+    if (it->get_nstages() > 1) {
+      throw std::runtime_error("PML layers are only implemented for time "
+                               "schemes with a single stage");
+    }
+    const specfem::boundaries::pml_layer layer(mesh.material_ind.region_CPML,
+                                               &compute, mpi);
+    domains->set_pml(mesh.material_ind.region_CPML, layer,
+                     setup.get_pml_frequency(), setup.get_pml_reflection(),
+                     setup.get_dt());
+    if (coupled) {
+      fluid->set_pml(mesh.material_ind.region_CPML, layer,
+                     setup.get_pml_frequency(), setup.get_pml_reflection(),
+                     setup.get_dt());
+    }
+    std::ostringstream message;
+    message << "PML layers : "
+            << mpi->reduce(domains->get_pml_nelements(), specfem::MPI::sum)
+            << " elements, thickness " << layer.interior[0] - layer.exterior[0]
+            << " / " << layer.exterior[1] - layer.interior[1] << " along x, "
+            << layer.interior[2] - layer.exterior[2] << " / "
+            << layer.exterior[3] - layer.interior[3] << " along z\n";
+    mpi->cout(message.str());
+  }
+
+  // Hybrid simulations record the wavefield on a contour of the regional
+  // mesh, or inject it through the absorbing edges of a local mesh, once per
+  // stiffness interaction
+  const auto injection_configuration = setup.get_injection_configuration();
+  specfem::boundaries::injection *injection = nullptr;
+  if (injection_configuration) {
+    if (acoustic || coupled || adjoint || reciprocal || restart ||
+        nshots > 1) {
+      throw std::runtime_error(
+          "Wavefield injection is only implemented for forward simulations "
+          "of a single shot of elastic meshes");
+    }
+    if (setup.get_graph_execution() || it->get_nstages() > 1 ||
+        it->get_nlevels() > 1) {
+      throw std::runtime_error(
+          "Wavefield injection is only implemented for single stage time "
+          "schemes without graph execution and local time stepping");
+    }
+
+    auto elastic = static_cast<specfem::Domain::Elastic *>(domains);
+    const int nstep = it->get_max_timestep();
+    std::ostringstream message;
+    if (injection_configuration->get_mode() == specfem::injection::record) {
+      const auto contour = injection_configuration->get_contour();
+      injection = new specfem::boundaries::injection(
+          contour[0], contour[1], contour[2], contour[3], &compute,
+          &partial_derivatives, &material_properties, &gllx, &gllz,
+          setup.get_wave_type(), nstep, injection_configuration->get_chunk(),
+          it->get_time(), setup.get_dt(),
+          injection_configuration->get_folder() + "/proc" +
+              std::to_string(mpi->get_rank()) + "_injection.bin");
+      const int npoints =
+          mpi->all_reduce(injection->get_npoints(), specfem::MPI::sum);
+      if (npoints == 0) {
+        throw std::runtime_error(
+            "Injection contour doesn't cross any elastic element");
+      }
+      message << "Wavefield injection : recording " << npoints
+              << " contour points to "
+              << injection_configuration->get_folder() << "\n";
+    } else {
+      if (!setup.get_absorbing_boundaries()) {
+        throw std::runtime_error(
+            "Injected wavefields need Stacey absorbing boundaries");
+      }
+      injection = new specfem::boundaries::injection(
+          injection_configuration->get_folder(), elastic->get_stacey(),
+          &compute, setup.get_wave_type(), nstep,
+          injection_configuration->get_chunk(), it->get_time(),
+          setup.get_dt());
+      message << "Wavefield injection : injecting "
+              << mpi->reduce(injection->get_npoints(), specfem::MPI::sum)
+              << " absorbing points from "
+              << injection_configuration->get_folder() << "\n";
+    }
+    elastic->set_injection(injection);
+    mpi->cout(message.str());
+  }
+
+  startup.stop();
+
+  // Sample the source time functions at every time step, or at every substep
+  // of the finest level with local time stepping
+  startup.start("Source time functions");
+  const int nsubsteps = 1 << (it->get_nlevels() - 1);
+  compute_sources.tabulate_stf(it->get_time(), setup.get_dt() / nsubsteps,
+                               it->get_max_timestep() * nsubsteps + 2);
+  if (adjoint) {
+    compute_adjoint_sources.tabulate_stf(it->get_time(), setup.get_dt(),
+                                         it->get_max_timestep() + 2);
+  }
+  startup.stop();
+
+  // Kernels are accumulated on the device during the adjoint time loop.
+  // Forward states fitting the checkpoint memory on every process are stored
+  // on the device, compressed states being smaller. Forward fields
+  // reconstructed backward in time only store the absorbing tractions
+  startup.start("Adjoint storage");
+  specfem::adjoint::kernels kernels;
+  specfem::adjoint::boundary_storage *boundaries = nullptr;
+  int ncheckpoints = 0;
+  if (adjoint) {
+    kernels = specfem::adjoint::kernels(&compute, &partial_derivatives,
+                                        &material_properties, &gllx, &gllz,
+                                        setup.get_wave_type());
+  }
+  if (adjoint && adjoint->get_reconstruction()) {
+    const int nstep = it->get_max_timestep();
+    const int npoints = domains->get_absorbing_npoints();
+    boundaries = new specfem::adjoint::boundary_storage(
+        npoints, ncomponents, nstep, adjoint->get_boundary_chunk(),
+        adjoint->get_output_folder() + "/proc" +
+            std::to_string(mpi->get_rank()) + "_absorbing.bin");
+    std::ostringstream message;
+    message << "Adjoint reconstruction : "
+            << mpi->reduce(npoints, specfem::MPI::sum)
+            << " absorbing points, "
+            << mpi->reduce(static_cast<double>(boundaries->get_file_size()),
+                           specfem::MPI::sum) /
+                   static_cast<double>(1 << 20)
+            << " MB of tractions for " << nstep << " timesteps\n";
+    mpi->cout(message.str());
+  } else if (adjoint) {
+    const int nstep = it->get_max_timestep();
+    const int compression_bits = adjoint->get_compression_bits();
+    const double state_size =
+        (compression_bits > 0)
+            ? 3.0 * specfem::adjoint::quantizer::slot_size(
+                        static_cast<std::size_t>(nglob) * ncomponents,
+                        compression_bits)
+            : 3.0 * nglob * ncomponents *
+                  static_cast<double>(sizeof(type_real));
+    const double budget =
+        adjoint->get_checkpoint_memory() * static_cast<double>(1 << 30);
+    ncheckpoints = static_cast<int>(
+        std::min(static_cast<double>(nstep), std::floor(budget / state_size)));
+    ncheckpoints = mpi->all_reduce(ncheckpoints, specfem::MPI::min);
+    if (ncheckpoints < 1) {
+      std::ostringstream message;
+      message << "Checkpoint memory of " << adjoint->get_checkpoint_memory()
+              << " GB can't store a single forward state";
+      throw std::runtime_error(message.str());
+    }
+    std::ostringstream message;
+    message << "Adjoint checkpoints : " << ncheckpoints
+            << " forward states, "
+            << specfem::adjoint::revolve::forward_steps(nstep, ncheckpoints)
+            << " forward steps for " << nstep << " timesteps\n";
+    if (compression_bits > 0) {
+      message << "Compressed checkpoints : " << compression_bits
+              << " bits per value, "
+              << 3.0 * nglob * ncomponents * sizeof(type_real) / state_size
+              << "x smaller\n";
+    }
+    mpi->cout(message.str());
+  }
+  startup.stop();
+
+  startup.start("Writers");
   auto writer =
-      setup.instantiate_seismogram_writer(receivers, &compute_receivers);
+      reciprocal
+          ? setup.instantiate_reciprocal_writer(
+                domains, &compute, sources, receivers, gllx, gllz,
+                it->get_max_seismogram_step(), -1.0 * t0, mpi)
+          : setup.instantiate_seismogram_writer(recorded, &compute_receivers,
+                                                mpi);
+
+  auto wavefield_writer =
+      setup.instantiate_wavefield_writer(domains, &compute, gllx, gllz,
+                                         mesh.coorg, mesh.material_ind.knods,
+                                         mpi);
+
+  auto spectrum_writer = setup.instantiate_spectrum_writer(
+      domains, &compute, recorded, &compute_receivers, mpi);
+
+  auto checkpoint =
+      setup.instantiate_checkpoint(domains, &compute_receivers, writer, mpi);
+
+  // Checkpoints store the fields of a single domain
+  if (coupled && checkpoint) {
+    throw std::runtime_error(
+        "Checkpoints are not implemented for coupled fluid-solid meshes");
+  }
+  if (adjoint && checkpoint) {
+    throw std::runtime_error(
+        "Checkpoints are not implemented for adjoint simulations");
+  }
+  // Misfits are accumulated on the device from the first sample of the
+  // forward seismograms
+  if (setup.get_misfit_configuration() &&
+      (reciprocal || adjoint || checkpoint)) {
+    throw std::runtime_error(
+        "Misfits are not implemented for reciprocal, adjoint and "
+        "checkpointed simulations");
+  }
+
+  // Element arrays are first touched by the threads computing the elements
+  // in the stiffness kernels of every domain on host backends. The adjoint
+  // domain launches the elements of the forward domain
+  specfem::first_touch::launches element_launches =
+      domains->get_element_launches();
+  if (fluid) {
+    const auto fluid_launches = fluid->get_element_launches();
+    element_launches.insert(element_launches.end(), fluid_launches.begin(),
+                            fluid_launches.end());
+  }
+  specfem::first_touch::place(partial_derivatives, element_launches);
+  specfem::first_touch::place(material_properties, element_launches);
 
-  specfem::solver::solver *solver =
-      new specfem::solver::time_marching(domains, it);
+  // Host copies of setup arrays aren't read once the domain and the writers
+  // are set up
+  partial_derivatives.release_host_mirrors();
+  material_properties.release_host_mirrors();
+  compute_sources.release_host_mirrors();
+  if (adjoint)
+    compute_adjoint_sources.release_host_mirrors();
+  compute_receivers.release_host_mirrors();
+  startup.stop();
+  timers.stop(domain_phase);
+
+  std::vector<std::pair<std::string, specfem::memory::usage> > usages = {
+    { "Global numbering", compute.memory_usage() },
+    { "Partial derivatives", partial_derivatives.memory_usage() },
+    { "Material properties", material_properties.memory_usage() },
+    { "Sources", compute_sources.memory_usage() },
+    { "Receivers", compute_receivers.memory_usage() },
+    { "Domain", domains->memory_usage() }
+  };
+  if (coupled) {
+    usages.push_back({ "Acoustic domain", fluid->memory_usage() });
+    usages.push_back({ "Fluid-solid coupling", coupling->memory_usage() });
+  }
+  if (adjoint) {
+    usages.push_back(
+        { "Adjoint sources", compute_adjoint_sources.memory_usage() });
+    usages.push_back({ "Adjoint domain", adjoint_domain->memory_usage() });
+    usages.push_back({ "Kernels", kernels.memory_usage() });
+  }
+  if (boundaries) {
+    usages.push_back({ "Absorbing tractions", boundaries->memory_usage() });
+  }
+  if (injection) {
+    usages.push_back({ "Wavefield injection", injection->memory_usage() });
+  }
+  mpi->cout(specfem::memory::print(usages, mpi));
+  mpi->cout(specfem::memory::print_tracked(mpi));
+
+  // Sizes of the problem let startup reports of different meshes be compared
+  const std::string startup_report = setup.get_startup_report();
+  if (timers.is_enabled() || !startup_report.empty()) {
+    startup.add_size("nspec", nspec_total);
+    startup.add_size("nglob", mpi->all_reduce(nglob, specfem::MPI::sum));
+    startup.add_size("ngll", gllx.get_N());
+    startup.add_size("nsources", sources.size());
+    startup.add_size("nreceivers", receivers.size());
+    mpi->cout(startup.print(mpi));
+    if (!startup_report.empty())
+      startup.write(startup_report, mpi);
+  }
+
+  if (restart) {
+    if (!checkpoint) {
+      throw std::runtime_error(
+          "Restarting a simulation requires a checkpoint section in the "
+          "parameter file");
+    }
+    // Spectra and responses accumulated before the checkpoint aren't stored
+    if (reciprocal) {
+      throw std::runtime_error(
+          "Reciprocal simulations can't be restarted from a checkpoint");
+    }
+    if (spectrum_writer) {
+      throw std::runtime_error(
+          "Spectra can't be computed by a restarted simulation");
+    }
+    // Memory variables aren't stored in checkpoints
+    if (setup.get_attenuation()) {
+      throw std::runtime_error(
+          "Attenuated simulations can't be restarted from a checkpoint");
+    }
+    if (setup.get_pml()) {
+      throw std::runtime_error(
+          "Simulations with PML layers can't be restarted from a checkpoint");
+    }
+    it->set_state(checkpoint->read());
+    std::ostringstream message;
+    message << "Resuming the time loop at step " << it->get_timestep();
+    mpi->cout(message.str());
+  }
+
+  specfem::solver::solver *solver = nullptr;
+  if (boundaries) {
+    solver = new specfem::solver::adjoint_time_marching(
+        static_cast<specfem::Domain::Elastic *>(domains), adjoint_domain,
+        newmark, &kernels, boundaries, setup.get_dt());
+  } else if (adjoint) {
+    solver = new specfem::solver::adjoint_time_marching(
+        static_cast<specfem::Domain::Elastic *>(domains), adjoint_domain,
+        newmark, &kernels, ncheckpoints, setup.get_dt(),
+        adjoint->get_compression_bits());
+  } else if (coupled) {
+    solver = new specfem::solver::coupled_time_marching(
+        fluid, static_cast<specfem::Domain::Elastic *>(domains), coupling, it,
+        writer);
+  } else {
+    solver = specfem::solver::instantiate_time_marching(
+        domains, it, setup.get_graph_execution(), writer, wavefield_writer,
+        checkpoint, spectrum_writer);
+  }
+
+  solver->set_timers(&timers);
+  specfem::progress::reporter progress(mpi, setup.get_progress_interval(),
+                                       nspec_total, setup.get_status_file());
+  solver->set_progress(&progress);
 
   mpi->cout("Executing time loop:");
   mpi->cout("-------------------------------");
 
+  const int time_loop_phase = timers.add("Time loop");
+  timers.start(time_loop_phase);
   solver->run();
+  progress.finish();
+  timers.set_step(-1);
+  timers.stop(time_loop_phase);
 
-  mpi->cout("Writing seismogram files:");
-  mpi->cout("-------------------------------");
+  // The last chunk of a recorded wavefield is partial
+  if (injection)
+    injection->flush();
 
-  writer->write();
+  // Time spent by faster processes waiting for the slowest one
+  const int wait_phase = timers.add("Time loop imbalance");
+  timers.start(wait_phase);
+  mpi->sync_all();
+  timers.stop(wait_phase);
+
+  const int write_phase = timers.add("Writing outputs");
+  timers.start(write_phase);
+
+  // Adjoint simulations don't compute seismograms. The remaining
+  // seismograms of interrupted simulations are written by the restarted
+  // simulation
+  if (adjoint) {
+    mpi->cout("Writing kernels:");
+    mpi->cout("-------------------------------");
+
+    kernels.write(adjoint->get_output_folder(), mpi);
+  } else if (checkpoint && checkpoint->interrupted()) {
+    mpi->cout("Time loop interrupted after writing a checkpoint");
+    checkpoint->wait();
+    writer->wait();
+  } else if (setup.get_misfit_configuration()) {
+    mpi->cout("Writing misfits and adjoint sources:");
+    mpi->cout("-------------------------------");
+
+    writer->write();
+  } else {
+    mpi->cout("Writing seismogram files:");
+    mpi->cout("-------------------------------");
+
+    writer->write();
+  }
+
+  // Snapshots are written in the background during the time loop
+  if (wavefield_writer)
+    wavefield_writer->write();
+
+  // Spectra of interrupted runs are incomplete
+  if (spectrum_writer && !(checkpoint && checkpoint->interrupted())) {
+    mpi->cout("Writing spectra:");
+    mpi->cout("-------------------------------");
+
+    spectrum_writer->write();
+  }
+  timers.stop(write_phase);
+
+  if (timers.is_enabled()) {
+    mpi->cout(timers.print(mpi));
+
+    // Work of every process, fluid elements of coupled meshes are computed
+    // by the fluid domain
+    specfem::load_balance::rank_load load(material_properties.h_ispec_type);
+    load.npml = domains->get_pml_nelements();
+    load.nabsorbing = domains->get_absorbing_npoints();
+    if (fluid)
+      load.nabsorbing += fluid->get_absorbing_npoints();
+    load.nsources = compute_sources.ispec_array.extent(0);
+    load.nreceivers = compute_receivers.ispec_array.extent(0);
+    load.nneighbors = halo.get_nneighbors();
+    load.nhalo = halo.get_host_points().extent(0) * halo.get_ncomponents();
+    mpi->cout(specfem::load_balance::print(load, timers, mpi));
+  }
+
+  // Elements of this process keep the weight they were partitioned with,
+  // scaled by the measured cost of the process
+  if (!element_weights_file.empty()) {
+    std::vector<type_real> local_weights(mesh.serial_ispec.size());
+    for (int ispec = 0; ispec < local_weights.size(); ispec++)
+      local_weights[ispec] = element_weights[mesh.serial_ispec[ispec]];
+    specfem::load_balance::write_element_weights(
+        element_weights_file, mesh.serial_ispec, local_weights,
+        specfem::load_balance::compute_seconds(timers), mpi);
+  }
+  if (!trace_file.empty())
+    trace.write(trace_file, mpi);
 
   mpi->cout("Cleaning up:");
   mpi->cout("-------------------------------");
@@ -202,14 +1165,26 @@ void execute(const std::string parameter_file, specfem::MPI::MPI *mpi) {
     delete source;
   }
 
-  for (auto &receiver : receivers) {
-    delete receiver;
+  for (auto &force : forces) {
+    delete force;
+  }
+
+  for (auto &force : adjoint_forces) {
+    delete force;
   }
 
   delete it;
   delete domains;
+  delete adjoint_domain;
+  delete boundaries;
+  delete injection;
+  delete fluid;
+  delete coupling;
   delete solver;
   delete writer;
+  delete wavefield_writer;
+  delete spectrum_writer;
+  delete checkpoint;
 
   mpi->cout(print_end_message(start_time));
 
@@ -220,14 +1195,24 @@ int main(int argc, char **argv) {
 
   // Initialize MPI
   specfem::MPI::MPI *mpi = new specfem::MPI::MPI(&argc, &argv);
-  // Initialize Kokkos
-  Kokkos::initialize(argc, argv);
+  // Initialize Kokkos on the device and cores assigned to this process
+  const auto binding = specfem::binding::initialize(argc, argv, mpi);
+  mpi->cout(specfem::binding::print(binding, mpi));
+  // Allocations are tallied for the memory report after setup
+  specfem::memory::track_allocations();
   {
     boost::program_options::variables_map vm;
     if (parse_args(argc, argv, vm)) {
       const std::string parameters_file =
           vm["parameters_file"].as<std::string>();
-      execute(parameters_file, mpi);
+      if (vm.count("ensemble")) {
+        const specfem::ensemble::sweep sweep(
+            vm["ensemble"].as<std::string>());
+        specfem::ensemble::run(parameters_file, sweep, mpi);
+      } else {
+        execute(parameters_file, vm.count("restart") > 0,
+                vm.count("verbose") > 0, vm.count("dry-run") > 0, mpi);
+      }
     }
   }
   // Finalize Kokkos
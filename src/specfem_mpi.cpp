@@ -3,6 +3,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <stdlib.h>
+#include <utility>
 #include <vector>
 
 specfem::MPI::MPI::MPI(int *argc, char ***argv) {
@@ -11,9 +12,33 @@ specfem::MPI::MPI::MPI(int *argc, char ***argv) {
   this->comm = MPI_COMM_WORLD;
   MPI_Comm_size(this->comm, &this->world_size);
   MPI_Comm_rank(this->comm, &this->my_rank);
+  MPI_Comm_split_type(this->comm, MPI_COMM_TYPE_SHARED, this->my_rank,
+                      MPI_INFO_NULL, &this->node_comm);
+  MPI_Comm_size(this->node_comm, &this->node_size);
+  MPI_Comm_rank(this->node_comm, &this->node_rank);
 #else
   this->world_size = 1;
   this->my_rank = 0;
+  this->node_size = 1;
+  this->node_rank = 0;
+#endif
+}
+
+specfem::MPI::MPI::MPI(const specfem::MPI::MPI &parent, const int color)
+    : owner(false) {
+#ifdef MPI_PARALLEL
+  MPI_Comm_split(parent.comm, color, parent.my_rank, &this->comm);
+  MPI_Comm_size(this->comm, &this->world_size);
+  MPI_Comm_rank(this->comm, &this->my_rank);
+  MPI_Comm_split_type(this->comm, MPI_COMM_TYPE_SHARED, this->my_rank,
+                      MPI_INFO_NULL, &this->node_comm);
+  MPI_Comm_size(this->node_comm, &this->node_size);
+  MPI_Comm_rank(this->node_comm, &this->node_rank);
+#else
+  this->world_size = 1;
+  this->my_rank = 0;
+  this->node_size = 1;
+  this->node_rank = 0;
 #endif
 }
 
@@ -25,7 +50,11 @@ void specfem::MPI::MPI::sync_all() const {
 
 specfem::MPI::MPI::~MPI() {
 #ifdef MPI_PARALLEL
-  MPI_Finalize();
+  MPI_Comm_free(&this->node_comm);
+  if (this->owner)
+    MPI_Finalize();
+  else
+    MPI_Comm_free(&this->comm);
 #endif
 }
 
@@ -122,6 +151,51 @@ double specfem::MPI::MPI::all_reduce(double lvalue,
 #endif
 }
 
+std::vector<int>
+specfem::MPI::MPI::all_reduce(const std::vector<int> &lvalues,
+                              specfem::MPI::reduce_type reducer) const {
+#ifdef MPI_PARALLEL
+  std::vector<int> svalues(lvalues.size());
+
+  MPI_Allreduce(lvalues.data(), svalues.data(), lvalues.size(), MPI_INT,
+                reducer, this->comm);
+
+  return svalues;
+#else
+  return lvalues;
+#endif
+}
+
+std::vector<float>
+specfem::MPI::MPI::all_reduce(const std::vector<float> &lvalues,
+                              specfem::MPI::reduce_type reducer) const {
+#ifdef MPI_PARALLEL
+  std::vector<float> svalues(lvalues.size());
+
+  MPI_Allreduce(lvalues.data(), svalues.data(), lvalues.size(), MPI_FLOAT,
+                reducer, this->comm);
+
+  return svalues;
+#else
+  return lvalues;
+#endif
+}
+
+std::vector<double>
+specfem::MPI::MPI::all_reduce(const std::vector<double> &lvalues,
+                              specfem::MPI::reduce_type reducer) const {
+#ifdef MPI_PARALLEL
+  std::vector<double> svalues(lvalues.size());
+
+  MPI_Allreduce(lvalues.data(), svalues.data(), lvalues.size(), MPI_DOUBLE,
+                reducer, this->comm);
+
+  return svalues;
+#else
+  return lvalues;
+#endif
+}
+
 std::vector<int> specfem::MPI::MPI::gather(int lelement) const {
 
   std::vector<int> gelement(this->world_size, 0);
@@ -250,3 +324,77 @@ void specfem::MPI::MPI::bcast(double &val, int root) const {
   MPI_Bcast(&val, 1, MPI_DOUBLE, root, this->comm);
 #endif
 }
+
+specfem::MPI::request::request(specfem::MPI::request &&other)
+    : complete(std::move(other.complete)) {
+  other.complete = nullptr;
+#ifdef MPI_PARALLEL
+  this->handle = other.handle;
+  other.handle = MPI_REQUEST_NULL;
+#endif
+}
+
+specfem::MPI::request &
+specfem::MPI::request::operator=(specfem::MPI::request &&other) {
+  if (this != &other) {
+    this->wait();
+    this->complete = std::move(other.complete);
+    other.complete = nullptr;
+#ifdef MPI_PARALLEL
+    this->handle = other.handle;
+    other.handle = MPI_REQUEST_NULL;
+#endif
+  }
+  return *this;
+}
+
+void specfem::MPI::request::wait() {
+#ifdef MPI_PARALLEL
+  if (this->handle != MPI_REQUEST_NULL)
+    MPI_Wait(&this->handle, MPI_STATUS_IGNORE);
+#endif
+  if (this->complete) {
+    this->complete();
+    this->complete = nullptr;
+  }
+}
+
+specfem::MPI::shared_window::shared_window(const std::size_t bytes,
+                                           const specfem::MPI::MPI *mpi) {
+#ifdef MPI_PARALLEL
+  this->node_comm = mpi->get_node_comm();
+  this->is_owner = (mpi->get_node_rank() == 0);
+
+  // Only the owner allocates memory, every process maps the memory of the
+  // owner
+  void *local;
+  const MPI_Aint size = this->is_owner ? bytes : 0;
+  MPI_Win_allocate_shared(size, 1, MPI_INFO_NULL, this->node_comm, &local,
+                          &this->window);
+
+  MPI_Aint owner_size;
+  int disp_unit;
+  MPI_Win_shared_query(this->window, 0, &owner_size, &disp_unit, &this->base);
+
+  // Passive target epoch used by sync for the lifetime of the window
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, this->window);
+#else
+  this->storage.resize(bytes);
+  this->base = this->storage.data();
+#endif
+}
+
+void specfem::MPI::shared_window::sync() const {
+#ifdef MPI_PARALLEL
+  MPI_Win_sync(this->window);
+  MPI_Barrier(this->node_comm);
+  MPI_Win_sync(this->window);
+#endif
+}
+
+specfem::MPI::shared_window::~shared_window() {
+#ifdef MPI_PARALLEL
+  MPI_Win_unlock_all(this->window);
+  MPI_Win_free(&this->window);
+#endif
+}
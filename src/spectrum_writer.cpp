@@ -0,0 +1,234 @@
+#include "../include/spectrum_writer.h"
+#include "../include/compute.h"
+#include "../include/constants.h"
+#include "../include/domain.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/receiver.h"
+#include "../include/specfem_mpi.h"
+#include "../include/wavefield_writer.h"
+#include <Kokkos_Complex.hpp>
+#include <Kokkos_Core.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+specfem::writer::spectrum::spectrum(
+    specfem::Domain::Domain *domain, const specfem::compute::compute *compute,
+    const specfem::receivers::receiver_set &receivers,
+    const specfem::compute::receivers *compute_receivers,
+    const std::vector<specfem::seismogram::type> &fields,
+    const std::vector<type_real> &frequencies,
+    const int nstep_between_samples, const int stride, const type_real dt,
+    const type_real t0, const type_real sample_dt,
+    const std::string output_folder, const specfem::MPI::MPI *mpi)
+    : domain(domain), compute_receivers(compute_receivers), fields(fields),
+      nstep_between_samples(nstep_between_samples), dt(dt), t0(t0),
+      sample_dt(sample_dt), output_folder(output_folder),
+      rank(mpi->get_rank()) {
+
+  if (nstep_between_samples < 1 || stride < 1 || frequencies.empty()) {
+    std::ostringstream message;
+    message << "Spectra need at least one frequency, a positive number of "
+            << "steps between samples and a positive stride";
+    throw std::runtime_error(message.str());
+  }
+
+  const int nfreq = frequencies.size();
+  this->omega = specfem::kokkos::DeviceView1d<double>(
+      "specfem::writer::spectrum::omega", nfreq);
+  auto h_omega = Kokkos::create_mirror_view(this->omega);
+  for (int ifreq = 0; ifreq < nfreq; ifreq++)
+    h_omega(ifreq) = 2.0 * pi * frequencies[ifreq];
+  Kokkos::deep_copy(this->omega, h_omega);
+
+  this->phase = specfem::kokkos::DeviceView1d<Kokkos::complex<type_real> >(
+      "specfem::writer::spectrum::phase", nfreq);
+
+  const auto coord = compute->coordinates.coord;
+  const auto h_points =
+      specfem::writer::select_points(compute->h_ibool, coord.extent(1),
+                                     stride);
+  const int npoints = this->fields.empty() ? 0 : h_points.size();
+  const int ncomponents = domain->get_field().extent(1);
+
+  this->points = specfem::kokkos::DeviceView1d<int>(
+      "specfem::writer::spectrum::points", npoints);
+  auto mirror = Kokkos::create_mirror_view(this->points);
+  specfem::kokkos::HostView2d<type_real> point_coord(
+      "specfem::writer::spectrum::coord", npoints, ndim);
+  for (int ipoint = 0; ipoint < npoints; ipoint++) {
+    mirror(ipoint) = h_points[ipoint];
+    for (int idim = 0; idim < ndim; idim++)
+      point_coord(ipoint, idim) = coord(idim, h_points[ipoint]);
+  }
+  Kokkos::deep_copy(this->points, mirror);
+
+  this->field_spectra =
+      specfem::kokkos::DeviceView4d<Kokkos::complex<type_real> >(
+          "specfem::writer::spectrum::field_spectra", this->fields.size(),
+          nfreq, npoints, ncomponents);
+
+  // Receivers of this process are stored in the order of the stations
+  int nsig_types = 0;
+  if (compute_receivers) {
+    for (int irec = 0; irec < receivers.size(); irec++) {
+      if (receivers.islice[irec] == this->rank)
+        this->stations.push_back(irec);
+    }
+    nsig_types = compute_receivers->h_seismogram_types.extent(0);
+  }
+
+  this->receiver_spectra =
+      specfem::kokkos::DeviceView4d<Kokkos::complex<type_real> >(
+          "specfem::writer::spectrum::receiver_spectra", nsig_types, nfreq,
+          this->stations.size(), 2);
+
+  std::filesystem::create_directories(output_folder);
+  if (npoints > 0) {
+    specfem::writer::write_binary(output_folder + "/spectrum_points_" +
+                                      std::to_string(this->rank) + ".bin",
+                                  point_coord, { npoints });
+  }
+}
+
+void specfem::writer::spectrum::compute_phase(
+    const double t, const type_real weight,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const auto omega = this->omega;
+  const auto phase = this->phase;
+  const int nfreq = omega.extent(0);
+
+  // Phases are computed in double precision since omega * t grows with the
+  // length of the run
+  Kokkos::parallel_for(
+      "specfem::writer::spectrum::compute_phase",
+      Kokkos::RangePolicy<specfem::kokkos::DevExecSpace>(exec_space, 0,
+                                                         nfreq),
+      KOKKOS_LAMBDA(const int ifreq) {
+        const double arg = omega(ifreq) * t;
+        phase(ifreq) = Kokkos::complex<type_real>(weight * Kokkos::cos(arg),
+                                                  -weight * Kokkos::sin(arg));
+      });
+}
+
+void specfem::writer::spectrum::transform(
+    const int istep, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const auto points = this->points;
+  const auto phase = this->phase;
+  const auto field_spectra = this->field_spectra;
+  const int npoints = points.extent(0);
+  const int nfreq = phase.extent(0);
+  const int ncomponents = field_spectra.extent(3);
+
+  if (npoints == 0)
+    return;
+
+  this->compute_phase(static_cast<double>(this->t0) +
+                          static_cast<double>(istep) * this->dt,
+                      this->nstep_between_samples * this->dt, exec_space);
+
+  for (int ifield = 0; ifield < this->fields.size(); ifield++) {
+    specfem::kokkos::DeviceFieldView2d<type_real> field;
+    switch (this->fields[ifield]) {
+    case specfem::seismogram::displacement:
+      field = this->domain->get_field();
+      break;
+    case specfem::seismogram::velocity:
+      field = this->domain->get_field_dot();
+      break;
+    case specfem::seismogram::acceleration:
+      field = this->domain->get_field_dot_dot();
+      break;
+    default:
+      throw std::runtime_error("Spectrum type has not been implemented yet");
+    }
+
+    Kokkos::parallel_for(
+        "specfem::writer::spectrum::transform",
+        Kokkos::RangePolicy<specfem::kokkos::DevExecSpace>(exec_space, 0,
+                                                           npoints),
+        KOKKOS_LAMBDA(const int ipoint) {
+          const int iglob = points(ipoint);
+          for (int icomp = 0; icomp < ncomponents; icomp++) {
+            const type_real value = field(iglob, icomp);
+            for (int ifreq = 0; ifreq < nfreq; ifreq++)
+              field_spectra(ifield, ifreq, ipoint, icomp) +=
+                  value * phase(ifreq);
+          }
+        });
+  }
+}
+
+void specfem::writer::spectrum::sample(
+    const int isig_step, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  if (this->stations.empty() || this->receiver_spectra.extent(0) == 0)
+    return;
+
+  // Decimated seismograms aren't written at every recorded sample
+  const int isample = this->compute_receivers->written_sample(isig_step);
+  if (isample < 0)
+    return;
+
+  const auto seismogram = this->compute_receivers->seismogram;
+  const auto phase = this->phase;
+  const auto receiver_spectra = this->receiver_spectra;
+  const int islot = isample % seismogram.extent(0);
+  const int nsig_types = receiver_spectra.extent(0);
+  const int nfreq = receiver_spectra.extent(1);
+  const int nreceivers = receiver_spectra.extent(2);
+
+  this->compute_phase(static_cast<double>(this->t0) +
+                          static_cast<double>(isample) * this->sample_dt,
+                      this->sample_dt, exec_space);
+
+  Kokkos::parallel_for(
+      "specfem::writer::spectrum::sample",
+      Kokkos::RangePolicy<specfem::kokkos::DevExecSpace>(exec_space, 0,
+                                                         nreceivers),
+      KOKKOS_LAMBDA(const int irec) {
+        for (int isig = 0; isig < nsig_types; isig++) {
+          for (int icomp = 0; icomp < 2; icomp++) {
+            const type_real value = seismogram(islot, isig, irec, icomp);
+            for (int ifreq = 0; ifreq < nfreq; ifreq++)
+              receiver_spectra(isig, ifreq, irec, icomp) +=
+                  value * phase(ifreq);
+          }
+        }
+      });
+}
+
+void specfem::writer::spectrum::write() {
+
+  const std::string suffix = "_" + std::to_string(this->rank) + ".bin";
+
+  if (this->points.extent(0) > 0) {
+    const auto h_field_spectra = Kokkos::create_mirror_view_and_copy(
+        Kokkos::HostSpace(), this->field_spectra);
+    specfem::writer::write_binary(
+        this->output_folder + "/spectrum" + suffix, h_field_spectra,
+        { static_cast<std::int32_t>(h_field_spectra.extent(0)),
+          static_cast<std::int32_t>(h_field_spectra.extent(1)),
+          static_cast<std::int32_t>(h_field_spectra.extent(2)),
+          static_cast<std::int32_t>(h_field_spectra.extent(3)) });
+  }
+
+  if (this->receiver_spectra.extent(0) > 0) {
+    const auto h_receiver_spectra = Kokkos::create_mirror_view_and_copy(
+        Kokkos::HostSpace(), this->receiver_spectra);
+    std::vector<std::int32_t> header = {
+      static_cast<std::int32_t>(h_receiver_spectra.extent(0)),
+      static_cast<std::int32_t>(h_receiver_spectra.extent(1)),
+      static_cast<std::int32_t>(h_receiver_spectra.extent(2))
+    };
+    header.insert(header.end(), this->stations.begin(), this->stations.end());
+    specfem::writer::write_binary(this->output_folder +
+                                      "/spectrum_receivers" + suffix,
+                                  h_receiver_spectra, header);
+  }
+}
@@ -0,0 +1,257 @@
+#include "../include/stacey.h"
+#include "../include/boundaries.h"
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/enums.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/quadrature.h"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+specfem::boundaries::stacey::stacey(
+    const specfem::boundaries::absorbing_boundary &abs_boundary,
+    const specfem::compute::compute *compute,
+    const specfem::compute::properties *properties,
+    const specfem::quadrature::quadrature *quadx,
+    const specfem::quadrature::quadrature *quadz,
+    const specfem::elements::type medium, const specfem::wave::type wave,
+    const int nshots, const specfem::kokkos::HostMirror1d<int> global_index)
+    : nshots(nshots) {
+
+  const bool acoustic = (medium == specfem::elements::acoustic);
+  const bool p_sv = !acoustic && (wave == specfem::wave::p_sv);
+  this->ncomponents = p_sv ? 2 : 1;
+
+  const auto h_ibool = compute->h_ibool;
+  const auto coord = compute->coordinates.coord;
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  const int nglob = coord.extent(1);
+  const auto wxgll = quadx->get_hw();
+  const auto wzgll = quadz->get_hw();
+  const auto hprime_xx = quadx->get_hhprime();
+  const auto hprime_zz = quadz->get_hhprime();
+  const auto ispec_type = properties->h_ispec_type;
+  const auto rho_vp = properties->rho_vp;
+  const auto rho_vs = properties->rho_vs;
+
+  // Point number of every global point, -1 outside the domain
+  std::vector<int> point_number(nglob, -1);
+  if (global_index.extent(0) > 0) {
+    for (int ipoint = 0; ipoint < global_index.extent(0); ipoint++)
+      point_number[global_index(ipoint)] = ipoint;
+  } else {
+    for (int iglob = 0; iglob < nglob; iglob++)
+      point_number[iglob] = iglob;
+  }
+
+  std::vector<int> points;
+  std::vector<type_real> normals;
+  std::vector<type_real> impedances;
+  std::vector<type_real> weights;
+
+  // The database allocates a single entry when there are no absorbing edges
+  const int nelements =
+      (abs_boundary.codeabs.extent(1) == 4) ? abs_boundary.numabs.extent(0) : 0;
+
+  for (int inum = 0; inum < nelements; inum++) {
+    const int ispec = abs_boundary.numabs(inum);
+    if (ispec_type(ispec) != medium)
+      continue;
+
+    // Sides are numbered bottom, right, top and left. Only one side is
+    // absorbing for every entry
+    int iside = 0;
+    while (iside < 3 && !abs_boundary.codeabs(inum, iside))
+      iside++;
+
+    const bool along_xi = (iside % 2 == 0);
+    const int ngll = along_xi ? ngllx : ngllz;
+    const auto point = [&](const int i, int &iz, int &ix) {
+      iz = (iside == 0) ? 0 : (iside == 2) ? ngllz - 1 : i;
+      ix = (iside == 3) ? 0 : (iside == 1) ? ngllx - 1 : i;
+    };
+
+    // Edge limits are 1-based. Full edges are used if they aren't set
+    const int ibegin[4] = { abs_boundary.ibegin_edge1(inum),
+                            abs_boundary.ibegin_edge2(inum),
+                            abs_boundary.ibegin_edge3(inum),
+                            abs_boundary.ibegin_edge4(inum) };
+    const int iend[4] = { abs_boundary.iend_edge1(inum),
+                          abs_boundary.iend_edge2(inum),
+                          abs_boundary.iend_edge3(inum),
+                          abs_boundary.iend_edge4(inum) };
+    int istart = ibegin[iside] - 1;
+    int istop = iend[iside];
+    if (istart < 0 || istop > ngll || istart >= istop) {
+      istart = 0;
+      istop = ngll;
+    }
+
+    for (int i = istart; i < istop; i++) {
+      // Tangent along the side, oriented with xi or gamma
+      type_real dx = 0.0;
+      type_real dz = 0.0;
+      for (int l = 0; l < ngll; l++) {
+        int iz, ix;
+        point(l, iz, ix);
+        const int iglob = h_ibool(ispec, iz, ix);
+        const type_real hprime = along_xi ? hprime_xx(i, l) : hprime_zz(i, l);
+        dx += hprime * coord(0, iglob);
+        dz += hprime * coord(1, iglob);
+      }
+
+      // The outward normal is the tangent rotated clockwise on bottom and
+      // right sides, and counterclockwise on top and left sides
+      const type_real jacobian1d = std::sqrt(dx * dx + dz * dz);
+      const type_real sign = (iside < 2) ? 1.0 : -1.0;
+      const type_real weight =
+          (along_xi ? wxgll(i) : wzgll(i)) * jacobian1d;
+
+      int iz, ix;
+      point(i, iz, ix);
+      const int iglob = h_ibool(ispec, iz, ix);
+      if (point_number[iglob] < 0) {
+        throw std::runtime_error(
+            "Absorbing boundary point isn't part of the domain");
+      }
+      points.push_back(point_number[iglob]);
+      normals.push_back(sign * dz / jacobian1d);
+      normals.push_back(-1.0 * sign * dx / jacobian1d);
+      weights.push_back(weight);
+
+      const type_real rho_vpl = rho_vp(ispec, iz, ix);
+      const type_real rho_vsl = rho_vs(ispec, iz, ix);
+      if (acoustic) {
+        impedances.push_back(weight / rho_vpl);
+        impedances.push_back(0.0);
+      } else if (p_sv) {
+        impedances.push_back(weight * rho_vpl);
+        impedances.push_back(weight * rho_vsl);
+      } else {
+        impedances.push_back(weight * rho_vsl);
+        impedances.push_back(0.0);
+      }
+    }
+  }
+
+  this->npoints = points.size();
+  if (this->npoints == 0)
+    return;
+
+  this->index = specfem::kokkos::DeviceView1d<int>(
+      "specfem::boundaries::stacey::index", this->npoints);
+  this->normal = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::boundaries::stacey::normal", this->npoints, 2);
+  this->impedance = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::boundaries::stacey::impedance", this->npoints, 2);
+  this->weight = specfem::kokkos::DeviceView1d<type_real>(
+      "specfem::boundaries::stacey::weight", this->npoints);
+
+  const auto h_index = Kokkos::create_mirror_view(this->index);
+  const auto h_normal = Kokkos::create_mirror_view(this->normal);
+  const auto h_impedance = Kokkos::create_mirror_view(this->impedance);
+  const auto h_weight = Kokkos::create_mirror_view(this->weight);
+  for (int ipoint = 0; ipoint < this->npoints; ipoint++) {
+    h_index(ipoint) = points[ipoint];
+    h_weight(ipoint) = weights[ipoint];
+    for (int i = 0; i < 2; i++) {
+      h_normal(ipoint, i) = normals[2 * ipoint + i];
+      h_impedance(ipoint, i) = impedances[2 * ipoint + i];
+    }
+  }
+
+  Kokkos::deep_copy(this->index, h_index);
+  Kokkos::deep_copy(this->normal, h_normal);
+  Kokkos::deep_copy(this->impedance, h_impedance);
+  Kokkos::deep_copy(this->weight, h_weight);
+
+  return;
+}
+
+void specfem::boundaries::stacey::compute_interaction(
+    const specfem::kokkos::DeviceFieldView2d<type_real> velocity,
+    const specfem::kokkos::DeviceFieldView2d<type_real> acceleration,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) const {
+
+  if (this->npoints == 0)
+    return;
+
+  const auto index = this->index;
+  const auto normal = this->normal;
+  const auto impedance = this->impedance;
+  const int ncomponents = this->ncomponents;
+  const int nshots = this->nshots;
+  const auto traction = this->traction;
+  const bool record = (this->mode == specfem::absorbing::record);
+
+  if (this->mode == specfem::absorbing::replay) {
+    specfem::kokkos::parallel_for(
+        "specfem::boundaries::stacey::replay_interaction",
+        specfem::kokkos::DeviceRange(exec_space, 0, this->npoints),
+        KOKKOS_LAMBDA(const int ipoint) {
+          const int iglob = index(ipoint);
+          for (int icomponent = 0; icomponent < ncomponents * nshots;
+               icomponent++) {
+            Kokkos::atomic_add(&acceleration(iglob, icomponent),
+                               -1.0 * traction(ipoint, icomponent));
+          }
+        },
+        node);
+    return;
+  }
+
+  // Points shared by two edges are damped by both edges
+  specfem::kokkos::parallel_for(
+      "specfem::boundaries::stacey::compute_interaction",
+      specfem::kokkos::DeviceRange(exec_space, 0, this->npoints),
+      KOKKOS_LAMBDA(const int ipoint) {
+        const int iglob = index(ipoint);
+        const type_real impedance0 = impedance(ipoint, 0);
+        if (ncomponents == 1) {
+          for (int ishot = 0; ishot < nshots; ishot++) {
+            const type_real t = impedance0 * velocity(iglob, ishot);
+            if (record)
+              traction(ipoint, ishot) = t;
+            Kokkos::atomic_add(&acceleration(iglob, ishot), -1.0 * t);
+          }
+          return;
+        }
+
+        const type_real nx = normal(ipoint, 0);
+        const type_real nz = normal(ipoint, 1);
+        const type_real impedance1 = impedance(ipoint, 1);
+        for (int ishot = 0; ishot < nshots; ishot++) {
+          const int icomponent = 2 * ishot;
+          const type_real vx = velocity(iglob, icomponent);
+          const type_real vz = velocity(iglob, icomponent + 1);
+          const type_real vn = nx * vx + nz * vz;
+          const type_real tx =
+              impedance0 * vn * nx + impedance1 * (vx - vn * nx);
+          const type_real tz =
+              impedance0 * vn * nz + impedance1 * (vz - vn * nz);
+          if (record) {
+            traction(ipoint, icomponent) = tx;
+            traction(ipoint, icomponent + 1) = tz;
+          }
+          Kokkos::atomic_add(&acceleration(iglob, icomponent), -1.0 * tx);
+          Kokkos::atomic_add(&acceleration(iglob, icomponent + 1), -1.0 * tz);
+        }
+      },
+      node);
+
+  return;
+}
+
+specfem::memory::usage specfem::boundaries::stacey::memory_usage() const {
+  specfem::memory::usage usage;
+  usage.add(this->index);
+  usage.add(this->normal);
+  usage.add(this->impedance);
+  usage.add(this->weight);
+
+  return usage;
+}
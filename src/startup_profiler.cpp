@@ -0,0 +1,156 @@
+#include "../include/startup_profiler.h"
+#include "../include/memory_report.h"
+#include "../include/specfem_mpi.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Size of an allocation in megabytes
+static double megabytes(const double bytes) {
+  return bytes / (1024.0 * 1024.0);
+}
+
+void specfem::startup::profiler::start(const std::string &name) {
+  if (!this->enabled)
+    return;
+  if (this->running >= 0)
+    throw std::runtime_error("Startup stage " + name + " started while " +
+                             this->stages[this->running].name + " runs");
+
+  this->running = this->stages.size();
+  for (int istage = 0; istage < this->stages.size(); istage++) {
+    if (this->stages[istage].name == name)
+      this->running = istage;
+  }
+  if (this->running == this->stages.size())
+    this->stages.push_back({ name });
+
+  this->allocated = specfem::memory::tracked_allocated();
+  this->begin = std::chrono::steady_clock::now();
+}
+
+void specfem::startup::profiler::stop() {
+  if (!this->enabled || this->running < 0)
+    return;
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - this->begin;
+  const auto allocated = specfem::memory::tracked_allocated();
+  auto &stage = this->stages[this->running];
+  stage.seconds += elapsed.count();
+  stage.allocated.device += allocated.device - this->allocated.device;
+  stage.allocated.host += allocated.host - this->allocated.host;
+  this->running = -1;
+}
+
+void specfem::startup::profiler::add_read(const std::string &filename) {
+  if (!this->enabled || this->running < 0)
+    return;
+  std::error_code error;
+  const auto size = std::filesystem::file_size(filename, error);
+  if (!error)
+    this->stages[this->running].bytes_read += static_cast<double>(size);
+}
+
+void specfem::startup::profiler::add_size(const std::string &name,
+                                          const double value) {
+  if (!this->enabled)
+    return;
+  this->sizes.push_back({ name, value });
+}
+
+std::vector<double>
+specfem::startup::profiler::reduce(const specfem::MPI::MPI *mpi) const {
+  const int nstages = this->stages.size();
+  std::vector<double> seconds(nstages), bytes_read(nstages);
+  std::vector<double> device(nstages), host(nstages);
+  for (int istage = 0; istage < nstages; istage++) {
+    seconds[istage] = this->stages[istage].seconds;
+    bytes_read[istage] = this->stages[istage].bytes_read;
+    device[istage] = this->stages[istage].allocated.device;
+    host[istage] = this->stages[istage].allocated.host;
+  }
+
+  const auto total = mpi->all_reduce(seconds, specfem::MPI::sum);
+  const auto largest = mpi->all_reduce(seconds, specfem::MPI::max);
+  const auto total_read = mpi->all_reduce(bytes_read, specfem::MPI::sum);
+  const auto largest_device = mpi->all_reduce(device, specfem::MPI::max);
+  const auto largest_host = mpi->all_reduce(host, specfem::MPI::max);
+
+  std::vector<double> reduced;
+  for (int istage = 0; istage < nstages; istage++) {
+    reduced.push_back(total[istage] / mpi->get_size());
+    reduced.push_back(largest[istage]);
+    reduced.push_back(total_read[istage]);
+    reduced.push_back(largest_device[istage]);
+    reduced.push_back(largest_host[istage]);
+  }
+  return reduced;
+}
+
+std::string
+specfem::startup::profiler::print(const specfem::MPI::MPI *mpi) const {
+
+  if (!this->enabled)
+    return "";
+
+  const auto reduced = this->reduce(mpi);
+
+  double total = 0.0;
+  std::ostringstream message;
+  message << "Startup report (" << mpi->get_size()
+          << " processes, s, MB):\n"
+          << "------------------------------\n"
+          << std::fixed << std::setprecision(3);
+  for (int istage = 0; istage < this->stages.size(); istage++) {
+    const double *values = &reduced[5 * istage];
+    total += values[1];
+    message << "- " << this->stages[istage].name << " : time = " << values[1]
+            << ", read = " << std::setprecision(1) << megabytes(values[2])
+            << ", device allocated = " << megabytes(values[3])
+            << ", host allocated = " << megabytes(values[4])
+            << std::setprecision(3) << "\n";
+  }
+  message << "- Total : time = " << total << "\n";
+
+  return message.str();
+}
+
+void specfem::startup::profiler::write(const std::string &filename,
+                                       const specfem::MPI::MPI *mpi) const {
+
+  if (!this->enabled)
+    return;
+
+  const auto reduced = this->reduce(mpi);
+  if (!mpi->main_proc())
+    return;
+
+  std::ofstream file(filename);
+  if (!file.is_open())
+    throw std::runtime_error("Could not open startup report " + filename);
+
+  file << std::setprecision(9) << "{\n"
+       << "  \"processes\": " << mpi->get_size() << ",\n"
+       << "  \"sizes\": {";
+  for (int isize = 0; isize < this->sizes.size(); isize++) {
+    file << (isize ? ", " : "") << "\"" << this->sizes[isize].first
+         << "\": " << this->sizes[isize].second;
+  }
+  file << "},\n"
+       << "  \"stages\": [";
+  for (int istage = 0; istage < this->stages.size(); istage++) {
+    const double *values = &reduced[5 * istage];
+    file << (istage ? "," : "") << "\n    {\"name\": \""
+         << this->stages[istage].name << "\", \"mean_seconds\": " << values[0]
+         << ", \"max_seconds\": " << values[1]
+         << ", \"bytes_read\": " << values[2]
+         << ", \"device_bytes_allocated\": " << values[3]
+         << ", \"host_bytes_allocated\": " << values[4] << "}";
+  }
+  file << "\n  ]\n}\n";
+}
@@ -28,7 +28,7 @@ specfem::surfaces::acoustic_free_surface::acoustic_free_surface(
 }
 
 specfem::surfaces::acoustic_free_surface::acoustic_free_surface(
-    std::ifstream &stream, const int nelem_acoustic_surface,
+    std::istream &stream, const int nelem_acoustic_surface,
     const specfem::MPI::MPI *mpi) {
 
   std::vector<int> acfree_edge(4, 0);
@@ -47,3 +47,13 @@ specfem::surfaces::acoustic_free_surface::acoustic_free_surface(
   mpi->sync_all();
   return;
 }
+
+specfem::surfaces::fluid_solid_edges::fluid_solid_edges(const int nedges) {
+  if (nedges > 0) {
+    this->ispec_acoustic = specfem::kokkos::HostView1d<int>(
+        "specfem::mesh::fluid_solid_edges::ispec_acoustic", nedges);
+    this->ispec_elastic = specfem::kokkos::HostView1d<int>(
+        "specfem::mesh::fluid_solid_edges::ispec_elastic", nedges);
+  }
+  return;
+}
@@ -0,0 +1,143 @@
+#include "../include/timers.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/specfem_mpi.h"
+#include "../include/trace.h"
+#include <Kokkos_Core.hpp>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+specfem::timers::timers::timers(const bool enabled, const bool accurate)
+    : enabled(enabled), accurate(accurate) {
+  // Indices of the time loop phases are the values of specfem::timers::phase
+  for (const auto &name :
+       { "Predictor", "Stiffness", "Sources", "Interface exchange",
+         "Mass division and corrector", "Seismograms", "Output" })
+    this->add(name);
+}
+
+int specfem::timers::timers::add(const std::string &name) {
+  for (int iphase = 0; iphase < this->phases.size(); iphase++) {
+    if (this->phases[iphase].name == name)
+      return iphase;
+  }
+  this->phases.push_back({ name });
+  return this->phases.size() - 1;
+}
+
+void specfem::timers::timers::start(const int iphase) {
+  if (!this->enabled)
+    return;
+  if (this->accurate)
+    Kokkos::fence();
+  Kokkos::Profiling::pushRegion(this->phases[iphase].name);
+  this->phases[iphase].begin = std::chrono::steady_clock::now();
+}
+
+void specfem::timers::timers::start(
+    const int iphase, const specfem::kokkos::DevExecSpace &exec_space) {
+  if (!this->enabled)
+    return;
+  if (this->accurate)
+    exec_space.fence();
+  Kokkos::Profiling::pushRegion(this->phases[iphase].name);
+  this->phases[iphase].begin = std::chrono::steady_clock::now();
+}
+
+void specfem::timers::timers::stop(const int iphase) {
+  if (!this->enabled)
+    return;
+  if (this->accurate)
+    Kokkos::fence();
+  auto &phase = this->phases[iphase];
+  const auto end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> elapsed = end - phase.begin;
+  phase.seconds += elapsed.count();
+  phase.calls++;
+  this->trace->record(phase.name, specfem::trace::phases, phase.begin, end);
+  Kokkos::Profiling::popRegion();
+}
+
+void specfem::timers::timers::stop(
+    const int iphase, const specfem::kokkos::DevExecSpace &exec_space) {
+  if (!this->enabled)
+    return;
+  if (this->accurate)
+    exec_space.fence();
+  auto &phase = this->phases[iphase];
+  const auto end = std::chrono::steady_clock::now();
+  const std::chrono::duration<double> elapsed = end - phase.begin;
+  phase.seconds += elapsed.count();
+  phase.calls++;
+  this->trace->record(phase.name, specfem::trace::phases, phase.begin, end);
+  Kokkos::Profiling::popRegion();
+}
+
+std::string
+specfem::timers::timers::print(const specfem::MPI::MPI *mpi) const {
+
+  if (!this->enabled)
+    return "";
+
+  // Achieved rates of every process, averaged across processes
+  const int nphases = this->phases.size();
+  std::vector<double> seconds(nphases);
+  std::vector<double> rates(2 * nphases, 0.0);
+  std::vector<int> calls(nphases);
+  for (int iphase = 0; iphase < nphases; iphase++) {
+    const auto &phase = this->phases[iphase];
+    seconds[iphase] = phase.seconds;
+    calls[iphase] = phase.calls;
+    if (phase.seconds > 0.0) {
+      rates[2 * iphase] = 1e-9 * phase.work.bytes / phase.seconds;
+      rates[2 * iphase + 1] = 1e-9 * phase.work.flops / phase.seconds;
+    }
+  }
+
+  const auto total = mpi->all_reduce(seconds, specfem::MPI::sum);
+  const auto smallest = mpi->all_reduce(seconds, specfem::MPI::min);
+  const auto largest = mpi->all_reduce(seconds, specfem::MPI::max);
+  const auto max_calls = mpi->all_reduce(calls, specfem::MPI::max);
+  const auto total_rates = mpi->all_reduce(rates, specfem::MPI::sum);
+  const int nproc = mpi->get_size();
+
+  // Rate and fraction of the peak
+  const auto print_rate = [](std::ostream &out, const double rate,
+                             const double peak, const char *unit) {
+    out << ", " << rate << " " << unit;
+    if (peak > 0.0)
+      out << " (" << std::setprecision(1) << 100.0 * rate / peak
+          << " % of peak)" << std::setprecision(3);
+  };
+
+  std::ostringstream message;
+  message << "Performance summary (" << nproc << " processes, s"
+          << (this->accurate ? ", fenced" : "") << "):\n"
+          << "------------------------------\n"
+          << std::fixed << std::setprecision(3);
+  for (int iphase = 0; iphase < nphases; iphase++) {
+    if (max_calls[iphase] == 0)
+      continue;
+    message << "- " << this->phases[iphase].name
+            << " : mean = " << total[iphase] / nproc
+            << ", min = " << smallest[iphase]
+            << ", max = " << largest[iphase]
+            << ", calls = " << max_calls[iphase];
+    if (total_rates[2 * iphase] > 0.0)
+      print_rate(message, total_rates[2 * iphase] / nproc,
+                 this->peak_bandwidth, "GB/s");
+    if (total_rates[2 * iphase + 1] > 0.0)
+      print_rate(message, total_rates[2 * iphase + 1] / nproc,
+                 this->peak_flops, "GFLOP/s");
+    message << "\n";
+  }
+
+  return message.str();
+}
+
+specfem::timers::timers *specfem::timers::disabled() {
+  static specfem::timers::timers instance(false);
+  return &instance;
+}
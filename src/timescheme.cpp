@@ -1,6 +1,13 @@
 #include "../include/timescheme.h"
 #include "../include/config.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <array>
+#include <limits>
 #include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
 specfem::TimeScheme::Newmark::Newmark(const int nstep, const type_real t0,
                                       const type_real dt,
@@ -20,58 +27,620 @@ void specfem::TimeScheme::Newmark::increment_time() {
 
 void specfem::TimeScheme::Newmark::reset_time() {
   this->istep = 0;
+  this->isig_step = 0;
   this->current_time = this->t0;
   return;
 }
 
-KOKKOS_IMPL_HOST_FUNCTION
 void specfem::TimeScheme::Newmark::apply_predictor_phase(
-    const specfem::Domain::Domain *domain) {
+    const specfem::Domain::Domain *domain,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+  this->launch_predictor_phase(domain, exec_space, nullptr);
+  return;
+}
+
+void specfem::TimeScheme::Newmark::apply_predictor_phase(
+    const specfem::Domain::Domain *domain,
+    specfem::kokkos::DeviceGraphNode &node) {
+  this->launch_predictor_phase(domain, specfem::kokkos::DevExecSpace(), &node);
+  return;
+}
+
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::TimeScheme::Newmark::launch_predictor_phase(
+    const specfem::Domain::Domain *domain,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
   auto field = domain->get_field();
   auto field_dot = domain->get_field_dot();
   auto field_dot_dot = domain->get_field_dot_dot();
 
   const int nglob = field.extent(0);
   const int ndim = field.extent(1);
+  const type_accum deltat = this->deltat;
+  const type_accum deltatover2 = this->deltatover2;
+  const type_accum deltatsquareover2 = this->deltatsquareover2;
 
-  Kokkos::parallel_for(
+  specfem::kokkos::parallel_for(
       "specfem::TimeScheme::Newmark::apply_predictor_phase",
-      specfem::kokkos::DeviceRange(0, nglob),
-      KOKKOS_CLASS_LAMBDA(const int iglob) {
+      specfem::kokkos::DeviceRange(exec_space, 0, nglob),
+      KOKKOS_LAMBDA(const int iglob) {
         for (int idim = 0; idim < ndim; idim++) {
           // update displacements
-          field(iglob, idim) +=
-              this->deltat * field_dot(iglob, idim) +
-              this->deltatsquareover2 * field_dot_dot(iglob, idim);
+          const type_accum accel = field_dot_dot(iglob, idim);
+          const type_accum veloc = field_dot(iglob, idim);
+          field(iglob, idim) = field(iglob, idim) + deltat * veloc +
+                               deltatsquareover2 * accel;
           // apply predictor phase
-          field_dot(iglob, idim) +=
-              this->deltatover2 * field_dot_dot(iglob, idim);
+          field_dot(iglob, idim) = veloc + deltatover2 * accel;
           // reset acceleration
           field_dot_dot(iglob, idim) = 0;
         }
-      });
+      },
+      node);
 
   return;
 }
 
 KOKKOS_IMPL_HOST_FUNCTION
 void specfem::TimeScheme::Newmark::apply_corrector_phase(
-    const specfem::Domain::Domain *domain) {
+    const specfem::Domain::Domain *domain,
+    const specfem::kokkos::DevExecSpace &exec_space) {
 
   auto field_dot = domain->get_field_dot();
   auto field_dot_dot = domain->get_field_dot_dot();
 
   const int nglob = field_dot.extent(0);
   const int ndim = field_dot.extent(1);
+  const type_accum deltatover2 = this->deltatover2;
 
   Kokkos::parallel_for(
-      "specfem::TimeScheme::Newmark::apply_predictor_phase",
-      specfem::kokkos::DeviceRange(0, nglob),
-      KOKKOS_CLASS_LAMBDA(const int iglob) {
+      "specfem::TimeScheme::Newmark::apply_corrector_phase",
+      specfem::kokkos::DeviceRange(exec_space, 0, nglob),
+      KOKKOS_LAMBDA(const int iglob) {
+        for (int idim = 0; idim < ndim; idim++) {
+          // apply corrector phase
+          field_dot(iglob, idim) =
+              static_cast<type_accum>(field_dot(iglob, idim)) +
+              deltatover2 * field_dot_dot(iglob, idim);
+        }
+      });
+
+  return;
+}
+
+void specfem::TimeScheme::Newmark::apply_fused_corrector_phase(
+    const specfem::Domain::Domain *domain, const bool apply_predictor,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+  this->launch_fused_corrector_phase(domain, apply_predictor, exec_space,
+                                     nullptr);
+  return;
+}
+
+void specfem::TimeScheme::Newmark::apply_fused_corrector_phase(
+    const specfem::Domain::Domain *domain, const bool apply_predictor,
+    specfem::kokkos::DeviceGraphNode &node) {
+  this->launch_fused_corrector_phase(domain, apply_predictor,
+                                     specfem::kokkos::DevExecSpace(), &node);
+  return;
+}
+
+namespace {
+// Fused corrector update of a global point. If check is true returns the
+// largest absolute value of the updated displacement and velocity, or the
+// largest representable value if one of them isn't finite
+template <bool check, typename FieldView, typename MassView>
+KOKKOS_INLINE_FUNCTION type_real
+fused_corrector(const FieldView &field, const FieldView &field_dot,
+                const FieldView &field_dot_dot, const MassView &rmass_inverse,
+                const int iglob, const int ndim, const bool apply_predictor,
+                const type_accum deltat, const type_accum deltatover2,
+                const type_accum deltatsquareover2) {
+  constexpr type_real largest = std::numeric_limits<type_real>::max();
+  const type_real rmass_inversel = rmass_inverse(iglob);
+  type_real norm = 0.0;
+  for (int idim = 0; idim < ndim; idim++) {
+    // divide by mass matrix
+    type_accum accel =
+        static_cast<type_accum>(field_dot_dot(iglob, idim)) * rmass_inversel;
+    // apply corrector phase
+    type_accum veloc = field_dot(iglob, idim) + deltatover2 * accel;
+    if (apply_predictor) {
+      // update displacements
+      field(iglob, idim) =
+          field(iglob, idim) + deltat * veloc + deltatsquareover2 * accel;
+      // apply predictor phase
+      veloc += deltatover2 * accel;
+      // reset acceleration
+      accel = 0;
+    }
+    field_dot(iglob, idim) = veloc;
+    field_dot_dot(iglob, idim) = accel;
+
+    if constexpr (check) {
+      // NaNs and infinities fail every comparison
+      const type_real displ = Kokkos::fabs(field(iglob, idim));
+      const type_real speed = Kokkos::fabs(static_cast<type_real>(veloc));
+      if (!(displ < largest) || !(speed < largest))
+        norm = largest;
+      norm = (displ > norm && displ < largest) ? displ : norm;
+      norm = (speed > norm && speed < largest) ? speed : norm;
+    }
+  }
+  return norm;
+}
+} // namespace
+
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::TimeScheme::Newmark::launch_fused_corrector_phase(
+    const specfem::Domain::Domain *domain, const bool apply_predictor,
+    const specfem::kokkos::DevExecSpace &exec_space,
+    specfem::kokkos::DeviceGraphNode *node) {
+
+  auto field = domain->get_field();
+  auto field_dot = domain->get_field_dot();
+  auto field_dot_dot = domain->get_field_dot_dot();
+  auto rmass_inverse = domain->get_rmass_inverse();
+
+  const int nglob = field.extent(0);
+  const int ndim = field.extent(1);
+  const type_accum deltat = this->deltat;
+  const type_accum deltatover2 = this->deltatover2;
+  const type_accum deltatsquareover2 = this->deltatsquareover2;
+
+  const bool check = node == nullptr && this->check_interval > 0 &&
+                     this->istep % this->check_interval == 0;
+
+  if (!check) {
+    specfem::kokkos::parallel_for(
+        "specfem::TimeScheme::Newmark::apply_fused_corrector_phase",
+        specfem::kokkos::DeviceRange(exec_space, 0, nglob),
+        KOKKOS_LAMBDA(const int iglob) {
+          fused_corrector<false>(field, field_dot, field_dot_dot,
+                                 rmass_inverse, iglob, ndim, apply_predictor,
+                                 deltat, deltatover2, deltatsquareover2);
+        },
+        node);
+    return;
+  }
+
+  // Check steps reduce the norm of the updated fields in the same pass
+  using reducer = Kokkos::MaxLoc<type_real, int>;
+  reducer::value_type largest;
+  Kokkos::parallel_reduce(
+      "specfem::TimeScheme::Newmark::apply_fused_corrector_phase",
+      specfem::kokkos::DeviceRange(exec_space, 0, nglob),
+      KOKKOS_LAMBDA(const int iglob, reducer::value_type &l_largest) {
+        const type_real norm = fused_corrector<true>(
+            field, field_dot, field_dot_dot, rmass_inverse, iglob, ndim,
+            apply_predictor, deltat, deltatover2, deltatsquareover2);
+        if (norm > l_largest.val) {
+          l_largest.val = norm;
+          l_largest.loc = iglob;
+        }
+      },
+      reducer(largest));
+
+  const bool finite = largest.val < std::numeric_limits<type_real>::max();
+  if (!finite || largest.val > this->check_threshold) {
+    std::ostringstream message;
+    message << "Unstable simulation at step " << this->istep << " (t = "
+            << this->current_time << ") : ";
+    if (finite)
+      message << "largest absolute value of the fields " << largest.val
+              << " exceeds the stability threshold " << this->check_threshold;
+    else
+      message << "fields are not finite";
+    message << " at global point " << largest.loc
+            << ". Check the time step and the mesh elements sharing this "
+               "point";
+    throw std::runtime_error(message.str());
+  }
+
+  return;
+}
+
+specfem::timers::cost specfem::TimeScheme::Newmark::get_cost(
+    const specfem::timers::phase phase, const specfem::Domain::Domain *domain,
+    const bool apply_predictor) const {
+  const auto field = domain->get_field();
+  const double nglob = field.extent(0);
+  // Components of every shot
+  const double nvalues = nglob * field.extent(1);
+  constexpr double real = sizeof(type_real);
+
+  specfem::timers::cost cost;
+  switch (phase) {
+  case specfem::timers::predictor:
+    // Every field is read and written
+    cost.bytes = 6 * nvalues * real;
+    cost.flops = 6 * nvalues;
+    break;
+  case specfem::timers::corrector:
+    // Mass matrix, acceleration and velocity are read, velocity and
+    // acceleration are written. The fused predictor updates the displacement
+    cost.bytes = (nglob + (apply_predictor ? 6 : 4) * nvalues) * real;
+    cost.flops = (apply_predictor ? 9 : 3) * nvalues;
+    break;
+  default:
+    break;
+  }
+
+  return cost;
+}
+
+namespace {
+// Fraction of the timestep at which every stage starts. The increment of a
+// stage is d = alpha * d + 1 and the time moves by beta * d
+constexpr std::array<type_accum, specfem::TimeScheme::LDDRK::nstages>
+lddrk_stage_fractions() {
+  using LDDRK = specfem::TimeScheme::LDDRK;
+  std::array<type_accum, LDDRK::nstages> c = {};
+  type_accum d = 0.0;
+  for (int istage = 1; istage < LDDRK::nstages; istage++) {
+    d = LDDRK::alpha[istage - 1] * d + 1.0;
+    c[istage] = c[istage - 1] + LDDRK::beta[istage - 1] * d;
+  }
+  return c;
+}
+
+constexpr std::array<type_accum, specfem::TimeScheme::LDDRK::nstages>
+    c_lddrk = lddrk_stage_fractions();
+} // namespace
+
+specfem::TimeScheme::LDDRK::LDDRK(const int nstep, const type_real t0,
+                                  const type_real dt,
+                                  const int nstep_between_samples)
+    : nstep(nstep), t0(t0), deltat(dt),
+      nstep_between_samples(nstep_between_samples) {
+  this->current_time = this->t0;
+}
+
+void specfem::TimeScheme::LDDRK::increment_time() {
+  this->istep++;
+  this->current_time += this->deltat;
+  return;
+}
+
+void specfem::TimeScheme::LDDRK::reset_time() {
+  this->istep = 0;
+  this->isig_step = 0;
+  this->current_time = this->t0;
+  return;
+}
+
+type_real
+specfem::TimeScheme::LDDRK::get_stage_time(const int istage) const {
+  return this->current_time + c_lddrk[istage] * this->deltat;
+}
+
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::TimeScheme::LDDRK::apply_predictor_phase(
+    const specfem::Domain::Domain *domain,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+  auto field = domain->get_field();
+  auto field_dot_dot = domain->get_field_dot_dot();
+
+  const int nglob = field.extent(0);
+  const int ndim = field.extent(1);
+
+  // Registers are allocated on first use to match the fields of the domain
+  if (this->field_register.extent(0) != field.extent(0) ||
+      this->field_register.extent(1) != field.extent(1)) {
+    this->field_register = specfem::kokkos::DeviceFieldView2d<type_real>(
+        "specfem::TimeScheme::LDDRK::field_register", nglob, ndim);
+    this->field_dot_register = specfem::kokkos::DeviceFieldView2d<type_real>(
+        "specfem::TimeScheme::LDDRK::field_dot_register", nglob, ndim);
+  }
+
+  Kokkos::parallel_for(
+      "specfem::TimeScheme::LDDRK::apply_predictor_phase",
+      specfem::kokkos::DeviceRange(exec_space, 0, nglob),
+      KOKKOS_LAMBDA(const int iglob) {
+        for (int idim = 0; idim < ndim; idim++) {
+          // reset acceleration
+          field_dot_dot(iglob, idim) = 0;
+        }
+      });
+
+  return;
+}
+
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::TimeScheme::LDDRK::apply_stage_update(
+    const specfem::Domain::Domain *domain, const int istage,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  auto field = domain->get_field();
+  auto field_dot = domain->get_field_dot();
+  auto field_dot_dot = domain->get_field_dot_dot();
+  auto rmass_inverse = domain->get_rmass_inverse();
+  auto field_register = this->field_register;
+  auto field_dot_register = this->field_dot_register;
+
+  const int nglob = field.extent(0);
+  const int ndim = field.extent(1);
+  const type_accum deltat = this->deltat;
+  const type_accum alpha = LDDRK::alpha[istage];
+  const type_accum beta = LDDRK::beta[istage];
+  // Acceleration after the last stage is kept for seismograms
+  const bool reset_acceleration = (istage + 1 < nstages);
+
+  Kokkos::parallel_for(
+      "specfem::TimeScheme::LDDRK::apply_stage_update",
+      specfem::kokkos::DeviceRange(exec_space, 0, nglob),
+      KOKKOS_LAMBDA(const int iglob) {
+        const type_real rmass_inversel = rmass_inverse(iglob);
+        for (int idim = 0; idim < ndim; idim++) {
+          // divide by mass matrix
+          const type_accum accel =
+              static_cast<type_accum>(field_dot_dot(iglob, idim)) *
+              rmass_inversel;
+          const type_accum veloc = field_dot(iglob, idim);
+          // update registers
+          const type_accum dveloc =
+              alpha * field_dot_register(iglob, idim) + deltat * accel;
+          const type_accum ddispl =
+              alpha * field_register(iglob, idim) + deltat * veloc;
+          field_dot_register(iglob, idim) = dveloc;
+          field_register(iglob, idim) = ddispl;
+          // update fields
+          field_dot(iglob, idim) = veloc + beta * dveloc;
+          field(iglob, idim) = field(iglob, idim) + beta * ddispl;
+          field_dot_dot(iglob, idim) = reset_acceleration ? 0 : accel;
+        }
+      });
+
+  return;
+}
+
+void specfem::TimeScheme::LTSNewmark::set_element_levels(
+    specfem::Domain::Domain *domain,
+    const specfem::kokkos::HostElementMirror3d<int> ibool,
+    const std::vector<int> &element_levels) {
+
+  const int nspec = ibool.extent(0);
+  const int ngllz = ibool.extent(1);
+  const int ngllx = ibool.extent(2);
+  const int nglob = domain->get_field().extent(0);
+  const int ndim = domain->get_field().extent(1);
+
+  // A point is stepped with the time step of the finest element containing it
+  std::vector<int> h_point_level(nglob, 0);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int iglob = ibool(ispec, iz, ix);
+        h_point_level[iglob] =
+            std::max(h_point_level[iglob], element_levels[ispec]);
+      }
+    }
+  }
+
+  // An element is computed by every level of the points it contains
+  std::vector<int> reach(nspec, 0);
+  this->nlevels = 1;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        reach[ispec] =
+            std::max(reach[ispec], h_point_level[ibool(ispec, iz, ix)]);
+      }
+    }
+    this->nlevels = std::max(this->nlevels, reach[ispec] + 1);
+  }
+
+  domain->set_element_levels(reach);
+
+  // Sort points by level
+  this->h_point_offsets = std::vector<int>(this->nlevels + 1, 0);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    this->h_point_offsets[h_point_level[iglob] + 1]++;
+  }
+  for (int ilevel = 0; ilevel < this->nlevels; ilevel++) {
+    this->h_point_offsets[ilevel + 1] += this->h_point_offsets[ilevel];
+  }
+
+  this->point_level = specfem::kokkos::DeviceView1d<int>(
+      "specfem::TimeScheme::LTSNewmark::point_level", nglob);
+  this->level_points = specfem::kokkos::DeviceView1d<int>(
+      "specfem::TimeScheme::LTSNewmark::level_points", nglob);
+  auto h_level = Kokkos::create_mirror_view(this->point_level);
+  auto h_level_points = Kokkos::create_mirror_view(this->level_points);
+
+  std::vector<int> next(this->h_point_offsets.begin(),
+                        this->h_point_offsets.end() - 1);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    h_level(iglob) = h_point_level[iglob];
+    h_level_points(next[h_point_level[iglob]]++) = iglob;
+  }
+
+  // Points of coarser levels inside elements computed by a level
+  std::vector<int> interface;
+  this->h_interface_offsets = std::vector<int>(this->nlevels + 1, 0);
+  for (int ilevel = 1; ilevel < this->nlevels; ilevel++) {
+    std::vector<bool> marked(nglob, false);
+    for (int ispec = 0; ispec < nspec; ispec++) {
+      if (reach[ispec] < ilevel)
+        continue;
+      for (int iz = 0; iz < ngllz; iz++) {
+        for (int ix = 0; ix < ngllx; ix++) {
+          const int iglob = ibool(ispec, iz, ix);
+          if (h_point_level[iglob] < ilevel && !marked[iglob]) {
+            marked[iglob] = true;
+            interface.push_back(iglob);
+          }
+        }
+      }
+    }
+    this->h_interface_offsets[ilevel + 1] = interface.size();
+  }
+
+  this->interface_points = specfem::kokkos::DeviceView1d<int>(
+      "specfem::TimeScheme::LTSNewmark::interface_points", interface.size());
+  auto h_interface_points = Kokkos::create_mirror_view(this->interface_points);
+  for (int i = 0; i < interface.size(); i++) {
+    h_interface_points(i) = interface[i];
+  }
+
+  Kokkos::deep_copy(this->point_level, h_level);
+  Kokkos::deep_copy(this->level_points, h_level_points);
+  Kokkos::deep_copy(this->interface_points, h_interface_points);
+
+  this->field_start = specfem::kokkos::DeviceFieldView2d<type_real>(
+      "specfem::TimeScheme::LTSNewmark::field_start", nglob, ndim);
+  this->field_end = specfem::kokkos::DeviceFieldView2d<type_real>(
+      "specfem::TimeScheme::LTSNewmark::field_end", nglob, ndim);
+
+  return;
+}
+
+int specfem::TimeScheme::LTSNewmark::get_start_level(
+    const int isubstep) const {
+  // Steps of level ilevel span 2^(nlevels - 1 - ilevel) substeps
+  for (int ilevel = 0; ilevel < this->nlevels - 1; ilevel++) {
+    if (isubstep % (1 << (this->nlevels - 1 - ilevel)) == 0)
+      return ilevel;
+  }
+  return this->nlevels - 1;
+}
+
+int specfem::TimeScheme::LTSNewmark::get_substep_level(
+    const int isubstep) const {
+  return this->get_start_level(isubstep + 1);
+}
+
+type_real
+specfem::TimeScheme::LTSNewmark::get_level_time(const int isubstep,
+                                                const int ilevel) const {
+  // Steps of level ilevel span 2^(nlevels - 1 - ilevel) substeps and end at
+  // the end of isubstep
+  const int nsubsteps = 1 << (this->nlevels - 1);
+  const int istart = isubstep + 1 - (1 << (this->nlevels - 1 - ilevel));
+  return this->current_time + istart * this->deltat / nsubsteps;
+}
+
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::TimeScheme::LTSNewmark::apply_level_predictor_phase(
+    const specfem::Domain::Domain *domain, const int isubstep,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  auto field = domain->get_field();
+  auto field_dot = domain->get_field_dot();
+  auto field_dot_dot = domain->get_field_dot_dot();
+  auto field_start = this->field_start;
+  auto field_end = this->field_end;
+  auto point_level = this->point_level;
+  auto level_points = this->level_points;
+  auto interface_points = this->interface_points;
+
+  const int nglob = field.extent(0);
+  const int ndim = field.extent(1);
+  const int nlevels = this->nlevels;
+  const type_accum deltat = this->deltat;
+  const int start_level = this->get_start_level(isubstep);
+  const int end_level = this->get_substep_level(isubstep);
+
+  Kokkos::parallel_for(
+      "specfem::TimeScheme::LTSNewmark::apply_level_predictor_phase",
+      specfem::kokkos::DeviceRange(
+          exec_space,
+          this->h_point_offsets[std::min(start_level, end_level)], nglob),
+      KOKKOS_LAMBDA(const int ipoint) {
+        const int iglob = level_points(ipoint);
+        const int level = point_level(iglob);
+        const type_accum dt = deltat / (1 << level);
+        for (int idim = 0; idim < ndim; idim++) {
+          if (level >= start_level) {
+            const type_accum accel = field_dot_dot(iglob, idim);
+            const type_accum veloc = field_dot(iglob, idim);
+            const type_accum displ = field(iglob, idim);
+            // update displacements
+            const type_accum displ_end =
+                displ + dt * veloc + 0.5 * dt * dt * accel;
+            field_start(iglob, idim) = displ;
+            field_end(iglob, idim) = displ_end;
+            field(iglob, idim) = displ_end;
+            // apply predictor phase
+            field_dot(iglob, idim) = veloc + 0.5 * dt * accel;
+          }
+          // reset acceleration
+          if (level >= end_level)
+            field_dot_dot(iglob, idim) = 0;
+        }
+      });
+
+  // Displacement of coarser points at the end of the substep
+  Kokkos::parallel_for(
+      "specfem::TimeScheme::LTSNewmark::interpolate_interface",
+      specfem::kokkos::DeviceRange(exec_space,
+                                   this->h_interface_offsets[end_level],
+                                   this->h_interface_offsets[end_level + 1]),
+      KOKKOS_LAMBDA(const int ipoint) {
+        const int iglob = interface_points(ipoint);
+        const int nsubsteps_level = 1 << (nlevels - 1 - point_level(iglob));
+        const type_accum theta =
+            static_cast<type_accum>((isubstep % nsubsteps_level) + 1) /
+            nsubsteps_level;
+        for (int idim = 0; idim < ndim; idim++) {
+          const type_accum displ_start = field_start(iglob, idim);
+          const type_accum displ_end = field_end(iglob, idim);
+          field(iglob, idim) = displ_start + theta * (displ_end - displ_start);
+        }
+      });
+
+  return;
+}
+
+KOKKOS_IMPL_HOST_FUNCTION
+void specfem::TimeScheme::LTSNewmark::apply_level_corrector_phase(
+    const specfem::Domain::Domain *domain, const int isubstep,
+    const specfem::kokkos::DevExecSpace &exec_space) {
+
+  auto field = domain->get_field();
+  auto field_dot = domain->get_field_dot();
+  auto field_dot_dot = domain->get_field_dot_dot();
+  auto rmass_inverse = domain->get_rmass_inverse();
+  auto field_end = this->field_end;
+  auto point_level = this->point_level;
+  auto level_points = this->level_points;
+  auto interface_points = this->interface_points;
+
+  const int nglob = field.extent(0);
+  const int ndim = field.extent(1);
+  const type_accum deltat = this->deltat;
+  const int end_level = this->get_substep_level(isubstep);
+
+  Kokkos::parallel_for(
+      "specfem::TimeScheme::LTSNewmark::restore_interface",
+      specfem::kokkos::DeviceRange(exec_space,
+                                   this->h_interface_offsets[end_level],
+                                   this->h_interface_offsets[end_level + 1]),
+      KOKKOS_LAMBDA(const int ipoint) {
+        const int iglob = interface_points(ipoint);
         for (int idim = 0; idim < ndim; idim++) {
+          field(iglob, idim) = field_end(iglob, idim);
+        }
+      });
+
+  Kokkos::parallel_for(
+      "specfem::TimeScheme::LTSNewmark::apply_level_corrector_phase",
+      specfem::kokkos::DeviceRange(exec_space,
+                                   this->h_point_offsets[end_level], nglob),
+      KOKKOS_LAMBDA(const int ipoint) {
+        const int iglob = level_points(ipoint);
+        const type_accum dt = deltat / (1 << point_level(iglob));
+        const type_real rmass_inversel = rmass_inverse(iglob);
+        for (int idim = 0; idim < ndim; idim++) {
+          // divide by mass matrix
+          const type_accum accel =
+              static_cast<type_accum>(field_dot_dot(iglob, idim)) *
+              rmass_inversel;
           // apply corrector phase
-          field_dot(iglob, idim) +=
-              this->deltatover2 * field_dot_dot(iglob, idim);
+          field_dot(iglob, idim) =
+              static_cast<type_accum>(field_dot(iglob, idim)) +
+              0.5 * dt * accel;
+          field_dot_dot(iglob, idim) = accel;
         }
       });
 
@@ -92,6 +661,37 @@ void specfem::TimeScheme::Newmark::print(std::ostream &message) const {
           << "    dt = " << this->deltat << "\n"
           << "    number of time steps = " << this->nstep << "\n"
           << "    Start time = " << this->t0 << "\n";
+  if (this->check_interval > 0)
+    message << "    stability check every " << this->check_interval
+            << " steps, threshold = " << this->check_threshold << "\n";
+}
+
+void specfem::TimeScheme::LDDRK::print(std::ostream &message) const {
+  message << "  Time Scheme:\n"
+          << "------------------------------\n"
+          << "- LDDRK\n"
+          << "    dt = " << this->deltat << "\n"
+          << "    number of stages = " << nstages << "\n"
+          << "    number of time steps = " << this->nstep << "\n"
+          << "    Start time = " << this->t0 << "\n";
+}
+
+void specfem::TimeScheme::LTSNewmark::print(std::ostream &message) const {
+  message << "  Time Scheme:\n"
+          << "------------------------------\n"
+          << "- Newmark with local time stepping\n"
+          << "    dt = " << this->deltat << "\n"
+          << "    number of levels = " << this->nlevels << "\n";
+  // Points per level are known once levels are assigned
+  for (int ilevel = 0; ilevel + 1 < this->h_point_offsets.size(); ilevel++) {
+    message << "      level " << ilevel << " : dt = "
+            << this->deltat / (1 << ilevel) << ", number of points = "
+            << this->h_point_offsets[ilevel + 1] -
+                   this->h_point_offsets[ilevel]
+            << "\n";
+  }
+  message << "    number of time steps = " << this->nstep << "\n"
+          << "    Start time = " << this->t0 << "\n";
 }
 
 std::ostream &
@@ -0,0 +1,153 @@
+#include "../include/trace.h"
+#include "../include/specfem_mpi.h"
+#include <Kokkos_Core.hpp>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Kernels launched while the active recorder records kernels
+struct kernel_launches {
+  std::mutex mutex;
+  specfem::trace::recorder *recorder = nullptr;
+  std::uint64_t next = 0;
+  std::map<std::uint64_t,
+           std::pair<std::string, std::chrono::steady_clock::time_point> >
+      running;
+};
+
+static kernel_launches &launches() {
+  static kernel_launches instance;
+  return instance;
+}
+
+// Kokkos tools callbacks
+static void begin_kernel(const char *name, const std::uint32_t,
+                         std::uint64_t *kernel) {
+  auto &state = launches();
+  const std::lock_guard<std::mutex> lock(state.mutex);
+  *kernel = state.next++;
+  if (state.recorder != nullptr && state.recorder->is_recording())
+    state.running[*kernel] = { name, std::chrono::steady_clock::now() };
+}
+
+static void end_kernel(const std::uint64_t kernel) {
+  const auto end = std::chrono::steady_clock::now();
+  auto &state = launches();
+  const std::lock_guard<std::mutex> lock(state.mutex);
+  const auto launch = state.running.find(kernel);
+  if (launch == state.running.end())
+    return;
+  state.recorder->record(launch->second.first, specfem::trace::kernels,
+                         launch->second.second, end);
+  state.running.erase(launch);
+}
+
+// Escape the characters of a name which aren't allowed in JSON strings
+static std::string escape(const std::string &name) {
+  std::string escaped;
+  for (const char c : name) {
+    if (c == '"' || c == '\\')
+      escaped += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20)
+      escaped += c;
+  }
+  return escaped;
+}
+
+specfem::trace::recorder::recorder(const specfem::MPI::MPI *mpi,
+                                   const int first_step, const int last_step)
+    : first_step(first_step), last_step(last_step) {
+  if (first_step > last_step)
+    throw std::runtime_error("First traced step is after the last one");
+  mpi->sync_all();
+  this->origin = std::chrono::steady_clock::now();
+}
+
+specfem::trace::recorder::~recorder() {
+  auto &state = launches();
+  const std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.recorder == this) {
+    state.recorder = nullptr;
+    state.running.clear();
+  }
+}
+
+void specfem::trace::recorder::record(
+    const std::string &name, const specfem::trace::track track,
+    const std::chrono::steady_clock::time_point &begin,
+    const std::chrono::steady_clock::time_point &end) {
+  if (!this->is_recording())
+    return;
+  const std::chrono::duration<double, std::micro> start =
+      begin - this->origin;
+  const std::chrono::duration<double, std::micro> duration = end - begin;
+  this->events.push_back(
+      { name, track, start.count(), duration.count(), this->istep });
+}
+
+void specfem::trace::recorder::record_kernels() {
+  if (!this->enabled)
+    return;
+  auto &state = launches();
+  {
+    const std::lock_guard<std::mutex> lock(state.mutex);
+    state.recorder = this;
+  }
+  Kokkos::Tools::Experimental::set_begin_parallel_for_callback(begin_kernel);
+  Kokkos::Tools::Experimental::set_end_parallel_for_callback(end_kernel);
+  Kokkos::Tools::Experimental::set_begin_parallel_reduce_callback(
+      begin_kernel);
+  Kokkos::Tools::Experimental::set_end_parallel_reduce_callback(end_kernel);
+}
+
+void specfem::trace::recorder::write(const std::string &filename,
+                                     const specfem::MPI::MPI *mpi) const {
+  if (!this->enabled)
+    return;
+
+  // Processes append their events in turn
+  for (int irank = 0; irank < mpi->get_size(); irank++) {
+    if (irank == mpi->get_rank()) {
+      const bool first = (irank == 0);
+      std::ofstream file(filename, first ? std::ios::trunc : std::ios::app);
+      if (!file.is_open())
+        throw std::runtime_error("Could not open trace " + filename);
+
+      file << std::fixed << std::setprecision(3);
+      if (first)
+        file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+      file << (first ? "" : ",\n") << "{\"ph\": \"M\", \"pid\": " << irank
+           << ", \"name\": \"process_name\", \"args\": {\"name\": "
+           << "\"Process " << irank << "\"}},\n"
+           << "{\"ph\": \"M\", \"pid\": " << irank << ", \"tid\": "
+           << specfem::trace::phases
+           << ", \"name\": \"thread_name\", \"args\": {\"name\": "
+           << "\"Phases\"}},\n"
+           << "{\"ph\": \"M\", \"pid\": " << irank << ", \"tid\": "
+           << specfem::trace::kernels
+           << ", \"name\": \"thread_name\", \"args\": {\"name\": "
+           << "\"Kernels\"}}";
+      for (const auto &event : this->events) {
+        file << ",\n{\"ph\": \"X\", \"pid\": " << irank
+             << ", \"tid\": " << event.track << ", \"name\": \""
+             << escape(event.name) << "\", \"ts\": " << event.begin
+             << ", \"dur\": " << event.duration
+             << ", \"args\": {\"step\": " << event.istep << "}}";
+      }
+      if (irank == mpi->get_size() - 1)
+        file << "\n]}\n";
+    }
+    mpi->sync_all();
+  }
+}
+
+specfem::trace::recorder *specfem::trace::disabled() {
+  static specfem::trace::recorder instance;
+  return &instance;
+}
@@ -1,242 +1,465 @@
 #include "../include/utils.h"
-#include "../include/jacobian.h"
 #include "../include/kokkos_abstractions.h"
+#include "../include/shape_functions.h"
 #include "../include/specfem_mpi.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 #include <tuple>
 #include <vector>
 
-std::vector<int>
-get_best_candidates(const int ispec_guess,
-                    const specfem::kokkos::HostView3d<int> ibool) {
+specfem::utilities::spatial_index::spatial_index(
+    const specfem::kokkos::HostView2d<type_real> coord,
+    const specfem::kokkos::HostElementMirror3d<int> ibool)
+    : coord(coord), ngllz(ibool.extent(1)), ngllx(ibool.extent(2)) {
 
   const int nspec = ibool.extent(0);
-  const int ngllx = ibool.extent(1);
-  const int ngllz = ibool.extent(2);
+  const int nglob = coord.extent(1);
 
-  std::vector<int> iglob_guess;
-  iglob_guess.push_back(ibool(ispec_guess, 0, 0));
-  iglob_guess.push_back(ibool(ispec_guess, ngllz - 1, 0));
-  iglob_guess.push_back(ibool(ispec_guess, 0, ngllx - 1));
-  iglob_guess.push_back(ibool(ispec_guess, ngllz - 1, ngllx - 1));
+  // First quadrature point, in element order, of every global point
+  this->first.assign(nglob, -1);
+  for (int ispec = 0; ispec < nspec; ispec++)
+    for (int j = 0; j < ngllz; j++)
+      for (int i = 0; i < ngllx; i++) {
+        const int iglob = ibool(ispec, j, i);
+        if (this->first[iglob] < 0)
+          this->first[iglob] = (ispec * ngllz + j) * ngllx + i;
+      }
 
-  std::vector<int> ispec_candidates;
-  ispec_candidates.push_back(ispec_guess);
+  this->xmin = std::numeric_limits<type_real>::max();
+  this->zmin = std::numeric_limits<type_real>::max();
+  type_real xmax = std::numeric_limits<type_real>::lowest();
+  type_real zmax = std::numeric_limits<type_real>::lowest();
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    this->xmin = std::min(this->xmin, coord(0, iglob));
+    this->zmin = std::min(this->zmin, coord(1, iglob));
+    xmax = std::max(xmax, coord(0, iglob));
+    zmax = std::max(zmax, coord(1, iglob));
+  }
 
-  for (int ispec = 0; ispec < nspec; ispec++) {
-    if (ispec == ispec_guess)
+  // About 4 points per bucket, buckets are close to square
+  const type_real width = xmax - this->xmin;
+  const type_real height = zmax - this->zmin;
+  const int nbuckets = std::max(1, nglob / 4);
+  if (width > 0 && height > 0) {
+    const type_real aspect = width / height;
+    this->nx = std::max(
+        1, static_cast<int>(std::lround(std::sqrt(nbuckets * aspect))));
+    this->nz = std::max(1, nbuckets / this->nx);
+  } else if (width > 0) {
+    this->nx = nbuckets;
+  } else if (height > 0) {
+    this->nz = nbuckets;
+  }
+  this->hx = (width > 0) ? width / this->nx : 1;
+  this->hz = (height > 0) ? height / this->nz : 1;
+
+  // Points of bucket b span [offsets[b], offsets[b + 1]) in points
+  std::vector<int> bucket(nglob, -1);
+  this->offsets.assign(this->nx * this->nz + 1, 0);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    if (this->first[iglob] < 0)
       continue;
+    bucket[iglob] = this->bucket_x(coord(0, iglob)) * this->nz +
+                    this->bucket_z(coord(1, iglob));
+    this->offsets[bucket[iglob] + 1]++;
+  }
+  for (int b = 0; b < this->nx * this->nz; b++)
+    this->offsets[b + 1] += this->offsets[b];
+  this->points.resize(this->offsets.back());
+  std::vector<int> position(this->offsets.begin(), this->offsets.end() - 1);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    if (bucket[iglob] >= 0)
+      this->points[position[bucket[iglob]]++] = iglob;
+  }
 
-    // loop over only corners
-    for (int j : { 0, ngllz - 1 }) {
+  // Elements touching every global point at one of their corners
+  std::vector<int> corner_offsets(nglob + 1, 0);
+  for (int ispec = 0; ispec < nspec; ispec++)
+    for (int j : { 0, ngllz - 1 })
+      for (int i : { 0, ngllx - 1 })
+        corner_offsets[ibool(ispec, j, i) + 1]++;
+  for (int iglob = 0; iglob < nglob; iglob++)
+    corner_offsets[iglob + 1] += corner_offsets[iglob];
+  std::vector<int> corner_elements(corner_offsets.back());
+  position.assign(corner_offsets.begin(), corner_offsets.end() - 1);
+  for (int ispec = 0; ispec < nspec; ispec++)
+    for (int j : { 0, ngllz - 1 })
+      for (int i : { 0, ngllx - 1 })
+        corner_elements[position[ibool(ispec, j, i)]++] = ispec;
+
+  // Neighbors of every element in increasing order
+  this->neighbor_offsets.assign(nspec + 1, 0);
+  std::vector<int> neighbors;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    neighbors.clear();
+    for (int j : { 0, ngllz - 1 })
       for (int i : { 0, ngllx - 1 }) {
-        // check if this element is in contact with initial guess
-        if (std::find(iglob_guess.begin(), iglob_guess.end(),
-                      ibool(ispec, j, i)) != iglob_guess.end()) {
-          // do not count the element twice
-          if (ispec_candidates.size() > 0 &&
-              ispec_candidates[ispec_candidates.size() - 1] != ispec)
-            ispec_candidates.push_back(ispec);
+        const int iglob = ibool(ispec, j, i);
+        for (int k = corner_offsets[iglob]; k < corner_offsets[iglob + 1];
+             k++) {
+          if (corner_elements[k] != ispec)
+            neighbors.push_back(corner_elements[k]);
         }
       }
-    }
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                    neighbors.end());
+    this->neighbors.insert(this->neighbors.end(), neighbors.begin(),
+                           neighbors.end());
+    this->neighbor_offsets[ispec + 1] = this->neighbors.size();
   }
-
-  return ispec_candidates;
 }
 
 std::tuple<int, int, int>
-rough_location(const type_real x_source, const type_real z_source,
-               const specfem::kokkos::HostView3d<int> ibool,
-               const specfem::kokkos::HostView2d<type_real> coord) {
+specfem::utilities::spatial_index::rough_location(const type_real x,
+                                                  const type_real z) const {
 
-  /***
-   *  Roughly locate closest quadrature point to the source
-   ***/
+  const int cx = this->bucket_x(x);
+  const int cz = this->bucket_z(z);
 
-  const int nspec = ibool.extent(0);
-  const int ngllx = ibool.extent(1);
-  const int ngllz = ibool.extent(2);
   type_real dist_min = std::numeric_limits<type_real>::max();
-  type_real dist_squared;
-
-  int ispec_selected, ix_selected, iz_selected;
-
-  for (int ispec = 0; ispec < nspec; ispec++) {
-    for (int j = 0; j < ngllz; j++) {
-      for (int i = 0; i < ngllx; i++) {
-        int iglob = ibool(ispec, j, i);
-        dist_squared =
-            (x_source - coord(0, iglob)) * (x_source - coord(0, iglob)) +
-            (z_source - coord(1, iglob)) * (z_source - coord(1, iglob));
-        if (dist_squared < dist_min) {
-          ispec_selected = ispec;
-          ix_selected = i;
-          iz_selected = j;
-          dist_min = dist_squared;
-        }
+  int selected = std::numeric_limits<int>::max();
+
+  const auto search_bucket = [&](const int bx, const int bz) {
+    if (bz < 0 || bz >= this->nz)
+      return;
+    const int b = bx * this->nz + bz;
+    for (int k = this->offsets[b]; k < this->offsets[b + 1]; k++) {
+      const int iglob = this->points[k];
+      const type_real dist_squared =
+          (x - coord(0, iglob)) * (x - coord(0, iglob)) +
+          (z - coord(1, iglob)) * (z - coord(1, iglob));
+      if (dist_squared < dist_min ||
+          (dist_squared == dist_min && this->first[iglob] < selected)) {
+        dist_min = dist_squared;
+        selected = this->first[iglob];
       }
     }
+  };
+
+  // Rings of buckets around the bucket of the point are searched until the
+  // remaining buckets are further than the closest point. Ties are broken
+  // by element order
+  for (int r = 0;; r++) {
+    for (int bx = std::max(0, cx - r); bx <= std::min(this->nx - 1, cx + r);
+         bx++) {
+      if (bx == cx - r || bx == cx + r) {
+        for (int bz = cz - r; bz <= cz + r; bz++)
+          search_bucket(bx, bz);
+      } else {
+        search_bucket(bx, cz - r);
+        search_bucket(bx, cz + r);
+      }
+    }
+
+    // Distance between the point and the buckets outside the ring
+    type_real bound = std::numeric_limits<type_real>::max();
+    if (cx - r > 0)
+      bound = std::min(bound, x - (this->xmin + (cx - r) * this->hx));
+    if (cx + r < this->nx - 1)
+      bound = std::min(bound, this->xmin + (cx + r + 1) * this->hx - x);
+    if (cz - r > 0)
+      bound = std::min(bound, z - (this->zmin + (cz - r) * this->hz));
+    if (cz + r < this->nz - 1)
+      bound = std::min(bound, this->zmin + (cz + r + 1) * this->hz - z);
+    if (bound == std::numeric_limits<type_real>::max())
+      break;
+    bound = std::max(bound, static_cast<type_real>(0));
+    if (dist_min < bound * bound)
+      break;
   }
 
-  return std::make_tuple(ix_selected, iz_selected, ispec_selected);
+  const int ngll2d = this->ngllz * this->ngllx;
+  return std::make_tuple(selected % this->ngllx,
+                         (selected % ngll2d) / this->ngllx,
+                         selected / ngll2d);
 }
 
-std::tuple<type_real, type_real>
-get_best_location(const type_real x_source, const type_real z_source,
-                  const specfem::kokkos::HostView2d<type_real> coorg,
-                  type_real xi, type_real gamma,
-                  const specfem::kokkos::HostView2d<int> knods,
-                  const int ispec) {
-
-  int ngnod = knods.extent(0);
-
-  specfem::kokkos::HostView2d<type_real> s_coorg("get_best_location::s_coorg",
-                                                 ndim, ngnod);
-
-  // Store s_coorg for better caching
-  for (int in = 0; in < ngnod; in++) {
-    s_coorg(0, in) = coorg(0, knods(in, ispec));
-    s_coorg(1, in) = coorg(1, knods(in, ispec));
-  }
+std::vector<int>
+specfem::utilities::spatial_index::best_candidates(const int ispec) const {
+  std::vector<int> candidates = { ispec };
+  candidates.insert(candidates.end(),
+                    this->neighbors.begin() + this->neighbor_offsets[ispec],
+                    this->neighbors.begin() +
+                        this->neighbor_offsets[ispec + 1]);
+  return candidates;
+}
 
-  for (int iter_loop = 0; iter_loop < 5; iter_loop++) {
-    auto [x, z] = jacobian::compute_locations(s_coorg, ngnod, xi, gamma);
-    auto [xix, xiz, gammax, gammaz] =
-        jacobian::compute_inverted_derivatives(s_coorg, ngnod, xi, gamma);
+int specfem::utilities::spatial_index::bucket_x(const type_real x) const {
+  const int bx = std::floor((x - this->xmin) / this->hx);
+  return std::max(0, std::min(this->nx - 1, bx));
+}
 
-    type_real dx = -(x - x_source);
-    type_real dz = -(z - z_source);
+int specfem::utilities::spatial_index::bucket_z(const type_real z) const {
+  const int bz = std::floor((z - this->zmin) / this->hz);
+  return std::max(0, std::min(this->nz - 1, bz));
+}
 
-    type_real dxi = xix * dx + xiz * dz;
-    type_real dgamma = gammax * dx + gammaz * dz;
+void specfem::utilities::best_locations(
+    const specfem::kokkos::HostView1d<type_real> x,
+    const specfem::kokkos::HostView1d<type_real> z,
+    const specfem::kokkos::HostView1d<int> ispec,
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    specfem::kokkos::HostView1d<type_real> xi,
+    specfem::kokkos::HostView1d<type_real> gamma,
+    specfem::kokkos::HostView1d<type_real> residual,
+    const int max_iterations) {
+
+  const int npoints = x.extent(0);
+  const int ngnod = knods.extent(0);
+  // Smaller updates don't move the location in type_real precision
+  const type_real tolerance = 10 * std::numeric_limits<type_real>::epsilon();
+
+  Kokkos::parallel_for(
+      "specfem::utilities::best_locations",
+      specfem::kokkos::HostRange(0, npoints), [=](const int ipoint) {
+        const int ielement = ispec(ipoint);
+
+        // Store s_coorg for better caching
+        type_real s_coorg[ndim][shape_functions::max_ngnod];
+        for (int in = 0; in < ngnod; in++) {
+          s_coorg[0][in] = coorg(0, knods(in, ielement));
+          s_coorg[1][in] = coorg(1, knods(in, ielement));
+        }
 
-    xi += dxi;
-    gamma += dgamma;
+        type_real shape2D[shape_functions::max_ngnod];
+        type_real dershape2D[ndim][shape_functions::max_ngnod];
+        type_real xi_point = xi(ipoint);
+        type_real gamma_point = gamma(ipoint);
+        type_real dx, dz;
+        bool converged = false;
+
+        for (int iteration = 0;; iteration++) {
+          shape_functions::define_shape_functions(xi_point, gamma_point, ngnod,
+                                                  shape2D, dershape2D);
+
+          type_real xp = 0.0, zp = 0.0;
+          type_real xxi = 0.0, zxi = 0.0, xgamma = 0.0, zgamma = 0.0;
+          for (int in = 0; in < ngnod; in++) {
+            xp += shape2D[in] * s_coorg[0][in];
+            zp += shape2D[in] * s_coorg[1][in];
+            xxi += dershape2D[0][in] * s_coorg[0][in];
+            zxi += dershape2D[0][in] * s_coorg[1][in];
+            xgamma += dershape2D[1][in] * s_coorg[0][in];
+            zgamma += dershape2D[1][in] * s_coorg[1][in];
+          }
+
+          dx = x(ipoint) - xp;
+          dz = z(ipoint) - zp;
+
+          if (converged || iteration == max_iterations)
+            break;
+
+          const type_real jacobian = xxi * zgamma - xgamma * zxi;
+          type_real xi_next =
+              xi_point + (zgamma * dx - xgamma * dz) / jacobian;
+          type_real gamma_next =
+              gamma_point + (xxi * dz - zxi * dx) / jacobian;
+
+          if (xi_next > 1.01)
+            xi_next = 1.01;
+          if (xi_next < -1.01)
+            xi_next = -1.01;
+          if (gamma_next > 1.01)
+            gamma_next = 1.01;
+          if (gamma_next < -1.01)
+            gamma_next = -1.01;
+
+          converged = std::fabs(xi_next - xi_point) < tolerance &&
+                      std::fabs(gamma_next - gamma_point) < tolerance;
+          xi_point = xi_next;
+          gamma_point = gamma_next;
+        }
 
-    if (xi > 1.01)
-      xi = 1.01;
-    if (xi < -1.01)
-      xi = -1.01;
-    if (gamma > 1.01)
-      gamma = 1.01;
-    if (gamma < -1.01)
-      gamma = -1.01;
-  }
+        xi(ipoint) = xi_point;
+        gamma(ipoint) = gamma_point;
+        residual(ipoint) = std::sqrt(dx * dx + dz * dz);
+      });
 
-  return std::make_tuple(xi, gamma);
+  Kokkos::fence();
 }
 
-int get_islice(const int final_dist, const specfem::MPI::MPI *mpi) {
+std::vector<std::tuple<type_real, type_real, int, int> >
+specfem::utilities::locate(
+    const specfem::kokkos::HostView2d<type_real> coord,
+    const specfem::kokkos::HostElementMirror3d<int> ibool,
+    const specfem::kokkos::HostMirror1d<type_real> xigll,
+    const specfem::kokkos::HostMirror1d<type_real> zigll,
+    const std::vector<type_real> &x_sources,
+    const std::vector<type_real> &z_sources,
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const specfem::MPI::MPI *mpi) {
+
+  const int nlocations = x_sources.size();
+  const int nglob = coord.extent(1);
+  const type_real unassigned = std::numeric_limits<type_real>::max();
+
+  // Bounding box of the quadrature points on this rank
+  type_real xmin = std::numeric_limits<type_real>::max();
+  type_real xmax = std::numeric_limits<type_real>::lowest();
+  type_real zmin = std::numeric_limits<type_real>::max();
+  type_real zmax = std::numeric_limits<type_real>::lowest();
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    xmin = std::min(xmin, coord(0, iglob));
+    xmax = std::max(xmax, coord(0, iglob));
+    zmin = std::min(zmin, coord(1, iglob));
+    zmax = std::max(zmax, coord(1, iglob));
+  }
+  const type_real tolerance = 1e-5 * std::max(xmax - xmin, zmax - zmin);
 
-  int islice = 0;
-  type_real glob_final_dist = mpi->all_reduce(final_dist, specfem::MPI::min);
+  std::vector<type_real> distances(nlocations, unassigned);
+  std::vector<type_real> xi(nlocations, 0.0), gamma(nlocations, 0.0);
+  std::vector<int> ispec(nlocations, -1);
 
-  // check if the source lies on currrent proc
-  if ((fabs(glob_final_dist - final_dist)) < 1e-6)
-    islice = mpi->get_rank();
+  // Built once for every point of the batch
+  const specfem::utilities::spatial_index index(coord, ibool);
 
-  std::vector<int> all_slice = mpi->gather(islice);
+  const int ngllz = ibool.extent(1);
+  const int ngllx = ibool.extent(2);
 
-  // checking if multiple mpi ranks get assigned the source
-  if (mpi->main_proc()) {
-    bool already_assigned = false;
-    for (int i = all_slice.size() - 1; i >= 0; i--) {
-      // assign the source the maximum processor number
-      // replicated from fortran code
-      if (all_slice[i] == i && already_assigned) {
-        mpi->cout("Multiple processors were assigned the same data");
-        all_slice[i] = 0;
-      } else if (all_slice[i] == i) {
-        already_assigned = true;
+  // Every candidate element of every point is searched in a single batch.
+  // Candidates are compared in order, hence ties select the first candidate
+  const auto search = [&](const std::vector<int> &points) {
+    std::vector<int> owners, elements;
+    std::vector<type_real> xi_guesses, gamma_guesses;
+    for (const int i : points) {
+      // get closest quadrature point to source
+      auto [ix_guess, iz_guess, ispec_guess] =
+          index.rough_location(x_sources[i], z_sources[i]);
+      const auto candidates = index.best_candidates(ispec_guess);
+      for (int icandidate = 0; icandidate < candidates.size(); icandidate++) {
+        if (icandidate > 0) {
+          ix_guess = int(ngllx / 2.0);
+          iz_guess = int(ngllz / 2.0);
+        }
+        owners.push_back(i);
+        elements.push_back(candidates[icandidate]);
+        xi_guesses.push_back(xigll(ix_guess));
+        gamma_guesses.push_back(zigll(iz_guess));
       }
     }
 
-    if (!already_assigned) {
-      throw std::runtime_error("Source was not assigned to any slice");
+    const int ncandidates = owners.size();
+    specfem::kokkos::HostView1d<type_real> x_candidates(
+        "specfem::utilities::locate::x", ncandidates);
+    specfem::kokkos::HostView1d<type_real> z_candidates(
+        "specfem::utilities::locate::z", ncandidates);
+    specfem::kokkos::HostView1d<int> ispec_candidates(
+        "specfem::utilities::locate::ispec", ncandidates);
+    specfem::kokkos::HostView1d<type_real> xi_candidates(
+        "specfem::utilities::locate::xi", ncandidates);
+    specfem::kokkos::HostView1d<type_real> gamma_candidates(
+        "specfem::utilities::locate::gamma", ncandidates);
+    specfem::kokkos::HostView1d<type_real> residuals(
+        "specfem::utilities::locate::residuals", ncandidates);
+    for (int icandidate = 0; icandidate < ncandidates; icandidate++) {
+      x_candidates(icandidate) = x_sources[owners[icandidate]];
+      z_candidates(icandidate) = z_sources[owners[icandidate]];
+      ispec_candidates(icandidate) = elements[icandidate];
+      xi_candidates(icandidate) = xi_guesses[icandidate];
+      gamma_candidates(icandidate) = gamma_guesses[icandidate];
     }
-  }
-
-  islice = mpi->scatter(all_slice);
-
-  return islice;
-}
-
-std::tuple<type_real, type_real, int, int>
-specfem::utilities::locate(const specfem::kokkos::HostView2d<type_real> coord,
-                           const specfem::kokkos::HostMirror3d<int> ibool,
-                           const specfem::kokkos::HostMirror1d<type_real> xigll,
-                           const specfem::kokkos::HostMirror1d<type_real> zigll,
-                           const int nproc, const type_real x_source,
-                           const type_real z_source,
-                           const specfem::kokkos::HostView2d<type_real> coorg,
-                           const specfem::kokkos::HostView2d<int> knods,
-                           const int npgeo, const specfem::MPI::MPI *mpi) {
 
-  const int nspec = ibool.extent(0);
-  const int ngllx = ibool.extent(1);
-  const int ngllz = ibool.extent(2);
-  // get closest quadrature point to source
-  auto [ix_guess, iz_guess, ispec_guess] =
-      rough_location(x_source, z_source, ibool, coord);
-  int ngnod = knods.extent(0);
-
-  assert(ispec_guess < nspec);
-
-  // get best candidates to search
-  auto ispec_candidates = get_best_candidates(ispec_guess, ibool);
-  specfem::kokkos::HostView2d<type_real> s_coorg(
-      "specfem::utilities::locate::s_coorg", ndim, ngnod);
-
-  type_real final_dist = std::numeric_limits<type_real>::max();
-  int ispec_selected_source;
-  type_real xi_source, gamma_source;
-
-  for (int i = 0; i < ispec_candidates.size(); i++) {
-    if (i > 0) {
-      ix_guess = int(ngllx / 2.0);
-      iz_guess = int(ngllz / 2.0);
+    specfem::utilities::best_locations(
+        x_candidates, z_candidates, ispec_candidates, coorg, knods,
+        xi_candidates, gamma_candidates, residuals, use_best_location ? 5 : 0);
+
+    for (int icandidate = 0; icandidate < ncandidates; icandidate++) {
+      const int i = owners[icandidate];
+      if (residuals(icandidate) < distances[i]) {
+        distances[i] = residuals(icandidate);
+        xi[i] = xi_candidates(icandidate);
+        gamma[i] = gamma_candidates(icandidate);
+        ispec[i] = ispec_candidates(icandidate);
+      }
     }
+  };
+
+  // Only points inside the bounding box are searched
+  std::vector<int> inside;
+  for (int i = 0; i < nlocations; i++) {
+    if (x_sources[i] >= xmin - tolerance && x_sources[i] <= xmax + tolerance &&
+        z_sources[i] >= zmin - tolerance && z_sources[i] <= zmax + tolerance)
+      inside.push_back(i);
+  }
+  search(inside);
 
-    int ispec = ispec_candidates[i];
-
-    type_real xi = xigll(ix_guess);
-    type_real gamma = zigll(iz_guess);
-
-    if (use_best_location)
-      std::tie(xi, gamma) =
-          get_best_location(x_source, z_source, coorg, xi, gamma, knods, ispec);
-
-    // Store s_coorg for better caching
-    for (int in = 0; in < ngnod; in++) {
-      s_coorg(0, in) = coorg(0, knods(in, ispec));
-      s_coorg(1, in) = coorg(1, knods(in, ispec));
-    }
+  std::vector<type_real> global_distances =
+      mpi->all_reduce(distances, specfem::MPI::min);
 
-    auto [x, z] = jacobian::compute_locations(s_coorg, ngnod, xi, gamma);
+  // Points outside every bounding box, i.e. outside the mesh, are searched by
+  // every rank
+  std::vector<int> outside;
+  for (int i = 0; i < nlocations; i++) {
+    if (global_distances[i] == unassigned)
+      outside.push_back(i);
+  }
+  search(outside);
+
+  if (!outside.empty())
+    global_distances = mpi->all_reduce(distances, specfem::MPI::min);
+
+  // Points found on several ranks are assigned to the maximum rank,
+  // replicated from fortran code
+  std::vector<int> islice(nlocations, -1);
+  for (int i = 0; i < nlocations; i++) {
+    if (distances[i] != unassigned &&
+        std::fabs(global_distances[i] - distances[i]) < 1e-6)
+      islice[i] = mpi->get_rank();
+  }
 
-    type_real final_distance_this_element = std::sqrt(
-        (x_source - x) * (x_source - x) + (z_source - z) * (z_source - z));
+  islice = mpi->all_reduce(islice, specfem::MPI::max);
 
-    if (final_distance_this_element < final_dist) {
-      ispec_selected_source = ispec;
-      xi_source = xi;
-      gamma_source = gamma;
-      final_dist = final_distance_this_element;
+  // Ship the location found by the owner to every rank
+  specfem::kokkos::HostView1d<type_real> local_coordinates(
+      "specfem::utilities::locate::local_coordinates", 2 * nlocations);
+  specfem::kokkos::HostView1d<int> ispec_selected(
+      "specfem::utilities::locate::ispec_selected", nlocations);
+  Kokkos::deep_copy(ispec_selected, -1);
+  for (int i = 0; i < nlocations; i++) {
+    if (islice[i] < 0)
+      throw std::runtime_error("Source was not assigned to any slice");
+    if (islice[i] == mpi->get_rank()) {
+      local_coordinates(2 * i) = xi[i];
+      local_coordinates(2 * i + 1) = gamma[i];
+      ispec_selected(i) = ispec[i];
     }
   }
 
-#ifdef MPI_PARALLEL
-  int islice = get_islice(final_dist, mpi);
-#else
-  int islice = 0;
-#endif
-
-  mpi->bcast(xi_source, islice);
-  mpi->bcast(gamma_source, islice);
-  mpi->bcast(ispec_selected_source, islice);
+  // Both reductions are in flight at the same time
+  auto coordinates_request =
+      mpi->iall_reduce(local_coordinates, specfem::MPI::sum);
+  auto ispec_request = mpi->iall_reduce(ispec_selected, specfem::MPI::max);
+  coordinates_request.wait();
+  ispec_request.wait();
+
+  std::vector<std::tuple<type_real, type_real, int, int> > locations(
+      nlocations);
+  for (int i = 0; i < nlocations; i++)
+    locations[i] =
+        std::make_tuple(local_coordinates(2 * i), local_coordinates(2 * i + 1),
+                        ispec_selected(i), islice[i]);
+
+  return locations;
+}
 
-  return std::make_tuple(xi_source, gamma_source, ispec_selected_source,
-                         islice);
+std::tuple<type_real, type_real, int, int>
+specfem::utilities::locate(
+    const specfem::kokkos::HostView2d<type_real> coord,
+    const specfem::kokkos::HostElementMirror3d<int> ibool,
+    const specfem::kokkos::HostMirror1d<type_real> xigll,
+    const specfem::kokkos::HostMirror1d<type_real> zigll,
+    const int nproc, const type_real x_source, const type_real z_source,
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const int npgeo, const specfem::MPI::MPI *mpi) {
+
+  return specfem::utilities::locate(coord, ibool, xigll, zigll, { x_source },
+                                    { z_source }, coorg, knods, mpi)[0];
 }
 
 void specfem::utilities::check_locations(const type_real x, const type_real z,
@@ -247,10 +470,20 @@ void specfem::utilities::check_locations(const type_real x, const type_real z,
                                          const specfem::MPI::MPI *mpi) {
   // Check if the source is inside the domain
 
-  type_real global_xmin = mpi->reduce(xmin, specfem::MPI::min);
-  type_real global_xmax = mpi->reduce(xmax, specfem::MPI::max);
-  type_real global_zmin = mpi->reduce(zmin, specfem::MPI::min);
-  type_real global_zmax = mpi->reduce(xmax, specfem::MPI::max);
+  specfem::kokkos::HostView1d<type_real> lower(
+      "specfem::utilities::check_locations::lower", 2);
+  specfem::kokkos::HostView1d<type_real> upper(
+      "specfem::utilities::check_locations::upper", 2);
+  lower(0) = xmin;
+  lower(1) = zmin;
+  upper(0) = xmax;
+  upper(1) = zmax;
+  mpi->reduce(lower, specfem::MPI::min);
+  mpi->reduce(upper, specfem::MPI::max);
+  const type_real global_xmin = lower(0);
+  const type_real global_xmax = upper(0);
+  const type_real global_zmin = lower(1);
+  const type_real global_zmax = upper(1);
 
   if (mpi->get_main()) {
     if (x < global_xmin || x > global_xmax || z < global_zmin ||
@@ -268,7 +501,7 @@ void specfem::utilities::check_locations(const type_real x, const type_real z,
 }
 
 int specfem::utilities::compute_nglob(
-    const specfem::kokkos::HostMirror3d<int> ibool) {
+    const specfem::kokkos::HostElementMirror3d<int> ibool) {
 
   const int nspec = ibool.extent(0);
   const int ngllz = ibool.extent(1);
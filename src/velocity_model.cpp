@@ -0,0 +1,176 @@
+#include "../include/velocity_model.h"
+#include "../include/compute.h"
+#include "../include/config.h"
+#include "../include/kokkos_abstractions.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Fractional index of a coordinate in the grid, clamped to the grid
+static double grid_index(const double value, const double origin,
+                         const double spacing, const int n) {
+  const double index = (value - origin) / spacing;
+  return std::min(std::max(index, 0.0), static_cast<double>(n - 1));
+}
+
+int specfem::velocity_model::interpolate(
+    const std::string &filename, const int tile_rows,
+    const specfem::kokkos::HostView2d<type_real> coord,
+    const specfem::kokkos::HostElementMirror3d<int> ibool,
+    specfem::compute::properties &properties) {
+
+  if (tile_rows < 1) {
+    throw std::runtime_error("Velocity model tiles need at least 1 row");
+  }
+
+  std::ifstream stream(filename, std::ios::binary);
+  if (!stream.is_open()) {
+    std::ostringstream message;
+    message << "Could not open velocity model " << filename;
+    throw std::runtime_error(message.str());
+  }
+
+  specfem::velocity_model::header head;
+  stream.read(reinterpret_cast<char *>(&head), sizeof(head));
+  if (!stream || std::memcmp(head.magic, "SPECFEMV", 8) != 0 ||
+      head.nx < 2 || head.nz < 2 || !(head.dx > 0.0) || !(head.dz > 0.0)) {
+    std::ostringstream message;
+    message << "Velocity model " << filename << " has an invalid header";
+    throw std::runtime_error(message.str());
+  }
+
+  const int nx = head.nx;
+  const int nz = head.nz;
+  const std::size_t row_values = static_cast<std::size_t>(nfields) * nx;
+
+  stream.seekg(0, std::ios::end);
+  const std::size_t expected =
+      sizeof(head) + row_values * nz * sizeof(float);
+  if (static_cast<std::size_t>(stream.tellg()) != expected) {
+    std::ostringstream message;
+    message << "Velocity model " << filename << " should have " << expected
+            << " bytes for a grid of " << nx << " x " << nz << " points";
+    throw std::runtime_error(message.str());
+  }
+
+  const int nspec = ibool.extent(0);
+  const int ngllz = ibool.extent(1);
+  const int ngllx = ibool.extent(2);
+  const int ngllxz = ngllz * ngllx;
+
+  // Bucket the quadrature points of elastic elements by the tile containing
+  // the row below them. Interpolation reads this row and the next one
+  const int ntiles = (nz - 2) / tile_rows + 1;
+  std::vector<int> tile_offsets(ntiles + 1, 0);
+  std::vector<int> point_tile(nspec * ngllxz, -1);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    if (properties.h_ispec_type(ispec) != specfem::elements::elastic)
+      continue;
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int iglob = ibool(ispec, iz, ix);
+        const double zindex = grid_index(coord(1, iglob), head.z0, head.dz, nz);
+        const int row = std::min(static_cast<int>(zindex), nz - 2);
+        const int itile = row / tile_rows;
+        point_tile[(ispec * ngllz + iz) * ngllx + ix] = itile;
+        tile_offsets[itile + 1]++;
+      }
+    }
+  }
+  for (int itile = 0; itile < ntiles; itile++)
+    tile_offsets[itile + 1] += tile_offsets[itile];
+
+  const int npoints = tile_offsets[ntiles];
+  specfem::kokkos::HostView1d<int> points(
+      "specfem::velocity_model::points", npoints);
+  {
+    std::vector<int> next(tile_offsets.begin(), tile_offsets.end() - 1);
+    for (int ipoint = 0; ipoint < nspec * ngllxz; ipoint++) {
+      if (point_tile[ipoint] >= 0)
+        points(next[point_tile[ipoint]]++) = ipoint;
+    }
+  }
+
+  const auto rho = properties.h_rho;
+  const auto mu = properties.h_mu;
+  const auto lambdaplus2mu = properties.h_lambdaplus2mu;
+  const auto kappa = properties.kappa;
+  const auto rho_vp = properties.rho_vp;
+  const auto rho_vs = properties.rho_vs;
+  const specfem::velocity_model::header grid = head;
+
+  // Rows of a tile and the first row of the next tile
+  specfem::kokkos::HostView2d<float> tile(
+      "specfem::velocity_model::tile", tile_rows + 1, row_values);
+
+  for (int itile = 0; itile < ntiles; itile++) {
+    const int istart = tile_offsets[itile];
+    const int iend = tile_offsets[itile + 1];
+    if (istart == iend)
+      continue;
+
+    const int first_row = itile * tile_rows;
+    const int nrows = std::min(tile_rows + 1, nz - first_row);
+    stream.seekg(sizeof(head) + first_row * row_values * sizeof(float));
+    stream.read(reinterpret_cast<char *>(tile.data()),
+                nrows * row_values * sizeof(float));
+    if (!stream) {
+      std::ostringstream message;
+      message << "Could not read rows " << first_row << " to "
+              << first_row + nrows << " of velocity model " << filename;
+      throw std::runtime_error(message.str());
+    }
+
+    Kokkos::parallel_for(
+        "specfem::velocity_model::interpolate",
+        specfem::kokkos::HostRange(istart, iend), [=](const int index) {
+          const int ipoint = points(index);
+          const int ispec = ipoint / ngllxz;
+          const int iz = (ipoint / ngllx) % ngllz;
+          const int ix = ipoint % ngllx;
+          const int iglob = ibool(ispec, iz, ix);
+
+          const double xindex =
+              grid_index(coord(0, iglob), grid.x0, grid.dx, grid.nx);
+          const double zindex =
+              grid_index(coord(1, iglob), grid.z0, grid.dz, grid.nz);
+          const int column = std::min(static_cast<int>(xindex), grid.nx - 2);
+          const int row = std::min(static_cast<int>(zindex), grid.nz - 2);
+          const double wx = xindex - column;
+          const double wz = zindex - row;
+          const int irow = row - first_row;
+
+          type_real values[nfields];
+          for (int ifield = 0; ifield < nfields; ifield++) {
+            const int i = ifield * grid.nx + column;
+            values[ifield] = (1.0 - wz) * ((1.0 - wx) * tile(irow, i) +
+                                           wx * tile(irow, i + 1)) +
+                             wz * ((1.0 - wx) * tile(irow + 1, i) +
+                                   wx * tile(irow + 1, i + 1));
+          }
+
+          const type_real vp = values[0];
+          const type_real vs = values[1];
+          const type_real rhol = values[2];
+          const type_real mul = rhol * vs * vs;
+          const type_real lambdaplus2mul = rhol * vp * vp;
+
+          rho(ispec, iz, ix) = rhol;
+          mu(ispec, iz, ix) = mul;
+          lambdaplus2mu(ispec, iz, ix) = lambdaplus2mul;
+          kappa(ispec, iz, ix) = lambdaplus2mul - mul;
+          rho_vp(ispec, iz, ix) = rhol * vp;
+          rho_vs(ispec, iz, ix) = rhol * vs;
+        });
+  }
+
+  properties.sync_views();
+
+  return npoints;
+}
@@ -0,0 +1,405 @@
+#include "../include/wavefield_writer.h"
+#include "../include/compute.h"
+#include "../include/domain.h"
+#include "../include/kokkos_abstractions.h"
+#include "../include/lagrange_poly.h"
+#include "../include/quadrature.h"
+#include "../include/specfem_mpi.h"
+#include "../include/utils.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <future>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <limits>
+#include <string>
+#include <vector>
+
+std::vector<int> specfem::writer::select_points(
+    const specfem::kokkos::HostElementMirror3d<int> ibool, const int nglob,
+    const int stride) {
+  const int nspec = ibool.extent(0);
+  const int ngllz = ibool.extent(1);
+  const int ngllx = ibool.extent(2);
+
+  std::vector<bool> selected(nglob, false);
+  std::vector<int> points;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int iz = 0; iz < ngllz; iz++) {
+      if (iz % stride != 0 && iz != ngllz - 1)
+        continue;
+      for (int ix = 0; ix < ngllx; ix++) {
+        if (ix % stride != 0 && ix != ngllx - 1)
+          continue;
+        const int iglob = ibool(ispec, iz, ix);
+        if (!selected[iglob]) {
+          selected[iglob] = true;
+          points.push_back(iglob);
+        }
+      }
+    }
+  }
+  return points;
+}
+
+specfem::writer::wavefield::wavefield(
+    specfem::Domain::Domain *domain, const specfem::compute::compute *compute,
+    const std::vector<specfem::seismogram::type> &fields,
+    const int nstep_between_snapshots, const int stride,
+    const std::string output_folder, const specfem::MPI::MPI *mpi)
+    : domain(domain), fields(fields),
+      nstep_between_snapshots(nstep_between_snapshots),
+      output_folder(output_folder), rank(mpi->get_rank()),
+      copy_spaces(Kokkos::Experimental::partition_space(
+          specfem::kokkos::DevExecSpace(), 1, 1)) {
+
+  if (nstep_between_snapshots < 1 || stride < 1 || fields.empty()) {
+    std::ostringstream message;
+    message << "Wavefield snapshots need at least one field, a positive "
+            << "number of steps between snapshots and a positive stride";
+    throw std::runtime_error(message.str());
+  }
+
+  const auto coord = compute->coordinates.coord;
+  const auto h_points =
+      specfem::writer::select_points(compute->h_ibool, coord.extent(1),
+                                     stride);
+  const int npoints = h_points.size();
+  const int ncomponents = domain->get_field().extent(1);
+
+  this->points = specfem::kokkos::DeviceView1d<int>(
+      "specfem::writer::wavefield::points", npoints);
+  auto mirror = Kokkos::create_mirror_view(this->points);
+  specfem::kokkos::HostView2d<type_real> point_coord(
+      "specfem::writer::wavefield::coord", npoints, ndim);
+  for (int ipoint = 0; ipoint < npoints; ipoint++) {
+    mirror(ipoint) = h_points[ipoint];
+    for (int idim = 0; idim < ndim; idim++)
+      point_coord(ipoint, idim) = coord(idim, h_points[ipoint]);
+  }
+  Kokkos::deep_copy(this->points, mirror);
+
+  for (int islot = 0; islot < 2; islot++) {
+    this->buffer[islot] = specfem::kokkos::DeviceView3d<type_real>(
+        "specfem::writer::wavefield::buffer", fields.size(), npoints,
+        ncomponents);
+    this->staging[islot] = specfem::kokkos::HostPinnedView3d<type_real>(
+        "specfem::writer::wavefield::staging", fields.size(), npoints,
+        ncomponents);
+  }
+
+  std::filesystem::create_directories(output_folder);
+  specfem::writer::write_binary(output_folder + "/wavefield_points_" +
+                                    std::to_string(this->rank) + ".bin",
+                                point_coord, { npoints });
+}
+
+specfem::writer::wavefield::wavefield(
+    specfem::Domain::Domain *domain, const specfem::compute::compute *compute,
+    const specfem::quadrature::quadrature &quadx,
+    const specfem::quadrature::quadrature &quadz,
+    const specfem::kokkos::HostView2d<type_real> coorg,
+    const specfem::kokkos::HostView2d<int> knods,
+    const std::vector<specfem::seismogram::type> &fields,
+    const int nstep_between_snapshots, const specfem::writer::image_grid &grid,
+    const std::string output_folder, const specfem::MPI::MPI *mpi)
+    : domain(domain), fields(fields),
+      nstep_between_snapshots(nstep_between_snapshots),
+      output_folder(output_folder), rank(mpi->get_rank()), grid(grid),
+      ibool(compute->get_ibool()),
+      copy_spaces(Kokkos::Experimental::partition_space(
+          specfem::kokkos::DevExecSpace(), 1, 1)) {
+
+  if (nstep_between_snapshots < 1 || fields.empty() || grid.nx < 1 ||
+      grid.nz < 1) {
+    std::ostringstream message;
+    message << "Wavefield images need at least one field, a positive "
+            << "number of steps between snapshots and at least one pixel "
+            << "along x and z";
+    throw std::runtime_error(message.str());
+  }
+
+  const auto coord = compute->coordinates.coord;
+  const auto h_ibool = compute->h_ibool;
+  const int nglob = coord.extent(1);
+
+  // The grid spans the bounding box of the mesh if it isn't given
+  if (!grid.bounded) {
+    type_real xmin = std::numeric_limits<type_real>::max();
+    type_real xmax = std::numeric_limits<type_real>::lowest();
+    type_real zmin = std::numeric_limits<type_real>::max();
+    type_real zmax = std::numeric_limits<type_real>::lowest();
+    for (int iglob = 0; iglob < nglob; iglob++) {
+      xmin = std::min(xmin, coord(0, iglob));
+      xmax = std::max(xmax, coord(0, iglob));
+      zmin = std::min(zmin, coord(1, iglob));
+      zmax = std::max(zmax, coord(1, iglob));
+    }
+    this->grid.xmin = mpi->all_reduce(xmin, specfem::MPI::min);
+    this->grid.xmax = mpi->all_reduce(xmax, specfem::MPI::max);
+    this->grid.zmin = mpi->all_reduce(zmin, specfem::MPI::min);
+    this->grid.zmax = mpi->all_reduce(zmax, specfem::MPI::max);
+  }
+
+  const int nx = this->grid.nx;
+  const int nz = this->grid.nz;
+  const type_real dx = (this->grid.xmax - this->grid.xmin) / nx;
+  const type_real dz = (this->grid.zmax - this->grid.zmin) / nz;
+  if (!(dx > 0.0) || !(dz > 0.0))
+    throw std::runtime_error("Wavefield images need xmax > xmin and "
+                             "zmax > zmin");
+
+  // Every pixel is located once
+  const int npixels = nx * nz;
+  std::vector<type_real> x(npixels), z(npixels);
+  for (int iz = 0; iz < nz; iz++) {
+    for (int ix = 0; ix < nx; ix++) {
+      x[iz * nx + ix] = this->grid.xmin + (ix + 0.5) * dx;
+      z[iz * nx + ix] = this->grid.zmin + (iz + 0.5) * dz;
+    }
+  }
+
+  const auto xigll = quadx.get_hxi();
+  const auto zigll = quadz.get_hxi();
+  const auto locations = specfem::utilities::locate(
+      coord, h_ibool, xigll, zigll, x, z, coorg, knods, mpi);
+
+  const int ngllz = h_ibool.extent(1);
+  const int ngllx = h_ibool.extent(2);
+  specfem::kokkos::HostMirror1d<type_real> h_xi(
+      "specfem::writer::wavefield::h_xi", ngllx);
+  specfem::kokkos::HostMirror1d<type_real> hprime_xi(
+      "specfem::writer::wavefield::hprime_xi", ngllx);
+  specfem::kokkos::HostMirror1d<type_real> h_gamma(
+      "specfem::writer::wavefield::h_gamma", ngllz);
+  specfem::kokkos::HostMirror1d<type_real> hprime_gamma(
+      "specfem::writer::wavefield::hprime_gamma", ngllz);
+
+  // Pixels outside the mesh are located on its boundary, further than the
+  // tolerance from their center
+  const type_real tolerance = 1e-2 * std::max(dx, dz);
+  std::vector<int> located, located_ispec;
+  std::vector<type_real> located_hxi, located_hgamma;
+  for (int ipixel = 0; ipixel < npixels; ipixel++) {
+    auto [xi, gamma, ispec, islice] = locations[ipixel];
+    if (islice != this->rank)
+      continue;
+
+    xi = std::min(static_cast<type_real>(1.0),
+                  std::max(static_cast<type_real>(-1.0), xi));
+    gamma = std::min(static_cast<type_real>(1.0),
+                     std::max(static_cast<type_real>(-1.0), gamma));
+    Lagrange::compute_lagrange_interpolants(h_xi, hprime_xi, xi, ngllx, xigll);
+    Lagrange::compute_lagrange_interpolants(h_gamma, hprime_gamma, gamma,
+                                            ngllz, zigll);
+
+    type_real x_located = 0.0;
+    type_real z_located = 0.0;
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const type_real weight = h_gamma(iz) * h_xi(ix);
+        const int iglob = h_ibool(ispec, iz, ix);
+        x_located += weight * coord(0, iglob);
+        z_located += weight * coord(1, iglob);
+      }
+    }
+    if (std::hypot(x_located - x[ipixel], z_located - z[ipixel]) > tolerance)
+      continue;
+
+    located.push_back(ipixel);
+    located_ispec.push_back(ispec);
+    for (int ix = 0; ix < ngllx; ix++)
+      located_hxi.push_back(h_xi(ix));
+    for (int iz = 0; iz < ngllz; iz++)
+      located_hgamma.push_back(h_gamma(iz));
+  }
+
+  const int nlocated = located.size();
+  this->pixels = specfem::kokkos::DeviceView1d<int>(
+      "specfem::writer::wavefield::pixels", nlocated);
+  this->pixel_ispec = specfem::kokkos::DeviceView1d<int>(
+      "specfem::writer::wavefield::pixel_ispec", nlocated);
+  this->hxi = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::writer::wavefield::hxi", nlocated, ngllx);
+  this->hgamma = specfem::kokkos::DeviceView2d<type_real>(
+      "specfem::writer::wavefield::hgamma", nlocated, ngllz);
+  auto h_pixels = Kokkos::create_mirror_view(this->pixels);
+  auto h_pixel_ispec = Kokkos::create_mirror_view(this->pixel_ispec);
+  auto h_hxi = Kokkos::create_mirror_view(this->hxi);
+  auto h_hgamma = Kokkos::create_mirror_view(this->hgamma);
+  for (int ipixel = 0; ipixel < nlocated; ipixel++) {
+    h_pixels(ipixel) = located[ipixel];
+    h_pixel_ispec(ipixel) = located_ispec[ipixel];
+    for (int ix = 0; ix < ngllx; ix++)
+      h_hxi(ipixel, ix) = located_hxi[ipixel * ngllx + ix];
+    for (int iz = 0; iz < ngllz; iz++)
+      h_hgamma(ipixel, iz) = located_hgamma[ipixel * ngllz + iz];
+  }
+  Kokkos::deep_copy(this->pixels, h_pixels);
+  Kokkos::deep_copy(this->pixel_ispec, h_pixel_ispec);
+  Kokkos::deep_copy(this->hxi, h_hxi);
+  Kokkos::deep_copy(this->hgamma, h_hgamma);
+
+  this->field_types = specfem::kokkos::DeviceView1d<int>(
+      "specfem::writer::wavefield::field_types", fields.size());
+  auto h_field_types = Kokkos::create_mirror_view(this->field_types);
+  for (int ifield = 0; ifield < fields.size(); ifield++) {
+    switch (fields[ifield]) {
+    case specfem::seismogram::displacement:
+      h_field_types(ifield) = 0;
+      break;
+    case specfem::seismogram::velocity:
+      h_field_types(ifield) = 1;
+      break;
+    case specfem::seismogram::acceleration:
+      h_field_types(ifield) = 2;
+      break;
+    default:
+      throw std::runtime_error("Wavefield type has not been implemented yet");
+    }
+  }
+  Kokkos::deep_copy(this->field_types, h_field_types);
+
+  // Pixels located on other processes or outside the mesh stay 0
+  const int ncomponents = domain->get_field().extent(1);
+  for (int islot = 0; islot < 2; islot++) {
+    this->buffer[islot] = specfem::kokkos::DeviceView3d<type_real>(
+        "specfem::writer::wavefield::buffer", fields.size(), npixels,
+        ncomponents);
+    this->staging[islot] = specfem::kokkos::HostPinnedView3d<type_real>(
+        "specfem::writer::wavefield::staging", fields.size(), npixels,
+        ncomponents);
+  }
+
+  std::filesystem::create_directories(output_folder);
+
+  std::ostringstream message;
+  message << "Wavefield images : " << nx << " x " << nz
+          << " pixels spanning [" << this->grid.xmin << ", "
+          << this->grid.xmax << "] x [" << this->grid.zmin << ", "
+          << this->grid.zmax << "], "
+          << npixels - mpi->reduce(nlocated, specfem::MPI::sum)
+          << " pixels outside the mesh\n";
+  mpi->cout(message.str());
+}
+
+specfem::writer::wavefield::~wavefield() {
+  if (this->pending.valid())
+    this->pending.wait();
+}
+
+void specfem::writer::wavefield::snapshot(
+    const int istep, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const int islot = this->isnapshot % 2;
+  const auto points = this->points;
+  const auto buffer = this->buffer[islot];
+  const int npoints = points.extent(0);
+  const int ncomponents = buffer.extent(2);
+  const bool image = (this->grid.nx > 0);
+
+  // Every field of every located pixel is interpolated by a single kernel
+  if (image) {
+    const auto field = this->domain->get_field();
+    const auto field_dot = this->domain->get_field_dot();
+    const auto field_dot_dot = this->domain->get_field_dot_dot();
+    const auto field_types = this->field_types;
+    const auto pixels = this->pixels;
+    const auto pixel_ispec = this->pixel_ispec;
+    const auto hxi = this->hxi;
+    const auto hgamma = this->hgamma;
+    const auto ibool = this->ibool;
+    const int nfields = field_types.extent(0);
+    const int ngllx = hxi.extent(1);
+    const int ngllz = hgamma.extent(1);
+
+    Kokkos::parallel_for(
+        "specfem::writer::wavefield::interpolate",
+        Kokkos::RangePolicy<specfem::kokkos::DevExecSpace>(
+            exec_space, 0, pixels.extent(0)),
+        KOKKOS_LAMBDA(const int ipixel) {
+          const int ispec = pixel_ispec(ipixel);
+          const int index = pixels(ipixel);
+          for (int ifield = 0; ifield < nfields; ifield++) {
+            const int type = field_types(ifield);
+            const auto values = (type == 0)   ? field
+                                : (type == 1) ? field_dot
+                                              : field_dot_dot;
+            for (int icomp = 0; icomp < ncomponents; icomp++) {
+              type_real value = 0.0;
+              for (int iz = 0; iz < ngllz; iz++) {
+                type_real row = 0.0;
+                for (int ix = 0; ix < ngllx; ix++)
+                  row += hxi(ipixel, ix) * values(ibool(ispec, iz, ix), icomp);
+                value += hgamma(ipixel, iz) * row;
+              }
+              buffer(ifield, index, icomp) = value;
+            }
+          }
+        });
+  } else {
+    for (int ifield = 0; ifield < this->fields.size(); ifield++) {
+      specfem::kokkos::DeviceFieldView2d<type_real> field;
+      switch (this->fields[ifield]) {
+      case specfem::seismogram::displacement:
+        field = this->domain->get_field();
+        break;
+      case specfem::seismogram::velocity:
+        field = this->domain->get_field_dot();
+        break;
+      case specfem::seismogram::acceleration:
+        field = this->domain->get_field_dot_dot();
+        break;
+      default:
+        throw std::runtime_error(
+            "Wavefield type has not been implemented yet");
+      }
+
+      Kokkos::parallel_for(
+          "specfem::writer::wavefield::gather",
+          Kokkos::RangePolicy<specfem::kokkos::DevExecSpace>(exec_space, 0,
+                                                             npoints),
+          KOKKOS_LAMBDA(const int ipoint) {
+            const int iglob = points(ipoint);
+            for (int icomp = 0; icomp < ncomponents; icomp++)
+              buffer(ifield, ipoint, icomp) = field(iglob, icomp);
+          });
+    }
+  }
+
+  // The copy instance reads the gathered values. Later updates of the fields
+  // don't need to wait for the copy
+  exec_space.fence();
+  const auto &copy_space = this->copy_spaces[islot];
+  const auto staging = this->staging[islot];
+  Kokkos::deep_copy(copy_space, staging, buffer);
+
+  // Snapshots are written in order. Rethrows errors of the previous write
+  if (this->pending.valid())
+    this->pending.get();
+
+  // Images start with their number of pixels along x and z
+  std::ostringstream filename;
+  filename << this->output_folder << (image ? "/image_" : "/wavefield_")
+           << std::setw(6) << std::setfill('0') << istep + 1 << "_"
+           << this->rank << ".bin";
+  std::vector<std::int32_t> header;
+  if (image)
+    header = { this->grid.nx, this->grid.nz };
+  this->pending = std::async(
+      std::launch::async,
+      [copy_space, staging, header, name = filename.str()]() {
+        copy_space.fence();
+        specfem::writer::write_binary(name, staging, header);
+      });
+
+  this->isnapshot++;
+}
+
+void specfem::writer::wavefield::write() {
+  if (this->pending.valid())
+    this->pending.get();
+}
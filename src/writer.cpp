@@ -1,81 +1,569 @@
 #include "../include/writer.h"
 #include "../include/compute.h"
+#include "../include/hdf5_file.h"
 #include "../include/receiver.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-void specfem::writer::seismogram::write() {
+namespace {
 
-  const int n_receivers = this->receivers.size();
-  const int nsig_types = this->compute_receivers->h_seismogram_types.extent(0);
-  const int nsig_steps = this->compute_receivers->h_seismogram.extent(0);
-  const auto h_seismogram = this->compute_receivers->h_seismogram;
-  const type_real dt = this->dt;
-  const type_real t0 = this->t0;
-  const type_real nstep_between_samples = this->nstep_between_samples;
+// Size of a Seismic Unix (SEG-Y) trace header in bytes
+constexpr int su_header_size = 240;
 
-  this->compute_receivers->sync_seismograms();
+// Byte offsets of the trace header fields set by the writer
+namespace su_header {
+enum field {
+  tracl = 0,
+  tracr = 4,
+  fldr = 8,
+  tracf = 12,
+  trid = 28,
+  gelev = 40,
+  scalel = 68,
+  scalco = 70,
+  gx = 80,
+  delrt = 108,
+  ns = 114,
+  dt = 116
+};
+} // namespace su_header
 
-  std::cout << "output folder : " << this->output_folder << "\n";
+// Store value at byte offset of a trace header
+template <typename T>
+void set_header(std::vector<char> &trace, const int offset, const T value) {
+  std::memcpy(trace.data() + offset, &value, sizeof(T));
+}
+
+// Seismic Unix files storing the x and z components of seismograms with
+// extension ext
+std::vector<std::string> su_filenames(const std::string &output_folder,
+                                      const std::string &ext) {
+  return { output_folder + "/Ux_file_single_" + ext + ".su",
+           output_folder + "/Uz_file_single_" + ext + ".su" };
+}
+
+// Append samples [first, first + nsamples) of the written receivers to one
+// existing Seismic Unix file per component with one trace per receiver,
+// receivers being traces [first_trace, first_trace + written.size()). The
+// headers of the traces are written with the first samples, traces are sized
+// for nsig_steps samples. Samples are single precision floats in native byte
+// order, as written by Seismic Unix itself
+template <typename ViewType>
+void write_seismic_unix(const specfem::receivers::receiver_set &receivers,
+                        const std::vector<int> &written, const int first_trace,
+                        const ViewType buffer, const int isig,
+                        const std::vector<std::string> &filename,
+                        const int first, const int nsamples,
+                        const int nsig_steps, const type_real sample_dt,
+                        const type_real t0) {
+
+  const int n_receivers = written.size();
+  if (n_receivers == 0)
+    return;
+  const int dt_us = std::lround(sample_dt * 1e6);
+  const int delrt_ms = std::lround(t0 * 1e3);
+
+  if (nsig_steps > std::numeric_limits<std::uint16_t>::max() ||
+      dt_us > std::numeric_limits<std::uint16_t>::max() ||
+      delrt_ms < std::numeric_limits<std::int16_t>::min() ||
+      delrt_ms > std::numeric_limits<std::int16_t>::max()) {
+    std::ostringstream message;
+    message << "Seismograms with " << nsig_steps << " samples, a sampling "
+            << "interval of " << dt_us << " us and a start time of "
+            << delrt_ms << " ms can't be stored in Seismic Unix headers";
+    throw std::runtime_error(message.str());
+  }
+
+  // Coordinates are stored in centimeters
+  constexpr std::int16_t scale = -100;
+
+  const std::streamoff trace_size =
+      su_header_size + static_cast<std::streamoff>(nsig_steps) * sizeof(float);
+  std::vector<char> header(su_header_size);
+  std::vector<float> samples(nsamples);
+
+  for (int iorientation = 0; iorientation < filename.size(); iorientation++) {
+    std::fstream seismo_file(filename[iorientation], std::ios::binary |
+                                                         std::ios::in |
+                                                         std::ios::out);
+    if (!seismo_file.is_open()) {
+      std::ostringstream message;
+      message << "Could not open seismogram file " << filename[iorientation];
+      throw std::runtime_error(message.str());
+    }
 
-  switch (this->type) {
-  case specfem::seismogram::format::ascii:
-    // Open stream
     for (int irec = 0; irec < n_receivers; irec++) {
-      std::string network_name = receivers[irec]->get_network_name();
-      std::string station_name = receivers[irec]->get_station_name();
-      for (int isig = 0; isig < nsig_types; isig++) {
-        std::vector<std::string> filename;
-        auto stype = this->compute_receivers->h_seismogram_types(isig);
-        switch (stype) {
-        case specfem::seismogram::displacement:
-          filename = { this->output_folder + "/" + network_name + station_name +
-                           "BXX" + ".semd",
-                       this->output_folder + "/" + network_name + station_name +
-                           "BXZ" + ".semd" };
-          break;
-        case specfem::seismogram::velocity:
-          filename = { this->output_folder + "/" + network_name + station_name +
-                           "BXX" + ".semv",
-                       this->output_folder + "/" + network_name + station_name +
-                           "BXZ" + ".semv" };
-          break;
-        case specfem::seismogram::acceleration:
-          filename = { this->output_folder + "/" + network_name + station_name +
-                           "BXX" + ".sema",
-                       this->output_folder + "/" + network_name + station_name +
-                           "BXZ" + ".sema" };
-          break;
-        default:
-          std::ostringstream message;
-          message << "seismogram type " << stype
-                  << " has not been implemented yet.";
-          throw std::runtime_error(message.str());
-        }
-
-        for (int iorientation = 0; iorientation < filename.size();
-             iorientation++) {
-          std::ofstream seismo_file;
-          seismo_file.open(filename[iorientation]);
-          for (int isig_step = 0; isig_step < nsig_steps; isig_step++) {
-            const type_real time_t =
-                isig_step * dt * nstep_between_samples + t0;
-            const type_real value =
-                h_seismogram(isig_step, isig, irec, iorientation);
-
-            seismo_file << std::scientific << time_t << " " << std::scientific
-                        << value << "\n";
-          }
-          seismo_file.close();
-        }
+      const int itrace = first_trace + irec;
+      if (first == 0) {
+        const std::int32_t x = std::lround(receivers.x[written[irec]] * 100);
+        const std::int32_t z = std::lround(receivers.z[written[irec]] * 100);
+        std::fill(header.begin(), header.end(), 0);
+        set_header<std::int32_t>(header, su_header::tracl, itrace + 1);
+        set_header<std::int32_t>(header, su_header::tracr, itrace + 1);
+        set_header<std::int32_t>(header, su_header::fldr, 1);
+        set_header<std::int32_t>(header, su_header::tracf, itrace + 1);
+        set_header<std::int16_t>(header, su_header::trid, 1);
+        set_header<std::int32_t>(header, su_header::gelev, z);
+        set_header<std::int16_t>(header, su_header::scalel, scale);
+        set_header<std::int16_t>(header, su_header::scalco, scale);
+        set_header<std::int32_t>(header, su_header::gx, x);
+        set_header<std::int16_t>(header, su_header::delrt, delrt_ms);
+        set_header<std::uint16_t>(header, su_header::ns, nsig_steps);
+        set_header<std::uint16_t>(header, su_header::dt, dt_us);
+        seismo_file.seekp(itrace * trace_size);
+        seismo_file.write(header.data(), header.size());
       }
+
+      for (int isample = 0; isample < nsamples; isample++)
+        samples[isample] = buffer(isample, isig, irec, iorientation);
+
+      seismo_file.seekp(itrace * trace_size + su_header_size +
+                        static_cast<std::streamoff>(first) * sizeof(float));
+      seismo_file.write(reinterpret_cast<const char *>(samples.data()),
+                        nsamples * sizeof(float));
+    }
+
+    if (!seismo_file) {
+      std::ostringstream message;
+      message << "Could not write seismogram file " << filename[iorientation];
+      throw std::runtime_error(message.str());
+    }
+  }
+}
+
+// Append samples [first, first + nsamples) to one ASCII file per receiver and
+// component
+template <typename ViewType>
+void write_ascii(const ViewType buffer, const int isig, const int irec,
+                 const std::vector<std::string> &filename, const int first,
+                 const int nsamples, const type_real sample_dt,
+                 const type_real t0) {
+
+  for (int iorientation = 0; iorientation < filename.size(); iorientation++) {
+    std::ofstream seismo_file;
+    seismo_file.open(filename[iorientation],
+                     (first == 0) ? std::ios::trunc : std::ios::app);
+    for (int isample = 0; isample < nsamples; isample++) {
+      const type_real time_t = (first + isample) * sample_dt + t0;
+      const type_real value = buffer(isample, isig, irec, iorientation);
+
+      seismo_file << std::scientific << time_t << " " << std::scientific
+                  << value << "\n";
     }
-    break;
+    seismo_file.close();
+  }
+}
+
+// Extension of files storing seismograms of type stype
+std::string extension(const specfem::seismogram::type stype) {
+  switch (stype) {
+  case specfem::seismogram::displacement:
+    return "d";
+  case specfem::seismogram::velocity:
+    return "v";
+  case specfem::seismogram::acceleration:
+    return "a";
   default:
     std::ostringstream message;
-    message << "seismogram output type " << this->type
-            << " has not been implemented yet.";
+    message << "seismogram type " << stype << " has not been implemented yet.";
     throw std::runtime_error(message.str());
   }
+}
+
+// Name of HDF5 datasets storing seismograms of type stype
+std::string dataset_name(const specfem::seismogram::type stype) {
+  switch (stype) {
+  case specfem::seismogram::displacement:
+    return "displacement";
+  case specfem::seismogram::velocity:
+    return "velocity";
+  case specfem::seismogram::acceleration:
+    return "acceleration";
+  default:
+    std::ostringstream message;
+    message << "seismogram type " << stype << " has not been implemented yet.";
+    throw std::runtime_error(message.str());
+  }
+}
+
+} // namespace
+
+specfem::writer::seismogram::seismogram(
+    const specfem::receivers::receiver_set &receivers,
+    specfem::compute::receivers *compute_receivers,
+    const specfem::seismogram::format::type type,
+    const std::string output_folder, const type_real dt, const type_real t0,
+    const int nstep_between_samples, const specfem::MPI::MPI *mpi,
+    const int compression, const int nwriters)
+    : type(type), output_folder(output_folder),
+      compute_receivers(compute_receivers), receivers(&receivers), dt(dt),
+      t0(t0), nstep_between_samples(nstep_between_samples), mpi(mpi),
+      compression(compression),
+      gathered(mpi != nullptr &&
+               type != specfem::seismogram::format::hdf5) {
+
+  if (!this->gathered) {
+    for (int irec = 0; irec < receivers.size(); irec++)
+      this->written.push_back(irec);
+    return;
+  }
+
+  const int nproc = mpi->get_size();
+  const int rank = mpi->get_rank();
+  const int n_receivers = receivers.size();
+  const int n_writers = std::max(1, std::min(nwriters, nproc));
+
+  // Writer iwriter is spread evenly among ranks and writes a contiguous block
+  // of receivers
+  std::vector<int> destination(n_receivers);
+  for (int iwriter = 0; iwriter < n_writers; iwriter++) {
+    const int writer_rank = iwriter * nproc / n_writers;
+    const int first = iwriter * n_receivers / n_writers;
+    const int last = (iwriter + 1) * n_receivers / n_writers;
+    for (int irec = first; irec < last; irec++)
+      destination[irec] = writer_rank;
+    if (writer_rank == rank) {
+      this->first_written = first;
+      for (int irec = first; irec < last; irec++)
+        this->written.push_back(irec);
+    }
+  }
+
+  // Receivers of this process are stored in the order of the stations,
+  // hence they are sorted by destination
+  this->send_offsets.assign(nproc + 1, 0);
+  for (int irec = 0; irec < n_receivers; irec++) {
+    if (receivers.islice[irec] == rank)
+      this->send_offsets[destination[irec] + 1]++;
+  }
+  for (int irank = 0; irank < nproc; irank++)
+    this->send_offsets[irank + 1] += this->send_offsets[irank];
+
+  // Received receivers are sorted by source rank
+  for (int source = 0; source < nproc; source++) {
+    for (int irec = 0; irec < this->written.size(); irec++) {
+      if (receivers.islice[this->written[irec]] == source)
+        this->recv_order.push_back(irec);
+    }
+  }
+}
+
+specfem::writer::seismogram::~seismogram() {
+  if (this->pending.valid())
+    this->pending.wait();
+}
+
+template <typename ViewType>
+void specfem::writer::seismogram::write_hdf5(const ViewType buffer,
+                                             const int first,
+                                             const int nsamples) {
+
+  const auto &receivers = *this->receivers;
+  const std::size_t n_receivers = receivers.size();
+  const int nsig_types = this->compute_receivers->h_seismogram_types.extent(0);
+  const std::size_t nsig_steps = this->compute_receivers->max_sig_step;
+
+  // Every process creates the datasets, the main process writes the
+  // description of the receivers
+  const std::string filename = this->output_folder + "/seismograms.h5";
+
+  // Samples are appended to the file of a resumed run
+  if (first > 0 && !this->file)
+    this->file = std::make_unique<specfem::writer::hdf5::file>(
+        filename, this->mpi, false);
+
+  if (first == 0) {
+    this->file =
+        std::make_unique<specfem::writer::hdf5::file>(filename, this->mpi);
+
+    // A chunk stores the samples of a flush
+    const std::size_t chunk = this->compute_receivers->seismogram.extent(0);
+    for (int isig = 0; isig < nsig_types; isig++)
+      this->file->create_dataset<type_real>(
+          dataset_name(this->compute_receivers->h_seismogram_types(isig)),
+          { n_receivers, 2, nsig_steps }, { 1, 2, chunk }, this->compression);
+
+    this->file->write_strings("network", receivers.network_names);
+    this->file->write_strings("station", receivers.station_names);
+
+    const bool main_proc = (this->mpi == nullptr) || this->mpi->main_proc();
+    std::vector<std::vector<std::size_t> > offsets;
+    if (main_proc && n_receivers > 0)
+      offsets.push_back({ 0 });
+    for (const auto &[name, values] : { std::make_pair("x", &receivers.x),
+                                        std::make_pair("z", &receivers.z) }) {
+      this->file->create_dataset<type_real>(name, { n_receivers },
+                                            { n_receivers });
+      this->file->write<type_real>(name, offsets, { n_receivers },
+                                   values->data());
+    }
+
+    this->file->write_attribute<type_real>(
+        "dt", this->dt * this->nstep_between_samples *
+                  this->compute_receivers->decimation);
+    this->file->write_attribute<type_real>("t0", this->t0);
+    this->file->write_attribute<int>("nstep_between_samples",
+                                     this->nstep_between_samples);
+    this->file->write_attribute<int>("decimation",
+                                     this->compute_receivers->decimation);
+  }
+
+  // Receivers of this process are stored in the order of the stations
+  std::vector<std::vector<std::size_t> > offsets;
+  for (int irec = 0; irec < n_receivers; irec++) {
+    if (this->mpi == nullptr ||
+        receivers.islice[irec] == this->mpi->get_rank())
+      offsets.push_back({ static_cast<std::size_t>(irec), 0,
+                          static_cast<std::size_t>(first) });
+  }
+
+  std::vector<type_real> values(offsets.size() * 2 * nsamples);
+  for (int isig = 0; isig < nsig_types; isig++) {
+    for (int irec = 0; irec < offsets.size(); irec++)
+      for (int iorientation = 0; iorientation < 2; iorientation++)
+        for (int isample = 0; isample < nsamples; isample++)
+          values[(irec * 2 + iorientation) * nsamples + isample] =
+              buffer(isample, isig, irec, iorientation);
+
+    this->file->write<type_real>(
+        dataset_name(this->compute_receivers->h_seismogram_types(isig)),
+        offsets, { 1, 2, static_cast<std::size_t>(nsamples) },
+        values.data());
+  }
+}
+
+template <typename ViewType>
+specfem::kokkos::HostView4d<type_real>
+specfem::writer::seismogram::gather(const ViewType buffer,
+                                    const int nsamples) const {
+
+  const int nsig_types = buffer.extent(1);
+  const int n_local = buffer.extent(2);
+  // Values sent for every receiver
+  const int nvalues = nsig_types * 2 * nsamples;
+
+  specfem::kokkos::HostView1d<type_real> svalues(
+      Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                         "specfem::writer::seismogram::svalues"),
+      n_local * nvalues);
+  for (int irec = 0; irec < n_local; irec++)
+    for (int isig = 0; isig < nsig_types; isig++)
+      for (int iorientation = 0; iorientation < 2; iorientation++)
+        for (int isample = 0; isample < nsamples; isample++)
+          svalues(((irec * nsig_types + isig) * 2 + iorientation) * nsamples +
+                  isample) = buffer(isample, isig, irec, iorientation);
+
+  std::vector<int> send_offsets(this->send_offsets.size());
+  for (int irank = 0; irank < send_offsets.size(); irank++)
+    send_offsets[irank] = this->send_offsets[irank] * nvalues;
+  std::vector<int> recv_offsets;
+  const auto rvalues =
+      this->mpi->all_to_allv(svalues, send_offsets, recv_offsets);
+
+  specfem::kokkos::HostView4d<type_real> samples(
+      Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                         "specfem::writer::seismogram::gathered"),
+      nsamples, nsig_types, this->written.size(), 2);
+  for (int i = 0; i < this->recv_order.size(); i++) {
+    const int irec = this->recv_order[i];
+    for (int isig = 0; isig < nsig_types; isig++)
+      for (int iorientation = 0; iorientation < 2; iorientation++)
+        for (int isample = 0; isample < nsamples; isample++)
+          samples(isample, isig, irec, iorientation) =
+              rvalues(((i * nsig_types + isig) * 2 + iorientation) * nsamples +
+                      isample);
+  }
+
+  return samples;
+}
+
+void specfem::writer::seismogram::create_files() const {
+
+  if (this->type != specfem::seismogram::format::seismic_unix)
+    return;
+
+  const int nsig_types = this->compute_receivers->h_seismogram_types.extent(0);
+  if (this->mpi == nullptr || this->mpi->main_proc()) {
+    for (int isig = 0; isig < nsig_types; isig++) {
+      const auto stype = this->compute_receivers->h_seismogram_types(isig);
+      for (const auto &filename :
+           su_filenames(this->output_folder, extension(stype)))
+        std::ofstream(filename, std::ios::binary | std::ios::trunc);
+    }
+  }
+
+  // Writers open the files once they are truncated
+  if (this->mpi)
+    this->mpi->sync_all();
+}
+
+template <typename ViewType>
+void specfem::writer::seismogram::write_samples(const ViewType buffer,
+                                                const int first,
+                                                const int nsamples) {
+
+  if (this->type == specfem::seismogram::format::hdf5) {
+    this->write_hdf5(buffer, first, nsamples);
+    return;
+  }
+
+  const int n_receivers = this->written.size();
+  const int nsig_types = this->compute_receivers->h_seismogram_types.extent(0);
+  const type_real sample_dt = this->dt * this->nstep_between_samples *
+                              this->compute_receivers->decimation;
+
+  for (int isig = 0; isig < nsig_types; isig++) {
+    const auto stype = this->compute_receivers->h_seismogram_types(isig);
+    const std::string ext = extension(stype);
+
+    switch (this->type) {
+    case specfem::seismogram::format::ascii:
+      for (int irec = 0; irec < n_receivers; irec++) {
+        const int istation = this->written[irec];
+        const std::string &network_name =
+            this->receivers->network_names[istation];
+        const std::string &station_name =
+            this->receivers->station_names[istation];
+        const std::string prefix =
+            this->output_folder + "/" + network_name + station_name;
+        write_ascii(buffer, isig, irec,
+                    { prefix + "BXX" + ".sem" + ext,
+                      prefix + "BXZ" + ".sem" + ext },
+                    first, nsamples, sample_dt, this->t0);
+      }
+      break;
+    case specfem::seismogram::format::seismic_unix:
+      write_seismic_unix(*this->receivers, this->written, this->first_written,
+                         buffer, isig, su_filenames(this->output_folder, ext),
+                         first, nsamples,
+                         this->compute_receivers->max_sig_step, sample_dt,
+                         this->t0);
+      break;
+    default:
+      std::ostringstream message;
+      message << "seismogram output type " << this->type
+              << " has not been implemented yet.";
+      throw std::runtime_error(message.str());
+    }
+  }
+}
+
+void specfem::writer::seismogram::wait() {
+  if (this->pending.valid())
+    this->pending.get();
+}
+
+void specfem::writer::seismogram::resume(const int nflushed) {
+  if (nflushed > 0 && this->type == specfem::seismogram::format::ascii) {
+    throw std::runtime_error("ASCII seismograms flushed during the time loop "
+                             "can't be resumed");
+  }
+  this->nflushed = nflushed;
+}
+
+void specfem::writer::seismogram::sample(
+    const int isig_step, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const int nslots = this->compute_receivers->seismogram.extent(0);
+
+  // Every sample is stored on the device
+  if (nslots >= this->compute_receivers->max_sig_step)
+    return;
+
+  // Decimated seismograms aren't written at every recorded sample
+  const int isample = this->compute_receivers->written_sample(isig_step);
+  if (isample >= 0 && isample + 1 - this->nflushed == nslots)
+    this->flush(nslots, exec_space);
+}
+
+void specfem::writer::seismogram::flush(
+    const int nsamples, const specfem::kokkos::DevExecSpace &exec_space) {
+
+  const auto d_seismogram = this->compute_receivers->seismogram;
+  auto &buffer = this->staging[this->iflush % 2];
+  if (!buffer.is_allocated()) {
+    buffer = specfem::kokkos::HostPinnedView4d<type_real,
+                                               specfem::kokkos::ReceiverLayout>(
+        Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                           "specfem::writer::seismogram::staging"),
+        d_seismogram.extent(0), d_seismogram.extent(1),
+        d_seismogram.extent(2), d_seismogram.extent(3));
+  }
+
+  // The buffer is overwritten by the next samples once the copy completes.
+  // The other staging buffer may still be written to file
+  Kokkos::deep_copy(exec_space, buffer, d_seismogram);
+  exec_space.fence();
+
+  // Samples are appended in order. Rethrows errors of the previous write
+  if (this->pending.valid())
+    this->pending.get();
+
+  const int first = this->nflushed;
+  if (first == 0)
+    this->create_files();
+
+  // Collectives are completed by the calling thread
+  const auto staged = buffer;
+  if (this->type == specfem::seismogram::format::hdf5) {
+    this->write_samples(staged, first, nsamples);
+  } else if (this->gathered) {
+    const auto samples = this->gather(staged, nsamples);
+    this->pending = std::async(std::launch::async, [this, samples, first,
+                                                    nsamples]() {
+      this->write_samples(samples, first, nsamples);
+    });
+  } else {
+    this->pending = std::async(std::launch::async, [this, staged, first,
+                                                    nsamples]() {
+      this->write_samples(staged, first, nsamples);
+    });
+  }
+
+  this->nflushed += nsamples;
+  this->iflush++;
+}
+
+void specfem::writer::seismogram::write() {
+
+  const int nslots = this->compute_receivers->seismogram.extent(0);
+  const int max_sig_step = this->compute_receivers->max_sig_step;
+
+  std::cout << "output folder : " << this->output_folder << "\n";
+
+  if (nslots >= max_sig_step) {
+    this->compute_receivers->sync_seismograms();
+    this->create_files();
+    if (this->gathered) {
+      this->write_samples(
+          this->gather(this->compute_receivers->h_seismogram, max_sig_step), 0,
+          max_sig_step);
+    } else {
+      this->write_samples(this->compute_receivers->h_seismogram, 0,
+                          max_sig_step);
+    }
+  } else {
+    // Samples computed since the last flush
+    if (this->nflushed < max_sig_step)
+      this->flush(max_sig_step - this->nflushed,
+                  specfem::kokkos::DevExecSpace());
+    if (this->pending.valid())
+      this->pending.get();
+  }
+
+  // Close the HDF5 file
+  this->file.reset();
 
   std::cout << std::endl;
 }
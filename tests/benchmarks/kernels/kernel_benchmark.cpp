@@ -0,0 +1,441 @@
+#include "../../../include/binding.h"
+#include "../../../include/compute.h"
+#include "../../../include/config.h"
+#include "../../../include/courant.h"
+#include "../../../include/domain.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/material.h"
+#include "../../../include/mesh.h"
+#include "../../../include/mesher.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/receiver.h"
+#include "../../../include/source.h"
+#include "../../../include/specfem_mpi.h"
+#include "../../../include/timers.h"
+#include "../../../include/timescheme.h"
+#include "../../../include/utils.h"
+#include "yaml-cpp/yaml.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <array>
+#include <boost/program_options.hpp>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// Microbenchmarks of the domain and timescheme kernels on synthetic elastic
+// meshes
+
+namespace {
+
+/**
+ * @brief Measured rate of a kernel for one configuration
+ *
+ */
+struct result {
+  std::string kernel;         ///< Name of the kernel
+  int ngll;                   ///< Number of GLL points in every direction
+  int nspec;                  ///< Number of elements
+  int nsources;               ///< Number of sources
+  int nreceivers;             ///< Number of receivers
+  double seconds;             ///< Time of a call
+  double items;               ///< Items processed by a call
+  std::string unit;           ///< Name of the items
+  specfem::timers::cost cost; ///< Modelled bytes and flops of a call
+};
+
+// Comma separated list of positive integers
+std::vector<int> parse_list(const std::string &list) {
+  std::vector<int> values;
+  std::istringstream stream(list);
+  std::string value;
+  while (std::getline(stream, value, ',')) {
+    const int n = std::stoi(value);
+    if (n < 1)
+      throw std::runtime_error("Benchmark sizes need to be positive: " + list);
+    values.push_back(n);
+  }
+  if (values.empty())
+    throw std::runtime_error("Empty benchmark size list");
+  return values;
+}
+
+// Mean time of a call, after a warm-up call
+double time_kernel(const std::function<void()> &kernel, const int repeats) {
+  kernel();
+  Kokkos::fence();
+  Kokkos::Timer timer;
+  for (int i = 0; i < repeats; i++)
+    kernel();
+  Kokkos::fence();
+  return timer.seconds() / repeats;
+}
+
+// Points of a k x k grid covering the interior of the mesh, k being the
+// smallest integer such that k * k >= n
+std::vector<std::array<type_real, 2> >
+grid_points(const int n, const type_real size_x, const type_real size_z) {
+  const int k = std::ceil(std::sqrt(static_cast<double>(n)));
+  std::vector<std::array<type_real, 2> > points;
+  for (int i = 0; i < n; i++) {
+    const type_real x = size_x * ((i % k) + 0.5) / k;
+    const type_real z = size_z * ((i / k) + 0.5) / k;
+    points.push_back({ x, z });
+  }
+  return points;
+}
+
+boost::program_options::options_description define_args() {
+  namespace po = boost::program_options;
+
+  po::options_description desc{ "======================================\n"
+                                "-------SPECFEM kernel benchmark-------\n"
+                                "======================================" };
+
+  desc.add_options()("help,h", "Print this help message")(
+      "ngll", po::value<std::string>()->default_value("5"),
+      "Comma separated numbers of GLL points in every direction")(
+      "nspec", po::value<std::string>()->default_value("4096,65536"),
+      "Comma separated numbers of elements. Meshes are the squares with the "
+      "closest number of elements")(
+      "nsources", po::value<std::string>()->default_value("1,64"),
+      "Comma separated numbers of sources")(
+      "nreceivers", po::value<std::string>()->default_value("1,64"),
+      "Comma separated numbers of receivers")(
+      "repeats", po::value<int>()->default_value(100),
+      "Number of timed calls of every kernel");
+
+  return desc;
+}
+
+std::string print_results(const std::vector<result> &results,
+                          const int repeats) {
+  std::ostringstream message;
+  message << "\n================================================\n"
+          << "             Kernel benchmark\n"
+          << "================================================\n\n"
+          << "Timed calls per kernel : " << repeats << "\n"
+          << "Bandwidth : bytes of the fields, mesh arrays and properties\n"
+          << "            read or written once per call\n"
+          << "Flop rate : operations of the reference algorithm\n"
+          << "------------------------------------------------\n"
+          << std::left << std::setw(22) << "Kernel" << std::right
+          << std::setw(6) << "NGLL" << std::setw(10) << "Elements"
+          << std::setw(9) << "Sources" << std::setw(11) << "Receivers"
+          << std::setw(14) << "Time (us)" << std::setw(14) << "Rate (1/s)"
+          << std::setw(10) << "GB/s" << std::setw(10) << "GFLOP/s"
+          << "  Items\n";
+  for (const auto &r : results) {
+    message << std::left << std::setw(22) << r.kernel << std::right
+            << std::setw(6) << r.ngll << std::setw(10) << r.nspec
+            << std::setw(9) << r.nsources << std::setw(11) << r.nreceivers
+            << std::fixed << std::setprecision(2) << std::setw(14)
+            << 1e6 * r.seconds << std::scientific << std::setprecision(3)
+            << std::setw(14) << r.items / r.seconds << std::fixed
+            << std::setprecision(2) << std::setw(10)
+            << 1e-9 * r.cost.bytes / r.seconds << std::setw(10)
+            << 1e-9 * r.cost.flops / r.seconds << "  " << r.unit << "\n";
+  }
+  message << "------------------------------------------------\n";
+
+  return message.str();
+}
+
+// Time of the element kernels and of the assembled matrix for every mesh and
+// number of GLL points, and the smallest number of GLL points from which the
+// element kernels are faster
+std::string print_crossover(const std::vector<result> &results) {
+  // (nspec, ngll) -> first measured time of both stiffness paths
+  std::vector<std::array<double, 4> > times;
+  for (const auto &r : results) {
+    const bool assembled = (r.kernel == "Assembled stiffness");
+    if (!assembled && r.kernel != "Stiffness")
+      continue;
+    auto entry = std::find_if(times.begin(), times.end(), [&r](const auto &t) {
+      return t[0] == r.nspec && t[1] == r.ngll;
+    });
+    if (entry == times.end()) {
+      times.push_back({ static_cast<double>(r.nspec),
+                        static_cast<double>(r.ngll), -1.0, -1.0 });
+      entry = times.end() - 1;
+    }
+    double &time = (*entry)[assembled ? 3 : 2];
+    if (time < 0.0)
+      time = r.seconds;
+  }
+  std::sort(times.begin(), times.end());
+
+  std::ostringstream message;
+  message << "\nStiffness interaction : element kernels and assembled matrix\n"
+          << "------------------------------------------------\n"
+          << std::setw(10) << "Elements" << std::setw(6) << "NGLL"
+          << std::setw(16) << "Elements (us)" << std::setw(17)
+          << "Assembled (us)" << "  Faster\n";
+  for (const auto &t : times) {
+    message << std::setw(10) << static_cast<int>(t[0]) << std::setw(6)
+            << static_cast<int>(t[1]) << std::fixed << std::setprecision(2)
+            << std::setw(16) << 1e6 * t[2] << std::setw(17) << 1e6 * t[3]
+            << "  " << ((t[3] < t[2]) ? "assembled" : "elements") << "\n";
+  }
+
+  // Crossover of every mesh
+  for (int i = 0; i < times.size(); i++) {
+    if (i > 0 && times[i][0] == times[i - 1][0])
+      continue;
+    int crossover = -1;
+    for (int j = i; j < times.size() && times[j][0] == times[i][0]; j++) {
+      if (times[j][2] <= times[j][3]) {
+        crossover = static_cast<int>(times[j][1]);
+        break;
+      }
+    }
+    message << "Crossover for " << static_cast<int>(times[i][0])
+            << " elements : ";
+    if (crossover > 0)
+      message << "element kernels are faster from NGLL = " << crossover
+              << "\n";
+    else
+      message << "assembled matrix is faster for every NGLL measured\n";
+  }
+  message << "------------------------------------------------\n";
+
+  return message.str();
+}
+
+void benchmark(specfem::mesh &mesh, specfem::material *material,
+               const int ngll, const int nsources, const int nreceivers,
+               const int repeats, specfem::MPI::MPI *mpi,
+               std::vector<result> &results) {
+
+  specfem::quadrature::quadrature gllx(0.0, 0.0, ngll);
+  specfem::quadrature::quadrature gllz(0.0, 0.0, ngll);
+  std::vector<specfem::material *> materials = { material };
+
+  specfem::compute::compute compute(mesh.coorg, mesh.material_ind.knods, gllx,
+                                    gllz);
+  specfem::compute::partial_derivatives partial_derivatives(
+      mesh.coorg, mesh.material_ind.knods, gllx, gllz);
+  specfem::compute::properties material_properties(mesh.material_ind.kmato,
+                                                   materials, mesh.nspec,
+                                                   gllx.get_N(), gllz.get_N());
+
+  const auto stable_timestep = specfem::courant::compute_stable_timestep(
+      compute.coordinates.coord, compute.h_ibool, material_properties.h_rho,
+      material_properties.rho_vp, material_properties.rho_vs);
+  const type_real dt = stable_timestep.dt;
+
+  const type_real xmax = compute.coordinates.xmax;
+  const type_real xmin = compute.coordinates.xmin;
+  const type_real zmax = compute.coordinates.zmax;
+  const type_real zmin = compute.coordinates.zmin;
+
+  // Force sources and receivers on regular grids covering the mesh
+  std::vector<specfem::sources::source *> sources;
+  for (const auto &[x, z] : grid_points(nsources, xmax - xmin, zmax - zmin)) {
+    YAML::Node node;
+    node["x"] = xmin + x;
+    node["z"] = zmin + z;
+    node["source_surf"] = false;
+    node["angle"] = 0.0;
+    node["vx"] = 0.0;
+    node["vz"] = 0.0;
+    node["Dirac"]["factor"] = 1e10;
+    node["Dirac"]["tshift"] = 0.0;
+    sources.push_back(new specfem::sources::force(node, dt));
+  }
+  specfem::sources::locate(sources, compute.coordinates.coord, compute.h_ibool,
+                           gllx.get_hxi(), gllz.get_hxi(), mesh.coorg,
+                           mesh.material_ind.knods,
+                           material_properties.h_ispec_type, mpi);
+
+  specfem::receivers::receiver_set receivers;
+  int irec = 0;
+  for (const auto &[x, z] :
+       grid_points(nreceivers, xmax - xmin, zmax - zmin)) {
+    receivers.add("BM", "S" + std::to_string(irec++), xmin + x, zmin + z);
+  }
+  receivers.locate(compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
+                   gllz.get_hxi(), mesh.coorg, mesh.material_ind.knods, mpi);
+
+  // Every timed call of the seismogram kernel records its own sample
+  specfem::TimeScheme::Newmark it(repeats + 1, -1.0 * sources[0]->get_t0(),
+                                  dt, 1);
+
+  specfem::compute::sources compute_sources(sources, gllx, gllz, xmax, xmin,
+                                            zmax, zmin, mpi,
+                                            specfem::wave::p_sv);
+  specfem::compute::receivers compute_receivers(
+      receivers, { specfem::seismogram::displacement }, gllx, gllz, xmax, xmin,
+      zmax, zmin, it.get_max_seismogram_step(), mpi);
+
+  const int nglob = specfem::utilities::compute_nglob(compute.h_ibool);
+  specfem::Domain::Elastic domain(
+      ndim, nglob, &compute, &material_properties, &partial_derivatives,
+      &compute_sources, &compute_receivers, &gllx, &gllz);
+
+  compute_sources.tabulate_stf(it.get_time(), dt, it.get_max_timestep() + 2);
+
+  const specfem::kokkos::DevExecSpace exec_space;
+  const double nspec = mesh.nspec;
+  const double real = sizeof(type_real);
+
+  // Costs of the kernels of the time loop are the models reported by the
+  // performance summary of a run
+  const double stiffness_seconds = time_kernel(
+      [&]() { domain.compute_stiffness_interaction(exec_space); }, repeats);
+  results.push_back({ "Stiffness", ngll, mesh.nspec, nsources, nreceivers,
+                      stiffness_seconds, nspec, "elements",
+                      domain.get_cost(specfem::timers::stiffness) });
+
+  // Same interaction applied as a sparse matrix assembled at setup
+  {
+    specfem::Domain::options options;
+    options.assembled_operator = true;
+    specfem::Domain::Elastic assembled(
+        ndim, nglob, &compute, &material_properties, &partial_derivatives,
+        &compute_sources, &compute_receivers, &gllx, &gllz, options);
+    const double assembled_seconds = time_kernel(
+        [&]() { assembled.compute_stiffness_interaction(exec_space); },
+        repeats);
+    results.push_back({ "Assembled stiffness", ngll, mesh.nspec, nsources,
+                        nreceivers, assembled_seconds, nspec, "elements",
+                        assembled.get_cost(specfem::timers::stiffness) });
+  }
+
+  // Point kernels read and write every component of the global fields
+  const double mass_seconds = time_kernel(
+      [&]() { domain.divide_mass_matrix(exec_space); }, repeats);
+  results.push_back({ "Mass matrix division", ngll, mesh.nspec, nsources,
+                      nreceivers, mass_seconds, nspec, "elements",
+                      { nglob * (2 * ndim + 1) * real,
+                        static_cast<double>(nglob * ndim) } });
+
+  const double predictor_seconds = time_kernel(
+      [&]() { it.apply_predictor_phase(&domain, exec_space); }, repeats);
+  results.push_back({ "Newmark predictor", ngll, mesh.nspec, nsources,
+                      nreceivers, predictor_seconds, nspec, "elements",
+                      it.get_cost(specfem::timers::predictor, &domain) });
+
+  const double corrector_seconds = time_kernel(
+      [&]() { it.apply_corrector_phase(&domain, exec_space); }, repeats);
+  results.push_back({ "Newmark corrector", ngll, mesh.nspec, nsources,
+                      nreceivers, corrector_seconds, nspec, "elements",
+                      { nglob * 3 * ndim * real,
+                        2.0 * nglob * ndim } });
+
+  const type_real timeval = it.get_time();
+  const double source_seconds = time_kernel(
+      [&]() { domain.compute_source_interaction(timeval, exec_space); },
+      repeats);
+  results.push_back({ "Source interaction", ngll, mesh.nspec, nsources,
+                      nreceivers, source_seconds,
+                      static_cast<double>(nsources), "sources",
+                      domain.get_cost(specfem::timers::sources) });
+
+  int isig_step = 0;
+  const double seismogram_seconds = time_kernel(
+      [&]() {
+        domain.compute_seismogram(isig_step, exec_space);
+        isig_step = (isig_step + 1) % (repeats + 1);
+      },
+      repeats);
+  results.push_back({ "Seismograms", ngll, mesh.nspec, nsources, nreceivers,
+                      seismogram_seconds, static_cast<double>(nreceivers),
+                      "receivers",
+                      domain.get_cost(specfem::timers::seismograms) });
+
+  for (auto &source : sources) {
+    delete source;
+  }
+
+  return;
+}
+
+void execute(const std::vector<int> &ngll_list,
+             const std::vector<int> &nspec_list,
+             const std::vector<int> &nsources_list,
+             const std::vector<int> &nreceivers_list, const int repeats,
+             specfem::MPI::MPI *mpi) {
+
+  const type_real element_size = 100.0;
+  std::vector<result> results;
+
+  for (const int nspec : nspec_list) {
+    // Square mesh of a homogeneous elastic medium without attenuation
+    const int n = std::max(1, static_cast<int>(std::lround(
+                                  std::sqrt(static_cast<double>(nspec)))));
+    specfem::mesher::layered_model model;
+    model.xmin = 0.0;
+    model.xmax = n * element_size;
+    model.zmin = 0.0;
+    model.nx = n;
+    specfem::mesher::layer layer;
+    layer.nz = n;
+    layer.top = { { 0.0, n * element_size } };
+    layer.rho = 2700.0;
+    layer.vp = 3000.0;
+    layer.vs = 1732.0;
+    model.layers = { layer };
+
+    std::vector<specfem::material *> materials;
+    auto mesh = specfem::mesher::generate(model, materials, mpi);
+
+    for (const int ngll : ngll_list) {
+      for (const int nsources : nsources_list) {
+        for (const int nreceivers : nreceivers_list) {
+          benchmark(mesh, materials[0], ngll, nsources, nreceivers, repeats,
+                    mpi, results);
+        }
+      }
+    }
+
+    for (auto &material : materials) {
+      delete material;
+    }
+  }
+
+  mpi->cout(print_results(results, repeats));
+  mpi->cout(print_crossover(results));
+
+  return;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+
+  // Initialize MPI
+  specfem::MPI::MPI *mpi = new specfem::MPI::MPI(&argc, &argv);
+  // Initialize Kokkos on the device and cores assigned to this process
+  const auto binding = specfem::binding::initialize(argc, argv, mpi);
+  mpi->cout(specfem::binding::print(binding, mpi));
+  {
+    const auto desc = define_args();
+    boost::program_options::variables_map vm;
+    boost::program_options::store(
+        boost::program_options::parse_command_line(argc, argv, desc), vm);
+
+    if (vm.count("help")) {
+      std::ostringstream help;
+      help << desc;
+      mpi->cout(help.str());
+    } else if (mpi->get_size() > 1) {
+      mpi->cout("Kernels are benchmarked on a single process. Use "
+                "scaling_benchmark for MPI runs");
+    } else {
+      execute(parse_list(vm["ngll"].as<std::string>()),
+              parse_list(vm["nspec"].as<std::string>()),
+              parse_list(vm["nsources"].as<std::string>()),
+              parse_list(vm["nreceivers"].as<std::string>()),
+              vm["repeats"].as<int>(), mpi);
+    }
+  }
+  // Finalize Kokkos
+  Kokkos::finalize();
+  // Finalize MPI
+  delete mpi;
+  return 0;
+}
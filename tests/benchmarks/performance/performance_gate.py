@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""Performance regression gate.
+
+Runs a benchmark command, extracts its throughput metrics and compares them
+against the baseline of this machine. A metric regresses when it is lower
+than (1 - tolerance) times its baseline. With --update the measured metrics
+replace the baseline instead.
+
+Metrics of kernel_benchmark are the rates of every kernel and configuration.
+The metric of specfem2d is the number of timesteps per second of the time
+loop, read from the performance summary of the run.
+"""
+
+import argparse
+import json
+import os
+import re
+import socket
+import subprocess
+import sys
+
+# Row of the kernel_benchmark table
+KERNEL_ROW = re.compile(
+    r"^(?P<kernel>\S.{0,21}?)\s+(?P<ngll>\d+)\s+(?P<nspec>\d+)\s+"
+    r"(?P<nsources>\d+)\s+(?P<nreceivers>\d+)\s+(?P<time>[0-9.]+)\s+"
+    r"(?P<rate>[0-9.eE+-]+)\s+(?P<bandwidth>[0-9.]+)\s+(?P<flops>[0-9.]+)\s+"
+    r"\w+$"
+)
+
+# Time loop phase of the specfem2d performance summary
+TIME_LOOP = re.compile(r"^- Time loop : mean = (?P<mean>[0-9.]+),")
+
+
+def kernel_metrics(output):
+    metrics = {}
+    for line in output.splitlines():
+        match = KERNEL_ROW.match(line.rstrip())
+        if not match:
+            continue
+        key = "{} ngll={} nspec={} nsources={} nreceivers={}".format(
+            match["kernel"].strip(),
+            match["ngll"],
+            match["nspec"],
+            match["nsources"],
+            match["nreceivers"],
+        )
+        metrics[key] = float(match["rate"])
+    return metrics
+
+
+def simulation_metrics(output, nstep):
+    for line in output.splitlines():
+        match = TIME_LOOP.match(line.strip())
+        if match:
+            return {"Time loop steps per second": nstep / float(match["mean"])}
+    return {}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--name", required=True, help="Name of the benchmark")
+    parser.add_argument(
+        "--kind", required=True, choices=["kernels", "simulation"]
+    )
+    parser.add_argument(
+        "--baseline-dir", required=True, help="Folder of the baseline files"
+    )
+    parser.add_argument("--tolerance", type=float, default=0.1)
+    parser.add_argument(
+        "--nstep", type=int, default=0, help="Timesteps of the simulation"
+    )
+    parser.add_argument("--update", action="store_true")
+    parser.add_argument("command", nargs=argparse.REMAINDER)
+    args = parser.parse_args()
+
+    command = args.command[1:] if args.command[:1] == ["--"] else args.command
+    run = subprocess.run(
+        command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True
+    )
+    if run.returncode != 0:
+        print(run.stdout)
+        print("FAILED : {} exited with {}".format(command[0], run.returncode))
+        return 1
+
+    if args.kind == "kernels":
+        measured = kernel_metrics(run.stdout)
+    else:
+        measured = simulation_metrics(run.stdout, args.nstep)
+    if not measured:
+        print(run.stdout)
+        print("FAILED : no metric found in the output of " + command[0])
+        return 1
+
+    # Every machine stores its own baselines
+    machine = os.environ.get(
+        "SPECFEM_PERFORMANCE_MACHINE", socket.gethostname()
+    )
+    filename = os.path.join(args.baseline_dir, machine + ".json")
+    baselines = {}
+    if os.path.exists(filename):
+        with open(filename) as f:
+            baselines = json.load(f)
+
+    if args.update:
+        baselines[args.name] = measured
+        os.makedirs(args.baseline_dir, exist_ok=True)
+        with open(filename, "w") as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("Updated {} baselines of {} in {}".format(
+            len(measured), args.name, filename))
+        return 0
+
+    if args.name not in baselines:
+        print("FAILED : {} has no baseline for {}. Build the "
+              "update_performance_baselines target to record it".format(
+                  filename, args.name))
+        return 1
+
+    baseline = baselines[args.name]
+    regressions = []
+    print("{:<60} {:>14} {:>14} {:>8}".format(
+        "Metric", "Baseline", "Measured", "Ratio"))
+    for key in sorted(baseline):
+        if key not in measured:
+            regressions.append(key + " : not measured")
+            continue
+        ratio = measured[key] / baseline[key]
+        print("{:<60} {:>14.4g} {:>14.4g} {:>8.3f}".format(
+            key, baseline[key], measured[key], ratio))
+        if ratio < 1.0 - args.tolerance:
+            regressions.append("{} : {:.1f} % slower than the baseline".format(
+                key, 100.0 * (1.0 - ratio)))
+    for key in sorted(set(measured) - set(baseline)):
+        print("{:<60} {:>14} {:>14.4g}".format(key, "-", measured[key]))
+
+    if regressions:
+        print("\n" + "=" * 60)
+        print("PERFORMANCE REGRESSION in {} (tolerance {:.0f} %)".format(
+            args.name, 100.0 * args.tolerance))
+        print("=" * 60)
+        for regression in regressions:
+            print("- " + regression)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,405 @@
+#include "../../../include/binding.h"
+#include "../../../include/compute.h"
+#include "../../../include/config.h"
+#include "../../../include/courant.h"
+#include "../../../include/domain.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/material.h"
+#include "../../../include/mesh.h"
+#include "../../../include/mpi_interfaces.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/receiver.h"
+#include "../../../include/solver.h"
+#include "../../../include/source.h"
+#include "../../../include/specfem_mpi.h"
+#include "../../../include/timescheme.h"
+#include "../../../include/utils.h"
+#include "yaml-cpp/yaml.h"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <array>
+#include <boost/program_options.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+// MPI weak and strong scaling benchmark on synthetic elastic meshes
+
+namespace {
+
+/**
+ * @brief Block of a structured mesh assigned to a rank
+ *
+ */
+struct block {
+  int px, pz;         ///< Number of blocks in x and z
+  int ix, iz;         ///< Position of the block of this rank
+  int ex, ez;         ///< First global element of the block in x and z
+  int nx, nz;         ///< Number of elements of the block in x and z
+  int nx_global = 0;  ///< Number of elements of the mesh in x
+  int nz_global = 0;  ///< Number of elements of the mesh in z
+};
+
+// Split n elements into nparts contiguous ranges differing by at most one
+// element. Returns the first element and the size of range ipart
+std::pair<int, int> split(const int n, const int nparts, const int ipart) {
+  const int size = n / nparts;
+  const int remainder = n % nparts;
+  const int first = ipart * size + std::min(ipart, remainder);
+  return { first, size + (ipart < remainder ? 1 : 0) };
+}
+
+/**
+ * @brief Decompose the mesh into a px x pz grid of blocks, px <= pz being the
+ * most square factorization of the number of ranks
+ *
+ * @param weak If true nx x nz elements are assigned to every rank, otherwise
+ * the nx x nz mesh is split between ranks
+ */
+block decompose(const bool weak, const int nx, const int nz,
+                const specfem::MPI::MPI *mpi) {
+  const int nproc = mpi->get_size();
+  const int rank = mpi->get_rank();
+
+  block b;
+  b.px = 1;
+  for (int p = 1; p * p <= nproc; p++) {
+    if (nproc % p == 0)
+      b.px = p;
+  }
+  b.pz = nproc / b.px;
+  b.ix = rank % b.px;
+  b.iz = rank / b.px;
+
+  b.nx_global = weak ? nx * b.px : nx;
+  b.nz_global = weak ? nz * b.pz : nz;
+
+  if (b.nx_global < b.px || b.nz_global < b.pz) {
+    std::ostringstream message;
+    message << "The " << b.nx_global << " x " << b.nz_global
+            << " mesh can't be split into " << b.px << " x " << b.pz
+            << " blocks";
+    throw std::runtime_error(message.str());
+  }
+
+  std::tie(b.ex, b.nx) = split(b.nx_global, b.px, b.ix);
+  std::tie(b.ez, b.nz) = split(b.nz_global, b.pz, b.iz);
+
+  return b;
+}
+
+/**
+ * @brief Generate the elements of a block
+ *
+ * Elements are squares using 4 control nodes. MPI interfaces with the 8
+ * neighboring blocks are stored as in databases such that the halo is
+ * constructed as for meshes generated by MESHFEM
+ *
+ * @param b Block of this rank
+ * @param size Size of the elements
+ */
+specfem::mesh block_mesh(const block &b, const type_real size) {
+  specfem::mesh mesh;
+  mesh.nspec = b.nx * b.nz;
+  mesh.npgeo = (b.nx + 1) * (b.nz + 1);
+  mesh.nproc = b.px * b.pz;
+
+  const auto node = [&b](const int jx, const int jz) {
+    return jz * (b.nx + 1) + jx;
+  };
+  const auto element = [&b](const int jx, const int jz) {
+    return jz * b.nx + jx;
+  };
+
+  mesh.coorg = specfem::kokkos::HostView2d<type_real>(
+      "scaling_benchmark::coorg", ndim, mesh.npgeo);
+  for (int jz = 0; jz <= b.nz; jz++) {
+    for (int jx = 0; jx <= b.nx; jx++) {
+      mesh.coorg(0, node(jx, jz)) = (b.ex + jx) * size;
+      mesh.coorg(1, node(jx, jz)) = (b.ez + jz) * size;
+    }
+  }
+
+  mesh.material_ind = specfem::materials::material_ind(mesh.nspec, 4);
+  for (int jz = 0; jz < b.nz; jz++) {
+    for (int jx = 0; jx < b.nx; jx++) {
+      const int ispec = element(jx, jz);
+      mesh.material_ind.kmato(ispec) = 0;
+      mesh.material_ind.region_CPML(ispec) = 0;
+      mesh.material_ind.knods(0, ispec) = node(jx, jz);
+      mesh.material_ind.knods(1, ispec) = node(jx + 1, jz);
+      mesh.material_ind.knods(2, ispec) = node(jx + 1, jz + 1);
+      mesh.material_ind.knods(3, ispec) = node(jx, jz + 1);
+    }
+  }
+
+  // Interface entries (element, type, node 1, node 2) shared with every
+  // neighboring block. Element and node ids are 1-based as in databases
+  std::vector<std::pair<int, std::vector<std::array<int, 4> > > > entries;
+  for (int dz = -1; dz <= 1; dz++) {
+    for (int dx = -1; dx <= 1; dx++) {
+      const int jx = b.ix + dx, jz = b.iz + dz;
+      if ((dx == 0 && dz == 0) || jx < 0 || jx >= b.px || jz < 0 ||
+          jz >= b.pz)
+        continue;
+
+      std::vector<std::array<int, 4> > neighbor_entries;
+      const int xedge = (dx > 0) ? b.nx - 1 : 0;
+      const int zedge = (dz > 0) ? b.nz - 1 : 0;
+      if (dx != 0 && dz != 0) {
+        // Corner shared with a diagonal block
+        const int n = node(xedge + (dx > 0), zedge + (dz > 0));
+        neighbor_entries.push_back(
+            { element(xedge, zedge) + 1, 1, n + 1, -1 });
+      } else if (dx != 0) {
+        for (int iz = 0; iz < b.nz; iz++) {
+          const int n1 = node(xedge + (dx > 0), iz);
+          const int n2 = node(xedge + (dx > 0), iz + 1);
+          neighbor_entries.push_back(
+              { element(xedge, iz) + 1, 2, n1 + 1, n2 + 1 });
+        }
+      } else {
+        for (int ix = 0; ix < b.nx; ix++) {
+          const int n1 = node(ix, zedge + (dz > 0));
+          const int n2 = node(ix + 1, zedge + (dz > 0));
+          neighbor_entries.push_back(
+              { element(ix, zedge) + 1, 2, n1 + 1, n2 + 1 });
+        }
+      }
+      entries.push_back({ jz * b.px + jx, neighbor_entries });
+    }
+  }
+
+  int max_interface_size = 0;
+  for (const auto &[neighbor, neighbor_entries] : entries)
+    max_interface_size = std::max(max_interface_size,
+                                  static_cast<int>(neighbor_entries.size()));
+
+  mesh.interface =
+      specfem::interfaces::interface(entries.size(), max_interface_size);
+  for (int iinterface = 0; iinterface < entries.size(); iinterface++) {
+    const auto &[neighbor, neighbor_entries] = entries[iinterface];
+    mesh.interface.my_neighbors(iinterface) = neighbor;
+    mesh.interface.my_nelmnts_neighbors(iinterface) = neighbor_entries.size();
+    for (int ie = 0; ie < neighbor_entries.size(); ie++) {
+      for (int k = 0; k < 4; k++)
+        mesh.interface.my_interfaces(iinterface, ie, k) =
+            neighbor_entries[ie][k];
+    }
+  }
+
+  return mesh;
+}
+
+boost::program_options::options_description define_args() {
+  namespace po = boost::program_options;
+
+  po::options_description desc{ "======================================\n"
+                                "-------SPECFEM scaling benchmark------\n"
+                                "======================================" };
+
+  desc.add_options()("help,h", "Print this help message")(
+      "preset", po::value<std::string>()->default_value("weak"),
+      "Scaling preset. weak: nx x nz elements per rank, strong: nx x nz "
+      "elements split between ranks")(
+      "nx", po::value<int>(),
+      "Number of elements in x. Defaults to 100 (weak) or 400 (strong)")(
+      "nz", po::value<int>(),
+      "Number of elements in z. Defaults to 100 (weak) or 400 (strong)")(
+      "nsteps", po::value<int>()->default_value(500),
+      "Number of timesteps")("ngll", po::value<int>()->default_value(5),
+                             "Number of GLL points in every direction");
+
+  return desc;
+}
+
+std::string print_results(const block &b, const int nsteps, const int ngll,
+                          const bool weak, const double elapsed,
+                          const double wait_fraction_max,
+                          const double wait_fraction_mean,
+                          const int nspec_max, const int nproc) {
+  const double nspec_global = static_cast<double>(b.nx_global) * b.nz_global;
+  std::ostringstream message;
+  message << "\n================================================\n"
+          << "             Scaling benchmark\n"
+          << "================================================\n\n"
+          << "Preset : " << (weak ? "weak" : "strong") << "\n"
+          << "Number of ranks : " << nproc << " (" << b.px << " x " << b.pz
+          << ")\n"
+          << "Number of elements : " << b.nx_global << " x " << b.nz_global
+          << "\n"
+          << "Largest number of elements per rank : " << nspec_max << "\n"
+          << "Number of GLL points : " << ngll << " x " << ngll << "\n"
+          << "Number of timesteps : " << nsteps << "\n"
+          << "------------------------------------------------\n"
+          << "Time loop : " << elapsed << " secs\n"
+          << "Steps per second : " << nsteps / elapsed << "\n"
+          << "Elements per second per rank : "
+          << nspec_global * nsteps / elapsed / nproc << "\n"
+          << "Halo wait fraction (max) : " << wait_fraction_max << "\n"
+          << "Halo wait fraction (mean) : " << wait_fraction_mean << "\n"
+          << "------------------------------------------------\n";
+
+  return message.str();
+}
+
+void execute(const bool weak, const int nx, const int nz, const int nsteps,
+             const int ngll, specfem::MPI::MPI *mpi) {
+
+  specfem::quadrature::quadrature gllx(0.0, 0.0, ngll);
+  specfem::quadrature::quadrature gllz(0.0, 0.0, ngll);
+
+  const type_real element_size = 100.0;
+  const auto b = decompose(weak, nx, nz, mpi);
+  auto mesh = block_mesh(b, element_size);
+
+  // Homogeneous elastic medium without attenuation
+  specfem::utilities::input_holder holder;
+  holder.val0 = 2700.0;
+  holder.val1 = 3000.0;
+  holder.val2 = 1732.0;
+  holder.val3 = 0.0;
+  holder.val5 = 9999.0;
+  holder.val6 = 9999.0;
+  std::vector<specfem::material *> materials;
+  materials.push_back(new specfem::elastic_material());
+  materials[0]->assign(holder);
+
+  specfem::compute::compute compute(mesh.coorg, mesh.material_ind.knods, gllx,
+                                    gllz);
+  specfem::compute::partial_derivatives partial_derivatives(
+      mesh.coorg, mesh.material_ind.knods, gllx, gllz);
+  specfem::compute::properties material_properties(mesh.material_ind.kmato,
+                                                   materials, mesh.nspec,
+                                                   gllx.get_N(), gllz.get_N());
+
+  const auto stable_timestep = specfem::courant::compute_stable_timestep(
+      compute.coordinates.coord, compute.h_ibool, material_properties.h_rho,
+      material_properties.rho_vp, material_properties.rho_vs);
+  const type_real dt = mpi->all_reduce(stable_timestep.dt, specfem::MPI::min);
+
+  // Force source at the center of the mesh
+  YAML::Node node;
+  node["x"] = 0.5 * b.nx_global * element_size;
+  node["z"] = 0.5 * b.nz_global * element_size;
+  node["source_surf"] = false;
+  node["angle"] = 0.0;
+  node["vx"] = 0.0;
+  node["vz"] = 0.0;
+  node["Dirac"]["factor"] = 1e10;
+  node["Dirac"]["tshift"] = 0.0;
+  std::vector<specfem::sources::source *> sources;
+  sources.push_back(new specfem::sources::force(node, dt));
+  specfem::receivers::receiver_set receivers;
+
+  specfem::sources::locate(sources, compute.coordinates.coord, compute.h_ibool,
+                           gllx.get_hxi(), gllz.get_hxi(), mesh.coorg,
+                           mesh.material_ind.knods,
+                           material_properties.h_ispec_type, mpi);
+
+  // Seismograms are sampled once
+  specfem::TimeScheme::TimeScheme *it = new specfem::TimeScheme::Newmark(
+      nsteps, -1.0 * sources[0]->get_t0(), dt, nsteps);
+
+  const type_real xmax = compute.coordinates.xmax;
+  const type_real xmin = compute.coordinates.xmin;
+  const type_real zmax = compute.coordinates.zmax;
+  const type_real zmin = compute.coordinates.zmin;
+
+  specfem::compute::sources compute_sources(sources, gllx, gllz, xmax, xmin,
+                                            zmax, zmin, mpi,
+                                            specfem::wave::p_sv);
+  specfem::compute::receivers compute_receivers(
+      receivers, { specfem::seismogram::displacement }, gllx, gllz, xmax, xmin,
+      zmax, zmin, it->get_max_seismogram_step(), mpi);
+
+  specfem::interfaces::halo halo(
+      mesh.interface, compute.h_ibool, compute.coordinates.coord,
+      mesh.material_ind.knods, material_properties.h_ispec_type, ndim, mpi);
+
+  const int nglob = specfem::utilities::compute_nglob(compute.h_ibool);
+  specfem::Domain::Domain *domains = new specfem::Domain::Elastic(
+      ndim, nglob, &compute, &material_properties, &partial_derivatives,
+      &compute_sources, &compute_receivers, &gllx, &gllz,
+      specfem::Domain::options(), &halo);
+
+  compute_sources.tabulate_stf(it->get_time(), dt, it->get_max_timestep() + 2);
+
+  specfem::solver::solver *solver =
+      specfem::solver::instantiate_time_marching(domains, it);
+
+  // Only exchanges of the time loop are timed
+  halo.reset_wait_time();
+  Kokkos::fence();
+  mpi->sync_all();
+
+  Kokkos::Timer timer;
+  solver->run();
+  Kokkos::fence();
+  const double local_elapsed = timer.seconds();
+
+  // The slowest rank sets the rate of the run
+  const double elapsed = mpi->all_reduce(local_elapsed, specfem::MPI::max);
+  const double wait_fraction = halo.get_wait_time() / local_elapsed;
+  const double wait_fraction_max =
+      mpi->all_reduce(wait_fraction, specfem::MPI::max);
+  const double wait_fraction_mean =
+      mpi->all_reduce(wait_fraction, specfem::MPI::sum) / mpi->get_size();
+  const int nspec_max = mpi->all_reduce(mesh.nspec, specfem::MPI::max);
+
+  mpi->cout(print_results(b, nsteps, ngll, weak, elapsed, wait_fraction_max,
+                          wait_fraction_mean, nspec_max, mpi->get_size()));
+
+  for (auto &material : materials) {
+    delete material;
+  }
+
+  for (auto &source : sources) {
+    delete source;
+  }
+
+  delete it;
+  delete domains;
+  delete solver;
+
+  return;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+
+  // Initialize MPI
+  specfem::MPI::MPI *mpi = new specfem::MPI::MPI(&argc, &argv);
+  // Initialize Kokkos on the device and cores assigned to this process
+  const auto binding = specfem::binding::initialize(argc, argv, mpi);
+  mpi->cout(specfem::binding::print(binding, mpi));
+  {
+    const auto desc = define_args();
+    boost::program_options::variables_map vm;
+    boost::program_options::store(
+        boost::program_options::parse_command_line(argc, argv, desc), vm);
+
+    const std::string preset = vm["preset"].as<std::string>();
+    if (vm.count("help")) {
+      std::ostringstream help;
+      help << desc;
+      mpi->cout(help.str());
+    } else if (preset != "weak" && preset != "strong") {
+      mpi->cout("Unknown preset " + preset + ". Use weak or strong");
+    } else {
+      const bool weak = (preset == "weak");
+      const int default_size = weak ? 100 : 400;
+      const int nx = vm.count("nx") ? vm["nx"].as<int>() : default_size;
+      const int nz = vm.count("nz") ? vm["nz"].as<int>() : default_size;
+      execute(weak, nx, nz, vm["nsteps"].as<int>(), vm["ngll"].as<int>(),
+              mpi);
+    }
+  }
+  // Finalize Kokkos
+  Kokkos::finalize();
+  // Finalize MPI
+  delete mpi;
+  return 0;
+}
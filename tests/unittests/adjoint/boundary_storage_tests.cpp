@@ -0,0 +1,84 @@
+#include "../../../include/adjoint.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <string>
+
+constexpr int npoints = 7;
+constexpr int nvalues = 2;
+
+type_real traction(const int istep, const int ipoint, const int ivalue) {
+  return 1000.0 * istep + 10.0 * ipoint + ivalue;
+}
+
+// Record every timestep, then replay them in reverse order
+void round_trip(const int nsteps, const int chunk_size,
+                const std::string &filename) {
+  const specfem::kokkos::DevExecSpace exec_space;
+  specfem::adjoint::boundary_storage storage(npoints, nvalues, nsteps,
+                                             chunk_size, filename);
+
+  for (int istep = 0; istep < nsteps; istep++) {
+    const auto recorded = storage.record(istep, exec_space);
+    ASSERT_EQ(recorded.extent(0), npoints);
+    ASSERT_EQ(recorded.extent(1), nvalues);
+    auto h_recorded = Kokkos::create_mirror_view(recorded);
+    for (int ipoint = 0; ipoint < npoints; ipoint++)
+      for (int ivalue = 0; ivalue < nvalues; ivalue++)
+        h_recorded(ipoint, ivalue) = traction(istep, ipoint, ivalue);
+    Kokkos::deep_copy(recorded, h_recorded);
+  }
+  storage.flush(exec_space);
+
+  for (int istep = nsteps - 1; istep >= 0; istep--) {
+    const auto replayed = storage.replay(istep, exec_space);
+    auto h_replayed = Kokkos::create_mirror_view(replayed);
+    Kokkos::deep_copy(h_replayed, replayed);
+    for (int ipoint = 0; ipoint < npoints; ipoint++)
+      for (int ivalue = 0; ivalue < nvalues; ivalue++)
+        EXPECT_EQ(h_replayed(ipoint, ivalue), traction(istep, ipoint, ivalue))
+            << "timestep " << istep;
+  }
+}
+
+TEST(BOUNDARY_STORAGE, SPILLED_CHUNKS) {
+  const std::string filename =
+      (std::filesystem::temp_directory_path() / "boundary_storage_tests.bin")
+          .string();
+  // The last chunk is partially recorded
+  round_trip(10, 3, filename);
+  EXPECT_FALSE(std::filesystem::exists(filename));
+}
+
+TEST(BOUNDARY_STORAGE, SINGLE_CHUNK) {
+  const std::string filename =
+      (std::filesystem::temp_directory_path() / "boundary_storage_tests.bin")
+          .string();
+  round_trip(5, 10, filename);
+
+  // A single chunk stays on the device
+  specfem::adjoint::boundary_storage storage(npoints, nvalues, 5, 10,
+                                             filename);
+  EXPECT_EQ(storage.get_file_size(), 0);
+}
+
+TEST(BOUNDARY_STORAGE, FILE_SIZE) {
+  const std::string filename =
+      (std::filesystem::temp_directory_path() / "boundary_storage_tests.bin")
+          .string();
+  // Every chunk but the last one is written
+  specfem::adjoint::boundary_storage storage(npoints, nvalues, 10, 3,
+                                             filename);
+  EXPECT_EQ(storage.get_file_size(),
+            3 * 3 * npoints * nvalues * sizeof(type_real));
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
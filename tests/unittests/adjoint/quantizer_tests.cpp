@@ -0,0 +1,97 @@
+#include "../../../include/adjoint.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+
+constexpr int nglob = 1000;
+constexpr int ncomponents = 2;
+
+// Largest error of every value after a round trip of a field spanning several
+// orders of magnitude, relative to the largest magnitude of its block
+type_real round_trip(const int bits, type_real &reported) {
+  specfem::kokkos::DeviceFieldView2d<type_real> field("quantizer_tests::field",
+                                                      nglob, ncomponents);
+  specfem::kokkos::DeviceFieldView2d<type_real> restored(
+      "quantizer_tests::restored", nglob, ncomponents);
+  auto h_field = Kokkos::create_mirror_view(field);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    for (int icomp = 0; icomp < ncomponents; icomp++) {
+      h_field(iglob, icomp) =
+          std::sin(0.1 * iglob + icomp) * std::pow(10.0, iglob / 250);
+    }
+  }
+  Kokkos::deep_copy(field, h_field);
+
+  const specfem::kokkos::DevExecSpace exec_space;
+  specfem::adjoint::quantizer quantizer(2, nglob, ncomponents, bits);
+  reported = quantizer.compress(1, field, exec_space);
+  quantizer.decompress(1, restored, exec_space);
+  exec_space.fence();
+
+  auto h_restored = Kokkos::create_mirror_view(restored);
+  Kokkos::deep_copy(h_restored, restored);
+
+  const int block_size = specfem::adjoint::quantizer::block_size;
+  type_real error = 0.0;
+  for (int first = 0; first < nglob * ncomponents; first += block_size) {
+    type_real scale = 0.0;
+    type_real block_error = 0.0;
+    for (int ivalue = first;
+         ivalue < first + block_size && ivalue < nglob * ncomponents;
+         ivalue++) {
+      const int iglob = ivalue / ncomponents;
+      const int icomp = ivalue % ncomponents;
+      scale = std::max(scale, std::fabs(h_field(iglob, icomp)));
+      block_error =
+          std::max(block_error,
+                   std::fabs(h_restored(iglob, icomp) - h_field(iglob, icomp)));
+    }
+    error = std::max(error, block_error / scale);
+  }
+  return error;
+}
+
+TEST(QUANTIZER, ERROR_BOUND) {
+  for (const int bits : { 2, 4, 8, 16 }) {
+    type_real reported;
+    const type_real error = round_trip(bits, reported);
+    const type_real levels = (1 << (bits - 1)) - 1;
+    // Half a quantization step, with a margin for rounding of type_real
+    EXPECT_LE(error, 0.5 / levels * (1.0 + 1e-3)) << bits << " bits";
+    // Relative to the largest magnitude of the field
+    EXPECT_LE(reported, error * (1.0 + 1e-3)) << bits << " bits";
+  }
+}
+
+TEST(QUANTIZER, COMPRESSION_RATIO) {
+  // Packed values and one scale per block
+  EXPECT_EQ(specfem::adjoint::quantizer::slot_size(128, 8),
+            128 + 2 * sizeof(type_real));
+  EXPECT_EQ(specfem::adjoint::quantizer::slot_size(65, 4),
+            64 + 2 * sizeof(type_real));
+
+  // Slots are allocated on the device, i.e. the host for serial backends
+  specfem::adjoint::quantizer quantizer(3, nglob, ncomponents, 4);
+  const auto usage = quantizer.memory_usage();
+  const std::size_t bytes = usage.device + usage.host;
+  const std::size_t raw = 3 * nglob * ncomponents * sizeof(type_real);
+  EXPECT_EQ(bytes,
+            3 * specfem::adjoint::quantizer::slot_size(nglob * ncomponents, 4));
+  EXPECT_GE(static_cast<double>(raw) / bytes, 7.0);
+}
+
+TEST(QUANTIZER, UNSUPPORTED_BITS) {
+  EXPECT_THROW(specfem::adjoint::quantizer(1, nglob, ncomponents, 3),
+               std::runtime_error);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
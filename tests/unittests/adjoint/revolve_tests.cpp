@@ -0,0 +1,97 @@
+#include "../../../include/adjoint.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+// Replay a schedule on the position of the forward fields. Records the
+// timesteps of the adjoint steps in the order they are computed and the
+// number of forward steps
+struct replay {
+  std::vector<int> adjoint_steps;
+  std::int64_t forward_steps = 0;
+  int max_checkpoints = 0;
+
+  void run(const int nsteps, const int ncheckpoints) {
+    specfem::adjoint::revolve schedule(nsteps, ncheckpoints);
+    std::map<int, int> checkpoints;
+    // -1 once the forward fields are read by a turn
+    int position = 0;
+
+    for (auto action = schedule.next();
+         action != specfem::adjoint::action::terminate;
+         action = schedule.next()) {
+      switch (action) {
+      case specfem::adjoint::action::advance:
+        ASSERT_GE(position, 0);
+        ASSERT_GT(schedule.get_capo(), position);
+        forward_steps += schedule.get_capo() - position;
+        position = schedule.get_capo();
+        break;
+      case specfem::adjoint::action::takeshot:
+        ASSERT_EQ(position, schedule.get_capo());
+        ASSERT_GE(schedule.get_check(), 0);
+        ASSERT_LT(schedule.get_check(), ncheckpoints);
+        checkpoints[schedule.get_check()] = position;
+        max_checkpoints = std::max(max_checkpoints,
+                                   static_cast<int>(checkpoints.size()));
+        break;
+      case specfem::adjoint::action::restore:
+        ASSERT_EQ(checkpoints.count(schedule.get_check()), 1);
+        position = checkpoints[schedule.get_check()];
+        ASSERT_EQ(position, schedule.get_capo());
+        break;
+      case specfem::adjoint::action::firsturn:
+      case specfem::adjoint::action::youturn:
+        ASSERT_EQ(position, schedule.get_capo());
+        forward_steps++;
+        adjoint_steps.push_back(position);
+        position = -1;
+        break;
+      default:
+        FAIL();
+      }
+    }
+  }
+};
+
+TEST(REVOLVE, REVERSAL_ORDER) {
+  for (int nsteps = 1; nsteps < 40; nsteps++) {
+    for (int ncheckpoints = 1; ncheckpoints < 8; ncheckpoints++) {
+      replay schedule;
+      schedule.run(nsteps, ncheckpoints);
+      ASSERT_EQ(schedule.adjoint_steps.size(), nsteps);
+      for (int istep = 0; istep < nsteps; istep++)
+        EXPECT_EQ(schedule.adjoint_steps[istep], nsteps - 1 - istep);
+      EXPECT_LE(schedule.max_checkpoints, ncheckpoints);
+    }
+  }
+}
+
+TEST(REVOLVE, OPTIMAL_FORWARD_STEPS) {
+  for (int nsteps = 1; nsteps < 40; nsteps++) {
+    for (int ncheckpoints = 1; ncheckpoints < 8; ncheckpoints++) {
+      replay schedule;
+      schedule.run(nsteps, ncheckpoints);
+      EXPECT_EQ(schedule.forward_steps,
+                specfem::adjoint::revolve::forward_steps(nsteps,
+                                                         ncheckpoints));
+    }
+  }
+
+  // A single checkpoint recomputes every step from the start
+  EXPECT_EQ(specfem::adjoint::revolve::forward_steps(10, 1), 10 * 11 / 2);
+  // Every state fits, steps are computed once before the turns
+  EXPECT_EQ(specfem::adjoint::revolve::forward_steps(10, 10), 9 + 10);
+  EXPECT_EQ(specfem::adjoint::revolve::forward_steps(100, 5), 316 + 100);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
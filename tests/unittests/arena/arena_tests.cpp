@@ -0,0 +1,62 @@
+#include "../../../include/arena.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../Kokkos_Environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cstdint>
+#include <gtest/gtest.h>
+
+TEST(ARENA_TESTS, ALLOCATE) {
+  specfem::memory::arena arena(1024);
+
+  auto a = arena.allocate<specfem::kokkos::HostView1d<double> >(3);
+  auto b = arena.allocate<specfem::kokkos::HostView2d<int> >(4, 5);
+
+  ASSERT_EQ(a.extent(0), 3);
+  ASSERT_EQ(b.extent(0), 4);
+  ASSERT_EQ(b.extent(1), 5);
+
+  // Views are aligned and don't overlap
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(a.data()) % 64, 0);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(b.data()) % 64, 0);
+  EXPECT_GE(reinterpret_cast<char *>(b.data()),
+            reinterpret_cast<char *>(a.data() + 3));
+
+  for (int i = 0; i < 3; i++)
+    a(i) = i;
+  for (int i = 0; i < 4; i++)
+    for (int j = 0; j < 5; j++)
+      b(i, j) = -1;
+  for (int i = 0; i < 3; i++)
+    EXPECT_EQ(a(i), i);
+
+  EXPECT_EQ(arena.capacity(), 1024);
+}
+
+TEST(ARENA_TESTS, RELEASE) {
+  specfem::memory::arena arena(1024);
+
+  auto a = arena.allocate<specfem::kokkos::HostView1d<double> >(8);
+  const auto mark = arena.mark();
+  auto b = arena.allocate<specfem::kokkos::HostView1d<double> >(8);
+
+  // Released memory is reused by the next allocation
+  arena.release(mark);
+  auto c = arena.allocate<specfem::kokkos::HostView1d<double> >(8);
+  EXPECT_EQ(c.data(), b.data());
+
+  // Allocations larger than a chunk get a chunk of their own
+  auto d = arena.allocate<specfem::kokkos::HostView1d<double> >(1000);
+  EXPECT_EQ(d.extent(0), 1000);
+  EXPECT_EQ(arena.capacity(), 1024 + 8000);
+
+  arena.release();
+  auto e = arena.allocate<specfem::kokkos::HostView1d<double> >(8);
+  EXPECT_EQ(e.data(), a.data());
+  EXPECT_EQ(arena.capacity(), 1024 + 8000);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,58 @@
+#include "../../../include/attenuation.h"
+#include "../Kokkos_Environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <set>
+#include <stdexcept>
+
+TEST(ATTENUATION_TESTS, CONSTANT_Q) {
+  const type_real f0 = 2.0;
+  const type_real q = 50.0;
+
+  for (const int n_sls : { 3, 5 }) {
+    const specfem::attenuation::model model(n_sls, f0);
+    ASSERT_EQ(model.omega.size(), n_sls);
+
+    // Q is matched within 5% inside the band
+    for (int i = 0; i <= 20; i++) {
+      const type_real frequency =
+          f0 * std::pow(specfem::attenuation::band_ratio, i / 10.0 - 1.0);
+      EXPECT_NEAR(model.inverse_q(frequency, q) * q, 1.0, 0.05)
+          << "n_sls = " << n_sls << ", frequency = " << frequency;
+    }
+
+    EXPECT_GT(model.dispersion(), 0.0);
+  }
+}
+
+TEST(ATTENUATION_TESTS, INVALID_MODEL) {
+  EXPECT_THROW(specfem::attenuation::model(0, 1.0), std::runtime_error);
+  EXPECT_THROW(specfem::attenuation::model(3, 0.0), std::runtime_error);
+}
+
+TEST(ATTENUATION_TESTS, SLS_PATTERN) {
+  for (int n_sls = 1; n_sls <= 5; n_sls++) {
+    for (int iz = 0; iz < 5; iz++) {
+      // Every SLS is used once by n_sls consecutive points
+      for (int ix = 0; ix + n_sls <= 5; ix++) {
+        std::set<int> used;
+        for (int jx = ix; jx < ix + n_sls; jx++)
+          used.insert(specfem::attenuation::sls_index(iz, jx, n_sls));
+        EXPECT_EQ(used.size(), n_sls);
+      }
+      // Points sharing an edge use different SLS
+      if (n_sls > 1 && iz > 0) {
+        for (int ix = 0; ix < 5; ix++)
+          EXPECT_NE(specfem::attenuation::sls_index(iz, ix, n_sls),
+                    specfem::attenuation::sls_index(iz - 1, ix, n_sls));
+      }
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
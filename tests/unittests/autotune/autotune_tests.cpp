@@ -0,0 +1,88 @@
+#include "../../../include/autotune.h"
+#include "../Kokkos_Environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <string>
+
+// Time reported for a candidate. Team size 64 is the fastest candidate on
+// device backends
+static double fake_time(const specfem::autotune::config &configuration) {
+  return 1.0 + std::abs(configuration.team_size - 64) +
+         configuration.scratch_level;
+}
+
+TEST(AUTOTUNE_TESTS, SELECT_FASTEST) {
+  const std::string filename = "autotune_tests_cache.txt";
+  std::remove(filename.c_str());
+
+  specfem::autotune::cache cache(filename);
+  specfem::autotune::kernel tuner("autotune_tests", 5, 100, &cache);
+
+  // Launches which can't be timed use the default configuration
+  const auto untimed = tuner.get_config(1024, false);
+  EXPECT_EQ(untimed.team_size, 0);
+  EXPECT_EQ(untimed.scratch_level, 0);
+  EXPECT_TRUE(tuner.tuning());
+
+  specfem::autotune::config fastest;
+  double fastest_time = 1e30;
+  while (tuner.tuning()) {
+    const auto configuration = tuner.get_config(1024);
+    const double time = fake_time(configuration);
+    if (time < fastest_time) {
+      fastest_time = time;
+      fastest = configuration;
+    }
+    tuner.record(time);
+  }
+
+  const auto best = tuner.get_config(1024);
+  EXPECT_EQ(best.team_size, fastest.team_size);
+  EXPECT_EQ(best.scratch_level, fastest.scratch_level);
+
+  // Later runs read the tuned configuration from the cache file
+  specfem::autotune::cache cached(filename);
+  specfem::autotune::kernel cached_tuner("autotune_tests", 5, 100, &cached);
+  const auto configuration = cached_tuner.get_config(1024);
+  EXPECT_FALSE(cached_tuner.tuning());
+  EXPECT_EQ(configuration.team_size, fastest.team_size);
+  EXPECT_EQ(configuration.scratch_level, fastest.scratch_level);
+
+  // Kernels launched on a different number of elements are tuned again
+  specfem::autotune::kernel other_tuner("autotune_tests", 5, 200, &cached);
+  other_tuner.get_config(1024);
+  EXPECT_TRUE(other_tuner.tuning());
+
+  std::remove(filename.c_str());
+}
+
+TEST(AUTOTUNE_TESTS, REJECT) {
+  specfem::autotune::cache cache;
+  specfem::autotune::kernel tuner("autotune_tests", 5, 100, &cache);
+
+  // Every candidate is too large for the kernel, hence the default
+  // configuration is kept
+  tuner.get_config(0);
+  while (tuner.tuning())
+    tuner.reject();
+
+  const auto best = tuner.get_config(0);
+  EXPECT_EQ(best.team_size, 0);
+  EXPECT_EQ(best.scratch_level, 0);
+}
+
+TEST(AUTOTUNE_TESTS, DISABLED) {
+  specfem::autotune::kernel tuner;
+  const auto configuration = tuner.get_config(1024);
+  EXPECT_FALSE(tuner.tuning());
+  EXPECT_EQ(configuration.team_size, 0);
+  EXPECT_EQ(configuration.scratch_level, 0);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,217 @@
+#include "../../../include/boundaries.h"
+#include "../../../include/compute.h"
+#include "../../../include/enums.h"
+#include "../../../include/injection.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/material.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/stacey.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+constexpr type_real rho = 2700.0;
+constexpr type_real cp = 3000.0;
+constexpr type_real cs = 1732.0;
+constexpr type_real dt = 1e-3;
+
+// A single elastic 4 node element of unit size. Every side is absorbing
+struct injection_setup {
+  specfem::kokkos::HostView2d<type_real> coorg;
+  specfem::kokkos::HostView2d<int> knods;
+  specfem::kokkos::HostView1d<int> kmato;
+  std::vector<specfem::material *> materials;
+  specfem::quadrature::quadrature gll;
+  specfem::boundaries::absorbing_boundary abs_boundary;
+  specfem::compute::compute compute;
+  specfem::compute::partial_derivatives partial_derivatives;
+  specfem::compute::properties properties;
+  std::string folder;
+
+  injection_setup()
+      : coorg("injection_tests::coorg", ndim, 4),
+        knods("injection_tests::knods", 4, 1),
+        kmato("injection_tests::kmato", 1), gll(0.0, 0.0, 5),
+        abs_boundary(4) {
+    for (int in = 0; in < 4; in++) {
+      coorg(0, in) = (in == 1 || in == 2) ? 1.0 : 0.0;
+      coorg(1, in) = (in >= 2) ? 1.0 : 0.0;
+      knods(in, 0) = in;
+      abs_boundary.numabs(in) = 0;
+      abs_boundary.codeabs(in, in) = true;
+    }
+
+    specfem::utilities::input_holder holder;
+    holder.val0 = rho;
+    holder.val1 = cp;
+    holder.val2 = cs;
+    holder.val3 = 0.0;
+    holder.val5 = 9999.0;
+    holder.val6 = 9999.0;
+    materials.push_back(new specfem::elastic_material());
+    materials[0]->assign(holder);
+
+    compute = specfem::compute::compute(coorg, knods, gll, gll);
+    partial_derivatives =
+        specfem::compute::partial_derivatives(coorg, knods, gll, gll);
+    properties = specfem::compute::properties(kmato, materials, 1,
+                                              gll.get_N(), gll.get_N());
+
+    folder =
+        (std::filesystem::temp_directory_path() / "injection_tests").string();
+    std::filesystem::remove_all(folder);
+  }
+
+  ~injection_setup() {
+    for (auto &material : materials)
+      delete material;
+    std::filesystem::remove_all(folder);
+  }
+
+  // Record nsteps timesteps of the displacement u = (x, 0) moving at
+  // v = (1, 0) on the contour
+  int record(const type_real xmin, const type_real xmax, const int nsteps,
+             const int chunk_size) {
+    specfem::boundaries::injection injection(
+        xmin, xmax, 0.0, 1.0, &compute, &partial_derivatives, &properties,
+        &gll, &gll, specfem::wave::p_sv, nsteps, chunk_size, 0.0, dt,
+        folder + "/proc0_injection.bin");
+
+    const int nglob = compute.coordinates.coord.extent(1);
+    specfem::kokkos::DeviceFieldView2d<type_real> field(
+        "injection_tests::field", nglob, 2);
+    specfem::kokkos::DeviceFieldView2d<type_real> field_dot(
+        "injection_tests::field_dot", nglob, 2);
+    specfem::kokkos::DeviceFieldView2d<type_real> field_dot_dot(
+        "injection_tests::field_dot_dot", nglob, 2);
+    auto h_field = Kokkos::create_mirror_view(field);
+    auto h_field_dot = Kokkos::create_mirror_view(field_dot);
+    for (int iglob = 0; iglob < nglob; iglob++) {
+      h_field(iglob, 0) = compute.coordinates.coord(0, iglob);
+      h_field(iglob, 1) = 0.0;
+      h_field_dot(iglob, 0) = 1.0;
+      h_field_dot(iglob, 1) = 0.0;
+    }
+    Kokkos::deep_copy(field, h_field);
+    Kokkos::deep_copy(field_dot, h_field_dot);
+
+    for (int istep = 0; istep < nsteps; istep++)
+      injection.compute_interaction(field, field_dot, field_dot_dot,
+                                    specfem::kokkos::DevExecSpace());
+    injection.flush();
+
+    return injection.get_npoints();
+  }
+};
+
+TEST(INJECTION, RECORDED_CONTOUR) {
+  injection_setup setup;
+
+  const int ngll = setup.gll.get_N();
+  const int nsteps = 3;
+  const int npoints = setup.record(0.0, 1.0, nsteps, 2);
+  EXPECT_EQ(npoints, 4 * (ngll - 1));
+
+  // Header, coordinates and 5 values of every point for every timestep
+  const auto size = std::filesystem::file_size(setup.folder +
+                                               "/proc0_injection.bin");
+  EXPECT_EQ(size, 4 * sizeof(std::int32_t) + 2 * sizeof(double) +
+                      (2 + 5 * nsteps) * npoints * sizeof(type_real));
+}
+
+TEST(INJECTION, INJECTED_TRACTION) {
+  injection_setup setup;
+
+  const int nsteps = 3;
+  setup.record(0.0, 1.0, nsteps, 2);
+
+  const specfem::boundaries::stacey stacey(
+      setup.abs_boundary, &setup.compute, &setup.properties, &setup.gll,
+      &setup.gll, specfem::elements::elastic, specfem::wave::p_sv, 1);
+  specfem::boundaries::injection injection(
+      setup.folder, stacey, &setup.compute, specfem::wave::p_sv, nsteps, 2,
+      0.0, dt);
+  EXPECT_EQ(injection.get_npoints(), stacey.get_npoints());
+
+  // The local field moves with the recorded velocity, hence the damping of
+  // the absorbing points cancels and only the recorded traction is applied
+  const int nglob = setup.compute.coordinates.coord.extent(1);
+  specfem::kokkos::DeviceFieldView2d<type_real> field(
+      "injection_tests::field", nglob, 2);
+  specfem::kokkos::DeviceFieldView2d<type_real> field_dot(
+      "injection_tests::field_dot", nglob, 2);
+  specfem::kokkos::DeviceFieldView2d<type_real> field_dot_dot(
+      "injection_tests::field_dot_dot", nglob, 2);
+  auto h_field_dot = Kokkos::create_mirror_view(field_dot);
+  auto h_field_dot_dot = Kokkos::create_mirror_view(field_dot_dot);
+  const auto coord = setup.compute.coordinates.coord;
+
+  for (int istep = 0; istep < nsteps; istep++) {
+    for (int iglob = 0; iglob < nglob; iglob++) {
+      h_field_dot(iglob, 0) = 1.0;
+      h_field_dot(iglob, 1) = 0.0;
+    }
+    Kokkos::deep_copy(field_dot, h_field_dot);
+    Kokkos::deep_copy(field_dot_dot, 0.0);
+    stacey.compute_interaction(field_dot, field_dot_dot,
+                               specfem::kokkos::DevExecSpace(), nullptr);
+    injection.compute_interaction(field, field_dot, field_dot_dot,
+                                  specfem::kokkos::DevExecSpace());
+    Kokkos::fence();
+    Kokkos::deep_copy(h_field_dot_dot, field_dot_dot);
+
+    // sigma_xx = lambda + 2 mu and sigma_zz = lambda pull the sides
+    type_real left[2] = { 0.0, 0.0 };
+    type_real total[2] = { 0.0, 0.0 };
+    for (int iglob = 0; iglob < nglob; iglob++) {
+      for (int icomp = 0; icomp < 2; icomp++) {
+        total[icomp] += h_field_dot_dot(iglob, icomp);
+        if (coord(0, iglob) < 1e-6)
+          left[icomp] += h_field_dot_dot(iglob, icomp);
+      }
+    }
+    EXPECT_NEAR(left[0] / (-1.0 * rho * cp * cp), 1.0, 1e-4);
+    EXPECT_NEAR(left[1] / (rho * cp * cp), 0.0, 1e-4);
+    EXPECT_NEAR(total[0] / (rho * cp * cp), 0.0, 1e-4);
+    EXPECT_NEAR(total[1] / (rho * cp * cp), 0.0, 1e-4);
+  }
+}
+
+TEST(INJECTION, UNMATCHED_POINTS) {
+  injection_setup setup;
+
+  // The element center isn't inside the contour, no point is recorded
+  EXPECT_EQ(setup.record(0.0, 0.5, 1, 1), 0);
+
+  const specfem::boundaries::stacey stacey(
+      setup.abs_boundary, &setup.compute, &setup.properties, &setup.gll,
+      &setup.gll, specfem::elements::elastic, specfem::wave::p_sv, 1);
+  EXPECT_THROW(specfem::boundaries::injection(setup.folder, stacey,
+                                              &setup.compute,
+                                              specfem::wave::p_sv, 1, 1, 0.0,
+                                              dt),
+               std::runtime_error);
+
+  // Start times need to be timesteps of the recording
+  setup.record(0.0, 1.0, 1, 1);
+  EXPECT_THROW(specfem::boundaries::injection(setup.folder, stacey,
+                                              &setup.compute,
+                                              specfem::wave::p_sv, 1, 1,
+                                              0.5 * dt, dt),
+               std::runtime_error);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
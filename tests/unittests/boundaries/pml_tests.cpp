@@ -0,0 +1,181 @@
+#include "../../../include/compute.h"
+#include "../../../include/enums.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/material.h"
+#include "../../../include/pml.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+constexpr type_real rho = 2700.0;
+constexpr type_real cp = 3000.0;
+constexpr type_real cs = 1732.0;
+constexpr type_real f0 = 10.0;
+constexpr type_real reflection = 0.001;
+constexpr type_real dt = 1e-3;
+
+// Three 4 node elements of unit size placed next to each other along x. The
+// first and last elements are X PML elements, hence the interior spans
+// [1, 2] along x
+struct pml_setup {
+  specfem::kokkos::HostView2d<type_real> coorg;
+  specfem::kokkos::HostView2d<int> knods;
+  specfem::kokkos::HostView1d<int> kmato;
+  specfem::kokkos::HostView1d<int> region_CPML;
+  std::vector<specfem::material *> materials;
+  specfem::quadrature::quadrature gll;
+  specfem::compute::compute compute;
+  specfem::compute::partial_derivatives partial_derivatives;
+  specfem::compute::properties properties;
+  specfem::boundaries::pml_layer layer;
+
+  pml_setup()
+      : coorg("pml_tests::coorg", ndim, 8), knods("pml_tests::knods", 4, 3),
+        kmato("pml_tests::kmato", 3), region_CPML("pml_tests::region_CPML", 3),
+        gll(0.0, 0.0, 5) {
+    for (int iz = 0; iz < 2; iz++) {
+      for (int ix = 0; ix < 4; ix++) {
+        coorg(0, iz * 4 + ix) = ix;
+        coorg(1, iz * 4 + ix) = iz;
+      }
+    }
+    for (int ispec = 0; ispec < 3; ispec++) {
+      knods(0, ispec) = ispec;
+      knods(1, ispec) = ispec + 1;
+      knods(2, ispec) = ispec + 5;
+      knods(3, ispec) = ispec + 4;
+      kmato(ispec) = 0;
+      region_CPML(ispec) = (ispec == 1) ? 0 : 1;
+    }
+
+    specfem::utilities::input_holder holder;
+    holder.val0 = rho;
+    holder.val1 = cp;
+    holder.val2 = cs;
+    holder.val3 = 0.0;
+    holder.val5 = 9999.0;
+    holder.val6 = 9999.0;
+    materials.push_back(new specfem::elastic_material());
+    materials[0]->assign(holder);
+
+    compute = specfem::compute::compute(coorg, knods, gll, gll);
+    partial_derivatives =
+        specfem::compute::partial_derivatives(coorg, knods, gll, gll);
+    properties = specfem::compute::properties(kmato, materials, 3, gll.get_N(),
+                                              gll.get_N());
+    layer = specfem::boundaries::pml_layer(region_CPML, &compute,
+                                           MPIEnvironment::mpi_);
+  }
+
+  ~pml_setup() {
+    for (auto &material : materials)
+      delete material;
+  }
+
+  specfem::boundaries::pml instantiate(const specfem::wave::type wave) const {
+    return specfem::boundaries::pml(region_CPML, layer, &compute,
+                                    &partial_derivatives, &properties, &gll,
+                                    &gll, wave, 1, f0, reflection, dt);
+  }
+
+  // Second derivative of the field after one update of a uniform field and
+  // velocity
+  specfem::kokkos::HostFieldMirror2d<type_real>
+  interact(const std::vector<type_real> &displacement,
+           const std::vector<type_real> &velocity) {
+    const auto pml = this->instantiate(specfem::wave::p_sv);
+    const int nglob = compute.coordinates.coord.extent(1);
+    specfem::kokkos::DeviceFieldView2d<type_real> field("pml_tests::field",
+                                                        nglob, 2);
+    specfem::kokkos::DeviceFieldView2d<type_real> field_dot(
+        "pml_tests::field_dot", nglob, 2);
+    specfem::kokkos::DeviceFieldView2d<type_real> field_dot_dot(
+        "pml_tests::field_dot_dot", nglob, 2);
+    auto h_field = Kokkos::create_mirror_view(field);
+    auto h_field_dot = Kokkos::create_mirror_view(field_dot);
+    for (int iglob = 0; iglob < nglob; iglob++) {
+      for (int icomp = 0; icomp < 2; icomp++) {
+        h_field(iglob, icomp) = displacement[icomp];
+        h_field_dot(iglob, icomp) = velocity[icomp];
+      }
+    }
+    Kokkos::deep_copy(field, h_field);
+    Kokkos::deep_copy(field_dot, h_field_dot);
+
+    pml.compute_interaction(field, field_dot, field_dot_dot,
+                            specfem::kokkos::DevExecSpace(), nullptr);
+    Kokkos::fence();
+
+    auto h_field_dot_dot = Kokkos::create_mirror_view(field_dot_dot);
+    Kokkos::deep_copy(h_field_dot_dot, field_dot_dot);
+    return h_field_dot_dot;
+  }
+};
+
+TEST(PML, LAYER_DISTANCE) {
+  pml_setup setup;
+
+  type_real thickness;
+  EXPECT_NEAR(setup.layer.distance(0, 0.25, thickness), 0.75, 1e-6);
+  EXPECT_NEAR(thickness, 1.0, 1e-6);
+  EXPECT_NEAR(setup.layer.distance(0, 3.0, thickness), 1.0, 1e-6);
+  EXPECT_NEAR(thickness, 1.0, 1e-6);
+  EXPECT_EQ(setup.layer.distance(0, 1.5, thickness), 0.0);
+  EXPECT_EQ(thickness, 0.0);
+  // There are no layers along z
+  EXPECT_EQ(setup.layer.distance(1, 0.0, thickness), 0.0);
+  EXPECT_EQ(thickness, 0.0);
+}
+
+TEST(PML, COMPACT_ELEMENTS) {
+  pml_setup setup;
+
+  // Only the flagged elements store memory variables
+  const auto p_sv = setup.instantiate(specfem::wave::p_sv);
+  EXPECT_EQ(p_sv.get_nelements(), 2);
+  EXPECT_EQ(p_sv.get_nvariables(), 18);
+
+  const auto sh = setup.instantiate(specfem::wave::sh);
+  EXPECT_EQ(sh.get_nelements(), 2);
+  EXPECT_EQ(sh.get_nvariables(), 9);
+}
+
+TEST(PML, RIGID_TRANSLATION) {
+  pml_setup setup;
+
+  // A uniform displacement without velocity isn't damped
+  const auto acceleration = setup.interact({ 1.0, 2.0 }, { 0.0, 0.0 });
+  for (int iglob = 0; iglob < acceleration.extent(0); iglob++) {
+    EXPECT_NEAR(acceleration(iglob, 0) / (rho * cp), 0.0, 1e-6);
+    EXPECT_NEAR(acceleration(iglob, 1) / (rho * cp), 0.0, 1e-6);
+  }
+}
+
+TEST(PML, DAMPED_VELOCITY) {
+  pml_setup setup;
+
+  // A uniform velocity along x is damped inside the layers only
+  const auto acceleration = setup.interact({ 0.0, 0.0 }, { 1.0, 0.0 });
+  const auto coord = setup.compute.coordinates.coord;
+  for (int iglob = 0; iglob < acceleration.extent(0); iglob++) {
+    const type_real x = coord(0, iglob);
+    if (x >= 1.0 - 1e-6 && x <= 2.0 + 1e-6) {
+      EXPECT_EQ(acceleration(iglob, 0), 0.0);
+    } else {
+      EXPECT_LT(acceleration(iglob, 0), 0.0);
+    }
+    EXPECT_EQ(acceleration(iglob, 1), 0.0);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
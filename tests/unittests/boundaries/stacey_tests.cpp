@@ -0,0 +1,219 @@
+#include "../../../include/boundaries.h"
+#include "../../../include/compute.h"
+#include "../../../include/enums.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/material.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/stacey.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+constexpr type_real rho = 2700.0;
+constexpr type_real cp = 3000.0;
+constexpr type_real cs = 1732.0;
+
+// Two 4 node elements of unit size placed next to each other along x, the
+// first one elastic and the second one acoustic. Every side of both
+// elements is absorbing
+struct absorbing_setup {
+  specfem::kokkos::HostView2d<type_real> coorg;
+  specfem::kokkos::HostView2d<int> knods;
+  specfem::kokkos::HostView1d<int> kmato;
+  std::vector<specfem::material *> materials;
+  specfem::quadrature::quadrature gll;
+  specfem::boundaries::absorbing_boundary abs_boundary;
+  specfem::compute::compute compute;
+  specfem::compute::properties properties;
+
+  absorbing_setup(const int ibegin = 0, const int iend = 0)
+      : coorg("stacey_tests::coorg", ndim, 6),
+        knods("stacey_tests::knods", 4, 2), kmato("stacey_tests::kmato", 2),
+        gll(0.0, 0.0, 5), abs_boundary(8) {
+    for (int iz = 0; iz < 2; iz++) {
+      for (int ix = 0; ix < 3; ix++) {
+        coorg(0, iz * 3 + ix) = ix;
+        coorg(1, iz * 3 + ix) = iz;
+      }
+    }
+    for (int ispec = 0; ispec < 2; ispec++) {
+      knods(0, ispec) = ispec;
+      knods(1, ispec) = ispec + 1;
+      knods(2, ispec) = ispec + 4;
+      knods(3, ispec) = ispec + 3;
+      kmato(ispec) = ispec;
+    }
+
+    // Edge limits of every side are [ibegin, iend], 1-based
+    for (int inum = 0; inum < 8; inum++) {
+      abs_boundary.numabs(inum) = inum / 4;
+      abs_boundary.codeabs(inum, inum % 4) = true;
+      abs_boundary.ibegin_edge1(inum) = ibegin;
+      abs_boundary.ibegin_edge2(inum) = ibegin;
+      abs_boundary.ibegin_edge3(inum) = ibegin;
+      abs_boundary.ibegin_edge4(inum) = ibegin;
+      abs_boundary.iend_edge1(inum) = iend;
+      abs_boundary.iend_edge2(inum) = iend;
+      abs_boundary.iend_edge3(inum) = iend;
+      abs_boundary.iend_edge4(inum) = iend;
+    }
+
+    specfem::utilities::input_holder holder;
+    holder.val0 = rho;
+    holder.val1 = cp;
+    holder.val2 = cs;
+    holder.val3 = 0.0;
+    holder.val5 = 9999.0;
+    holder.val6 = 9999.0;
+    materials.push_back(new specfem::elastic_material());
+    materials[0]->assign(holder);
+
+    holder.val2 = 0.0;
+    materials.push_back(new specfem::acoustic_material());
+    materials[1]->assign(holder);
+
+    compute = specfem::compute::compute(coorg, knods, gll, gll);
+    properties = specfem::compute::properties(kmato, materials, 2,
+                                              gll.get_N(), gll.get_N());
+  }
+
+  ~absorbing_setup() {
+    for (auto &material : materials)
+      delete material;
+  }
+
+  // Sum of every component of the acceleration after damping a uniform
+  // velocity
+  std::vector<type_real> damp(const specfem::elements::type medium,
+                              const specfem::wave::type wave,
+                              const std::vector<type_real> &velocity) {
+    const specfem::boundaries::stacey stacey(abs_boundary, &compute,
+                                             &properties, &gll, &gll, medium,
+                                             wave, 1);
+    const int nglob = compute.coordinates.coord.extent(1);
+    const int ncomponents = velocity.size();
+    specfem::kokkos::DeviceFieldView2d<type_real> field_dot(
+        "stacey_tests::field_dot", nglob, ncomponents);
+    specfem::kokkos::DeviceFieldView2d<type_real> field_dot_dot(
+        "stacey_tests::field_dot_dot", nglob, ncomponents);
+    auto h_field_dot = Kokkos::create_mirror_view(field_dot);
+    for (int iglob = 0; iglob < nglob; iglob++)
+      for (int icomp = 0; icomp < ncomponents; icomp++)
+        h_field_dot(iglob, icomp) = velocity[icomp];
+    Kokkos::deep_copy(field_dot, h_field_dot);
+
+    stacey.compute_interaction(field_dot, field_dot_dot,
+                               specfem::kokkos::DevExecSpace(), nullptr);
+    Kokkos::fence();
+
+    auto h_field_dot_dot = Kokkos::create_mirror_view(field_dot_dot);
+    Kokkos::deep_copy(h_field_dot_dot, field_dot_dot);
+    std::vector<type_real> sum(ncomponents, 0.0);
+    for (int iglob = 0; iglob < nglob; iglob++)
+      for (int icomp = 0; icomp < ncomponents; icomp++)
+        sum[icomp] += h_field_dot_dot(iglob, icomp);
+
+    npoints = stacey.get_npoints();
+    return sum;
+  }
+
+  int npoints = 0;
+};
+
+TEST(STACEY, ELASTIC_TRACTION) {
+  absorbing_setup setup;
+
+  // Velocity along x is normal to the left and right sides and tangential
+  // to the bottom and top sides
+  const auto sum = setup.damp(specfem::elements::elastic, specfem::wave::p_sv,
+                              { 1.0, 0.0 });
+  EXPECT_EQ(setup.npoints, 4 * setup.gll.get_N());
+  EXPECT_NEAR(sum[0] / (-2.0 * rho * (cp + cs)), 1.0, 1e-5);
+  EXPECT_NEAR(sum[1] / (rho * cp), 0.0, 1e-6);
+}
+
+TEST(STACEY, SH_TRACTION) {
+  absorbing_setup setup;
+
+  const auto sum =
+      setup.damp(specfem::elements::elastic, specfem::wave::sh, { 1.0 });
+  EXPECT_NEAR(sum[0] / (-4.0 * rho * cs), 1.0, 1e-5);
+}
+
+TEST(STACEY, ACOUSTIC_POTENTIAL) {
+  absorbing_setup setup;
+
+  const auto sum =
+      setup.damp(specfem::elements::acoustic, specfem::wave::p_sv, { 1.0 });
+  EXPECT_EQ(setup.npoints, 4 * setup.gll.get_N());
+  EXPECT_NEAR(sum[0] * rho * cp / -4.0, 1.0, 1e-5);
+}
+
+TEST(STACEY, REPLAYED_TRACTIONS) {
+  absorbing_setup setup;
+
+  // Replaying recorded tractions reproduces the damping whatever the
+  // velocity of the replay
+  specfem::boundaries::stacey stacey(setup.abs_boundary, &setup.compute,
+                                     &setup.properties, &setup.gll, &setup.gll,
+                                     specfem::elements::elastic,
+                                     specfem::wave::p_sv, 1);
+  const int nglob = setup.compute.coordinates.coord.extent(1);
+  specfem::kokkos::DeviceFieldView2d<type_real> field_dot(
+      "stacey_tests::field_dot", nglob, 2);
+  specfem::kokkos::DeviceFieldView2d<type_real> recorded(
+      "stacey_tests::recorded", nglob, 2);
+  specfem::kokkos::DeviceFieldView2d<type_real> replayed(
+      "stacey_tests::replayed", nglob, 2);
+  specfem::kokkos::DeviceView2d<type_real> traction(
+      "stacey_tests::traction", stacey.get_npoints(), 2);
+  auto h_field_dot = Kokkos::create_mirror_view(field_dot);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    h_field_dot(iglob, 0) = 1.0;
+    h_field_dot(iglob, 1) = -2.0;
+  }
+  Kokkos::deep_copy(field_dot, h_field_dot);
+
+  stacey.set_mode(specfem::absorbing::record, traction);
+  stacey.compute_interaction(field_dot, recorded,
+                             specfem::kokkos::DevExecSpace(), nullptr);
+  Kokkos::deep_copy(field_dot, 0.0);
+  stacey.set_mode(specfem::absorbing::replay, traction);
+  stacey.compute_interaction(field_dot, replayed,
+                             specfem::kokkos::DevExecSpace(), nullptr);
+  Kokkos::fence();
+
+  auto h_recorded = Kokkos::create_mirror_view(recorded);
+  auto h_replayed = Kokkos::create_mirror_view(replayed);
+  Kokkos::deep_copy(h_recorded, recorded);
+  Kokkos::deep_copy(h_replayed, replayed);
+  type_real norm = 0.0;
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    for (int icomp = 0; icomp < 2; icomp++) {
+      norm += std::abs(h_recorded(iglob, icomp));
+      EXPECT_NEAR(h_replayed(iglob, icomp), h_recorded(iglob, icomp),
+                  1e-6 * rho * cp);
+    }
+  }
+  EXPECT_GT(norm, 0.0);
+}
+
+TEST(STACEY, EDGE_LIMITS) {
+  // Corners of every side are skipped
+  const int ngll = 5;
+  absorbing_setup setup(2, ngll - 1);
+
+  setup.damp(specfem::elements::elastic, specfem::wave::p_sv, { 1.0, 0.0 });
+  EXPECT_EQ(setup.npoints, 4 * (ngll - 2));
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,144 @@
+#include "../../../include/checkpoint.h"
+#include "../../../include/compute.h"
+#include "../../../include/domain.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/timescheme.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <csignal>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+// Domain storing fields only
+class field_domain : public specfem::Domain::Domain {
+public:
+  field_domain(const int nglob)
+      : field("field", nglob, ndim), field_dot("field_dot", nglob, ndim),
+        field_dot_dot("field_dot_dot", nglob, ndim) {}
+  specfem::kokkos::DeviceFieldView2d<type_real> get_field() const override {
+    return this->field;
+  }
+  specfem::kokkos::DeviceFieldView2d<type_real>
+  get_field_dot() const override {
+    return this->field_dot;
+  }
+  specfem::kokkos::DeviceFieldView2d<type_real>
+  get_field_dot_dot() const override {
+    return this->field_dot_dot;
+  }
+
+  specfem::kokkos::DeviceFieldView2d<type_real> field, field_dot,
+      field_dot_dot;
+};
+
+// Seismogram buffer of 4 samples, 2 seismogram types and 3 receivers
+specfem::compute::receivers seismogram_buffer() {
+  specfem::compute::receivers receivers;
+  receivers.seismogram = specfem::kokkos::DeviceReceiverView4d<type_real>(
+      "seismogram", 4, 2, 3, ndim);
+  return receivers;
+}
+
+std::filesystem::path checkpoint_directory() {
+  return std::filesystem::temp_directory_path() /
+         ("checkpoint_" + std::to_string(getpid()));
+}
+
+// Fields and the position of the time loop are restored from the checkpoint
+TEST(CHECKPOINT_TESTS, write_read) {
+
+  constexpr int nglob = 15;
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  const auto directory = checkpoint_directory();
+
+  field_domain domain(nglob);
+  auto receivers = seismogram_buffer();
+  specfem::checkpoint::checkpoint checkpoint(directory.string(), 3, &domain,
+                                             &receivers, nullptr, mpi);
+
+  for (int istep = 0; istep < 7; istep++)
+    EXPECT_EQ(checkpoint.checkpoint_step(istep), (istep + 1) % 3 == 0);
+  EXPECT_FALSE(checkpoint.interrupted());
+
+  const auto views = { domain.field, domain.field_dot, domain.field_dot_dot };
+  int ifield = 0;
+  for (const auto &view : views) {
+    auto h_view = Kokkos::create_mirror_view(view);
+    for (int iglob = 0; iglob < nglob; iglob++)
+      for (int idim = 0; idim < ndim; idim++)
+        h_view(iglob, idim) = iglob + 100 * idim + 1000 * ifield;
+    Kokkos::deep_copy(view, h_view);
+    ifield++;
+  }
+  Kokkos::deep_copy(receivers.seismogram, 7.0);
+
+  checkpoint.write({ 6, 2, 0.25 }, specfem::kokkos::DevExecSpace());
+  checkpoint.wait();
+
+  EXPECT_TRUE(std::filesystem::exists(
+      directory / ("checkpoint_" + std::to_string(mpi->get_rank()) + ".bin")));
+
+  for (const auto &view : views)
+    Kokkos::deep_copy(view, 0.0);
+  Kokkos::deep_copy(receivers.seismogram, 0.0);
+
+  const auto state = checkpoint.read();
+  EXPECT_EQ(state.istep, 6);
+  EXPECT_EQ(state.isig_step, 2);
+  EXPECT_EQ(state.current_time, 0.25);
+
+  ifield = 0;
+  for (const auto &view : views) {
+    auto h_view = Kokkos::create_mirror_view(view);
+    Kokkos::deep_copy(h_view, view);
+    for (int iglob = 0; iglob < nglob; iglob++)
+      for (int idim = 0; idim < ndim; idim++)
+        EXPECT_EQ(h_view(iglob, idim), iglob + 100 * idim + 1000 * ifield);
+    ifield++;
+  }
+
+  auto h_seismogram = Kokkos::create_mirror_view(receivers.seismogram);
+  Kokkos::deep_copy(h_seismogram, receivers.seismogram);
+  for (std::size_t i = 0; i < h_seismogram.span(); i++)
+    EXPECT_EQ(h_seismogram.data()[i], 7.0);
+
+  // Checkpoints of another mesh are rejected
+  field_domain other_domain(nglob + 1);
+  specfem::checkpoint::checkpoint other(directory.string(), 3, &other_domain,
+                                        &receivers, nullptr, mpi);
+  EXPECT_THROW(other.read(), std::runtime_error);
+
+  std::filesystem::remove_all(directory);
+}
+
+// SIGTERM stops the time loop at the next step checking signals
+TEST(CHECKPOINT_TESTS, terminate) {
+
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  const auto directory = checkpoint_directory();
+
+  field_domain domain(4);
+  auto receivers = seismogram_buffer();
+  specfem::checkpoint::checkpoint checkpoint(directory.string(), 0, &domain,
+                                             &receivers, nullptr, mpi);
+
+  EXPECT_FALSE(checkpoint.checkpoint_step(0));
+  std::raise(SIGTERM);
+  EXPECT_FALSE(checkpoint.checkpoint_step(1));
+  EXPECT_FALSE(checkpoint.interrupted());
+  EXPECT_TRUE(checkpoint.checkpoint_step(10));
+  EXPECT_TRUE(checkpoint.interrupted());
+
+  std::filesystem::remove_all(directory);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
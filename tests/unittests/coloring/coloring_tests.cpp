@@ -0,0 +1,84 @@
+#include "../../../include/coloring.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../Kokkos_Environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <vector>
+
+// Global numbering of a structured nx * nz grid of elements with ngll points
+// in every dimension
+specfem::kokkos::HostMirror3d<int> structured_ibool(const int nx, const int nz,
+                                                    const int ngll) {
+  specfem::kokkos::HostElementMirror3d<int> h_ibool("coloring_tests::h_ibool",
+                                             nx * nz, ngll, ngll);
+  const int npoints_x = nx * (ngll - 1) + 1;
+  for (int jz = 0; jz < nz; jz++) {
+    for (int jx = 0; jx < nx; jx++) {
+      const int ispec = jz * nx + jx;
+      for (int iz = 0; iz < ngll; iz++) {
+        for (int ix = 0; ix < ngll; ix++) {
+          h_ibool(ispec, iz, ix) = (jz * (ngll - 1) + iz) * npoints_x +
+                                   (jx * (ngll - 1) + ix);
+        }
+      }
+    }
+  }
+  return h_ibool;
+}
+
+TEST(coloring_tests, STRUCTURED_GRID) {
+  const int nx = 4, nz = 4, ngll = 3;
+  auto h_ibool = structured_ibool(nx, nz, ngll);
+
+  std::vector<int> ispec_list;
+  for (int ispec = 0; ispec < nx * nz; ispec++)
+    ispec_list.push_back(ispec);
+
+  auto [permutation, offsets] =
+      specfem::coloring::color_elements(h_ibool, ispec_list);
+
+  // Greedy coloring of a structured grid needs 4 colors
+  ASSERT_EQ(offsets.size(), 5);
+  EXPECT_EQ(offsets.back(), nx * nz);
+
+  // permutation should contain every element once
+  std::vector<int> sorted(permutation);
+  std::sort(sorted.begin(), sorted.end());
+  for (int i = 0; i < nx * nz; i++)
+    EXPECT_EQ(sorted[i], i);
+
+  // no two elements of the same color share a global point
+  for (int icolor = 0; icolor < offsets.size() - 1; icolor++) {
+    std::vector<int> iglobs;
+    for (int i = offsets[icolor]; i < offsets[icolor + 1]; i++) {
+      const int ispec = ispec_list[permutation[i]];
+      for (int iz = 0; iz < ngll; iz++)
+        for (int ix = 0; ix < ngll; ix++)
+          iglobs.push_back(h_ibool(ispec, iz, ix));
+    }
+    std::sort(iglobs.begin(), iglobs.end());
+    EXPECT_EQ(std::adjacent_find(iglobs.begin(), iglobs.end()), iglobs.end())
+        << "Elements of color " << icolor << " share a global point";
+  }
+}
+
+TEST(coloring_tests, REPEATED_ELEMENTS) {
+  auto h_ibool = structured_ibool(2, 2, 3);
+
+  // Multiple sources inside the same element
+  std::vector<int> ispec_list = { 1, 1, 1 };
+
+  auto [permutation, offsets] =
+      specfem::coloring::color_elements(h_ibool, ispec_list);
+
+  ASSERT_EQ(offsets.size(), 4);
+  for (int icolor = 0; icolor < 3; icolor++)
+    EXPECT_EQ(offsets[icolor + 1] - offsets[icolor], 1);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -96,6 +96,64 @@ TEST(COMPUTE_TESTS, compute_partial_derivatives) {
       gllz.get_N(), gllx.get_N()));
 }
 
+TEST(COMPUTE_TESTS, affine_elements) {
+
+  // A parallelogram and a trapezoid sharing an edge
+  const type_real nodes[][2] = { { 0.0, 0.0 }, { 2.0, 0.0 }, { 3.0, 1.0 },
+                                 { 1.0, 1.0 }, { 0.5, -1.0 }, { 1.5, -1.0 } };
+  const int elements[][4] = { { 0, 1, 2, 3 }, { 4, 5, 1, 0 } };
+  const int nspec = 2;
+
+  specfem::kokkos::HostView2d<type_real> coorg("coorg", ndim, 6);
+  for (int inode = 0; inode < 6; inode++) {
+    coorg(0, inode) = nodes[inode][0];
+    coorg(1, inode) = nodes[inode][1];
+  }
+  specfem::kokkos::HostView2d<int> knods("knods", 4, nspec);
+  for (int ispec = 0; ispec < nspec; ispec++)
+    for (int in = 0; in < 4; in++)
+      knods(in, ispec) = elements[ispec][in];
+
+  specfem::quadrature::quadrature gllx(0.0, 0.0, 5);
+  specfem::quadrature::quadrature gllz(0.0, 0.0, 5);
+  const int ngll = gllx.get_N();
+
+  specfem::compute::partial_derivatives partial_derivatives(coorg, knods,
+                                                            gllx, gllz);
+  const auto h_jacobian = Kokkos::create_mirror_view_and_copy(
+      Kokkos::HostSpace(), partial_derivatives.jacobian);
+
+  ASSERT_EQ(partial_derivatives.assign_affine_elements(coorg, knods), 1);
+  EXPECT_EQ(partial_derivatives.h_affine(0), 1);
+  EXPECT_EQ(partial_derivatives.h_affine(1), 0);
+  EXPECT_NEAR(partial_derivatives.h_affine_record(
+                  0, specfem::compute::element_geometry::jacobian),
+              0.5, 1e-5);
+
+  // The accessors read the record of the parallelogram and the quadrature
+  // points of the trapezoid
+  const auto jacobian = partial_derivatives.get_jacobian();
+  specfem::kokkos::DeviceView3d<type_real> values("values", nspec, ngll,
+                                                  ngll);
+  Kokkos::parallel_for(
+      specfem::kokkos::DeviceMDrange<3>({ 0, 0, 0 }, { nspec, ngll, ngll }),
+      KOKKOS_LAMBDA(const int ispec, const int iz, const int ix) {
+        values(ispec, iz, ix) = jacobian(ispec, iz, ix);
+      });
+  const auto h_values =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), values);
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int iz = 0; iz < ngll; iz++) {
+      for (int ix = 0; ix < ngll; ix++) {
+        EXPECT_EQ(h_values(ispec, iz, ix),
+                  partial_derivatives.h_jacobian(ispec, iz, ix));
+        EXPECT_NEAR(h_values(ispec, iz, ix), h_jacobian(ispec, iz, ix),
+                    1e-5);
+      }
+    }
+  }
+}
+
 int main(int argc, char *argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
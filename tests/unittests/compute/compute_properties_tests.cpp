@@ -111,6 +111,95 @@ TEST(COMPUTE_TESTS, compute_properties) {
                                                gllz.get_N(), gllx.get_N()));
 }
 
+TEST(COMPUTE_TESTS, release_host_mirrors) {
+
+  std::string config_filename =
+      "../../../tests/unittests/compute/test_config.yml";
+  test_config test_config =
+      get_test_config(config_filename, MPIEnvironment::mpi_);
+
+  specfem::quadrature::quadrature gllx(0.0, 0.0, 5);
+  specfem::quadrature::quadrature gllz(0.0, 0.0, 5);
+  std::vector<specfem::material *> materials;
+
+  specfem::mesh mesh(test_config.database_filename, materials,
+                     MPIEnvironment::mpi_);
+
+  specfem::compute::properties properties(mesh.material_ind.kmato, materials,
+                                          mesh.nspec, gllz.get_N(),
+                                          gllx.get_N());
+
+  const auto resident = properties.memory_usage();
+  properties.release_host_mirrors();
+  const auto released = properties.memory_usage();
+
+  // Device views are kept, host only properties are freed
+  EXPECT_EQ(released.device, resident.device);
+  EXPECT_GE(resident.host - released.host,
+            5 * properties.rho.span() * sizeof(type_real));
+  EXPECT_EQ(properties.h_rho.data(), nullptr);
+  EXPECT_EQ(properties.rho_vp.data(), nullptr);
+  EXPECT_EQ(static_cast<int>(properties.rho.extent(0)), mesh.nspec);
+}
+
+TEST(COMPUTE_TESTS, compress_properties) {
+
+  std::string config_filename =
+      "../../../tests/unittests/compute/test_config.yml";
+  test_config test_config =
+      get_test_config(config_filename, MPIEnvironment::mpi_);
+
+  specfem::quadrature::quadrature gllx(0.0, 0.0, 5);
+  specfem::quadrature::quadrature gllz(0.0, 0.0, 5);
+  std::vector<specfem::material *> materials;
+
+  specfem::mesh mesh(test_config.database_filename, materials,
+                     MPIEnvironment::mpi_);
+  const auto kmato = mesh.material_ind.kmato;
+  const int ngll = gllx.get_N();
+
+  specfem::compute::properties properties(kmato, materials, mesh.nspec, ngll,
+                                          ngll);
+  ASSERT_TRUE(properties.compress(kmato));
+  EXPECT_FALSE(properties.rho.is_allocated());
+
+  // The accessors read the material table
+  const auto mu = properties.get_mu();
+  const auto lambdaplus2mu = properties.get_lambdaplus2mu();
+  specfem::kokkos::DeviceView3d<type_real> values(
+      "values", mesh.nspec, ngll, ngll);
+  specfem::kokkos::DeviceView3d<type_real> moduli(
+      "moduli", mesh.nspec, ngll, ngll);
+  Kokkos::parallel_for(
+      specfem::kokkos::DeviceMDrange<3>({ 0, 0, 0 },
+                                        { mesh.nspec, ngll, ngll }),
+      KOKKOS_LAMBDA(const int ispec, const int iz, const int ix) {
+        values(ispec, iz, ix) = mu(ispec, iz, ix);
+        moduli(ispec, iz, ix) = lambdaplus2mu(ispec, iz, ix);
+      });
+  const auto h_values =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), values);
+  const auto h_moduli =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), moduli);
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    for (int iz = 0; iz < ngll; iz++) {
+      for (int ix = 0; ix < ngll; ix++) {
+        EXPECT_EQ(h_values(ispec, iz, ix), properties.h_mu(ispec, iz, ix));
+        EXPECT_EQ(h_moduli(ispec, iz, ix),
+                  properties.h_lambdaplus2mu(ispec, iz, ix));
+      }
+    }
+  }
+
+  // Models varying inside a material are stored at every quadrature point
+  specfem::compute::properties varying(kmato, materials, mesh.nspec, ngll,
+                                       ngll);
+  varying.h_rho(0, 0, 0) *= 2.0;
+  EXPECT_FALSE(varying.compress(kmato));
+  EXPECT_FALSE(varying.compressed());
+  EXPECT_TRUE(varying.rho.is_allocated());
+}
+
 int main(int argc, char *argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
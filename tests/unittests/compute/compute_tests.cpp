@@ -81,6 +81,203 @@ TEST(COMPUTE_TESTS, compute_ibool) {
                                    mesh.nspec, gllz.get_N(), gllx.get_N()));
 }
 
+/**
+ * Numbering of a 2x2 mesh where an element is rotated, i.e. its first corner
+ * isn't the lower left corner, such that shared edges run in opposite
+ * directions in neighbouring elements
+ *
+ */
+TEST(COMPUTE_TESTS, compute_ibool_rotated_element) {
+
+  specfem::quadrature::quadrature gllx(0.0, 0.0, 5);
+  specfem::quadrature::quadrature gllz(0.0, 0.0, 5);
+  const int ngll = gllx.get_N();
+
+  // 3x3 control nodes on a unit grid
+  specfem::kokkos::HostView2d<type_real> coorg("coorg", ndim, 9);
+  for (int inode = 0; inode < 9; inode++) {
+    coorg(0, inode) = inode % 3;
+    coorg(1, inode) = inode / 3;
+  }
+
+  const int nspec = 4;
+  const int corners[nspec][4] = {
+    { 0, 1, 4, 3 }, { 1, 2, 5, 4 }, { 3, 4, 7, 6 }, { 8, 7, 4, 5 }
+  };
+  specfem::kokkos::HostView2d<int> knods("knods", 4, nspec);
+  for (int ispec = 0; ispec < nspec; ispec++)
+    for (int icorner = 0; icorner < 4; icorner++)
+      knods(icorner, ispec) = corners[ispec][icorner];
+
+  specfem::compute::compute compute(coorg, knods, gllx, gllz);
+
+  const int nglob = compute.coordinates.coord.extent(1);
+  EXPECT_EQ(nglob, (2 * (ngll - 1) + 1) * (2 * (ngll - 1) + 1));
+  EXPECT_EQ(compute.coordinates.xmin, 0.0);
+  EXPECT_EQ(compute.coordinates.xmax, 2.0);
+  EXPECT_EQ(compute.coordinates.zmin, 0.0);
+  EXPECT_EQ(compute.coordinates.zmax, 2.0);
+
+  // Every element shares control node 4 at (1, 1)
+  const int positions[4][2] = { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } };
+  int center = -1;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int icorner = 0; icorner < 4; icorner++) {
+      if (knods(icorner, ispec) != 4)
+        continue;
+      const int iglob =
+          compute.h_ibool(ispec, positions[icorner][0] * (ngll - 1),
+                          positions[icorner][1] * (ngll - 1));
+      if (center < 0)
+        center = iglob;
+      EXPECT_EQ(iglob, center);
+    }
+  }
+  EXPECT_NEAR(compute.coordinates.coord(0, center), 1.0, 1e-6);
+  EXPECT_NEAR(compute.coordinates.coord(1, center), 1.0, 1e-6);
+
+  // The edge from node 4 to node 5 is shared by elements 1 and 3
+  for (int t = 0; t < ngll; t++) {
+    EXPECT_EQ(compute.h_ibool(1, ngll - 1, t),
+              compute.h_ibool(3, ngll - 1, ngll - 1 - t));
+  }
+}
+
+TEST(COMPUTE_TESTS, compress_connectivity) {
+
+  std::string config_filename =
+      "../../../tests/unittests/compute/test_config.yml";
+  test_config test_config =
+      get_test_config(config_filename, MPIEnvironment::mpi_);
+
+  specfem::quadrature::quadrature gllx(0.0, 0.0, 5);
+  specfem::quadrature::quadrature gllz(0.0, 0.0, 5);
+  const int ngll = gllx.get_N();
+  std::vector<specfem::material *> materials;
+
+  specfem::mesh mesh(test_config.database_filename, materials,
+                     MPIEnvironment::mpi_);
+
+  specfem::compute::compute reference(mesh.coorg, mesh.material_ind.knods,
+                                      gllx, gllz);
+  specfem::compute::compute compute(mesh.coorg, mesh.material_ind.knods, gllx,
+                                    gllz);
+  ASSERT_TRUE(compute.compress_connectivity());
+  ASSERT_TRUE(compute.compressed());
+
+  // Renumbered points keep their coordinates and interior points of every
+  // element are consecutive
+  const int nglob = compute.coordinates.coord.extent(1);
+  EXPECT_EQ(nglob,
+            static_cast<int>(reference.coordinates.coord.extent(1)));
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    for (int iz = 0; iz < ngll; iz++) {
+      for (int ix = 0; ix < ngll; ix++) {
+        const int iglob = compute.h_ibool(ispec, iz, ix);
+        const int jglob = reference.h_ibool(ispec, iz, ix);
+        ASSERT_GE(iglob, 0);
+        ASSERT_LT(iglob, nglob);
+        EXPECT_EQ(compute.coordinates.coord(0, iglob),
+                  reference.coordinates.coord(0, jglob));
+        EXPECT_EQ(compute.coordinates.coord(1, iglob),
+                  reference.coordinates.coord(1, jglob));
+        if (iz > 0 && iz < ngll - 1 && ix > 0 && ix < ngll - 1) {
+          EXPECT_EQ(iglob, compute.h_ibool(ispec, 1, 1) +
+                               (iz - 1) * (ngll - 2) + (ix - 1));
+        }
+      }
+    }
+  }
+
+  // The accessor decodes the global numbering on the device
+  const auto ibool = compute.get_ibool();
+  specfem::kokkos::DeviceView3d<int> decoded("decoded", mesh.nspec, ngll,
+                                             ngll);
+  Kokkos::parallel_for(
+      specfem::kokkos::DeviceMDrange<3>({ 0, 0, 0 },
+                                        { mesh.nspec, ngll, ngll }),
+      KOKKOS_LAMBDA(const int ispec, const int iz, const int ix) {
+        decoded(ispec, iz, ix) = ibool(ispec, iz, ix);
+      });
+  const auto h_decoded =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), decoded);
+  for (int ispec = 0; ispec < mesh.nspec; ispec++)
+    for (int iz = 0; iz < ngll; iz++)
+      for (int ix = 0; ix < ngll; ix++)
+        EXPECT_EQ(h_decoded(ispec, iz, ix), compute.h_ibool(ispec, iz, ix));
+}
+
+/**
+ * Structured blocks of a 3x2 mesh of unit elements, where the last element of
+ * the first row is rotated. Points of every element are rows of the tile of
+ * its block
+ *
+ */
+TEST(COMPUTE_TESTS, structured_blocks) {
+
+  specfem::quadrature::quadrature gllx(0.0, 0.0, 5);
+  specfem::quadrature::quadrature gllz(0.0, 0.0, 5);
+  const int ngll = gllx.get_N();
+
+  // 4x3 control nodes on a unit grid
+  specfem::kokkos::HostView2d<type_real> coorg("coorg", ndim, 12);
+  for (int inode = 0; inode < 12; inode++) {
+    coorg(0, inode) = inode % 4;
+    coorg(1, inode) = inode / 4;
+  }
+
+  const int nspec = 6;
+  const int corners[nspec][4] = { { 0, 1, 5, 4 },  { 1, 2, 6, 5 },
+                                  { 7, 6, 2, 3 },  { 4, 5, 9, 8 },
+                                  { 5, 6, 10, 9 }, { 6, 7, 11, 10 } };
+  specfem::kokkos::HostView2d<int> knods("knods", 4, nspec);
+  for (int ispec = 0; ispec < nspec; ispec++)
+    for (int icorner = 0; icorner < 4; icorner++)
+      knods(icorner, ispec) = corners[ispec][icorner];
+
+  specfem::compute::compute reference(coorg, knods, gllx, gllz);
+  specfem::compute::compute compute(coorg, knods, gllx, gllz);
+  ASSERT_FALSE(compute.structured());
+
+  // The rotated element doesn't follow the orientation of its neighbours,
+  // hence the block is made of the first 2 columns. The last element of the
+  // second row is left out since blocks are rectangular
+  const auto [nblocks, nstructured] = compute.assign_structured_blocks(knods);
+  EXPECT_EQ(nblocks, 1);
+  EXPECT_EQ(nstructured, 4);
+  ASSERT_TRUE(compute.structured());
+
+  const int nglob = compute.coordinates.coord.extent(1);
+  EXPECT_EQ(nglob,
+            static_cast<int>(reference.coordinates.coord.extent(1)));
+  const auto tiles = compute.h_structured_tiles;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    const bool structured = (ispec % 3 != 2);
+    EXPECT_EQ(tiles(ispec, 1) != 0, structured);
+    for (int iz = 0; iz < ngll; iz++) {
+      for (int ix = 0; ix < ngll; ix++) {
+        const int iglob = compute.h_ibool(ispec, iz, ix);
+        const int jglob = reference.h_ibool(ispec, iz, ix);
+        ASSERT_GE(iglob, 0);
+        ASSERT_LT(iglob, nglob);
+        EXPECT_EQ(compute.coordinates.coord(0, iglob),
+                  reference.coordinates.coord(0, jglob));
+        EXPECT_EQ(compute.coordinates.coord(1, iglob),
+                  reference.coordinates.coord(1, jglob));
+        if (structured) {
+          EXPECT_EQ(iglob, tiles(ispec, 0) + iz * tiles(ispec, 1) + ix);
+        }
+      }
+    }
+  }
+
+  // Neighbouring elements of the block have different parities
+  EXPECT_EQ(tiles(0, 2), 0);
+  EXPECT_EQ(tiles(1, 2), 1);
+  EXPECT_EQ(tiles(3, 2), 2);
+  EXPECT_EQ(tiles(4, 2), 3);
+}
+
 int main(int argc, char *argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
@@ -0,0 +1,222 @@
+#include "../../../include/compute.h"
+#include "../../../include/coupling.h"
+#include "../../../include/domain.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/material.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/source.h"
+#include "../../../include/surfaces.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include "yaml-cpp/yaml.h"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+// Two 4 node elements of unit size placed next to each other along x, the
+// first one acoustic and the second one elastic. The fluid-solid edge is the
+// right side of the acoustic element, at x = 1
+struct fluid_solid_setup {
+  specfem::kokkos::HostView2d<type_real> coorg;
+  specfem::kokkos::HostView2d<int> knods;
+  specfem::kokkos::HostView1d<int> kmato;
+  std::vector<specfem::material *> materials;
+  specfem::quadrature::quadrature gll;
+  specfem::surfaces::fluid_solid_edges edges;
+
+  fluid_solid_setup()
+      : coorg("coupling_tests::coorg", ndim, 6),
+        knods("coupling_tests::knods", 4, 2),
+        kmato("coupling_tests::kmato", 2), gll(0.0, 0.0, 5), edges(1) {
+    for (int iz = 0; iz < 2; iz++) {
+      for (int ix = 0; ix < 3; ix++) {
+        coorg(0, iz * 3 + ix) = ix;
+        coorg(1, iz * 3 + ix) = iz;
+      }
+    }
+    for (int ispec = 0; ispec < 2; ispec++) {
+      knods(0, ispec) = ispec;
+      knods(1, ispec) = ispec + 1;
+      knods(2, ispec) = ispec + 4;
+      knods(3, ispec) = ispec + 3;
+      kmato(ispec) = ispec;
+    }
+    edges.ispec_acoustic(0) = 0;
+    edges.ispec_elastic(0) = 1;
+
+    specfem::utilities::input_holder holder;
+    holder.val0 = 1000.0;
+    holder.val1 = 1500.0;
+    holder.val2 = 0.0;
+    holder.val3 = 0.0;
+    holder.val5 = 9999.0;
+    holder.val6 = 9999.0;
+    materials.push_back(new specfem::acoustic_material());
+    materials[0]->assign(holder);
+
+    holder.val0 = 2700.0;
+    holder.val1 = 3000.0;
+    holder.val2 = 1732.0;
+    materials.push_back(new specfem::elastic_material());
+    materials[1]->assign(holder);
+  }
+
+  ~fluid_solid_setup() {
+    for (auto &material : materials)
+      delete material;
+  }
+};
+
+// Structs read by the domains, the domains and their coupling
+struct coupled_setup {
+  fluid_solid_setup mesh;
+  specfem::compute::compute compute;
+  specfem::compute::partial_derivatives partial_derivatives;
+  specfem::compute::properties properties;
+  specfem::compute::sources sources;
+  specfem::compute::receivers receivers;
+  specfem::Domain::Acoustic fluid;
+  specfem::Domain::Elastic solid;
+  specfem::coupling::fluid_solid coupling;
+
+  coupled_setup(const std::vector<specfem::sources::source *> &forces = {})
+      : compute(mesh.coorg, mesh.knods, mesh.gll, mesh.gll),
+        partial_derivatives(mesh.coorg, mesh.knods, mesh.gll, mesh.gll),
+        properties(mesh.kmato, mesh.materials, 2, mesh.gll.get_N(),
+                   mesh.gll.get_N()),
+        sources(locate(forces), mesh.gll, mesh.gll, compute.coordinates.xmax,
+                compute.coordinates.xmin, compute.coordinates.zmax,
+                compute.coordinates.zmin, MPIEnvironment::mpi_),
+        fluid(ndim, &compute, &properties, &partial_derivatives, &sources,
+              &receivers, &mesh.gll, &mesh.gll),
+        solid(ndim, specfem::utilities::compute_nglob(compute.h_ibool),
+              &compute, &properties, &partial_derivatives, &sources,
+              &receivers, &mesh.gll, &mesh.gll),
+        coupling(mesh.edges, mesh.knods, &compute, &mesh.gll, &mesh.gll,
+                 &fluid, &solid, 1) {}
+
+  // Sources are located before the structs of the domains are built
+  std::vector<specfem::sources::source *>
+  locate(const std::vector<specfem::sources::source *> &forces) {
+    specfem::sources::locate(forces, compute.coordinates.coord,
+                             compute.h_ibool, mesh.gll.get_hxi(),
+                             mesh.gll.get_hxi(), mesh.coorg, mesh.knods,
+                             properties.h_ispec_type, MPIEnvironment::mpi_);
+    return forces;
+  }
+};
+
+TEST(FLUID_SOLID_COUPLING, NORMALS) {
+  coupled_setup setup;
+
+  // Normals point out of the fluid and integrate to the length of the edge
+  ASSERT_EQ(setup.coupling.get_npoints(), setup.mesh.gll.get_N());
+  const auto normal = setup.coupling.get_host_normal();
+  type_real length = 0.0;
+  for (int ipoint = 0; ipoint < setup.coupling.get_npoints(); ipoint++) {
+    EXPECT_GT(normal(ipoint, 0), 0.0);
+    EXPECT_NEAR(normal(ipoint, 1), 0.0, 1e-6);
+    length += normal(ipoint, 0);
+  }
+  EXPECT_NEAR(length, 1.0, 1e-5);
+}
+
+TEST(FLUID_SOLID_COUPLING, FLUID_COUPLING) {
+  coupled_setup setup;
+
+  // Uniform displacement along x crosses the edge
+  const auto displacement = setup.solid.get_host_field();
+  for (int iglob = 0; iglob < displacement.extent(0); iglob++) {
+    displacement(iglob, 0) = 1.0;
+    displacement(iglob, 1) = 2.0;
+  }
+  setup.solid.sync_field(specfem::sync::HostToDevice);
+
+  setup.coupling.compute_fluid_coupling();
+  Kokkos::fence();
+  setup.fluid.sync_field_dot_dot(specfem::sync::DeviceToHost);
+
+  const auto potential_dot_dot = setup.fluid.get_host_field_dot_dot();
+  type_real flux = 0.0;
+  for (int iacoustic = 0; iacoustic < potential_dot_dot.extent(0); iacoustic++)
+    flux += potential_dot_dot(iacoustic, 0);
+  EXPECT_NEAR(flux, 1.0, 1e-5);
+}
+
+TEST(FLUID_SOLID_COUPLING, SOLID_COUPLING) {
+  coupled_setup setup;
+
+  // Uniform pressure of -1 pulls the solid towards the fluid
+  const auto potential_dot_dot = setup.fluid.get_host_field_dot_dot();
+  for (int iacoustic = 0; iacoustic < potential_dot_dot.extent(0); iacoustic++)
+    potential_dot_dot(iacoustic, 0) = 1.0;
+  setup.fluid.sync_field_dot_dot(specfem::sync::HostToDevice);
+
+  setup.coupling.compute_solid_coupling();
+  Kokkos::fence();
+  setup.solid.sync_field_dot_dot(specfem::sync::DeviceToHost);
+
+  const auto acceleration = setup.solid.get_host_field_dot_dot();
+  const auto coord = setup.compute.coordinates.coord;
+  type_real force_x = 0.0;
+  type_real force_z = 0.0;
+  for (int iglob = 0; iglob < acceleration.extent(0); iglob++) {
+    if (std::abs(coord(0, iglob) - 1.0) > 1e-6) {
+      EXPECT_EQ(acceleration(iglob, 0), 0.0);
+    }
+    force_x += acceleration(iglob, 0);
+    force_z += acceleration(iglob, 1);
+  }
+  EXPECT_NEAR(force_x, -1.0, 1e-5);
+  EXPECT_NEAR(force_z, 0.0, 1e-6);
+}
+
+TEST(FLUID_SOLID_COUPLING, DISPATCH_TABLES) {
+  // One force in the middle of every element
+  std::vector<specfem::sources::source *> forces;
+  for (const type_real x : { 0.5, 1.5 }) {
+    YAML::Node Node = YAML::Load("{ z: 0.5, angle: 0.0, "
+                                 "Dirac: { tshift: 0.0, factor: 1.0 } }");
+    Node["x"] = x;
+    forces.push_back(new specfem::sources::force(Node, 1e-3));
+  }
+
+  {
+    coupled_setup setup(forces);
+    ASSERT_EQ(setup.sources.h_ispec_array.extent(0), 2);
+
+    // Every domain launches over the source inside its elements only
+    const double ngll2 = setup.mesh.gll.get_N() * setup.mesh.gll.get_N();
+    EXPECT_DOUBLE_EQ(setup.fluid.get_cost(specfem::timers::sources).bytes,
+                     ngll2 * (sizeof(int) + 3 * sizeof(type_real)));
+    EXPECT_DOUBLE_EQ(setup.solid.get_cost(specfem::timers::sources).bytes,
+                     ngll2 * (sizeof(int) + 6 * sizeof(type_real)));
+
+    setup.fluid.compute_source_interaction(0.0);
+    setup.solid.compute_source_interaction(0.0);
+    Kokkos::fence();
+    setup.solid.sync_field_dot_dot(specfem::sync::DeviceToHost);
+
+    // The acoustic source doesn't act on the solid
+    const auto acceleration = setup.solid.get_host_field_dot_dot();
+    const auto coord = setup.compute.coordinates.coord;
+    for (int iglob = 0; iglob < acceleration.extent(0); iglob++) {
+      if (coord(0, iglob) < 1.0 - 1e-6) {
+        EXPECT_EQ(acceleration(iglob, 0), 0.0);
+        EXPECT_EQ(acceleration(iglob, 1), 0.0);
+      }
+    }
+  }
+
+  for (auto &force : forces)
+    delete force;
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,92 @@
+#include "../../../include/courant.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../Kokkos_Environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+// Two 2 x 2 GLL point elements placed next to each other along x. Element 0
+// spans [0, 1] x [0, 1] and element 1 spans [1, 3] x [0, 1]
+struct two_element_mesh {
+  specfem::kokkos::HostView2d<type_real> coord;
+  specfem::kokkos::HostElementMirror3d<int> ibool;
+  specfem::kokkos::HostElementMirror3d<type_real> rho;
+  specfem::kokkos::HostElementView3d<type_real> rho_vp;
+  specfem::kokkos::HostElementView3d<type_real> rho_vs;
+
+  two_element_mesh(const type_real vp0, const type_real vp1)
+      : coord("courant_tests::coord", ndim, 6),
+        ibool("courant_tests::ibool", 2, 2, 2),
+        rho("courant_tests::rho", 2, 2, 2),
+        rho_vp("courant_tests::rho_vp", 2, 2, 2),
+        rho_vs("courant_tests::rho_vs", 2, 2, 2) {
+    const std::vector<type_real> x = { 0.0, 1.0, 3.0 };
+    for (int iz = 0; iz < 2; iz++) {
+      for (int ix = 0; ix < 3; ix++) {
+        coord(0, iz * 3 + ix) = x[ix];
+        coord(1, iz * 3 + ix) = iz;
+      }
+    }
+
+    const type_real vp[2] = { vp0, vp1 };
+    for (int ispec = 0; ispec < 2; ispec++) {
+      for (int iz = 0; iz < 2; iz++) {
+        for (int ix = 0; ix < 2; ix++) {
+          ibool(ispec, iz, ix) = iz * 3 + ispec + ix;
+          rho(ispec, iz, ix) = 2.0;
+          rho_vp(ispec, iz, ix) = 2.0 * vp[ispec];
+          rho_vs(ispec, iz, ix) = 2.0 * vp[ispec] / 2.0;
+        }
+      }
+    }
+  }
+};
+
+TEST(COURANT_TESTS, LIMITING_ELEMENT) {
+  two_element_mesh mesh(2.0, 1.0);
+
+  const auto timestep = specfem::courant::compute_stable_timestep(
+      mesh.coord, mesh.ibool, mesh.rho, mesh.rho_vp, mesh.rho_vs);
+
+  const type_real courant = specfem::courant::courant_number_max;
+  EXPECT_NEAR(timestep.dt, courant * 1.0 / 2.0, 1e-6);
+  ASSERT_EQ(timestep.limiting_elements.size(), 2);
+  EXPECT_EQ(timestep.limiting_elements[0], 0);
+  EXPECT_EQ(timestep.limiting_elements[1], 1);
+  EXPECT_NEAR(timestep.element_dt[1], courant * 1.0 / 1.0, 1e-6);
+  EXPECT_NEAR(timestep.element_dmin[0], 1.0, 1e-6);
+  EXPECT_NEAR(timestep.element_vmax[0], 2.0, 1e-6);
+}
+
+TEST(COURANT_TESTS, NREPORT) {
+  two_element_mesh mesh(1.0, 4.0);
+
+  const auto timestep = specfem::courant::compute_stable_timestep(
+      mesh.coord, mesh.ibool, mesh.rho, mesh.rho_vp, mesh.rho_vs, 1);
+
+  EXPECT_NEAR(timestep.dt, specfem::courant::courant_number_max / 4.0, 1e-6);
+  ASSERT_EQ(timestep.limiting_elements.size(), 1);
+  EXPECT_EQ(timestep.limiting_elements[0], 1);
+}
+
+TEST(COURANT_TESTS, ELEMENT_LEVELS) {
+  const std::vector<type_real> element_dt = { 1.0, 0.6, 0.5, 0.3, 0.26 };
+
+  const auto levels =
+      specfem::courant::compute_element_levels(element_dt, 1.0, 3);
+
+  const std::vector<int> expected = { 0, 1, 1, 2, 2 };
+  EXPECT_EQ(levels, expected);
+
+  // 0.2 needs dt / 8
+  const std::vector<type_real> unstable_dt = { 1.0, 0.2 };
+  EXPECT_THROW(specfem::courant::compute_element_levels(unstable_dt, 1.0, 3),
+               std::runtime_error);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
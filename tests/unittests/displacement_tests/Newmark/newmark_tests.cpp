@@ -43,7 +43,12 @@ test_config parse_test_config(std::string test_configuration_file,
 
 // ------------------------------------- //
 
-TEST(DISPLACEMENT_TESTS, newmark_scheme_tests) {
+// Run the simulation described in test config and compare the displacement
+// against the reference solution
+void run_newmark_test(const specfem::Domain::options &options,
+                      const bool graph_execution = false,
+                      const bool static_dispatch = true,
+                      const int max_stf_table_size = 0) {
   std::string config_filename =
       "../../../tests/unittests/displacement_tests/Newmark/test_config.yaml";
 
@@ -112,14 +117,24 @@ TEST(DISPLACEMENT_TESTS, newmark_scheme_tests) {
                                             zmax, zmin, mpi);
   specfem::compute::receivers compute_receivers;
 
+  if (max_stf_table_size > 0)
+    compute_sources.tabulate_stf(it->get_time(), setup.get_dt(),
+                                 it->get_max_timestep() + 2,
+                                 max_stf_table_size);
+
   // Instantiate domain classes
   const int nglob = specfem::utilities::compute_nglob(compute.h_ibool);
   specfem::Domain::Domain *domains = new specfem::Domain::Elastic(
       ndim, nglob, &compute, &material_properties, &partial_derivatives,
-      &compute_sources, &compute_receivers, &gllx, &gllz);
+      &compute_sources, &compute_receivers, &gllx, &gllz, options);
 
+  // Runtime dispatched solvers call domain and timescheme methods through
+  // the base classes
   specfem::solver::solver *solver =
-      new specfem::solver::time_marching(domains, it);
+      static_dispatch
+          ? specfem::solver::instantiate_time_marching(domains, it,
+                                                       graph_execution)
+          : new specfem::solver::time_marching(domains, it, graph_execution);
 
   solver->run();
 
@@ -133,6 +148,62 @@ TEST(DISPLACEMENT_TESTS, newmark_scheme_tests) {
       field, test_config.solutions_file, nglob, ndim, tolerance));
 }
 
+TEST(DISPLACEMENT_TESTS, newmark_scheme_tests) {
+  specfem::Domain::options options;
+  run_newmark_test(options);
+}
+
+TEST(DISPLACEMENT_TESTS, newmark_scheme_colored_assembly_tests) {
+  specfem::Domain::options options;
+  options.assembly = specfem::assembly::colored;
+  run_newmark_test(options);
+}
+
+TEST(DISPLACEMENT_TESTS, newmark_scheme_packed_element_data_tests) {
+  specfem::Domain::options options;
+  options.packed_element_data = true;
+  run_newmark_test(options);
+}
+
+TEST(DISPLACEMENT_TESTS, newmark_scheme_quantized_element_data_tests) {
+  specfem::Domain::options options;
+  options.quantized_element_data = true;
+  run_newmark_test(options);
+}
+
+TEST(DISPLACEMENT_TESTS, newmark_scheme_active_elements_tests) {
+  specfem::Domain::options options;
+  options.active_elements = true;
+  run_newmark_test(options);
+}
+
+TEST(DISPLACEMENT_TESTS, newmark_scheme_host_offload_tests) {
+  specfem::Domain::options options;
+  options.host_offload = true;
+  options.host_fraction = 0.2;
+  run_newmark_test(options);
+}
+
+TEST(DISPLACEMENT_TESTS, newmark_scheme_graph_execution_tests) {
+  specfem::Domain::options options;
+  run_newmark_test(options, true);
+}
+
+TEST(DISPLACEMENT_TESTS, newmark_scheme_runtime_dispatch_tests) {
+  specfem::Domain::options options;
+  run_newmark_test(options, false, false);
+}
+
+TEST(DISPLACEMENT_TESTS, newmark_scheme_stf_table_tests) {
+  specfem::Domain::options options;
+  run_newmark_test(options, false, true, 1 << 24);
+}
+
+TEST(DISPLACEMENT_TESTS, newmark_scheme_streamed_stf_table_tests) {
+  specfem::Domain::options options;
+  run_newmark_test(options, false, true, 64);
+}
+
 int main(int argc, char *argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
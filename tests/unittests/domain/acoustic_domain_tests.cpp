@@ -0,0 +1,164 @@
+#include "../../../include/compute.h"
+#include "../../../include/domain.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/material.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+constexpr type_real rho = 1000.0;
+constexpr type_real cp = 1500.0;
+
+// Two 4 node elements of unit size placed next to each other along x, and
+// one acoustic material
+struct two_element_setup {
+  specfem::kokkos::HostView2d<type_real> coorg;
+  specfem::kokkos::HostView2d<int> knods;
+  specfem::kokkos::HostView1d<int> kmato;
+  std::vector<specfem::material *> materials;
+  specfem::quadrature::quadrature gll;
+
+  two_element_setup()
+      : coorg("acoustic_domain_tests::coorg", ndim, 6),
+        knods("acoustic_domain_tests::knods", 4, 2),
+        kmato("acoustic_domain_tests::kmato", 2), gll(0.0, 0.0, 5) {
+    for (int iz = 0; iz < 2; iz++) {
+      for (int ix = 0; ix < 3; ix++) {
+        coorg(0, iz * 3 + ix) = ix;
+        coorg(1, iz * 3 + ix) = iz;
+      }
+    }
+    for (int ispec = 0; ispec < 2; ispec++) {
+      knods(0, ispec) = ispec;
+      knods(1, ispec) = ispec + 1;
+      knods(2, ispec) = ispec + 4;
+      knods(3, ispec) = ispec + 3;
+      kmato(ispec) = 0;
+    }
+
+    specfem::utilities::input_holder holder;
+    holder.val0 = rho;
+    holder.val1 = cp;
+    holder.val2 = 0.0;
+    holder.val3 = 0.0;
+    holder.val5 = 9999.0;
+    holder.val6 = 9999.0;
+    materials.push_back(new specfem::acoustic_material());
+    materials[0]->assign(holder);
+  }
+
+  ~two_element_setup() {
+    for (auto &material : materials)
+      delete material;
+  }
+};
+
+// Structs read by the domain, and the domain
+struct acoustic_setup {
+  two_element_setup mesh;
+  specfem::compute::compute compute;
+  specfem::compute::partial_derivatives partial_derivatives;
+  specfem::compute::properties properties;
+  specfem::compute::sources sources;
+  specfem::compute::receivers receivers;
+  specfem::Domain::Acoustic domain;
+
+  acoustic_setup(const specfem::Domain::options &options = {})
+      : compute(mesh.coorg, mesh.knods, mesh.gll, mesh.gll),
+        partial_derivatives(mesh.coorg, mesh.knods, mesh.gll, mesh.gll),
+        properties(mesh.kmato, mesh.materials, 2, mesh.gll.get_N(),
+                   mesh.gll.get_N()),
+        sources({}, mesh.gll, mesh.gll, compute.coordinates.xmax,
+                compute.coordinates.xmin, compute.coordinates.zmax,
+                compute.coordinates.zmin, MPIEnvironment::mpi_),
+        domain(ndim, &compute, &properties, &partial_derivatives, &sources,
+               &receivers, &mesh.gll, &mesh.gll, options) {}
+};
+
+TEST(ACOUSTIC_DOMAIN, NUMBERING) {
+  specfem::Domain::options options;
+  options.nshots = 2;
+  acoustic_setup setup(options);
+
+  // A single component is stored for every shot
+  const int nglob = specfem::utilities::compute_nglob(setup.compute.h_ibool);
+  const auto field = setup.domain.get_host_field();
+  ASSERT_EQ(field.extent(0), nglob);
+  EXPECT_EQ(field.extent(1), 2);
+
+  const auto global_index = setup.domain.get_host_global_index();
+  ASSERT_EQ(global_index.extent(0), nglob);
+  std::vector<bool> found(nglob, false);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    ASSERT_GE(global_index(iglob), 0);
+    ASSERT_LT(global_index(iglob), nglob);
+    EXPECT_FALSE(found[global_index(iglob)]);
+    found[global_index(iglob)] = true;
+  }
+}
+
+TEST(ACOUSTIC_DOMAIN, MASS_MATRIX) {
+  acoustic_setup setup;
+  setup.domain.sync_rmass_inverse(specfem::sync::DeviceToHost);
+
+  // Mass of the potential integrates the inverse of the bulk modulus
+  const auto rmass_inverse = setup.domain.get_host_rmass_inverse();
+  double mass = 0.0;
+  for (int iglob = 0; iglob < rmass_inverse.extent(0); iglob++)
+    mass += 1.0 / rmass_inverse(iglob);
+
+  const double kappa = rho * cp * cp;
+  EXPECT_NEAR(mass * kappa, 2.0, 1e-4);
+}
+
+TEST(ACOUSTIC_DOMAIN, STIFFNESS) {
+  for (const auto assembly :
+       { specfem::assembly::atomic, specfem::assembly::colored }) {
+    specfem::Domain::options options;
+    options.assembly = assembly;
+    acoustic_setup setup(options);
+
+    // Potential equal to x has a uniform gradient, hence only points on the
+    // vertical boundaries are accelerated
+    const auto coord = setup.compute.coordinates.coord;
+    const auto global_index = setup.domain.get_host_global_index();
+    const int nglob = global_index.extent(0);
+    const auto field = setup.domain.get_host_field();
+    for (int iglob = 0; iglob < nglob; iglob++)
+      field(iglob, 0) = coord(0, global_index(iglob));
+    setup.domain.sync_field(specfem::sync::HostToDevice);
+
+    setup.domain.compute_stiffness_interaction();
+    Kokkos::fence();
+    setup.domain.sync_field_dot_dot(specfem::sync::DeviceToHost);
+
+    const auto field_dot_dot = setup.domain.get_host_field_dot_dot();
+    double left = 0.0;
+    double right = 0.0;
+    for (int iglob = 0; iglob < nglob; iglob++) {
+      const type_real x = coord(0, global_index(iglob));
+      if (std::abs(x) < 1e-6) {
+        left += field_dot_dot(iglob, 0);
+      } else if (std::abs(x - 2.0) < 1e-6) {
+        right += field_dot_dot(iglob, 0);
+      } else {
+        EXPECT_NEAR(field_dot_dot(iglob, 0) * rho, 0.0, 1e-4);
+      }
+    }
+
+    EXPECT_NEAR(left * rho, 1.0, 1e-4);
+    EXPECT_NEAR(right * rho, -1.0, 1e-4);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
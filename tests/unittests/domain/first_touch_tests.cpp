@@ -0,0 +1,144 @@
+#include "../../../include/compute.h"
+#include "../../../include/first_touch.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+// Two 4 node elements of unit size placed next to each other along x
+struct two_element_setup {
+  specfem::kokkos::HostView2d<type_real> coorg;
+  specfem::kokkos::HostView2d<int> knods;
+  specfem::quadrature::quadrature gll;
+
+  two_element_setup()
+      : coorg("first_touch_tests::coorg", ndim, 6),
+        knods("first_touch_tests::knods", 4, 2), gll(0.0, 0.0, 5) {
+    for (int iz = 0; iz < 2; iz++) {
+      for (int ix = 0; ix < 3; ix++) {
+        coorg(0, iz * 3 + ix) = ix;
+        coorg(1, iz * 3 + ix) = iz;
+      }
+    }
+    for (int ispec = 0; ispec < 2; ispec++) {
+      knods(0, ispec) = ispec;
+      knods(1, ispec) = ispec + 1;
+      knods(2, ispec) = ispec + 4;
+      knods(3, ispec) = ispec + 3;
+    }
+  }
+};
+
+// Points shared by both elements belong to the element launched first
+TEST(FIRST_TOUCH, POINT_LAUNCHES) {
+  two_element_setup setup;
+  specfem::compute::compute compute(setup.coorg, setup.knods, setup.gll,
+                                    setup.gll);
+  const int nglob = specfem::utilities::compute_nglob(compute.h_ibool);
+
+  const auto points = specfem::first_touch::point_launches(
+      { { 1 }, { 0 } }, compute.h_ibool, nglob);
+  ASSERT_EQ(points.size(), 2);
+  EXPECT_EQ(points[0].size(), 25);
+  EXPECT_EQ(points[1].size(), 20);
+
+  std::vector<int> count(nglob, 0);
+  for (const auto &launch : points) {
+    for (const int iglob : launch)
+      count[iglob]++;
+  }
+  for (int iglob = 0; iglob < nglob; iglob++)
+    EXPECT_EQ(count[iglob], 1);
+}
+
+// Placed views keep their label, extents and values, including the values of
+// elements and points which aren't launched
+TEST(FIRST_TOUCH, PLACE) {
+  specfem::kokkos::DeviceElementView3d<type_real> element(
+      "first_touch_tests::element", 3, 2, 2);
+  specfem::kokkos::DeviceFieldView2d<type_real> field(
+      "first_touch_tests::field", 5, 2);
+  specfem::kokkos::DeviceView1d<type_real> mass("first_touch_tests::mass", 5);
+
+  auto h_element = Kokkos::create_mirror_view(element);
+  auto h_field = Kokkos::create_mirror_view(field);
+  auto h_mass = Kokkos::create_mirror_view(mass);
+  for (int ispec = 0; ispec < 3; ispec++) {
+    for (int iz = 0; iz < 2; iz++) {
+      for (int ix = 0; ix < 2; ix++)
+        h_element(ispec, iz, ix) = 100 * ispec + 10 * iz + ix;
+    }
+  }
+  for (int iglob = 0; iglob < 5; iglob++) {
+    h_field(iglob, 0) = iglob;
+    h_field(iglob, 1) = -1.0 * iglob;
+    h_mass(iglob) = 0.5 * iglob;
+  }
+  Kokkos::deep_copy(element, h_element);
+  Kokkos::deep_copy(field, h_field);
+  Kokkos::deep_copy(mass, h_mass);
+
+  specfem::first_touch::place(element, { { 2 }, { 0 } });
+  specfem::first_touch::place(field, { { 4, 1 }, { 3 } });
+  specfem::first_touch::place(mass, { { 4, 1 }, { 3 } });
+
+  EXPECT_EQ(element.label(), "first_touch_tests::element");
+  ASSERT_EQ(element.extent(0), 3);
+  ASSERT_EQ(field.extent(0), 5);
+  ASSERT_EQ(field.extent(1), 2);
+  ASSERT_EQ(mass.extent(0), 5);
+
+  const auto placed_element =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), element);
+  const auto placed_field =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), field);
+  const auto placed_mass =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), mass);
+  for (int ispec = 0; ispec < 3; ispec++) {
+    for (int iz = 0; iz < 2; iz++) {
+      for (int ix = 0; ix < 2; ix++)
+        EXPECT_EQ(placed_element(ispec, iz, ix), 100 * ispec + 10 * iz + ix);
+    }
+  }
+  for (int iglob = 0; iglob < 5; iglob++) {
+    EXPECT_EQ(placed_field(iglob, 0), iglob);
+    EXPECT_EQ(placed_field(iglob, 1), -1.0 * iglob);
+    EXPECT_EQ(placed_mass(iglob), 0.5 * iglob);
+  }
+}
+
+// Host mirrors of placed partial derivatives are the placed views on host
+// backends
+TEST(FIRST_TOUCH, PARTIAL_DERIVATIVES) {
+  two_element_setup setup;
+  specfem::compute::partial_derivatives partial_derivatives(
+      setup.coorg, setup.knods, setup.gll, setup.gll);
+  const auto jacobian = Kokkos::create_mirror_view_and_copy(
+      Kokkos::HostSpace(), partial_derivatives.jacobian);
+
+  specfem::first_touch::place(partial_derivatives, { { 1, 0 } });
+  if (Kokkos::SpaceAccessibility<Kokkos::HostSpace,
+                                 specfem::kokkos::DevMemSpace>::accessible) {
+    EXPECT_EQ(partial_derivatives.h_jacobian.data(),
+              partial_derivatives.jacobian.data());
+  }
+
+  for (int ispec = 0; ispec < 2; ispec++) {
+    for (int iz = 0; iz < setup.gll.get_N(); iz++) {
+      for (int ix = 0; ix < setup.gll.get_N(); ix++)
+        EXPECT_EQ(partial_derivatives.h_jacobian(ispec, iz, ix),
+                  jacobian(ispec, iz, ix));
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
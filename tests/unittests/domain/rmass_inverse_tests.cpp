@@ -121,9 +121,19 @@ TEST(DOMAIN_TESTS, rmass_inverse_elastic_test) {
 
   domains->sync_rmass_inverse(specfem::sync::DeviceToHost);
 
-  EXPECT_NO_THROW(
-      specfem::testing::test_array(domains->get_host_rmass_inverse(),
-                                   test_config.solutions_file, nglob, ndim));
+  // Mass matrix is stored once per global point, reference solution stores it
+  // for every component
+  const auto h_rmass_inverse = domains->get_host_rmass_inverse();
+  specfem::kokkos::HostView2d<type_real> rmass_inverse(
+      "rmass_inverse_tests::rmass_inverse", nglob, ndim);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    for (int idim = 0; idim < ndim; idim++) {
+      rmass_inverse(iglob, idim) = h_rmass_inverse(iglob);
+    }
+  }
+
+  EXPECT_NO_THROW(specfem::testing::test_array(
+      rmass_inverse, test_config.solutions_file, nglob, ndim));
 }
 
 int main(int argc, char *argv[]) {
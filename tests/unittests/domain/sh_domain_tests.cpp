@@ -0,0 +1,245 @@
+#include "../../../include/compute.h"
+#include "../../../include/domain.h"
+#include "../../../include/enums.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/material.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+constexpr type_real rho = 2700.0;
+constexpr type_real cp = 3000.0;
+constexpr type_real cs = 1732.0;
+constexpr int nex = 4;
+constexpr int nez = 3;
+
+// Grid of nex x nez skewed 4 node elements and one elastic material
+struct grid_setup {
+  specfem::kokkos::HostView2d<type_real> coorg;
+  specfem::kokkos::HostView2d<int> knods;
+  specfem::kokkos::HostView1d<int> kmato;
+  std::vector<specfem::material *> materials;
+  specfem::quadrature::quadrature gll;
+
+  grid_setup()
+      : coorg("sh_domain_tests::coorg", ndim, (nex + 1) * (nez + 1)),
+        knods("sh_domain_tests::knods", 4, nex * nez),
+        kmato("sh_domain_tests::kmato", nex * nez), gll(0.0, 0.0, 5) {
+    for (int iz = 0; iz <= nez; iz++) {
+      for (int ix = 0; ix <= nex; ix++) {
+        coorg(0, iz * (nex + 1) + ix) = ix + 0.1 * iz;
+        coorg(1, iz * (nex + 1) + ix) = iz + 0.05 * ix * ix;
+      }
+    }
+    for (int ez = 0; ez < nez; ez++) {
+      for (int ex = 0; ex < nex; ex++) {
+        const int ispec = ez * nex + ex;
+        const int inode = ez * (nex + 1) + ex;
+        knods(0, ispec) = inode;
+        knods(1, ispec) = inode + 1;
+        knods(2, ispec) = inode + nex + 2;
+        knods(3, ispec) = inode + nex + 1;
+        kmato(ispec) = 0;
+      }
+    }
+
+    specfem::utilities::input_holder holder;
+    holder.val0 = rho;
+    holder.val1 = cp;
+    holder.val2 = cs;
+    holder.val3 = 0.0;
+    holder.val5 = 9999.0;
+    holder.val6 = 9999.0;
+    materials.push_back(new specfem::elastic_material());
+    materials[0]->assign(holder);
+  }
+
+  ~grid_setup() {
+    for (auto &material : materials)
+      delete material;
+  }
+};
+
+// Structs read by an SH domain
+struct sh_setup {
+  grid_setup mesh;
+  specfem::compute::compute compute;
+  specfem::compute::partial_derivatives partial_derivatives;
+  specfem::compute::properties properties;
+  specfem::compute::sources sources;
+  specfem::compute::receivers receivers;
+
+  sh_setup()
+      : compute(mesh.coorg, mesh.knods, mesh.gll, mesh.gll),
+        partial_derivatives(mesh.coorg, mesh.knods, mesh.gll, mesh.gll),
+        properties(mesh.kmato, mesh.materials, nex * nez, mesh.gll.get_N(),
+                   mesh.gll.get_N()),
+        sources({}, mesh.gll, mesh.gll, compute.coordinates.xmax,
+                compute.coordinates.xmin, compute.coordinates.zmax,
+                compute.coordinates.zmin, MPIEnvironment::mpi_,
+                specfem::wave::sh) {}
+
+  // Acceleration of the displacement u(x, z)
+  specfem::kokkos::HostFieldMirror2d<type_real>
+  stiffness(const specfem::Domain::options &options,
+            const std::function<type_real(type_real, type_real)> &u) {
+    const int nglob = compute.coordinates.coord.extent(1);
+    specfem::Domain::Elastic domain(ndim, nglob, &compute, &properties,
+                                    &partial_derivatives, &sources, &receivers,
+                                    &mesh.gll, &mesh.gll, options);
+
+    const auto coord = compute.coordinates.coord;
+    const auto field = domain.get_host_field();
+    for (int iglob = 0; iglob < nglob; iglob++)
+      field(iglob, 0) = u(coord(0, iglob), coord(1, iglob));
+    domain.sync_field(specfem::sync::HostToDevice);
+
+    domain.compute_stiffness_interaction();
+    Kokkos::fence();
+    domain.sync_field_dot_dot(specfem::sync::DeviceToHost);
+    return domain.get_host_field_dot_dot();
+  }
+
+  // Global points on the boundary of the grid
+  std::vector<bool> boundary_points() const {
+    const int ngll = mesh.gll.get_N();
+    std::vector<bool> boundary(compute.coordinates.coord.extent(1), false);
+    for (int ez = 0; ez < nez; ez++) {
+      for (int ex = 0; ex < nex; ex++) {
+        const int ispec = ez * nex + ex;
+        for (int iz = 0; iz < ngll; iz++) {
+          for (int ix = 0; ix < ngll; ix++) {
+            if ((ex == 0 && ix == 0) || (ex == nex - 1 && ix == ngll - 1) ||
+                (ez == 0 && iz == 0) || (ez == nez - 1 && iz == ngll - 1))
+              boundary[compute.h_ibool(ispec, iz, ix)] = true;
+          }
+        }
+      }
+    }
+    return boundary;
+  }
+};
+
+// SH stiffness kernels specialized for the number of GLL points
+std::vector<std::pair<std::string, specfem::Domain::options> >
+specialized_kernels() {
+  specfem::Domain::options lanes;
+  lanes.wave = specfem::wave::sh;
+  specfem::Domain::options teams = lanes;
+  teams.host_lanes = false;
+  specfem::Domain::options batched = lanes;
+  batched.batched_contractions = true;
+  specfem::Domain::options colored = lanes;
+  colored.assembly = specfem::assembly::colored;
+  return { { "Host lane kernels", lanes },
+           { "NGLL team kernels", teams },
+           { "Batched contractions", batched },
+           { "Colored assembly", colored } };
+}
+
+// Runtime sized kernel
+specfem::Domain::options reference_kernel() {
+  specfem::Domain::options options;
+  options.wave = specfem::wave::sh;
+  options.reference_kernels = true;
+  return options;
+}
+
+// Largest absolute value of the first component
+type_real max_abs(const specfem::kokkos::HostFieldMirror2d<type_real> field) {
+  type_real value = 0.0;
+  for (int iglob = 0; iglob < field.extent(0); iglob++)
+    value = std::max(value, std::fabs(field(iglob, 0)));
+  return value;
+}
+
+TEST(SH_DOMAIN, STORAGE) {
+  sh_setup setup;
+  const int nglob = setup.compute.coordinates.coord.extent(1);
+
+  for (const auto &[wave, ncomponents] :
+       { std::make_pair(specfem::wave::sh, 1),
+         std::make_pair(specfem::wave::p_sv, 2) }) {
+    specfem::Domain::options options;
+    options.wave = wave;
+    specfem::Domain::Elastic domain(
+        ndim, nglob, &setup.compute, &setup.properties,
+        &setup.partial_derivatives, &setup.sources, &setup.receivers,
+        &setup.mesh.gll, &setup.mesh.gll, options);
+    EXPECT_EQ(domain.get_field().extent(1), ncomponents);
+    EXPECT_EQ(domain.get_field_dot().extent(1), ncomponents);
+    EXPECT_EQ(domain.get_field_dot_dot().extent(1), ncomponents);
+  }
+}
+
+// A linear displacement has a constant stress, hence the runtime sized kernel
+// gives no force at points inside the grid. GLL quadrature is exact for 4
+// node elements. Forces balance since constant displacements are free of
+// stress
+TEST(SH_DOMAIN, PATCH_TEST) {
+  sh_setup setup;
+  const auto boundary = setup.boundary_points();
+
+  const auto linear = [](const type_real x, const type_real z) {
+    return static_cast<type_real>(1e-3 * (2.0 * x - 3.0 * z));
+  };
+
+  for (const auto &[name, options] :
+       { std::make_pair(std::string("Reference kernel"), reference_kernel()),
+         specialized_kernels().front() }) {
+    SCOPED_TRACE(name);
+    const auto acceleration = setup.stiffness(options, linear);
+    ASSERT_EQ(acceleration.extent(1), 1);
+
+    const type_real scale = max_abs(acceleration);
+    ASSERT_GT(scale, 0.0);
+    double sum = 0.0;
+    for (int iglob = 0; iglob < acceleration.extent(0); iglob++) {
+      sum += acceleration(iglob, 0);
+      if (!boundary[iglob])
+        EXPECT_NEAR(acceleration(iglob, 0) / scale, 0.0, 1e-4)
+            << "For point " << iglob;
+    }
+    EXPECT_NEAR(sum / scale, 0.0, 1e-4);
+  }
+}
+
+// Every SH kernel specialized for the number of GLL points matches the
+// runtime sized kernel for a displacement with a varying gradient
+TEST(SH_DOMAIN, STIFFNESS) {
+  sh_setup setup;
+
+  const auto smooth = [](const type_real x, const type_real z) {
+    return static_cast<type_real>(1e-3 * (x * x + 0.5 * z - x * z * z));
+  };
+
+  const auto expected = setup.stiffness(reference_kernel(), smooth);
+  const type_real scale = max_abs(expected);
+  ASSERT_GT(scale, 0.0);
+
+  for (const auto &[name, options] : specialized_kernels()) {
+    SCOPED_TRACE(name);
+    const auto computed = setup.stiffness(options, smooth);
+    ASSERT_EQ(computed.extent(1), 1);
+    for (int iglob = 0; iglob < expected.extent(0); iglob++) {
+      EXPECT_NEAR(computed(iglob, 0) / scale, expected(iglob, 0) / scale,
+                  1e-5)
+          << "For point " << iglob;
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
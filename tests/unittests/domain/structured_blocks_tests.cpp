@@ -0,0 +1,152 @@
+#include "../../../include/compute.h"
+#include "../../../include/domain.h"
+#include "../../../include/enums.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/material.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+constexpr type_real rho = 2700.0;
+constexpr type_real cp = 3000.0;
+constexpr type_real cs = 1732.0;
+constexpr int nex = 3;
+constexpr int nez = 3;
+
+// Grid of nex x nez skewed 4 node elements and one elastic material
+struct grid_setup {
+  specfem::kokkos::HostView2d<type_real> coorg;
+  specfem::kokkos::HostView2d<int> knods;
+  specfem::kokkos::HostView1d<int> kmato;
+  std::vector<specfem::material *> materials;
+  specfem::quadrature::quadrature gll;
+
+  grid_setup()
+      : coorg("structured_blocks_tests::coorg", ndim, (nex + 1) * (nez + 1)),
+        knods("structured_blocks_tests::knods", 4, nex * nez),
+        kmato("structured_blocks_tests::kmato", nex * nez), gll(0.0, 0.0, 5) {
+    for (int iz = 0; iz <= nez; iz++) {
+      for (int ix = 0; ix <= nex; ix++) {
+        coorg(0, iz * (nex + 1) + ix) = ix + 0.1 * iz;
+        coorg(1, iz * (nex + 1) + ix) = iz + 0.05 * ix * ix;
+      }
+    }
+    for (int ez = 0; ez < nez; ez++) {
+      for (int ex = 0; ex < nex; ex++) {
+        const int ispec = ez * nex + ex;
+        const int inode = ez * (nex + 1) + ex;
+        knods(0, ispec) = inode;
+        knods(1, ispec) = inode + 1;
+        knods(2, ispec) = inode + nex + 2;
+        knods(3, ispec) = inode + nex + 1;
+        kmato(ispec) = 0;
+      }
+    }
+
+    specfem::utilities::input_holder holder;
+    holder.val0 = rho;
+    holder.val1 = cp;
+    holder.val2 = cs;
+    holder.val3 = 0.0;
+    holder.val5 = 9999.0;
+    holder.val6 = 9999.0;
+    materials.push_back(new specfem::elastic_material());
+    materials[0]->assign(holder);
+  }
+
+  ~grid_setup() {
+    for (auto &material : materials)
+      delete material;
+  }
+};
+
+// Structs read by the domain, with or without structured blocks
+struct elastic_setup {
+  specfem::compute::compute compute;
+  specfem::compute::partial_derivatives partial_derivatives;
+  specfem::compute::properties properties;
+  specfem::compute::sources sources;
+  specfem::compute::receivers receivers;
+
+  elastic_setup(grid_setup &mesh, const bool structured)
+      : compute(mesh.coorg, mesh.knods, mesh.gll, mesh.gll),
+        partial_derivatives(mesh.coorg, mesh.knods, mesh.gll, mesh.gll),
+        properties(mesh.kmato, mesh.materials, nex * nez, mesh.gll.get_N(),
+                   mesh.gll.get_N()),
+        sources({}, mesh.gll, mesh.gll, compute.coordinates.xmax,
+                compute.coordinates.xmin, compute.coordinates.zmax,
+                compute.coordinates.zmin, MPIEnvironment::mpi_) {
+    if (structured)
+      compute.assign_structured_blocks(mesh.knods);
+  }
+
+  // Acceleration of a smooth displacement
+  specfem::kokkos::HostFieldMirror2d<type_real>
+  stiffness(grid_setup &mesh, const specfem::Domain::options &options) {
+    const int nglob = compute.coordinates.coord.extent(1);
+    specfem::Domain::Elastic domain(ndim, nglob, &compute, &properties,
+                                    &partial_derivatives, &sources, &receivers,
+                                    &mesh.gll, &mesh.gll, options);
+
+    const auto coord = compute.coordinates.coord;
+    const auto field = domain.get_host_field();
+    for (int iglob = 0; iglob < nglob; iglob++) {
+      const type_real x = coord(0, iglob);
+      const type_real z = coord(1, iglob);
+      field(iglob, 0) = x * x + 0.5 * z;
+      if (field.extent(1) > 1)
+        field(iglob, 1) = x * z - z * z * z;
+    }
+    domain.sync_field(specfem::sync::HostToDevice);
+
+    domain.compute_stiffness_interaction();
+    Kokkos::fence();
+    domain.sync_field_dot_dot(specfem::sync::DeviceToHost);
+    return domain.get_host_field_dot_dot();
+  }
+};
+
+TEST(STRUCTURED_BLOCKS, STIFFNESS) {
+  grid_setup mesh;
+  elastic_setup reference(mesh, false);
+  elastic_setup structured(mesh, true);
+  ASSERT_TRUE(structured.compute.structured());
+
+  for (const auto wave : { specfem::wave::p_sv, specfem::wave::sh }) {
+    for (const auto assembly :
+         { specfem::assembly::atomic, specfem::assembly::colored }) {
+      specfem::Domain::options options;
+      options.wave = wave;
+      options.assembly = assembly;
+      const auto expected = reference.stiffness(mesh, options);
+      const auto computed = structured.stiffness(mesh, options);
+
+      // Both numberings are compared through the points of every element
+      const int ngll = mesh.gll.get_N();
+      for (int ispec = 0; ispec < nex * nez; ispec++) {
+        for (int iz = 0; iz < ngll; iz++) {
+          for (int ix = 0; ix < ngll; ix++) {
+            const int iglob = structured.compute.h_ibool(ispec, iz, ix);
+            const int jglob = reference.compute.h_ibool(ispec, iz, ix);
+            for (int icomp = 0; icomp < expected.extent(1); icomp++) {
+              EXPECT_NEAR(computed(iglob, icomp) / (rho * cp),
+                          expected(jglob, icomp) / (rho * cp), 1e-5);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,132 @@
+#include "../../../include/ensemble.h"
+#include "../../../include/material.h"
+#include "../../../include/simulation.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <cmath>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+const std::string sweep_file =
+    "../../../tests/unittests/ensemble/serial/sweep.yaml";
+// Resident simulation of the Newmark displacement tests
+const std::string parameter_file = "../../../tests/unittests/simulation/"
+                                   "serial/specfem_config.yaml";
+const std::string sources_file = "../../../tests/unittests/"
+                                 "displacement_tests/Newmark/serial/"
+                                 "sources.yaml";
+const std::string shifted_sources_file = "../../../tests/unittests/"
+                                         "simulation/serial/"
+                                         "sources_shifted.yaml";
+
+TEST(ENSEMBLE_TESTS, SWEEP_FILE) {
+  const specfem::ensemble::sweep sweep(sweep_file);
+
+  // One listed member followed by 2 sources x 2 values of vs
+  ASSERT_EQ(sweep.get_nmembers(), 5);
+  EXPECT_EQ(sweep.get_output_folder(), "OUTPUT_FILES/ensemble_tests");
+  EXPECT_EQ(sweep.get_member_folder(3),
+            "OUTPUT_FILES/ensemble_tests/member0003");
+  EXPECT_EQ(sweep.get_ngroups(4), 1);
+
+  EXPECT_TRUE(sweep.get_member(0).materials.empty());
+  const std::vector<std::string> shifted = { shifted_sources_file };
+  const type_real values[4] = { 1600.0, 1700.0, 1600.0, 1700.0 };
+  for (int imember = 1; imember < 5; imember++) {
+    const auto &member = sweep.get_member(imember);
+    EXPECT_EQ(member.sources_files == shifted, imember > 2);
+    ASSERT_EQ(member.materials.size(), 1);
+    EXPECT_EQ(member.materials[0].kmato, 1);
+    EXPECT_EQ(member.materials[0].property, "vs");
+    EXPECT_FLOAT_EQ(member.materials[0].value, values[imember - 1]);
+  }
+}
+
+TEST(ENSEMBLE_TESTS, GROUPS) {
+  const specfem::ensemble::sweep listed(
+      std::vector<specfem::ensemble::member>(3), "ensemble");
+  // One group for every process, every group simulates a member
+  EXPECT_EQ(listed.get_ngroups(2), 2);
+  EXPECT_EQ(listed.get_ngroups(8), 3);
+
+  const specfem::ensemble::sweep grouped(
+      std::vector<specfem::ensemble::member>(3), "ensemble", 4);
+  EXPECT_THROW(grouped.get_ngroups(2), std::runtime_error);
+}
+
+TEST(ENSEMBLE_TESTS, ASSIGN_MATERIALS) {
+  specfem::utilities::return_holder base;
+  base.rho = 2000.0;
+  base.mu = 2000.0 * 1500.0 * 1500.0;
+  base.lambdaplus2mu = 2000.0 * 2500.0 * 2500.0;
+  base.kappa = base.lambdaplus2mu - base.mu;
+  base.qkappa = 9999.0;
+  base.qmu = 9999.0;
+
+  const std::vector<specfem::ensemble::material_value> values = {
+    { 2, "vs", 1000.0 }, { 2, "rho", 2500.0 }
+  };
+  auto materials = specfem::ensemble::assign_materials({ base, base }, values);
+  ASSERT_EQ(materials.size(), 2);
+
+  // Materials without values keep the properties of the parameter file
+  const auto kept = materials[0]->get_properties();
+  EXPECT_FLOAT_EQ(kept.rho, base.rho);
+  EXPECT_FLOAT_EQ(kept.mu, base.mu);
+  EXPECT_FLOAT_EQ(kept.lambdaplus2mu, base.lambdaplus2mu);
+
+  const auto overridden = materials[1]->get_properties();
+  EXPECT_FLOAT_EQ(overridden.rho, 2500.0);
+  EXPECT_FLOAT_EQ(overridden.mu, 2500.0 * 1000.0 * 1000.0);
+  EXPECT_FLOAT_EQ(overridden.lambdaplus2mu, 2500.0 * 2500.0 * 2500.0);
+
+  for (auto &material : materials)
+    delete material;
+
+  EXPECT_THROW(specfem::ensemble::assign_materials({ base }, values),
+               std::runtime_error);
+}
+
+TEST(ENSEMBLE_TESTS, RUN) {
+  const auto folder =
+      (std::filesystem::temp_directory_path() / "ensemble_tests").string();
+  std::filesystem::remove_all(folder);
+
+  // Lower shear velocities are stable at the time step of the parameter file
+  type_real vs;
+  {
+    specfem::simulation::simulation simulation(parameter_file,
+                                               MPIEnvironment::mpi_);
+    const auto properties = simulation.get_materials()[0]->get_properties();
+    vs = 0.9 * std::sqrt(properties.mu / properties.rho);
+  }
+
+  std::vector<specfem::ensemble::member> members(3);
+  members[0].sources_files = { sources_file };
+  members[1].sources_files = { shifted_sources_file };
+  members[1].materials = { { 1, "vs", vs } };
+  members[2].materials = { { 1, "vs", vs } };
+  const specfem::ensemble::sweep sweep(members, folder);
+
+  specfem::ensemble::run(parameter_file, sweep, MPIEnvironment::mpi_);
+
+  EXPECT_TRUE(std::filesystem::exists(folder + "/ensemble.yaml"));
+  for (int imember = 0; imember < sweep.get_nmembers(); imember++) {
+    const auto member_folder = sweep.get_member_folder(imember);
+    ASSERT_TRUE(std::filesystem::is_directory(member_folder));
+    EXPECT_FALSE(std::filesystem::is_empty(member_folder));
+  }
+
+  std::filesystem::remove_all(folder);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,318 @@
+#include "../../../include/compute.h"
+#include "../../../include/domain.h"
+#include "../../../include/material.h"
+#include "../../../include/mesh.h"
+#include "../../../include/mesher.h"
+#include "../../../include/parameter_parser.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/read_sources.h"
+#include "../../../include/receiver.h"
+#include "../../../include/solver.h"
+#include "../../../include/timescheme.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include "../utilities/include/compare_array.h"
+#include <functional>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Example mesh and source of the Newmark displacement tests
+const std::string parameter_file = "../../../tests/unittests/"
+                                   "displacement_tests/Newmark/serial/"
+                                   "specfem_config.yaml";
+
+// Optimized implementation of the elastic domain and of the time loop
+struct fast_path {
+  std::string name;
+  specfem::Domain::options options;
+  bool graph_execution = false;
+  bool static_dispatch = true;
+  type_real tolerance = 1e-4; ///< Largest normalized L1 error
+  bool sh = false; ///< If true the path is also compared for SH waves
+};
+
+// Acceleration of every quadrature point after one step and seismograms
+// after every step of a path
+struct path_results {
+  specfem::kokkos::HostView2d<type_real> acceleration;
+  specfem::kokkos::HostView2d<type_real> seismograms;
+};
+
+// Runtime sized kernels with atomic assembly
+specfem::Domain::options reference_options() {
+  specfem::Domain::options options;
+  options.reference_kernels = true;
+  return options;
+}
+
+std::vector<fast_path> fast_paths() {
+  std::vector<fast_path> paths;
+  const auto add = [&paths](const std::string &name,
+                            const std::function<void(fast_path &)> &set) {
+    fast_path path{ name };
+    set(path);
+    paths.push_back(path);
+  };
+
+  // Host lane kernels are the NGLL specialized kernels of host backends. Team
+  // kernels are used on device backends either way
+  add("Host lane kernels", [](fast_path &path) { path.sh = true; });
+  add("NGLL team kernels", [](fast_path &path) {
+    path.options.host_lanes = false;
+    path.sh = true;
+  });
+  add("Batched contractions", [](fast_path &path) {
+    path.options.batched_contractions = true;
+    path.sh = true;
+  });
+  add("Colored assembly", [](fast_path &path) {
+    path.options.assembly = specfem::assembly::colored;
+  });
+  add("Packed element data",
+      [](fast_path &path) { path.options.packed_element_data = true; });
+  add("Quantized element data", [](fast_path &path) {
+    path.options.quantized_element_data = true;
+    path.tolerance = 5e-3;
+  });
+  add("Assembled operator",
+      [](fast_path &path) { path.options.assembled_operator = true; });
+  add("Compressed connectivity",
+      [](fast_path &path) { path.options.compressed_connectivity = true; });
+  add("Structured blocks",
+      [](fast_path &path) { path.options.structured_blocks = true; });
+  add("Active elements",
+      [](fast_path &path) { path.options.active_elements = true; });
+  add("Host offload", [](fast_path &path) {
+    path.options.host_offload = true;
+    path.options.host_fraction = 0.2;
+  });
+  add("Graph execution",
+      [](fast_path &path) { path.graph_execution = true; });
+  add("Runtime dispatch",
+      [](fast_path &path) { path.static_dispatch = false; });
+
+  return paths;
+}
+
+// Run nstep steps of a path on a mesh. Receivers are placed at fixed
+// fractions of the extent of the mesh
+path_results run_path(const std::function<specfem::mesh(
+                          std::vector<specfem::material *> &)> &read_mesh,
+                      const fast_path &path, const int nstep) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  specfem::runtime_configuration::setup setup(parameter_file);
+  const auto [database_file, sources_file] = setup.get_databases();
+  auto [gllx, gllz] = setup.instantiate_quadrature();
+
+  std::vector<specfem::material *> materials;
+  specfem::mesh mesh = read_mesh(materials);
+
+  specfem::compute::compute compute(mesh.coorg, mesh.material_ind.knods, gllx,
+                                    gllz);
+  specfem::compute::partial_derivatives partial_derivatives(
+      mesh.coorg, mesh.material_ind.knods, gllx, gllz);
+  specfem::compute::properties material_properties(mesh.material_ind.kmato,
+                                                   materials, mesh.nspec,
+                                                   gllx.get_N(), gllz.get_N());
+  if (path.options.compressed_connectivity)
+    compute.compress_connectivity();
+  if (path.options.structured_blocks)
+    compute.assign_structured_blocks(mesh.material_ind.knods);
+
+  auto [sources, t0] = specfem::read_sources(sources_file, setup.get_dt(), mpi);
+  for (auto &source : sources)
+    source->locate(compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
+                   gllz.get_hxi(), mesh.nproc, mesh.coorg,
+                   mesh.material_ind.knods, mesh.npgeo,
+                   material_properties.h_ispec_type, mpi);
+
+  const type_real xmax = compute.coordinates.xmax;
+  const type_real xmin = compute.coordinates.xmin;
+  const type_real zmax = compute.coordinates.zmax;
+  const type_real zmin = compute.coordinates.zmin;
+
+  specfem::receivers::receiver_set stations;
+  for (const auto &[fx, fz] : std::vector<std::pair<type_real, type_real> >{
+           { 0.2, 0.7 }, { 0.8, 0.3 }, { 0.5, 0.9 } })
+    stations.add("AA", "S" + std::to_string(stations.size()),
+                 xmin + fx * (xmax - xmin), zmin + fz * (zmax - zmin));
+  stations.locate(compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
+                  gllz.get_hxi(), mesh.coorg, mesh.material_ind.knods, mpi);
+
+  specfem::TimeScheme::Newmark it(nstep, -1.0 * t0, setup.get_dt(), 1);
+
+  specfem::compute::sources compute_sources(sources, gllx, gllz, xmax, xmin,
+                                            zmax, zmin, mpi,
+                                            path.options.wave);
+  specfem::compute::receivers compute_receivers(
+      stations,
+      { specfem::seismogram::displacement, specfem::seismogram::velocity },
+      gllx, gllz, xmax, xmin, zmax, zmin, it.get_max_seismogram_step(), mpi);
+
+  const int nglob = specfem::utilities::compute_nglob(compute.h_ibool);
+  specfem::Domain::Elastic domain(ndim, nglob, &compute, &material_properties,
+                                  &partial_derivatives, &compute_sources,
+                                  &compute_receivers, &gllx, &gllz,
+                                  path.options);
+
+  specfem::solver::solver *solver =
+      path.static_dispatch
+          ? specfem::solver::instantiate_time_marching(&domain, &it,
+                                                       path.graph_execution)
+          : new specfem::solver::time_marching<specfem::Domain::Domain,
+                                               specfem::TimeScheme::TimeScheme>(
+                &domain, &it, path.graph_execution);
+  solver->run();
+
+  // Global numbers depend on the path, quadrature points don't
+  path_results results;
+  domain.sync_field_dot_dot(specfem::sync::DeviceToHost);
+  const auto field_dot_dot = domain.get_host_field_dot_dot();
+  const int ngllz = gllz.get_N();
+  const int ngllx = gllx.get_N();
+  results.acceleration = specfem::kokkos::HostView2d<type_real>(
+      "acceleration", mesh.nspec * ngllz * ngllx, field_dot_dot.extent(1));
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    for (int iz = 0; iz < ngllz; iz++) {
+      for (int ix = 0; ix < ngllx; ix++) {
+        const int ipoint = (ispec * ngllz + iz) * ngllx + ix;
+        const int iglob = compute.h_ibool(ispec, iz, ix);
+        for (int icomp = 0; icomp < field_dot_dot.extent(1); icomp++)
+          results.acceleration(ipoint, icomp) = field_dot_dot(iglob, icomp);
+      }
+    }
+  }
+
+  compute_receivers.sync_seismograms();
+  const auto seismogram = compute_receivers.h_seismogram;
+  const int nvalues =
+      seismogram.extent(0) * seismogram.extent(1) * seismogram.extent(2);
+  results.seismograms = specfem::kokkos::HostView2d<type_real>(
+      "seismograms", nvalues, seismogram.extent(3));
+  int ivalue = 0;
+  for (int isample = 0; isample < seismogram.extent(0); isample++) {
+    for (int itype = 0; itype < seismogram.extent(1); itype++) {
+      for (int irec = 0; irec < seismogram.extent(2); irec++) {
+        for (int idim = 0; idim < seismogram.extent(3); idim++)
+          results.seismograms(ivalue, idim) =
+              seismogram(isample, itype, irec, idim);
+        ivalue++;
+      }
+    }
+  }
+
+  return results;
+}
+
+// Compare the acceleration after one step and the seismograms after nstep
+// steps of every fast path against the reference path. Only paths marked
+// for SH waves are compared for SH waves
+void compare_fast_paths(const std::function<specfem::mesh(
+                            std::vector<specfem::material *> &)> &read_mesh,
+                        const int nstep,
+                        const specfem::wave::type wave = specfem::wave::p_sv) {
+  fast_path reference{ "Reference" };
+  reference.options = reference_options();
+  reference.options.wave = wave;
+  const auto reference_step = run_path(read_mesh, reference, 1);
+  const auto reference_run = run_path(read_mesh, reference, nstep);
+
+  for (auto path : fast_paths()) {
+    if (wave == specfem::wave::sh && !path.sh)
+      continue;
+    path.options.wave = wave;
+    SCOPED_TRACE(path.name);
+    const auto step = run_path(read_mesh, path, 1);
+    EXPECT_NO_THROW(specfem::testing::compare_norm(
+        step.acceleration, reference_step.acceleration, path.tolerance));
+    const auto run = run_path(read_mesh, path, nstep);
+    EXPECT_NO_THROW(specfem::testing::compare_norm(
+        run.seismograms, reference_run.seismograms, path.tolerance));
+  }
+}
+
+TEST(FAST_PATH_TESTS, example_mesh) {
+  specfem::runtime_configuration::setup setup(parameter_file);
+  const auto [database_file, sources_file] = setup.get_databases();
+  compare_fast_paths(
+      [database_file = database_file](
+          std::vector<specfem::material *> &materials) {
+        return specfem::mesh(database_file, materials, MPIEnvironment::mpi_);
+      },
+      100);
+}
+
+// Two elastic layers with a sloping interface, hence elements of the lower
+// layer aren't affine, around the source of the example mesh
+specfem::mesher::layered_model synthetic_model() {
+  specfem::mesher::layered_model model;
+  model.xmin = 0.0;
+  model.xmax = 5000.0;
+  model.zmin = 0.0;
+  model.nx = 16;
+
+  specfem::mesher::layer lower;
+  lower.nz = 8;
+  lower.top = { { 0.0, 2000.0 }, { 5000.0, 3000.0 } };
+  lower.rho = 2700.0;
+  lower.vp = 3000.0;
+  lower.vs = 1700.0;
+
+  specfem::mesher::layer upper;
+  upper.nz = 8;
+  upper.top = { { 0.0, 5000.0 } };
+  upper.rho = 2200.0;
+  upper.vp = 2500.0;
+  upper.vs = 1400.0;
+
+  model.layers = { lower, upper };
+  return model;
+}
+
+TEST(FAST_PATH_TESTS, synthetic_mesh) {
+  const auto model = synthetic_model();
+  compare_fast_paths(
+      [&model](std::vector<specfem::material *> &materials) {
+        return specfem::mesher::generate(model, materials,
+                                         MPIEnvironment::mpi_);
+      },
+      100);
+}
+
+// The stiffness kernels are templated on the wave type, SH kernels load and
+// assemble a single component
+TEST(FAST_PATH_TESTS, sh_waves) {
+  const auto model = synthetic_model();
+  compare_fast_paths(
+      [&model](std::vector<specfem::material *> &materials) {
+        return specfem::mesher::generate(model, materials,
+                                         MPIEnvironment::mpi_);
+      },
+      100, specfem::wave::sh);
+}
+
+// Elements of structured blocks aren't activated by their neighbours and
+// would be computed twice if they contain a source
+TEST(FAST_PATH_TESTS, active_elements_with_structured_blocks) {
+  const auto model = synthetic_model();
+  fast_path path{ "Active elements with structured blocks" };
+  path.options.structured_blocks = true;
+  path.options.active_elements = true;
+  EXPECT_THROW(run_path(
+                   [&model](std::vector<specfem::material *> &materials) {
+                     return specfem::mesher::generate(model, materials,
+                                                      MPIEnvironment::mpi_);
+                   },
+                   path, 1),
+               std::runtime_error);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
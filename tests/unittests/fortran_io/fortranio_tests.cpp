@@ -1,6 +1,9 @@
 #include "../../../include/config.h"
 #include "../../../include/fortran_IO.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../Kokkos_Environment.hpp"
 #include <boost/algorithm/string/trim.hpp>
+#include <cstdio>
 #include <fstream>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -43,3 +46,86 @@ TEST(iotests, fortran_io) {
 
   stream.close();
 }
+
+// Write records of the form (ipoin, x, z) with markers of the given length
+void write_records(const std::string &filename, const int nrecords,
+                   const int marker) {
+  std::ofstream stream(filename, std::ios::binary);
+  for (int i = 0; i < nrecords; i++) {
+    const int ipoin = i + 1;
+    const double x = 0.5 * i, z = -1.0 * i;
+    stream.write(reinterpret_cast<const char *>(&marker), fint);
+    stream.write(reinterpret_cast<const char *>(&ipoin), fint);
+    stream.write(reinterpret_cast<const char *>(&x), fdouble);
+    stream.write(reinterpret_cast<const char *>(&z), fdouble);
+    stream.write(reinterpret_cast<const char *>(&marker), fint);
+  }
+}
+
+TEST(iotests, record_reader) {
+  const std::string filename = "fortranio_record_reader.bin";
+  constexpr int nrecords = 10;
+  write_records(filename, nrecords, fint + 2 * fdouble);
+
+  specfem::kokkos::HostView1d<int> ipoin("ipoin", nrecords);
+  specfem::kokkos::HostView2d<type_real> coordinates("coordinates", nrecords,
+                                                     2);
+
+  {
+    // Memory-mapped file
+    specfem::fortran_IO::record_reader reader(filename);
+    EXPECT_EQ(reader.record_length(), fint + 2 * fdouble);
+    reader.read_records(nrecords, ipoin, coordinates);
+    EXPECT_TRUE(reader.eof());
+    for (int i = 0; i < nrecords; i++) {
+      EXPECT_EQ(ipoin(i), i + 1);
+      EXPECT_FLOAT_EQ(coordinates(i, 0), 0.5 * i);
+      EXPECT_FLOAT_EQ(coordinates(i, 1), -1.0 * i);
+    }
+  }
+
+  {
+    // Stream, the first record is read value by value
+    std::ifstream stream(filename, std::ios::binary);
+    int first;
+    type_real x, z;
+    specfem::fortran_IO::fortran_read_line(stream, &first, &x, &z);
+    EXPECT_EQ(first, 1);
+    Kokkos::deep_copy(ipoin, 0);
+    specfem::fortran_IO::fortran_read_records(stream, nrecords - 1, ipoin,
+                                              coordinates);
+    for (int i = 0; i < nrecords - 1; i++) {
+      EXPECT_EQ(ipoin(i), i + 2);
+      EXPECT_FLOAT_EQ(coordinates(i, 0), 0.5 * (i + 1));
+    }
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(iotests, record_reader_markers) {
+  const std::string filename = "fortranio_record_markers.bin";
+  constexpr int nrecords = 2;
+
+  // Markers don't match the layout of the columns
+  write_records(filename, nrecords, fint + 2 * fdouble);
+  specfem::kokkos::HostView1d<int> ipoin("ipoin", nrecords);
+  specfem::kokkos::HostView1d<type_real> x("x", nrecords);
+  specfem::fortran_IO::record_reader reader(filename);
+  EXPECT_THROW(reader.read_records(nrecords, ipoin, x), std::runtime_error);
+
+  // Records beyond the end of the file
+  specfem::kokkos::HostView2d<type_real> coordinates("coordinates", 3, 2);
+  specfem::kokkos::HostView1d<int> ipoin3("ipoin", 3);
+  specfem::fortran_IO::record_reader truncated(filename);
+  EXPECT_THROW(truncated.read_records(3, ipoin3, coordinates),
+               std::runtime_error);
+
+  std::remove(filename.c_str());
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -1,4 +1,5 @@
 #include "../../../include/gll_library.h"
+#include "../../../include/gll_tables.h"
 #include "../../../include/lagrange_poly.h"
 #include "../Kokkos_Environment.hpp"
 #include <Kokkos_Core.hpp>
@@ -45,6 +46,69 @@ TEST(lagrange_tests, LAGRANGE_TESTS) {
   }
 }
 
+// Compare the compile-time table of NGLL points against the quadrature
+// computed at runtime
+template <int NGLL> void check_gll_table() {
+  constexpr auto table = specfem::quadrature::gll_tables<type_real, NGLL>;
+  type_real tol = 1e-5;
+
+  auto [h_z1, h_w1] = gll_library::zwgljd(NGLL, 0.0, 0.0);
+  // hprime_ii(j, i) is the derivative of polynomial j at point i
+  auto h_hprime_ii = Lagrange::compute_lagrange_derivatives_GLL(h_z1, NGLL);
+
+  for (int i = 0; i < NGLL; i++) {
+    EXPECT_NEAR(table.xi[i], h_z1(i), tol) << NGLL << " " << i;
+    EXPECT_NEAR(table.w[i], h_w1(i), tol) << NGLL << " " << i;
+    for (int j = 0; j < NGLL; j++) {
+      EXPECT_NEAR(table.hprime[i][j], h_hprime_ii(j, i), tol * NGLL * NGLL)
+          << NGLL << " " << i << " " << j;
+      EXPECT_NEAR(table.hprimewgll[i][j], h_hprime_ii(i, j) * h_w1(j),
+                  tol * NGLL * NGLL)
+          << NGLL << " " << i << " " << j;
+    }
+  }
+}
+
+TEST(lagrange_tests, GLL_TABLES) {
+  // Tables are evaluated at compile time in single and double precision
+  static_assert(specfem::quadrature::gll_tables<float, 2>.xi[0] == -1.0f);
+  static_assert(specfem::quadrature::gll_tables<double, 3>.xi[1] == 0.0);
+  static_assert(specfem::quadrature::gll_tables<double, 3>.w[0] ==
+                specfem::quadrature::gll_tables<double, 3>.w[2]);
+
+  check_gll_table<3>();
+  check_gll_table<4>();
+  check_gll_table<5>();
+  check_gll_table<6>();
+  check_gll_table<7>();
+  check_gll_table<8>();
+  check_gll_table<9>();
+  check_gll_table<10>();
+}
+
+TEST(lagrange_tests, GLJ_DERIVATIVES) {
+  /**
+   *  This test checks if compute_jacobi_derivatives_GLJ gives the derivatives
+   * of the Lagrange interpolants at GLJ points
+   *
+   */
+  type_real tol = 1e-4;
+
+  for (int nglj = 3; nglj <= 8; nglj++) {
+    auto [h_z1, h_w1] = gll_library::zwgljd(nglj, 0.0, 1.0);
+    auto h_hprimeBar = Lagrange::compute_jacobi_derivatives_GLJ(h_z1, nglj);
+
+    for (int i = 0; i < nglj; i++) {
+      auto [h_h1, h_h1_prime] =
+          Lagrange::compute_lagrange_interpolants(h_z1(i), nglj, h_z1);
+      for (int j = 0; j < nglj; j++) {
+        EXPECT_NEAR(h_hprimeBar(i, j), h_h1_prime(j), tol * nglj * nglj)
+            << nglj << " " << i << " " << j;
+      }
+    }
+  }
+}
+
 int main(int argc, char *argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
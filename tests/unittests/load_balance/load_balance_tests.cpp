@@ -0,0 +1,98 @@
+#include "../../../include/enums.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/load_balance.h"
+#include "../../../include/partitioner.h"
+#include "../../../include/timers.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <chrono>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(LOAD_BALANCE_TESTS, ELEMENT_COUNTS) {
+  specfem::kokkos::HostMirror1d<specfem::elements::type> h_ispec_type(
+      "load_balance_tests::h_ispec_type", 5);
+  h_ispec_type(0) = specfem::elements::elastic;
+  h_ispec_type(1) = specfem::elements::acoustic;
+  h_ispec_type(2) = specfem::elements::elastic;
+  h_ispec_type(3) = specfem::elements::poroelastic;
+  h_ispec_type(4) = specfem::elements::elastic;
+
+  const specfem::load_balance::rank_load load(h_ispec_type);
+  EXPECT_EQ(load.nelastic, 3);
+  EXPECT_EQ(load.nacoustic, 1);
+  EXPECT_EQ(load.nporoelastic, 1);
+}
+
+TEST(LOAD_BALANCE_TESTS, REPORT) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  specfem::load_balance::rank_load load;
+  load.nelastic = 10;
+  load.nsources = 2;
+  load.nhalo = 24;
+
+  // Compute time isn't measured by disabled timers
+  specfem::timers::timers disabled(false);
+  EXPECT_NE(specfem::load_balance::print(load, disabled, mpi)
+                .find("Compute time wasn't measured"),
+            std::string::npos);
+
+  // Output isn't compute time
+  specfem::timers::timers timers;
+  timers.start(specfem::timers::stiffness);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  timers.stop(specfem::timers::stiffness);
+  timers.start(specfem::timers::output);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  timers.stop(specfem::timers::output);
+  EXPECT_DOUBLE_EQ(specfem::load_balance::compute_seconds(timers),
+                   timers.get_seconds(specfem::timers::stiffness));
+
+  const std::string report = specfem::load_balance::print(load, timers, mpi);
+  if (mpi->get_size() == 1) {
+    EXPECT_NE(report.find("imbalance (max / mean) = 1.000"),
+              std::string::npos);
+    EXPECT_NE(report.find("- Rank 0 : "), std::string::npos);
+  }
+  EXPECT_NE(report.find("10 elastic"), std::string::npos);
+  EXPECT_NE(report.find("sources = 2"), std::string::npos);
+  EXPECT_NE(report.find("halo values = 24"), std::string::npos);
+}
+
+TEST(LOAD_BALANCE_TESTS, ELEMENT_WEIGHTS) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  if (mpi->get_size() > 1)
+    GTEST_SKIP() << "Elements are numbered for a single process";
+
+  const std::string filename = "load_balance_tests_weights.txt";
+  const std::vector<int> serial_ispec = { 2, 0, 1 };
+  const std::vector<type_real> element_weights = { 1.0, 0.5, 2.0 };
+
+  // A single process keeps its total weight
+  specfem::load_balance::write_element_weights(filename, serial_ispec,
+                                               element_weights, 3.0, mpi);
+  const auto weights =
+      specfem::partitioner::read_element_weights(filename, 3);
+  ASSERT_EQ(weights.size(), 3);
+  EXPECT_FLOAT_EQ(weights[0], 0.5);
+  EXPECT_FLOAT_EQ(weights[1], 2.0);
+  EXPECT_FLOAT_EQ(weights[2], 1.0);
+
+  // Meshes which weren't partitioned don't define serial indices
+  EXPECT_THROW(specfem::load_balance::write_element_weights(
+                   filename, {}, element_weights, 3.0, mpi),
+               std::runtime_error);
+  std::remove(filename.c_str());
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
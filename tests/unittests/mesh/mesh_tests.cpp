@@ -65,6 +65,47 @@ TEST(MESH_TESTS, fortran_binary_reader) {
                                      MPIEnvironment::mpi_));
 }
 
+/**
+ *
+ * Check that arrays stored in node shared memory match private arrays
+ *
+ */
+TEST(MESH_TESTS, node_shared_reader) {
+
+  // Node shared storage requires every process to read the same database
+  if (MPIEnvironment::mpi_->get_size() > 1)
+    GTEST_SKIP();
+
+  std::string config_filename =
+      "../../../tests/unittests/mesh/test_config.yaml";
+  test_config test_config =
+      get_test_config(config_filename, MPIEnvironment::mpi_);
+
+  std::vector<specfem::material *> materials;
+  specfem::mesh mesh(test_config.database_filename, materials,
+                     MPIEnvironment::mpi_);
+  specfem::mesh shared(test_config.database_filename, materials,
+                       MPIEnvironment::mpi_, true);
+
+  ASSERT_EQ(shared.npgeo, mesh.npgeo);
+  ASSERT_EQ(shared.nspec, mesh.nspec);
+
+  for (int ipgeo = 0; ipgeo < mesh.npgeo; ipgeo++) {
+    EXPECT_EQ(shared.coorg(0, ipgeo), mesh.coorg(0, ipgeo));
+    EXPECT_EQ(shared.coorg(1, ipgeo), mesh.coorg(1, ipgeo));
+  }
+
+  const int ngnod = mesh.material_ind.knods.extent(0);
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    EXPECT_EQ(shared.material_ind.kmato(ispec), mesh.material_ind.kmato(ispec));
+    EXPECT_EQ(shared.material_ind.region_CPML(ispec),
+              mesh.material_ind.region_CPML(ispec));
+    for (int in = 0; in < ngnod; in++)
+      EXPECT_EQ(shared.material_ind.knods(in, ispec),
+                mesh.material_ind.knods(in, ispec));
+  }
+}
+
 int main(int argc, char *argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
@@ -0,0 +1,166 @@
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/material.h"
+#include "../../../include/mesh.h"
+#include "../../../include/mesher.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+// Elastic layer under an acoustic layer with a sloping top interface
+specfem::mesher::layered_model two_layers(const int ngnod) {
+  specfem::mesher::layered_model model;
+  model.xmin = 0.0;
+  model.xmax = 4.0;
+  model.zmin = -2.0;
+  model.nx = 4;
+  model.ngnod = ngnod;
+  model.absorbing = { true, true, false, true };
+
+  specfem::mesher::layer elastic;
+  elastic.nz = 2;
+  elastic.top = { { 0.0, 0.0 } };
+  elastic.rho = 2700.0;
+  elastic.vp = 3000.0;
+  elastic.vs = 1700.0;
+
+  specfem::mesher::layer acoustic;
+  acoustic.nz = 1;
+  acoustic.top = { { 0.0, 1.0 }, { 4.0, 2.0 } };
+  acoustic.rho = 1000.0;
+  acoustic.vp = 1500.0;
+  acoustic.vs = 0.0;
+
+  model.layers = { elastic, acoustic };
+  return model;
+}
+
+TEST(MESHER_TESTS, LAYERED_GRID) {
+  std::vector<specfem::material *> materials;
+  const auto mesh = specfem::mesher::generate(two_layers(4), materials,
+                                              MPIEnvironment::mpi_);
+
+  ASSERT_EQ(mesh.nspec, 12);
+  ASSERT_EQ(mesh.npgeo, 20);
+  ASSERT_EQ(materials.size(), 2);
+  EXPECT_EQ(materials[0]->get_ispec_type(), specfem::elements::elastic);
+  EXPECT_EQ(materials[1]->get_ispec_type(), specfem::elements::acoustic);
+
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    EXPECT_EQ(mesh.material_ind.kmato(ispec), (ispec < 8) ? 0 : 1);
+
+    // Corners are counterclockwise
+    const auto &knods = mesh.material_ind.knods;
+    type_real area = 0.0;
+    for (int in = 0; in < 4; in++) {
+      const int n1 = knods(in, ispec);
+      const int n2 = knods((in + 1) % 4, ispec);
+      area += mesh.coorg(0, n1) * mesh.coorg(1, n2) -
+              mesh.coorg(0, n2) * mesh.coorg(1, n1);
+    }
+    EXPECT_GT(area, 0.0);
+  }
+
+  // Top right corner follows the sloping interface
+  const int top_right = mesh.material_ind.knods(2, 11);
+  EXPECT_FLOAT_EQ(mesh.coorg(0, top_right), 4.0);
+  EXPECT_FLOAT_EQ(mesh.coorg(1, top_right), 2.0);
+  const int top_middle = mesh.material_ind.knods(3, 10);
+  EXPECT_FLOAT_EQ(mesh.coorg(1, top_middle), 1.5);
+
+  // Bottom edges and the left and right edges of every row
+  EXPECT_EQ(mesh.parameters.nelemabs, 4 + 2 * 3);
+  int nbottom = 0;
+  for (int inum = 0; inum < mesh.parameters.nelemabs; inum++) {
+    if (mesh.abs_boundary.codeabs(inum, 0)) {
+      EXPECT_LT(mesh.abs_boundary.numabs(inum), 4);
+      nbottom++;
+    }
+    EXPECT_FALSE(mesh.abs_boundary.codeabs(inum, 2));
+  }
+  EXPECT_EQ(nbottom, 4);
+
+  ASSERT_EQ(mesh.fluid_solid_edges.nedges(), 4);
+  for (int inum = 0; inum < 4; inum++) {
+    EXPECT_EQ(mesh.fluid_solid_edges.ispec_acoustic(inum), 8 + inum);
+    EXPECT_EQ(mesh.fluid_solid_edges.ispec_elastic(inum), 4 + inum);
+  }
+
+  for (auto &material : materials)
+    delete material;
+}
+
+TEST(MESHER_TESTS, NINE_NODE_ELEMENTS) {
+  std::vector<specfem::material *> materials;
+  const auto mesh = specfem::mesher::generate(two_layers(9), materials,
+                                              MPIEnvironment::mpi_);
+
+  ASSERT_EQ(mesh.npgeo, 9 * 7);
+  const auto &knods = mesh.material_ind.knods;
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    // The centre node is the average of the corners of flat layers
+    if (ispec >= 8)
+      continue;
+    type_real x = 0.0, z = 0.0;
+    for (int in = 0; in < 4; in++) {
+      x += 0.25 * mesh.coorg(0, knods(in, ispec));
+      z += 0.25 * mesh.coorg(1, knods(in, ispec));
+    }
+    EXPECT_FLOAT_EQ(mesh.coorg(0, knods(8, ispec)), x);
+    EXPECT_FLOAT_EQ(mesh.coorg(1, knods(8, ispec)), z);
+  }
+
+  for (auto &material : materials)
+    delete material;
+}
+
+TEST(MESHER_TESTS, CROSSING_INTERFACES) {
+  auto model = two_layers(4);
+  model.layers[1].top = { { 0.0, 1.0 }, { 4.0, -1.0 } };
+
+  std::vector<specfem::material *> materials;
+  EXPECT_THROW(
+      specfem::mesher::generate(model, materials, MPIEnvironment::mpi_),
+      std::runtime_error);
+}
+
+TEST(MESHER_TESTS, AXISYMMETRIC) {
+  auto model = two_layers(4);
+  model.axisymmetric = true;
+  model.absorbing = { true, true, false, false };
+
+  std::vector<specfem::material *> materials;
+  const auto mesh =
+      specfem::mesher::generate(model, materials, MPIEnvironment::mpi_);
+
+  // Elements of the first column are on the axis
+  EXPECT_TRUE(mesh.axisym);
+  EXPECT_EQ(mesh.parameters.nelem_on_the_axis, 3);
+  ASSERT_EQ(mesh.axial_nodes.is_on_the_axis.extent(0), mesh.nspec);
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    EXPECT_EQ(mesh.axial_nodes.is_on_the_axis(ispec), ispec % 4 == 0);
+  }
+
+  for (auto &material : materials)
+    delete material;
+
+  // The axis is the left edge, at x = 0, and isn't absorbing
+  model.absorbing[3] = true;
+  EXPECT_THROW(
+      specfem::mesher::generate(model, materials, MPIEnvironment::mpi_),
+      std::runtime_error);
+  model.absorbing[3] = false;
+  model.xmin = 1.0;
+  EXPECT_THROW(
+      specfem::mesher::generate(model, materials, MPIEnvironment::mpi_),
+      std::runtime_error);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,224 @@
+#include "../../../include/enums.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/mpi_interfaces.h"
+#include "../../../include/specfem_mpi.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+// Tests hold for any number of processes. Ranks form a chain: rank r holds a
+// column of nez elements spanning x in [r, r + 1] and shares its left edge
+// with rank r - 1 and its right edge with rank r + 1
+
+constexpr int nez = 2;
+constexpr int ngll = 3;
+constexpr int ncomponents = 2;
+
+struct column {
+  specfem::kokkos::HostElementMirror3d<int> h_ibool;
+  specfem::kokkos::HostView2d<type_real> coord;
+  specfem::kokkos::HostView2d<int> knods;
+  specfem::kokkos::HostMirror1d<specfem::elements::type> h_ispec_type;
+
+  column(const int rank)
+      : h_ibool("halo_tests::h_ibool", nez, ngll, ngll),
+        coord("halo_tests::coord", ndim, ngll * (nez * (ngll - 1) + 1)),
+        knods("halo_tests::knods", 4, nez),
+        h_ispec_type("halo_tests::h_ispec_type", nez) {
+    for (int ispec = 0; ispec < nez; ispec++) {
+      for (int iz = 0; iz < ngll; iz++) {
+        for (int ix = 0; ix < ngll; ix++) {
+          const int iglob = (ispec * (ngll - 1) + iz) * ngll + ix;
+          h_ibool(ispec, iz, ix) = iglob;
+          coord(0, iglob) = rank + static_cast<type_real>(ix) / (ngll - 1);
+          coord(1, iglob) = ispec + static_cast<type_real>(iz) / (ngll - 1);
+        }
+      }
+      // Control nodes are numbered 2 * iz + ix on the corners of the column
+      knods(0, ispec) = 2 * ispec;
+      knods(1, ispec) = 2 * ispec + 1;
+      knods(2, ispec) = 2 * ispec + 3;
+      knods(3, ispec) = 2 * ispec + 2;
+      h_ispec_type(ispec) = specfem::elements::elastic;
+    }
+  }
+
+  int nglob() const { return coord.extent(1); }
+};
+
+// Interfaces of rank in the chain. Edges are listed with 1-based element and
+// control node ids as in the database. nright elements are listed on the
+// right edge
+specfem::interfaces::interface chain_interface(const int rank, const int size,
+                                               const int nright = nez) {
+  std::vector<int> neighbors;
+  if (rank > 0)
+    neighbors.push_back(rank - 1);
+  if (rank < size - 1)
+    neighbors.push_back(rank + 1);
+
+  specfem::interfaces::interface interface(neighbors.size(), nez);
+  for (int iinterface = 0; iinterface < neighbors.size(); iinterface++) {
+    const bool left = (neighbors[iinterface] < rank);
+    const int nelements = left ? nez : nright;
+    interface.my_neighbors(iinterface) = neighbors[iinterface];
+    interface.my_nelmnts_neighbors(iinterface) = nelements;
+    for (int ispec = 0; ispec < nelements; ispec++) {
+      interface.my_interfaces(iinterface, ispec, 0) = ispec + 1;
+      interface.my_interfaces(iinterface, ispec, 1) = 2;
+      interface.my_interfaces(iinterface, ispec, 2) =
+          (left ? 2 * ispec : 2 * ispec + 1) + 1;
+      interface.my_interfaces(iinterface, ispec, 3) =
+          (left ? 2 * ispec + 2 : 2 * ispec + 3) + 1;
+    }
+  }
+
+  return interface;
+}
+
+// Value of component icomp at height z before assembly on rank
+type_real local_value(const int rank, const int icomp, const type_real z) {
+  return (rank + 1) * (icomp + 1) + 10 * z;
+}
+
+TEST(HALO, NO_NEIGHBORS) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  const column mesh(mpi->get_rank());
+  const int nglob = mesh.nglob();
+
+  specfem::interfaces::interface interface(0, 0);
+  specfem::interfaces::halo halo(interface, mesh.h_ibool, mesh.coord,
+                                 mesh.knods, mesh.h_ispec_type, ncomponents,
+                                 mpi);
+  EXPECT_EQ(halo.get_nneighbors(), 0);
+
+  specfem::kokkos::DeviceFieldView2d<type_real> field("field", nglob,
+                                                      ncomponents);
+  specfem::kokkos::DeviceView1d<type_real> values("values", nglob);
+  auto h_field = Kokkos::create_mirror_view(field);
+  auto h_values = Kokkos::create_mirror_view(values);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    h_values(iglob) = iglob;
+    for (int icomp = 0; icomp < ncomponents; icomp++)
+      h_field(iglob, icomp) = iglob * ncomponents + icomp;
+  }
+  Kokkos::deep_copy(field, h_field);
+  Kokkos::deep_copy(values, h_values);
+
+  // Default halos and halos without interfaces don't modify arrays
+  specfem::interfaces::halo empty;
+  for (auto *h : { &halo, &empty }) {
+    h->assemble(field);
+    h->assemble(values);
+  }
+  Kokkos::fence();
+
+  Kokkos::deep_copy(h_field, field);
+  Kokkos::deep_copy(h_values, values);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    EXPECT_EQ(h_values(iglob), iglob);
+    for (int icomp = 0; icomp < ncomponents; icomp++)
+      EXPECT_EQ(h_field(iglob, icomp), iglob * ncomponents + icomp);
+  }
+  EXPECT_EQ(halo.get_wait_time(), 0.0);
+}
+
+// Points of the left and right edges receive the values of the neighbor at
+// the same coordinates, other points are unchanged
+TEST(HALO, CHAIN_ASSEMBLY) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  const int rank = mpi->get_rank();
+  const int size = mpi->get_size();
+  if (size < 2)
+    GTEST_SKIP() << "Assembly across interfaces needs at least 2 processes";
+
+  const column mesh(rank);
+  const int nglob = mesh.nglob();
+  specfem::interfaces::halo halo(chain_interface(rank, size), mesh.h_ibool,
+                                 mesh.coord, mesh.knods, mesh.h_ispec_type,
+                                 ncomponents, mpi);
+  EXPECT_EQ(halo.get_nneighbors(), (rank > 0) + (rank < size - 1));
+  EXPECT_EQ(halo.get_host_points().extent(0),
+            static_cast<std::size_t>(halo.get_nneighbors() *
+                                     (nez * (ngll - 1) + 1)));
+
+  specfem::kokkos::DeviceFieldView2d<type_real> field("field", nglob,
+                                                      ncomponents);
+  auto h_field = Kokkos::create_mirror_view(field);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    for (int icomp = 0; icomp < ncomponents; icomp++)
+      h_field(iglob, icomp) = local_value(rank, icomp, mesh.coord(1, iglob));
+  }
+
+  // Persistent requests are reused by every assembly
+  for (int iassembly = 0; iassembly < 2; iassembly++) {
+    Kokkos::deep_copy(field, h_field);
+    halo.assemble(field);
+    Kokkos::fence();
+  }
+
+  const auto h_assembled = Kokkos::create_mirror_view(field);
+  Kokkos::deep_copy(h_assembled, field);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    const type_real x = mesh.coord(0, iglob);
+    const type_real z = mesh.coord(1, iglob);
+    for (int icomp = 0; icomp < ncomponents; icomp++) {
+      type_real expected = local_value(rank, icomp, z);
+      if (x == rank && rank > 0)
+        expected += local_value(rank - 1, icomp, z);
+      if (x == rank + 1 && rank < size - 1)
+        expected += local_value(rank + 1, icomp, z);
+      EXPECT_EQ(h_assembled(iglob, icomp), expected)
+          << "For point (" << x << ", " << z << ") component " << icomp;
+    }
+  }
+
+  // Arrays with one value per point, e.g. the mass matrix
+  specfem::kokkos::DeviceView1d<type_real> values("values", nglob);
+  Kokkos::deep_copy(values, 1.0);
+  halo.assemble(values);
+  const auto h_values = Kokkos::create_mirror_view(values);
+  Kokkos::deep_copy(h_values, values);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    const type_real x = mesh.coord(0, iglob);
+    const int nshared = (x == rank && rank > 0) +
+                        (x == rank + 1 && rank < size - 1);
+    EXPECT_EQ(h_values(iglob), 1.0 + nshared) << "For point " << iglob;
+  }
+}
+
+// Rank 0 lists a single element on its right edge, hence ranks 0 and 1 don't
+// share the same number of points
+TEST(HALO, POINT_COUNT_MISMATCH) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  const int rank = mpi->get_rank();
+  const int size = mpi->get_size();
+  if (size < 2)
+    GTEST_SKIP() << "Assembly across interfaces needs at least 2 processes";
+
+  const column mesh(rank);
+  const auto interface =
+      chain_interface(rank, size, (rank == 0) ? nez - 1 : nez);
+  const auto build = [&]() {
+    specfem::interfaces::halo halo(interface, mesh.h_ibool, mesh.coord,
+                                   mesh.knods, mesh.h_ispec_type, ncomponents,
+                                   mpi);
+  };
+
+  if (rank < 2) {
+    EXPECT_THROW(build(), std::runtime_error);
+  } else {
+    EXPECT_NO_THROW(build());
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
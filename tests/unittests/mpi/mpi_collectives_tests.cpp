@@ -0,0 +1,118 @@
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/specfem_mpi.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <vector>
+
+// Tests hold for any number of processes
+
+TEST(MPI_COLLECTIVES, ALL_REDUCE_DEVICE_VIEW) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  const int rank = mpi->get_rank();
+  const int size = mpi->get_size();
+
+  specfem::kokkos::DeviceView1d<type_real> values("values", 3);
+  const auto h_values = Kokkos::create_mirror_view(values);
+  h_values(0) = 1.0;
+  h_values(1) = rank;
+  h_values(2) = -rank;
+  Kokkos::deep_copy(values, h_values);
+
+  mpi->all_reduce(values, specfem::MPI::sum);
+  Kokkos::deep_copy(h_values, values);
+
+  EXPECT_EQ(h_values(0), size);
+  EXPECT_EQ(h_values(1), size * (size - 1) / 2);
+  EXPECT_EQ(h_values(2), -size * (size - 1) / 2);
+}
+
+TEST(MPI_COLLECTIVES, REDUCE_INT) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+
+  specfem::kokkos::HostView1d<int> values("values", 2);
+  values(0) = mpi->get_rank();
+  values(1) = mpi->get_rank();
+  mpi->reduce(values, specfem::MPI::max);
+
+  if (mpi->main_proc()) {
+    EXPECT_EQ(values(0), mpi->get_size() - 1);
+    EXPECT_EQ(values(1), mpi->get_size() - 1);
+  }
+}
+
+TEST(MPI_COLLECTIVES, NONBLOCKING) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+
+  specfem::kokkos::HostView1d<int> minimum("minimum", 1);
+  specfem::kokkos::HostView1d<double> broadcast("broadcast", 2);
+  minimum(0) = mpi->get_rank() + 1;
+  broadcast(0) = mpi->main_proc() ? 2.5 : 0.0;
+  broadcast(1) = mpi->main_proc() ? -1.0 : 0.0;
+
+  auto min_request = mpi->iall_reduce(minimum, specfem::MPI::min);
+  auto bcast_request = mpi->ibcast(broadcast, mpi->get_main());
+  min_request.wait();
+  bcast_request.wait();
+
+  EXPECT_EQ(minimum(0), 1);
+  EXPECT_EQ(broadcast(0), 2.5);
+  EXPECT_EQ(broadcast(1), -1.0);
+}
+
+TEST(MPI_COLLECTIVES, ALL_GATHERV) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  const int rank = mpi->get_rank();
+  const int size = mpi->get_size();
+
+  // Rank r contributes r + 1 copies of r
+  specfem::kokkos::HostView1d<int> lvalues("lvalues", rank + 1);
+  Kokkos::deep_copy(lvalues, rank);
+
+  std::vector<int> offsets;
+  const auto gvalues = mpi->all_gatherv(lvalues, offsets);
+
+  ASSERT_EQ(offsets.size(), static_cast<std::size_t>(size + 1));
+  ASSERT_EQ(gvalues.extent(0), static_cast<std::size_t>(size * (size + 1) / 2));
+  for (int r = 0; r < size; r++) {
+    EXPECT_EQ(offsets[r + 1] - offsets[r], r + 1);
+    for (int i = offsets[r]; i < offsets[r + 1]; i++)
+      EXPECT_EQ(gvalues(i), r);
+  }
+}
+
+TEST(MPI_COLLECTIVES, ALL_TO_ALLV) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  const int rank = mpi->get_rank();
+  const int size = mpi->get_size();
+
+  // Rank r sends r + 1 values to every rank, encoding sender and receiver
+  std::vector<int> send_offsets(size + 1, 0);
+  for (int r = 0; r < size; r++)
+    send_offsets[r + 1] = send_offsets[r] + rank + 1;
+
+  specfem::kokkos::HostView1d<int> svalues("svalues", send_offsets.back());
+  for (int r = 0; r < size; r++) {
+    for (int i = send_offsets[r]; i < send_offsets[r + 1]; i++)
+      svalues(i) = rank * size + r;
+  }
+
+  std::vector<int> recv_offsets;
+  const auto rvalues = mpi->all_to_allv(svalues, send_offsets, recv_offsets);
+
+  ASSERT_EQ(recv_offsets.size(), static_cast<std::size_t>(size + 1));
+  for (int r = 0; r < size; r++) {
+    EXPECT_EQ(recv_offsets[r + 1] - recv_offsets[r], r + 1);
+    for (int i = recv_offsets[r]; i < recv_offsets[r + 1]; i++)
+      EXPECT_EQ(rvalues(i), r * size + rank);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
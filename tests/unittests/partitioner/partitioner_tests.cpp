@@ -0,0 +1,221 @@
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/mesh.h"
+#include "../../../include/partitioner.h"
+#include "../Kokkos_Environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Serial mesh of a structured nx * nz grid of unit 4 node elements without
+// boundaries. Element (jx, jz) of the grid is element jz * nx + jx
+specfem::mesh structured_mesh(const int nx, const int nz) {
+  specfem::mesh mesh;
+  mesh.nspec = nx * nz;
+  mesh.npgeo = (nx + 1) * (nz + 1);
+  mesh.nproc = 1;
+  mesh.interface.ninterfaces = 0;
+
+  mesh.coorg = specfem::kokkos::HostView2d<type_real>(
+      "partitioner_tests::coorg", ndim, mesh.npgeo);
+  for (int jz = 0; jz <= nz; jz++) {
+    for (int jx = 0; jx <= nx; jx++) {
+      mesh.coorg(0, jz * (nx + 1) + jx) = jx;
+      mesh.coorg(1, jz * (nx + 1) + jx) = jz;
+    }
+  }
+
+  mesh.material_ind = specfem::materials::material_ind(mesh.nspec, 4);
+  for (int jz = 0; jz < nz; jz++) {
+    for (int jx = 0; jx < nx; jx++) {
+      const int ispec = jz * nx + jx;
+      mesh.material_ind.kmato(ispec) = 0;
+      mesh.material_ind.region_CPML(ispec) = 0;
+      mesh.material_ind.knods(0, ispec) = jz * (nx + 1) + jx;
+      mesh.material_ind.knods(1, ispec) = jz * (nx + 1) + jx + 1;
+      mesh.material_ind.knods(2, ispec) = (jz + 1) * (nx + 1) + jx + 1;
+      mesh.material_ind.knods(3, ispec) = (jz + 1) * (nx + 1) + jx;
+    }
+  }
+
+  mesh.abs_boundary = specfem::boundaries::absorbing_boundary(0);
+  mesh.acforcing_boundary = specfem::boundaries::forcing_boundary(0);
+  mesh.acfree_surface = specfem::surfaces::acoustic_free_surface(0);
+  mesh.axial_nodes = specfem::elements::axial_elements(mesh.nspec);
+  for (int ispec = 0; ispec < mesh.nspec; ispec++)
+    mesh.axial_nodes.is_on_the_axis(ispec) = false;
+
+  mesh.parameters.nspec = mesh.nspec;
+  mesh.parameters.nelemabs = 0;
+  mesh.parameters.nelem_acforcing = 0;
+  mesh.parameters.nelem_acoustic_surface = 0;
+  mesh.parameters.nelem_on_the_axis = 0;
+
+  return mesh;
+}
+
+std::vector<type_real> partition_costs(const std::vector<type_real> &weights,
+                                       const std::vector<int> &partition,
+                                       const int nparts) {
+  std::vector<type_real> costs(nparts, 0.0);
+  for (int ispec = 0; ispec < partition.size(); ispec++) {
+    EXPECT_GE(partition[ispec], 0);
+    EXPECT_LT(partition[ispec], nparts);
+    costs[partition[ispec]] += weights[ispec];
+  }
+  return costs;
+}
+
+TEST(partitioner_tests, UNIFORM_WEIGHTS) {
+  const int nx = 8, nz = 8, nparts = 4;
+  const auto mesh = structured_mesh(nx, nz);
+  const std::vector<type_real> weights(nx * nz, 1.0);
+
+  const auto partition = specfem::partitioner::partition_elements(
+      mesh.coorg, mesh.material_ind.knods, weights, nparts);
+
+  for (const type_real cost : partition_costs(weights, partition, nparts))
+    EXPECT_EQ(cost, 16.0);
+}
+
+TEST(partitioner_tests, ELEMENT_WEIGHTS) {
+  const int nx = 8, nz = 8, nparts = 2;
+  const auto mesh = structured_mesh(nx, nz);
+
+  // Elements in the left half of the grid are twice as expensive
+  std::vector<type_real> weights(nx * nz, 1.0);
+  for (int ispec = 0; ispec < nx * nz; ispec++) {
+    if (ispec % nx < nx / 2)
+      weights[ispec] = 2.0;
+  }
+
+  const auto partition = specfem::partitioner::partition_elements(
+      mesh.coorg, mesh.material_ind.knods, weights, nparts);
+
+  const auto costs = partition_costs(weights, partition, nparts);
+  EXPECT_LE(std::abs(costs[0] - costs[1]), 2.0);
+}
+
+TEST(partitioner_tests, NONEMPTY_PARTS) {
+  const int nx = 2, nz = 2, nparts = 4;
+  const auto mesh = structured_mesh(nx, nz);
+
+  // A single expensive element would otherwise fill most parts
+  std::vector<type_real> weights(nx * nz, 1.0);
+  weights[0] = 100.0;
+
+  const auto partition = specfem::partitioner::partition_elements(
+      mesh.coorg, mesh.material_ind.knods, weights, nparts);
+
+  std::vector<int> sorted(partition);
+  std::sort(sorted.begin(), sorted.end());
+  for (int ipart = 0; ipart < nparts; ipart++)
+    EXPECT_EQ(sorted[ipart], ipart);
+
+  EXPECT_THROW(specfem::partitioner::partition_elements(
+                   mesh.coorg, mesh.material_ind.knods, weights, nx * nz + 1),
+               std::runtime_error);
+}
+
+TEST(partitioner_tests, MESH_PARTITION) {
+  const int nx = 4, nz = 2;
+  auto mesh = structured_mesh(nx, nz);
+
+  // Left and right halves of the grid
+  std::vector<int> partition(nx * nz);
+  for (int ispec = 0; ispec < nx * nz; ispec++)
+    partition[ispec] = (ispec % nx < nx / 2) ? 0 : 1;
+
+  mesh.partition(partition, 1);
+
+  EXPECT_EQ(mesh.nspec, 4);
+  EXPECT_EQ(mesh.npgeo, 9);
+  EXPECT_EQ(mesh.nproc, 2);
+  EXPECT_EQ(mesh.parameters.nspec, 4);
+
+  // Kept elements are the right half of the grid
+  ASSERT_EQ(mesh.serial_ispec.size(), mesh.nspec);
+  for (int ispec = 0; ispec < mesh.nspec; ispec++)
+    EXPECT_EQ(partition[mesh.serial_ispec[ispec]], 1);
+
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    for (int in = 0; in < 4; in++) {
+      const int ipgeo = mesh.material_ind.knods(in, ispec);
+      ASSERT_GE(ipgeo, 0);
+      ASSERT_LT(ipgeo, mesh.npgeo);
+      EXPECT_GE(mesh.coorg(0, ipgeo), 2.0);
+    }
+  }
+
+  // Both elements on the left column share an edge with partition 0
+  ASSERT_EQ(mesh.interface.ninterfaces, 1);
+  EXPECT_EQ(mesh.interface.my_neighbors(0), 0);
+  ASSERT_EQ(mesh.interface.my_nelmnts_neighbors(0), 2);
+  for (int ie = 0; ie < 2; ie++) {
+    EXPECT_EQ(mesh.interface.my_interfaces(0, ie, 1), 2);
+    for (int k = 2; k < 4; k++) {
+      const int ipgeo = mesh.interface.my_interfaces(0, ie, k) - 1;
+      EXPECT_EQ(mesh.coorg(0, ipgeo), 2.0);
+    }
+  }
+
+  EXPECT_THROW(mesh.partition(std::vector<int>(mesh.nspec, 0), 0),
+               std::runtime_error);
+}
+
+TEST(partitioner_tests, REORDERED_PARTITION) {
+  const int nx = 4, nz = 4;
+  auto mesh = structured_mesh(nx, nz);
+
+  // Bottom and top halves of the grid
+  std::vector<int> partition(nx * nz);
+  for (int ispec = 0; ispec < nx * nz; ispec++)
+    partition[ispec] = (ispec / nx < nz / 2) ? 0 : 1;
+
+  mesh.partition(partition, 1);
+  mesh.reorder_elements(specfem::reordering::morton);
+
+  // Lower left corner of element (jx, jz) is (jx, jz)
+  ASSERT_EQ(mesh.serial_ispec.size(), mesh.nspec);
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    const int serial = mesh.serial_ispec[ispec];
+    const int ipgeo = mesh.material_ind.knods(0, ispec);
+    EXPECT_EQ(mesh.coorg(0, ipgeo), serial % nx);
+    EXPECT_EQ(mesh.coorg(1, ipgeo), serial / nx);
+  }
+}
+
+TEST(partitioner_tests, READ_ELEMENT_WEIGHTS) {
+  const std::string filename = "partitioner_tests_weights.txt";
+  {
+    std::ofstream file(filename);
+    file << "2 0.5\n0 1.5\n1 2\n";
+  }
+  const auto weights = specfem::partitioner::read_element_weights(filename, 3);
+  ASSERT_EQ(weights.size(), 3);
+  EXPECT_FLOAT_EQ(weights[0], 1.5);
+  EXPECT_FLOAT_EQ(weights[1], 2.0);
+  EXPECT_FLOAT_EQ(weights[2], 0.5);
+
+  // Every element needs a weight
+  EXPECT_THROW(specfem::partitioner::read_element_weights(filename, 4),
+               std::runtime_error);
+  {
+    std::ofstream file(filename);
+    file << "0 1.0\n3 1.0\n";
+  }
+  EXPECT_THROW(specfem::partitioner::read_element_weights(filename, 2),
+               std::runtime_error);
+  std::remove(filename.c_str());
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,85 @@
+#include "../../../include/progress.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <string>
+
+// Content of a text file
+static std::string read(const std::string &filename) {
+  std::ifstream file(filename);
+  return std::string((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+}
+
+TEST(PROGRESS_TESTS, EVERY_STEP) {
+  specfem::progress::reporter progress(MPIEnvironment::mpi_, 0.0, 100.0);
+  progress.update(1, 4);
+  EXPECT_NE(progress.get_message().find("executed 1 steps of 4 steps"),
+            std::string::npos);
+  progress.update(2, 4);
+  EXPECT_NE(progress.get_message().find("executed 2 steps of 4 steps"),
+            std::string::npos);
+  EXPECT_NE(progress.get_message().find("elements/s, ETA "),
+            std::string::npos);
+}
+
+TEST(PROGRESS_TESTS, INTERVAL) {
+  specfem::progress::reporter progress(MPIEnvironment::mpi_, 3600.0, 100.0);
+  progress.update(1, 4);
+  progress.update(2, 4);
+  EXPECT_EQ(progress.get_message(), "");
+
+  // The last step of a loop is always reported
+  progress.update(4, 4);
+  EXPECT_NE(progress.get_message().find("executed 4 steps of 4 steps"),
+            std::string::npos);
+
+  // A new loop starts when the name of the steps changes
+  progress.update(1, 4, "adjoint steps");
+  EXPECT_NE(progress.get_message().find("executed 4 steps"),
+            std::string::npos);
+  progress.update(4, 4, "adjoint steps");
+  EXPECT_NE(progress.get_message().find("executed 4 adjoint steps"),
+            std::string::npos);
+}
+
+TEST(PROGRESS_TESTS, STATUS_FILE) {
+  const std::string filename = "progress_tests_status.json";
+  specfem::progress::reporter progress(MPIEnvironment::mpi_, 0.0, 100.0,
+                                       filename);
+  progress.update(3, 10);
+  std::string json = read(filename);
+  EXPECT_NE(json.find("\"state\": \"running\""), std::string::npos);
+  EXPECT_NE(json.find("\"step\": 3, \"nstep\": 10"), std::string::npos);
+  EXPECT_NE(json.find("\"eta_seconds\""), std::string::npos);
+  EXPECT_FALSE(std::filesystem::exists(filename + ".tmp"));
+
+  progress.finish();
+  json = read(filename);
+  EXPECT_NE(json.find("\"state\": \"finished\""), std::string::npos);
+  std::filesystem::remove(filename);
+}
+
+TEST(PROGRESS_TESTS, DISABLED_REPORTER) {
+  const std::string filename = "progress_tests_disabled.json";
+  specfem::progress::reporter progress(MPIEnvironment::mpi_, -1.0, 100.0,
+                                       filename);
+  progress.update(10, 10);
+  progress.finish();
+  EXPECT_EQ(progress.get_message(), "");
+  EXPECT_FALSE(std::filesystem::exists(filename));
+
+  specfem::progress::disabled()->update(10, 10);
+  EXPECT_EQ(specfem::progress::disabled()->get_message(), "");
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,137 @@
+#include "../../../include/enums.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/reordering.h"
+#include "../Kokkos_Environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <tuple>
+#include <vector>
+
+// Control nodes of a structured nx * nz grid of unit 4 node elements. Element
+// ielement of the grid is stored at position element_order[ielement]
+std::tuple<specfem::kokkos::HostView2d<type_real>,
+           specfem::kokkos::HostView2d<int> >
+structured_mesh(const int nx, const int nz,
+                const std::vector<int> &element_order) {
+  const int npgeo = (nx + 1) * (nz + 1);
+  specfem::kokkos::HostView2d<type_real> coorg("reordering_tests::coorg", ndim,
+                                               npgeo);
+  specfem::kokkos::HostView2d<int> knods("reordering_tests::knods", 4,
+                                         nx * nz);
+
+  for (int jz = 0; jz <= nz; jz++) {
+    for (int jx = 0; jx <= nx; jx++) {
+      coorg(0, jz * (nx + 1) + jx) = jx;
+      coorg(1, jz * (nx + 1) + jx) = jz;
+    }
+  }
+
+  for (int jz = 0; jz < nz; jz++) {
+    for (int jx = 0; jx < nx; jx++) {
+      const int ispec = element_order[jz * nx + jx];
+      knods(0, ispec) = jz * (nx + 1) + jx;
+      knods(1, ispec) = jz * (nx + 1) + jx + 1;
+      knods(2, ispec) = (jz + 1) * (nx + 1) + jx + 1;
+      knods(3, ispec) = (jz + 1) * (nx + 1) + jx;
+    }
+  }
+
+  return std::make_tuple(coorg, knods);
+}
+
+// Maximum distance in the new ordering between elements sharing a node
+int bandwidth(const specfem::kokkos::HostView2d<int> knods,
+              const std::vector<int> &permutation) {
+  const int nspec = knods.extent(1);
+  std::vector<int> inverse(nspec);
+  for (int inew = 0; inew < nspec; inew++)
+    inverse[permutation[inew]] = inew;
+
+  int bw = 0;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int jspec = 0; jspec < nspec; jspec++) {
+      bool shared = false;
+      for (int in = 0; in < 4; in++)
+        for (int jn = 0; jn < 4; jn++)
+          shared = shared || (knods(in, ispec) == knods(jn, jspec));
+      if (shared)
+        bw = std::max(bw, std::abs(inverse[ispec] - inverse[jspec]));
+    }
+  }
+  return bw;
+}
+
+void check_permutation(const std::vector<int> &permutation, const int nspec) {
+  std::vector<int> sorted(permutation);
+  std::sort(sorted.begin(), sorted.end());
+  ASSERT_EQ(sorted.size(), nspec);
+  for (int i = 0; i < nspec; i++)
+    EXPECT_EQ(sorted[i], i);
+}
+
+TEST(reordering_tests, MORTON) {
+  const int nx = 4, nz = 4;
+  std::vector<int> element_order(nx * nz);
+  for (int i = 0; i < nx * nz; i++)
+    element_order[i] = i;
+
+  auto [coorg, knods] = structured_mesh(nx, nz, element_order);
+
+  const auto permutation = specfem::reordering::element_permutation(
+      coorg, knods, specfem::reordering::morton);
+
+  check_permutation(permutation, nx * nz);
+
+  // Z-order traversal of a 4 x 4 grid numbered row by row
+  const std::vector<int> expected = { 0, 1, 4,  5,  2,  3,  6,  7,
+                                      8, 9, 12, 13, 10, 11, 14, 15 };
+  EXPECT_EQ(permutation, expected);
+}
+
+TEST(reordering_tests, CUTHILL_MCKEE) {
+  const int nx = 4, nz = 8;
+  // Scatter elements of the grid
+  std::vector<int> element_order(nx * nz);
+  for (int i = 0; i < nx * nz; i++)
+    element_order[i] = (7 * i) % (nx * nz);
+
+  auto [coorg, knods] = structured_mesh(nx, nz, element_order);
+
+  const auto permutation = specfem::reordering::element_permutation(
+      coorg, knods, specfem::reordering::cuthill_mckee);
+
+  check_permutation(permutation, nx * nz);
+
+  std::vector<int> identity(nx * nz);
+  for (int i = 0; i < nx * nz; i++)
+    identity[i] = i;
+
+  const int bw_scattered = bandwidth(knods, identity);
+  const int bw_reordered = bandwidth(knods, permutation);
+
+  EXPECT_LT(bw_reordered, bw_scattered);
+  EXPECT_LE(bw_reordered, 2 * (nx + 1));
+}
+
+TEST(reordering_tests, NONE) {
+  const int nx = 3, nz = 2;
+  std::vector<int> element_order(nx * nz);
+  for (int i = 0; i < nx * nz; i++)
+    element_order[i] = i;
+
+  auto [coorg, knods] = structured_mesh(nx, nz, element_order);
+
+  const auto permutation = specfem::reordering::element_permutation(
+      coorg, knods, specfem::reordering::none);
+
+  for (int i = 0; i < nx * nz; i++)
+    EXPECT_EQ(permutation[i], i);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,202 @@
+#include "../../../include/compute.h"
+#include "../../../include/enums.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/misfit_writer.h"
+#include "../../../include/receiver.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+constexpr int nsamples = 1000;
+constexpr type_real dt = 1e-3;
+
+// A single receiver of this process recording displacements along BXX
+struct misfit_setup {
+  specfem::receivers::receiver_set receivers;
+  specfem::compute::receivers compute_receivers;
+  std::filesystem::path folder;
+
+  misfit_setup() {
+    receivers.add("AA", "S0001", 0.0, 0.0);
+    receivers.set_location(0, 0.0, 0.0, 0,
+                           MPIEnvironment::mpi_->get_rank());
+
+    compute_receivers.max_sig_step = nsamples;
+    compute_receivers.seismogram =
+        specfem::kokkos::DeviceReceiverView4d<type_real>(
+            "misfit_writer_tests::seismogram", nsamples, 1, 1, 2);
+    compute_receivers.seismogram_types =
+        specfem::kokkos::DeviceView1d<specfem::seismogram::type>(
+            "misfit_writer_tests::seismogram_types", 1);
+    compute_receivers.h_seismogram_types =
+        Kokkos::create_mirror_view(compute_receivers.seismogram_types);
+    compute_receivers.h_seismogram_types(0) =
+        specfem::seismogram::displacement;
+
+    folder = std::filesystem::temp_directory_path() /
+             ("misfit_writer_" + std::to_string(getpid()));
+    std::filesystem::create_directories(folder / "observed");
+  }
+
+  ~misfit_setup() { std::filesystem::remove_all(folder); }
+
+  // Observed BXX trace d(t)
+  void observe(const std::function<type_real(type_real)> &trace) const {
+    std::ofstream file((folder / "observed" / "AAS0001BXX.semd").string());
+    for (int isample = 0; isample < nsamples; isample++)
+      file << std::scientific << isample * dt << " " << std::scientific
+           << trace(isample * dt) << "\n";
+  }
+
+  // Synthetic BXX trace s(t), every sample being compared once computed
+  void simulate(specfem::writer::misfit &writer,
+                const std::function<type_real(type_real)> &trace) {
+    auto h_seismogram =
+        Kokkos::create_mirror_view(compute_receivers.seismogram);
+    for (int isample = 0; isample < nsamples; isample++) {
+      h_seismogram(isample, 0, 0, 0) = trace(isample * dt);
+      h_seismogram(isample, 0, 0, 1) = 0.0;
+    }
+    Kokkos::deep_copy(compute_receivers.seismogram, h_seismogram);
+
+    for (int isample = 0; isample < nsamples; isample++)
+      writer.sample(isample, specfem::kokkos::DevExecSpace());
+    writer.write();
+  }
+
+  // Values of the time value lines of filename
+  std::vector<type_real> read_trace(const std::string &filename) const {
+    std::ifstream file((folder / "output" / filename).string());
+    std::vector<type_real> values;
+    type_real time, value;
+    while (file >> time >> value)
+      values.push_back(value);
+    return values;
+  }
+
+  // Misfit and shift of BXX written by this process
+  std::vector<type_real> read_misfit() const {
+    std::ifstream file(
+        (folder / "output" /
+         ("misfit_" + std::to_string(MPIEnvironment::mpi_->get_rank()) +
+          ".txt"))
+            .string());
+    std::string name;
+    file >> name;
+    EXPECT_EQ(name, "AAS0001BXX");
+    std::vector<type_real> values;
+    type_real value;
+    while (file >> value)
+      values.push_back(value);
+    return values;
+  }
+};
+
+type_real gaussian(const type_real t, const type_real t0) {
+  return std::exp(-1.0 * (t - t0) * (t - t0) / (2.0 * 0.02 * 0.02));
+}
+
+// A constant residual r gives a misfit of r^2 T / 2 and the residual as
+// adjoint source. Components without an observed trace are skipped
+TEST(MISFIT_WRITER_TESTS, l2) {
+  misfit_setup setup;
+  const auto observed = [](const type_real t) {
+    return std::sin(2 * M_PI * 5.0 * t);
+  };
+  setup.observe(observed);
+
+  specfem::writer::misfit writer(
+      setup.receivers, &setup.compute_receivers, specfem::misfit::l2,
+      (setup.folder / "observed").string(),
+      (setup.folder / "output").string(), specfem::wave::p_sv, dt, 0.0, 0.0,
+      MPIEnvironment::mpi_);
+  setup.simulate(writer,
+                 [&](const type_real t) { return observed(t) + 0.1; });
+
+  const auto misfit = setup.read_misfit();
+  ASSERT_EQ(misfit.size(), 1);
+  EXPECT_NEAR(misfit[0], 0.5 * 0.01 * nsamples * dt, 1e-6);
+
+  const auto adjoint = setup.read_trace("AAS0001BXX.adj");
+  ASSERT_EQ(adjoint.size(), nsamples);
+  for (const auto value : adjoint)
+    EXPECT_NEAR(value, 0.1, 1e-5);
+  EXPECT_FALSE(
+      std::filesystem::exists(setup.folder / "output" / "AAS0001BXZ.adj"));
+}
+
+// The synthetic pulse arrives 30 samples after the observed pulse. The
+// adjoint source f satisfies int f s' dt = -shift
+TEST(MISFIT_WRITER_TESTS, cross_correlation) {
+  misfit_setup setup;
+  const type_real shift = 30 * dt;
+  setup.observe([](const type_real t) { return gaussian(t, 0.5); });
+
+  specfem::writer::misfit writer(
+      setup.receivers, &setup.compute_receivers,
+      specfem::misfit::cross_correlation, (setup.folder / "observed").string(),
+      (setup.folder / "output").string(), specfem::wave::p_sv, dt, 0.0, 0.1,
+      MPIEnvironment::mpi_);
+  const auto synthetic = [&](const type_real t) {
+    return gaussian(t, 0.5 + shift);
+  };
+  setup.simulate(writer, synthetic);
+
+  const auto misfit = setup.read_misfit();
+  ASSERT_EQ(misfit.size(), 2);
+  EXPECT_NEAR(misfit[1], shift, 1e-6);
+  EXPECT_NEAR(misfit[0], 0.5 * shift * shift, 1e-8);
+
+  const auto adjoint = setup.read_trace("AAS0001BXX.adj");
+  ASSERT_EQ(adjoint.size(), nsamples);
+  type_real product = 0.0;
+  for (int isample = 1; isample < nsamples - 1; isample++) {
+    const type_real velocity = (synthetic((isample + 1) * dt) -
+                                synthetic((isample - 1) * dt)) /
+                               (2 * dt);
+    product += adjoint[isample] * velocity * dt;
+  }
+  EXPECT_NEAR(product, -1.0 * shift, 1e-4);
+}
+
+TEST(MISFIT_WRITER_TESTS, missing_observations) {
+  misfit_setup setup;
+
+  // Observed traces need to be sampled as the seismograms
+  {
+    std::ofstream file(
+        (setup.folder / "observed" / "AAS0001BXX.semd").string());
+    for (int isample = 0; isample < nsamples; isample++)
+      file << 2 * isample * dt << " 0.0\n";
+  }
+  EXPECT_THROW(specfem::writer::misfit(
+                   setup.receivers, &setup.compute_receivers,
+                   specfem::misfit::l2, (setup.folder / "observed").string(),
+                   (setup.folder / "output").string(), specfem::wave::p_sv,
+                   dt, 0.0, 0.0, MPIEnvironment::mpi_),
+               std::runtime_error);
+
+  std::filesystem::remove(setup.folder / "observed" / "AAS0001BXX.semd");
+  EXPECT_THROW(specfem::writer::misfit(
+                   setup.receivers, &setup.compute_receivers,
+                   specfem::misfit::l2, (setup.folder / "observed").string(),
+                   (setup.folder / "output").string(), specfem::wave::p_sv,
+                   dt, 0.0, 0.0, MPIEnvironment::mpi_),
+               std::runtime_error);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -8,10 +8,23 @@
 #include "../../../include/solver.h"
 #include "../../../include/timescheme.h"
 #include "../../../include/utils.h"
+#include "../../../include/writer.h"
 #include "../Kokkos_Environment.hpp"
 #include "../MPI_environment.hpp"
 #include "../utilities/include/compare_array.h"
 #include "yaml-cpp/yaml.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#ifdef SPECFEM_ENABLE_HDF5
+#include <hdf5.h>
+#endif
 
 // ----- Parse test config ------------- //
 
@@ -48,8 +61,8 @@ test_config parse_test_config(std::string test_configuration_file,
 
 // read field from fortran binary file
 void read_field(const std::string filename,
-                specfem::kokkos::HostMirror2d<type_real> field, const int n1,
-                const int n2) {
+                specfem::kokkos::HostFieldMirror2d<type_real> field,
+                const int n1, const int n2) {
 
   assert(field.extent(0) == n1);
   assert(field.extent(1) == n2);
@@ -106,11 +119,8 @@ TEST(SEISMOGRAM_TESTS, elastic_seismograms_test) {
                                                    gllx.get_N(), gllz.get_N());
 
   // locate the recievers
-  for (auto &receiver : receivers)
-    receiver->locate(compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
-                     gllz.get_hxi(), mesh.nproc, mesh.coorg,
-                     mesh.material_ind.knods, mesh.npgeo,
-                     material_properties.h_ispec_type, mpi);
+  receivers.locate(compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
+                   gllz.get_hxi(), mesh.coorg, mesh.material_ind.knods, mpi);
 
   // Setup solver compute struct
 
@@ -176,9 +186,306 @@ TEST(SEISMOGRAM_TESTS, elastic_seismograms_test) {
 
   assert(index == ground_truth.size());
 
+  // Fields at rest before the first recorded sample and constant afterwards.
+  // The anti-alias filter has unit gain at zero frequency, hence written
+  // samples which don't depend on samples before the first recorded sample
+  // match the seismograms above
+  const int decimation = 2;
+  const int nsig_steps = 60;
+  specfem::compute::receivers decimated_receivers(
+      receivers, stypes, gllx, gllz, xmax, xmin, zmax, zmin, nsig_steps, mpi,
+      0, decimation);
+
+  const int delay = decimated_receivers.filter_delay();
+  EXPECT_EQ(delay, 8 * decimation);
+  EXPECT_EQ(decimated_receivers.max_sig_step,
+            (nsig_steps - delay - 1) / decimation + 1);
+
+  specfem::Domain::Domain *decimated_domain = new specfem::Domain::Elastic(
+      2, nglob, &compute, &material_properties, &partial_derivatives, NULL,
+      &decimated_receivers, &gllx, &gllz);
+
+  Kokkos::deep_copy(decimated_domain->get_field(), domain->get_field());
+  Kokkos::deep_copy(decimated_domain->get_field_dot(),
+                    domain->get_field_dot());
+  Kokkos::deep_copy(decimated_domain->get_field_dot_dot(),
+                    domain->get_field_dot_dot());
+
+  for (int isig_step = 0; isig_step < nsig_steps; isig_step++)
+    decimated_domain->compute_seismogram(isig_step);
+
+  decimated_receivers.sync_seismograms();
+
+  for (int isample = delay / decimation;
+       isample < decimated_receivers.max_sig_step; isample++) {
+    for (int isys = 0; isys < stypes.size(); isys++) {
+      for (int irec = 0; irec < receivers.size(); irec++) {
+        for (int idim = 0; idim < 2; idim++) {
+          const type_real expected =
+              compute_receivers.h_seismogram(0, isys, irec, idim);
+          EXPECT_NEAR(
+              decimated_receivers.h_seismogram(isample, isys, irec, idim),
+              expected, 1e-5 * std::fabs(expected));
+        }
+      }
+    }
+  }
+
   return;
 }
 
+// Write seismograms using a device buffer of nslots samples and check the
+// Seismic Unix files. If gathered, samples are sent to the writer process
+void test_seismic_unix_writer(const int nslots, const bool gathered = false) {
+
+  const int nsteps = 16;
+  const int nreceivers = 3;
+  const type_real dt = 1e-3;
+  const type_real t0 = -0.5;
+  const int nstep_between_samples = 2;
+
+  specfem::receivers::receiver_set receivers;
+  for (int irec = 0; irec < nreceivers; irec++)
+    receivers.add("AA", "S000" + std::to_string(irec), 100.0 * irec, 25.5);
+
+  // Every receiver is stored by this process
+  specfem::MPI::MPI *mpi = gathered ? MPIEnvironment::mpi_ : nullptr;
+  if (gathered) {
+    for (int irec = 0; irec < nreceivers; irec++)
+      receivers.set_location(irec, 0.0, 0.0, 0, mpi->get_rank());
+  }
+
+  specfem::compute::receivers compute_receivers;
+  compute_receivers.max_sig_step = nsteps;
+  compute_receivers.seismogram =
+      specfem::kokkos::DeviceReceiverView4d<type_real>(
+      "seismogram", nslots, 1, nreceivers, 2);
+  compute_receivers.h_seismogram =
+      Kokkos::create_mirror_view(compute_receivers.seismogram);
+  compute_receivers.h_seismogram_types =
+      specfem::kokkos::HostMirror1d<specfem::seismogram::type>(
+          "seismogram_types", 1);
+  compute_receivers.h_seismogram_types(0) = specfem::seismogram::velocity;
+
+  const auto folder = std::filesystem::temp_directory_path() /
+                      ("seismic_unix_writer_" + std::to_string(getpid()));
+  std::filesystem::create_directories(folder);
+
+  specfem::writer::seismogram writer(
+      receivers, &compute_receivers, specfem::seismogram::format::seismic_unix,
+      folder.string(), dt, t0, nstep_between_samples, mpi);
+
+  // Samples are computed one at a time in the slots of the ring buffer
+  for (int isig_step = 0; isig_step < nsteps; isig_step++) {
+    for (int irec = 0; irec < nreceivers; irec++)
+      for (int idim = 0; idim < 2; idim++)
+        compute_receivers.h_seismogram(isig_step % nslots, 0, irec, idim) =
+            isig_step + 100 * irec + 1000 * idim;
+    Kokkos::deep_copy(compute_receivers.seismogram,
+                      compute_receivers.h_seismogram);
+    writer.sample(isig_step, specfem::kokkos::DevExecSpace());
+  }
+  writer.write();
+
+  const int trace_size = 240 + nsteps * sizeof(float);
+  const std::string files[2] = { "Ux_file_single_v.su",
+                                 "Uz_file_single_v.su" };
+  for (int idim = 0; idim < 2; idim++) {
+    std::ifstream stream((folder / files[idim]).string(), std::ios::binary);
+    ASSERT_TRUE(stream.is_open());
+    std::vector<char> data((std::istreambuf_iterator<char>(stream)),
+                           std::istreambuf_iterator<char>());
+    ASSERT_EQ(data.size(), static_cast<std::size_t>(nreceivers * trace_size));
+
+    for (int irec = 0; irec < nreceivers; irec++) {
+      const char *trace = data.data() + irec * trace_size;
+      std::int32_t tracl, gx, gelev;
+      std::int16_t delrt;
+      std::uint16_t ns, sample_dt;
+      std::memcpy(&tracl, trace, sizeof(tracl));
+      std::memcpy(&gelev, trace + 40, sizeof(gelev));
+      std::memcpy(&gx, trace + 80, sizeof(gx));
+      std::memcpy(&delrt, trace + 108, sizeof(delrt));
+      std::memcpy(&ns, trace + 114, sizeof(ns));
+      std::memcpy(&sample_dt, trace + 116, sizeof(sample_dt));
+      EXPECT_EQ(tracl, irec + 1);
+      EXPECT_EQ(gx, 10000 * irec);
+      EXPECT_EQ(gelev, 2550);
+      EXPECT_EQ(delrt, -500);
+      EXPECT_EQ(ns, nsteps);
+      EXPECT_EQ(sample_dt, 2000);
+
+      for (int isig_step = 0; isig_step < nsteps; isig_step++) {
+        float value;
+        std::memcpy(&value, trace + 240 + isig_step * sizeof(float),
+                    sizeof(value));
+        EXPECT_EQ(value, isig_step + 100 * irec + 1000 * idim);
+      }
+    }
+  }
+
+  std::filesystem::remove_all(folder);
+}
+
+TEST(SEISMOGRAM_TESTS, seismic_unix_writer) { test_seismic_unix_writer(16); }
+
+TEST(SEISMOGRAM_TESTS, seismic_unix_streaming_writer) {
+  // 16 samples are flushed in three full buffers and a partial one
+  test_seismic_unix_writer(5);
+}
+
+TEST(SEISMOGRAM_TESTS, seismic_unix_gathered_writer) {
+  test_seismic_unix_writer(16, true);
+  test_seismic_unix_writer(5, true);
+}
+
+// Write seismograms using a device buffer of nslots samples and check the
+// HDF5 file
+void test_hdf5_writer(const int nslots) {
+#ifndef SPECFEM_ENABLE_HDF5
+  GTEST_SKIP() << "SPECFEM was compiled without HDF5";
+#else
+  const int nsteps = 16;
+  const int nreceivers = 3;
+  const type_real dt = 1e-3;
+  const type_real t0 = -0.5;
+  const int nstep_between_samples = 2;
+
+  specfem::receivers::receiver_set receivers;
+  for (int irec = 0; irec < nreceivers; irec++)
+    receivers.add("AA", "S000" + std::to_string(irec), 100.0 * irec, 25.5);
+
+  specfem::compute::receivers compute_receivers;
+  compute_receivers.max_sig_step = nsteps;
+  compute_receivers.seismogram =
+      specfem::kokkos::DeviceReceiverView4d<type_real>(
+      "seismogram", nslots, 1, nreceivers, 2);
+  compute_receivers.h_seismogram =
+      Kokkos::create_mirror_view(compute_receivers.seismogram);
+  compute_receivers.h_seismogram_types =
+      specfem::kokkos::HostMirror1d<specfem::seismogram::type>(
+          "seismogram_types", 1);
+  compute_receivers.h_seismogram_types(0) = specfem::seismogram::velocity;
+
+  const auto folder = std::filesystem::temp_directory_path() /
+                      ("hdf5_writer_" + std::to_string(getpid()));
+  std::filesystem::create_directories(folder);
+
+  specfem::writer::seismogram writer(
+      receivers, &compute_receivers, specfem::seismogram::format::hdf5,
+      folder.string(), dt, t0, nstep_between_samples, nullptr, 4);
+
+  for (int isig_step = 0; isig_step < nsteps; isig_step++) {
+    for (int irec = 0; irec < nreceivers; irec++)
+      for (int idim = 0; idim < 2; idim++)
+        compute_receivers.h_seismogram(isig_step % nslots, 0, irec, idim) =
+            isig_step + 100 * irec + 1000 * idim;
+    Kokkos::deep_copy(compute_receivers.seismogram,
+                      compute_receivers.h_seismogram);
+    writer.sample(isig_step, specfem::kokkos::DevExecSpace());
+  }
+  writer.write();
+
+  const hid_t file = H5Fopen((folder / "seismograms.h5").string().c_str(),
+                             H5F_ACC_RDONLY, H5P_DEFAULT);
+  ASSERT_GE(file, 0);
+
+  std::vector<double> values(nreceivers * 2 * nsteps);
+  const hid_t dataset = H5Dopen2(file, "velocity", H5P_DEFAULT);
+  ASSERT_GE(dataset, 0);
+  ASSERT_GE(H5Dread(dataset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+                    values.data()),
+            0);
+  H5Dclose(dataset);
+
+  for (int irec = 0; irec < nreceivers; irec++)
+    for (int idim = 0; idim < 2; idim++)
+      for (int isig_step = 0; isig_step < nsteps; isig_step++)
+        EXPECT_EQ(values[(irec * 2 + idim) * nsteps + isig_step],
+                  isig_step + 100 * irec + 1000 * idim);
+
+  std::vector<double> x(nreceivers);
+  const hid_t x_dataset = H5Dopen2(file, "x", H5P_DEFAULT);
+  ASSERT_GE(x_dataset, 0);
+  H5Dread(x_dataset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+          x.data());
+  H5Dclose(x_dataset);
+  for (int irec = 0; irec < nreceivers; irec++)
+    EXPECT_NEAR(x[irec], 100.0 * irec, 1e-4);
+
+  double sample_dt = 0.0;
+  const hid_t attribute = H5Aopen(file, "dt", H5P_DEFAULT);
+  ASSERT_GE(attribute, 0);
+  H5Aread(attribute, H5T_NATIVE_DOUBLE, &sample_dt);
+  H5Aclose(attribute);
+  EXPECT_NEAR(sample_dt, dt * nstep_between_samples, 1e-8);
+
+  H5Fclose(file);
+
+  std::filesystem::remove_all(folder);
+#endif
+}
+
+TEST(SEISMOGRAM_TESTS, hdf5_writer) { test_hdf5_writer(16); }
+
+TEST(SEISMOGRAM_TESTS, hdf5_streaming_writer) { test_hdf5_writer(5); }
+
+// Text and binary stations files define the same stations
+TEST(SEISMOGRAM_TESTS, read_stations) {
+
+  const auto folder = std::filesystem::temp_directory_path() /
+                      ("stations_" + std::to_string(getpid()));
+  std::filesystem::create_directories(folder);
+
+  const std::string text_file = (folder / "STATIONS").string();
+  {
+    std::ofstream stream(text_file);
+    stream << "AA S0001 2500.0 2250.0 0.0 0.0\n"
+           << "\n"
+           << "BB S0002\t100.5\t-20.25\t0.0\t0.0\n";
+  }
+
+  const std::string binary_file = (folder / "STATIONS.bin").string();
+  {
+    std::ofstream stream(binary_file, std::ios::binary);
+    const std::uint32_t version = 1;
+    const std::uint64_t nstations = 2;
+    const double x[2] = { 2500.0, 100.5 };
+    const double z[2] = { 2250.0, -20.25 };
+    stream.write("SPECFEMS", 8);
+    stream.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    stream.write(reinterpret_cast<const char *>(&nstations),
+                 sizeof(nstations));
+    stream.write(reinterpret_cast<const char *>(x), sizeof(x));
+    stream.write(reinterpret_cast<const char *>(z), sizeof(z));
+    const char names[] = "AA\0S0001\0BB\0S0002";
+    stream.write(names, sizeof(names));
+  }
+
+  for (const auto &filename : { text_file, binary_file }) {
+    const auto receivers = specfem::read_receivers(filename, 30.0);
+    ASSERT_EQ(receivers.size(), 2) << "For " << filename;
+    EXPECT_EQ(receivers.network_names[0], "AA");
+    EXPECT_EQ(receivers.station_names[0], "S0001");
+    EXPECT_EQ(receivers.network_names[1], "BB");
+    EXPECT_EQ(receivers.station_names[1], "S0002");
+    EXPECT_EQ(receivers.x[0], static_cast<type_real>(2500.0));
+    EXPECT_EQ(receivers.z[0], static_cast<type_real>(2250.0));
+    EXPECT_EQ(receivers.x[1], static_cast<type_real>(100.5));
+    EXPECT_EQ(receivers.z[1], static_cast<type_real>(-20.25));
+    EXPECT_EQ(receivers.angle, static_cast<type_real>(30.0));
+  }
+
+  // Stations defined by fewer than 6 values are rejected
+  {
+    std::ofstream stream(text_file);
+    stream << "AA S0001 2500.0 2250.0\n";
+  }
+  EXPECT_THROW(specfem::read_receivers(text_file, 0.0), std::runtime_error);
+
+  std::filesystem::remove_all(folder);
+}
+
 int main(int argc, char *argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
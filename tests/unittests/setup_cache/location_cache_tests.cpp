@@ -0,0 +1,114 @@
+#include "../../../include/compute.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/location_cache.h"
+#include "../../../include/quadrature.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <vector>
+
+// Two 4 node elements placed next to each other along x, and two stations
+struct two_element_setup {
+  specfem::kokkos::HostView2d<type_real> coorg;
+  specfem::kokkos::HostView2d<int> knods;
+  specfem::quadrature::quadrature gll;
+  std::vector<type_real> x = { 0.25, 1.5 };
+  std::vector<type_real> z = { 0.5, 0.75 };
+
+  two_element_setup()
+      : coorg("location_cache_tests::coorg", ndim, 6),
+        knods("location_cache_tests::knods", 4, 2), gll(0.0, 0.0, 5) {
+    for (int iz = 0; iz < 2; iz++) {
+      for (int ix = 0; ix < 3; ix++) {
+        coorg(0, iz * 3 + ix) = ix;
+        coorg(1, iz * 3 + ix) = iz;
+      }
+    }
+    for (int ispec = 0; ispec < 2; ispec++) {
+      knods(0, ispec) = ispec;
+      knods(1, ispec) = ispec + 1;
+      knods(2, ispec) = ispec + 4;
+      knods(3, ispec) = ispec + 3;
+    }
+  }
+};
+
+TEST(LOCATION_CACHE, ROUND_TRIP) {
+  two_element_setup setup;
+  const std::string filename = specfem::location_cache::filename(
+      "location_cache_tests", "stations", MPIEnvironment::mpi_);
+
+  specfem::compute::compute compute(setup.coorg, setup.knods, setup.gll,
+                                    setup.gll);
+  const auto key = specfem::location_cache::key(
+      compute.coordinates.coord, compute.h_ibool, setup.gll.get_hxi(),
+      setup.gll.get_hxi(), setup.x, setup.z, setup.coorg, setup.knods,
+      MPIEnvironment::mpi_);
+
+  const std::vector<specfem::location_cache::location> locations = {
+    { -0.5, 0.0, 0, 0 }, { 0.0, 0.5, 1, 0 }
+  };
+  specfem::location_cache::save(filename, key, locations);
+
+  // Moving a station changes the key
+  setup.x[1] = 1.75;
+  const auto moved = specfem::location_cache::key(
+      compute.coordinates.coord, compute.h_ibool, setup.gll.get_hxi(),
+      setup.gll.get_hxi(), setup.x, setup.z, setup.coorg, setup.knods,
+      MPIEnvironment::mpi_);
+  EXPECT_NE(moved, key);
+
+  std::vector<specfem::location_cache::location> loaded;
+  EXPECT_FALSE(specfem::location_cache::load(filename, moved, loaded));
+  EXPECT_TRUE(loaded.empty());
+
+  ASSERT_TRUE(specfem::location_cache::load(filename, key, loaded));
+  EXPECT_EQ(loaded, locations);
+
+  std::remove(filename.c_str());
+}
+
+// The first call locates the stations and stores them, the second one reads
+// the same locations from the cache
+TEST(LOCATION_CACHE, LOCATE) {
+  two_element_setup setup;
+  const std::string filename = specfem::location_cache::filename(
+      "location_cache_tests", "locate", MPIEnvironment::mpi_);
+  std::remove(filename.c_str());
+
+  specfem::compute::compute compute(setup.coorg, setup.knods, setup.gll,
+                                    setup.gll);
+
+  const auto [located, located_cached] = specfem::location_cache::locate(
+      filename, compute.coordinates.coord, compute.h_ibool,
+      setup.gll.get_hxi(), setup.gll.get_hxi(), setup.x, setup.z, setup.coorg,
+      setup.knods, MPIEnvironment::mpi_);
+  EXPECT_FALSE(located_cached);
+  ASSERT_EQ(located.size(), 2);
+  EXPECT_EQ(std::get<2>(located[0]), 0);
+  EXPECT_EQ(std::get<2>(located[1]), 1);
+
+  const auto [loaded, loaded_cached] = specfem::location_cache::locate(
+      filename, compute.coordinates.coord, compute.h_ibool,
+      setup.gll.get_hxi(), setup.gll.get_hxi(), setup.x, setup.z, setup.coorg,
+      setup.knods, MPIEnvironment::mpi_);
+  EXPECT_TRUE(loaded_cached);
+  EXPECT_EQ(loaded, located);
+
+  std::remove(filename.c_str());
+}
+
+TEST(LOCATION_CACHE, MISSING_FILE) {
+  std::vector<specfem::location_cache::location> locations;
+  EXPECT_FALSE(specfem::location_cache::load(
+      "location_cache_tests/missing.bin", 0, locations));
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+#include "../../../include/compute.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/material.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/setup_cache.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <vector>
+
+// Two 4 node elements placed next to each other along x, and one elastic
+// material
+struct two_element_setup {
+  specfem::kokkos::HostView2d<type_real> coorg;
+  specfem::kokkos::HostView2d<int> knods;
+  specfem::kokkos::HostView1d<int> kmato;
+  std::vector<specfem::material *> materials;
+  specfem::quadrature::quadrature gll;
+
+  two_element_setup()
+      : coorg("setup_cache_tests::coorg", ndim, 6),
+        knods("setup_cache_tests::knods", 4, 2),
+        kmato("setup_cache_tests::kmato", 2), gll(0.0, 0.0, 5) {
+    for (int iz = 0; iz < 2; iz++) {
+      for (int ix = 0; ix < 3; ix++) {
+        coorg(0, iz * 3 + ix) = ix;
+        coorg(1, iz * 3 + ix) = iz;
+      }
+    }
+    for (int ispec = 0; ispec < 2; ispec++) {
+      knods(0, ispec) = ispec;
+      knods(1, ispec) = ispec + 1;
+      knods(2, ispec) = ispec + 4;
+      knods(3, ispec) = ispec + 3;
+      kmato(ispec) = 0;
+    }
+
+    specfem::utilities::input_holder holder;
+    holder.val0 = 2700.0;
+    holder.val1 = 3000.0;
+    holder.val2 = 1732.0;
+    holder.val3 = 0.0;
+    holder.val5 = 9999.0;
+    holder.val6 = 9999.0;
+    materials.push_back(new specfem::elastic_material());
+    materials[0]->assign(holder);
+  }
+
+  ~two_element_setup() {
+    for (auto &material : materials)
+      delete material;
+  }
+};
+
+TEST(SETUP_CACHE, ROUND_TRIP) {
+  two_element_setup setup;
+  const std::string filename = specfem::setup_cache::filename(
+      "setup_cache_tests", MPIEnvironment::mpi_);
+
+  specfem::compute::compute compute(setup.coorg, setup.knods, setup.gll,
+                                    setup.gll);
+  specfem::compute::partial_derivatives partial_derivatives(
+      setup.coorg, setup.knods, setup.gll, setup.gll);
+  specfem::compute::properties properties(setup.kmato, setup.materials, 2,
+                                          setup.gll.get_N(),
+                                          setup.gll.get_N());
+
+  const auto key =
+      specfem::setup_cache::key(setup.coorg, setup.knods, setup.kmato,
+                                setup.materials, setup.gll, setup.gll);
+  specfem::setup_cache::save(filename, key, compute, partial_derivatives,
+                             properties);
+
+  specfem::compute::compute l_compute;
+  specfem::compute::partial_derivatives l_partial_derivatives;
+  specfem::compute::properties l_properties;
+
+  // Moving a control node changes the key
+  setup.coorg(0, 5) = 2.5;
+  const auto moved =
+      specfem::setup_cache::key(setup.coorg, setup.knods, setup.kmato,
+                                setup.materials, setup.gll, setup.gll);
+  EXPECT_NE(moved, key);
+  EXPECT_FALSE(specfem::setup_cache::load(
+      filename, moved, l_compute, l_partial_derivatives, l_properties));
+
+  ASSERT_TRUE(specfem::setup_cache::load(filename, key, l_compute,
+                                         l_partial_derivatives, l_properties));
+
+  ASSERT_EQ(l_compute.coordinates.coord.extent(1),
+            compute.coordinates.coord.extent(1));
+  EXPECT_EQ(l_compute.coordinates.xmax, compute.coordinates.xmax);
+  EXPECT_EQ(l_compute.coordinates.zmin, compute.coordinates.zmin);
+  const int nglob = compute.coordinates.coord.extent(1);
+  for (int iglob = 0; iglob < nglob; iglob++) {
+    EXPECT_EQ(l_compute.coordinates.coord(0, iglob),
+              compute.coordinates.coord(0, iglob));
+    EXPECT_EQ(l_compute.coordinates.coord(1, iglob),
+              compute.coordinates.coord(1, iglob));
+  }
+
+  for (int ispec = 0; ispec < 2; ispec++) {
+    EXPECT_EQ(l_properties.h_ispec_type(ispec), properties.h_ispec_type(ispec));
+    for (int iz = 0; iz < setup.gll.get_N(); iz++) {
+      for (int ix = 0; ix < setup.gll.get_N(); ix++) {
+        EXPECT_EQ(l_compute.h_ibool(ispec, iz, ix),
+                  compute.h_ibool(ispec, iz, ix));
+        EXPECT_EQ(l_partial_derivatives.h_jacobian(ispec, iz, ix),
+                  partial_derivatives.h_jacobian(ispec, iz, ix));
+        EXPECT_EQ(l_partial_derivatives.h_xix(ispec, iz, ix),
+                  partial_derivatives.h_xix(ispec, iz, ix));
+        EXPECT_EQ(l_properties.h_lambdaplus2mu(ispec, iz, ix),
+                  properties.h_lambdaplus2mu(ispec, iz, ix));
+        EXPECT_EQ(l_properties.rho_vs(ispec, iz, ix),
+                  properties.rho_vs(ispec, iz, ix));
+      }
+    }
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST(SETUP_CACHE, MISSING_FILE) {
+  two_element_setup setup;
+  specfem::compute::compute compute;
+  specfem::compute::partial_derivatives partial_derivatives;
+  specfem::compute::properties properties;
+
+  EXPECT_FALSE(specfem::setup_cache::load("setup_cache_tests/missing.bin", 0,
+                                          compute, partial_derivatives,
+                                          properties));
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,205 @@
+#include "../../../include/compute.h"
+#include "../../../include/ensemble.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/receiver.h"
+#include "../../../include/simulation.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include "../utilities/include/compare_array.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Example mesh and source of the Newmark displacement tests
+const std::string parameter_file = "../../../tests/unittests/simulation/"
+                                   "serial/specfem_config.yaml";
+const std::string sources_file = "../../../tests/unittests/"
+                                 "displacement_tests/Newmark/serial/"
+                                 "sources.yaml";
+const std::string shifted_sources_file = "../../../tests/unittests/"
+                                         "simulation/serial/"
+                                         "sources_shifted.yaml";
+
+// Seismograms recorded by receivers, (nsamples * ntypes * nreceivers, ndim)
+specfem::kokkos::HostView2d<type_real>
+seismograms(specfem::compute::receivers &receivers) {
+  receivers.sync_seismograms();
+  const auto seismogram = receivers.h_seismogram;
+  const int nvalues =
+      seismogram.extent(0) * seismogram.extent(1) * seismogram.extent(2);
+  specfem::kokkos::HostView2d<type_real> values("seismograms", nvalues,
+                                                seismogram.extent(3));
+  int ivalue = 0;
+  for (int isample = 0; isample < seismogram.extent(0); isample++) {
+    for (int itype = 0; itype < seismogram.extent(1); itype++) {
+      for (int irec = 0; irec < seismogram.extent(2); irec++) {
+        for (int idim = 0; idim < seismogram.extent(3); idim++)
+          values(ivalue, idim) = seismogram(isample, itype, irec, idim);
+        ivalue++;
+      }
+    }
+  }
+  return values;
+}
+
+// Seismograms of the last run
+specfem::kokkos::HostView2d<type_real>
+seismograms(specfem::simulation::simulation &simulation) {
+  return seismograms(simulation.get_receivers());
+}
+
+bool identical(const specfem::kokkos::HostView2d<type_real> lhs,
+               const specfem::kokkos::HostView2d<type_real> rhs) {
+  if (lhs.extent(0) != rhs.extent(0) || lhs.extent(1) != rhs.extent(1))
+    return false;
+  for (int i = 0; i < lhs.extent(0); i++) {
+    for (int j = 0; j < lhs.extent(1); j++) {
+      if (lhs(i, j) != rhs(i, j))
+        return false;
+    }
+  }
+  return true;
+}
+
+TEST(SIMULATION_TESTS, REPEATED_RUNS) {
+  specfem::simulation::simulation simulation(parameter_file,
+                                             MPIEnvironment::mpi_);
+  simulation.run();
+  const auto first = seismograms(simulation);
+  simulation.run();
+  const auto second = seismograms(simulation);
+
+  // Fields are at rest before every run
+  EXPECT_TRUE(identical(first, second));
+  EXPECT_EQ(simulation.get_nruns(), 2);
+}
+
+TEST(SIMULATION_TESTS, NEW_SOURCES) {
+  specfem::simulation::simulation simulation(parameter_file,
+                                             MPIEnvironment::mpi_);
+  simulation.run();
+  const auto original = seismograms(simulation);
+
+  simulation.set_sources(std::vector<std::string>{ shifted_sources_file });
+  simulation.run();
+  const auto shifted = seismograms(simulation);
+  EXPECT_FALSE(identical(original, shifted));
+
+  // Going back to the original sources reproduces the first run
+  simulation.set_sources(std::vector<std::string>{ sources_file });
+  simulation.run();
+  EXPECT_NO_THROW(specfem::testing::compare_norm(seismograms(simulation),
+                                                 original, 1e-6));
+
+  // A simulation whose first run steps the shifted sources
+  specfem::simulation::simulation fresh(parameter_file, MPIEnvironment::mpi_);
+  fresh.set_sources(std::vector<std::string>{ shifted_sources_file });
+  fresh.run();
+  EXPECT_NO_THROW(
+      specfem::testing::compare_norm(seismograms(fresh), shifted, 1e-6));
+
+  // The number of shots is fixed by the parameter file
+  EXPECT_THROW(simulation.set_sources(std::vector<std::string>{
+                   sources_file, shifted_sources_file }),
+               std::runtime_error);
+}
+
+TEST(SIMULATION_TESTS, NEW_RECEIVERS) {
+  if (MPIEnvironment::mpi_->get_size() > 1)
+    GTEST_SKIP() << "Receivers are ordered for a single process";
+
+  specfem::simulation::simulation simulation(parameter_file,
+                                             MPIEnvironment::mpi_);
+  simulation.run();
+  const auto original = seismograms(simulation);
+  const int noriginal = simulation.get_receivers().h_seismogram.extent(2);
+
+  // The first station is the first station of the stations file
+  specfem::receivers::receiver_set stations;
+  stations.add("AA", "S0", 2200.0, 3000.0);
+  stations.add("AA", "S1", 2500.0, 2750.0);
+  simulation.set_receivers(stations);
+  simulation.run();
+  const auto recorded = seismograms(simulation);
+
+  const auto &seismogram = simulation.get_receivers().h_seismogram;
+  ASSERT_EQ(seismogram.extent(2), 2);
+  const int nrows = seismogram.extent(0) * seismogram.extent(1);
+  for (int irow = 0; irow < nrows; irow++) {
+    for (int idim = 0; idim < seismogram.extent(3); idim++)
+      EXPECT_FLOAT_EQ(recorded(irow * 2, idim),
+                      original(irow * noriginal, idim));
+  }
+}
+
+TEST(SIMULATION_TESTS, NEW_MATERIALS) {
+  specfem::simulation::simulation simulation(parameter_file,
+                                             MPIEnvironment::mpi_);
+  simulation.run();
+  const auto original = seismograms(simulation);
+
+  std::vector<specfem::utilities::return_holder> materials;
+  for (auto &material : simulation.get_materials())
+    materials.push_back(material->get_properties());
+
+  // Slower shear waves are stable at the time step of the parameter file
+  const type_real vs = 0.9 * std::sqrt(materials[0].mu / materials[0].rho);
+  simulation.set_materials(
+      specfem::ensemble::assign_materials(materials, { { 1, "vs", vs } }));
+  simulation.run();
+  EXPECT_FALSE(identical(seismograms(simulation), original));
+
+  // Going back to the original materials reproduces the first run
+  simulation.set_materials(specfem::ensemble::assign_materials(materials, {}));
+  simulation.run();
+  EXPECT_NO_THROW(specfem::testing::compare_norm(seismograms(simulation),
+                                                 original, 1e-6));
+
+  // Faster waves are unstable
+  const type_real vp =
+      10.0 * std::sqrt(materials[0].lambdaplus2mu / materials[0].rho);
+  EXPECT_THROW(simulation.set_materials(specfem::ensemble::assign_materials(
+                   materials, { { 1, "vp", vp } })),
+               std::runtime_error);
+}
+
+TEST(SIMULATION_TESTS, CONCURRENT_RUNS) {
+  if (MPIEnvironment::mpi_->get_size() > 1)
+    GTEST_SKIP() << "Domains with MPI interfaces can't be shared";
+
+  specfem::simulation::simulation simulation(parameter_file,
+                                             MPIEnvironment::mpi_);
+  simulation.run();
+  const auto original = seismograms(simulation);
+  simulation.set_sources(std::vector<std::string>{ shifted_sources_file });
+  simulation.run();
+  const auto shifted = seismograms(simulation);
+
+  // Concurrent runs record the seismograms of runs one after the other
+  const std::vector<std::vector<std::string> > sources_files = {
+    { sources_file }, { shifted_sources_file }, { sources_file }
+  };
+  simulation.run_concurrent(sources_files);
+  ASSERT_EQ(simulation.get_nconcurrent(), 3);
+  EXPECT_NO_THROW(specfem::testing::compare_norm(
+      seismograms(simulation.get_receivers(0)), original, 1e-6));
+  EXPECT_NO_THROW(specfem::testing::compare_norm(
+      seismograms(simulation.get_receivers(1)), shifted, 1e-6));
+  EXPECT_NO_THROW(specfem::testing::compare_norm(
+      seismograms(simulation.get_receivers(2)), original, 1e-6));
+
+  // Domains of the previous concurrent run are reset
+  simulation.run_concurrent(sources_files);
+  EXPECT_NO_THROW(specfem::testing::compare_norm(
+      seismograms(simulation.get_receivers(1)), shifted, 1e-6));
+  EXPECT_EQ(simulation.get_nruns(), 8);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -5,12 +5,19 @@
 #include "../../../include/params.h"
 #include "../../../include/read_mesh_database.h"
 #include "../../../include/read_sources.h"
+#include "../../../include/receiver.h"
 #include "../../../include/source.h"
+#include "../../../include/utils.h"
 #include "../Kokkos_Environment.hpp"
 #include "../MPI_environment.hpp"
 #include "yaml-cpp/yaml.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <vector>
 
 // ---- Read ground truth ---------
@@ -212,6 +219,425 @@ TEST(SOURCE_LOCATION_TESTS, compute_source_locations) {
     FAIL() << "Solution doesn't exist for current nnodes = " << mpi->get_size();
 }
 
+/**
+ *
+ * Check that batched locations match locations computed for every source
+ *
+ */
+TEST(SOURCE_LOCATION_TESTS, batched_source_locations) {
+  std::string config_filename =
+      "../../../tests/unittests/source/test_config.yml";
+
+  //  alias the mpi environment pointer
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+
+  test_config test_config = parse_test_config(config_filename);
+
+  // Set up GLL quadrature points
+  specfem::quadrature::quadrature gllx(0.0, 0.0, 5);
+  specfem::quadrature::quadrature gllz(0.0, 0.0, 5);
+
+  // Read mesh for binary database for the test
+  std::vector<specfem::material *> materials;
+  specfem::mesh mesh(test_config.database_file, materials, mpi);
+
+  auto [sources, t0] =
+      specfem::read_sources(test_config.sources_file, 1.0, mpi);
+  auto [batched_sources, batched_t0] =
+      specfem::read_sources(test_config.sources_file, 1.0, mpi);
+
+  specfem::compute::compute compute(mesh.coorg, mesh.material_ind.knods, gllx,
+                                    gllz);
+  specfem::compute::properties material_properties(mesh.material_ind.kmato,
+                                                   materials, mesh.nspec,
+                                                   gllx.get_N(), gllz.get_N());
+
+  for (auto &source : sources)
+    source->locate(compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
+                   gllz.get_hxi(), mesh.nproc, mesh.coorg,
+                   mesh.material_ind.knods, mesh.npgeo,
+                   material_properties.h_ispec_type, mpi);
+
+  specfem::sources::locate(batched_sources, compute.coordinates.coord,
+                           compute.h_ibool, gllx.get_hxi(), gllz.get_hxi(),
+                           mesh.coorg, mesh.material_ind.knods,
+                           material_properties.h_ispec_type, mpi);
+
+  ASSERT_EQ(batched_sources.size(), sources.size());
+  for (int i = 0; i < sources.size(); i++) {
+    EXPECT_EQ(batched_sources[i]->get_ispec(), sources[i]->get_ispec())
+        << "For source " << i;
+    EXPECT_EQ(batched_sources[i]->get_islice(), sources[i]->get_islice())
+        << "For source " << i;
+    EXPECT_EQ(batched_sources[i]->get_xi(), sources[i]->get_xi())
+        << "For source " << i;
+    EXPECT_EQ(batched_sources[i]->get_gamma(), sources[i]->get_gamma())
+        << "For source " << i;
+  }
+}
+
+/**
+ *
+ * Check that batched Newton iterations invert the mapping of quadrature points
+ *
+ */
+TEST(SOURCE_LOCATION_TESTS, best_locations) {
+  std::string config_filename =
+      "../../../tests/unittests/source/test_config.yml";
+
+  //  alias the mpi environment pointer
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+
+  test_config test_config = parse_test_config(config_filename);
+
+  // Set up GLL quadrature points
+  specfem::quadrature::quadrature gllx(0.0, 0.0, 5);
+  specfem::quadrature::quadrature gllz(0.0, 0.0, 5);
+
+  // Read mesh for binary database for the test
+  std::vector<specfem::material *> materials;
+  specfem::mesh mesh(test_config.database_file, materials, mpi);
+
+  specfem::compute::compute compute(mesh.coorg, mesh.material_ind.knods, gllx,
+                                    gllz);
+
+  // Quadrature point (iz, ix) = (1, 3) of every element, starting from the
+  // center of the element
+  const int nspec = compute.h_ibool.extent(0);
+  const auto xigll = gllx.get_hxi();
+  const auto zigll = gllz.get_hxi();
+  specfem::kokkos::HostView1d<type_real> x("x", nspec), z("z", nspec);
+  specfem::kokkos::HostView1d<int> ispec("ispec", nspec);
+  specfem::kokkos::HostView1d<type_real> xi("xi", nspec), gamma("gamma", nspec);
+  specfem::kokkos::HostView1d<type_real> residual("residual", nspec);
+  type_real scale = 0.0;
+  for (int i = 0; i < nspec; i++) {
+    const int iglob = compute.h_ibool(i, 1, 3);
+    x(i) = compute.coordinates.coord(0, iglob);
+    z(i) = compute.coordinates.coord(1, iglob);
+    ispec(i) = i;
+    scale = std::max(scale, std::max(std::fabs(x(i)), std::fabs(z(i))));
+  }
+
+  specfem::utilities::best_locations(x, z, ispec, mesh.coorg,
+                                     mesh.material_ind.knods, xi, gamma,
+                                     residual);
+
+  for (int i = 0; i < nspec; i++) {
+    EXPECT_NEAR(xi(i), xigll(3), 1e-3) << "For element " << i;
+    EXPECT_NEAR(gamma(i), zigll(1), 1e-3) << "For element " << i;
+    EXPECT_NEAR(residual(i), 0.0, 1e-5 * scale) << "For element " << i;
+  }
+}
+
+/**
+ *
+ * Check that every source file defines a shot sharing the time axis of the
+ * simulation
+ *
+ */
+TEST(SOURCE_LOCATION_TESTS, shots) {
+  std::string config_filename =
+      "../../../tests/unittests/source/test_config.yml";
+
+  //  alias the mpi environment pointer
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+
+  test_config test_config = parse_test_config(config_filename);
+
+  auto [sources, t0] =
+      specfem::read_sources(test_config.sources_file, 1.0, mpi);
+  auto [shot_sources, shots, shot_t0] = specfem::read_sources(
+      std::vector<std::string>{ test_config.sources_file,
+                                test_config.sources_file },
+      1.0, mpi);
+
+  const int nsources = sources.size();
+  ASSERT_EQ(shot_sources.size(), 2 * nsources);
+  ASSERT_EQ(shots.size(), 2 * nsources);
+  EXPECT_EQ(shot_t0, t0);
+  for (int i = 0; i < 2 * nsources; i++) {
+    EXPECT_EQ(shots[i], i / nsources) << "For source " << i;
+    EXPECT_EQ(shot_sources[i]->get_t0(), sources[i % nsources]->get_t0())
+        << "For source " << i;
+  }
+
+  for (auto &source : sources)
+    delete source;
+  for (auto &source : shot_sources)
+    delete source;
+}
+
+// Reciprocal simulations apply a force along every component of every station
+TEST(SOURCE_LOCATION_TESTS, reciprocal_sources) {
+
+  const type_real dt = 1e-3;
+  specfem::receivers::receiver_set receivers;
+  receivers.add("AA", "S0001", 100.0, 200.0);
+  receivers.add("AA", "S0002", 300.0, 400.0);
+
+  for (const auto [wave, ncomponents] :
+       { std::make_tuple(specfem::wave::p_sv, 2),
+         std::make_tuple(specfem::wave::sh, 1) }) {
+    auto [forces, shots, t0] =
+        specfem::reciprocal_sources(receivers, wave, dt);
+
+    ASSERT_EQ(forces.size(), ncomponents * receivers.size());
+    ASSERT_EQ(shots.size(), forces.size());
+    // The Dirac source time function starts 1.2 periods before its peak
+    EXPECT_NEAR(t0, 12.0 * dt, 1e-6);
+    for (int i = 0; i < forces.size(); i++) {
+      EXPECT_EQ(shots[i], i);
+      EXPECT_EQ(forces[i]->get_x(), receivers.x[i / ncomponents]);
+      EXPECT_EQ(forces[i]->get_z(), receivers.z[i / ncomponents]);
+    }
+
+    for (auto &force : forces)
+      delete force;
+  }
+}
+
+// ---- Spatial index -------------
+
+// Closest quadrature point to (x, z), scanning every quadrature point in
+// element order. Returns (ix, iz, ispec) of the first closest point
+std::tuple<int, int, int>
+brute_force_location(const specfem::kokkos::HostView2d<type_real> coord,
+                     const specfem::kokkos::HostElementMirror3d<int> ibool,
+                     const type_real x, const type_real z) {
+  const int nspec = ibool.extent(0);
+  const int ngllz = ibool.extent(1);
+  const int ngllx = ibool.extent(2);
+
+  type_real dist_min = std::numeric_limits<type_real>::max();
+  std::tuple<int, int, int> location;
+  for (int ispec = 0; ispec < nspec; ispec++) {
+    for (int j = 0; j < ngllz; j++) {
+      for (int i = 0; i < ngllx; i++) {
+        const int iglob = ibool(ispec, j, i);
+        const type_real dist_squared =
+            (x - coord(0, iglob)) * (x - coord(0, iglob)) +
+            (z - coord(1, iglob)) * (z - coord(1, iglob));
+        if (dist_squared < dist_min) {
+          dist_min = dist_squared;
+          location = std::make_tuple(i, j, ispec);
+        }
+      }
+    }
+  }
+  return location;
+}
+
+// Elements sharing a corner with ispec, in increasing order
+std::vector<int>
+brute_force_neighbors(const specfem::kokkos::HostElementMirror3d<int> ibool,
+                      const int ispec) {
+  const int nspec = ibool.extent(0);
+  const int ngllz = ibool.extent(1);
+  const int ngllx = ibool.extent(2);
+
+  std::vector<int> neighbors;
+  for (int jspec = 0; jspec < nspec; jspec++) {
+    if (jspec == ispec)
+      continue;
+    bool shared = false;
+    for (int j : { 0, ngllz - 1 })
+      for (int i : { 0, ngllx - 1 })
+        for (int l : { 0, ngllz - 1 })
+          for (int k : { 0, ngllx - 1 })
+            shared |= (ibool(ispec, j, i) == ibool(jspec, l, k));
+    if (shared)
+      neighbors.push_back(jspec);
+  }
+  return neighbors;
+}
+
+// Structured nx * nz grid of elements with ngllx * ngllz points. Elements are
+// numbered in a random order, and points are placed on a grid of spacing
+// (dx, dz)
+std::tuple<specfem::kokkos::HostView2d<type_real>,
+           specfem::kokkos::HostElementMirror3d<int> >
+structured_mesh(const int nx, const int nz, const int ngllx, const int ngllz,
+                const type_real dx, const type_real dz,
+                std::mt19937 &generator) {
+  const int npoints_x = nx * (ngllx - 1) + 1;
+  const int npoints_z = nz * (ngllz - 1) + 1;
+
+  std::vector<int> order(nx * nz);
+  for (int ispec = 0; ispec < nx * nz; ispec++)
+    order[ispec] = ispec;
+  std::shuffle(order.begin(), order.end(), generator);
+
+  specfem::kokkos::HostElementMirror3d<int> ibool(
+      "source_location_tests::ibool", nx * nz, ngllz, ngllx);
+  for (int jz = 0; jz < nz; jz++) {
+    for (int jx = 0; jx < nx; jx++) {
+      const int ispec = order[jz * nx + jx];
+      for (int iz = 0; iz < ngllz; iz++) {
+        for (int ix = 0; ix < ngllx; ix++) {
+          ibool(ispec, iz, ix) = (jz * (ngllz - 1) + iz) * npoints_x +
+                                 (jx * (ngllx - 1) + ix);
+        }
+      }
+    }
+  }
+
+  specfem::kokkos::HostView2d<type_real> coord(
+      "source_location_tests::coord", 2, npoints_x * npoints_z);
+  for (int iz = 0; iz < npoints_z; iz++) {
+    for (int ix = 0; ix < npoints_x; ix++) {
+      coord(0, iz * npoints_x + ix) = ix * dx;
+      coord(1, iz * npoints_x + ix) = iz * dz;
+    }
+  }
+
+  return std::make_tuple(coord, ibool);
+}
+
+// Compare the index against a brute force scan at every query point.
+// Coordinates are multiples of 1/4 such that distances are exact and ties
+// are resolved by element order only
+void check_index(const specfem::kokkos::HostView2d<type_real> coord,
+                 const specfem::kokkos::HostElementMirror3d<int> ibool,
+                 const std::vector<type_real> &x,
+                 const std::vector<type_real> &z) {
+  const specfem::utilities::spatial_index index(coord, ibool);
+
+  for (int i = 0; i < x.size(); i++) {
+    const auto [ix, iz, ispec] = index.rough_location(x[i], z[i]);
+    const auto [ix_ref, iz_ref, ispec_ref] =
+        brute_force_location(coord, ibool, x[i], z[i]);
+    EXPECT_EQ(ispec, ispec_ref) << "For point (" << x[i] << ", " << z[i] << ")";
+    EXPECT_EQ(iz, iz_ref) << "For point (" << x[i] << ", " << z[i] << ")";
+    EXPECT_EQ(ix, ix_ref) << "For point (" << x[i] << ", " << z[i] << ")";
+  }
+
+  for (int ispec = 0; ispec < ibool.extent(0); ispec++) {
+    std::vector<int> candidates = { ispec };
+    const auto neighbors = brute_force_neighbors(ibool, ispec);
+    candidates.insert(candidates.end(), neighbors.begin(), neighbors.end());
+    EXPECT_EQ(index.best_candidates(ispec), candidates)
+        << "For element " << ispec;
+  }
+}
+
+// Random query points on a grid of spacing 1/4 covering [x0, x1] * [z0, z1]
+void random_points(const type_real x0, const type_real x1, const type_real z0,
+                   const type_real z1, const int npoints,
+                   std::mt19937 &generator, std::vector<type_real> &x,
+                   std::vector<type_real> &z) {
+  std::uniform_int_distribution<int> ix(0, std::lround(4 * (x1 - x0)));
+  std::uniform_int_distribution<int> iz(0, std::lround(4 * (z1 - z0)));
+  for (int i = 0; i < npoints; i++) {
+    x.push_back(x0 + ix(generator) / static_cast<type_real>(4));
+    z.push_back(z0 + iz(generator) / static_cast<type_real>(4));
+  }
+}
+
+/**
+ *
+ * Check that the spatial index finds the closest quadrature point of a brute
+ * force scan on meshes with random points. Points are drawn on a coarse grid,
+ * hence many global points share coordinates and many queries are
+ * equidistant from several points
+ *
+ */
+TEST(SOURCE_LOCATION_TESTS, spatial_index_random) {
+  std::mt19937 generator(42);
+
+  for (const auto &[nspec, ngllx, ngllz, nglob] :
+       { std::make_tuple(1, 2, 2, 4), std::make_tuple(20, 5, 5, 200),
+         std::make_tuple(50, 3, 3, 60), std::make_tuple(20, 5, 3, 120),
+         std::make_tuple(20, 3, 6, 120) }) {
+    std::uniform_int_distribution<int> iglob(0, nglob - 1);
+    std::uniform_int_distribution<int> ix(0, 40), iz(0, 12);
+
+    specfem::kokkos::HostElementMirror3d<int> ibool(
+        "source_location_tests::ibool", nspec, ngllz, ngllx);
+    for (int ispec = 0; ispec < nspec; ispec++)
+      for (int j = 0; j < ngllz; j++)
+        for (int i = 0; i < ngllx; i++)
+          ibool(ispec, j, i) = iglob(generator);
+
+    specfem::kokkos::HostView2d<type_real> coord(
+        "source_location_tests::coord", 2, nglob);
+    for (int i = 0; i < nglob; i++) {
+      coord(0, i) = ix(generator) / static_cast<type_real>(2);
+      coord(1, i) = iz(generator) / static_cast<type_real>(2);
+    }
+
+    // Queries inside and outside the mesh, and at every global point
+    std::vector<type_real> x, z;
+    random_points(-5.0, 25.0, -5.0, 11.0, 1000, generator, x, z);
+    for (int i = 0; i < nglob; i++) {
+      x.push_back(coord(0, i));
+      z.push_back(coord(1, i));
+    }
+
+    check_index(coord, ibool, x, z);
+  }
+}
+
+/**
+ *
+ * Check that ties between elements sharing points, and between equidistant
+ * points, are broken by element order as in a brute force scan
+ *
+ */
+TEST(SOURCE_LOCATION_TESTS, spatial_index_ties) {
+  std::mt19937 generator(7);
+
+  // Square and non square elements
+  const int nx = 6, nz = 4;
+  for (const auto &[ngllx, ngllz] :
+       { std::make_tuple(5, 5), std::make_tuple(5, 3),
+         std::make_tuple(3, 5) }) {
+    auto [coord, ibool] =
+        structured_mesh(nx, nz, ngllx, ngllz, 1.0, 2.0, generator);
+
+    // Every global point, shared by up to 4 elements, and the midpoints of
+    // every pair of neighboring points, equidistant from 2 or 4 points
+    const int npoints_x = nx * (ngllx - 1) + 1;
+    const int npoints_z = nz * (ngllz - 1) + 1;
+    std::vector<type_real> x, z;
+    for (int iz = 0; iz < 2 * npoints_z - 1; iz++) {
+      for (int ix = 0; ix < 2 * npoints_x - 1; ix++) {
+        x.push_back(ix * static_cast<type_real>(0.5));
+        z.push_back(iz * static_cast<type_real>(1.0));
+      }
+    }
+    random_points(-3.0, 27.0, -3.0, 35.0, 500, generator, x, z);
+
+    check_index(coord, ibool, x, z);
+  }
+}
+
+/**
+ *
+ * Check meshes of zero height, zero width, or reduced to a single point
+ *
+ */
+TEST(SOURCE_LOCATION_TESTS, spatial_index_degenerate) {
+  std::mt19937 generator(3);
+
+  const int nx = 5, nz = 3, ngllx = 4, ngllz = 3;
+  for (const auto &[dx, dz] : { std::make_tuple(1.0, 0.0),
+                                std::make_tuple(0.0, 1.0),
+                                std::make_tuple(0.0, 0.0) }) {
+    auto [coord, ibool] =
+        structured_mesh(nx, nz, ngllx, ngllz, dx, dz, generator);
+
+    std::vector<type_real> x, z;
+    random_points(-2.0, 17.0, -2.0, 11.0, 500, generator, x, z);
+    for (int i = 0; i < coord.extent(1); i++) {
+      x.push_back(coord(0, i));
+      z.push_back(coord(1, i));
+    }
+
+    check_index(coord, ibool, x, z);
+  }
+}
+
 int main(int argc, char *argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
   ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
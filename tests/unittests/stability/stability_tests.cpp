@@ -0,0 +1,111 @@
+#include "../../../include/domain.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/timescheme.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// Domain storing fields and a unit mass matrix
+class field_domain : public specfem::Domain::Domain {
+public:
+  field_domain(const int nglob)
+      : field("field", nglob, ndim), field_dot("field_dot", nglob, ndim),
+        field_dot_dot("field_dot_dot", nglob, ndim),
+        rmass_inverse("rmass_inverse", nglob) {
+    Kokkos::deep_copy(this->rmass_inverse, 1.0);
+  }
+  specfem::kokkos::DeviceFieldView2d<type_real> get_field() const override {
+    return this->field;
+  }
+  specfem::kokkos::DeviceFieldView2d<type_real>
+  get_field_dot() const override {
+    return this->field_dot;
+  }
+  specfem::kokkos::DeviceFieldView2d<type_real>
+  get_field_dot_dot() const override {
+    return this->field_dot_dot;
+  }
+  specfem::kokkos::DeviceView1d<type_real> get_rmass_inverse() const override {
+    return this->rmass_inverse;
+  }
+
+  // Set a component of the displacement of a global point
+  void set_field(const int iglob, const type_real value) {
+    auto h_field = Kokkos::create_mirror_view(this->field);
+    Kokkos::deep_copy(h_field, this->field);
+    h_field(iglob, 0) = value;
+    Kokkos::deep_copy(this->field, h_field);
+  }
+
+  specfem::kokkos::DeviceFieldView2d<type_real> field, field_dot,
+      field_dot_dot;
+  specfem::kokkos::DeviceView1d<type_real> rmass_inverse;
+};
+
+TEST(STABILITY_TESTS, STABLE_FIELDS) {
+  field_domain domain(10);
+  domain.set_field(3, 1.0);
+  specfem::TimeScheme::Newmark newmark(10, 0.0, 0.1, 1);
+  newmark.set_stability_check(1, 1e25);
+  EXPECT_NO_THROW(newmark.apply_fused_corrector_phase(&domain, true));
+}
+
+TEST(STABILITY_TESTS, NON_FINITE_FIELDS) {
+  field_domain domain(10);
+  domain.set_field(7, std::numeric_limits<type_real>::quiet_NaN());
+  specfem::TimeScheme::Newmark newmark(10, 0.0, 0.1, 1);
+  newmark.set_stability_check(1, 1e25);
+  try {
+    newmark.apply_fused_corrector_phase(&domain, false);
+    FAIL() << "Non-finite fields weren't detected";
+  } catch (const std::runtime_error &error) {
+    const std::string message = error.what();
+    EXPECT_NE(message.find("not finite"), std::string::npos);
+    EXPECT_NE(message.find("global point 7"), std::string::npos);
+  }
+}
+
+TEST(STABILITY_TESTS, THRESHOLD) {
+  field_domain domain(10);
+  domain.set_field(2, 1e6);
+  specfem::TimeScheme::Newmark newmark(10, 0.0, 0.1, 1);
+  newmark.set_stability_check(1, 1e3);
+  try {
+    newmark.apply_fused_corrector_phase(&domain, true);
+    FAIL() << "Fields exceeding the threshold weren't detected";
+  } catch (const std::runtime_error &error) {
+    const std::string message = error.what();
+    EXPECT_NE(message.find("exceeds the stability threshold"),
+              std::string::npos);
+    EXPECT_NE(message.find("global point 2"), std::string::npos);
+  }
+}
+
+TEST(STABILITY_TESTS, UNCHECKED_STEPS) {
+  field_domain domain(10);
+  domain.set_field(5, std::numeric_limits<type_real>::infinity());
+  specfem::TimeScheme::Newmark newmark(10, 0.0, 0.1, 1);
+
+  // Steps between checks and disabled checks don't reduce the fields
+  newmark.set_stability_check(2, 1e25);
+  newmark.increment_time();
+  EXPECT_NO_THROW(newmark.apply_fused_corrector_phase(&domain, false));
+  newmark.set_stability_check(0, 1e25);
+  newmark.increment_time();
+  EXPECT_NO_THROW(newmark.apply_fused_corrector_phase(&domain, false));
+
+  newmark.set_stability_check(2, 1e25);
+  EXPECT_THROW(newmark.apply_fused_corrector_phase(&domain, false),
+               std::runtime_error);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,100 @@
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/memory_report.h"
+#include "../../../include/startup_profiler.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+TEST(STARTUP_TESTS, ACCUMULATED_STAGES) {
+  specfem::memory::track_allocations();
+  specfem::startup::profiler startup;
+
+  // Stages with the same name are accumulated
+  for (int i = 0; i < 2; i++) {
+    startup.start("Global numbering");
+    specfem::kokkos::DeviceView1d<type_real> view(
+        "specfem::tests::startup::view", 1000);
+    startup.stop();
+  }
+  startup.start("Domains");
+  startup.stop();
+
+  ASSERT_EQ(startup.get_nstages(), 2);
+  EXPECT_GE(startup.get_seconds(0), 0.0);
+  const auto allocated = startup.get_allocated(0);
+  EXPECT_EQ(allocated.device + allocated.host, 2 * 1000 * sizeof(type_real));
+  EXPECT_EQ(startup.get_allocated(1).device + startup.get_allocated(1).host,
+            0);
+
+  const std::string report = startup.print(MPIEnvironment::mpi_);
+  EXPECT_NE(report.find("- Global numbering"), std::string::npos);
+  EXPECT_NE(report.find("- Total"), std::string::npos);
+}
+
+TEST(STARTUP_TESTS, BYTES_READ) {
+  const std::string filename = "startup_tests_input.txt";
+  {
+    std::ofstream file(filename);
+    file << std::string(100, 'x');
+  }
+
+  specfem::startup::profiler startup;
+  startup.start("Database");
+  startup.add_read(filename);
+  startup.add_read("startup_tests_missing.txt");
+  startup.stop();
+  EXPECT_DOUBLE_EQ(startup.get_bytes_read(0), 100.0);
+
+  // Files read outside of a stage aren't counted
+  startup.add_read(filename);
+  EXPECT_DOUBLE_EQ(startup.get_bytes_read(0), 100.0);
+
+  std::filesystem::remove(filename);
+}
+
+TEST(STARTUP_TESTS, NESTED_STAGES) {
+  specfem::startup::profiler startup;
+  startup.start("Database");
+  EXPECT_THROW(startup.start("Partitioning"), std::runtime_error);
+}
+
+TEST(STARTUP_TESTS, JSON_REPORT) {
+  const std::string filename = "startup_tests_report.json";
+  specfem::startup::profiler startup;
+  startup.start("Database");
+  startup.stop();
+  startup.add_size("nspec", 4096);
+  startup.write(filename, MPIEnvironment::mpi_);
+
+  std::ifstream file(filename);
+  ASSERT_TRUE(file.is_open());
+  const std::string json((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  EXPECT_NE(json.find("\"nspec\": 4096"), std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"Database\""), std::string::npos);
+  EXPECT_NE(json.find("\"max_seconds\""), std::string::npos);
+  file.close();
+  std::filesystem::remove(filename);
+}
+
+TEST(STARTUP_TESTS, DISABLED_PROFILER) {
+  specfem::startup::profiler startup(false);
+  startup.start("Database");
+  startup.start("Partitioning");
+  startup.stop();
+  EXPECT_EQ(startup.get_nstages(), 0);
+  EXPECT_EQ(startup.print(MPIEnvironment::mpi_), "");
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,91 @@
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/timers.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+TEST(TIMERS_TESTS, REGISTERED_PHASES) {
+  specfem::timers::timers timers;
+
+  // Time loop phases are registered first
+  EXPECT_EQ(timers.add("Stiffness"), specfem::timers::stiffness);
+  const int nphases = timers.get_nphases();
+  const int mesh_phase = timers.add("Mesh");
+  EXPECT_EQ(mesh_phase, nphases);
+  EXPECT_EQ(timers.add("Mesh"), mesh_phase);
+  EXPECT_EQ(timers.get_nphases(), nphases + 1);
+}
+
+TEST(TIMERS_TESTS, ACCUMULATED_TIME) {
+  const specfem::kokkos::DevExecSpace exec_space;
+  for (const bool accurate : { false, true }) {
+    specfem::timers::timers timers(true, accurate);
+    for (int i = 0; i < 3; i++) {
+      timers.start(specfem::timers::stiffness, exec_space);
+      timers.stop(specfem::timers::stiffness, exec_space);
+    }
+    EXPECT_EQ(timers.get_calls(specfem::timers::stiffness), 3);
+    EXPECT_GE(timers.get_seconds(specfem::timers::stiffness), 0.0);
+    EXPECT_EQ(timers.get_calls(specfem::timers::sources), 0);
+
+    // Phases which never ran aren't printed
+    const std::string summary = timers.print(MPIEnvironment::mpi_);
+    EXPECT_NE(summary.find("Stiffness"), std::string::npos);
+    EXPECT_EQ(summary.find("Sources"), std::string::npos);
+  }
+}
+
+TEST(TIMERS_TESTS, ACHIEVED_RATES) {
+  specfem::timers::timers timers;
+  for (int i = 0; i < 2; i++) {
+    timers.start(specfem::timers::stiffness);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    timers.stop(specfem::timers::stiffness);
+    timers.add_cost(specfem::timers::stiffness, { 1e6, 2e6 });
+  }
+  timers.start(specfem::timers::sources);
+  timers.stop(specfem::timers::sources);
+
+  const auto cost = timers.get_cost(specfem::timers::stiffness);
+  EXPECT_DOUBLE_EQ(cost.bytes, 2e6);
+  EXPECT_DOUBLE_EQ(cost.flops, 4e6);
+
+  // Phases without a cost don't print rates
+  std::string summary = timers.print(MPIEnvironment::mpi_);
+  const auto line = [&summary](const std::string &name) {
+    const auto begin = summary.find("- " + name);
+    return summary.substr(begin, summary.find('\n', begin) - begin);
+  };
+  const auto stiffness = line("Stiffness");
+  const auto sources = line("Sources");
+  EXPECT_NE(stiffness.find("GB/s"), std::string::npos);
+  EXPECT_NE(stiffness.find("GFLOP/s"), std::string::npos);
+  EXPECT_EQ(sources.find("GB/s"), std::string::npos);
+  EXPECT_EQ(summary.find("% of peak"), std::string::npos);
+
+  timers.set_peak(100.0, 1000.0);
+  summary = timers.print(MPIEnvironment::mpi_);
+  EXPECT_NE(summary.find("% of peak"), std::string::npos);
+}
+
+TEST(TIMERS_TESTS, DISABLED_TIMERS) {
+  specfem::timers::timers *timers = specfem::timers::disabled();
+  EXPECT_FALSE(timers->is_enabled());
+  timers->start(specfem::timers::predictor);
+  timers->stop(specfem::timers::predictor);
+  timers->add_cost(specfem::timers::predictor, { 1.0, 1.0 });
+  EXPECT_EQ(timers->get_calls(specfem::timers::predictor), 0);
+  EXPECT_EQ(timers->get_cost(specfem::timers::predictor).bytes, 0.0);
+  EXPECT_EQ(timers->print(MPIEnvironment::mpi_), "");
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
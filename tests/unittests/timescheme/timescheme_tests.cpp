@@ -0,0 +1,178 @@
+#include "../../../include/compute.h"
+#include "../../../include/domain.h"
+#include "../../../include/material.h"
+#include "../../../include/mesh.h"
+#include "../../../include/mesher.h"
+#include "../../../include/parameter_parser.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/read_sources.h"
+#include "../../../include/receiver.h"
+#include "../../../include/solver.h"
+#include "../../../include/timescheme.h"
+#include "../../../include/utils.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include "../utilities/include/compare_array.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Source of the Newmark displacement tests, at the center of the synthetic
+// mesh
+const std::string parameter_file = "../../../tests/unittests/"
+                                   "displacement_tests/Newmark/serial/"
+                                   "specfem_config.yaml";
+
+// Stage times are the start times of the stages of the 2N-storage recursion
+TEST(TIMESCHEME_TESTS, LDDRK_STAGE_TIMES) {
+  using LDDRK = specfem::TimeScheme::LDDRK;
+  const type_real t0 = -1.5;
+  const type_real dt = 0.25;
+  LDDRK lddrk(10, t0, dt, 1);
+
+  double d = 0.0;
+  double c = 0.0;
+  for (int istage = 0; istage < LDDRK::nstages; istage++) {
+    EXPECT_NEAR(lddrk.get_stage_time(istage), t0 + c * dt, 1e-5)
+        << "stage " << istage;
+    d = LDDRK::alpha[istage] * d + 1.0;
+    c += LDDRK::beta[istage] * d;
+  }
+
+  // The last stage completes the timestep
+  EXPECT_NEAR(c, 1.0, 1e-9);
+}
+
+TEST(TIMESCHEME_TESTS, LDDRK_REFERENCE_STAGE_TIMES) {
+  const double reference[] = { 0.0,
+                               0.032918605146,
+                               0.249351723343,
+                               0.466911705055,
+                               0.582030414044,
+                               0.847252983783 };
+  specfem::TimeScheme::LDDRK lddrk(10, 0.0, 1.0, 1);
+  for (int istage = 0; istage < specfem::TimeScheme::LDDRK::nstages;
+       istage++) {
+    EXPECT_NEAR(lddrk.get_stage_time(istage), reference[istage], 1e-5)
+        << "stage " << istage;
+  }
+}
+
+// Acceleration of every global point after nstep steps of the Newmark
+// timescheme on a uniform mesh. Elements whose center is right of xfine are
+// stepped with dt / 2 if xfine is inside the mesh
+specfem::kokkos::HostView2d<type_real> run_newmark(const type_real xfine,
+                                                   const int nstep) {
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  specfem::runtime_configuration::setup setup(parameter_file);
+  const auto [database_file, sources_file] = setup.get_databases();
+  auto [gllx, gllz] = setup.instantiate_quadrature();
+
+  specfem::mesher::layered_model model;
+  model.xmin = 0.0;
+  model.xmax = 5000.0;
+  model.zmin = 0.0;
+  model.nx = 16;
+  specfem::mesher::layer layer;
+  layer.nz = 16;
+  layer.top = { { 0.0, 5000.0 } };
+  layer.rho = 2700.0;
+  layer.vp = 3000.0;
+  layer.vs = 1700.0;
+  model.layers = { layer };
+
+  std::vector<specfem::material *> materials;
+  specfem::mesh mesh = specfem::mesher::generate(model, materials, mpi);
+
+  specfem::compute::compute compute(mesh.coorg, mesh.material_ind.knods, gllx,
+                                    gllz);
+  specfem::compute::partial_derivatives partial_derivatives(
+      mesh.coorg, mesh.material_ind.knods, gllx, gllz);
+  specfem::compute::properties material_properties(mesh.material_ind.kmato,
+                                                   materials, mesh.nspec,
+                                                   gllx.get_N(), gllz.get_N());
+
+  auto [sources, t0] = specfem::read_sources(sources_file, setup.get_dt(), mpi);
+  for (auto &source : sources)
+    source->locate(compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
+                   gllz.get_hxi(), mesh.nproc, mesh.coorg,
+                   mesh.material_ind.knods, mesh.npgeo,
+                   material_properties.h_ispec_type, mpi);
+
+  const type_real xmax = compute.coordinates.xmax;
+  const type_real xmin = compute.coordinates.xmin;
+  const type_real zmax = compute.coordinates.zmax;
+  const type_real zmin = compute.coordinates.zmin;
+
+  specfem::receivers::receiver_set stations;
+  stations.add("AA", "S0", 0.5 * (xmin + xmax), 0.7 * (zmin + zmax));
+  stations.locate(compute.coordinates.coord, compute.h_ibool, gllx.get_hxi(),
+                  gllz.get_hxi(), mesh.coorg, mesh.material_ind.knods, mpi);
+
+  // Element levels are assigned explicitly, the mesh is stable with dt
+  std::vector<int> element_levels(mesh.nspec, 0);
+  const int ngllz = gllz.get_N();
+  const int ngllx = gllx.get_N();
+  for (int ispec = 0; ispec < mesh.nspec; ispec++) {
+    const int icenter = compute.h_ibool(ispec, ngllz / 2, ngllx / 2);
+    if (compute.coordinates.coord(0, icenter) > xfine)
+      element_levels[ispec] = 1;
+  }
+  const bool lts =
+      (*std::max_element(element_levels.begin(), element_levels.end()) > 0);
+
+  std::unique_ptr<specfem::TimeScheme::TimeScheme> it;
+  if (lts) {
+    it = std::make_unique<specfem::TimeScheme::LTSNewmark>(
+        nstep, -1.0 * t0, setup.get_dt(), 1);
+  } else {
+    it = std::make_unique<specfem::TimeScheme::Newmark>(nstep, -1.0 * t0,
+                                                        setup.get_dt(), 1);
+  }
+
+  specfem::compute::sources compute_sources(sources, gllx, gllz, xmax, xmin,
+                                            zmax, zmin, mpi);
+  specfem::compute::receivers compute_receivers(
+      stations, { specfem::seismogram::displacement }, gllx, gllz, xmax, xmin,
+      zmax, zmin, it->get_max_seismogram_step(), mpi);
+
+  const int nglob = specfem::utilities::compute_nglob(compute.h_ibool);
+  specfem::Domain::Elastic domain(ndim, nglob, &compute, &material_properties,
+                                  &partial_derivatives, &compute_sources,
+                                  &compute_receivers, &gllx, &gllz);
+  if (lts)
+    it->set_element_levels(&domain, compute.h_ibool, element_levels);
+
+  std::unique_ptr<specfem::solver::solver> solver(
+      specfem::solver::instantiate_time_marching(&domain, it.get(), false));
+  solver->run();
+
+  domain.sync_field_dot_dot(specfem::sync::DeviceToHost);
+  const auto field_dot_dot = domain.get_host_field_dot_dot();
+  specfem::kokkos::HostView2d<type_real> acceleration(
+      "acceleration", field_dot_dot.extent(0), field_dot_dot.extent(1));
+  for (int iglob = 0; iglob < field_dot_dot.extent(0); iglob++) {
+    for (int icomp = 0; icomp < field_dot_dot.extent(1); icomp++)
+      acceleration(iglob, icomp) = field_dot_dot(iglob, icomp);
+  }
+
+  return acceleration;
+}
+
+// A source inside coarse elements far from the fine elements is stepped as
+// with a single level until the wavefield reaches the fine elements
+TEST(TIMESCHEME_TESTS, LTS_NEWMARK_COARSE_SOURCE) {
+  const int nstep = 20;
+  const auto newmark = run_newmark(10000.0, nstep);
+  const auto lts = run_newmark(3750.0, nstep);
+  EXPECT_NO_THROW(specfem::testing::compare_norm(lts, newmark, 1e-4));
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
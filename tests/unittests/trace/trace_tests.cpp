@@ -0,0 +1,83 @@
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/timers.h"
+#include "../../../include/trace.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <string>
+
+TEST(TRACE_TESTS, STEP_WINDOW) {
+  specfem::trace::recorder trace(MPIEnvironment::mpi_, 2, 3);
+  specfem::timers::timers timers;
+  timers.set_trace(&trace);
+
+  // Phases outside of the time loop aren't traced with a step window
+  const int setup_phase = timers.add("Setup");
+  timers.start(setup_phase);
+  timers.stop(setup_phase);
+  EXPECT_EQ(trace.get_nevents(), 0);
+
+  for (int istep = 0; istep < 6; istep++) {
+    timers.set_step(istep);
+    timers.start(specfem::timers::stiffness);
+    timers.stop(specfem::timers::stiffness);
+    timers.start(specfem::timers::corrector);
+    timers.stop(specfem::timers::corrector);
+  }
+  EXPECT_EQ(trace.get_nevents(), 4);
+}
+
+TEST(TRACE_TESTS, KERNEL_EVENTS) {
+  specfem::trace::recorder trace(MPIEnvironment::mpi_);
+  trace.record_kernels();
+  trace.set_step(0);
+  specfem::kokkos::DeviceView1d<type_real> view("specfem::tests::trace::view",
+                                                 100);
+  Kokkos::parallel_for(
+      "specfem::tests::trace::kernel",
+      specfem::kokkos::DeviceRange(0, 100),
+      KOKKOS_LAMBDA(const int i) { view(i) = i; });
+  Kokkos::fence();
+  EXPECT_GE(trace.get_nevents(), 1);
+}
+
+TEST(TRACE_TESTS, CHROME_TRACE) {
+  const std::string filename = "trace_tests_trace.json";
+  specfem::trace::recorder trace(MPIEnvironment::mpi_);
+  specfem::timers::timers timers;
+  timers.set_trace(&trace);
+  timers.set_step(0);
+  timers.start(specfem::timers::interfaces);
+  timers.stop(specfem::timers::interfaces);
+  trace.write(filename, MPIEnvironment::mpi_);
+
+  std::ifstream file(filename);
+  ASSERT_TRUE(file.is_open());
+  const std::string json((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  EXPECT_EQ(json.find("{\"displayTimeUnit\""), 0);
+  EXPECT_NE(json.find("\"name\": \"Interface exchange\""), std::string::npos);
+  EXPECT_NE(json.find("\"args\": {\"step\": 0}"), std::string::npos);
+  EXPECT_NE(json.find("]}"), std::string::npos);
+  file.close();
+  std::filesystem::remove(filename);
+}
+
+TEST(TRACE_TESTS, DISABLED_TRACE) {
+  specfem::timers::timers timers;
+  timers.set_step(0);
+  timers.start(specfem::timers::stiffness);
+  timers.stop(specfem::timers::stiffness);
+  EXPECT_EQ(specfem::trace::disabled()->get_nevents(), 0);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
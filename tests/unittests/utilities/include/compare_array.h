@@ -21,7 +21,7 @@ void test_array(specfem::kokkos::HostView1d<int> computed_array,
 void test_array(specfem::kokkos::HostView2d<int> computed_array,
                 std::string ref_file, int n1, int n2);
 
-void test_array(specfem::kokkos::HostView3d<int> computed_array,
+void test_array(specfem::kokkos::HostElementView3d<int> computed_array,
                 std::string ref_file, int n1, int n2, int n3);
 
 void test_array(specfem::kokkos::HostView1d<type_real> computed_array,
@@ -30,8 +30,9 @@ void test_array(specfem::kokkos::HostView1d<type_real> computed_array,
 void test_array(specfem::kokkos::HostView2d<type_real> computed_array,
                 std::string ref_file, int n1, int n2);
 
-void test_array(specfem::kokkos::HostView3d<type_real> computed_array,
-                std::string ref_file, int n1, int n2, int n3);
+void test_array(
+    specfem::kokkos::HostElementView3d<type_real> computed_array,
+    std::string ref_file, int n1, int n2, int n3);
 
 void compare_norm(specfem::kokkos::HostView1d<type_real> computed_array,
                   std::string ref_file, int n1, type_real tolerance);
@@ -42,6 +43,10 @@ void compare_norm(specfem::kokkos::HostView2d<type_real> computed_array,
 void compare_norm(specfem::kokkos::HostView3d<type_real> computed_array,
                   std::string ref_file, int n1, int n2, int n3,
                   type_real tolerance);
+
+void compare_norm(specfem::kokkos::HostView2d<type_real> computed_array,
+                  specfem::kokkos::HostView2d<type_real> ref_array,
+                  type_real tolerance);
 } // namespace testing
 } // namespace specfem
 
@@ -3,6 +3,7 @@
 #include "../../../../include/fortran_IO.h"
 #include "../../../../include/kokkos_abstractions.h"
 #include <Kokkos_Core.hpp>
+#include <cmath>
 #include <exception>
 #include <fstream>
 #include <iostream>
@@ -101,8 +102,8 @@ void specfem::testing::test_array(
 }
 
 void specfem::testing::test_array(
-    specfem::kokkos::HostView3d<int> computed_array, std::string ref_file,
-    int n1, int n2, int n3) {
+    specfem::kokkos::HostElementView3d<int> computed_array,
+    std::string ref_file, int n1, int n2, int n3) {
   assert(computed_array.extent(0) == n1);
   assert(computed_array.extent(1) == n2);
   assert(computed_array.extent(2) == n3);
@@ -203,8 +204,8 @@ void specfem::testing::test_array(
 }
 
 void specfem::testing::test_array(
-    specfem::kokkos::HostView3d<type_real> computed_array, std::string ref_file,
-    int n1, int n2, int n3) {
+    specfem::kokkos::HostElementView3d<type_real> computed_array,
+    std::string ref_file, int n1, int n2, int n3) {
   assert(computed_array.extent(0) == n1);
   assert(computed_array.extent(1) == n2);
   assert(computed_array.extent(2) == n3);
@@ -340,3 +341,29 @@ void specfem::testing::compare_norm(
 
   equate_norm(error_norm, computed_norm, tolerance);
 }
+
+void specfem::testing::compare_norm(
+    specfem::kokkos::HostView2d<type_real> computed_array,
+    specfem::kokkos::HostView2d<type_real> ref_array, type_real tolerance) {
+  if (computed_array.extent(0) != ref_array.extent(0) ||
+      computed_array.extent(1) != ref_array.extent(1)) {
+    std::ostringstream ss;
+    ss << "Computed array of size " << computed_array.extent(0) << " x "
+       << computed_array.extent(1) << " != ref array of size "
+       << ref_array.extent(0) << " x " << ref_array.extent(1);
+
+    throw std::runtime_error(ss.str());
+  }
+
+  type_real error_norm = 0.0;
+  type_real computed_norm = 0.0;
+
+  for (int i1 = 0; i1 < computed_array.extent(0); i1++) {
+    for (int i2 = 0; i2 < computed_array.extent(1); i2++) {
+      error_norm += std::fabs(computed_array(i1, i2) - ref_array(i1, i2));
+      computed_norm += std::fabs(computed_array(i1, i2));
+    }
+  }
+
+  equate_norm(error_norm, computed_norm, tolerance);
+}
@@ -0,0 +1,149 @@
+#include "../../../include/compute.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/velocity_model.h"
+#include "../Kokkos_Environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Linear fields are reproduced exactly by bilinear interpolation
+static double vp(const double x, const double z) {
+  return 2000.0 + 2.0 * x + 3.0 * z;
+}
+static double vs(const double x, const double z) {
+  return 1000.0 + x - z;
+}
+static double rho(const double x, const double z) {
+  return 2500.0 + 0.5 * x;
+}
+
+static std::string write_model(const int nx, const int nz) {
+  const std::string filename =
+      (std::filesystem::temp_directory_path() / "velocity_model_tests.bin")
+          .string();
+  specfem::velocity_model::header head;
+  std::memcpy(head.magic, "SPECFEMV", 8);
+  head.nx = nx;
+  head.nz = nz;
+  head.x0 = 0.0;
+  head.z0 = -10.0;
+  head.dx = 10.0;
+  head.dz = 5.0;
+
+  std::ofstream stream(filename, std::ios::binary);
+  stream.write(reinterpret_cast<const char *>(&head), sizeof(head));
+  for (int iz = 0; iz < nz; iz++) {
+    const double z = head.z0 + iz * head.dz;
+    std::vector<float> row;
+    for (const auto field : { vp, vs, rho })
+      for (int ix = 0; ix < nx; ix++)
+        row.push_back(field(head.x0 + ix * head.dx, z));
+    stream.write(reinterpret_cast<const char *>(row.data()),
+                 row.size() * sizeof(float));
+  }
+  return filename;
+}
+
+TEST(VELOCITY_MODEL_TESTS, INTERPOLATE) {
+  const int nx = 5;
+  const int nz = 7;
+  const std::string filename = write_model(nx, nz);
+
+  // Points of a single element inside the grid
+  const int ngll = 3;
+  const std::vector<double> xs = { 1.0, 17.5, 39.0 };
+  const std::vector<double> zs = { -9.0, 3.0, 19.5 };
+  specfem::kokkos::HostView2d<type_real> coord("coord", 2, ngll * ngll);
+  specfem::kokkos::HostElementView3d<int> ibool("ibool", 1, ngll, ngll);
+  for (int iz = 0; iz < ngll; iz++) {
+    for (int ix = 0; ix < ngll; ix++) {
+      const int iglob = iz * ngll + ix;
+      ibool(0, iz, ix) = iglob;
+      coord(0, iglob) = xs[ix];
+      coord(1, iglob) = zs[iz];
+    }
+  }
+
+  // Every tile size gives the same values
+  for (const int tile_rows : { 1, 2, 16 }) {
+    specfem::compute::properties properties(1, ngll, ngll);
+    properties.h_ispec_type(0) = specfem::elements::elastic;
+
+    EXPECT_EQ(specfem::velocity_model::interpolate(filename, tile_rows, coord,
+                                                   ibool, properties),
+              ngll * ngll);
+
+    for (int iz = 0; iz < ngll; iz++) {
+      for (int ix = 0; ix < ngll; ix++) {
+        const double x = xs[ix];
+        const double z = zs[iz];
+        const double rhol = rho(x, z);
+        EXPECT_NEAR(properties.h_rho(0, iz, ix), rhol, 1e-2);
+        EXPECT_NEAR(properties.rho_vp(0, iz, ix) / rhol, vp(x, z), 1e-2);
+        EXPECT_NEAR(properties.rho_vs(0, iz, ix) / rhol, vs(x, z), 1e-2);
+        EXPECT_NEAR(properties.h_mu(0, iz, ix) / (rhol * vs(x, z) * vs(x, z)),
+                    1.0, 1e-5);
+        EXPECT_NEAR(properties.h_lambdaplus2mu(0, iz, ix) /
+                        (rhol * vp(x, z) * vp(x, z)),
+                    1.0, 1e-5);
+      }
+    }
+  }
+
+  std::filesystem::remove(filename);
+}
+
+TEST(VELOCITY_MODEL_TESTS, OUTSIDE_GRID) {
+  const std::string filename = write_model(3, 3);
+
+  // Points outside the grid take the value of the closest grid point
+  specfem::kokkos::HostView2d<type_real> coord("coord", 2, 2);
+  specfem::kokkos::HostElementView3d<int> ibool("ibool", 1, 1, 2);
+  coord(0, 0) = -50.0;
+  coord(1, 0) = -50.0;
+  coord(0, 1) = 100.0;
+  coord(1, 1) = 100.0;
+  ibool(0, 0, 0) = 0;
+  ibool(0, 0, 1) = 1;
+
+  specfem::compute::properties properties(1, 1, 2);
+  properties.h_ispec_type(0) = specfem::elements::elastic;
+  specfem::velocity_model::interpolate(filename, 1, coord, ibool, properties);
+
+  EXPECT_NEAR(properties.rho_vp(0, 0, 0) / properties.h_rho(0, 0, 0),
+              vp(0.0, -10.0), 1e-2);
+  EXPECT_NEAR(properties.rho_vp(0, 0, 1) / properties.h_rho(0, 0, 1),
+              vp(20.0, 0.0), 1e-2);
+
+  std::filesystem::remove(filename);
+}
+
+TEST(VELOCITY_MODEL_TESTS, INVALID_FILE) {
+  specfem::kokkos::HostView2d<type_real> coord("coord", 2, 1);
+  specfem::kokkos::HostElementView3d<int> ibool("ibool", 1, 1, 1);
+  specfem::compute::properties properties(1, 1, 1);
+
+  const std::string filename =
+      (std::filesystem::temp_directory_path() / "velocity_model_invalid.bin")
+          .string();
+  {
+    std::ofstream stream(filename, std::ios::binary);
+    stream << "not a velocity model, not a velocity model, not a model";
+  }
+  EXPECT_THROW(specfem::velocity_model::interpolate(filename, 4, coord, ibool,
+                                                    properties),
+               std::runtime_error);
+  std::filesystem::remove(filename);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,145 @@
+#include "../../../include/compute.h"
+#include "../../../include/domain.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/receiver.h"
+#include "../../../include/spectrum_writer.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Domain storing fields only
+class field_domain : public specfem::Domain::Domain {
+public:
+  field_domain(const int nglob)
+      : field("field", nglob, ndim), field_dot("field_dot", nglob, ndim),
+        field_dot_dot("field_dot_dot", nglob, ndim) {}
+  specfem::kokkos::DeviceFieldView2d<type_real> get_field() const override {
+    return this->field;
+  }
+  specfem::kokkos::DeviceFieldView2d<type_real>
+  get_field_dot() const override {
+    return this->field_dot;
+  }
+  specfem::kokkos::DeviceFieldView2d<type_real>
+  get_field_dot_dot() const override {
+    return this->field_dot_dot;
+  }
+
+  specfem::kokkos::DeviceFieldView2d<type_real> field, field_dot,
+      field_dot_dot;
+};
+
+// Two elements of 3 x 3 points sharing an edge. Global points are numbered
+// along x on a 5 x 3 grid
+specfem::compute::compute two_elements() {
+  constexpr int ngll = 3;
+  specfem::compute::compute compute(2, ngll, ngll);
+  compute.coordinates.coord =
+      specfem::kokkos::HostView2d<type_real>("coord", ndim, 15);
+  for (int ispec = 0; ispec < 2; ispec++)
+    for (int iz = 0; iz < ngll; iz++)
+      for (int ix = 0; ix < ngll; ix++)
+        compute.h_ibool(ispec, iz, ix) = iz * 5 + ispec * (ngll - 1) + ix;
+  for (int iglob = 0; iglob < 15; iglob++) {
+    compute.coordinates.coord(0, iglob) = iglob % 5;
+    compute.coordinates.coord(1, iglob) = iglob / 5;
+  }
+  return compute;
+}
+
+std::vector<char> read_file(const std::filesystem::path &filename) {
+  std::ifstream stream(filename.string(), std::ios::binary);
+  return std::vector<char>((std::istreambuf_iterator<char>(stream)),
+                           std::istreambuf_iterator<char>());
+}
+
+// The spectrum of a cosine sampled over an integer number of periods is half
+// its amplitude times the length of the run at its frequency and vanishes at
+// the other frequencies of the discrete Fourier transform
+TEST(SPECTRUM_WRITER_TESTS, cosine) {
+
+  const int nsteps = 100;
+  const type_real dt = 0.01;
+  const type_real frequency = 5.0;
+  const std::vector<type_real> frequencies = { frequency, 2 * frequency };
+  const std::vector<int> expected_points = { 0, 2, 10, 12, 4, 14 };
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+
+  const auto compute = two_elements();
+  field_domain domain(15);
+  auto h_field = Kokkos::create_mirror_view(domain.field);
+  specfem::receivers::receiver_set receivers;
+
+  const auto folder = std::filesystem::temp_directory_path() /
+                      ("spectrum_writer_" + std::to_string(getpid()));
+
+  specfem::writer::spectrum writer(
+      &domain, &compute, receivers, nullptr,
+      { specfem::seismogram::displacement }, frequencies, 1, 2, dt, 0.0, dt,
+      folder.string(), mpi);
+
+  for (int istep = 0; istep < nsteps; istep++) {
+    const type_real t = istep * dt;
+    for (int iglob = 0; iglob < 15; iglob++)
+      for (int idim = 0; idim < ndim; idim++)
+        h_field(iglob, idim) =
+            (iglob + 1 + 100 * idim) * std::cos(2 * M_PI * frequency * t);
+    Kokkos::deep_copy(domain.field, h_field);
+
+    EXPECT_TRUE(writer.transform_step(istep));
+    writer.transform(istep, specfem::kokkos::DevExecSpace());
+  }
+  writer.write();
+
+  const int npoints = expected_points.size();
+  const int nfreq = frequencies.size();
+  const std::string rank = std::to_string(mpi->get_rank());
+
+  EXPECT_TRUE(
+      std::filesystem::exists(folder / ("spectrum_points_" + rank + ".bin")));
+  EXPECT_FALSE(std::filesystem::exists(
+      folder / ("spectrum_receivers_" + rank + ".bin")));
+
+  const auto spectrum = read_file(folder / ("spectrum_" + rank + ".bin"));
+  ASSERT_EQ(spectrum.size(), 4 * sizeof(std::int32_t) +
+                                 nfreq * npoints * ndim * 2 *
+                                     sizeof(type_real));
+  std::int32_t header[4];
+  std::memcpy(header, spectrum.data(), sizeof(header));
+  EXPECT_EQ(header[0], 1);
+  EXPECT_EQ(header[1], nfreq);
+  EXPECT_EQ(header[2], npoints);
+  EXPECT_EQ(header[3], ndim);
+
+  std::vector<type_real> values(nfreq * npoints * ndim * 2);
+  std::memcpy(values.data(), spectrum.data() + sizeof(header),
+              values.size() * sizeof(type_real));
+  for (int ifreq = 0; ifreq < nfreq; ifreq++)
+    for (int ipoint = 0; ipoint < npoints; ipoint++)
+      for (int idim = 0; idim < ndim; idim++) {
+        const type_real amplitude = expected_points[ipoint] + 1 + 100 * idim;
+        const type_real expected =
+            (ifreq == 0) ? 0.5 * amplitude * nsteps * dt : 0.0;
+        const int index = ((ifreq * npoints + ipoint) * ndim + idim) * 2;
+        EXPECT_NEAR(values[index], expected, 1e-4 * amplitude);
+        EXPECT_NEAR(values[index + 1], 0.0, 1e-4 * amplitude);
+      }
+
+  std::filesystem::remove_all(folder);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,235 @@
+#include "../../../include/compute.h"
+#include "../../../include/domain.h"
+#include "../../../include/kokkos_abstractions.h"
+#include "../../../include/quadrature.h"
+#include "../../../include/wavefield_writer.h"
+#include "../Kokkos_Environment.hpp"
+#include "../MPI_environment.hpp"
+#include <Kokkos_Core.hpp>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Domain storing fields only
+class field_domain : public specfem::Domain::Domain {
+public:
+  field_domain(const int nglob)
+      : field("field", nglob, ndim), field_dot("field_dot", nglob, ndim),
+        field_dot_dot("field_dot_dot", nglob, ndim) {}
+  specfem::kokkos::DeviceFieldView2d<type_real> get_field() const override {
+    return this->field;
+  }
+  specfem::kokkos::DeviceFieldView2d<type_real>
+  get_field_dot() const override {
+    return this->field_dot;
+  }
+  specfem::kokkos::DeviceFieldView2d<type_real>
+  get_field_dot_dot() const override {
+    return this->field_dot_dot;
+  }
+
+  specfem::kokkos::DeviceFieldView2d<type_real> field, field_dot,
+      field_dot_dot;
+};
+
+// Two elements of 3 x 3 points sharing an edge. Global points are numbered
+// along x on a 5 x 3 grid
+specfem::compute::compute two_elements() {
+  constexpr int ngll = 3;
+  specfem::compute::compute compute(2, ngll, ngll);
+  compute.coordinates.coord =
+      specfem::kokkos::HostView2d<type_real>("coord", ndim, 15);
+  for (int ispec = 0; ispec < 2; ispec++)
+    for (int iz = 0; iz < ngll; iz++)
+      for (int ix = 0; ix < ngll; ix++)
+        compute.h_ibool(ispec, iz, ix) = iz * 5 + ispec * (ngll - 1) + ix;
+  for (int iglob = 0; iglob < 15; iglob++) {
+    compute.coordinates.coord(0, iglob) = iglob % 5;
+    compute.coordinates.coord(1, iglob) = iglob / 5;
+  }
+  return compute;
+}
+
+std::vector<char> read_file(const std::filesystem::path &filename) {
+  std::ifstream stream(filename.string(), std::ios::binary);
+  return std::vector<char>((std::istreambuf_iterator<char>(stream)),
+                           std::istreambuf_iterator<char>());
+}
+
+// Snapshots written at every step multiple of nstep_between_snapshots
+// store the requested fields of the selected points
+void test_wavefield_writer(const int stride,
+                           const std::vector<int> &expected_points) {
+
+  const int nsteps = 6;
+  const int nstep_between_snapshots = 2;
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+
+  const auto compute = two_elements();
+  field_domain domain(15);
+  auto h_field = Kokkos::create_mirror_view(domain.field);
+  auto h_field_dot = Kokkos::create_mirror_view(domain.field_dot);
+
+  const auto folder = std::filesystem::temp_directory_path() /
+                      ("wavefield_writer_" + std::to_string(getpid()));
+
+  specfem::writer::wavefield writer(
+      &domain, &compute,
+      { specfem::seismogram::displacement, specfem::seismogram::velocity },
+      nstep_between_snapshots, stride, folder.string(), mpi);
+
+  for (int istep = 0; istep < nsteps; istep++) {
+    for (int iglob = 0; iglob < 15; iglob++)
+      for (int idim = 0; idim < ndim; idim++) {
+        h_field(iglob, idim) = iglob + 100 * idim + 1000 * istep;
+        h_field_dot(iglob, idim) = -h_field(iglob, idim);
+      }
+    Kokkos::deep_copy(domain.field, h_field);
+    Kokkos::deep_copy(domain.field_dot, h_field_dot);
+
+    EXPECT_EQ(writer.snapshot_step(istep),
+              (istep + 1) % nstep_between_snapshots == 0);
+    if (writer.snapshot_step(istep))
+      writer.snapshot(istep, specfem::kokkos::DevExecSpace());
+  }
+  writer.write();
+
+  const int npoints = expected_points.size();
+  const std::string rank = std::to_string(mpi->get_rank());
+
+  const auto points = read_file(folder / ("wavefield_points_" + rank + ".bin"));
+  ASSERT_EQ(points.size(),
+            sizeof(std::int32_t) + npoints * ndim * sizeof(type_real));
+  std::int32_t npoints_file;
+  std::memcpy(&npoints_file, points.data(), sizeof(npoints_file));
+  EXPECT_EQ(npoints_file, npoints);
+  for (int ipoint = 0; ipoint < npoints; ipoint++) {
+    type_real x, z;
+    const char *data =
+        points.data() + sizeof(std::int32_t) + ipoint * ndim * sizeof(x);
+    std::memcpy(&x, data, sizeof(x));
+    std::memcpy(&z, data + sizeof(x), sizeof(z));
+    EXPECT_EQ(x, expected_points[ipoint] % 5);
+    EXPECT_EQ(z, expected_points[ipoint] / 5);
+  }
+
+  for (const int istep : { 1, 3, 5 }) {
+    const std::string step = "00000" + std::to_string(istep + 1);
+    const auto snapshot =
+        read_file(folder / ("wavefield_" + step + "_" + rank + ".bin"));
+    ASSERT_EQ(snapshot.size(), 2 * npoints * ndim * sizeof(type_real));
+    std::vector<type_real> values(2 * npoints * ndim);
+    std::memcpy(values.data(), snapshot.data(), snapshot.size());
+    for (int ipoint = 0; ipoint < npoints; ipoint++)
+      for (int idim = 0; idim < ndim; idim++) {
+        const type_real value =
+            expected_points[ipoint] + 100 * idim + 1000 * istep;
+        EXPECT_EQ(values[ipoint * ndim + idim], value);
+        EXPECT_EQ(values[(npoints + ipoint) * ndim + idim], -value);
+      }
+  }
+
+  EXPECT_FALSE(std::filesystem::exists(folder / ("wavefield_000001_" + rank +
+                                                 ".bin")));
+
+  std::filesystem::remove_all(folder);
+}
+
+TEST(WAVEFIELD_WRITER_TESTS, every_point) {
+  // Points are ordered by first occurrence, shared points are written once
+  test_wavefield_writer(1, { 0, 1, 2, 5, 6, 7, 10, 11, 12, 3, 4, 8, 9, 13,
+                             14 });
+}
+
+TEST(WAVEFIELD_WRITER_TESTS, element_corners) {
+  test_wavefield_writer(2, { 0, 2, 10, 12, 4, 14 });
+}
+
+// Pixels of images interpolate the fields, which are linear in x and z, at
+// their centers. Pixels outside the mesh are 0
+TEST(WAVEFIELD_WRITER_TESTS, regular_image) {
+
+  specfem::MPI::MPI *mpi = MPIEnvironment::mpi_;
+  if (mpi->get_size() > 1)
+    GTEST_SKIP();
+
+  auto compute = two_elements();
+  compute.sync_views();
+  specfem::quadrature::quadrature gll(0.0, 0.0, 3);
+
+  // Corner control nodes of both elements
+  specfem::kokkos::HostView2d<type_real> coorg("coorg", ndim, 6);
+  specfem::kokkos::HostView2d<int> knods("knods", 4, 2);
+  for (int inode = 0; inode < 6; inode++) {
+    coorg(0, inode) = 2 * (inode % 3);
+    coorg(1, inode) = 2 * (inode / 3);
+  }
+  for (int ispec = 0; ispec < 2; ispec++) {
+    knods(0, ispec) = ispec;
+    knods(1, ispec) = ispec + 1;
+    knods(2, ispec) = ispec + 4;
+    knods(3, ispec) = ispec + 3;
+  }
+
+  field_domain domain(15);
+  auto h_field = Kokkos::create_mirror_view(domain.field);
+  for (int iglob = 0; iglob < 15; iglob++)
+    for (int idim = 0; idim < ndim; idim++)
+      h_field(iglob, idim) = iglob + 100 * idim;
+  Kokkos::deep_copy(domain.field, h_field);
+
+  specfem::writer::image_grid grid;
+  grid.nx = 5;
+  grid.nz = 2;
+  grid.xmax = 5.0;
+  grid.zmax = 2.0;
+  grid.bounded = true;
+
+  const auto folder = std::filesystem::temp_directory_path() /
+                      ("wavefield_image_" + std::to_string(getpid()));
+  {
+    specfem::writer::wavefield writer(
+        &domain, &compute, gll, gll, coorg, knods,
+        { specfem::seismogram::displacement }, 1, grid, folder.string(), mpi);
+    writer.snapshot(0, specfem::kokkos::DevExecSpace());
+    writer.write();
+  }
+
+  const auto image = read_file(folder / "image_000001_0.bin");
+  const int npixels = grid.nx * grid.nz;
+  ASSERT_EQ(image.size(), 2 * sizeof(std::int32_t) +
+                              npixels * ndim * sizeof(type_real));
+  std::int32_t header[2];
+  std::memcpy(header, image.data(), sizeof(header));
+  EXPECT_EQ(header[0], grid.nx);
+  EXPECT_EQ(header[1], grid.nz);
+
+  std::vector<type_real> values(npixels * ndim);
+  std::memcpy(values.data(), image.data() + sizeof(header),
+              values.size() * sizeof(type_real));
+  for (int iz = 0; iz < grid.nz; iz++) {
+    for (int ix = 0; ix < grid.nx; ix++) {
+      const type_real x = ix + 0.5;
+      const type_real z = iz + 0.5;
+      for (int idim = 0; idim < ndim; idim++) {
+        const type_real expected = (ix < 4) ? 5 * z + x + 100 * idim : 0.0;
+        EXPECT_NEAR(values[(iz * grid.nx + ix) * ndim + idim], expected,
+                    1e-3);
+      }
+    }
+  }
+
+  std::filesystem::remove_all(folder);
+}
+
+int main(int argc, char *argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::testing::AddGlobalTestEnvironment(new MPIEnvironment);
+  ::testing::AddGlobalTestEnvironment(new KokkosEnvironment);
+  return RUN_ALL_TESTS();
+}